@@ -0,0 +1,226 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/AsyncLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+namespace carla {
+
+  static size_t NextPowerOfTwo(size_t value) {
+    size_t result = 1u;
+    while (result < value) {
+      result <<= 1u;
+    }
+    return result;
+  }
+
+  static const char *LevelPrefix(const int level) {
+    // 与 Logging.h 中同步写入的前缀一致
+    switch (level) {
+      case LIBCARLA_LOG_LEVEL_DEBUG:    return "DEBUG:";
+      case LIBCARLA_LOG_LEVEL_INFO:     return "INFO: ";
+      case LIBCARLA_LOG_LEVEL_WARNING:  return "WARNING:";
+      case LIBCARLA_LOG_LEVEL_ERROR:    return "ERROR:";
+      default:                          return "CRITICAL:";
+    }
+  }
+
+  static const char *LevelName(const int level) {
+    switch (level) {
+      case LIBCARLA_LOG_LEVEL_DEBUG:    return "debug";
+      case LIBCARLA_LOG_LEVEL_INFO:     return "info";
+      case LIBCARLA_LOG_LEVEL_WARNING:  return "warning";
+      case LIBCARLA_LOG_LEVEL_ERROR:    return "error";
+      default:                          return "critical";
+    }
+  }
+
+  static void WriteJsonString(std::ostream &out, const std::string &value) {
+    out << '"';
+    for (const char c : value) {
+      switch (c) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20u) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+            out << buffer;
+          } else {
+            out << c;
+          }
+      }
+    }
+    out << '"';
+  }
+
+  AsyncLogger::AsyncLogger(
+      const LogFormat format,
+      std::ostream &out,
+      std::ostream &err,
+      const size_t queue_capacity)
+    : _format(format),
+      _out(out),
+      _err(err),
+      _mask(NextPowerOfTwo(std::max<size_t>(queue_capacity, 2u)) - 1u),
+      _slots(new Slot[_mask + 1u]) {
+    for (size_t i = 0u; i <= _mask; ++i) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _thread = std::thread([this]() { Run(); });
+  }
+
+  AsyncLogger::~AsyncLogger() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    _thread.join();
+  }
+
+  static std::mutex g_shared_mutex;
+  static AsyncLogger *g_shared_logger = nullptr;
+
+  bool AsyncLogger::Start(const AsyncLoggerSettings &settings) {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    if (g_shared_logger != nullptr) {
+      log_warning("asynchronous logging already started, ignoring new settings");
+      return false;
+    }
+    std::ostream *out = &std::cout;
+    std::ostream *err = &std::cerr;
+    if (!settings.file_path.empty()) {
+      // 与后端一样不销毁，退出时其它线程可能仍在记录日志
+      auto *file = new std::ofstream(settings.file_path, std::ios_base::app);
+      if (!file->is_open()) {
+        delete file;
+        log_error("failed to open log file", settings.file_path);
+        return false;
+      }
+      out = file;
+      err = file;
+    }
+    g_shared_logger = new AsyncLogger(settings.format, *out, *err, settings.queue_capacity);
+    logging::SetLevel(settings.level);
+    logging::SetBackend(g_shared_logger);
+    return true;
+  }
+
+  void AsyncLogger::Stop() {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    if (g_shared_logger != nullptr) {
+      logging::SetBackend(nullptr);
+      g_shared_logger->Flush();
+    }
+  }
+
+  void AsyncLogger::Write(const int level, std::string message) {
+    size_t position = _enqueue_position.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+      slot = &_slots[position & _mask];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if (difference == 0) {
+        if (_enqueue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // 队列已满，丢弃而不是阻塞记录日志的线程
+        ++_dropped;
+        return;
+      } else {
+        position = _enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+    slot->level = level;
+    slot->time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot->thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    slot->message = std::move(message);
+    slot->sequence.store(position + 1u, std::memory_order_release);
+    if (level >= LIBCARLA_LOG_LEVEL_ERROR) {
+      _wake.notify_one();
+    }
+  }
+
+  void AsyncLogger::Flush() {
+    const size_t target = _enqueue_position.load();
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake.notify_one();
+    _written.wait(lock, [&]() { return _dequeue_position.load() >= target; });
+  }
+
+  bool AsyncLogger::TryPop(Slot *&slot, size_t &position) {
+    position = _dequeue_position.load(std::memory_order_relaxed);
+    slot = &_slots[position & _mask];
+    return slot->sequence.load(std::memory_order_acquire) == position + 1u;
+  }
+
+  void AsyncLogger::Run() {
+    while (true) {
+      Slot *slot;
+      size_t position;
+      bool wrote = false;
+      while (TryPop(slot, position)) {
+        WriteRecord(*slot);
+        slot->message.clear();
+        slot->sequence.store(position + _mask + 1u, std::memory_order_release);
+        _dequeue_position.store(position + 1u);
+        wrote = true;
+      }
+      const size_t dropped = _dropped.load();
+      if (dropped != _reported_dropped) {
+        Slot report;
+        report.level = LIBCARLA_LOG_LEVEL_WARNING;
+        report.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        report.thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        report.message = "log queue full, dropped " +
+            std::to_string(dropped - _reported_dropped) + " messages";
+        WriteRecord(report);
+        _reported_dropped = dropped;
+        wrote = true;
+      }
+      if (wrote) {
+        _out.flush();
+        _err.flush();
+      }
+      std::unique_lock<std::mutex> lock(_mutex);
+      _written.notify_all();
+      if (_stop && !TryPop(slot, position)) {
+        return;
+      }
+      _wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+  }
+
+  void AsyncLogger::WriteRecord(const Slot &slot) {
+    std::ostream &out = (slot.level >= LIBCARLA_LOG_LEVEL_WARNING) ? _err : _out;
+    if (_format == LogFormat::Json) {
+      out << "{\"time\": " << slot.time_us / 1000000 << '.';
+      const auto microseconds = std::to_string(slot.time_us % 1000000);
+      out << std::string(6u - microseconds.size(), '0') << microseconds
+          << ", \"level\": \"" << LevelName(slot.level)
+          << "\", \"thread\": " << slot.thread_id
+          << ", \"message\": ";
+      WriteJsonString(out, slot.message);
+      out << "}\n";
+    } else {
+      out << LevelPrefix(slot.level) << ' ' << slot.message << '\n';
+    }
+  }
+
+} // namespace carla
@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace carla {
+
+  enum class LogFormat : uint8_t {
+    /// 与同步写入相同的 "LEVEL: message" 格式。
+    Text,
+    /// 每行一个 JSON 对象，包含时间、级别、线程与消息。
+    Json
+  };
+
+  struct AsyncLoggerSettings {
+    LogFormat format = LogFormat::Text;
+
+    /// 为空时信息与调试消息写入 std::cout，其它写入 std::cerr。
+    std::string file_path;
+
+    /// 队列能容纳的消息数，向上取整为 2 的幂。队列满时新消息被丢弃并计数。
+    size_t queue_capacity = 8192u;
+
+    /// 运行时日志级别，见 logging::SetLevel。
+    int level = LIBCARLA_LOG_LEVEL;
+  };
+
+  /// 异步日志后端：记录日志的线程把消息放入无锁的有界队列后立即返回，由
+  /// 后台线程格式化并写入输出流。错误及以上级别的消息会立即唤醒后台线程，
+  /// 其它消息最多延迟几毫秒写出。
+  class AsyncLogger final : public logging::LogBackend, private NonCopyable {
+  public:
+
+    AsyncLogger(LogFormat format, std::ostream &out, std::ostream &err, size_t queue_capacity = 8192u);
+
+    /// 写出队列中剩余的消息后结束后台线程。
+    ~AsyncLogger();
+
+    /// 创建进程共用的异步日志后端并安装到 carla::log_*，已经启动时记录警告并
+    /// 返回 false。文件无法打开时返回 false 并保持同步写入。
+    static bool Start(const AsyncLoggerSettings &settings);
+
+    /// 写出队列中的消息并恢复同步写入。共用的后端不会被销毁，其它线程中正在
+    /// 进行的调用仍然有效。
+    static void Stop();
+
+    void Write(int level, std::string message) override;
+
+    /// 等待调用之前放入队列的消息都已写出。
+    void Flush();
+
+    /// 因队列已满而丢弃的消息数。
+    size_t GetNumberOfDroppedMessages() const {
+      return _dropped.load();
+    }
+
+  private:
+
+    struct Slot {
+      std::atomic<size_t> sequence;
+      int level;
+      int64_t time_us;
+      size_t thread_id;
+      std::string message;
+    };
+
+    bool TryPop(Slot *&slot, size_t &position);
+
+    void Run();
+
+    void WriteRecord(const Slot &slot);
+
+    const LogFormat _format;
+
+    std::ostream &_out;
+
+    std::ostream &_err;
+
+    const size_t _mask;
+
+    // 有界的多生产者队列，每个槽的序号表示它是否可写或可读
+    std::unique_ptr<Slot[]> _slots;
+
+    std::atomic<size_t> _enqueue_position{0u};
+
+    std::atomic<size_t> _dequeue_position{0u};
+
+    std::atomic<size_t> _dropped{0u};
+
+    size_t _reported_dropped = 0u;
+
+    std::mutex _mutex;
+
+    std::condition_variable _wake;
+
+    std::condition_variable _written;
+
+    bool _stop = false;
+
+    std::thread _thread;
+  };
+
+} // namespace carla
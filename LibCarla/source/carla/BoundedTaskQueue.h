@@ -0,0 +1,167 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace carla {
+
+  /// 有界的任务队列与固定数量的工作线程，用于把耗时的工作（如写入磁盘）移出
+  /// 调用线程。
+  ///
+  /// 队列满时 Push 可以阻塞直到有空位，也可以立即丢弃任务；丢弃的数量与队列
+  /// 中的任务数作为背压报告给调用者。任务抛出的异常不会传播，只记录失败的
+  /// 数量与最后一个错误。
+  class BoundedTaskQueue : private NonCopyable {
+  public:
+
+    struct Statistics {
+      /// 在队列中或正在执行的任务数。
+      size_t pending = 0u;
+      size_t completed = 0u;
+      size_t dropped = 0u;
+      size_t failed = 0u;
+      std::string last_error;
+    };
+
+    BoundedTaskQueue(size_t max_size, size_t worker_threads)
+      : _max_size(std::max<size_t>(max_size, 1u)) {
+      _workers.CreateThreads(std::max<size_t>(worker_threads, 1u), [this]() { Run(); });
+    }
+
+    /// 完成队列中剩余的任务后结束。
+    ~BoundedTaskQueue() {
+      Stop();
+    }
+
+    size_t GetMaxSize() const {
+      return _max_size;
+    }
+
+    /// 把 @a task 加入队列。队列满时，@a block 为 true 则等待空位，否则丢弃
+    /// 任务并返回 false。Stop 之后总是返回 false。
+    bool Push(std::function<void()> task, bool block) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (block) {
+        _not_full.wait(lock, [this]() { return _stop || (_tasks.size() < _max_size); });
+      }
+      if (_stop || (_tasks.size() >= _max_size)) {
+        ++_dropped;
+        return false;
+      }
+      _tasks.emplace_back(std::move(task));
+      lock.unlock();
+      _not_empty.notify_one();
+      return true;
+    }
+
+    /// 等待队列中的所有任务执行完。
+    void Wait() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _idle.wait(lock, [this]() { return _tasks.empty() && (_running == 0u); });
+    }
+
+    /// 不再接受新任务，执行完队列中的任务后结束工作线程。
+    void Stop() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _not_empty.notify_all();
+      _not_full.notify_all();
+      _workers.JoinAll();
+    }
+
+    Statistics GetStatistics() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Statistics statistics;
+      statistics.pending = _tasks.size() + _running;
+      statistics.completed = _completed;
+      statistics.dropped = _dropped;
+      statistics.failed = _failed;
+      statistics.last_error = _last_error;
+      return statistics;
+    }
+
+  private:
+
+    void Run() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (true) {
+        _not_empty.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+        if (_tasks.empty()) {
+          return; // 已停止且没有剩余的任务
+        }
+        auto task = std::move(_tasks.front());
+        _tasks.pop_front();
+        ++_running;
+        lock.unlock();
+        _not_full.notify_one();
+        std::string error;
+        bool failed = false;
+        try {
+          task();
+        } catch (const std::exception &e) {
+          failed = true;
+          error = e.what();
+        } catch (...) {
+          failed = true;
+          error = "unknown error";
+        }
+        // 在锁外销毁任务，其捕获的对象可能需要获取其它的锁。
+        task = nullptr;
+        lock.lock();
+        --_running;
+        ++_completed;
+        if (failed) {
+          ++_failed;
+          _last_error = std::move(error);
+        }
+        if (_tasks.empty() && (_running == 0u)) {
+          _idle.notify_all();
+        }
+      }
+    }
+
+    const size_t _max_size;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _not_empty;
+
+    std::condition_variable _not_full;
+
+    std::condition_variable _idle;
+
+    std::deque<std::function<void()>> _tasks;
+
+    size_t _running = 0u;
+
+    size_t _completed = 0u;
+
+    size_t _dropped = 0u;
+
+    size_t _failed = 0u;
+
+    std::string _last_error;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace carla
@@ -11,4 +11,11 @@ namespace carla {
     }
   }
 
+  void Buffer::ReportReallocation() {
+    auto pool = _parent_pool.lock();
+    if (pool != nullptr) {
+      ++pool->_reallocations;
+    }
+  }
+
 } // namespace carla
@@ -300,6 +300,9 @@ namespace carla {
     void reset(size_type size) {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
+        if (_capacity > 0u) {
+          ReportReallocation();
+        }
         _data = std::make_unique<value_type[]>(size);
         _capacity = size;
       }
@@ -325,7 +328,7 @@ namespace carla {
     void resize(uint64_t size) {
       if (_capacity < size) {
         std::unique_ptr<value_type[]> data = std::move(_data);
-        uint64_t old_size = size;
+        uint64_t old_size = _size;
         reset(size);
         copy_from(data.get(), static_cast<size_type>(old_size));
       }
@@ -438,6 +441,9 @@ namespace carla {
   private:
 
     void ReuseThisBuffer();
+
+    /// 通知来源池此缓冲区的容量不足而重新分配了内存，用于统计。
+    void ReportReallocation();
     // 私有函数，用于重新使用此缓冲区资源，具体实现未给出
 
 
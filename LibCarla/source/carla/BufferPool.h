@@ -17,43 +17,181 @@
 #  pragma clang diagnostic pop  // 恢复之前保存的编译警告状态
 #endif
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>  // 包含内存管理相关的头文件
 
 namespace carla {
 
   /// 一个缓冲区池。 从这个池中弹出的缓冲区在销毁时会自动返回到池中，
   /// 这样分配的内存可以被重用。
+  ///
+  /// 空闲的缓冲区按容量分组存放（以 2 的幂为界），Pop(size) 只返回容量足够的
+  /// 缓冲区，因此不同大小的传感器数据共用一个池时不会互相导致重新分配。
+  /// 空闲缓冲区的总容量超过上限时，最大的空闲缓冲区会被释放。
   /// @warning 缓冲区仅通过增长来调整其大小，除非明确地清除它们，否则不会缩小。
-  /// 分配的内存在此池被销毁时才会被删除。
 
   class BufferPool : public std::enable_shared_from_this<BufferPool> {  // 定义 BufferPool 类，支持共享指针
   public:
 
+    /// 空闲缓冲区总容量的默认上限。
+    static constexpr size_t DEFAULT_MAX_IDLE_BYTES = 256u * 1024u * 1024u;
+
+    /// 池的统计信息。
+    struct Statistics {
+      /// 返回了池中已有缓冲区的 Pop 次数。
+      uint64_t hits = 0u;
+      /// 池中没有合适的缓冲区，返回了空缓冲区的 Pop 次数。
+      uint64_t misses = 0u;
+      /// 从池中取出的缓冲区因容量不足而重新分配内存的次数。
+      uint64_t reallocations = 0u;
+      /// 因超过容量上限而释放的空闲缓冲区数量。
+      uint64_t trimmed = 0u;
+      /// 当前池中空闲缓冲区的总容量（字节）。
+      size_t idle_bytes = 0u;
+    };
+
     BufferPool() = default;  // 默认构造函数
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}  // 带参数的构造函数，初始化队列大小
+    /// @param max_idle_bytes 空闲缓冲区总容量的上限，0 表示不限制。
+    explicit BufferPool(size_t max_idle_bytes) : _max_idle_bytes(max_idle_bytes) {}
 
-  /// 从队列中弹出一个缓冲区，如果队列为空，则创建一个新的缓冲区。
+    /// 从池中弹出一个缓冲区，如果池为空，则创建一个新的缓冲区。
+    ///
+    /// 不知道所需大小时使用，优先返回与最近放回的缓冲区大小相同的缓冲区。
     Buffer Pop() {
       Buffer item; // 创建一个 Buffer 实例
-      _queue.try_dequeue(item); // 尝试从队列中弹出，失败则不处理
+      const auto preferred = _last_size_class.load(std::memory_order_relaxed);
+      bool found = TryPop(preferred, item);
+      for (auto i = 0u; !found && (i < NUMBER_OF_SIZE_CLASSES); ++i) {
+        found = (i != preferred) && TryPop(i, item);
+      }
+      return Adopt(std::move(item), found);
+    }
+
+    /// 从池中弹出一个容量至少为 @a size 的缓冲区，如果没有，则创建一个新的缓冲区。
+    ///
+    /// 返回的缓冲区的大小未定义，调用者需要调用 reset 或 copy_from。
+    Buffer Pop(size_t size) {
+      Buffer item;
+      const auto size_class = SizeClassFor(size);
+      // 只在相邻的较大一组中查找，以免小的数据占用很大的缓冲区
+      const bool found =
+          TryPop(size_class, item) ||
+          ((size_class + 1u < NUMBER_OF_SIZE_CLASSES) && TryPop(size_class + 1u, item));
+      return Adopt(std::move(item), found);
+    }
+
+    /// 设置空闲缓冲区总容量的上限，0 表示不限制。
+    void SetMaxIdleBytes(size_t max_idle_bytes) {
+      _max_idle_bytes = max_idle_bytes;
+      Trim();
+    }
+
+    Statistics GetStatistics() const {
+      Statistics statistics;
+      statistics.hits = _hits;
+      statistics.misses = _misses;
+      statistics.reallocations = _reallocations;
+      statistics.trimmed = _trimmed;
+      statistics.idle_bytes = _idle_bytes;
+      return statistics;
+    }
+
+  private:
+
+    friend class Buffer;  // 允许 Buffer 类访问私有成员
+
+    /// 第 i 组存放容量在 [2^i, 2^(i+1)) 之间的缓冲区。
+    static constexpr size_t NUMBER_OF_SIZE_CLASSES = 33u;
+
+    /// 容量为 @a capacity 的缓冲区所在的组。
+    static size_t SizeClassOf(size_t capacity) {
+      size_t size_class = 0u;
+      while ((capacity >>= 1u) != 0u) {
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    /// 其中所有缓冲区的容量都不小于 @a size 的最小的组。
+    static size_t SizeClassFor(size_t size) {
+      const auto size_class = SizeClassOf(size);
+      return ((size & (size - 1u)) == 0u) ? size_class : size_class + 1u;
+    }
+
+    struct Bucket {
+      /// 不预先分配队列的存储空间，大部分组一直是空的。
+      Bucket() : queue(0u) {}
+
+      moodycamel::ConcurrentQueue<Buffer> queue;
+    };
+
+    bool TryPop(size_t size_class, Buffer &item) {
+      if (size_class >= NUMBER_OF_SIZE_CLASSES) {
+        return false;
+      }
+      if (_buckets[size_class].queue.try_dequeue(item)) {
+        _idle_bytes -= item.capacity();
+        return true;
+      }
+      return false;
+    }
+
+    Buffer Adopt(Buffer &&item, bool found) {
+      ++(found ? _hits : _misses);
 #if __cplusplus >= 201703L // 检查是否支持 C++17
       item._parent_pool = weak_from_this();  // 设置父池为弱引用
 #else
       item._parent_pool = shared_from_this();  // 设置父池为共享引用
 #endif
-      return item;  // 返回弹出的 Buffer
+      return std::move(item);  // 返回弹出的 Buffer
     }
 
-  private:
-
-    friend class Buffer;  // 允许 Buffer 类访问私有成员
-
     void Push(Buffer &&buffer) {  // 定义 Push 方法，接受一个右值引用的 Buffer
-      _queue.enqueue(std::move(buffer));  // 将 Buffer 移动到队列中
+      const auto capacity = buffer.capacity();
+      const auto size_class = SizeClassOf(capacity);
+      _idle_bytes += capacity;
+      _last_size_class.store(size_class, std::memory_order_relaxed);
+      _buckets[size_class].queue.enqueue(std::move(buffer));  // 将 Buffer 移动到队列中
+      if ((_max_idle_bytes != 0u) && (_idle_bytes > _max_idle_bytes)) {
+        Trim();
+      }
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;  // 定义并发队列用于存储 Buffer
+    /// 从最大的组开始释放空闲缓冲区，直到总容量不超过上限。
+    void Trim() {
+      const size_t max_idle_bytes = _max_idle_bytes;
+      if (max_idle_bytes == 0u) {
+        return;
+      }
+      for (auto i = NUMBER_OF_SIZE_CLASSES; (i > 0u) && (_idle_bytes > max_idle_bytes); --i) {
+        Buffer item;
+        while ((_idle_bytes > max_idle_bytes) && TryPop(i - 1u, item)) {
+          // 断开与池的关联，使缓冲区销毁时释放内存而不是放回池中
+          item._parent_pool.reset();
+          item.clear();
+          ++_trimmed;
+        }
+      }
+    }
+
+    std::array<Bucket, NUMBER_OF_SIZE_CLASSES> _buckets;
+
+    std::atomic_size_t _max_idle_bytes{DEFAULT_MAX_IDLE_BYTES};
+
+    std::atomic_size_t _idle_bytes{0u};
+
+    std::atomic_size_t _last_size_class{0u};
+
+    std::atomic<uint64_t> _hits{0u};
+
+    std::atomic<uint64_t> _misses{0u};
+
+    std::atomic<uint64_t> _reallocations{0u};
+
+    std::atomic<uint64_t> _trimmed{0u};
   };
 
 } // namespace carla
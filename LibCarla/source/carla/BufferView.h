@@ -60,11 +60,31 @@ namespace carla {
       return std::shared_ptr<BufferView>(new BufferView(std::move(buffer)));
     }
 
+    /// 创建一个引用外部内存的视图，不进行任何复制。
+    ///
+    /// @a owner 负责保持 @a data 所指向的内存有效，视图（以及所有引用它的
+    /// 消息）被销毁时释放 @a owner。用于将渲染回读等外部内存直接交给套接字。
+    static std::shared_ptr<BufferView> CreateFrom(
+        const value_type *data,
+        size_type size,
+        std::shared_ptr<const void> owner) {
+      DEBUG_ASSERT(owner != nullptr);
+      return std::shared_ptr<BufferView>(new BufferView(data, size, std::move(owner)));
+    }
+
   private:
 
     // 私有构造函数，接收一个临时缓冲区
     BufferView(Buffer &&rhs) noexcept
-      : _buffer(std::move(rhs)) {}
+      : _buffer(std::move(rhs)),
+        _data(_buffer.data()),
+        _size(_buffer.size()) {}
+
+    // 私有构造函数，引用由 @a owner 持有的外部内存
+    BufferView(const value_type *data, size_type size, std::shared_ptr<const void> owner) noexcept
+      : _owner(std::move(owner)),
+        _data(data),
+        _size(size) {}
 
     /// @}
     // =========================================================================
@@ -76,19 +96,19 @@ namespace carla {
 
     // 访问位置@a i的字节
     const value_type &operator[](size_t i) const {
-      return _buffer.data()[i];
+      return _data[i];
     }
 
     // 直接访问分配的内存，如果没有分配内存则返回nullptrv
     const value_type *data() const noexcept {
-      return _buffer.data();
+      return _data;
     }
 
     // 将此缓冲区转换为boost::asio::buffer
     ///
     /// @warning Boost.Asio缓冲区不拥有数据，调用者必须确保在asio缓冲区不再使用之前不要删除这块内存
     boost::asio::const_buffer cbuffer() const noexcept {
-      return {_buffer.data(), _buffer.size()};
+      return {_data, _size};
     }
 
     /// @copydoc cbuffer()
@@ -106,12 +126,12 @@ namespace carla {
     // 检查容器是否为空，并返回结果。
     // 如果_buffer中没有元素，则返回true，表示容器为空；否则返回false。
     bool empty() const noexcept {
-      return _buffer.size() == 0u;
+      return _size == 0u;
     }
     // 返回容器中当前存储的元素数量。
     // 这个值表示容器内实际的元素个数。
     size_type size() const noexcept {
-      return _buffer.size();
+      return _size;
     }
     // 返回容器能存储的最大元素数量。
     // 这是一个静态函数，返回size_type能表示的最大值，通常代表理论最大容量。
@@ -121,7 +141,7 @@ namespace carla {
     // 返回容器当前分配的存储空间大小，即容量。
     // 这个值表示在不进行内存重新分配的情况下，容器能存储的元素数量。
     size_type capacity() const noexcept {
-      return _buffer.capacity();
+      return _owner != nullptr ? _size : _buffer.capacity();
     }
 
     /// @}
@@ -134,28 +154,37 @@ namespace carla {
     // 返回指向容器开始的常量迭代器。
     // 这个迭代器不能用于修改容器中的元素，只能用于读取。
     const_iterator cbegin() const noexcept {
-      return _buffer.data();
+      return _data;
     }
     // 返回指向容器开始的常量迭代器。
     // 这个迭代器不能用于修改容器中的元素，只能用于读取。
     const_iterator begin() const noexcept {
-      return _buffer.cbegin();
+      return _data;
     }
     // 返回指向容器末尾的常量迭代器。
     // 这个迭代器指向容器中最后一个元素的下一个位置，表示容器的逻辑结束。
     const_iterator cend() const noexcept {
-      return _buffer.cbegin() + _buffer.size();
+      return _data + _size;
     }
     // 返回指向容器末尾的常量迭代器。
     // 这个迭代器指向容器中最后一个元素的下一个位置，表示容器的逻辑结束。
     const_iterator end() const noexcept {
-      return _buffer.cend();
+      return _data + _size;
     }
 
   private:
 
     // 用于存储数据的缓冲区
     const Buffer _buffer;
+
+    // 外部内存的持有者，仅当视图引用外部内存时非空
+    const std::shared_ptr<const void> _owner;
+
+    // 视图所引用数据的起始地址
+    const value_type *_data = nullptr;
+
+    // 视图所引用数据的大小
+    const size_type _size = 0u;
   };
 
   // BufferView的共享智能指针
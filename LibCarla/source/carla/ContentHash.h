@@ -0,0 +1,59 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace carla {
+
+  /// 计算数据内容的标识，用于判断本地缓存的文件与服务器上的是否相同。
+  ///
+  /// 标识由 64 位 FNV-1a 哈希值和数据大小组成，不适用于安全相关的用途。
+  class ContentHash {
+  public:
+
+    /// 空数据的哈希值，分段计算时作为第一段的 @a hash。
+    static constexpr uint64_t InitialValue() {
+      return 14695981039346656037ull;
+    }
+
+    /// 数据的 64 位 FNV-1a 哈希值。分段计算时将上一段的结果作为 @a hash
+    /// 传入，结果与一次计算全部数据相同。
+    static uint64_t ComputeValue(const void *data, size_t size, uint64_t hash = InitialValue()) {
+      constexpr uint64_t FNV_PRIME = 1099511628211ull;
+      const auto *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0u; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+      }
+      return hash;
+    }
+
+    /// 由哈希值 @a hash 和数据大小 @a size 组成的标识。
+    static std::string Format(uint64_t hash, uint64_t size) {
+      char buffer[64];
+      std::snprintf(
+          buffer,
+          sizeof(buffer),
+          "%016llx-%llu",
+          static_cast<unsigned long long>(hash),
+          static_cast<unsigned long long>(size));
+      return buffer;
+    }
+
+    static std::string Compute(const void *data, size_t size) {
+      return Format(ComputeValue(data, size), size);
+    }
+
+    static std::string Compute(const std::string &data) {
+      return Compute(data.data(), data.size());
+    }
+  };
+
+} // namespace carla
@@ -35,17 +35,71 @@
 //
 //  * LOG_DEBUG_ONLY(/* code here */)
 //  * LOG_INFO_ONLY(/* code here */)
+//  * LOG_RATE_LIMITED(seconds, log_function, /* arguments */)
+//
+// 编译时启用的级别还可以在运行时用 logging::SetLevel 进一步过滤。默认同步
+// 写入 std::cout/std::cerr；用 logging::SetBackend 安装后端（例如
+// AsyncLogger）后，调用者线程只格式化消息，写入由后端完成。
 
 // =============================================================================
 // -- Implementation of log functions ------------------------------------------
 // =============================================================================
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 namespace carla {
 
 namespace logging {
 
+  /// 接收格式化后的日志消息的后端，会被多个线程同时调用，不应阻塞。
+  class LogBackend {
+  public:
+
+    virtual ~LogBackend() = default;
+
+    /// @a level 为 LIBCARLA_LOG_LEVEL_* 之一，@a message 不包含级别前缀与换行。
+    virtual void Write(int level, std::string message) = 0;
+  };
+
+  // 非 static 的内联函数，所有编译单元共用同一个对象
+  inline std::atomic<LogBackend *> &backend_storage() {
+    static std::atomic<LogBackend *> backend{nullptr};
+    return backend;
+  }
+
+  inline std::atomic<int> &level_storage() {
+    static std::atomic<int> level{LIBCARLA_LOG_LEVEL};
+    return level;
+  }
+
+  /// 安装日志后端，nullptr 表示恢复同步写入。后端必须在之后一直有效，
+  /// 其它线程可能仍在使用旧的后端。
+  inline void SetBackend(LogBackend *backend) {
+    backend_storage().store(backend);
+  }
+
+  inline LogBackend *GetBackend() {
+    return backend_storage().load(std::memory_order_acquire);
+  }
+
+  /// 运行时的日志级别，低于它的消息被丢弃。低于编译时 LIBCARLA_LOG_LEVEL
+  /// 的级别在编译时已被移除，设置得更低也不会输出。
+  inline void SetLevel(int level) {
+    level_storage().store(level);
+  }
+
+  inline int GetLevel() {
+    return level_storage().load(std::memory_order_relaxed);
+  }
+
+  inline bool IsEnabled(int level) {
+    return level >= GetLevel();
+  }
+
   // https://stackoverflow.com/a/27375675
   template <typename Arg, typename ... Args>
   LIBCARLA_NOINLINE
@@ -55,18 +109,67 @@ namespace logging {
     (void) expander{0, (void(out << ' ' << std::forward<Args>(args)), 0) ...};
   }
 
+  static inline void write_to_stream(std::ostream &) {}
+
   template <typename ... Args>
   static inline void log(Args && ... args) {
     logging::write_to_stream(std::cout, std::forward<Args>(args) ..., '\n');
   }
 
+  /// 按级别过滤后同步写入 @a out，或格式化后交给已安装的后端。
+  template <typename ... Args>
+  LIBCARLA_NOINLINE
+  static void dispatch(int level, std::ostream &out, const char *prefix, Args && ... args) {
+    if (!IsEnabled(level)) {
+      return;
+    }
+    auto *backend = GetBackend();
+    if (backend == nullptr) {
+      write_to_stream(out, prefix, std::forward<Args>(args) ..., '\n');
+      return;
+    }
+    std::ostringstream message;
+    write_to_stream(message, std::forward<Args>(args) ...);
+    backend->Write(level, message.str());
+  }
+
+  /// 限制一个调用点的日志频率，每 @a interval 最多通过一次，并记录期间被
+  /// 丢弃的次数。无锁，可以被多个线程同时调用。
+  class RateLimiter {
+  public:
+
+    explicit RateLimiter(double interval_seconds)
+      : _interval(static_cast<int64_t>(interval_seconds * 1e9)) {}
+
+    /// 返回 true 时通过，@a suppressed 为上次通过之后被丢弃的次数。
+    bool Allow(size_t &suppressed) {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t next = _next.load(std::memory_order_relaxed);
+      if ((now >= next) && _next.compare_exchange_strong(next, now + _interval)) {
+        suppressed = _suppressed.exchange(0u);
+        return true;
+      }
+      ++_suppressed;
+      return false;
+    }
+
+  private:
+
+    const int64_t _interval;
+
+    std::atomic<int64_t> _next{0};
+
+    std::atomic<size_t> _suppressed{0u};
+  };
+
 } // namespace logging
 
 #if LIBCARLA_LOG_LEVEL <= LIBCARLA_LOG_LEVEL_DEBUG
 
   template <typename ... Args>
   static inline void log_debug(Args && ... args) {
-    logging::write_to_stream(std::cout, "DEBUG:", std::forward<Args>(args) ..., '\n');
+    logging::dispatch(LIBCARLA_LOG_LEVEL_DEBUG, std::cout, "DEBUG:", std::forward<Args>(args) ...);
   }
 
 #else
@@ -80,7 +183,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_info(Args && ... args) {
-    logging::write_to_stream(std::cout, "INFO: ", std::forward<Args>(args) ..., '\n');
+    logging::dispatch(LIBCARLA_LOG_LEVEL_INFO, std::cout, "INFO: ", std::forward<Args>(args) ...);
   }
 
 #else
@@ -94,7 +197,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_warning(Args && ... args) {
-    logging::write_to_stream(std::cerr, "WARNING:", std::forward<Args>(args) ..., '\n');
+    logging::dispatch(LIBCARLA_LOG_LEVEL_WARNING, std::cerr, "WARNING:", std::forward<Args>(args) ...);
   }
 
 #else
@@ -108,7 +211,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_error(Args && ... args) {
-    logging::write_to_stream(std::cerr, "ERROR:", std::forward<Args>(args) ..., '\n');
+    logging::dispatch(LIBCARLA_LOG_LEVEL_ERROR, std::cerr, "ERROR:", std::forward<Args>(args) ...);
   }
 
 #else
@@ -122,7 +225,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_critical(Args && ... args) {
-    logging::write_to_stream(std::cerr, "CRITICAL:", std::forward<Args>(args) ..., '\n');
+    logging::dispatch(LIBCARLA_LOG_LEVEL_CRITICAL, std::cerr, "CRITICAL:", std::forward<Args>(args) ...);
   }
 
 #else
@@ -149,3 +252,17 @@ namespace logging {
 #else
 #  define LOG_INFO_ONLY(code)
 #endif
+
+/// 每个调用点每 @a seconds 秒最多记录一次，通过时附加期间被丢弃的次数。
+#define LOG_RATE_LIMITED(seconds, log_function, ...) \
+  do { \
+    static ::carla::logging::RateLimiter carla_log_rate_limiter(seconds); \
+    size_t carla_log_suppressed = 0u; \
+    if (carla_log_rate_limiter.Allow(carla_log_suppressed)) { \
+      if (carla_log_suppressed > 0u) { \
+        log_function(__VA_ARGS__, "(suppressed", carla_log_suppressed, "similar messages)"); \
+      } else { \
+        log_function(__VA_ARGS__); \
+      } \
+    } \
+  } while (false)
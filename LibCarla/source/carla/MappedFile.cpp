@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/MappedFile.h"
+
+#include "carla/Logging.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  include <fstream>
+#  include <iterator>
+#endif // _WIN32
+
+namespace carla {
+
+#ifndef _WIN32
+
+  static std::string ErrorString(const char *what, const std::string &path) {
+    return std::string(what) + " '" + path + "': " + std::strerror(errno);
+  }
+
+  std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path, const bool writable) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      // 文件不存在是正常情况，调用者会回退到其他方式。
+      if (errno != ENOENT) {
+        log_warning(ErrorString("failed to open file", path));
+      }
+      return nullptr;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      log_warning(ErrorString("failed to query file", path));
+      ::close(fd);
+      return nullptr;
+    }
+    const auto size = static_cast<size_t>(info.st_size);
+    if (size == 0u) {
+      ::close(fd);
+      return nullptr;
+    }
+    // MAP_PRIVATE 的写入只复制被写的页，文件以只读方式打开即可
+    const int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void *data = ::mmap(nullptr, size, protection, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      log_warning(ErrorString("failed to map file", path));
+      ::close(fd);
+      return nullptr;
+    }
+    ::close(fd);
+    return std::unique_ptr<MappedFile>(
+        new MappedFile(static_cast<const uint8_t *>(data), size, writable));
+  }
+
+  MappedFile::~MappedFile() {
+    if (_content.empty()) {
+      ::munmap(const_cast<uint8_t *>(_data), _size);
+    }
+  }
+
+#else
+
+  std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path, const bool writable) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+      return nullptr;
+    }
+    std::vector<uint8_t> content(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    if (content.empty()) {
+      return nullptr;
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile(std::move(content), writable));
+  }
+
+  MappedFile::~MappedFile() = default;
+
+#endif // _WIN32
+
+  std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path) {
+    return Open(path, false);
+  }
+
+  std::unique_ptr<MappedFile> MappedFile::OpenCopyOnWrite(const std::string &path) {
+    return Open(path, true);
+  }
+
+} // namespace carla
@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+
+  /// 以只读方式映射到本进程地址空间的文件。
+  ///
+  /// 在 POSIX 平台上使用 mmap，文件内容按需从页缓存读入，不需要先复制到
+  /// 内存中；在其他平台上把整个文件读入内存。
+  class MappedFile : private NonCopyable {
+  public:
+
+    /// 打开并映射 @a path 指向的文件。
+    ///
+    /// @return 如果文件不存在、为空或无法映射则返回 nullptr。
+    static std::unique_ptr<MappedFile> Open(const std::string &path);
+
+    /// 以写时复制方式映射 @a path 指向的文件，映射可以写入，但写入只对本进程
+    /// 可见，不会写回文件；没有写入的页仍与其他进程共享页缓存。
+    ///
+    /// @return 如果文件不存在、为空或无法映射则返回 nullptr。
+    static std::unique_ptr<MappedFile> OpenCopyOnWrite(const std::string &path);
+
+    ~MappedFile();
+
+    const uint8_t *data() const {
+      return _data;
+    }
+
+    /// 只有用 OpenCopyOnWrite 打开的文件可以写入，否则返回 nullptr。
+    uint8_t *writable_data() const {
+      return _writable ? const_cast<uint8_t *>(_data) : nullptr;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    static std::unique_ptr<MappedFile> Open(const std::string &path, bool writable);
+
+    MappedFile(const uint8_t *data, size_t size, bool writable)
+      : _data(data),
+        _size(size),
+        _writable(writable) {}
+
+    MappedFile(std::vector<uint8_t> content, bool writable)
+      : _content(std::move(content)),
+        _data(_content.data()),
+        _size(_content.size()),
+        _writable(writable) {}
+
+    /// 不支持 mmap 的平台上存放文件的内容。
+    std::vector<uint8_t> _content;
+
+    const uint8_t *const _data;
+
+    const size_t _size;
+
+    const bool _writable;
+  };
+
+} // namespace carla
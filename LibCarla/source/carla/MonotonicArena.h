@@ -0,0 +1,131 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace carla {
+
+  /// 单调增长的内存区域，分配只移动指针，释放时一次归还所有内存。
+  ///
+  /// 用于生命周期相同的一组临时对象，例如同一帧的参与者快照。区域不负责调用
+  /// 对象的析构函数，也不是线程安全的。
+  class MonotonicArena : private NonCopyable {
+  public:
+
+    /// @a initial_size 为第一块内存的大小，为 0 时在第一次分配时按需创建。
+    explicit MonotonicArena(size_t initial_size = 0u) {
+      if (initial_size > 0u) {
+        AddBlock(initial_size);
+      }
+    }
+
+    void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+      DEBUG_ASSERT((alignment & (alignment - 1u)) == 0u);
+      if (!_blocks.empty()) {
+        const auto current = reinterpret_cast<std::uintptr_t>(_current);
+        const auto aligned = (current + alignment - 1u) & ~(std::uintptr_t(alignment) - 1u);
+        const size_t padding = aligned - current;
+        if (padding + size <= _remaining) {
+          _current += padding + size;
+          _remaining -= padding + size;
+          _allocated += size;
+          return reinterpret_cast<void *>(aligned);
+        }
+      }
+      // 新块至少是上一块的两倍，块数随分配量对数增长
+      const size_t last_size = _blocks.empty() ? 0u : _blocks.back().size;
+      AddBlock(std::max(size + alignment, 2u * last_size));
+      return Allocate(size, alignment);
+    }
+
+    /// 已分配的字节数，不包括对齐的填充。
+    size_t GetAllocatedBytes() const {
+      return _allocated;
+    }
+
+    /// 所有块的总大小。
+    size_t GetCapacity() const {
+      size_t capacity = 0u;
+      for (const auto &block : _blocks) {
+        capacity += block.size;
+      }
+      return capacity;
+    }
+
+    size_t GetNumberOfBlocks() const {
+      return _blocks.size();
+    }
+
+  private:
+
+    struct Block {
+      std::unique_ptr<unsigned char[]> data;
+      size_t size;
+    };
+
+    void AddBlock(size_t size) {
+      _blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+      _current = _blocks.back().data.get();
+      _remaining = size;
+    }
+
+    std::vector<Block> _blocks;
+
+    unsigned char *_current = nullptr;
+
+    size_t _remaining = 0u;
+
+    size_t _allocated = 0u;
+  };
+
+  /// 从 MonotonicArena 分配内存的标准库分配器，释放不做任何事，内存在区域
+  /// 销毁时归还。使用它的容器必须在区域之前销毁。
+  template <typename T>
+  class ArenaAllocator {
+  public:
+
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena &arena) noexcept : _arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(other._arena) {}
+
+    T *allocate(size_t n) {
+      return static_cast<T *>(_arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &rhs) const noexcept {
+      return _arena == rhs._arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &rhs) const noexcept {
+      return _arena != rhs._arena;
+    }
+
+  private:
+
+    template <typename U>
+    friend class ArenaAllocator;
+
+    MonotonicArena *_arena;
+  };
+
+} // namespace carla
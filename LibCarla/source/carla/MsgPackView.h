@@ -0,0 +1,128 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/ListView.h"
+#include "carla/MsgPack.h"
+
+#include <boost/utility/string_view.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace carla {
+
+  /// 反序列化后的 MsgPack 对象的只读视图，读取字符串和二进制数据时不复制。
+  ///
+  /// 视图持有 object_handle，返回的 string_view 和 ListView 都指向它的 zone
+  /// 中的内存，只要视图或它的任何副本（包括子元素的视图）还存在就一直有效。
+  class MsgPackView {
+  public:
+
+    using object_handle = ::clmdep_msgpack::object_handle;
+
+    using object = ::clmdep_msgpack::object;
+
+    using string_view = boost::string_view;
+
+    using bytes_view = ListView<const uint8_t *>;
+
+    MsgPackView() = default;
+
+    explicit MsgPackView(object_handle &&handle)
+      : _handle(std::make_shared<object_handle>(std::move(handle))),
+        _object(&_handle->get()) {}
+
+    /// 从 Buffer 反序列化，视图会复制一份 @a buffer 的数据。
+    static MsgPackView UnPack(const Buffer &buffer) {
+      return MsgPackView(::clmdep_msgpack::unpack(
+          reinterpret_cast<const char *>(buffer.data()),
+          buffer.size()));
+    }
+
+    bool IsValid() const {
+      return _object != nullptr;
+    }
+
+    const object &Get() const {
+      DEBUG_ASSERT(IsValid());
+      return *_object;
+    }
+
+    /// 将对象转换为 @a T，会复制其中的数据。
+    template <typename T>
+    T As() const {
+      return Get().template as<T>();
+    }
+
+    /// 数组的元素数量。
+    size_t size() const {
+      return GetArray().size;
+    }
+
+    /// 数组第 @a index 个元素的视图，与此视图共享同一个 object_handle。
+    MsgPackView operator[](size_t index) const {
+      const auto &array = GetArray();
+      if (index >= array.size) {
+        throw_exception(std::out_of_range("MsgPackView: index out of range"));
+      }
+      return MsgPackView(_handle, &array.ptr[index]);
+    }
+
+    /// 字符串或二进制数据的视图。
+    string_view AsStringView() const {
+      const auto &o = Get();
+      switch (o.type) {
+        case ::clmdep_msgpack::type::STR:
+          return {o.via.str.ptr, o.via.str.size};
+        case ::clmdep_msgpack::type::BIN:
+          return {o.via.bin.ptr, o.via.bin.size};
+        default:
+          throw_exception(::clmdep_msgpack::type_error());
+      }
+    }
+
+    /// 二进制数据（例如 std::vector<uint8_t>）或字符串的视图。
+    bytes_view AsBytes() const {
+      const auto str = AsStringView();
+      const auto *begin = reinterpret_cast<const uint8_t *>(str.data());
+      return bytes_view(begin, begin + str.size());
+    }
+
+    /// 字符串数组中每个字符串的视图。
+    std::vector<string_view> AsStringViewArray() const {
+      std::vector<string_view> result;
+      result.reserve(size());
+      for (auto i = 0u; i < size(); ++i) {
+        result.emplace_back((*this)[i].AsStringView());
+      }
+      return result;
+    }
+
+  private:
+
+    MsgPackView(std::shared_ptr<object_handle> handle, const object *o)
+      : _handle(std::move(handle)),
+        _object(o) {}
+
+    const ::clmdep_msgpack::object_array &GetArray() const {
+      const auto &o = Get();
+      if (o.type != ::clmdep_msgpack::type::ARRAY) {
+        throw_exception(::clmdep_msgpack::type_error());
+      }
+      return o.via.array;
+    }
+
+    std::shared_ptr<object_handle> _handle;
+
+    const object *_object = nullptr;
+  };
+
+} // namespace carla
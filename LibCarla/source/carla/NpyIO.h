@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace carla {
+
+  /// 写入 NumPy 的 .npy 文件（格式版本 1.0），文件头之后直接是按行存放的原始
+  /// 数据，可以用 numpy.load 读取。
+  class NpyIO {
+  public:
+
+    /// 本机的字节序，小端为 '<'，大端为 '>'。
+    static char GetByteOrder() {
+      const uint16_t one = 1u;
+      return (*reinterpret_cast<const uint8_t *>(&one) == 1u) ? '<' : '>';
+    }
+
+    /// 数值类型 @a T 对应的 numpy 类型描述，如 "'<f4'"。
+    template <typename T>
+    static std::string GetTypeDescription() {
+      static_assert(std::is_arithmetic<T>::value, "Invalid type.");
+      const char kind =
+          std::is_floating_point<T>::value ? 'f' :
+          std::is_same<T, bool>::value ? 'b' :
+          std::is_signed<T>::value ? 'i' : 'u';
+      const char order = (sizeof(T) == 1u) ? '|' : GetByteOrder();
+      return std::string("'") + order + kind + std::to_string(sizeof(T)) + "'";
+    }
+
+    /// 写入文件头。@a description 为 numpy 的类型描述，可以是 GetTypeDescription
+    /// 的结果，也可以是结构化类型的字段列表，如 "[('x', '<f4'), ('y', '<f4')]"。
+    static void WriteHeader(
+        std::ostream &out,
+        const std::string &description,
+        const std::vector<size_t> &shape) {
+      std::string header = "{'descr': " + description + ", 'fortran_order': False, 'shape': (";
+      for (size_t i = 0u; i < shape.size(); ++i) {
+        header += (i == 0u ? "" : ", ") + std::to_string(shape[i]);
+      }
+      header += (shape.size() == 1u) ? ",), }" : "), }";
+      // 魔数、版本与长度共 10 字节，数据按 64 字节对齐。
+      const size_t unpadded_size = 10u + header.size() + 1u;
+      header.append((64u - unpadded_size % 64u) % 64u, ' ');
+      header += '\n';
+      const auto length = static_cast<uint16_t>(header.size());
+      const char preamble[10u] = {
+          '\x93', 'N', 'U', 'M', 'P', 'Y', '\x01', '\x00',
+          static_cast<char>(length & 0xFFu),
+          static_cast<char>(length >> 8u)};
+      out.write(preamble, sizeof(preamble));
+      out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+  };
+
+} // namespace carla
@@ -0,0 +1,59 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/TaskScheduler.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace carla {
+
+namespace detail {
+
+  /// 为 true 时当前线程调用的 ParallelFor 在调用线程中依次执行。
+  inline bool &IsParallelForSerial() {
+    static thread_local bool serial = false;
+    return serial;
+  }
+
+} // namespace detail
+
+  /// 在作用域内，当前线程调用的 ParallelFor 都在调用线程中按索引顺序执行，
+  /// 用于得到与并行执行比较的串行结果。
+  class ScopedSerialParallelFor : private NonCopyable {
+  public:
+
+    ScopedSerialParallelFor() : _previous(detail::IsParallelForSerial()) {
+      detail::IsParallelForSerial() = true;
+    }
+
+    ~ScopedSerialParallelFor() {
+      detail::IsParallelForSerial() = _previous;
+    }
+
+  private:
+
+    const bool _previous;
+  };
+
+  /// 用多个线程对 [0, size) 中的每个索引调用 @a functor，不同索引的调用必须互不
+  /// 影响。每个线程至少分到 @a min_elements_per_thread 个索引，元素少时直接在
+  /// 调用线程中执行。工作线程中抛出的第一个异常在所有线程结束后重新抛出。
+  ///
+  /// 任务提交到进程共用的 TaskScheduler，不会为每次调用创建线程。
+  template <typename Functor>
+  void ParallelFor(const size_t size, Functor &&functor, const size_t min_elements_per_thread = 64u) {
+    TaskScheduler::Get().ParallelFor(
+        size,
+        std::forward<Functor>(functor),
+        min_elements_per_thread,
+        detail::IsParallelForSerial() ? 1u : 0u);
+  }
+
+} // namespace carla
@@ -0,0 +1,178 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+  /// 读多写少的列表，遍历不加锁也不分配内存（读-复制-更新）。
+  ///
+  /// 修改在互斥量下复制当前的版本并原子地发布新版本，旧版本在所有可能读到
+  /// 它的遍历结束后回收到池中，下次修改时复用，其 std::vector 保留已有的容量，
+  /// 因此稳定后增删元素也不分配内存。
+  ///
+  /// 遍历按纪元计数：每次遍历计入当前纪元奇偶对应的计数器。只有上一个纪元
+  /// 的遍历都结束后纪元才前进，所以在纪元 E 被替换的版本到纪元 E + 2 时已经
+  /// 没有遍历在使用。修改从不等待遍历结束，遍历中的回调可以修改列表。
+  template <typename T>
+  class RcuList : private NonCopyable {
+  public:
+
+    RcuList() : _current(new Version) {}
+
+    ~RcuList() {
+      delete _current.load();
+      for (auto &retired : _retired) {
+        delete retired.version;
+      }
+      for (auto *version : _pool) {
+        delete version;
+      }
+    }
+
+    /// 对列表中的每个元素调用 @a functor，看到的是调用开始时的版本。
+    template <typename FunctorT>
+    void ForEach(FunctorT &&functor) const {
+      ReadGuard guard(*this);
+      for (const auto &item : _current.load()->items) {
+        functor(item);
+      }
+    }
+
+    template <typename ValueT>
+    void Push(ValueT &&value) {
+      Modify([&](std::vector<T> &items) { items.emplace_back(std::forward<ValueT>(value)); });
+    }
+
+    void DeleteByIndex(size_t index) {
+      Modify([&](std::vector<T> &items) {
+        DEBUG_ASSERT(index < items.size());
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(index));
+      });
+    }
+
+    template <typename ValueT>
+    void DeleteByValue(const ValueT &value) {
+      Modify([&](std::vector<T> &items) {
+        items.erase(std::remove(items.begin(), items.end(), value), items.end());
+      });
+    }
+
+    void Clear() {
+      Modify([](std::vector<T> &items) { items.clear(); });
+    }
+
+    size_t size() const {
+      ReadGuard guard(*this);
+      return _current.load()->items.size();
+    }
+
+  private:
+
+    struct Version {
+      std::vector<T> items;
+    };
+
+    struct Retired {
+      Version *version;
+      size_t epoch;
+    };
+
+    /// 在作用域内计入当前纪元的计数器，即使回调抛出异常也会撤销。读取纪元与
+    /// 增加计数之间纪元可能前进，此时撤销重试，保证计入的纪元在某一时刻是当前
+    /// 纪元。
+    class ReadGuard {
+    public:
+
+      explicit ReadGuard(const RcuList &list) : _readers(list._readers) {
+        while (true) {
+          _epoch = list._epoch.load();
+          ++_readers[_epoch & 1u];
+          if (list._epoch.load() == _epoch) {
+            return;
+          }
+          --_readers[_epoch & 1u];
+        }
+      }
+
+      ~ReadGuard() {
+        --_readers[_epoch & 1u];
+      }
+
+    private:
+
+      std::atomic<size_t> (&_readers)[2u];
+
+      size_t _epoch;
+    };
+
+    template <typename FunctorT>
+    void Modify(FunctorT &&modify) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Version *version = AcquireVersion();
+      Version *old_version = _current.load();
+      version->items = old_version->items;
+      modify(version->items);
+      _current.store(version);
+      _retired.push_back(Retired{old_version, _epoch.load()});
+      TryAdvanceEpoch();
+      Reclaim();
+    }
+
+    /// 上一个纪元的遍历都已结束时前进一个纪元，否则留到下次修改。
+    void TryAdvanceEpoch() {
+      const size_t epoch = _epoch.load();
+      if (_readers[(epoch + 1u) & 1u].load() == 0u) {
+        _epoch.store(epoch + 1u);
+      }
+    }
+
+    void Reclaim() {
+      const size_t epoch = _epoch.load();
+      auto it = std::partition(_retired.begin(), _retired.end(), [epoch](const Retired &retired) {
+        return retired.epoch + 2u > epoch;
+      });
+      for (auto reclaim = it; reclaim != _retired.end(); ++reclaim) {
+        reclaim->version->items.clear();
+        _pool.push_back(reclaim->version);
+      }
+      _retired.erase(it, _retired.end());
+    }
+
+    Version *AcquireVersion() {
+      if (_pool.empty()) {
+        return new Version;
+      }
+      Version *version = _pool.back();
+      _pool.pop_back();
+      return version;
+    }
+
+    std::mutex _mutex;
+
+    std::atomic<Version *> _current;
+
+    std::atomic<size_t> _epoch{0u};
+
+    mutable std::atomic<size_t> _readers[2u] = {{0u}, {0u}};
+
+    /// 已被替换但可能仍在被遍历的版本。
+    std::vector<Retired> _retired;
+
+    /// 可以复用的版本。
+    std::vector<Version *> _pool;
+  };
+
+} // namespace carla
@@ -6,6 +6,8 @@
 
 #pragma once  // 防止头文件被重复包含
 
+#include "carla/AtomicSharedPtr.h"  // 引入原子共享指针，用于无锁地发布值
+#include "carla/Debug.h"
 #include "carla/Exception.h"  // 引入CARLA项目中的异常处理头文件 
 #include "carla/Time.h"   // 引入CARLA项目中的时间处理头文件
 
@@ -20,11 +22,21 @@
 #include <boost/variant2/variant.hpp> // 如果不是在 MSVC 环境下，直接引入 Boost.Variant2
 #endif
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable> // 引入 C++ 标准库中的条件变量头文件，用于同步操作，如等待某个条件成立 
+#include <cstdint>
 #include <exception> // 引入 C++ 标准库中的异常处理头文件
-#include <map> // 引入 C++ 标准库中的 map 头文件，map 是一个关联容器，存储的元素是键值对 
+#include <memory>
 #include <mutex> // 引入 C++ 标准库中的互斥锁头文件，用于提供互斥锁，以保护共享数据的同步访问 
 
+#if defined(__linux__)
+#  include <ctime>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
 namespace carla {
 
 namespace detail {
@@ -67,17 +79,29 @@ namespace detail {
     void SetException(ExceptionT &&exception);
 
   private:
-      // 互斥量：可以确保一次只有一个线程可以访问共享资源，避免竞争条件的发生
+
+    using value_type = boost::variant2::variant<SharedException, T>;  // boost::variant2实现类型转换
+
+    /// 等待 _version 不再等于 @a version 或者到达 @a deadline，到期时返回 false。
+    bool WaitForVersion(uint32_t version, std::chrono::steady_clock::time_point deadline);
+
+    void NotifyAll();
+
+    // 每次设置值时加一。等待的线程记下调用时的版本号，版本号改变后读取
+    // _value，所以不需要为每个线程保存状态，设置值时也不需要加锁。
+    std::atomic<uint32_t> _version{0u};
+
+    // 正在等待的线程数，为 0 时设置值不需要唤醒任何线程。
+    std::atomic<uint32_t> _waiters{0u};
+
+    AtomicSharedPtr<const value_type> _value;
+
+#if !defined(__linux__)
+    // 没有 futex 的平台上用于阻塞等待，只在有线程等待时使用。
     std::mutex _mutex;
-      // 条件变量是c++中提供的一种多线程同步机制，它允许一个或多个线程等待另一个消除发出通知，以便能够有效地进行线程同步
-    std::condition_variable _cv;
-      // 定义一个结构体，用于映射键（const char*）到值和等待状态 
-    struct mapped_type {
-      bool should_wait;
-      boost::variant2::variant<SharedException, T> value;  // boost::variant2实现类型转换
-    };
 
-    std::map<const char *, mapped_type> _map;  // 所有线程构成的map
+    std::condition_variable _cv;
+#endif
   };
 
   // ===========================================================================
@@ -85,9 +109,6 @@ namespace detail {
   // ===========================================================================
 // 定义了一个名为 detail 的命名空间
 namespace detail {
-//// 定义一个线程局部的静态常量字符变量，用于标识或标记当前线程，其值默认为空字符（'\0'）
-  static thread_local const char thread_tag{};
-
   class SharedException : public std::exception {
   public:
 
@@ -110,38 +131,91 @@ namespace detail {
     std::shared_ptr<std::exception> _exception;
   };
 
+#if defined(__linux__)
+  /// 如果 *@a address 等于 @a expected 则阻塞，直到被唤醒或经过 @a timeout。
+  /// 可能被虚假唤醒，调用者需要重新检查条件。
+  static inline void FutexWait(std::atomic<uint32_t> *address, uint32_t expected, std::chrono::nanoseconds timeout) {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(address), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+  }
+
+  static inline void FutexWakeAll(std::atomic<uint32_t> *address) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(address), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+  }
+#endif // __linux__
+
 } // namespace detail
 
   //  如果达到超时时间timeout仍然未获得结果，则返回空的 boost::optional
   template <typename T>
   boost::optional<T> RecurrentSharedFuture<T>::WaitFor(time_duration timeout) {
-    // std::mutex提供的lock()和unlock()方法，用于在需要访问共享资源时加锁和解锁。
-    // 当一个线程获得了锁之后，其他线程会被阻塞直到锁被释放。
-    // 这样可以保证同一时刻只有一个线程可以访问共享资源，从而确保数据的一致性和正确性。
-    std::unique_lock<std::mutex> lock(_mutex);
-    auto &r = _map[&detail::thread_tag];
-    r.should_wait = true;
-    // wait_for() 函数用于阻塞线程并等待唤醒，它可以设置一个超时时间 timeout.to_chrono()。
-    if (!_cv.wait_for(lock, timeout.to_chrono(), [&]() { return !r.should_wait; })) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout.to_chrono();
+    const uint32_t version = _version.load();
+    if (!WaitForVersion(version, deadline)) {
       return {};
     }
-    if (r.value.index() == 0) {
-      throw_exception(boost::variant2::get<SharedException>(r.value));
+    // 版本号改变之前值已经发布，读到的是这次或更新的值
+    const auto value = _value.load();
+    DEBUG_ASSERT(value != nullptr);
+    if (value->index() == 0) {
+      throw_exception(boost::variant2::get<SharedException>(*value));
     }
-    return boost::variant2::get<T>(std::move(r.value));
+    return boost::variant2::get<T>(*value);
   }
 
   // /// 设置值并通知所有等待的线程
   template <typename T>
   template <typename T2>
   void RecurrentSharedFuture<T>::SetValue(const T2 &value) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    for (auto &pair : _map) {
-      pair.second.should_wait = false;  // 将每个线程设置为不需要等待
-      pair.second.value = value;        // 设置值
+    _value.store(std::make_shared<const value_type>(value));
+    ++_version;
+    NotifyAll();  // 通知所有线程
+  }
+
+  template <typename T>
+  bool RecurrentSharedFuture<T>::WaitForVersion(
+      const uint32_t version,
+      const std::chrono::steady_clock::time_point deadline) {
+    // 先增加等待者再检查版本号，与 SetValue 中先改版本号再检查等待者相对应
+    // （都是顺序一致的操作），两者中至少有一方能看到对方的修改，不会丢失唤醒。
+    ++_waiters;
+    bool changed = true;
+#if defined(__linux__)
+    while (_version.load() == version) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline) {
+        changed = false;
+        break;
+      }
+      detail::FutexWait(&_version, version, deadline - now);
+    }
+#else
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      changed = _cv.wait_until(lock, deadline, [&]() { return _version.load() != version; });
     }
-    _cv.notify_all();  // 通知所有线程
+#endif
+    --_waiters;
+    return changed;
   }
+
+  template <typename T>
+  void RecurrentSharedFuture<T>::NotifyAll() {
+    if (_waiters.load() == 0u) {
+      return;
+    }
+#if defined(__linux__)
+    detail::FutexWakeAll(&_version);
+#else
+    // 加锁保证等待者要么还没有检查条件，要么已经在 _cv 上等待
+    { std::lock_guard<std::mutex> lock(_mutex); }
+    _cv.notify_all();
+#endif
+  }
+
  // 设置一个异常，并通知所有等待的线程
   template <typename T>
   template <typename ExceptionT>
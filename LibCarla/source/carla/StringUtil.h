@@ -88,6 +88,18 @@ namespace carla {
     static bool Match(const String1T &str, const String2T &wildcard_pattern) {
       return Match(ToConstCharPtr(str), ToConstCharPtr(wildcard_pattern));
     }
+
+    /// 返回 @a wildcard_pattern 中第一个通配符之前的部分，所有与该模式匹配的
+    /// 字符串都以它开头，可以用来在有序的容器中缩小查找范围。
+    // Windows 上的匹配不区分大小写，并且支持用 ';' 分隔多个模式，因此返回空字符串。
+    static std::string GetWildcardPrefix(const std::string &wildcard_pattern) {
+#ifdef _WIN32
+      (void) wildcard_pattern;
+      return {};
+#else
+      return wildcard_pattern.substr(0u, wildcard_pattern.find_first_of("*?[\\"));
+#endif // _WIN32
+    }
   };
 
 } // namespace carla
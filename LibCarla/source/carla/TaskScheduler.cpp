@@ -0,0 +1,215 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/TaskScheduler.h"
+
+#include "carla/Logging.h"
+
+#include <thread>
+
+namespace carla {
+
+  // 调用者线程所属的调度器与队列，不是工作线程时为空。
+  static thread_local const TaskScheduler *t_scheduler = nullptr;
+  static thread_local size_t t_queue_index = 0u;
+
+  static std::mutex g_default_mutex;
+  static size_t g_default_worker_threads = 0u;
+  static ThreadSettings g_default_settings;
+  static bool g_default_created = false;
+
+  TaskScheduler::TaskScheduler(size_t worker_threads, const ThreadSettings &settings) {
+    if (worker_threads == 0u) {
+      worker_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+    }
+    _queues.reserve(worker_threads);
+    for (size_t i = 0u; i < worker_threads; ++i) {
+      _queues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0u; i < worker_threads; ++i) {
+      _workers.CreateThread([this, i, settings]() {
+        if (!settings.IsDefault()) {
+          settings.ApplyToCurrentThread();
+        }
+        Run(i);
+      });
+    }
+  }
+
+  TaskScheduler::~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    _workers.JoinAll();
+  }
+
+  TaskScheduler &TaskScheduler::Get() {
+    static TaskScheduler *scheduler = []() {
+      std::lock_guard<std::mutex> lock(g_default_mutex);
+      g_default_created = true;
+      // 不销毁，静态对象析构时可能仍有线程在使用它
+      return new TaskScheduler(g_default_worker_threads, g_default_settings);
+    }();
+    return *scheduler;
+  }
+
+  bool TaskScheduler::Configure(size_t worker_threads, const ThreadSettings &settings) {
+    std::lock_guard<std::mutex> lock(g_default_mutex);
+    if (g_default_created) {
+      log_warning("task scheduler already running, ignoring new configuration");
+      return false;
+    }
+    g_default_worker_threads = worker_threads;
+    g_default_settings = settings;
+    return true;
+  }
+
+  bool TaskScheduler::IsWorkerThread() const {
+    return t_scheduler == this;
+  }
+
+  void TaskScheduler::Post(std::function<void()> task) {
+    DEBUG_ASSERT(task != nullptr);
+    const size_t index = IsWorkerThread() ?
+        t_queue_index :
+        _next_queue.fetch_add(1u, std::memory_order_relaxed) % _queues.size();
+    {
+      auto &queue = *_queues[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.emplace_back(std::move(task));
+    }
+    ++_pending;
+    {
+      // 与 Run 中的等待同步，避免错过唤醒
+      std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake.notify_one();
+  }
+
+  bool TaskScheduler::Pop(size_t first_queue, bool own_queue, std::function<void()> &task) {
+    if (_pending.load() == 0u) {
+      return false;
+    }
+    const size_t number_of_queues = _queues.size();
+    for (size_t i = 0u; i < number_of_queues; ++i) {
+      auto &queue = *_queues[(first_queue + i) % number_of_queues];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      // 自己的队列取最新的任务，数据更可能还在缓存中；窃取时取最早的任务
+      if (own_queue && (i == 0u)) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      --_pending;
+      return true;
+    }
+    return false;
+  }
+
+  static void RunTask(std::function<void()> &task) {
+    try {
+      task();
+    } catch (const std::exception &e) {
+      log_error("exception thrown in scheduled task:", e.what());
+    } catch (...) {
+      log_error("unknown exception thrown in scheduled task");
+    }
+    task = nullptr;
+  }
+
+  bool TaskScheduler::RunPendingTask() {
+    std::function<void()> task;
+    const bool is_worker = IsWorkerThread();
+    const size_t first_queue = is_worker ?
+        t_queue_index :
+        _next_queue.load(std::memory_order_relaxed) % _queues.size();
+    if (!Pop(first_queue, is_worker, task)) {
+      return false;
+    }
+    RunTask(task);
+    _task_done.notify_all();
+    return true;
+  }
+
+  void TaskScheduler::Run(const size_t index) {
+    t_scheduler = this;
+    t_queue_index = index;
+    std::function<void()> task;
+    while (true) {
+      if (Pop(index, true, task)) {
+        RunTask(task);
+        _task_done.notify_all();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_sleep_mutex);
+      _wake.wait(lock, [this]() { return _stop || (_pending.load() > 0u); });
+      if (_stop && (_pending.load() == 0u)) {
+        return;
+      }
+    }
+  }
+
+  void TaskGraph::Run(TaskScheduler &scheduler) {
+    if (_nodes.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _completed = 0u;
+      _exception = nullptr;
+    }
+    _failed = false;
+    std::vector<NodeId> roots;
+    for (NodeId id = 0u; id < _nodes.size(); ++id) {
+      _nodes[id]->remaining = _nodes[id]->dependencies;
+      if (_nodes[id]->dependencies == 0u) {
+        roots.push_back(id);
+      }
+    }
+    DEBUG_ASSERT(!roots.empty());
+    for (const NodeId id : roots) {
+      scheduler.Post([this, &scheduler, id]() { Execute(scheduler, id); });
+    }
+    scheduler.WaitUntil([this]() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _completed == _nodes.size();
+    });
+    if (_exception != nullptr) {
+      std::rethrow_exception(_exception);
+    }
+  }
+
+  void TaskGraph::Execute(TaskScheduler &scheduler, const NodeId id) {
+    auto &node = *_nodes[id];
+    if (!_failed) {
+      try {
+        node.task();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_exception == nullptr) {
+          _exception = std::current_exception();
+        }
+        _failed = true;
+      }
+    }
+    // 失败后仍然沿依赖传递，只是不再执行任务，保证 Run 能够等到所有节点
+    for (const NodeId successor : node.successors) {
+      if (--_nodes[successor]->remaining == 0u) {
+        scheduler.Post([this, &scheduler, successor]() { Execute(scheduler, successor); });
+      }
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_completed;
+  }
+
+} // namespace carla
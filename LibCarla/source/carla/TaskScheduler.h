@@ -0,0 +1,318 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+#include "carla/ThreadSettings.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace carla {
+
+  /// 整个进程共用的工作窃取任务调度器。
+  ///
+  /// 每个工作线程有自己的任务队列，工作线程提交的任务放入自己的队列并按后进
+  /// 先出执行，空闲时从其它线程队列的另一端窃取任务；其它线程提交的任务轮流
+  /// 分配到各个队列。地图构建、网格生成、图像转换与交通管理器的各阶段都提交
+  /// 到同一个调度器，进程中的计算线程数不会超过它的线程数。
+  ///
+  /// 等待任务的函数（ParallelFor、Wait、TaskGraph::Run）在等待期间执行队列中
+  /// 的任务，所以可以在工作线程中嵌套调用。
+  class TaskScheduler : private NonCopyable {
+  public:
+
+    /// @a worker_threads 为 0 时使用硬件线程数减一，调用者线程也参与计算。
+    /// 每个工作线程在开始执行任务之前应用 @a settings。
+    explicit TaskScheduler(size_t worker_threads = 0u, const ThreadSettings &settings = {});
+
+    /// 执行完队列中剩余的任务后结束工作线程。
+    ~TaskScheduler();
+
+    /// 进程共用的调度器，第一次调用时创建。
+    static TaskScheduler &Get();
+
+    /// 设置共用调度器的工作线程数与线程设置，必须在第一次调用 Get 之前调用，
+    /// 否则记录警告并返回 false。
+    static bool Configure(size_t worker_threads, const ThreadSettings &settings = {});
+
+    size_t GetNumberOfWorkerThreads() const {
+      return _queues.size();
+    }
+
+    /// 同时参与计算的线程数，包括调用者线程。
+    size_t GetConcurrency() const {
+      return _queues.size() + 1u;
+    }
+
+    /// 调用者线程是否为这个调度器的工作线程。
+    bool IsWorkerThread() const;
+
+    /// 把 @a task 加入队列。任务抛出的异常被记录后忽略。
+    void Post(std::function<void()> task);
+
+    /// 把 @a functor 加入队列，通过返回的 future 获取结果或异常。
+    template <typename FunctorT, typename ResultT = typename std::result_of<FunctorT()>::type>
+    std::future<ResultT> Submit(FunctorT &&functor) {
+      auto task = std::make_shared<std::packaged_task<ResultT()>>(std::forward<FunctorT>(functor));
+      auto future = task->get_future();
+      Post([task]() { (*task)(); });
+      return future;
+    }
+
+    /// 在调用者线程中执行一个队列中的任务，队列为空时返回 false。
+    bool RunPendingTask();
+
+    /// 等待 @a future 就绪，期间执行队列中的任务。与直接调用 future.wait()
+    /// 不同，在工作线程中调用也不会因所有线程都在等待而死锁。
+    template <typename T>
+    void Wait(const std::future<T> &future) {
+      WaitUntil([&]() {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+      });
+    }
+
+    /// 用调度器的线程对 [0, size) 中的每个索引调用 @a functor，不同索引的调用
+    /// 必须互不影响。调用者线程也参与计算，每个线程至少分到
+    /// @a min_elements_per_thread 个索引，最多使用 @a max_threads 个线程（0 表示
+    /// 不限制）。第一个异常在所有参与的线程结束后重新抛出。
+    template <typename FunctorT>
+    void ParallelFor(
+        size_t size,
+        FunctorT &&functor,
+        size_t min_elements_per_thread = 64u,
+        size_t max_threads = 0u);
+
+  private:
+
+    struct WorkerQueue {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    /// 正在进行的 ParallelFor。各线程从计数器中取下一块索引；调用者完成后
+    /// 关闭它并等待已经进入的线程，之后才开始执行的任务不再访问 @a body。
+    struct ParallelForState {
+      ParallelForState(size_t in_size, size_t in_chunk_size, std::function<void(size_t)> in_body)
+        : size(in_size),
+          chunk_size(in_chunk_size),
+          body(std::move(in_body)) {}
+
+      bool Enter() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+          return false;
+        }
+        ++active;
+        return true;
+      }
+
+      void Leave() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--active == 0u) {
+          finished.notify_all();
+        }
+      }
+
+      void Close() {
+        std::unique_lock<std::mutex> lock(mutex);
+        closed = true;
+        finished.wait(lock, [this]() { return active == 0u; });
+      }
+
+      void Work() {
+        for (size_t begin = next_index.fetch_add(chunk_size);
+             begin < size;
+             begin = next_index.fetch_add(chunk_size)) {
+          const size_t end = std::min(begin + chunk_size, size);
+          try {
+            for (size_t i = begin; i < end; ++i) {
+              body(i);
+            }
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (exception == nullptr) {
+              exception = std::current_exception();
+            }
+            next_index.store(size);
+          }
+        }
+      }
+
+      const size_t size;
+
+      const size_t chunk_size;
+
+      const std::function<void(size_t)> body;
+
+      std::atomic<size_t> next_index{0u};
+
+      std::mutex mutex;
+
+      std::condition_variable finished;
+
+      size_t active = 0u;
+
+      bool closed = false;
+
+      std::exception_ptr exception;
+    };
+
+    /// 每个线程平均分到的块数，块越多负载越均衡，但取块的开销越大。
+    static constexpr size_t ChunksPerThread = 8u;
+
+    /// 取一个任务：先取自己队列的末尾，再从其它队列的开头窃取。
+    bool Pop(size_t first_queue, bool own_queue, std::function<void()> &task);
+
+    void Run(size_t index);
+
+    /// 执行队列中的任务直到 @a ready 返回 true，没有任务时短暂等待。
+    template <typename PredicateT>
+    void WaitUntil(PredicateT &&ready) {
+      while (!ready()) {
+        if (!RunPendingTask()) {
+          std::unique_lock<std::mutex> lock(_wait_mutex);
+          _task_done.wait_for(lock, std::chrono::milliseconds(1));
+        }
+      }
+    }
+
+    friend class TaskGraph;
+
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+
+    /// 队列中的任务数。
+    std::atomic<size_t> _pending{0u};
+
+    std::atomic<size_t> _next_queue{0u};
+
+    std::mutex _sleep_mutex;
+
+    std::condition_variable _wake;
+
+    std::mutex _wait_mutex;
+
+    std::condition_variable _task_done;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+  template <typename FunctorT>
+  void TaskScheduler::ParallelFor(
+      const size_t size,
+      FunctorT &&functor,
+      const size_t min_elements_per_thread,
+      const size_t max_threads) {
+    const size_t concurrency = (max_threads == 0u) ?
+        GetConcurrency() :
+        std::min(max_threads, GetConcurrency());
+    const size_t number_of_threads = std::min(
+        concurrency,
+        size / std::max<size_t>(min_elements_per_thread, 1u));
+    if (number_of_threads <= 1u) {
+      for (size_t i = 0u; i < size; ++i) {
+        functor(i);
+      }
+      return;
+    }
+    const size_t chunk_size = std::max<size_t>(size / (number_of_threads * ChunksPerThread), 1u);
+    auto state = std::make_shared<ParallelForState>(
+        size,
+        chunk_size,
+        [&functor](const size_t i) { functor(i); });
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+      Post([state]() {
+        if (state->Enter()) {
+          state->Work();
+          state->Leave();
+        }
+      });
+    }
+    state->Enter();
+    state->Work();
+    state->Leave();
+    // 已经进入的线程只剩下正在执行的块，不需要执行其它任务也能很快结束。
+    state->Close();
+    if (state->exception != nullptr) {
+      std::rethrow_exception(state->exception);
+    }
+  }
+
+  /// 有依赖关系的一组任务，每个任务在它依赖的所有任务完成后才开始执行。
+  ///
+  /// 图必须是无环的，可以多次运行。
+  class TaskGraph : private NonCopyable {
+  public:
+
+    using NodeId = size_t;
+
+    NodeId AddTask(std::function<void()> task) {
+      _nodes.emplace_back(std::make_unique<Node>(std::move(task)));
+      return _nodes.size() - 1u;
+    }
+
+    /// @a after 在 @a before 完成后才开始执行。
+    void Precede(NodeId before, NodeId after) {
+      DEBUG_ASSERT(before < _nodes.size());
+      DEBUG_ASSERT(after < _nodes.size());
+      DEBUG_ASSERT(before != after);
+      _nodes[before]->successors.push_back(after);
+      ++_nodes[after]->dependencies;
+    }
+
+    size_t GetNumberOfTasks() const {
+      return _nodes.size();
+    }
+
+    /// 在 @a scheduler 上执行所有任务，全部完成后返回，期间调用者线程也执行
+    /// 任务。如果有任务抛出异常，尚未开始的任务不再执行，第一个异常在返回前
+    /// 重新抛出。
+    void Run(TaskScheduler &scheduler = TaskScheduler::Get());
+
+  private:
+
+    struct Node {
+      explicit Node(std::function<void()> in_task) : task(std::move(in_task)) {}
+
+      std::function<void()> task;
+
+      std::vector<NodeId> successors;
+
+      size_t dependencies = 0u;
+
+      std::atomic<size_t> remaining{0u};
+    };
+
+    void Execute(TaskScheduler &scheduler, NodeId id);
+
+    std::vector<std::unique_ptr<Node>> _nodes;
+
+    std::mutex _mutex;
+
+    size_t _completed = 0u;
+
+    std::atomic<bool> _failed{false};
+
+    std::exception_ptr _exception;
+  };
+
+} // namespace carla
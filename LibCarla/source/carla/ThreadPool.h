@@ -9,6 +9,7 @@
 #include "carla/MoveHandler.h"   // 引入 MoveHandler，用于在 Boost.Asio 中包装任务
 #include "carla/NonCopyable.h"   // 引入 NonCopyable 类，确保 ThreadPool 不可拷贝
 #include "carla/ThreadGroup.h"   // 引入 ThreadGroup，用于管理工作线程
+#include "carla/ThreadSettings.h"  // 引入 ThreadSettings，用于设置工作线程的亲和性和优先级
 #include "carla/Time.h"          // 引入 Time 类，用于时间相关操作
 
 #include <boost/asio/io_context.hpp>   // 引入 Boost.Asio 的 io_context 类，用于调度异步任务
@@ -47,8 +48,16 @@ namespace carla {
 
     // 启动线程以异步运行任务，可以指定线程数量
     // 如果没有指定数量，则使用硬件的并发线程数
-    void AsyncRun(size_t worker_threads) {
-      _workers.CreateThreads(worker_threads, [this]() { Run(); });
+    // 每个工作线程在开始运行任务之前应用 @a settings
+    void AsyncRun(size_t worker_threads, const ThreadSettings &settings = {}) {
+      if (settings.IsDefault()) {
+        _workers.CreateThreads(worker_threads, [this]() { Run(); });
+        return;
+      }
+      _workers.CreateThreads(worker_threads, [this, settings]() {
+        settings.ApplyToCurrentThread();
+        Run();
+      });
     }
 
     // 调用 AsyncRun 函数，不指定线程数量，默认使用硬件并发线程数
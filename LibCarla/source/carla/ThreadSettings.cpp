@@ -0,0 +1,156 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ThreadSettings.h"
+
+#include "carla/Logging.h"
+#include "carla/StringUtil.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#  include <sys/resource.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace carla {
+
+  static bool ApplyAffinity(const std::vector<size_t> &cpus) {
+    if (cpus.empty()) {
+      return true;
+    }
+#if defined(_WIN32)
+    DWORD_PTR mask = 0u;
+    for (auto cpu : cpus) {
+      if (cpu < sizeof(DWORD_PTR) * 8u) {
+        mask |= (DWORD_PTR(1) << cpu);
+      }
+    }
+    if ((mask == 0u) || (SetThreadAffinityMask(GetCurrentThread(), mask) == 0u)) {
+      log_warning("failed to set thread affinity, error", GetLastError());
+      return false;
+    }
+    return true;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+      if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+      log_warning("failed to set thread affinity:", std::strerror(result));
+      return false;
+    }
+    return true;
+#else
+    log_warning("thread affinity not supported on this platform");
+    return false;
+#endif
+  }
+
+  static bool ApplyPriority(ThreadPriority priority) {
+    if (priority == ThreadPriority::Normal) {
+      return true;
+    }
+#if defined(_WIN32)
+    const int value = (priority == ThreadPriority::Low) ?
+        THREAD_PRIORITY_BELOW_NORMAL :
+        THREAD_PRIORITY_ABOVE_NORMAL;
+    if (!SetThreadPriority(GetCurrentThread(), value)) {
+      log_warning("failed to set thread priority, error", GetLastError());
+      return false;
+    }
+    return true;
+#elif defined(__linux__)
+    // 普通调度策略的线程只能通过 nice 值调整优先级，Linux 上 nice 值是每个线程的
+    const int nice = (priority == ThreadPriority::Low) ? 10 : -5;
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, nice) != 0) {
+      log_warning("failed to set thread priority:", std::strerror(errno));
+      return false;
+    }
+    return true;
+#else
+    log_warning("thread priority not supported on this platform");
+    return false;
+#endif
+  }
+
+  bool ThreadSettings::ApplyToCurrentThread() const {
+    const bool affinity = ApplyAffinity(cpu_affinity);
+    const bool priority_set = ApplyPriority(priority);
+    return affinity && priority_set;
+  }
+
+  static bool ParseNumber(const std::string &str, size_t &number) {
+    if (str.empty() || (str.size() > 6u) ||
+        !std::all_of(str.begin(), str.end(), [](char c) { return (c >= '0') && (c <= '9'); })) {
+      return false;
+    }
+    number = static_cast<size_t>(std::stoul(str));
+    return true;
+  }
+
+  bool ThreadSettings::ParseCpuList(const std::string &str, std::vector<size_t> &cpus) {
+    std::vector<std::string> ranges;
+    StringUtil::Split(ranges, str, ",");
+    std::vector<size_t> result;
+    for (auto &range : ranges) {
+      StringUtil::Trim(range);
+      const auto dash = range.find('-');
+      size_t first = 0u;
+      size_t last = 0u;
+      if (dash == std::string::npos) {
+        if (!ParseNumber(range, first)) {
+          return false;
+        }
+        last = first;
+      } else if (!ParseNumber(range.substr(0u, dash), first) ||
+                 !ParseNumber(range.substr(dash + 1u), last) ||
+                 (last < first)) {
+        return false;
+      }
+      for (auto cpu = first; cpu <= last; ++cpu) {
+        result.emplace_back(cpu);
+      }
+    }
+    if (result.empty()) {
+      return false;
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    cpus = std::move(result);
+    return true;
+  }
+
+  bool ThreadSettings::ParsePriority(const std::string &str, ThreadPriority &priority) {
+    const auto value = StringUtil::ToLowerCopy(str);
+    if (value == "normal") {
+      priority = ThreadPriority::Normal;
+    } else if (value == "low") {
+      priority = ThreadPriority::Low;
+    } else if (value == "high") {
+      priority = ThreadPriority::High;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+} // namespace carla
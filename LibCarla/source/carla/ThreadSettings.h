@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+
+  /// 工作线程的优先级。
+  enum class ThreadPriority : uint8_t {
+    Normal,
+    /// 低于游戏线程和渲染线程，适用于可以延迟的后台工作。
+    Low,
+    /// 高于普通线程，在 Linux 上需要 CAP_SYS_NICE 权限。
+    High
+  };
+
+  /// 线程池中每个工作线程的 CPU 亲和性和优先级。
+  ///
+  /// 默认设置不修改线程，与系统创建的线程相同。
+  struct ThreadSettings {
+    /// 工作线程可以运行的 CPU 编号，空表示不限制。每个线程都绑定到整个集合，
+    /// 由系统在其中调度。
+    std::vector<size_t> cpu_affinity;
+
+    ThreadPriority priority = ThreadPriority::Normal;
+
+    bool IsDefault() const {
+      return cpu_affinity.empty() && (priority == ThreadPriority::Normal);
+    }
+
+    /// 将设置应用于调用者线程。平台不支持或没有权限时记录警告并返回 false，
+    /// 线程保持原来的设置继续运行。
+    bool ApplyToCurrentThread() const;
+
+    /// 解析 "0-3,8,10-11" 形式的 CPU 列表，格式无效时返回 false。
+    static bool ParseCpuList(const std::string &str, std::vector<size_t> &cpus);
+
+    /// 解析 "low"、"normal" 或 "high"，无效时返回 false。
+    static bool ParsePriority(const std::string &str, ThreadPriority &priority);
+  };
+
+} // namespace carla
@@ -9,6 +9,7 @@
 #include "carla/StringUtil.h" // 引入字符串工具类的头文件
 #include "carla/client/detail/ActorFactory.h" // 引入参与者工厂类的头文件
 
+#include <algorithm>
 #include <iterator> // 引入迭代器相关的标准库
 
 namespace carla {
@@ -16,9 +17,11 @@ namespace client {
 
   ActorList::ActorList( // 参与者列表构造函数
       detail::EpisodeProxy episode, // 传入的场景代理对象
-      std::vector<rpc::Actor> actors) // 传入的参与者列表
+      std::vector<rpc::Actor> actors, // 传入的参与者列表
+      bool sorted_by_type_id) // 参与者是否按类型ID排序
     : _episode(std::move(episode)), // 移动语义传递场景代理
-      _actors(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end())) {} // 使用移动迭代器初始化参与者列表
+      _actors(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end())), // 使用移动迭代器初始化参与者列表
+      _sorted_by_type_id(sorted_by_type_id) {}
 
   SharedPtr<Actor> ActorList::Find(const ActorId actor_id) const { // 查找指定ID的参与者
     for (auto &actor : _actors) { // 遍历所有参与者
@@ -30,8 +33,21 @@ namespace client {
   }
 
   SharedPtr<ActorList> ActorList::Filter(const std::string &wildcard_pattern) const { // 根据通配符模式过滤参与者
-    SharedPtr<ActorList> filtered (new ActorList(_episode, {})); // 创建一个新的参与者列表用于存放过滤后的参与者
-    for (auto &&actor : _actors) { // 遍历所有参与者
+    SharedPtr<ActorList> filtered (new ActorList(_episode, {}, _sorted_by_type_id)); // 创建一个新的参与者列表用于存放过滤后的参与者
+    auto first = _actors.begin();
+    auto last = _actors.end();
+    if (_sorted_by_type_id) {
+      // 只访问类型 ID 以通配符之前的前缀开头的参与者
+      const auto prefix = StringUtil::GetWildcardPrefix(wildcard_pattern);
+      first = std::lower_bound(first, last, prefix, [](const auto &actor, const auto &value) {
+        return actor.GetTypeId() < value;
+      });
+      last = std::find_if(first, last, [&](const auto &actor) {
+        return !StringUtil::StartsWith(actor.GetTypeId(), prefix);
+      });
+    }
+    for (auto it = first; it != last; ++it) { // 遍历所有参与者
+      auto &actor = *it;
       if (StringUtil::Match(actor.GetTypeId(), wildcard_pattern)) { // 如果参与者类型与通配符匹配
         filtered->_actors.push_back(actor); // 将匹配的参与者加入到过滤后的列表中
       }
@@ -62,11 +62,18 @@ namespace client { // 开始 client 命名空间
 
     friend class World; // 声明 World 类为友元类
 
-    ActorList(detail::EpisodeProxy episode, std::vector<rpc::Actor> actors); // 构造函数，接受 EpisodeProxy 和 Actor 向量
+    /// @param sorted_by_type_id @a actors 是否已按类型 ID 排序，排序的列表
+    /// 过滤时只访问类型 ID 前缀匹配的参与者。
+    ActorList(
+        detail::EpisodeProxy episode,
+        std::vector<rpc::Actor> actors,
+        bool sorted_by_type_id = false); // 构造函数，接受 EpisodeProxy 和 Actor 向量
 
     detail::EpisodeProxy _episode; // 存储 EpisodeProxy 对象
 
     std::vector<detail::ActorVariant> _actors; // 存储 ActorVariant 对象的向量
+
+    bool _sorted_by_type_id = false;
   };
 
 } // namespace client
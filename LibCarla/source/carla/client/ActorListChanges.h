@@ -0,0 +1,34 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 自上一次查询以来剧集中出现和销毁的参与者，见 World::GetActorListChanges。
+  struct ActorListChanges {
+
+    /// 下一次查询时传入的序号。
+    uint64_t sequence = 0u;
+
+    /// 为 false 时客户端没有保留足够的历史（或者剧集已经改变），spawned 和
+    /// destroyed 为空，调用者需要重新获取完整的参与者列表。
+    bool complete = true;
+
+    /// 新出现的参与者，其中不包括随后又被销毁的。
+    std::vector<rpc::ActorId> spawned;
+
+    std::vector<rpc::ActorId> destroyed;
+  };
+
+} // namespace client
+} // namespace carla
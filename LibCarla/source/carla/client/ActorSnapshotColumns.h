@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/client/ActorSnapshot.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/rpc/ActorId.h"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 按列存储的快照中所有参与者的状态。
+  ///
+  /// 每一列都是连续的 float 数组，第 i 行对应 GetIds()[i]，参与者按 ID
+  /// 升序排列。适合一次处理大量参与者，例如在 Python 中作为 numpy 数组使用。
+  class ActorSnapshotColumns : private NonCopyable {
+  public:
+
+    /// 每个变换在 GetTransforms() 中占用的 float 数量：x、y、z、pitch、yaw、roll。
+    static constexpr size_t TRANSFORM_SIZE = 6u;
+
+    /// 每个向量在其他列中占用的 float 数量：x、y、z。
+    static constexpr size_t VECTOR_SIZE = 3u;
+
+    template <typename IteratorT>
+    ActorSnapshotColumns(IteratorT begin, IteratorT end) {
+      std::vector<const ActorSnapshot *> snapshots;
+      for (; begin != end; ++begin) {
+        snapshots.emplace_back(&*begin);
+      }
+      std::sort(snapshots.begin(), snapshots.end(), [](auto *lhs, auto *rhs) {
+        return lhs->id < rhs->id;
+      });
+      const auto count = snapshots.size();
+      _ids.reserve(count);
+      _transforms.reserve(TRANSFORM_SIZE * count);
+      _velocities.reserve(VECTOR_SIZE * count);
+      _angular_velocities.reserve(VECTOR_SIZE * count);
+      _accelerations.reserve(VECTOR_SIZE * count);
+      for (auto *snapshot : snapshots) {
+        const auto &location = snapshot->transform.location;
+        const auto &rotation = snapshot->transform.rotation;
+        _ids.emplace_back(snapshot->id);
+        _transforms.insert(_transforms.end(), {
+            location.x, location.y, location.z,
+            rotation.pitch, rotation.yaw, rotation.roll});
+        Append(_velocities, snapshot->velocity);
+        Append(_angular_velocities, snapshot->angular_velocity);
+        Append(_accelerations, snapshot->acceleration);
+      }
+    }
+
+    size_t size() const {
+      return _ids.size();
+    }
+
+    /// 参与者 @a id 所在的行。
+    boost::optional<size_t> FindIndex(ActorId id) const {
+      auto it = std::lower_bound(_ids.begin(), _ids.end(), id);
+      if ((it == _ids.end()) || (*it != id)) {
+        return boost::none;
+      }
+      return static_cast<size_t>(it - _ids.begin());
+    }
+
+    const std::vector<ActorId> &GetIds() const {
+      return _ids;
+    }
+
+    /// 每行 TRANSFORM_SIZE 个 float，单位为米和度。
+    const std::vector<float> &GetTransforms() const {
+      return _transforms;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，单位为 m/s。
+    const std::vector<float> &GetVelocities() const {
+      return _velocities;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，单位为 deg/s。
+    const std::vector<float> &GetAngularVelocities() const {
+      return _angular_velocities;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，单位为 m/s^2。
+    const std::vector<float> &GetAccelerations() const {
+      return _accelerations;
+    }
+
+  private:
+
+    static void Append(std::vector<float> &column, const geom::Vector3D &vector) {
+      column.insert(column.end(), {vector.x, vector.y, vector.z});
+    }
+
+    std::vector<ActorId> _ids;
+
+    std::vector<float> _transforms;
+
+    std::vector<float> _velocities;
+
+    std::vector<float> _angular_velocities;
+
+    std::vector<float> _accelerations;
+  };
+
+} // namespace client
+} // namespace carla
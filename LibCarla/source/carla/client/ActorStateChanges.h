@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/TrafficLightState.h"
+#include "carla/rpc/VehicleLightState.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 一帧中参与者的变化，由客户端比较连续的剧集状态得到，见 World::OnActorChanges。
+  struct ActorStateChanges {
+
+    struct TrafficLightChange {
+      rpc::ActorId id;
+      rpc::TrafficLightState previous;
+      rpc::TrafficLightState state;
+    };
+
+    struct VehicleLightChange {
+      rpc::ActorId id;
+      rpc::VehicleLightState::flag_type previous;
+      rpc::VehicleLightState::flag_type state;
+    };
+
+    uint64_t frame = 0u;
+
+    /// 为 true 时剧集已经改变，之前的参与者都在 destroyed 中。
+    bool episode_changed = false;
+
+    std::vector<rpc::ActorId> spawned;
+
+    std::vector<rpc::ActorId> destroyed;
+
+    /// 与上一次报告的位置相距超过阈值的参与者，新出现的参与者不在其中。
+    std::vector<rpc::ActorId> moved;
+
+    std::vector<TrafficLightChange> traffic_lights;
+
+    std::vector<VehicleLightChange> vehicle_lights;
+
+    bool empty() const {
+      return !episode_changed &&
+          spawned.empty() &&
+          destroyed.empty() &&
+          moved.empty() &&
+          traffic_lights.empty() &&
+          vehicle_lights.empty();
+    }
+  };
+
+} // namespace client
+} // namespace carla
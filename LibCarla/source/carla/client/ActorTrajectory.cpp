@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/ActorTrajectory.h"
+
+#include <cmath>
+
+namespace carla {
+namespace client {
+
+  // 两个角度（度）之差，取 [-180, 180) 中的值。
+  static double AngleDifference(double to, double from) {
+    const double difference = std::fmod(to - from + 180.0, 360.0);
+    return (difference < 0.0 ? difference + 360.0 : difference) - 180.0;
+  }
+
+  // 计算第 i 个样本上一个分量的一阶和二阶导数，@a value(j) 返回第 j 个样本相对于
+  // 第 i 个样本的值。
+  template <typename ValueT>
+  static void Differentiate(
+      const std::vector<double> &t,
+      size_t i,
+      ValueT &&value,
+      float &first,
+      float &second) {
+    const size_t n = t.size();
+    // 两端使用最近的三个样本
+    const size_t center = (i == 0u) ? 1u : ((i == n - 1u) ? n - 2u : i);
+    if (n < 3u) {
+      const double dt = t[1u] - t[0u];
+      first = (dt > 0.0) ? static_cast<float>((value(1u) - value(0u)) / dt) : 0.0f;
+      second = 0.0f;
+      return;
+    }
+    const double h1 = t[center] - t[center - 1u];
+    const double h2 = t[center + 1u] - t[center];
+    if ((h1 <= 0.0) || (h2 <= 0.0)) {
+      first = 0.0f;
+      second = 0.0f;
+      return;
+    }
+    const double v0 = value(center - 1u);
+    const double v1 = value(center);
+    const double v2 = value(center + 1u);
+    const double d1 = (v1 - v0) / h1;
+    const double d2 = (v2 - v1) / h2;
+    second = static_cast<float>(2.0 * (d2 - d1) / (h1 + h2));
+    if (i == center) {
+      first = static_cast<float>((h1 * d2 + h2 * d1) / (h1 + h2));
+    } else if (i < center) {
+      first = static_cast<float>(d1 - h1 * (d2 - d1) / (h1 + h2));
+    } else {
+      first = static_cast<float>(d2 + h2 * (d2 - d1) / (h1 + h2));
+    }
+  }
+
+  ActorTrajectoryDerivatives ActorTrajectory::ComputeDerivatives() const {
+    const size_t n = size();
+    ActorTrajectoryDerivatives result;
+    result.velocities.assign(VECTOR_SIZE * n, 0.0f);
+    result.accelerations.assign(VECTOR_SIZE * n, 0.0f);
+    result.rotation_rates.assign(VECTOR_SIZE * n, 0.0f);
+    if (n < 2u) {
+      return result;
+    }
+    for (size_t i = 0u; i < n; ++i) {
+      for (size_t axis = 0u; axis < VECTOR_SIZE; ++axis) {
+        const size_t row = VECTOR_SIZE * i + axis;
+        Differentiate(_timestamps, i, [&](size_t j) {
+          return static_cast<double>(_transforms[TRANSFORM_SIZE * j + axis]);
+        }, result.velocities[row], result.accelerations[row]);
+        // 以第 i 个样本为参考展开角度，避免跳变
+        const double reference = _transforms[TRANSFORM_SIZE * i + VECTOR_SIZE + axis];
+        float unused;
+        Differentiate(_timestamps, i, [&](size_t j) {
+          return AngleDifference(_transforms[TRANSFORM_SIZE * j + VECTOR_SIZE + axis], reference);
+        }, result.rotation_rates[row], unused);
+      }
+    }
+    return result;
+  }
+
+  void ActorTrajectory::Reserve(const size_t count) {
+    _frames.reserve(count);
+    _timestamps.reserve(count);
+    _transforms.reserve(TRANSFORM_SIZE * count);
+    _velocities.reserve(VECTOR_SIZE * count);
+    _angular_velocities.reserve(VECTOR_SIZE * count);
+    _accelerations.reserve(VECTOR_SIZE * count);
+  }
+
+  void ActorTrajectory::Append(
+      const uint64_t frame,
+      const double timestamp,
+      const float *transform,
+      const float *velocity,
+      const float *angular_velocity,
+      const float *acceleration) {
+    _frames.emplace_back(frame);
+    _timestamps.emplace_back(timestamp);
+    _transforms.insert(_transforms.end(), transform, transform + TRANSFORM_SIZE);
+    _velocities.insert(_velocities.end(), velocity, velocity + VECTOR_SIZE);
+    _angular_velocities.insert(_angular_velocities.end(), angular_velocity, angular_velocity + VECTOR_SIZE);
+    _accelerations.insert(_accelerations.end(), acceleration, acceleration + VECTOR_SIZE);
+  }
+
+} // namespace client
+} // namespace carla
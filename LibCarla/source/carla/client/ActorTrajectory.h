@@ -0,0 +1,126 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 一个参与者在一段时间内的有限差分导数，由 ActorTrajectory::ComputeDerivatives
+  /// 计算。每一列的第 i 行对应轨迹的第 i 个样本。
+  struct ActorTrajectoryDerivatives {
+
+    /// 由位置计算的速度，每行 x、y、z，单位为 m/s。
+    std::vector<float> velocities;
+
+    /// 由位置计算的加速度，每行 x、y、z，单位为 m/s^2。
+    std::vector<float> accelerations;
+
+    /// 由旋转计算的欧拉角变化率，每行 pitch、yaw、roll，单位为 deg/s。角度的跳变
+    /// （例如 yaw 从 179 到 -179）按最短的方向计算。
+    std::vector<float> rotation_rates;
+  };
+
+  /// 按列存储的一个参与者在一段时间内的状态，见 World::GetActorTrajectory。
+  ///
+  /// 样本按时间升序排列，只包含参与者存在的帧。每一列都是连续的数组，适合在
+  /// Python 中作为 numpy 数组使用。
+  class ActorTrajectory : private NonCopyable {
+  public:
+
+    /// 每个变换在 GetTransforms() 中占用的 float 数量：x、y、z、pitch、yaw、roll。
+    static constexpr size_t TRANSFORM_SIZE = 6u;
+
+    /// 每个向量在其他列中占用的 float 数量：x、y、z。
+    static constexpr size_t VECTOR_SIZE = 3u;
+
+    explicit ActorTrajectory(ActorId id) : _id(id) {}
+
+    ActorId GetId() const {
+      return _id;
+    }
+
+    size_t size() const {
+      return _frames.size();
+    }
+
+    bool empty() const {
+      return _frames.empty();
+    }
+
+    const std::vector<uint64_t> &GetFrames() const {
+      return _frames;
+    }
+
+    /// 每个样本的模拟时间（秒），与 Timestamp::elapsed_seconds 相同。
+    const std::vector<double> &GetTimestamps() const {
+      return _timestamps;
+    }
+
+    /// 每行 TRANSFORM_SIZE 个 float，单位为米和度。
+    const std::vector<float> &GetTransforms() const {
+      return _transforms;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，服务器报告的速度，单位为 m/s。
+    const std::vector<float> &GetVelocities() const {
+      return _velocities;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，单位为 deg/s。
+    const std::vector<float> &GetAngularVelocities() const {
+      return _angular_velocities;
+    }
+
+    /// 每行 VECTOR_SIZE 个 float，单位为 m/s^2。
+    const std::vector<float> &GetAccelerations() const {
+      return _accelerations;
+    }
+
+    /// 在样本的时间上计算位置和旋转的有限差分。内部的样本使用相邻两个样本
+    /// （非均匀的中心差分），两端使用单侧差分；少于两个样本时导数为 0，少于
+    /// 三个样本时加速度为 0。
+    ActorTrajectoryDerivatives ComputeDerivatives() const;
+
+    /// 预留 @a count 个样本的空间。
+    void Reserve(size_t count);
+
+    /// 在末尾添加一个样本，@a transform 为 TRANSFORM_SIZE 个 float，其余为
+    /// VECTOR_SIZE 个 float。
+    void Append(
+        uint64_t frame,
+        double timestamp,
+        const float *transform,
+        const float *velocity,
+        const float *angular_velocity,
+        const float *acceleration);
+
+  private:
+
+    ActorId _id;
+
+    std::vector<uint64_t> _frames;
+
+    std::vector<double> _timestamps;
+
+    std::vector<float> _transforms;
+
+    std::vector<float> _velocities;
+
+    std::vector<float> _angular_velocities;
+
+    std::vector<float> _accelerations;
+  };
+
+} // namespace client
+} // namespace carla
@@ -7,63 +7,176 @@
 #include "carla/client/BlueprintLibrary.h"
 
 #include "carla/Exception.h"
+#include "carla/StringUtil.h"
 
 #include <algorithm>
 #include <iterator>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
 
 namespace carla {
 namespace client {
+
+  /// 索引中的（id 或标签，蓝图）。
+  using IndexEntry = std::pair<std::string, const ActorBlueprint *>;
+
+  /// 每个库缓存的结果数量上限，超出时清空。
+  static constexpr size_t MAX_CACHED_RESULTS = 256u;
+
+  /// 过滤用的索引，只读取库中的蓝图，库本身不会被修改。
+  struct BlueprintLibrary::FilterIndex {
+
+    std::once_flag built;
+
+    /// 按 id 排序。
+    std::vector<IndexEntry> ids;
+
+    /// 按标签排序。
+    std::vector<IndexEntry> tags;
+
+    /// 以属性名和值（中间用 '\0' 分隔）为键的蓝图。
+    std::unordered_map<std::string, std::vector<const_pointer>> attributes;
+
+    std::mutex cache_mutex;
+
+    std::unordered_map<std::string, SharedPtr<BlueprintLibrary>> filter_cache;
+
+    std::unordered_map<std::string, SharedPtr<BlueprintLibrary>> attribute_cache;
+  };
+
+  static std::string MakeAttributeKey(const std::string &name, const std::string &value) {
+    std::string key;
+    key.reserve(name.size() + value.size() + 1u);
+    key.append(name).append(1u, '\0').append(value);
+    return key;
+  }
+
+  // 模式中第一个通配符之前的部分，所有匹配的字符串都以它开头。
+  static std::string GetLiteralPrefix(const std::string &wildcard_pattern) {
+#ifdef _WIN32
+    // PathMatchSpecA 不区分大小写，不能按前缀查找
+    (void) wildcard_pattern;
+    return {};
+#else
+    return wildcard_pattern.substr(0u, wildcard_pattern.find_first_of("*?[\\"));
+#endif // _WIN32
+  }
+
+  // 在排序的 @a entries 中匹配模式，只检查以 @a prefix 开头的项。
+  template <typename MatchT>
+  static void CollectMatches(
+      const std::vector<IndexEntry> &entries,
+      const std::string &prefix,
+      const std::string &wildcard_pattern,
+      MatchT &&add) {
+    auto it = std::lower_bound(entries.begin(), entries.end(), prefix, [](const auto &entry, const std::string &key) {
+      return entry.first < key;
+    });
+    for (; (it != entries.end()) && (it->first.compare(0u, prefix.size(), prefix) == 0); ++it) {
+      if (StringUtil::Match(it->first, wildcard_pattern)) {
+        add(it->second);
+      }
+    }
+  }
+
+  // 在缓存中查找 @a key，没有时用 @a make 生成结果并缓存。
+  template <typename MakeT>
+  static SharedPtr<BlueprintLibrary> GetCached(
+      std::mutex &mutex,
+      std::unordered_map<std::string, SharedPtr<BlueprintLibrary>> &cache,
+      const std::string &key,
+      MakeT &&make) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = cache.find(key);
+      if (it != cache.end()) {
+        return it->second;
+      }
+    }
+    auto result = make();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cache.size() >= MAX_CACHED_RESULTS) {
+      cache.clear();
+    }
+    cache.emplace(key, result);
+    return result;
+  }
 //构造函数：使用给定的蓝图列表初始化 BlueprintLibary
   BlueprintLibrary::BlueprintLibrary(
-      const std::vector<rpc::ActorDefinition> &blueprints) {
+      const std::vector<rpc::ActorDefinition> &blueprints)
+    : _index(std::make_shared<FilterIndex>()) {
     _blueprints.reserve(blueprints.size()); //预留空间以存储蓝图
     for (auto &definition : blueprints) {
       _blueprints.emplace(definition.id, ActorBlueprint{definition});
       //将蓝图添加到映射中
     }
   }
+
+  BlueprintLibrary::BlueprintLibrary(map_type blueprints)
+    : _blueprints(std::move(blueprints)),
+      _index(std::make_shared<FilterIndex>()) {}
+
+  BlueprintLibrary::FilterIndex &BlueprintLibrary::GetIndex() const {
+    DEBUG_ASSERT(_index != nullptr);
+    std::call_once(_index->built, [this]() {
+      auto &index = *_index;
+      index.ids.reserve(_blueprints.size());
+      for (auto &pair : _blueprints) {
+        const ActorBlueprint &blueprint = pair.second;
+        index.ids.emplace_back(pair.first, &blueprint);
+        for (auto &tag : blueprint.GetTags()) {
+          index.tags.emplace_back(std::move(tag), &blueprint);
+        }
+        for (const ActorAttribute &attribute : blueprint) {
+          const auto &values = attribute.GetRecommendedValues();
+          if (values.empty()) {
+            index.attributes[MakeAttributeKey(attribute.GetId(), attribute.GetValue())].emplace_back(&blueprint);
+          } else {
+            // 避免重复的推荐值使蓝图出现两次
+            for (auto &value : std::unordered_set<std::string>(values.begin(), values.end())) {
+              index.attributes[MakeAttributeKey(attribute.GetId(), value)].emplace_back(&blueprint);
+            }
+          }
+        }
+      }
+      auto by_key = [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; };
+      std::sort(index.ids.begin(), index.ids.end(), by_key);
+      std::sort(index.tags.begin(), index.tags.end(), by_key);
+    });
+    return *_index;
+  }
 //根据通配符模式过滤蓝图，返回匹配的 BlueprintLibrary
   SharedPtr<BlueprintLibrary> BlueprintLibrary::Filter(
       const std::string &wildcard_pattern) const {
-    map_type result; //存储过滤结果的映射
-    for (auto &pair : _blueprints) {
-      if (pair.second.MatchTags(wildcard_pattern)) { //检查蓝图是否匹配通配符模式
-        result.emplace(pair); //如果匹配，则将其添加到结果中
-      }
-    }
-    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(result)};
-    //返回过滤后的蓝图库
+    auto &index = GetIndex();
+    return GetCached(index.cache_mutex, index.filter_cache, wildcard_pattern, [&]() {
+      const auto prefix = GetLiteralPrefix(wildcard_pattern);
+      map_type result; //存储过滤结果的映射，同时匹配 id 和标签的蓝图只添加一次
+      auto add = [&](const_pointer blueprint) {
+        result.emplace(blueprint->GetId(), *blueprint);
+      };
+      CollectMatches(index.ids, prefix, wildcard_pattern, add);
+      CollectMatches(index.tags, prefix, wildcard_pattern, add);
+      return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(std::move(result))};
+    });
   }
 //根据指定属性名称和值过滤蓝图，返回匹配的 BlueprintLibrary
   SharedPtr<BlueprintLibrary> BlueprintLibrary::FilterByAttribute(
       const std::string &name, const std::string& value) const {
-    map_type result; //存储过滤结果的映射
-
-    for (auto &pair : _blueprints) {
-      if (!pair.second.ContainsAttribute(name))
-        continue; //如果蓝图不包含指定的属性，则跳过
-      const ActorAttribute &Attribute = pair.second.GetAttribute(name); //获取指定的属性
-      const std::vector<std::string> &Values = Attribute.GetRecommendedValues();//获取推荐值
-      if (Values.empty()) //如果值为空
-      {
-        const std::string &AttributeValue = Attribute.GetValue(); //获取属性当前值
-        if (value == AttributeValue) //如果值匹配
-          result.emplace(pair); //将蓝图添加到结果中
-      }
-      else
-      {
-        for (const std::string &Value : Values) //如果有推荐值，逐个排查
-        {
-          if (Value == value) //如果找到匹配的推荐值
-          {
-            result.emplace(pair); //将蓝图添加到结果中
-            break; //退出循环
-          }
+    auto &index = GetIndex();
+    const auto key = MakeAttributeKey(name, value);
+    return GetCached(index.cache_mutex, index.attribute_cache, key, [&]() {
+      map_type result; //存储过滤结果的映射
+      auto it = index.attributes.find(key);
+      if (it != index.attributes.end()) {
+        result.reserve(it->second.size());
+        for (auto *blueprint : it->second) {
+          result.emplace(blueprint->GetId(), *blueprint);
         }
       }
-
-    }
-    return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(result)}; //返回过滤后的蓝图库
+      return SharedPtr<BlueprintLibrary>{new BlueprintLibrary(std::move(result))};
+    });
   }
 
   BlueprintLibrary::const_pointer BlueprintLibrary::Find(const std::string &key) const {
@@ -12,6 +12,7 @@
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorBlueprint.h"
 
+#include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -40,7 +41,13 @@ namespace client {
     BlueprintLibrary &operator=(BlueprintLibrary &&) = default;
 
     /// 过滤 id 或标签与 @a wildcard_pattern 匹配的 ActorBlueprint 列表。
+    ///
+    /// 第一次过滤时建立按 id、标签和属性值排序的索引，只检查与模式中第一个通配符
+    /// 之前的部分前缀相同的 id 和标签；相同模式的结果会被缓存，返回同一个库。
     SharedPtr<BlueprintLibrary> Filter(const std::string &wildcard_pattern) const;
+
+    /// 过滤属性 @a name 的推荐值（没有推荐值时为当前值）包含 @a value 的
+    /// ActorBlueprint 列表，使用与 Filter 相同的索引和缓存。
     SharedPtr<BlueprintLibrary> FilterByAttribute(const std::string &name, const std::string& value) const;
 
     const_pointer Find(const std::string &key) const;
@@ -76,10 +83,17 @@ namespace client {
 
   private:
 
-    BlueprintLibrary(map_type blueprints)
-      : _blueprints(std::move(blueprints)) {}
+    struct FilterIndex;
+
+    BlueprintLibrary(map_type blueprints);
+
+    /// 第一次调用时建立索引。
+    FilterIndex &GetIndex() const;
 
     map_type _blueprints;
+
+    /// 指向 _blueprints 中的元素，随库一起移动，元素地址不变。
+    std::shared_ptr<FilterIndex> _index;
   };
 
 } // namespace client
@@ -65,14 +65,18 @@ namespace client {
     // 获取所需的文件列表。
     // 调用_simulator对象的GetRequiredFiles方法，传入文件夹路径和是否下载的标志。
     // 如果folder参数为空字符串，则使用默认路径。
-    // 如果download参数为true，则在需要时下载文件。
-    std::vector<std::string> GetRequiredFiles(const std::string &folder = "", const bool download = true) const {
-      return _simulator->GetRequiredFiles(folder, download);
+    // 如果download参数为true，则在需要时下载文件，每收到一块数据调用一次progress。
+    std::vector<std::string> GetRequiredFiles(
+        const std::string &folder = "",
+        const bool download = true,
+        const FileTransfer::ProgressCallback &progress = {}) const {
+      return _simulator->GetRequiredFiles(folder, download, progress);
     }
     // 请求一个文件。
-    // 调用_simulator对象的RequestFile方法，传入文件名。
-    void RequestFile(const std::string &name) const {
-      _simulator->RequestFile(name);
+    // 调用_simulator对象的RequestFile方法，传入文件名。本地缓存中的文件内容
+    // 相同时不下载，中断的下载从中断处继续。
+    void RequestFile(const std::string &name, const FileTransfer::ProgressCallback &progress = {}) const {
+      _simulator->RequestFile(name, progress);
     }
     // 重新加载世界环境。
     // 调用_simulator对象的ReloadEpisode方法，并根据参数决定是否重置设置。
@@ -81,6 +85,12 @@ namespace client {
       return World{_simulator->ReloadEpisode(reset_settings)};
     }
 
+    // 不重新加载地图而重新开始当前的场景。
+    // 销毁场景中生成的所有 actor，重置交通信号灯、天气和时间，地图的资源和导航网格保持加载。
+    World SoftResetWorld(bool reset_settings = true) const {
+      return World{_simulator->SoftResetEpisode(reset_settings)};
+    }
+
     // 加载场景世界
     World LoadWorld(
         std::string map_name,           // 地图名
@@ -132,8 +142,21 @@ namespace client {
     }
 
     // 启用记录功能，该功能将开始保存服务器重放仿真所需的所有信息。
-    std::string StartRecorder(std::string name, bool additional_data = false) {
-      return _simulator->StartRecorder(name, additional_data);
+    // compressed 为 true 时，记录文件按块用 zlib 压缩，由后台线程写入磁盘。
+    std::string StartRecorder(std::string name, bool additional_data = false, bool compressed = false) {
+      return _simulator->StartRecorder(name, additional_data, compressed);
+    }
+
+    // 启用“黑匣子”记录：只在内存中保留最近 seconds 秒。触发时（或发生碰撞时）
+    // 把这几秒连同之后的 seconds_after 秒写入新文件（name 加上序号）。
+    std::string StartFlightRecorder(std::string name, double seconds, double seconds_after,
+        bool additional_data = false, bool compressed = false) {
+      return _simulator->StartFlightRecorder(name, seconds, seconds_after, additional_data, compressed);
+    }
+
+    // 触发“黑匣子”记录，返回开始写入的文件名（已在写入时为空）。
+    std::string TriggerFlightRecorder(void) {
+      return _simulator->TriggerFlightRecorder();
     }
 
     // 停止记录日志数据
@@ -190,6 +213,21 @@ namespace client {
       _simulator->SetReplayerIgnoreSpectator(ignore_spectator);
     }
 
+    // 回放时直接瞬移演员，不进行物理更新（仅用于观看回放）。
+    void SetReplayerSkipPhysics(bool skip_physics) {
+      _simulator->SetReplayerSkipPhysics(skip_physics);
+    }
+
+    // 每次 tick 回放一个记录帧（忽略时间因子，不插值），用于确定性地逐帧采集传感器数据。
+    void SetReplayerFrameStep(bool frame_step) {
+      _simulator->SetReplayerFrameStep(frame_step);
+    }
+
+    // 返回回放程序最后处理的记录帧的 id。
+    uint64_t GetReplayerFrame() const {
+      return _simulator->GetReplayerFrame();
+    }
+
     // 在单个模拟步上执行命令列表，不检索任何信息。
     void ApplyBatch(
         std::vector<rpc::Command> commands,
@@ -209,6 +247,26 @@ namespace client {
       return responses;
     }
 
+    // 发出一个命令列表但不等待执行结果，返回 command.Response 列表的 future。
+    // 同一连接上可以同时有多批尚未返回的命令，可用于流水线式地发出大量请求。
+    RpcFuture<std::vector<rpc::CommandResponse>> ApplyBatchAsync(
+        std::vector<rpc::Command> commands) const {
+      return _simulator->ApplyBatchAsync(std::move(commands), false);
+    }
+
+    // 在一次调用中生成一批演员，返回每个演员的 command.Response，顺序与
+    // batch.entries 相同。每种蓝图只需在 batch.descriptions 中出现一次，
+    // 比逐个执行 SpawnActor 命令快得多。
+    std::vector<rpc::CommandResponse> SpawnActors(const rpc::ActorSpawnBatch &batch) const {
+      return _simulator->SpawnActors(batch);
+    }
+
+    // 与 SpawnActors 相同，但不等待结果。
+    RpcFuture<std::vector<rpc::CommandResponse>> SpawnActorsAsync(
+        const rpc::ActorSpawnBatch &batch) const {
+      return _simulator->SpawnActorsAsync(batch);
+    }
+
   private:
 
     std::shared_ptr<detail::Simulator> _simulator;  // 当前仿真器的智能指针
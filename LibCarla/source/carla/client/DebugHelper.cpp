@@ -136,5 +136,71 @@ namespace client {
     DrawShape(_episode, string, color, life_time, persistent_lines); // 调用绘制形状
   }
 
+  void DebugHelper::ShapeBatch::AddPoint(
+      const geom::Location &location,
+      float size,
+      sensor::data::Color color,
+      float life_time,
+      bool persistent_lines) {
+    _shapes.push_back(Shape{Shape::Point{location, size}, color, life_time, persistent_lines});
+  }
+
+  void DebugHelper::ShapeBatch::AddLine(
+      const geom::Location &begin,
+      const geom::Location &end,
+      float thickness,
+      sensor::data::Color color,
+      float life_time,
+      bool persistent_lines) {
+    _shapes.push_back(Shape{Shape::Line{begin, end, thickness}, color, life_time, persistent_lines});
+  }
+
+  void DebugHelper::ShapeBatch::AddArrow(
+      const geom::Location &begin,
+      const geom::Location &end,
+      float thickness,
+      float arrow_size,
+      sensor::data::Color color,
+      float life_time,
+      bool persistent_lines) {
+    Shape::Line line{begin, end, thickness};
+    _shapes.push_back(Shape{Shape::Arrow{line, arrow_size}, color, life_time, persistent_lines});
+  }
+
+  void DebugHelper::ShapeBatch::AddBox(
+      const geom::BoundingBox &box,
+      const geom::Rotation &rotation,
+      float thickness,
+      sensor::data::Color color,
+      float life_time,
+      bool persistent_lines) {
+    _shapes.push_back(Shape{Shape::Box{box, rotation, thickness}, color, life_time, persistent_lines});
+  }
+
+  void DebugHelper::ShapeBatch::AddString(
+      const geom::Location &location,
+      const std::string &text,
+      bool draw_shadow,
+      sensor::data::Color color,
+      float life_time,
+      bool persistent_lines) {
+    _shapes.push_back(Shape{Shape::String{location, text, draw_shadow}, color, life_time, persistent_lines});
+  }
+
+  // 批量绘制，整组形状只需一次 RPC
+  void DebugHelper::DrawShapes(const ShapeBatch &batch) {
+    if (!batch.empty()) {
+      _episode.Lock()->DrawDebugShapes(batch._shapes);
+    }
+  }
+
+  DebugHelper::ShapeGroupId DebugHelper::DrawShapeGroup(const ShapeBatch &batch, ShapeGroupId group) {
+    return _episode.Lock()->DrawDebugShapeGroup(batch._shapes, group);
+  }
+
+  void DebugHelper::ClearShapeGroup(ShapeGroupId group) {
+    _episode.Lock()->ClearDebugShapeGroup(group);
+  }
+
 } // namespace client
 } // namespace carla
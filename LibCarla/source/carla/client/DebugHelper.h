@@ -10,6 +10,7 @@
 #include "carla/geom/BoundingBox.h"              // 包含 BoundingBox 的头文件
 #include "carla/geom/Location.h"                 // 包含 Location 的头文件
 #include "carla/geom/Rotation.h"                 // 包含 Rotation 的头文件
+#include "carla/rpc/DebugShape.h"                // 包含 DebugShape 的头文件
 #include "carla/sensor/data/Color.h"             // 包含 Color 数据类型的头文件
 
 namespace carla {
@@ -105,6 +106,85 @@ namespace client {
         float life_time = -1.0f,          // 字符串的生命周期，默认值为无限
         bool persistent_lines = true);     // 是否绘制持久线
 
+    /// 一组调试形状，由 DrawShapes 或 DrawShapeGroup 在一次 RPC 中发送，
+    /// 参数与对应的 Draw* 函数相同。
+    class ShapeBatch {
+    public:
+
+      void AddPoint(
+          const geom::Location &location,
+          float size = 0.1f,
+          Color color = Color{255u, 0u, 0u},
+          float life_time = -1.0f,
+          bool persistent_lines = true);
+
+      void AddLine(
+          const geom::Location &begin,
+          const geom::Location &end,
+          float thickness = 0.1f,
+          Color color = Color{255u, 0u, 0u},
+          float life_time = -1.0f,
+          bool persistent_lines = true);
+
+      void AddArrow(
+          const geom::Location &begin,
+          const geom::Location &end,
+          float thickness = 0.1f,
+          float arrow_size = 0.1f,
+          Color color = Color{255u, 0u, 0u},
+          float life_time = -1.0f,
+          bool persistent_lines = true);
+
+      void AddBox(
+          const geom::BoundingBox &box,
+          const geom::Rotation &rotation,
+          float thickness = 0.1f,
+          Color color = Color{255u, 0u, 0u},
+          float life_time = -1.0f,
+          bool persistent_lines = true);
+
+      void AddString(
+          const geom::Location &location,
+          const std::string &text,
+          bool draw_shadow = false,
+          Color color = Color{255u, 0u, 0u},
+          float life_time = -1.0f,
+          bool persistent_lines = true);
+
+      size_t size() const {
+        return _shapes.size();
+      }
+
+      bool empty() const {
+        return _shapes.empty();
+      }
+
+      void clear() {
+        _shapes.clear();
+      }
+
+    private:
+
+      friend class DebugHelper;
+
+      std::vector<rpc::DebugShape> _shapes;
+    };
+
+    /// 形状组的标识，0 表示新建一个组。
+    using ShapeGroupId = uint64_t;
+
+    /// 在一次 RPC 中绘制 @a batch 中的所有形状，效果与逐个调用 Draw* 相同。
+    void DrawShapes(const ShapeBatch &batch);
+
+    /// 用 @a batch 替换形状组 @a group 的内容并返回组的标识，@a group 为 0
+    /// 或已经失效（例如加载了新地图）时新建一个组。组中的点、线、箭头与方框
+    /// 不受 life_time 影响，保留到下一次替换或 ClearShapeGroup；HUD 形状与
+    /// 字符串按 life_time 绘制。
+    ShapeGroupId DrawShapeGroup(const ShapeBatch &batch, ShapeGroupId group = 0u);
+
+    /// 删除形状组 @a group 中的所有形状并释放该组。
+    void ClearShapeGroup(ShapeGroupId group);
+
   private:
 
     detail::EpisodeProxy _episode;  // 存储 EpisodeProxy 对象
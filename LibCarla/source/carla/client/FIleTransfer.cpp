@@ -5,8 +5,11 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "FileTransfer.h"
+#include "carla/ContentHash.h"
 #include "carla/Version.h"
 
+#include <cstdio>
+
 namespace carla {
 namespace client {
 
@@ -31,24 +34,35 @@ namespace client {
     return _filesBaseFolder;
   }
 
-  bool FileTransfer::FileExists(std::string file) {
-    // 检查文件是否存在
-    struct stat buffer;
+  std::string FileTransfer::GetFullPath(const std::string &path) {
     std::string fullpath = _filesBaseFolder;
     fullpath += "/";
     fullpath += ::carla::version();
     fullpath += "/";
-    fullpath += file;
+    fullpath += path;
+    return fullpath;
+  }
+
+  bool FileTransfer::FileExists(std::string file) {
+    // 检查文件是否存在
+    struct stat buffer;
+    return (stat(GetFullPath(file).c_str(), &buffer) == 0);
+  }
 
-    return (stat(fullpath.c_str(), &buffer) == 0);
+  size_t FileTransfer::GetFileSize(const std::string &path) {
+    struct stat buffer;
+    if (stat(GetFullPath(path).c_str(), &buffer) != 0) {
+      return 0u;
+    }
+    return static_cast<size_t>(buffer.st_size);
   }
 
   bool FileTransfer::WriteFile(std::string path, std::vector<uint8_t> content) {
-    std::string writePath = _filesBaseFolder;
-    writePath += "/";
-    writePath += ::carla::version();
-    writePath += "/";
-    writePath += path;
+    return WriteFile(std::move(path), content.data(), content.size());
+  }
+
+  bool FileTransfer::WriteFile(std::string path, const uint8_t *data, size_t size) {
+    std::string writePath = GetFullPath(path);
 
     // 验证并创建文件路径
     carla::FileSystem::ValidateFilePath(writePath);
@@ -58,25 +72,67 @@ namespace client {
     if(!out.good()) return false;
 
     // 写下内容并关闭
-    for(auto file : content) {
-          out << file;
-    }
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
     out.close();
 
     return true;
   }
   //取文件内容并返回一个字节向量
   std::vector<uint8_t> FileTransfer::ReadFile(std::string path) {
-    std::string fullpath = _filesBaseFolder;
-    fullpath += "/";
-    fullpath += ::carla::version();
-    fullpath += "/";
-    fullpath += path;
     // 从基础文件夹读取二进制文件
-    std::ifstream file(fullpath, std::ios::binary);
+    std::ifstream file(GetFullPath(path), std::ios::binary);
     std::vector<uint8_t> content(std::istreambuf_iterator<char>(file), {});
     return content;
   }
 
+  bool FileTransfer::WriteFileChunk(
+      const std::string &path,
+      const size_t offset,
+      const uint8_t *data,
+      const size_t size) {
+    std::string writePath = GetFullPath(path);
+    carla::FileSystem::ValidateFilePath(writePath);
+
+    // 不截断已有内容；文件不存在时 in | out 打不开，先创建
+    std::fstream out(writePath, std::ios::in | std::ios::out | std::ios::binary);
+    if (!out.is_open()) {
+      out.open(writePath, std::ios::out | std::ios::binary);
+    }
+    if (!out.good()) return false;
+
+    out.seekp(static_cast<std::streamoff>(offset));
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+    return out.good();
+  }
+
+  bool FileTransfer::RenameFile(const std::string &from, const std::string &to) {
+    std::string toPath = GetFullPath(to);
+    carla::FileSystem::ValidateFilePath(toPath);
+    // Windows 上 rename 不会覆盖已有的文件
+    std::remove(toPath.c_str());
+    return std::rename(GetFullPath(from).c_str(), toPath.c_str()) == 0;
+  }
+
+  bool FileTransfer::RemoveFile(const std::string &path) {
+    return std::remove(GetFullPath(path).c_str()) == 0;
+  }
+
+  std::string FileTransfer::ComputeContentHash(const std::string &path) {
+    std::ifstream file(GetFullPath(path), std::ios::binary);
+    if (!file.is_open()) {
+      return {};
+    }
+    std::vector<char> buffer(1u << 20u);
+    uint64_t hash = ContentHash::InitialValue();
+    uint64_t size = 0u;
+    while (file) {
+      file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      const auto count = static_cast<size_t>(file.gcount());
+      hash = ContentHash::ComputeValue(buffer.data(), count, hash);
+      size += count;
+    }
+    return ContentHash::Format(hash, size);
+  }
+
 } // namespace client
 } // namespace carla
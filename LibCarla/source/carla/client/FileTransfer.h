@@ -9,10 +9,12 @@
 #include "carla/FileSystem.h"   // 引入CARLA客户端传感器的头文件
 
 #include <fstream>  // 引入文件流库
+#include <functional>
 #include <iostream>  // 引入输入输出流库
 #include <string>  // 引入字符串库
 #include <sys/stat.h>  // 引入用于文件状态的系统调用库
 #include <cstdint>   // 引入标准整数类型库
+#include <vector>
 
 namespace carla {    // 定义carla命名空间
 namespace client {   // 定义client命名空间
@@ -24,6 +26,10 @@ namespace client {   // 定义client命名空间
 
     FileTransfer() = delete;   // 禁止使用默认构造函数
 
+    /// 下载文件时每收到一块数据调用一次，参数为文件名、已收到的字节数和
+    /// 文件的总字节数。
+    using ProgressCallback = std::function<void(const std::string &name, size_t received, size_t total)>;
+
     static bool SetFilesBaseFolder(const std::string &path);   // 设置文件基础目录，返回是否成功
 
     static const std::string& GetFilesBaseFolder();   // 获取文件基础目录的常量引用
@@ -32,8 +38,27 @@ namespace client {   // 定义client命名空间
 
     static bool WriteFile(std::string path, std::vector<uint8_t> content);    // 写入文件，返回是否成功
 
+    static bool WriteFile(std::string path, const uint8_t *data, size_t size);   // 写入 @a size 字节的数据，返回是否成功
+
     static std::vector<uint8_t> ReadFile(std::string path);   // 读取文件内容，返回字节向量
 
+    /// 缓存中 @a path 的绝对路径。
+    static std::string GetFullPath(const std::string &path);
+
+    /// 缓存中 @a path 的大小（字节），文件不存在时为 0。
+    static size_t GetFileSize(const std::string &path);
+
+    /// 从 @a offset 开始写入 @a size 字节，文件不存在时创建，不改变其余内容。
+    static bool WriteFileChunk(const std::string &path, size_t offset, const uint8_t *data, size_t size);
+
+    /// 将缓存中的 @a from 移动到 @a to，覆盖已有的文件。
+    static bool RenameFile(const std::string &from, const std::string &to);
+
+    static bool RemoveFile(const std::string &path);
+
+    /// 分块读取缓存中的 @a path 并计算其 ContentHash，文件不存在时为空。
+    static std::string ComputeContentHash(const std::string &path);
+
   private:
 
     static std::string _filesBaseFolder;   // 存储文件基础目录的静态变量
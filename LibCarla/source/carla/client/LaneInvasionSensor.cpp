@@ -13,7 +13,6 @@
 #include "carla/client/Vehicle.h"
 #include "carla/client/detail/Simulator.h"
 #include "carla/geom/Location.h"
-#include "carla/geom/Math.h"
 #include "carla/sensor/data/LaneInvasionEvent.h"
 
 #include <exception>
@@ -21,41 +20,26 @@
 namespace carla {
 namespace client {
 
-  // ===========================================================================
-  // -- 静态局部方法 ------------------------------------------------------------
-  // ===========================================================================
-// 静态方法，根据给定的偏航角和位置进行旋转计算
-  static geom::Location Rotate(float yaw, const geom::Location &location) {
-  	// 将偏航角从度转换为弧度
-    yaw *= geom::Math::Pi<float>() / 180.0f;
-    const float c = std::cos(yaw);
-    const float s = std::sin(yaw);
-    // 进行旋转计算并返回新的位置
-    return {
-        c * location.x - s * location.y,
-        s * location.x + c * location.y,
-        location.z};
-  }
-
   // ===========================================================================
   // -- 压线回调类 LaneInvasionCallback -----------------------------------------
   // ===========================================================================
 
   class LaneInvasionCallback {
   public:
-// 构造函数，接收车辆、地图智能指针和用户回调函数
+// 构造函数，接收车辆 ID、地图智能指针和用户回调函数
     LaneInvasionCallback(
-        const Vehicle &vehicle,
-        SharedPtr<Map> &&map,
+        ActorId parent,
+        SharedPtr<const Map> map,
         Sensor::CallbackFunctionType &&user_callback)
-      : _parent(vehicle.GetId()),
-        _parent_bounding_box(vehicle.GetBoundingBox()),
+      : _parent(parent),
         _map(std::move(map)),
         _callback(std::move(user_callback)) {
       DEBUG_ASSERT(_map != nullptr);
     }
-// 处理每一帧数据的函数
-    void Tick(const WorldSnapshot &snapshot) const;
+// 处理每一帧数据的函数，车辆的边界由客户端传感器的共享处理计算
+    void Tick(
+        const WorldSnapshot &snapshot,
+        const detail::ClientSideSensorPipeline::Frame &frame) const;
 
   private:
 // 内部结构体，用于存储一帧的边界信息
@@ -63,14 +47,8 @@ namespace client {
       size_t frame;
       std::array<geom::Location, 4u> corners;
     };
- // 创建边界信息的函数
-    std::shared_ptr<const Bounds> MakeBounds(
-        size_t frame,
-        const geom::Transform &vehicle_transform) const;
 
     ActorId _parent;
-// 存储父类车辆的边界框信息
-    geom::BoundingBox _parent_bounding_box;
 // 地图的智能指针
     SharedPtr<const Map> _map;
 // 用户定义的回调函数
@@ -79,14 +57,16 @@ namespace client {
     mutable AtomicSharedPtr<const Bounds> _bounds;
   };
 // 处理每一帧数据，检查车辆是否压线并调用用户回调函数
-  void LaneInvasionCallback::Tick(const WorldSnapshot &snapshot) const {
+  void LaneInvasionCallback::Tick(
+      const WorldSnapshot &snapshot,
+      const detail::ClientSideSensorPipeline::Frame &frame) const {
     // 确保父类还存活。
-    auto parent = snapshot.Find(_parent);
-    if (!parent) {
+    auto parent = frame.Find(_parent);
+    if (parent == nullptr) {
       return;
     }
-// 创建当前帧的边界信息
-    auto next = MakeBounds(snapshot.GetFrame(), parent->transform);
+// 当前帧的边界信息
+    auto next = std::make_shared<const Bounds>(Bounds{snapshot.GetFrame(), parent->footprint});
     auto prev = _bounds.load();
 
     // 第一帧它将为空。
@@ -125,19 +105,6 @@ namespace client {
           std::move(crossed_lanes)));
     }
   }
-// 创建边界信息的函数实现
-  std::shared_ptr<const LaneInvasionCallback::Bounds> LaneInvasionCallback::MakeBounds(
-      const size_t frame,
-      const geom::Transform &transform) const {
-    const auto &box = _parent_bounding_box;
-    const auto location = transform.location + box.location;
-    const auto yaw = transform.rotation.yaw;
-    return std::make_shared<Bounds>(Bounds{frame, {
-        location + Rotate(yaw, geom::Location( box.extent.x,  box.extent.y, 0.0f)),
-        location + Rotate(yaw, geom::Location(-box.extent.x,  box.extent.y, 0.0f)),
-        location + Rotate(yaw, geom::Location( box.extent.x, -box.extent.y, 0.0f)),
-        location + Rotate(yaw, geom::Location(-box.extent.x, -box.extent.y, 0.0f))}});
-  }
 
   // ===========================================================================
   // -- 压线传感器 LaneInvasionSensor -------------------------------------------
@@ -157,13 +124,16 @@ namespace client {
     auto episode = GetEpisode().Lock();
     // 创建压线回调对象
     auto cb = std::make_shared<LaneInvasionCallback>(
-        *vehicle,
+        vehicle->GetId(),
         episode->GetCurrentMap(),
         std::move(callback));
 
-    const size_t callback_id = episode->RegisterOnTickEvent([cb=std::move(cb)](const auto &snapshot) {
+    // 不需要路点，只请求车辆的边界
+    const size_t callback_id = episode->RegisterClientSideSensor(
+        {vehicle->GetId(), vehicle->GetBoundingBox(), nullptr},
+        [cb=std::move(cb)](const auto &snapshot, const auto &frame) {
       try {
-        cb->Tick(snapshot);
+        cb->Tick(snapshot, frame);
       } catch (const std::exception &e) {
         log_error("LaneInvasionSensor:", e.what());
       }
@@ -171,7 +141,7 @@ namespace client {
 
     const size_t previous = _callback_id.exchange(callback_id);
     if (previous != 0u) {
-      episode->RemoveOnTickEvent(previous);
+      episode->RemoveClientSideSensor(previous);
     }
   }
  // 停止监听
@@ -179,7 +149,7 @@ namespace client {
     const size_t previous = _callback_id.exchange(0u);
     auto episode = GetEpisode().TryLock();
     if ((previous != 0u) && (episode != nullptr)) {
-      episode->RemoveOnTickEvent(previous);
+      episode->RemoveClientSideSensor(previous);
     }
   }
 
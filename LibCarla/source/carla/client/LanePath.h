@@ -0,0 +1,95 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/road/Map.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 沿车道采样的路点，按列存储。
+  ///
+  /// 与 Waypoint::GetNext 不同，路点只是值，不为每个路点创建对象，适合每帧
+  /// 需要采样大量路点的规划器，例如在 Python 中作为 numpy 数组使用。第 i 行
+  /// 的 (road_id, section_id, lane_id, s) 可以用 Map::GetWaypointXODR 转换
+  /// 为 Waypoint。
+  class LanePath : private NonCopyable {
+  public:
+
+    /// 每个变换在 GetTransforms() 中占用的 float 数量：x、y、z、pitch、yaw、roll。
+    static constexpr size_t TRANSFORM_SIZE = 6u;
+
+    LanePath(const road::Map &map, const std::vector<road::element::Waypoint> &waypoints) {
+      const auto count = waypoints.size();
+      _road_ids.reserve(count);
+      _section_ids.reserve(count);
+      _lane_ids.reserve(count);
+      _s.reserve(count);
+      _transforms.reserve(TRANSFORM_SIZE * count);
+      for (const auto &waypoint : waypoints) {
+        const auto transform = map.ComputeTransform(waypoint);
+        const auto &location = transform.location;
+        const auto &rotation = transform.rotation;
+        _road_ids.emplace_back(waypoint.road_id);
+        _section_ids.emplace_back(waypoint.section_id);
+        _lane_ids.emplace_back(waypoint.lane_id);
+        _s.emplace_back(waypoint.s);
+        _transforms.insert(_transforms.end(), {
+            location.x, location.y, location.z,
+            rotation.pitch, rotation.yaw, rotation.roll});
+      }
+    }
+
+    size_t size() const {
+      return _road_ids.size();
+    }
+
+    road::element::Waypoint GetWaypoint(size_t index) const {
+      return {_road_ids.at(index), _section_ids.at(index), _lane_ids.at(index), _s.at(index)};
+    }
+
+    const std::vector<road::RoadId> &GetRoadIds() const {
+      return _road_ids;
+    }
+
+    const std::vector<road::SectionId> &GetSectionIds() const {
+      return _section_ids;
+    }
+
+    const std::vector<road::LaneId> &GetLaneIds() const {
+      return _lane_ids;
+    }
+
+    /// 沿道路的距离，单位为米。
+    const std::vector<double> &GetS() const {
+      return _s;
+    }
+
+    /// 每行 TRANSFORM_SIZE 个 float，单位为米和度。
+    const std::vector<float> &GetTransforms() const {
+      return _transforms;
+    }
+
+  private:
+
+    std::vector<road::RoadId> _road_ids;
+
+    std::vector<road::SectionId> _section_ids;
+
+    std::vector<road::LaneId> _lane_ids;
+
+    std::vector<double> _s;
+
+    std::vector<float> _transforms;
+  };
+
+} // namespace client
+} // namespace carla
@@ -304,11 +304,29 @@ const LightState& LightManager::RetrieveLightState(LightId id) const {
 
 void LightManager::QueryLightsStateToServer() {
   std::lock_guard<std::mutex> lock(_mutex);
-  // 发送 blocking 查询到服务器以获取灯光状态
-  std::vector<rpc::LightState> lights_snapshot = _episode.Lock()->QueryLightsStateToServer();
+  // 发送 blocking 查询到服务器以获取灯光状态，只获取上次查询之后改变的灯光
+  auto episode = _episode.Lock();
+  std::vector<rpc::LightState> lights_snapshot;
+  if (_delta_query_supported) {
+    try {
+      auto delta = episode->QueryLightsStateToServerSince(_lights_version);
+      if (delta.first < _lights_version) {
+        // 服务器的版本号变小了（例如加载了新地图），重新查询全部灯光
+        delta = episode->QueryLightsStateToServerSince(0u);
+      }
+      _lights_version = delta.first;
+      lights_snapshot = std::move(delta.second);
+    } catch (const std::exception &) {
+      // 旧版本的服务器没有增量查询，改为每次查询全部灯光
+      _delta_query_supported = false;
+    }
+  }
+  if (!_delta_query_supported) {
+    lights_snapshot = episode->QueryLightsStateToServer();
+  }
 
   // 更新本地灯光状态
-  SharedPtr<LightManager> lm = _episode.Lock()->GetLightManager();
+  SharedPtr<LightManager> lm = episode->GetLightManager();
 
   for(const auto& it : lights_snapshot) {
     _lights_state[it._id] = LightState(
@@ -41,6 +41,8 @@ public:
     _on_tick_register_id = other._on_tick_register_id; // 拷贝tick注册ID
     _on_light_update_register_id = other._on_light_update_register_id; // 拷贝灯光更新注册ID
     _dirty = other._dirty; // 拷贝脏标志
+    _lights_version = other._lights_version; // 拷贝灯光版本号
+    _delta_query_supported = other._delta_query_supported; // 拷贝增量查询标志
   }
 
   void SetEpisode(detail::WeakEpisodeProxy episode); // 设置当前Episode
@@ -107,6 +109,8 @@ private:
   size_t _on_tick_register_id = 0; // tick注册ID
   size_t _on_light_update_register_id = 0; // 灯光更新注册ID
   bool _dirty = false; // 脏标志
+  uint64_t _lights_version = 0u; // 上次查询时服务器的灯光版本号，0 表示查询全部
+  bool _delta_query_supported = true; // 服务器是否支持增量查询
 };
 
 } // namespace client
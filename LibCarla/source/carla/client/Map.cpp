@@ -6,6 +6,10 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/ContentHash.h"
+#include "carla/Logging.h"
+#include "carla/MappedFile.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
@@ -19,18 +23,43 @@ namespace carla {
 // 命名空间 client
 namespace client {
 // 静态函数 MakeMap，根据输入的 opendrive 内容生成地图  
+// 地图的R树按 OpenDRIVE 内容缓存在本地，再次加载同一地图时直接映射缓存的文件，
+// 不需要重新采样所有车道
 static auto MakeMap(const std::string &opendrive_contents) {
 // 创建输入字符串流   
  auto stream = std::istringstream(opendrive_contents);
+    const auto cache_path =
+        std::string("ContentCache/") + ContentHash::Compute(opendrive_contents) + ".rtree.bin";
+    const auto cached_rtree = MappedFile::Open(FileTransfer::GetFilesBaseFolder() + cache_path);
  // 调用 OpenDriveParser 类的 Load 函数加载地图，返回 boost::optional<carla::road::Map>
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    auto map = opendrive::OpenDriveParser::Load(
+        stream.str(),
+        cached_rtree != nullptr ? cached_rtree->data() : nullptr,
+        cached_rtree != nullptr ? cached_rtree->size() : 0u);
  // 如果 map 为空，抛出运行时异常    
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
+    if (map->IsRtreeLoaded()) {
+      log_debug("using cached map R-tree", cache_path);
+    } else {
+      FileTransfer::WriteFile(cache_path, map->SerializeRtree());
+    }
 // 移动 map 的值
     return std::move(*map);
   }
+
+// 作为 @a previous 的新版本生成地图，新的R树同样写入缓存
+static auto MakeUpdatedMap(const std::string &opendrive_contents, const road::Map &previous) {
+    auto map = opendrive::OpenDriveParser::LoadUpdate(opendrive_contents, previous);
+    if (!map.has_value()) {
+      throw_exception(std::runtime_error("failed to generate map"));
+    }
+    const auto cache_path =
+        std::string("ContentCache/") + ContentHash::Compute(opendrive_contents) + ".rtree.bin";
+    FileTransfer::WriteFile(cache_path, map->SerializeRtree());
+    return std::move(*map);
+  }
  // Map 类的构造函数，接受 rpc::MapInfo 和 xodr 内容
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
@@ -45,8 +74,16 @@ static auto MakeMap(const std::string &opendrive_contents) {
     std::vector<geom::Transform>{}}, xodr_content) {
     open_drive_file = xodr_content;
   }
+  Map::Map(rpc::MapInfo description, std::string xodr_content, const road::Map &previous)
+    : open_drive_file(xodr_content),
+      _description(std::move(description)),
+      _map(MakeUpdatedMap(xodr_content, previous)) {}
 // Map 类的析构函数，使用默认析构函数
   Map::~Map() = default;
+// 用修改后的 OpenDRIVE 内容创建新版本的地图
+  SharedPtr<Map> Map::MakeUpdated(std::string xodr_content) const {
+    return SharedPtr<Map>(new Map(_description, std::move(xodr_content), _map));
+  }
 // 获取与给定位置相关的 Waypoint 的函数
   SharedPtr<Waypoint> Map::GetWaypoint(
   const geom::Location &location,
@@ -65,6 +102,23 @@ static auto MakeMap(const std::string &opendrive_contents) {
     SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
     nullptr;
   }
+// 批量获取 Waypoint 的函数，查询在 road::Map 中并行执行
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    const auto waypoints = project_to_road ?
+        _map.GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map.GetWaypoints(locations, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
 // 根据道路 ID、车道 ID 和 s 坐标获取 Waypoint 的函数
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
@@ -119,6 +119,20 @@ namespace client {
         const geom::Location &location,
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+    /**
+         * @brief 批量获取路点，与对每个位置调用 GetWaypoint 的结果相同。
+         *
+         * 查询按空间位置排序后并行执行，适合每帧需要查询大量位置的情况。
+         *
+         * @param locations 地理位置列表。
+         * @param project_to_road 是否将位置投影到最近的道路上（默认为true）。
+         * @param lane_type 车道类型（默认为驾驶车道）。
+         * @return 与 @a locations 一一对应的路点，没有找到路点的位置为 nullptr。
+         */
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
     /**
          * @brief 根据OpenDRIVE ID获取路点。
          *
@@ -226,8 +240,22 @@ namespace client {
           */
     void CookInMemoryMap(const std::string& path) const;
 
+    /**
+          * @brief 用修改后的 OpenDRIVE 内容创建这个地图的新版本。
+          *
+          * 只有新增和修改的道路重新采样，其他道路重用这个地图的R树元素，比重新
+          * 加载整个地图快得多。新地图的 GetMap().GetUpdate() 为变化的道路。
+          *
+          * @param xodr_content 修改后的OpenDRIVE地图数据。
+          * @return 返回新的地图，这个地图不变。
+          */
+    SharedPtr<Map> MakeUpdated(std::string xodr_content) const;
+
   private:
 
+    /// 作为 @a previous 的新版本从 @a xodr_content 创建地图。
+    Map(rpc::MapInfo description, std::string xodr_content, const road::Map &previous);
+
     std::string open_drive_file;// 包含OpenDRIVE文件内容的字符串
 
     const rpc::MapInfo _description; // 描述地图信息的RPC对象
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Time.h"
+
+#include <boost/optional.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace carla {
+namespace client {
+
+  /// 尚未返回的 RPC 调用的结果。
+  ///
+  /// 请求在创建时已经发出，同一连接上可以同时有任意多个尚未返回的请求，
+  /// 因此可以先发出一批请求，再依次等待它们的结果，而不必为每个请求
+  /// 等待一次往返。
+  template <typename T>
+  class RpcFuture {
+  public:
+
+    /// 等待结果最多 @a timeout，返回结果是否已经到达。
+    using WaitFunction = std::function<bool(time_duration)>;
+
+    /// 阻塞直到结果到达并返回结果，超时或调用失败时抛出异常。
+    using GetFunction = std::function<T()>;
+
+    RpcFuture() = default;
+
+    RpcFuture(WaitFunction wait, GetFunction get)
+      : _state(std::make_shared<State>()) {
+      _state->wait = std::move(wait);
+      _state->get = std::move(get);
+    }
+
+    bool IsValid() const {
+      return _state != nullptr;
+    }
+
+    /// 结果是否已经到达，不阻塞。
+    bool IsReady() const {
+      return WaitFor(time_duration::milliseconds(0u));
+    }
+
+    /// 等待结果最多 @a timeout，返回结果是否已经到达。
+    bool WaitFor(time_duration timeout) const {
+      DEBUG_ASSERT(IsValid());
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      return _state->value.has_value() || _state->wait(timeout);
+    }
+
+    /// 等待并返回结果，最多等待客户端的超时时间。
+    ///
+    /// 可以多次调用，结果在第一次调用后被缓存。
+    ///
+    /// @throw TimeoutException 如果在客户端的超时时间内没有收到响应。
+    /// @throw std::runtime_error 如果服务器返回了错误。
+    T Get() const {
+      DEBUG_ASSERT(IsValid());
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      if (!_state->value.has_value()) {
+        _state->value = _state->get();
+      }
+      return *_state->value;
+    }
+
+  private:
+
+    struct State {
+      std::mutex mutex;
+      WaitFunction wait;
+      GetFunction get;
+      boost::optional<T> value;
+    };
+
+    std::shared_ptr<State> _state;
+  };
+
+} // namespace client
+} // namespace carla
@@ -51,6 +51,18 @@ namespace client {
     listening_mask.set(0); // 将监听标志的第0位置为true
   }
 
+  void ServerSideSensor::ListenCompressed(CallbackFunctionType callback) {
+    log_debug(GetDisplayId(), ": subscribing to stream without decompression");
+    GetEpisode().Lock()->SubscribeToSensor(*this, std::move(callback), false);
+    listening_mask.set(0);
+  }
+
+  void ServerSideSensor::ListenLazy(CallbackFunctionType callback) {
+    log_debug(GetDisplayId(), ": subscribing to stream with lazy deserialization");
+    GetEpisode().Lock()->SubscribeToSensor(*this, std::move(callback), true, true);
+    listening_mask.set(0);
+  }
+
   // stop函数：停止监听传感器数据流
   void ServerSideSensor::Stop() {
     log_debug("calling sensor Stop() ", GetDisplayId()); // 打印调试信息
@@ -122,6 +134,18 @@ namespace client {
     return GetEpisode().Lock()->IsEnabledForROS(*this);
   }
 
+  void ServerSideSensor::EnableMulticast() {
+    GetEpisode().Lock()->EnableMulticast(*this);
+  }
+
+  void ServerSideSensor::DisableMulticast() {
+    GetEpisode().Lock()->DisableMulticast(*this);
+  }
+
+  rpc::StreamStatistics ServerSideSensor::GetStreamStatistics() {
+    return GetEpisode().Lock()->GetStreamStatistics(*this);
+  }
+
   bool ServerSideSensor::Destroy() {
     log_debug("calling sensor Destroy() ", GetDisplayId()); // 记录调试日志，表示调用了Destroy方法
     if (IsListening()) { // 如果传感器正在监听
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/client/Sensor.h"
+#include "carla/rpc/StreamStatistics.h"
 #include <bitset>
 
 namespace carla {
@@ -25,6 +26,14 @@ namespace client {
     /// 请注意，多个传感器实例（即使在不同的进程中）可能指向模拟器中的同一传感器。
     void Listen(CallbackFunctionType callback) override;
 
+    /// 与 Listen 相同，但压缩的测量数据不会被解压，而是以
+    /// sensor::data::CompressedData 的形式交给 @a 回调（未压缩的数据照常处理）。
+    void ListenCompressed(CallbackFunctionType callback);
+
+    /// 与 Listen 相同，但只解析测量数据的数据头，以 sensor::data::LazyData 的
+    /// 形式交给 @a 回调，负载在第一次调用 LazyData::Get 时才反序列化。
+    void ListenLazy(CallbackFunctionType callback);
+
     /// 停止监听新的测量结果。
     void Stop() override;
 
@@ -52,6 +61,16 @@ namespace client {
     /// 如果传感器正在为 ROS2 发布，则返回
     bool IsEnabledForROS();
 
+    /// 通过服务器的组播组发送该传感器的数据，此后调用 Listen 的客户端从组播组接收数据。
+    /// 需要在 Listen 之前调用，已经在监听的客户端继续使用 TCP。
+    void EnableMulticast();
+
+    /// 停止通过组播发送该传感器的数据
+    void DisableMulticast();
+
+    /// 返回服务器端该传感器流的发送队列统计信息，包括队列深度和丢弃的帧数
+    rpc::StreamStatistics GetStreamStatistics();
+
     /// 通过该传感器发送数据
     void Send(std::string message);
 
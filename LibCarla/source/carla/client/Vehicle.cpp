@@ -152,6 +152,10 @@ namespace client {
         TireJSON,
         BaseJSONPath);
   }
+// 启用运动学车辆模型
+  void Vehicle::EnableKinematicPhysics() {
+    GetEpisode().Lock()->EnableKinematicPhysics(*this);
+  }
 // 恢复 PhysX 物理引擎
   void Vehicle::RestorePhysXPhysics() {
     GetEpisode().Lock()->RestorePhysXPhysics(*this);
@@ -144,6 +144,9 @@ namespace client {
         std::string TireJSON = "",
         std::string BaseJSONPath = "");
 
+    /// 用运动学自行车模型代替完整的物理模拟，适用于远处的背景车辆，发生碰撞时恢复完整的物理
+    void EnableKinematicPhysics();
+
     void RestorePhysXPhysics();
 
     /// 返回车辆的故障状态
@@ -14,12 +14,35 @@
 namespace carla {
 namespace client {
 
+  // 控制器是否由服务器端的行人导航驱动（蓝图属性 server_navigation）
+  static bool UsesServerNavigation(const Actor &controller) {
+    for (auto &&attribute : controller.GetAttributes()) {
+      if (attribute.GetId() == "server_navigation") {
+        return attribute.As<bool>();
+      }
+    }
+    return false;
+  }
+
   //构造函数,初始化WalkerAIController并传递初始化参数给父类Actor
   WalkerAIController::WalkerAIController(ActorInitializer init)
     : Actor(std::move(init)) {} 
 
   //方法Start,Start()方法在控制器启动时调用，注册AI控制器并让行人加入导航系统。
   void WalkerAIController::Start() {
+    if (UsesServerNavigation(*this)) {
+      // 服务器负责更新行人，同时禁用它的物理和碰撞
+      auto walker = GetParent();
+      if (walker == nullptr) {
+        throw_exception(std::runtime_error(GetDisplayId() + ": not attached to walker"));
+        return;
+      }
+      if (!GetEpisode().Lock()->AddWalkerToServerNavigation(walker->GetId(), GetId())) {
+        log_warning("NAV: failed to add walker", walker->GetId(), "to the server navigation");
+      }
+      return;
+    }
+
     GetEpisode().Lock()->RegisterAIController(*this);
 
     // 在 Recast & Detour 中添加行人
@@ -40,6 +63,14 @@ namespace client {
 
   //方法Stop,Stop()方法用于停止控制器的工作，解除对行人对象的管理。
   void WalkerAIController::Stop() {
+    if (UsesServerNavigation(*this)) {
+      auto walker = GetParent();
+      if (walker != nullptr) {
+        GetEpisode().Lock()->RemoveWalkerFromServerNavigation(walker->GetId());
+      }
+      return;
+    }
+
     GetEpisode().Lock()->UnregisterAIController(*this);
 
     // 从 Recast & Detour 中移除行人
@@ -56,6 +87,13 @@ namespace client {
   // 获取一个随机的导航位置，供行人AI使用
   boost::optional<geom::Location> WalkerAIController::GetRandomLocation() {
       //GetRandomLocation()方法返回一个随机的位置，通常用于让AI行人随机选择一个目标位置。
+    if (UsesServerNavigation(*this)) {
+      auto locations = GetEpisode().Lock()->GetServerNavigationRandomLocations(1u);
+      if (!locations.empty()) {
+        return locations.front();
+      }
+      return {};
+    }
     auto nav = GetEpisode().Lock()->GetNavigation();
     if (nav != nullptr) {
       return nav->GetRandomLocation();
@@ -65,6 +103,14 @@ namespace client {
 
   //方法GoToLocation,GoToLocation()方法使得AI行人朝着指定的目标位置前进。
   void WalkerAIController::GoToLocation(const carla::geom::Location &destination) {
+    if (UsesServerNavigation(*this)) {
+      auto walker = GetParent();
+      if (walker == nullptr ||
+          !GetEpisode().Lock()->SetServerNavigationWalkerTarget(walker->GetId(), destination)) {
+        log_warning("NAV: Failed to set request to go to ", destination.x, destination.y, destination.z);
+      }
+      return;
+    }
     auto nav = GetEpisode().Lock()->GetNavigation();
     if (nav != nullptr) {
       auto walker = GetParent();
@@ -81,6 +127,14 @@ namespace client {
 
   //方法SetMaxSpeed,SetMaxSpeed()方法设置行人的最大速度。
   void WalkerAIController::SetMaxSpeed(const float max_speed) {
+    if (UsesServerNavigation(*this)) {
+      auto walker = GetParent();
+      if (walker == nullptr ||
+          !GetEpisode().Lock()->SetServerNavigationWalkerMaxSpeed(walker->GetId(), max_speed)) {
+        log_warning("NAV: failed to set max speed");
+      }
+      return;
+    }
     auto nav = GetEpisode().Lock()->GetNavigation();
     if (nav != nullptr) {
       auto walker = GetParent();
@@ -8,6 +8,7 @@
 #include "carla/client/Map.h"  // 引入Map头文件
 #include "carla/client/Junction.h"  // 引入Junction头文件
 #include "carla/client/Landmark.h"  // 引入Landmark头文件
+#include "carla/client/LanePath.h"  // 引入LanePath头文件
 
 #include <unordered_set>  // 引入unordered_set头文件，用于哈希集合
 
@@ -143,6 +144,22 @@ namespace client {
     return result;  // 返回直到车道开始的Waypoint列表
   }
 
+  // 沿车道采样路点，只保存值
+  std::shared_ptr<const LanePath> Waypoint::SampleNext(
+      double distance, size_t max_count, bool until_lane_end) const {
+    const auto &map = _parent->GetMap();
+    return std::make_shared<LanePath>(
+        map, map.SampleLane(_waypoint, distance, max_count, true, until_lane_end));
+  }
+
+  // 沿车道反方向采样路点，只保存值
+  std::shared_ptr<const LanePath> Waypoint::SamplePrevious(
+      double distance, size_t max_count, bool until_lane_start) const {
+    const auto &map = _parent->GetMap();
+    return std::make_shared<LanePath>(
+        map, map.SampleLane(_waypoint, distance, max_count, false, until_lane_start));
+  }
+
   SharedPtr<Waypoint> Waypoint::GetRight() const {
     // 获取右侧的Waypoint
     auto right_lane_waypoint =
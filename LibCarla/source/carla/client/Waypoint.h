@@ -59,6 +59,8 @@
          * 该头文件包含了Boost库中的boost::optional模板类，用于表示一个可能不存在的值。
          */
 #include <boost/optional.hpp>
+
+#include <memory>
          /**
           * @namespace carla::client
           * @brief CARLA客户端相关的命名空间。
@@ -69,6 +71,7 @@ namespace client {
   class Map;
   class Junction;
   class Landmark;
+  class LanePath;
   /**
    * @class Waypoint
    * @brief 路径点类，表示道路上的特定位置。
@@ -193,6 +196,26 @@ namespace client {
      * @return 路径点列表（SharedPtr<Waypoint>类型的vector）。
      */
     std::vector<SharedPtr<Waypoint>> GetPreviousUntilLaneStart(double distance) const;
+    /**
+     * @brief 一次采样从当前位置开始沿车道的 @a max_count 个路点及其变换，
+     * 不为每个路点创建 Waypoint 对象。
+     *
+     * 每一步与 GetNext(distance) 的第一个结果相同；@a until_lane_end 为 true
+     * 时与 GetNextUntilLaneEnd 相同。
+     *
+     * @param distance 每个路径点之间的间隔距离（double类型）。
+     * @param max_count 最多返回的路径点数量。
+     * @param until_lane_end 是否在道路末端停止。
+     * @return 按列存储的路径点。
+     */
+    std::shared_ptr<const LanePath> SampleNext(
+        double distance, size_t max_count, bool until_lane_end = false) const;
+    /**
+     * @brief 与 SampleNext 相同，但沿车道反方向采样，与 GetPrevious 和
+     * GetPreviousUntilLaneStart 相同。
+     */
+    std::shared_ptr<const LanePath> SamplePrevious(
+        double distance, size_t max_count, bool until_lane_start = false) const;
     /**
      * @brief 获取当前路径点右侧的路径点。
      *
@@ -17,6 +17,7 @@
 #include "carla/client/TrafficLight.h"  // 引入交通灯类的定义
 
 #include <exception>  // 引入异常处理
+#include <unordered_map>  // 引入无序映射
 
 namespace carla {
 namespace client {
@@ -33,6 +34,18 @@ namespace client {
     _episode.Lock()->UnloadLevelLayer(map_layers);  // 卸载指定的地图层
   }
 
+  void World::LoadLevelLayerAsync(
+      rpc::MapLayer map_layers,
+      std::function<void()> callback) const {
+    _episode.Lock()->ChangeLevelLayerAsync(map_layers, true, std::move(callback));
+  }
+
+  void World::UnloadLevelLayerAsync(
+      rpc::MapLayer map_layers,
+      std::function<void()> callback) const {
+    _episode.Lock()->ChangeLevelLayerAsync(map_layers, false, std::move(callback));
+  }
+
   SharedPtr<BlueprintLibrary> World::GetBlueprintLibrary() const {  // 获取蓝图库的方法
     return _episode.Lock()->GetBlueprintLibrary();  // 返回蓝图库
   }
@@ -103,6 +116,21 @@ namespace client {
     return _episode.Lock()->GetWorldSnapshot();  // 返回当前世界快照
   }
 
+  ActorListChanges World::GetActorListChanges(const uint64_t sequence) const {
+    return _episode.Lock()->GetActorListChanges(sequence);
+  }
+
+  void World::ConfigureStateHistory(const double max_duration, const size_t max_frames) {
+    _episode.Lock()->ConfigureStateHistory(max_duration, max_frames);
+  }
+
+  std::shared_ptr<const ActorTrajectory> World::GetActorTrajectory(
+      const ActorId id,
+      const double begin,
+      const double end) const {
+    return _episode.Lock()->GetActorTrajectory(id, begin, end);
+  }
+
   SharedPtr<Actor> World::GetActor(ActorId id) const {  // 根据ID获取参与者的方法
     auto simulator = _episode.Lock();  // 锁定当前剧集
     auto description = simulator->GetActorById(id);  // 获取指定ID的参与者描述
@@ -114,7 +142,8 @@ namespace client {
   SharedPtr<ActorList> World::GetActors() const {  // 获取所有参与者的方法
     return SharedPtr<ActorList>{new ActorList{  // 返回新的参与者列表
                                   _episode,
-                                  _episode.Lock()->GetAllTheActorsInTheEpisode()}};  // 获取所有参与者
+                                  _episode.Lock()->GetAllTheActorsInTheEpisode(),  // 获取所有参与者
+                                  true}};  // 参与者按类型ID排序
   }
 
   SharedPtr<ActorList> World::GetActors(const std::vector<ActorId> &actor_ids) const {  // 根据ID列表获取参与者的方法
@@ -123,6 +152,26 @@ namespace client {
                                   _episode.Lock()->GetActorsById(actor_ids)}};  // 根据ID获取参与者列表
   }
 
+  SharedPtr<ActorList> World::FilterActors(const std::string &wildcard_pattern) const {  // 根据类型ID获取参与者的方法
+    return SharedPtr<ActorList>{new ActorList{
+                                  _episode,
+                                  _episode.Lock()->GetActorsByTypeId(wildcard_pattern),
+                                  true}};
+  }
+
+  SharedPtr<ActorList> World::GetActorsInRadius(  // 根据位置获取参与者的方法
+      const geom::Location &location,
+      const float radius,
+      const std::string &wildcard_pattern) const {
+    return SharedPtr<ActorList>{new ActorList{
+                                  _episode,
+                                  _episode.Lock()->GetActorsInRadius(location, radius, wildcard_pattern)}};
+  }
+
+  rpc::ActorQueryResult World::QueryActors(const rpc::ActorQuery &query) const {
+    return _episode.Lock()->QueryActors(query);
+  }
+
  SharedPtr<Actor> World::SpawnActor(
       const ActorBlueprint &blueprint, // 参与者蓝图
       const geom::Transform &transform, // 变换信息
@@ -154,6 +203,14 @@ namespace client {
     return _episode.Lock()->WaitForTick(local_timeout); // 等待并返回快照
   }
 
+  std::vector<rpc::FrameTimings> World::GetFrameTimings(const uint64_t count) const { // 获取帧时间
+    return _episode.Lock()->GetFrameTimings(count);
+  }
+
+  rpc::SensorTickPlan World::GetSensorTickPlan(const uint32_t frames) const { // 获取传感器触发计划
+    return _episode.Lock()->GetSensorTickPlan(frames);
+  }
+
   size_t World::OnTick(std::function<void(WorldSnapshot)> callback) { // 注册tick事件
     return _episode.Lock()->RegisterOnTickEvent(std::move(callback)); // 返回回调ID
   }
@@ -162,12 +219,57 @@ namespace client {
     _episode.Lock()->RemoveOnTickEvent(callback_id); // 根据ID移除
   }
 
+  size_t World::OnActorChanges(std::function<void(const ActorStateChanges &)> callback) {
+    return _episode.Lock()->RegisterOnActorChangesEvent(std::move(callback));
+  }
+
+  void World::RemoveOnActorChanges(size_t callback_id) {
+    _episode.Lock()->RemoveOnActorChangesEvent(callback_id);
+  }
+
+  void World::SetActorChangesMoveThreshold(const float meters) {
+    _episode.Lock()->SetActorChangesMoveThreshold(meters);
+  }
+
+  uint32_t World::ListenToSensors(
+      const std::vector<ActorId> &sensor_ids,
+      std::function<void(std::vector<SharedPtr<sensor::SensorData>>)> callback) {
+    return _episode.Lock()->ListenToSensorBundle(sensor_ids, std::move(callback));
+  }
+
+  void World::StopListeningToSensors(uint32_t bundle_id) {
+    _episode.Lock()->StopSensorBundle(bundle_id);
+  }
+
   uint64_t World::Tick(time_duration timeout) { // 执行tick操作
     time_duration local_timeout = timeout.milliseconds() == 0 ?
         _episode.Lock()->GetNetworkingTimeout() : timeout; // 确定超时时间
     return _episode.Lock()->Tick(local_timeout); // 执行tick并返回结果
   }
 
+  RpcFuture<uint64_t> World::TickAsync(time_duration timeout) {
+    time_duration local_timeout = timeout.milliseconds() == 0 ?
+        _episode.Lock()->GetNetworkingTimeout() : timeout;
+    return _episode.Lock()->TickAsync(local_timeout);
+  }
+
+  uint32_t World::RegisterTickParticipant(const std::string &name, time_duration deadline) { // 注册节拍屏障的参与者
+    return _episode.Lock()->RegisterTickParticipant(name, deadline);
+  }
+
+  void World::UnregisterTickParticipant(uint32_t participant_id) { // 注销节拍屏障的参与者
+    _episode.Lock()->UnregisterTickParticipant(participant_id);
+  }
+
+  void World::NotifyTickReady(uint32_t participant_id, uint64_t frame) { // 确认参与者已处理完一帧
+    _episode.Lock()->NotifyTickReady(participant_id, frame);
+  }
+
+  void World::NotifyTickReady(uint32_t participant_id) { // 确认参与者已处理完最后收到的一帧
+    auto simulator = _episode.Lock();
+    simulator->NotifyTickReady(participant_id, simulator->GetWorldSnapshot().GetFrame());
+  }
+
   void World::SetPedestriansCrossFactor(float percentage) { // 设置行人过街因子
     _episode.Lock()->SetPedestriansCrossFactor(percentage); // 更新因子
   }
@@ -223,10 +325,39 @@ namespace client {
     return nullptr; // 未找到时返回空指针
   }
 
+  // 一次遍历所有参与者，建立 OpenDRIVE 信号 ID 到交通灯的映射，
+  // 避免对每个信号都遍历一次参与者列表
+  static std::unordered_map<road::SignId, SharedPtr<Actor>> MapTrafficLightsBySignId(
+      const ActorList &actors) {
+    std::unordered_map<road::SignId, SharedPtr<Actor>> result;
+    for (size_t i = 0; i < actors.size(); i++) {
+      SharedPtr<Actor> actor = actors.at(i);
+      if (StringUtil::Match(actor->GetTypeId(), "*traffic_light*")) {
+        TrafficLight* tl = static_cast<TrafficLight*>(actor.get());
+        if (tl) {
+          result.emplace(tl->GetSignId(), actor);
+        }
+      }
+    }
+    return result;
+  }
+
   void World::ResetAllTrafficLights() { // 重置所有交通信号灯
     _episode.Lock()->ResetAllTrafficLights(); // 调用重置方法
   }
 
+  uint64_t World::SaveState() const { // 保存场景的当前状态
+    return _episode.Lock()->SaveEpisodeSnapshot();
+  }
+
+  void World::RestoreState(uint64_t state_id) const { // 恢复保存的状态
+    _episode.Lock()->RestoreEpisodeSnapshot(state_id);
+  }
+
+  void World::RemoveState(uint64_t state_id) const { // 释放保存的状态
+    _episode.Lock()->RemoveEpisodeSnapshot(state_id);
+  }
+
   SharedPtr<LightManager> World::GetLightManager() const { // 获取光照管理器
     return _episode.Lock()->GetLightManager(); // 返回光照管理器
   }
@@ -243,6 +374,13 @@ namespace client {
     return _episode.Lock()->GetEnvironmentObjects(queried_tag); // 返回环境对象列表
   }
 
+  std::vector<rpc::EnvironmentObject> World::GetEnvironmentObjectsInRadius(
+      const geom::Location &location,
+      float radius,
+      uint8_t queried_tag) const { // 获取一定范围内的环境对象
+    return _episode.Lock()->GetEnvironmentObjectsInRadius(location, radius, queried_tag);
+  }
+
 
  void World::EnableEnvironmentObjects(
       std::vector<uint64_t> env_objects_ids, // 环境对象的 ID 列表
@@ -281,12 +419,18 @@ std::vector<SharedPtr<Actor>> World::GetTrafficLightsFromWaypoint(
     std::vector<SharedPtr<Landmark>> landmarks =
         waypoint.GetAllLandmarksInDistance(distance); // 获取指定距离内的所有地标
     std::set<std::string> added_signals; // 用于记录已添加的信号
+    std::unordered_map<road::SignId, SharedPtr<Actor>> traffic_lights; // 只在需要时建立
+    bool traffic_lights_mapped = false;
     for (auto& landmark : landmarks) { // 遍历所有地标
       if (road::SignalType::IsTrafficLight(landmark->GetType())) { // 判断是否为交通信号灯
-        SharedPtr<Actor> traffic_light = GetTrafficLight(*(landmark.get())); // 获取交通信号灯
-        if (traffic_light) { // 如果找到交通信号灯
+        if (!traffic_lights_mapped) {
+          traffic_lights = MapTrafficLightsBySignId(*GetActors());
+          traffic_lights_mapped = true;
+        }
+        auto traffic_light = traffic_lights.find(landmark->GetId()); // 获取交通信号灯
+        if (traffic_light != traffic_lights.end()) { // 如果找到交通信号灯
           if(added_signals.count(landmark->GetId()) == 0) { // 检查是否未添加
-            Result.emplace_back(traffic_light); // 添加到结果中
+            Result.emplace_back(traffic_light->second); // 添加到结果中
             added_signals.insert(landmark->GetId()); // 标记为已添加
           }
         }
@@ -300,13 +444,14 @@ std::vector<SharedPtr<Actor>> World::GetTrafficLightsInJunction(
     std::vector<SharedPtr<Actor>> Result; // 保存结果的向量
     SharedPtr<Map> map = GetMap(); // 获取地图
     const road::Junction* junction = map->GetMap().GetJunction(junc_id); // 获取交叉口
+    const auto traffic_lights = MapTrafficLightsBySignId(*GetActors());
     for (const road::ContId& cont_id : junction->GetControllers()) { // 遍历控制器
       const std::unique_ptr<road::Controller>& controller =
           map->GetMap().GetControllers().at(cont_id); // 获取控制器
       for (road::SignId sign_id : controller->GetSignals()) { // 遍历控制器的信号
-        SharedPtr<Actor> traffic_light = GetTrafficLightFromOpenDRIVE(sign_id); // 从 OpenDRIVE 获取交通信号灯
-        if (traffic_light) { // 如果找到交通信号灯
-          Result.emplace_back(traffic_light); // 添加到结果中
+        auto traffic_light = traffic_lights.find(sign_id); // 从 OpenDRIVE 获取交通信号灯
+        if (traffic_light != traffic_lights.end()) { // 如果找到交通信号灯
+          Result.emplace_back(traffic_light->second); // 添加到结果中
         }
       }
     }
@@ -10,18 +10,26 @@
 
 #include "carla/Memory.h"
 #include "carla/Time.h"
+#include "carla/client/ActorListChanges.h"
+#include "carla/client/ActorStateChanges.h"
+#include "carla/client/ActorTrajectory.h"
 #include "carla/client/DebugHelper.h"
 #include "carla/client/Landmark.h"
 #include "carla/client/Waypoint.h"
 #include "carla/client/Junction.h"
 #include "carla/client/LightManager.h"
+#include "carla/client/RpcFuture.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/WorldSnapshot.h"
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/Actor.h"
+#include "carla/rpc/ActorQuery.h"
+#include "carla/rpc/ActorQueryResult.h"
 #include "carla/rpc/AttachmentType.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/FrameTimings.h"
+#include "carla/rpc/SensorTickPlan.h"
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/MapLayer.h"
@@ -31,11 +39,16 @@
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
 
+#include <functional>
 #include <string>
+#include <vector>
 #include <boost/optional.hpp>
   //引入了一些必要的头文件，包括内存管理、时间控制、调试工具、地图层信息、车辆和环境对象的RPC接口等。这些模块共同支持CARLA模拟环境的创建和控制。
 
 namespace carla {
+namespace sensor {
+  class SensorData;
+} // namespace sensor
 namespace client {
 
   class Actor;
@@ -72,6 +85,17 @@ namespace client {
 
     void UnloadLevelLayer(rpc::MapLayer map_layers) const;
 
+    /// 在后台分时加载 @a map_layers，不阻塞服务器和传感器。加载完成并注册了
+    /// 新的环境物体后，在之后某一帧的 tick 回调线程中调用 @a callback。
+    void LoadLevelLayerAsync(
+        rpc::MapLayer map_layers,
+        std::function<void()> callback = {}) const;
+
+    /// 与 LoadLevelLayerAsync 相同，但卸载 @a map_layers。
+    void UnloadLevelLayerAsync(
+        rpc::MapLayer map_layers,
+        std::function<void()> callback = {}) const;
+
     /// 返回当前世界中可用的蓝图列表. 
     /// 这个蓝图可以用来在世界中生成参与者(actor).
     SharedPtr<BlueprintLibrary> GetBlueprintLibrary() const;
@@ -107,6 +131,20 @@ namespace client {
     /// 返回当前世界的快照.
     WorldSnapshot GetSnapshot() const;
 
+    /// 返回自序号 @a sequence 以来出现和销毁的参与者，按接收到的剧集状态计算，
+    /// 不需要调用服务器。第一次调用时传入 0，之后传入上一次返回的序号；返回的
+    /// complete 为 false 时需要用 GetActors() 重新获取完整的列表.
+    ActorListChanges GetActorListChanges(uint64_t sequence) const;
+
+    /// 在客户端保留最近 @a max_duration 秒（最多 @a max_frames 帧）的参与者
+    /// 状态，用于 GetActorTrajectory。默认不保留，任一为 0 时停止记录并释放
+    /// 内存.
+    void ConfigureStateHistory(double max_duration, size_t max_frames);
+
+    /// 返回参与者 @a id 在模拟时间 [@a begin, @a end]（秒）内记录的轨迹，不需要
+    /// 调用服务器.
+    std::shared_ptr<const ActorTrajectory> GetActorTrajectory(ActorId id, double begin, double end) const;
+
     /// 根据id查找actor，如果没有找到则返回nullptr.
     SharedPtr<Actor> GetActor(ActorId id) const;
 
@@ -116,6 +154,21 @@ namespace client {
     /// 返回一个包含ActorId请求的参与者(actor)的列表.
     SharedPtr<ActorList> GetActors(const std::vector<ActorId> &actor_ids) const;
 
+    /// 返回一个包含当前世界上类型 ID 与 @a wildcard_pattern 匹配的参与者(actor)
+    /// 的列表。只访问匹配的参与者，描述已缓存时不需要调用服务器.
+    SharedPtr<ActorList> FilterActors(const std::string &wildcard_pattern) const;
+
+    /// 返回一个包含当前世界上与 @a location 的距离不超过 @a radius（米）且类型
+    /// ID 与 @a wildcard_pattern 匹配的参与者(actor)的列表.
+    SharedPtr<ActorList> GetActorsInRadius(
+        const geom::Location &location,
+        float radius,
+        const std::string &wildcard_pattern = "*") const;
+
+    /// 在一次调用中查询符合 @a query 条件的所有参与者(actor)的指定字段，
+    /// 结果按列返回。适合每一帧查询大量参与者的属性和状态.
+    rpc::ActorQueryResult QueryActors(const rpc::ActorQuery &query) const;
+
     /// 根据 @a 转换中提供的 @a 蓝图，在世界中生成一个参与者(actor).
     /// 如果提供了 @a 父类，则参与者(actor)被附加到 @a 父类.
     SharedPtr<Actor> SpawnActor(
@@ -136,6 +189,14 @@ namespace client {
     /// 阻塞调用线程，直到接收到一个世界刻.
     WorldSnapshot WaitForTick(time_duration timeout) const;
 
+    /// 返回最近 @a count 帧（服务器最多保留 1000 帧）在服务器和此客户端各阶段
+    /// 所用的时间，按帧号升序排列.
+    std::vector<rpc::FrameTimings> GetFrameTimings(uint64_t count = 1u) const;
+
+    /// 返回服务器为传感器分配的帧相位，以及之后 @a frames 帧每一帧的
+    /// 传感器估计开销.
+    rpc::SensorTickPlan GetSensorTickPlan(uint32_t frames = 20u) const;
+
     /// 注册一个 @a 回调函数，在每次接收到世界刻时调用.
     ///
     /// @return 回调函数的ID，用它来删除回调函数.
@@ -144,11 +205,59 @@ namespace client {
     /// Remove a callback registered with OnTick.
     void RemoveOnTick(size_t callback_id);
 
+    /// 注册一个 @a 回调函数，每帧以出现、销毁、移动超过阈值的参与者以及交通灯
+    /// 和车灯状态的变化调用，在 OnTick 的回调之前调用，没有变化的帧不调用。
+    /// 变化在客户端比较连续的剧集状态得到，注册后的第一次调用中已有的参与者都
+    /// 在 spawned 中.
+    ///
+    /// @return 回调函数的ID，用它来删除回调函数.
+    size_t OnActorChanges(std::function<void(const ActorStateChanges &)> callback);
+
+    /// 删除用 OnActorChanges 注册的回调函数.
+    void RemoveOnActorChanges(size_t callback_id);
+
+    /// 参与者相对上一次报告的位置移动超过 @a meters 米时报告移动，默认 0.1 米.
+    void SetActorChangesMoveThreshold(float meters);
+
+    /// 同时监听一组传感器：服务器将这些传感器同一帧的数据合并为一条消息，
+    /// 所有数据到达后调用一次 @a callback，数据按 @a sensor_ids 的顺序排列。
+    ///
+    /// @return 传感器组的 ID，用它来停止监听.
+    uint32_t ListenToSensors(
+        const std::vector<ActorId> &sensor_ids,
+        std::function<void(std::vector<SharedPtr<sensor::SensorData>>)> callback);
+
+    /// 停止监听 ListenToSensors 创建的传感器组.
+    void StopListeningToSensors(uint32_t bundle_id);
+
     /// 通知模拟器继续进行下一个节拍(仅对同步模式有效).
     ///
     /// @return 这个调用开始的帧的id.
     uint64_t Tick(time_duration timeout);
 
+    /// 与 Tick 相同，但不等待这一帧的快照，结果就绪时就已经收到了快照。
+    RpcFuture<uint64_t> TickAsync(time_duration timeout);
+
+    /// 将此客户端注册为同步模式下节拍屏障的参与者。有参与者时，每当所有
+    /// 参与者都通过 NotifyTickReady 确认处理完当前帧，模拟器就开始下一帧，
+    /// 不需要调用 Tick。
+    ///
+    /// @param deadline 大于 0 时，模拟器最多等待此参与者这么长时间，超时后
+    /// 不再等待它而开始下一帧；为 0 时一直等待。
+    /// @return 参与者的 ID.
+    uint32_t RegisterTickParticipant(
+        const std::string &name,
+        time_duration deadline = time_duration::seconds(0u));
+
+    /// 注销节拍屏障的参与者.
+    void UnregisterTickParticipant(uint32_t participant_id);
+
+    /// 通知模拟器参与者已处理完 @a frame，不等待响应.
+    void NotifyTickReady(uint32_t participant_id, uint64_t frame);
+
+    /// 通知模拟器参与者已处理完此客户端收到的最后一帧.
+    void NotifyTickReady(uint32_t participant_id);
+
     /// 设置一个代理表示在它的路径中穿过道路的概率.
     /// 0.0f表示行人不得过马路
     /// 0.5f表示50%的行人可以过马路
@@ -168,6 +277,16 @@ namespace client {
 
     void ResetAllTrafficLights();
 
+    /// 在服务端保存场景的当前状态（actor 的变换、速度和控制，交通信号灯的计时器，
+    /// 天气和时间），返回用来恢复它的 Id。
+    uint64_t SaveState() const;
+
+    /// 把场景恢复到 SaveState 保存的状态，可以多次恢复同一个状态。
+    void RestoreState(uint64_t state_id) const;
+
+    /// 释放 SaveState 保存的状态。
+    void RemoveState(uint64_t state_id) const;
+
     SharedPtr<LightManager> GetLightManager() const;
 
     DebugHelper MakeDebugHelper() const {
@@ -185,6 +304,13 @@ namespace client {
 
     std::vector<rpc::EnvironmentObject> GetEnvironmentObjects(uint8_t queried_tag) const;
 
+    /// 返回包围盒中心与 @a location 的距离不超过 @a radius（米）且标签为
+    /// @a queried_tag 的环境物体。服务器在网格中查找，不会遍历整个列表.
+    std::vector<rpc::EnvironmentObject> GetEnvironmentObjectsInRadius(
+        const geom::Location &location,
+        float radius,
+        uint8_t queried_tag) const;
+
     void EnableEnvironmentObjects(
       std::vector<uint64_t> env_objects_ids,
       bool enable) const;
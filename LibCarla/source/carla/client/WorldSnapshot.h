@@ -60,6 +60,16 @@ namespace client {
     auto end() const {
       return _state->end();
     }
+
+    /// 按列存储的所有参与者的状态，同一个快照只生成一次。
+    std::shared_ptr<const ActorSnapshotColumns> GetColumns() const {
+      return _state->GetActorSnapshotColumns();
+    }
+
+    /// 与 @a location 的距离不超过 @a radius（米）的参与者的 ID。
+    std::vector<ActorId> GetActorIdsInRadius(const geom::Location &location, float radius) const {
+      return _state->GetActorSpatialGrid()->GetActorIdsInRadius(location, radius);
+    }
     // 重载等于运算符，判断两个 WorldSnapshot 对象是否相等，仅当时间戳相等时返回 true
     bool operator==(const WorldSnapshot &rhs) const {
       return GetTimestamp() == rhs.GetTimestamp();
@@ -0,0 +1,134 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/ActorChangeFeed.h"
+
+#include "carla/StringUtil.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  constexpr float ActorChangeFeed::DEFAULT_MOVE_THRESHOLD;
+
+  ActorChangeFeed::ActorKind ActorChangeFeed::GetActorKind(const std::string &type_id) {
+    if (StringUtil::StartsWith(type_id, "vehicle.")) {
+      return ActorKind::Vehicle;
+    }
+    if (StringUtil::StartsWith(type_id, "traffic.traffic_light")) {
+      return ActorKind::TrafficLight;
+    }
+    return ActorKind::Other;
+  }
+
+  void ActorChangeFeed::SetMoveThreshold(const float meters) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _move_threshold = std::max(meters, 0.0f);
+  }
+
+  float ActorChangeFeed::GetMoveThreshold() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _move_threshold;
+  }
+
+  void ActorChangeFeed::OnEpisodeChanged() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _episode_changed = true;
+  }
+
+  void ActorChangeFeed::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _episode_changed = false;
+    _records.clear();
+  }
+
+  void ActorChangeFeed::BeginUpdate(const uint64_t frame, ActorStateChanges &changes) {
+    changes.frame = frame;
+    if (_episode_changed) {
+      // 新剧集可能复用之前的 ID，旧的参与者全部报告为销毁
+      _episode_changed = false;
+      changes.episode_changed = true;
+      changes.destroyed.reserve(_records.size());
+      for (const auto &item : _records) {
+        changes.destroyed.emplace_back(item.first);
+      }
+      _records.clear();
+    }
+    ++_generation;
+  }
+
+  bool ActorChangeFeed::Visit(const ActorSnapshot &actor, ActorStateChanges &changes) {
+    auto it = _records.find(actor.id);
+    if (it == _records.end()) {
+      return false;
+    }
+    Record &record = it->second;
+    record.generation = _generation;
+
+    const auto &location = actor.transform.location;
+    if (geom::Math::DistanceSquared(location, record.location) > _move_threshold * _move_threshold) {
+      record.location = location;
+      changes.moved.emplace_back(actor.id);
+    }
+
+    if (record.kind == ActorKind::TrafficLight) {
+      const auto state = actor.state.traffic_light_data.state;
+      if (state != record.traffic_light_state) {
+        changes.traffic_lights.push_back({actor.id, record.traffic_light_state, state});
+        record.traffic_light_state = state;
+      }
+    } else if (record.kind == ActorKind::Vehicle) {
+      const auto state = actor.state.vehicle_data.light_state;
+      if (state != record.light_state) {
+        changes.vehicle_lights.push_back({actor.id, record.light_state, state});
+        record.light_state = state;
+      }
+    }
+    return true;
+  }
+
+  void ActorChangeFeed::Insert(
+      const ActorSnapshot &actor,
+      const ActorKind kind,
+      ActorStateChanges &changes) {
+    Record record;
+    record.location = actor.transform.location;
+    record.generation = _generation;
+    record.kind = kind;
+    record.traffic_light_state = (kind == ActorKind::TrafficLight) ?
+        actor.state.traffic_light_data.state :
+        rpc::TrafficLightState::Unknown;
+    record.light_state = (kind == ActorKind::Vehicle) ?
+        actor.state.vehicle_data.light_state :
+        rpc::VehicleLightState::flag_type{0u};
+    _records.emplace(actor.id, record);
+    changes.spawned.emplace_back(actor.id);
+  }
+
+  void ActorChangeFeed::EndUpdate(ActorStateChanges &changes) {
+    for (auto it = _records.begin(); it != _records.end();) {
+      if (it->second.generation != _generation) {
+        changes.destroyed.emplace_back(it->first);
+        it = _records.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // 快照按哈希表的顺序遍历，排序后结果与遍历顺序无关
+    std::sort(changes.spawned.begin(), changes.spawned.end());
+    std::sort(changes.destroyed.begin(), changes.destroyed.end());
+    std::sort(changes.moved.begin(), changes.moved.end());
+    const auto by_id = [](const auto &lhs, const auto &rhs) { return lhs.id < rhs.id; };
+    std::sort(changes.traffic_lights.begin(), changes.traffic_lights.end(), by_id);
+    std::sort(changes.vehicle_lights.begin(), changes.vehicle_lights.end(), by_id);
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
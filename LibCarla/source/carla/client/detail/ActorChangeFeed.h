@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/client/ActorSnapshot.h"
+#include "carla/client/ActorStateChanges.h"
+#include "carla/geom/Location.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// 比较每一帧的参与者快照与之前记录的状态，得到 ActorStateChanges。
+  ///
+  /// 每个参与者只记录上一次报告的位置、交通灯状态和车灯状态，因此缓慢移动的
+  /// 参与者在累计移动超过阈值时也会被报告。第一次调用 Update 时已有的参与者都
+  /// 报告为新出现。
+  class ActorChangeFeed : private NonCopyable {
+  public:
+
+    /// 快照中类型相关的状态需要按参与者的类型解释。
+    enum class ActorKind : uint8_t {
+      Other,
+      Vehicle,
+      TrafficLight
+    };
+
+    static constexpr float DEFAULT_MOVE_THRESHOLD = 0.1f;
+
+    static ActorKind GetActorKind(const std::string &type_id);
+
+    /// 位置变化超过 @a meters 米时报告参与者移动，为 0 时报告任何移动。
+    void SetMoveThreshold(float meters);
+
+    float GetMoveThreshold() const;
+
+    /// 比较一帧的参与者 @a actors（ActorSnapshot 的范围）与记录的状态。
+    /// @a kind_of(id) 只对新出现的参与者调用，返回其 ActorKind。
+    template <typename RangeT, typename KindFunctorT>
+    ActorStateChanges Update(uint64_t frame, const RangeT &actors, KindFunctorT &&kind_of) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ActorStateChanges changes;
+      BeginUpdate(frame, changes);
+      for (const ActorSnapshot &actor : actors) {
+        if (!Visit(actor, changes)) {
+          Insert(actor, kind_of(actor.id), changes);
+        }
+      }
+      EndUpdate(changes);
+      return changes;
+    }
+
+    /// 剧集改变后调用，之前记录的参与者在下一次 Update 中报告为销毁。
+    void OnEpisodeChanged();
+
+    /// 丢弃记录的状态，不报告任何变化。
+    void Clear();
+
+  private:
+
+    struct Record {
+      geom::Location location;
+      uint64_t generation;
+      ActorKind kind;
+      rpc::TrafficLightState traffic_light_state;
+      rpc::VehicleLightState::flag_type light_state;
+    };
+
+    void BeginUpdate(uint64_t frame, ActorStateChanges &changes);
+
+    /// 参与者没有记录时返回 false。
+    bool Visit(const ActorSnapshot &actor, ActorStateChanges &changes);
+
+    void Insert(const ActorSnapshot &actor, ActorKind kind, ActorStateChanges &changes);
+
+    void EndUpdate(ActorStateChanges &changes);
+
+    mutable std::mutex _mutex;
+
+    float _move_threshold = DEFAULT_MOVE_THRESHOLD;
+
+    bool _episode_changed = false;
+
+    /// 每次 Update 加一，记录中的值不等于它的参与者已经销毁。
+    uint64_t _generation = 0u;
+
+    std::unordered_map<ActorId, Record> _records;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
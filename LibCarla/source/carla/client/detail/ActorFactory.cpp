@@ -9,6 +9,7 @@
 #include "carla/Logging.h"
 #include "carla/StringUtil.h"
 #include "carla/client/Actor.h"
+#include "carla/client/ActorAttribute.h"
 #include "carla/client/LaneInvasionSensor.h"
 #include "carla/client/ServerSideSensor.h"
 #ifdef RSS_ENABLED
@@ -79,6 +80,16 @@ namespace detail {
     return SharedPtr<ActorT>{new ActorT(std::move(init))};// 否则直接返回普通的 shared_ptr
   }
 
+  // 车道入侵传感器设置了 server_side 时由服务器计算并发送事件，客户端只需订阅数据流。
+  static bool IsServerSideLaneInvasionSensor(const rpc::Actor &description) {
+    for (const auto &attribute : description.description.attributes) {
+      if (attribute.id == "server_side") {
+        return ActorAttributeValue(attribute).As<bool>();
+      }
+    }
+    return false;
+  }
+
   // ActorFactory 类的成员函数：创建不同类型的 Actor 实例。
 // episode: 当前场景的 EpisodeProxy，代表仿真中的当前环境。
 // description: rpc::Actor，包含 Actor 的描述信息。
@@ -90,7 +101,8 @@ namespace detail {
       // 创建 ActorInitializer 实例，传递给具体 Actor 构造函数
     auto init = ActorInitializer{description, episode};
     // 判断传入的 Actor 描述信息，创建对应类型的 Actor 实例
-    if (description.description.id == "sensor.other.lane_invasion") {
+    if ((description.description.id == "sensor.other.lane_invasion") &&
+        !IsServerSideLaneInvasionSensor(description)) {
         // 创建车道入侵传感器实例
       return MakeActorImpl<LaneInvasionSensor>(std::move(init), gc);
 #ifdef RSS_ENABLED
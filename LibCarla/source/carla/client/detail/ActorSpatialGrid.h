@@ -0,0 +1,104 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/client/ActorSnapshot.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// 按参与者在 XY 平面上的位置划分的均匀网格，用于查询某一位置附近的参与者。
+  class ActorSpatialGrid : private NonCopyable {
+  public:
+
+    /// 网格单元的边长（米）。
+    static constexpr float CELL_SIZE = 50.0f;
+
+    template <typename IteratorT>
+    ActorSpatialGrid(IteratorT begin, IteratorT end) {
+      for (; begin != end; ++begin) {
+        const auto &location = begin->transform.location;
+        _entries.emplace_back(Entry{begin->id, location});
+        _cells[MakeKey(CellIndex(location.x), CellIndex(location.y))].emplace_back(
+            _entries.size() - 1u);
+      }
+    }
+
+    /// 返回与 @a location 的距离不超过 @a radius（米）的参与者 ID。
+    std::vector<ActorId> GetActorIdsInRadius(const geom::Location &location, float radius) const {
+      std::vector<ActorId> result;
+      if (radius < 0.0f) {
+        return result;
+      }
+      const float radius_squared = radius * radius;
+      auto add_if_in_radius = [&](size_t index) {
+        const auto &entry = _entries[index];
+        if (geom::Math::DistanceSquared(entry.location, location) <= radius_squared) {
+          result.emplace_back(entry.id);
+        }
+      };
+      const auto min_x = CellIndex(location.x - radius);
+      const auto max_x = CellIndex(location.x + radius);
+      const auto min_y = CellIndex(location.y - radius);
+      const auto max_y = CellIndex(location.y + radius);
+      const auto number_of_cells =
+          (static_cast<double>(max_x) - min_x + 1.0) * (static_cast<double>(max_y) - min_y + 1.0);
+      if (number_of_cells > static_cast<double>(_cells.size())) {
+        // 半径很大时，逐个检查参与者比遍历覆盖的单元更快。
+        for (auto i = 0u; i < _entries.size(); ++i) {
+          add_if_in_radius(i);
+        }
+        return result;
+      }
+      for (auto x = min_x; x <= max_x; ++x) {
+        for (auto y = min_y; y <= max_y; ++y) {
+          auto it = _cells.find(MakeKey(x, y));
+          if (it != _cells.end()) {
+            for (auto index : it->second) {
+              add_if_in_radius(index);
+            }
+          }
+        }
+      }
+      return result;
+    }
+
+  private:
+
+    struct Entry {
+      ActorId id;
+      geom::Location location;
+    };
+
+    static int32_t CellIndex(float coordinate) {
+      return static_cast<int32_t>(std::floor(coordinate / CELL_SIZE));
+    }
+
+    static uint64_t MakeKey(int32_t x, int32_t y) {
+      return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32u) |
+          static_cast<uint64_t>(static_cast<uint32_t>(y));
+    }
+
+    std::vector<Entry> _entries;
+
+    std::unordered_map<uint64_t, std::vector<size_t>> _cells;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -7,13 +7,21 @@
 #pragma once
 
 #include "carla/NonCopyable.h"
+#include "carla/StringUtil.h"
 #include "carla/rpc/Actor.h"
 
 #include <boost/iterator/transform_iterator.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
 #include <iterator>
 #include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -25,7 +33,9 @@ namespace detail {
 
   /// 保留参与者描述列表，以避免每次都向服务器请求描述。
   ///
-  /// @todo Dead actors are never removed from the list.
+  /// 列表根据剧集状态中参与者的增加和删除增量地更新：删除的参与者被移出
+  /// 列表，新出现的参与者被记为待获取，之后通过一次调用获取它们的描述。
+  /// 列表还按类型 ID 排序索引参与者，按通配符过滤时只访问匹配前缀的参与者。
   class CachedActorList : private MovableNonCopyable {
   public:
 
@@ -47,36 +57,75 @@ namespace detail {
     template <typename RangeT>
     std::vector<rpc::Actor> GetActorsById(const RangeT &range) const;
 
+    /// 根据剧集状态的变化更新列表：移除 @a removed 中的参与者，并将
+    /// @a added 中尚未缓存的参与者记为待获取。
+    template <typename AddedRangeT, typename RemovedRangeT>
+    void Update(const AddedRangeT &added, const RemovedRangeT &removed);
+
+    /// 返回待获取描述的参与者 ID。
+    std::vector<ActorId> GetPendingIds() const;
+
+    /// 插入为待获取的 @a ids 获取到的参与者 @a actors。获取期间已被移除的
+    /// 参与者不会被插入，@a ids 中服务器没有返回的参与者也不再是待获取的。
+    void ResolvePending(const std::vector<ActorId> &ids, std::vector<rpc::Actor> actors);
+
+    /// 检索类型 ID 与 @a wildcard_pattern 匹配的参与者，按类型 ID 排序。
+    /// 只访问类型 ID 以通配符之前的前缀开头的参与者。
+    std::vector<rpc::Actor> GetActorsByTypeId(const std::string &wildcard_pattern) const;
+
     void Clear();
 
   private:
 
+    using TypeIndexKey = std::pair<std::string, ActorId>;
+
+    void InsertLocked(rpc::Actor actor);
+
+    void EraseLocked(ActorId id);
+
     mutable std::mutex _mutex;
 
     std::unordered_map<ActorId, rpc::Actor> _actors;
+
+    /// (类型 ID, 参与者 ID)，按类型 ID 排序。
+    std::set<TypeIndexKey> _by_type_id;
+
+    std::unordered_set<ActorId> _pending;
   };
 
   // ===========================================================================
   // -- 缓冲的参与者列表 CachedActorList implementation 实现 ---------------------
   // ===========================================================================
 
+  inline void CachedActorList::InsertLocked(rpc::Actor actor) {
+    auto id = actor.id;
+    _pending.erase(id);
+    auto result = _actors.emplace(id, std::move(actor));
+    if (result.second) {
+      _by_type_id.emplace(result.first->second.description.id, id);
+    }
+  }
+
+  inline void CachedActorList::EraseLocked(ActorId id) {
+    _pending.erase(id);
+    auto it = _actors.find(id);
+    if (it != _actors.end()) {
+      _by_type_id.erase(TypeIndexKey{it->second.description.id, id});
+      _actors.erase(it);
+    }
+  }
+
   inline void CachedActorList::Insert(rpc::Actor actor) {
     std::lock_guard<std::mutex> lock(_mutex);
-    auto id = actor.id;
-    _actors.emplace(id, std::move(actor));
+    InsertLocked(std::move(actor));
   }
 
   template <typename RangeT>
   inline void CachedActorList::InsertRange(RangeT range) {
-    auto make_a_pair = [](rpc::Actor actor) {
-      auto id = actor.id;
-      return std::make_pair(id, std::move(actor));
-    };
-    auto make_iterator = [&make_a_pair](auto it) {
-      return boost::make_transform_iterator(std::make_move_iterator(it), make_a_pair);
-    };
     std::lock_guard<std::mutex> lock(_mutex);
-    _actors.insert(make_iterator(std::begin(range)), make_iterator(std::end(range)));
+    for (auto &&actor : range) {
+      InsertLocked(std::move(actor));
+    }
   }
 
   template <typename RangeT>
@@ -113,9 +162,61 @@ namespace detail {
     return result;
   }
 
+  template <typename AddedRangeT, typename RemovedRangeT>
+  inline void CachedActorList::Update(const AddedRangeT &added, const RemovedRangeT &removed) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &&id : removed) {
+      EraseLocked(id);
+    }
+    for (auto &&id : added) {
+      if (_actors.find(id) == _actors.end()) {
+        _pending.insert(id);
+      }
+    }
+  }
+
+  inline std::vector<ActorId> CachedActorList::GetPendingIds() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return {_pending.begin(), _pending.end()};
+  }
+
+  inline void CachedActorList::ResolvePending(
+      const std::vector<ActorId> &ids,
+      std::vector<rpc::Actor> actors) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &&actor : actors) {
+      if (_pending.find(actor.id) != _pending.end()) {
+        InsertLocked(std::move(actor));
+      }
+    }
+    for (auto id : ids) {
+      _pending.erase(id);
+    }
+  }
+
+  inline std::vector<rpc::Actor> CachedActorList::GetActorsByTypeId(
+      const std::string &wildcard_pattern) const {
+    const auto prefix = StringUtil::GetWildcardPrefix(wildcard_pattern);
+    const bool is_literal = (prefix.size() == wildcard_pattern.size());
+    const bool match_all = (wildcard_pattern == "*");
+    std::vector<rpc::Actor> result;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _by_type_id.lower_bound(TypeIndexKey{prefix, 0u});
+         (it != _by_type_id.end()) && StringUtil::StartsWith(it->first, prefix);
+         ++it) {
+      if (match_all ||
+          (is_literal ? (it->first == wildcard_pattern) : StringUtil::Match(it->first, wildcard_pattern))) {
+        result.emplace_back(_actors.at(it->second));
+      }
+    }
+    return result;
+  }
+
   inline void CachedActorList::Clear() {
     std::lock_guard<std::mutex> lock(_mutex);
     _actors.clear();
+    _by_type_id.clear();
+    _pending.clear();
   }
 
 } // namespace detail
@@ -6,16 +6,19 @@
 
 #pragma once
 
-#include "carla/AtomicList.h"
 #include "carla/NonCopyable.h"
+#include "carla/RcuList.h"
 
 #include <atomic>
 #include <functional>
+#include <memory>
 
 namespace carla {
 namespace client {
 namespace detail {
 
+  /// 调用回调不加锁也不分配内存；回调保存在共享指针中，注册和注销只复制
+  /// 指针。回调中可以注册或注销回调，本次调用仍使用调用开始时的列表。
   template <typename... InputsT>
   class CallbackList : private NonCopyable {
   public:
@@ -23,16 +26,15 @@ namespace detail {
     using CallbackType = std::function<void(InputsT...)>;
 
     void Call(InputsT... args) const {
-      auto list = _list.Load();
-      for (auto &item : *list) {
-        item.callback(args...);
-      }
+      _list.ForEach([&](const Item &item) {
+        (*item.callback)(args...);
+      });
     }
 
     size_t Push(CallbackType &&callback) {
       auto id = ++_counter;
       DEBUG_ASSERT(id != 0u);
-      _list.Push(Item{id, std::move(callback)});
+      _list.Push(Item{id, std::make_shared<const CallbackType>(std::move(callback))});
       return id;
     }
 
@@ -44,11 +46,15 @@ namespace detail {
       _list.Clear();
     }
 
+    bool empty() const {
+      return _list.size() == 0u;
+    }
+
   private:
 
     struct Item {
       size_t id;
-      CallbackType callback;
+      std::shared_ptr<const CallbackType> callback;
 
       friend bool operator==(const Item &lhs, const Item &rhs) {
         return lhs.id == rhs.id;
@@ -65,7 +71,7 @@ namespace detail {
 
     std::atomic_size_t _counter{0u};
 
-    AtomicList<Item> _list;
+    RcuList<Item> _list;
   };
 
 } // namespace detail
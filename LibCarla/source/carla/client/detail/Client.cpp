@@ -6,7 +6,10 @@
 
 #include "carla/client/detail/Client.h"
 
+#include "carla/ContentHash.h"
 #include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
@@ -15,7 +18,9 @@
 #include "carla/rpc/BoneTransformDataIn.h"
 #include "carla/rpc/Client.h"
 #include "carla/rpc/DebugShape.h"
+#include "carla/rpc/FileInfo.h"
 #include "carla/rpc/Response.h"
+#include "carla/rpc/ResponseView.h"
 #include "carla/rpc/VehicleAckermannControl.h"
 #include "carla/rpc/VehicleControl.h"
 #include "carla/rpc/VehicleLightState.h"
@@ -26,7 +31,14 @@
 
 #include <rpc/rpc_error.h>
 
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -34,13 +46,72 @@ namespace detail {
 
   template <typename T>
   static T Get(carla::rpc::Response<T> &response) {
-    return response.Get();
+    return std::move(response.Get());
   }
 
   static bool Get(carla::rpc::Response<void> &) {
     return true;
   }
 
+  // ===========================================================================
+  // -- RpcConnectionPool ------------------------------------------------------
+  // ===========================================================================
+
+  /// 已销毁的客户端留下的 RPC 连接，按端点复用。短时间内创建大量客户端时，
+  /// 不需要每次都重新建立连接。
+  class RpcConnectionPool : private NonCopyable {
+  public:
+
+    static RpcConnectionPool &Get() {
+      static RpcConnectionPool pool;
+      return pool;
+    }
+
+    std::unique_ptr<rpc::Client> Acquire(const std::string &host, uint16_t port) {
+      const auto endpoint = host + ":" + std::to_string(port);
+      std::unique_ptr<rpc::Client> client;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _idle.begin(); it != _idle.end(); ++it) {
+          if (it->first == endpoint) {
+            client = std::move(it->second);
+            _idle.erase(it);
+            break;
+          }
+        }
+      }
+      if ((client == nullptr) || !client->is_connected()) {
+        client = std::make_unique<rpc::Client>(host, port);
+      } else {
+        log_debug("reusing rpc connection to", endpoint);
+      }
+      return client;
+    }
+
+    void Release(std::string endpoint, std::unique_ptr<rpc::Client> client) {
+      if ((client == nullptr) || !client->is_connected()) {
+        return;
+      }
+      std::unique_ptr<rpc::Client> evicted;
+      std::lock_guard<std::mutex> lock(_mutex);
+      _idle.emplace_back(std::move(endpoint), std::move(client));
+      if (_idle.size() > MAX_IDLE_CONNECTIONS) {
+        evicted = std::move(_idle.front().second);
+        _idle.erase(_idle.begin());
+      }
+    }
+
+  private:
+
+    RpcConnectionPool() = default;
+
+    static constexpr size_t MAX_IDLE_CONNECTIONS = 8u;
+
+    std::mutex _mutex;
+
+    std::vector<std::pair<std::string, std::unique_ptr<rpc::Client>>> _idle;
+  };
+
   // ===========================================================================
   // -- Client::Pimpl ----------------------------------------------------------
   // ===========================================================================
@@ -50,13 +121,18 @@ namespace detail {
 
     Pimpl(const std::string &host, uint16_t port, size_t worker_threads)
       : endpoint(host + ":" + std::to_string(port)),
-        rpc_client(host, port),
+        rpc_connection(RpcConnectionPool::Get().Acquire(host, port)),
+        rpc_client(*rpc_connection),
         streaming_client(host) {
       rpc_client.set_timeout(5000u);
       streaming_client.AsyncRun(
           worker_threads > 0u ? worker_threads : std::thread::hardware_concurrency());
     }
 
+    ~Pimpl() {
+      RpcConnectionPool::Get().Release(endpoint, std::move(rpc_connection));
+    }
+
     template <typename ... Args>
     auto RawCall(const std::string &function, Args && ... args) {
       try {
@@ -77,12 +153,59 @@ namespace detail {
       return Get(response);
     }
 
+    /// 与 CallAndWait 相同，但返回值的视图，不复制其中的字符串和二进制数据。
+    template <typename ... Args>
+    MsgPackView CallAndView(const std::string &function, Args && ... args) {
+      const rpc::ResponseView response(MsgPackView(RawCall(function, std::forward<Args>(args) ...)));
+      if (response.HasError()) {
+        throw_exception(std::runtime_error(response.GetError().What()));
+      }
+      return response.Get();
+    }
+
+    /// 与 CallAndView 相同，但不等待响应。
+    template <typename ... Args>
+    RpcFuture<MsgPackView> CallAndViewAsync(const std::string &function, Args && ... args) {
+      return MakeFuture<MsgPackView>(
+          rpc_client.pipelined_call(function, std::forward<Args>(args) ...),
+          [](auto &object) {
+            const rpc::ResponseView response(MsgPackView(std::move(object)));
+            if (response.HasError()) {
+              throw_exception(std::runtime_error(response.GetError().What()));
+            }
+            return response.Get();
+          });
+    }
+
     template <typename ... Args>
     void AsyncCall(const std::string &function, Args && ... args) {
       // Discard returned future.
       rpc_client.async_call(function, std::forward<Args>(args) ...);
     }
 
+    /// 与 RawCall 相同，但不等待响应。
+    template <typename T, typename ... Args>
+    RpcFuture<T> RawCallAsync(const std::string &function, Args && ... args) {
+      return MakeFuture<T>(
+          rpc_client.pipelined_call(function, std::forward<Args>(args) ...),
+          [](auto &object) { return object.template as<T>(); });
+    }
+
+    /// 与 CallAndWait 相同，但不等待响应。
+    template <typename T, typename ... Args>
+    RpcFuture<T> CallAsync(const std::string &function, Args && ... args) {
+      return MakeFuture<T>(
+          rpc_client.pipelined_call(function, std::forward<Args>(args) ...),
+          [](auto &object) {
+            using R = typename carla::rpc::Response<T>;
+            auto response = object.template as<R>();
+            if (response.HasError()) {
+              throw_exception(std::runtime_error(response.GetError().What()));
+            }
+            return Get(response);
+          });
+    }
+
     time_duration GetTimeout() const {
       auto timeout = rpc_client.get_timeout();
       DEBUG_ASSERT(timeout.has_value());
@@ -91,7 +214,30 @@ namespace detail {
 
     const std::string endpoint;
 
-    rpc::Client rpc_client;
+    /// 从连接池中取得的连接，销毁时放回连接池。
+    std::unique_ptr<rpc::Client> rpc_connection;
+
+    rpc::Client &rpc_client;
+
+  private:
+
+    template <typename T, typename Future, typename Convert>
+    RpcFuture<T> MakeFuture(Future &&future, Convert convert) {
+      auto shared_future = std::make_shared<Future>(std::move(future));
+      return RpcFuture<T>(
+          [shared_future](time_duration timeout) {
+            return shared_future->wait_for(timeout.to_chrono()) == std::future_status::ready;
+          },
+          [shared_future, convert, endpoint=endpoint, timeout=GetTimeout()]() -> T {
+            if (shared_future->wait_for(timeout.to_chrono()) != std::future_status::ready) {
+              throw_exception(TimeoutException(endpoint, timeout));
+            }
+            auto object = shared_future->get();
+            return convert(object);
+          });
+    }
+
+  public:
 
     streaming::Client streaming_client;
   };
@@ -149,6 +295,23 @@ namespace detail {
     _pimpl->CallAndWait<void>("load_new_episode", std::move(map_name), reset_settings, map_layer);
   }
 
+  void Client::SoftResetEpisode(bool reset_settings) {
+    // 等待响应，之后的请求需要看到重置后的场景。
+    _pimpl->CallAndWait<void>("soft_reset_episode", reset_settings);
+  }
+
+  uint64_t Client::SaveEpisodeSnapshot() {
+    return _pimpl->CallAndWait<uint64_t>("save_episode_snapshot");
+  }
+
+  void Client::RestoreEpisodeSnapshot(uint64_t snapshot_id) {
+    _pimpl->CallAndWait<void>("restore_episode_snapshot", snapshot_id);
+  }
+
+  void Client::RemoveEpisodeSnapshot(uint64_t snapshot_id) {
+    _pimpl->CallAndWait<void>("remove_episode_snapshot", snapshot_id);
+  }
+
   void Client::LoadLevelLayer(rpc::MapLayer map_layer) const {
     // 等待响应，我们需要确定这一点。
     _pimpl->CallAndWait<void>("load_map_layer", map_layer);
@@ -159,6 +322,18 @@ namespace detail {
     _pimpl->CallAndWait<void>("unload_map_layer", map_layer);
   }
 
+  uint64_t Client::LoadLevelLayerAsync(rpc::MapLayer map_layer) const {
+    return _pimpl->CallAndWait<uint64_t>("load_map_layer_async", map_layer);
+  }
+
+  uint64_t Client::UnloadLevelLayerAsync(rpc::MapLayer map_layer) const {
+    return _pimpl->CallAndWait<uint64_t>("unload_map_layer_async", map_layer);
+  }
+
+  RpcFuture<bool> Client::IsLevelLayerRequestDoneAsync(const uint64_t request) const {
+    return _pimpl->CallAsync<bool>("is_map_layer_request_done", request);
+  }
+
   void Client::CopyOpenDriveToServer(std::string opendrive, const rpc::OpendriveGenerationParameters & params) {
     // 等待响应，我们需要确定这一点。
     _pimpl->CallAndWait<void>("copy_opendrive_to_file", std::move(opendrive), params);
@@ -191,40 +366,265 @@ namespace detail {
   }
 
   std::string Client::GetMapData() const{
-    return _pimpl->CallAndWait<std::string>("get_map_data");
+    const auto view = GetMapDataView();
+    const auto data = view.AsStringView();
+    return std::string(data.data(), data.size());
+  }
+
+  /// 按内容标识缓存的文件的路径。
+  static std::string GetContentCachePath(const std::string &content_hash, const char *extension) {
+    return std::string("ContentCache/") + content_hash + extension;
+  }
+
+  /// 读取内容标识为 @a content_hash 的缓存文件，文件不存在或内容不符时为空。
+  static std::vector<uint8_t> ReadContentCache(const std::string &path, const std::string &content_hash) {
+    auto content = FileTransfer::ReadFile(path);
+    if (!content.empty() && (ContentHash::Compute(content.data(), content.size()) != content_hash)) {
+      log_warning("discarding outdated cached file", path);
+      content.clear();
+    }
+    return content;
+  }
+
+  /// 写入缓存文件 @a path，先写入临时文件再替换：其他进程可能正在映射原来的
+  /// 文件，不能修改它的内容。
+  static bool ReplaceContentCache(const std::string &path, const uint8_t *data, size_t size) {
+    const auto part = path + ".part";
+    if (!FileTransfer::WriteFile(part, data, size) || !FileTransfer::RenameFile(part, path)) {
+      FileTransfer::RemoveFile(part);
+      return false;
+    }
+    return true;
+  }
+
+  std::string Client::GetMapData(const std::string &content_hash) const {
+    if (content_hash.empty()) {
+      return GetMapData();
+    }
+    const auto path = GetContentCachePath(content_hash, ".xodr");
+    const auto cached = ReadContentCache(path, content_hash);
+    if (!cached.empty()) {
+      log_debug("using cached OpenDRIVE", path);
+      return std::string(cached.begin(), cached.end());
+    }
+    const auto view = GetMapDataView();
+    const auto data = view.AsStringView();
+    FileTransfer::WriteFile(path, reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    return std::string(data.data(), data.size());
+  }
+
+  MsgPackView Client::GetMapDataView() const {
+    return _pimpl->CallAndView("get_map_data");
   }
 
   std::vector<uint8_t> Client::GetNavigationMesh() const {
-    return _pimpl->CallAndWait<std::vector<uint8_t>>("get_navigation_mesh");
+    const auto view = GetNavigationMeshView();
+    const auto data = view.AsBytes();
+    return std::vector<uint8_t>(data.begin(), data.end());
+  }
+
+  MsgPackView Client::GetNavigationMeshView() const {
+    return _pimpl->CallAndView("get_navigation_mesh");
+  }
+
+  std::vector<uint8_t> Client::GetNavigationMesh(const std::string &content_hash) const {
+    if (content_hash.empty()) {
+      return GetNavigationMesh();
+    }
+    const auto path = GetContentCachePath(content_hash, ".bin");
+    auto cached = ReadContentCache(path, content_hash);
+    if (!cached.empty()) {
+      log_debug("using cached navigation mesh", path);
+      return cached;
+    }
+    const auto view = GetNavigationMeshView();
+    const auto data = view.AsBytes();
+    ReplaceContentCache(path, data.begin(), data.size());
+    return std::vector<uint8_t>(data.begin(), data.end());
+  }
+
+  std::unique_ptr<MappedFile> Client::MapNavigationMesh(const std::string &content_hash) const {
+    if (content_hash.empty()) {
+      return nullptr;
+    }
+    const auto path = GetContentCachePath(content_hash, ".bin");
+    const auto full_path = FileTransfer::GetFullPath(path);
+    auto file = MappedFile::OpenCopyOnWrite(full_path);
+    if ((file != nullptr) && (ContentHash::Compute(file->data(), file->size()) != content_hash)) {
+      log_warning("discarding outdated cached file", path);
+      file.reset();
+    }
+    if (file == nullptr) {
+      const auto view = GetNavigationMeshView();
+      const auto data = view.AsBytes();
+      if (!ReplaceContentCache(path, data.begin(), data.size())) {
+        return nullptr;
+      }
+      file = MappedFile::OpenCopyOnWrite(full_path);
+    } else {
+      log_debug("mapping cached navigation mesh", path);
+    }
+    return file;
+  }
+
+  bool Client::AddWalkerToServerNavigation(rpc::ActorId walker, rpc::ActorId controller) {
+    return _pimpl->CallAndWait<bool>("walker_navigation_add", walker, controller);
+  }
+
+  void Client::RemoveWalkerFromServerNavigation(rpc::ActorId walker) {
+    _pimpl->AsyncCall("walker_navigation_remove", walker);
+  }
+
+  bool Client::SetServerNavigationWalkerTarget(rpc::ActorId walker, const geom::Location &to) {
+    return _pimpl->CallAndWait<bool>("walker_navigation_set_target", walker, to);
+  }
+
+  bool Client::SetServerNavigationWalkerMaxSpeed(rpc::ActorId walker, const float max_speed) {
+    return _pimpl->CallAndWait<bool>("walker_navigation_set_max_speed", walker, max_speed);
+  }
+
+  std::vector<geom::Location> Client::GetServerNavigationRandomLocations(const uint32_t count) {
+    using return_t = std::vector<geom::Location>;
+    return _pimpl->CallAndWait<return_t>("walker_navigation_random_locations", count);
+  }
+
+  void Client::SetServerNavigationPedestriansCrossFactor(const float percentage) {
+    _pimpl->AsyncCall("walker_navigation_set_cross_factor", percentage);
+  }
+
+  void Client::SetServerNavigationPedestriansSeed(const unsigned int seed) {
+    _pimpl->AsyncCall("walker_navigation_set_seed", seed);
   }
 
   bool Client::SetFilesBaseFolder(const std::string &path) {
     return FileTransfer::SetFilesBaseFolder(path);
   }
 
-  std::vector<std::string> Client::GetRequiredFiles(const std::string &folder, const bool download) const {
-    // 获取所需文件列表
-    auto requiredFiles = _pimpl->CallAndWait<std::vector<std::string>>("get_required_files", folder);
+  std::vector<std::string> Client::GetRequiredFiles(
+      const std::string &folder,
+      const bool download,
+      const FileTransfer::ProgressCallback &progress) const {
+    // 获取所需文件列表，每个文件名只从响应中复制一次
+    const auto view = _pimpl->CallAndView("get_required_files", folder);
+    std::vector<std::string> requiredFiles;
+    requiredFiles.reserve(view.size());
+    for (const auto &name : view.AsStringViewArray()) {
+      requiredFiles.emplace_back(name.data(), name.size());
+    }
 
     if (download) {
 
-      // 对于每个所需文件，检查它是否存在，否则请求它
-      for (auto requiredFile : requiredFiles) {
-        if (!FileTransfer::FileExists(requiredFile)) {
-          RequestFile(requiredFile);
-          log_info("Could not find the required file in cache, downloading... ", requiredFile);
-        } else {
-          log_info("Found the required file in cache! ", requiredFile);
-        }
+      // 对于每个所需文件，本地缓存中没有或内容不同时下载它
+      for (const auto &requiredFile : requiredFiles) {
+        RequestFile(requiredFile, progress);
       }
     }
     return requiredFiles;
   }
 
-  void Client::RequestFile(const std::string &name) const {
-    // 从服务器下载文件的二进制内容并写入客户端
-    auto content = _pimpl->CallAndWait<std::vector<uint8_t>>("request_file", name);
-    FileTransfer::WriteFile(name, content);
+  /// 每个分块请求的最大字节数。
+  static constexpr size_t FILE_CHUNK_SIZE = 4u << 20u;
+
+  /// 同时在传输中的分块请求数。
+  static constexpr size_t FILE_CHUNKS_IN_FLIGHT = 4u;
+
+  /// 与缓存中的 @a name 一起保存的内容标识的路径。
+  static std::string GetContentHashPath(const std::string &name) {
+    return name + ".hash";
+  }
+
+  /// 缓存中的 @a name 的内容是否与 @a info 相同。
+  static bool IsFileCached(const std::string &name, const rpc::FileInfo &info) {
+    if (!FileTransfer::FileExists(name) || (FileTransfer::GetFileSize(name) != info.size)) {
+      return false;
+    }
+    const auto stored = FileTransfer::ReadFile(GetContentHashPath(name));
+    if (!stored.empty()) {
+      return std::string(stored.begin(), stored.end()) == info.content_hash;
+    }
+    // 没有内容标识的文件（例如旧版本下载的）计算一次后保存
+    if (FileTransfer::ComputeContentHash(name) != info.content_hash) {
+      return false;
+    }
+    FileTransfer::WriteFile(
+        GetContentHashPath(name),
+        reinterpret_cast<const uint8_t *>(info.content_hash.data()),
+        info.content_hash.size());
+    return true;
+  }
+
+  void Client::RequestFile(const std::string &name, const FileTransfer::ProgressCallback &progress) const {
+    const auto info = _pimpl->CallAndWait<rpc::FileInfo>("get_file_info", name);
+    if (info.content_hash.empty()) {
+      log_warning("required file not found in the server:", name);
+      return;
+    }
+    const auto total = static_cast<size_t>(info.size);
+    if (IsFileCached(name, info)) {
+      log_info("Found the required file in cache! ", name);
+      if (progress) {
+        progress(name, total, total);
+      }
+      return;
+    }
+
+    // 临时文件以内容标识命名，只有内容相同时才会从中断处继续
+    const auto part = GetContentCachePath(info.content_hash, ".part");
+    size_t received = FileTransfer::GetFileSize(part);
+    if (total == 0u) {
+      FileTransfer::WriteFile(part, static_cast<const uint8_t *>(nullptr), 0u);
+    } else if (received > total) {
+      FileTransfer::RemoveFile(part);
+      received = 0u;
+    }
+    if (received > 0u) {
+      log_info("Resuming the download of the required file at byte", received, name);
+    } else {
+      log_info("Could not find the required file in cache, downloading... ", name);
+    }
+
+    // 按顺序写入每一块，临时文件始终是完整内容的前缀；同时保持多个请求
+    // 在传输中以隐藏往返延迟，内存中最多只有这些分块
+    std::deque<std::pair<size_t, RpcFuture<MsgPackView>>> pending;
+    size_t requested = received;
+    while (received < total) {
+      while ((pending.size() < FILE_CHUNKS_IN_FLIGHT) && (requested < total)) {
+        const size_t size = std::min(FILE_CHUNK_SIZE, total - requested);
+        pending.emplace_back(size, _pimpl->CallAndViewAsync(
+            "request_file_chunk",
+            name,
+            info.content_hash,
+            static_cast<uint64_t>(requested),
+            static_cast<uint64_t>(size)));
+        requested += size;
+      }
+      const auto expected = pending.front().first;
+      const auto view = pending.front().second.Get();
+      pending.pop_front();
+      const auto data = view.AsBytes();
+      if (data.size() != expected) {
+        throw_exception(std::runtime_error("incomplete chunk received for file " + name));
+      }
+      if (!FileTransfer::WriteFileChunk(part, received, data.begin(), data.size())) {
+        throw_exception(std::runtime_error("unable to write file " + FileTransfer::GetFullPath(part)));
+      }
+      received += data.size();
+      if (progress) {
+        progress(name, received, total);
+      }
+    }
+
+    if (FileTransfer::ComputeContentHash(part) != info.content_hash) {
+      FileTransfer::RemoveFile(part);
+      throw_exception(std::runtime_error("content of the downloaded file does not match: " + name));
+    }
+    if (!FileTransfer::RenameFile(part, name)) {
+      throw_exception(std::runtime_error("unable to write file " + FileTransfer::GetFullPath(name)));
+    }
+    FileTransfer::WriteFile(
+        GetContentHashPath(name),
+        reinterpret_cast<const uint8_t *>(info.content_hash.data()),
+        info.content_hash.size());
   }
 
   std::vector<uint8_t> Client::GetCacheFile(const std::string &name, const bool request_otherwise) const {
@@ -281,6 +681,10 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_actors_by_id", ids);
   }
 
+  rpc::ActorQueryResult Client::QueryActors(const rpc::ActorQuery &query) {
+    return _pimpl->CallAndWait<rpc::ActorQueryResult>("query_actors", query);
+  }
+
   rpc::VehiclePhysicsControl Client::GetVehiclePhysicsControl(
       rpc::ActorId vehicle) const {
     return _pimpl->CallAndWait<carla::rpc::VehiclePhysicsControl>("get_physics_control", vehicle);
@@ -533,6 +937,10 @@ namespace detail {
         BaseJSONPath);
   }
 
+  void Client::EnableKinematicPhysics(rpc::ActorId vehicle) {
+    _pimpl->AsyncCall("enable_kinematic_physics", vehicle);
+  }
+
   void Client::RestorePhysXPhysics(rpc::ActorId vehicle) {
     _pimpl->AsyncCall("restore_physx_physics", vehicle);
   }
@@ -606,8 +1014,18 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_group_traffic_lights", traffic_light);
   }
 
-  std::string Client::StartRecorder(std::string name, bool additional_data) {
-    return _pimpl->CallAndWait<std::string>("start_recorder", name, additional_data);
+  std::string Client::StartRecorder(std::string name, bool additional_data, bool compressed) {
+    return _pimpl->CallAndWait<std::string>("start_recorder", name, additional_data, compressed);
+  }
+
+  std::string Client::StartFlightRecorder(std::string name, double seconds, double seconds_after,
+      bool additional_data, bool compressed) {
+    return _pimpl->CallAndWait<std::string>("start_flight_recorder", name, seconds, seconds_after,
+        additional_data, compressed);
+  }
+
+  std::string Client::TriggerFlightRecorder() {
+    return _pimpl->CallAndWait<std::string>("trigger_flight_recorder");
   }
 
   void Client::StopRecorder() {
@@ -648,6 +1066,18 @@ namespace detail {
     _pimpl->AsyncCall("set_replayer_ignore_spectator", ignore_spectator);
   }
 
+  void Client::SetReplayerSkipPhysics(bool skip_physics) {
+    _pimpl->AsyncCall("set_replayer_skip_physics", skip_physics);
+  }
+
+  void Client::SetReplayerFrameStep(bool frame_step) {
+    _pimpl->AsyncCall("set_replayer_frame_step", frame_step);
+  }
+
+  uint64_t Client::GetReplayerFrame() {
+    return _pimpl->CallAndWait<uint64_t>("get_replayer_frame");
+  }
+
   void Client::SubscribeToStream(
       const streaming::Token &token,
       std::function<void(Buffer)> callback) {
@@ -675,6 +1105,29 @@ namespace detail {
     return _pimpl->CallAndWait<bool>("is_sensor_enabled_for_ros", thisToken.get_stream_id());
   }
 
+  void Client::EnableMulticast(const streaming::Token &token) {
+    carla::streaming::detail::token_type thisToken(token);
+    _pimpl->CallAndWait<void>("enable_sensor_multicast", thisToken.get_stream_id());
+  }
+
+  void Client::DisableMulticast(const streaming::Token &token) {
+    carla::streaming::detail::token_type thisToken(token);
+    _pimpl->CallAndWait<void>("disable_sensor_multicast", thisToken.get_stream_id());
+  }
+
+  rpc::StreamStatistics Client::GetStreamStatistics(const streaming::Token &token) {
+    carla::streaming::detail::token_type thisToken(token);
+    return _pimpl->CallAndWait<rpc::StreamStatistics>("get_sensor_stream_statistics", thisToken.get_stream_id());
+  }
+
+  std::vector<rpc::FrameTimings> Client::GetFrameTimings(const uint64_t count) {
+    return _pimpl->CallAndWait<std::vector<rpc::FrameTimings>>("get_frame_timings", count);
+  }
+
+  rpc::SensorTickPlan Client::GetSensorTickPlan(const uint32_t frames) {
+    return _pimpl->CallAndWait<rpc::SensorTickPlan>("get_sensor_tick_plan", frames);
+  }
+
   void Client::Send(rpc::ActorId ActorId, std::string message) {
     _pimpl->AsyncCall("send", ActorId, message);
   }
@@ -700,10 +1153,38 @@ namespace detail {
     _pimpl->streaming_client.UnSubscribe(token);
   }
 
+  streaming::Token Client::SubscribeToSensorBundle(
+      const std::vector<rpc::ActorId> &sensor_ids,
+      std::function<void(Buffer)> callback) {
+    std::vector<unsigned char> token_data = _pimpl->CallAndWait<std::vector<unsigned char>>("open_sensor_bundle", sensor_ids);
+    streaming::Token token;
+    std::memcpy(&token.data[0u], token_data.data(), token_data.size());
+    _pimpl->streaming_client.Subscribe(token, std::move(callback));
+    return token;
+  }
+
+  void Client::UnSubscribeFromSensorBundle(const streaming::Token &token) {
+    _pimpl->streaming_client.UnSubscribe(token);
+    carla::streaming::detail::token_type thisToken(token);
+    _pimpl->AsyncCall("close_sensor_bundle", thisToken.get_stream_id());
+  }
+
   void Client::DrawDebugShape(const rpc::DebugShape &shape) {
     _pimpl->AsyncCall("draw_debug_shape", shape);
   }
 
+  void Client::DrawDebugShapes(const std::vector<rpc::DebugShape> &shapes) {
+    _pimpl->AsyncCall("draw_debug_shapes", shapes);
+  }
+
+  uint64_t Client::DrawDebugShapeGroup(const std::vector<rpc::DebugShape> &shapes, uint64_t group) {
+    return _pimpl->CallAndWait<uint64_t>("draw_debug_shape_group", shapes, group);
+  }
+
+  void Client::ClearDebugShapeGroup(uint64_t group) {
+    _pimpl->AsyncCall("clear_debug_shape_group", group);
+  }
+
   void Client::ApplyBatch(std::vector<rpc::Command> commands, bool do_tick_cue) {
     _pimpl->AsyncCall("apply_batch", std::move(commands), do_tick_cue);
   }
@@ -715,15 +1196,78 @@ namespace detail {
     return result.as<std::vector<rpc::CommandResponse>>();
   }
 
+  bool Client::ApplyVehicleControls(std::vector<rpc::Command::ApplyVehicleControl> controls) {
+    try {
+      _pimpl->CallAndWait<void>("apply_vehicle_controls", std::move(controls));
+    } catch (::rpc::rpc_error &e) {
+      if (rpc::Client::IsFunctionNotFound(e)) {
+        return false;
+      }
+      throw;
+    }
+    return true;
+  }
+
+  bool Client::ApplyWalkerStates(const rpc::WalkerStates &states) {
+    try {
+      _pimpl->CallAndWait<void>("apply_walker_states", states);
+    } catch (::rpc::rpc_error &e) {
+      if (rpc::Client::IsFunctionNotFound(e)) {
+        return false;
+      }
+      throw;
+    }
+    return true;
+  }
+
+  RpcFuture<std::vector<rpc::CommandResponse>> Client::ApplyBatchAsync(
+      std::vector<rpc::Command> commands,
+      bool do_tick_cue) {
+    return _pimpl->RawCallAsync<std::vector<rpc::CommandResponse>>(
+        "apply_batch", std::move(commands), do_tick_cue);
+  }
+
+  std::vector<rpc::CommandResponse> Client::SpawnActors(const rpc::ActorSpawnBatch &batch) {
+    using return_t = std::vector<rpc::CommandResponse>;
+    return _pimpl->CallAndWait<return_t>("spawn_actors", batch);
+  }
+
+  RpcFuture<std::vector<rpc::CommandResponse>> Client::SpawnActorsAsync(
+      const rpc::ActorSpawnBatch &batch) {
+    return _pimpl->CallAsync<std::vector<rpc::CommandResponse>>("spawn_actors", batch);
+  }
+
   uint64_t Client::SendTickCue() {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
 
+  RpcFuture<uint64_t> Client::SendTickCueAsync() {
+    return _pimpl->CallAsync<uint64_t>("tick_cue");
+  }
+
+  uint32_t Client::RegisterTickParticipant(const std::string &name, const double deadline) {
+    return _pimpl->CallAndWait<uint32_t>("register_tick_participant", name, deadline);
+  }
+
+  void Client::UnregisterTickParticipant(const uint32_t participant_id) {
+    _pimpl->CallAndWait<void>("unregister_tick_participant", participant_id);
+  }
+
+  void Client::NotifyTickReady(const uint32_t participant_id, const uint64_t frame) {
+    _pimpl->AsyncCall("tick_ready", participant_id, frame);
+  }
+
   std::vector<rpc::LightState> Client::QueryLightsStateToServer() const {
     using return_t = std::vector<rpc::LightState>;
     return _pimpl->CallAndWait<return_t>("query_lights_state", _pimpl->endpoint);
   }
 
+  std::pair<uint64_t, std::vector<rpc::LightState>> Client::QueryLightsStateToServerSince(
+      uint64_t version) const {
+    using return_t = std::pair<uint64_t, std::vector<rpc::LightState>>;
+    return _pimpl->CallAndWait<return_t>("query_lights_state_since", _pimpl->endpoint, version);
+  }
+
   void Client::UpdateServerLightsState(std::vector<rpc::LightState>& lights, bool discard_client) const {
     _pimpl->AsyncCall("update_lights_state", _pimpl->endpoint, std::move(lights), discard_client);
   }
@@ -742,6 +1286,14 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_environment_objects", queried_tag);
   }
 
+  std::vector<rpc::EnvironmentObject> Client::GetEnvironmentObjectsInRadius(
+      const geom::Location &location,
+      float radius,
+      uint8_t queried_tag) const {
+    using return_t = std::vector<rpc::EnvironmentObject>;
+    return _pimpl->CallAndWait<return_t>("get_environment_objects_in_radius", location, radius, queried_tag);
+  }
+
   void Client::EnableEnvironmentObjects(
       std::vector<uint64_t> env_objects_ids,
       bool enable) const {
@@ -6,24 +6,34 @@
 
 #pragma once
 
+#include "carla/MappedFile.h"
 #include "carla/Memory.h"
+#include "carla/MsgPackView.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/client/FileTransfer.h"
+#include "carla/client/RpcFuture.h"
 #include "carla/geom/Transform.h"
 #include "carla/geom/Location.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/ActorDefinition.h"
+#include "carla/rpc/ActorQuery.h"
+#include "carla/rpc/ActorQueryResult.h"
+#include "carla/rpc/ActorSpawnBatch.h"
 #include "carla/rpc/AttachmentType.h"
 #include "carla/rpc/Command.h"
 #include "carla/rpc/CommandResponse.h"
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/EpisodeInfo.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/FrameTimings.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/LightState.h"
 #include "carla/rpc/MapInfo.h"
 #include "carla/rpc/MapLayer.h"
 #include "carla/rpc/OpendriveGenerationParameters.h"
+#include "carla/rpc/SensorTickPlan.h"
+#include "carla/rpc/StreamStatistics.h"
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleDoor.h"
 #include "carla/rpc/VehicleLightStateList.h"
@@ -31,6 +41,7 @@
 #include "carla/rpc/VehiclePhysicsControl.h"
 #include "carla/rpc/VehicleTelemetryData.h"
 #include "carla/rpc/VehicleWheels.h"
+#include "carla/rpc/WalkerStates.h"
 #include "carla/rpc/WeatherParameters.h"
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
@@ -102,10 +113,27 @@ namespace detail {
 
     void LoadEpisode(std::string map_name, bool reset_settings = true, rpc::MapLayer map_layer = rpc::MapLayer::All);
 
+    void SoftResetEpisode(bool reset_settings = true);
+
+    uint64_t SaveEpisodeSnapshot();
+
+    void RestoreEpisodeSnapshot(uint64_t snapshot_id);
+
+    void RemoveEpisodeSnapshot(uint64_t snapshot_id);
+
     void LoadLevelLayer(rpc::MapLayer map_layer) const;
 
     void UnloadLevelLayer(rpc::MapLayer map_layer) const;
 
+    /// 开始在后台加载 @a map_layer，返回用于查询是否完成的请求 id。
+    uint64_t LoadLevelLayerAsync(rpc::MapLayer map_layer) const;
+
+    /// 开始在后台卸载 @a map_layer，返回用于查询是否完成的请求 id。
+    uint64_t UnloadLevelLayerAsync(rpc::MapLayer map_layer) const;
+
+    /// 查询 @a request 是否已经完成，不等待响应。
+    RpcFuture<bool> IsLevelLayerRequestDoneAsync(uint64_t request) const;
+
     void CopyOpenDriveToServer(
         std::string opendrive, const rpc::OpendriveGenerationParameters & params);
 
@@ -127,13 +155,60 @@ namespace detail {
 
     std::vector<uint8_t> GetNavigationMesh() const;
 
+    /// 与 GetNavigationMesh 相同，但返回响应中数据的视图，不复制。
+    MsgPackView GetNavigationMeshView() const;
+
+    /// 与 GetNavigationMesh 相同，但本地缓存中有内容标识为 @a content_hash
+    /// 的导航网格时不从服务器下载，下载后写入缓存。
+    std::vector<uint8_t> GetNavigationMesh(const std::string &content_hash) const;
+
+    /// 以写时复制方式映射本地缓存中内容标识为 @a content_hash 的导航网格，缓存
+    /// 中没有时先下载并写入缓存。同一台机器上的客户端共享缓存文件的页。
+    ///
+    /// @return 无法使用缓存（@a content_hash 为空或无法写入、映射缓存文件）时
+    /// 返回 nullptr。
+    std::unique_ptr<MappedFile> MapNavigationMesh(const std::string &content_hash) const;
+
+    // 服务器端的行人导航：行人在服务器上与物理一起更新，不需要每帧发送
+    // ApplyWalkerState。
+
+    bool AddWalkerToServerNavigation(rpc::ActorId walker, rpc::ActorId controller);
+
+    void RemoveWalkerFromServerNavigation(rpc::ActorId walker);
+
+    bool SetServerNavigationWalkerTarget(rpc::ActorId walker, const geom::Location &to);
+
+    bool SetServerNavigationWalkerMaxSpeed(rpc::ActorId walker, float max_speed);
+
+    /// 一次请求 @a count 个随机位置，导航网格不可用时返回空
+    std::vector<geom::Location> GetServerNavigationRandomLocations(uint32_t count);
+
+    void SetServerNavigationPedestriansCrossFactor(float percentage);
+
+    void SetServerNavigationPedestriansSeed(unsigned int seed);
+
     bool SetFilesBaseFolder(const std::string &path);
 
-    std::vector<std::string> GetRequiredFiles(const std::string &folder = "", const bool download = true) const;
+    /// 获取地图所需文件的列表，@a download 为 true 时下载本地缓存中没有或
+    /// 内容不同的文件，见 RequestFile。
+    std::vector<std::string> GetRequiredFiles(
+        const std::string &folder = "",
+        const bool download = true,
+        const FileTransfer::ProgressCallback &progress = {}) const;
 
     std::string GetMapData() const;
 
-    void RequestFile(const std::string &name) const;
+    /// 与 GetMapData 相同，但返回响应中 OpenDRIVE 内容的视图，不复制。
+    MsgPackView GetMapDataView() const;
+
+    /// 与 GetMapData 相同，但本地缓存中有内容标识为 @a content_hash 的
+    /// OpenDRIVE 文件时不从服务器下载，下载后写入缓存。
+    std::string GetMapData(const std::string &content_hash) const;
+
+    /// 按内容标识分块下载服务器上的 @a name，本地缓存中的文件内容相同时不
+    /// 下载。同时有多个分块请求在传输中，已收到的数据写入以内容标识命名的
+    /// 临时文件，下载中断后再次请求时从中断处继续。
+    void RequestFile(const std::string &name, const FileTransfer::ProgressCallback &progress = {}) const;
 
     std::vector<uint8_t> GetCacheFile(const std::string &name, const bool request_otherwise = true) const;
 
@@ -157,6 +232,8 @@ namespace detail {
 
     std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &ids);
 
+    rpc::ActorQueryResult QueryActors(const rpc::ActorQuery &query);
+
     rpc::VehiclePhysicsControl GetVehiclePhysicsControl(rpc::ActorId vehicle) const;
 
     rpc::VehicleLightState GetVehicleLightState(rpc::ActorId vehicle) const;
@@ -335,6 +412,8 @@ namespace detail {
         std::string TireJSON,
         std::string BaseJSONPath);
 
+    void EnableKinematicPhysics(rpc::ActorId vehicle);
+
     void RestorePhysXPhysics(rpc::ActorId vehicle);
 
     void ApplyControlToWalker(
@@ -391,7 +470,12 @@ namespace detail {
     std::vector<ActorId> GetGroupTrafficLights(
         rpc::ActorId traffic_light);
 
-    std::string StartRecorder(std::string name, bool additional_data);
+    std::string StartRecorder(std::string name, bool additional_data, bool compressed);
+
+    std::string StartFlightRecorder(std::string name, double seconds, double seconds_after,
+        bool additional_data, bool compressed);
+
+    std::string TriggerFlightRecorder();
 
     void StopRecorder();
 
@@ -410,6 +494,12 @@ namespace detail {
 
     void SetReplayerIgnoreSpectator(bool ignore_spectator);
 
+    void SetReplayerSkipPhysics(bool skip_physics);
+
+    void SetReplayerFrameStep(bool frame_step);
+
+    uint64_t GetReplayerFrame();
+
     void StopReplayer(bool keep_actors);
 
     void SubscribeToStream(
@@ -429,14 +519,41 @@ namespace detail {
 
     bool IsEnabledForROS(const streaming::Token &token);
 
+    void EnableMulticast(const streaming::Token &token);
+
+    void DisableMulticast(const streaming::Token &token);
+
+    rpc::StreamStatistics GetStreamStatistics(const streaming::Token &token);
+
+    /// 获取服务器记录的最近 @a count 帧各阶段的时间。
+    std::vector<rpc::FrameTimings> GetFrameTimings(uint64_t count);
+
+    /// 获取服务器为传感器分配的帧相位以及之后 @a frames 帧的开销。
+    rpc::SensorTickPlan GetSensorTickPlan(uint32_t frames);
+
     void UnSubscribeFromGBuffer(
         rpc::ActorId ActorId,
         uint32_t GBufferId);
 
+    /// 在服务器端创建一个传感器组并订阅它的流。
+    ///
+    /// @return 传感器组的流的 Token。
+    streaming::Token SubscribeToSensorBundle(
+        const std::vector<rpc::ActorId> &sensor_ids,
+        std::function<void(Buffer)> callback);
+
+    void UnSubscribeFromSensorBundle(const streaming::Token &token);
+
     void Send(rpc::ActorId ActorId, std::string message);
 
     void DrawDebugShape(const rpc::DebugShape &shape);
 
+    void DrawDebugShapes(const std::vector<rpc::DebugShape> &shapes);
+
+    uint64_t DrawDebugShapeGroup(const std::vector<rpc::DebugShape> &shapes, uint64_t group);
+
+    void ClearDebugShapeGroup(uint64_t group);
+
     void ApplyBatch(
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
@@ -445,10 +562,49 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    /// 只包含车辆控制的批量命令。服务器在 RPC 线程中接收，不等待游戏线程，
+    /// 控制在下一次物理更新前统一应用；找不到的车辆只在服务器端记录日志。
+    /// 有 id 超出服务器容量时整批都不应用并抛出异常。
+    ///
+    /// 服务器不支持 apply_vehicle_controls 时返回 false。
+    bool ApplyVehicleControls(std::vector<rpc::Command::ApplyVehicleControl> controls);
+
+    /// 与 ApplyVehicleControls 相同，用于行人的变换和速度，与逐个发送
+    /// ApplyWalkerState 命令的效果相同。
+    ///
+    /// 服务器不支持 apply_walker_states 时返回 false。
+    bool ApplyWalkerStates(const rpc::WalkerStates &states);
+
+    /// 与 ApplyBatchSync 相同，但不等待响应，可以同时发出多批命令。
+    RpcFuture<std::vector<rpc::CommandResponse>> ApplyBatchAsync(
+        std::vector<rpc::Command> commands,
+        bool do_tick_cue);
+
+    /// 在一次调用中生成多个演员，返回每个演员的生成结果。
+    std::vector<rpc::CommandResponse> SpawnActors(const rpc::ActorSpawnBatch &batch);
+
+    /// 与 SpawnActors 相同，但不等待响应。
+    RpcFuture<std::vector<rpc::CommandResponse>> SpawnActorsAsync(
+        const rpc::ActorSpawnBatch &batch);
+
     uint64_t SendTickCue();
 
+    /// 与 SendTickCue 相同，但不等待响应。
+    RpcFuture<uint64_t> SendTickCueAsync();
+
+    uint32_t RegisterTickParticipant(const std::string &name, double deadline);
+
+    void UnregisterTickParticipant(uint32_t participant_id);
+
+    /// 通知服务器此参与者已处理完 @a frame，不等待响应。
+    void NotifyTickReady(uint32_t participant_id, uint64_t frame);
+
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
 
+    /// 只查询版本 @a version 之后状态改变的灯光，同时返回服务器当前的版本号
+    std::pair<uint64_t, std::vector<rpc::LightState>> QueryLightsStateToServerSince(
+        uint64_t version) const;
+
     void UpdateServerLightsState(
         std::vector<rpc::LightState>& lights,
         bool discard_client = false) const;
@@ -460,6 +616,11 @@ namespace detail {
 
     std::vector<rpc::EnvironmentObject> GetEnvironmentObjects(uint8_t queried_tag) const;
 
+    std::vector<rpc::EnvironmentObject> GetEnvironmentObjectsInRadius(
+        const geom::Location &location,
+        float radius,
+        uint8_t queried_tag) const;
+
     void EnableEnvironmentObjects(
       std::vector<uint64_t> env_objects_ids,
       bool enable) const;
@@ -0,0 +1,158 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/ClientSideSensorPipeline.h"
+
+#include "carla/Logging.h"
+#include "carla/ParallelFor.h"
+#include "carla/client/Map.h"
+#include "carla/client/Waypoint.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  // 根据偏航角（度）在水平面上旋转 @a location
+  static geom::Location Rotate(float yaw, const geom::Location &location) {
+    yaw *= geom::Math::Pi<float>() / 180.0f;
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    return {
+        c * location.x - s * location.y,
+        s * location.x + c * location.y,
+        location.z};
+  }
+
+  static void ComputeActorData(
+      const ClientSideSensorPipeline::Request &request,
+      const geom::Transform &transform,
+      ClientSideSensorPipeline::ActorData &data) {
+    const auto &box = request.bounding_box;
+    const auto location = transform.location + box.location;
+    const auto yaw = transform.rotation.yaw;
+    data.id = request.actor;
+    data.transform = transform;
+    data.footprint = {
+        location + Rotate(yaw, geom::Location( box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location( box.extent.x, -box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x, -box.extent.y, 0.0f))};
+    data.world_vertices = box.GetWorldVertices(transform);
+    data.waypoint = (request.map != nullptr) ?
+        request.map->GetWaypoint(transform.location) :
+        nullptr;
+  }
+
+  // ===========================================================================
+  // -- ClientSideSensorPipeline::Frame ----------------------------------------
+  // ===========================================================================
+
+  const ClientSideSensorPipeline::ActorData *ClientSideSensorPipeline::Frame::Find(
+      const ActorId id) const {
+    auto it = std::lower_bound(_actors.begin(), _actors.end(), id,
+        [](const ActorData &data, ActorId value) { return data.id < value; });
+    return ((it != _actors.end()) && (it->id == id)) ? &*it : nullptr;
+  }
+
+  // ===========================================================================
+  // -- ClientSideSensorPipeline -----------------------------------------------
+  // ===========================================================================
+
+  size_t ClientSideSensorPipeline::Register(Request request, Callback callback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const size_t id = ++_counter;
+    auto subscribers = _subscribers.load()->subscribers;
+    subscribers.emplace_back(Subscriber{
+        id,
+        std::move(request),
+        std::make_shared<const Callback>(std::move(callback))});
+    Update(std::move(subscribers));
+    return id;
+  }
+
+  void ClientSideSensorPipeline::Remove(const size_t id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto subscribers = _subscribers.load()->subscribers;
+    auto it = std::find_if(subscribers.begin(), subscribers.end(),
+        [id](const Subscriber &subscriber) { return subscriber.id == id; });
+    if (it != subscribers.end()) {
+      subscribers.erase(it);
+      Update(std::move(subscribers));
+    }
+  }
+
+  void ClientSideSensorPipeline::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _subscribers.store(std::make_shared<Subscribers>());
+  }
+
+  void ClientSideSensorPipeline::Update(std::vector<Subscriber> subscribers) {
+    auto result = std::make_shared<Subscribers>();
+    for (const auto &subscriber : subscribers) {
+      result->actors.emplace_back(subscriber.request);
+    }
+    std::stable_sort(result->actors.begin(), result->actors.end(),
+        [](const Request &lhs, const Request &rhs) { return lhs.actor < rhs.actor; });
+    // 同一个参与者只保留一项；任何一个传感器需要路点时都计算路点
+    std::vector<Request> merged;
+    for (auto &request : result->actors) {
+      if (merged.empty() || (merged.back().actor != request.actor)) {
+        merged.emplace_back(std::move(request));
+      } else if (merged.back().map == nullptr) {
+        merged.back().map = std::move(request.map);
+      }
+    }
+    result->actors = std::move(merged);
+    result->subscribers = std::move(subscribers);
+    _subscribers.store(std::move(result));
+  }
+
+  void ClientSideSensorPipeline::Tick(const WorldSnapshot &snapshot) const {
+    const auto subscribers = _subscribers.load();
+    if (subscribers->subscribers.empty()) {
+      return;
+    }
+
+    const auto &requests = subscribers->actors;
+    std::vector<boost::optional<ActorSnapshot>> actors;
+    actors.reserve(requests.size());
+    for (const auto &request : requests) {
+      actors.emplace_back(snapshot.Find(request.actor));
+    }
+
+    // 路点查询是主要开销，每个线程少量参与者就值得并行
+    std::vector<ActorData> data(requests.size());
+    ParallelFor(requests.size(), [&](const size_t i) {
+      if (actors[i].has_value()) {
+        ComputeActorData(requests[i], actors[i]->transform, data[i]);
+      }
+    }, 4u);
+
+    Frame frame;
+    frame._actors.reserve(data.size());
+    for (size_t i = 0u; i < data.size(); ++i) {
+      if (actors[i].has_value()) {
+        frame._actors.emplace_back(std::move(data[i]));
+      }
+    }
+
+    for (const auto &subscriber : subscribers->subscribers) {
+      try {
+        (*subscriber.callback)(snapshot, frame);
+      } catch (const std::exception &e) {
+        log_error("client-side sensor:", e.what());
+      }
+    }
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
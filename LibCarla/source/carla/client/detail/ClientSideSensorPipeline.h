@@ -0,0 +1,129 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/AtomicSharedPtr.h"
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  class Map;
+  class Waypoint;
+
+namespace detail {
+
+  /// 客户端传感器共用的逐帧处理。每收到一个 WorldSnapshot，所有传感器关心的
+  /// 参与者的派生数据（包围盒的世界坐标顶点、投影到道路上的路点等）只并行计算
+  /// 一次，再分发给所有传感器，因此每帧的开销几乎不随传感器数量增加。
+  ///
+  /// 注册和注销复制订阅列表，每帧的处理不加锁。
+  class ClientSideSensorPipeline : private NonCopyable {
+  public:
+
+    /// 传感器需要的参与者数据。
+    struct Request {
+      /// 传感器所依附的参与者。
+      ActorId actor;
+
+      /// 参与者的包围盒，相对于参与者。
+      geom::BoundingBox bounding_box;
+
+      /// 非空时在这张地图上计算参与者所在的路点。
+      SharedPtr<const Map> map;
+    };
+
+    /// 一个参与者在当前帧的派生数据。
+    struct ActorData {
+      ActorId id;
+
+      geom::Transform transform;
+
+      /// 包围盒在水平面上的四个角，只按偏航角旋转。
+      std::array<geom::Location, 4u> footprint;
+
+      /// 包围盒的八个顶点，顺序与 BoundingBox::GetWorldVertices 相同。
+      std::array<geom::Location, 8u> world_vertices;
+
+      /// 参与者位置投影到道路上的路点，没有请求或不在道路上时为空。
+      SharedPtr<Waypoint> waypoint;
+    };
+
+    /// 一帧中所有被请求的参与者的数据。
+    class Frame {
+    public:
+
+      /// 参与者 @a id 在这一帧的数据，参与者不在快照中时返回 nullptr。
+      const ActorData *Find(ActorId id) const;
+
+      const std::vector<ActorData> &GetActors() const {
+        return _actors;
+      }
+
+    private:
+
+      friend ClientSideSensorPipeline;
+
+      /// 按 id 升序排列。
+      std::vector<ActorData> _actors;
+    };
+
+    using Callback = std::function<void(const WorldSnapshot &, const Frame &)>;
+
+    /// 注册一个传感器，每帧以 @a request 请求的数据调用 @a callback。返回的
+    /// id 不为 0。
+    size_t Register(Request request, Callback callback);
+
+    void Remove(size_t id);
+
+    void Clear();
+
+    /// 为 @a snapshot 计算派生数据并调用所有回调。回调抛出的异常会被记录，
+    /// 不影响其它回调。
+    void Tick(const WorldSnapshot &snapshot) const;
+
+  private:
+
+    struct Subscriber {
+      size_t id;
+      Request request;
+      std::shared_ptr<const Callback> callback;
+    };
+
+    struct Subscribers {
+      std::vector<Subscriber> subscribers;
+
+      /// 合并后的请求，每个参与者一项，按 id 升序排列。
+      std::vector<Request> actors;
+    };
+
+    /// 在持有 _mutex 时根据 @a subscribers 重建合并后的请求并替换当前列表。
+    void Update(std::vector<Subscriber> subscribers);
+
+    /// 只在注册和注销时加锁。
+    std::mutex _mutex;
+
+    size_t _counter = 0u;
+
+    AtomicSharedPtr<const Subscribers> _subscribers{std::make_shared<Subscribers>()};
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
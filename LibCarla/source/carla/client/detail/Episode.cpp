@@ -7,12 +7,16 @@
 #include "carla/client/detail/Episode.h"
 
 #include "carla/Logging.h"
+#include "carla/StopWatch.h"
+#include "carla/StringUtil.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/sensor/Deserializer.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
+#include <algorithm>
 #include <exception>
+#include <unordered_set>
 
 namespace carla {
 namespace client {
@@ -36,6 +40,18 @@ using namespace std::chrono_literals;
      // 返回指定ID的参与者列表
     return actors.GetActorsById(actor_ids);
   }
+// 从缓存的类型 ID 索引中获取 @a state 中类型 ID 匹配的参与者
+  static auto GetActorsByTypeId_Impl(
+      const CachedActorList &actors,
+      const EpisodeState &state,
+      const std::string &wildcard_pattern) {
+    auto result = actors.GetActorsByTypeId(wildcard_pattern);
+    // 缓存中可能还有已生成但尚未出现在剧集状态中的参与者。
+    result.erase(std::remove_if(result.begin(), result.end(), [&](const auto &actor) {
+      return !state.ContainsActorSnapshot(actor.id);
+    }), result.end());
+    return result;
+  }
 // 构造函数，通过客户端和弱引用的模拟器创建Episode对象，并使用默认的EpisodeInfo
   Episode::Episode(Client &client, std::weak_ptr<Simulator> simulator)
     : Episode(client, client.GetEpisodeInfo(), simulator) {}
@@ -59,10 +75,26 @@ using namespace std::chrono_literals;
     _client.SubscribeToStream(_token, [weak](auto buffer) {
       auto self = weak.lock();
       if (self != nullptr) {
+        rpc::FrameTimings timings;
+        StopWatch stop_watch;
         // 反序列化数据
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        const auto &raw_state = CastData(*data);
         auto prev = self->GetState();
+        std::shared_ptr<const EpisodeState> next;
+        if (raw_state.IsDelta()) {
+          // 没有增量对应的基准帧（刚开始订阅或丢失了消息），等待下一个关键帧。
+          if ((raw_state.GetEpisodeId() != prev->GetEpisodeId()) ||
+              (raw_state.GetBaseFrame() != prev->GetFrame())) {
+            return;
+          }
+          next = std::make_shared<const EpisodeState>(raw_state, *prev);
+        } else {
+          next = std::make_shared<const EpisodeState>(raw_state);
+        }
+        timings.frame = next->GetFrame();
+        timings.deserialization = static_cast<float>(
+            stop_watch.GetElapsedTime<std::chrono::microseconds>()) * 1e-3f;
 
         // TODO: 更新地图变化的检测方式
         bool HasMapChanged = next->HasMapChanged();
@@ -90,6 +122,8 @@ using namespace std::chrono_literals;
             }
           } while (!self->_state.compare_exchange(&prev, next));
 
+          self->UpdateCachedActors(*prev, *next);
+
           if(UpdateLights || HasMapChanged) {
             self->_on_light_update_callbacks.Call(next);
           }
@@ -103,11 +137,20 @@ using namespace std::chrono_literals;
             self->OnEpisodeChanged();
           }
 
+          self->_state_history.Record(*next);
+
+          self->NotifyActorChanges(*next);
+
           // 通知等待的线程并执行回调。
           self->_snapshot.SetValue(next);
 
           // 调用用户回调函数
+          stop_watch.Restart();
+          self->_client_side_sensors.Tick(WorldSnapshot{next});
           self->_on_tick_callbacks.Call(next);
+          timings.callbacks = static_cast<float>(
+              stop_watch.GetElapsedTime<std::chrono::microseconds>()) * 1e-3f;
+          self->RecordClientFrameTimings(timings);
         }
       }
     });
@@ -128,19 +171,171 @@ using namespace std::chrono_literals;
   std::vector<rpc::Actor> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
     return GetActorsById_Impl(_client, _actors, actor_ids);
   }
-// 获取所有参与者列表，使用模板函数实现
+// 获取所有参与者列表，优先使用缓存的类型 ID 索引
   std::vector<rpc::Actor> Episode::GetActors() {
-    return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds());
+    FetchPendingActors();
+    auto state = GetState();
+    auto actors = GetActorsByTypeId_Impl(_actors, *state, "*");
+    if (actors.size() != state->size()) {
+      // 有的参与者还不在缓存中（例如状态刚刚更新），逐个检查 ID。
+      actors = GetActorsById_Impl(_client, _actors, state->GetActorIds());
+      std::sort(actors.begin(), actors.end(), [](const auto &lhs, const auto &rhs) {
+        return (lhs.description.id < rhs.description.id) ||
+            ((lhs.description.id == rhs.description.id) && (lhs.id < rhs.id));
+      });
+    }
+    return actors;
+  }
+// 根据类型 ID 获取参与者列表，只访问类型 ID 前缀匹配的参与者
+  std::vector<rpc::Actor> Episode::GetActors(const std::string &wildcard_pattern) {
+    FetchPendingActors();
+    return GetActorsByTypeId_Impl(_actors, *GetState(), wildcard_pattern);
+  }
+// 根据位置获取参与者列表，使用剧集状态的网格索引
+  std::vector<rpc::Actor> Episode::GetActorsInRadius(
+      const geom::Location &location,
+      const float radius,
+      const std::string &wildcard_pattern) {
+    auto ids = GetState()->GetActorSpatialGrid()->GetActorIdsInRadius(location, radius);
+    auto actors = GetActorsById_Impl(_client, _actors, ids);
+    actors.erase(std::remove_if(actors.begin(), actors.end(), [&](const auto &actor) {
+      return !StringUtil::Match(actor.description.id, wildcard_pattern);
+    }), actors.end());
+    return actors;
+  }
+// 根据剧集状态的变化更新缓存：移除消失的参与者，记录新出现的参与者
+  void Episode::UpdateCachedActors(const EpisodeState &prev, const EpisodeState &next) {
+    std::vector<ActorId> added;
+    std::vector<ActorId> removed;
+    for (auto id : next.GetActorIds()) {
+      if (!prev.ContainsActorSnapshot(id)) {
+        added.emplace_back(id);
+      }
+    }
+    for (auto id : prev.GetActorIds()) {
+      if (!next.ContainsActorSnapshot(id)) {
+        removed.emplace_back(id);
+      }
+    }
+    if (!added.empty() || !removed.empty()) {
+      _actors.Update(added, removed);
+      std::lock_guard<std::mutex> lock(_actor_list_changes_mutex);
+      ActorListChanges changes;
+      changes.sequence = ++_actor_list_changes_sequence;
+      changes.spawned = std::move(added);
+      changes.destroyed = std::move(removed);
+      _actor_list_changes.emplace_back(std::move(changes));
+      while (_actor_list_changes.size() > MAX_ACTOR_LIST_CHANGES) {
+        _actor_list_changes.pop_front();
+        _actor_list_changes_oldest = _actor_list_changes.front().sequence - 1u;
+      }
+    }
+  }
+
+  ActorListChanges Episode::GetActorListChanges(const uint64_t sequence) const {
+    std::lock_guard<std::mutex> lock(_actor_list_changes_mutex);
+    ActorListChanges result;
+    result.sequence = _actor_list_changes_sequence;
+    if ((sequence < _actor_list_changes_oldest) || (sequence > _actor_list_changes_sequence)) {
+      result.complete = false;
+      return result;
+    }
+    // 在这段时间内出现又被销毁的参与者不需要报告
+    std::unordered_set<ActorId> spawned;
+    for (const auto &changes : _actor_list_changes) {
+      if (changes.sequence <= sequence) {
+        continue;
+      }
+      for (auto id : changes.spawned) {
+        spawned.insert(id);
+        result.spawned.emplace_back(id);
+      }
+      for (auto id : changes.destroyed) {
+        if (spawned.erase(id) == 0u) {
+          result.destroyed.emplace_back(id);
+        }
+      }
+    }
+    result.spawned.erase(std::remove_if(result.spawned.begin(), result.spawned.end(), [&](auto id) {
+      return spawned.find(id) == spawned.end();
+    }), result.spawned.end());
+    return result;
+  }
+  void Episode::RemoveOnActorChangesEvent(const size_t id) {
+    _on_actor_changes_callbacks.Remove(id);
+    if (_on_actor_changes_callbacks.empty()) {
+      // 之后重新注册时从当前状态重新开始
+      _actor_changes.Clear();
+    }
+  }
+// 计算参与者变化，只有新出现的参与者需要查询类型
+  void Episode::NotifyActorChanges(const EpisodeState &state) {
+    if (_on_actor_changes_callbacks.empty()) {
+      return;
+    }
+    bool fetched = false;
+    const auto changes = _actor_changes.Update(state.GetFrame(), state, [&](ActorId id) {
+      if (!fetched) {
+        // 一次调用获取这一帧所有新参与者的描述
+        fetched = true;
+        try {
+          FetchPendingActors();
+        } catch (const std::exception &e) {
+          log_warning("actor changes: failed to fetch new actors:", e.what());
+        }
+      }
+      const auto actor = _actors.GetActorById(id);
+      return actor.has_value() ?
+          ActorChangeFeed::GetActorKind(actor->description.id) :
+          ActorChangeFeed::ActorKind::Other;
+    });
+    if (!changes.empty()) {
+      _on_actor_changes_callbacks.Call(changes);
+    }
+  }
+// 获取所有待获取的参与者描述
+  void Episode::FetchPendingActors() {
+    auto ids = _actors.GetPendingIds();
+    if (!ids.empty()) {
+      _actors.ResolvePending(ids, _client.GetActorsById(ids));
+    }
+  }
+// 记录客户端的帧时间，只保留最近的几帧
+  void Episode::RecordClientFrameTimings(const rpc::FrameTimings &timings) {
+    std::lock_guard<std::mutex> lock(_frame_timings_mutex);
+    _client_frame_timings.emplace_back(timings);
+    while (_client_frame_timings.size() > MAX_CLIENT_FRAME_TIMINGS) {
+      _client_frame_timings.pop_front();
+    }
+  }
+// 获取客户端的帧时间记录
+  std::vector<rpc::FrameTimings> Episode::GetClientFrameTimings() const {
+    std::lock_guard<std::mutex> lock(_frame_timings_mutex);
+    return {_client_frame_timings.begin(), _client_frame_timings.end()};
   }
 // 当Episode开始时的处理函数
   void Episode::OnEpisodeStarted() {
     _actors.Clear();
+    {
+      // 之前的序号不再有效
+      std::lock_guard<std::mutex> lock(_actor_list_changes_mutex);
+      _actor_list_changes.clear();
+      _actor_list_changes_oldest = _actor_list_changes_sequence;
+    }
     _on_tick_callbacks.Clear();
+    _on_actor_changes_callbacks.Clear();
+    _actor_changes.Clear();
+    _client_side_sensors.Clear();
     _walker_navigation.reset();
     traffic_manager::TrafficManager::Release();
   }
 // 当Episode改变时的处理函数
   void Episode::OnEpisodeChanged() {
+    // 新剧集的时间从头开始
+    _state_history.Clear();
+    if (!_on_actor_changes_callbacks.empty()) {
+      _actor_changes.OnEpisodeChanged();
+    }
     traffic_manager::TrafficManager::Reset();
   }
 // 检查自上次调用以来地图是否发生变化
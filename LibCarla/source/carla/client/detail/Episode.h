@@ -9,14 +9,24 @@
 #include "carla/AtomicSharedPtr.h" // 引入原子共享指针
 #include "carla/NonCopyable.h" // 引入不可复制类
 #include "carla/RecurrentSharedFuture.h" // 引入递归共享未来
+#include "carla/client/ActorListChanges.h"
+#include "carla/client/ActorStateChanges.h"
 #include "carla/client/Timestamp.h" // 引入时间戳
 #include "carla/client/WorldSnapshot.h" // 引入世界快照
+#include "carla/client/detail/ActorChangeFeed.h"
 #include "carla/client/detail/CachedActorList.h" // 引入缓存参与者列表
 #include "carla/client/detail/CallbackList.h" // 引入回调列表
+#include "carla/client/detail/ClientSideSensorPipeline.h"
 #include "carla/client/detail/EpisodeState.h" // 引入剧集状态
+#include "carla/client/detail/EpisodeStateHistory.h"
 #include "carla/client/detail/EpisodeProxy.h" // 引入剧集代理
+#include "carla/geom/Location.h"
 #include "carla/rpc/EpisodeInfo.h" // 引入剧集信息
+#include "carla/rpc/FrameTimings.h"
 
+#include <deque>
+#include <mutex>
+#include <string>
 #include <vector> // 引入向量类
 
 namespace carla {
@@ -49,15 +59,27 @@ namespace detail {
       return _state.load();
     }
 
-    void RegisterParticipant(rpc::Actor actor) { // 注册参与者
+    void RegisterActor(rpc::Actor actor) { // 注册参与者
       _actors.Insert(std::move(actor));
     }
 
-    boost::optional<rpc::Actor> GetParticipantById(ActorId id); // 根据 ID 获取参与者
+    boost::optional<rpc::Actor> GetActorById(ActorId id); // 根据 ID 获取参与者
 
-    std::vector<rpc::Actor> GetParticipantsById(const std::vector<ActorId> &actor_ids); // 根据 ID 列表获取参与者
+    std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &actor_ids); // 根据 ID 列表获取参与者
 
-    std::vector<rpc::Actor> GetParticipants(); // 获取所有参与者
+    /// 获取当前剧集状态中的所有参与者，按类型 ID 排序。
+    std::vector<rpc::Actor> GetActors();
+
+    /// 获取当前剧集状态中类型 ID 与 @a wildcard_pattern 匹配的参与者，按类型
+    /// ID 排序。描述都已缓存时不需要调用服务器。
+    std::vector<rpc::Actor> GetActors(const std::string &wildcard_pattern);
+
+    /// 获取当前剧集状态中与 @a location 的距离不超过 @a radius（米）且类型 ID
+    /// 与 @a wildcard_pattern 匹配的参与者。
+    std::vector<rpc::Actor> GetActorsInRadius(
+        const geom::Location &location,
+        float radius,
+        const std::string &wildcard_pattern);
 
     boost::optional<WorldSnapshot> WaitForState(time_duration timeout) { // 等待状态变化
       return _snapshot.WaitFor(timeout);
@@ -71,6 +93,29 @@ namespace detail {
       _on_tick_callbacks.Remove(id);
     }
 
+    /// 注册参与者变化的回调，每帧在 tick 事件回调之前调用，没有变化的帧不调用。
+    /// 没有注册回调时不计算变化。
+    size_t RegisterOnActorChangesEvent(std::function<void(const ActorStateChanges &)> callback) {
+      return _on_actor_changes_callbacks.Push(std::move(callback));
+    }
+
+    void RemoveOnActorChangesEvent(size_t id);
+
+    void SetActorChangesMoveThreshold(float meters) {
+      _actor_changes.SetMoveThreshold(meters);
+    }
+
+    /// 注册客户端传感器，每帧在 tick 事件回调之前以共享的派生数据调用。
+    size_t RegisterClientSideSensor(
+        ClientSideSensorPipeline::Request request,
+        ClientSideSensorPipeline::Callback callback) {
+      return _client_side_sensors.Register(std::move(request), std::move(callback));
+    }
+
+    void RemoveClientSideSensor(size_t id) {
+      _client_side_sensors.Remove(id);
+    }
+
     size_t RegisterOnMapChangeEvent(std::function<void(WorldSnapshot)> callback) { // 注册地图变化事件回调
       return _on_map_change_callbacks.Push(std::move(callback));
     }
@@ -100,6 +145,25 @@ namespace detail {
 
     std::shared_ptr<WalkerNavigation> CreateNavigationIfMissing(); // 如果缺失则创建导航
 
+    /// 最近接收的几帧在客户端各阶段的时间，按帧号升序排列，只有客户端的
+    /// 字段有效。
+    std::vector<rpc::FrameTimings> GetClientFrameTimings() const;
+
+    /// 序号 @a sequence 之后出现和销毁的参与者，合并为一个变化。第一次查询
+    /// 时传入 0。
+    ActorListChanges GetActorListChanges(uint64_t sequence) const;
+
+    /// 在客户端保留最近 @a max_duration 秒（最多 @a max_frames 帧）的参与者
+    /// 状态，任一为 0 时停止记录。
+    void ConfigureStateHistory(double max_duration, size_t max_frames) {
+      _state_history.Configure(max_duration, max_frames);
+    }
+
+    /// 参与者 @a id 在模拟时间 [@a begin, @a end]（秒）内记录的轨迹。
+    std::shared_ptr<const ActorTrajectory> GetActorTrajectory(ActorId id, double begin, double end) const {
+      return _state_history.GetActorTrajectory(id, begin, end);
+    }
+
   private:
 
     Episode(Client &client, const rpc::EpisodeInfo &info, std::weak_ptr<Simulator> simulator); // 私有构造函数
@@ -108,6 +172,23 @@ namespace detail {
 
     void OnEpisodeChanged(); // 处理剧集变化事件
 
+    /// 根据剧集状态从 @a prev 到 @a next 的变化更新缓存的参与者列表。
+    void UpdateCachedActors(const EpisodeState &prev, const EpisodeState &next);
+
+    /// 在一次调用中获取新出现的参与者的描述。
+    void FetchPendingActors();
+
+    /// 计算 @a state 中参与者的变化并调用参与者变化的回调。
+    void NotifyActorChanges(const EpisodeState &state);
+
+    void RecordClientFrameTimings(const rpc::FrameTimings &timings);
+
+    /// 保留的客户端帧时间记录的数量。
+    static constexpr size_t MAX_CLIENT_FRAME_TIMINGS = 1000u;
+
+    /// 保留的参与者列表变化的数量，只记录参与者列表有变化的帧。
+    static constexpr size_t MAX_ACTOR_LIST_CHANGES = 1000u;
+
     Client &_client; // 引用客户端
 
     AtomicSharedPtr<const EpisodeState> _state; // 原子共享指针指向剧集状态
@@ -116,8 +197,30 @@ namespace detail {
 
     CachedActorList _actors; // 缓存的参与者列表
 
+    mutable std::mutex _frame_timings_mutex;
+
+    std::deque<rpc::FrameTimings> _client_frame_timings;
+
+    mutable std::mutex _actor_list_changes_mutex;
+
+    /// 每一项的序号依次加一，最后一项的序号为 _actor_list_changes_sequence。
+    std::deque<ActorListChanges> _actor_list_changes;
+
+    uint64_t _actor_list_changes_sequence = 0u;
+
+    /// 可以查询的最小序号，更早的变化已经丢弃。
+    uint64_t _actor_list_changes_oldest = 0u;
+
+    EpisodeStateHistory _state_history;
+
+    ActorChangeFeed _actor_changes;
+
+    CallbackList<const ActorStateChanges &> _on_actor_changes_callbacks;
+
     CallbackList<WorldSnapshot> _on_tick_callbacks; // tick 事件回调列表
 
+    ClientSideSensorPipeline _client_side_sensors;
+
     CallbackList<WorldSnapshot> _on_map_change_callbacks; // 地图变化事件回调列表
 
     CallbackList<WorldSnapshot> _on_light_update_callbacks; // 光照更新事件回调列表
@@ -10,6 +10,24 @@ namespace carla {
 namespace client {
 namespace detail {
 
+  static ActorSnapshot MakeActorSnapshot(const sensor::data::ActorDynamicState &actor) {
+    return ActorSnapshot{
+        actor.id,
+        actor.actor_state,
+        actor.transform,
+        actor.velocity,
+        actor.angular_velocity,
+        actor.acceleration,
+        actor.state};
+  }
+
+  size_t EpisodeState::EstimateArenaSize(const size_t number_of_actors) {
+    // 节点包含键值对、下一节点指针与缓存的哈希值，桶数组约为元素数的两倍
+    constexpr size_t node_size = sizeof(ActorMap::value_type) + 2u * sizeof(void *);
+    constexpr size_t bucket_size = 2u * sizeof(void *);
+    return number_of_actors * (node_size + bucket_size) + 256u;
+  }
+
   EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
     : _episode_id(state.GetEpisodeId()),
       _timestamp(
@@ -18,24 +36,43 @@ namespace detail {
           state.GetDeltaSeconds(),
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),
-      _simulation_state(state.GetSimulationState()) {
+      _simulation_state(state.GetSimulationState()),
+      _arena(EstimateArenaSize(state.size())),
+      _actors(ActorMap::allocator_type(_arena)) {
     _actors.reserve(state.size());
     for (auto &&actor : state) {
       DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.actor_state,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
+      _actors.emplace(actor.id, MakeActorSnapshot(actor));
       DEBUG_ASSERT(result.second);
     }
   }
 
+  EpisodeState::EpisodeState(
+      const sensor::data::RawEpisodeState &state,
+      const EpisodeState &base)
+    : _episode_id(state.GetEpisodeId()),
+      _timestamp(
+          state.GetFrame(),
+          state.GetGameTimeStamp(),
+          state.GetDeltaSeconds(),
+          state.GetPlatformTimeStamp()),
+      _map_origin(state.GetMapOrigin()),
+      _simulation_state(state.GetSimulationState()),
+      _arena(EstimateArenaSize(base.size() + state.size())),
+      _actors(ActorMap::allocator_type(_arena)) {
+    DEBUG_ASSERT(state.IsDelta());
+    DEBUG_ASSERT(state.GetEpisodeId() == base.GetEpisodeId());
+    DEBUG_ASSERT(state.GetBaseFrame() == base.GetFrame());
+    _actors.reserve(base.size() + state.size());
+    _actors.insert(base._actors.begin(), base._actors.end());
+    for (auto id : state.GetRemovedActorIds()) {
+      _actors.erase(id);
+    }
+    for (auto &&actor : state) {
+      _actors[actor.id] = MakeActorSnapshot(actor);
+    }
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
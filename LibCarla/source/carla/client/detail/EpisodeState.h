@@ -8,15 +8,19 @@
 
 #include "carla/Iterator.h" // 引入迭代器头文件
 #include "carla/ListView.h" // 引入列表视图头文件
+#include "carla/MonotonicArena.h"
 #include "carla/NonCopyable.h" // 引入不可复制类的头文件
 #include "carla/client/ActorSnapshot.h" // 引入参与者快照头文件
+#include "carla/client/ActorSnapshotColumns.h"
 #include "carla/client/Timestamp.h" // 引入时间戳头文件
+#include "carla/client/detail/ActorSpatialGrid.h"
 #include "carla/geom/Vector3DInt.h" // 引入三维整数向量头文件
 #include "carla/sensor/data/RawEpisodeState.h" // 引入原始剧集状态数据头文件
 
 #include <boost/optional.hpp> // 引入Boost可选类型头文件
 
 #include <memory> // 引入智能指针头文件
+#include <mutex>
 #include <unordered_map> // 引入无序映射头文件
 
 namespace carla { // 定义carla命名空间
@@ -33,11 +37,16 @@ namespace detail { // 定义detail子命名空间
   public:
 
     // 构造函数，接受剧集ID
-    explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
+    explicit EpisodeState(uint64_t episode_id)
+      : _episode_id(episode_id),
+        _actors(ActorMap::allocator_type(_arena)) {}
 
     // 构造函数，接受原始剧集状态
     explicit EpisodeState(const sensor::data::RawEpisodeState &state);
 
+    /// 将增量消息 @a state 应用到 @a base 上，@a base 必须是增量的基准帧。
+    EpisodeState(const sensor::data::RawEpisodeState &state, const EpisodeState &base);
+
     // 获取剧集ID
     auto GetEpisodeId() const {
       return _episode_id;
@@ -109,6 +118,22 @@ namespace detail { // 定义detail子命名空间
       return iterator::make_map_values_const_iterator(_actors.end()); // 返回参与者快照值的结束迭代器
     }
 
+    /// 按列存储的参与者状态，第一次调用时生成，之后返回同一个对象。
+    std::shared_ptr<const ActorSnapshotColumns> GetActorSnapshotColumns() const {
+      std::call_once(_columns_flag, [this]() {
+        _columns = std::make_shared<const ActorSnapshotColumns>(begin(), end());
+      });
+      return _columns;
+    }
+
+    /// 按位置索引参与者的网格，第一次调用时生成，之后返回同一个对象。
+    std::shared_ptr<const ActorSpatialGrid> GetActorSpatialGrid() const {
+      std::call_once(_grid_flag, [this]() {
+        _grid = std::make_shared<const ActorSpatialGrid>(begin(), end());
+      });
+      return _grid;
+    }
+
   private:
 
     // 复制指定参与者的快照（如果存在）
@@ -128,7 +153,29 @@ namespace detail { // 定义detail子命名空间
 
     SimulationState _simulation_state; // 存储模拟状态
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors; // 存储参与者快照的无序映射
+    using ActorMap = std::unordered_map<
+        ActorId,
+        ActorSnapshot,
+        std::hash<ActorId>,
+        std::equal_to<ActorId>,
+        ArenaAllocator<std::pair<const ActorId, ActorSnapshot>>>;
+
+    /// 按参与者数量估计映射需要的内存，使大多数帧只需要分配一次。
+    static size_t EstimateArenaSize(size_t number_of_actors);
+
+    /// 本帧参与者映射的节点与桶从这里分配，随快照一起释放；必须在 _actors
+    /// 之前声明，保证映射先销毁。
+    MonotonicArena _arena;
+
+    ActorMap _actors; // 存储参与者快照的无序映射
+
+    mutable std::once_flag _columns_flag;
+
+    mutable std::shared_ptr<const ActorSnapshotColumns> _columns;
+
+    mutable std::once_flag _grid_flag;
+
+    mutable std::shared_ptr<const ActorSpatialGrid> _grid;
   };
 
 } // namespace detail
@@ -0,0 +1,126 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/EpisodeStateHistory.h"
+
+#include "carla/client/detail/EpisodeState.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  static void Copy(const geom::Vector3D &vector, float (&out)[ActorTrajectory::VECTOR_SIZE]) {
+    out[0u] = vector.x;
+    out[1u] = vector.y;
+    out[2u] = vector.z;
+  }
+
+  void EpisodeStateHistory::Configure(const double max_duration, const size_t max_frames) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const bool enabled = (max_duration > 0.0) && (max_frames > 0u);
+    _max_duration = enabled ? max_duration : 0.0;
+    _max_frames = enabled ? max_frames : 0u;
+    _enabled.store(enabled, std::memory_order_relaxed);
+    if (!enabled) {
+      _frames.clear();
+      _spare = std::vector<ActorSample>{};
+    } else if (!_frames.empty()) {
+      Trim(_frames.back().timestamp);
+    }
+  }
+
+  void EpisodeStateHistory::Record(const EpisodeState &state) {
+    if (!IsEnabled()) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if ((_max_frames == 0u) || (!_frames.empty() && (state.GetFrame() <= _frames.back().frame))) {
+      return;
+    }
+    Frame frame;
+    frame.frame = state.GetFrame();
+    frame.timestamp = state.GetTimestamp().elapsed_seconds;
+    frame.actors = std::move(_spare);
+    frame.actors.clear();
+    frame.actors.reserve(state.size());
+    for (const auto &snapshot : state) {
+      const auto &location = snapshot.transform.location;
+      const auto &rotation = snapshot.transform.rotation;
+      ActorSample sample;
+      sample.id = snapshot.id;
+      sample.transform[0u] = location.x;
+      sample.transform[1u] = location.y;
+      sample.transform[2u] = location.z;
+      sample.transform[3u] = rotation.pitch;
+      sample.transform[4u] = rotation.yaw;
+      sample.transform[5u] = rotation.roll;
+      Copy(snapshot.velocity, sample.velocity);
+      Copy(snapshot.angular_velocity, sample.angular_velocity);
+      Copy(snapshot.acceleration, sample.acceleration);
+      frame.actors.emplace_back(sample);
+    }
+    std::sort(frame.actors.begin(), frame.actors.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.id < rhs.id;
+    });
+    _spare.clear();
+    _frames.emplace_back(std::move(frame));
+    Trim(_frames.back().timestamp);
+  }
+
+  void EpisodeStateHistory::Trim(const double latest_timestamp) {
+    while (!_frames.empty() &&
+           ((_frames.size() > _max_frames) ||
+            (latest_timestamp - _frames.front().timestamp > _max_duration))) {
+      _spare = std::move(_frames.front().actors);
+      _frames.pop_front();
+    }
+  }
+
+  void EpisodeStateHistory::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _frames.clear();
+  }
+
+  size_t EpisodeStateHistory::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _frames.size();
+  }
+
+  std::shared_ptr<const ActorTrajectory> EpisodeStateHistory::GetActorTrajectory(
+      const ActorId id,
+      const double begin,
+      const double end) const {
+    auto result = std::make_shared<ActorTrajectory>(id);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto first = std::lower_bound(_frames.begin(), _frames.end(), begin, [](const Frame &frame, double time) {
+      return frame.timestamp < time;
+    });
+    auto last = std::upper_bound(first, _frames.end(), end, [](double time, const Frame &frame) {
+      return time < frame.timestamp;
+    });
+    result->Reserve(static_cast<size_t>(std::distance(first, last)));
+    for (auto it = first; it != last; ++it) {
+      auto sample = std::lower_bound(it->actors.begin(), it->actors.end(), id, [](const ActorSample &lhs, ActorId rhs) {
+        return lhs.id < rhs;
+      });
+      if ((sample != it->actors.end()) && (sample->id == id)) {
+        result->Append(
+            it->frame,
+            it->timestamp,
+            sample->transform,
+            sample->velocity,
+            sample->angular_velocity,
+            sample->acceleration);
+      }
+    }
+    return result;
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/client/ActorTrajectory.h"
+#include "carla/rpc/ActorId.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  class EpisodeState;
+
+  /// 最近几帧剧集状态的紧凑记录，用于查询参与者在一段时间内的轨迹。
+  ///
+  /// 默认不记录。每帧只保存每个参与者的变换、速度、角速度和加速度，按参与者
+  /// ID 排序；超出时长或帧数上限的帧被丢弃，其内存由之后的帧复用。
+  class EpisodeStateHistory : private NonCopyable {
+  public:
+
+    /// 最多保留 @a max_duration 秒且不超过 @a max_frames 帧，任一为 0 时停止记录
+    /// 并清空历史。
+    void Configure(double max_duration, size_t max_frames);
+
+    bool IsEnabled() const {
+      return _enabled.load(std::memory_order_relaxed);
+    }
+
+    /// 记录一帧，帧号必须大于上一次记录的帧，否则忽略。
+    void Record(const EpisodeState &state);
+
+    void Clear();
+
+    /// 保留的帧数。
+    size_t size() const;
+
+    /// 参与者 @a id 在模拟时间 [@a begin, @a end]（秒）内的轨迹，没有样本时为空。
+    std::shared_ptr<const ActorTrajectory> GetActorTrajectory(
+        ActorId id,
+        double begin,
+        double end) const;
+
+  private:
+
+    struct ActorSample {
+      ActorId id;
+      float transform[ActorTrajectory::TRANSFORM_SIZE];
+      float velocity[ActorTrajectory::VECTOR_SIZE];
+      float angular_velocity[ActorTrajectory::VECTOR_SIZE];
+      float acceleration[ActorTrajectory::VECTOR_SIZE];
+    };
+
+    struct Frame {
+      uint64_t frame = 0u;
+      double timestamp = 0.0;
+      /// 按 ID 升序排列。
+      std::vector<ActorSample> actors;
+    };
+
+    void Trim(double latest_timestamp);
+
+    std::atomic_bool _enabled{false};
+
+    mutable std::mutex _mutex;
+
+    double _max_duration = 0.0;
+
+    size_t _max_frames = 0u;
+
+    std::deque<Frame> _frames;
+
+    /// 最近丢弃的帧，复用其分配的内存。
+    std::vector<ActorSample> _spare;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -18,8 +18,12 @@
 #include "carla/client/WalkerAIController.h"
 #include "carla/client/detail/ActorFactory.h"
 #include "carla/client/detail/WalkerNavigation.h"
+#include "carla/profiler/TraceProfiler.h"
 #include "carla/trafficmanager/TrafficManager.h"
 #include "carla/sensor/Deserializer.h"
+#include "carla/sensor/s11n/SensorBundleSerializer.h"
+#include "carla/sensor/s11n/VideoStream.h"
+#include "carla/streaming/detail/Token.h"
 
 #include <exception>
 #include <thread>
@@ -182,7 +186,8 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
       std::reverse(map_base_path.begin(), map_base_path.end());
       std::string XODRFolder = map_base_path + "/OpenDrive/" + map_name + ".xodr";
       if (FileTransfer::FileExists(XODRFolder) == false) _client.GetRequiredFiles();
-      _open_drive_file = _client.GetMapData();
+      // 本地缓存中有相同内容的 OpenDRIVE 时不需要下载
+      _open_drive_file = _client.GetMapData(map_info.open_drive_hash);
       _cached_map = MakeShared<Map>(map_info, _open_drive_file);
     }
 
@@ -198,23 +203,57 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
       return _client.SetFilesBaseFolder(path);
     }
 
-    std::vector<std::string> Simulator::GetRequiredFiles(const std::string &folder, const bool download) const {
-      return _client.GetRequiredFiles(folder, download);
+    std::vector<std::string> Simulator::GetRequiredFiles(
+        const std::string &folder,
+        const bool download,
+        const FileTransfer::ProgressCallback &progress) const {
+      return _client.GetRequiredFiles(folder, download, progress);
     }
 
-    void Simulator::RequestFile(const std::string &name) const {
-      _client.RequestFile(name);
+    void Simulator::RequestFile(const std::string &name, const FileTransfer::ProgressCallback &progress) const {
+      _client.RequestFile(name, progress);
     }
 
     std::vector<uint8_t> Simulator::GetCacheFile(const std::string &name, const bool request_otherwise) const {
       return _client.GetCacheFile(name, request_otherwise);
     }
 
+    std::unique_ptr<MappedFile> Simulator::MapNavigationMesh() {
+      return _client.MapNavigationMesh(_client.GetMapInfo().navigation_mesh_hash);
+    }
+
+    std::vector<uint8_t> Simulator::GetNavigationMesh() {
+      const auto map_info = _client.GetMapInfo();
+      if (map_info.navigation_mesh_hash.empty()) {
+        return {};
+      }
+      return _client.GetNavigationMesh(map_info.navigation_mesh_hash);
+    }
+
   // ===========================================================================
   // -- 节拍 -------------------------------------------------------------------
   // ===========================================================================
 
+  std::vector<rpc::FrameTimings> Simulator::GetFrameTimings(const uint64_t count) {
+    DEBUG_ASSERT(_episode != nullptr);
+    auto result = _client.GetFrameTimings(count);
+    const auto client_timings = _episode->GetClientFrameTimings();
+    // 两个列表都按帧号升序排列
+    auto it = client_timings.begin();
+    for (auto &timings : result) {
+      while ((it != client_timings.end()) && (it->frame < timings.frame)) {
+        ++it;
+      }
+      if ((it != client_timings.end()) && (it->frame == timings.frame)) {
+        timings.deserialization = it->deserialization;
+        timings.callbacks = it->callbacks;
+      }
+    }
+    return result;
+  }
+
   WorldSnapshot Simulator::WaitForTick(time_duration timeout) {
+    CARLA_TRACE_SCOPE(client, wait_for_tick);
     DEBUG_ASSERT(_episode != nullptr);
 
     // 发出行人导航节拍
@@ -228,6 +267,7 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
   }
 
   uint64_t Simulator::Tick(time_duration timeout) {
+    CARLA_TRACE_SCOPE(client, tick);
     DEBUG_ASSERT(_episode != nullptr);
 
     // 发出行人导航节拍
@@ -244,6 +284,43 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     return frame;
   }
 
+  RpcFuture<uint64_t> Simulator::TickAsync(time_duration timeout) {
+    CARLA_TRACE_SCOPE(client, tick_async);
+    DEBUG_ASSERT(_episode != nullptr);
+
+    NavigationTick();
+
+    auto cue = _client.SendTickCueAsync();
+    auto episode = _episode;
+    const auto has_frame = [cue, episode]() {
+      try {
+        return cue.Get() <= episode->GetState()->GetTimestamp().frame;
+      } catch (const std::exception &) {
+        // 错误在 Get() 中抛出
+        return true;
+      }
+    };
+    return RpcFuture<uint64_t>(
+        [cue, episode, has_frame](time_duration wait_timeout) {
+          if (!cue.WaitFor(wait_timeout)) {
+            return false;
+          }
+          if (has_frame()) {
+            return true;
+          }
+          // 快照在流的线程中到达
+          episode->WaitForState(wait_timeout);
+          return has_frame();
+        },
+        [cue, episode, timeout, endpoint=_client.GetEndpoint()]() {
+          const auto frame = cue.Get();
+          if (!SynchronizeFrame(frame, *episode, timeout)) {
+            throw_exception(TimeoutException(endpoint, timeout));
+          }
+          return frame;
+        });
+  }
+
   // ===========================================================================
   // -- 在场景中访问全局对象 -----------------------------------------------------
   // ===========================================================================
@@ -340,12 +417,15 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     DEBUG_ASSERT(_episode != nullptr);
     auto nav = _episode->CreateNavigationIfMissing();
     nav->SetPedestriansCrossFactor(percentage);// 设置行人穿越系数
+    // 服务器端导航的行人使用相同的设置
+    _client.SetServerNavigationPedestriansCrossFactor(percentage);
   }
 
   void Simulator::SetPedestriansSeed(unsigned int seed) {
     DEBUG_ASSERT(_episode != nullptr);
     auto nav = _episode->CreateNavigationIfMissing();
     nav->SetPedestriansSeed(seed);// 设置行人种子值，用于随机生成行人的位置等
+    _client.SetServerNavigationPedestriansSeed(seed);
   }
 
   // ===========================================================================
@@ -413,12 +493,24 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
 
   void Simulator::SubscribeToSensor(
       const Sensor &sensor,
-      std::function<void(SharedPtr<sensor::SensorData>)> callback) {
+      std::function<void(SharedPtr<sensor::SensorData>)> callback,
+      const bool decompress,
+      const bool lazy) {
     DEBUG_ASSERT(_episode != nullptr);
+    std::shared_ptr<sensor::s11n::VideoDecoder> decoder = sensor::Deserializer::MakeVideoDecoder();
     _client.SubscribeToStream(
         sensor.GetActorDescription().GetStreamToken(),
-        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
-          auto data = sensor::Deserializer::Deserialize(std::move(buffer));
+        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}, decompress, lazy, decoder](auto buffer) {
+          // 视频帧依赖于之前的帧，必须按到达的顺序解码，懒加载时也一样
+          if (decompress && sensor::Deserializer::IsVideoFrame(buffer)) {
+            buffer = decoder->Decode(std::move(buffer));
+            if (buffer.empty()) {
+              return; // 等待下一个关键帧
+            }
+          }
+          auto data = lazy ?
+              sensor::Deserializer::DeserializeLazy(std::move(buffer)) :
+              sensor::Deserializer::Deserialize(std::move(buffer), decompress);
           data->_episode = ep.TryLock();
           cb(std::move(data));
         });
@@ -441,6 +533,74 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     return _client.IsEnabledForROS(sensor.GetActorDescription().GetStreamToken());
   }
 
+  void Simulator::EnableMulticast(const Sensor &sensor) {
+    _client.EnableMulticast(sensor.GetActorDescription().GetStreamToken());
+  }
+
+  void Simulator::DisableMulticast(const Sensor &sensor) {
+    _client.DisableMulticast(sensor.GetActorDescription().GetStreamToken());
+  }
+
+  rpc::StreamStatistics Simulator::GetStreamStatistics(const Sensor &sensor) {
+    return _client.GetStreamStatistics(sensor.GetActorDescription().GetStreamToken());
+  }
+
+  void Simulator::ChangeLevelLayerAsync(
+      const rpc::MapLayer map_layers,
+      const bool load,
+      std::function<void()> callback) {
+    DEBUG_ASSERT(_episode != nullptr);
+    const uint64_t request = load ?
+        _client.LoadLevelLayerAsync(map_layers) :
+        _client.UnloadLevelLayerAsync(map_layers);
+    if (!callback) {
+      return;
+    }
+
+    // 每一帧发出一次不等待的查询，在之后的帧里检查结果，tick 回调不会被阻塞
+    struct PendingRequest {
+      std::mutex mutex;
+      size_t callback_id = 0u;
+      RpcFuture<bool> status;
+      bool done = false;
+    };
+    auto pending = std::make_shared<PendingRequest>();
+    std::lock_guard<std::mutex> lock(pending->mutex);
+    pending->callback_id = _episode->RegisterOnTickEvent(
+        [pending, request, cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](WorldSnapshot) {
+          auto simulator = ep.TryLock();
+          if (simulator == nullptr) {
+            return;
+          }
+          {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            if (pending->done) {
+              return;
+            }
+            if (pending->status.IsValid()) {
+              if (!pending->status.IsReady()) {
+                return;
+              }
+              try {
+                pending->done = pending->status.Get();
+              } catch (const std::exception &e) {
+                log_error("map layer request", request, "failed:", e.what());
+                pending->done = true;
+                simulator->RemoveOnTickEvent(pending->callback_id);
+                return;
+              }
+              pending->status = RpcFuture<bool>{};
+            }
+            if (!pending->done) {
+              pending->status = simulator->_client.IsLevelLayerRequestDoneAsync(request);
+              return;
+            }
+            simulator->RemoveOnTickEvent(pending->callback_id);
+          }
+          cb();
+        });
+  }
+
   void Simulator::SubscribeToGBuffer(
       Actor &actor,
       uint32_t gbuffer_id,
@@ -457,6 +617,45 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     _client.UnSubscribeFromGBuffer(actor.GetId(), gbuffer_id);
   }
 
+  uint32_t Simulator::ListenToSensorBundle(
+      const std::vector<rpc::ActorId> &sensor_ids,
+      std::function<void(std::vector<SharedPtr<sensor::SensorData>>)> callback) {
+    DEBUG_ASSERT(_episode != nullptr);
+    auto token = _client.SubscribeToSensorBundle(
+        sensor_ids,
+        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+          auto parts = sensor::s11n::SensorBundleSerializer::Deserialize(buffer);
+          std::vector<SharedPtr<sensor::SensorData>> bundle;
+          bundle.reserve(parts.size());
+          auto episode = ep.TryLock();
+          for (auto &part : parts) {
+            auto data = sensor::Deserializer::Deserialize(std::move(part.second));
+            data->_episode = episode;
+            bundle.emplace_back(std::move(data));
+          }
+          cb(std::move(bundle));
+        });
+    const auto bundle_id = streaming::detail::token_type(token).get_stream_id();
+    std::lock_guard<std::mutex> lock(_sensor_bundles_mutex);
+    _sensor_bundles[bundle_id] = token;
+    return bundle_id;
+  }
+
+  void Simulator::StopSensorBundle(const uint32_t bundle_id) {
+    streaming::Token token;
+    {
+      std::lock_guard<std::mutex> lock(_sensor_bundles_mutex);
+      auto it = _sensor_bundles.find(bundle_id);
+      if (it == _sensor_bundles.end()) {
+        log_warning("sensor bundle", bundle_id, "not found");
+        return;
+      }
+      token = it->second;
+      _sensor_bundles.erase(it);
+    }
+    _client.UnSubscribeFromSensorBundle(token);
+  }
+
   void Simulator::FreezeAllTrafficLights(bool frozen) {
     _client.FreezeAllTrafficLights(frozen);
   }
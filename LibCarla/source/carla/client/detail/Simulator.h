@@ -25,6 +25,7 @@
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleLightStateList.h"
 #include "carla/rpc/LabelledPoint.h"
+#include "carla/rpc/StreamStatistics.h"
 #include "carla/rpc/VehicleWheels.h"
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
@@ -32,6 +33,8 @@
 #include <boost/optional.hpp>
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace carla {
 namespace client {
@@ -75,6 +78,27 @@ namespace detail {
 
     EpisodeProxy LoadEpisode(std::string map_name, bool reset_settings = true, rpc::MapLayer map_layers = rpc::MapLayer::All);
 
+    /// 不重新加载地图，销毁场景中生成的所有 actor 并重置交通信号灯、天气和时间，
+    /// 场景的 Id 不变，所以返回的还是当前的场景。
+    EpisodeProxy SoftResetEpisode(bool reset_settings = true) {
+      _client.SoftResetEpisode(reset_settings);
+      return GetCurrentEpisode();
+    }
+
+    /// 在服务端的内存中保存场景的当前状态，返回用来恢复它的 Id。
+    uint64_t SaveEpisodeSnapshot() {
+      return _client.SaveEpisodeSnapshot();
+    }
+
+    /// 把场景恢复到保存的状态，可以多次恢复同一个状态。
+    void RestoreEpisodeSnapshot(uint64_t snapshot_id) {
+      _client.RestoreEpisodeSnapshot(snapshot_id);
+    }
+
+    void RemoveEpisodeSnapshot(uint64_t snapshot_id) {
+      _client.RemoveEpisodeSnapshot(snapshot_id);
+    }
+
     void LoadLevelLayer(rpc::MapLayer map_layers) const {
       _client.LoadLevelLayer(map_layers);
     }
@@ -83,6 +107,13 @@ namespace detail {
       _client.UnloadLevelLayer(map_layers);
     }
 
+    /// 在后台加载（@a load 为 true）或卸载 @a map_layers，服务器不会因此停顿。
+    /// 完成后在 tick 回调的线程中调用 @a callback，可以为空。
+    void ChangeLevelLayerAsync(
+        rpc::MapLayer map_layers,
+        bool load,
+        std::function<void()> callback);
+
     EpisodeProxy LoadOpenDriveEpisode(
         std::string opendrive,
         const rpc::OpendriveGenerationParameters & params,
@@ -125,6 +156,29 @@ namespace detail {
       return WorldSnapshot{_episode->GetState()};
     }
 
+    ActorListChanges GetActorListChanges(uint64_t sequence) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorListChanges(sequence);
+    }
+
+    void ConfigureStateHistory(double max_duration, size_t max_frames) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->ConfigureStateHistory(max_duration, max_frames);
+    }
+
+    std::shared_ptr<const ActorTrajectory> GetActorTrajectory(ActorId id, double begin, double end) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorTrajectory(id, begin, end);
+    }
+
+    /// 最近 @a count 帧各阶段的时间，合并了服务器记录的时间和此客户端接收
+    /// 剧集状态时记录的时间。
+    std::vector<rpc::FrameTimings> GetFrameTimings(uint64_t count);
+
+    rpc::SensorTickPlan GetSensorTickPlan(uint32_t frames) {
+      return _client.GetSensorTickPlan(frames);
+    }
+
     /// @}
     // =========================================================================
     /// @name 地图相关的方法
@@ -145,12 +199,22 @@ namespace detail {
 
     bool SetFilesBaseFolder(const std::string &path);
 
-    std::vector<std::string> GetRequiredFiles(const std::string &folder = "", const bool download = true) const;
+    std::vector<std::string> GetRequiredFiles(
+        const std::string &folder = "",
+        const bool download = true,
+        const FileTransfer::ProgressCallback &progress = {}) const;
 
-    void RequestFile(const std::string &name) const;
+    void RequestFile(const std::string &name, const FileTransfer::ProgressCallback &progress = {}) const;
 
     std::vector<uint8_t> GetCacheFile(const std::string &name, const bool request_otherwise) const;
 
+    /// 获取当前地图的导航网格，本地缓存中有相同内容时不从服务器下载。
+    std::vector<uint8_t> GetNavigationMesh();
+
+    /// 以写时复制方式映射本地缓存中当前地图的导航网格，见
+    /// Client::MapNavigationMesh；服务器没有提供内容标识时返回 nullptr。
+    std::unique_ptr<MappedFile> MapNavigationMesh();
+
     /// @}
     // =========================================================================
     /// @name 垃圾收集策略
@@ -201,8 +265,51 @@ namespace detail {
       _episode->RemoveOnTickEvent(id);
     }
 
+    size_t RegisterOnActorChangesEvent(std::function<void(const ActorStateChanges &)> callback) {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->RegisterOnActorChangesEvent(std::move(callback));
+    }
+
+    void RemoveOnActorChangesEvent(size_t id) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->RemoveOnActorChangesEvent(id);
+    }
+
+    void SetActorChangesMoveThreshold(float meters) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->SetActorChangesMoveThreshold(meters);
+    }
+
+    size_t RegisterClientSideSensor(
+        ClientSideSensorPipeline::Request request,
+        ClientSideSensorPipeline::Callback callback) {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->RegisterClientSideSensor(std::move(request), std::move(callback));
+    }
+
+    void RemoveClientSideSensor(size_t id) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->RemoveClientSideSensor(id);
+    }
+
     uint64_t Tick(time_duration timeout);
 
+    /// 与 Tick 相同，但不等待。返回的结果在节拍命令的响应和这一帧的快照都
+    /// 到达后就绪，等待时可以指定超时，适合不阻塞线程的事件循环。
+    RpcFuture<uint64_t> TickAsync(time_duration timeout);
+
+    uint32_t RegisterTickParticipant(const std::string &name, time_duration deadline) {
+      return _client.RegisterTickParticipant(name, static_cast<double>(deadline.milliseconds()) * 1e-3);
+    }
+
+    void UnregisterTickParticipant(uint32_t participant_id) {
+      _client.UnregisterTickParticipant(participant_id);
+    }
+
+    void NotifyTickReady(uint32_t participant_id, uint64_t frame) {
+      _client.NotifyTickReady(participant_id, frame);
+    }
+
     /// @}
     // =========================================================================
     /// @name 访问场景中的全局对象
@@ -284,6 +391,13 @@ namespace detail {
       return _client.GetEnvironmentObjects(queried_tag);
     }
 
+    std::vector<rpc::EnvironmentObject> GetEnvironmentObjectsInRadius(
+        const geom::Location &location,
+        float radius,
+        uint8_t queried_tag) const {
+      return _client.GetEnvironmentObjectsInRadius(location, radius, queried_tag);
+    }
+
     void EnableEnvironmentObjects(
       std::vector<uint64_t> env_objects_ids,
       bool enable) const {
@@ -320,6 +434,26 @@ namespace detail {
 
     void SetPedestriansSeed(unsigned int seed);
 
+    bool AddWalkerToServerNavigation(ActorId walker_id, ActorId controller_id) {
+      return _client.AddWalkerToServerNavigation(walker_id, controller_id);
+    }
+
+    void RemoveWalkerFromServerNavigation(ActorId walker_id) {
+      _client.RemoveWalkerFromServerNavigation(walker_id);
+    }
+
+    bool SetServerNavigationWalkerTarget(ActorId walker_id, const geom::Location &to) {
+      return _client.SetServerNavigationWalkerTarget(walker_id, to);
+    }
+
+    bool SetServerNavigationWalkerMaxSpeed(ActorId walker_id, float max_speed) {
+      return _client.SetServerNavigationWalkerMaxSpeed(walker_id, max_speed);
+    }
+
+    std::vector<geom::Location> GetServerNavigationRandomLocations(uint32_t count) {
+      return _client.GetServerNavigationRandomLocations(count);
+    }
+
     /// @}
     // =========================================================================
     /// @name 参与者的一般操作
@@ -341,6 +475,24 @@ namespace detail {
       return _episode->GetActors();
     }
 
+    std::vector<rpc::Actor> GetActorsByTypeId(const std::string &wildcard_pattern) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActors(wildcard_pattern);
+    }
+
+    std::vector<rpc::Actor> GetActorsInRadius(
+        const geom::Location &location,
+        float radius,
+        const std::string &wildcard_pattern) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorsInRadius(location, radius, wildcard_pattern);
+    }
+
+    /// 在服务器端一次查询多个演员的指定字段，不经过剧集状态。
+    rpc::ActorQueryResult QueryActors(const rpc::ActorQuery &query) {
+      return _client.QueryActors(query);
+    }
+
     /// 根据现有参与者的描述创建一个参与者实例。请注意，这不会生成参与者。
     ///
     /// If @a gc is GarbageCollectionPolicy::Enabled, the shared pointer
@@ -620,6 +772,10 @@ namespace detail {
           BaseJSONPath);
     }
 
+    void EnableKinematicPhysics(Vehicle &vehicle) {
+      _client.EnableKinematicPhysics(vehicle.GetId());
+    }
+
     void RestorePhysXPhysics(Vehicle &vehicle) {
       _client.RestorePhysXPhysics(vehicle.GetId());
     }
@@ -630,8 +786,17 @@ namespace detail {
     // =========================================================================
     /// @{
 
-    std::string StartRecorder(std::string name, bool additional_data) {
-      return _client.StartRecorder(std::move(name), additional_data);
+    std::string StartRecorder(std::string name, bool additional_data, bool compressed) {
+      return _client.StartRecorder(std::move(name), additional_data, compressed);
+    }
+
+    std::string StartFlightRecorder(std::string name, double seconds, double seconds_after,
+        bool additional_data, bool compressed) {
+      return _client.StartFlightRecorder(std::move(name), seconds, seconds_after, additional_data, compressed);
+    }
+
+    std::string TriggerFlightRecorder(void) {
+      return _client.TriggerFlightRecorder();
     }
 
     void StopRecorder(void) {
@@ -667,6 +832,18 @@ namespace detail {
       _client.SetReplayerIgnoreSpectator(ignore_spectator);
     }
 
+    void SetReplayerSkipPhysics(bool skip_physics) {
+      _client.SetReplayerSkipPhysics(skip_physics);
+    }
+
+    void SetReplayerFrameStep(bool frame_step) {
+      _client.SetReplayerFrameStep(frame_step);
+    }
+
+    uint64_t GetReplayerFrame() {
+      return _client.GetReplayerFrame();
+    }
+
     void StopReplayer(bool keep_actors) {
       _client.StopReplayer(keep_actors);
   }
@@ -677,9 +854,15 @@ namespace detail {
     // =========================================================================
     /// @{
 
+    /// @param decompress 为 false 时，压缩的数据以 sensor::data::CompressedData
+    /// 的形式交给回调，不进行解压。
+    /// @param lazy 为 true 时只解析数据头，数据以 sensor::data::LazyData 的形式
+    /// 交给回调，负载在第一次访问时才反序列化。
     void SubscribeToSensor(
         const Sensor &sensor,
-        std::function<void(SharedPtr<sensor::SensorData>)> callback);
+        std::function<void(SharedPtr<sensor::SensorData>)> callback,
+        bool decompress = true,
+        bool lazy = false);
 
     void UnSubscribeFromSensor(Actor &sensor);
 
@@ -689,6 +872,12 @@ namespace detail {
 
     bool IsEnabledForROS(const Sensor &sensor);
 
+    void EnableMulticast(const Sensor &sensor);
+
+    void DisableMulticast(const Sensor &sensor);
+
+    rpc::StreamStatistics GetStreamStatistics(const Sensor &sensor);
+
     void SubscribeToGBuffer(
         Actor & sensor,
         uint32_t gbuffer_id,
@@ -700,6 +889,16 @@ namespace detail {
 
     void Send(const Sensor &sensor, std::string message);        
 
+    /// 将一组传感器每帧的数据合并，在所有传感器的数据都到达后调用一次 @a callback，
+    /// 数据按 @a sensor_ids 的顺序排列。
+    ///
+    /// @return 传感器组的 ID，用于 StopSensorBundle。
+    uint32_t ListenToSensorBundle(
+        const std::vector<rpc::ActorId> &sensor_ids,
+        std::function<void(std::vector<SharedPtr<sensor::SensorData>>)> callback);
+
+    void StopSensorBundle(uint32_t bundle_id);
+
     /// @}
     // =========================================================================
     /// @name 交通灯的操作
@@ -753,6 +952,18 @@ namespace detail {
       _client.DrawDebugShape(shape);
     }
 
+    void DrawDebugShapes(const std::vector<rpc::DebugShape> &shapes) {
+      _client.DrawDebugShapes(shapes);
+    }
+
+    uint64_t DrawDebugShapeGroup(const std::vector<rpc::DebugShape> &shapes, uint64_t group) {
+      return _client.DrawDebugShapeGroup(shapes, group);
+    }
+
+    void ClearDebugShapeGroup(uint64_t group) {
+      _client.ClearDebugShapeGroup(group);
+    }
+
     /// @}
     // =========================================================================
     /// @name Apply commands in batch
@@ -767,6 +978,26 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    bool ApplyVehicleControls(std::vector<rpc::Command::ApplyVehicleControl> controls) {
+      return _client.ApplyVehicleControls(std::move(controls));
+    }
+
+    bool ApplyWalkerStates(const rpc::WalkerStates &states) {
+      return _client.ApplyWalkerStates(states);
+    }
+
+    auto ApplyBatchAsync(std::vector<rpc::Command> commands, bool do_tick_cue) {
+      return _client.ApplyBatchAsync(std::move(commands), do_tick_cue);
+    }
+
+    auto SpawnActors(const rpc::ActorSpawnBatch &batch) {
+      return _client.SpawnActors(batch);
+    }
+
+    auto SpawnActorsAsync(const rpc::ActorSpawnBatch &batch) {
+      return _client.SpawnActorsAsync(batch);
+    }
+
     /// @}
     // =========================================================================
     /// @name 操作灯
@@ -781,6 +1012,11 @@ namespace detail {
       return _client.QueryLightsStateToServer();
     }
 
+    std::pair<uint64_t, std::vector<rpc::LightState>> QueryLightsStateToServerSince(
+        uint64_t version) const {
+      return _client.QueryLightsStateToServerSince(version);
+    }
+
     void UpdateServerLightsState(
         std::vector<rpc::LightState>& lights,
         bool discard_client = false) const {
@@ -838,6 +1074,10 @@ namespace detail {
     SharedPtr<Map> _cached_map;
 
     std::string _open_drive_file;
+
+    std::mutex _sensor_bundles_mutex;
+
+    std::unordered_map<uint32_t, streaming::Token> _sensor_bundles;
   };
 
 } // namespace detail
@@ -6,6 +6,10 @@
 
 #include "carla/client/detail/WalkerNavigation.h"
 
+#include "carla/Logging.h"
+#include "carla/client/TrafficLight.h"
+#include "carla/client/Waypoint.h"
+#include "carla/client/World.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/Episode.h"
 #include "carla/client/detail/EpisodeState.h"
@@ -16,14 +20,54 @@
 #include "carla/rpc/WalkerControl.h"
 
 #include <sstream>
+#include <unordered_map>
 
 namespace carla {
 namespace client {
 namespace detail {
 
   WalkerNavigation::WalkerNavigation(std::weak_ptr<Simulator> simulator) : _simulator(simulator), _next_check_index(0) {
-    _nav.SetSimulator(simulator);
-    // 这里调用服务器来检索导航网格数据。
+    // 交通灯的停止位置和状态从模拟器获取，保留交通灯对象以便快速读取状态
+    auto lights = std::make_shared<std::unordered_map<ActorId, SharedPtr<TrafficLight>>>();
+    _nav.SetTrafficLights(
+        [simulator, lights]() {
+          std::vector<carla::nav::TrafficLightStop> stops;
+          auto sim = simulator.lock();
+          if (sim == nullptr) {
+            return stops;
+          }
+          World world = sim->GetWorld();
+          for (auto &&actor : sim->GetAllTheActorsInTheEpisode()) {
+            // 仅检查交通灯
+            if (actor.description.id == "traffic.traffic_light") {
+              auto tl = boost::static_pointer_cast<TrafficLight>(world.GetActor(actor.id));
+              (*lights)[actor.id] = tl;
+              // 获取交通灯影响的路标
+              for (auto &way : tl->GetStopWaypoints()) {
+                stops.emplace_back(actor.id, way->GetTransform().location);
+              }
+            }
+          }
+          return stops;
+        },
+        [lights](ActorId id) {
+          auto it = lights->find(id);
+          if (it == lights->end()) {
+            return rpc::TrafficLightState::Unknown;
+          }
+          return it->second->GetState();
+        });
+    // 这里调用服务器来检索导航网格数据，本地缓存中有相同内容时不下载。优先映射
+    // 缓存的文件，同一台机器上的客户端共享其页缓存。
+    auto mapped_mesh = _simulator.lock()->MapNavigationMesh();
+    if ((mapped_mesh != nullptr) && _nav.Load(std::move(mapped_mesh))) {
+      return;
+    }
+    auto navigation_mesh = _simulator.lock()->GetNavigationMesh();
+    if (!navigation_mesh.empty()) {
+      _nav.Load(std::move(navigation_mesh));
+      return;
+    }
     auto files = _simulator.lock()->GetRequiredFiles("Nav");
     if (!files.empty()) {
       _nav.Load(_simulator.lock()->GetCacheFile(files[0], true));
@@ -46,20 +90,19 @@ namespace detail {
     UpdateVehiclesInCrowd(episode, false);
 
     // 更新导航模块中的人群
-    _nav.UpdateCrowd(*state);
+    _nav.UpdateCrowd(state->GetTimestamp().delta_seconds);
 
     carla::geom::Transform trans;
-    using Cmd = rpc::Command;
-    std::vector<Cmd> commands;
-    commands.reserve(walkers->size());
+    _walker_states.clear();
+    _walker_states.Reserve(walkers->size());
     for (auto handle : *walkers) {
       // 获取行人的变换
       if (_nav.GetWalkerTransform(handle.walker, trans)) {
         float speed = _nav.GetWalkerSpeed(handle.walker);
-        commands.emplace_back(Cmd::ApplyWalkerState{ handle.walker, trans, speed });
+        _walker_states.Add(handle.walker, trans, speed);
       }
     }
-    _simulator.lock()->ApplyBatchSync(std::move(commands), false);
+    SendWalkerStates();
 
     // 检查是否所有代理已被杀死
     bool alive;
@@ -80,6 +123,34 @@ namespace detail {
     }
   }
 
+  void WalkerNavigation::SendWalkerStates() {
+    if (_walker_states.empty()) {
+      return;
+    }
+    auto simulator = _simulator.lock();
+    if (_walker_states_supported) {
+      try {
+        if (simulator->ApplyWalkerStates(_walker_states)) {
+          return;
+        }
+        log_warning("batched walker states not available, falling back to apply_batch");
+        _walker_states_supported = false;
+      } catch (const std::exception &e) {
+        // 服务器拒绝整批时不会应用其中任何状态，这一次改用apply_batch逐个应用
+        log_warning("batched walker states rejected, sending them with apply_batch:", e.what());
+      }
+    }
+    std::vector<rpc::Command> commands;
+    commands.reserve(_walker_states.size());
+    for (size_t i = 0u; i < _walker_states.size(); ++i) {
+      commands.emplace_back(rpc::Command::ApplyWalkerState{
+          _walker_states.actors[i],
+          _walker_states.transforms[i],
+          _walker_states.speeds[i]});
+    }
+    simulator->ApplyBatchSync(std::move(commands), false);
+  }
+
   void WalkerNavigation::CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state) {
 
     // 与总数进行核对
@@ -11,6 +11,7 @@
 #include "carla/NonCopyable.h" // 引入不可复制类的头文件
 #include "carla/client/Timestamp.h" // 引入时间戳头文件
 #include "carla/rpc/ActorId.h" // 引入参与者ID头文件
+#include "carla/rpc/WalkerStates.h"
 
 #include <memory> // 引入智能指针头文件
 
@@ -100,6 +101,15 @@ namespace detail { // 定义detail子命名空间
 
     AtomicList<WalkerHandle> _walkers;
 
+    /// 每次更新发送给服务器的行人状态，保留以重用内存
+    rpc::WalkerStates _walker_states;
+
+    /// 服务器是否支持批量行人状态接口，旧版本的服务器不支持
+    bool _walker_states_supported = true;
+
+    /// 把 _walker_states 发送给服务器，不支持时改为逐个发送 ApplyWalkerState 命令
+    void SendWalkerStates();
+
     /// 检查一些行人，如果不存在，则将其从人群中移除
     void CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state);
     /// 添加/更新/删除人群中的所有车辆
@@ -12,7 +12,9 @@
 #include "carla/geom/Location.h"
 #include "carla/geom/Vector3D.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 
 #ifdef LIBCARLA_INCLUDED_FROM_UE4
 #include <compiler/enable-ue4-macros.h>
@@ -118,6 +120,53 @@ namespace geom {
         return world_vertices;
     }
 
+    /**
+     * 计算 @a count 个边界框在世界空间中的顶点，第 i 个边界框用 @a transforms[i]
+     * 变换，它的第 k 个顶点（顺序与 GetWorldVertices 相同）写到 @a x、@a y、@a z
+     * 的第 8 * i + k 个元素，每个数组至少有 8 * @a count 个元素。
+     *
+     * 每个边界框只计算一次组合后的矩阵，顶点的循环没有分支，编译器可以把它向量化。
+     */
+    static void GetWorldVertices(
+        const BoundingBox *boxes,
+        const Transform *transforms,
+        size_t count,
+        float *__restrict x,
+        float *__restrict y,
+        float *__restrict z) {
+      // 顶点 k 在 x、y、z 方向上取 extent 的符号，由 k 的第 2、1、0 位决定
+      constexpr float sign_x[8] = {-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+      constexpr float sign_y[8] = {-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f};
+      constexpr float sign_z[8] = {-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
+      for (size_t i = 0u; i < count; ++i) {
+        const auto &box = boxes[i];
+        // 世界变换与边界框自身的变换相乘，得到从边界框中心到世界空间的 3×4 矩阵
+        const auto w = transforms[i].GetMatrix();
+        const auto b = Transform(box.location, box.rotation).GetMatrix();
+        float m[12];
+        for (size_t r = 0u; r < 3u; ++r) {
+          for (size_t c = 0u; c < 4u; ++c) {
+            m[4u * r + c] =
+                w[4u * r] * b[c] +
+                w[4u * r + 1u] * b[4u + c] +
+                w[4u * r + 2u] * b[8u + c] +
+                (c == 3u ? w[4u * r + 3u] : 0.0f);
+          }
+        }
+        float *__restrict out_x = x + 8u * i;
+        float *__restrict out_y = y + 8u * i;
+        float *__restrict out_z = z + 8u * i;
+        for (size_t k = 0u; k < 8u; ++k) {
+          const float ex = sign_x[k] * box.extent.x;
+          const float ey = sign_y[k] * box.extent.y;
+          const float ez = sign_z[k] * box.extent.z;
+          out_x[k] = m[0] * ex + m[1] * ey + m[2] * ez + m[3];
+          out_y[k] = m[4] * ex + m[5] * ey + m[6] * ez + m[7];
+          out_z[k] = m[8] * ex + m[9] * ey + m[10] * ez + m[11];
+        }
+      }
+    }
+
     // =========================================================================
     // -- 比较运算符 -------------------------------------------------
     // =========================================================================
@@ -0,0 +1,221 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/ParallelFor.h"
+#include "carla/geom/Math.h"
+#include "carla/geom/Transform.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+namespace geom {
+
+  /// 与 CARLA 的相机传感器相同的针孔相机模型：焦距由水平视场角计算，像素为
+  /// 正方形，主点位于图像中心。相机空间中 x 向前、y 向右、z 向上，像素坐标
+  /// u 向右、v 向下。
+  class CameraProjection {
+  public:
+
+    /// 每个线程至少处理的点数，点少时在调用线程中直接投影。
+    static constexpr size_t MinPointsPerThread = 1u << 14u;
+
+    CameraProjection(
+        const Transform &camera_transform,
+        uint32_t image_width,
+        uint32_t image_height,
+        float fov)
+      : _world_to_camera(camera_transform.GetInverseMatrix()),
+        _image_width(image_width),
+        _image_height(image_height),
+        _focal_length(static_cast<float>(image_width) / (2.0f * std::tan(Math::ToRadians(fov) / 2.0f))) {
+      DEBUG_ASSERT(fov > 0.0f && fov < 180.0f);
+    }
+
+    uint32_t GetImageWidth() const {
+      return _image_width;
+    }
+
+    uint32_t GetImageHeight() const {
+      return _image_height;
+    }
+
+    float GetFocalLength() const {
+      return _focal_length;
+    }
+
+    /// 3×3 的内参矩阵 K，按行存放。
+    std::array<float, 9> GetIntrinsics() const {
+      return {
+          _focal_length, 0.0f, 0.5f * _image_width,
+          0.0f, _focal_length, 0.5f * _image_height,
+          0.0f, 0.0f, 1.0f};
+    }
+
+    /// 把 @a count 个点投影到图像上。第 i 个点的 x、y、z 为 @a points 中第
+    /// @a stride * i 个及其后的两个 float（如激光雷达的检测点，stride 为每个点的
+    /// float 数），坐标位于 @a source_transform 的空间中。
+    ///
+    /// 像素坐标写到 @a u、@a v，沿相机前方的深度写到 @a depth。相机后方的点
+    /// 深度不大于 0，像素坐标为 NaN；图像外的点照常写入，由调用者筛选。
+    void ProjectPoints(
+        const Transform &source_transform,
+        const float *points,
+        size_t stride,
+        size_t count,
+        float *u,
+        float *v,
+        float *depth) const {
+      DEBUG_ASSERT(stride >= 3u);
+      const auto m = Compose(_world_to_camera, source_transform.GetMatrix());
+      ParallelFor(NumberOfBlocks(count), [&](const size_t block) {
+        const size_t begin = block * MinPointsPerThread;
+        const size_t end = std::min(count, begin + MinPointsPerThread);
+        Project(m, points + stride * begin, stride, end - begin, u + begin, v + begin, depth + begin);
+      }, 1u);
+    }
+
+    /// 与 ProjectPoints 相同，但世界空间中的点按坐标分别存放，如
+    /// BoundingBox::GetWorldVertices 的结果。
+    void ProjectWorldPoints(
+        const float *x,
+        const float *y,
+        const float *z,
+        size_t count,
+        float *u,
+        float *v,
+        float *depth) const {
+      const auto &m = _world_to_camera;
+      ParallelFor(NumberOfBlocks(count), [&](const size_t block) {
+        const size_t begin = block * MinPointsPerThread;
+        const size_t end = std::min(count, begin + MinPointsPerThread);
+        ProjectSoA(m, x + begin, y + begin, z + begin, end - begin, u + begin, v + begin, depth + begin);
+      }, 1u);
+    }
+
+    /// 把投影后的点写入 GetImageWidth() × GetImageHeight() 的深度图 @a image
+    /// （按行存放），每个像素保留最近的深度。@a image 中已有的值参与比较，
+    /// 通常先填充为 0，表示没有点。返回落在图像内的点数。
+    size_t RenderDepth(
+        const float *u,
+        const float *v,
+        const float *depth,
+        size_t count,
+        float *image) const {
+      size_t number_of_points = 0u;
+      const float width = static_cast<float>(_image_width);
+      const float height = static_cast<float>(_image_height);
+      for (size_t i = 0u; i < count; ++i) {
+        // 比较对 NaN 为 false，相机后方的点被跳过
+        if (!(depth[i] > 0.0f && u[i] >= 0.0f && u[i] < width && v[i] >= 0.0f && v[i] < height)) {
+          continue;
+        }
+        const size_t pixel =
+            static_cast<size_t>(v[i]) * _image_width + static_cast<size_t>(u[i]);
+        float &value = image[pixel];
+        if (value <= 0.0f || depth[i] < value) {
+          value = depth[i];
+        }
+        ++number_of_points;
+      }
+      return number_of_points;
+    }
+
+  private:
+
+    size_t NumberOfBlocks(size_t count) const {
+      return (count + MinPointsPerThread - 1u) / MinPointsPerThread;
+    }
+
+    /// 4×4 矩阵的乘积 a × b，只保留前三行。
+    static std::array<float, 12> Compose(
+        const std::array<float, 16> &a,
+        const std::array<float, 16> &b) {
+      std::array<float, 12> result;
+      for (size_t r = 0u; r < 3u; ++r) {
+        for (size_t c = 0u; c < 4u; ++c) {
+          result[4u * r + c] =
+              a[4u * r] * b[c] +
+              a[4u * r + 1u] * b[4u + c] +
+              a[4u * r + 2u] * b[8u + c] +
+              a[4u * r + 3u] * b[12u + c];
+        }
+      }
+      return result;
+    }
+
+    /// 相机空间中的点 (x, y, z) 投影为 (cu + f·y/x, cv - f·z/x)，深度为 x。
+    /// 循环没有分支，编译器可以把它向量化。
+    template <typename MatrixT>
+    void Project(
+        const MatrixT &m,
+        const float *__restrict points,
+        size_t stride,
+        size_t count,
+        float *__restrict u,
+        float *__restrict v,
+        float *__restrict depth) const {
+      const float f = _focal_length;
+      const float cu = 0.5f * _image_width;
+      const float cv = 0.5f * _image_height;
+      const float nan = std::numeric_limits<float>::quiet_NaN();
+      for (size_t i = 0u; i < count; ++i) {
+        const float px = points[stride * i];
+        const float py = points[stride * i + 1u];
+        const float pz = points[stride * i + 2u];
+        const float x = px * m[0] + py * m[1] + pz * m[2] + m[3];
+        const float y = px * m[4] + py * m[5] + pz * m[6] + m[7];
+        const float z = px * m[8] + py * m[9] + pz * m[10] + m[11];
+        const float scale = f / x;
+        u[i] = (x > 0.0f) ? (cu + y * scale) : nan;
+        v[i] = (x > 0.0f) ? (cv - z * scale) : nan;
+        depth[i] = x;
+      }
+    }
+
+    template <typename MatrixT>
+    void ProjectSoA(
+        const MatrixT &m,
+        const float *__restrict px,
+        const float *__restrict py,
+        const float *__restrict pz,
+        size_t count,
+        float *__restrict u,
+        float *__restrict v,
+        float *__restrict depth) const {
+      const float f = _focal_length;
+      const float cu = 0.5f * _image_width;
+      const float cv = 0.5f * _image_height;
+      const float nan = std::numeric_limits<float>::quiet_NaN();
+      for (size_t i = 0u; i < count; ++i) {
+        const float x = px[i] * m[0] + py[i] * m[1] + pz[i] * m[2] + m[3];
+        const float y = px[i] * m[4] + py[i] * m[5] + pz[i] * m[6] + m[7];
+        const float z = px[i] * m[8] + py[i] * m[9] + pz[i] * m[10] + m[11];
+        const float scale = f / x;
+        u[i] = (x > 0.0f) ? (cu + y * scale) : nan;
+        v[i] = (x > 0.0f) ? (cv - z * scale) : nan;
+        depth[i] = x;
+      }
+    }
+
+    std::array<float, 16> _world_to_camera;
+
+    uint32_t _image_width;
+
+    uint32_t _image_height;
+
+    float _focal_length;
+  };
+
+} // namespace geom
+} // namespace carla
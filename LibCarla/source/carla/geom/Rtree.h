@@ -45,9 +45,22 @@ namespace geom {
       _rtree.insert(element);
     } // 成员函数，将一个 TreeElement 插入 R-tree。
 
+    /// 批量插入多个 TreeElement 到 R-tree。树为空时与 Build 相同。
     void InsertElements(const std::vector<TreeElement> &elements) {
-      _rtree.insert(elements.begin(), elements.end());
-    } // 成员函数，批量插入多个 TreeElement 到 R-tree。
+      if (_rtree.empty()) {
+        Build(elements);
+      } else {
+        _rtree.insert(elements.begin(), elements.end());
+      }
+    }
+
+    /// 用 @a elements 替换树中的所有元素。元素一次性打包（bulk loading）：
+    /// 按坐标递归划分，每个节点装满相邻的元素，节点之间几乎不重叠。比逐个
+    /// 插入建树快得多，查询访问的节点也更少，适合建好以后不再修改的数据，
+    /// 例如地图的路点。
+    void Build(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
 
     /// 返回最近邻元素，可以应用用户定义的过滤器。
     ///  过滤器接收一个 TreeElement 值作为参数，并且需要
@@ -79,7 +92,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
@@ -102,9 +117,24 @@ namespace geom {
       _rtree.insert(element);
     }// 成员函数，将一个 TreeElement 插入 R-tree。
 
+    /// 批量插入多个 TreeElement 到 R-tree。树为空时与 Build 相同。
     void InsertElements(const std::vector<TreeElement> &elements) {
-      _rtree.insert(elements.begin(), elements.end());
-    }// 成员函数，批量插入多个 TreeElement 到 R-tree。
+      if (_rtree.empty()) {
+        Build(elements);
+      } else {
+        _rtree.insert(elements.begin(), elements.end());
+      }
+    }
+
+    /// 用 @a elements 替换树中的所有元素，一次性打包，见 PointCloudRtree::Build。
+    void Build(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
+    /// 返回树中的所有元素，顺序不确定。
+    std::vector<TreeElement> GetElements() const {
+      return std::vector<TreeElement>(_rtree.begin(), _rtree.end());
+    }
 
     /// 返回带有用户定义过滤器的最近邻元素。
     /// 过滤器接收一个 TreeElement 值作为参数，并且需要
@@ -150,7 +180,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
     // 私有成员变量，R-tree 数据结构实例。
   };
 
@@ -9,8 +9,280 @@
 #include "carla/geom/Simplification.h"
 #include "simplify/Simplify.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
 namespace carla {
 namespace geom {
+
+namespace {
+
+  /// 只包含位置和三角形的网格，索引从 0 开始。
+  struct IndexedMesh {
+    std::vector<Vector3D> vertices;
+    std::vector<size_t> indexes;
+  };
+
+  /// Mesh 的索引从 1 开始（OBJ 格式）。
+  IndexedMesh FromMesh(const Mesh &mesh) {
+    IndexedMesh result;
+    result.vertices = mesh.GetVertices();
+    const auto &indexes = mesh.GetIndexes();
+    result.indexes.reserve(indexes.size() - indexes.size() % 3u);
+    for (size_t i = 0u; i + 2u < indexes.size(); i += 3u) {
+      result.indexes.push_back(indexes[i] - 1u);
+      result.indexes.push_back(indexes[i + 1u] - 1u);
+      result.indexes.push_back(indexes[i + 2u] - 1u);
+    }
+    return result;
+  }
+
+  std::unique_ptr<Mesh> ToMesh(const IndexedMesh &mesh) {
+    auto result = std::make_unique<Mesh>();
+    result->GetVertices() = mesh.vertices;
+    result->GetIndexes().reserve(mesh.indexes.size());
+    for (size_t index : mesh.indexes) {
+      result->GetIndexes().push_back(index + 1u);
+    }
+    return result;
+  }
+
+  /// 合并位置量化到同一网格单元的顶点，并删除因此退化的三角形。
+  void WeldVertices(IndexedMesh &mesh, const float tolerance) {
+    struct CellHash {
+      size_t operator()(const std::tuple<int64_t, int64_t, int64_t> &cell) const {
+        const auto x = static_cast<uint64_t>(std::get<0>(cell));
+        const auto y = static_cast<uint64_t>(std::get<1>(cell));
+        const auto z = static_cast<uint64_t>(std::get<2>(cell));
+        return static_cast<size_t>((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+      }
+    };
+    const double inv_tolerance = 1.0 / std::max(static_cast<double>(tolerance), 1e-9);
+    std::unordered_map<std::tuple<int64_t, int64_t, int64_t>, size_t, CellHash> cells;
+    cells.reserve(mesh.vertices.size());
+    std::vector<size_t> remap(mesh.vertices.size());
+    std::vector<Vector3D> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (size_t i = 0u; i < mesh.vertices.size(); ++i) {
+      const auto &vertex = mesh.vertices[i];
+      const auto cell = std::make_tuple(
+          static_cast<int64_t>(std::llround(vertex.x * inv_tolerance)),
+          static_cast<int64_t>(std::llround(vertex.y * inv_tolerance)),
+          static_cast<int64_t>(std::llround(vertex.z * inv_tolerance)));
+      const auto inserted = cells.emplace(cell, vertices.size());
+      if (inserted.second) {
+        vertices.push_back(vertex);
+      }
+      remap[i] = inserted.first->second;
+    }
+    std::vector<size_t> indexes;
+    indexes.reserve(mesh.indexes.size());
+    for (size_t i = 0u; i < mesh.indexes.size(); i += 3u) {
+      const size_t a = remap[mesh.indexes[i]];
+      const size_t b = remap[mesh.indexes[i + 1u]];
+      const size_t c = remap[mesh.indexes[i + 2u]];
+      if (a != b && b != c && a != c) {
+        indexes.push_back(a);
+        indexes.push_back(b);
+        indexes.push_back(c);
+      }
+    }
+    mesh.vertices = std::move(vertices);
+    mesh.indexes = std::move(indexes);
+  }
+
+  /// 用二次误差度量把三角形数减少到 @a target_count。
+  void Decimate(IndexedMesh &mesh, const size_t target_count) {
+    Simplify::SimplificationObject simplification;
+    simplification.vertices.reserve(mesh.vertices.size());
+    for (const auto &vertex : mesh.vertices) {
+      Simplify::Vertex v;
+      v.p.x = vertex.x;
+      v.p.y = vertex.y;
+      v.p.z = vertex.z;
+      simplification.vertices.push_back(v);
+    }
+    simplification.triangles.reserve(mesh.indexes.size() / 3u);
+    for (size_t i = 0u; i < mesh.indexes.size(); i += 3u) {
+      Simplify::Triangle t;
+      t.material = 0;
+      t.v[0] = static_cast<int>(mesh.indexes[i]);
+      t.v[1] = static_cast<int>(mesh.indexes[i + 1u]);
+      t.v[2] = static_cast<int>(mesh.indexes[i + 2u]);
+      simplification.triangles.push_back(t);
+    }
+    simplification.simplify_mesh(static_cast<int>(target_count));
+
+    mesh.vertices.clear();
+    for (const auto &vertex : simplification.vertices) {
+      mesh.vertices.emplace_back(
+          static_cast<float>(vertex.p.x),
+          static_cast<float>(vertex.p.y),
+          static_cast<float>(vertex.p.z));
+    }
+    mesh.indexes.clear();
+    for (const auto &triangle : simplification.triangles) {
+      mesh.indexes.push_back(static_cast<size_t>(triangle.v[0]));
+      mesh.indexes.push_back(static_cast<size_t>(triangle.v[1]));
+      mesh.indexes.push_back(static_cast<size_t>(triangle.v[2]));
+    }
+  }
+
+  /// 按 Forsyth 的线性时间算法重新排列三角形，提高 GPU 顶点缓存的命中率，
+  /// 再按首次使用的顺序重新编号顶点。
+  void OptimizeVertexCache(IndexedMesh &mesh) {
+    constexpr size_t CACHE_SIZE = 32u;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+    constexpr size_t NOT_IN_CACHE = std::numeric_limits<size_t>::max();
+
+    const size_t number_of_vertices = mesh.vertices.size();
+    const size_t number_of_triangles = mesh.indexes.size() / 3u;
+    if (number_of_triangles == 0u) {
+      return;
+    }
+
+    // 每个顶点相邻的尚未输出的三角形
+    std::vector<size_t> remaining(number_of_vertices, 0u);
+    for (size_t index : mesh.indexes) {
+      ++remaining[index];
+    }
+    std::vector<size_t> offsets(number_of_vertices + 1u, 0u);
+    for (size_t v = 0u; v < number_of_vertices; ++v) {
+      offsets[v + 1u] = offsets[v] + remaining[v];
+    }
+    std::vector<size_t> adjacency(mesh.indexes.size());
+    {
+      std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+      for (size_t i = 0u; i < mesh.indexes.size(); ++i) {
+        adjacency[fill[mesh.indexes[i]]++] = i / 3u;
+      }
+    }
+
+    std::vector<size_t> cache_position(number_of_vertices, NOT_IN_CACHE);
+    std::vector<float> vertex_score(number_of_vertices, 0.0f);
+    const auto score = [&](const size_t v) {
+      if (remaining[v] == 0u) {
+        return -1.0f;
+      }
+      float result = 0.0f;
+      const size_t position = cache_position[v];
+      if (position != NOT_IN_CACHE) {
+        if (position < 3u) {
+          result = LAST_TRIANGLE_SCORE;
+        } else {
+          const float scaler = 1.0f / static_cast<float>(CACHE_SIZE - 3u);
+          result = std::pow(1.0f - static_cast<float>(position - 3u) * scaler, CACHE_DECAY_POWER);
+        }
+      }
+      return result + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining[v]), -VALENCE_BOOST_POWER);
+    };
+    for (size_t v = 0u; v < number_of_vertices; ++v) {
+      vertex_score[v] = score(v);
+    }
+    std::vector<float> triangle_score(number_of_triangles);
+    for (size_t t = 0u; t < number_of_triangles; ++t) {
+      triangle_score[t] =
+          vertex_score[mesh.indexes[3u * t]] +
+          vertex_score[mesh.indexes[3u * t + 1u]] +
+          vertex_score[mesh.indexes[3u * t + 2u]];
+    }
+
+    std::vector<bool> emitted(number_of_triangles, false);
+    std::vector<size_t> cache;
+    std::vector<size_t> new_cache;
+    std::vector<size_t> indexes;
+    indexes.reserve(mesh.indexes.size());
+    size_t next_unemitted = 0u;
+    size_t best_triangle = 0u;
+    for (size_t t = 1u; t < number_of_triangles; ++t) {
+      if (triangle_score[t] > triangle_score[best_triangle]) {
+        best_triangle = t;
+      }
+    }
+
+    for (size_t count = 0u; count < number_of_triangles; ++count) {
+      const size_t t = best_triangle;
+      emitted[t] = true;
+      new_cache.clear();
+      for (size_t k = 0u; k < 3u; ++k) {
+        const size_t v = mesh.indexes[3u * t + k];
+        indexes.push_back(v);
+        new_cache.push_back(v);
+        // 从顶点的相邻列表中移除这个三角形
+        auto begin = adjacency.begin() + static_cast<std::ptrdiff_t>(offsets[v]);
+        auto end = begin + static_cast<std::ptrdiff_t>(remaining[v]);
+        std::iter_swap(std::find(begin, end, t), end - 1);
+        --remaining[v];
+      }
+      for (size_t v : cache) {
+        if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end()) {
+          new_cache.push_back(v);
+        }
+      }
+      // 被挤出缓存的顶点
+      for (size_t i = std::min(new_cache.size(), CACHE_SIZE); i < new_cache.size(); ++i) {
+        cache_position[new_cache[i]] = NOT_IN_CACHE;
+        vertex_score[new_cache[i]] = score(new_cache[i]);
+      }
+      new_cache.resize(std::min(new_cache.size(), CACHE_SIZE));
+      std::swap(cache, new_cache);
+
+      // 更新缓存中顶点及其相邻三角形的分数，选出分数最高的三角形
+      for (size_t i = 0u; i < cache.size(); ++i) {
+        cache_position[cache[i]] = i;
+      }
+      for (size_t v : cache) {
+        vertex_score[v] = score(v);
+      }
+      float best_score = -1.0f;
+      for (size_t v : cache) {
+        for (size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+          const size_t adjacent = adjacency[a];
+          const float s =
+              vertex_score[mesh.indexes[3u * adjacent]] +
+              vertex_score[mesh.indexes[3u * adjacent + 1u]] +
+              vertex_score[mesh.indexes[3u * adjacent + 2u]];
+          triangle_score[adjacent] = s;
+          if (s > best_score) {
+            best_score = s;
+            best_triangle = adjacent;
+          }
+        }
+      }
+      // 缓存中的顶点没有剩余的三角形时，从尚未输出的三角形中按顺序选一个
+      if (best_score < 0.0f) {
+        while (next_unemitted < number_of_triangles && emitted[next_unemitted]) {
+          ++next_unemitted;
+        }
+        best_triangle = next_unemitted;
+      }
+    }
+
+    // 按首次使用的顺序重新编号顶点，未使用的顶点被删除
+    constexpr size_t UNUSED = std::numeric_limits<size_t>::max();
+    std::vector<size_t> remap(number_of_vertices, UNUSED);
+    std::vector<Vector3D> vertices;
+    vertices.reserve(number_of_vertices);
+    for (size_t &index : indexes) {
+      if (remap[index] == UNUSED) {
+        remap[index] = vertices.size();
+        vertices.push_back(mesh.vertices[index]);
+      }
+      index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+    mesh.indexes = std::move(indexes);
+  }
+
+} // namespace
+
 // 简化函数，对给定的网格进行简化
   void Simplification::Simplificate(const std::unique_ptr<geom::Mesh>& pmesh){
   	// 创建一个简化对象
@@ -24,10 +296,10 @@ namespace geom {
       Simplification.vertices.push_back(v);
     }
     // 将输入网格的索引转换为简化对象的三角形格式，并添加到简化对象中
-    for (size_t i = 0; i < pmesh->GetIndexes().size() - 2; i += 3) {
+    const auto &indices = pmesh->GetIndexes();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
       Simplify::Triangle t;
       t.material = 0;
-      auto indices = pmesh->GetIndexes();
       t.v[0] = (indices[i]) - 1;
       t.v[1] = (indices[i + 1]) - 1;
       t.v[2] = (indices[i + 2]) - 1;
@@ -57,5 +329,32 @@ namespace geom {
     }
   }
 
+  std::vector<std::unique_ptr<Mesh>> Simplification::GenerateLODs(
+      const Mesh &mesh,
+      const std::vector<float> &triangle_ratios,
+      const float weld_tolerance) {
+    std::vector<std::unique_ptr<Mesh>> lods;
+    lods.reserve(triangle_ratios.size() + 1u);
+
+    IndexedMesh current = FromMesh(mesh);
+    WeldVertices(current, weld_tolerance);
+    const size_t original_count = current.indexes.size() / 3u;
+    OptimizeVertexCache(current);
+    lods.emplace_back(ToMesh(current));
+
+    for (const float ratio : triangle_ratios) {
+      const auto target_count = static_cast<size_t>(
+          static_cast<float>(original_count) * std::min(std::max(ratio, 0.0f), 1.0f));
+      // 每一级从上一级继续简化，误差逐级累积但总耗时接近只简化一次
+      if (target_count < current.indexes.size() / 3u) {
+        Decimate(current, target_count);
+        WeldVertices(current, weld_tolerance);
+        OptimizeVertexCache(current);
+      }
+      lods.emplace_back(ToMesh(current));
+    }
+    return lods;
+  }
+
 } // namespace geom
 } // namespace carla
@@ -8,6 +8,9 @@
 
 #include "carla/geom/Mesh.h" // 包含Mesh类的定义
 
+#include <memory>
+#include <vector>
+
 namespace carla {
 namespace geom {
 
@@ -23,6 +26,19 @@ namespace geom {
     float simplification_percentage; // 存储简化率
 
     void Simplificate(const std::unique_ptr<geom::Mesh>& pmesh); // 声明简化函数
+
+    /// 为 @a mesh 生成细节层次（LOD）链。
+    ///
+    /// 第 0 级是原网格焊接重合顶点后的结果，第 i 级（i ≥ 1）用二次误差度量
+    /// 简化第 i - 1 级，保留原网格 @a triangle_ratios[i - 1] 比例的三角形，
+    /// 比例应递减。位置相差在 @a weld_tolerance 以内的顶点被合并，每一级的
+    /// 三角形按顶点缓存的命中率重新排序，顶点按首次使用的顺序排列。
+    ///
+    /// 与 Simplificate 一样，结果只包含顶点位置和索引。
+    static std::vector<std::unique_ptr<Mesh>> GenerateLODs(
+        const Mesh &mesh,
+        const std::vector<float> &triangle_ratios,
+        float weld_tolerance = 0.001f);
   };
 
 } // namespace geom
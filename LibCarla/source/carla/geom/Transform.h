@@ -13,6 +13,9 @@
 #include "carla/geom/Math.h"   // 引入数学工具库
 #include "carla/geom/Rotation.h"  // 引入Rotation类，表示旋转
 
+#include <array>
+#include <cstddef>
+
 #ifdef LIBCARLA_INCLUDED_FROM_UE4
 #include <compiler/enable-ue4-macros.h>// 用于处理UE4的宏定义
 #include "Math/Transform.h"    // 引入UE4的Transform类
@@ -100,6 +103,39 @@ namespace geom {
             in_point = out_point;
         }
 
+        /// 对 @a count 个点进行与 TransformPoint 相同的变换，坐标按数组分别存放，
+        /// 结果写回原数组。旋转矩阵只计算一次，循环没有分支，编译器可以把它向量化。
+        void TransformPoints(float *x, float *y, float *z, size_t count) const {
+            ApplyMatrix(GetMatrix(), x, y, z, count);
+        }
+
+        /// 对 @a count 个点进行与 InverseTransformPoint 相同的变换，格式与
+        /// TransformPoints 相同。
+        void InverseTransformPoints(float *x, float *y, float *z, size_t count) const {
+            ApplyMatrix(GetInverseMatrix(), x, y, z, count);
+        }
+
+        /// 用 GetMatrix 格式的 4×4 矩阵 @a m 变换 @a count 个点。数组互不重叠，
+        /// 参数用 __restrict 声明，编译器不需要在运行时检查别名。
+        static void ApplyMatrix(
+                const std::array<float, 16> &m,
+                float *__restrict x,
+                float *__restrict y,
+                float *__restrict z,
+                const size_t count) {
+            const float m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3];
+            const float m10 = m[4], m11 = m[5], m12 = m[6], m13 = m[7];
+            const float m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11];
+            for (size_t i = 0u; i < count; ++i) {
+                const float px = x[i];
+                const float py = y[i];
+                const float pz = z[i];
+                x[i] = px * m00 + py * m01 + pz * m02 + m03;
+                y[i] = px * m10 + py * m11 + pz * m12 + m13;
+                z[i] = px * m20 + py * m21 + pz * m22 + m23;
+            }
+        }
+
         /// 计算变换的 4 矩阵形式
         /// 通过当前的旋转角度（偏航、俯仰、翻滚）以及位置信息，按照特定的数学变换规则计算出一个 4x4 的变换矩阵，用于更通用的线性变换操作表示
         std::array<float, 16> GetMatrix() const {
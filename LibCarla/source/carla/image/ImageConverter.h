@@ -6,28 +6,214 @@
 
 #pragma once // 确保头文件只被包含一次
 
+#include "carla/ParallelFor.h" // 引入并行循环的头文件
 #include "carla/image/ImageView.h" // 引入ImageView头文件
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
 namespace carla { // carla命名空间
 namespace image { // image子命名空间
 
+namespace detail {
+
+  /// 每个通道 8 位的交错 RGBA 像素中各颜色通道的字节偏移，只为支持快速转换的
+  /// 像素类型定义。
+  template <typename PixelT>
+  struct Rgba8Layout;
+
+  template <>
+  struct Rgba8Layout<boost::gil::bgra8_pixel_t> {
+    static constexpr size_t red = 2u;
+    static constexpr size_t green = 1u;
+    static constexpr size_t blue = 0u;
+    static constexpr size_t alpha = 3u;
+  };
+
+  template <>
+  struct Rgba8Layout<boost::gil::rgba8_pixel_t> {
+    static constexpr size_t red = 0u;
+    static constexpr size_t green = 1u;
+    static constexpr size_t blue = 2u;
+    static constexpr size_t alpha = 3u;
+  };
+
+  template <typename PixelT>
+  struct IsRgba8Pixel
+    : std::integral_constant<bool,
+        std::is_same<PixelT, boost::gil::bgra8_pixel_t>::value ||
+        std::is_same<PixelT, boost::gil::rgba8_pixel_t>::value> {};
+
+  /// 像素在内存中按行连续存放的视图（如由 carla::Buffer 创建的视图），可以直接
+  /// 按字节处理每一行。
+  template <typename ViewT>
+  struct IsRawRgba8View
+    : std::integral_constant<bool,
+        IsRgba8Pixel<typename ViewT::value_type>::value &&
+        std::is_same<typename ViewT::x_iterator, typename ViewT::value_type *>::value> {};
+
+  /// 与 boost::gil 中 float 到 uint8_t 的通道转换相同。
+  inline uint8_t FloatToChannel(float value) {
+    return static_cast<uint8_t>(value * 255.0f + 0.5f);
+  }
+
+  /// 与 ColorConverter::Depth 相同，返回 [0, 1] 中的深度。
+  template <typename LayoutT>
+  inline float DecodeDepth(const uint8_t *pixel) {
+    const float depth =
+         pixel[LayoutT::red] +
+        (pixel[LayoutT::green] * 256) +
+        (pixel[LayoutT::blue]  * 256 * 256);
+    return depth / static_cast<float>(256 * 256 * 256 - 1);
+  }
+
+  template <typename LayoutT>
+  inline void WriteGray(uint8_t *pixel, uint8_t value) {
+    pixel[LayoutT::red] = value;
+    pixel[LayoutT::green] = value;
+    pixel[LayoutT::blue] = value;
+    pixel[LayoutT::alpha] = 255u;
+  }
+
+  /// 逐行转换的内核。循环体没有分支，编译器可以自动向量化；没有内核的颜色转换
+  /// 器使用 boost::gil 的通用实现。
+  template <typename LayoutT, typename ColorConverterT>
+  struct RowConverter {
+    static constexpr bool is_supported = false;
+  };
+
+  template <typename LayoutT>
+  struct RowConverter<LayoutT, ColorConverter::Depth> {
+    static constexpr bool is_supported = true;
+
+    explicit RowConverter(ColorConverter::Depth) {}
+
+    void operator()(uint8_t *row, size_t width) const {
+      for (size_t i = 0u; i < width; ++i) {
+        uint8_t *pixel = row + 4u * i;
+        WriteGray<LayoutT>(pixel, FloatToChannel(DecodeDepth<LayoutT>(pixel)));
+      }
+    }
+  };
+
+  template <typename LayoutT>
+  struct RowConverter<LayoutT, ColorConverter::LogarithmicDepth> {
+    static constexpr bool is_supported = true;
+
+    explicit RowConverter(ColorConverter::LogarithmicDepth) {}
+
+    void operator()(uint8_t *row, size_t width) const {
+      for (size_t i = 0u; i < width; ++i) {
+        uint8_t *pixel = row + 4u * i;
+        // 与 ColorConverter::LogarithmicLinear 相同
+        const float value = 1.0f + std::log(DecodeDepth<LayoutT>(pixel)) / 5.70378f;
+        const float clamped = std::max(std::min(value, 1.0f), 0.005f);
+        WriteGray<LayoutT>(pixel, FloatToChannel(clamped));
+      }
+    }
+  };
+
+  template <typename LayoutT>
+  struct RowConverter<LayoutT, ColorConverter::CityScapesPalette> {
+    static constexpr bool is_supported = true;
+
+    /// 每个可能的标签对应的输出像素。
+    std::array<std::array<uint8_t, 4u>, 256u> palette;
+
+    explicit RowConverter(ColorConverter::CityScapesPalette) {
+      for (size_t tag = 0u; tag < palette.size(); ++tag) {
+        const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        palette[tag][LayoutT::red] = color[0u];
+        palette[tag][LayoutT::green] = color[1u];
+        palette[tag][LayoutT::blue] = color[2u];
+        palette[tag][LayoutT::alpha] = 255u;
+      }
+    }
+
+    void operator()(uint8_t *row, size_t width) const {
+      for (size_t i = 0u; i < width; ++i) {
+        uint8_t *pixel = row + 4u * i;
+        const auto &color = palette[pixel[LayoutT::red]];
+        pixel[0u] = color[0u];
+        pixel[1u] = color[1u];
+        pixel[2u] = color[2u];
+        pixel[3u] = color[3u];
+      }
+    }
+  };
+
+  template <typename ViewT, typename ColorConverterT>
+  struct HasRowConverter
+    : std::integral_constant<bool,
+        RowConverter<Rgba8Layout<typename ViewT::value_type>, ColorConverterT>::is_supported> {};
+
+} // namespace detail
+
   class ImageConverter { // 定义ImageConverter类
   public:
 
+    /// 每个线程至少处理的像素数，小图像在调用线程中直接转换。
+    static constexpr size_t MinPixelsPerThread = 1u << 16u;
+
     template <typename SrcViewT, typename DstViewT> // 模板函数，接受源视图和目标视图类型
     static void CopyPixels(const SrcViewT &src, DstViewT &dst) { // 静态成员函数，复制像素
       boost::gil::copy_pixels(src, dst); // 使用Boost.GIL库复制像素
     }
 
+    /// 原地转换图像。对每个通道 8 位的 BGRA 或 RGBA 图像，Depth、
+    /// LogarithmicDepth 与 CityScapesPalette 按行分块用多个线程转换，结果与
+    /// boost::gil 的颜色转换视图完全相同。
     template <typename ColorConverter, typename MutableImageView> // 模板函数，接受颜色转换器和可变图像视图类型
     static void ConvertInPlace( // 静态成员函数，原地转换图像
         MutableImageView &image_view, // 可变图像视图引用
         ColorConverter converter = ColorConverter()) { // 默认颜色转换器
+      ConvertInPlace(image_view, converter, SupportsParallelConversion<MutableImageView, ColorConverter>{});
+    }
+
+  private:
+
+    template <typename ViewT, typename ColorConverterT>
+    using SupportsParallelConversion = std::integral_constant<bool,
+        detail::IsRawRgba8View<ViewT>::value &&
+        detail::HasRowConverter<ViewT, ColorConverterT>::value>;
+
+    template <typename ColorConverter, typename MutableImageView>
+    static void ConvertInPlace(
+        MutableImageView &image_view,
+        ColorConverter converter,
+        std::false_type) {
       using DstPixelT = typename MutableImageView::value_type; // 获取目标像素类型
       CopyPixels( // 调用CopyPixels函数
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter), // 创建颜色转换后的视图
           image_view); // 目标为原始图像视图
     }
+
+    template <typename ColorConverter, typename MutableImageView>
+    static void ConvertInPlace(
+        MutableImageView &image_view,
+        ColorConverter converter,
+        std::true_type) {
+      using LayoutT = detail::Rgba8Layout<typename MutableImageView::value_type>;
+      const detail::RowConverter<LayoutT, ColorConverter> convert_row{converter};
+      const auto width = static_cast<size_t>(image_view.width());
+      const auto height = static_cast<size_t>(image_view.height());
+      if ((width == 0u) || (height == 0u)) {
+        return;
+      }
+      const size_t rows_per_block = std::max<size_t>(1u, MinPixelsPerThread / width);
+      const size_t number_of_blocks = (height + rows_per_block - 1u) / rows_per_block;
+      ParallelFor(number_of_blocks, [&](const size_t block) {
+        const size_t end = std::min(height, (block + 1u) * rows_per_block);
+        for (size_t y = block * rows_per_block; y < end; ++y) {
+          auto *row = reinterpret_cast<uint8_t *>(&*image_view.row_begin(static_cast<std::ptrdiff_t>(y)));
+          convert_row(row, width);
+        }
+      }, 1u);
+    }
   };
 
 } // namespace image
@@ -6,11 +6,17 @@
 
 #pragma once  // 确保头文件只被包含一次
 
+#include "carla/Exception.h"  // 引入异常相关的头文件
 #include "carla/FileSystem.h"  // 引入文件系统相关的头文件
 #include "carla/Logging.h"     // 引入日志记录相关的头文件
+#include "carla/NpyIO.h"       // 引入 .npy 文件写入的头文件
 #include "carla/StringUtil.h"  // 引入字符串工具相关的头文件
 #include "carla/image/BoostGil.h"  // 引入Boost.GIL库的图像处理功能
 
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
 // 检测是否支持PNG格式
 #ifndef LIBCARLA_IMAGE_WITH_PNG_SUPPORT
 #  if defined(__has_include) && __has_include("png.h")  // 检查是否能找到png.h头文件
@@ -202,6 +208,60 @@ struct io_tiff { // 定义一个io_tiff结构体
 #endif // LIBCARLA_IMAGE_WITH_TIFF_SUPPORT // 结束TIFF支持的条件编译
 };
 
+  /// 不压缩的 NumPy 数组，形状为 (height, width, channels)，通道按像素在内存
+  /// 中的顺序存放（如 BGRA）。不需要任何库，写入比 PNG 快得多。
+  struct io_npy {
+
+    static constexpr bool is_supported = true;
+
+    static constexpr const char *get_default_extension() {
+      return "npy";
+    }
+
+    template <typename Str>
+    static bool match_extension(const Str &str) {
+      return StringUtil::EndsWith(str, get_default_extension());
+    }
+
+    template <typename Str, typename ImageT>
+    static void read_image(Str &&, ImageT &) {
+      throw_exception(std::invalid_argument("reading .npy images is not supported"));
+    }
+
+    template <typename Str, typename ViewT>
+    static void write_view(Str &&out_filename, const ViewT &view) {
+      using pixel_type = typename ViewT::value_type;
+      using channel_type = typename boost::gil::channel_type<ViewT>::type;
+      using base_type = typename std::conditional<
+          std::is_same<channel_type, boost::gil::float32_t>::value,
+          float,
+          channel_type>::type;
+      static_assert(sizeof(base_type) == sizeof(channel_type), "Invalid channel type.");
+      constexpr size_t channels = boost::gil::num_channels<ViewT>::value;
+      const auto width = static_cast<size_t>(view.width());
+      const auto height = static_cast<size_t>(view.height());
+      std::vector<size_t> shape = {height, width};
+      if (channels > 1u) {
+        shape.push_back(channels);
+      }
+      std::ofstream out(out_filename, std::ios::binary);
+      NpyIO::WriteHeader(out, NpyIO::GetTypeDescription<base_type>(), shape);
+      std::vector<base_type> row(width * channels);
+      for (size_t y = 0u; y < height; ++y) {
+        auto it = view.row_begin(static_cast<std::ptrdiff_t>(y));
+        for (size_t x = 0u; x < width; ++x) {
+          const pixel_type pixel = it[static_cast<std::ptrdiff_t>(x)];
+          for (size_t c = 0u; c < channels; ++c) {
+            row[x * channels + c] = static_cast<base_type>(pixel[c]);
+          }
+        }
+        out.write(
+            reinterpret_cast<const char *>(row.data()),
+            static_cast<std::streamsize>(row.size() * sizeof(base_type)));
+      }
+    }
+  };
+
 struct io_resolver { // 定义一个io_resolver结构体
 
     template <typename IO, typename Str> // 模板函数，接受IO类型和字符串类型
@@ -320,17 +380,19 @@ struct jpeg : detail::io_impl<detail::io_jpeg> {}; // 定义jpeg结构体，继
 
 struct tiff : detail::io_impl<detail::io_tiff> {}; // 定义tiff结构体，继承自io_impl
 
+struct npy : detail::io_impl<detail::io_npy> {};
+
 #if LIBCARLA_IMAGE_WITH_PNG_SUPPORT // 如果支持PNG格式
 
-struct any : detail::io_any<detail::io_png, detail::io_tiff, detail::io_jpeg> {}; // 定义any结构体，支持PNG、TIFF和JPEG
+struct any : detail::io_any<detail::io_png, detail::io_tiff, detail::io_jpeg, detail::io_npy> {}; // 定义any结构体，支持PNG、TIFF和JPEG
 
 #elif LIBCARLA_IMAGE_WITH_TIFF_SUPPORT // 如果不支持PNG但支持TIFF
 
-struct any : detail::io_any<detail::io_tiff, detail::io_jpeg> {}; // 定义any结构体，支持TIFF和JPEG
+struct any : detail::io_any<detail::io_tiff, detail::io_jpeg, detail::io_npy> {}; // 定义any结构体，支持TIFF和JPEG
 
 #else // 如果以上都不支持
 
-struct any : detail::io_any<detail::io_jpeg> {}; // 定义any结构体，仅支持JPEG
+struct any : detail::io_any<detail::io_jpeg, detail::io_npy> {}; // 定义any结构体，仅支持JPEG
 
 #endif
 
@@ -18,7 +18,8 @@ enum MultiGPUCommand : uint32_t {
   ENABLE_ROS,  // 启用ROS（Robot Operating System）集成，ROS是一个用于机器人开发的灵活框架
   DISABLE_ROS, // 禁用ROS集成
   IS_ENABLED_ROS, // 查询ROS集成是否启用
-  YOU_ALIVE // 一种心跳或存活检查命令，用于确认接收方是否在线或响应
+  YOU_ALIVE, // 一种心跳或存活检查命令，用于确认接收方是否在线或响应
+  GET_FRAME_TIME // 查询辅助服务器最近一帧的 GPU 时间（毫秒，double），用于放置传感器
 };
 // 定义一个结构体CommandHeader，用于表示命令的头部信息  
 // 头部信息通常包括命令的标识符和后续数据的大小
@@ -27,5 +28,16 @@ struct CommandHeader {
   uint32_t size; // 跟随此头部之后的数据的大小（以字节为单位
 };
 
+// 辅助服务器渲染完一帧后主动发送的确认，用于主服务器的流水线同步
+// 辅助服务器的回应没有头部，确认是唯一以这个标记开头的 16 字节回应（令牌是 24 字节）
+struct FrameAck {
+  static constexpr uint64_t TAG = 0x4b4341454d415246u; // "FRAMEACK"
+
+  uint64_t tag = TAG;
+  uint64_t frame = 0u; // 渲染完的帧，即帧数据中主服务器的帧计数
+};
+
+static_assert(sizeof(FrameAck) == 16u, "FrameAck must be 16 bytes");
+
 }  // namespace multigpu 结束multigpu命名空间的定义
 } // namespace carla 结束carla命名空间的定义
@@ -0,0 +1,222 @@
+﻿// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/multigpu/placementScheduler.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace multigpu {
+
+  // 新的帧时间报告在平滑值中占的比例
+  static constexpr double PlacementScheduler_ReportWeight = 0.5;
+
+  // 迁移至少要让较慢的服务器快这么多（比例），以免来回迁移
+  static constexpr double PlacementScheduler_MinImprovement = 0.1;
+
+  static bool PlacementScheduler_StartsWith(const std::string &str, const char *prefix) {
+    return str.compare(0u, std::char_traits<char>::length(prefix), prefix) == 0;
+  }
+
+  double PlacementScheduler::GetSensorWeight(
+      const std::string &type_id,
+      const uint32_t width,
+      const uint32_t height) {
+    if (PlacementScheduler_StartsWith(type_id, "sensor.camera.")) {
+      const double pixels = static_cast<double>(width) * static_cast<double>(height);
+      const double size = std::max(pixels, 1.0) / (1920.0 * 1080.0);
+      // 深度、语义分割等相机不做后处理，大约是 RGB 相机的一半
+      const bool full =
+          (type_id == "sensor.camera.rgb") ||
+          (type_id == "sensor.camera.dvs") ||
+          (type_id == "sensor.camera.optical_flow");
+      return size * (full ? 1.0 : 0.5);
+    }
+    if (PlacementScheduler_StartsWith(type_id, "sensor.lidar.") ||
+        (type_id == "sensor.other.radar")) {
+      return 0.25;
+    }
+    // GNSS、IMU 等几乎没有渲染开销
+    return 0.01;
+  }
+
+  void PlacementScheduler::AddServer(server_key server) {
+    if (FindServer(server) == nullptr) {
+      Server item;
+      item.key = server;
+      _servers.emplace_back(item);
+    }
+  }
+
+  void PlacementScheduler::RemoveServer(server_key server) {
+    _servers.erase(
+        std::remove_if(_servers.begin(), _servers.end(), [=](const Server &item) {
+          return item.key == server;
+        }),
+        _servers.end());
+    for (auto it = _placements.begin(); it != _placements.end();) {
+      if (it->second.server == server) {
+        it = _placements.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void PlacementScheduler::Clear() {
+    _servers.clear();
+    _placements.clear();
+    _imbalanced_reports = 0u;
+  }
+
+  PlacementScheduler::server_key PlacementScheduler::Place(stream_id sensor, double weight) {
+    auto placed = _placements.find(sensor);
+    if (placed != _placements.end()) {
+      return placed->second.server;
+    }
+    Server *best = nullptr;
+    double best_time = 0.0;
+    for (auto &server : _servers) {
+      const double time = GetFrameTime(server, server.weight + weight);
+      if ((best == nullptr) || (time < best_time)) {
+        best = &server;
+        best_time = time;
+      }
+    }
+    if (best == nullptr) {
+      return nullptr;
+    }
+    best->weight += weight;
+    _placements[sensor] = Placement{best->key, weight};
+    return best->key;
+  }
+
+  PlacementScheduler::server_key PlacementScheduler::GetServer(stream_id sensor) const {
+    auto placed = _placements.find(sensor);
+    return (placed != _placements.end()) ? placed->second.server : nullptr;
+  }
+
+  void PlacementScheduler::Remove(stream_id sensor) {
+    auto placed = _placements.find(sensor);
+    if (placed != _placements.end()) {
+      Server *server = FindServer(placed->second.server);
+      if (server != nullptr) {
+        server->weight = std::max(server->weight - placed->second.weight, 0.0);
+      }
+      _placements.erase(placed);
+    }
+  }
+
+  void PlacementScheduler::ReportFrameTime(server_key server, double milliseconds) {
+    Server *item = FindServer(server);
+    if ((item == nullptr) || !(milliseconds >= 0.0)) {
+      return;
+    }
+    const double cost = milliseconds / (item->weight + 1.0);
+    item->cost = item->has_report ?
+        (PlacementScheduler_ReportWeight * cost + (1.0 - PlacementScheduler_ReportWeight) * item->cost) :
+        cost;
+    item->has_report = true;
+  }
+
+  double PlacementScheduler::GetFrameTime(server_key server) const {
+    const Server *item = FindServer(server);
+    return (item != nullptr) ? GetFrameTime(*item, item->weight) : 0.0;
+  }
+
+  std::vector<PlacementScheduler::Migration> PlacementScheduler::Balance() {
+    std::vector<Migration> result;
+    if (_servers.size() < 2u) {
+      return result;
+    }
+
+    // 最慢和最快的服务器
+    Server *slowest = &_servers.front();
+    Server *fastest = &_servers.front();
+    for (auto &server : _servers) {
+      if (GetFrameTime(server, server.weight) > GetFrameTime(*slowest, slowest->weight)) {
+        slowest = &server;
+      }
+      if (GetFrameTime(server, server.weight) < GetFrameTime(*fastest, fastest->weight)) {
+        fastest = &server;
+      }
+    }
+    const double slowest_time = GetFrameTime(*slowest, slowest->weight);
+    const double fastest_time = GetFrameTime(*fastest, fastest->weight);
+    if (!(fastest_time > 0.0) || (slowest_time <= _threshold * fastest_time)) {
+      _imbalanced_reports = 0u;
+      return result;
+    }
+    if (++_imbalanced_reports < _reports_needed) {
+      return result;
+    }
+
+    // 选出迁移后两台服务器中较慢那台的帧时间最短的传感器
+    stream_id best_sensor = 0u;
+    const double max_time = (1.0 - PlacementScheduler_MinImprovement) * slowest_time;
+    double best_time = max_time;
+    for (const auto &placement : _placements) {
+      if (placement.second.server != slowest->key) {
+        continue;
+      }
+      const double weight = placement.second.weight;
+      const double time = std::max(
+          GetFrameTime(*slowest, slowest->weight - weight),
+          GetFrameTime(*fastest, fastest->weight + weight));
+      if (time < best_time) {
+        best_sensor = placement.first;
+        best_time = time;
+      }
+    }
+    if (best_time >= max_time) {
+      // 没有传感器能改善，比如只有一个很重的传感器
+      return result;
+    }
+
+    auto &placement = _placements[best_sensor];
+    slowest->weight = std::max(slowest->weight - placement.weight, 0.0);
+    fastest->weight += placement.weight;
+    placement.server = fastest->key;
+    _imbalanced_reports = 0u;
+    result.emplace_back(Migration{best_sensor, slowest->key, fastest->key});
+    return result;
+  }
+
+  PlacementScheduler::Server *PlacementScheduler::FindServer(server_key server) {
+    for (auto &item : _servers) {
+      if (item.key == server) {
+        return &item;
+      }
+    }
+    return nullptr;
+  }
+
+  const PlacementScheduler::Server *PlacementScheduler::FindServer(server_key server) const {
+    for (const auto &item : _servers) {
+      if (item.key == server) {
+        return &item;
+      }
+    }
+    return nullptr;
+  }
+
+  double PlacementScheduler::GetCost(const Server &server) const {
+    if (server.has_report) {
+      return server.cost;
+    }
+    double total = 0.0;
+    uint32_t count = 0u;
+    for (const auto &item : _servers) {
+      if (item.has_report) {
+        total += item.cost;
+        ++count;
+      }
+    }
+    return (count > 0u) ? (total / count) : 1.0;
+  }
+
+} // namespace multigpu
+} // namespace carla
@@ -0,0 +1,118 @@
+﻿// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace multigpu {
+
+  /// 决定传感器放在哪台辅助服务器上渲染。
+  ///
+  /// 每个传感器按类型和分辨率有一个权重（1 相当于一个 1920x1080 的 RGB 相机），
+  /// 每台服务器渲染一帧的时间由它报告的 GPU 帧时间估计：每单位权重的耗时乘以
+  /// 服务器上的总权重（场景本身算一个单位）。新的传感器放在放置后帧时间最短的
+  /// 服务器上；最慢和最快的服务器相差超过阈值、并且连续几次报告都如此时，
+  /// 把一个传感器从最慢的服务器迁到最快的服务器。
+  ///
+  /// 不是线程安全的，由 Router 加锁调用。
+  class PlacementScheduler {
+  public:
+
+    using stream_id = carla::streaming::detail::stream_id_type;
+
+    /// 服务器的标识，只用来比较，不会解引用。
+    using server_key = const void *;
+
+    struct Migration {
+      stream_id sensor;
+      server_key from;
+      server_key to;
+    };
+
+    /// 按类型和分辨率估计传感器的渲染开销。
+    static double GetSensorWeight(const std::string &type_id, uint32_t width, uint32_t height);
+
+    /// 最慢的服务器的帧时间超过最快的 @a ratio 倍，并且连续 @a reports 次报告
+    /// 都如此时才迁移。
+    void SetImbalanceThreshold(double ratio, uint32_t reports) {
+      _threshold = ratio;
+      _reports_needed = reports;
+    }
+
+    void AddServer(server_key server);
+
+    /// 同时忘记放在这台服务器上的传感器。
+    void RemoveServer(server_key server);
+
+    void Clear();
+
+    /// 选出放置后帧时间最短的服务器并记录下来，没有服务器时返回 nullptr。
+    /// 已经放置的传感器返回原来的服务器。
+    server_key Place(stream_id sensor, double weight);
+
+    /// 传感器所在的服务器，没有放置时返回 nullptr。
+    server_key GetServer(stream_id sensor) const;
+
+    void Remove(stream_id sensor);
+
+    /// 记录服务器报告的 GPU 帧时间（毫秒）。
+    void ReportFrameTime(server_key server, double milliseconds);
+
+    /// 估计的服务器帧时间（毫秒）。
+    double GetFrameTime(server_key server) const;
+
+    /// 每轮报告之后调用，返回需要进行的迁移（最多一个，迁移已经记录）。
+    std::vector<Migration> Balance();
+
+  private:
+
+    struct Server {
+      server_key key = nullptr;
+      /// 上面所有传感器的权重之和。
+      double weight = 0.0;
+      /// 每单位权重的帧时间（毫秒），指数平滑。
+      double cost = 0.0;
+      bool has_report = false;
+    };
+
+    struct Placement {
+      server_key server;
+      double weight;
+    };
+
+    Server *FindServer(server_key server);
+
+    const Server *FindServer(server_key server) const;
+
+    /// 没有报告的服务器用其它服务器的平均值。
+    double GetCost(const Server &server) const;
+
+    double GetFrameTime(const Server &server, double weight) const {
+      return GetCost(server) * (weight + 1.0);
+    }
+
+    /// 按连接的顺序，帧时间相同时放在先连接的服务器上。
+    std::vector<Server> _servers;
+
+    std::unordered_map<stream_id, Placement> _placements;
+
+    double _threshold = 1.5;
+
+    uint32_t _reports_needed = 3u;
+
+    uint32_t _imbalanced_reports = 0u;
+  };
+
+} // namespace multigpu
+} // namespace carla
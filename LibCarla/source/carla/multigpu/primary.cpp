@@ -12,6 +12,7 @@
 #include "carla/Logging.h"///< 包含CARLA的日志记录功能，可能定义了日志记录器、日志级别和日志消息格式等。
 #include "carla/multigpu/incomingMessage.h"///< 包含CARLA多GPU支持中接收消息的相关类和函数。
 #include "carla/multigpu/listener.h"///< 包含CARLA多GPU支持中监听网络通信的相关类和函数。
+#include "carla/multigpu/socketOptions.h"///< 包含主服务器和辅助服务器连接的套接字选项。
 /// @brief 包含Boost.Asio库的头文件，用于网络编程和异步I/O操作。 
 #include <boost/asio/read.hpp>///< Boost.Asio库中的读操作函数，用于从网络套接字读取数据。
 #include <boost/asio/write.hpp> ///< Boost.Asio库中的写操作函数，用于向网络套接字写入数据。 
@@ -81,9 +82,14 @@ namespace multigpu {
       Listener::callback_function_type_response on_response) {
     DEBUG_ASSERT(on_opened && on_closed);// 确保回调函数不为空。 
 
-    // 这强制不使用 Nagle 算法。将 Linux 上的同步模式速度提高了约 3 倍。
-    const boost::asio::ip::tcp::no_delay option(true);
-    _socket.set_option(option);
+    // 不使用 Nagle 算法，并使用更大的缓冲区
+    SetSocketOptions(_socket);
+
+    boost::system::error_code ec;
+    const auto remote = _socket.remote_endpoint(ec);
+    if (!ec) {
+      _remote_address = remote.address();
+    }
 
     // 保存回调函数的引用。
     _on_closed = std::move(on_closed);
@@ -76,6 +76,11 @@ namespace multigpu {
     /// 发布工作以关闭会话。
     void Close();  // 关闭会话
 
+    /// 辅助服务器的地址，在会话打开时记录。
+    boost::asio::ip::address GetRemoteAddress() const {
+      return _remote_address;
+    }
+
   private:
 
     // 开启计时器
@@ -105,6 +110,8 @@ namespace multigpu {
     std::shared_ptr<BufferPool> _buffer_pool;  // 缓冲池的共享指针
 
     bool _is_writing = false;  // 写入状态标志
+
+    boost::asio::ip::address _remote_address;  // 辅助服务器的地址
   };
 
 } // namespace multigpu
@@ -37,11 +37,17 @@ void PrimaryCommands::set_router(std::shared_ptr<Router> router) {
 // 向所有辅助服务器广播帧数据的函数
 // 参数buffer: 包含帧数据的carla::Buffer类型对象，会将此数据通过路由器发送给所有辅助服务器
 // 实现方式是调用_router的Write方法，传递对应的命令类型（MultiGPUCommand::SEND_FRAME）和要发送的数据（移动语义传递buffer）
-void PrimaryCommands::SendFrameData(carla::Buffer buffer) {
+void PrimaryCommands::SendFrameData(carla::Buffer buffer, uint64_t frame) {
+  // 先记录帧，这时连接的服务器不会被要求确认它
+  _router->SetLastFrame(frame);
   _router->Write(MultiGPUCommand::SEND_FRAME, std::move(buffer));
   // log_info("sending frame command");  // 此处原代码有日志输出，可能用于调试等记录发送帧命令的操作，当前被注释掉了
 }
 
+bool PrimaryCommands::WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout) {
+  return _router->WaitForFrame(frame, timeout);
+}
+
 // 向所有辅助服务器广播要加载的地图的函数
 // 参数map: 表示地图名称的字符串，先将其转换为carla::Buffer类型，再通过路由器发送给所有辅助服务器
 // 转换为Buffer时，会包含字符串内容以及结尾的'\0'字符（通过 + 1 来保证包含结尾字符），然后调用_router的Write方法发送，命令类型为MultiGPUCommand::LOAD_MAP
@@ -54,14 +60,23 @@ void PrimaryCommands::SendLoadMap(std::string map) {
 // 参数sensor_id: 传感器的ID，用于标识请求令牌对应的传感器
 // 函数先记录请求令牌的日志信息（log_info），然后将sensor_id放入carla::Buffer中，通过路由器的WriteToNext方法异步发送请求（命令类型为MultiGPUCommand::GET_TOKEN）
 // 接着等待异步操作完成（fut.get()）获取响应，从响应中解析出新的令牌（token_type），并记录获取到的令牌信息，最后返回该令牌
-token_type PrimaryCommands::SendGetToken(stream_id sensor_id) {
+token_type PrimaryCommands::SendGetToken(std::weak_ptr<Primary> server, stream_id sensor_id) {
   log_info("asking for a token");
   carla::Buffer buf((carla::Buffer::value_type *) &sensor_id,
                     (size_t) sizeof(stream_id));
-  auto fut = _router->WriteToNext(MultiGPUCommand::GET_TOKEN, std::move(buf));
+  auto fut = _router->WriteToOne(server, MultiGPUCommand::GET_TOKEN, std::move(buf));
 
   auto response = fut.get();
   token_type new_token(*reinterpret_cast<carla::streaming::detail::token_data *>(response.buffer.data()));
+  // 辅助服务器的令牌没有地址，客户端会连接到主服务器的主机。填上辅助服务器的地址，
+  // 客户端直接从辅助服务器接收传感器数据，主服务器只负责转交令牌。
+  // 同一台主机上的辅助服务器（回环地址）保持原样，客户端使用主服务器的地址即可。
+  if (!new_token.has_address() && (response.session != nullptr)) {
+    const auto address = response.session->GetRemoteAddress();
+    if (!address.is_unspecified() && !address.is_loopback()) {
+      new_token.set_address(address);
+    }
+  }
   log_info("got a token: ", new_token.get_stream_id(), ", ", new_token.get_port());
   return new_token;
 }
@@ -144,7 +159,7 @@ bool PrimaryCommands::SendIsEnabledForROS(stream_id sensor_id) {
 //   - 通过路由器获取下一个可用的服务器（_router->GetNextServer()）
 //   - 调用SendGetToken函数向该服务器请求获取令牌
 //   - 将获取到的令牌添加到令牌列表（_tokens）和服务器列表（_servers）中，记录日志信息表明使用新激活传感器的令牌，最后返回该令牌
-token_type PrimaryCommands::GetToken(stream_id sensor_id) {
+token_type PrimaryCommands::GetToken(stream_id sensor_id, double weight) {
   // 搜索传感器是否已在任何辅助服务器中激活
   auto it = _tokens.find(sensor_id);
   if (it!= _tokens.end()) {
@@ -153,9 +168,9 @@ token_type PrimaryCommands::GetToken(stream_id sensor_id) {
     return it->second;
   }
   else {
-    // 在一台辅助服务器上启用传感器
-    auto server = _router->GetNextServer();
-    auto token = SendGetToken(sensor_id);
+    // 在调度器选出的辅助服务器上启用传感器
+    auto server = _router->GetServerFor(sensor_id, weight);
+    auto token = SendGetToken(server, sensor_id);
     // add to the maps
     _tokens[sensor_id] = token;
     _servers[sensor_id] = server;
@@ -164,6 +179,52 @@ token_type PrimaryCommands::GetToken(stream_id sensor_id) {
   }
 }
 
+// 查询一台辅助服务器的 GPU 帧时间（毫秒）
+// 旧版本的辅助服务器不回答这个命令，所以只等待一段时间
+bool PrimaryCommands::SendGetFrameTime(std::weak_ptr<Primary> server, double &milliseconds) {
+  carla::Buffer buf;
+  auto fut = _router->WriteToOne(server, MultiGPUCommand::GET_FRAME_TIME, std::move(buf));
+  if (fut.wait_for(std::chrono::seconds(1)) != std::future_status::ready) {
+    log_warning("no frame time from a secondary server");
+    return false;
+  }
+  auto response = fut.get();
+  if (response.buffer.size() != sizeof(double)) {
+    return false;
+  }
+  milliseconds = *reinterpret_cast<double *>(response.buffer.data());
+  return true;
+}
+
+// 更新传感器的放置
+// 先收集所有辅助服务器的帧时间，然后由调度器决定是否迁移传感器：
+//   - 在新服务器上获取令牌，之后的订阅连接到新服务器（已经订阅的客户端继续使用原来的服务器）
+//   - 如果传感器启用了ROS，则在原服务器上禁用，在新服务器上启用
+void PrimaryCommands::UpdatePlacement() {
+  for (auto &server : _router->GetServers()) {
+    double milliseconds = 0.0;
+    if (SendGetFrameTime(server, milliseconds)) {
+      _router->ReportFrameTime(server, milliseconds);
+    }
+  }
+  for (auto &migration : _router->BalancePlacement()) {
+    const stream_id sensor_id = migration.first;
+    if (migration.second.expired() || (_servers.find(sensor_id) == _servers.end())) {
+      continue;
+    }
+    const bool ros = SendIsEnabledForROS(sensor_id);
+    if (ros) {
+      SendDisableForROS(sensor_id);
+    }
+    _tokens[sensor_id] = SendGetToken(migration.second, sensor_id);
+    _servers[sensor_id] = migration.second;
+    if (ros) {
+      SendEnableForROS(sensor_id);
+    }
+    log_info("sensor ", sensor_id, " moved to another secondary server");
+  }
+}
+
 // 启用特定传感器的ROS相关功能的函数
 // 参数sensor_id: 传感器的ID，首先在服务器列表（_servers）中查找该传感器是否已在某个辅助服务器中激活，如果找到：
 //   - 直接调用SendEnableForROS函数发送启用命令
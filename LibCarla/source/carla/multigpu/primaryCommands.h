@@ -13,6 +13,8 @@
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
 
+#include <chrono>
+
 namespace carla {
 namespace multigpu {
 
@@ -32,8 +34,11 @@ class PrimaryCommands {
 
     void set_router(std::shared_ptr<Router> router);
 
-    // 向所有辅助服务器广播帧数据
-    void SendFrameData(carla::Buffer buffer);
+    // 向所有辅助服务器广播帧数据，frame 是数据中主服务器的帧计数
+    void SendFrameData(carla::Buffer buffer, uint64_t frame = 0u);
+
+    // 等待所有辅助服务器渲染完 frame（收到它们的 FrameAck），超时返回 false
+    bool WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout);
 
     // 向所有辅助服务器广播要加载的地图
     void SendLoadMap(std::string map);
@@ -41,7 +46,13 @@ class PrimaryCommands {
     // 发送以了解连接是否处于活动状态
     void SendIsAlive();
 
-    token_type GetToken(stream_id sensor_id);
+    // 在调度器选出的辅助服务器上启用传感器并返回令牌，weight 是传感器的渲染开销
+    // （见 PlacementScheduler::GetSensorWeight）
+    token_type GetToken(stream_id sensor_id, double weight = 1.0);
+
+    // 查询所有辅助服务器的 GPU 帧时间，不平衡持续时把传感器迁移到较快的服务器，
+    // 之后的订阅使用新服务器的令牌
+    void UpdatePlacement();
 
     void EnableForROS(stream_id sensor_id);
 
@@ -52,7 +63,10 @@ class PrimaryCommands {
   private:
 
     // 发送到一个辅助节点以获取传感器的令牌
-    token_type SendGetToken(carla::streaming::detail::stream_id_type sensor_id);
+    token_type SendGetToken(std::weak_ptr<Primary> server, carla::streaming::detail::stream_id_type sensor_id);
+
+    // 查询一台辅助服务器的 GPU 帧时间，超时或没有回答时返回 false
+    bool SendGetFrameTime(std::weak_ptr<Primary> server, double &milliseconds);
 
     // 管理 ROS 传感器的启用/禁用
     void SendEnableForROS(stream_id sensor_id);
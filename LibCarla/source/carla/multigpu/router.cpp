@@ -8,6 +8,9 @@
 #include "carla/multigpu/listener.h"
 #include "carla/streaming/EndPoint.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace carla {
 namespace multigpu {
 
@@ -76,6 +79,17 @@ void Router::SetCallbacks() {
       auto self = weak.lock();
       if (!self) return;
       std::lock_guard<std::mutex> lock(self->_mutex);
+      // 帧确认不是对命令的回应
+      if (buffer.size() == sizeof(FrameAck)) {
+        FrameAck ack;
+        std::memcpy(&ack, buffer.data(), sizeof(FrameAck));
+        if (ack.tag == FrameAck::TAG) {
+          auto &acked = self->_acks[session.get()];
+          acked = std::max(acked, ack.frame);
+          self->_ack_condition.notify_all();
+          return;
+        }
+      }
       auto prom =self-> _promises.find(session.get());
       if (prom!= self->_promises.end()) {
         log_info("Got data from secondary (with promise): ", buffer.size());
@@ -101,8 +115,9 @@ void Router::SetNewConnectionCallback(std::function<void(void)> func)
 
 // 异步运行路由器（Router）相关操作的函数，启动线程池以异步处理相关任务
 // 参数worker_threads: 指定线程池中的工作线程数量，用于控制并发处理能力
-void Router::AsyncRun(size_t worker_threads) {
-  _pool.AsyncRun(worker_threads);
+// 参数settings: 工作线程的CPU亲和性和优先级
+void Router::AsyncRun(size_t worker_threads, const ThreadSettings &settings) {
+  _pool.AsyncRun(worker_threads, settings);
 }
 
 // 获取路由器（Router）本地监听端点信息的函数，返回其监听的TCP端点对象（包含IP地址和端口等信息）
@@ -118,6 +133,8 @@ boost::asio::ip::tcp::endpoint Router::GetLocalEndpoint() const {
 void Router::ConnectSession(std::shared_ptr<Primary> session) {
   DEBUG_ASSERT(session!= nullptr);
   std::lock_guard<std::mutex> lock(_mutex);
+  _scheduler.AddServer(session.get());
+  _acks[session.get()] = _last_frame;
   _sessions.emplace_back(std::move(session));
   log_info("Connected secondary servers:", _sessions.size());
   // 对新连接运行外部回调
@@ -134,9 +151,12 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
   DEBUG_ASSERT(session!= nullptr);
   std::lock_guard<std::mutex> lock(_mutex);
   if (_sessions.size() == 0) return;
+  _scheduler.RemoveServer(session.get());
+  _acks.erase(session.get());
   _sessions.erase(
       std::remove(_sessions.begin(), _sessions.end(), session),
       _sessions.end());
+  _ack_condition.notify_all();
   log_info("Connected secondary servers:", _sessions.size());
 }
 
@@ -145,6 +165,9 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
 void Router::ClearSessions() {
   std::lock_guard<std::mutex> lock(_mutex);
   _sessions.clear();
+  _scheduler.Clear();
+  _acks.clear();
+  _ack_condition.notify_all();
   log_info("Disconnecting all secondary servers");
 }
 
@@ -273,5 +296,61 @@ std::weak_ptr<Primary> Router::GetNextServer() {
   }
 }
 
+void Router::SetLastFrame(uint64_t frame) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _last_frame = frame;
+}
+
+// 断开的会话不再等待
+bool Router::WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _ack_condition.wait_for(lock, timeout, [&]() {
+    for (const auto &ack : _acks) {
+      if (ack.second < frame) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+// 按调度器选出渲染传感器的服务器，放置后帧时间估计最短的那台
+std::weak_ptr<Primary> Router::GetServerFor(stream_id sensor_id, double weight) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return FindSession(_scheduler.Place(sensor_id, weight));
+}
+
+std::vector<std::weak_ptr<Primary>> Router::GetServers() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::vector<std::weak_ptr<Primary>>(_sessions.begin(), _sessions.end());
+}
+
+void Router::ReportFrameTime(std::weak_ptr<Primary> server, double milliseconds) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto s = server.lock();
+  if (s) {
+    _scheduler.ReportFrameTime(s.get(), milliseconds);
+  }
+}
+
+// 不平衡持续时由调度器决定迁移哪个传感器，这里只把标识换回会话
+std::vector<std::pair<stream_id, std::weak_ptr<Primary>>> Router::BalancePlacement() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::pair<stream_id, std::weak_ptr<Primary>>> result;
+  for (const auto &migration : _scheduler.Balance()) {
+    result.emplace_back(migration.sensor, FindSession(migration.to));
+  }
+  return result;
+}
+
+std::weak_ptr<Primary> Router::FindSession(PlacementScheduler::server_key key) {
+  for (auto &s : _sessions) {
+    if (s.get() == key) {
+      return std::weak_ptr<Primary>(s);
+    }
+  }
+  return std::weak_ptr<Primary>();
+}
+
 } // 名称空间 multigpu
 } // 名称空间 carla
@@ -12,10 +12,13 @@
 #include "carla/multigpu/primary.h" // 包含用于多GPU处理的主要组件的头文件
 #include "carla/multigpu/primaryCommands.h" 
 #include "carla/multigpu/commands.h"
+#include "carla/multigpu/placementScheduler.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <chrono>
+#include <condition_variable>
 #include <mutex> // 包含互斥锁的头文件
 #include <vector> // 包含动态数组的头文件
 #include <sstream> // 包含字符串流的头文件
@@ -47,7 +50,7 @@ namespace multigpu {
     void SetCallbacks(); // 设置回调函数
     void SetNewConnectionCallback(std::function<void(void)>); // 设置新连接的回调函数
 
-    void AsyncRun(size_t worker_threads); // 异步运行，指定工作线程的数量
+    void AsyncRun(size_t worker_threads, const ThreadSettings &settings = {}); // 异步运行，指定工作线程的数量、亲和性和优先级
 
     boost::asio::ip::tcp::endpoint GetLocalEndpoint() const;
 
@@ -61,10 +64,28 @@ namespace multigpu {
 
     std::weak_ptr<Primary> GetNextServer();  // 获取下一个服务器的弱引用
 
+    /// 记录最近广播的帧，之后连接的服务器不需要确认这一帧和之前的帧。
+    void SetLastFrame(uint64_t frame);
+
+    /// 等待所有辅助服务器确认渲染完 @a frame，超时返回 false。
+    bool WaitForFrame(uint64_t frame, std::chrono::milliseconds timeout);
+
+    /// 按调度器选出渲染这个传感器的服务器（权重见 PlacementScheduler::GetSensorWeight），
+    /// 已经放置的传感器返回原来的服务器。
+    std::weak_ptr<Primary> GetServerFor(stream_id sensor_id, double weight);
+
+    std::vector<std::weak_ptr<Primary>> GetServers();  // 所有连接的辅助服务器
+
+    void ReportFrameTime(std::weak_ptr<Primary> server, double milliseconds);  // 记录服务器报告的 GPU 帧时间
+
+    /// 一轮报告之后调用，返回需要迁移到新服务器的传感器。
+    std::vector<std::pair<stream_id, std::weak_ptr<Primary>>> BalancePlacement();
+
   private:
     void ConnectSession(std::shared_ptr<Primary> session); // 连接会话
     void DisconnectSession(std::shared_ptr<Primary> session); // 断开会话
     void ClearSessions(); // 清除会话
+    std::weak_ptr<Primary> FindSession(PlacementScheduler::server_key key); // 按调度器的标识查找会话，需要持有锁
 
     // 互斥锁和线程池必须放在开始位置，以确保最后被销毁
     std::mutex                              _mutex; // 互斥锁
@@ -76,6 +97,10 @@ namespace multigpu {
     std::unordered_map<Primary *, std::shared_ptr<std::promise<SessionInfo>>> _promises;  // 用于异步操作的承诺映射
     PrimaryCommands                         _commander; // 命令对象
     std::function<void(void)>               _callback; // 回调函数
+    PlacementScheduler                      _scheduler; // 传感器的放置
+    std::unordered_map<Primary *, uint64_t> _acks; // 每个会话确认的最后一帧
+    uint64_t                                _last_frame = 0u; // 最近广播的帧
+    std::condition_variable                 _ack_condition; // 收到确认或会话断开时通知
   };
 
 } // namespace multigpu
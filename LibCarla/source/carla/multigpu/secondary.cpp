@@ -6,6 +6,7 @@
 
 #include "carla/multigpu/incomingMessage.h" // 包含接收消息的头文件
 #include "carla/multigpu/secondary.h"       // 包含次要功能的头文件
+#include "carla/multigpu/socketOptions.h"   // 包含连接的套接字选项
 
 #include "carla/BufferPool.h"                // 包含缓冲池的头文件
 #include "carla/Debug.h"                     // 包含调试相关的头文件
@@ -89,9 +90,8 @@ namespace multigpu {
           return;
         }
 
-        // 此设置强制不使用Nagle算法。
-        // 在Linux上提高同步模式速度约3倍。
-        self->_socket.set_option(boost::asio::ip::tcp::no_delay(true)); // 禁用Nagle算法
+        // 不使用Nagle算法，并使用更大的缓冲区（辅助服务器可以在其它主机上）
+        SetSocketOptions(self->_socket);
 
         log_info("secondary server: connected to ", self->_endpoint); // 记录连接信息
 
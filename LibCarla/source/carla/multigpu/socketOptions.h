@@ -0,0 +1,63 @@
+﻿// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include <atomic>
+#include <cstddef>
+
+namespace carla {
+namespace multigpu {
+
+  /// 主服务器和辅助服务器连接的套接字缓冲区大小（字节），0 表示使用系统的
+  /// 自动调整，默认为 0。
+  ///
+  /// 设置固定大小会关闭 Linux 的 TCP 自动调整，并且被限制在
+  /// net.core.rmem_max/wmem_max 以内（默认约 208 KiB），通常比自动调整的
+  /// 结果更小。只在提高了系统上限的高带宽时延积链路上设置。
+  inline std::atomic<size_t> &MultiGPUSocketBufferSize() {
+    static std::atomic<size_t> size{0u};
+    return size;
+  }
+
+  /// 设置主服务器和辅助服务器连接的套接字选项。
+  inline void SetSocketOptions(boost::asio::ip::tcp::socket &socket) {
+    // 这强制不使用 Nagle 算法。将 Linux 上的同步模式速度提高了约 3 倍。
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    const size_t size = MultiGPUSocketBufferSize().load(std::memory_order_relaxed);
+    if (size == 0u) {
+      return;
+    }
+    boost::system::error_code ec;
+    socket.set_option(boost::asio::socket_base::send_buffer_size(static_cast<int>(size)), ec);
+    socket.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(size)), ec);
+    if (ec) {
+      log_warning("multigpu: cannot set the socket buffer size:", ec.message());
+      return;
+    }
+    // 系统会不报错地把大小限制在上限以内。Linux 上读回的值包含内核记账的部分，
+    // 是设置值的两倍
+#ifdef __linux__
+    const size_t expected = 2u * size;
+#else
+    const size_t expected = size;
+#endif
+    boost::asio::socket_base::send_buffer_size send;
+    boost::asio::socket_base::receive_buffer_size receive;
+    socket.get_option(send, ec);
+    socket.get_option(receive, ec);
+    if (!ec && (static_cast<size_t>(send.value()) < expected || static_cast<size_t>(receive.value()) < expected)) {
+      log_warning("multigpu: socket buffer size clamped by the system to",
+          send.value(), "(send) and", receive.value(), "(receive) bytes, requested", size);
+    }
+  }
+
+} // namespace multigpu
+} // namespace carla
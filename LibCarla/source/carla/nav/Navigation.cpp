@@ -13,8 +13,9 @@
 #include "carla/nav/WalkerManager.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
-#include <fstream>
 #include <mutex>
 
 namespace carla {
@@ -42,6 +43,12 @@ namespace nav {
   static const float AREA_GRASS_COST =  1.0f;
   static const float AREA_ROAD_COST  = 10.0f;
 
+  // 路径缓存最多保存的多边形路径，满了就清空
+  static const size_t PATH_CACHE_SIZE = 4096u;
+  // 人群的过滤器是 0 和 1，GetPath 的默认过滤器使用 2，其他过滤器不使用缓存
+  static const unsigned char PATH_CACHE_DEFAULT_FILTER = 2u;
+  static const unsigned char NO_PATH_CACHE = 0xffu;
+
   // 返回一个随机的浮点数 float
   static float frand() {
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
@@ -60,17 +67,18 @@ namespace nav {
     _mapped_by_index.clear();
     _walkers_blocked_position.clear();
     _yaw_walkers.clear();
-    _binary_mesh.clear();
     dtFreeCrowd(_crowd);
     dtFreeNavMeshQuery(_nav_query);
     dtFreeNavMesh(_nav_mesh);
+    // 瓦片引用这些数据，网格释放之后才能释放
+    _binary_mesh.clear();
+    _mapped_mesh.reset();
   }
 
-  // 参考模拟器访问API函数
-  void Navigation::SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator)
+  // 设置交通灯的数据来源
+  void Navigation::SetTrafficLights(TrafficLightStopsFunction stops, TrafficLightStateFunction state)
   {
-    _simulator = simulator;
-    _walker_manager.SetSimulator(simulator);
+    _walker_manager.SetTrafficLights(std::move(stops), std::move(state));
   }
 
   // 设置要使用的随机数种子
@@ -80,23 +88,44 @@ namespace nav {
 
   // 加载导航数据
   bool Navigation::Load(const std::string &filename) {
-    std::ifstream f;
-    std::istream_iterator<uint8_t> start(f), end;
-
-    // 读取整个文件
-    f.open(filename, std::ios::binary);
-    if (!f.is_open()) {
+    auto file = MappedFile::OpenCopyOnWrite(filename);
+    if (file == nullptr) {
       return false;
     }
-    std::vector<uint8_t> content(start, end);
-    f.close();
-
-    // 解析内容
-    return Load(std::move(content));
+    return Load(std::move(file));
   }
 
   // 从内存中加载导航数据
   bool Navigation::Load(std::vector<uint8_t> content) {
+    dtNavMesh *mesh = CreateNavMesh(content.data(), content.size());
+    if (mesh == nullptr) {
+      return false;
+    }
+    // 先释放旧的网格，再释放它引用的数据
+    SetNavMesh(mesh);
+    _binary_mesh = std::move(content);
+    _mapped_mesh.reset();
+    return true;
+  }
+
+  // 从映射的文件中加载导航数据
+  bool Navigation::Load(std::unique_ptr<MappedFile> file) {
+    if ((file == nullptr) || (file->writable_data() == nullptr)) {
+      logging::log("Nav: navigation mesh must be mapped copy-on-write");
+      return false;
+    }
+    dtNavMesh *mesh = CreateNavMesh(file->writable_data(), file->size());
+    if (mesh == nullptr) {
+      return false;
+    }
+    SetNavMesh(mesh);
+    _mapped_mesh = std::move(file);
+    _binary_mesh = std::vector<uint8_t>{};
+    return true;
+  }
+
+  // 解析导航网格
+  dtNavMesh *Navigation::CreateNavMesh(uint8_t *content, const size_t size) {
     const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; // 'MSET';
     const int NAVMESHSET_VERSION = 1;
 #pragma pack(push, 1)
@@ -117,31 +146,32 @@ namespace nav {
 
     // 检查 导航网格集合头的结构体大小
     // 如果内存中导航数据 都小于 头的大小，则报错
-    if (content.size() < sizeof(header)) {
+    if ((content == nullptr) || (size < sizeof(header))) {
       logging::log("Nav: failed loading binary");
-      return false;
+      return nullptr;
     }
 
     // 读取文件的头
-    unsigned long pos = 0;
-    memcpy(&header, &content[pos], sizeof(header));
+    size_t pos = 0u;
+    memcpy(&header, content + pos, sizeof(header));
     pos += sizeof(header);
 
     // 检查文件的魔术和版本
     if (header.magic != NAVMESHSET_MAGIC || header.version != NAVMESHSET_VERSION) {
-      return false;
+      return nullptr;
     }
 
     // 分配导航网格对象的内存
     dtNavMesh *mesh = dtAllocNavMesh();
     if (!mesh) {
-      return false;
+      return nullptr;
     }
 
     // 设置瓦片的数目和原点
     dtStatus status = mesh->init(&header.params);
     if (dtStatusFailed(status)) {
-      return false;
+      dtFreeNavMesh(mesh);
+      return nullptr;
     }
 
     // 读取瓦片数据
@@ -149,37 +179,49 @@ namespace nav {
       NavMeshTileHeader tile_header;
 
       // 读取瓦片头
-      memcpy(&tile_header, &content[pos], sizeof(tile_header));
-      pos += sizeof(tile_header);
-      if (pos >= content.size()) {
+      if (pos + sizeof(tile_header) >= size) {
         dtFreeNavMesh(mesh);
-        return false;
+        return nullptr;
       }
+      memcpy(&tile_header, content + pos, sizeof(tile_header));
+      pos += sizeof(tile_header);
 
       // 检查瓦片的有效性
-      if (!tile_header.tile_ref || !tile_header.data_size) {
+      if (!tile_header.tile_ref || (tile_header.data_size <= 0)) {
         break;
       }
 
-      // 分配缓冲区内存
-      char *data = static_cast<char *>(dtAlloc(static_cast<size_t>(tile_header.data_size), DT_ALLOC_PERM));
-      if (!data) {
-        break;
+      const auto data_size = static_cast<size_t>(tile_header.data_size);
+      if (pos + data_size > size) {
+        dtFreeNavMesh(mesh);
+        return nullptr;
       }
 
-      // 读取瓦片
-      memcpy(data, &content[pos], static_cast<size_t>(tile_header.data_size));
-      pos += static_cast<unsigned long>(tile_header.data_size);
-      if (pos > content.size()) {
-        dtFree(data);
-        dtFreeNavMesh(mesh);
-        return false;
+      // 瓦片直接使用 content 中的数据，Detour 释放网格时不释放它们。Detour 按 4 字节
+      // 访问瓦片的数据，文件中的瓦片都是对齐的，不对齐时才复制。
+      unsigned char *data = content + pos;
+      int flags = 0;
+      if ((reinterpret_cast<uintptr_t>(data) % alignof(float)) != 0u) {
+        data = static_cast<unsigned char *>(dtAlloc(data_size, DT_ALLOC_PERM));
+        if (!data) {
+          break;
+        }
+        memcpy(data, content + pos, data_size);
+        flags = DT_TILE_FREE_DATA;
       }
+      pos += data_size;
 
       // 添加瓦片数据
-      mesh->addTile(reinterpret_cast<unsigned char *>(data), tile_header.data_size, DT_TILE_FREE_DATA,
-      tile_header.tile_ref, 0);
+      status = mesh->addTile(data, tile_header.data_size, flags, tile_header.tile_ref, 0);
+      if (dtStatusFailed(status) && (flags == DT_TILE_FREE_DATA)) {
+        dtFree(data);
+      }
     }
+    return mesh;
+  }
+
+  void Navigation::SetNavMesh(dtNavMesh *mesh) {
+    DEBUG_ASSERT(mesh != nullptr);
 
     // 交换
     dtFreeNavMesh(_nav_mesh);
@@ -190,14 +232,14 @@ namespace nav {
     _nav_query = dtAllocNavMeshQuery();
     _nav_query->init(_nav_mesh, MAX_QUERY_SEARCH_NODES);
 
-    // 拷贝
-    _binary_mesh = std::move(content);
     _ready = true;
 
+    // 旧网格的路径不再有效
+    _path_cache.clear();
+    BuildRandomPolys();
+
     // 创建并初始化人群管理器
     CreateCrowd();
-
-    return true;
   }
 
   void Navigation::CreateCrowd(void) {
@@ -271,106 +313,53 @@ namespace nav {
                            dtQueryFilter * filter,
                            std::vector<carla::geom::Location> &path,
                            std::vector<unsigned char> &area) {
-    // 找到路径
-    float straight_path[MAX_POLYS * 3];
-    unsigned char straight_path_flags[MAX_POLYS];
-    dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path;
-    int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;
-
-    // 路径中的多边形
-    dtPolyRef polys[MAX_POLYS];
-    int num_polys;
-
     // 检查是否一切就绪
     if (!_ready) {
       return false;
     }
 
-    DEBUG_ASSERT(_nav_query != nullptr);
-
-    // 点的延伸
-    float poly_pick_ext[3];
-    poly_pick_ext[0] = 2;
-    poly_pick_ext[1] = 4;
-    poly_pick_ext[2] = 2;
-
     // 筛选
     dtQueryFilter filter2;
+    unsigned char filter_key = NO_PATH_CACHE;
     if (filter == nullptr) {
       filter2.setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
       filter2.setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
       filter2.setIncludeFlags(CARLA_TYPE_WALKABLE);
       filter2.setExcludeFlags(CARLA_TYPE_NONE);
       filter = &filter2;
+      filter_key = PATH_CACHE_DEFAULT_FILTER;
     }
 
-    // 设置点
-    dtPolyRef start_ref = 0;
-    dtPolyRef end_ref = 0;
-    float start_pos[3] = { from.x, from.z, from.y };
-    float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
-    if (!start_ref || !end_ref) {
-      return false;
-    }
-
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      // 获取节点的路径
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
-    }
+    return FindPath(filter, filter_key, from, to, path, area);
+  }
 
-    // 获得点的路径
-    num_straight_path = 0;
-    if (num_polys == 0) {
+  bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
+  std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
+    // 检查是否一切就绪
+    if (!_ready) {
       return false;
     }
 
-    // 如果是部分路径，请确保终点与最后一个多边形相接
-    float end_pos2[3];
-    dtVcopy(end_pos2, end_pos);
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
-    }
+    // 从代理获取当前过滤器
+    auto it = _mapped_walkers_id.find(id);
+    if (it == _mapped_walkers_id.end())
+      return false;
 
-    // 获得点
+    const dtQueryFilter *filter;
+    unsigned char filter_key;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
-
-    // 将路径复制到输出缓冲区
-    path.clear();
-    path.reserve(static_cast<unsigned long>(num_straight_path));
-    unsigned char area_type;
-    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
-      // 保存虚幻轴的坐标（x，z，y）
-      path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存区域类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
-      }
-      area.emplace_back(area_type);
+      filter_key = _crowd->getAgent(it->second)->params.queryFilterType;
+      filter = _crowd->getFilter(filter_key);
     }
 
-    return true;
+    return FindPath(filter, filter_key, from, to, path, area);
   }
 
-  bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
+  // 查找路径，人群的过滤器和默认过滤器的多边形路径保存在缓存中
+  bool Navigation::FindPath(const dtQueryFilter *filter, unsigned char filter_key,
+  carla::geom::Location from, carla::geom::Location to,
   std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
     // 找到路径
     float straight_path[MAX_POLYS * 3];
@@ -381,53 +370,51 @@ namespace nav {
 
     // 路径中的多边形
     dtPolyRef polys[MAX_POLYS];
-    int num_polys;
-
-    // 检查是否一切就绪
-    if (!_ready) {
-      return false;
-    }
+    const dtPolyRef *path_polys = polys;
+    int num_polys = 0;
 
     DEBUG_ASSERT(_nav_query != nullptr);
 
     // 点的扩展
     float poly_pick_ext[3] = {2,4,2};
 
-    // 从代理获取当前过滤器
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
-      return false;
-
-    const dtQueryFilter *filter;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
-    }
-
     // 设置点
     dtPolyRef start_ref = 0;
     dtPolyRef end_ref = 0;
     float start_pos[3] = { from.x, from.z, from.y };
     float end_pos[3] = { to.x, to.z, to.y };
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
-    }
+
+    // 关键部分，强制单线程运行这里，整个查询只加锁一次
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
+    _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
     if (!start_ref || !end_ref) {
       return false;
     }
 
-    // 获取点的路径
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
+    // 获取节点的路径，先查找缓存
+    if (filter_key != NO_PATH_CACHE) {
+      const PathKey key { start_ref, end_ref, filter_key };
+      auto cached = _path_cache.find(key);
+      if (cached == _path_cache.end()) {
+        _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
+        if (num_polys > 0) {
+          // 缓存满了就全部丢弃，重新开始
+          if (_path_cache.size() >= PATH_CACHE_SIZE) {
+            _path_cache.clear();
+          }
+          cached = _path_cache.emplace(key, std::vector<dtPolyRef>(polys, polys + num_polys)).first;
+        }
+      }
+      if (cached != _path_cache.end()) {
+        path_polys = cached->second.data();
+        num_polys = static_cast<int>(cached->second.size());
+      }
+    } else {
       _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
     }
 
-    // 获取点的路径
     if (num_polys == 0) {
       return false;
     }
@@ -435,34 +422,26 @@ namespace nav {
     // 如果是部分路径，请确保终点与最后一个多边形相接
     float end_pos2[3];
     dtVcopy(end_pos2, end_pos);
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
+    if (path_polys[num_polys - 1] != end_ref) {
+      _nav_query->closestPointOnPoly(path_polys[num_polys - 1], end_pos, end_pos2, 0);
     }
 
     // 获取点
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
+    _nav_query->findStraightPath(start_pos, end_pos2, path_polys, num_polys,
+    straight_path, straight_path_flags,
+    straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
 
     // 将路径复制到输出缓冲区
     path.clear();
     path.reserve(static_cast<unsigned long>(num_straight_path));
+    area.clear();
+    area.reserve(static_cast<unsigned long>(num_straight_path));
     unsigned char area_type;
     for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
       // 保存虚幻轴的坐标（x，z，y）
       path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存面积类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
-      }
+      // 保存区域类型
+      _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
       area.emplace_back(area_type);
     }
 
@@ -830,7 +809,7 @@ namespace nav {
   }
 
   // 更新人群中的所有行人
-  void Navigation::UpdateCrowd(const client::detail::EpisodeState &state) {
+  void Navigation::UpdateCrowd(double delta_seconds) {
 
     // 检查是否一切就绪
     if (!_ready) {
@@ -840,7 +819,7 @@ namespace nav {
     DEBUG_ASSERT(_crowd != nullptr);
 
     // 更新人群代理
-    _delta_seconds = state.GetTimestamp().delta_seconds;
+    _delta_seconds = delta_seconds;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
@@ -1067,6 +1046,12 @@ namespace nav {
 
     DEBUG_ASSERT(_nav_query != nullptr);
 
+    // 默认的人行道过滤器使用预先计算的多边形面积
+    if (filter == nullptr && !_random_polys.empty()) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return GetRandomPolyLocation(location);
+    }
+
     // 过滤器
     dtQueryFilter filter2;
     if (filter == nullptr) {
@@ -1098,6 +1083,117 @@ namespace nav {
     return (rounds > 0);
   }
 
+  // 获取多个人行道上的随机位置
+  size_t Navigation::GetRandomLocations(size_t count, std::vector<carla::geom::Location> &locations) const {
+    locations.reserve(locations.size() + count);
+    if (!_ready || _random_polys.empty()) {
+      // 没有人行道多边形时逐个查找
+      size_t found = 0u;
+      carla::geom::Location location;
+      for (size_t i = 0u; i < count; ++i) {
+        if (GetRandomLocation(location)) {
+          locations.emplace_back(location);
+          ++found;
+        }
+      }
+      return found;
+    }
+
+    // 关键部分，强制单线程运行这里，所有位置只加锁一次
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t found = 0u;
+    carla::geom::Location location;
+    for (size_t i = 0u; i < count; ++i) {
+      if (GetRandomPolyLocation(location)) {
+        locations.emplace_back(location);
+        ++found;
+      }
+    }
+    return found;
+  }
+
+  // 计算人行道多边形的累计面积
+  void Navigation::BuildRandomPolys() {
+    _random_polys.clear();
+
+    dtQueryFilter filter;
+    filter.setIncludeFlags(CARLA_TYPE_SIDEWALK);
+    filter.setExcludeFlags(CARLA_TYPE_NONE);
+
+    const dtNavMesh *mesh = _nav_mesh;
+    float total_area = 0.0f;
+    for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+      const dtMeshTile *tile = mesh->getTile(i);
+      if (tile == nullptr || tile->header == nullptr) {
+        continue;
+      }
+      const dtPolyRef base = mesh->getPolyRefBase(tile);
+      for (int j = 0; j < tile->header->polyCount; ++j) {
+        const dtPoly *poly = &tile->polys[j];
+        // 与 findRandomPoint 一样只使用地面多边形
+        if (poly->getType() != DT_POLYTYPE_GROUND) {
+          continue;
+        }
+        const dtPolyRef ref = base | static_cast<dtPolyRef>(j);
+        if (!filter.passFilter(ref, tile, poly)) {
+          continue;
+        }
+        float poly_area = 0.0f;
+        const float *va = &tile->verts[poly->verts[0] * 3];
+        for (int k = 2; k < poly->vertCount; ++k) {
+          const float *vb = &tile->verts[poly->verts[k - 1] * 3];
+          const float *vc = &tile->verts[poly->verts[k] * 3];
+          poly_area += dtTriArea2D(va, vb, vc);
+        }
+        poly_area = std::fabs(poly_area);
+        if (poly_area > 0.0f) {
+          total_area += poly_area;
+          _random_polys.emplace_back(ref, total_area);
+        }
+      }
+    }
+  }
+
+  // 按面积选择一个人行道多边形，再在多边形内选择一个点
+  bool Navigation::GetRandomPolyLocation(carla::geom::Location &location) const {
+    DEBUG_ASSERT(!_random_polys.empty());
+
+    const float value = frand() * _random_polys.back().second;
+    auto it = std::upper_bound(_random_polys.begin(), _random_polys.end(), value,
+        [](float lhs, const std::pair<dtPolyRef, float> &rhs) { return lhs < rhs.second; });
+    if (it == _random_polys.end()) {
+      --it;
+    }
+
+    const dtMeshTile *tile = nullptr;
+    const dtPoly *poly = nullptr;
+    if (dtStatusFailed(_nav_mesh->getTileAndPolyByRef(it->first, &tile, &poly))) {
+      return false;
+    }
+
+    float verts[3 * DT_VERTS_PER_POLYGON];
+    float areas[DT_VERTS_PER_POLYGON];
+    for (int k = 0; k < poly->vertCount; ++k) {
+      dtVcopy(&verts[k * 3], &tile->verts[poly->verts[k] * 3]);
+    }
+    const float s = frand();
+    const float t = frand();
+    float point[3];
+    dtRandomPointInConvexPoly(verts, poly->vertCount, areas, s, t, point);
+
+    // 将高度贴合到多边形上
+    float height = 0.0f;
+    if (dtStatusSucceed(_nav_query->getPolyHeight(it->first, point, &height))) {
+      point[1] = height;
+    }
+
+    // 在虚幻坐标中设置位置
+    location.x = point[0];
+    location.y = point[2];
+    location.z = point[1];
+    return true;
+  }
+
   // 为代理分配过滤索引
   void Navigation::SetAgentFilter(int agent_index, int filter_index)
   {
@@ -7,7 +7,7 @@
 #pragma once
 
 #include "carla/AtomicList.h"
-#include "carla/client/detail/EpisodeState.h"
+#include "carla/MappedFile.h"
 #include "carla/geom/BoundingBox.h"
 
 // 使用几何库相关功能
@@ -25,6 +25,11 @@
 #include <recast/DetourNavMeshQuery.h>
 #include <recast/DetourCommon.h>
 
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace nav {
 
@@ -67,18 +72,24 @@ namespace nav {
     Navigation();
     ~Navigation();
 
-    /// 从磁盘中加载导航数据
+    /// 从磁盘中加载导航数据，文件以写时复制方式映射到内存，见 Load(std::unique_ptr<MappedFile>)
     bool Load(const std::string &filename);
-    /// 从内存中加载导航数据
+    /// 从内存中加载导航数据，瓦片直接使用 @a content 中的数据
     bool Load(std::vector<uint8_t> content);
+    /// 从映射的文件中加载导航数据，瓦片直接使用映射中的数据而不复制。
+    ///
+    /// Detour 只写入瓦片中的多边形和连接，顶点、细节网格和包围体树所在的页
+    /// 不会被复制，同一台机器上加载同一个文件的进程共享这些页。@a file 必须用
+    /// MappedFile::OpenCopyOnWrite 打开。
+    bool Load(std::unique_ptr<MappedFile> file);
     /// 返回从一个位置到另一个位置的路径点
     bool GetPath(carla::geom::Location from, carla::geom::Location to, dtQueryFilter * filter,
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
     bool GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
 
-    /// 引用模拟器来访问API函数
-    void SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator);
+    /// 设置交通灯的数据来源，客户端从模拟器读取，服务器端直接从场景中读取
+    void SetTrafficLights(TrafficLightStopsFunction stops, TrafficLightStateFunction state);
     /// 设置随机数种子
     void SetSeed(unsigned int seed);
     /// 创建人群对象
@@ -104,10 +115,12 @@ namespace nav {
     bool GetWalkerPosition(ActorId id, carla::geom::Location &location);
     /// 获取步行人速度
     float GetWalkerSpeed(ActorId id);
-    /// 更新人群中的所有步行者
-    void UpdateCrowd(const client::detail::EpisodeState &state);
+    /// 更新人群中的所有步行者，@a delta_seconds 是这一帧的模拟时间
+    void UpdateCrowd(double delta_seconds);
     /// 获取导航的随机位置
     bool GetRandomLocation(carla::geom::Location &location, dtQueryFilter * filter = nullptr) const;
+    /// 获取 @a count 个人行道上的随机位置，返回得到的数量
+    size_t GetRandomLocations(size_t count, std::vector<carla::geom::Location> &locations) const;
     /// 设置行人代理在路径跟随过程中穿过马路的概率
     void SetPedestriansCrossFactor(float percentage);
     /// 将人群中的代理设置为暂停
@@ -126,8 +139,45 @@ namespace nav {
 
   private:
 
+    /// 路径缓存的键：起点和终点的多边形，以及过滤器
+    struct PathKey {
+      dtPolyRef start;
+      dtPolyRef end;
+      unsigned char filter;
+
+      bool operator==(const PathKey &rhs) const {
+        return start == rhs.start && end == rhs.end && filter == rhs.filter;
+      }
+    };
+
+    struct PathKeyHash {
+      size_t operator()(const PathKey &key) const {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(key.start) * 31u + key.end) * 31u + key.filter);
+      }
+    };
+
+    /// 查找从 @a from 到 @a to 的路径，@a filter_key 不是 NO_PATH_CACHE 时使用路径缓存
+    bool FindPath(const dtQueryFilter *filter, unsigned char filter_key,
+    carla::geom::Location from, carla::geom::Location to,
+    std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
+
+    /// 从 @a data 中解析导航网格，瓦片引用 @a data 中的数据，调用者负责在网格
+    /// 释放之前保持其有效；失败时返回 nullptr
+    static dtNavMesh *CreateNavMesh(uint8_t *data, size_t size);
+
+    /// 使用新的网格，@a mesh 引用的数据已经存放在 _binary_mesh 或 _mapped_mesh 中
+    void SetNavMesh(dtNavMesh *mesh);
+
+    /// 计算人行道多边形的累计面积，用来选择随机位置
+    void BuildRandomPolys();
+
+    /// 按面积在人行道多边形上均匀地选择一个随机位置，需要持有 _mutex
+    bool GetRandomPolyLocation(carla::geom::Location &location) const;
+
     bool _ready { false };
+    /// 网格的数据，二者最多一个不为空；必须在网格释放之后才能释放
     std::vector<uint8_t> _binary_mesh;
+    std::unique_ptr<MappedFile> _mapped_mesh;
     double _delta_seconds { 0.0 };
     /// 网格
     dtNavMesh *_nav_mesh { nullptr };
@@ -145,11 +195,15 @@ namespace nav {
     std::unordered_map<int, carla::geom::Vector3D> _walkers_blocked_position;
     double _time_to_unblock { 0.0 };
 
+    /// 多边形之间的路径（findPath 的结果），路径只取决于导航网格和过滤器，
+    /// 所以可以在行人之间共享，只需要重新计算 findStraightPath
+    std::unordered_map<PathKey, std::vector<dtPolyRef>, PathKeyHash> _path_cache;
+    /// 人行道多边形和到它为止的累计面积
+    std::vector<std::pair<dtPolyRef, float>> _random_polys;
+
     /// 行人管理器负责带事件的路线规划
     WalkerManager _walker_manager;
 
-    std::weak_ptr<carla::client::detail::Simulator> _simulator;
-    
     mutable std::mutex _mutex;
 
     float _probability_crossing { 0.0f };
@@ -55,9 +55,9 @@ namespace nav {
             }
 
             // 检查是否需要等待红绿灯
-            if (event.actor) {
+            if (event.actor != 0u) {
                 // 获取交通信号灯演员（event.actor）的当前状态
-                auto state = event.actor->GetState();
+                auto state = _manager->GetTrafficLightState(event.actor);
                 // 如果交通信号灯状态为绿色（Green）或者黄色（Yellow），则表示可以继续前进，返回EventResult::Continue
                 if (state == carla::rpc::TrafficLightState::Green || 
                     state == carla::rpc::TrafficLightState::Yellow) {
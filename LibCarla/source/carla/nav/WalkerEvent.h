@@ -70,8 +70,8 @@ namespace nav {
         double time;
         // 表示是否检查交通信号灯，类型为布尔值，true表示要检查，false表示不检查
         bool check_for_trafficlight;
-        // 指向carla::client::TrafficLight类型的共享指针，用于指向相关的交通信号灯Actor（如果有的话），方便后续操作与之相关的实体
-        SharedPtr<carla::client::TrafficLight> actor;
+        // 相关的交通信号灯Actor的ID，没有交通信号灯时为0
+        ActorId actor { 0u };
         // 构造函数，用于初始化成员变量，默认设置为要检查交通信号灯，并接收一个表示持续时间的参数来设置等待时间
         WalkerEventStopAndCheck(double duration) : time(duration),
                                                    check_for_trafficlight(true)
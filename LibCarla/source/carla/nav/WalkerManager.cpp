@@ -7,16 +7,27 @@
 #include "carla/nav/WalkerManager.h"
 
 #include "carla/Logging.h"
-#include "carla/client/ActorSnapshot.h"
-#include "carla/client/Waypoint.h"
-#include "carla/client/World.h"
-#include "carla/client/detail/Simulator.h"
+#include "carla/ParallelFor.h"
 #include "carla/nav/Navigation.h"
-#include "carla/rpc/Actor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 
 namespace carla {
 namespace nav {
 
+    // 行人较少时不值得启动线程
+    static constexpr size_t WalkerManager_MinWalkersPerThread = 64u;
+
+    // 交通灯网格单元的大小（米）
+    static constexpr float WalkerManager_TrafficLightCellSize = 10.0f;
+
+    static int32_t WalkerManager_GetCell(float value) {
+        return static_cast<int32_t>(std::floor(value / WalkerManager_TrafficLightCellSize));
+    }
+
     WalkerManager::WalkerManager() {
     }
 
@@ -28,9 +39,13 @@ namespace nav {
         _nav = nav;
     }
 
-    // 设置模拟器的弱引用，以访问 API 函数
-    void WalkerManager::SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator) {
-        _simulator = simulator;
+    // 设置交通灯的数据来源
+    void WalkerManager::SetTrafficLights(TrafficLightStopsFunction stops, TrafficLightStateFunction state) {
+        _get_traffic_light_stops = std::move(stops);
+        _get_traffic_light_state = std::move(state);
+        _traffic_lights.clear();
+        _traffic_light_grid.clear();
+        _traffic_lights_loaded = false;
     }
 
 	// 创建新的行人路线
@@ -58,51 +73,33 @@ namespace nav {
     }
 
 	// 更新所有行人路线
+    //
+    // 分两步：先并行地更新每个行人的状态和事件（只读取导航和交通灯，只修改各自
+    // 的 WalkerInfo），再按顺序执行需要查询路径和修改人群的操作
     bool WalkerManager::Update(double delta) {
 
-        // 检查所有行人
+        _update_walkers.clear();
+        _update_walkers.reserve(_walkers.size());
         for (auto &it : _walkers) {
+            _update_walkers.emplace_back(it.first, &it.second);
+        }
+        _update_results.assign(_update_walkers.size(), WalkerUpdate::None);
 
-            // 获取行人信息
-            WalkerInfo &info = it.second;
-
-            // 根据状态执行不同的操作
-            switch (info.state) {
-                case WALKER_IDLE:
-                    break;// 闲置状态不做任何操作
-
-                case WALKER_WALKING:
-                    {
-                        // 获取目标点
-                        carla::geom::Location &target = info.route[info.currentIndex].location;
-                        // 获取当前位置信息
-                        carla::geom::Location current;
-                        _nav->GetWalkerPosition(it.first, current);
-                        // 计算与目标点的距离v
-                        carla::geom::Vector3D dist(target.x - current.x, target.z - current.z, target.y - current.y);
-                        if (dist.SquaredLength() <= 1) {// 判断是否到达目标点
-                            info.state = WALKER_IN_EVENT;// 状态切换为在事件中
-                        }
-                    }
-                    break;
+        ParallelFor(_update_walkers.size(), [this, delta](const size_t i) {
+            _update_results[i] = UpdateWalker(_update_walkers[i].first, *_update_walkers[i].second, delta);
+        }, WalkerManager_MinWalkersPerThread);
 
-                case WALKER_IN_EVENT:
-                    switch (ExecuteEvent(it.first, it.second, delta)) {
-                        case EventResult::Continue:
-                            break;// 继续事件
-                        case EventResult::End:
-                             // 进入下一个路径点 
-                            SetWalkerNextPoint(it.first);
-                            break;
-                        case EventResult::TimeOut:
-                            // 解锁改变路线的操作
-                            SetWalkerRoute(it.first);
-                            break;
-                    }
+        for (size_t i = 0u; i < _update_walkers.size(); ++i) {
+            switch (_update_results[i]) {
+                case WalkerUpdate::None:
                     break;
-
-                case WALKER_STOP:
-                    info.state = WALKER_IDLE;// 停止后切换状态为闲置
+                case WalkerUpdate::NextPoint:
+                    // 进入下一个路径点
+                    SetWalkerNextPoint(_update_walkers[i].first);
+                    break;
+                case WalkerUpdate::NewRoute:
+                    // 解锁改变路线的操作
+                    SetWalkerRoute(_update_walkers[i].first);
                     break;
             }
         }
@@ -110,6 +107,48 @@ namespace nav {
         return true;
     }
 
+    // 更新一个行人的状态
+    WalkerManager::WalkerUpdate WalkerManager::UpdateWalker(ActorId id, WalkerInfo &info, double delta) {
+
+        // 根据状态执行不同的操作
+        switch (info.state) {
+            case WALKER_IDLE:
+                break;// 闲置状态不做任何操作
+
+            case WALKER_WALKING:
+                {
+                    // 获取目标点
+                    carla::geom::Location &target = info.route[info.currentIndex].location;
+                    // 获取当前位置信息
+                    carla::geom::Location current;
+                    _nav->GetWalkerPosition(id, current);
+                    // 计算与目标点的距离v
+                    carla::geom::Vector3D dist(target.x - current.x, target.z - current.z, target.y - current.y);
+                    if (dist.SquaredLength() <= 1) {// 判断是否到达目标点
+                        info.state = WALKER_IN_EVENT;// 状态切换为在事件中
+                    }
+                }
+                break;
+
+            case WALKER_IN_EVENT:
+                switch (ExecuteEvent(id, info, delta)) {
+                    case EventResult::Continue:
+                        break;// 继续事件
+                    case EventResult::End:
+                        return WalkerUpdate::NextPoint;
+                    case EventResult::TimeOut:
+                        return WalkerUpdate::NewRoute;
+                }
+                break;
+
+            case WALKER_STOP:
+                info.state = WALKER_IDLE;// 停止后切换状态为闲置
+                break;
+        }
+
+        return WalkerUpdate::None;
+    }
+
 	// 从当前位置信息设置新的路线
     bool WalkerManager::SetWalkerRoute(ActorId id) {
         // 检查导航模块是否存在
@@ -165,8 +204,13 @@ namespace nav {
                 case CARLA_AREA_ROAD:
                 case CARLA_AREA_CROSSWALK:
                     // 仅当来自安全区域（人行道、草地或人行横道）时
-                    if (previous_area != CARLA_AREA_CROSSWALK && previous_area != CARLA_AREA_ROAD)
-                        info.route.emplace_back(WalkerEventStopAndCheck(60), std::move(path[i]), area[i]);
+                    if (previous_area != CARLA_AREA_CROSSWALK && previous_area != CARLA_AREA_ROAD) {
+                        // 创建路线时就找到这个路口的交通灯，不在每一帧的事件中查找
+                        WalkerEventStopAndCheck event(60);
+                        event.actor = GetTrafficLightAffecting(path[i]);
+                        event.check_for_trafficlight = false;
+                        info.route.emplace_back(event, std::move(path[i]), area[i]);
+                    }
                     break;
 
                 default:
@@ -276,54 +320,103 @@ namespace nav {
 
     // 获取所有交通灯的路标
     void WalkerManager::GetAllTrafficLightWaypoints() {
-        static bool AlreadyCalculated = false;
-        if (AlreadyCalculated) return;
-
-        // 获取世界对象
-        carla::client::World world = _simulator.lock()->GetWorld();
-
-        _traffic_lights.clear();
-        std::vector<carla::rpc::Actor> actors = _simulator.lock()->GetAllTheActorsInTheEpisode();
-        for (auto actor : actors) {
-            carla::client::ActorSnapshot snapshot = _simulator.lock()->GetActorSnapshot(actor.id);
-            // 仅检查交通灯
-            if (actor.description.id == "traffic.traffic_light") {
-                // 获取交通灯对象
-                SharedPtr<carla::client::TrafficLight> tl =
-                    boost::static_pointer_cast<carla::client::TrafficLight>(world.GetActor(actor.id));
-                // 获取交通灯影响的路标
-                std::vector<SharedPtr<carla::client::Waypoint>> list = tl->GetStopWaypoints();
-                for (auto &way : list) {
-                    _traffic_lights.emplace_back(tl, way->GetTransform().location);
-                }
+        if (_traffic_lights_loaded || !_get_traffic_light_stops) return;
+
+        _traffic_lights = _get_traffic_light_stops();
+
+        // 建立网格索引
+        _traffic_light_grid.clear();
+        for (size_t i = 0u; i < _traffic_lights.size(); ++i) {
+            const int32_t x = WalkerManager_GetCell(_traffic_lights[i].second.x);
+            const int32_t y = WalkerManager_GetCell(_traffic_lights[i].second.y);
+            if (i == 0u) {
+                _traffic_light_grid_min[0] = _traffic_light_grid_max[0] = x;
+                _traffic_light_grid_min[1] = _traffic_light_grid_max[1] = y;
+            } else {
+                _traffic_light_grid_min[0] = std::min(_traffic_light_grid_min[0], x);
+                _traffic_light_grid_max[0] = std::max(_traffic_light_grid_max[0], x);
+                _traffic_light_grid_min[1] = std::min(_traffic_light_grid_min[1], y);
+                _traffic_light_grid_max[1] = std::max(_traffic_light_grid_max[1], y);
             }
+            _traffic_light_grid[GetTrafficLightCell(x, y)].push_back(i);
         }
 
-        AlreadyCalculated = true;// 标记为已计算
+        _traffic_lights_loaded = true;// 标记为已计算
+    }
+
+    uint64_t WalkerManager::GetTrafficLightCell(int32_t x, int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32u) | static_cast<uint32_t>(y);
     }
 
 
     // 返回影响该位置的交通灯
-    SharedPtr<carla::client::TrafficLight> WalkerManager::GetTrafficLightAffecting(
+    ActorId WalkerManager::GetTrafficLightAffecting(
         carla::geom::Location UnrealPos,
         float max_distance) {
             float min_dist = std::numeric_limits<float>::infinity();
-            SharedPtr<carla::client::TrafficLight> actor;
-            for (auto &&item : _traffic_lights) {
-                float dist = UnrealPos.DistanceSquared(item.second);
-                if (dist < min_dist) {
-                    min_dist = dist;
-                    actor = item.first;
+            ActorId actor = 0u;
+            if (_traffic_light_grid.empty()) {
+                return 0u;
+            }
+            // 从所在的单元开始一圈一圈地向外搜索，直到外面的单元不可能更近
+            const int32_t x = WalkerManager_GetCell(UnrealPos.x);
+            const int32_t y = WalkerManager_GetCell(UnrealPos.y);
+            int32_t max_ring = std::max(
+                std::max(std::abs(x - _traffic_light_grid_min[0]), std::abs(x - _traffic_light_grid_max[0])),
+                std::max(std::abs(y - _traffic_light_grid_min[1]), std::abs(y - _traffic_light_grid_max[1])));
+            if (max_distance >= 0.0f) {
+                max_ring = std::min(max_ring,
+                    static_cast<int32_t>(std::ceil(max_distance / WalkerManager_TrafficLightCellSize)) + 1);
+            }
+            auto check_cell = [&](int32_t cx, int32_t cy) {
+                auto cell = _traffic_light_grid.find(GetTrafficLightCell(cx, cy));
+                if (cell == _traffic_light_grid.end()) {
+                    return;
+                }
+                for (size_t index : cell->second) {
+                    auto &item = _traffic_lights[index];
+                    float dist = UnrealPos.DistanceSquared(item.second);
+                    if (dist < min_dist) {
+                        min_dist = dist;
+                        actor = item.first;
+                    }
+                }
+            };
+            for (int32_t ring = 0; ring <= max_ring; ++ring) {
+                // 第 ring 圈的单元至少相距 (ring - 1) 个单元
+                const float ring_dist = static_cast<float>(ring - 1) * WalkerManager_TrafficLightCellSize;
+                if (ring > 1 && ring_dist * ring_dist > min_dist) {
+                    break;
+                }
+                if (ring == 0) {
+                    check_cell(x, y);
+                    continue;
+                }
+                for (int32_t i = -ring; i <= ring; ++i) {
+                    check_cell(x + i, y - ring);
+                    check_cell(x + i, y + ring);
+                }
+                for (int32_t i = -ring + 1; i < ring; ++i) {
+                    check_cell(x - ring, y + i);
+                    check_cell(x + ring, y + i);
                 }
             }
             // 如果距离超出限制，则拒绝该交通灯
             if (max_distance < 0.0f || min_dist <= max_distance * max_distance) {
                 return actor;
             } else {
-                return SharedPtr<carla::client::TrafficLight>();
+                return 0u;
             }
     }
 
+    // 返回交通灯的当前状态
+    carla::rpc::TrafficLightState WalkerManager::GetTrafficLightState(ActorId id) const {
+        if (!_get_traffic_light_state) {
+            return carla::rpc::TrafficLightState::Unknown;
+        }
+        return _get_traffic_light_state(id);
+    }
+
 
 } // namespace nav
 } // namespace carla
@@ -8,13 +8,17 @@
 
 #include "carla/NonCopyable.h"
 
-#include "carla/client/TrafficLight.h"
-#include "carla/client/World.h"
 #include "carla/geom/Location.h"
 #include "carla/nav/WalkerEvent.h"
 #include "carla/rpc/ActorId.h"
 #include "carla/rpc/TrafficLightState.h"
 
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace nav {
 
@@ -46,6 +50,13 @@ namespace nav {
         std::vector<WalkerRoutePoint> route;
     };
 
+    // 交通灯和它影响的一个停止位置
+    using TrafficLightStop = std::pair<ActorId, carla::geom::Location>;
+    // 返回所有交通灯的停止位置
+    using TrafficLightStopsFunction = std::function<std::vector<TrafficLightStop>()>;
+    // 返回交通灯的当前状态
+    using TrafficLightStateFunction = std::function<carla::rpc::TrafficLightState(ActorId)>;
+
   // 定义 WalkerManager 类用于管理行人及其路径
   class WalkerManager : private NonCopyable {
 
@@ -57,8 +68,8 @@ namespace nav {
     // 设置导航模块的函数
     void SetNav(Navigation *nav);
 
-    // 设置模拟器的引用，允许访问 API 函数
-    void SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator);
+    // 设置交通灯的数据来源，这样导航不依赖客户端也可以在服务器端运行
+    void SetTrafficLights(TrafficLightStopsFunction stops, TrafficLightStateFunction state);
 
     // 创建新的行人路线
     bool AddWalker(ActorId id);
@@ -85,21 +96,47 @@ namespace nav {
     // 返回导航对象
     Navigation *GetNavigation() { return _nav; };
 
-    // 返回影响特定位置的交通灯
-    SharedPtr<carla::client::TrafficLight> GetTrafficLightAffecting(carla::geom::Location UnrealPos, float max_distance = -1.0f);
+    // 返回影响特定位置的交通灯，没有时返回 0
+    ActorId GetTrafficLightAffecting(carla::geom::Location UnrealPos, float max_distance = -1.0f);
+
+    // 返回交通灯的当前状态
+    carla::rpc::TrafficLightState GetTrafficLightState(ActorId id) const;
 
     private:
 
-    // 获取所有交通灯的路径点
+    // 获取所有交通灯的路径点，并建立它们的网格索引
     void GetAllTrafficLightWaypoints();
 
+    // 网格单元的键
+    static uint64_t GetTrafficLightCell(int32_t x, int32_t y);
+
     // 执行特定事件的处理
     EventResult ExecuteEvent(ActorId id, WalkerInfo &info, double delta);
 
+    // 更新一个行人之后需要做的修改路线的操作
+    enum class WalkerUpdate {
+        None,
+        NextPoint,
+        NewRoute
+    };
+
+    // 更新一个行人的状态，只修改它自己的 WalkerInfo，可以并行调用
+    WalkerUpdate UpdateWalker(ActorId id, WalkerInfo &info, double delta);
+
     std::unordered_map<ActorId, WalkerInfo> _walkers;
-    std::vector<std::pair<SharedPtr<carla::client::TrafficLight>, carla::geom::Location>> _traffic_lights;
+    // Update 中使用，保留内存
+    std::vector<std::pair<ActorId, WalkerInfo *>> _update_walkers;
+    std::vector<WalkerUpdate> _update_results;
+    std::vector<TrafficLightStop> _traffic_lights;
+    // 交通灯停止位置的网格索引，值是 _traffic_lights 中的下标，这样查找影响
+    // 一个位置的交通灯时不需要遍历所有的交通灯
+    std::unordered_map<uint64_t, std::vector<size_t>> _traffic_light_grid;
+    int32_t _traffic_light_grid_min[2] { 0, 0 };
+    int32_t _traffic_light_grid_max[2] { 0, 0 };
+    bool _traffic_lights_loaded { false };
+    TrafficLightStopsFunction _get_traffic_light_stops;
+    TrafficLightStateFunction _get_traffic_light_state;
     Navigation *_nav { nullptr };
-    std::weak_ptr<carla::client::detail::Simulator> _simulator;
   };
 
 } // namespace nav
@@ -6,6 +6,7 @@
 
 #include "carla/opendrive/OpenDriveParser.h"
 
+#include "carla/ContentHash.h"
 #include "carla/Logging.h"
 #include "carla/opendrive/parser/ControllerParser.h"
 #include "carla/opendrive/parser/GeoReferenceParser.h"
@@ -21,19 +22,15 @@
 
 #include <pugixml/pugixml.hpp>
 
+#include <sstream>
+
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
-    pugi::xml_document xml;
-    pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());  // 使用 pugixml XML 处理工具加载OpenDrive文件
+namespace {
 
-    if (parse_result == false) {
-      log_error("unable to parse the OpenDRIVE XML string");
-      return {};
-    }
-// 创建MapBuilder对象，用于构建地图
-    carla::road::MapBuilder map_builder;
+  // 解析 OpenDRIVE 的各个部分并添加到 @a map_builder 中
+  void ParseAll(const pugi::xml_document &xml, road::MapBuilder &map_builder) {
  // 使用GeoReferenceParser解析器解析XML中的地理参考信息（如坐标系统），并将这些信息传递给map_builder对象以构建地图的地理基础  
     parser::GeoReferenceParser::Parse(xml, map_builder);
  // 使用RoadParser解析器解析XML中的道路信息（如道路形状、类型等）， 并将这些信息添加到map_builder对象中 
@@ -55,7 +52,52 @@ namespace opendrive {
   // 使用ControllerParser解析器解析XML中可能存在的控制器配置信息  ，并将这些信息添加到map_builder对象中  
     parser::ControllerParser::Parse(xml, map_builder);
 
-    return map_builder.Build();
+    // 记录每条道路的 <road> 元素的哈希，用于增量更新时比较两个版本的道路
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      std::ostringstream stream;
+      node_road.print(stream, "", pugi::format_raw);
+      const std::string source = stream.str();
+      map_builder.SetRoadSourceHash(
+          node_road.attribute("id").as_uint(),
+          ContentHash::ComputeValue(source.data(), source.size()));
+    }
+  }
+
+  bool LoadXml(const std::string &opendrive, pugi::xml_document &xml) {
+    pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());  // 使用 pugixml XML 处理工具加载OpenDrive文件
+    if (parse_result == false) {
+      log_error("unable to parse the OpenDRIVE XML string");
+      return false;
+    }
+    return true;
+  }
+
+} // namespace
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const uint8_t *rtree_data,
+      const size_t rtree_size) {
+    pugi::xml_document xml;
+    if (!LoadXml(opendrive, xml)) {
+      return {};
+    }
+// 创建MapBuilder对象，用于构建地图
+    carla::road::MapBuilder map_builder;
+    ParseAll(xml, map_builder);
+    return map_builder.Build(rtree_data, rtree_size);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::LoadUpdate(
+      const std::string &opendrive,
+      const road::Map &previous) {
+    pugi::xml_document xml;
+    if (!LoadXml(opendrive, xml)) {
+      return {};
+    }
+    carla::road::MapBuilder map_builder;
+    ParseAll(xml, map_builder);
+    return map_builder.Build(previous);
   }
 
 } // namespace opendrive
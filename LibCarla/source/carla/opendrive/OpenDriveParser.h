@@ -20,7 +20,17 @@ namespace opendrive {
 // 函数返回一个boost::optional<road::Map>类型的值 ， boost::optional是一个模板类，用于表示一个可能不存在的值  
 // 在这里，它表示可能成功解析并生成一个road::Map对象，也可能因为某些原因（如文件不存在、解析错误等）而失败  
 // road::Map是CARLA中定义的一个类，用于表示一个完整的道路网络地图  
-    static boost::optional<road::Map> Load(const std::string &opendrive);
+// @a rtree_data 不为空时使用 road::Map::SerializeRtree 生成的数据加载地图的R树，避免重新生成
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        const uint8_t *rtree_data = nullptr,
+        size_t rtree_size = 0u);
+
+// 解析 @a opendrive 作为地图 @a previous 的新版本，<road> 元素与 @a previous 中相同的道路
+// 重用其R树元素，只对新增和修改的道路重新采样。变化的道路见 road::Map::GetUpdate
+    static boost::optional<road::Map> LoadUpdate(
+        const std::string &opendrive,
+        const road::Map &previous);
   };
 
 } // namespace opendrive
@@ -0,0 +1,449 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/OpenDriveStitcher.h"
+
+#include "carla/Exception.h"
+#include "carla/geom/Math.h"
+#include "carla/road/element/Geometry.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace carla {
+namespace opendrive {
+
+namespace {
+
+  using IdMap = std::unordered_map<std::string, std::string>;
+
+  /// 为各图块中的 ID 分配新的、在合并结果中唯一的 ID
+  class IdAllocator {
+  public:
+
+    void Remap(pugi::xml_attribute attribute, IdMap &map) {
+      if (!attribute) {
+        return;
+      }
+      auto it = map.find(attribute.value());
+      if (it == map.end()) {
+        it = map.emplace(attribute.value(), std::to_string(_next++)).first;
+      }
+      attribute.set_value(it->second.c_str());
+    }
+
+  private:
+
+    uint64_t _next = 1u;
+  };
+
+  /// 一个图块中的 ID 到新 ID 的映射。道路和交叉口共用一个分配器，
+  /// 新的道路 ID 和交叉口 ID 也不会相同
+  struct TileIds {
+    IdMap roads;
+    IdMap junctions;
+    IdMap signals;
+    IdMap objects;
+    IdMap controllers;
+  };
+
+  struct Allocators {
+    IdAllocator elements;
+    IdAllocator signals;
+    IdAllocator objects;
+    IdAllocator controllers;
+  };
+
+  /// 没有连接的道路端点
+  struct RoadEnd {
+    size_t tile;
+    pugi::xml_node road;
+    bool at_start;
+    double x;
+    double y;
+    /// 离开道路的方向
+    double heading;
+    bool linked;
+  };
+
+  bool IsJunctionRoad(const pugi::xml_node &road) {
+    const char *junction = road.attribute("junction").value();
+    return junction[0] != '\0' && std::strcmp(junction, "-1") != 0;
+  }
+
+  void RemapRoad(pugi::xml_node road, TileIds &ids, Allocators &allocators) {
+    allocators.elements.Remap(road.attribute("id"), ids.roads);
+    if (IsJunctionRoad(road)) {
+      allocators.elements.Remap(road.attribute("junction"), ids.junctions);
+    }
+    for (pugi::xml_node link : road.child("link").children()) {
+      const bool is_junction = std::strcmp(link.attribute("elementType").value(), "junction") == 0;
+      allocators.elements.Remap(link.attribute("elementId"), is_junction ? ids.junctions : ids.roads);
+    }
+    for (pugi::xml_node signal : road.child("signals").children()) {
+      allocators.signals.Remap(signal.attribute("id"), ids.signals);
+      for (pugi::xml_node dependency : signal.children("dependency")) {
+        allocators.signals.Remap(dependency.attribute("id"), ids.signals);
+      }
+    }
+    for (pugi::xml_node object : road.child("objects").children()) {
+      allocators.objects.Remap(object.attribute("id"), ids.objects);
+    }
+  }
+
+  void RemapJunction(pugi::xml_node junction, TileIds &ids, Allocators &allocators) {
+    allocators.elements.Remap(junction.attribute("id"), ids.junctions);
+    for (pugi::xml_node connection : junction.children("connection")) {
+      allocators.elements.Remap(connection.attribute("incomingRoad"), ids.roads);
+      allocators.elements.Remap(connection.attribute("connectingRoad"), ids.roads);
+    }
+    for (pugi::xml_node priority : junction.children("priority")) {
+      allocators.elements.Remap(priority.attribute("high"), ids.roads);
+      allocators.elements.Remap(priority.attribute("low"), ids.roads);
+    }
+    for (pugi::xml_node controller : junction.children("controller")) {
+      allocators.controllers.Remap(controller.attribute("id"), ids.controllers);
+    }
+  }
+
+  void RemapController(pugi::xml_node controller, TileIds &ids, Allocators &allocators) {
+    allocators.controllers.Remap(controller.attribute("id"), ids.controllers);
+    for (pugi::xml_node control : controller.children("control")) {
+      allocators.signals.Remap(control.attribute("signalId"), ids.signals);
+    }
+  }
+
+  /// 计算 <geometry> 元素终点的位置和方向
+  void GetGeometryEnd(const pugi::xml_node &node, double &x, double &y, double &heading) {
+    using namespace road::element;
+    const double length = node.attribute("length").as_double();
+    x = node.attribute("x").as_double();
+    y = node.attribute("y").as_double();
+    heading = node.attribute("hdg").as_double();
+    if (!(length > 0.0)) {
+      return;
+    }
+    // 相对于起点计算，投影坐标很大，直接使用单精度的 Location 会损失精度
+    const geom::Location origin(0.0f, 0.0f, 0.0f);
+    std::unique_ptr<Geometry> geometry;
+    if (pugi::xml_node arc = node.child("arc")) {
+      const double curvature = arc.attribute("curvature").as_double();
+      if (std::fabs(curvature) > 1e-15) {
+        geometry = std::make_unique<GeometryArc>(0.0, length, heading, origin, curvature);
+      }
+    } else if (pugi::xml_node spiral = node.child("spiral")) {
+      geometry = std::make_unique<GeometrySpiral>(
+          0.0, length, heading, origin,
+          spiral.attribute("curvStart").as_double(),
+          spiral.attribute("curvEnd").as_double());
+    } else if (pugi::xml_node poly3 = node.child("poly3")) {
+      geometry = std::make_unique<GeometryPoly3>(
+          0.0, length, heading, origin,
+          poly3.attribute("a").as_double(),
+          poly3.attribute("b").as_double(),
+          poly3.attribute("c").as_double(),
+          poly3.attribute("d").as_double());
+    } else if (pugi::xml_node param_poly3 = node.child("paramPoly3")) {
+      geometry = std::make_unique<GeometryParamPoly3>(
+          0.0, length, heading, origin,
+          param_poly3.attribute("aU").as_double(),
+          param_poly3.attribute("bU").as_double(),
+          param_poly3.attribute("cU").as_double(),
+          param_poly3.attribute("dU").as_double(),
+          param_poly3.attribute("aV").as_double(),
+          param_poly3.attribute("bV").as_double(),
+          param_poly3.attribute("cV").as_double(),
+          param_poly3.attribute("dV").as_double(),
+          std::strcmp(param_poly3.attribute("pRange").value(), "arcLength") == 0);
+    }
+    if (geometry == nullptr) {
+      geometry = std::make_unique<GeometryLine>(0.0, length, heading, origin);
+    }
+    const DirectedPoint end = geometry->PosFromDist(length);
+    x += end.location.x;
+    y += end.location.y;
+    heading = end.tangent;
+  }
+
+  void AddRoadEnds(const size_t tile, pugi::xml_node road, std::vector<RoadEnd> &ends) {
+    if (IsJunctionRoad(road)) {
+      return;
+    }
+    pugi::xml_node plan_view = road.child("planView");
+    pugi::xml_node first = plan_view.child("geometry");
+    pugi::xml_node last = plan_view.last_child();
+    while (last && std::strcmp(last.name(), "geometry") != 0) {
+      last = last.previous_sibling();
+    }
+    if (!first || !last) {
+      return;
+    }
+    pugi::xml_node link = road.child("link");
+    if (!link.child("predecessor")) {
+      ends.push_back(RoadEnd{
+          tile,
+          road,
+          true,
+          first.attribute("x").as_double(),
+          first.attribute("y").as_double(),
+          first.attribute("hdg").as_double() + geom::Math::Pi<double>(),
+          false});
+    }
+    if (!link.child("successor")) {
+      RoadEnd end{tile, road, false, 0.0, 0.0, 0.0, false};
+      GetGeometryEnd(last, end.x, end.y, end.heading);
+      ends.push_back(end);
+    }
+  }
+
+  pugi::xml_node GetOrCreateFirstChild(pugi::xml_node parent, const char *name) {
+    pugi::xml_node child = parent.child(name);
+    return child ? child : parent.prepend_child(name);
+  }
+
+  /// predecessor 须位于 successor 之前
+  pugi::xml_node AddLinkElement(pugi::xml_node link, const bool at_start) {
+    return at_start ? link.prepend_child("predecessor") : link.append_child("successor");
+  }
+
+  pugi::xml_node GetLaneSection(const pugi::xml_node &road, const bool at_start) {
+    pugi::xml_node lanes = road.child("lanes");
+    if (at_start) {
+      return lanes.child("laneSection");
+    }
+    pugi::xml_node section = lanes.last_child();
+    while (section && std::strcmp(section.name(), "laneSection") != 0) {
+      section = section.previous_sibling();
+    }
+    return section;
+  }
+
+  /// 连接两条道路的道路和车道，@a a 和 @a b 分别位于连接点的两侧
+  void LinkRoads(const RoadEnd &a, const RoadEnd &b) {
+    pugi::xml_node link = AddLinkElement(GetOrCreateFirstChild(a.road, "link"), a.at_start);
+    link.append_attribute("elementType") = "road";
+    link.append_attribute("elementId") = b.road.attribute("id").value();
+    link.append_attribute("contactPoint") = b.at_start ? "start" : "end";
+
+    // 两条道路同向相接（一条的终点接另一条的起点）时车道 ID 相同，
+    // 相向相接时车道 ID 的符号相反
+    std::unordered_set<int> other_lanes;
+    const pugi::xml_node other_section = GetLaneSection(b.road, b.at_start);
+    for (const char *side : {"left", "right"}) {
+      for (pugi::xml_node lane : other_section.child(side).children("lane")) {
+        other_lanes.insert(lane.attribute("id").as_int());
+      }
+    }
+    const int sign = (a.at_start == b.at_start) ? -1 : 1;
+    const pugi::xml_node section = GetLaneSection(a.road, a.at_start);
+    for (const char *side : {"left", "right"}) {
+      for (pugi::xml_node lane : section.child(side).children("lane")) {
+        const int other = sign * lane.attribute("id").as_int();
+        if (other_lanes.count(other) > 0u) {
+          AddLinkElement(GetOrCreateFirstChild(lane, "link"), a.at_start).append_attribute("id") = other;
+        }
+      }
+    }
+  }
+
+  /// 连接不同图块中端点重合且方向相反的道路
+  void LinkRoadEnds(std::vector<RoadEnd> &ends, const double tolerance) {
+    const double cell_size = std::max(tolerance, 1e-3);
+    auto key = [](int64_t ix, int64_t iy) {
+      return (static_cast<uint64_t>(ix) << 32u) ^ static_cast<uint64_t>(static_cast<uint32_t>(iy));
+    };
+    std::unordered_multimap<uint64_t, size_t> grid;
+    for (size_t i = 0u; i < ends.size(); ++i) {
+      grid.emplace(
+          key(static_cast<int64_t>(std::floor(ends[i].x / cell_size)),
+              static_cast<int64_t>(std::floor(ends[i].y / cell_size))),
+          i);
+    }
+    // 离开方向的夹角大于 120 度
+    const double min_cos = -0.5;
+    for (size_t i = 0u; i < ends.size(); ++i) {
+      RoadEnd &end = ends[i];
+      if (end.linked) {
+        continue;
+      }
+      const auto ix = static_cast<int64_t>(std::floor(end.x / cell_size));
+      const auto iy = static_cast<int64_t>(std::floor(end.y / cell_size));
+      size_t best = ends.size();
+      double best_distance = tolerance;
+      for (int64_t dx = -1; dx <= 1; ++dx) {
+        for (int64_t dy = -1; dy <= 1; ++dy) {
+          auto range = grid.equal_range(key(ix + dx, iy + dy));
+          for (auto it = range.first; it != range.second; ++it) {
+            const RoadEnd &other = ends[it->second];
+            if (other.linked || other.tile == end.tile ||
+                std::cos(other.heading - end.heading) > min_cos) {
+              continue;
+            }
+            const double distance = std::hypot(other.x - end.x, other.y - end.y);
+            if (distance <= best_distance) {
+              best = it->second;
+              best_distance = distance;
+            }
+          }
+        }
+      }
+      if (best != ends.size()) {
+        RoadEnd &other = ends[best];
+        LinkRoads(end, other);
+        LinkRoads(other, end);
+        end.linked = true;
+        other.linked = true;
+      }
+    }
+  }
+
+  /// 平移全部道路的几何，使原点位于路网包围盒的中心
+  void CenterMap(pugi::xml_node root) {
+    double min_x = std::numeric_limits<double>::max();
+    double min_y = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    for (pugi::xml_node road : root.children("road")) {
+      for (pugi::xml_node geometry : road.child("planView").children("geometry")) {
+        double end_x, end_y, end_heading;
+        GetGeometryEnd(geometry, end_x, end_y, end_heading);
+        for (const double x : {geometry.attribute("x").as_double(), end_x}) {
+          min_x = std::min(min_x, x);
+          max_x = std::max(max_x, x);
+        }
+        for (const double y : {geometry.attribute("y").as_double(), end_y}) {
+          min_y = std::min(min_y, y);
+          max_y = std::max(max_y, y);
+        }
+      }
+    }
+    if (min_x > max_x) {
+      return;
+    }
+    const double center_x = 0.5 * (min_x + max_x);
+    const double center_y = 0.5 * (min_y + max_y);
+    for (pugi::xml_node road : root.children("road")) {
+      for (pugi::xml_node geometry : road.child("planView").children("geometry")) {
+        geometry.attribute("x") = geometry.attribute("x").as_double() - center_x;
+        geometry.attribute("y") = geometry.attribute("y").as_double() - center_y;
+      }
+    }
+    pugi::xml_node header = root.child("header");
+    for (const char *name : {"north", "south"}) {
+      if (pugi::xml_attribute attribute = header.attribute(name)) {
+        attribute = attribute.as_double() - center_y;
+      }
+    }
+    for (const char *name : {"east", "west"}) {
+      if (pugi::xml_attribute attribute = header.attribute(name)) {
+        attribute = attribute.as_double() - center_x;
+      }
+    }
+    // 平移后的坐标加上 offset 即为地理参考中的坐标
+    pugi::xml_node offset = header.child("offset");
+    if (!offset) {
+      offset = header.append_child("offset");
+      for (const char *name : {"x", "y", "z", "hdg"}) {
+        offset.append_attribute(name) = 0.0;
+      }
+    }
+    offset.attribute("x") = offset.attribute("x").as_double() + center_x;
+    offset.attribute("y") = offset.attribute("y").as_double() + center_y;
+  }
+
+  /// 合并各图块 header 中的包围盒
+  void MergeBounds(pugi::xml_node header, const pugi::xml_node &tile_header) {
+    auto merge = [&](const char *name, bool take_max) {
+      pugi::xml_attribute value = tile_header.attribute(name);
+      if (!value) {
+        return;
+      }
+      pugi::xml_attribute merged = header.attribute(name);
+      if (!merged) {
+        header.append_attribute(name) = value.value();
+      } else if (take_max ? value.as_double() > merged.as_double() : value.as_double() < merged.as_double()) {
+        merged = value.value();
+      }
+    };
+    merge("north", true);
+    merge("south", false);
+    merge("east", true);
+    merge("west", false);
+  }
+
+} // namespace
+
+  std::string OpenDriveStitcher::Stitch(
+      const std::vector<std::string> &tiles,
+      const double tolerance,
+      const bool center_map) {
+    std::vector<std::unique_ptr<pugi::xml_document>> documents;
+    for (size_t i = 0u; i < tiles.size(); ++i) {
+      documents.emplace_back(std::make_unique<pugi::xml_document>());
+      const auto result = documents[i]->load_string(tiles[i].c_str());
+      if (!result || !documents[i]->child("OpenDRIVE")) {
+        throw_exception(std::invalid_argument(
+            "unable to parse OpenDRIVE tile " + std::to_string(i) + ": " + result.description()));
+      }
+    }
+
+    pugi::xml_document output;
+    pugi::xml_node root = output.append_child("OpenDRIVE");
+    if (!documents.empty()) {
+      const pugi::xml_node first = documents.front()->child("OpenDRIVE");
+      for (pugi::xml_attribute attribute : first.attributes()) {
+        root.append_attribute(attribute.name()) = attribute.value();
+      }
+      pugi::xml_node header = root.append_copy(first.child("header"));
+      for (const auto &document : documents) {
+        MergeBounds(header, document->child("OpenDRIVE").child("header"));
+      }
+    }
+
+    // 按 OpenDRIVE 的元素顺序依次写入所有图块的道路、控制器和交叉口
+    std::vector<TileIds> ids(documents.size());
+    Allocators allocators;
+    std::vector<RoadEnd> ends;
+    for (size_t i = 0u; i < documents.size(); ++i) {
+      for (pugi::xml_node road : documents[i]->child("OpenDRIVE").children("road")) {
+        pugi::xml_node copy = root.append_copy(road);
+        RemapRoad(copy, ids[i], allocators);
+        AddRoadEnds(i, copy, ends);
+      }
+    }
+    for (size_t i = 0u; i < documents.size(); ++i) {
+      for (pugi::xml_node controller : documents[i]->child("OpenDRIVE").children("controller")) {
+        RemapController(root.append_copy(controller), ids[i], allocators);
+      }
+    }
+    for (size_t i = 0u; i < documents.size(); ++i) {
+      for (pugi::xml_node junction : documents[i]->child("OpenDRIVE").children("junction")) {
+        RemapJunction(root.append_copy(junction), ids[i], allocators);
+      }
+    }
+
+    LinkRoadEnds(ends, tolerance);
+    if (center_map) {
+      CenterMap(root);
+    }
+
+    std::ostringstream stream;
+    output.save(stream, "  ");
+    return stream.str();
+  }
+
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,34 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+
+  /// 把分块转换（见 OsmTileSplitter）得到的多个 OpenDRIVE 合并为一个。
+  class OpenDriveStitcher {
+  public:
+
+    /// 合并 @a tiles，各图块的坐标须在同一投影下（转换时不启用 center_map）。
+    ///
+    /// 道路、交叉口、信号、物体和控制器重新编号以避免冲突。一端没有连接的道路
+    /// 如果与另一个图块中同样没有连接的道路端点距离不超过 @a tolerance 米且方向
+    /// 相反，则互相连接，包括车道的连接。@a center_map 为 true 时平移全部几何，
+    /// 使原点位于路网的中心，平移量记录在 header 的 offset 中。
+    ///
+    /// 无法解析的图块会抛出 std::invalid_argument。
+    static std::string Stitch(
+        const std::vector<std::string> &tiles,
+        double tolerance = 1.0,
+        bool center_map = false);
+  };
+
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,141 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/OsmStreamReader.h"
+
+#include "carla/Exception.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <stdexcept>
+
+namespace carla {
+namespace opendrive {
+
+  static constexpr size_t READ_BUFFER_SIZE = 1u << 20u;
+
+  static bool EndsWith(const std::string &str, const char *suffix, const size_t size) {
+    return str.size() >= size && str.compare(str.size() - size, size, suffix) == 0;
+  }
+
+  /// 标记中的元素名称，例如 "<node id=..." 中的 "node"。
+  static std::string GetTagName(const std::string &markup) {
+    size_t begin = markup[1u] == '/' ? 2u : 1u;
+    size_t end = begin;
+    while (end < markup.size() &&
+           markup[end] != ' ' && markup[end] != '\t' && markup[end] != '\r' &&
+           markup[end] != '\n' && markup[end] != '/' && markup[end] != '>') {
+      ++end;
+    }
+    return markup.substr(begin, end - begin);
+  }
+
+  OsmStreamReader::OsmStreamReader(const std::string &path)
+    : _path(path),
+      _file(path, std::ios::binary),
+      _buffer(READ_BUFFER_SIZE) {
+    if (!_file.is_open()) {
+      throw_exception(std::runtime_error("unable to open OSM file " + path));
+    }
+  }
+
+  bool OsmStreamReader::FillBuffer() {
+    _file.read(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _position = 0u;
+    _end = static_cast<size_t>(_file.gcount());
+    return _end > 0u;
+  }
+
+  bool OsmStreamReader::ReadMarkup(std::string &markup) {
+    markup.assign(1u, '<');
+    char quote = '\0';
+    char c;
+    while (ReadChar(c)) {
+      markup.push_back(c);
+      if (markup.size() == 4u && markup.compare(0u, 4u, "<!--") == 0) {
+        // 注释中可以出现 '>' 和引号，一直读到 "-->"
+        while (ReadChar(c)) {
+          markup.push_back(c);
+          if (c == '>' && EndsWith(markup, "-->", 3u)) {
+            return true;
+          }
+        }
+        return false;
+      }
+      if (quote != '\0') {
+        if (c == quote) {
+          quote = '\0';
+        }
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == '>') {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool OsmStreamReader::Next(std::string &source) {
+    source.clear();
+    size_t depth = 0u;
+    char c;
+    while (ReadChar(c)) {
+      if (c != '<') {
+        // 元素之间的空白不需要保留
+        if (depth > 0u) {
+          source.push_back(c);
+        }
+        continue;
+      }
+      if (!ReadMarkup(_markup)) {
+        break;
+      }
+      if (_markup[1u] == '?' || _markup[1u] == '!') {
+        // XML 声明、注释和 DOCTYPE
+        continue;
+      }
+      if (_markup[1u] == '/') {
+        if (depth == 0u) {
+          // </osm>
+          return false;
+        }
+        source += _markup;
+        if (--depth == 0u) {
+          return true;
+        }
+        continue;
+      }
+      if (depth == 0u && GetTagName(_markup) == "osm") {
+        continue;
+      }
+      source += _markup;
+      if (!EndsWith(_markup, "/>", 2u)) {
+        ++depth;
+      } else if (depth == 0u) {
+        return true;
+      }
+    }
+    if (depth > 0u) {
+      throw_exception(std::runtime_error("unexpected end of OSM file " + _path));
+    }
+    return false;
+  }
+
+  bool OsmStreamReader::Next(pugi::xml_document &element) {
+    if (!Next(_source)) {
+      return false;
+    }
+    element.reset();
+    const auto result = element.load_buffer(_source.data(), _source.size());
+    if (!result) {
+      throw_exception(std::runtime_error(
+          "unable to parse OSM element in " + _path + ": " + result.description()));
+    }
+    return true;
+  }
+
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,70 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pugi {
+  class xml_document;
+} // namespace pugi
+
+namespace carla {
+namespace opendrive {
+
+  /// 逐个读取 .osm 文件中 <osm> 元素的子元素（node、way、relation 等）。
+  /// 不把整个文件解析为 DOM，内存占用只与单个元素的大小有关，适用于城市规模的
+  /// OpenStreetMap 数据。
+  class OsmStreamReader : private NonCopyable {
+  public:
+
+    /// 打开 @a path，无法打开时抛出 std::runtime_error。
+    explicit OsmStreamReader(const std::string &path);
+
+    /// 读取下一个元素的 XML 文本到 @a source 中，文件结束时返回 false。
+    /// 注释和处理指令会被跳过。
+    bool Next(std::string &source);
+
+    /// 读取下一个元素并解析到 @a element 中，该元素为文档的第一个子节点。
+    /// 文件结束时返回 false。
+    bool Next(pugi::xml_document &element);
+
+  private:
+
+    bool ReadChar(char &c) {
+      if (_position == _end && !FillBuffer()) {
+        return false;
+      }
+      c = _buffer[_position++];
+      return true;
+    }
+
+    bool FillBuffer();
+
+    /// 读取以 '<' 开始（'<' 已被读取）的标记，直到对应的 '>'。
+    bool ReadMarkup(std::string &markup);
+
+    const std::string _path;
+
+    std::ifstream _file;
+
+    std::vector<char> _buffer;
+
+    size_t _position = 0u;
+
+    size_t _end = 0u;
+
+    std::string _markup;
+
+    std::string _source;
+  };
+
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,429 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/OsmTileSplitter.h"
+
+#include "carla/Exception.h"
+#include "carla/geom/Math.h"
+#include "carla/opendrive/OsmStreamReader.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace carla {
+namespace opendrive {
+
+namespace {
+
+  /// 每度纬度对应的距离（米）
+  constexpr double METERS_PER_DEGREE = 111320.0;
+
+  /// 网格中图块数量的上限，防止 tile_size 过小时生成大量文件
+  constexpr size_t MAX_TILES = 1u << 16u;
+
+  /// 切断 way 时新建的节点和 way 的 ID 从这里开始递减，避开 OSM 的 ID 和编辑器
+  /// 中新对象使用的小的负 ID
+  constexpr int64_t SYNTHETIC_ID_BASE = -(int64_t(1) << 50u);
+
+  struct Node {
+    int64_t id;
+    double lat;
+    double lon;
+  };
+
+  struct Bounds {
+    double min_lat = std::numeric_limits<double>::max();
+    double min_lon = std::numeric_limits<double>::max();
+    double max_lat = std::numeric_limits<double>::lowest();
+    double max_lon = std::numeric_limits<double>::lowest();
+
+    void Extend(const double lat, const double lon) {
+      min_lat = std::min(min_lat, lat);
+      min_lon = std::min(min_lon, lon);
+      max_lat = std::max(max_lat, lat);
+      max_lon = std::max(max_lon, lon);
+    }
+
+    bool IsValid() const {
+      return min_lat <= max_lat && min_lon <= max_lon;
+    }
+  };
+
+  /// 覆盖地图包围盒的经纬度网格，行对应纬度，列对应经度
+  class TileGrid {
+  public:
+
+    TileGrid(const Bounds &bounds, const double tile_size) : _bounds(bounds) {
+      const double center_lat = 0.5 * (bounds.min_lat + bounds.max_lat);
+      const double cos_lat = std::max(std::cos(geom::Math::ToRadians(center_lat)), 0.01);
+      _lat_step = tile_size / METERS_PER_DEGREE;
+      _lon_step = tile_size / (METERS_PER_DEGREE * cos_lat);
+      const double rows = std::ceil((bounds.max_lat - bounds.min_lat) / _lat_step);
+      const double columns = std::ceil((bounds.max_lon - bounds.min_lon) / _lon_step);
+      if (rows * columns > static_cast<double>(MAX_TILES)) {
+        throw_exception(std::invalid_argument("OSM tile size too small for the map bounds"));
+      }
+      _rows = std::max(1u, static_cast<uint32_t>(rows));
+      _columns = std::max(1u, static_cast<uint32_t>(columns));
+    }
+
+    size_t size() const {
+      return static_cast<size_t>(_rows) * _columns;
+    }
+
+    uint32_t columns() const {
+      return _columns;
+    }
+
+    size_t GetCell(const Node &node) const {
+      const uint32_t row = GetIndex(node.lat - _bounds.min_lat, _lat_step, _rows);
+      const uint32_t column = GetIndex(node.lon - _bounds.min_lon, _lon_step, _columns);
+      return static_cast<size_t>(row) * _columns + column;
+    }
+
+    Bounds GetCellBounds(const size_t cell) const {
+      const auto row = static_cast<double>(cell / _columns);
+      const auto column = static_cast<double>(cell % _columns);
+      Bounds result;
+      result.min_lat = _bounds.min_lat + row * _lat_step;
+      result.min_lon = _bounds.min_lon + column * _lon_step;
+      result.max_lat = result.min_lat + _lat_step;
+      result.max_lon = result.min_lon + _lon_step;
+      return result;
+    }
+
+  private:
+
+    static uint32_t GetIndex(const double offset, const double step, const uint32_t count) {
+      const double index = std::floor(offset / step);
+      if (index <= 0.0) {
+        return 0u;
+      }
+      return std::min(count - 1u, static_cast<uint32_t>(std::min(index, 4294967295.0)));
+    }
+
+    Bounds _bounds;
+
+    double _lat_step;
+
+    double _lon_step;
+
+    uint32_t _rows;
+
+    uint32_t _columns;
+  };
+
+  /// 一个图块的内容，在读完整个文件后写出
+  struct TileContent {
+
+    /// 图块中道路使用的节点
+    std::vector<int64_t> nodes;
+
+    /// 在图块边界切断 way 时新建的节点
+    std::vector<Node> border_nodes;
+
+    std::string ways;
+
+    std::string relations;
+
+    size_t way_count = 0u;
+  };
+
+  std::string ToString(const pugi::xml_node &node) {
+    std::ostringstream stream;
+    node.print(stream, "", pugi::format_raw);
+    return stream.str();
+  }
+
+  bool HasTag(const pugi::xml_node &element, const char *key, const char *value = nullptr) {
+    for (pugi::xml_node tag : element.children("tag")) {
+      if (std::strcmp(tag.attribute("k").value(), key) == 0 &&
+          (value == nullptr || std::strcmp(tag.attribute("v").value(), value) == 0)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void WriteNode(std::ostream &out, const Node &node) {
+    char buffer[96];
+    std::snprintf(
+        buffer,
+        sizeof(buffer),
+        "<node id=\"%lld\" lat=\"%.7f\" lon=\"%.7f\"/>\n",
+        static_cast<long long>(node.id),
+        node.lat,
+        node.lon);
+    out << buffer;
+  }
+
+  class SplitState {
+  public:
+
+    SplitState(std::string output_folder, const double tile_size)
+      : _output_folder(std::move(output_folder)),
+        _tile_size(tile_size) {}
+
+    void Process(const pugi::xml_node &element) {
+      const char *name = element.name();
+      if (std::strcmp(name, "node") == 0) {
+        AddNode(element);
+      } else if (std::strcmp(name, "way") == 0) {
+        if (HasTag(element, "highway") && CreateGrid()) {
+          AddWay(element);
+        }
+      } else if (std::strcmp(name, "relation") == 0) {
+        if (HasTag(element, "type", "restriction") && CreateGrid()) {
+          AddRestriction(element);
+        }
+      } else if (std::strcmp(name, "bounds") == 0) {
+        _declared_bounds.Extend(element.attribute("minlat").as_double(), element.attribute("minlon").as_double());
+        _declared_bounds.Extend(element.attribute("maxlat").as_double(), element.attribute("maxlon").as_double());
+      }
+    }
+
+    std::vector<OsmTileSplitter::Tile> Finish();
+
+  private:
+
+    void AddNode(const pugi::xml_node &element) {
+      if (_grid != nullptr) {
+        throw_exception(std::runtime_error("OSM nodes must precede ways and relations"));
+      }
+      Node node;
+      node.id = element.attribute("id").as_llong();
+      node.lat = element.attribute("lat").as_double();
+      node.lon = element.attribute("lon").as_double();
+      _sorted = _sorted && (_nodes.empty() || _nodes.back().id < node.id);
+      _nodes.push_back(node);
+      _node_bounds.Extend(node.lat, node.lon);
+      _min_node_id = std::min(_min_node_id, node.id);
+      if (element.first_child()) {
+        // 只保留带标签的节点（信号灯、人行横道等）的原文，其余的由坐标重新生成
+        _tagged_nodes.emplace(node.id, ToString(element));
+      }
+    }
+
+    /// 在第一个 way 之前创建网格，此时所有节点均已读取
+    bool CreateGrid() {
+      if (_grid == nullptr) {
+        if (!_sorted) {
+          std::sort(_nodes.begin(), _nodes.end(), [](const Node &a, const Node &b) { return a.id < b.id; });
+          _sorted = true;
+        }
+        const Bounds &bounds = _declared_bounds.IsValid() ? _declared_bounds : _node_bounds;
+        if (!bounds.IsValid()) {
+          return false;
+        }
+        _grid = std::make_unique<TileGrid>(bounds, _tile_size);
+        _tiles.resize(_grid->size());
+        _next_node_id = std::min(_min_node_id, int64_t(0)) + SYNTHETIC_ID_BASE;
+      }
+      return true;
+    }
+
+    const Node *FindNode(const int64_t id) const {
+      auto it = std::lower_bound(_nodes.begin(), _nodes.end(), id, [](const Node &node, int64_t value) {
+        return node.id < value;
+      });
+      return (it != _nodes.end() && it->id == id) ? &*it : nullptr;
+    }
+
+    void AddWay(const pugi::xml_node &element) {
+      std::vector<const Node *> path;
+      for (pugi::xml_node nd : element.children("nd")) {
+        const Node *node = FindNode(nd.attribute("ref").as_llong());
+        if (node != nullptr) {
+          path.push_back(node);
+        }
+      }
+      if (path.size() < 2u) {
+        return;
+      }
+      std::string tags;
+      for (pugi::xml_node tag : element.children("tag")) {
+        tags += ToString(tag);
+      }
+      const int64_t way_id = element.attribute("id").as_llong();
+      std::vector<size_t> cells_with_way_id;
+      std::vector<int64_t> piece{path[0u]->id};
+      size_t cell = _grid->GetCell(*path[0u]);
+      for (size_t i = 1u; i < path.size(); ++i) {
+        const size_t next_cell = _grid->GetCell(*path[i]);
+        if (next_cell != cell) {
+          // 在越界线段的中点切断，切点是两侧道路的端点
+          const Node border{
+              _next_node_id--,
+              0.5 * (path[i - 1u]->lat + path[i]->lat),
+              0.5 * (path[i - 1u]->lon + path[i]->lon)};
+          _tiles[cell].border_nodes.push_back(border);
+          _tiles[next_cell].border_nodes.push_back(border);
+          piece.push_back(border.id);
+          AddPiece(cell, way_id, piece, tags, cells_with_way_id);
+          piece.assign(1u, border.id);
+          cell = next_cell;
+        }
+        piece.push_back(path[i]->id);
+      }
+      AddPiece(cell, way_id, piece, tags, cells_with_way_id);
+    }
+
+    void AddPiece(
+        const size_t cell,
+        int64_t way_id,
+        const std::vector<int64_t> &piece,
+        const std::string &tags,
+        std::vector<size_t> &cells_with_way_id) {
+      // 同一个 way 可能多次进入同一个图块，之后的部分使用新的 ID
+      if (std::find(cells_with_way_id.begin(), cells_with_way_id.end(), cell) != cells_with_way_id.end()) {
+        way_id = _next_way_id--;
+      } else {
+        cells_with_way_id.push_back(cell);
+      }
+      auto &tile = _tiles[cell];
+      tile.ways += "<way id=\"" + std::to_string(way_id) + "\">";
+      for (const int64_t id : piece) {
+        tile.ways += "<nd ref=\"" + std::to_string(id) + "\"/>";
+        if (id > SYNTHETIC_ID_BASE) {
+          tile.nodes.push_back(id);
+        }
+      }
+      tile.ways += tags;
+      tile.ways += "</way>\n";
+      ++tile.way_count;
+    }
+
+    /// 转向限制写入其途经节点所在的图块，途经节点所在的交叉口完整地位于该图块中
+    void AddRestriction(const pugi::xml_node &element) {
+      for (pugi::xml_node member : element.children("member")) {
+        if (std::strcmp(member.attribute("type").value(), "node") == 0 &&
+            std::strcmp(member.attribute("role").value(), "via") == 0) {
+          const Node *via = FindNode(member.attribute("ref").as_llong());
+          if (via != nullptr) {
+            _tiles[_grid->GetCell(*via)].relations += ToString(element) + "\n";
+          }
+          return;
+        }
+      }
+    }
+
+    std::string GetTilePath(const uint32_t row, const uint32_t column) const {
+      std::string path = _output_folder;
+      if (!path.empty() && path.back() != '/' && path.back() != '\\') {
+        path += '/';
+      }
+      return path + "tile_" + std::to_string(row) + "_" + std::to_string(column) + ".osm";
+    }
+
+    const std::string _output_folder;
+
+    const double _tile_size;
+
+    std::vector<Node> _nodes;
+
+    bool _sorted = true;
+
+    std::unordered_map<int64_t, std::string> _tagged_nodes;
+
+    Bounds _declared_bounds;
+
+    Bounds _node_bounds;
+
+    int64_t _min_node_id = 0;
+
+    int64_t _next_node_id = SYNTHETIC_ID_BASE;
+
+    int64_t _next_way_id = SYNTHETIC_ID_BASE;
+
+    std::unique_ptr<TileGrid> _grid;
+
+    std::vector<TileContent> _tiles;
+  };
+
+  std::vector<OsmTileSplitter::Tile> SplitState::Finish() {
+    std::vector<OsmTileSplitter::Tile> result;
+    for (size_t cell = 0u; cell < _tiles.size(); ++cell) {
+      TileContent content;
+      std::swap(content, _tiles[cell]);
+      if (content.way_count == 0u) {
+        continue;
+      }
+      OsmTileSplitter::Tile tile;
+      tile.row = static_cast<uint32_t>(cell / _grid->columns());
+      tile.column = static_cast<uint32_t>(cell % _grid->columns());
+      tile.path = GetTilePath(tile.row, tile.column);
+      tile.ways = content.way_count;
+
+      std::ofstream out(tile.path, std::ios::binary | std::ios::trunc);
+      if (!out.is_open()) {
+        throw_exception(std::runtime_error("unable to write OSM tile " + tile.path));
+      }
+      const Bounds bounds = _grid->GetCellBounds(cell);
+      char buffer[160];
+      std::snprintf(
+          buffer,
+          sizeof(buffer),
+          "<bounds minlat=\"%.7f\" minlon=\"%.7f\" maxlat=\"%.7f\" maxlon=\"%.7f\"/>\n",
+          bounds.min_lat,
+          bounds.min_lon,
+          bounds.max_lat,
+          bounds.max_lon);
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+          << "<osm version=\"0.6\" generator=\"carla\">\n"
+          << buffer;
+
+      std::sort(content.nodes.begin(), content.nodes.end());
+      content.nodes.erase(std::unique(content.nodes.begin(), content.nodes.end()), content.nodes.end());
+      for (const int64_t id : content.nodes) {
+        auto tagged = _tagged_nodes.find(id);
+        if (tagged != _tagged_nodes.end()) {
+          out << tagged->second << '\n';
+        } else {
+          WriteNode(out, *FindNode(id));
+        }
+      }
+      for (const Node &node : content.border_nodes) {
+        WriteNode(out, node);
+      }
+      out << content.ways << content.relations << "</osm>\n";
+      if (!out.good()) {
+        throw_exception(std::runtime_error("unable to write OSM tile " + tile.path));
+      }
+      result.push_back(std::move(tile));
+    }
+    return result;
+  }
+
+} // namespace
+
+  std::vector<OsmTileSplitter::Tile> OsmTileSplitter::Split(
+      const std::string &osm_path,
+      const std::string &output_folder,
+      const double tile_size) {
+    if (!(tile_size > 0.0)) {
+      throw_exception(std::invalid_argument("OSM tile size must be positive"));
+    }
+    OsmStreamReader reader(osm_path);
+    SplitState state(output_folder, tile_size);
+    pugi::xml_document element;
+    while (reader.Next(element)) {
+      state.Process(element.first_child());
+    }
+    return state.Finish();
+  }
+
+} // namespace opendrive
+} // namespace carla
@@ -0,0 +1,48 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+
+  /// 把大的 .osm 文件划分为可以分别（并行）转换为 OpenDRIVE 的图块。
+  class OsmTileSplitter {
+  public:
+
+    struct Tile {
+
+      /// 图块的 .osm 文件
+      std::string path;
+
+      uint32_t row = 0u;
+
+      uint32_t column = 0u;
+
+      /// 图块中的 way 数量
+      size_t ways = 0u;
+    };
+
+    /// 以流的方式读取 @a osm_path，按边长约为 @a tile_size 米的经纬度网格划分，
+    /// 每个含有道路的图块写入 @a output_folder（须已存在）中的一个 .osm 文件。
+    ///
+    /// 每个节点属于其所在的图块，因此交叉口总是完整地出现在一个图块中。跨越图块
+    /// 边界的 way 在越界线段的中点处切断，切点同时写入两侧的图块，转换后由
+    /// OpenDriveStitcher 重新连接。只保留带 highway 标签的 way 和转向限制，
+    /// 节点须位于 way 之前（.osm 文件的标准顺序）。
+    static std::vector<Tile> Split(
+        const std::string &osm_path,
+        const std::string &output_folder,
+        double tile_size);
+  };
+
+} // namespace opendrive
+} // namespace carla
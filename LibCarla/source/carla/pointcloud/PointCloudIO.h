@@ -6,11 +6,17 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/FileSystem.h"
+#include "carla/NpyIO.h"
+#include "carla/StringUtil.h"
 
+#include <cstring>
 #include <fstream>
 #include <iterator>
 #include <iomanip>
+#include <sstream>
+#include <type_traits>
 
 namespace carla {// 定义命名空间carla，用于组织相关的代码和数据
 namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于点云处理的代码
@@ -30,29 +36,158 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
       }
     }
 
+    /// 二进制输出的格式。
+    enum class BinaryFormat {
+      /// 本机字节序的二进制 PLY。
+      Ply,
+      /// PCD 0.7 的 "DATA binary"。
+      Pcd,
+      /// 形状为 (N,) 的 NumPy 结构化数组，字段由点类型的 GetNpyDescription
+      /// 给出。
+      Npy
+    };
+
+    /// 以二进制格式写入，每个点按其内存布局原样写入，属性的顺序与
+    /// WritePlyHeaderInfo 相同。比文本格式小得多，写入也快得多；点连续存放时
+    /// （如 sensor::data::Array 的迭代器）所有的点只需一次写入。
+    template <typename PointIt>
+    static void DumpBinary(
+        std::ostream &out,
+        PointIt begin,
+        PointIt end,
+        BinaryFormat format = BinaryFormat::Ply) {
+      const auto header = MakeBinaryHeader(format, begin, end);
+      out.write(header.data(), static_cast<std::streamsize>(header.size()));
+      WritePoints(begin, end, [&](const char *data, size_t size) {
+        out.write(data, static_cast<std::streamsize>(size));
+      });
+    }
+
     template <typename PointIt>
-    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
+    static void DumpNpy(std::ostream &out, PointIt begin, PointIt end) {
+      DumpBinary(out, begin, end, BinaryFormat::Npy);
+    }
+
+    /// DumpBinary 写入的字节数，用于预先分配输出，如内存映射的文件。
+    template <typename PointIt>
+    static size_t GetBinarySize(BinaryFormat format, PointIt begin, PointIt end) {
+      using point_type = typename std::iterator_traits<PointIt>::value_type;
+      return MakeBinaryHeader(format, begin, end).size() +
+          static_cast<size_t>(std::distance(begin, end)) * sizeof(point_type);
+    }
+
+    /// 与 DumpBinary 相同，但写入到 @a destination 指向的内存中，其大小至少为
+    /// GetBinarySize 的结果。返回写入的字节数。
+    template <typename PointIt>
+    static size_t WriteBinary(
+        BinaryFormat format,
+        PointIt begin,
+        PointIt end,
+        unsigned char *destination) {
+      DEBUG_ASSERT(destination != nullptr);
+      const auto header = MakeBinaryHeader(format, begin, end);
+      std::memcpy(destination, header.data(), header.size());
+      size_t offset = header.size();
+      WritePoints(begin, end, [&](const char *data, size_t size) {
+        std::memcpy(destination + offset, data, size);
+        offset += size;
+      });
+      return offset;
+    }
+
+    /// 保存点云。扩展名为 ".npy" 时保存为 NumPy 数组，为 ".pcd" 时保存为二进制
+    /// PCD 文件，否则保存为 PLY 文件，@a binary 为 true 时使用二进制 PLY 格式。
+    template <typename PointIt>
+    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end, bool binary = false) {
       // 验证文件路径是否以".ply"结尾，确保文件类型为PLY 
       FileSystem::ValidateFilePath(path, ".ply");
-      // 创建输出文件流对象，并打开文件
-      std::ofstream out(path);
-      // 调用Dump函数，将点云数据写入到文件中
-      Dump(out, begin, end);
+      if (StringUtil::EndsWith(path, ".npy")) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, begin, end, BinaryFormat::Npy);
+      } else if (StringUtil::EndsWith(path, ".pcd")) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, begin, end, BinaryFormat::Pcd);
+      } else if (binary) {
+        std::ofstream out(path, std::ios::binary);
+        DumpBinary(out, begin, end, BinaryFormat::Ply);
+      } else {
+        // 创建输出文件流对象，并打开文件
+        std::ofstream out(path);
+        // 调用Dump函数，将点云数据写入到文件中
+        Dump(out, begin, end);
+      }
        // 返回文件路径
       return path;
     }
 
   private:
-    template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
+
+    template <typename PointIt>
+    static std::string MakeBinaryHeader(BinaryFormat format, PointIt begin, PointIt end) {
+      using point_type = typename std::iterator_traits<PointIt>::value_type;
+      static_assert(std::is_trivially_copyable<point_type>::value, "Invalid point type.");
+      DEBUG_ASSERT(std::distance(begin, end) >= 0);
+      const auto size = static_cast<size_t>(std::distance(begin, end));
+      std::ostringstream out;
+      switch (format) {
+        case BinaryFormat::Ply:
+          WriteHeader(out, begin, end, (NpyIO::GetByteOrder() == '<') ?
+              "binary_little_endian 1.0" :
+              "binary_big_endian 1.0");
+          break;
+        case BinaryFormat::Pcd:
+          // PCD 的二进制数据使用本机字节序。
+          out << "# .PCD v0.7 - Point Cloud Data file format\n"
+                 "VERSION 0.7\n";
+          point_type().WritePcdHeaderInfo(out);
+          out << "\nWIDTH " << size << "\n"
+                 "HEIGHT 1\n"
+                 "VIEWPOINT 0 0 0 1 0 0 0\n"
+                 "POINTS " << size << "\n"
+                 "DATA binary\n";
+          break;
+        case BinaryFormat::Npy:
+          NpyIO::WriteHeader(out, point_type::GetNpyDescription(), {size});
+          break;
+      }
+      return out.str();
+    }
+
+    /// 把点的原始字节交给 @a write，连续存放的点只调用一次。
+    template <typename PointIt, typename WriteFunctor>
+    static void WritePoints(PointIt begin, PointIt end, WriteFunctor &&write) {
+      WritePoints(begin, end, write, std::is_pointer<PointIt>{});
+    }
+
+    template <typename PointIt, typename WriteFunctor>
+    static void WritePoints(PointIt begin, PointIt end, WriteFunctor &write, std::true_type) {
+      using point_type = typename std::iterator_traits<PointIt>::value_type;
+      if (begin != end) {
+        write(reinterpret_cast<const char *>(begin),
+              static_cast<size_t>(std::distance(begin, end)) * sizeof(point_type));
+      }
+    }
+
+    template <typename PointIt, typename WriteFunctor>
+    static void WritePoints(PointIt begin, PointIt end, WriteFunctor &write, std::false_type) {
+      using point_type = typename std::iterator_traits<PointIt>::value_type;
+      for (; begin != end; ++begin) {
+        write(reinterpret_cast<const char *>(&*begin), sizeof(point_type));
+      }
+    }
+    template <typename PointIt>
+    static void WriteHeader(std::ostream &out, PointIt begin, PointIt end, const char *format = "ascii 1.0") {
+      using point_type = typename std::iterator_traits<PointIt>::value_type;
       // 断言确保点云数据的数量非负
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
       // 写入PLY文件的基本头部信息
       out << "ply\n"
-           "format ascii 1.0\n"
+           "format " << format << "\n"
            // 写入元素(vertex)的数量，即点云中的点数
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
-      // 假设每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息      
-      begin->WritePlyHeaderInfo(out);
+      // 每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息，点云为空
+      // 时也不能解引用 begin
+      point_type().WritePlyHeaderInfo(out);
       // 写入PLY文件头部的结束标志
       out << "\nend_header\n";
       // 设置输出流的格式，固定小数点后4位 
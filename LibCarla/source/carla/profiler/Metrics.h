@@ -0,0 +1,404 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace profiler {
+
+  /// 指标的标签，按给出的顺序输出。
+  using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+  /// 只增不减的计数。
+  class Counter : private NonCopyable {
+  public:
+
+    void Increment(uint64_t value = 1u) {
+      _value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Get() const {
+      return _value.load(std::memory_order_relaxed);
+    }
+
+  private:
+
+    std::atomic<uint64_t> _value{0u};
+  };
+
+  /// 可以任意设置的数值。
+  class Gauge : private NonCopyable {
+  public:
+
+    void Set(double value) {
+      _value.store(value, std::memory_order_relaxed);
+    }
+
+    void Add(double value) {
+      double current = _value.load(std::memory_order_relaxed);
+      while (!_value.compare_exchange_weak(current, current + value, std::memory_order_relaxed));
+    }
+
+    double Get() const {
+      return _value.load(std::memory_order_relaxed);
+    }
+
+  private:
+
+    std::atomic<double> _value{0.0};
+  };
+
+  /// 按固定上界分桶的分布，记录一次只需要几次原子加法。
+  class Histogram : private NonCopyable {
+  public:
+
+    /// 10 微秒到 10 秒的时长，单位为秒。
+    static std::vector<double> DefaultDurationBuckets() {
+      return {1e-5, 5e-5, 1e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 10.0};
+    }
+
+    /// @a upper_bounds 必须递增，最后还有一个不设上界的桶。
+    explicit Histogram(std::vector<double> upper_bounds)
+      : _upper_bounds(std::move(upper_bounds)),
+        _counts(new std::atomic<uint64_t>[_upper_bounds.size() + 1u]) {
+      for (size_t i = 0u; i <= _upper_bounds.size(); ++i) {
+        _counts[i].store(0u, std::memory_order_relaxed);
+      }
+    }
+
+    void Observe(double value) {
+      const auto bucket = static_cast<size_t>(
+          std::lower_bound(_upper_bounds.begin(), _upper_bounds.end(), value) - _upper_bounds.begin());
+      _counts[bucket].fetch_add(1u, std::memory_order_relaxed);
+      double sum = _sum.load(std::memory_order_relaxed);
+      while (!_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed));
+    }
+
+    const std::vector<double> &GetUpperBounds() const {
+      return _upper_bounds;
+    }
+
+    /// 第 @a index 个桶（不累计）中的次数，最后一个桶不设上界。
+    uint64_t GetBucketCount(size_t index) const {
+      return _counts[index].load(std::memory_order_relaxed);
+    }
+
+    double GetSum() const {
+      return _sum.load(std::memory_order_relaxed);
+    }
+
+  private:
+
+    const std::vector<double> _upper_bounds;
+
+    const std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+
+    std::atomic<double> _sum{0.0};
+  };
+
+  /// 在作用域结束时把经过的秒数记录到直方图中，直方图为空时什么也不做。
+  class ScopedHistogramTimer : private NonCopyable {
+  public:
+
+    explicit ScopedHistogramTimer(Histogram *histogram)
+      : _histogram(histogram),
+        _begin(std::chrono::steady_clock::now()) {}
+
+    ~ScopedHistogramTimer() {
+      if (_histogram != nullptr) {
+        _histogram->Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - _begin).count());
+      }
+    }
+
+  private:
+
+    Histogram *_histogram;
+
+    std::chrono::steady_clock::time_point _begin;
+  };
+
+  /// 把相邻两次 Lap 之间经过的秒数记录到直方图中，用于依次执行的多个阶段。
+  class LapTimer {
+  public:
+
+    LapTimer() : _last(std::chrono::steady_clock::now()) {}
+
+    void Lap(Histogram *histogram) {
+      const auto now = std::chrono::steady_clock::now();
+      if (histogram != nullptr) {
+        histogram->Observe(std::chrono::duration<double>(now - _last).count());
+      }
+      _last = now;
+    }
+
+  private:
+
+    std::chrono::steady_clock::time_point _last;
+  };
+
+  /// 进程中所有指标的注册表，以 Prometheus 文本格式导出。
+  ///
+  /// 指标由使用它的对象通过 shared_ptr 持有，注册表只保留弱引用，对象（例如
+  /// 传感器的流）销毁后其指标不再导出。相同名称与标签的指标在仍存在时是同一个
+  /// 对象。注册在互斥量下进行，更新指标不加锁，应在热路径之外获取并保存指标。
+  class MetricsRegistry : private NonCopyable {
+  public:
+
+    /// 把采样值写入导出结果，用于在导出时才读取的数值（例如缓冲池的统计）。
+    class Writer {
+    public:
+
+      void AddCounter(const std::string &name, const std::string &help, const MetricLabels &labels, double value) {
+        Add(name, help, "counter", labels, value);
+      }
+
+      void AddGauge(const std::string &name, const std::string &help, const MetricLabels &labels, double value) {
+        Add(name, help, "gauge", labels, value);
+      }
+
+    private:
+
+      friend class MetricsRegistry;
+
+      struct Family {
+        std::string help;
+        std::string type;
+        std::vector<std::string> samples;
+      };
+
+      void Add(
+          const std::string &name,
+          const std::string &help,
+          const char *type,
+          const MetricLabels &labels,
+          double value,
+          const std::string &suffix = "",
+          const MetricLabels &extra_labels = {}) {
+        auto &family = _families[name];
+        if (family.type.empty()) {
+          family.help = help;
+          family.type = type;
+        }
+        std::ostringstream sample;
+        sample << name << suffix;
+        WriteLabels(sample, labels, extra_labels);
+        sample << ' ' << FormatValue(value);
+        family.samples.emplace_back(sample.str());
+      }
+
+      static void WriteLabels(std::ostream &out, const MetricLabels &labels, const MetricLabels &extra_labels) {
+        if (labels.empty() && extra_labels.empty()) {
+          return;
+        }
+        out << '{';
+        bool first = true;
+        for (const auto *list : {&labels, &extra_labels}) {
+          for (const auto &label : *list) {
+            out << (first ? "" : ",") << label.first << "=\"";
+            for (const char c : label.second) {
+              if ((c == '\\') || (c == '"')) {
+                out << '\\' << c;
+              } else if (c == '\n') {
+                out << "\\n";
+              } else {
+                out << c;
+              }
+            }
+            out << '"';
+            first = false;
+          }
+        }
+        out << '}';
+      }
+
+      static std::string FormatValue(double value) {
+        if (value == std::numeric_limits<double>::infinity()) {
+          return "+Inf";
+        }
+        std::ostringstream out;
+        out.precision(std::numeric_limits<double>::digits10);
+        out << value;
+        return out.str();
+      }
+
+      std::map<std::string, Family> _families;
+    };
+
+    using Collector = std::function<void(Writer &)>;
+
+    /// 进程共用的注册表。
+    static MetricsRegistry &Get() {
+      // 不销毁，静态对象析构时可能仍有线程在更新指标
+      static MetricsRegistry *registry = new MetricsRegistry;
+      return *registry;
+    }
+
+    std::shared_ptr<Counter> GetCounter(
+        const std::string &name,
+        const std::string &help,
+        const MetricLabels &labels = {}) {
+      return GetOrCreate(_counters, name, help, labels, []() { return std::make_shared<Counter>(); });
+    }
+
+    std::shared_ptr<Gauge> GetGauge(
+        const std::string &name,
+        const std::string &help,
+        const MetricLabels &labels = {}) {
+      return GetOrCreate(_gauges, name, help, labels, []() { return std::make_shared<Gauge>(); });
+    }
+
+    std::shared_ptr<Histogram> GetHistogram(
+        const std::string &name,
+        const std::string &help,
+        const MetricLabels &labels = {},
+        std::vector<double> upper_bounds = Histogram::DefaultDurationBuckets()) {
+      return GetOrCreate(_histograms, name, help, labels, [&]() {
+        return std::make_shared<Histogram>(std::move(upper_bounds));
+      });
+    }
+
+    /// 每次导出时调用 @a collector，直到返回的对象被销毁。
+    std::shared_ptr<const Collector> AddCollector(Collector collector) {
+      auto result = std::make_shared<const Collector>(std::move(collector));
+      std::lock_guard<std::mutex> lock(_mutex);
+      Prune(_collectors);
+      _collectors.emplace_back(result);
+      return result;
+    }
+
+    /// 以 Prometheus 文本格式（0.0.4）导出所有仍存在的指标。
+    std::string ExportPrometheus() {
+      Writer writer;
+      std::vector<std::shared_ptr<const Collector>> collectors;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto &entry : _counters) {
+          if (auto counter = entry.metric.lock()) {
+            writer.Add(entry.name, entry.help, "counter", entry.labels, static_cast<double>(counter->Get()));
+          }
+        }
+        for (const auto &entry : _gauges) {
+          if (auto gauge = entry.metric.lock()) {
+            writer.Add(entry.name, entry.help, "gauge", entry.labels, gauge->Get());
+          }
+        }
+        for (const auto &entry : _histograms) {
+          if (auto histogram = entry.metric.lock()) {
+            WriteHistogram(writer, entry, *histogram);
+          }
+        }
+        for (const auto &collector : _collectors) {
+          if (auto pointer = collector.lock()) {
+            collectors.emplace_back(std::move(pointer));
+          }
+        }
+      }
+      // 在锁外调用收集函数，它们可能需要获取指标
+      for (const auto &collector : collectors) {
+        (*collector)(writer);
+      }
+      std::ostringstream out;
+      for (const auto &family : writer._families) {
+        out << "# HELP " << family.first << ' ' << family.second.help << '\n';
+        out << "# TYPE " << family.first << ' ' << family.second.type << '\n';
+        for (const auto &sample : family.second.samples) {
+          out << sample << '\n';
+        }
+      }
+      return out.str();
+    }
+
+  private:
+
+    template <typename T>
+    struct Entry {
+      std::string name;
+      std::string help;
+      MetricLabels labels;
+      std::weak_ptr<T> metric;
+    };
+
+    template <typename T>
+    static void Prune(std::vector<T> &entries) {
+      entries.erase(std::remove_if(entries.begin(), entries.end(), [](const T &entry) {
+        return Expired(entry);
+      }), entries.end());
+    }
+
+    template <typename T>
+    static bool Expired(const Entry<T> &entry) {
+      return entry.metric.expired();
+    }
+
+    template <typename T>
+    static bool Expired(const std::weak_ptr<T> &pointer) {
+      return pointer.expired();
+    }
+
+    template <typename T, typename FactoryT>
+    std::shared_ptr<T> GetOrCreate(
+        std::vector<Entry<T>> &entries,
+        const std::string &name,
+        const std::string &help,
+        const MetricLabels &labels,
+        FactoryT &&factory) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Prune(entries);
+      for (const auto &entry : entries) {
+        if ((entry.name == name) && (entry.labels == labels)) {
+          if (auto metric = entry.metric.lock()) {
+            return metric;
+          }
+        }
+      }
+      auto metric = factory();
+      entries.emplace_back(Entry<T>{name, help, labels, metric});
+      return metric;
+    }
+
+    static void WriteHistogram(Writer &writer, const Entry<Histogram> &entry, const Histogram &histogram) {
+      const auto &bounds = histogram.GetUpperBounds();
+      uint64_t cumulative = 0u;
+      for (size_t i = 0u; i <= bounds.size(); ++i) {
+        cumulative += histogram.GetBucketCount(i);
+        const double bound = (i < bounds.size()) ? bounds[i] : std::numeric_limits<double>::infinity();
+        writer.Add(
+            entry.name, entry.help, "histogram", entry.labels, static_cast<double>(cumulative),
+            "_bucket", {{"le", Writer::FormatValue(bound)}});
+      }
+      writer.Add(entry.name, entry.help, "histogram", entry.labels, histogram.GetSum(), "_sum");
+      writer.Add(entry.name, entry.help, "histogram", entry.labels, static_cast<double>(cumulative), "_count");
+    }
+
+    std::mutex _mutex;
+
+    std::vector<Entry<Counter>> _counters;
+
+    std::vector<Entry<Gauge>> _gauges;
+
+    std::vector<Entry<Histogram>> _histograms;
+
+    std::vector<std::weak_ptr<const Collector>> _collectors;
+  };
+
+} // namespace profiler
+} // namespace carla
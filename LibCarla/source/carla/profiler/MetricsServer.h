@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/Metrics.h"
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace carla {
+namespace profiler {
+
+  /// 提供 Prometheus 拉取接口的最小 HTTP 服务器，GET /metrics 返回
+  /// MetricsRegistry 的导出结果，其它路径返回 404。
+  ///
+  /// 在自己的线程中依次处理请求，导出只在请求到来时进行，不影响热路径。
+  class MetricsServer : private NonCopyable {
+  public:
+
+    /// 监听 @a port，为 0 时由系统选择端口。
+    explicit MetricsServer(uint16_t port, MetricsRegistry &registry = MetricsRegistry::Get())
+      : _registry(registry),
+        _acceptor(_io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)) {
+      Accept();
+      _thread = std::thread([this]() { _io_context.run(); });
+    }
+
+    ~MetricsServer() {
+      _io_context.stop();
+      _thread.join();
+    }
+
+    uint16_t GetPort() const {
+      return _acceptor.local_endpoint().port();
+    }
+
+  private:
+
+    struct Connection {
+      explicit Connection(boost::asio::io_context &io_context) : socket(io_context) {}
+
+      boost::asio::ip::tcp::socket socket;
+
+      boost::asio::streambuf request;
+
+      std::string response;
+    };
+
+    void Accept() {
+      auto connection = std::make_shared<Connection>(_io_context);
+      _acceptor.async_accept(connection->socket, [this, connection](const boost::system::error_code &ec) {
+        if (ec == boost::asio::error::operation_aborted) {
+          return;
+        }
+        if (!ec) {
+          Read(connection);
+        } else {
+          log_debug("metrics server: accept failed:", ec.message());
+        }
+        Accept();
+      });
+    }
+
+    void Read(std::shared_ptr<Connection> connection) {
+      boost::asio::async_read_until(
+          connection->socket,
+          connection->request,
+          "\r\n\r\n",
+          [this, connection](const boost::system::error_code &ec, size_t) {
+        if (ec) {
+          return;
+        }
+        std::istream stream(&connection->request);
+        std::string method;
+        std::string path;
+        stream >> method >> path;
+        const bool found = (method == "GET") && ((path == "/metrics") || (path.rfind("/metrics?", 0u) == 0u));
+        const std::string body = found ? _registry.ExportPrometheus() : std::string("not found\n");
+        connection->response =
+            std::string(found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n") +
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+        boost::asio::async_write(
+            connection->socket,
+            boost::asio::buffer(connection->response),
+            [connection](const boost::system::error_code &, size_t) {
+          boost::system::error_code ignored;
+          connection->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+        });
+      });
+    }
+
+    MetricsRegistry &_registry;
+
+    boost::asio::io_context _io_context;
+
+    boost::asio::ip::tcp::acceptor _acceptor;
+
+    std::thread _thread;
+  };
+
+} // namespace profiler
+} // namespace carla
@@ -7,7 +7,9 @@
 #pragma once // 防止头文件重复包含
 
 #ifndef LIBCARLA_ENABLE_PROFILER // 如果没有启用性能分析器
-#  define CARLA_PROFILE_SCOPE(context, profiler_name) // 定义宏，空操作
+#  include "carla/profiler/TraceProfiler.h"
+// 作用域由一直编译的 TraceProfiler 记录，运行时用 TraceProfiler::SetEnabled 开启
+#  define CARLA_PROFILE_SCOPE(context, profiler_name) CARLA_TRACE_SCOPE(context, profiler_name)
 #  define CARLA_PROFILE_FPS(context, profiler_name) // 定义宏，空操作
 #else
 
@@ -0,0 +1,476 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#  define LIBCARLA_TRACE_PROFILER_USE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define LIBCARLA_TRACE_PROFILER_USE_TSC
+#endif
+
+namespace carla {
+namespace profiler {
+namespace detail {
+
+  /// 一次作用域的执行。@a name 指向静态存储的字符串（通常是字符串字面量），
+  /// 时间为 TraceProfiler::Now() 的时钟周期。
+  struct TraceEvent {
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t depth;
+  };
+
+  /// 单个线程的事件环形缓冲区，生产者为该线程，消费者为持有 TraceProfiler 的
+  /// 锁的收集者，两者之间没有锁。缓冲区满时新的事件被丢弃并计数。
+  class TraceBuffer : private NonCopyable {
+  public:
+
+    static constexpr size_t Capacity = 1u << 12u;
+
+    explicit TraceBuffer(uint32_t thread_id) : _thread_id(thread_id) {}
+
+    uint32_t GetThreadId() const {
+      return _thread_id;
+    }
+
+    void Push(const TraceEvent &event) {
+      const uint64_t head = _head.load(std::memory_order_relaxed);
+      if (head - _tail.load(std::memory_order_acquire) >= Capacity) {
+        _dropped.fetch_add(1u, std::memory_order_relaxed);
+        return;
+      }
+      _events[head & (Capacity - 1u)] = event;
+      _head.store(head + 1u, std::memory_order_release);
+    }
+
+    /// 对缓冲区中的每个事件调用 @a functor 并清空缓冲区，只能由一个消费者调用。
+    template <typename FunctorT>
+    void Drain(FunctorT &&functor) {
+      const uint64_t tail = _tail.load(std::memory_order_relaxed);
+      const uint64_t head = _head.load(std::memory_order_acquire);
+      for (uint64_t i = tail; i < head; ++i) {
+        functor(_events[i & (Capacity - 1u)]);
+      }
+      _tail.store(head, std::memory_order_release);
+    }
+
+    uint64_t ExchangeDropped() {
+      return _dropped.exchange(0u, std::memory_order_relaxed);
+    }
+
+  private:
+
+    const uint32_t _thread_id;
+
+    std::atomic<uint64_t> _head{0u};
+
+    std::atomic<uint64_t> _tail{0u};
+
+    std::atomic<uint64_t> _dropped{0u};
+
+    std::array<TraceEvent, Capacity> _events;
+  };
+
+  /// 持续时间（纳秒）的对数直方图：小于 16 的值各占一个桶，之后每个 2 的幂
+  /// 分为 8 个桶，百分位数的相对误差不超过 1/16。
+  class DurationHistogram {
+  public:
+
+    void Add(uint64_t nanoseconds) {
+      ++_buckets[GetBucket(nanoseconds)];
+      ++_count;
+      _total += nanoseconds;
+      _max = std::max(_max, nanoseconds);
+    }
+
+    uint64_t GetCount() const {
+      return _count;
+    }
+
+    uint64_t GetTotal() const {
+      return _total;
+    }
+
+    uint64_t GetMax() const {
+      return _max;
+    }
+
+    /// 第 @a percentile（0 到 100）百分位数的近似值，为所在桶的中点且不超过
+    /// 最大值。
+    uint64_t GetPercentile(double percentile) const {
+      if (_count == 0u) {
+        return 0u;
+      }
+      const double p = std::min(std::max(percentile, 0.0), 100.0);
+      const auto rank = std::max<uint64_t>(1u, static_cast<uint64_t>(p / 100.0 * static_cast<double>(_count) + 0.5));
+      uint64_t accumulated = 0u;
+      for (size_t i = 0u; i < _buckets.size(); ++i) {
+        accumulated += _buckets[i];
+        if (accumulated >= rank) {
+          return std::min(GetBucketMidpoint(i), _max);
+        }
+      }
+      return _max;
+    }
+
+  private:
+
+    static constexpr size_t LinearBuckets = 16u;
+
+    static constexpr size_t SubBucketBits = 3u;
+
+    static size_t GetBucket(uint64_t value) {
+      if (value < LinearBuckets) {
+        return static_cast<size_t>(value);
+      }
+      size_t exponent = 0u;
+      for (uint64_t v = value; v > 1u; v >>= 1u) {
+        ++exponent;
+      }
+      const auto sub_bucket = static_cast<size_t>((value >> (exponent - SubBucketBits)) & ((1u << SubBucketBits) - 1u));
+      return LinearBuckets + ((exponent - 4u) << SubBucketBits) + sub_bucket;
+    }
+
+    static uint64_t GetBucketMidpoint(size_t bucket) {
+      if (bucket < LinearBuckets) {
+        return bucket;
+      }
+      const size_t exponent = ((bucket - LinearBuckets) >> SubBucketBits) + 4u;
+      const uint64_t sub_bucket = (bucket - LinearBuckets) & ((1u << SubBucketBits) - 1u);
+      const uint64_t width = uint64_t(1u) << (exponent - SubBucketBits);
+      return (uint64_t(1u) << exponent) + sub_bucket * width + width / 2u;
+    }
+
+    std::array<uint64_t, LinearBuckets + (60u << SubBucketBits)> _buckets{};
+
+    uint64_t _count = 0u;
+
+    uint64_t _total = 0u;
+
+    uint64_t _max = 0u;
+  };
+
+} // namespace detail
+
+  /// 可以在生产环境中一直开启的分层性能分析器。
+  ///
+  /// 每个线程把 CARLA_TRACE_SCOPE 的开始与结束时间（x86 上为 TSC）写入自己的
+  /// 环形缓冲区，记录时不加锁也不分配内存；关闭时每个作用域只读取一个原子变量。
+  /// Collect（可以由 StartAggregation 启动的线程定期调用）把事件汇总为每个作用
+  /// 域的直方图，并按需保留最近的事件，用 WriteChromeTrace 导出为 Chrome 的
+  /// trace JSON（可由 chrome://tracing、Perfetto 或 Tracy 的 import-chrome 打开）。
+  class TraceProfiler : private NonCopyable {
+  public:
+
+    struct ScopeStatistics {
+      std::string name;
+      uint64_t count = 0u;
+      double total_ms = 0.0;
+      double mean_ms = 0.0;
+      double p50_ms = 0.0;
+      double p99_ms = 0.0;
+      double max_ms = 0.0;
+    };
+
+    static TraceProfiler &Get() {
+      static TraceProfiler instance;
+      return instance;
+    }
+
+    static bool IsEnabled() {
+      return GetEnabledFlag().load(std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enabled) {
+      GetEnabledFlag().store(enabled, std::memory_order_relaxed);
+    }
+
+    /// 时间戳，单位为时钟周期，由 Collect 换算为纳秒。
+    static uint64_t Now() {
+#ifdef LIBCARLA_TRACE_PROFILER_USE_TSC
+      return static_cast<uint64_t>(__rdtsc());
+#else
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /// 当前线程中嵌套的作用域数，由 TraceScope 更新。
+    static uint32_t &GetThreadDepth() {
+      static thread_local uint32_t depth = 0u;
+      return depth;
+    }
+
+    void Record(const detail::TraceEvent &event) {
+      GetThreadBuffer().Push(event);
+    }
+
+    /// 为 WriteChromeTrace 保留最近的 @a max_events 个事件，为 0 时（默认）
+    /// 只汇总统计数据。
+    void SetTraceCapacity(size_t max_events) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _trace_capacity = max_events;
+      while (_trace.size() > _trace_capacity) {
+        _trace.pop_front();
+      }
+    }
+
+    /// 取出所有线程缓冲区中的事件并汇总。
+    void Collect() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      CollectLocked();
+    }
+
+    /// 启动每隔 @a period 调用一次 Collect 的线程，避免缓冲区满时丢弃事件。
+    void StartAggregation(std::chrono::milliseconds period) {
+      StopAggregation();
+      std::lock_guard<std::mutex> lock(_aggregation_mutex);
+      _stop_aggregation = false;
+      _aggregation_thread = std::thread([this, period]() {
+        std::unique_lock<std::mutex> aggregation_lock(_aggregation_mutex);
+        while (!_aggregation_condition.wait_for(aggregation_lock, period, [this]() { return _stop_aggregation; })) {
+          aggregation_lock.unlock();
+          Collect();
+          aggregation_lock.lock();
+        }
+      });
+    }
+
+    void StopAggregation() {
+      {
+        std::lock_guard<std::mutex> lock(_aggregation_mutex);
+        _stop_aggregation = true;
+      }
+      _aggregation_condition.notify_all();
+      if (_aggregation_thread.joinable()) {
+        _aggregation_thread.join();
+      }
+    }
+
+    /// 到目前为止汇总的每个作用域的统计数据，按总时间从大到小排序。
+    std::vector<ScopeStatistics> GetStatistics() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      CollectLocked();
+      std::vector<ScopeStatistics> result;
+      result.reserve(_histograms.size());
+      for (const auto &item : _histograms) {
+        const auto &histogram = item.second;
+        ScopeStatistics statistics;
+        statistics.name = item.first;
+        statistics.count = histogram.GetCount();
+        statistics.total_ms = ToMilliseconds(histogram.GetTotal());
+        statistics.mean_ms = (statistics.count > 0u) ? (statistics.total_ms / static_cast<double>(statistics.count)) : 0.0;
+        statistics.p50_ms = ToMilliseconds(histogram.GetPercentile(50.0));
+        statistics.p99_ms = ToMilliseconds(histogram.GetPercentile(99.0));
+        statistics.max_ms = ToMilliseconds(histogram.GetMax());
+        result.emplace_back(std::move(statistics));
+      }
+      std::sort(result.begin(), result.end(), [](const ScopeStatistics &a, const ScopeStatistics &b) {
+        return a.total_ms > b.total_ms;
+      });
+      return result;
+    }
+
+    /// 因线程缓冲区已满而丢弃的事件数。
+    uint64_t GetDroppedCount() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      CollectLocked();
+      return _dropped;
+    }
+
+    /// 以 Chrome trace 的 JSON 格式写出保留的事件。
+    void WriteChromeTrace(std::ostream &out) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      CollectLocked();
+      out << "{\"traceEvents\":[";
+      bool first = true;
+      for (const auto &event : _trace) {
+        out << (first ? "" : ",")
+            << "{\"name\":\"" << event.name
+            << "\",\"cat\":\"carla\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread_id
+            << ",\"ts\":" << static_cast<double>(event.begin_ns) * 1e-3
+            << ",\"dur\":" << static_cast<double>(event.duration_ns) * 1e-3
+            << ",\"args\":{\"depth\":" << event.depth << "}}";
+        first = false;
+      }
+      out << "],\"displayTimeUnit\":\"ms\"}";
+    }
+
+    /// 丢弃所有汇总的数据与缓冲区中的事件。
+    void Reset() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &buffer : _buffers) {
+        buffer->Drain([](const detail::TraceEvent &) {});
+        buffer->ExchangeDropped();
+      }
+      _histograms.clear();
+      _trace.clear();
+      _dropped = 0u;
+    }
+
+    ~TraceProfiler() {
+      StopAggregation();
+    }
+
+  private:
+
+    struct RetainedEvent {
+      const char *name;
+      uint32_t thread_id;
+      uint32_t depth;
+      uint64_t begin_ns;
+      uint64_t duration_ns;
+    };
+
+    TraceProfiler()
+      : _start_ticks(Now()),
+        _start_time(std::chrono::steady_clock::now()) {}
+
+    static std::atomic<bool> &GetEnabledFlag() {
+      static std::atomic<bool> enabled{false};
+      return enabled;
+    }
+
+    detail::TraceBuffer &GetThreadBuffer() {
+      static thread_local std::shared_ptr<detail::TraceBuffer> buffer = RegisterThread();
+      return *buffer;
+    }
+
+    std::shared_ptr<detail::TraceBuffer> RegisterThread() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto buffer = std::make_shared<detail::TraceBuffer>(_next_thread_id++);
+      _buffers.emplace_back(buffer);
+      return buffer;
+    }
+
+    void CollectLocked() {
+      // 每次收集时用稳定时钟重新校准时钟周期与纳秒的比例
+      const uint64_t ticks = Now() - _start_ticks;
+      const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - _start_time).count();
+      if ((elapsed > 0) && (ticks > 0u)) {
+        _nanoseconds_per_tick = static_cast<double>(elapsed) / static_cast<double>(ticks);
+      }
+      for (auto &buffer : _buffers) {
+        const uint32_t thread_id = buffer->GetThreadId();
+        buffer->Drain([&](const detail::TraceEvent &event) {
+          const auto duration = ToNanoseconds(event.end - event.begin);
+          _histograms[event.name].Add(duration);
+          if (_trace_capacity > 0u) {
+            if (_trace.size() >= _trace_capacity) {
+              _trace.pop_front();
+            }
+            _trace.push_back(RetainedEvent{
+                event.name,
+                thread_id,
+                event.depth,
+                ToNanoseconds(event.begin - _start_ticks),
+                duration});
+          }
+        });
+        _dropped += buffer->ExchangeDropped();
+      }
+      // 线程结束后只有这里还持有它的缓冲区，取完事件后释放
+      _buffers.erase(std::remove_if(_buffers.begin(), _buffers.end(), [](const std::shared_ptr<detail::TraceBuffer> &buffer) {
+        return buffer.use_count() == 1;
+      }), _buffers.end());
+    }
+
+    uint64_t ToNanoseconds(uint64_t ticks) const {
+      return static_cast<uint64_t>(static_cast<double>(ticks) * _nanoseconds_per_tick);
+    }
+
+    static double ToMilliseconds(uint64_t nanoseconds) {
+      return 1e-6 * static_cast<double>(nanoseconds);
+    }
+
+    const uint64_t _start_ticks;
+
+    const std::chrono::steady_clock::time_point _start_time;
+
+    std::mutex _mutex;
+
+    std::vector<std::shared_ptr<detail::TraceBuffer>> _buffers;
+
+    uint32_t _next_thread_id = 0u;
+
+    double _nanoseconds_per_tick = 1.0;
+
+    std::unordered_map<std::string, detail::DurationHistogram> _histograms;
+
+    size_t _trace_capacity = 0u;
+
+    std::deque<RetainedEvent> _trace;
+
+    uint64_t _dropped = 0u;
+
+    std::mutex _aggregation_mutex;
+
+    std::condition_variable _aggregation_condition;
+
+    bool _stop_aggregation = true;
+
+    std::thread _aggregation_thread;
+  };
+
+  /// 记录所在作用域的执行时间，TraceProfiler 关闭时不做任何事。
+  class TraceScope : private NonCopyable {
+  public:
+
+    explicit TraceScope(const char *name) : _name(name) {
+      if (TraceProfiler::IsEnabled()) {
+        _depth = TraceProfiler::GetThreadDepth()++;
+        _begin = TraceProfiler::Now();
+        _active = true;
+      }
+    }
+
+    ~TraceScope() {
+      if (_active) {
+        const uint64_t end = TraceProfiler::Now();
+        --TraceProfiler::GetThreadDepth();
+        TraceProfiler::Get().Record(detail::TraceEvent{_name, _begin, end, _depth});
+      }
+    }
+
+  private:
+
+    const char *_name;
+
+    uint64_t _begin = 0u;
+
+    uint32_t _depth = 0u;
+
+    bool _active = false;
+  };
+
+} // namespace profiler
+} // namespace carla
+
+#define CARLA_TRACE_SCOPE(context, profiler_name) \
+    ::carla::profiler::TraceScope carla_trace_ ## context ## _ ## profiler_name ## _scope(#context "." #profiler_name)
@@ -12,6 +12,9 @@
 #include <torchcluster/cluster.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <c10/cuda/CUDACachingAllocator.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <ostream>
@@ -146,7 +149,160 @@ namespace learning {
     //   - 一个torch::jit::IValue对象，它封装了神经网络所需的输入张量（或张量的组合）  
     //       这个返回值可以直接被传递给torch::jit::script::Module的forward方法
     torch::jit::IValue GetWheelTensorInputsCUDA(WheelInput& wheel, int wheel_idx);
+
+    // 批量推理的输入缓冲区，在多次调用之间保留，只在容量不足时重新分配
+    at::Tensor batch_host_buffer; // 使用CUDA时为页锁定内存
+    at::Tensor batch_device_buffer;
+    // 返回至少能容纳 size 个 float 的主机缓冲区
+    float* ReserveBatchBuffers(int64_t size, bool cuda);
+    void ForwardBatch(
+        const std::vector<Inputs> &inputs,
+        std::vector<Outputs> &outputs,
+        bool cuda);
   };
+
+  static std::array<const WheelInput*, 4> GetWheels(const Inputs &input) {
+    return {&input.wheel0, &input.wheel1, &input.wheel2, &input.wheel3};
+  }
+
+  static std::array<WheelOutput*, 4> GetWheels(Outputs &output) {
+    return {&output.wheel0, &output.wheel1, &output.wheel2, &output.wheel3};
+  }
+
+  float* NeuralModelImpl::ReserveBatchBuffers(int64_t size, bool cuda)
+  {
+    const bool reallocate =
+        !batch_host_buffer.defined() ||
+        batch_host_buffer.numel() < size ||
+        batch_device_buffer.defined() != cuda;
+    if (reallocate) {
+      // 按倍数增长，车辆与粒子的数量变化时不必每帧重新分配
+      const int64_t capacity = std::max<int64_t>(
+          size, batch_host_buffer.defined() ? 2 * batch_host_buffer.numel() : 0);
+      batch_host_buffer = torch::empty({capacity},
+          torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(cuda));
+      batch_device_buffer = cuda ?
+          torch::empty({capacity}, torch::TensorOptions().dtype(torch::kFloat32).device(torch::kCUDA)) :
+          at::Tensor();
+    }
+    return batch_host_buffer.data_ptr<float>();
+  }
+
+  void NeuralModelImpl::ForwardBatch(
+      const std::vector<Inputs> &inputs,
+      std::vector<Outputs> &outputs,
+      bool cuda)
+  {
+    outputs.clear();
+    outputs.resize(inputs.size());
+    if (inputs.empty()) {
+      return;
+    }
+    torch::NoGradGuard no_grad;
+    // 车轮的位置、方向、线速度与角速度
+    constexpr int64_t WheelStateSize = 3 + 4 + 3 + 3;
+    int64_t size = 0;
+    for (const Inputs &input : inputs) {
+      for (const WheelInput *wheel : GetWheels(input)) {
+        size += 6 * wheel->num_particles + WheelStateSize;
+      }
+      size += 3; // 转向、油门和刹车
+    }
+    // 按模型参数的顺序写入缓冲区
+    float *host_data = ReserveBatchBuffers(size, cuda);
+    int64_t offset = 0;
+    auto Write = [&](const float *data, int64_t count) {
+      std::memcpy(host_data + offset, data, sizeof(float) * count);
+      offset += count;
+    };
+    for (const Inputs &input : inputs) {
+      for (const WheelInput *wheel : GetWheels(input)) {
+        Write(wheel->particles_positions, 3 * wheel->num_particles);
+        Write(wheel->particles_velocities, 3 * wheel->num_particles);
+        Write(wheel->wheel_positions, 3);
+        Write(wheel->wheel_oritentation, 4);
+        Write(wheel->wheel_linear_velocity, 3);
+        Write(wheel->wheel_angular_velocity, 3);
+      }
+      const float driving[3] = {input.steering, input.throttle, input.braking};
+      Write(driving, 3);
+    }
+    at::Tensor data = batch_host_buffer.narrow(0, 0, size);
+    if (cuda) {
+      // 页锁定内存可以异步拷贝，之后的计算在同一个流上排队
+      data = batch_device_buffer.narrow(0, 0, size);
+      data.copy_(batch_host_buffer.narrow(0, 0, size), /*non_blocking=*/true);
+    }
+    offset = 0;
+    auto Take = [&](at::IntArrayRef shape) {
+      int64_t count = 1;
+      for (int64_t dimension : shape) {
+        count *= dimension;
+      }
+      at::Tensor tensor = data.narrow(0, offset, count).view(shape);
+      offset += count;
+      return tensor;
+    };
+    // 每辆车依次为四个车轮的粒子力与四个车轮的力，展平后在设备上拼接
+    std::vector<at::Tensor> results;
+    results.reserve(8u * inputs.size());
+    for (const Inputs &input : inputs) {
+      std::vector<torch::jit::IValue> TorchInputs;
+      for (const WheelInput *wheel : GetWheels(input)) {
+        const int64_t num_particles = wheel->num_particles;
+        std::vector<torch::jit::IValue> Tuple {
+            Take({num_particles, 3}), Take({num_particles, 3}),
+            Take({3}), Take({4}), Take({3}), Take({3})};
+        if (cuda) {
+          Tuple.emplace_back(wheel->num_particles);
+        }
+        TorchInputs.push_back(torch::ivalue::Tuple::create(Tuple));
+      }
+      TorchInputs.push_back(Take({3}));
+      if (input.terrain_type >= 0) {
+        TorchInputs.push_back(input.terrain_type);
+      }
+      TorchInputs.push_back(input.verbose);
+      try {
+        torch::jit::IValue Output = module.forward(TorchInputs);
+        std::vector<torch::jit::IValue> Tensors = Output.toTuple()->elements();
+        for (size_t i = 0u; i < 8u; ++i) {
+          results.push_back(Tensors[i].toTensor().to(data.device(), torch::kFloat32).reshape({-1}));
+        }
+      } catch (const c10::Error& e) {
+        // 模型出错的车辆没有力，也不移动粒子
+        std::cout << "Error running model: " << e.msg() << std::endl;
+        results.resize(results.size() - results.size() % 8u);
+        for (const WheelInput *wheel : GetWheels(input)) {
+          results.push_back(torch::zeros({3 * wheel->num_particles}, data.options()));
+        }
+        for (size_t i = 0u; i < 4u; ++i) {
+          results.push_back(torch::zeros({6}, data.options()));
+        }
+      }
+    }
+    const at::Tensor host_results = torch::cat(results).cpu();
+    const float *result_data = host_results.data_ptr<float>();
+    size_t result = 0u;
+    for (Outputs &output : outputs) {
+      const auto wheels = GetWheels(output);
+      for (WheelOutput *wheel : wheels) {
+        const int64_t count = results[result++].numel();
+        wheel->_particle_forces.assign(result_data, result_data + count);
+        result_data += count;
+      }
+      for (WheelOutput *wheel : wheels) {
+        const int64_t count = results[result++].numel();
+        float *forces[6] = {
+            &wheel->wheel_forces_x, &wheel->wheel_forces_y, &wheel->wheel_forces_z,
+            &wheel->wheel_torque_x, &wheel->wheel_torque_y, &wheel->wheel_torque_z};
+        for (int64_t i = 0; i < std::min<int64_t>(count, 6); ++i) {
+          *forces[i] = result_data[i];
+        }
+        result_data += count;
+      }
+    }
+  }
   torch::jit::IValue NeuralModelImpl::GetWheelTensorInputsCUDA(WheelInput& wheel, int wheel_idx)
   {// 从WheelInput结构体中的粒子位置数组创建一个张量
     at::Tensor particles_position_tensor = 
@@ -186,7 +342,7 @@ namespace learning {
     // 使用std::make_unique初始化Model成员变量，它是一个指向NeuralModelImpl类型的unique_ptr
     Model = std::make_unique<NeuralModelImpl>();
   }
-  void NeuralModel::LoadModel(char* filename, int device) {
+  void NeuralModel::LoadModel(char* filename, int device, bool optimize) {
     // 禁用TensorExpr融合器，可能是为了避免某些与模型加载或执行不兼容的问题
     torch::jit::setTensorExprFuserEnabled(false);
     // 将传入的char*类型文件名转换为std::string，便于后续操作。
@@ -196,6 +352,16 @@ namespace learning {
     try {
       // 使用torch::jit::load加载模型文件，并将其存储在ModelImpl类的module成员中
       Model->module = torch::jit::load(filename_str);
+      if (optimize) {
+        // 冻结后的图把参数作为常量内联，并融合推理中的算子
+        try {
+          Model->module.eval();
+          torch::jit::Module frozen = torch::jit::freeze(Model->module);
+          Model->module = torch::jit::optimize_for_inference(frozen);
+        } catch (const c10::Error& e) {
+          std::cout << "Error optimizing model, using it unoptimized: " << e.msg() << std::endl;
+        }
+      }
       // 构造CUDA设备字符串，格式为"cuda:X"，其中X是传入的设备ID
       std::string cuda_str = "cuda:" + std::to_string(device);
       // 将模型移动到指定的CUDA设备上执行
@@ -333,6 +499,13 @@ namespace learning {
         Tensors[3].toTensor().cpu(), Tensors[7].toTensor().cpu() );
   }
   
+  void NeuralModel::ForwardBatch(
+      const std::vector<Inputs> &inputs,
+      std::vector<Outputs> &outputs,
+      bool cuda_tensors) {
+    Model->ForwardBatch(inputs, outputs, cuda_tensors);
+  }
+
   Outputs& NeuralModel::GetOutputs() {
     return _output;
   }
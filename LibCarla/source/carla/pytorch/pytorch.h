@@ -62,12 +62,22 @@ namespace learning {
   public:
 
     NeuralModel(); // 构造函数
-    void LoadModel(char* filename, int device); // 加载模型
+    /// 加载模型。@a optimize 为 true 时冻结 TorchScript 图并为推理优化，
+    /// 优化后的图在之后的每次调用中复用。
+    void LoadModel(char* filename, int device, bool optimize = false); // 加载模型
 
     void SetInputs(Inputs input); // 设置输入数据
     void Forward(); // 执行前向传播
     void ForwardDynamic(); // 执行动态前向传播
     void ForwardCUDATensors(); // 使用CUDA张量执行前向传播
+    /// 在一次调用中对多辆车执行前向传播，@a outputs 与 @a inputs 一一对应。
+    /// 所有车辆的所有车轮的输入写入同一块输入缓冲区，@a cuda_tensors 为 true
+    /// 时该缓冲区为页锁定内存，只需一次拷贝到设备；所有的输出也只需一次拷贝
+    /// 回主机。缓冲区在多次调用之间保留。
+    void ForwardBatch(
+        const std::vector<Inputs> &inputs,
+        std::vector<Outputs> &outputs,
+        bool cuda_tensors);
     Outputs& GetOutputs(); // 获取输出数据
 
     ~NeuralModel();  // 析构函数
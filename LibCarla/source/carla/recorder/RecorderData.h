@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 记录文件的基本信息。
+  struct RecorderInfo {
+    uint16_t version = 0u;
+    std::string magic;
+    /// 开始记录的时间（Unix 时间戳）。
+    int64_t date = 0;
+    std::string map_name;
+    uint64_t frames = 0u;
+    /// 记录的总时长（秒）。
+    double duration = 0.0;
+    /// 文件按块压缩。
+    bool compressed = false;
+    /// 文件末尾带有帧索引。
+    bool indexed = false;
+  };
+
+  /// 记录中出现过的 actor。
+  struct RecorderActor {
+    uint32_t id = 0u;
+    /// 与服务器端 FCarlaActor::ActorType 相同：0 其他、1 车辆、2 行人、3 交通灯、
+    /// 4 交通标志、5 传感器。
+    uint8_t type = 0u;
+    /// 蓝图 id，例如 "vehicle.tesla.model3"。
+    std::string type_id;
+    std::string role_name;
+    /// 创建和销毁的时间（秒）；没有销毁时为 -1。
+    double created = 0.0;
+    double destroyed = -1.0;
+
+    /// 碰撞查询使用的类别：'v' 车辆、'w' 行人、't' 交通灯、'o' 其他。
+    char GetCategory() const {
+      switch (type) {
+        case 1u: return 'v';
+        case 2u: return 'w';
+        case 3u: return 't';
+        default: return 'o';
+      }
+    }
+
+    bool IsHero() const {
+      return role_name == "hero";
+    }
+  };
+
+  /// 一次碰撞的开始；碰撞持续多帧时只记录第一帧。
+  struct RecorderCollision {
+    double time = 0.0;
+    uint64_t frame = 0u;
+    /// 不是 actor 的物体（例如建筑）的 id 为 uint32_t(-1)。
+    uint32_t actor1 = 0u;
+    uint32_t actor2 = 0u;
+    bool is_actor1_hero = false;
+    bool is_actor2_hero = false;
+  };
+
+  /// 在一段时间内几乎没有移动的 actor。
+  struct RecorderBlockedActor {
+    uint32_t id = 0u;
+    /// 开始停止的时间（秒）。
+    double time = 0.0;
+    /// 停止的时长（秒）。
+    double duration = 0.0;
+  };
+
+  /// 一个 actor 的轨迹，按列存放，每帧一个采样。
+  struct RecorderTrajectory {
+    uint32_t actor_id = 0u;
+    /// 采样时间（秒）。
+    std::vector<double> times;
+    /// 每个采样 3 个 float：x、y、z（米）。
+    std::vector<float> locations;
+    /// 每个采样 3 个 float：roll、pitch、yaw（度）。
+    std::vector<float> rotations;
+
+    size_t size() const {
+      return times.size();
+    }
+  };
+
+} // namespace recorder
+} // namespace carla
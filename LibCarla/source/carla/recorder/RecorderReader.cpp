@@ -0,0 +1,703 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/RecorderReader.h"
+
+#include "carla/Exception.h"
+#include "carla/ParallelFor.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace carla {
+namespace recorder {
+
+namespace {
+
+  /// 与服务器端 CarlaRecorderPacketId 相同。
+  enum class PacketId : uint8_t {
+    FrameStart = 0u,
+    FrameEnd = 1u,
+    EventAdd = 2u,
+    EventDel = 3u,
+    Collision = 5u,
+    Position = 6u,
+    KeyFrame = 24u,
+    FrameIndex = 25u,
+    PositionDelta = 26u
+  };
+
+  /// 按块压缩的文件开头的签名，见 CarlaRecorderBlockFile.h。
+  constexpr char BLOCK_SIGNATURE[8u] = {'C', 'R', 'B', 'L', 'O', 'C', 'K', 'S'};
+
+  /// 块头：uint32 存储大小、uint32 原始大小、uint8 压缩方式。
+  constexpr size_t BLOCK_HEADER_SIZE = 9u;
+
+  /// 数据包头：char id、uint32 大小。
+  constexpr size_t PACKET_HEADER_SIZE = 5u;
+
+  /// 位置记录：uint32 id、3 个 float 位置、3 个 float 旋转。
+  constexpr size_t POSITION_SIZE = 28u;
+
+  /// 增量编码的数据包的标志，见服务器端 CarlaRecorderDelta.h。
+  constexpr uint8_t DELTA_NEW_IDS = 1u << 0u;
+  constexpr uint8_t DELTA_RESET = 1u << 1u;
+
+  /// 增量编码的位置的量化步长：位置为厘米，旋转为度。
+  constexpr float DELTA_LOCATION_STEP = 0.01f;
+  constexpr float DELTA_ROTATION_STEP = 0.01f;
+
+  /// 帧索引的记录：double 时间、uint64 位置、uint8 是否为关键帧。
+  constexpr size_t INDEX_ENTRY_SIZE = 17u;
+
+  constexpr size_t FRAMES_PER_CHUNK = 256u;
+
+  constexpr uint32_t NO_ACTOR = std::numeric_limits<uint32_t>::max();
+
+  constexpr float TO_METERS = 1e-2f;
+
+  /// 在 [begin, end) 范围内带边界检查地顺序读取。
+  class Cursor {
+  public:
+
+    Cursor(const uint8_t *data, size_t begin, size_t end)
+      : _data(data),
+        _pos(begin),
+        _end(end) {}
+
+    template <typename T>
+    T Read() {
+      Require(sizeof(T));
+      T value;
+      std::memcpy(&value, _data + _pos, sizeof(T));
+      _pos += sizeof(T);
+      return value;
+    }
+
+    /// 服务器端 WriteFString 的格式：uint16 长度 + UTF-8 文本。
+    std::string ReadString() {
+      const auto length = Read<uint16_t>();
+      Require(length);
+      std::string value(reinterpret_cast<const char *>(_data + _pos), length);
+      _pos += length;
+      return value;
+    }
+
+    void Skip(size_t count) {
+      Require(count);
+      _pos += count;
+    }
+
+    void Seek(size_t pos) {
+      if (pos > _end) {
+        throw_exception(std::runtime_error("recorder file: packet out of bounds"));
+      }
+      _pos = pos;
+    }
+
+    size_t pos() const {
+      return _pos;
+    }
+
+    bool AtEnd() const {
+      return _pos >= _end;
+    }
+
+  private:
+
+    void Require(size_t count) const {
+      if (count > _end - _pos) {
+        throw_exception(std::runtime_error("recorder file: unexpected end of data"));
+      }
+    }
+
+    const uint8_t *_data;
+
+    size_t _pos;
+
+    size_t _end;
+  };
+
+  struct ChunkEvents {
+    /// 帧序号与 actor。
+    std::vector<std::pair<size_t, RecorderActor>> added;
+    std::vector<std::pair<size_t, uint32_t>> deleted;
+  };
+
+  static size_t NumberOfChunks(size_t frames) {
+    return (frames + FRAMES_PER_CHUNK - 1u) / FRAMES_PER_CHUNK;
+  }
+
+  static bool MatchesCategory(char category, char actor_category, bool is_hero) {
+    return (category == 'a') || (category == actor_category) || (category == 'h' && is_hero);
+  }
+
+} // namespace
+
+  RecorderReader::RecorderReader(const std::string &path)
+    : _file(MappedFile::Open(path)) {
+    if (_file == nullptr) {
+      throw_exception(std::runtime_error("cannot open recorder file '" + path + "'"));
+    }
+    _data = _file->data();
+    _size = _file->size();
+    if ((_size >= sizeof(BLOCK_SIGNATURE)) &&
+        (std::memcmp(_data, BLOCK_SIGNATURE, sizeof(BLOCK_SIGNATURE)) == 0)) {
+      Decompress();
+    }
+    ReadInfo();
+    FindFrames();
+    ParseFrames();
+  }
+
+  RecorderReader::~RecorderReader() = default;
+
+  void RecorderReader::Decompress() {
+    struct Block {
+      size_t offset;
+      size_t start;
+      uint32_t stored_size;
+      uint32_t size;
+      uint8_t compression;
+    };
+
+    // 块头很小，顺序扫描；记录中断时最后一个不完整的块被忽略。
+    std::vector<Block> blocks;
+    size_t total = 0u;
+    Cursor cursor(_data, sizeof(BLOCK_SIGNATURE), _size);
+    while (_size - cursor.pos() >= BLOCK_HEADER_SIZE) {
+      Block block;
+      block.stored_size = cursor.Read<uint32_t>();
+      block.size = cursor.Read<uint32_t>();
+      block.compression = cursor.Read<uint8_t>();
+      block.offset = cursor.pos();
+      block.start = total;
+      if (block.stored_size > _size - block.offset) {
+        break;
+      }
+      blocks.push_back(block);
+      cursor.Skip(block.stored_size);
+      total += block.size;
+    }
+
+    _content.resize(total);
+    ParallelFor(blocks.size(), [&](size_t i) {
+      const Block &block = blocks[i];
+      uint8_t *destination = _content.data() + block.start;
+      if (block.compression == 0u) {
+        if (block.stored_size != block.size) {
+          throw_exception(std::runtime_error("recorder file: corrupted block"));
+        }
+        std::memcpy(destination, _data + block.offset, block.size);
+      } else {
+        uLongf size = block.size;
+        const auto result = uncompress(destination, &size, _data + block.offset, block.stored_size);
+        if ((result != Z_OK) || (size != block.size)) {
+          throw_exception(std::runtime_error("recorder file: cannot decompress block"));
+        }
+      }
+    }, 1u);
+
+    _data = _content.data();
+    _size = _content.size();
+    _info.compressed = true;
+  }
+
+  void RecorderReader::ReadInfo() {
+    Cursor cursor(_data, 0u, _size);
+    _info.version = cursor.Read<uint16_t>();
+    _info.magic = cursor.ReadString();
+    if (_info.magic != "CARLA_RECORDER") {
+      throw_exception(std::runtime_error("not a recorder file"));
+    }
+    _info.date = cursor.Read<int64_t>();
+    _info.map_name = cursor.ReadString();
+    _first_packet = cursor.pos();
+  }
+
+  void RecorderReader::FindFrames() {
+    // 有帧索引时直接读取每一帧的位置，索引的位置保存在文件最后 8 个字节。
+    if (_size - _first_packet >= PACKET_HEADER_SIZE + sizeof(uint32_t) + sizeof(uint64_t)) {
+      uint64_t trailer = 0u;
+      std::memcpy(&trailer, _data + _size - sizeof(uint64_t), sizeof(uint64_t));
+      if ((trailer >= _first_packet) &&
+          (trailer <= _size - PACKET_HEADER_SIZE - sizeof(uint32_t) - sizeof(uint64_t)) &&
+          (_data[trailer] == static_cast<uint8_t>(PacketId::FrameIndex))) {
+        Cursor cursor(_data, trailer + 1u, _size);
+        const auto size = cursor.Read<uint32_t>();
+        const auto count = cursor.Read<uint32_t>();
+        const bool valid =
+            (trailer + PACKET_HEADER_SIZE + size == _size) &&
+            (size == sizeof(uint32_t) + uint64_t(count) * INDEX_ENTRY_SIZE + sizeof(uint64_t));
+        if (valid) {
+          std::vector<Frame> frames(count);
+          bool ordered = true;
+          for (auto &frame : frames) {
+            cursor.Skip(sizeof(double));
+            frame.begin = cursor.Read<uint64_t>();
+            cursor.Skip(sizeof(uint8_t));
+          }
+          for (size_t i = 0u; i < frames.size(); ++i) {
+            frames[i].end = (i + 1u < frames.size()) ? frames[i + 1u].begin : trailer;
+            ordered = ordered && (frames[i].begin >= _first_packet) && (frames[i].begin < frames[i].end);
+          }
+          if (ordered) {
+            _frames = std::move(frames);
+            _info.indexed = true;
+            return;
+          }
+        }
+      }
+    }
+
+    // 没有索引：只读取数据包头，跳过内容。
+    constexpr size_t none = std::numeric_limits<size_t>::max();
+    size_t begin = none;
+    size_t pos = _first_packet;
+    while (_size - pos >= PACKET_HEADER_SIZE) {
+      const auto id = _data[pos];
+      uint32_t size;
+      std::memcpy(&size, _data + pos + 1u, sizeof(uint32_t));
+      if (size > _size - pos - PACKET_HEADER_SIZE) {
+        break;
+      }
+      const size_t next = pos + PACKET_HEADER_SIZE + size;
+      if (id == static_cast<uint8_t>(PacketId::FrameStart)) {
+        begin = pos;
+      } else if ((id == static_cast<uint8_t>(PacketId::FrameEnd)) && (begin != none)) {
+        Frame frame;
+        frame.begin = begin;
+        frame.end = next;
+        _frames.push_back(frame);
+        begin = none;
+      }
+      pos = next;
+    }
+  }
+
+  void RecorderReader::ParseFrames() {
+    const size_t chunks = NumberOfChunks(_frames.size());
+    std::vector<ChunkEvents> events(chunks);
+    std::vector<std::vector<RawCollision>> collisions(chunks);
+
+    ParallelFor(chunks, [&](size_t chunk) {
+      const size_t last = std::min(_frames.size(), (chunk + 1u) * FRAMES_PER_CHUNK);
+      for (size_t i = chunk * FRAMES_PER_CHUNK; i < last; ++i) {
+        Frame &frame = _frames[i];
+        Cursor cursor(_data, frame.begin, frame.end);
+        while (!cursor.AtEnd()) {
+          const auto id = static_cast<PacketId>(cursor.Read<uint8_t>());
+          const auto size = cursor.Read<uint32_t>();
+          const size_t next = cursor.pos() + size;
+          switch (id) {
+            case PacketId::FrameStart:
+              frame.id = cursor.Read<uint64_t>();
+              frame.duration = cursor.Read<double>();
+              frame.elapsed = cursor.Read<double>();
+              break;
+            case PacketId::EventAdd: {
+              const auto total = cursor.Read<uint16_t>();
+              for (auto j = 0u; j < total; ++j) {
+                RecorderActor actor;
+                actor.id = cursor.Read<uint32_t>();
+                actor.type = cursor.Read<uint8_t>();
+                // 位置、旋转与蓝图 uid
+                cursor.Skip(6u * sizeof(float) + sizeof(uint32_t));
+                actor.type_id = cursor.ReadString();
+                const auto attributes = cursor.Read<uint16_t>();
+                for (auto k = 0u; k < attributes; ++k) {
+                  cursor.Skip(sizeof(uint8_t));
+                  auto attribute = cursor.ReadString();
+                  auto value = cursor.ReadString();
+                  if (attribute == "role_name") {
+                    actor.role_name = std::move(value);
+                  }
+                }
+                events[chunk].added.emplace_back(i, std::move(actor));
+              }
+              break;
+            }
+            case PacketId::EventDel: {
+              const auto total = cursor.Read<uint16_t>();
+              for (auto j = 0u; j < total; ++j) {
+                events[chunk].deleted.emplace_back(i, cursor.Read<uint32_t>());
+              }
+              break;
+            }
+            case PacketId::Collision: {
+              const auto total = cursor.Read<uint16_t>();
+              for (auto j = 0u; j < total; ++j) {
+                RawCollision collision;
+                collision.frame = i;
+                cursor.Skip(sizeof(uint32_t));
+                collision.actor1 = cursor.Read<uint32_t>();
+                collision.actor2 = cursor.Read<uint32_t>();
+                collision.is_actor1_hero = cursor.Read<uint8_t>() != 0u;
+                collision.is_actor2_hero = cursor.Read<uint8_t>() != 0u;
+                collisions[chunk].push_back(collision);
+              }
+              break;
+            }
+            case PacketId::Position:
+              frame.position_count = cursor.Read<uint16_t>();
+              frame.positions = cursor.pos();
+              frame.position_encoding = PositionEncoding::Full;
+              cursor.Skip(frame.position_count * POSITION_SIZE);
+              break;
+            case PacketId::PositionDelta:
+              frame.positions = cursor.pos();
+              frame.position_reset = (cursor.Read<uint8_t>() & DELTA_RESET) != 0u;
+              frame.position_count = cursor.Read<uint16_t>();
+              frame.position_encoding = PositionEncoding::Delta;
+              break;
+            case PacketId::KeyFrame:
+              // 第一帧的关键帧是记录开始前已存在的 actor（“黑匣子”记录的文件），
+              // 解析其中嵌套的数据包；其他关键帧只是重复已知的状态。
+              if (i == 0u) {
+                continue;
+              }
+              break;
+            default:
+              break;
+          }
+          cursor.Seek(next);
+        }
+        // 最后一帧的时长在记录时没有写入
+        frame.duration = std::max(frame.duration, 0.0);
+      }
+    }, 1u);
+
+    // 按帧的顺序合并
+    std::unordered_map<uint32_t, RecorderActor> actors;
+    for (auto &chunk : events) {
+      for (auto &item : chunk.added) {
+        item.second.created = _frames[item.first].elapsed;
+        actors[item.second.id] = std::move(item.second);
+      }
+      for (auto &item : chunk.deleted) {
+        auto it = actors.find(item.second);
+        if (it != actors.end()) {
+          it->second.destroyed = _frames[item.first].elapsed;
+        }
+      }
+    }
+    _actors.reserve(actors.size());
+    for (auto &item : actors) {
+      _actors.emplace_back(std::move(item.second));
+    }
+    std::sort(_actors.begin(), _actors.end(), [](const RecorderActor &lhs, const RecorderActor &rhs) {
+      return lhs.id < rhs.id;
+    });
+    for (size_t i = 0u; i < _actors.size(); ++i) {
+      _actor_index[_actors[i].id] = i;
+    }
+
+    for (auto &chunk : collisions) {
+      _collisions.insert(_collisions.end(), chunk.begin(), chunk.end());
+    }
+
+    DecodePositions();
+
+    _info.frames = _frames.empty() ? 0u : _frames.back().id;
+    _info.duration = _frames.empty() ? 0.0 : _frames.back().elapsed;
+  }
+
+  void RecorderReader::DecodePositions() {
+    static_assert(sizeof(Position) == POSITION_SIZE, "Position must match the layout of the file");
+    size_t total = 0u;
+    for (auto &frame : _frames) {
+      frame.first_position = total;
+      total += frame.position_count;
+    }
+    _positions.resize(total);
+
+    // 增量编码的位置依赖上一帧，从不依赖上一帧的位置数据包（完整的或带有
+    // Reset 标志的，录制时每个关键帧一个）开始分段，各段并行解码。
+    std::vector<size_t> segments;
+    for (size_t i = 0u; i < _frames.size(); ++i) {
+      const auto &frame = _frames[i];
+      if ((i == 0u) ||
+          (frame.position_encoding == PositionEncoding::Full) ||
+          (frame.position_encoding == PositionEncoding::Delta && frame.position_reset)) {
+        segments.push_back(i);
+      }
+    }
+
+    ParallelFor(segments.size(), [&](size_t segment) {
+      const size_t last = (segment + 1u < segments.size()) ? segments[segment + 1u] : _frames.size();
+      std::vector<Position> previous;
+      std::unordered_map<uint32_t, size_t> previous_index;
+      for (size_t i = segments[segment]; i < last; ++i) {
+        const Frame &frame = _frames[i];
+        if (frame.position_encoding == PositionEncoding::None) {
+          continue;
+        }
+        Position *output = _positions.data() + frame.first_position;
+        if (frame.position_encoding == PositionEncoding::Full) {
+          std::memcpy(output, _data + frame.positions, frame.position_count * POSITION_SIZE);
+        } else {
+          Cursor cursor(_data, frame.positions, frame.end);
+          const auto flags = cursor.Read<uint8_t>();
+          const auto count = cursor.Read<uint16_t>();
+          if ((flags & DELTA_RESET) != 0u) {
+            previous.clear();
+          }
+          const bool new_ids = (flags & DELTA_NEW_IDS) != 0u;
+          for (auto j = 0u; j < count; ++j) {
+            output[j].id = new_ids ?
+                cursor.Read<uint32_t>() :
+                (j < previous.size() ? previous[j].id : 0u);
+          }
+          if (new_ids || (previous.size() != count)) {
+            previous_index.clear();
+            for (size_t j = 0u; j < previous.size(); ++j) {
+              previous_index.emplace(previous[j].id, j);
+            }
+          }
+          auto find_previous = [&](size_t j) -> const Position * {
+            if (!new_ids && (previous.size() == count)) {
+              return &previous[j];
+            }
+            auto it = previous_index.find(output[j].id);
+            return (it != previous_index.end()) ? &previous[it->second] : nullptr;
+          };
+          const size_t mask = cursor.pos();
+          cursor.Skip((count + 7u) / 8u);
+          for (auto j = 0u; j < count; ++j) {
+            const uint32_t id = output[j].id;
+            const Position *source = find_previous(j);
+            if (source != nullptr) {
+              output[j] = *source;
+            } else {
+              output[j] = Position{};
+            }
+            output[j].id = id;
+            if ((_data[mask + j / 8u] & (1u << (j % 8u))) == 0u) {
+              continue;
+            }
+            if (cursor.Read<uint8_t>() == 0u) {
+              // 相对上一帧的量化差值，计算方式与服务器端相同
+              for (auto k = 0u; k < 3u; ++k) {
+                output[j].location[k] += static_cast<float>(cursor.Read<int16_t>()) * DELTA_LOCATION_STEP;
+              }
+              for (auto k = 0u; k < 3u; ++k) {
+                output[j].rotation[k] += static_cast<float>(cursor.Read<int16_t>()) * DELTA_ROTATION_STEP;
+              }
+            } else {
+              for (auto k = 0u; k < 3u; ++k) {
+                output[j].location[k] = cursor.Read<float>();
+              }
+              for (auto k = 0u; k < 3u; ++k) {
+                output[j].rotation[k] = cursor.Read<float>();
+              }
+            }
+          }
+        }
+        previous.assign(output, output + frame.position_count);
+      }
+    }, 1u);
+  }
+
+  std::vector<RecorderCollision> RecorderReader::GetCollisions(char category1, char category2) const {
+    auto get_category = [this](uint32_t id) {
+      if (id == NO_ACTOR) {
+        return 'o';
+      }
+      auto it = _actor_index.find(id);
+      return (it != _actor_index.end()) ? _actors[it->second].GetCategory() : 'o';
+    };
+
+    // 与服务器端的查询相同，上一帧已经存在的碰撞不重复报告。
+    std::vector<RecorderCollision> result;
+    std::set<std::pair<uint32_t, uint32_t>> previous;
+    std::set<std::pair<uint32_t, uint32_t>> current;
+    size_t current_frame = std::numeric_limits<size_t>::max();
+    for (const auto &collision : _collisions) {
+      if (collision.frame != current_frame) {
+        if (collision.frame == current_frame + 1u) {
+          previous = std::move(current);
+        } else {
+          previous.clear();
+        }
+        current.clear();
+        current_frame = collision.frame;
+      }
+      if (!MatchesCategory(category1, get_category(collision.actor1), collision.is_actor1_hero) ||
+          !MatchesCategory(category2, get_category(collision.actor2), collision.is_actor2_hero)) {
+        continue;
+      }
+      const auto pair = std::make_pair(collision.actor1, collision.actor2);
+      if (previous.count(pair) == 0u) {
+        RecorderCollision item;
+        item.time = _frames[collision.frame].elapsed;
+        item.frame = _frames[collision.frame].id;
+        item.actor1 = collision.actor1;
+        item.actor2 = collision.actor2;
+        item.is_actor1_hero = collision.is_actor1_hero;
+        item.is_actor2_hero = collision.is_actor2_hero;
+        result.push_back(item);
+      }
+      current.insert(pair);
+    }
+    return result;
+  }
+
+  std::vector<RecorderBlockedActor> RecorderReader::GetBlockedActors(
+      const double min_time,
+      const double min_distance) const {
+    // 每个线程处理 id 对线程数取模相同的 actor，各个 actor 的状态互不影响。
+    const size_t groups = std::max(std::thread::hardware_concurrency(), 1u);
+    const float min_distance_cm = static_cast<float>(min_distance) / TO_METERS;
+    std::vector<std::vector<RecorderBlockedActor>> results(groups);
+
+    ParallelFor(groups, [&](size_t group) {
+      struct State {
+        float x, y, z;
+        double time;
+        double duration;
+      };
+      std::unordered_map<uint32_t, State> states;
+      auto &result = results[group];
+      for (const auto &frame : _frames) {
+        const Position *record = _positions.data() + frame.first_position;
+        for (auto i = 0u; i < frame.position_count; ++i, ++record) {
+          const uint32_t id = record->id;
+          if (id % groups != group) {
+            continue;
+          }
+          const float *location = record->location;
+          auto it = states.find(id);
+          if (it == states.end()) {
+            states.emplace(id, State{location[0u], location[1u], location[2u], 0.0, 0.0});
+            continue;
+          }
+          State &state = it->second;
+          const float dx = location[0u] - state.x;
+          const float dy = location[1u] - state.y;
+          const float dz = location[2u] - state.z;
+          if (std::sqrt(dx * dx + dy * dy + dz * dz) < min_distance_cm) {
+            // 停止
+            if (state.duration == 0.0) {
+              state.time = frame.elapsed;
+            }
+            state.duration += frame.duration;
+          } else {
+            // 重新移动
+            if (state.duration >= min_time) {
+              result.push_back(RecorderBlockedActor{id, state.time, state.duration});
+            }
+            state.duration = 0.0;
+            state.x = location[0u];
+            state.y = location[1u];
+            state.z = location[2u];
+          }
+        }
+      }
+      // 到记录结束时仍然停止的 actor
+      for (const auto &item : states) {
+        if (item.second.duration >= min_time) {
+          result.push_back(RecorderBlockedActor{item.first, item.second.time, item.second.duration});
+        }
+      }
+    }, 1u);
+
+    std::vector<RecorderBlockedActor> blocked;
+    for (auto &result : results) {
+      blocked.insert(blocked.end(), result.begin(), result.end());
+    }
+    std::sort(blocked.begin(), blocked.end(), [](const RecorderBlockedActor &lhs, const RecorderBlockedActor &rhs) {
+      if (lhs.duration != rhs.duration) {
+        return lhs.duration > rhs.duration;
+      }
+      return (lhs.time != rhs.time) ? (lhs.time < rhs.time) : (lhs.id < rhs.id);
+    });
+    return blocked;
+  }
+
+  std::vector<RecorderTrajectory> RecorderReader::GetTrajectories(const std::vector<uint32_t> &actor_ids) const {
+    std::vector<RecorderTrajectory> result;
+    if (actor_ids.empty()) {
+      result.resize(_actors.size());
+      for (size_t i = 0u; i < _actors.size(); ++i) {
+        result[i].actor_id = _actors[i].id;
+      }
+    } else {
+      result.resize(actor_ids.size());
+      for (size_t i = 0u; i < actor_ids.size(); ++i) {
+        result[i].actor_id = actor_ids[i];
+      }
+    }
+    std::unordered_map<uint32_t, size_t> index;
+    for (size_t i = 0u; i < result.size(); ++i) {
+      index.emplace(result[i].actor_id, i);
+    }
+
+    const size_t actors = result.size();
+    const size_t chunks = NumberOfChunks(_frames.size());
+    auto for_each_sample = [&](size_t chunk, auto &&callback) {
+      const size_t last = std::min(_frames.size(), (chunk + 1u) * FRAMES_PER_CHUNK);
+      for (size_t i = chunk * FRAMES_PER_CHUNK; i < last; ++i) {
+        const Position *record = _positions.data() + _frames[i].first_position;
+        for (auto j = 0u; j < _frames[i].position_count; ++j, ++record) {
+          auto it = index.find(record->id);
+          if (it != index.end()) {
+            callback(_frames[i], it->second, *record);
+          }
+        }
+      }
+    };
+
+    // 第一遍并行统计每组帧中每个 actor 的采样数，第二遍直接写到最终位置。
+    std::vector<size_t> offsets(chunks * actors, 0u);
+    ParallelFor(chunks, [&](size_t chunk) {
+      size_t *counts = offsets.data() + chunk * actors;
+      for_each_sample(chunk, [counts](const Frame &, size_t actor, const Position &) {
+        ++counts[actor];
+      });
+    }, 1u);
+
+    for (size_t actor = 0u; actor < actors; ++actor) {
+      size_t total = 0u;
+      for (size_t chunk = 0u; chunk < chunks; ++chunk) {
+        const size_t count = offsets[chunk * actors + actor];
+        offsets[chunk * actors + actor] = total;
+        total += count;
+      }
+      result[actor].times.resize(total);
+      result[actor].locations.resize(3u * total);
+      result[actor].rotations.resize(3u * total);
+    }
+
+    ParallelFor(chunks, [&](size_t chunk) {
+      size_t *next = offsets.data() + chunk * actors;
+      for_each_sample(chunk, [&](const Frame &frame, size_t actor, const Position &record) {
+        auto &trajectory = result[actor];
+        const size_t sample = next[actor]++;
+        trajectory.times[sample] = frame.elapsed;
+        for (auto k = 0u; k < 3u; ++k) {
+          trajectory.locations[3u * sample + k] = TO_METERS * record.location[k];
+          trajectory.rotations[3u * sample + k] = record.rotation[k];
+        }
+      });
+    }, 1u);
+
+    return result;
+  }
+
+  RecorderTrajectory RecorderReader::GetTrajectory(uint32_t actor_id) const {
+    return std::move(GetTrajectories({actor_id}).front());
+  }
+
+} // namespace recorder
+} // namespace carla
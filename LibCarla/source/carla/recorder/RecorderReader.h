@@ -0,0 +1,139 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MappedFile.h"
+#include "carla/NonCopyable.h"
+#include "carla/recorder/RecorderData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 不依赖模拟器读取记录文件（start_recorder 生成的文件），用于离线分析。
+  ///
+  /// 文件通过 mmap 映射到内存；按块压缩的文件并行解压。构造时先找到每一帧的
+  /// 位置（有帧索引时直接读取，否则只扫描数据包头），再把帧分组并行解析，
+  /// 保留事件、碰撞和每帧位置数据包的位置。查询结果以结构体返回，而不是
+  /// 服务器端 CarlaRecorderQuery 生成的文本。
+  ///
+  /// 与服务器端的查询不同，距离和位置的单位是米。
+  class RecorderReader : private NonCopyable {
+  public:
+
+    /// @throw std::runtime_error 如果文件无法打开或不是记录文件。
+    explicit RecorderReader(const std::string &path);
+
+    ~RecorderReader();
+
+    const RecorderInfo &GetInfo() const {
+      return _info;
+    }
+
+    /// 所有出现过的 actor，按 id 排序。
+    const std::vector<RecorderActor> &GetActors() const {
+      return _actors;
+    }
+
+    /// 两个 actor 的类别都符合时返回碰撞的开始。类别为 'v' 车辆、'w' 行人、
+    /// 't' 交通灯、'o' 其他、'h' hero、'a' 任意。
+    std::vector<RecorderCollision> GetCollisions(char category1 = 'a', char category2 = 'a') const;
+
+    /// 至少 @a min_time 秒内移动不超过 @a min_distance 米的 actor，按停止时长
+    /// 从长到短排序。
+    std::vector<RecorderBlockedActor> GetBlockedActors(double min_time = 30.0, double min_distance = 0.1) const;
+
+    /// @a actor_ids 中每个 actor 的轨迹，顺序相同；@a actor_ids 为空时返回所有
+    /// actor 的轨迹。
+    std::vector<RecorderTrajectory> GetTrajectories(const std::vector<uint32_t> &actor_ids = {}) const;
+
+    RecorderTrajectory GetTrajectory(uint32_t actor_id) const;
+
+  private:
+
+    enum class PositionEncoding : uint8_t {
+      None,
+      Full,
+      Delta
+    };
+
+    struct Frame {
+      uint64_t id = 0u;
+      double elapsed = 0.0;
+      double duration = 0.0;
+      /// 帧在数据中的范围 [begin, end)。
+      size_t begin = 0u;
+      size_t end = 0u;
+      /// 位置数据包的负载在数据中的位置与记录数；没有时 count 为 0。
+      size_t positions = 0u;
+      uint16_t position_count = 0u;
+      PositionEncoding position_encoding = PositionEncoding::None;
+      /// 增量编码的位置数据包是否不依赖上一帧。
+      bool position_reset = false;
+      /// 解码后第一条记录在 _positions 中的序号。
+      size_t first_position = 0u;
+    };
+
+    /// 与服务器端 CarlaRecorderPosition 相同，位置单位为厘米。
+    struct Position {
+      uint32_t id;
+      float location[3u];
+      float rotation[3u];
+    };
+
+    struct RawCollision {
+      size_t frame;
+      uint32_t actor1;
+      uint32_t actor2;
+      bool is_actor1_hero;
+      bool is_actor2_hero;
+    };
+
+    void Decompress();
+
+    void ReadInfo();
+
+    void FindFrames();
+
+    void ParseFrames();
+
+    void DecodePositions();
+
+    std::unique_ptr<MappedFile> _file;
+
+    /// 压缩文件解压后的内容。
+    std::vector<uint8_t> _content;
+
+    const uint8_t *_data = nullptr;
+
+    size_t _size = 0u;
+
+    /// 文件头之后第一个数据包的位置。
+    size_t _first_packet = 0u;
+
+    RecorderInfo _info;
+
+    std::vector<Frame> _frames;
+
+    /// 所有帧解码后的位置。
+    std::vector<Position> _positions;
+
+    std::vector<RecorderActor> _actors;
+
+    std::unordered_map<uint32_t, size_t> _actor_index;
+
+    std::vector<RawCollision> _collisions;
+  };
+
+} // namespace recorder
+} // namespace carla
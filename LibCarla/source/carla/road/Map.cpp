@@ -6,10 +6,13 @@
 
 #include "carla/road/Map.h" // 导入地图相关的头文件
 #include "carla/Exception.h" // 导入异常处理的头文件
+#include "carla/Logging.h" // 导入日志的头文件
+#include "carla/ParallelFor.h" // 导入并行循环的头文件
 #include "carla/geom/Math.h" // 导入数学计算相关的头文件
 #include "carla/geom/Vector3D.h" // 导入三维向量相关的头文件
 #include "carla/road/MeshFactory.h" // 导入网格工厂的头文件
 #include "carla/road/Deformation.h" // 导入变形相关的头文件
+#include "carla/road/SignalType.h" // 导入信号类型的头文件
 #include "carla/road/element/LaneCrossingCalculator.h" // 导入车道交叉计算器的头文件
 #include "carla/road/element/RoadInfoCrosswalk.h" // 导入人行横道信息的头文件
 #include "carla/road/element/RoadInfoElevation.h" // 导入道路高度信息的头文件
@@ -22,13 +25,19 @@
 
 #include "marchingcube/MeshReconstruction.h" // 导入网格重建的头文件
 
+#include <atomic> // 导入原子类型
 #include <vector> // 导入向量库
 #include <unordered_map> // 导入无序映射库
+#include <unordered_set> // 导入无序集合库
 #include <stdexcept> // 导入标准异常库
 #include <chrono> // 导入时间相关库
+#include <mutex> // 导入互斥锁
 #include <thread> // 导入线程相关库
 #include <iomanip> // 导入格式化输入输出库
 #include <cmath> // 导入数学库
+#include <cstring> // 导入内存复制函数
+#include <algorithm> // 导入排序算法
+#include <limits> // 导入数值极限
 
 namespace carla {
 namespace road {
@@ -55,6 +64,43 @@ namespace road {
     return dst; // 返回合并后的向量
   }
 
+  // 按顺序把多个向量合并为一个连续的向量，预先分配准确的容量
+  template <typename T>
+  static std::vector<T> FlattenVectors(std::vector<std::vector<T>> &vectors) {
+    size_t size = 0u;
+    for (const auto &vector : vectors) {
+      size += vector.size();
+    }
+    std::vector<T> result;
+    result.reserve(size);
+    for (auto &vector : vectors) {
+      result.insert(
+          result.end(),
+          std::make_move_iterator(vector.begin()),
+          std::make_move_iterator(vector.end()));
+    }
+    return result;
+  }
+
+  // 按 MapData 中的遍历顺序返回所有道路，供多个线程按索引处理
+  static std::vector<const Road *> GetRoadList(const MapData &data) {
+    std::vector<const Road *> roads;
+    roads.reserve(data.GetRoads().size());
+    for (const auto &pair : data.GetRoads()) {
+      roads.push_back(&pair.second);
+    }
+    return roads;
+  }
+
+  // 道路上各车道段中车道数的最大值，用于估计结果的容量
+  static size_t GetMaxLanesInSection(const Road &road) {
+    size_t result = 0u;
+    for (const auto &lane_section : road.GetLaneSections()) {
+      result = std::max(result, lane_section.GetLanes().size());
+    }
+    return result;
+  }
+
   // 获取车道开始位置的距离
   static double GetDistanceAtStartOfLane(const Lane &lane) {
     if (lane.GetId() <= 0) { // 如果车道ID小于等于0
@@ -161,6 +207,62 @@ static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
     return section.ContainsLane(waypoint.lane_id); // 检查车道是否存在
 }
 
+/// 将 @a value 的低 32 位分散到结果的偶数位上，用于计算 Morton 码。
+static uint64_t SpreadBits(uint64_t value) {
+    value &= 0xFFFFFFFFull;
+    value = (value | (value << 16u)) & 0x0000FFFF0000FFFFull;
+    value = (value | (value << 8u)) & 0x00FF00FF00FF00FFull;
+    value = (value | (value << 4u)) & 0x0F0F0F0F0F0F0F0Full;
+    value = (value | (value << 2u)) & 0x3333333333333333ull;
+    value = (value | (value << 1u)) & 0x5555555555555555ull;
+    return value;
+}
+
+/// 返回 @a locations 的索引，按位置所在网格在 XY 平面上的 Morton 码排序。
+/// 相邻的查询访问R树中相同的节点，这些节点更可能留在缓存中。
+static std::vector<size_t> SortSpatially(const std::vector<geom::Location> &locations) {
+    constexpr float cell_size = 10.0f;
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    for (const auto &location : locations) {
+        min_x = std::min(min_x, location.x);
+        min_y = std::min(min_y, location.y);
+    }
+    std::vector<std::pair<uint64_t, size_t>> keys;
+    keys.reserve(locations.size());
+    for (size_t i = 0u; i < locations.size(); ++i) {
+        const auto cell_x = static_cast<uint64_t>((locations[i].x - min_x) / cell_size);
+        const auto cell_y = static_cast<uint64_t>((locations[i].y - min_y) / cell_size);
+        keys.emplace_back(SpreadBits(cell_x) | (SpreadBits(cell_y) << 1u), i);
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<size_t> order;
+    order.reserve(keys.size());
+    for (const auto &key : keys) {
+        order.push_back(key.second);
+    }
+    return order;
+}
+
+/// 对 @a locations 中的每个位置调用 @a query，同一块中的查询在空间上相邻，
+/// 不同的块在多个线程中执行。
+template <typename QueryT>
+static std::vector<boost::optional<Waypoint>> RunBatchedQuery(
+    const std::vector<geom::Location> &locations,
+    QueryT &&query) {
+    constexpr size_t block_size = 64u;
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    const auto order = SortSpatially(locations);
+    const size_t number_of_blocks = (order.size() + block_size - 1u) / block_size;
+    ParallelFor(number_of_blocks, [&](const size_t block) {
+        const size_t end = std::min(order.size(), (block + 1u) * block_size);
+        for (size_t i = block * block_size; i < end; ++i) {
+            result[order[i]] = query(locations[order[i]]);
+        }
+    }, 1u);
+    return result;
+}
+
 // ===========================================================================
 // -- 地图: 几何 -------------------------------------------------------------
 // ===========================================================================
@@ -233,6 +335,22 @@ boost::optional<Waypoint> Map::GetWaypoint(
     return boost::optional<Waypoint>{}; // 否则返回空
 }
 
+std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type) const {
+    return RunBatchedQuery(locations, [&](const geom::Location &location) {
+        return GetClosestWaypointOnRoad(location, lane_type);
+    });
+}
+
+std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+    const std::vector<geom::Location> &locations,
+    int32_t lane_type) const {
+    return RunBatchedQuery(locations, [&](const geom::Location &location) {
+        return GetWaypoint(location, lane_type);
+    });
+}
+
 boost::optional<Waypoint> Map::GetWaypoint(
     RoadId road_id,
     LaneId lane_id,
@@ -337,106 +455,174 @@ std::vector<Map::SignalSearchData> Map::GetSignalsInDistance(
 
   const auto &lane = GetLane(waypoint); // 获取Waypoint对应的车道
   const bool forward = (waypoint.lane_id <= 0); // 判断移动方向
-  const double signed_distance = forward ? distance : -distance; // 根据方向设置带符号的距离
   const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对s
   const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 计算剩余车道长度
   DEBUG_ASSERT(remaining_lane_length >= 0.0); // 确保剩余长度非负
 
-  auto &road =_data.GetRoad(waypoint.road_id); // 获取对应的道路
+  // 如果减去距离后仍在同一车道，只搜索到该距离；否则搜索到车道末端再查看后继
+  const bool ends_in_lane = distance <= remaining_lane_length;
+  const double searched_length = ends_in_lane ? distance : remaining_lane_length;
+  const double end_s = waypoint.s + (forward ? searched_length : -searched_length);
+
   std::vector<SignalSearchData> result; // 存储结果信号数据的向量
+  for (auto *signal : GetLaneSignalsInRange(waypoint.road_id, waypoint.lane_id, waypoint.s, end_s)) {
+    const double distance_to_signal = waypoint.lane_id < 0 ?
+        signal->GetDistance() - waypoint.s : // 计算信号与Waypoint的距离
+        waypoint.s - signal->GetDistance();
+    if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
+      result.emplace_back(SignalSearchData{signal, waypoint, distance_to_signal});
+    } else {
+      result.emplace_back(SignalSearchData // 获取信号处的Waypoint
+          {signal, GetNext(waypoint, distance_to_signal).front(), distance_to_signal});
+    }
+  }
+  if (ends_in_lane) {
+    return result; // 返回结果
+  }
 
-  // 如果减去距离后仍在同一车道，则返回同一Waypoint和额外距离
-  if (distance <= remaining_lane_length) {
-    auto signals = road.GetInfosInRange<RoadInfoSignal>(
-        waypoint.s, waypoint.s + signed_distance); // 在指定范围内获取信号信息
-    for(auto* signal : signals){ // 遍历所有信号
-      double distance_to_signal = 0;
-      if (waypoint.lane_id < 0){ // 判断车道方向
-        distance_to_signal = signal->GetDistance() - waypoint.s; // 计算信号与Waypoint的距离
-      } else {
-        distance_to_signal = waypoint.s - signal->GetDistance(); // 计算信号与Waypoint的距离
-      }
-      // 检查信号是否影响Waypoint
-      bool is_valid = false; // 初始化有效性标志为false
-      for (auto &validity : signal->GetValidities()) { // 遍历信号的有效性范围
-        if (waypoint.lane_id >= validity._from_lane && // 检查Waypoint的lane_id是否在有效范围内
-            waypoint.lane_id <= validity._to_lane) {
-          is_valid = true; // 有效性标志设为true
-          break; // 结束循环
-        }
-      }
- if(!is_valid){ // 如果信号不有效
-    continue; // 跳过当前循环，继续下一个信号
-}
-if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
-    result.emplace_back(SignalSearchData // 添加信号数据到结果中
-        {signal, waypoint, // 将信号和Waypoint放入SignalSearchData结构中
-        distance_to_signal}); // 记录距离为0
-} else {
-    result.emplace_back(SignalSearchData // 添加信号数据到结果中
-        {signal, GetNext(waypoint, distance_to_signal).front(), // 获取下一个Waypoint并存储
-        distance_to_signal}); // 记录与信号的距离
+  // 如果剩余车道长度用尽，必须查看后继
+  const auto successors = _signal_successors.find(&lane);
+  if (successors == _signal_successors.end()) {
+    return result;
+  }
+  for (const auto &successor : successors->second) { // 遍历Waypoint的后继节点
+    if (successor.is_junction && stop_at_junction) { // 如果后继是交叉口并且需要停止
+      continue; // 跳过此后继
+    }
+    auto sucessor_signals = GetSignalsInDistance( // 获取后继信号在指定距离内的信号
+        successor.waypoint, distance - remaining_lane_length, stop_at_junction);
+    for (auto &signal : sucessor_signals) { // 遍历后继信号
+      signal.accumulated_s += remaining_lane_length; // 更新累积的s值
+    }
+    result = ConcatVectors(result, sucessor_signals); // 合并结果信号和后继信号
+  }
+  return result; // 返回结果
 }
 
+static uint64_t MakeLaneSignalKey(const RoadId road_id, const LaneId lane_id) {
+  return (static_cast<uint64_t>(road_id) << 32u) | static_cast<uint32_t>(lane_id);
 }
-return result; // 返回结果
 
-const double signed_remaining_length = forward ? remaining_lane_length : -remaining_lane_length; // 根据方向设置带符号的剩余长度
+// 交通灯、停车和让行标志决定车辆能否通过
+static bool IsControllingSignal(const RoadInfoSignal &signal_reference) {
+  const Signal *signal = signal_reference.GetSignal();
+  if (signal == nullptr) {
+    return false;
+  }
+  const auto &type = signal->GetType();
+  return SignalType::IsTrafficLight(type) ||
+         type == SignalType::StopSign() ||
+         type == SignalType::YieldSign();
+}
 
-//result = road.GetInfosInRange<RoadInfoSignal>(waypoint.s, waypoint.s + signed_remaining_length); // 注释掉的代码：获取信号信息
+void Map::BuildSignalIndex() {
+  _lane_signals.clear();
+  _lane_controlling_signals.clear();
+  _signal_successors.clear();
+  for (const auto &road_pair : _data.GetRoads()) {
+    const auto &road = road_pair.second;
+    // 道路上的信号已经按 s 排序，按有效范围分到每条车道
+    const auto signals = road.GetInfos<RoadInfoSignal>();
+    for (const auto &section : road.GetLaneSections()) {
+      for (const auto &lane_pair : section.GetLanes()) {
+        const auto lane_id = lane_pair.first;
+        if (lane_id == 0) {
+          continue;
+        }
+        const auto key = MakeLaneSignalKey(road.GetId(), lane_id);
+        if (_lane_signals.find(key) == _lane_signals.end()) {
+          auto &lane_signals = _lane_signals[key];
+          for (auto *signal : signals) {
+            for (auto &validity : signal->GetValidities()) {
+              if (lane_id >= validity._from_lane && lane_id <= validity._to_lane) {
+                lane_signals.emplace_back(signal);
+                break;
+              }
+            }
+          }
+          std::vector<const RoadInfoSignal *> controlling_signals;
+          for (auto *signal : lane_signals) {
+            if (IsControllingSignal(*signal)) {
+              controlling_signals.emplace_back(signal);
+            }
+          }
+          if (!controlling_signals.empty()) {
+            _lane_controlling_signals.emplace(key, std::move(controlling_signals));
+          }
+        }
 
-auto signals = road.GetInfosInRange<RoadInfoSignal>( // 在指定范围内获取信号信息
-    waypoint.s, waypoint.s + signed_remaining_length);
-for(auto* signal : signals){ // 遍历所有信号
-    double distance_to_signal = 0; // 初始化信号与Waypoint的距离
-    if (waypoint.lane_id < 0){ // 判断车道方向
-        distance_to_signal = signal->GetDistance() - waypoint.s; // 计算信号与Waypoint的距离
-    } else {
-        distance_to_signal = waypoint.s - signal->GetDistance(); // 计算信号与Waypoint的距离
-    }
-    // 检查信号是否影响Waypoint
-    bool is_valid = false; // 初始化有效性标志为false
-    for (auto &validity : signal->GetValidities()) { // 遍历信号的有效性范围
-        if (waypoint.lane_id >= validity._from_lane && // 检查Waypoint的lane_id是否在有效范围内
-            waypoint.lane_id <= validity._to_lane) {
-            is_valid = true; // 有效性标志设为true
-            break; // 结束循环
+        // 后继的 s 移到沿行驶方向进入后继车道的一端
+        const auto &lane = lane_pair.second;
+        const Waypoint waypoint{road.GetId(), section.GetId(), lane_id, GetDistanceAtEndOfLane(lane)};
+        auto &successors = _signal_successors[&lane];
+        for (auto successor : GetSuccessors(waypoint)) {
+          const auto &successor_road = _data.GetRoad(successor.road_id);
+          const auto &successor_lane = successor_road.GetLaneByDistance(successor.s, successor.lane_id);
+          if (successor.lane_id < 0) {
+            successor.s = successor_lane.GetDistance();
+          } else {
+            successor.s = successor_lane.GetDistance() + successor_lane.GetLength();
+          }
+          successors.emplace_back(SignalSearchSuccessor{successor, successor_road.IsJunction()});
         }
+      }
     }
-    if(!is_valid){ // 如果信号无效
-        continue; // 跳过当前信号
-    }
-    if (distance_to_signal == 0) { // 如果信号与Waypoint的距离为0
-        result.emplace_back(SignalSearchData // 添加信号数据到结果中
-            {signal, waypoint, // 将信号和Waypoint放入SignalSearchData结构中
-            distance_to_signal}); // 记录距离为0
-    } else {
-        result.emplace_back(SignalSearchData // 添加信号数据到结果中
-            {signal, GetNext(waypoint, distance_to_signal).front(), // 获取下一个Waypoint并存储
-            distance_to_signal}); // 记录与信号的距离
-    }
+  }
 }
 
-// 如果剩余车道长度用尽，必须查看后继
-for (auto &successor : GetSuccessors(waypoint)) { // 遍历Waypoint的后继节点
-    if(_data.GetRoad(successor.road_id).IsJunction() && stop_at_junction){ // 如果后继是交叉口并且需要停止
-        continue; // 跳过此后继
-    }
-    auto& sucessor_lane = _data.GetRoad(successor.road_id). // 获取后继车道
-        GetLaneByDistance(successor.s, successor.lane_id);
-    if (successor.lane_id < 0) { // 如果后继车道ID为负
-        successor.s = sucessor_lane.GetDistance(); // 设置后继s为车道的起始距离
-    } else {
-        successor.s = sucessor_lane.GetDistance() + sucessor_lane.GetLength(); // 设置后继s为车道的结束距离
-    }
-    auto sucessor_signals = GetSignalsInDistance( // 获取后继信号在指定距离内的信号
-        successor, distance - remaining_lane_length, stop_at_junction);
-    for(auto& signal : sucessor_signals){ // 遍历后继信号
-        signal.accumulated_s += remaining_lane_length; // 更新累积的s值
-    }
-    result = ConcatVectors(result, sucessor_signals); // 合并结果信号和后继信号
+std::vector<const element::RoadInfoSignal *> Map::GetLaneSignalsInRange(
+    const RoadId road_id,
+    const LaneId lane_id,
+    const double min_s,
+    const double max_s) const {
+  std::vector<const element::RoadInfoSignal *> result;
+  const auto it = _lane_signals.find(MakeLaneSignalKey(road_id, lane_id));
+  if (it == _lane_signals.end()) {
+    return result;
+  }
+  const auto &signals = it->second;
+  const auto less_s = [](const element::RoadInfoSignal *signal, const double s) {
+    return signal->GetDistance() < s;
+  };
+  const auto s_less = [](const double s, const element::RoadInfoSignal *signal) {
+    return s < signal->GetDistance();
+  };
+  const double low = std::min(min_s, max_s);
+  const double high = std::max(min_s, max_s);
+  const auto begin = std::lower_bound(signals.begin(), signals.end(), low, less_s);
+  const auto end = std::upper_bound(begin, signals.end(), high, s_less);
+  if (min_s < max_s) {
+    result.assign(begin, end);
+  } else {
+    result.assign(std::make_reverse_iterator(end), std::make_reverse_iterator(begin));
+  }
+  return result;
 }
-return result; // 返回结果
+
+const std::vector<const element::RoadInfoSignal *> &Map::GetLaneControllingSignals(
+    const RoadId road_id,
+    const LaneId lane_id) const {
+  static const std::vector<const element::RoadInfoSignal *> empty;
+  const auto it = _lane_controlling_signals.find(MakeLaneSignalKey(road_id, lane_id));
+  return it == _lane_controlling_signals.end() ? empty : it->second;
+}
+
+const element::RoadInfoSignal *Map::GetNextControllingSignal(const Waypoint &waypoint) const {
+  const auto &signals = GetLaneControllingSignals(waypoint.road_id, waypoint.lane_id);
+  if (waypoint.lane_id <= 0) {
+    // s 增加的方向行驶，第一个 s >= waypoint.s 的信号
+    const auto it = std::lower_bound(signals.begin(), signals.end(), waypoint.s,
+        [](const element::RoadInfoSignal *signal, const double s) {
+          return signal->GetDistance() < s;
+        });
+    return it == signals.end() ? nullptr : *it;
+  }
+  // s 减小的方向行驶，最后一个 s <= waypoint.s 的信号
+  const auto it = std::upper_bound(signals.begin(), signals.end(), waypoint.s,
+      [](const double s, const element::RoadInfoSignal *signal) {
+        return s < signal->GetDistance();
+      });
+  return it == signals.begin() ? nullptr : *std::prev(it);
 }
 
 std::vector<const element::RoadInfoSignal*> // 获取所有信号引用
@@ -624,6 +810,49 @@ std::vector<Waypoint> Map::GetNext(
     return result; // 返回所有找到的waypoints
   }
 
+  std::vector<Waypoint> Map::SampleLane(
+      Waypoint waypoint,
+      const double distance,
+      const size_t max_count,
+      const bool forward,
+      const bool until_lane_end) const {
+    RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
+    const RoadId road_id = waypoint.road_id;
+    std::vector<Waypoint> result;
+    result.reserve(max_count);
+    bool reached_road_end = false;
+    while (result.size() < max_count) {
+      auto next = forward ? GetNext(waypoint, distance) : GetPrevious(waypoint, distance);
+      if (next.empty()) {
+        break;
+      }
+      if (until_lane_end && (next.size() != 1u || next.front().road_id != road_id)) {
+        reached_road_end = true;
+        break;
+      }
+      waypoint = next.front();
+      result.emplace_back(waypoint);
+    }
+
+    // 最后一个路点放在车道末端
+    if (reached_road_end && result.size() < max_count) {
+      const double road_length = _data.GetRoad(road_id).GetLength();
+      const bool increasing_s = (forward == (waypoint.lane_id <= 0));
+      const double remaining_length =
+          (increasing_s ? road_length - waypoint.s : waypoint.s) -
+          std::numeric_limits<double>::epsilon();
+      if (remaining_length > 0.0) {
+        auto end = forward ?
+            GetNext(waypoint, remaining_length) :
+            GetPrevious(waypoint, remaining_length);
+        if (!end.empty()) {
+          result.emplace_back(end.front());
+        }
+      }
+    }
+    return result;
+  }
+
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0); // 确保车道ID不为0
     if (waypoint.lane_id > 0) { // 如果当前车道ID为正
@@ -648,16 +877,21 @@ std::vector<Waypoint> Map::GetNext(
 
   std::vector<Waypoint> Map::GenerateWaypoints(const double distance) const {
     RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
-    std::vector<Waypoint> result; // 存储生成的waypoints
-    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
+    // 各条道路在多个线程中处理，再按道路的顺序合并，结果与逐条生成相同
+    const auto roads = GetRoadList(_data);
+    std::vector<std::vector<Waypoint>> road_waypoints(roads.size());
+    ParallelFor(roads.size(), [&](const size_t i) {
+      const auto &road = *roads[i]; // 获取当前道路
+      auto &waypoints = road_waypoints[i];
+      waypoints.reserve(
+          (static_cast<size_t>(road.GetLength() / distance) + 1u) * GetMaxLanesInSection(road));
       for (double s = EPSILON; s < (road.GetLength() - EPSILON); s += distance) { // 从0到道路长度生成waypoints
         ForEachDrivableLaneAt(road, s, [&](auto &&waypoint) { // 对每个可驾驶车道执行操作
-          result.emplace_back(waypoint); // 将waypoint添加到结果中
+          waypoints.emplace_back(waypoint); // 将waypoint添加到结果中
         });
       }
-    }
-    return result; // 返回生成的waypoints
+    }, 16u);
+    return FlattenVectors(road_waypoints); // 返回生成的waypoints
   }
 
  std::vector<Waypoint> Map::GenerateWaypointsOnRoadEntries(Lane::LaneType lane_type) const {
@@ -723,9 +957,13 @@ std::vector<Waypoint> Map::GenerateWaypointsInRoad(
 }
 
 std::vector<std::pair<Waypoint, Waypoint>> Map::GenerateTopology() const {
-    std::vector<std::pair<Waypoint, Waypoint>> result; // 创建一个空的 Waypoint 对向量来存储结果
-    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
-        const auto &road = pair.second; // 获取当前道路
+    // 各条道路在多个线程中处理，再按道路的顺序合并，结果与逐条生成相同
+    const auto roads = GetRoadList(_data);
+    std::vector<std::vector<std::pair<Waypoint, Waypoint>>> road_topology(roads.size());
+    ParallelFor(roads.size(), [&](const size_t i) {
+        const auto &road = *roads[i]; // 获取当前道路
+        auto &result = road_topology[i];
+        result.reserve(road.GetLaneSections().size() * GetMaxLanesInSection(road));
         ForEachDrivableLane(road, [&](auto &&waypoint) { // 对每个可驾驶车道执行操作
             auto successors = GetSuccessors(waypoint); // 获取当前 waypoint 的后继 waypoint
             if (successors.size() == 0) { // 如果没有后继
@@ -735,13 +973,13 @@ std::vector<std::pair<Waypoint, Waypoint>> Map::GenerateTopology() const {
                     result.push_back({waypoint, *last_waypoint}); // 添加到结果
                 }
             } else { // 如果有后继
-                for (auto &&successor : GetSuccessors(waypoint)) { // 遍历所有后继
+                for (auto &&successor : successors) { // 遍历所有后继
                     result.push_back({waypoint, successor}); // 添加到结果
                 }
             }
         });
-    }
-    return result; // 返回生成的 waypoint 对向量
+    }, 16u);
+    return FlattenVectors(road_topology); // 返回生成的 waypoint 对向量
 }
 
 
@@ -890,7 +1128,29 @@ double GetRemainingLength(const Lane &lane, double current_s) {
 }
 
 // 创建R树
+// 每条车道在每个车道段的起始位置的路点
+static std::vector<Waypoint> GetLaneStartWaypoints(const Road &road) {
+    std::vector<Waypoint> result;
+    ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
+        if (waypoint.lane_id != 0) { // 排除ID为0的车道
+            result.push_back(waypoint);
+        }
+    });
+    return result;
+}
+
 void Map::CreateRtree() {
+    // 在每条车道的起始位置生成Waypoints
+    std::vector<Waypoint> topology; // 存储所有Waypoints
+    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
+        const auto lane_starts = GetLaneStartWaypoints(pair.second);
+        topology.insert(topology.end(), lane_starts.begin(), lane_starts.end());
+    }
+    // 将段添加到R树
+    _rtree.Build(CreateRtreeElements(topology));
+}
+
+std::vector<Map::Rtree::TreeElement> Map::CreateRtreeElements(const std::vector<Waypoint> &lane_starts) {
     const double epsilon = 0.000001; // 设置一个小的增量以防止数值误差
     const double min_delta_s = 1;    // 每个段的最小长度为1米
 
@@ -899,106 +1159,131 @@ void Map::CreateRtree() {
     // 线段的最大长度
     constexpr double max_segment_length = 100.0;
 
-    // 在每条车道的起始位置生成Waypoints
-    std::vector<Waypoint> topology; // 存储所有Waypoints
-    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
-        const auto &road = pair.second; // 获取道路信息
-        // 对每条车道进行操作
-        ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
-            if(waypoint.lane_id != 0) { // 排除ID为0的车道
-                topology.push_back(waypoint); // 将Waypoint加入到topology中
-            }
-        });
-    }
-}
-
-// 段和路点的容器
-std::vector<Rtree::TreeElement> rtree_elements;
+    // 段和路点的容器
+    std::vector<Rtree::TreeElement> rtree_elements;
 
-// 遍历所有车道
-for (auto &waypoint : topology) {
-    auto &lane_start_waypoint = waypoint; // 车道起始路点
+    // 遍历所有车道
+    for (auto &waypoint : lane_starts) {
+        auto &lane_start_waypoint = waypoint; // 车道起始路点
 
-    auto current_waypoint = lane_start_waypoint; // 当前路点
+        auto current_waypoint = lane_start_waypoint; // 当前路点
 
-    const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
+        const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
 
-    geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
-
-    // 在直线段中节省计算时间
-    if (lane.IsStraight()) { // 如果车道是直的
-        double delta_s = min_delta_s; // 初始化增量距离
-        double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
-        remaining_length -= epsilon; // 减去一个小值以避免数值问题
-        delta_s = remaining_length; // 更新增量距离
-        if (delta_s < epsilon) { // 如果增量距离小于阈值
-            continue; // 跳过此轮
-        }
-        auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
-
-        RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
-        auto next_waypoint = next.front(); // 下一个路点
-
-        AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // 到达车道末尾
-    } else {
-        auto next_waypoint = current_waypoint; // 初始化下一个路点
+        geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
 
-        // 循环直到车道末尾
-        // 按小的s增量前进
-        while (true) {
+        // 在直线段中节省计算时间
+        if (lane.IsStraight()) { // 如果车道是直的
             double delta_s = min_delta_s; // 初始化增量距离
-            double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
+            double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
             remaining_length -= epsilon; // 减去一个小值以避免数值问题
-            delta_s = std::min(delta_s, remaining_length); // 更新增量距离
-
+            delta_s = remaining_length; // 更新增量距离
             if (delta_s < epsilon) { // 如果增量距离小于阈值
-                AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
+                continue; // 跳过此轮
             }
+            auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
+
+            RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
+            RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
+            auto next_waypoint = next.front(); // 下一个路点
+
+            AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
+                rtree_elements,
+                current_transform,
+                current_waypoint,
+                next_waypoint);
+            // 到达车道末尾
+        } else {
+            auto next_waypoint = current_waypoint; // 初始化下一个路点
+
+            // 循环直到车道末尾
+            // 按小的s增量前进
+            while (true) {
+                double delta_s = min_delta_s; // 初始化增量距离
+                double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
+                remaining_length -= epsilon; // 减去一个小值以避免数值问题
+                delta_s = std::min(delta_s, remaining_length); // 更新增量距离
+
+                if (delta_s < epsilon) { // 如果增量距离小于阈值
+                    AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
+                        rtree_elements,
+                        current_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    break; // 退出循环
+                }
 
-            auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
-            if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
-                current_waypoint.section_id != next.front().section_id) {
-                AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
-            }
+                auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
+                if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
+                    current_waypoint.section_id != next.front().section_id) {
+                    AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
+                        rtree_elements,
+                        current_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    break; // 退出循环
+                }
 
-            next_waypoint = next.front(); // 更新下一个路点
-            geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
-            double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
-                current_transform.GetForwardVector(), next_transform.GetForwardVector());
-
-            if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
-                std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
-                AddElementToRtree( // 将当前和下一个路点的变换添加到R树
-                    rtree_elements,
-                    current_transform,
-                    next_transform,
-                    current_waypoint,
-                    next_waypoint);
-                current_waypoint = next_waypoint; // 更新当前路点
-                current_transform = next_transform; // 更新当前变换
+                next_waypoint = next.front(); // 更新下一个路点
+                geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
+                double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
+                    current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+                if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
+                    std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
+                    AddElementToRtree( // 将当前和下一个路点的变换添加到R树
+                        rtree_elements,
+                        current_transform,
+                        next_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    current_waypoint = next_waypoint; // 更新当前路点
+                    current_transform = next_transform; // 更新当前变换
+                }
             }
         }
     }
+    return rtree_elements;
 }
 
-// 将段添加到R树
-_rtree.InsertElements(rtree_elements);
+Map::Map(MapData m, const Map &previous) : _data(std::move(m)) {
+    // 按源哈希比较两个版本中的道路，哈希未知的道路视为已修改
+    std::vector<Waypoint> lane_starts;
+    std::unordered_set<RoadId> unchanged_roads;
+    for (const auto &pair : _data.GetRoads()) {
+        const auto &road = pair.second;
+        const auto &previous_roads = previous._data.GetRoads();
+        const auto it = previous_roads.find(road.GetId());
+        if (it == previous_roads.end()) {
+            _update.added_roads.push_back(road.GetId());
+        } else if (road.GetSourceHash() == 0u || road.GetSourceHash() != it->second.GetSourceHash()) {
+            _update.replaced_roads.push_back(road.GetId());
+        } else {
+            unchanged_roads.insert(road.GetId());
+            continue;
+        }
+        const auto road_lane_starts = GetLaneStartWaypoints(road);
+        lane_starts.insert(lane_starts.end(), road_lane_starts.begin(), road_lane_starts.end());
+    }
+    for (const auto &pair : previous._data.GetRoads()) {
+        if (!_data.ContainsRoad(pair.first)) {
+            _update.removed_roads.push_back(pair.first);
+        }
+    }
+    std::sort(_update.added_roads.begin(), _update.added_roads.end());
+    std::sort(_update.removed_roads.begin(), _update.removed_roads.end());
+    std::sort(_update.replaced_roads.begin(), _update.replaced_roads.end());
+
+    // 未变化道路的R树元素只依赖道路自身的几何和车道，可以直接重用
+    auto rtree_elements = CreateRtreeElements(lane_starts);
+    for (const auto &element : previous._rtree.GetElements()) {
+        if (unchanged_roads.count(element.second.first.road_id) > 0u) {
+            rtree_elements.push_back(element);
+        }
+    }
+    _rtree.Build(rtree_elements);
+    BuildSignalIndex();
+}
 
 Junction* Map::GetJunction(JuncId id) { // 获取交叉口
     return _data.GetJunction(id); // 返回指定ID的交叉口
@@ -1069,24 +1354,33 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
     geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
     std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list; // 定义输出网格列表
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map; // 定义用于存储交叉口网格的哈希映射
+    // 各条道路的网格在多个线程中生成，再按原来的顺序合并，结果与逐条生成相同
+    std::vector<const Road *> roads; // 不在交叉口内的道路
     for (auto &&pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
-      if (!road.IsJunction()) { // 如果该道路不是交叉口
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road); // 生成道路的所有网格
-
-        // 将生成的道路网格添加到输出网格列表中
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+      if (!pair.second.IsJunction()) { // 如果该道路不是交叉口
+        roads.push_back(&pair.second);
       }
     }
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> road_mesh_lists(roads.size());
+    ParallelFor(roads.size(), [&](const size_t i) {
+      road_mesh_lists[i] = mesh_factory.GenerateAllWithMaxLen(*roads[i]); // 生成道路的所有网格
+    }, 1u);
+    for (auto &road_mesh_list : road_mesh_lists) {
+      // 将生成的道路网格添加到输出网格列表中
+      out_mesh_list.insert(
+          out_mesh_list.end(),
+          std::make_move_iterator(road_mesh_list.begin()),
+          std::make_move_iterator(road_mesh_list.end()));
+    }
 
     // 生成交叉口内的道路并进行光滑处理
+    std::vector<const Junction *> junctions;
     for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
+      junctions.push_back(&junc_pair.second);
+    }
+    std::vector<std::unique_ptr<geom::Mesh>> junction_meshes(junctions.size());
+    ParallelFor(junctions.size(), [&](const size_t junction_index) {
+      const auto &junction = *junctions[junction_index]; // 获取当前交叉口
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
       std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
       for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
@@ -1108,7 +1402,7 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
         for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
           *merged_mesh += *lane; // 将人行道网格添加到合并网格中
         }
-        out_mesh_list.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
+        junction_meshes[junction_index] = std::move(merged_mesh); // 保存合并后的网格
       } else {
         std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
         for(auto& lane : lane_meshes) { // 遍历车道网格
@@ -1117,9 +1411,13 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
         for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
           *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
         }
-        out_mesh_list.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
+        junction_meshes[junction_index] = std::move(junction_mesh); // 保存交叉口网格
       }
-    }
+    }, 1u);
+    out_mesh_list.insert( // 将交叉口网格按原来的顺序添加到输出列表
+        out_mesh_list.end(),
+        std::make_move_iterator(junction_meshes.begin()),
+        std::make_move_iterator(junction_meshes.end()));
 
     // 找到输出网格的最小和最大位置
     auto min_pos = geom::Vector2D(
@@ -1155,74 +1453,192 @@ Map::GenerateOrderedChunkedMeshInLocations(const rpc::OpendriveGenerationParamet
                                             const geom::Vector3D& minpos,
                                             const geom::Vector3D& maxpos) const
 {
-    geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
     std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> road_out_mesh_list; // 存储道路类型对应的网格列表
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> junction_out_mesh_list; // 存储交叉口类型对应的网格列表
-
-    // 创建一个线程来生成交叉口的网格
-    std::thread junction_thread(&Map::GenerateJunctions, this, mesh_factory, params,
-                                 minpos, maxpos, &junction_out_mesh_list);
+    // 回调是串行调用的，不需要加锁
+    GenerateOrderedChunkedMeshInLocations(params, minpos, maxpos, [&](MeshChunk &&chunk) {
+        for (auto&& pair : chunk.meshes) { // 遍历分块中各车道类型的网格
+            auto &mesh_list = road_out_mesh_list[pair.first];
+            mesh_list.insert(mesh_list.end(),
+                             std::make_move_iterator(pair.second.begin()),
+                             std::make_move_iterator(pair.second.end()));
+        }
+    });
+    return road_out_mesh_list; // 返回生成的道路网格列表
+}
 
-    // 根据位置过滤需要生成的道路ID
-    const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
+void Map::GenerateOrderedChunkedMeshInLocations(
+    const rpc::OpendriveGenerationParameters& params,
+    const geom::Vector3D& minpos,
+    const geom::Vector3D& maxpos,
+    const MeshChunkCallback &callback) const
+{
+    GenerateOrderedChunkedMeshInLocations(params, minpos, maxpos, {}, callback);
+}
 
-    size_t num_roads = RoadsIDToGenerate.size(); // 获取需要生成的道路数量
-    size_t num_roads_per_thread = 30; // 每个线程处理的道路数量
-    size_t num_threads = (num_roads / num_roads_per_thread) + 1; // 计算所需线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 确保至少有一个线程
-    std::vector<std::thread> workers; // 存储工作线程
-    std::mutex write_mutex; // 互斥量，用于保护写操作
-    std::cout << "Generating " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成道路数量
-
-    for (size_t i = 0; i < num_threads; ++i) { // 为每个线程创建工作任务
-        std::thread new_worker(
-            [this, &write_mutex, &mesh_factory, &RoadsIDToGenerate, &road_out_mesh_list, i, num_roads_per_thread]() {
-                // 生成当前线程的道路网格
-                std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> Current =
-                    std::move(GenerateRoadsMultithreaded(mesh_factory, RoadsIDToGenerate, i, num_roads_per_thread));
-                
-                std::lock_guard<std::mutex> guard(write_mutex); // 锁住互斥量以进行安全写入
-                
-                for (auto&& pair : Current) { // 遍历当前线程生成的网格
-                    if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-                        // 如果已存在，合并网格
-                        road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                              std::make_move_iterator(pair.second.begin()),
-                                                              std::make_move_iterator(pair.second.end()));
-                    } else {
-                        // 如果不存在，直接添加
-                        road_out_mesh_list[pair.first] = std::move(pair.second);
-                    }
-                }
-            });
-        workers.push_back(std::move(new_worker)); // 将新线程添加到工作线程列表中
+void Map::GetMeshGenerationBounds(geom::Vector3D &minpos, geom::Vector3D &maxpos) const
+{
+    // 与 FilterRoadsByPosition 和 FilterJunctionsByPosition 判断位置的点相同
+    std::vector<geom::Location> locations;
+    for (const auto &pair : _data.GetRoads()) {
+        const auto &lane_section = *pair.second.GetLaneSections().begin();
+        const road::Lane *lane = lane_section.GetLane(-1);
+        if (lane != nullptr) {
+            const double s_check = lane_section.GetDistance() + lane_section.GetLength() * 0.5;
+            locations.push_back(lane->ComputeTransform(s_check).location);
+        }
     }
+    for (const auto &pair : _data.GetJunctions()) {
+        locations.push_back(pair.second.GetBoundingBox().location);
+    }
+    if (locations.empty()) {
+        minpos = maxpos = geom::Vector3D();
+        return;
+    }
+    minpos = maxpos = locations.front();
+    for (const auto &location : locations) {
+        minpos.x = std::min(minpos.x, location.x);
+        maxpos.x = std::max(maxpos.x, location.x);
+        minpos.y = std::max(minpos.y, location.y);
+        maxpos.y = std::min(maxpos.y, location.y);
+    }
+    // 过滤时比较是严格的，边界上的点需要留出余量
+    constexpr float margin = 1.0f;
+    minpos.x -= margin;
+    minpos.y += margin;
+    maxpos.x += margin;
+    maxpos.y -= margin;
+}
 
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有工作线程完成
-        workers[i].join(); // 加入线程
-    }
-    workers.clear(); // 清空工作线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 再次检查线程并确保它们已加入
-        if (workers[i].joinable()) {
-            workers[i].join(); // 如果可加入则加入
+void Map::GenerateOrderedChunkedMeshInLocations(
+    const rpc::OpendriveGenerationParameters& params,
+    const geom::Vector3D& minpos,
+    const geom::Vector3D& maxpos,
+    const std::vector<geom::Location>& focus,
+    const MeshChunkCallback &callback) const
+{
+    DEBUG_ASSERT(callback != nullptr);
+    geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
+
+    // 与 FilterRoadsByPosition 相同，y 轴方向上 minpos.y 大于 maxpos.y
+    const double chunk_size = std::max(params.max_road_length, 1.0);
+    const size_t chunks_x = static_cast<size_t>(std::max(maxpos.x - minpos.x, 0.0f) / chunk_size) + 1u;
+    const size_t chunks_y = static_cast<size_t>(std::max(minpos.y - maxpos.y, 0.0f) / chunk_size) + 1u;
+    const auto chunk_of = [&](const geom::Location &location) {
+        const auto x = std::min(
+            static_cast<size_t>(std::max(location.x - minpos.x, 0.0f) / chunk_size), chunks_x - 1u);
+        const auto y = std::min(
+            static_cast<size_t>(std::max(minpos.y - location.y, 0.0f) / chunk_size), chunks_y - 1u);
+        return x + chunks_x * y;
+    };
+
+    // 分块中心到最近的焦点在水平面上的距离的平方，没有焦点时为 0
+    const auto priority_of = [&](const size_t chunk) {
+        if (focus.empty()) {
+            return 0.0f;
         }
+        const float center_x = minpos.x + (static_cast<float>(chunk % chunks_x) + 0.5f) * static_cast<float>(chunk_size);
+        const float center_y = minpos.y - (static_cast<float>(chunk / chunks_x) + 0.5f) * static_cast<float>(chunk_size);
+        float result = std::numeric_limits<float>::max();
+        for (const auto &location : focus) {
+            const float dx = location.x - center_x;
+            const float dy = location.y - center_y;
+            result = std::min(result, dx * dx + dy * dy);
+        }
+        return result;
+    };
+
+    // 每项为一条道路或一个交叉口，按所在分块的优先级和位置排序，ParallelFor
+    // 大致按索引顺序分配，靠前的分块先完成
+    struct WorkItem {
+        size_t chunk;
+        bool is_junction;
+        uint32_t id;
+        float priority;
+    };
+    std::vector<WorkItem> items;
+    for (RoadId id : FilterRoadsByPosition(minpos, maxpos)) {
+        const auto &road = _data.GetRoads().at(id);
+        if (road.IsJunction()) {
+            continue;
+        }
+        const auto &lane_section = *road.GetLaneSections().begin();
+        const road::Lane *lane = lane_section.GetLane(-1); // 过滤后的道路一定有这条车道
+        const double s_check = lane_section.GetDistance() + lane_section.GetLength() * 0.5;
+        const auto chunk = chunk_of(lane->ComputeTransform(s_check).location);
+        items.push_back({chunk, false, id, priority_of(chunk)});
+    }
+    for (JuncId id : FilterJunctionsByPosition(minpos, maxpos)) {
+        const auto &junction = _data.GetJunctions().at(id);
+        const auto chunk = chunk_of(junction.GetBoundingBox().location);
+        items.push_back({chunk, true, static_cast<uint32_t>(id), priority_of(chunk)});
+    }
+    std::stable_sort(items.begin(), items.end(), [](const WorkItem &lhs, const WorkItem &rhs) {
+        return (lhs.priority < rhs.priority) ||
+            ((lhs.priority == rhs.priority) && (lhs.chunk < rhs.chunk));
+    });
+
+    // 各分块尚未完成的项数，chunks 中的分块按回调的顺序排列
+    struct PendingChunk {
+        size_t remaining = 0u;
+        MeshChunk chunk;
+    };
+    std::vector<PendingChunk> chunks;
+    std::vector<size_t> item_chunk(items.size());
+    for (size_t i = 0u; i < items.size(); ++i) {
+        if (chunks.empty() || (i > 0u && items[i].chunk != items[i - 1u].chunk)) {
+            chunks.emplace_back();
+            chunks.back().chunk.x = items[i].chunk % chunks_x;
+            chunks.back().chunk.y = items[i].chunk / chunks_x;
+        }
+        ++chunks.back().remaining;
+        item_chunk[i] = chunks.size() - 1u;
     }
 
-    junction_thread.join(); // 等待交叉口生成线程完成
-    for (auto&& pair : junction_out_mesh_list) { // 遍历交叉口生成的网格
-        if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) { // 检查类型是否已存在
-            // 如果已存在，合并交叉口网格
-            road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-                                                  std::make_move_iterator(pair.second.begin()),
-                                                  std::make_move_iterator(pair.second.end()));
+    std::mutex mutex;
+    size_t next_chunk = 0u;
+    bool emitting = false;
+    std::atomic<bool> failed{false};
+    ParallelFor(items.size(), [&](const size_t i) {
+        if (failed) {
+            return;
+        }
+        std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> meshes;
+        if (items[i].is_junction) {
+            GenerateSingleJunction(mesh_factory, static_cast<JuncId>(items[i].id), &meshes);
         } else {
-            // 如果不存在，直接添加
-            road_out_mesh_list[pair.first] = std::move(pair.second);
+            mesh_factory.GenerateAllOrderedWithMaxLen(_data.GetRoads().at(items[i].id), meshes);
         }
-    }
-    std::cout << "Generated " << std::to_string(num_roads) << " roads" << std::endl; // 输出生成完成的信息
 
-    return road_out_mesh_list; // 返回生成的道路网格列表
+        std::unique_lock<std::mutex> lock(mutex);
+        auto &pending = chunks[item_chunk[i]];
+        for (auto &&pair : meshes) {
+            auto &mesh_list = pending.chunk.meshes[pair.first];
+            mesh_list.insert(mesh_list.end(),
+                             std::make_move_iterator(pair.second.begin()),
+                             std::make_move_iterator(pair.second.end()));
+        }
+        --pending.remaining;
+        // 同一时间只有一个线程回调，回调期间其他线程完成的分块由它继续回调
+        if (emitting) {
+            return;
+        }
+        emitting = true;
+        while (next_chunk < chunks.size() && chunks[next_chunk].remaining == 0u) {
+            MeshChunk chunk = std::move(chunks[next_chunk].chunk);
+            ++next_chunk;
+            lock.unlock();
+            try {
+                callback(std::move(chunk));
+            } catch (...) {
+                failed = true;
+                lock.lock();
+                emitting = false;
+                throw;
+            }
+            lock.lock();
+        }
+        emitting = false;
+    }, 1u);
 }
 
 
@@ -1384,36 +1800,24 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateLineMarkings(
     std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos); // 根据位置过滤交叉口
     size_t num_junctions = JunctionsToGenerate.size(); // 交叉口数量
     std::cout << "Generating " << std::to_string(num_junctions) << " junctions" << std::endl; // 输出生成的交叉口数
-    size_t junctionindex = 0; // 交叉口索引初始化
-    size_t num_junctions_per_thread = 5; // 每个线程处理的交叉口数量
-    size_t num_threads = (num_junctions / num_junctions_per_thread) + 1; // 计算线程数
-    num_threads = num_threads > 1 ? num_threads : 1; // 至少一个线程
-    std::vector<std::thread> workers; // 线程列表
+    size_t num_junctions_per_thread = 5; // 每个任务处理的交叉口数量
+    size_t num_blocks = (num_junctions + num_junctions_per_thread - 1) / num_junctions_per_thread; // 任务数
     std::mutex write_mutex; // 互斥锁用于保护共享资源
 
-    for ( size_t i = 0; i < num_threads; ++i ) { // 创建并启动多个线程
-      std::thread neworker(
-        [this, &write_mutex, &mesh_factory, &junction_out_mesh_list, JunctionsToGenerate, i, num_junctions_per_thread, num_junctions]() {
-        std::map<road::Lane::LaneType, // 本线程内的交叉口列表
+    // 提交到共用的任务调度器，不为每个分块创建线程
+    ParallelFor(num_blocks, [&](const size_t i) {
+        std::map<road::Lane::LaneType, // 本任务内的交叉口列表
           std::vector<std::unique_ptr<geom::Mesh>>> junctionsofthisthread;
 
-        size_t minimum = 0; // 初始化最小值
-        if( (i + 1) * num_junctions_per_thread < num_junctions ){ // 如果还有交叉口需要处理
-          minimum = (i + 1) * num_junctions_per_thread; // 更新最小值
-        }else{
-          minimum = num_junctions; // 否则设置为总数量
-        }
-        std::cout << "Generating Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出当前线程处理的交叉口范围
-
-        for ( size_t junctionindex = i * num_junctions_per_thread; // 遍历本线程处理的交叉口
+        const size_t minimum = std::min((i + 1) * num_junctions_per_thread, num_junctions); // 本任务的结束索引
+        for ( size_t junctionindex = i * num_junctions_per_thread; // 遍历本任务处理的交叉口
                         junctionindex < minimum;
                         ++junctionindex )
         {
           GenerateSingleJunction(mesh_factory, JunctionsToGenerate[junctionindex], &junctionsofthisthread); // 生成单个交叉口
         }
-        std::cout << "Generated Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl; // 输出完成的交叉口范围
         std::lock_guard<std::mutex> guard(write_mutex); // 保护对共享数据的写操作
-        for ( auto&& pair : junctionsofthisthread ) { // 遍历本线程生成的交叉口
+        for ( auto&& pair : junctionsofthisthread ) { // 遍历本任务生成的交叉口
           if ((*junction_out_mesh_list).find(pair.first) != (*junction_out_mesh_list).end()) { // 如果该类型的交叉口已存在
             (*junction_out_mesh_list)[pair.first].insert((*junction_out_mesh_list)[pair.first].end(),
               std::make_move_iterator(pair.second.begin()), // 插入新的交叉口网格
@@ -1422,19 +1826,7 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateLineMarkings(
             (*junction_out_mesh_list)[pair.first] = std::move(pair.second); // 否则直接移动到输出列表
           }
         }
-      });
-      workers.push_back(std::move(neworker)); // 将新线程添加到线程列表
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) { // 等待所有线程完成
-      workers[i].join();
-    }
-    workers.clear(); // 清空线程列表
-    for (size_t i = 0; i < workers.size(); ++i) { // 检查并确保所有线程已加入
-      if (workers[i].joinable()) {
-        workers[i].join();
-      }
-    }
+    }, 1u);
   }
 
   std::vector<JuncId> Map::FilterJunctionsByPosition( const geom::Vector3D& minpos, // 根据位置过滤交叉口的函数
@@ -1620,6 +2012,108 @@ std::unique_ptr<geom::Mesh> Map::SDFToMesh(const road::Junction& jinput, // 定
       }
     }
 
+// ===========================================================================
+// -- Map: R-tree cache ------------------------------------------------------
+// ===========================================================================
+
+namespace {
+
+  /// 序列化R树数据的文件头，格式变化时增加 version。
+  struct RtreeHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t number_of_elements;
+  };
+
+  /// R树的一个元素：线段的两个端点及其对应的两个路径点。
+  struct RtreeRecord {
+    float segment[6];
+    uint32_t road_id[2];
+    uint32_t section_id[2];
+    int32_t lane_id[2];
+    double s[2];
+  };
+
+  static_assert(sizeof(RtreeHeader) == 16u, "Unexpected padding in RtreeHeader");
+  static_assert(sizeof(RtreeRecord) == 64u, "Unexpected padding in RtreeRecord");
+
+  constexpr uint32_t RTREE_MAGIC = 0x45525443u; // "CTRE"
+  constexpr uint32_t RTREE_VERSION = 1u;
+
+} // namespace
+
+std::vector<uint8_t> Map::SerializeRtree() const {
+    const auto elements = _rtree.GetElements();
+    const RtreeHeader header{RTREE_MAGIC, RTREE_VERSION, elements.size()};
+    std::vector<uint8_t> data(sizeof(RtreeHeader) + elements.size() * sizeof(RtreeRecord));
+    std::memcpy(data.data(), &header, sizeof(RtreeHeader));
+    uint8_t *output = data.data() + sizeof(RtreeHeader);
+    for (const auto &element : elements) {
+        RtreeRecord record;
+        const auto &first = element.first.first;
+        const auto &second = element.first.second;
+        record.segment[0] = first.get<0>();
+        record.segment[1] = first.get<1>();
+        record.segment[2] = first.get<2>();
+        record.segment[3] = second.get<0>();
+        record.segment[4] = second.get<1>();
+        record.segment[5] = second.get<2>();
+        const Waypoint *waypoints[2] = {&element.second.first, &element.second.second};
+        for (size_t i = 0u; i < 2u; ++i) {
+            record.road_id[i] = waypoints[i]->road_id;
+            record.section_id[i] = waypoints[i]->section_id;
+            record.lane_id[i] = waypoints[i]->lane_id;
+            record.s[i] = waypoints[i]->s;
+        }
+        std::memcpy(output, &record, sizeof(RtreeRecord));
+        output += sizeof(RtreeRecord);
+    }
+    return data;
+}
+
+bool Map::LoadRtree(const uint8_t *data, const size_t size) {
+    RtreeHeader header;
+    if (size < sizeof(RtreeHeader)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(RtreeHeader));
+    if ((header.magic != RTREE_MAGIC) ||
+        (header.version != RTREE_VERSION) ||
+        (header.number_of_elements != (size - sizeof(RtreeHeader)) / sizeof(RtreeRecord)) ||
+        ((size - sizeof(RtreeHeader)) % sizeof(RtreeRecord) != 0u)) {
+        log_warning("discarding incompatible R-tree data");
+        return false;
+    }
+
+    std::vector<Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(static_cast<size_t>(header.number_of_elements));
+    const uint8_t *input = data + sizeof(RtreeHeader);
+    for (uint64_t n = 0u; n < header.number_of_elements; ++n) {
+        RtreeRecord record;
+        std::memcpy(&record, input, sizeof(RtreeRecord));
+        input += sizeof(RtreeRecord);
+        Waypoint waypoints[2];
+        for (size_t i = 0u; i < 2u; ++i) {
+            // 数据应与地图对应，引用不存在的道路说明缓存已损坏
+            if (!_data.ContainsRoad(record.road_id[i])) {
+                log_warning("discarding R-tree data of a different map");
+                return false;
+            }
+            waypoints[i].road_id = record.road_id[i];
+            waypoints[i].section_id = record.section_id[i];
+            waypoints[i].lane_id = record.lane_id[i];
+            waypoints[i].s = record.s[i];
+        }
+        Rtree::BPoint first(record.segment[0], record.segment[1], record.segment[2]);
+        Rtree::BPoint second(record.segment[3], record.segment[4], record.segment[5]);
+        rtree_elements.emplace_back(
+            Rtree::BSegment(first, second),
+            std::make_pair(waypoints[0], waypoints[1]));
+    }
+    _rtree.Build(rtree_elements);
+    return true;
+}
+
 } // namespace road
 } // namespace carla  
 
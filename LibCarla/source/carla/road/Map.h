@@ -21,6 +21,10 @@
 
 #include <boost/optional.hpp> // 包含可选类型的定义
 
+#include <cstdint> // 包含定长整数类型的定义
+#include <functional> // 包含函数对象的定义
+#include <map> // 包含有序映射的定义
+#include <unordered_map> // 包含无序映射的定义
 #include <vector> // 包含向量类的定义
 
 namespace carla {
@@ -37,6 +41,53 @@ namespace road {
 
     Map(MapData m) : _data(std::move(m)) { // 构造函数，初始化_map数据
       CreateRtree(); // 创建R树
+      BuildSignalIndex(); // 建立信号搜索的索引
+    }
+
+    /// 使用 SerializeRtree 生成的数据加载R树，避免重新采样所有车道。数据
+    /// 无效或与 @a m 不符时回退到 CreateRtree。
+    Map(MapData m, const uint8_t *rtree_data, size_t rtree_size) : _data(std::move(m)) {
+      _rtree_loaded = (rtree_data != nullptr) && LoadRtree(rtree_data, rtree_size);
+      if (!_rtree_loaded) {
+        CreateRtree();
+      }
+      BuildSignalIndex();
+    }
+
+    /// 作为 @a previous 的新版本构造地图。源哈希与 @a previous 中相同的道路
+    /// 重用其R树元素，只对新增和修改的道路重新采样，变化的道路见 GetUpdate。
+    Map(MapData m, const Map &previous);
+
+    /// ========================================================================
+    /// -- Incremental update --------------------------------------------------
+    /// ========================================================================
+
+    /// 与前一个版本的地图相比变化的道路，每个列表按道路 ID 排序。
+    struct MapUpdate {
+      std::vector<RoadId> added_roads;
+      std::vector<RoadId> removed_roads;
+      std::vector<RoadId> replaced_roads;
+
+      bool IsEmpty() const {
+        return added_roads.empty() && removed_roads.empty() && replaced_roads.empty();
+      }
+    };
+
+    /// 构造时给定的前一个版本到这个地图的变化，不是增量构造的地图为空。
+    const MapUpdate &GetUpdate() const {
+      return _update;
+    }
+
+    /// ========================================================================
+    /// -- R-tree cache --------------------------------------------------------
+    /// ========================================================================
+
+    /// 将R树的元素序列化为二进制数据，供构造函数在下次加载同一地图时使用。
+    std::vector<uint8_t> SerializeRtree() const;
+
+    /// R树是否由构造函数传入的数据加载。
+    bool IsRtreeLoaded() const {
+      return _rtree_loaded;
     }
 
     /// ========================================================================
@@ -59,6 +110,18 @@ namespace road {
         const geom::Location &location, // 输入位置
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const; // 默认车道类型为驾驶车道
 
+    /// 对 @a locations 中的每个位置调用 GetClosestWaypointOnRoad，结果与
+    /// @a locations 一一对应。查询按空间位置排序后分块并行执行。
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
+    /// 对 @a locations 中的每个位置调用 GetWaypoint，结果与 @a locations
+    /// 一一对应。查询按空间位置排序后分块并行执行。
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     boost::optional<element::Waypoint> GetWaypoint( // 根据道路ID和车道ID获取路径点
         RoadId road_id, // 道路ID
         LaneId lane_id, // 车道ID
@@ -106,6 +169,15 @@ namespace road {
     std::vector<const element::RoadInfoSignal*>
         GetAllSignalReferences() const; // 获取所有信号的引用
 
+    /// 道路 @a road_id 上对车道 @a lane_id 有效的控制通行的信号（交通灯、停车和
+    /// 让行标志），按 s 排序。地图加载时建立，查找的复杂度为 O(1)。
+    const std::vector<const element::RoadInfoSignal *> &GetLaneControllingSignals(
+        RoadId road_id, LaneId lane_id) const;
+
+    /// 沿行驶方向在 @a waypoint 所在车道上（包括 waypoint 处）的下一个控制通行的
+    /// 信号，没有时返回 nullptr。
+    const element::RoadInfoSignal *GetNextControllingSignal(const Waypoint &waypoint) const;
+
     /// ========================================================================
     /// -- 路点生成 -------------------------------------------------------------
     /// ========================================================================
@@ -122,6 +194,18 @@ namespace road {
     /// 使得车辆可以反向驶向这些路点。
     std::vector<Waypoint> GetPrevious(Waypoint waypoint, double distance) const; // 获取上一个路点
 
+    /// 从 @a waypoint 开始每隔 @a distance 沿车道采样，最多返回 @a max_count
+    /// 个路点（不含起点），在分叉处沿第一个后继（或前驱）继续，没有后续车道
+    /// 时提前结束。@a forward 为 false 时反向采样，与 GetPrevious 相同。
+    /// @a until_lane_end 为 true 时在离开当前道路前停止，最后一个路点位于
+    /// 车道末端，与 client::Waypoint::GetNextUntilLaneEnd 相同。
+    std::vector<Waypoint> SampleLane(
+        Waypoint waypoint,
+        double distance,
+        size_t max_count,
+        bool forward = true,
+        bool until_lane_end = false) const;
+
     /// 返回 @a waypoint 右侧车道的路点。
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const; // 获取右侧路点
 
@@ -166,6 +250,41 @@ namespace road {
                                              const geom::Vector3D& minpos,
                                              const geom::Vector3D& maxpos) const; // 在指定位置生成有序分块网格
 
+    /// 一个空间分块内所有道路和交叉口的网格，按车道类型分组
+    struct MeshChunk {
+      /// 分块在区域中的列和行，分块的大小为 max_road_length
+      size_t x = 0u;
+      size_t y = 0u;
+      std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> meshes;
+    };
+
+    using MeshChunkCallback = std::function<void(MeshChunk &&)>;
+
+    /// 生成与 GenerateOrderedChunkedMeshInLocations 相同的网格，但道路和交叉口
+    /// 在多个线程中生成，每个分块完成后立即传给 @a callback，不需要等待整个
+    /// 区域生成完毕。分块按行优先的空间顺序回调，没有道路的分块被跳过。
+    /// @a callback 在工作线程中串行调用，抛出异常后不再生成剩余的道路和
+    /// 交叉口，异常在所有线程结束后重新抛出。
+    void GenerateOrderedChunkedMeshInLocations(
+        const rpc::OpendriveGenerationParameters& params,
+        const geom::Vector3D& minpos,
+        const geom::Vector3D& maxpos,
+        const MeshChunkCallback &callback) const;
+
+    /// 与上面的函数相同，但分块按中心与 @a focus 中最近一点在水平面上的距离
+    /// 由近到远生成和回调，@a focus 为空时按行优先的空间顺序。
+    void GenerateOrderedChunkedMeshInLocations(
+        const rpc::OpendriveGenerationParameters& params,
+        const geom::Vector3D& minpos,
+        const geom::Vector3D& maxpos,
+        const std::vector<geom::Location>& focus,
+        const MeshChunkCallback &callback) const;
+
+    /// 包含所有道路和交叉口的区域，传给 GenerateOrderedChunkedMeshInLocations
+    /// 时生成整张地图。与 FilterRoadsByPosition 相同，@a minpos.y 大于
+    /// @a maxpos.y。
+    void GetMeshGenerationBounds(geom::Vector3D &minpos, geom::Vector3D &maxpos) const;
+
 /// Buids a mesh of all crosswalks based on the OpenDRIVE  // 基于OpenDRIVE构建所有人行横道的网格
 geom::Mesh GetAllCrosswalkMesh() const;
 
@@ -211,6 +330,40 @@ private:
 
     void CreateRtree();  // 创建R树
 
+    /// 对从 @a lane_starts 开始的车道采样，生成R树的元素。
+    std::vector<Rtree::TreeElement> CreateRtreeElements(const std::vector<Waypoint> &lane_starts);
+
+    MapUpdate _update;
+
+    /// 从 SerializeRtree 生成的数据加载R树，数据无效时返回 false 且不修改R树。
+    bool LoadRtree(const uint8_t *data, size_t size);
+
+    bool _rtree_loaded = false;
+
+    /// 为 GetSignalsInDistance 建立每条车道的信号列表和后继车道列表。
+    void BuildSignalIndex();
+
+    /// 道路 @a road_id 上对车道 @a lane_id 有效、s 在 [min_s, max_s] 范围内的
+    /// 信号，min_s > max_s 时按 s 递减的顺序返回。与 Road::GetInfosInRange
+    /// 的结果（去掉无效的信号）相同。
+    std::vector<const element::RoadInfoSignal *> GetLaneSignalsInRange(
+        RoadId road_id, LaneId lane_id, double min_s, double max_s) const;
+
+    /// 车道的一个后继，waypoint 的 s 已经移到沿行驶方向进入该车道的一端。
+    struct SignalSearchSuccessor {
+      Waypoint waypoint;
+      bool is_junction;
+    };
+
+    /// 以 (road_id, lane_id) 为键，按 s 排序的信号。
+    std::unordered_map<uint64_t, std::vector<const element::RoadInfoSignal *>> _lane_signals;
+
+    /// 与 _lane_signals 相同的键，只包含控制通行的信号。
+    std::unordered_map<uint64_t, std::vector<const element::RoadInfoSignal *>> _lane_controlling_signals;
+
+    /// 每条车道的后继。Lane 存放在 MapData 的节点容器中，移动 Map 时地址不变。
+    std::unordered_map<const Lane *, std::vector<SignalSearchSuccessor>> _signal_successors;
+
     // 辅助函数，用于构造R树元素列表
     void AddElementToRtree(  // 将元素添加到R树
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
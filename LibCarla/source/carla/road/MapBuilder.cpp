@@ -26,6 +26,8 @@
 #include "carla/road/Signal.h" // 引入信号类
 #include "carla/road/SignalType.h" // 引入信号类型类
 
+#include "carla/ParallelFor.h"
+
 #include <iterator> // 引入迭代器相关库
 #include <memory> // 引入智能指针库
 #include <algorithm> // 引入算法库
@@ -35,8 +37,31 @@ using namespace carla::road::element; // 使用carla::road::element命名空间
 namespace carla {
 namespace road {
 
-  boost::optional<Map> MapBuilder::Build() {
+  boost::optional<Map> MapBuilder::Build(const uint8_t *rtree_data, const size_t rtree_size) {
+    PrepareMapData();
+    // _map_data is a member of MapBuilder so you must especify if
+    // you want to keep it (will return copy -> Map(const Map &))
+    // or move it (will return move -> Map(Map &&))
+    Map map(std::move(_map_data), rtree_data, rtree_size); // 移动并创建地图对象
+    FinishMap(map);
+    return map; // 返回构建的地图
+  }
+
+  boost::optional<Map> MapBuilder::Build(const Map &previous) {
+    PrepareMapData();
+    Map map(std::move(_map_data), previous); // 重用 previous 中未变化道路的R树元素
+    FinishMap(map);
+    return map;
+  }
 
+  void MapBuilder::SetRoadSourceHash(const RoadId road_id, const uint64_t hash) {
+    auto it = _map_data._roads.find(road_id);
+    if (it != _map_data._roads.end()) {
+      it->second._source_hash = hash;
+    }
+  }
+
+  void MapBuilder::PrepareMapData() {
     CreatePointersBetweenRoadSegments(); // 创建路段之间的指针
     RemoveZeroLaneValiditySignalReferences(); // 移除无效车道信号引用
 
@@ -58,16 +83,12 @@ namespace road {
     // remove temporal already used information
     _temp_road_info_container.clear(); // 清空临时道路信息容器
     _temp_lane_info_container.clear(); // 清空临时车道信息容器
+  }
 
-    // _map_data is a member of MapBuilder so you must especify if
-    // you want to keep it (will return copy -> Map(const Map &))
-    // or move it (will return move -> Map(Map &&))
-    Map map(std::move(_map_data)); // 移动并创建地图对象
+  void MapBuilder::FinishMap(Map &map) {
     CreateJunctionBoundingBoxes(map); // 创建交叉口的边界框
     ComputeJunctionRoadConflicts(map); // 计算交叉口道路冲突
     CheckSignalsOnRoads(map); // 检查道路上的信号
-
-    return map; // 返回构建的地图
   }
 
   // called from profiles parser
@@ -746,38 +767,53 @@ return result; // 返回结果
 
 // 为下一个车道分配指针
 void MapBuilder::CreatePointersBetweenRoadSegments(void) {
-  // 处理每个车道以定义其下一个车道
+  // 收集所有道路和车道。GetLaneNext 只读取地图数据，每个车道的后继可以并行计算
+  struct LaneEntry {
+    RoadId road_id;
+    SectionId section_id;
+    LaneId lane_id;
+    Lane *lane;
+  };
+  std::vector<Road *> roads;
+  std::vector<LaneEntry> lanes;
+  roads.reserve(_map_data._roads.size());
   for (auto &road : _map_data._roads) { // 遍历地图数据中的所有道路
+    roads.push_back(&road.second);
     for (auto &section : road.second._lane_sections) { // 遍历每条道路的车道段
       for (auto &lane : section.second._lanes) { // 遍历每个车道
-
-        // 分配下一个车道指针
-        lane.second._next_lanes = GetLaneNext(road.first, section.second._id, lane.first); // 获取下一个车道
-
-        // 将找到的每个车道添加为其前驱
-        for (auto next_lane : lane.second._next_lanes) { // 遍历下一个车道
-          // 添加为前驱
-          DEBUG_ASSERT(next_lane != nullptr); // 确保下一个车道不为空
-          next_lane->_prev_lanes.push_back(&lane.second); // 将当前车道添加到下一个车道的前驱列表中
-        }
-
+        lanes.push_back(LaneEntry{road.first, section.second._id, lane.first, &lane.second});
       }
     }
   }
 
-  // 处理每个车道以定义其下一个车道
-  for (auto &road : _map_data._roads) { // 遍历地图数据中的所有道路
-    for (auto &section : road.second._lane_sections) { // 遍历每条道路的车道段
+  // 分配下一个车道指针
+  ParallelFor(lanes.size(), [&](const size_t i) {
+    const LaneEntry &entry = lanes[i];
+    entry.lane->_next_lanes = GetLaneNext(entry.road_id, entry.section_id, entry.lane_id);
+  });
+
+  // 将找到的每个车道添加为其前驱。前驱写入其他车道，按原来的顺序执行
+  for (const LaneEntry &entry : lanes) {
+    for (auto next_lane : entry.lane->_next_lanes) { // 遍历下一个车道
+      DEBUG_ASSERT(next_lane != nullptr); // 确保下一个车道不为空
+      next_lane->_prev_lanes.push_back(entry.lane); // 将当前车道添加到下一个车道的前驱列表中
+    }
+  }
+
+  // 处理每条道路的前后道路，每条道路只写入自己的列表
+  ParallelFor(roads.size(), [&](const size_t i) {
+    Road &road = *roads[i];
+    for (auto &section : road._lane_sections) { // 遍历每条道路的车道段
       for (auto &lane : section.second._lanes) { // 遍历每个车道
 
         // 添加下一个道路
         for (auto next_lane : lane.second._next_lanes) { // 遍历下一个车道
           DEBUG_ASSERT(next_lane != nullptr); // 确保下一个车道不为空
           // 避免同一路径
-          if (next_lane->GetRoad() != &road.second) { // 如果下一个车道的道路不是当前道路
-            if (std::find(road.second._nexts.begin(), road.second._nexts.end(),
-                next_lane->GetRoad()) == road.second._nexts.end()) { // 检查下一个道路是否已经存在于列表中
-              road.second._nexts.push_back(next_lane->GetRoad()); // 添加下一个道路
+          if (next_lane->GetRoad() != &road) { // 如果下一个车道的道路不是当前道路
+            if (std::find(road._nexts.begin(), road._nexts.end(),
+                next_lane->GetRoad()) == road._nexts.end()) { // 检查下一个道路是否已经存在于列表中
+              road._nexts.push_back(next_lane->GetRoad()); // 添加下一个道路
             }
           }
         }
@@ -786,17 +822,17 @@ void MapBuilder::CreatePointersBetweenRoadSegments(void) {
         for (auto prev_lane : lane.second._prev_lanes) { // 遍历前驱车道
           DEBUG_ASSERT(prev_lane != nullptr); // 确保前驱车道不为空
           // 避免同一路径
-          if (prev_lane->GetRoad() != &road.second) { // 如果前驱车道的道路不是当前道路
-            if (std::find(road.second._prevs.begin(), road.second._prevs.end(),
-                prev_lane->GetRoad()) == road.second._prevs.end()) { // 检查前驱道路是否已经存在于列表中
-              road.second._prevs.push_back(prev_lane->GetRoad()); // 添加前驱道路
+          if (prev_lane->GetRoad() != &road) { // 如果前驱车道的道路不是当前道路
+            if (std::find(road._prevs.begin(), road._prevs.end(),
+                prev_lane->GetRoad()) == road._prevs.end()) { // 检查前驱道路是否已经存在于列表中
+              road._prevs.push_back(prev_lane->GetRoad()); // 添加前驱道路
             }
           }
         }
 
       }
     }
-  }
+  });
 }
 
 geom::Transform MapBuilder::ComputeSignalTransform(std::unique_ptr<Signal> &signal, MapData &data) {
@@ -870,10 +906,20 @@ void MapBuilder::SolveControllerAndJuntionReferences() {
     }
 }
 
-void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
-    // 遍历地图中的所有交叉口
+std::vector<Junction *> MapBuilder::GetJunctionPointers(Map &map) {
+    std::vector<Junction *> junctions;
+    junctions.reserve(map._data.GetJunctions().size());
     for (auto &junctionpair : map._data.GetJunctions()) {
-        auto* junction = map.GetJunction(junctionpair.first); // 获取交叉口对象
+      junctions.push_back(&junctionpair.second);
+    }
+    return junctions;
+}
+
+void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
+    // 遍历地图中的所有交叉口。每个交叉口只写入自己的边界框，地图的查询是只读的，可以并行计算
+    const std::vector<Junction *> junctions = GetJunctionPointers(map);
+    ParallelFor(junctions.size(), [&](const size_t junction_index) {
+        auto* junction = junctions[junction_index]; // 获取交叉口对象
         auto waypoints = map.GetJunctionWaypoints(junction->GetId(), Lane::LaneType::Any); // 获取交叉口的路径点
         const int number_intervals = 10; // 定义分段数量
 
@@ -946,7 +992,7 @@ void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
 
         // 设置交叉口的边界框
         junction->_bounding_box = carla::geom::BoundingBox(location, extent);
-    }
+    });
 }
 
 void MapBuilder::CreateController(
@@ -978,11 +1024,12 @@ void MapBuilder::CreateController(
 }
 
 void MapBuilder::ComputeJunctionRoadConflicts(Map &map) {
-    // 遍历地图中的所有交叉口
-    for (auto &junctionpair : map._data.GetJunctions()) {
-      auto& junction = junctionpair.second; // 获取交叉口对象
+    // 遍历地图中的所有交叉口，各交叉口的冲突互相独立，可以并行计算
+    const std::vector<Junction *> junctions = GetJunctionPointers(map);
+    ParallelFor(junctions.size(), [&](const size_t junction_index) {
+      auto& junction = *junctions[junction_index]; // 获取交叉口对象
       junction._road_conflicts = (map.ComputeJunctionConflicts(junction.GetId())); // 计算交叉口的道路冲突
-    }
+    });
 }
 
 void MapBuilder::GenerateDefaultValiditiesForSignalReferences() {
@@ -20,7 +20,16 @@ namespace road {
   class MapBuilder {
   public:
 
-    boost::optional<Map> Build(); // 构建地图并返回一个可选的地图对象
+    /// 构建地图并返回一个可选的地图对象。@a rtree_data 不为空时使用
+    /// Map::SerializeRtree 生成的数据加载R树，而不是重新生成。
+    boost::optional<Map> Build(const uint8_t *rtree_data = nullptr, size_t rtree_size = 0u);
+
+    /// 构建 @a previous 的新版本。与 @a previous 中源哈希相同的道路重用其R树
+    /// 元素，只对新增和修改的道路重新采样，变化的道路见 Map::GetUpdate。
+    boost::optional<Map> Build(const Map &previous);
+
+    /// 记录生成道路 @a road_id 的 OpenDRIVE 元素的哈希。
+    void SetRoadSourceHash(RoadId road_id, uint64_t hash);
 
     // 从道路解析器调用
     carla::road::Road *AddRoad(
@@ -364,9 +373,18 @@ private:
 
     MapData _map_data; // 地图数据
 
+    /// 构造 Map 之前对地图数据的处理
+    void PrepareMapData();
+
+    /// 构造 Map 之后的处理
+    void FinishMap(Map &map);
+
     /// Create the pointers between RoadSegments based on the ids. // 根据标识符创建道路段之间的指针
     void CreatePointersBetweenRoadSegments();
 
+    /// 地图中所有交叉口的指针，用于按索引并行处理交叉口
+    static std::vector<Junction *> GetJunctionPointers(Map &map);
+
     /// Create the bounding boxes of each junction // 创建每个交叉口的边界框
     void CreateJunctionBoundingBoxes(Map &map);
 
@@ -1103,18 +1103,20 @@ void MeshFactory::GenerateLaneMarksForNotCenterLine(
     using Rtree = geom::PointCloudRtree<VertexInfo>;  // R树类型
     using Point = Rtree::BPoint;  // 点类型
     Rtree rtree;  // 创建R树实例
+    std::vector<Rtree::TreeElement> rtree_elements;  // 所有顶点，一次性打包建树
     for (size_t lane_mesh_idx = 0; lane_mesh_idx < lane_meshes.size(); ++lane_mesh_idx) {  // 遍历每个车道网格
       auto& mesh = lane_meshes[lane_mesh_idx];   // 获取当前网格
       for(size_t i = 0; i < mesh->GetVerticesNum(); ++i) {  // 遍历每个顶点
         auto& vertex = mesh->GetVertices()[i];  // 获取当前顶点
         Point point(vertex.x, vertex.y, vertex.z);  // 创建点对象
         if (i < 2 || i >= mesh->GetVerticesNum() - 2) {  // 判断顶点是否为边界顶点
-          rtree.InsertElement({point, {&vertex, lane_mesh_idx, true}});  // 插入边界顶点到R树
+          rtree_elements.push_back({point, {&vertex, lane_mesh_idx, true}});  // 边界顶点
         } else {
-          rtree.InsertElement({point, {&vertex, lane_mesh_idx, false}});  // 插入非边界顶点到R树
+          rtree_elements.push_back({point, {&vertex, lane_mesh_idx, false}});  // 非边界顶点
         }
       }
     }
+    rtree.Build(rtree_elements);  // 构建R树
 
   // 查找每个顶点的邻居并计算它们的权重
   std::vector<VertexNeighbors> vertices_neighborhoods;  // 顶点邻域集合
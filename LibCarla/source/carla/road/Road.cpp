@@ -63,6 +63,11 @@ namespace road {
     return _predecessor; // 返回前一条道路ID
   }
 
+  // 获取生成道路的 OpenDRIVE 元素的哈希
+  uint64_t Road::GetSourceHash() const {
+    return _source_hash;
+  }
+
   // 获取下一条道路的指针列表
   std::vector<Road *> Road::GetNexts() const {
     return _nexts; // 返回下一条道路的指针列表
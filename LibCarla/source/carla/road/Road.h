@@ -19,6 +19,7 @@
 #include "carla/road/RoadElementSet.h" // 引入 RoadElementSet 的定义
 #include "carla/road/RoadTypes.h" // 引入 RoadTypes 的定义
 
+#include <cstdint> // 引入定长整数类型
 #include <unordered_map> // 引入 unordered_map
 #include <vector> // 引入 vector
 
@@ -176,6 +177,10 @@ namespace road {
       /// 获取在给定 s 位置的所有车道
       std::map<LaneId, const Lane*> GetLanesAt(const double s) const;
 
+      /// 生成该道路的 OpenDRIVE 元素的哈希，用于比较两个版本的地图中的道路，
+      /// 0 表示未知
+      uint64_t GetSourceHash() const;
+
   private:
 
       friend MapBuilder; // 声明 MapBuilder 为友元类
@@ -198,6 +203,8 @@ namespace road {
 
       RoadId _predecessor{ 0 }; // 前一个路段 ID，初始化为 0
 
+      uint64_t _source_hash{ 0u }; // OpenDRIVE 元素的哈希，0 表示未知
+
       InformationSet _info; // 信息集合
 
       std::vector<Road*> _nexts; // 下一个路段的指针向量
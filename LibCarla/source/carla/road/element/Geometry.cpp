@@ -32,6 +32,7 @@
 #include <cmath>
 // 引入stdexcept标准库头文件，用于处理异常
 #include <stdexcept>
+#include <utility>
 
 // 定义命名空间carla
 namespace carla {
@@ -54,6 +55,117 @@ void DirectedPoint::ApplyLateralOffset(float lateral_offset) {
     location.y += lateral_offset * normal_y;
 }
 
+// ===========================================================================
+// -- ArcLengthTable ---------------------------------------------------------
+// ===========================================================================
+
+void ArcLengthTable::AddSample(const Sample &sample) {
+    Node node;
+    node.sample = sample;
+    // 保持方向连续，避免 atan2 在 ±π 处跳变导致插值错误
+    if (!_samples.empty()) {
+        constexpr double two_pi = 2.0 * geom::Math::Pi<double>();
+        const double previous = _samples.back().sample.heading;
+        node.sample.heading -= two_pi * std::round((node.sample.heading - previous) / two_pi);
+    }
+    node.du = std::cos(node.sample.heading);
+    node.dv = std::sin(node.sample.heading);
+    _samples.push_back(node);
+}
+
+ArcLengthTable::Sample ArcLengthTable::Evaluate(double s) const {
+    DEBUG_ASSERT(!_samples.empty());
+    if (_samples.size() < 2u) {
+        return _samples.front().sample;
+    }
+    const size_t last_interval = _samples.size() - 2u;
+    const double position = std::max(s, 0.0) * _inv_step;
+    const size_t i = std::min(static_cast<size_t>(position), last_interval);
+    const double t = std::min(position - static_cast<double>(i), 1.0);
+    const Node &n0 = _samples[i];
+    const Node &n1 = _samples[i + 1u];
+
+    // 三次 Hermite 基函数
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    const double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+    const double h10 = (t3 - 2.0 * t2 + t) * _step;
+    const double h01 = -2.0 * t3 + 3.0 * t2;
+    const double h11 = (t3 - t2) * _step;
+
+    Sample result;
+    result.u = h00 * n0.sample.u + h10 * n0.du + h01 * n1.sample.u + h11 * n1.du;
+    result.v = h00 * n0.sample.v + h10 * n0.dv + h01 * n1.sample.v + h11 * n1.dv;
+    result.heading =
+        h00 * n0.sample.heading + h10 * n0.sample.curvature +
+        h01 * n1.sample.heading + h11 * n1.sample.curvature;
+    result.curvature = (1.0 - t) * n0.sample.curvature + t * n1.sample.curvature;
+    return result;
+}
+
+namespace {
+
+  /// 弧长积分的参数步长
+  constexpr double ARC_LENGTH_PARAMETER_STEP = 0.05;
+
+  /// 速度的下限，避免在奇异点除以零
+  constexpr double ARC_LENGTH_MIN_SPEED = 1e-9;
+
+  /// 参数曲线的弧长参数化：按弧长递增的顺序查询弧长对应的曲线参数。
+  ///
+  /// 以 ARC_LENGTH_PARAMETER_STEP 为步长用三点 Gauss-Legendre 公式对速度 |dP/dp| 积分，
+  /// 在包含目标弧长的步内用牛顿法求解参数。
+  template <typename SpeedFunctionT>
+  class ArcLengthParameterizationImpl {
+  public:
+
+    explicit ArcLengthParameterizationImpl(SpeedFunctionT speed)
+      : _speed(std::move(speed)) {}
+
+    double ParameterAt(double s) {
+      while (true) {
+        const double step_length = Integrate(_parameter, _parameter + ARC_LENGTH_PARAMETER_STEP);
+        if ((_arc_length + step_length >= s) || (step_length <= 0.0)) {
+          break;
+        }
+        _parameter += ARC_LENGTH_PARAMETER_STEP;
+        _arc_length += step_length;
+      }
+      const double remaining = s - _arc_length;
+      double p = _parameter + remaining / std::max(_speed(_parameter), ARC_LENGTH_MIN_SPEED);
+      for (int i = 0; i < 4; ++i) {
+        p = geom::Math::Clamp(p, _parameter, _parameter + ARC_LENGTH_PARAMETER_STEP);
+        p -= (Integrate(_parameter, p) - remaining) / std::max(_speed(p), ARC_LENGTH_MIN_SPEED);
+      }
+      return geom::Math::Clamp(p, _parameter, _parameter + ARC_LENGTH_PARAMETER_STEP);
+    }
+
+  private:
+
+    double Integrate(double a, double b) const {
+      const double half = 0.5 * (b - a);
+      const double middle = 0.5 * (a + b);
+      const double offset = half * 0.7745966692414834;
+      return half * (
+          (5.0 / 9.0) * _speed(middle - offset) +
+          (8.0 / 9.0) * _speed(middle) +
+          (5.0 / 9.0) * _speed(middle + offset));
+    }
+
+    SpeedFunctionT _speed;
+
+    double _parameter = 0.0;
+
+    double _arc_length = 0.0;
+  };
+
+  template <typename SpeedFunctionT>
+  static ArcLengthParameterizationImpl<SpeedFunctionT> MakeArcLengthParameterization(SpeedFunctionT speed) {
+    return ArcLengthParameterizationImpl<SpeedFunctionT>(std::move(speed));
+  }
+
+} // namespace
+
 // 函数：GeometryLine类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryLine::PosFromDist(double dist) const {
@@ -117,13 +229,24 @@ geom::Vector2D RotatebyAngle(double angle, double x, double y) {
 // 函数：GeometrySpiral类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
-    // 将距离限制在0.0到_length之间
-    dist = geom::Math::Clamp(dist, 0.0, _length);
     // 调试断言，确保_length大于0.0
     DEBUG_ASSERT(_length > 0.0);
-    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading
-    DirectedPoint p(_start_position, _heading);
+    // 在查找表中插值，查找表会把距离限制在0.0到_length之间
+    const auto sample = _table.Evaluate(dist);
+    // 调用RotatebyAngle函数把相对于起点的坐标旋转到起始方向
+    geom::Vector2D pos = RotatebyAngle(_heading, sample.u, sample.v);
+    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading加上相对方向
+    DirectedPoint p(_start_position, _heading + sample.heading);
+    // 更新位置的x坐标
+    p.location.x += pos.x;
+    // 更新位置的y坐标
+    p.location.y += pos.y;
+    // 返回计算后的DirectedPoint对象
+    return p;
+}
 
+// 函数：GeometrySpiral类的成员函数，用odrSpiral计算查找表的采样点
+void GeometrySpiral::PreComputeSpline() {
     // 获取螺旋线终点的曲率
     const double curve_end = (_curve_end);
     // 获取螺旋线起点的曲率
@@ -132,39 +255,31 @@ DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
     const double curve_dot = (curve_end - curve_start) / (_length);
     // 计算起始参数s_o
     const double s_o = curve_start / curve_dot;
-    // 计算当前参数s
-    double s = s_o + dist;
-
-    double x;
-    double y;
-    double t;
-    // 调用odrSpiral函数，可能是根据参数计算螺旋线上的点坐标和切线方向
-    odrSpiral(s, curve_dot, &x, &y, &t);
 
     double x_o;
     double y_o;
     double t_o;
-    // 再次调用odrSpiral函数，计算起始参数对应的点坐标和切线方向
+    // 计算起始参数对应的点坐标和切线方向
     odrSpiral(s_o, curve_dot, &x_o, &y_o, &t_o);
 
-    // 计算相对坐标x
-    x = x - x_o;
-    // 计算相对坐标y
-    y = y - y_o;
-    // 计算相对切线方向t
-    t = t - t_o;
-
-    // 调用RotatebyAngle函数旋转点坐标
-    geom::Vector2D pos = RotatebyAngle(_heading - t_o, x, y);
-    // 更新位置的x坐标
-    p.location.x += pos.x;
-    // 更新位置的y坐标
-    p.location.y += pos.y;
-    // 更新tangent（方向相关的值）
-    p.tangent = _heading + t;
-
-    // 返回计算后的DirectedPoint对象
-    return p;
+    // 把坐标旋转到起点的切线方向
+    const double cos_o = std::cos(-t_o);
+    const double sin_o = std::sin(-t_o);
+    _table.Build(_length, [&](double dist) {
+        double x;
+        double y;
+        double t;
+        // 计算当前参数对应的点坐标和切线方向
+        odrSpiral(s_o + dist, curve_dot, &x, &y, &t);
+        const double dx = x - x_o;
+        const double dy = y - y_o;
+        ArcLengthTable::Sample sample;
+        sample.u = dx * cos_o - dy * sin_o;
+        sample.v = dy * cos_o + dx * sin_o;
+        sample.heading = t - t_o;
+        sample.curvature = curve_start + curve_dot * dist;
+        return sample;
+    });
 }
 
 // 函数：GeometrySpiral类的成员函数，计算到给定位置的距离（未完全实现）
@@ -178,27 +293,13 @@ std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &locatio
 // 函数：GeometryPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-
-    // 计算插值比例
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    // 根据插值比例计算u值
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    // 根据插值比例计算v值
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    // 根据插值比例计算tangent（可能是方向相关的值，这里计算方式存疑）
-    double tangent = atan((rate * val1.t + (1.0 - rate) * val2.t)); //?
+    // 在查找表中插值得到相对于起点的坐标和方向
+    const auto sample = _table.Evaluate(dist);
 
     // 调用RotatebyAngle函数旋转点坐标
-    geom::Vector2D pos = RotatebyAngle(_heading, u, v);
-    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading + tangent
-    DirectedPoint p(_start_position, _heading + tangent);
+    geom::Vector2D pos = RotatebyAngle(_heading, sample.u, sample.v);
+    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading加上相对方向
+    DirectedPoint p(_start_position, _heading + sample.heading);
     // 更新位置的x坐标
     p.location.x += pos.x;
     // 更新位置的y坐标
@@ -217,79 +318,35 @@ std::pair<float, float> GeometryPoly3::DistanceTo(const geom::Location & /*p*/)
 
 // 函数：GeometryPoly3类的成员函数，预计算样条曲线
 void GeometryPoly3::PreComputeSpline() {
-    // 定义常量，大概是区间大小（单位：米）
-    constexpr double interval_size = 0.3;
-    // 定义变量，表示u值的区间间隔，初始化为interval_size
-    const double delta_u = interval_size; // interval between values of u
-    double current_s = 0;
-    double current_u = 0;
-    double last_u = 0;
-    // 计算初始的v值
-    double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
-    // 循环，直到current_s大于_length加上delta_u
-    while (current_s < _length + delta_u) {
-        // 更新u值
-        current_u += delta_u;
-        // 计算当前的v值
-        double current_v = _poly.Evaluate(current_u);
-        // 计算u值的差值
-        double du = current_u - last_u;
-        // 计算v值的差值
-        double dv = current_v - last_v;
-        // 计算s值的变化量
-        double ds = sqrt(du * du + dv * dv);
-        // 更新s值
-        current_s += ds;
-        // 计算当前的切线值
-        double current_t = _poly.Tangent(current_u);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-        // 创建两个Rtree的点对象
-        Rtree::BPoint p1(static_cast<float>(last_s));
-        Rtree::BPoint p2(static_cast<float>(current_s));
-        // 在rtree中插入元素
-        _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
-
-        // 更新上次的值
-        last_u = current_u;
-        last_v = current_v;
-        last_s = current_s;
-        last_val = current_val;
-
-    }
+    // v(u) 的一阶和二阶导数
+    const auto derivative = [this](double u) { return _poly.Tangent(u); };
+    const auto second_derivative = [this](double u) { return 2.0 * _c + 6.0 * _d * u; };
+    auto parameterization = MakeArcLengthParameterization([&](double u) {
+        const double dv = derivative(u);
+        return std::sqrt(1.0 + dv * dv);
+    });
+    _table.Build(_length, [&](double dist) {
+        const double u = parameterization.ParameterAt(dist);
+        const double dv = derivative(u);
+        ArcLengthTable::Sample sample;
+        sample.u = u;
+        sample.v = _poly.Evaluate(u);
+        sample.heading = std::atan(dv);
+        sample.curvature = second_derivative(u) / std::pow(1.0 + dv * dv, 1.5);
+        return sample;
+    });
 }
 
 // 函数：GeometryParamPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-    // 计算插值比例
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    // 根据插值比例计算u值
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    // 根据插值比例计算v值
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    // 根据插值比例计算t_u值
-    double t_u = (rate * val1.t_u + (1.0 - rate) * val2.t_u);
-    // 根据插值比例计算t_v值
-    double t_v = (rate * val1.t_v + (1.0 - rate) * val2.t_v);
-    // 根据t_u和t_v计算tangent（可能是方向相关的值）
-    double tangent = atan2(t_v, t_u); //?
+    // 在查找表中插值得到相对于起点的坐标和方向
+    const auto sample = _table.Evaluate(dist);
 
     // 调用RotatebyAngle函数旋转点坐标
-    geom::Vector2D pos = RotatebyAngle(_heading, u, v);
-    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading + tangent
-    DirectedPoint p(_start_position, _heading + tangent);
+    geom::Vector2D pos = RotatebyAngle(_heading, sample.u, sample.v);
+    // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading加上相对方向
+    DirectedPoint p(_start_position, _heading + sample.heading);
     // 更新位置的x坐标
     p.location.x += pos.x;
     // 更新位置的y坐标
@@ -308,82 +365,29 @@ std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &) c
 
 // 函数：GeometryParamPoly3类的成员函数，预计算样条曲线
 void GeometryParamPoly3::PreComputeSpline() {
-    // 定义常量，大概是区间大小（单位：米）
-    constexpr double interval_size = 0.5;
-    // 根据_length和interval_size计算区间数量，至少为5
-    size_t number_intervals =
-        std::max(static_cast<size_t>(_length / interval_size), size_t(5));
-    double delta_p = 1.0 / number_intervals;
-    if (_arcLength) {
-        // 如果_arcLength为真，根据_length调整delta_p
-        delta_p *= _length;
-    }
-    double param_p = 0;
-    double current_s = 0;
-    double last_u = _polyU.Evaluate(param_p);
-    double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{
-        last_u,
-        last_v,
-        last_s,
-        _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
-    // 循环number_intervals次
-    for(size_t i = 0; i < number_intervals; ++i) {
-        // 更新param_p
-        param_p += delta_p;
-        // 计算当前的u值
-        double current_u = _polyU.Evaluate(param_p);
-        // 计算当前的v值
-        double current_v = _polyV.Evaluate(param_p);
-        // 计算u值的差值
-        double du = current_u - last_u;
-        // 计算v值的差值
-        double dv = current_v - last_v;
-        // 计算s值的变化量
-        double ds = sqrt(du * du + dv * dv);
-        // 更新s值
-        current_s += ds;
-        // 计算当前的u方向切线值
-        double current_t_u = _polyU.Tangent(param_p);
-        // 计算当前的v方向切线值
-        double current_t_v = _polyV.Tangent(param_p);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{
-            current_u,
-            current_v,
-            current_s,
-            current_t_u,
-            current_t_v };
-
-       // 创建一个Rtree中的BPoint类型对象p1，将last_s转换为float类型后作为构造函数的参数
-      // BPoint可能是Rtree中表示点的数据结构，这里是使用last_s的值来初始化这个点
-       Rtree::BPoint p1(static_cast<float>(last_s));
-      // 创建一个Rtree中的BPoint类型对象p2，将current_s转换为float类型后作为构造函数的参数
-      // 同样，这里是使用current_s的值来初始化这个点
-       Rtree::BPoint p2(static_cast<float>(current_s));
-      // 调用_rtree对象的InsertElement函数，将由p1和p2组成的线段（BSegment）以及相关的值last_val和current_val插入到_rtree中
-     // 这里的_rtree可能是某种数据结构（例如空间索引结构），用于存储和管理这些元素
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
-
-     // 将当前的u值赋给last_u，用于记录上一次的u值，可能是为了后续的计算或者数据更新
-      last_u = current_u;
-     // 将当前的v值赋给last_v，用于记录上一次的v值
-      last_v = current_v;
-    // 将当前的s值赋给last_s，用于记录上一次的s值
-      last_s = current_s;
-    // 将当前的val值赋给last_val，用于记录上一次的val值，这里的val可能是包含多个属性值的数据结构
-      last_val = current_val;
-
-   // 如果当前的s值大于_length（这里_length可能是预先定义的某个长度限制或者阈值）
-      if (current_s > _length) {
-    // 则跳出当前的循环
-        break;
-       }
-    }
-  }
+    // u(p) 和 v(p) 的二阶导数
+    const auto second_derivative_u = [this](double p) { return 2.0 * _cU + 6.0 * _dU * p; };
+    const auto second_derivative_v = [this](double p) { return 2.0 * _cV + 6.0 * _dV * p; };
+    auto parameterization = MakeArcLengthParameterization([this](double p) {
+        const double du = _polyU.Tangent(p);
+        const double dv = _polyV.Tangent(p);
+        return std::sqrt(du * du + dv * dv);
+    });
+    _table.Build(_length, [&](double dist) {
+        const double p = parameterization.ParameterAt(dist);
+        const double du = _polyU.Tangent(p);
+        const double dv = _polyV.Tangent(p);
+        const double speed_squared = std::max(du * du + dv * dv, 1e-18);
+        ArcLengthTable::Sample sample;
+        sample.u = _polyU.Evaluate(p);
+        sample.v = _polyV.Evaluate(p);
+        sample.heading = std::atan2(dv, du);
+        sample.curvature =
+            (du * second_derivative_v(p) - dv * second_derivative_u(p)) / std::pow(speed_squared, 1.5);
+        return sample;
+    });
+}
+
 } // namespace element
 } // namespace road
 } // namespace carla
\ No newline at end of file
@@ -12,8 +12,11 @@
 #include "carla/geom/Math.h"
 // 包含carla/geom/CubicPolynomial.h头文件
 #include "carla/geom/CubicPolynomial.h"
-// 包含carla/geom/Rtree.h头文件
-#include "carla/geom/Rtree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
 
 // 定义命名空间carla，在这个命名空间下包含road和其他相关的定义
 namespace carla {
@@ -67,6 +70,60 @@ namespace element {
         }
     };
 
+    /// 曲线按弧长等间距采样的查找表，采样点之间用三次 Hermite 插值。
+    ///
+    /// 采样点的坐标和方向相对于几何形状的起点和起始方向。位置以方向的余弦和
+    /// 正弦为导数、方向以曲率为导数插值，曲率半径不小于 1 米时位置误差小于
+    /// 1 毫米。查找表在加载地图时构建一次，之后同一距离的结果总是相同的。
+    class ArcLengthTable {
+    public:
+
+        struct Sample {
+            double u = 0.0;
+            double v = 0.0;
+            double heading = 0.0;
+            double curvature = 0.0;
+        };
+
+        /// 采样间隔的上限（单位：米）
+        static constexpr double MAX_STEP = 0.5;
+
+        /// 对 [0, length] 按等间距调用 @a sample 构建查找表，@a sample 的参数
+        /// 为弧长，调用顺序为弧长递增的顺序。
+        template <typename SampleFunctionT>
+        void Build(double length, SampleFunctionT &&sample) {
+            const size_t number_of_intervals =
+                std::max<size_t>(static_cast<size_t>(std::ceil(length / MAX_STEP)), 1u);
+            _step = length / static_cast<double>(number_of_intervals);
+            _inv_step = (_step > 0.0) ? 1.0 / _step : 0.0;
+            _samples.clear();
+            _samples.reserve(number_of_intervals + 1u);
+            for (size_t i = 0u; i <= number_of_intervals; ++i) {
+                const double s = (i == number_of_intervals) ? length : static_cast<double>(i) * _step;
+                AddSample(sample(s));
+            }
+        }
+
+        /// 返回弧长 @a s 处插值得到的采样点，@a s 限制在 [0, length] 内。
+        Sample Evaluate(double s) const;
+
+    private:
+
+        struct Node {
+            Sample sample;
+            double du = 1.0;
+            double dv = 0.0;
+        };
+
+        void AddSample(const Sample &sample);
+
+        double _step = 0.0;
+
+        double _inv_step = 0.0;
+
+        std::vector<Node> _samples;
+    };
+
     // 定义一个抽象基类Geometry，表示几何形状
     class Geometry {
     public:
@@ -217,7 +274,9 @@ namespace element {
      // 初始化本类中的_curve_start成员变量，将传入的curv_s赋值给它，表示曲线起始曲率
            _curve_start(curv_s),
      // 初始化本类中的_curve_end成员变量，将传入的curv_e赋值给它，表示曲线结束曲率
-           _curve_end(curv_e) {}
+           _curve_end(curv_e) {
+        PreComputeSpline();
+    }
 
         // 获取曲线起始曲率的函数
         double GetCurveStart() {
@@ -240,6 +299,10 @@ namespace element {
         double _curve_start;
         // 曲线结束曲率
         double _curve_end;
+        // 按弧长采样的查找表
+        ArcLengthTable _table;
+        // 用 odrSpiral 计算查找表的采样点
+        void PreComputeSpline();
     };
 
     // 定义表示三次多项式曲线的几何形状类，继承自Geometry类
@@ -314,20 +377,9 @@ namespace element {
         double _c;
         double _d;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
-            double u = 0;
-            double v = 0;
-            double s = 0;
-            double t = 0;
-        };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
+        // 按弧长采样的查找表
+        ArcLengthTable _table;
+        // 对弧长积分并计算查找表的采样点
         void PreComputeSpline();
     };
 
@@ -420,21 +472,9 @@ namespace element {
         // 是否为弧长相关的标志
         bool _arcLength;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
-            double u = 0;
-            double v = 0;
-            double s = 0;
-            double t_u = 0;
-            double t_v = 0;
-        };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
+        // 按弧长采样的查找表
+        ArcLengthTable _table;
+        // 对弧长积分并计算查找表的采样点
         void PreComputeSpline();
     };
 
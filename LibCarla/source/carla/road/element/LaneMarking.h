@@ -54,6 +54,8 @@ namespace element {  // 定义命名空间element
       Both  = 0x03  // 11  - 双向
     };
 
+    LaneMarking() = default;  // 默认构造函数，用于反序列化
+
     explicit LaneMarking(const RoadInfoMarkRecord &info);  // 构造函数，接受RoadInfoMarkRecord对象
 
     Type type = Type::None;  // 车道标记类型，默认值为None
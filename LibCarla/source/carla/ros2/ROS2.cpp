@@ -33,12 +33,14 @@
 #include "publishers/CarlaMapSensorPublisher.h" // 引入地图传感器发布者模块
 #include "publishers/CarlaSpeedometerSensor.h" // 引入速度计传感器模块
 #include "publishers/CarlaTransformPublisher.h" // 引入变换发布者模块
+#include "publishers/CarlaTFPublisher.h" // 引入合并变换的TF发布者模块
 #include "publishers/CarlaCollisionPublisher.h" // 引入碰撞发布者模块
 #include "publishers/CarlaLineInvasionPublisher.h" // 引入线路侵入发布者模块
 
 #include "subscribers/CarlaSubscriber.h" // 引入Carla订阅者模块
 #include "subscribers/CarlaEgoVehicleControlSubscriber.h" // 引入自我车辆控制订阅者模块
 
+#include <sstream> // 引入字符串流库
 #include <vector> // 引入向量库
 
 namespace carla {
@@ -70,11 +72,21 @@ enum ESensors { // 定义传感器枚举
   CameraGBufferFloat // 相机G缓冲区（浮点数）
 };
 
+// 发布相机数据的线程数
+static constexpr size_t ROS2_PublisherThreads = 2u;
+
 void ROS2::Enable(bool enable) { // 启用或禁用ROS2
   _enabled = enable; // 设置启用状态
   log_info("ROS2 enabled: ", _enabled); // 记录启用状态
   _clock_publisher = std::make_shared<CarlaClockPublisher>("clock", ""); // 创建时钟发布者
   _clock_publisher->Init(); // 初始化时钟发布者
+  _status_publisher = std::make_shared<CarlaMapSensorPublisher>("status", ""); // 创建状态发布者
+  _status_publisher->Init(); // 初始化状态发布者
+  _tf_publisher = std::make_shared<CarlaTFPublisher>("tf", ""); // 创建TF发布者，每帧发布一条 /tf
+  if (!_tf_publisher->Init()) // 初始化失败时每个变换发布者自己发布
+    _tf_publisher.reset();
+  if (_enabled)
+    _publisher_pool.Start(ROS2_PublisherThreads); // 启动发布线程池
 }
 
 void ROS2::SetFrame(uint64_t frame) { // 设置帧
@@ -104,6 +116,12 @@ void ROS2::SetTimestamp(double timestamp) { // 设置时间戳
   _nanoseconds = static_cast<uint32_t>(fractional * multiplier); // 更新纳秒数
   _clock_publisher->SetData(_seconds, _nanoseconds); // 设置时钟数据
   _clock_publisher->Publish(); // 发布时钟数据
+  if (_tf_publisher)
+    _tf_publisher->Publish(); // 发布上一帧收集的所有变换
+  if (_seconds != _status_seconds) { // 每个模拟秒发布一次状态
+    _status_seconds = _seconds;
+    PublishStatus();
+  }
    //log_info("ROS2 new timestamp: ", _timestamp); // 记录新时间戳
 }
 
@@ -124,6 +142,7 @@ void ROS2::RemoveActorRosName(void *actor) { // 移除操作者的ROS名称
   _actor_ros_name.erase(actor); // 移除ROS名称
   _actor_parent_ros_name.erase(actor); // 移除父ROS名称
 
+  _publisher_pool.Remove(actor); // 丢弃还没有发布的数据
   _publishers.erase(actor); // 移除发布者
   _transforms.erase(actor); // 移除变换数据
 }
@@ -212,7 +231,7 @@ std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublish
           _publishers.insert({actor, new_publisher});// 插入到发布者列表
           publisher = new_publisher; // 设置当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 插入到变换发布者列表
           transform = new_transform;// 设置当前变换发布者
@@ -231,7 +250,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 插入到发布者列表
           publisher = new_publisher;// 设置当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 插入到变换发布者列表
           transform = new_transform; // 设置当前变换发布者
@@ -249,7 +268,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str()); // 创建一个新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher); // 创建一个新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换
@@ -267,7 +286,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将DVS发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换
@@ -285,7 +304,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将GNSS发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换
@@ -303,7 +322,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将IMU发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换
@@ -321,7 +340,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将压线发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换
@@ -342,7 +361,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换发布者
@@ -360,7 +379,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换发布者
@@ -378,7 +397,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换发布者
@@ -396,7 +415,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换发布者
@@ -417,7 +436,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher; // 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) { // 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform; // 更新当前变换发布者
@@ -435,7 +454,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher; // 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform;// 更新当前变换发布者
@@ -453,7 +472,7 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
           _publishers.insert({actor, new_publisher});// 将新发布者插入到发布者集合中
           publisher = new_publisher;// 更新当前发布者
         }
-        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str());// 创建新的变换发布者
+        std::shared_ptr<CarlaTransformPublisher> new_transform = std::make_shared<CarlaTransformPublisher>(ros_name.c_str(), parent_ros_name.c_str(), _tf_publisher);// 创建新的变换发布者
         if (new_transform->Init()) {// 初始化变换发布者
           _transforms.insert({actor, new_transform});// 将新变换发布者插入到变换集合中
           transform = new_transform; // 更新当前变换发布者
@@ -492,85 +511,93 @@ void ROS2::ProcessDataFromCamera(
       {
         log_info("Sensor DepthCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录深度相机数据
         auto sensors = GetOrCreateSensor(ESensors::DepthCamera, stream_id, actor);
-        if (sensors.first) {// 如果存在第一个传感器
-          std::shared_ptr<CarlaDepthCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDepthCameraPublisher>(sensors.first); // 转换为深度相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header) // 如果头信息为空
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true); // 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果存在第二个传感器
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) {// 如果存在第一个传感器
+            std::shared_ptr<CarlaDepthCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDepthCameraPublisher>(sensors.first); // 转换为深度相机发布者
+            const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
+            if (!header) // 如果头信息为空
+              return;// 返回
+            if (!publisher->HasBeenInitialized())// 如果发布者未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true); // 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果存在第二个传感器
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;
     case ESensors::NormalsCamera: // 法线相机
       log_info("Sensor NormalsCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录法线相机数据
       {
         auto sensors = GetOrCreateSensor(ESensors::NormalsCamera, stream_id, actor); // 获取或创建传感器
-        if (sensors.first) { // 如果存在第一个传感器
-          std::shared_ptr<CarlaNormalsCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaNormalsCameraPublisher>(sensors.first);// 转换为法线相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)// 如果头信息为空
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果存在第二个传感器
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish(); // 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) { // 如果存在第一个传感器
+            std::shared_ptr<CarlaNormalsCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaNormalsCameraPublisher>(sensors.first);// 转换为法线相机发布者
+            const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
+            if (!header)// 如果头信息为空
+              return;// 返回
+            if (!publisher->HasBeenInitialized())// 如果发布者未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果存在第二个传感器
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish(); // 发布数据
+          }
+        });
       }
       break;
     case ESensors::LaneInvasionSensor:// 压线传感器
       log_info("Sensor LaneInvasionSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录压线传感器的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
       {
         auto sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);// 获取或创建压线传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first); // 转换为压线发布者
-          publisher->SetData(_seconds, _nanoseconds, (const int32_t*) buffer->data());// 设置数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) {// 如果第一个传感器存在
+            std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first); // 转换为压线发布者
+            publisher->SetData(seconds, nanoseconds, (const int32_t*) buffer->data());// 设置数据
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果第二个传感器存在
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;
     case ESensors::OpticalFlowCamera:// 光流相机传感器
       log_info("Sensor OpticalFlowCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录光流相机的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
       {
         auto sensors = GetOrCreateSensor(ESensors::OpticalFlowCamera, stream_id, actor);// 获取或创建光流相机传感器
-        if (sensors.first) { // 如果第一个传感器存在
-          std::shared_ptr<CarlaOpticalFlowCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaOpticalFlowCameraPublisher>(sensors.first);// 转换为光流相机发布者
-          const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *>(buffer->data());
-          if (!header) // 如果没有图像头，返回
-            return;
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const float*) (buffer->data() + carla::sensor::s11n::OpticalFlowImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) { // 如果第一个传感器存在
+            std::shared_ptr<CarlaOpticalFlowCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaOpticalFlowCameraPublisher>(sensors.first);// 转换为光流相机发布者
+            const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *>(buffer->data());
+            if (!header) // 如果没有图像头，返回
+              return;
+            if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const float*) (buffer->data() + carla::sensor::s11n::OpticalFlowImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果第二个传感器存在
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;
     case ESensors::RssSensor:// RSS传感器
@@ -581,23 +608,25 @@ void ROS2::ProcessDataFromCamera(
       log_info("Sensor SceneCaptureCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录场景捕捉相机的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
       {
         auto sensors = GetOrCreateSensor(ESensors::SceneCaptureCamera, stream_id, actor);// 获取或创建场景捕捉相机传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaRGBCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaRGBCameraPublisher>(sensors.first);// 设置图像数据
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)// 如果没有图像头，返回
-            return;
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) {// 如果第一个传感器存在
+            std::shared_ptr<CarlaRGBCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaRGBCameraPublisher>(sensors.first);// 设置图像数据
+            const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
+            if (!header)// 如果没有图像头，返回
+              return;
+            if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果第二个传感器存在
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;
     }
@@ -605,46 +634,50 @@ void ROS2::ProcessDataFromCamera(
       log_info("Sensor SemanticSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：语义分割相机到ROS数据
       {
         auto sensors = GetOrCreateSensor(ESensors::SemanticSegmentationCamera, stream_id, actor);// 获取或创建传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaSSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaSSCameraPublisher>(sensors.first);// 转换为语义分割相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
-          if (!header) // 如果图像头不存在
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds); // 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) {// 如果第一个传感器存在
+            std::shared_ptr<CarlaSSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaSSCameraPublisher>(sensors.first);// 转换为语义分割相机发布者
+            const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
+            if (!header) // 如果图像头不存在
+              return;// 返回
+            if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds); // 设置相机信息数据
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) {// 如果第二个传感器存在
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;// 结束该case
     case ESensors::InstanceSegmentationCamera:// 实例分割相机
       log_info("Sensor InstanceSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：实例分割相机到ROS数据
       {
         auto sensors = GetOrCreateSensor(ESensors::InstanceSegmentationCamera, stream_id, actor);// 获取或创建传感器
-        if (sensors.first) { // 如果第一个传感器存在
-          std::shared_ptr<CarlaISCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaISCameraPublisher>(sensors.first);// 转换为实例分割相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
-          if (!header)// 如果图像头不存在
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) { // 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+        _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+          if (sensors.first) { // 如果第一个传感器存在
+            std::shared_ptr<CarlaISCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaISCameraPublisher>(sensors.first);// 转换为实例分割相机发布者
+            const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
+              reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
+            if (!header)// 如果图像头不存在
+              return;// 返回
+            if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
+              publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+            publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+            publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+            publisher->Publish();// 发布数据
+          }
+          if (sensors.second) { // 如果第二个传感器存在
+            std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
+            publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+            publisher->Publish();// 发布数据
+          }
+        });
       }
       break;// 结束该case
     case ESensors::WorldObserver:// 世界观察者
@@ -712,25 +745,27 @@ void ROS2::ProcessDataFromDVS(
     void *actor) { // 操作者
   log_info("Sensor DVS to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id);// 记录DVS传感器数据
   auto sensors = GetOrCreateSensor(ESensors::DVSCamera, stream_id, actor);// 获取或创建传感器
-  if (sensors.first) { // 如果存在第一个传感器
-    std::shared_ptr<CarlaDVSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDVSCameraPublisher>(sensors.first);// 将传感器转换为DVS相机发布者
-    const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 图像头信息
-      reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区获取头部
-    if (!header)// 如果头部为空
-      return; // 退出
-    if (!publisher->HasBeenInitialized())  // 如果发布者尚未初始化
-      publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-    size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);// 计算元素数量
-    publisher->SetImageData(_seconds, _nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-    publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-    publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
-    publisher->Publish();// 发布数据
-  }
-  if (sensors.second) { // 如果存在第二个传感器
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
-  }
+  _publisher_pool.Push(actor, sensors.first ? sensors.first->name() : std::string(), [=, seconds = _seconds, nanoseconds = _nanoseconds]() {
+    if (sensors.first) { // 如果存在第一个传感器
+      std::shared_ptr<CarlaDVSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDVSCameraPublisher>(sensors.first);// 将传感器转换为DVS相机发布者
+      const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 图像头信息
+        reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区获取头部
+      if (!header)// 如果头部为空
+        return; // 退出
+      if (!publisher->HasBeenInitialized())  // 如果发布者尚未初始化
+        publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+      size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);// 计算元素数量
+      publisher->SetImageData(seconds, nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+      publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+      publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
+      publisher->Publish();// 发布数据
+    }
+    if (sensors.second) { // 如果存在第二个传感器
+      std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
+      publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
+      publisher->Publish();// 发布变换数据
+    }
+  });
 }
 
 void ROS2::ProcessDataFromLidar(
@@ -832,7 +867,25 @@ void ROS2::ProcessDataFromCollisionSensor(
   }
 }
 
+void ROS2::PublishStatus() {
+  if (!_status_publisher)
+    return;
+  // 每个发布者一行：名称、已发布、丢弃、排队的数量和延迟（最近/平均/最大，毫秒）
+  std::ostringstream status;
+  status << "frame " << _frame << '\n';
+  for (auto &stats : _publisher_pool.GetStats()) {
+    status << stats.name
+           << " published " << stats.published
+           << " dropped " << stats.dropped
+           << " queued " << stats.queued
+           << " latency_ms " << stats.last_latency_ms << ' ' << stats.mean_latency_ms << ' ' << stats.max_latency_ms << '\n';
+  }
+  _status_publisher->SetData(status.str().c_str());
+  _status_publisher->Publish();
+}
+
 void ROS2::Shutdown() {// 关闭
+  _publisher_pool.Stop();// 停止发布线程，丢弃还没有发布的数据
   for (auto& element : _publishers) {// 遍历发布者
     element.second.reset();// 重置发布者
   }
@@ -840,6 +893,8 @@ void ROS2::Shutdown() {// 关闭
     element.second.reset();// 重置变换
   }
   _clock_publisher.reset();// 重置时钟发布者
+  _status_publisher.reset();// 重置状态发布者
+  _tf_publisher.reset();// 重置TF发布者
   _controller.reset();// 重置控制器
   _enabled = false;// 禁用
 }
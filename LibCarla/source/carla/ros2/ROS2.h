@@ -10,6 +10,7 @@
 #include "carla/BufferView.h" // 引入 Carla 缓冲区视图头文件
 #include "carla/geom/Transform.h" // 引入 Carla 变换几何头文件
 #include "carla/ros2/ROS2CallbackData.h" // 引入 ROS2 回调数据头文件
+#include "carla/ros2/ROS2PublisherPool.h" // 引入 ROS2 发布线程池头文件
 #include "carla/streaming/detail/Types.h" // 引入 Carla 流媒体类型头文件
 
 #include <unordered_set> // 引入无序集合头文件
@@ -39,7 +40,9 @@ namespace ros2 {
 
   class CarlaPublisher; // 声明 CarlaPublisher 类
   class CarlaTransformPublisher; // 声明 CarlaTransformPublisher 类
+  class CarlaTFPublisher; // 声明 CarlaTFPublisher 类
   class CarlaClockPublisher; // 声明 CarlaClockPublisher 类
+  class CarlaMapSensorPublisher; // 声明 CarlaMapSensorPublisher 类
   class CarlaEgoVehicleControlSubscriber; // 声明 CarlaEgoVehicleControlSubscriber 类
 
 class ROS2
@@ -78,6 +81,9 @@ class ROS2
   bool IsStreamEnabled(carla::streaming::detail::stream_id_type id) { return _publish_stream.count(id) > 0; } // 检查流是否启用
   void ResetStreams() { _publish_stream.clear(); } // 重置流
 
+  // 发布线程池中每个发布者的延迟和丢弃统计，每秒也会发布到 /carla/status
+  std::vector<ROS2PublisherStats> GetPublisherStats() const { return _publisher_pool.GetStats(); }
+
   // 接收要发布的数据
   void ProcessDataFromCamera(
       uint64_t sensor_type,
@@ -143,6 +149,7 @@ class ROS2
 
  private: // 私有成员
  std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> GetOrCreateSensor(int type, carla::streaming::detail::stream_id_type id, void* actor); // 获取或创建传感器
+ void PublishStatus(); // 发布发布者的统计信息
 
 // 单例
 ROS2() {}; // 构造函数
@@ -157,10 +164,15 @@ std::unordered_map<void *, std::string> _actor_ros_name; // Actor 的 ROS 名称
 std::unordered_map<void *, std::vector<void*> > _actor_parent_ros_name; // Actor 的父级 ROS 名称映射
 std::shared_ptr<CarlaEgoVehicleControlSubscriber> _controller; // 控制器实例
 std::shared_ptr<CarlaClockPublisher> _clock_publisher; // 时钟发布者实例
+std::shared_ptr<CarlaMapSensorPublisher> _status_publisher; // 状态发布者实例
+std::shared_ptr<CarlaTFPublisher> _tf_publisher; // 合并所有变换的 TF 发布者实例
+int32_t _status_seconds { 0 }; // 上次发布状态的秒数
 std::unordered_map<void *, std::shared_ptr<CarlaPublisher>> _publishers; // 发布者映射
 std::unordered_map<void *, std::shared_ptr<CarlaTransformPublisher>> _transforms; // 变换发布者映射
 std::unordered_set<carla::streaming::detail::stream_id_type> _publish_stream; // 发布流集合
 std::unordered_map<void *, ActorCallback> _actor_callbacks; // Actor 回调映射
+// 相机数据的发布线程池：数据在发布线程上处理，传感器的回调只交出共享的 Buffer
+ROS2PublisherPool _publisher_pool;
 };
 
 } // namespace ros2
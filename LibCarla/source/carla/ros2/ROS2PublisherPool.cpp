@@ -0,0 +1,159 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ros2/ROS2PublisherPool.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace ros2 {
+
+  constexpr size_t ROS2PublisherPool::DefaultQueueSize;
+
+  ROS2PublisherPool::~ROS2PublisherPool() {
+    Stop();
+  }
+
+  void ROS2PublisherPool::Start(size_t threads) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running)
+      return;
+    _running = true;
+    _workers.CreateThreads(std::max<size_t>(threads, 1u), [this]() { Run(); });
+  }
+
+  void ROS2PublisherPool::Stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_running)
+        return;
+      _running = false;
+    }
+    _condition.notify_all();
+    _workers.JoinAll();
+    // 丢弃还没有发布的数据，释放它们持有的发布者和 Buffer
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queues.clear();
+    _ready.clear();
+  }
+
+  bool ROS2PublisherPool::IsRunning() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _running;
+  }
+
+  void ROS2PublisherPool::SetQueue(const void *key, size_t size, ROS2DropPolicy policy) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &queue = _queues[key];
+    queue.size = std::max<size_t>(size, 1u);
+    queue.policy = policy;
+  }
+
+  void ROS2PublisherPool::Push(const void *key, const std::string &name, Task task) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_running) {
+      lock.unlock();
+      task();
+      return;
+    }
+    auto &queue = _queues[key];
+    queue.removed = false;
+    if (queue.stats.name.empty())
+      queue.stats.name = name;
+    if (queue.items.size() >= queue.size) {
+      ++queue.stats.dropped;
+      if (queue.policy == ROS2DropPolicy::DropNewest)
+        return;
+      queue.items.pop_front();
+    }
+    queue.items.push_back({std::move(task), clock::now()});
+    if (!queue.scheduled) {
+      queue.scheduled = true;
+      _ready.push_back(key);
+      lock.unlock();
+      _condition.notify_one();
+    }
+  }
+
+  void ROS2PublisherPool::Remove(const void *key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _queues.find(key);
+    if (it == _queues.end())
+      return;
+    if (it->second.scheduled) {
+      // 可能有线程正在执行它的任务，由那个线程删除
+      it->second.items.clear();
+      it->second.removed = true;
+    } else {
+      _queues.erase(it);
+    }
+  }
+
+  std::vector<ROS2PublisherStats> ROS2PublisherPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<ROS2PublisherStats> result;
+    result.reserve(_queues.size());
+    for (auto &element : _queues) {
+      if (element.second.removed)
+        continue;
+      result.push_back(element.second.stats);
+      result.back().queued = element.second.items.size();
+    }
+    return result;
+  }
+
+  void ROS2PublisherPool::Run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      _condition.wait(lock, [this]() { return !_running || !_ready.empty(); });
+      if (!_running)
+        return;
+      const void *key = _ready.front();
+      _ready.pop_front();
+      auto it = _queues.find(key);
+      if (it == _queues.end())
+        continue;
+      if (it->second.items.empty()) {
+        // 排队的时候被移除了
+        if (it->second.removed)
+          _queues.erase(it);
+        else
+          it->second.scheduled = false;
+        continue;
+      }
+      Item item = std::move(it->second.items.front());
+      it->second.items.pop_front();
+
+      lock.unlock();
+      item.task();
+      const double latency = std::chrono::duration<double, std::milli>(clock::now() - item.time).count();
+      item.task = nullptr;
+      lock.lock();
+
+      // 执行任务的时候其他线程不会删除这个队列，但是可能已经重新 rehash
+      it = _queues.find(key);
+      if (it == _queues.end())
+        continue;
+      auto &queue = it->second;
+      if (queue.removed && queue.items.empty()) {
+        _queues.erase(it);
+        continue;
+      }
+      auto &stats = queue.stats;
+      ++stats.published;
+      stats.last_latency_ms = latency;
+      stats.mean_latency_ms += (latency - stats.mean_latency_ms) / static_cast<double>(stats.published);
+      stats.max_latency_ms = std::max(stats.max_latency_ms, latency);
+      if (queue.items.empty()) {
+        queue.scheduled = false;
+      } else {
+        _ready.push_back(key);
+      }
+    }
+  }
+
+} // namespace ros2
+} // namespace carla
@@ -0,0 +1,112 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h" // 引入不可复制类
+#include "carla/ThreadGroup.h" // 引入线程组
+
+#include <chrono> // 引入时间库
+#include <condition_variable> // 引入条件变量
+#include <cstdint> // 引入固定宽度整数类型
+#include <deque> // 引入双端队列
+#include <functional> // 引入函数对象
+#include <mutex> // 引入互斥锁
+#include <string> // 引入字符串
+#include <unordered_map> // 引入无序映射
+#include <vector> // 引入向量
+
+namespace carla {
+namespace ros2 {
+
+  /// 发布者的队列满了以后的处理方式
+  enum class ROS2DropPolicy {
+    DropOldest, ///< 丢弃队列中最旧的数据，订阅者总是收到最新的数据（默认）
+    DropNewest  ///< 丢弃新到的数据，已经在队列中的数据都会被发布
+  };
+
+  /// 一个发布者的统计信息
+  struct ROS2PublisherStats {
+    std::string name; ///< 发布者的名称
+    uint64_t published { 0u }; ///< 已发布的数据数量
+    uint64_t dropped { 0u }; ///< 因为队列已满而丢弃的数据数量
+    size_t queued { 0u }; ///< 正在排队的数据数量
+    double last_latency_ms { 0.0 }; ///< 最近一次从入队到发布完成的时间
+    double mean_latency_ms { 0.0 }; ///< 平均延迟
+    double max_latency_ms { 0.0 }; ///< 最大延迟
+  };
+
+  /// 在专用的线程上发布 ROS2 数据，传感器的回调只需要把数据（共享的
+  /// Buffer）交给线程池，不会被 DDS 的发现过程或者慢的订阅者阻塞。
+  ///
+  /// 每个发布者（以 key 区分）都有自己的有界队列，同一个发布者的任务按顺序
+  /// 执行且不会并行执行，不同发布者的任务在线程池中并行执行。
+  class ROS2PublisherPool : private NonCopyable {
+  public:
+
+    using Task = std::function<void()>;
+
+    static constexpr size_t DefaultQueueSize = 2u;
+
+    ~ROS2PublisherPool();
+
+    /// 启动 threads 个发布线程
+    void Start(size_t threads);
+
+    /// 停止发布线程，丢弃所有还没有发布的数据
+    void Stop();
+
+    bool IsRunning() const;
+
+    /// 设置一个发布者的队列长度和丢弃策略
+    void SetQueue(const void *key, size_t size, ROS2DropPolicy policy);
+
+    /// 把 task 放入 key 的队列。如果线程池没有启动，直接在当前线程执行
+    void Push(const void *key, const std::string &name, Task task);
+
+    /// 移除 key 的队列和统计信息，丢弃还没有执行的任务
+    void Remove(const void *key);
+
+    std::vector<ROS2PublisherStats> GetStats() const;
+
+  private:
+
+    using clock = std::chrono::steady_clock;
+
+    struct Item {
+      Task task;
+      clock::time_point time;
+    };
+
+    struct Queue {
+      std::deque<Item> items;
+      size_t size { DefaultQueueSize };
+      ROS2DropPolicy policy { ROS2DropPolicy::DropOldest };
+      /// 在 _ready 中或者正在执行，保证同一个队列只有一个线程在处理
+      bool scheduled { false };
+      /// 执行任务的时候被移除了，任务结束以后再删除
+      bool removed { false };
+      ROS2PublisherStats stats;
+    };
+
+    void Run();
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::unordered_map<const void *, Queue> _queues;
+
+    /// 有任务等待执行的队列
+    std::deque<const void *> _ready;
+
+    bool _running { false };
+
+    ThreadGroup _workers;
+  };
+
+} // namespace ros2
+} // namespace carla
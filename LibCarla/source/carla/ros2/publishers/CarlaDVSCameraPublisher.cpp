@@ -27,6 +27,7 @@
 #include <fastrtps/qos/QosPolicies.h>
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>
 #include <fastdds/dds/publisher/DataWriterListener.hpp>
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 
 /**
  * @namespace carla::ros2
@@ -193,6 +194,7 @@ namespace ros2 {
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
@@ -314,6 +316,7 @@ namespace ros2 {
     /// 获取DomainParticipantFactory的实例
     auto factory = efd::DomainParticipantFactory::get_instance();
     /// 创建DomainParticipant
+    SetSharedMemoryTransport(pqos);
     _point_cloud->_participant = factory->create_participant(0, pqos);
     if (_point_cloud->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
@@ -24,6 +24,7 @@
 #include <fastrtps/qos/QosPolicies.h>
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>// 引入数据写入器QoS配置类
 #include <fastdds/dds/publisher/DataWriterListener.hpp>// 引入数据写入器监听器类
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 
 /**
  * @namespace carla::ros2
@@ -165,6 +166,7 @@ namespace ros2 {
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
@@ -461,11 +463,8 @@ namespace ros2 {
  * @param width 图像的宽度
  * @param data 指向图像数据的指针，数据格式为BGRA，每个像素4个字节
  */
-  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {    std::vector<uint8_t> vector_data;
-    const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
-    SetData(seconds, nanoseconds,height, width, std::move(vector_data));
+  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
+    SetData(seconds, nanoseconds, height, width, CopyPixels(data, height * width * 4));
   }
   /**
  * @brief 设置感兴趣区域（ROI）信息
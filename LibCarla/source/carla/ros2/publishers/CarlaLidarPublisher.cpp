@@ -22,6 +22,7 @@
 #include <fastrtps/qos/QosPolicies.h>
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>
 #include <fastdds/dds/publisher/DataWriterListener.hpp>
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 /**
  * @namespace carla::ros2
  * @brief 命名空间，包含CARLA与ROS2集成相关的类和函数。
@@ -88,6 +89,7 @@ namespace ros2 {
     pqos.name(_name);
     // 创建域参与者
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
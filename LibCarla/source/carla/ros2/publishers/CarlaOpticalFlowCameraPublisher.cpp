@@ -24,6 +24,7 @@
 #include <fastrtps/qos/QosPolicies.h> // 引入QoS策略的类定义
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>// 引入数据写入器QoS配置的类定义
 #include <fastdds/dds/publisher/DataWriterListener.hpp>// 引入数据写入器监听器的类定义（用于处理写入事件）
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 /**
  * @brief 通用CLAMP函数，用于将值限制在指定范围内。
  *
@@ -135,6 +136,7 @@ namespace ros2 {
     /// 获取DomainParticipantFactory的实例。
     auto factory = efd::DomainParticipantFactory::get_instance();
     /// 创建DomainParticipant。
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         /// 如果创建DomainParticipant失败，输出错误信息并返回false。
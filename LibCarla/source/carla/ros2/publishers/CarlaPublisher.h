@@ -6,6 +6,8 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 // 引入 C++ 标准字符串库，用于处理字符串相关操作
 #include <string>
+#include <cstdint>
+#include <vector>
 
 namespace carla {
 namespace ros2 {  
@@ -26,6 +28,12 @@ namespace ros2 {
       CarlaPublisher() = default;    // 析构函数，使用编译器生成的默认析构函数实现，析构函数在子类中可能会被重写以释放特定资源
       virtual ~CarlaPublisher() = default;
 
+    protected:
+      // 复制 @a size 字节的传感器数据作为消息内容。直接从数据构造，避免 resize 先把整幅图像清零
+      static std::vector<uint8_t> CopyPixels(const uint8_t *data, size_t size) {
+        return std::vector<uint8_t>(data, data + size);
+      }
+
     protected:  // 存储帧 ID 的字符串成员变量，初始化为空字符串
       std::string _frame_id = "";//存储名称的字符串成员变量，初始化为空字符串
       std::string _name = "";   // 存储父级名称的字符串成员变量，初始化为空字符串
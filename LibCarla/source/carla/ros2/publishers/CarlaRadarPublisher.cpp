@@ -23,6 +23,7 @@
 #include <fastrtps/qos/QosPolicies.h>/// @brief 包含Fast-RTPS服务质量（QoS）策略的头文件。
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>/// @brief 包含Fast-DDS数据写入器服务质量（QoS）的头文件。
 #include <fastdds/dds/publisher/DataWriterListener.hpp>/// @brief 包含Fast-DDS数据写入器监听器的头文件。
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 
 /**
  * @namespace carla::ros2
@@ -115,6 +116,7 @@ namespace ros2 {
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name); // 设置域参与者的名称
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     /**
    * 检查域参与者是否创建成功。如果为nullptr，表示创建失败，打印错误信息并返回false。
@@ -24,6 +24,7 @@
 // 引入Fast-DDS中DataWriter的QoS配置和数据写入监听器
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>// DataWriterQos类，用于配置DataWriter的QoS策略
 #include <fastdds/dds/publisher/DataWriterListener.hpp>// DataWriterListener类，用于监听DataWriter的事件
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 /**
  * @namespace carla::ros2
  * @brief 此命名空间包含了CARLA与ROS2集成相关的类和函数。
@@ -160,6 +161,7 @@ namespace ros2 {
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
@@ -454,11 +456,7 @@ namespace ros2 {
  * @param data 图像数据的指针，假设为BGRA格式
  */
   void CarlaSSCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;
-    const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
-    SetData(seconds, nanoseconds, height, width, std::move(vector_data));
+    SetData(seconds, nanoseconds, height, width, CopyPixels(data, height * width * 4));
   }
   /**
  * @brief 设置感兴趣区域的信息
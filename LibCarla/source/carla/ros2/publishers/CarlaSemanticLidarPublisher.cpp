@@ -22,6 +22,7 @@
 #include <fastrtps/qos/QosPolicies.h>  // 引入QoS策略类
 #include <fastdds/dds/publisher/qos/DataWriterQos.hpp>// 引入数据写入器QoS类
 #include <fastdds/dds/publisher/DataWriterListener.hpp>// 引入数据写入器监听器类
+#include "carla/ros2/publishers/CarlaSharedMemoryTransport.h"
 
 /**
  * @namespace carla::ros2
@@ -69,6 +70,7 @@ namespace ros2 {
     efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
     pqos.name(_name);
     auto factory = efd::DomainParticipantFactory::get_instance();
+    SetSharedMemoryTransport(pqos);
     _impl->_participant = factory->create_participant(0, pqos);
     if (_impl->_participant == nullptr) {
         std::cerr << "Failed to create DomainParticipant" << std::endl;
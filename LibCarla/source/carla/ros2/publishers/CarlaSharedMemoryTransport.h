@@ -0,0 +1,37 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma de Barcelona (UAB).
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+#define _GLIBCXX_USE_CXX11_ABI 0
+
+#include <cstdint>
+#include <memory>
+
+#include <fastdds/dds/domain/qos/DomainParticipantQos.hpp>
+#include <fastdds/rtps/transport/UDPv4TransportDescriptor.h>
+#include <fastdds/rtps/transport/shared_mem/SharedMemTransportDescriptor.h>
+
+namespace carla {
+namespace ros2 {
+
+  /// 共享内存段的大小。FastDDS 默认的段只有 512 KiB，放不下一帧图像或点云，
+  /// 大消息会退回 UDP，这里的大小可以容纳几帧 1080p 的 bgra8 图像。
+  constexpr uint32_t CarlaSharedMemoryTransport_SegmentSize = 64u * 1024u * 1024u;
+
+  /// 为发布大消息（图像、点云）的参与者配置传输：先用共享内存，同一台机器上的
+  /// ROS2 节点不经过网络协议栈就能收到数据；其他机器上的节点仍然通过 UDP 接收。
+  ///
+  /// 图像和点云是无界序列，不能使用 loan_sample 和 data sharing（它们只支持
+  /// 固定大小的类型），所以这里仍然要序列化一次，但只写入共享内存。
+  inline void SetSharedMemoryTransport(eprosima::fastdds::dds::DomainParticipantQos& pqos,
+      uint32_t segment_size = CarlaSharedMemoryTransport_SegmentSize) {
+    auto shm = std::make_shared<eprosima::fastdds::rtps::SharedMemTransportDescriptor>();
+    shm->segment_size(segment_size);
+    auto udp = std::make_shared<eprosima::fastdds::rtps::UDPv4TransportDescriptor>();
+    pqos.transport().use_builtin_transports = false;
+    pqos.transport().user_transports.push_back(shm);
+    pqos.transport().user_transports.push_back(udp);
+  }
+}
+}
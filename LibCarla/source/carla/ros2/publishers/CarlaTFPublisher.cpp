@@ -0,0 +1,305 @@
+#define _GLIBCXX_USE_CXX11_ABI 0
+
+#include "CarlaTFPublisher.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "carla/ros2/types/TFMessagePubSubTypes.h"
+#include "carla/ros2/listeners/CarlaListener.h"
+
+#include <fastdds/dds/domain/DomainParticipant.hpp>
+#include <fastdds/dds/publisher/Publisher.hpp>
+#include <fastdds/dds/topic/Topic.hpp>
+#include <fastdds/dds/publisher/DataWriter.hpp>
+#include <fastdds/dds/topic/TypeSupport.hpp>
+
+#include <fastdds/dds/domain/qos/DomainParticipantQos.hpp>
+#include <fastdds/dds/domain/DomainParticipantFactory.hpp>
+#include <fastdds/dds/publisher/qos/PublisherQos.hpp>
+#include <fastdds/dds/topic/qos/TopicQos.hpp>
+
+#include <fastrtps/attributes/ParticipantAttributes.h>
+#include <fastrtps/qos/QosPolicies.h>
+#include <fastdds/dds/publisher/qos/DataWriterQos.hpp>
+#include <fastdds/dds/publisher/DataWriterListener.hpp>
+
+namespace carla {
+namespace ros2 {
+
+  namespace efd = eprosima::fastdds::dds;
+  using erc = eprosima::fastrtps::types::ReturnCode_t;
+
+  struct CarlaTFPublisherImpl {
+    efd::DomainParticipant* _participant { nullptr };
+    efd::Publisher* _publisher { nullptr };
+    efd::Topic* _topic { nullptr };
+    efd::Topic* _static_topic { nullptr };
+    efd::DataWriter* _datawriter { nullptr };
+    efd::DataWriter* _static_datawriter { nullptr };
+    efd::TypeSupport _type { new tf2_msgs::msg::TFMessagePubSubType() };
+    CarlaListener _listener {};
+    CarlaListener _static_listener {};
+    /// 保护下面的成员，变换可能从发布线程池中加入
+    std::mutex _mutex;
+    /// 这一帧收集的变换
+    tf2_msgs::msg::TFMessage _transforms {};
+    /// 所有的静态变换，按子帧排序
+    std::map<std::string, geometry_msgs::msg::TransformStamped> _static_transforms;
+    bool _static_changed { false };
+  };
+
+  static bool CheckReturnCode(erc rcode) {
+    if (rcode == erc::ReturnCodeValue::RETCODE_OK) {
+        return true;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_ERROR) {
+        std::cerr << "RETCODE_ERROR" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_UNSUPPORTED) {
+        std::cerr << "RETCODE_UNSUPPORTED" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_BAD_PARAMETER) {
+        std::cerr << "RETCODE_BAD_PARAMETER" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_PRECONDITION_NOT_MET) {
+        std::cerr << "RETCODE_PRECONDITION_NOT_MET" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_OUT_OF_RESOURCES) {
+        std::cerr << "RETCODE_OUT_OF_RESOURCES" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_NOT_ENABLED) {
+        std::cerr << "RETCODE_NOT_ENABLED" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_IMMUTABLE_POLICY) {
+        std::cerr << "RETCODE_IMMUTABLE_POLICY" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_INCONSISTENT_POLICY) {
+        std::cerr << "RETCODE_INCONSISTENT_POLICY" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_ALREADY_DELETED) {
+        std::cerr << "RETCODE_ALREADY_DELETED" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_TIMEOUT) {
+        std::cerr << "RETCODE_TIMEOUT" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_NO_DATA) {
+        std::cerr << "RETCODE_NO_DATA" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_ILLEGAL_OPERATION) {
+        std::cerr << "RETCODE_ILLEGAL_OPERATION" << std::endl;
+        return false;
+    }
+    if (rcode == erc::ReturnCodeValue::RETCODE_NOT_ALLOWED_BY_SECURITY) {
+        std::cerr << "RETCODE_NOT_ALLOWED_BY_SECURITY" << std::endl;
+        return false;
+    }
+    std::cerr << "UNKNOWN" << std::endl;
+    return false;
+  }
+
+  bool CarlaTFPublisher::Init() {
+    if (_impl->_type == nullptr) {
+        std::cerr << "Invalid TypeSupport" << std::endl;
+        return false;
+    }
+
+    efd::DomainParticipantQos pqos = efd::PARTICIPANT_QOS_DEFAULT;
+    pqos.name(_name);
+    auto factory = efd::DomainParticipantFactory::get_instance();
+    _impl->_participant = factory->create_participant(0, pqos);
+    if (_impl->_participant == nullptr) {
+        std::cerr << "Failed to create DomainParticipant" << std::endl;
+        return false;
+    }
+    _impl->_type.register_type(_impl->_participant);
+
+    efd::PublisherQos pubqos = efd::PUBLISHER_QOS_DEFAULT;
+    _impl->_publisher = _impl->_participant->create_publisher(pubqos, nullptr);
+    if (_impl->_publisher == nullptr) {
+      std::cerr << "Failed to create Publisher" << std::endl;
+      return false;
+    }
+
+    efd::TopicQos tqos = efd::TOPIC_QOS_DEFAULT;
+    _impl->_topic = _impl->_participant->create_topic("rt/tf", _impl->_type->getName(), tqos);
+    _impl->_static_topic = _impl->_participant->create_topic("rt/tf_static", _impl->_type->getName(), tqos);
+    if (_impl->_topic == nullptr || _impl->_static_topic == nullptr) {
+        std::cerr << "Failed to create Topic" << std::endl;
+        return false;
+    }
+
+    efd::DataWriterQos wqos = efd::DATAWRITER_QOS_DEFAULT;
+    wqos.endpoint().history_memory_policy = eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
+    efd::DataWriterListener* listener = (efd::DataWriterListener*)_impl->_listener._impl.get();
+    _impl->_datawriter = _impl->_publisher->create_datawriter(_impl->_topic, wqos, listener);
+
+    // 和 ROS2 的 /tf_static 一样：可靠、transient local，只保留最后一条，
+    // 之后加入的订阅者也能收到所有的静态变换
+    efd::DataWriterQos sqos = wqos;
+    sqos.reliability().kind = efd::RELIABLE_RELIABILITY_QOS;
+    sqos.durability().kind = efd::TRANSIENT_LOCAL_DURABILITY_QOS;
+    sqos.history().kind = efd::KEEP_LAST_HISTORY_QOS;
+    sqos.history().depth = 1;
+    efd::DataWriterListener* static_listener = (efd::DataWriterListener*)_impl->_static_listener._impl.get();
+    _impl->_static_datawriter = _impl->_publisher->create_datawriter(_impl->_static_topic, sqos, static_listener);
+    if (_impl->_datawriter == nullptr || _impl->_static_datawriter == nullptr) {
+        std::cerr << "Failed to create DataWriter" << std::endl;
+        return false;
+    }
+
+    _frame_id = _name;
+    return true;
+  }
+
+  bool CarlaTFPublisher::Publish() {
+    tf2_msgs::msg::TFMessage transforms;
+    tf2_msgs::msg::TFMessage static_transforms;
+    bool static_changed = false;
+    {
+      std::lock_guard<std::mutex> lock(_impl->_mutex);
+      std::swap(transforms.transforms(), _impl->_transforms.transforms());
+      // 下一帧的变换数量通常一样，保留容量
+      _impl->_transforms.transforms().reserve(transforms.transforms().size());
+      if (_impl->_static_changed) {
+        static_changed = true;
+        _impl->_static_changed = false;
+        static_transforms.transforms().reserve(_impl->_static_transforms.size());
+        for (auto& element : _impl->_static_transforms) {
+          static_transforms.transforms().push_back(element.second);
+        }
+      }
+    }
+
+    bool result = true;
+    eprosima::fastrtps::rtps::InstanceHandle_t instance_handle;
+    if (!transforms.transforms().empty()) {
+      result = CheckReturnCode(_impl->_datawriter->write(&transforms, instance_handle));
+    }
+    if (static_changed) {
+      eprosima::fastrtps::rtps::InstanceHandle_t static_instance_handle;
+      result = CheckReturnCode(_impl->_static_datawriter->write(&static_transforms, static_instance_handle)) && result;
+    }
+    return result;
+  }
+
+  void CarlaTFPublisher::AddTransform(bool is_static, int32_t seconds, uint32_t nanoseconds,
+      const std::string& parent, const std::string& child,
+      const float* translation, const float* rotation) {
+    builtin_interfaces::msg::Time time;
+    time.sec(seconds);
+    time.nanosec(nanoseconds);
+
+    std_msgs::msg::Header header;
+    header.stamp(std::move(time));
+    header.frame_id(parent);
+
+    geometry_msgs::msg::Vector3 vec_translation;
+    vec_translation.x(translation[0]);
+    vec_translation.y(translation[1]);
+    vec_translation.z(translation[2]);
+    geometry_msgs::msg::Quaternion vec_rotation;
+    vec_rotation.x(rotation[0]);
+    vec_rotation.y(rotation[1]);
+    vec_rotation.z(rotation[2]);
+    vec_rotation.w(rotation[3]);
+
+    geometry_msgs::msg::Transform t;
+    t.rotation(std::move(vec_rotation));
+    t.translation(std::move(vec_translation));
+
+    geometry_msgs::msg::TransformStamped ts;
+    ts.header(std::move(header));
+    ts.transform(std::move(t));
+    ts.child_frame_id(child);
+
+    std::lock_guard<std::mutex> lock(_impl->_mutex);
+    if (is_static) {
+      _impl->_static_transforms[child] = std::move(ts);
+      _impl->_static_changed = true;
+    } else {
+      _impl->_transforms.transforms().push_back(std::move(ts));
+    }
+  }
+
+  void CarlaTFPublisher::RemoveStaticTransform(const std::string& child) {
+    std::lock_guard<std::mutex> lock(_impl->_mutex);
+    if (_impl->_static_transforms.erase(child) > 0u)
+      _impl->_static_changed = true;
+  }
+
+  CarlaTFPublisher::CarlaTFPublisher(const char* ros_name, const char* parent) :
+  _impl(std::make_shared<CarlaTFPublisherImpl>()) {
+    _name = ros_name;
+    _parent = parent;
+  }
+
+  CarlaTFPublisher::~CarlaTFPublisher() {
+      if (!_impl)
+          return;
+
+      if (_impl->_datawriter)
+          _impl->_publisher->delete_datawriter(_impl->_datawriter);
+
+      if (_impl->_static_datawriter)
+          _impl->_publisher->delete_datawriter(_impl->_static_datawriter);
+
+      if (_impl->_publisher)
+          _impl->_participant->delete_publisher(_impl->_publisher);
+
+      if (_impl->_topic)
+          _impl->_participant->delete_topic(_impl->_topic);
+
+      if (_impl->_static_topic)
+          _impl->_participant->delete_topic(_impl->_static_topic);
+
+      if (_impl->_participant)
+          efd::DomainParticipantFactory::get_instance()->delete_participant(_impl->_participant);
+  }
+
+  CarlaTFPublisher::CarlaTFPublisher(const CarlaTFPublisher& other) {
+    _frame_id = other._frame_id;
+    _name = other._name;
+    _parent = other._parent;
+    _impl = other._impl;
+  }
+
+  CarlaTFPublisher& CarlaTFPublisher::operator=(const CarlaTFPublisher& other) {
+    _frame_id = other._frame_id;
+    _name = other._name;
+    _parent = other._parent;
+    _impl = other._impl;
+
+    return *this;
+  }
+
+  CarlaTFPublisher::CarlaTFPublisher(CarlaTFPublisher&& other) {
+    _frame_id = std::move(other._frame_id);
+    _name = std::move(other._name);
+    _parent = std::move(other._parent);
+    _impl = std::move(other._impl);
+  }
+
+  CarlaTFPublisher& CarlaTFPublisher::operator=(CarlaTFPublisher&& other) {
+    _frame_id = std::move(other._frame_id);
+    _name = std::move(other._name);
+    _parent = std::move(other._parent);
+    _impl = std::move(other._impl);
+
+    return *this;
+  }
+}
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma de Barcelona (UAB).
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+#define _GLIBCXX_USE_CXX11_ABI 0
+
+#include <memory>
+#include <string>
+
+#include "CarlaPublisher.h"
+
+namespace carla {
+namespace ros2 {
+
+  struct CarlaTFPublisherImpl;
+
+  /**
+   * @class CarlaTFPublisher
+   * @brief 把所有的变换合并成每帧一条 tf2_msgs/TFMessage 发布。
+   *
+   * 每个 CarlaTransformPublisher 只把自己的变换加入这里，不再各自创建 DDS
+   * 参与者和写入器。相对父节点的变换是固定的，放在 /tf_static 上（transient
+   * local，只在变化时重新发布全部静态变换），其他变换每帧发布在 /tf 上。
+   * 可以从多个线程添加变换。
+   */
+  class CarlaTFPublisher : public CarlaPublisher {
+    public:
+      CarlaTFPublisher(const char* ros_name = "", const char* parent = "");
+      ~CarlaTFPublisher();
+      CarlaTFPublisher(const CarlaTFPublisher&);
+      CarlaTFPublisher& operator=(const CarlaTFPublisher&);
+      CarlaTFPublisher(CarlaTFPublisher&&);
+      CarlaTFPublisher& operator=(CarlaTFPublisher&&);
+
+      bool Init();
+      /// 发布这一帧收集的变换，静态变换有变化时也重新发布
+      bool Publish();
+
+      /**
+       * @brief 加入一个变换，值已经转换到 ROS 的坐标系。
+       *
+       * @param translation x, y, z
+       * @param rotation 四元数 x, y, z, w
+       */
+      void AddTransform(bool is_static, int32_t seconds, uint32_t nanoseconds,
+          const std::string& parent, const std::string& child,
+          const float* translation, const float* rotation);
+      /// 移除一个静态变换（例如传感器被销毁）
+      void RemoveStaticTransform(const std::string& child);
+
+      const char* type() const override { return "tf"; }
+
+    private:
+      std::shared_ptr<CarlaTFPublisherImpl> _impl;
+  };
+}
+}
@@ -1,6 +1,7 @@
 #define _GLIBCXX_USE_CXX11_ABI 0
 
 #include "CarlaTransformPublisher.h"// 包含CarlaTransformPublisher类的声明
+#include "CarlaTFPublisher.h"// 包含合并发布的TF发布者
 
 #include <string>// 包含字符串处理功能
 // 包含CARLA ROS2类型定义和监听器类
@@ -62,6 +63,9 @@ namespace ros2 {
     geometry_msgs::msg::Vector3 vec_translation;
     /// 旋转信息的ROS2消息表示（使用四元数）。
     geometry_msgs::msg::Quaternion vec_rotation;
+    int32_t seconds { 0 };
+    uint32_t nanoseconds { 0u };
+    bool changed { true };
   };
   /**
  * @brief 初始化CarlaTransformPublisher对象
@@ -79,6 +83,13 @@ namespace ros2 {
         std::cerr << "Invalid TypeSupport" << std::endl;
         return false;
     }
+    /**
+     * 合并发布时不需要自己的 DDS 实体。
+     */
+    if (_tf) {
+      _frame_id = _name;
+      return true;
+    }
     /**
      * 设置DomainParticipant的QoS策略，并使用默认QoS创建一个DomainParticipant。
      * 设置DomainParticipant的名称为_name。
@@ -156,6 +167,24 @@ namespace ros2 {
  * @return bool 发布成功返回true，否则返回false。
  */
   bool CarlaTransformPublisher::Publish() {
+    // 合并发布：相对父节点的变换作为静态变换，只在变化时加入
+    if (_tf) {
+      const bool is_static = !_parent.empty();
+      if (is_static && !_impl->changed)
+        return true;
+      _impl->changed = false;
+      const float translation[3] = {
+        static_cast<float>(_impl->vec_translation.x()),
+        static_cast<float>(_impl->vec_translation.y()),
+        static_cast<float>(_impl->vec_translation.z()) };
+      const float rotation[4] = {
+        static_cast<float>(_impl->vec_rotation.x()),
+        static_cast<float>(_impl->vec_rotation.y()),
+        static_cast<float>(_impl->vec_rotation.z()),
+        static_cast<float>(_impl->vec_rotation.w()) };
+      _tf->AddTransform(is_static, _impl->seconds, _impl->nanoseconds, _parent, _frame_id, translation, rotation);
+      return true;
+    }
       /**
      * 声明一个InstanceHandle_t类型的变量instance_handle，用于接收write方法的返回值。
      */
@@ -258,7 +287,10 @@ namespace ros2 {
     int same_translation = std::memcmp(translation, _impl->last_translation, sizeof(float) * 3);
     int same_rotation = std::memcmp(rotation, _impl->last_rotation, sizeof(float) * 3);
     // 如果位置或旋转有变化，则更新内部状态
+    _impl->seconds = seconds;
+    _impl->nanoseconds = nanoseconds;
     if (same_translation != 0 || same_rotation != 0) {
+        _impl->changed = true;
         std::memcpy(_impl->last_translation, translation, sizeof(float) * 3);
         std::memcpy(_impl->last_rotation, rotation, sizeof(float) * 3);
         // 从数组中解包位置信息
@@ -286,6 +318,9 @@ namespace ros2 {
         _impl->vec_rotation.y(cr * sp * cy + sr * cp * sy);
         _impl->vec_rotation.z(cr * cp * sy - sr * sp * cy);
     }
+    // 合并发布时由 Publish 把变换交给 TF 发布者
+    if (_tf)
+      return;
     // 设置时间戳
     builtin_interfaces::msg::Time time;
     time.sec(seconds);
@@ -313,9 +348,11 @@ namespace ros2 {
  *
  * @param ros_name ROS 节点名称
  * @param parent 父帧ID
+ * @param tf 合并发布的 TF 发布者，可以为空
  */
-  CarlaTransformPublisher::CarlaTransformPublisher(const char* ros_name, const char* parent) :
-  _impl(std::make_shared<CarlaTransformPublisherImpl>()) {
+  CarlaTransformPublisher::CarlaTransformPublisher(const char* ros_name, const char* parent, std::shared_ptr<CarlaTFPublisher> tf) :
+  _impl(std::make_shared<CarlaTransformPublisherImpl>()),
+  _tf(std::move(tf)) {
     _name = ros_name;
     _parent = parent;
   }
@@ -327,6 +364,9 @@ namespace ros2 {
   CarlaTransformPublisher::~CarlaTransformPublisher() {
       if (!_impl)
           return;
+      // 传感器被销毁以后，它的静态变换不再发布
+      if (_tf && !_parent.empty())
+          _tf->RemoveStaticTransform(_frame_id);
       // 删除 DataWriter
       if (_impl->_datawriter)
           _impl->_publisher->delete_datawriter(_impl->_datawriter);
@@ -353,6 +393,7 @@ namespace ros2 {
     _name = other._name;
     _parent = other._parent;
     _impl = other._impl;// 浅拷贝 _impl 指针
+    _tf = other._tf;
   }
   /**
  * @brief 赋值运算符重载
@@ -368,6 +409,7 @@ namespace ros2 {
     _name = other._name;
     _parent = other._parent;
     _impl = other._impl;// 浅拷贝 _impl 指针
+    _tf = other._tf;
 
     return *this;
   }
@@ -383,6 +425,7 @@ namespace ros2 {
     _name = std::move(other._name);
     _parent = std::move(other._parent);
     _impl = std::move(other._impl);// 移动 _impl 指针
+    _tf = std::move(other._tf);
   }
   /**
  * @brief 移动赋值运算符重载
@@ -397,6 +440,7 @@ namespace ros2 {
     _name = std::move(other._name);
     _parent = std::move(other._parent);
     _impl = std::move(other._impl);// 移动 _impl 指针
+    _tf = std::move(other._tf);
 
     return *this;
   }
@@ -24,6 +24,7 @@ namespace ros2 {
      * @brief CarlaTransformPublisher类的内部实现结构体，采用Pimpl（Pointer to IMPLementation）惯用法隐藏实现细节。
      */
   struct CarlaTransformPublisherImpl;
+  class CarlaTFPublisher;
   /**
      * @class CarlaTransformPublisher
      * @brief CarlaTransformPublisher类继承自CarlaPublisher，用于在CARLA中发布变换信息到ROS2。
@@ -34,8 +35,9 @@ namespace ros2 {
             * @brief 构造函数，初始化CarlaTransformPublisher对象。
             * @param ros_name ROS2节点的名称，默认为空字符串。
             * @param parent 父节点的名称，默认为空字符串。
+            * @param tf 合并发布的 TF 发布者。不为空时变换只加入 tf，不创建自己的 DDS 写入器。
             */
-      CarlaTransformPublisher(const char* ros_name = "", const char* parent = "");
+      CarlaTransformPublisher(const char* ros_name = "", const char* parent = "", std::shared_ptr<CarlaTFPublisher> tf = nullptr);
       /**
              * @brief 析构函数，释放CarlaTransformPublisher对象占用的资源。
              */
@@ -91,6 +93,10 @@ namespace ros2 {
              * @brief 指向CarlaTransformPublisherImpl的智能指针，用于隐藏实现细节。
              */
       std::shared_ptr<CarlaTransformPublisherImpl> _impl;
+      /**
+             * @brief 合并发布的 TF 发布者，可以为空。
+             */
+      std::shared_ptr<CarlaTFPublisher> _tf;
   };
 }
 }
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/Location.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  using ActorQueryFieldType = uint32_t;
+
+  /// ActorQuery 中可以请求的字段，可以按位组合。
+  enum class ActorQueryField : ActorQueryFieldType {
+    None            =  0,
+    TypeId          =  0x1,
+    ParentId        =  0x1 << 1,
+    SemanticTags    =  0x1 << 2,
+    Attributes      =  0x1 << 3,
+    BoundingBox     =  0x1 << 4,
+    Transform       =  0x1 << 5,
+    Velocity        =  0x1 << 6,
+    AngularVelocity =  0x1 << 7,
+    All             =  0xFFFFFFFF,
+  };
+
+  /// 在一次调用中查询多个演员的请求。
+  ///
+  /// 所有条件同时满足的演员才会被返回，每个条件为空时不进行过滤。
+  class ActorQuery {
+  public:
+
+    /// 只查询这些演员，为空时查询所有演员。
+    std::vector<ActorId> actor_ids;
+
+    /// 类型 ID 的通配符，例如 "vehicle.*"。
+    std::string type_id_filter;
+
+    /// 只返回具有其中至少一个语义标签的演员。
+    std::vector<uint8_t> semantic_tags;
+
+    /// 只返回距离 @a center 不超过 @a radius 米的演员，radius 不大于 0 时不过滤。
+    geom::Location center;
+
+    float radius = 0.0f;
+
+    /// 要返回的字段，ActorQueryField 的按位组合。
+    ActorQueryFieldType fields = static_cast<ActorQueryFieldType>(ActorQueryField::All);
+
+    bool HasField(ActorQueryField field) const {
+      return (fields & static_cast<ActorQueryFieldType>(field)) != 0u;
+    }
+
+    MSGPACK_DEFINE_ARRAY(actor_ids, type_id_filter, semantic_tags, center, radius, fields);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,74 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/rpc/ActorAttribute.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/ActorQuery.h"
+
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// ActorQuery 的结果，按列存储。
+  ///
+  /// 每一列的第 i 个元素对应 ids[i]，没有请求的字段对应的列为空。
+  class ActorQueryResult {
+  public:
+
+    /// 生成结果时使用的字段，ActorQueryField 的按位组合。
+    ActorQueryFieldType fields = 0u;
+
+    std::vector<ActorId> ids;
+
+    std::vector<std::string> type_ids;
+
+    std::vector<ActorId> parent_ids;
+
+    std::vector<std::vector<uint8_t>> semantic_tags;
+
+    std::vector<std::vector<ActorAttributeValue>> attributes;
+
+    std::vector<geom::BoundingBox> bounding_boxes;
+
+    std::vector<geom::Transform> transforms;
+
+    /// 单位为 m/s。
+    std::vector<geom::Vector3D> velocities;
+
+    /// 单位为 deg/s。
+    std::vector<geom::Vector3D> angular_velocities;
+
+    size_t size() const {
+      return ids.size();
+    }
+
+    bool HasField(ActorQueryField field) const {
+      return (fields & static_cast<ActorQueryFieldType>(field)) != 0u;
+    }
+
+    MSGPACK_DEFINE_ARRAY(
+        fields,
+        ids,
+        type_ids,
+        parent_ids,
+        semantic_tags,
+        attributes,
+        bounding_boxes,
+        transforms,
+        velocities,
+        angular_velocities);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorDescription.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/AttachmentType.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 在一次调用中生成多个演员的请求。
+  ///
+  /// 每种蓝图的描述只发送一次，服务器也只解析一次，每个要生成的演员通过
+  /// 索引引用其中一个描述。
+  class ActorSpawnBatch {
+  public:
+
+    class Entry {
+    public:
+
+      /// 在 ActorSpawnBatch::descriptions 中的索引。
+      uint32_t description = 0u;
+
+      geom::Transform transform;
+
+      /// 父演员的 ID，0 表示没有父演员。
+      ActorId parent = 0u;
+
+      AttachmentType attachment_type = AttachmentType::Rigid;
+
+      std::string socket_name;
+
+      MSGPACK_DEFINE_ARRAY(description, transform, parent, attachment_type, socket_name);
+    };
+
+    /// 添加一种蓝图的描述，返回其索引。
+    uint32_t AddDescription(ActorDescription description) {
+      descriptions.emplace_back(std::move(description));
+      return static_cast<uint32_t>(descriptions.size() - 1u);
+    }
+
+    /// 添加一个要生成的演员。
+    void Add(
+        uint32_t description,
+        const geom::Transform &transform,
+        ActorId parent = 0u,
+        AttachmentType attachment_type = AttachmentType::Rigid,
+        std::string socket_name = {}) {
+      entries.emplace_back();
+      auto &entry = entries.back();
+      entry.description = description;
+      entry.transform = transform;
+      entry.parent = parent;
+      entry.attachment_type = attachment_type;
+      entry.socket_name = std::move(socket_name);
+    }
+
+    std::vector<ActorDescription> descriptions;
+
+    std::vector<Entry> entries;
+
+    /// 大于 0 时，服务器先检查每个生成点周围该半径（米）内是否已有车辆、行人
+    /// 或物理物体，以及同一批中的生成点之间是否相距过近，不满足的生成点不会
+    /// 生成演员。
+    float validation_radius = 0.0f;
+
+    MSGPACK_DEFINE_ARRAY(descriptions, entries, validation_radius);
+  };
+
+} // namespace rpc
+} // namespace carla
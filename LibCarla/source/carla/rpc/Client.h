@@ -9,6 +9,9 @@
 #include "carla/rpc/Metadata.h"
 
 #include <rpc/client.h>
+#include <rpc/rpc_error.h>
+
+#include <string>
 
 namespace carla {
 namespace rpc {
@@ -27,6 +30,10 @@ namespace rpc {
     auto get_timeout() const {
       return _client.get_timeout();
     }
+//连接是否仍然可用
+    bool is_connected() const {
+      return _client.get_connection_state() == ::rpc::client::connection_state::connected;
+    }
 //调用底层 rpc::client 对象的 set_timeout 方法来设置超时
     template <typename... Args>
     auto call(const std::string &function, Args &&... args) {
@@ -37,6 +44,24 @@ namespace rpc {
     void async_call(const std::string &function, Args &&... args) {
       _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
     }
+
+    /// 发出一个需要响应的调用，但不等待响应，而是返回响应的 future。
+    /// 同一连接上可以同时有多个这样的请求，服务器按顺序处理并返回响应。
+    template <typename... Args>
+    auto pipelined_call(const std::string &function, Args &&... args) {
+      return _client.async_call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
+    }
+
+    /// 服务器没有绑定所调用的函数时为 true，例如连接的是较旧的服务器。函数
+    /// 本身返回的错误（carla::rpc::Response）不会抛出 ::rpc::rpc_error。
+    static bool IsFunctionNotFound(::rpc::rpc_error &error) {
+      const auto &object = error.get_error().get();
+      if (object.type != clmdep_msgpack::type::STR) {
+        return false;
+      }
+      return object.as<std::string>().find("could not be found") != std::string::npos;
+    }
+
   private:
 //async_call 方法用于执行异步的 RPC 调用
     ::rpc::client _client;
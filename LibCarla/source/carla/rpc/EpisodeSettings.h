@@ -54,9 +54,25 @@ namespace rpc {
 
     bool spectator_as_ego = true;
 
+    // PhysX 的增强确定性：结果不依赖物体加入场景的顺序和线程调度，
+    // 在加载地图创建物理场景时生效
+    bool deterministic_physics = false;
+
+    // 距离所有 hero 车辆超过该距离（米）的车辆使用运动学模型代替完整的物理，0 表示不启用
+    float kinematic_physics_distance = 0.0f;
+
+    // 只运行物理和交通的服务器：隐含 no_rendering_mode，并且跳过相机的渲染与读回、
+    // 天气的视觉效果和行人在画面外的骨骼动画
+    bool physics_only_mode = false;
+
+    // 异步模式且有固定时间步长时，服务器按该实时因子（模拟时间与墙钟时间之比）
+    // 控制每一帧的节奏，超出预算时减少物理子步并推迟传感器，0 表示不启用
+    double target_realtime_factor = 0.0;
+
     MSGPACK_DEFINE_ARRAY(synchronous_mode, no_rendering_mode, fixed_delta_seconds, substepping,
         max_substep_delta_time, max_substeps, max_culling_distance, deterministic_ragdolls,
-        tile_stream_distance, actor_active_distance, spectator_as_ego);
+        tile_stream_distance, actor_active_distance, spectator_as_ego, deterministic_physics,
+        kinematic_physics_distance, physics_only_mode, target_realtime_factor);
 
     // =========================================================================
     // -- 构造函数 --------------------------------------------------------------
@@ -75,7 +91,11 @@ namespace rpc {
         bool deterministic_ragdolls = true,
         float tile_stream_distance = 3000.f,
         float actor_active_distance = 2000.f,
-        bool spectator_as_ego = true)
+        bool spectator_as_ego = true,
+        bool deterministic_physics = false,
+        float kinematic_physics_distance = 0.0f,
+        bool physics_only_mode = false,
+        double target_realtime_factor = 0.0)
       : synchronous_mode(synchronous_mode),
         no_rendering_mode(no_rendering_mode),
         fixed_delta_seconds(
@@ -87,7 +107,11 @@ namespace rpc {
         deterministic_ragdolls(deterministic_ragdolls),
         tile_stream_distance(tile_stream_distance),
         actor_active_distance(actor_active_distance),
-        spectator_as_ego(spectator_as_ego) {}
+        spectator_as_ego(spectator_as_ego),
+        deterministic_physics(deterministic_physics),
+        kinematic_physics_distance(kinematic_physics_distance),
+        physics_only_mode(physics_only_mode),
+        target_realtime_factor(target_realtime_factor) {}
 
     // =========================================================================
     // -- 比较操作符 ------------------------------------------------------------
@@ -105,7 +129,11 @@ namespace rpc {
           (deterministic_ragdolls == rhs.deterministic_ragdolls) &&
           (tile_stream_distance == rhs.tile_stream_distance) &&
           (actor_active_distance == rhs.actor_active_distance) &&
-          (spectator_as_ego == rhs.spectator_as_ego);
+          (spectator_as_ego == rhs.spectator_as_ego) &&
+          (deterministic_physics == rhs.deterministic_physics) &&
+          (kinematic_physics_distance == rhs.kinematic_physics_distance) &&
+          (physics_only_mode == rhs.physics_only_mode) &&
+          (target_realtime_factor == rhs.target_realtime_factor);
     }
 
     bool operator!=(const EpisodeSettings &rhs) const {
@@ -130,10 +158,14 @@ namespace rpc {
             Settings.bDeterministicRagdolls,
             Settings.TileStreamingDistance,
             Settings.ActorActiveDistance,
-            Settings.SpectatorAsEgo) {
+            Settings.SpectatorAsEgo,
+            Settings.bDeterministicPhysics) {
       constexpr float CMTOM = 1.f/100.f;
       tile_stream_distance = CMTOM * Settings.TileStreamingDistance;
       actor_active_distance = CMTOM * Settings.ActorActiveDistance;
+      kinematic_physics_distance = CMTOM * Settings.KinematicPhysicsDistance;
+      physics_only_mode = Settings.bPhysicsOnlyMode;
+      target_realtime_factor = Settings.TargetRealTimeFactor;
     }
 
     operator FEpisodeSettings() const {
@@ -152,6 +184,10 @@ namespace rpc {
       Settings.TileStreamingDistance = MTOCM * tile_stream_distance;
       Settings.ActorActiveDistance = MTOCM * actor_active_distance;
       Settings.SpectatorAsEgo = spectator_as_ego;
+      Settings.bDeterministicPhysics = deterministic_physics;
+      Settings.KinematicPhysicsDistance = MTOCM * kinematic_physics_distance;
+      Settings.bPhysicsOnlyMode = physics_only_mode;
+      Settings.TargetRealTimeFactor = target_realtime_factor;
 
       return Settings;
     }
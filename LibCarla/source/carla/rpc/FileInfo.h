@@ -0,0 +1,31 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  /// 服务器上可以分块下载的文件的信息。
+  class FileInfo {
+  public:
+
+    /// 文件大小（字节），文件不存在时为 0。
+    uint64_t size = 0u;
+
+    /// 文件内容的 ContentHash，文件不存在时为空。
+    std::string content_hash;
+
+    MSGPACK_DEFINE_ARRAY(size, content_hash);
+  };
+
+} // namespace rpc
+} // namespace carla
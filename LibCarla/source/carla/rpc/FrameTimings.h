@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace rpc {
+
+  /// 一帧在服务器和客户端各阶段所用的时间，时间单位均为毫秒。
+  ///
+  /// 服务器端的字段由服务器在每一帧记录，客户端的字段由接收剧集状态的
+  /// 客户端记录，不参与序列化。值为负表示该阶段没有被记录。
+  class FrameTimings {
+  public:
+
+    uint64_t frame = 0u;
+
+    /// 服务器开始这一帧时的平台时间（秒）。
+    double platform_timestamp = 0.0;
+
+    /// @name 服务器端
+    /// @{
+
+    /// 等待并处理 RPC 命令（同步模式下包括等待 tick 命令）的时间。
+    float rpc = -1.0f;
+
+    /// OnPreTick 中除 RPC 以外的时间（计时器、次级服务器的帧数据等）。
+    float pre_tick = -1.0f;
+
+    /// 从 OnPreTick 结束到 OnPostTick 开始的时间，包括物理模拟和参与者的 tick。
+    float world_tick = -1.0f;
+
+    /// OnPostTick 中录制器和次级服务器的时间。
+    float post_tick = -1.0f;
+
+    /// 序列化并发送剧集状态的时间。
+    float episode_state = -1.0f;
+
+    /// 传感器在物理模拟之后的 tick（包括提交渲染读取请求）的时间。
+    float sensors = -1.0f;
+
+    /// 从这一帧开始到剧集状态发送以及传感器 tick 结束的时间。
+    float server_total = -1.0f;
+
+    /// @}
+    /// @name 服务器端的实时因子调度（见 EpisodeSettings::target_realtime_factor）
+    /// @{
+
+    /// 这一帧的墙钟时间预算，没有启用调度时为负。
+    float budget = -1.0f;
+
+    /// 为保持节奏在这一帧开始前等待（期间继续处理 RPC）的时间，包含在 rpc 中。
+    float idle = -1.0f;
+
+    /// 最近几帧达到的实时因子（模拟时间与墙钟时间之比）的滑动平均。
+    float realtime_factor = -1.0f;
+
+    /// 这一帧使用的物理子步数，没有启用调度时为 -1。
+    int32_t substeps = -1;
+
+    /// 因超出预算推迟到之后几帧的传感器数量。
+    uint32_t deferred_sensors = 0u;
+
+    /// @}
+    /// @name 客户端
+    /// @{
+
+    /// 反序列化剧集状态的时间。
+    float deserialization = -1.0f;
+
+    /// 执行 on_tick 回调的时间。
+    float callbacks = -1.0f;
+
+    /// @}
+
+    MSGPACK_DEFINE_ARRAY(
+        frame,
+        platform_timestamp,
+        rpc,
+        pre_tick,
+        world_tick,
+        post_tick,
+        episode_state,
+        sensors,
+        server_total,
+        budget,
+        idle,
+        realtime_factor,
+        substeps,
+        deferred_sensors);
+  };
+
+} // namespace rpc
+} // namespace carla
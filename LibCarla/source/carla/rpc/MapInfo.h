@@ -22,7 +22,13 @@ namespace rpc {
 
     std::vector<geom::Transform> recommended_spawn_points;
 
-    MSGPACK_DEFINE_ARRAY(name, recommended_spawn_points);
+    /// OpenDRIVE 文件内容的 ContentHash，客户端据此判断本地缓存是否可用。
+    std::string open_drive_hash;
+
+    /// 导航网格内容的 ContentHash，地图没有导航网格时为空。
+    std::string navigation_mesh_hash;
+
+    MSGPACK_DEFINE_ARRAY(name, recommended_spawn_points, open_drive_hash, navigation_mesh_hash);
   };
 
 } // namespace rpc
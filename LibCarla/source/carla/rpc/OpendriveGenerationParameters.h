@@ -21,14 +21,16 @@ namespace rpc {
         double a_width,
         bool smooth_junc,
         bool e_visibility,
-        bool e_pedestrian)
+        bool e_pedestrian,
+        bool e_streaming = false)
       : vertex_distance(v_distance),
         max_road_length(max_road_len),
         wall_height(w_height),
         additional_width(a_width),
         smooth_junctions(smooth_junc),
         enable_mesh_visibility(e_visibility),
-        enable_pedestrian_navigation(e_pedestrian)
+        enable_pedestrian_navigation(e_pedestrian),
+        enable_mesh_streaming(e_streaming)
         {}
 
     double vertex_distance = 2.0;
@@ -40,6 +42,9 @@ namespace rpc {
     bool smooth_junctions = true;
     bool enable_mesh_visibility = true;
     bool enable_pedestrian_navigation = true;
+    /// Generate the road mesh around the spectator and the hero vehicles
+    /// before the episode starts and the rest of the map in the background
+    bool enable_mesh_streaming = false;
 
     MSGPACK_DEFINE_ARRAY(
         vertex_distance,
@@ -48,7 +53,8 @@ namespace rpc {
         additional_width,
         smooth_junctions,
         enable_mesh_visibility,
-        enable_pedestrian_navigation);
+        enable_pedestrian_navigation,
+        enable_mesh_streaming);
   };
 
 }
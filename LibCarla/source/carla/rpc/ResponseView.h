@@ -0,0 +1,57 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPackView.h"
+#include "carla/rpc/Response.h"
+
+namespace carla {
+namespace rpc {
+
+  /// 序列化后的 Response<T>（T 不为 void）的只读视图，不复制其中的值。
+  ///
+  /// Response<T> 序列化为 [[index, value]]，index 为 0 时 value 是
+  /// ResponseError。
+  class ResponseView {
+  public:
+
+    explicit ResponseView(const MsgPackView &response) {
+      if (response.size() != 1u) {
+        throw_exception(::clmdep_msgpack::type_error());
+      }
+      auto data = response[0u];
+      if (data.size() != 2u) {
+        throw_exception(::clmdep_msgpack::type_error());
+      }
+      _has_error = (data[0u].As<uint64_t>() == 0u);
+      _value = data[1u];
+    }
+
+    bool HasError() const {
+      return _has_error;
+    }
+
+    ResponseError GetError() const {
+      DEBUG_ASSERT(HasError());
+      return _value.As<ResponseError>();
+    }
+
+    /// 值的视图。
+    const MsgPackView &Get() const {
+      DEBUG_ASSERT(!HasError());
+      return _value;
+    }
+
+  private:
+
+    bool _has_error = true;
+
+    MsgPackView _value;
+  };
+
+} // namespace rpc
+} // namespace carla
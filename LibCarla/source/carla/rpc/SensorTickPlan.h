@@ -0,0 +1,61 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 服务器为设置了 sensor_tick 的传感器分配的帧相位，以及由此得到的之后
+  /// 每一帧的传感器开销。
+  ///
+  /// 只有在固定时间步长下才会错开传感器，否则 fixed_delta_seconds 为 0，
+  /// 所有传感器的周期都为 0。
+  class SensorTickPlan {
+  public:
+
+    class Sensor {
+    public:
+
+      ActorId actor_id = 0u;
+
+      /// 传感器每隔多少帧触发一次，0 表示不错开（每帧或按时间间隔触发）。
+      uint32_t period_frames = 0u;
+
+      /// 传感器在帧号对 period_frames 取模等于该值的帧触发。
+      uint32_t phase_frames = 0u;
+
+      /// 用于分配相位的估计开销，单位为相对值。
+      float estimated_cost = 0.0f;
+
+      /// 实际测得的每次触发的平均时间（毫秒），负数表示还没有测量。
+      float measured_cost = -1.0f;
+
+      MSGPACK_DEFINE_ARRAY(actor_id, period_frames, phase_frames, estimated_cost, measured_cost);
+    };
+
+    /// 用于换算周期的固定时间步长（秒）。
+    double fixed_delta_seconds = 0.0;
+
+    std::vector<Sensor> sensors;
+
+    /// frame_costs 中第一帧的帧号。
+    uint64_t first_frame = 0u;
+
+    /// 从 first_frame 开始每一帧触发的传感器估计开销之和。
+    std::vector<float> frame_costs;
+
+    MSGPACK_DEFINE_ARRAY(fixed_delta_seconds, sensors, first_frame, frame_costs);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -8,6 +8,7 @@
 
 #include "carla/MoveHandler.h"  // 包含处理移动的头文件
 #include "carla/Time.h"         // 包含时间相关的头文件
+#include "carla/profiler/Metrics.h"
 #include "carla/rpc/Metadata.h" // 包含元数据相关的头文件
 #include "carla/rpc/Response.h" // 包含响应相关的头文件
 
@@ -100,6 +101,23 @@ namespace detail {
   template<class T>
   struct FunctionWrapper<T &&> : public FunctionWrapper<T> {};
 
+  /// 每个绑定函数的调用次数与执行时间，由包装函数持有。
+  struct CallMetrics {
+    explicit CallMetrics(const std::string &name)
+      : calls(profiler::MetricsRegistry::Get().GetCounter(
+            "carla_rpc_calls_total",
+            "Number of RPC calls received.",
+            {{"function", name}})),
+        duration(profiler::MetricsRegistry::Get().GetHistogram(
+            "carla_rpc_call_duration_seconds",
+            "Time spent executing RPC calls, excluding queueing.",
+            {{"function", name}})) {}
+
+    const std::shared_ptr<profiler::Counter> calls;
+
+    const std::shared_ptr<profiler::Histogram> duration;
+  };
+
   // 定义函数指针包装器
   template <typename R, typename... Args>
   struct FunctionWrapper<R (*)(Args...)> {
@@ -112,9 +130,14 @@ namespace detail {
     /// io_context的上下文中调用。即，我们可以使用io_context在特定线程（例如
     /// 游戏线程）上运行任务。
     template <typename FuncT>
-    static auto WrapSyncCall(boost::asio::io_context &io, FuncT &&functor) {
-      return [&io, functor=std::forward<FuncT>(functor)](Metadata metadata, Args... args) -> R {
-        auto task = std::packaged_task<R()>([functor=std::move(functor), args...]() {
+    static auto WrapSyncCall(
+        boost::asio::io_context &io,
+        std::shared_ptr<CallMetrics> metrics,
+        FuncT &&functor) {
+      return [&io, metrics, functor=std::forward<FuncT>(functor)](Metadata metadata, Args... args) -> R {
+        metrics->calls->Increment();
+        auto task = std::packaged_task<R()>([metrics, functor=std::move(functor), args...]() {
+          profiler::ScopedHistogramTimer timer(metrics->duration.get());
           return functor(args...); // 调用传入的可调用对象
         });
         if (metadata.IsResponseIgnored()) { // 如果响应被忽略
@@ -134,8 +157,10 @@ namespace detail {
    /// 将@a functor包装为具有等效签名的函数类型，
 /// 处理客户端发送的元数据。如果客户端异步调用此方法，结果将被忽略。
 template <typename FuncT>
-static auto WrapAsyncCall(FuncT &&functor) {
-  return [functor=std::forward<FuncT>(functor)](::carla::rpc::Metadata metadata, Args... args) -> R {
+static auto WrapAsyncCall(std::shared_ptr<CallMetrics> metrics, FuncT &&functor) {
+  return [metrics, functor=std::forward<FuncT>(functor)](::carla::rpc::Metadata metadata, Args... args) -> R {
+    metrics->calls->Increment();
+    profiler::ScopedHistogramTimer timer(metrics->duration.get());
     if (metadata.IsResponseIgnored()) { // 检查响应是否被忽略
       functor(args...); // 调用传入的可调用对象
       return R(); // 返回默认构造的R
@@ -161,7 +186,10 @@ inline void Server::BindSync(const std::string &name, FunctorT &&functor) {
   using Wrapper = detail::FunctionWrapper<FunctorT>; // 使用函数包装器
   _server.bind(
       name,
-      Wrapper::WrapSyncCall(_sync_io_context, std::forward<FunctorT>(functor))); // 绑定同步函数
+      Wrapper::WrapSyncCall(
+          _sync_io_context,
+          std::make_shared<detail::CallMetrics>(name),
+          std::forward<FunctorT>(functor))); // 绑定同步函数
 }
 
 // 绑定一个异步函数
@@ -170,7 +198,9 @@ inline void Server::BindAsync(const std::string &name, FunctorT &&functor) {
   using Wrapper = detail::FunctionWrapper<FunctorT>; // 使用函数包装器
   _server.bind(
       name,
-      Wrapper::WrapAsyncCall(std::forward<FunctorT>(functor))); // 绑定异步函数
+      Wrapper::WrapAsyncCall(
+          std::make_shared<detail::CallMetrics>(name),
+          std::forward<FunctorT>(functor))); // 绑定异步函数
 }
 
 } // namespace rpc
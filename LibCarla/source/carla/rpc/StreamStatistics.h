@@ -0,0 +1,59 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/streaming/detail/SessionQueue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 传感器流在服务器端的发送队列统计信息，汇总了该流的所有客户端会话。
+  class StreamStatistics {
+  public:
+
+    StreamStatistics() = default;
+
+    explicit StreamStatistics(const std::vector<streaming::detail::SessionStatistics> &sessions)
+      : number_of_sessions(static_cast<uint32_t>(sessions.size())) {
+      for (auto &session : sessions) {
+        queue_depth += session.queue_depth;
+        max_queue_depth = std::max<uint64_t>(max_queue_depth, session.max_queue_depth);
+        sent_messages += session.sent_messages;
+        dropped_messages += session.dropped_messages;
+      }
+    }
+
+    /// 订阅该流的客户端会话数量。
+    uint32_t number_of_sessions = 0u;
+
+    /// 所有会话中当前等待发送的消息总数。
+    uint64_t queue_depth = 0u;
+
+    /// 任一会话的队列达到过的最大深度。
+    uint64_t max_queue_depth = 0u;
+
+    /// 所有会话成功发送的消息总数。
+    uint64_t sent_messages = 0u;
+
+    /// 所有会话因队列已满而丢弃的消息总数。
+    uint64_t dropped_messages = 0u;
+
+    MSGPACK_DEFINE_ARRAY(
+        number_of_sessions,
+        queue_depth,
+        max_queue_depth,
+        sent_messages,
+        dropped_messages);
+  };
+
+} // namespace rpc
+} // namespace carla
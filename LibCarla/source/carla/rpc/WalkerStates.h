@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 一批行人的变换和速度，按列存储，第 i 个行人为 actors[i]、transforms[i]、
+  /// speeds[i]。与逐个发送 Command::ApplyWalkerState 的效果相同。
+  struct WalkerStates {
+
+    std::vector<ActorId> actors;
+
+    std::vector<geom::Transform> transforms;
+
+    std::vector<float> speeds;
+
+    void Reserve(const size_t count) {
+      actors.reserve(count);
+      transforms.reserve(count);
+      speeds.reserve(count);
+    }
+
+    void Add(const ActorId actor, const geom::Transform &transform, const float speed) {
+      actors.emplace_back(actor);
+      transforms.emplace_back(transform);
+      speeds.emplace_back(speed);
+    }
+
+    /// 清空各列，保留已分配的内存
+    void clear() {
+      actors.clear();
+      transforms.clear();
+      speeds.clear();
+    }
+
+    size_t size() const {
+      return actors.size();
+    }
+
+    bool empty() const {
+      return actors.empty();
+    }
+
+    MSGPACK_DEFINE_ARRAY(actors, transforms, speeds);
+  };
+
+} // namespace rpc
+} // namespace carla
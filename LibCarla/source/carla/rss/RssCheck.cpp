@@ -46,6 +46,10 @@
 #include "carla/client/Vehicle.h"
 #include "carla/client/Walker.h"
 #include "carla/client/Waypoint.h"
+#include "carla/geom/Math.h"
+#ifndef RSS_USE_TBB
+#include "carla/ParallelFor.h"
+#endif
 
 #define DEBUG_TIMING 0
 // 定义在carla命名空间的rss子命名空间中 
@@ -76,6 +80,23 @@ void printRoute(std::string const &route_descr, ::ad::map::route::FullRoute cons
 // 度到弧度转换常数 PI / 180
 constexpr float to_radians = static_cast<float>(M_PI) / 180.0f;
 
+// 参与者在这个范围内移动时重用上一次的地图匹配结果。阈值足够小，只覆盖静止
+// 或几乎静止的参与者（20 Hz 下约 0.4 m/s），车道匹配不会因此改变
+constexpr float match_object_cache_max_distance = 0.02f;
+constexpr float match_object_cache_max_yaw_deg = 0.2f;
+
+static bool IsSamePose(carla::geom::Transform const &lhs, carla::geom::Transform const &rhs) {
+  if (carla::geom::Math::DistanceSquared(lhs.location, rhs.location) >
+      match_object_cache_max_distance * match_object_cache_max_distance) {
+    return false;
+  }
+  auto yaw_diff = std::fmod(std::fabs(lhs.rotation.yaw - rhs.rotation.yaw), 360.f);
+  if (yaw_diff > 180.f) {
+    yaw_diff = 360.f - yaw_diff;
+  }
+  return yaw_diff <= match_object_cache_max_yaw_deg;
+}
+
 EgoDynamicsOnRoute::EgoDynamicsOnRoute()
   : time_since_epoch_check_start_ms(0.),
     time_since_epoch_check_end_ms(0.),
@@ -377,9 +398,16 @@ bool RssCheck::CheckObjects(carla::client::Timestamp const &timestamp,
               << " before  MapMatching" << std::endl;
 #endif
 
+    // 上一次检查的匹配结果在本次检查中只读，本次的结果重新收集，
+    // 不再出现的参与者随之从缓存中移除
+    _last_match_objects.swap(_match_objects);
+    _match_objects.clear();
+
     //允许车辆距离路线至少 2.0 米，以免丧失
     //与路线的接触
-    auto const ego_match_object = GetMatchObject(carla_ego_actor, ::ad::physics::Distance(2.0));
+    bool ego_match_object_reused = false;
+    auto const ego_match_object =
+        GetMatchObject(carla_ego_actor, ::ad::physics::Distance(2.0), &ego_match_object_reused);
 
     if (::ad::map::point::isValid(_carla_rss_state.ego_match_object.enuPosition.centerPoint, false)) {
       // check for bigger position jumps of the ego vehicle
@@ -403,7 +431,13 @@ bool RssCheck::CheckObjects(carla::client::Timestamp const &timestamp,
               << " after ego MapMatching" << std::endl;
 #endif
 
-    UpdateRoute(_carla_rss_state);
+    if (ego_match_object_reused && _routing_targets_to_append.empty() &&
+        !_carla_rss_state.ego_route.roadSegments.empty()) {
+      // 自车没有移动且没有新的路由目标，上一次的路线仍然有效
+      _logger->trace("Ego vehicle did not move, keeping route");
+    } else {
+      UpdateRoute(_carla_rss_state);
+    }
 
 #if DEBUG_TIMING
     t_end = std::chrono::high_resolution_clock::now();
@@ -469,7 +503,8 @@ bool RssCheck::CheckObjects(carla::client::Timestamp const &timestamp,
 }
 
 ::ad::map::match::Object RssCheck::GetMatchObject(carla::SharedPtr<carla::client::Actor> const &actor,
-                                                  ::ad::physics::Distance const &sampling_distance) const {
+                                                  ::ad::physics::Distance const &sampling_distance,
+                                                  bool *reused) const {
   ::ad::map::match::Object match_object;
 
   auto const vehicle_transform = actor->GetTransform();
@@ -496,9 +531,31 @@ bool RssCheck::CheckObjects(carla::client::Timestamp const &timestamp,
   }
   match_object.enuPosition.enuReferencePoint = ::ad::map::access::getENUReferencePoint();
 
-  ::ad::map::match::AdMapMatching map_matching;
-  match_object.mapMatchedBoundingBox =
-      map_matching.getMapMatchedBoundingBox(match_object.enuPosition, sampling_distance);
+  // 位置与朝向总是使用当前值，只有代价较高的地图匹配可以重用；比较的是计算
+  // 匹配结果时的位姿，缓慢移动的误差不会累积
+  MatchObjectCacheEntry cache_entry;
+  bool cache_hit = false;
+  auto const cached = _last_match_objects.find(actor->GetId());
+  if ((cached != _last_match_objects.end()) && (cached->second.sampling_distance == sampling_distance) &&
+      IsSamePose(cached->second.transform, vehicle_transform)) {
+    cache_entry = cached->second;
+    cache_hit = true;
+  } else {
+    ::ad::map::match::AdMapMatching map_matching;
+    cache_entry.transform = vehicle_transform;
+    cache_entry.sampling_distance = sampling_distance;
+    cache_entry.map_matched_bounding_box =
+        map_matching.getMapMatchedBoundingBox(match_object.enuPosition, sampling_distance);
+  }
+  if (reused != nullptr) {
+    *reused = cache_hit;
+  }
+  match_object.mapMatchedBoundingBox = cache_entry.map_matched_bounding_box;
+
+  {
+    std::lock_guard<std::mutex> lock(_match_objects_mutex);
+    _match_objects[actor->GetId()] = std::move(cache_entry);
+  }
 
   return match_object;
 }
@@ -811,20 +868,30 @@ void RssCheck::UpdateDefaultRssDynamics(CarlaRssState &carla_rss_state) {
     bool found_relevant_traffic_light = false;
     for (const auto &traffic_light : traffic_lights) {
       auto traffic_light_state = traffic_light->GetState();
-      carla::geom::BoundingBox trigger_bounding_box = traffic_light->GetTriggerVolume();
 
-      auto traffic_light_transform = traffic_light->GetTransform();
-      auto trigger_box_location = trigger_bounding_box.location;
-      traffic_light_transform.TransformPoint(trigger_box_location);
-
-      ::ad::map::point::ENUPoint trigger_box_position;
-      trigger_box_position.x = ::ad::map::point::ENUCoordinate(trigger_box_location.x);
-      trigger_box_position.y = ::ad::map::point::ENUCoordinate(-1 * trigger_box_location.y);
-      trigger_box_position.z = ::ad::map::point::ENUCoordinate(0.);
-
-      _logger->trace("traffic light[{}] Position: {}", traffic_light->GetId(), trigger_box_position);
-      auto traffic_light_map_matched_positions = traffic_light_map_matching.getMapMatchedPositions(
-          trigger_box_position, ::ad::physics::Distance(0.25), ::ad::physics::Probability(0.1));
+      // 信号灯不会移动，触发区域只需匹配一次
+      auto cached_positions = _traffic_light_matched_positions.find(traffic_light->GetId());
+      if (cached_positions == _traffic_light_matched_positions.end()) {
+        carla::geom::BoundingBox trigger_bounding_box = traffic_light->GetTriggerVolume();
+
+        auto traffic_light_transform = traffic_light->GetTransform();
+        auto trigger_box_location = trigger_bounding_box.location;
+        traffic_light_transform.TransformPoint(trigger_box_location);
+
+        ::ad::map::point::ENUPoint trigger_box_position;
+        trigger_box_position.x = ::ad::map::point::ENUCoordinate(trigger_box_location.x);
+        trigger_box_position.y = ::ad::map::point::ENUCoordinate(-1 * trigger_box_location.y);
+        trigger_box_position.z = ::ad::map::point::ENUCoordinate(0.);
+
+        _logger->trace("traffic light[{}] Position: {}", traffic_light->GetId(), trigger_box_position);
+        cached_positions = _traffic_light_matched_positions
+                               .emplace(traffic_light->GetId(),
+                                        traffic_light_map_matching.getMapMatchedPositions(
+                                            trigger_box_position, ::ad::physics::Distance(0.25),
+                                            ::ad::physics::Probability(0.1)))
+                               .first;
+      }
+      auto const &traffic_light_map_matched_positions = cached_positions->second;
 
       _logger->trace("traffic light[{}] Map Matched Position: {}", traffic_light->GetId(),
                      traffic_light_map_matched_positions);
@@ -952,10 +1019,12 @@ void RssCheck::CreateWorldModel(carla::client::Timestamp const &timestamp, carla
       other_traffic_participants.begin(), other_traffic_participants.end(),
       RssObjectChecker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights));
 #else
-  for (auto const traffic_participant : other_traffic_participants) {
-    auto checker = RssObjectChecker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights);
-    checker(traffic_participant);
-  }
+  // RssSceneCreation::appendScenes 可以并发调用，每个参与者的地图匹配与场景创建
+  // 互不依赖
+  RssObjectChecker const checker(*this, scene_creation, carla_ego_vehicle, carla_rss_state, green_traffic_lights);
+  carla::ParallelFor(other_traffic_participants.size(), [&](const size_t index) {
+    checker(other_traffic_participants[index]);
+  }, 1u);
 #endif
 
   if (_road_boundaries_mode != RoadBoundariesMode::Off) {
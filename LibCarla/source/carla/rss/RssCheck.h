@@ -7,6 +7,7 @@
 
 #include <spdlog/spdlog.h>
 #include <ad/map/landmark/LandmarkIdSet.hpp>
+#include <ad/map/match/MapMatchedPositionConfidenceList.hpp>
 #include <ad/map/match/Object.hpp>
 #include <ad/map/route/FullRoute.hpp>
 #include <ad/rss/core/RssCheck.hpp>
@@ -17,6 +18,7 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include "carla/client/ActorList.h"
 #include "carla/client/Vehicle.h"
 #include "carla/road/Map.h"
@@ -300,9 +302,32 @@ private:
   /// @brief the current state of the ego vehicle
   CarlaRssState _carla_rss_state;
 
+  /// @brief map matched bounding box of an actor together with the pose it was calculated for
+  struct MatchObjectCacheEntry {
+    carla::geom::Transform transform;
+    ::ad::physics::Distance sampling_distance;
+    ::ad::map::match::MapMatchedObjectBoundingBox map_matched_bounding_box;
+  };
+
+  /// @brief map matching results of the previous check (only read while checking)
+  std::unordered_map<carla::ActorId, MatchObjectCacheEntry> _last_match_objects;
+  /// @brief map matching results of the current check
+  ///
+  /// Actors not present in a check drop out of the cache with the next swap.
+  mutable std::unordered_map<carla::ActorId, MatchObjectCacheEntry> _match_objects;
+  /// @brief protects _match_objects while the other traffic participants are processed in parallel
+  mutable std::mutex _match_objects_mutex;
+  /// @brief map matched trigger volume positions of the traffic lights (traffic lights never move)
+  mutable std::unordered_map<carla::ActorId, ::ad::map::match::MapMatchedPositionConfidenceList>
+      _traffic_light_matched_positions;
+
   /// @brief calculate the map matched object from the actor
+  ///
+  /// The map matched bounding box of the previous check is reused if the actor
+  /// did not move noticeably since it was calculated; @a reused is set accordingly.
   ::ad::map::match::Object GetMatchObject(carla::SharedPtr<carla::client::Actor> const &actor,
-                                          ::ad::physics::Distance const &sampling_distance) const;
+                                          ::ad::physics::Distance const &sampling_distance,
+                                          bool *reused = nullptr) const;
 
   /// @brief calculate the speed from the actor
   ::ad::physics::Speed GetSpeed(carla::client::Actor const &actor) const;
@@ -6,13 +6,77 @@
 
 #include "carla/sensor/Deserializer.h"
 
+#include "carla/Debug.h"
+#include "carla/profiler/TraceProfiler.h"
+
 #include "carla/sensor/SensorRegistry.h"
+#include "carla/sensor/data/CompressedData.h"
+#include "carla/sensor/data/LazyData.h"
+#include "carla/sensor/s11n/Compression.h"
+#include "carla/sensor/s11n/VideoStream.h"
+
+#include <mutex>
 
 namespace carla {
 namespace sensor {
 
+  static std::mutex video_decoder_factory_mutex;
+
+  static Deserializer::VideoDecoderFactory video_decoder_factory;
+
   SharedPtr<SensorData> Deserializer::Deserialize(Buffer &&buffer) {
-    return SensorRegistry::Deserialize(std::move(buffer));
+    CARLA_TRACE_SCOPE(sensor, deserialize);
+    return SensorRegistry::Deserialize(s11n::Compression::Decompress(std::move(buffer)));
+  }
+
+  SharedPtr<SensorData> Deserializer::Deserialize(Buffer &&buffer, bool decompress) {
+    using HeaderSerializer = s11n::SensorHeaderSerializer;
+    if (!decompress &&
+        (buffer.size() >= HeaderSerializer::header_offset) &&
+        (HeaderSerializer::GetCompression(HeaderSerializer::Deserialize(buffer)) != 0u)) {
+      return SharedPtr<SensorData>{new data::CompressedData(std::move(buffer))};
+    }
+    return Deserialize(std::move(buffer));
+  }
+
+  SharedPtr<SensorData> Deserializer::DeserializeLazy(Buffer &&buffer) {
+    DEBUG_ASSERT(buffer.size() >= s11n::SensorHeaderSerializer::header_offset);
+    return SharedPtr<SensorData>{new data::LazyData(std::move(buffer))};
+  }
+
+  bool Deserializer::IsVideoFrame(const Buffer &buffer) {
+    using HeaderSerializer = s11n::SensorHeaderSerializer;
+    return (buffer.size() >= HeaderSerializer::header_offset) &&
+        (static_cast<s11n::CompressionType>(HeaderSerializer::GetCompression(
+            HeaderSerializer::Deserialize(buffer))) == s11n::CompressionType::Video);
+  }
+
+  std::unique_ptr<s11n::VideoDecoder> Deserializer::MakeVideoDecoder() {
+    std::lock_guard<std::mutex> lock(video_decoder_factory_mutex);
+    if (video_decoder_factory) {
+      return video_decoder_factory();
+    }
+    return std::make_unique<s11n::DeltaVideoDecoder>();
+  }
+
+  void Deserializer::SetVideoDecoderFactory(VideoDecoderFactory factory) {
+    std::lock_guard<std::mutex> lock(video_decoder_factory_mutex);
+    video_decoder_factory = std::move(factory);
+  }
+
+  SharedPtr<SensorData> data::CompressedData::Decompress() const {
+    auto data = Deserializer::Deserialize(Buffer(_message.data(), _message.size()));
+    data->_episode = GetEpisode();
+    return data;
+  }
+
+  SharedPtr<SensorData> data::LazyData::Get() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_data == nullptr) {
+      _data = Deserializer::Deserialize(std::move(_message));
+      _data->_episode = GetEpisode();
+    }
+    return _data;
   }
 
 } // namespace sensor
@@ -9,11 +9,20 @@
 #include "carla/Buffer.h"
 #include "carla/Memory.h"
 
+#include <functional>
+#include <memory>
+
 namespace carla {
 namespace sensor {
 
   class SensorData;
 
+namespace s11n {
+
+  class VideoDecoder;
+
+} // namespace s11n
+
   /// Deserializes a Buffer containing data generated by a sensor and creates
   /// the appropriate SensorData class that contains the sensor's measurement.
   ///
@@ -22,7 +31,31 @@ namespace sensor {
   class Deserializer {
   public:
 
+    /// Compressed buffers are decompressed before being deserialized.
     static SharedPtr<SensorData> Deserialize(Buffer &&buffer);
+
+    /// If @a decompress is false, compressed buffers are returned as a
+    /// data::CompressedData without decompressing them.
+    static SharedPtr<SensorData> Deserialize(Buffer &&buffer, bool decompress);
+
+    /// Decodes only the header and returns a data::LazyData, the payload is
+    /// decompressed and deserialized on first access.
+    static SharedPtr<SensorData> DeserializeLazy(Buffer &&buffer);
+
+    /// Whether @a buffer is a frame of a video stream, which has to be decoded
+    /// in order by the decoder of its stream before being deserialized.
+    static bool IsVideoFrame(const Buffer &buffer);
+
+    using VideoDecoderFactory = std::function<std::unique_ptr<s11n::VideoDecoder>()>;
+
+    /// Makes a decoder for a video stream, one per subscription. By default
+    /// the built-in s11n::DeltaVideoDecoder.
+    static std::unique_ptr<s11n::VideoDecoder> MakeVideoDecoder();
+
+    /// Replaces the decoder made by MakeVideoDecoder, e.g. with one that
+    /// uses a hardware decoder. Affects the sensors subscribed afterwards, an
+    /// empty @a factory restores the built-in decoder.
+    static void SetVideoDecoderFactory(VideoDecoderFactory factory);
   };
 
 } // namespace sensor
@@ -30,7 +30,12 @@ namespace sensor { // sensor命名空间
 
     /// 生成数据的传感器的类型ID。
     uint64_t GetSensorTypeId() const {
-     return GetHeader().sensor_type; // 返回传感器类型ID
+     return HeaderSerializer::GetSensorTypeId(GetHeader()); // 返回传感器类型ID（不含压缩标志）
+    }
+
+    /// 负载的格式，图像见 s11n::ImageFormat
+    uint8_t GetPayloadFormat() const {
+     return HeaderSerializer::GetPayloadFormat(GetHeader());
     }
 
     /// 生成数据时的帧计数。
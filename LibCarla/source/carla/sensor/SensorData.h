@@ -16,6 +16,8 @@
 namespace carla {  // carla 命名空间
 namespace sensor {  // sensor 命名空间
 
+namespace data { class CompressedData; class LazyData; }
+
   /// 所有传感器生成数据的对象的基类
   class SensorData
     : public EnableSharedFromThis<SensorData>,  // 允许共享指针
@@ -62,6 +64,8 @@ namespace sensor {  // sensor 命名空间
 
     /// @todo 这个不应该暴露在这个命名空间中。
     friend class client::detail::Simulator;  // 声明 Simulator 类为友元
+    friend class data::CompressedData;  // 解压后的数据沿用原数据的剧集
+    friend class data::LazyData;  // 反序列化后的数据沿用原数据的剧集
     client::detail::WeakEpisodeProxy _episode;  // 剧集的弱引用代理
 
     const size_t _frame;  // 帧数
@@ -22,6 +22,7 @@
 #include "carla/sensor/s11n/NormalsImageSerializer.h"
 #include "carla/sensor/s11n/OpticalFlowImageSerializer.h"
 #include "carla/sensor/s11n/IMUSerializer.h"
+#include "carla/sensor/s11n/LaneInvasionEventSerializer.h"
 #include "carla/sensor/s11n/LidarSerializer.h"
 #include "carla/sensor/s11n/NoopSerializer.h"
 #include "carla/sensor/s11n/ObstacleDetectionEventSerializer.h"
@@ -29,7 +30,9 @@
 #include "carla/sensor/s11n/SemanticLidarSerializer.h"
 #include "carla/sensor/s11n/GBufferUint8Serializer.h"
 #include "carla/sensor/s11n/GBufferFloatSerializer.h"
+#include "carla/sensor/s11n/TelemetrySerializer.h"
 #include "carla/sensor/s11n/V2XSerializer.h"
+#include "carla/sensor/s11n/WalkerPoseSerializer.h"
 
 // 2. Add a forward-declaration of the sensor here.	// 对各种传感器类进行前置声明，告知编译器这些类在后续会被定义，避免编译时找不到类型定义的错误
 class ACollisionSensor;	
@@ -53,6 +56,8 @@ struct FCameraGBufferUint8;
 struct FCameraGBufferFloat;
 class AV2XSensor;
 class ACustomV2XSensor;
+class AWalkerPoseSensor;
+class AVehicleTelemetrySensor;
 
 namespace carla {
 namespace sensor {
@@ -71,7 +76,7 @@ namespace sensor {
     std::pair<ADVSCamera *, s11n::DVSEventArraySerializer>,
     std::pair<AGnssSensor *, s11n::GnssSerializer>,
     std::pair<AInertialMeasurementUnit *, s11n::IMUSerializer>,
-    std::pair<ALaneInvasionSensor *, s11n::NoopSerializer>,
+    std::pair<ALaneInvasionSensor *, s11n::LaneInvasionEventSerializer>,
     std::pair<AObstacleDetectionSensor *, s11n::ObstacleDetectionEventSerializer>,
     std::pair<AOpticalFlowCamera *, s11n::OpticalFlowImageSerializer>,
     std::pair<ARadar *, s11n::RadarSerializer>,
@@ -85,7 +90,9 @@ namespace sensor {
     std::pair<FCameraGBufferUint8 *, s11n::GBufferUint8Serializer>,
     std::pair<FCameraGBufferFloat *, s11n::GBufferFloatSerializer>,
     std::pair<AV2XSensor *, s11n::CAMDataSerializer>,
-    std::pair<ACustomV2XSensor *, s11n::CustomV2XDataSerializer>
+    std::pair<ACustomV2XSensor *, s11n::CustomV2XDataSerializer>,
+    std::pair<AWalkerPoseSensor *, s11n::WalkerPoseSerializer>,
+    std::pair<AVehicleTelemetrySensor *, s11n::TelemetrySerializer>
     
 
   >;
@@ -117,5 +124,7 @@ namespace sensor {
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Sensor/V2XSensor.h"
 #include "Carla/Sensor/CustomV2XSensor.h"
+#include "Carla/Sensor/WalkerPoseSensor.h"
+#include "Carla/Sensor/VehicleTelemetrySensor.h"
 
 #endif // LIBCARLA_SENSOR_REGISTRY_WITH_SENSOR_INCLUDES
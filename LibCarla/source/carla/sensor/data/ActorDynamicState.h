@@ -11,6 +11,7 @@
 #include "carla/rpc/ActorId.h"
 #include "carla/rpc/ActorState.h"
 #include "carla/rpc/VehicleFailureState.h"
+#include "carla/rpc/VehicleLightState.h"
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleControl.h"
 #include "carla/rpc/WalkerControl.h"
@@ -65,6 +66,8 @@ namespace detail { // 定义命名空间 detail
     bool has_traffic_light; // 是否有交通灯
     rpc::ActorId traffic_light_id; // 交通灯 ID
     rpc::VehicleFailureState failure_state; // 车辆故障状态
+    /// 车灯状态，占用联合体中原本未使用的字节，旧版本的服务器发送 0
+    rpc::VehicleLightState::flag_type light_state;
   };
 #pragma pack(pop) // 恢复对齐方式
 
@@ -143,6 +146,8 @@ namespace detail { // 定义命名空间 detail
 
 #pragma pack(pop) // 恢复对齐方式
 
+  using ActorDynamicState = ParticipantDynamicState;
+
  static_assert(
     sizeof(ParticipantDynamicState) == 119u, // 确保 ParticipantDynamicState 的大小为 119 字节
     "Invalid ParticipantDynamicState size! "
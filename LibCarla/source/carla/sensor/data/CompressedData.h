@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/sensor/SensorData.h"
+#include "carla/sensor/s11n/Compression.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+#include <string>
+
+namespace carla {
+namespace sensor {
+
+  class Deserializer;
+
+namespace data {
+
+  /// 尚未解压的传感器数据。只在以不解压的方式订阅传感器时产生，
+  /// 便于直接保存或转发压缩后的数据，需要时再调用 Decompress。
+  class CompressedData : public SensorData {
+    using Super = SensorData;
+    using HeaderSerializer = s11n::SensorHeaderSerializer;
+
+    friend Deserializer;
+
+    explicit CompressedData(Buffer &&message)
+      : Super(
+            HeaderSerializer::Deserialize(message).frame,
+            HeaderSerializer::Deserialize(message).timestamp,
+            HeaderSerializer::Deserialize(message).sensor_transform),
+        _message(std::move(message)) {}
+
+  public:
+
+    using value_type = unsigned char;
+
+    /// 生成数据的传感器的类型 ID。
+    uint64_t GetSensorTypeId() const {
+      return HeaderSerializer::GetSensorTypeId(HeaderSerializer::Deserialize(_message));
+    }
+
+    s11n::CompressionType GetCompression() const {
+      return static_cast<s11n::CompressionType>(
+          HeaderSerializer::GetCompression(HeaderSerializer::Deserialize(_message)));
+    }
+
+    std::string GetCompressionName() const {
+      return s11n::Compression::ToString(GetCompression());
+    }
+
+    /// 解压后负载的大小（字节）。
+    uint32_t GetUncompressedSize() const {
+      return s11n::Compression::GetUncompressedSize(_message);
+    }
+
+    /// 包括数据头在内的完整消息，可以原样保存后再交给 Deserializer。
+    const Buffer &GetMessage() const {
+      return _message;
+    }
+
+    /// 压缩后的负载（不含数据头）。
+    value_type *data() {
+      return _message.data() + HeaderSerializer::header_offset;
+    }
+
+    const value_type *data() const {
+      return _message.data() + HeaderSerializer::header_offset;
+    }
+
+    size_t size() const {
+      return _message.size() - HeaderSerializer::header_offset;
+    }
+
+    /// 解压并反序列化为该传感器对应的数据类型。
+    SharedPtr<SensorData> Decompress() const;
+
+  private:
+
+    Buffer _message;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
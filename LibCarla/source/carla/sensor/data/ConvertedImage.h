@@ -0,0 +1,133 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/ImageConversion.h"
+#include "carla/sensor/s11n/ImageSerializer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 在服务器端转换为 BGRA8 以外格式（深度或语义标签）的相机图像，每个像素
+  /// 占 GetBytesPerPixel() 个字节，按行存放。
+  class ConvertedImage : public Array<unsigned char> {
+    using Super = Array<unsigned char>;
+  protected:
+
+    using Serializer = s11n::ImageSerializer;
+
+    friend Serializer;
+
+    explicit ConvertedImage(RawData &&data)
+      : Super(Serializer::header_offset, std::move(data)) {
+      DEBUG_ASSERT(GetWidth() * GetHeight() * GetBytesPerPixel() == Super::size());
+    }
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    uint32_t GetWidth() const {
+      return GetHeader().width;
+    }
+
+    uint32_t GetHeight() const {
+      return GetHeader().height;
+    }
+
+    float GetFOVAngle() const {
+      return GetHeader().fov_angle;
+    }
+
+    s11n::ImageFormat GetFormat() const {
+      return static_cast<s11n::ImageFormat>(Super::GetRawData().GetPayloadFormat());
+    }
+
+    std::string GetFormatName() const {
+      return s11n::ImageConversion::ToString(GetFormat());
+    }
+
+    uint32_t GetBytesPerPixel() const {
+      return s11n::ImageConversion::GetBytesPerPixel(GetFormat());
+    }
+
+    /// 像素的个数。
+    size_t GetPixelCount() const {
+      return static_cast<size_t>(GetWidth()) * GetHeight();
+    }
+
+    /// 第 @a index 个像素的深度（米）。
+    ///
+    /// @throw std::logic_error 如果图像不是深度格式。
+    float GetDepth(size_t index) const {
+      CheckIndex(index);
+      switch (GetFormat()) {
+        case s11n::ImageFormat::Depth16F: {
+          uint16_t half;
+          std::memcpy(&half, Super::data() + 2u * index, sizeof(half));
+          return HalfToFloat(half);
+        }
+        case s11n::ImageFormat::Depth32F: {
+          float value;
+          std::memcpy(&value, Super::data() + 4u * index, sizeof(value));
+          return value;
+        }
+        default:
+          throw_exception(std::logic_error("image does not contain depth"));
+      }
+    }
+
+    /// 第 @a index 个像素的语义标签。
+    ///
+    /// @throw std::logic_error 如果图像不是标签格式。
+    uint8_t GetLabel(size_t index) const {
+      CheckIndex(index);
+      if (GetFormat() != s11n::ImageFormat::Label8) {
+        throw_exception(std::logic_error("image does not contain labels"));
+      }
+      return Super::data()[index];
+    }
+
+    /// IEEE 754 半精度浮点数转换为单精度浮点数。
+    static float HalfToFloat(uint16_t half) {
+      const float sign = (half & 0x8000u) ? -1.0f : 1.0f;
+      const int exponent = (half >> 10u) & 0x1Fu;
+      const int mantissa = half & 0x3FFu;
+      if (exponent == 0) {
+        return sign * std::ldexp(static_cast<float>(mantissa), -24);
+      }
+      if (exponent == 31) {
+        return mantissa == 0 ? sign * INFINITY : NAN;
+      }
+      return sign * std::ldexp(static_cast<float>(mantissa + 1024), exponent - 25);
+    }
+
+  private:
+
+    void CheckIndex(size_t index) const {
+      if (!(index < GetPixelCount())) {
+        throw_exception(std::out_of_range("image index out of range"));
+      }
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
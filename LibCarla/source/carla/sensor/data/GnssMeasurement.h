@@ -12,6 +12,8 @@
 // 引入Carla项目中传感器序列化相关的GnssSerializer头文件，用于对GNSS测量数据进行序列化和反序列化操作，方便数据的存储、传输以及恢复等处理
 #include "carla/sensor/s11n/GnssSerializer.h"
 
+#include <vector>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -34,12 +36,20 @@ namespace data {
       : Super(data){
 
       // 通过调用Serializer类的DeserializeRawData方法，从传入的原始数据中反序列化出地理位置相关的数据，将其赋值给_geo_location成员变量，以此初始化该GNSS测量对象所对应的地理位置信息
-      geom::GeoLocation gnss_data = Serializer::DeserializeRawData(data);
-      _geo_location = gnss_data;
-
+      auto gnss_data = Serializer::DeserializeRawData(data);
+      _geo_location = geom::GeoLocation{gnss_data.latitude, gnss_data.longitude, gnss_data.altitude};
+      // 每次节拍只有一个采样时，采样列表只包含测量本身
+      if (gnss_data.samples.empty()) {
+        _samples.push_back(Sample{0.0f, _geo_location});
+      } else {
+        _samples = std::move(gnss_data.samples);
+      }
     }
 
   public:
+
+    using Sample = Serializer::Sample;
+
     // 获取该GNSS测量对应的地理位置信息，返回一个geom::GeoLocation类型的对象，外部代码可以通过调用此方法获取完整的地理位置详情，用于后续诸如地图定位、路径规划等相关操作
     geom::GeoLocation GetGeoLocation() const {
       return _geo_location;
@@ -60,10 +70,18 @@ namespace data {
       return _geo_location.altitude;
     }
 
+    // 获取两次节拍之间的所有采样（按时间排序，最后一个即测量本身），传感器的
+    // samples_per_tick 属性大于 1 时使用
+    const std::vector<Sample> &GetSamples() const {
+      return _samples;
+    }
+
   private:
     // 用于存储该GNSS测量所对应的地理位置信息，是一个geom::GeoLocation类型的对象，包含了经度、纬度和海拔等详细的地理位置属性，这些属性通过构造函数从原始数据中反序列化得到并保存
     geom::GeoLocation _geo_location;
 
+    std::vector<Sample> _samples;
+
   };
 
 } // namespace data
@@ -13,6 +13,8 @@
 // 引入Carla项目中传感器数据相关的SensorData头文件，IMUMeasurement类继承自SensorData类，意味着它能复用SensorData类已有的通用属性和行为，在此基础上拓展针对IMU测量数据的特定功能
 #include "carla/sensor/SensorData.h"
 
+#include <vector>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -32,15 +34,24 @@ namespace data {
     // 显式定义的构造函数，接收一个RawData类型的常量引用参数（表示原始数据），用于从传入的原始数据中初始化IMUMeasurement对象的各项属性，创建一个有效的IMU测量数据对象
     explicit IMUMeasurement(const RawData &data)
       // 首先调用父类（SensorData）的构造函数，传递原始数据data，完成父类部分的初始化，确保继承体系下的初始化顺序正确，继承父类的相关属性和行为
-      : Super(data),
-        // 通过调用Serializer类的DeserializeRawData方法，从原始数据中反序列化出加速度计相关的数据，并使用其初始化_accelerometer成员变量，该变量用于存储IMU测量得到的加速度信息，以三维向量形式表示其在空间中的方向和大小
-        _accelerometer(Serializer::DeserializeRawData(data).accelerometer),
-        // 同样借助Serializer类的DeserializeRawData方法，从原始数据中反序列化出陀螺仪相关的数据，以此初始化_gyroscope成员变量，该变量用于存储IMU测量得到的角速度信息，同样以三维向量形式呈现其在不同方向上的旋转速度情况
-        _gyroscope(Serializer::DeserializeRawData(data).gyroscope),
-        // 还是调用Serializer类的DeserializeRawData方法，从原始数据中反序列化出罗盘（指南针）相关的数据，用来初始化_compass成员变量，该变量存储的是罗盘测量得到的方向信息，以浮点数形式表示（可能是角度等相关表示形式，具体取决于项目内的定义）
-        _compass(Serializer::DeserializeRawData(data).compass) {}
+      : Super(data) {
+      // 只反序列化一次，再从中取出加速度计、陀螺仪和罗盘的数据
+      auto imu_data = Serializer::DeserializeRawData(data);
+      _accelerometer = imu_data.accelerometer;
+      _gyroscope = imu_data.gyroscope;
+      _compass = imu_data.compass;
+      // 每次节拍只有一个采样时，采样列表只包含测量本身
+      if (imu_data.samples.empty()) {
+        _samples.push_back(Sample{0.0f, _accelerometer, _gyroscope, _compass});
+      } else {
+        _samples = std::move(imu_data.samples);
+      }
+    }
 
   public:
+
+    using Sample = Serializer::Sample;
+
     // 获取加速度计测量得到的加速度信息，返回一个geom::Vector3D类型的三维向量，外部代码可以通过调用此方法获取IMU中加速度计所测得的加速度大小和方向，用于后续如物体运动分析、姿态估计等相关操作
     geom::Vector3D GetAccelerometer() const {
       return _accelerometer;
@@ -56,6 +67,12 @@ namespace data {
       return _compass;
     }
 
+    // 获取两次节拍之间的所有采样（按时间排序，最后一个即测量本身），传感器的
+    // samples_per_tick 属性大于 1 时用于获得高于模拟频率的 IMU 数据
+    const std::vector<Sample> &GetSamples() const {
+      return _samples;
+    }
+
   private:
     // 用于存储加速度计测量得到的加速度信息，是一个geom::Vector3D类型的三维向量，其值通过构造函数从原始数据中反序列化获取，在后续的使用中保持不变，供外部通过相应的访问函数来获取该数据
     geom::Vector3D _accelerometer;
@@ -64,6 +81,8 @@ namespace data {
     // 用于存储罗盘测量得到的方向信息，以浮点数类型表示，其具体数值由构造函数从原始数据中解析而来，用于提供物体朝向等相关的方向参考，可通过访问函数对外提供该数据
     float _compass;
 
+    std::vector<Sample> _samples;
+
   };
 
 } // namespace data
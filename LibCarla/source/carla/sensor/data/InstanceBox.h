@@ -0,0 +1,47 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+#pragma pack(push, 1)
+  /// 实例分割图像中一个实例的真值：可见像素数、可见部分的二维包围盒和遮挡率。
+  /// 包围盒的坐标为像素，包含 x_min 到 x_max、y_min 到 y_max 两端。
+  struct InstanceBox {
+    /// 实例所属的 actor 的 id，不是 actor（例如地图中的静态物体）时为 0。
+    uint32_t actor_id = 0u;
+    /// 实例在图像中的编码（绿色通道为低字节，蓝色通道为高字节）。
+    uint16_t instance_id = 0u;
+    /// 语义标签（红色通道），实例包含多个标签时取最大值。
+    uint8_t semantic_tag = 0u;
+    uint8_t padding = 0u;
+    /// 可见的像素数。
+    uint32_t pixel_count = 0u;
+    uint16_t x_min = 0u;
+    uint16_t y_min = 0u;
+    uint16_t x_max = 0u;
+    uint16_t y_max = 0u;
+    /// 遮挡率的估计，[0, 1]：1 减去可见包围盒与 actor 三维包围盒投影（裁剪到
+    /// 图像内）的面积之比。无法估计时（不是 actor 或 actor 在相机后方）为 -1。
+    float occlusion = -1.0f;
+
+    /// 可见包围盒的面积，单位为像素。
+    uint32_t GetBoxArea() const {
+      return (static_cast<uint32_t>(x_max) - x_min + 1u) * (static_cast<uint32_t>(y_max) - y_min + 1u);
+    }
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(InstanceBox) == 24u, "Invalid InstanceBox size");
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
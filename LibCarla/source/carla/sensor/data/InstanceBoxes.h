@@ -0,0 +1,56 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/data/InstanceBox.h"
+#include "carla/sensor/s11n/ImageSerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 实例分割相机在服务器端（GPU 上）从实例图像归约得到的每个实例的真值，
+  /// 代替整幅图像发送，按 instance_id 排序。数据头与图像相同。
+  class InstanceBoxes : public Array<InstanceBox> {
+    using Super = Array<InstanceBox>;
+  protected:
+
+    using Serializer = s11n::ImageSerializer;
+
+    friend Serializer;
+
+    explicit InstanceBoxes(RawData &&data)
+      : Super(Serializer::header_offset, std::move(data)) {}
+
+  private:
+
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+  public:
+
+    /// 图像的宽度，单位为像素。
+    uint32_t GetWidth() const {
+      return GetHeader().width;
+    }
+
+    /// 图像的高度，单位为像素。
+    uint32_t GetHeight() const {
+      return GetHeader().height;
+    }
+
+    /// 水平视场角，单位为度。
+    float GetFOVAngle() const {
+      return GetHeader().fov_angle;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -11,6 +11,7 @@
 #include "carla/client/Actor.h"
 #include "carla/road/element/LaneMarking.h" // 包含车道标记类的定义
 #include "carla/rpc/ActorId.h"
+#include "carla/sensor/s11n/LaneInvasionEventSerializer.h"
 
 #include <vector> // 包含标准模板库中的向量容器
 
@@ -20,6 +21,18 @@ namespace data {
 
   // 定义一个车道变更事件类
   class LaneInvasionEvent : public SensorData {
+    using Serializer = s11n::LaneInvasionEventSerializer;
+    friend Serializer;
+
+    // 由服务器端传感器发送的事件
+    explicit LaneInvasionEvent(const RawData &data)
+      : LaneInvasionEvent(data, Serializer::DeserializeRawData(data)) {}
+
+    LaneInvasionEvent(const RawData &data, const Serializer::Data &event)
+      : SensorData(data),
+        _parent(event.parent),
+        _crossed_lane_markings(Serializer::ToLaneMarkings(event)) {}
+
   public:
 
     using LaneMarking = road::element::LaneMarking; // 定义一个类型别名，方便使用
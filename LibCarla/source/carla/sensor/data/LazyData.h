@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/sensor/SensorData.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+#include <mutex>
+
+namespace carla {
+namespace sensor {
+
+  class Deserializer;
+
+namespace data {
+
+  /// 只解析了数据头的传感器数据，负载在第一次调用 Get 时才解压并反序列化。
+  /// 只需要帧号或时间戳，或者大部分数据被丢弃时，可以省去反序列化的开销。
+  class LazyData : public SensorData {
+    using Super = SensorData;
+    using HeaderSerializer = s11n::SensorHeaderSerializer;
+
+    friend Deserializer;
+
+    explicit LazyData(Buffer &&message)
+      : Super(
+            HeaderSerializer::Deserialize(message).frame,
+            HeaderSerializer::Deserialize(message).timestamp,
+            HeaderSerializer::Deserialize(message).sensor_transform),
+        _sensor_type_id(HeaderSerializer::GetSensorTypeId(HeaderSerializer::Deserialize(message))),
+        _size(message.size() - HeaderSerializer::header_offset),
+        _message(std::move(message)) {}
+
+  public:
+
+    /// 生成数据的传感器的类型 ID。
+    uint64_t GetSensorTypeId() const {
+      return _sensor_type_id;
+    }
+
+    /// 负载的大小（字节），压缩的数据为压缩后的大小。
+    size_t size() const {
+      return _size;
+    }
+
+    bool IsMaterialized() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _data != nullptr;
+    }
+
+    /// 反序列化为该传感器对应的数据类型。只在第一次调用时反序列化，之后返回
+    /// 同一个对象；可以在多个线程中同时调用。
+    SharedPtr<SensorData> Get() const;
+
+  private:
+
+    const uint64_t _sensor_type_id;
+
+    const size_t _size;
+
+    mutable std::mutex _mutex;
+
+    /// 反序列化后移入 _data。
+    mutable Buffer _message;
+
+    mutable SharedPtr<SensorData> _data;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,94 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/LidarSerializer.h"
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// Measurement produced by a Lidar with the points in columns
+  /// (LidarPointLayout::SoA): X, Y, Z and intensity as floats, followed by the
+  /// semantic tag of each point as uint8. The bytes of the array are the raw
+  /// columns.
+  class LidarColumns : public Array<unsigned char> {
+    using Super = Array<unsigned char>;
+  protected:
+
+    using Serializer = s11n::LidarSerializer;
+
+    friend Serializer;
+
+    explicit LidarColumns(RawData &&data)
+      : Super(std::move(data), [](const RawData &d) {
+      return Serializer::GetHeaderOffset(d);
+    }) {
+      DEBUG_ASSERT(Super::size() == Serializer::column_point_size * GetTotalPointCount());
+    }
+
+  private:
+
+    auto GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+    const float *GetColumn(size_t index) const {
+      return reinterpret_cast<const float *>(Super::data()) + index * GetTotalPointCount();
+    }
+
+  public:
+
+    /// Horizontal angle of the Lidar at the time of the measurement.
+    auto GetHorizontalAngle() const {
+      return GetHeader().GetHorizontalAngle();
+    }
+
+    /// Number of channels of the Lidar.
+    auto GetChannelCount() const {
+      return GetHeader().GetChannelCount();
+    }
+
+    /// Retrieve the number of points that @a channel generated. Points are
+    /// sorted by channel, so this method allows to identify the channel that
+    /// generated each point.
+    auto GetPointCount(size_t channel) const {
+      return GetHeader().GetPointCount(channel);
+    }
+
+    /// Number of points of all the channels.
+    size_t GetTotalPointCount() const {
+      return Super::size() / Serializer::column_point_size;
+    }
+
+    const float *GetX() const {
+      return GetColumn(0u);
+    }
+
+    const float *GetY() const {
+      return GetColumn(1u);
+    }
+
+    const float *GetZ() const {
+      return GetColumn(2u);
+    }
+
+    const float *GetIntensity() const {
+      return GetColumn(3u);
+    }
+
+    /// Semantic tag of each point, see carla::rpc::CityObjectLabel.
+    const uint8_t *GetTags() const {
+      return reinterpret_cast<const uint8_t *>(GetColumn(4u));
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include "carla/NpyIO.h"
 #include "carla/rpc/Location.h"
 #include "carla/sensor/data/SemanticLidarData.h"
 
+#include <cmath>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace carla {
@@ -48,6 +51,26 @@ namespace data {
   ///      Xn, Yn, Zn, In
   ///    }
   ///
+  /// or, with LidarPointLayout::SoA, in columns followed by the semantic tag of
+  /// each point
+  ///
+  ///    {
+  ///      X0, ..., Xn,
+  ///      Y0, ..., Yn,
+  ///      Z0, ..., Zn,
+  ///      I0, ..., In,
+  ///      Tag0, ..., Tagn (uint8)
+  ///    }
+  ///
+
+  /// Layout of the points of a Lidar measurement, flagged in the payload
+  /// format of the sensor header.
+  enum class LidarPointLayout : uint8_t {
+    /// Array of {X, Y, Z, I}, deserialized as LidarMeasurement.
+    AoS = 0u,
+    /// Columns of X, Y, Z, I and tags, deserialized as LidarColumns.
+    SoA = 1u
+  };
 
   class LidarDetection {
     public:
@@ -68,9 +91,22 @@ namespace data {
           "property float32 I";
       }
 
+      void WritePcdHeaderInfo(std::ostream& out) const{
+        out << "FIELDS x y z intensity\n" \
+          "SIZE 4 4 4 4\n" \
+          "TYPE F F F F\n" \
+          "COUNT 1 1 1 1";
+      }
+
       void WriteDetection(std::ostream& out) const{
         out << point.x << ' ' << point.y << ' ' << point.z << ' ' << intensity;
       }
+
+      /// Fields of the detection as a numpy structured type, in memory order.
+      static std::string GetNpyDescription() {
+        const auto f4 = NpyIO::GetTypeDescription<float>();
+        return "[('x', " + f4 + "), ('y', " + f4 + "), ('z', " + f4 + "), ('intensity', " + f4 + ")]";
+      }
   };
 
   class LidarData : public SemanticLidarData{
@@ -85,7 +121,7 @@ namespace data {
     ~LidarData() = default;
 
     virtual void ResetMemory(std::vector<uint32_t> points_per_channel) {
-      DEBUG_ASSERT(GetChannelCount() > points_per_channel.size());
+      DEBUG_ASSERT(GetChannelCount() == points_per_channel.size());
       std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
 
       uint32_t total_points = static_cast<uint32_t>(
@@ -93,6 +129,10 @@ namespace data {
 
       _points.clear();
       _points.reserve(total_points * 4);
+      _tags.clear();
+      if (_layout == LidarPointLayout::SoA) {
+        _tags.reserve(total_points);
+      }
     }
 
     void WritePointSync(LidarDetection &detection) {
@@ -102,14 +142,108 @@ namespace data {
       _points.emplace_back(detection.intensity);
     }
 
+    /// Write a point and its semantic tag, the tags are only serialized with
+    /// LidarPointLayout::SoA.
+    void WritePointSync(LidarDetection &detection, uint8_t tag) {
+      WritePointSync(detection);
+      _tags.emplace_back(tag);
+    }
+
+    LidarPointLayout GetLayout() const {
+      return _layout;
+    }
+
+    void SetLayout(LidarPointLayout layout) {
+      _layout = layout;
+    }
+
+    /// Number of points written since the last ResetMemory.
+    size_t GetPointCount() const {
+      return _points.size() / 4u;
+    }
+
+    /// Replace the points that fall in the same cube of @a voxel_size meters by
+    /// their centroid, with the mean intensity and the tag of the first point.
+    /// A merged point counts towards the channel of the first point of its
+    /// voxel, so the points stay grouped by channel. Call after
+    /// WriteChannelCount.
+    void DownsampleVoxelGrid(float voxel_size) {
+      if (!(voxel_size > 0.0f) || _points.empty()) {
+        return;
+      }
+      struct Voxel {
+        float x, y, z, intensity;
+        uint32_t count;
+        size_t first;
+      };
+      const bool has_tags = _tags.size() == GetPointCount();
+      const float scale = 1.0f / voxel_size;
+      std::unordered_map<uint64_t, uint32_t> indices;
+      indices.reserve(GetPointCount());
+      std::vector<Voxel> voxels;
+      std::vector<uint32_t> voxels_per_channel(GetChannelCount(), 0u);
+
+      size_t point = 0u;
+      for (uint32_t channel = 0u; channel < GetChannelCount(); ++channel) {
+        const uint32_t count = _header[Index::SIZE + channel];
+        for (uint32_t i = 0u; i < count && point < GetPointCount(); ++i, ++point) {
+          const float *p = &_points[4u * point];
+          const uint64_t key = GetVoxelKey(p[0] * scale, p[1] * scale, p[2] * scale);
+          auto result = indices.emplace(key, static_cast<uint32_t>(voxels.size()));
+          if (result.second) {
+            voxels.push_back(Voxel{0.0f, 0.0f, 0.0f, 0.0f, 0u, point});
+            ++voxels_per_channel[channel];
+          }
+          Voxel &voxel = voxels[result.first->second];
+          voxel.x += p[0];
+          voxel.y += p[1];
+          voxel.z += p[2];
+          voxel.intensity += p[3];
+          ++voxel.count;
+        }
+      }
+
+      std::vector<float> points;
+      points.reserve(4u * voxels.size());
+      std::vector<uint8_t> tags;
+      tags.reserve(has_tags ? voxels.size() : 0u);
+      for (const Voxel &voxel : voxels) {
+        const float inverse_count = 1.0f / static_cast<float>(voxel.count);
+        points.emplace_back(voxel.x * inverse_count);
+        points.emplace_back(voxel.y * inverse_count);
+        points.emplace_back(voxel.z * inverse_count);
+        points.emplace_back(voxel.intensity * inverse_count);
+        if (has_tags) {
+          tags.emplace_back(_tags[voxel.first]);
+        }
+      }
+      _points.swap(points);
+      _tags.swap(tags);
+      WriteChannelCount(voxels_per_channel);
+    }
+
     virtual void WritePointSync(SemanticLidarDetection &detection) {
       (void) detection;
       DEBUG_ASSERT(false);
     }
 
   private:
+    /// 21 bits per axis, enough for +-10 km with voxels of 1 cm.
+    static uint64_t GetVoxelKey(float x, float y, float z) {
+      constexpr int64_t bias = int64_t(1) << 20;
+      constexpr uint64_t mask = (uint64_t(1) << 21) - 1u;
+      const auto cell = [&](float value) {
+        return static_cast<uint64_t>(static_cast<int64_t>(std::floor(value)) + bias) & mask;
+      };
+      return cell(x) | (cell(y) << 21) | (cell(z) << 42);
+    }
+
     std::vector<float> _points;
 
+    std::vector<uint8_t> _tags;
+
+    LidarPointLayout _layout = LidarPointLayout::AoS;
+
     friend class s11n::LidarSerializer;
     friend class s11n::LidarHeaderView;
     friend class carla::ros2::ROS2;
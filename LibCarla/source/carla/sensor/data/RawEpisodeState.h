@@ -11,6 +11,9 @@
 #include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
+#include <cstring>
+#include <vector>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -25,7 +28,7 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData &&data)
-      : Super(Serializer::header_offset, std::move(data)) {}
+      : Super(std::move(data), [](const RawData &d) { return Serializer::GetActorsOffset(d); }) {}
 
   private:
 
@@ -66,6 +69,29 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// Whether this message only contains the actors that changed since the
+    /// frame returned by GetBaseFrame().
+    bool IsDelta() const {
+      return Serializer::IsDelta(GetHeader());
+    }
+
+    /// Frame of the state this delta applies to. Only valid if IsDelta().
+    uint64_t GetBaseFrame() const {
+      return Serializer::DeserializeDeltaHeader(Super::GetRawData()).base_frame;
+    }
+
+    /// Actors removed since the base frame. Only valid if IsDelta().
+    std::vector<ActorId> GetRemovedActorIds() const {
+      const auto &raw_data = Super::GetRawData();
+      const auto &delta = Serializer::DeserializeDeltaHeader(raw_data);
+      std::vector<ActorId> result(delta.number_of_removed_actors);
+      std::memcpy(
+          result.data(),
+          raw_data.begin() + Serializer::header_offset + sizeof(Serializer::DeltaHeader),
+          sizeof(ActorId) * result.size());
+      return result;
+    }
+
   };
 
 } // namespace data
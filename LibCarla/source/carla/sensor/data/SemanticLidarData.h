@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include "carla/NpyIO.h"
 #include "carla/rpc/Location.h"
 
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <numeric>
 
@@ -76,10 +78,25 @@ namespace data {
            "property uint32 ObjTag";
       }
 
+      void WritePcdHeaderInfo(std::ostream& out) const{
+        out << "FIELDS x y z cos_inc_angle object_idx object_tag\n" \
+           "SIZE 4 4 4 4 4 4\n" \
+           "TYPE F F F F U U\n" \
+           "COUNT 1 1 1 1 1 1";
+      }
+
       void WriteDetection(std::ostream& out) const{
         out << point.x << ' ' << point.y << ' ' << point.z << ' ' \
           << cos_inc_angle << ' ' << object_idx << ' ' << object_tag;
       }
+
+      /// Fields of the detection as a numpy structured type, in memory order.
+      static std::string GetNpyDescription() {
+        const auto f4 = NpyIO::GetTypeDescription<float>();
+        const auto u4 = NpyIO::GetTypeDescription<uint32_t>();
+        return "[('x', " + f4 + "), ('y', " + f4 + "), ('z', " + f4 + "), ('cos_inc_angle', " + f4 +
+            "), ('object_idx', " + u4 + "), ('object_tag', " + u4 + ")]";
+      }
   };
   #pragma pack(pop)
 
@@ -116,7 +133,7 @@ namespace data {
     }
 
     virtual void ResetMemory(std::vector<uint32_t> points_per_channel) {
-      DEBUG_ASSERT(GetChannelCount() > points_per_channel.size());
+      DEBUG_ASSERT(GetChannelCount() == points_per_channel.size());
       std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
 
       uint32_t total_points = static_cast<uint32_t>(
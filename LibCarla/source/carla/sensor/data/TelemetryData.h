@@ -0,0 +1,123 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/rpc/VehicleTelemetryData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+namespace s11n {
+  class TelemetrySerializer;
+}
+
+namespace data {
+
+  /// 一辆车的遥测数据，与 rpc::VehicleTelemetryData 相同但不包括车轮。
+  struct VehicleTelemetrySample {
+    float speed;
+    float steer;
+    float throttle;
+    float brake;
+    float engine_rpm;
+    int32_t gear;
+    float drag;
+  };
+
+  /// 一个车轮的遥测数据，与 rpc::WheelTelemetryData 相同。
+  struct WheelTelemetrySample {
+    float tire_friction;
+    float lat_slip;
+    float long_slip;
+    float omega;
+    float tire_load;
+    float normalized_tire_load;
+    float torque;
+    float long_force;
+    float lat_force;
+    float normalized_long_force;
+    float normalized_lat_force;
+  };
+
+  /// 一帧中多辆车的遥测数据，由服务器端写入。
+  class TelemetryData {
+    static_assert(sizeof(VehicleTelemetrySample) == 7u * sizeof(float), "Invalid VehicleTelemetrySample size");
+    static_assert(sizeof(WheelTelemetrySample) == 11u * sizeof(float), "Invalid WheelTelemetrySample size");
+
+  public:
+
+    class Index {
+    public:
+      enum Type {
+        VehicleCount,
+        SIZE
+      };
+    };
+
+    /// 头部中每辆车所占的 uint32_t 个数：参与者 ID 和车轮数。
+    static constexpr size_t vehicle_header_size = 2u;
+
+    explicit TelemetryData() : _header(Index::SIZE, 0u) {}
+
+    TelemetryData &operator=(TelemetryData &&) = default;
+
+    /// 删除所有车辆，不释放已分配的内存。
+    void Reset() {
+      _header.assign(Index::SIZE, 0u);
+      _vehicles.clear();
+      _wheels.clear();
+    }
+
+    size_t GetVehicleCount() const {
+      return _header[Index::VehicleCount];
+    }
+
+    void WriteVehicle(uint32_t actor_id, const rpc::VehicleTelemetryData &telemetry) {
+      ++_header[Index::VehicleCount];
+      _header.push_back(actor_id);
+      _header.push_back(static_cast<uint32_t>(telemetry.wheels.size()));
+      _vehicles.push_back(VehicleTelemetrySample{
+          telemetry.speed,
+          telemetry.steer,
+          telemetry.throttle,
+          telemetry.brake,
+          telemetry.engine_rpm,
+          telemetry.gear,
+          telemetry.drag});
+      for (const auto &wheel : telemetry.wheels) {
+        _wheels.push_back(WheelTelemetrySample{
+            wheel.tire_friction,
+            wheel.lat_slip,
+            wheel.long_slip,
+            wheel.omega,
+            wheel.tire_load,
+            wheel.normalized_tire_load,
+            wheel.torque,
+            wheel.long_force,
+            wheel.lat_force,
+            wheel.normalized_long_force,
+            wheel.normalized_lat_force});
+      }
+    }
+
+  private:
+
+    std::vector<uint32_t> _header;
+
+    std::vector<VehicleTelemetrySample> _vehicles;
+
+    std::vector<WheelTelemetrySample> _wheels;
+
+    friend class s11n::TelemetrySerializer;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
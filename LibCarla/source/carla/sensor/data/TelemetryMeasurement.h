@@ -0,0 +1,127 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/VehicleTelemetryData.h"
+#include "carla/sensor/SensorData.h"
+#include "carla/sensor/s11n/TelemetrySerializer.h"
+
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 车辆遥测传感器一帧的测量结果，包含一辆或多辆车的遥测数据，与
+  /// Vehicle::GetTelemetryData 的结果相同，但不需要每辆车一次 RPC。
+  class TelemetryMeasurement : public SensorData {
+  protected:
+
+    using Serializer = s11n::TelemetrySerializer;
+
+    friend Serializer;
+
+    explicit TelemetryMeasurement(RawData &&data)
+      : SensorData(data),
+        _data(std::move(data)) {
+      const auto header = GetHeader();
+      const size_t vehicle_count = header.GetVehicleCount();
+      _first_wheels.reserve(vehicle_count + 1u);
+      _first_wheels.push_back(0u);
+      for (size_t i = 0u; i < vehicle_count; ++i) {
+        _first_wheels.push_back(_first_wheels.back() + header.GetWheelCount(i));
+      }
+      const size_t vehicles_offset = Serializer::GetHeaderOffset(_data);
+      _vehicles = reinterpret_cast<const VehicleTelemetrySample *>(_data.begin() + vehicles_offset);
+      _wheels = reinterpret_cast<const WheelTelemetrySample *>(_vehicles + vehicle_count);
+      DEBUG_ASSERT(
+          vehicles_offset + sizeof(VehicleTelemetrySample) * vehicle_count +
+          sizeof(WheelTelemetrySample) * _first_wheels.back() == _data.size());
+    }
+
+  private:
+
+    s11n::TelemetryHeaderView GetHeader() const {
+      return Serializer::DeserializeHeader(_data);
+    }
+
+    RawData _data;
+
+    /// 每辆车的第一个车轮在 _wheels 中的位置。
+    std::vector<size_t> _first_wheels;
+
+    const VehicleTelemetrySample *_vehicles = nullptr;
+
+    const WheelTelemetrySample *_wheels = nullptr;
+
+  public:
+
+    size_t GetVehicleCount() const {
+      return _first_wheels.size() - 1u;
+    }
+
+    rpc::ActorId GetVehicleId(size_t vehicle_index) const {
+      return GetHeader().GetVehicleId(vehicle_index);
+    }
+
+    std::vector<rpc::ActorId> GetVehicleIds() const {
+      std::vector<rpc::ActorId> result;
+      result.reserve(GetVehicleCount());
+      for (size_t i = 0u; i < GetVehicleCount(); ++i) {
+        result.push_back(GetVehicleId(i));
+      }
+      return result;
+    }
+
+    /// 给定车辆在本帧中的序号，车辆不在测量结果中时返回 -1。
+    int FindVehicle(rpc::ActorId vehicle_id) const {
+      for (size_t i = 0u; i < GetVehicleCount(); ++i) {
+        if (GetVehicleId(i) == vehicle_id) {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    }
+
+    /// 第 @a vehicle_index 辆车的遥测数据。
+    rpc::VehicleTelemetryData GetTelemetry(size_t vehicle_index) const {
+      DEBUG_ASSERT(vehicle_index < GetVehicleCount());
+      const VehicleTelemetrySample &vehicle = _vehicles[vehicle_index];
+      std::vector<rpc::WheelTelemetryData> wheels;
+      wheels.reserve(_first_wheels[vehicle_index + 1u] - _first_wheels[vehicle_index]);
+      for (size_t i = _first_wheels[vehicle_index]; i < _first_wheels[vehicle_index + 1u]; ++i) {
+        const WheelTelemetrySample &wheel = _wheels[i];
+        wheels.emplace_back(
+            wheel.tire_friction,
+            wheel.lat_slip,
+            wheel.long_slip,
+            wheel.omega,
+            wheel.tire_load,
+            wheel.normalized_tire_load,
+            wheel.torque,
+            wheel.long_force,
+            wheel.lat_force,
+            wheel.normalized_long_force,
+            wheel.normalized_lat_force);
+      }
+      return rpc::VehicleTelemetryData(
+          vehicle.speed,
+          vehicle.steer,
+          vehicle.throttle,
+          vehicle.brake,
+          vehicle.engine_rpm,
+          vehicle.gear,
+          vehicle.drag,
+          std::move(wheels));
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+namespace s11n {
+  class WalkerPoseSerializer;
+}
+
+namespace data {
+
+  /// 一根骨骼在世界坐标系中的位姿，位置单位为米，旋转单位为度。
+  struct WalkerBonePose {
+    float x;
+    float y;
+    float z;
+    float pitch;
+    float yaw;
+    float roll;
+  };
+
+  /// 一帧中所有行人的骨骼位姿，由服务器端写入。骨骼的顺序与
+  /// Walker::GetBonesTransform 返回的顺序相同。
+  class WalkerPoseData {
+    static_assert(sizeof(WalkerBonePose) == 6u * sizeof(float), "Invalid WalkerBonePose size");
+
+  public:
+
+    class Index {
+    public:
+      enum Type {
+        WalkerCount,
+        SIZE
+      };
+    };
+
+    /// 头部中每个行人所占的 uint32_t 个数：参与者 ID 和骨骼数。
+    static constexpr size_t walker_header_size = 2u;
+
+    explicit WalkerPoseData() : _header(Index::SIZE, 0u) {}
+
+    WalkerPoseData &operator=(WalkerPoseData &&) = default;
+
+    /// 设置本帧的行人及其骨骼数，每一项为（参与者 ID，骨骼数）。之后可以在
+    /// 不同线程中同时调用 GetBones 写入不同行人的骨骼。已分配的内存不会释放。
+    void SetWalkers(const std::vector<std::pair<uint32_t, uint32_t>> &walkers) {
+      _header.resize(Index::SIZE + walker_header_size * walkers.size());
+      _header[Index::WalkerCount] = static_cast<uint32_t>(walkers.size());
+      _offsets.resize(walkers.size() + 1u);
+      _offsets[0u] = 0u;
+      for (size_t i = 0u; i < walkers.size(); ++i) {
+        _header[Index::SIZE + walker_header_size * i] = walkers[i].first;
+        _header[Index::SIZE + walker_header_size * i + 1u] = walkers[i].second;
+        _offsets[i + 1u] = _offsets[i] + walkers[i].second;
+      }
+      _bones.resize(_offsets.back());
+    }
+
+    size_t GetWalkerCount() const {
+      return _header[Index::WalkerCount];
+    }
+
+    size_t GetBoneCount() const {
+      return _bones.size();
+    }
+
+    /// 第 @a walker_index 个行人的骨骼的首地址，共有 SetWalkers 中给出的骨骼数。
+    WalkerBonePose *GetBones(size_t walker_index) {
+      DEBUG_ASSERT(walker_index < GetWalkerCount());
+      return _bones.data() + _offsets[walker_index];
+    }
+
+  private:
+
+    std::vector<uint32_t> _header;
+
+    /// 每个行人的第一根骨骼在 _bones 中的位置，不序列化。
+    std::vector<size_t> _offsets;
+
+    std::vector<WalkerBonePose> _bones;
+
+    friend class s11n::WalkerPoseSerializer;
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/data/Array.h"
+#include "carla/sensor/s11n/WalkerPoseSerializer.h"
+
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 行人位姿传感器一帧的测量结果，是所有行人骨骼位姿的数组，按行人依次排列。
+  /// 每个行人的骨骼顺序与 Walker::GetBonesTransform 返回的顺序相同，因此骨骼
+  /// 名称只需要用 GetBonesTransform 获取一次。
+  class WalkerPoseMeasurement : public Array<data::WalkerBonePose> {
+    using Super = Array<data::WalkerBonePose>;
+  protected:
+
+    using Serializer = s11n::WalkerPoseSerializer;
+
+    friend Serializer;
+
+    explicit WalkerPoseMeasurement(RawData &&data)
+      : Super(std::move(data), [](const RawData &d) {
+      return Serializer::GetHeaderOffset(d);
+    }) {
+      const auto header = GetHeader();
+      _offsets.reserve(header.GetWalkerCount() + 1u);
+      _offsets.push_back(0u);
+      for (size_t i = 0u; i < header.GetWalkerCount(); ++i) {
+        _offsets.push_back(_offsets.back() + header.GetBoneCount(i));
+      }
+      DEBUG_ASSERT(_offsets.back() == Super::size());
+    }
+
+  private:
+
+    s11n::WalkerPoseHeaderView GetHeader() const {
+      return Serializer::DeserializeHeader(Super::GetRawData());
+    }
+
+    /// 每个行人的第一根骨骼在数组中的位置。
+    std::vector<size_t> _offsets;
+
+  public:
+
+    size_t GetWalkerCount() const {
+      return _offsets.size() - 1u;
+    }
+
+    rpc::ActorId GetWalkerId(size_t walker_index) const {
+      return GetHeader().GetWalkerId(walker_index);
+    }
+
+    std::vector<rpc::ActorId> GetWalkerIds() const {
+      std::vector<rpc::ActorId> result;
+      result.reserve(GetWalkerCount());
+      for (size_t i = 0u; i < GetWalkerCount(); ++i) {
+        result.push_back(GetWalkerId(i));
+      }
+      return result;
+    }
+
+    /// 第 @a walker_index 个行人的骨骼个数。
+    size_t GetBoneCount(size_t walker_index) const {
+      DEBUG_ASSERT(walker_index < GetWalkerCount());
+      return _offsets[walker_index + 1u] - _offsets[walker_index];
+    }
+
+    /// 第 @a walker_index 个行人的第一根骨骼。
+    const_iterator GetBones(size_t walker_index) const {
+      DEBUG_ASSERT(walker_index < GetWalkerCount());
+      return Super::begin() + _offsets[walker_index];
+    }
+
+    /// 给定行人在本帧中的序号，行人不在测量结果中时返回 -1。
+    int FindWalker(rpc::ActorId walker_id) const {
+      for (size_t i = 0u; i < GetWalkerCount(); ++i) {
+        if (GetWalkerId(i) == walker_id) {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
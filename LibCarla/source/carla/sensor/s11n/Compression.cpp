@@ -0,0 +1,156 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/Compression.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  using HeaderSerializer = SensorHeaderSerializer;
+
+  static constexpr size_t size_prefix = sizeof(uint32_t);
+
+  static Buffer PopBufferFromPool(size_t size) {
+    static auto pool = std::make_shared<BufferPool>();
+    return pool->Pop(size);
+  }
+
+  bool Compression::FromString(const std::string &str, CompressionType &compression) {
+    if (str.empty() || (str == "none")) {
+      compression = CompressionType::None;
+    } else if (str == "deflate") {
+      compression = CompressionType::Deflate;
+    } else if (str == "video") {
+      compression = CompressionType::Video;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  const char *Compression::ToString(const CompressionType compression) {
+    switch (compression) {
+      case CompressionType::None:    return "none";
+      case CompressionType::Deflate: return "deflate";
+      case CompressionType::Video:   return "video";
+      default:                       return "unknown";
+    }
+  }
+
+  Buffer Compression::Compress(
+      const CompressionType compression,
+      const std::vector<boost::asio::const_buffer> &payload,
+      Buffer &&output) {
+    DEBUG_ASSERT(compression == CompressionType::Deflate);
+    (void) compression;
+    size_t total = 0u;
+    for (auto &part : payload) {
+      total += boost::asio::buffer_size(part);
+    }
+    if (total > std::numeric_limits<uint32_t>::max()) {
+      return Buffer{};
+    }
+
+    z_stream stream{};
+    if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK) {
+      return Buffer{};
+    }
+    const auto bound = size_prefix + deflateBound(&stream, static_cast<uLong>(total));
+    output.reset(bound);
+    const auto uncompressed_size = static_cast<uint32_t>(total);
+    std::memcpy(output.data(), &uncompressed_size, size_prefix);
+    stream.next_out = output.data() + size_prefix;
+    stream.avail_out = static_cast<uInt>(bound - size_prefix);
+
+    int result = Z_OK;
+    for (auto i = 0u; (i < payload.size()) && (result == Z_OK); ++i) {
+      const auto &part = payload[i];
+      stream.next_in = const_cast<Bytef *>(
+          boost::asio::buffer_cast<const Bytef *>(part));
+      stream.avail_in = static_cast<uInt>(boost::asio::buffer_size(part));
+      const int flush = (i + 1u == payload.size()) ? Z_FINISH : Z_NO_FLUSH;
+      do {
+        result = deflate(&stream, flush);
+      } while ((result == Z_OK) && (stream.avail_in > 0u));
+    }
+    if (payload.empty()) {
+      result = deflate(&stream, Z_FINISH);
+    }
+    const auto compressed_size = size_prefix + stream.total_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+      return Buffer{};
+    }
+    output.reset(static_cast<Buffer::size_type>(compressed_size));
+    return std::move(output);
+  }
+
+  uint32_t Compression::GetUncompressedSize(const Buffer &message) {
+    DEBUG_ASSERT(message.size() >= HeaderSerializer::header_offset + size_prefix);
+    uint32_t size;
+    std::memcpy(&size, message.data() + HeaderSerializer::header_offset, size_prefix);
+    return size;
+  }
+
+  Buffer Compression::Decompress(Buffer &&message, Buffer &&output) {
+    constexpr auto header_size = HeaderSerializer::header_offset;
+    if (message.size() < header_size) {
+      return std::move(message);
+    }
+    auto header = HeaderSerializer::Deserialize(message);
+    const auto compression = static_cast<CompressionType>(HeaderSerializer::GetCompression(header));
+    if (compression == CompressionType::None) {
+      return std::move(message);
+    }
+    if (compression == CompressionType::Video) {
+      throw_exception(std::runtime_error("video frames can only be decoded by the decoder of their stream"));
+    }
+    if ((compression != CompressionType::Deflate) ||
+        (message.size() < header_size + size_prefix)) {
+      throw_exception(std::runtime_error("invalid compressed sensor data"));
+    }
+
+    const auto uncompressed_size = GetUncompressedSize(message);
+    output.reset(header_size + uncompressed_size);
+    HeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::None));
+    std::memcpy(output.data(), &header, header_size);
+
+    uLongf destination_size = uncompressed_size;
+    const int result = uncompress(
+        output.data() + header_size,
+        &destination_size,
+        message.data() + header_size + size_prefix,
+        static_cast<uLong>(message.size() - header_size - size_prefix));
+    if ((result != Z_OK) || (destination_size != uncompressed_size)) {
+      throw_exception(std::runtime_error("failed to decompress sensor data"));
+    }
+    return std::move(output);
+  }
+
+  Buffer Compression::Decompress(Buffer &&message) {
+    if ((message.size() < HeaderSerializer::header_offset + size_prefix) ||
+        (HeaderSerializer::GetCompression(HeaderSerializer::Deserialize(message)) == 0u)) {
+      return std::move(message);
+    }
+    const auto size = HeaderSerializer::header_offset + GetUncompressedSize(message);
+    return Decompress(std::move(message), PopBufferFromPool(size));
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// 传感器数据流可选的压缩方式，保存在数据头 sensor_type 的最高字节中。
+  enum class CompressionType : uint8_t {
+    None = 0u,
+    /// zlib (deflate) 无损压缩，使用最快的压缩级别。
+    Deflate = 1u,
+    /// 视频流，每一帧可以依赖于之前的帧（参见 VideoEncoder），只能由该流的
+    /// VideoDecoder 按顺序解码。
+    Video = 2u
+  };
+
+  /// 压缩与解压传感器消息的负载（数据头之后的部分）。
+  ///
+  /// 压缩后的负载格式为：[uint32 原始大小][压缩数据]。数据头本身不压缩，
+  /// 因此不解压也可以读取帧号、时间戳等元信息。
+  class Compression {
+  public:
+
+    /// 将字符串（"none" / "deflate" / "video"）转换为压缩方式，无法识别时返回 false。
+    static bool FromString(const std::string &str, CompressionType &compression);
+
+    static const char *ToString(CompressionType compression);
+
+    /// 将 @a payload 的各个部分依次压缩到 @a output 中。
+    ///
+    /// @return 压缩后的负载；压缩失败时返回空缓冲区。
+    static Buffer Compress(
+        CompressionType compression,
+        const std::vector<boost::asio::const_buffer> &payload,
+        Buffer &&output);
+
+    /// 压缩后的负载解压后的大小。
+    static uint32_t GetUncompressedSize(const Buffer &message);
+
+    /// 解压完整的传感器消息（数据头 + 压缩的负载），返回未压缩的消息，
+    /// 其数据头中的压缩标志已清除。@a message 未压缩时原样返回。
+    ///
+    /// @throw std::runtime_error 如果数据已损坏，或者是视频帧（需要使用
+    /// 该流的 VideoDecoder）。
+    static Buffer Decompress(Buffer &&message, Buffer &&output);
+
+    static Buffer Decompress(Buffer &&message);
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
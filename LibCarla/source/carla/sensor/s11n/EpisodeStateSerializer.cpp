@@ -8,10 +8,44 @@
 
 #include "carla/sensor/data/RawEpisodeState.h" // 包含 RawEpisodeState 数据类型的定义
 
+#include <cmath>
+#include <cstring>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
   //从原始传感器数据反序列化出场景状态数据
+  static bool EpisodeStateSerializer_IsNear(const geom::Vector3D &lhs, const geom::Vector3D &rhs, float epsilon) {
+    return (std::abs(lhs.x - rhs.x) <= epsilon) &&
+           (std::abs(lhs.y - rhs.y) <= epsilon) &&
+           (std::abs(lhs.z - rhs.z) <= epsilon);
+  }
+
+  size_t EpisodeStateSerializer::GetActorsOffset(const RawData &message) {
+    if (!IsDelta(DeserializeHeader(message))) {
+      return header_offset;
+    }
+    const auto &delta = DeserializeDeltaHeader(message);
+    return header_offset + sizeof(DeltaHeader) + delta.number_of_removed_actors * sizeof(ActorId);
+  }
+
+  bool EpisodeStateSerializer::HasChanged(
+      const data::ActorDynamicState &lhs,
+      const data::ActorDynamicState &rhs,
+      const float epsilon) {
+    const auto &lrot = lhs.transform.rotation;
+    const auto &rrot = rhs.transform.rotation;
+    return
+        (lhs.id != rhs.id) ||
+        (lhs.actor_state != rhs.actor_state) ||
+        !EpisodeStateSerializer_IsNear(lhs.transform.location, rhs.transform.location, epsilon) ||
+        !EpisodeStateSerializer_IsNear({lrot.pitch, lrot.yaw, lrot.roll}, {rrot.pitch, rrot.yaw, rrot.roll}, epsilon) ||
+        !EpisodeStateSerializer_IsNear(lhs.velocity, rhs.velocity, epsilon) ||
+        !EpisodeStateSerializer_IsNear(lhs.angular_velocity, rhs.angular_velocity, epsilon) ||
+        !EpisodeStateSerializer_IsNear(lhs.acceleration, rhs.acceleration, epsilon) ||
+        (std::memcmp(&lhs.state, &rhs.state, sizeof(lhs.state)) != 0);
+  }
+
   SharedPtr<SensorData> EpisodeStateSerializer::Deserialize(RawData &&data) {
     // 将输入的原始数据封装到一个新的 RawEpisodeState 对象中
     // 使用智能指针 SharedPtr 管理对象的生命周期
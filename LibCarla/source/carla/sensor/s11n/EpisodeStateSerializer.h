@@ -30,7 +30,8 @@ namespace s11n {
     enum SimulationState {  //枚举类，用于表示模拟状态的类型
       None               = (0x0 << 0),  // 默认状态，无特定更新
       MapChange          = (0x1 << 0),  // 表示地图变更的状态
-      PendingLightUpdate = (0x1 << 1)  // 表示待处理的交通信号灯更新
+      PendingLightUpdate = (0x1 << 1),  // 表示待处理的交通信号灯更新
+      Delta              = (0x1 << 2)  // 只包含自基准帧以来发生变化的参与者
     };
 
 #pragma pack(push, 1)
@@ -45,6 +46,34 @@ namespace s11n {
 
     constexpr static auto header_offset = sizeof(Header);  // 数据头部的偏移量，用于快速定位数据正文
 
+    /// 增量消息在 Header 之后的头部，其后是 number_of_removed_actors 个被移除的
+    /// 参与者 ID，然后是状态发生变化（或新出现）的参与者。未列出的参与者与
+    /// 基准帧中的状态相同。
+#pragma pack(push, 1)
+    struct DeltaHeader {
+      uint64_t base_frame;  // 增量所基于的上一条消息的帧号
+      uint32_t number_of_removed_actors;  // 基准帧之后被移除的参与者数量
+    };
+#pragma pack(pop)
+
+    static bool IsDelta(const Header &header) {
+      return (header.simulation_state & SimulationState::Delta) != 0;
+    }
+
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      DEBUG_ASSERT(IsDelta(DeserializeHeader(message)));
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
+    }
+
+    /// 第一个参与者状态在消息中的偏移量。
+    static size_t GetActorsOffset(const RawData &message);
+
+    /// 两个状态是否有任一数值的差超过 @a epsilon，或非数值的状态不同。
+    static bool HasChanged(
+        const data::ActorDynamicState &lhs,
+        const data::ActorDynamicState &rhs,
+        float epsilon);
+
     //反序列化数据包头部
     static const Header &DeserializeHeader(const RawData &message) {  // 反序列化数据包头部
       return *reinterpret_cast<const Header *>(message.begin());  // 返回解析后的'Header'结构体的引用
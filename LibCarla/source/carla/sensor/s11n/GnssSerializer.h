@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/Memory.h" // 提供智能指针和内存管理相关的功能
 #include "carla/geom/GeoLocation.h" // 定义了 GeoLocation，表示地理位置信息
 #include "carla/rpc/ActorId.h" // 定义了 ActorId，用于标识参与者
@@ -13,6 +14,7 @@
 
 #include <cstdint> // 提供固定大小的整数类型
 #include <cstring> // 提供内存操作函数
+#include <vector>
 
 namespace carla { // Carla 项目顶级命名空间
 namespace sensor { // 包含所有与传感器相关的功能
@@ -24,9 +26,34 @@ namespace s11n { // 提供序列化和反序列化功能的命名空间
   class GnssSerializer {  // 数据的序列化器，用于处理 GNSS 数据的序列化和反序列化操作
   public:
 
-    static geom::GeoLocation DeserializeRawData(const RawData &message) {
-      // 使用 MsgPack 解包 RawData 中的数据，并将其解析为 GeoLocation 对象
-      return MsgPack::UnPack<geom::GeoLocation>(message.begin(), message.size());
+    /// 两次节拍之间的一个采样，time_offset 为相对于测量时间戳的秒数（不大于 0）
+    struct Sample {
+
+      float time_offset;
+
+      geom::GeoLocation geo_location;
+
+      MSGPACK_DEFINE_ARRAY(time_offset, geo_location)
+    };
+
+    /// 与 GeoLocation 的前三个字段兼容，每次节拍只有一个采样时不发送 samples，
+    /// 否则前三个字段为最后一个采样
+    struct Data {
+
+      double latitude = 0.0;
+
+      double longitude = 0.0;
+
+      double altitude = 0.0;
+
+      std::vector<Sample> samples;
+
+      MSGPACK_DEFINE_ARRAY(latitude, longitude, altitude, samples)
+    };
+
+    static Data DeserializeRawData(const RawData &message) {
+      // 使用 MsgPack 解包 RawData 中的数据，只有一个采样时 samples 为空
+      return MsgPack::UnPack<Data>(message.begin(), message.size());
     }
 
     /// @brief 将地理位置信息序列化为二进制数据
@@ -42,6 +69,16 @@ namespace s11n { // 提供序列化和反序列化功能的命名空间
       return MsgPack::Pack(geo_location);
     }
 
+    /// @brief 将一次节拍中按时间排序的所有采样序列化，最后一个采样即测量本身
+    template <typename SensorT>
+    static Buffer Serialize(
+        const SensorT &,
+        const std::vector<Sample> &samples) {
+      DEBUG_ASSERT(!samples.empty());
+      const geom::GeoLocation &last = samples.back().geo_location;
+      return MsgPack::Pack(Data{last.latitude, last.longitude, last.altitude, samples});
+    }
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
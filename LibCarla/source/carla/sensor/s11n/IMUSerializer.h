@@ -7,9 +7,12 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/Debug.h"
 #include "carla/Memory.h"
 #include "carla/sensor/RawData.h"
 
+#include <vector>
+
 namespace carla {
 namespace sensor {
 
@@ -21,6 +24,22 @@ namespace s11n {
   {
   public:
 
+    /// One of the samples taken between two sensor ticks.
+    struct Sample {
+
+      /// Seconds relative to the timestamp of the measurement, zero or
+      /// negative.
+      float time_offset;
+
+      geom::Vector3D accelerometer;
+
+      geom::Vector3D gyroscope;
+
+      float compass;
+
+      MSGPACK_DEFINE_ARRAY(time_offset, accelerometer, gyroscope, compass)
+    };
+
     struct Data {
 
       geom::Vector3D accelerometer;
@@ -29,7 +48,12 @@ namespace s11n {
 
       float compass;
 
-      MSGPACK_DEFINE_ARRAY(accelerometer, gyroscope, compass)
+      /// Empty unless the sensor takes several samples per tick, in which
+      /// case the fields above hold the last one. Older messages don't have
+      /// this field and unpack with it empty.
+      std::vector<Sample> samples;
+
+      MSGPACK_DEFINE_ARRAY(accelerometer, gyroscope, compass, samples)
     };
 
     template <typename SensorT>
@@ -39,6 +63,13 @@ namespace s11n {
       const geom::Vector3D &gyroscope,
       const float compass);
 
+    /// Serialize the samples taken during a tick, ordered by time. The last
+    /// one is also the sample of the measurement itself.
+    template <typename SensorT>
+    static Buffer Serialize(
+      const SensorT &sensor,
+      const std::vector<Sample> &samples);
+
     static Data DeserializeRawData(const RawData &message) {
       return MsgPack::UnPack<Data>(message.begin(), message.size());
     }
@@ -52,7 +83,16 @@ namespace s11n {
       const geom::Vector3D &accelerometer,
       const geom::Vector3D &gyroscope,
       const float compass) {
-    return MsgPack::Pack(Data{accelerometer, gyroscope, compass});
+    return MsgPack::Pack(Data{accelerometer, gyroscope, compass, {}});
+  }
+
+  template <typename SensorT>
+  inline Buffer IMUSerializer::Serialize(
+      const SensorT &,
+      const std::vector<Sample> &samples) {
+    DEBUG_ASSERT(!samples.empty());
+    const Sample &last = samples.back();
+    return MsgPack::Pack(Data{last.accelerometer, last.gyroscope, last.compass, samples});
   }
 
 } // namespace s11n
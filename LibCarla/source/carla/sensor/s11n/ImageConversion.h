@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// 相机图像在服务器端（GPU 上）转换后的像素格式，保存在数据头 sensor_type
+  /// 的第二高字节中（见 SensorHeaderSerializer::GetPayloadFormat）。
+  enum class ImageFormat : uint8_t {
+    /// 每像素 4 字节 BGRA，未转换的图像。
+    BGRA8 = 0u,
+    /// 每像素 2 字节的半精度浮点深度，单位为米。
+    Depth16F = 1u,
+    /// 每像素 4 字节的单精度浮点深度，单位为米。
+    Depth32F = 2u,
+    /// 每像素 1 字节的语义标签。
+    Label8 = 3u,
+    /// 不是图像：实例分割图像在 GPU 上归约得到的每个实例的像素数与二维包围盒，
+    /// 见 data::InstanceBoxes。不能作为 output_format 选择。
+    InstanceBoxes = 4u
+  };
+
+  /// 图像中的矩形区域，单位为像素。
+  struct ImageRegion {
+    uint32_t x = 0u;
+    uint32_t y = 0u;
+    uint32_t width = 0u;
+    uint32_t height = 0u;
+  };
+
+  /// 回读之前对相机图像进行的转换：裁剪出感兴趣区域（ROI），按整数倍缩小，
+  /// 再转换为 format 格式。缩小时颜色取每个块的平均值，深度和标签取块左上角
+  /// 的像素，避免在物体边缘混合不同的值。
+  struct ImageConversion {
+    ImageFormat format = ImageFormat::BGRA8;
+
+    /// 宽度或高度为 0 时区域延伸到图像的边缘。
+    ImageRegion roi;
+
+    uint32_t downscale = 1u;
+
+    /// 将字符串（"bgra8" / "depth16f" / "depth32f" / "label8"）转换为格式，
+    /// 无法识别时返回 false。
+    static bool FromString(const std::string &str, ImageFormat &format) {
+      for (auto candidate : {ImageFormat::BGRA8, ImageFormat::Depth16F, ImageFormat::Depth32F, ImageFormat::Label8}) {
+        if (str == ToString(candidate)) {
+          format = candidate;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    static const char *ToString(ImageFormat format) {
+      switch (format) {
+        case ImageFormat::Depth16F: return "depth16f";
+        case ImageFormat::Depth32F: return "depth32f";
+        case ImageFormat::Label8:   return "label8";
+        case ImageFormat::InstanceBoxes: return "instance_boxes";
+        default:                    return "bgra8";
+      }
+    }
+
+    static uint32_t GetBytesPerPixel(ImageFormat format) {
+      switch (format) {
+        case ImageFormat::Depth16F: return 2u;
+        case ImageFormat::Label8:   return 1u;
+        default:                    return 4u;
+      }
+    }
+
+    /// 限制在 @a image_width x @a image_height 的图像之内的感兴趣区域。
+    ImageRegion GetRegion(uint32_t image_width, uint32_t image_height) const {
+      ImageRegion region;
+      region.x = std::min(roi.x, image_width);
+      region.y = std::min(roi.y, image_height);
+      region.width = image_width - region.x;
+      region.height = image_height - region.y;
+      if (roi.width > 0u) {
+        region.width = std::min(region.width, roi.width);
+      }
+      if (roi.height > 0u) {
+        region.height = std::min(region.height, roi.height);
+      }
+      return region;
+    }
+
+    uint32_t GetOutputWidth(uint32_t image_width, uint32_t image_height) const {
+      return GetRegion(image_width, image_height).width / std::max(downscale, 1u);
+    }
+
+    uint32_t GetOutputHeight(uint32_t image_width, uint32_t image_height) const {
+      return GetRegion(image_width, image_height).height / std::max(downscale, 1u);
+    }
+
+    /// 转换后的图像与原图像相同，不需要转换。
+    bool IsIdentity(uint32_t image_width, uint32_t image_height) const {
+      const auto region = GetRegion(image_width, image_height);
+      return format == ImageFormat::BGRA8 &&
+          std::max(downscale, 1u) == 1u &&
+          region.x == 0u && region.y == 0u &&
+          region.width == image_width && region.height == image_height;
+    }
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
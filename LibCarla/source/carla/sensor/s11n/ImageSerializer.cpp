@@ -6,13 +6,21 @@
 
 #include "carla/sensor/s11n/ImageSerializer.h"
 
+#include "carla/sensor/data/ConvertedImage.h"
 #include "carla/sensor/data/Image.h"
+#include "carla/sensor/data/InstanceBoxes.h"
 
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> ImageSerializer::Deserialize(RawData &&data) {
+    if (data.GetPayloadFormat() == static_cast<uint8_t>(ImageFormat::InstanceBoxes)) {
+      return SharedPtr<data::InstanceBoxes>(new data::InstanceBoxes{std::move(data)});
+    }
+    if (data.GetPayloadFormat() != static_cast<uint8_t>(ImageFormat::BGRA8)) {
+      return SharedPtr<data::ConvertedImage>(new data::ConvertedImage{std::move(data)});
+    }
     auto image = SharedPtr<data::Image>(new data::Image{std::move(data)});
     // Set alpha of each pixel in the buffer to max to make it 100% opaque
     for (auto &pixel : *image) {
@@ -20,6 +20,10 @@ namespace sensor {
 namespace s11n {
 
   /// Serializes image buffers generated by camera sensors.
+  ///
+  /// The size in the header is the size of the image after the conversion
+  /// applied by the sensor, if any. Images converted to a format other than
+  /// BGRA8 (see ImageFormat) are deserialized as data::ConvertedImage.
   class ImageSerializer {
   public:
 
@@ -40,6 +44,11 @@ namespace s11n {
     template <typename Sensor>
     static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);
 
+    /// 仅序列化图像头部。用于像素数据作为独立缓冲区发送的情况，
+    /// 此时像素数据的前 header_offset 个字节不需要预留给头部。
+    template <typename Sensor>
+    static Buffer SerializeHeader(const Sensor &sensor);
+
     static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
@@ -47,14 +56,24 @@ namespace s11n {
   inline Buffer ImageSerializer::Serialize(const Sensor &sensor, Buffer &&bitmap) {
     DEBUG_ASSERT(bitmap.size() > sizeof(ImageHeader));
     ImageHeader header = {
-      sensor.GetImageWidth(),
-      sensor.GetImageHeight(),
+      sensor.GetOutputImageWidth(),
+      sensor.GetOutputImageHeight(),
       sensor.GetFOVAngle()
     };
     std::memcpy(bitmap.data(), reinterpret_cast<const void *>(&header), sizeof(header));
     return std::move(bitmap);
   }
 
+  template <typename Sensor>
+  inline Buffer ImageSerializer::SerializeHeader(const Sensor &sensor) {
+    ImageHeader header = {
+      sensor.GetOutputImageWidth(),
+      sensor.GetOutputImageHeight(),
+      sensor.GetFOVAngle()
+    };
+    return Buffer(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/MsgPack.h"
+#include "carla/road/element/LaneMarking.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/RawData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  /// Serializes the lane markings crossed by the parent of a server-side
+  /// lane invasion sensor.
+  class LaneInvasionEventSerializer {
+  public:
+
+    struct LaneMarkingData {
+
+      uint8_t type;
+
+      uint8_t color;
+
+      uint8_t lane_change;
+
+      double width;
+
+      MSGPACK_DEFINE_ARRAY(type, color, lane_change, width)
+    };
+
+    struct Data {
+
+      ActorId parent;
+
+      std::vector<LaneMarkingData> crossed_lane_markings;
+
+      MSGPACK_DEFINE_ARRAY(parent, crossed_lane_markings)
+    };
+
+    constexpr static auto header_offset = 0u;
+
+    static Data DeserializeRawData(const RawData &message) {
+      return MsgPack::UnPack<Data>(message.begin(), message.size());
+    }
+
+    static std::vector<road::element::LaneMarking> ToLaneMarkings(const Data &data) {
+      using LaneMarking = road::element::LaneMarking;
+      std::vector<LaneMarking> result;
+      result.reserve(data.crossed_lane_markings.size());
+      for (const auto &item : data.crossed_lane_markings) {
+        LaneMarking marking;
+        marking.type = static_cast<LaneMarking::Type>(item.type);
+        marking.color = static_cast<LaneMarking::Color>(item.color);
+        marking.lane_change = static_cast<LaneMarking::LaneChange>(item.lane_change);
+        marking.width = item.width;
+        result.emplace_back(marking);
+      }
+      return result;
+    }
+
+    template <typename SensorT>
+    static Buffer Serialize(
+        const SensorT &,
+        ActorId parent,
+        const std::vector<road::element::LaneMarking> &crossed_lane_markings) {
+      Data data{parent, {}};
+      data.crossed_lane_markings.reserve(crossed_lane_markings.size());
+      for (const auto &marking : crossed_lane_markings) {
+        data.crossed_lane_markings.push_back(LaneMarkingData{
+            static_cast<uint8_t>(marking.type),
+            static_cast<uint8_t>(marking.color),
+            static_cast<uint8_t>(marking.lane_change),
+            marking.width});
+      }
+      return MsgPack::Pack(data);
+    }
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -5,6 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 
+#include "carla/sensor/data/LidarColumns.h"
 #include "carla/sensor/data/LidarMeasurement.h"
 #include "carla/sensor/s11n/LidarSerializer.h"
 
@@ -13,6 +14,9 @@ namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> LidarSerializer::Deserialize(RawData &&data) {
+    if (data.GetPayloadFormat() == static_cast<uint8_t>(data::LidarPointLayout::SoA)) {
+      return SharedPtr<data::LidarColumns>(new data::LidarColumns{std::move(data)});
+    }
     return SharedPtr<data::LidarMeasurement>(
         new data::LidarMeasurement{std::move(data)});
   }
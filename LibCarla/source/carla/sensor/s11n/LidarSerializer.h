@@ -11,6 +11,8 @@
 #include "carla/sensor/RawData.h"
 #include "carla/sensor/data/LidarData.h"
 
+#include <cstring>
+
 namespace carla {
 namespace sensor {
 
@@ -74,6 +76,13 @@ namespace s11n {
         Buffer &&output);
 
     static SharedPtr<SensorData> Deserialize(RawData &&data);
+
+    /// Bytes of each point in the columns of LidarPointLayout::SoA.
+    static constexpr size_t column_point_size = 4u * sizeof(float) + sizeof(uint8_t);
+
+  private:
+
+    static Buffer SerializeColumns(const data::LidarData &data, Buffer &&output);
   };
 
   // ===========================================================================
@@ -85,6 +94,9 @@ namespace s11n {
       const Sensor &,
       const data::LidarData &data,
       Buffer &&output) {
+    if (data.GetLayout() == data::LidarPointLayout::SoA) {
+      return SerializeColumns(data, std::move(output));
+    }
     std::array<boost::asio::const_buffer, 2u> seq = {
         boost::asio::buffer(data._header),
         boost::asio::buffer(data._points)};
@@ -92,6 +104,31 @@ namespace s11n {
     return std::move(output);
   }
 
+  inline Buffer LidarSerializer::SerializeColumns(
+      const data::LidarData &data,
+      Buffer &&output) {
+    const size_t count = data.GetPointCount();
+    const size_t header_size = sizeof(uint32_t) * data._header.size();
+    output.reset(header_size + column_point_size * count);
+    std::memcpy(output.data(), data._header.data(), header_size);
+
+    // Transpose the points into the X, Y, Z and I columns.
+    unsigned char *column = output.data() + header_size;
+    for (size_t component = 0u; component < 4u; ++component) {
+      float *out = reinterpret_cast<float *>(column);
+      for (size_t i = 0u; i < count; ++i) {
+        out[i] = data._points[4u * i + component];
+      }
+      column += sizeof(float) * count;
+    }
+    if (data._tags.size() == count) {
+      std::memcpy(column, data._tags.data(), count);
+    } else {
+      std::memset(column, 0, count);
+    }
+    return std::move(output);
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
@@ -39,6 +39,10 @@ namespace carla {
         template <typename Sensor>
         static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);// 模板静态函数，对传感器数据和缓冲区进行序列化，传入传感器对象和可变右值引用的缓冲区
 
+        /// 仅序列化图像头部，用于像素数据作为独立缓冲区发送的情况。
+        template <typename Sensor>
+        static Buffer SerializeHeader(const Sensor &sensor);
+
         static SharedPtr<SensorData> Deserialize(RawData &&data);// 静态函数，反序列化 RawData 对象为 SensorData 的智能指针
       };
 
@@ -54,6 +58,16 @@ namespace carla {
         return std::move(bitmap);// 返回移动后的缓冲区
       }
 
+      template <typename Sensor>
+      inline Buffer NormalsImageSerializer::SerializeHeader(const Sensor &sensor) {
+        ImageHeader header = {
+            sensor.GetImageWidth(),
+            sensor.GetImageHeight(),
+            sensor.GetFOVAngle()
+        };
+        return Buffer(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+      }
+
     } // namespace s11n
   } // namespace sensor
 } // namespace carla
@@ -38,6 +38,10 @@ namespace carla {
         template <typename Sensor>
         static Buffer Serialize(const Sensor &sensor, Buffer &&bitmap);
 
+        /// 仅序列化图像头部，用于像素数据作为独立缓冲区发送的情况。
+        template <typename Sensor>
+        static Buffer SerializeHeader(const Sensor &sensor);
+
         static SharedPtr<SensorData> Deserialize(RawData &&data);
       };
 
@@ -53,6 +57,16 @@ namespace carla {
         return std::move(bitmap);
       }
 
+      template <typename Sensor>
+      inline Buffer OpticalFlowImageSerializer::SerializeHeader(const Sensor &sensor) {
+        ImageHeader header = {
+            sensor.GetImageWidth(),
+            sensor.GetImageHeight(),
+            sensor.GetFOVAngle()
+        };
+        return Buffer(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+      }
+
     } // namespace s11n
   } // namespace sensor
 } // namespace carla
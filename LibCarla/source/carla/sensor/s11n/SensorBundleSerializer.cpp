@@ -0,0 +1,168 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/SensorBundleSerializer.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  using Entry = SensorBundleSerializer::Entry;
+
+  static Buffer PopBufferFromPool(size_t size) {
+    static auto pool = std::make_shared<BufferPool>();
+    return pool->Pop(size);
+  }
+
+  // ===========================================================================
+  // -- SensorBundleSerializer -------------------------------------------------
+  // ===========================================================================
+
+  std::vector<std::pair<SensorBundleSerializer::stream_id_type, Buffer>>
+  SensorBundleSerializer::Deserialize(const Buffer &message) {
+    uint32_t count = 0u;
+    if (message.size() < sizeof(count)) {
+      throw_exception(std::invalid_argument("invalid sensor bundle message"));
+    }
+    std::memcpy(&count, message.data(), sizeof(count));
+    const size_t index_size = sizeof(count) + count * sizeof(Entry);
+    if (message.size() < index_size) {
+      throw_exception(std::invalid_argument("invalid sensor bundle message"));
+    }
+    std::vector<std::pair<stream_id_type, Buffer>> result;
+    result.reserve(count);
+    for (auto i = 0u; i < count; ++i) {
+      Entry entry;
+      std::memcpy(&entry, message.data() + sizeof(count) + i * sizeof(Entry), sizeof(Entry));
+      if (index_size + entry.offset + size_t(entry.size) > message.size()) {
+        throw_exception(std::invalid_argument("invalid sensor bundle message"));
+      }
+      auto buffer = PopBufferFromPool(entry.size);
+      buffer.copy_from(message.data() + index_size + entry.offset, entry.size);
+      result.emplace_back(entry.stream_id, std::move(buffer));
+    }
+    return result;
+  }
+
+  // ===========================================================================
+  // -- SensorBundleBuilder ----------------------------------------------------
+  // ===========================================================================
+
+  SensorBundleBuilder::SensorBundleBuilder(
+      std::vector<stream_id_type> stream_ids,
+      const size_t max_pending_frames)
+    : _stream_ids(std::move(stream_ids)),
+      _max_pending_frames(std::max<size_t>(max_pending_frames, 1u)) {}
+
+  bool SensorBundleBuilder::Contains(const stream_id_type stream_id) const {
+    return IndexOf(stream_id) < _stream_ids.size();
+  }
+
+  size_t SensorBundleBuilder::IndexOf(const stream_id_type stream_id) const {
+    return static_cast<size_t>(
+        std::find(_stream_ids.begin(), _stream_ids.end(), stream_id) - _stream_ids.begin());
+  }
+
+  uint64_t SensorBundleBuilder::GetDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped_frames;
+  }
+
+  boost::optional<std::pair<Buffer, Buffer>> SensorBundleBuilder::Add(
+      const stream_id_type stream_id,
+      const uint64_t frame,
+      const std::vector<boost::asio::const_buffer> &message) {
+    const auto index = IndexOf(stream_id);
+    if (index >= _stream_ids.size()) {
+      return boost::none;
+    }
+    const auto message_size = boost::asio::buffer_size(message);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pending.find(frame);
+    if (it == _pending.end()) {
+      if (!_pending.empty() && (frame < _pending.begin()->first) &&
+          (_pending.size() >= _max_pending_frames)) {
+        // 比所有未完成的帧都旧，不可能再完成
+        return boost::none;
+      }
+      it = _pending.emplace(frame, PendingFrame{}).first;
+      it->second.data = PopBufferFromPool(_last_frame_size);
+      it->second.data.reset(0u);
+      it->second.entries.resize(_stream_ids.size(), Entry{0u, 0u, 0u});
+      it->second.is_received.resize(_stream_ids.size(), false);
+      while (_pending.size() > _max_pending_frames) {
+        log_debug("sensor bundle: dropping incomplete frame", _pending.begin()->first);
+        _pending.erase(_pending.begin());
+        ++_dropped_frames;
+      }
+      it = _pending.find(frame);
+      if (it == _pending.end()) {
+        return boost::none;
+      }
+    }
+
+    auto &pending = it->second;
+    auto &entry = pending.entries[index];
+    if (pending.is_received[index]) {
+      // 同一帧收到了两次，保留第一次的数据
+      return boost::none;
+    }
+
+    // 追加到数据缓冲区，容量不足时扩容并保留已有的数据
+    const size_t offset = pending.data.size();
+    const size_t required = offset + message_size;
+    if (required > std::numeric_limits<uint32_t>::max()) {
+      log_warning("sensor bundle: frame", frame, "is too big, dropping it");
+      _pending.erase(it);
+      ++_dropped_frames;
+      return boost::none;
+    }
+    if (required > pending.data.capacity()) {
+      auto grown = PopBufferFromPool(std::max(required, 2u * size_t(pending.data.capacity())));
+      grown.reset(static_cast<Buffer::size_type>(required));
+      std::memcpy(grown.data(), pending.data.data(), offset);
+      pending.data = std::move(grown);
+    } else {
+      pending.data.reset(static_cast<Buffer::size_type>(required));
+    }
+    boost::asio::buffer_copy(boost::asio::buffer(pending.data.data() + offset, message_size), message);
+    entry.stream_id = stream_id;
+    entry.offset = static_cast<uint32_t>(offset);
+    entry.size = static_cast<uint32_t>(message_size);
+    pending.is_received[index] = true;
+
+    if (++pending.received < _stream_ids.size()) {
+      return boost::none;
+    }
+
+    // 帧已完整，生成索引并丢弃所有更旧的帧
+    const auto count = static_cast<uint32_t>(pending.entries.size());
+    Buffer header = PopBufferFromPool(sizeof(count) + count * sizeof(Entry));
+    header.reset(static_cast<Buffer::size_type>(sizeof(count) + count * sizeof(Entry)));
+    std::memcpy(header.data(), &count, sizeof(count));
+    std::memcpy(header.data() + sizeof(count), pending.entries.data(), count * sizeof(Entry));
+    Buffer data = std::move(pending.data);
+    _last_frame_size = data.size();
+
+    _dropped_frames += static_cast<uint64_t>(std::distance(_pending.begin(), it));
+    _pending.erase(_pending.begin(), std::next(it));
+    return std::make_pair(std::move(header), std::move(data));
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,110 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// 传感器组（bundle）的消息格式：将一组传感器在同一帧的数据合并为一条消息。
+  ///
+  /// 消息由两部分组成：
+  ///   - 索引：[uint32 数量][数量 × {uint32 stream_id, uint32 偏移, uint32 大小}]，
+  ///     按创建组时传感器的顺序排列；
+  ///   - 数据：各传感器的完整消息（数据头 + 负载），按到达顺序依次存放。
+  class SensorBundleSerializer {
+  public:
+
+    using stream_id_type = streaming::detail::stream_id_type;
+
+#pragma pack(push, 1)
+    struct Entry {
+      stream_id_type stream_id;
+      uint32_t offset;
+      uint32_t size;
+    };
+#pragma pack(pop)
+
+    /// 将组消息拆分为每个传感器的消息，按创建组时传感器的顺序返回。
+    ///
+    /// @throw std::invalid_argument 如果消息格式不正确。
+    static std::vector<std::pair<stream_id_type, Buffer>> Deserialize(const Buffer &message);
+  };
+
+  /// 在服务器端收集一组传感器的数据，所有传感器都送达同一帧后生成一条组消息。
+  ///
+  /// 只保留最近 @a max_pending_frames 个未完成的帧，更旧的帧（例如某个传感器
+  /// 的 sensor_tick 不同，没有产生这一帧的数据）会被丢弃。
+  ///
+  /// 可以在任意线程中调用 Add。
+  class SensorBundleBuilder : private NonCopyable {
+  public:
+
+    using stream_id_type = streaming::detail::stream_id_type;
+
+    explicit SensorBundleBuilder(
+        std::vector<stream_id_type> stream_ids,
+        size_t max_pending_frames = 4u);
+
+    const std::vector<stream_id_type> &GetStreamIds() const {
+      return _stream_ids;
+    }
+
+    bool Contains(stream_id_type stream_id) const;
+
+    /// 复制传感器 @a stream_id 在帧 @a frame 的消息 @a message。
+    ///
+    /// @return 如果该帧已完整，返回组消息的索引和数据两部分。
+    boost::optional<std::pair<Buffer, Buffer>> Add(
+        stream_id_type stream_id,
+        uint64_t frame,
+        const std::vector<boost::asio::const_buffer> &message);
+
+    /// 因未完成而被丢弃的帧数。
+    uint64_t GetDroppedFrames() const;
+
+  private:
+
+    struct PendingFrame {
+      Buffer data;
+      std::vector<SensorBundleSerializer::Entry> entries;
+      std::vector<bool> is_received;
+      size_t received = 0u;
+    };
+
+    size_t IndexOf(stream_id_type stream_id) const;
+
+    const std::vector<stream_id_type> _stream_ids;
+
+    const size_t _max_pending_frames;
+
+    mutable std::mutex _mutex;
+
+    std::map<uint64_t, PendingFrame> _pending;
+
+    /// 上一帧数据的大小，用于预先分配下一帧的缓冲区。
+    size_t _last_frame_size = 0u;
+
+    uint64_t _dropped_frames = 0u;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -9,6 +9,8 @@
 #include "carla/Buffer.h"
 #include "carla/rpc/Transform.h"
 
+#include <cstdint>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
@@ -28,6 +30,35 @@ namespace s11n {
 
     constexpr static auto header_offset = sizeof(Header);
 
+    /// The highest byte of Header::sensor_type stores the compression applied
+    /// to the payload (see CompressionType), the next one the format of the
+    /// payload (see ImageFormat), the rest is the sensor type id.
+    constexpr static uint64_t compression_shift = 56u;
+
+    constexpr static uint64_t payload_format_shift = 48u;
+
+    constexpr static uint64_t sensor_type_mask = (uint64_t(1u) << payload_format_shift) - 1u;
+
+    static uint64_t GetSensorTypeId(const Header &header) {
+      return header.sensor_type & sensor_type_mask;
+    }
+
+    static uint8_t GetCompression(const Header &header) {
+      return static_cast<uint8_t>(header.sensor_type >> compression_shift);
+    }
+
+    static void SetCompression(Header &header, uint8_t compression) {
+      SetByte(header, compression_shift, compression);
+    }
+
+    static uint8_t GetPayloadFormat(const Header &header) {
+      return static_cast<uint8_t>(header.sensor_type >> payload_format_shift);
+    }
+
+    static void SetPayloadFormat(Header &header, uint8_t format) {
+      SetByte(header, payload_format_shift, format);
+    }
+
     static Buffer Serialize(
         uint64_t index,
         uint64_t frame,
@@ -37,6 +68,14 @@ namespace s11n {
     static const Header &Deserialize(const Buffer &message) {
       return *reinterpret_cast<const Header *>(message.data());
     }
+
+  private:
+
+    static void SetByte(Header &header, uint64_t shift, uint8_t value) {
+      header.sensor_type =
+          (header.sensor_type & ~(uint64_t(0xFFu) << shift)) |
+          (static_cast<uint64_t>(value) << shift);
+    }
   };
 
 } // namespace s11n
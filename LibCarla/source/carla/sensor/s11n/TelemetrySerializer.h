@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+#include "carla/sensor/data/TelemetryData.h"
+
+#include <array>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  // ===========================================================================
+  // -- TelemetryHeaderView ----------------------------------------------------
+  // ===========================================================================
+
+  /// 车辆遥测数据头部的视图。
+  class TelemetryHeaderView {
+    using Index = data::TelemetryData::Index;
+
+  public:
+
+    uint32_t GetVehicleCount() const {
+      return _begin[Index::VehicleCount];
+    }
+
+    uint32_t GetVehicleId(size_t vehicle_index) const {
+      DEBUG_ASSERT(vehicle_index < GetVehicleCount());
+      return _begin[Index::SIZE + data::TelemetryData::vehicle_header_size * vehicle_index];
+    }
+
+    uint32_t GetWheelCount(size_t vehicle_index) const {
+      DEBUG_ASSERT(vehicle_index < GetVehicleCount());
+      return _begin[Index::SIZE + data::TelemetryData::vehicle_header_size * vehicle_index + 1u];
+    }
+
+  private:
+
+    friend class TelemetrySerializer;
+
+    explicit TelemetryHeaderView(const uint32_t *begin) : _begin(begin) {
+      DEBUG_ASSERT(_begin != nullptr);
+    }
+
+    const uint32_t *_begin;
+  };
+
+  // ===========================================================================
+  // -- TelemetrySerializer ----------------------------------------------------
+  // ===========================================================================
+
+  /// 序列化车辆遥测传感器的数据：头部为车辆数和每辆车的（参与者 ID，车轮数），
+  /// 之后是每辆车的 VehicleTelemetrySample，最后是所有车轮的 WheelTelemetrySample。
+  class TelemetrySerializer {
+  public:
+
+    static TelemetryHeaderView DeserializeHeader(const RawData &data) {
+      return TelemetryHeaderView{reinterpret_cast<const uint32_t *>(data.begin())};
+    }
+
+    static size_t GetHeaderOffset(const RawData &data) {
+      auto View = DeserializeHeader(data);
+      return sizeof(uint32_t) * (data::TelemetryData::Index::SIZE +
+          data::TelemetryData::vehicle_header_size * View.GetVehicleCount());
+    }
+
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        const data::TelemetryData &data,
+        Buffer &&output);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer TelemetrySerializer::Serialize(
+      const Sensor &,
+      const data::TelemetryData &data,
+      Buffer &&output) {
+    std::array<boost::asio::const_buffer, 3u> seq = {
+        boost::asio::buffer(data._header),
+        boost::asio::buffer(data._vehicles),
+        boost::asio::buffer(data._wheels)};
+    output.copy_from(seq);
+    return std::move(output);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,159 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/VideoStream.h"
+
+#include "carla/Exception.h"
+#include "carla/sensor/s11n/Compression.h"
+#include "carla/sensor/s11n/SensorHeaderSerializer.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  using HeaderSerializer = SensorHeaderSerializer;
+
+  // ===========================================================================
+  // -- DeltaVideoEncoder ------------------------------------------------------
+  // ===========================================================================
+
+  DeltaVideoEncoder::DeltaVideoEncoder(const uint32_t keyframe_interval)
+    : _keyframe_interval(keyframe_interval) {}
+
+  Buffer DeltaVideoEncoder::Encode(
+      const std::vector<boost::asio::const_buffer> &payload,
+      Buffer &&output) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t total = 0u;
+    for (auto &part : payload) {
+      total += boost::asio::buffer_size(part);
+    }
+
+    const bool keyframe =
+        _keyframe_requested ||
+        (total != _previous.size()) ||
+        ((_keyframe_interval > 0u) && (_frames_since_keyframe + 1u >= _keyframe_interval));
+
+    const unsigned char *frame_data = nullptr;
+    if (keyframe) {
+      _previous.resize(total);
+      auto *it = _previous.data();
+      for (auto &part : payload) {
+        const auto size = boost::asio::buffer_size(part);
+        std::memcpy(it, boost::asio::buffer_cast<const unsigned char *>(part), size);
+        it += size;
+      }
+      frame_data = _previous.data();
+    } else {
+      // 与前一帧的差异，同时把当前帧保存为下一帧的参考
+      _delta.resize(total);
+      auto *previous = _previous.data();
+      auto *delta = _delta.data();
+      for (auto &part : payload) {
+        const auto *data = boost::asio::buffer_cast<const unsigned char *>(part);
+        const auto size = boost::asio::buffer_size(part);
+        for (size_t i = 0u; i < size; ++i) {
+          delta[i] = static_cast<unsigned char>(data[i] ^ previous[i]);
+          previous[i] = data[i];
+        }
+        previous += size;
+        delta += size;
+      }
+      frame_data = _delta.data();
+    }
+
+    const VideoFrameHeader frame_header{++_sequence, static_cast<uint8_t>(keyframe ? 1u : 0u)};
+    auto encoded = Compression::Compress(
+        CompressionType::Deflate,
+        {boost::asio::buffer(&frame_header, sizeof(frame_header)),
+         boost::asio::buffer(frame_data, total)},
+        std::move(output));
+    if (encoded.empty()) {
+      // 这一帧不压缩发送，客户端需要新的关键帧
+      _keyframe_requested = true;
+      _frames_since_keyframe = 0u;
+      return encoded;
+    }
+    _keyframe_requested = false;
+    _frames_since_keyframe = keyframe ? 0u : _frames_since_keyframe + 1u;
+    return encoded;
+  }
+
+  void DeltaVideoEncoder::RequestKeyframe() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _keyframe_requested = true;
+  }
+
+  // ===========================================================================
+  // -- DeltaVideoDecoder ------------------------------------------------------
+  // ===========================================================================
+
+  Buffer DeltaVideoDecoder::Decode(Buffer &&message) {
+    constexpr auto header_size = HeaderSerializer::header_offset;
+    constexpr auto size_prefix = sizeof(uint32_t);
+    if ((message.size() < header_size) ||
+        (static_cast<CompressionType>(HeaderSerializer::GetCompression(
+            HeaderSerializer::Deserialize(message))) != CompressionType::Video)) {
+      return std::move(message);
+    }
+    if (message.size() < header_size + size_prefix) {
+      throw_exception(std::runtime_error("invalid video frame"));
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto uncompressed_size = Compression::GetUncompressedSize(message);
+    if (uncompressed_size < sizeof(VideoFrameHeader)) {
+      throw_exception(std::runtime_error("invalid video frame"));
+    }
+    _scratch.resize(uncompressed_size);
+    uLongf destination_size = uncompressed_size;
+    const int result = uncompress(
+        _scratch.data(),
+        &destination_size,
+        message.data() + header_size + size_prefix,
+        static_cast<uLong>(message.size() - header_size - size_prefix));
+    if ((result != Z_OK) || (destination_size != uncompressed_size)) {
+      throw_exception(std::runtime_error("failed to decode video frame"));
+    }
+
+    VideoFrameHeader frame_header;
+    std::memcpy(&frame_header, _scratch.data(), sizeof(frame_header));
+    const auto *frame_data = _scratch.data() + sizeof(frame_header);
+    const size_t frame_size = uncompressed_size - sizeof(frame_header);
+    if (frame_header.keyframe != 0u) {
+      _previous.assign(frame_data, frame_data + frame_size);
+    } else if (
+        !_valid ||
+        (frame_header.sequence != _sequence + 1u) ||
+        (frame_size != _previous.size())) {
+      // 没有参考帧，等待下一个关键帧
+      _valid = false;
+      return Buffer{};
+    } else {
+      for (size_t i = 0u; i < frame_size; ++i) {
+        _previous[i] ^= frame_data[i];
+      }
+    }
+    _valid = true;
+    _sequence = frame_header.sequence;
+
+    auto header = HeaderSerializer::Deserialize(message);
+    HeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::None));
+    // 重用消息的内存
+    message.reset(static_cast<Buffer::size_type>(header_size + frame_size));
+    std::memcpy(message.data(), &header, header_size);
+    std::memcpy(message.data() + header_size, _previous.data(), frame_size);
+    return std::move(message);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,121 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// 视频流中每一帧在负载开头保存的信息。
+#pragma pack(push, 1)
+  struct VideoFrameHeader {
+    /// 帧序号，用于发现丢失的帧。
+    uint32_t sequence;
+
+    /// 关键帧不依赖于之前的帧。
+    uint8_t keyframe;
+  };
+#pragma pack(pop)
+
+  /// 将一个传感器连续的消息编码为视频流（CompressionType::Video），每一帧
+  /// 可以依赖于之前的帧。每个传感器一个编码器，帧必须按发送的顺序编码。
+  class VideoEncoder : private NonCopyable {
+  public:
+
+    virtual ~VideoEncoder() = default;
+
+    /// 编码 @a payload 的各个部分（数据头之后的负载）。
+    ///
+    /// @return 编码后的负载；编码失败时返回空缓冲区，这一帧应当不压缩发送，
+    /// 下一帧将是关键帧。
+    virtual Buffer Encode(
+        const std::vector<boost::asio::const_buffer> &payload,
+        Buffer &&output) = 0;
+
+    /// 下一帧编码为关键帧，例如有新的客户端订阅时。
+    virtual void RequestKeyframe() = 0;
+  };
+
+  /// 解码一个视频流，每个订阅一个解码器，帧必须按到达的顺序解码。
+  class VideoDecoder : private NonCopyable {
+  public:
+
+    virtual ~VideoDecoder() = default;
+
+    /// 解码完整的传感器消息（数据头 + 编码的负载），返回未压缩的消息，其
+    /// 数据头中的压缩标志已清除。在第一个关键帧之前或者丢失了帧之后，到
+    /// 下一个关键帧为止返回空缓冲区。
+    ///
+    /// @throw std::runtime_error 如果数据已损坏。
+    virtual Buffer Decode(Buffer &&message) = 0;
+  };
+
+  /// 内置的无损编码器：关键帧用 deflate 压缩整帧，其余的帧压缩与前一帧逐
+  /// 字节异或的结果，画面中不变的部分几乎不占空间。
+  class DeltaVideoEncoder final : public VideoEncoder {
+  public:
+
+    /// 每 @a keyframe_interval 帧发送一个关键帧，让中途订阅或者丢失了帧的
+    /// 客户端可以恢复；为 0 时只有第一帧和请求的帧是关键帧。
+    explicit DeltaVideoEncoder(uint32_t keyframe_interval);
+
+    Buffer Encode(
+        const std::vector<boost::asio::const_buffer> &payload,
+        Buffer &&output) override;
+
+    void RequestKeyframe() override;
+
+  private:
+
+    std::mutex _mutex;
+
+    const uint32_t _keyframe_interval;
+
+    uint32_t _sequence = 0u;
+
+    uint32_t _frames_since_keyframe = 0u;
+
+    bool _keyframe_requested = true;
+
+    /// 上一帧的负载。
+    std::vector<unsigned char> _previous;
+
+    std::vector<unsigned char> _delta;
+  };
+
+  /// DeltaVideoEncoder 对应的解码器。
+  class DeltaVideoDecoder final : public VideoDecoder {
+  public:
+
+    Buffer Decode(Buffer &&message) override;
+
+  private:
+
+    std::mutex _mutex;
+
+    bool _valid = false;
+
+    uint32_t _sequence = 0u;
+
+    /// 上一帧解码后的负载。
+    std::vector<unsigned char> _previous;
+
+    std::vector<unsigned char> _scratch;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
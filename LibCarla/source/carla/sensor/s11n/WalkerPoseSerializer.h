@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+#include "carla/sensor/data/WalkerPoseData.h"
+
+#include <array>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+namespace s11n {
+
+  // ===========================================================================
+  // -- WalkerPoseHeaderView ---------------------------------------------------
+  // ===========================================================================
+
+  /// 行人位姿数据头部的视图。
+  class WalkerPoseHeaderView {
+    using Index = data::WalkerPoseData::Index;
+
+  public:
+
+    uint32_t GetWalkerCount() const {
+      return _begin[Index::WalkerCount];
+    }
+
+    uint32_t GetWalkerId(size_t walker_index) const {
+      DEBUG_ASSERT(walker_index < GetWalkerCount());
+      return _begin[Index::SIZE + data::WalkerPoseData::walker_header_size * walker_index];
+    }
+
+    uint32_t GetBoneCount(size_t walker_index) const {
+      DEBUG_ASSERT(walker_index < GetWalkerCount());
+      return _begin[Index::SIZE + data::WalkerPoseData::walker_header_size * walker_index + 1u];
+    }
+
+  private:
+
+    friend class WalkerPoseSerializer;
+
+    explicit WalkerPoseHeaderView(const uint32_t *begin) : _begin(begin) {
+      DEBUG_ASSERT(_begin != nullptr);
+    }
+
+    const uint32_t *_begin;
+  };
+
+  // ===========================================================================
+  // -- WalkerPoseSerializer ---------------------------------------------------
+  // ===========================================================================
+
+  /// 序列化行人位姿传感器的数据：头部为行人个数和每个行人的（参与者 ID，
+  /// 骨骼数），之后是所有行人的骨骼，每根骨骼为 6 个 float。
+  class WalkerPoseSerializer {
+  public:
+
+    static WalkerPoseHeaderView DeserializeHeader(const RawData &data) {
+      return WalkerPoseHeaderView{reinterpret_cast<const uint32_t *>(data.begin())};
+    }
+
+    static size_t GetHeaderOffset(const RawData &data) {
+      auto View = DeserializeHeader(data);
+      return sizeof(uint32_t) * (data::WalkerPoseData::Index::SIZE +
+          data::WalkerPoseData::walker_header_size * View.GetWalkerCount());
+    }
+
+    template <typename Sensor>
+    static Buffer Serialize(
+        const Sensor &sensor,
+        const data::WalkerPoseData &data,
+        Buffer &&output);
+
+    static SharedPtr<SensorData> Deserialize(RawData &&data);
+  };
+
+  template <typename Sensor>
+  inline Buffer WalkerPoseSerializer::Serialize(
+      const Sensor &,
+      const data::WalkerPoseData &data,
+      Buffer &&output) {
+    std::array<boost::asio::const_buffer, 2u> seq = {
+        boost::asio::buffer(data._header),
+        boost::asio::buffer(data._bones)};
+    output.copy_from(seq);
+    return std::move(output);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
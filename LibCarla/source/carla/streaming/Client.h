@@ -10,7 +10,9 @@
 #include "carla/ThreadPool.h"// 包含 carla 库中的线程池相关的头文件。
 #include "carla/streaming/Token.h"// 包含 carla 库中流处理相关的令牌（Token）头文件。
 
+#include "carla/streaming/detail/shm/Client.h"// 包含 carla 库中流处理细节中共享内存客户端相关的头文件。
 #include "carla/streaming/detail/tcp/Client.h"// 包含 carla 库中流处理细节中 TCP 客户端相关的头文件。
+#include "carla/streaming/detail/udp/Client.h"// 包含 carla 库中流处理细节中组播客户端相关的头文件。
 #include "carla/streaming/low_level/Client.h"// 包含 carla 库中流处理低层级客户端相关的头文件。
 
 #include <boost/asio/io_context.hpp>// 包含 Boost.Asio 库中的输入输出上下文（io_context）头文件。
@@ -23,13 +25,17 @@ using stream_token = detail::token_type;// 定义别名 stream_token 为 detail
 // 注释：一个能够订阅多个流的客户端。
 class Client {// 定义一个名为 Client 的类。
 using underlying_client = low_level::Client<detail::tcp::Client>;// 定义一个类型别名 underlying_client，表示低层级客户端，该客户端使用 detail::tcp::Client 作为模板参数。
+using underlying_shm_client = low_level::Client<detail::shm::Client>;// 共享内存令牌使用的低层级客户端。
+using underlying_udp_client = low_level::Client<detail::udp::Client>;// 组播令牌使用的低层级客户端。
 
 public:
 
     Client() = default;// 默认构造函数，不进行任何特殊操作。
 
     explicit Client(const std::string &fallback_address)
-      : _client(fallback_address) {}
+      : _client(fallback_address),
+        _shm_client(fallback_address),
+        _udp_client(fallback_address) {}
     // 带有一个字符串参数的构造函数，初始化内部的 _client 对象，传入的参数为备用地址（fallback_address）。
 
     ~Client() {
@@ -40,12 +46,24 @@ public:
     // 警告：不能对同一个流（即使是多流（MultiStream））订阅两次。
     template <typename Functor>
     void Subscribe(const Token &token, Functor &&callback) {
-      _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      if (stream_token(token).protocol_is_shm()) {
+        _shm_client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      } else if (stream_token(token).protocol_is_udp()) {
+        _udp_client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      } else {
+        _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      }
     }
-    // 模板函数，用于订阅一个令牌（Token）对应的流，并传入一个回调函数（Functor），内部调用底层客户端的订阅方法，并传入线程池的输入输出上下文（io_context）、令牌和回调函数。
+    // 模板函数，用于订阅一个令牌（Token）对应的流，并传入一个回调函数（Functor），内部根据令牌的协议调用对应底层客户端的订阅方法，并传入线程池的输入输出上下文（io_context）、令牌和回调函数。
 
     void UnSubscribe(const Token &token) {
-      _client.UnSubscribe(token);
+      if (stream_token(token).protocol_is_shm()) {
+        _shm_client.UnSubscribe(token);
+      } else if (stream_token(token).protocol_is_udp()) {
+        _udp_client.UnSubscribe(token);
+      } else {
+        _client.UnSubscribe(token);
+      }
     }
     // 函数，用于取消订阅一个令牌（Token）对应的流，内部调用底层客户端的取消订阅方法。
 
@@ -67,6 +85,10 @@ private:
 
     underlying_client _client; // 定义一个底层客户端对象 _client。
 
+    underlying_shm_client _shm_client; // 订阅共享内存令牌的底层客户端对象。
+
+    underlying_udp_client _udp_client; // 订阅组播令牌的底层客户端对象。
+
 };
 
 } // namespace streaming
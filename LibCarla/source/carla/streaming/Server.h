@@ -8,10 +8,14 @@
 // 引入所需的头文件
 #include "carla/ThreadPool.h"
 #include "carla/streaming/detail/tcp/Server.h"
+#include "carla/streaming/detail/SessionQueue.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/low_level/Server.h"
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <vector>
 // 定义命名空间
 namespace carla {
 namespace streaming {
@@ -64,13 +68,44 @@ namespace streaming {
       _pool.Run();
     }
 // 异步启动线程池，指定工作线程数量运行服务器。
-    void AsyncRun(size_t worker_threads) {
-      _pool.AsyncRun(worker_threads);
+// @a settings 设置工作线程的 CPU 亲和性和优先级，以免与游戏线程和渲染线程争抢 CPU。
+    void AsyncRun(size_t worker_threads, const ThreadSettings &settings = {}) {
+      _pool.AsyncRun(worker_threads, settings);
     }
 // 设置服务器为同步模式或异步模式。
     void SetSynchronousMode(bool is_synchro) {
       _server.SetSynchronousMode(is_synchro);
     }
+// 设置此后创建的流是否向同一主机上的客户端提供共享内存传输。
+// 需要在创建流之前调用，已创建的流保持原来的协议。
+    void SetSharedMemoryMode(bool enable) {
+      _server.SetSharedMemoryMode(enable);
+    }
+// 设置每个会话发送队列的长度和队列已满时的策略，使较慢的客户端不会影响同一流的其他客户端。
+    void SetSessionQueueSettings(const detail::SessionQueueSettings &settings) {
+      _server.SetSessionQueueSettings(settings);
+    }
+// 设置组播流使用的组播组，需要在启用组播之前调用。
+    void SetMulticastGroup(
+        const std::string &address, uint16_t port,
+        const detail::udp::MulticastSettings &settings = {}) {
+      _server.SetMulticastGroup(
+          boost::asio::ip::udp::endpoint{make_address(address), port},
+          settings);
+    }
+// 通过组播发送指定流 ID 的消息，适用于很多客户端订阅同一个流的情况。
+// 此后该流的令牌指向组播组，已订阅的 TCP 客户端不受影响。
+    bool EnableMulticast(stream_id sensor_id) {
+      return _server.EnableMulticast(sensor_id);
+    }
+
+    void DisableMulticast(stream_id sensor_id) {
+      _server.DisableMulticast(sensor_id);
+    }
+// 获取指定流 ID 的每个会话发送队列的统计信息。
+    std::vector<detail::SessionStatistics> GetSessionStatistics(stream_id sensor_id) {
+      return _server.GetSessionStatistics(sensor_id);
+    }
 // 获取指定流 ID 的令牌。
     token_type GetToken(stream_id sensor_id) {
       return _server.GetToken(sensor_id);
@@ -107,6 +107,29 @@ namespace detail {
     }
   }
   
+  bool Dispatcher::EnableMulticast(
+      stream_id_type sensor_id,
+      std::shared_ptr<udp::MulticastSender> sender) {
+    DEBUG_ASSERT(sender != nullptr);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto search = _stream_map.find(sensor_id);
+    if (search == _stream_map.end()) {
+      log_error("Cannot enable multicast: no stream available with id", sensor_id);
+      return false;
+    }
+    log_debug("Enabling multicast for stream ", sensor_id);
+    search->second->EnableMulticast(std::move(sender));
+    return true;
+  }
+
+  void Dispatcher::DisableMulticast(stream_id_type sensor_id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto search = _stream_map.find(sensor_id);
+    if (search != _stream_map.end()) {
+      search->second->DisableMulticast();
+    }
+  }
+
   token_type Dispatcher::GetToken(stream_id_type sensor_id) {
     std::lock_guard<std::mutex> lock(_mutex);
     log_debug("Searching sensor id: ", sensor_id);
@@ -116,7 +139,7 @@ namespace detail {
       auto stream_state = search->second;
       stream_state->ForceActive();
       log_debug("Getting token from stream ", sensor_id, " on port ", stream_state->token().get_port());
-      return stream_state->token();
+      return stream_state->GetSubscriptionToken();
     } else {
       
       // 如果没有找到，创建新的传感器流
@@ -11,10 +11,12 @@
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Stream.h"
 #include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/udp/MulticastSender.h"
 
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 // carla 命名空间
 namespace carla {
 // streaming 子命名空间
@@ -67,6 +69,27 @@ namespace detail {
       }
       return false;
     }
+// 获取指定流的每个会话发送队列的统计信息，流不存在时返回空列表
+    std::vector<SessionStatistics> GetSessionStatistics(stream_id_type sensor_id) {
+      std::shared_ptr<MultiStreamState> stream;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto search = _stream_map.find(sensor_id);
+        if (search != _stream_map.end()) {
+          stream = search->second;
+        }
+      }
+      return (stream != nullptr) ? stream->GetSessionStatistics() : std::vector<SessionStatistics>{};
+    }
+// 通过组播发送指定流的消息，此后 GetToken 返回组播组的令牌。流不存在时返回 false
+    bool EnableMulticast(stream_id_type sensor_id, std::shared_ptr<udp::MulticastSender> sender);
+// 停止通过组播发送指定流的消息
+    void DisableMulticast(stream_id_type sensor_id);
+// 设置此后创建的流是否向同一主机上的客户端提供共享内存传输
+    void SetSharedMemoryMode(bool enable) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _cached_token.set_shared_memory(enable);
+    }
 
   private:
 
@@ -10,13 +10,17 @@
 // 用于原子性的共享指针操作
 #include "carla/Logging.h"
 // 用于日志记录
+#include "carla/streaming/detail/SessionQueue.h"
 #include "carla/streaming/detail/StreamStateBase.h"
 // 基类，可能提供了一些基本的流状态管理功能
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/udp/MulticastSender.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
-#include <atomic>
 
 namespace carla {
 namespace streaming {
@@ -24,43 +28,48 @@ namespace detail {
 
   /// A stream state that can hold any number of sessions.
   ///
-  /// @todo Lacking some optimization.
+  /// 会话列表是一个不可变的快照，由 AtomicSharedPtr 持有。连接和断开会话时
+  /// 复制列表并以原子操作替换快照（写时复制），因此每帧的写入路径不需要加锁。
+  ///
+  /// 启用组播时，每条消息还通过组播发送一次，订阅组播令牌的客户端不建立会话。
+  ///
+  /// @warning 仅快照的读取是原子的，对列表的修改由互斥量锁定。
   class MultiStreamState final : public StreamStateBase {
+    using SessionList = std::vector<std::shared_ptr<Session>>;
   public:
  // 调用基类的构造函数
     using StreamStateBase::StreamStateBase;
- // 构造函数，接受一个 token 并初始化成员变量
+ // 构造函数，接受一个 token
     MultiStreamState(const token_type &token) :
-      StreamStateBase(token),
-      _session(nullptr)
+      StreamStateBase(token)
       {};
 // 模板函数，用于写入数据到流中
     template <typename... Buffers>
     void Write(Buffers... buffers) {
-      // try write single stream
-      auto session = _session.load();
-      if (session != nullptr) {
-		  // 创建消息并写入单个会话
-        auto message = Session::MakeMessage(buffers...);
-        session->Write(std::move(message));
-        log_debug("sensor ", session->get_stream_id()," data sent");
-        // Return here, _session is only valid if we have a
-        // single session.
+      auto sessions = _sessions.load();
+      auto multicast = _multicast.load();
+      if (sessions->empty() && (multicast == nullptr)) {
         return;
       }
-
-      // try write multiple stream
-      std::lock_guard<std::mutex> lock(_mutex);
-      if (_sessions.size() > 0) {
-		  // 创建消息并写入多个会话
-        auto message = Session::MakeMessage(buffers...);
-        for (auto &s : _sessions) {
-          if (s != nullptr) {
-            s->Write(message);
-            log_debug("sensor ", s->get_stream_id()," data sent ");
-         }
+      // 创建消息，所有会话共享同一条消息
+      auto message = Session::MakeMessage(buffers...);
+      _messages_written->Increment();
+      _bytes_written->Increment(message->size());
+      if (multicast != nullptr) {
+        multicast->Send(token().get_stream_id(), ++_multicast_sequence, *message);
+        if (sessions->empty()) {
+          return;
         }
       }
+      if (sessions->size() == 1u) {
+        sessions->front()->Write(std::move(message));
+        log_debug("sensor ", sessions->front()->get_stream_id()," data sent");
+        return;
+      }
+      for (auto &s : *sessions) {
+        s->Write(message);
+        log_debug("sensor ", s->get_stream_id()," data sent ");
+      }
     }
  // 设置强制激活标志
     void ForceActive() {
@@ -80,74 +89,114 @@ namespace detail {
     }
  // 检查是否有客户端正在监听流
     bool AreClientsListening() {
-      return (_sessions.size() > 0 || _force_active || _enabled_for_ros);
+      return (!_sessions.load()->empty() || _force_active || _enabled_for_ros || IsMulticastEnabled());
+    }
+// 通过组播发送此后写入的消息。无法知道有多少客户端加入了组播组，因此启用后流一直被视为活动的
+    void EnableMulticast(std::shared_ptr<udp::MulticastSender> sender) {
+      DEBUG_ASSERT(sender != nullptr);
+      _multicast.store(std::move(sender));
+    }
+
+    void DisableMulticast() {
+      _multicast.store(nullptr);
+    }
+
+    bool IsMulticastEnabled() const {
+      return _multicast.load() != nullptr;
+    }
+// 客户端订阅此流使用的令牌：启用组播时为组播组的 UDP 令牌，否则为流的令牌
+    token_type GetSubscriptionToken() const {
+      auto multicast = _multicast.load();
+      if (multicast == nullptr) {
+        return token();
+      }
+      token_data data;
+      data.stream_id = token().get_stream_id();
+      data.port = multicast->GetGroup().port();
+      data.protocol = token_data::protocol::udp;
+      token_type result{data};
+      result.set_address(multicast->GetGroup().address());
+      return result;
     }
 // 连接一个新的会话
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
-	  // 将新会话添加到会话列表中
-      _sessions.emplace_back(std::move(session));
-      log_debug("Connecting multistream sessions:", _sessions.size());
-      if (_sessions.size() == 1) {
-		  // 如果只有一个会话，设置 _session 指向这个会话
-        _session.store(_sessions[0]);
-      }
-      else if (_sessions.size() > 1) {
-		  // 如果有多个会话，设置 _session 为空指针
-        _session.store(nullptr);
-      }
+      // 复制当前列表并添加新会话
+      auto new_list = std::make_shared<SessionList>(*_sessions.load());
+      new_list->emplace_back(std::move(session));
+      log_debug("Connecting multistream sessions:", new_list->size());
+      _sessions.store(std::move(new_list));
     }
 // 断开一个会话
     void DisconnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
       log_debug("Calling DisconnectSession for ", session->get_stream_id());
-      if (_sessions.size() == 0) return;
-      if (_sessions.size() == 1) {
-        DEBUG_ASSERT(session == _session.load());
-        _session.store(nullptr);
-        _sessions.clear();
+      auto current = _sessions.load();
+      if (current->empty()) return;
+      // 复制当前列表并移除指定的会话
+      auto new_list = std::make_shared<SessionList>(*current);
+      new_list->erase(
+          std::remove(new_list->begin(), new_list->end(), session),
+          new_list->end());
+      if (new_list->empty()) {
         _force_active = false;
         log_debug("Last session disconnected");
-      } else {
-		   // 从会话列表中移除指定的会话
-        _sessions.erase(
-            std::remove(_sessions.begin(), _sessions.end(), session),
-            _sessions.end());
-
-        // set single session if only one
-        if (_sessions.size() == 1)
-          _session.store(_sessions[0]);
-        else
-          _session.store(nullptr);
       }
-      log_debug("Disconnecting multistream sessions:", _sessions.size());
+      log_debug("Disconnecting multistream sessions:", new_list->size());
+      _sessions.store(std::move(new_list));
+    }
+// 返回每个已连接会话发送队列的统计信息
+    std::vector<SessionStatistics> GetSessionStatistics() {
+      auto sessions = _sessions.load();
+      std::vector<SessionStatistics> result;
+      result.reserve(sessions->size());
+      for (auto &s : *sessions) {
+        result.emplace_back(s->GetStatistics());
+      }
+      return result;
     }
 // 清空所有的会话
     void ClearSessions() final {
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &s : _sessions) {
-        if (s != nullptr) {
-          s->Close();
-        }
+      std::shared_ptr<const SessionList> sessions;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        sessions = _sessions.load();
+        _sessions.store(std::make_shared<const SessionList>());
+        _force_active = false;
+      }
+      for (auto &s : *sessions) {
+        s->Close();
       }
-      _sessions.clear();
-      _force_active = false;
-      _session.store(nullptr);
       log_debug("Disconnecting all multistream sessions");
     }
 
   private:
 
+    // 仅用于串行化对会话列表的修改，写入路径不使用
     std::mutex _mutex;
 
-    // if there is only one session, then we use atomic
-    AtomicSharedPtr<Session> _session;
-    // if there are more than one session, we use vector of sessions with mutex
-    std::vector<std::shared_ptr<Session>> _sessions;
-    bool _force_active {false};
-    bool _enabled_for_ros {false};
+    // 当前会话列表的快照
+    AtomicSharedPtr<const SessionList> _sessions{std::make_shared<const SessionList>()};
+
+    std::atomic_bool _force_active {false};
+
+    std::atomic_bool _enabled_for_ros {false};
+
+    AtomicSharedPtr<udp::MulticastSender> _multicast;
+
+    /// 组播消息的序号，0 保留给尚未发送消息的状态。
+    std::atomic<uint32_t> _multicast_sequence {0u};
+
+    /// 有接收者时写入的消息，每条消息只计一次，与会话数无关。
+    const std::shared_ptr<profiler::Counter> _messages_written = MakeStreamCounter(
+        "carla_streaming_messages_written_total",
+        "Messages written to a stream that had listeners.");
+
+    const std::shared_ptr<profiler::Counter> _bytes_written = MakeStreamCounter(
+        "carla_streaming_bytes_written_total",
+        "Bytes written to a stream that had listeners, excluding the message header.");
   };
 
 } // namespace detail
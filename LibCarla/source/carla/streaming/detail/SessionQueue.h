@@ -0,0 +1,57 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Time.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// 会话的发送队列已满时采取的策略。
+  enum class OverflowPolicy : uint8_t {
+    /// 丢弃新到达的消息。
+    DropNewest,
+    /// 丢弃队列中最旧的消息，为新消息腾出空间。
+    DropOldest,
+    /// 新消息在会话中等待队列有空间，超时后丢弃；不会阻塞写入线程。
+    Block
+  };
+
+  /// 每个会话发送队列的配置。
+  ///
+  /// 队列深度不包括正在发送的消息，因此默认配置（深度为 0，丢弃新消息）即
+  /// 在上一条消息发送完毕前丢弃所有新消息。同步模式下总是按 Block 处理，
+  /// 以保证每一帧都被送达。
+  struct SessionQueueSettings {
+    OverflowPolicy policy = OverflowPolicy::DropNewest;
+    /// 等待发送的消息的最大数量。
+    size_t max_depth = 0u;
+    /// Block 策略的最长等待时间，0 表示使用会话的超时时间。
+    time_duration timeout = time_duration::milliseconds(0u);
+  };
+
+  /// 单个会话发送队列的统计信息。
+  struct SessionStatistics {
+    /// 当前等待发送的消息数量。
+    size_t queue_depth = 0u;
+    /// 按 Block 策略等待进入队列的消息数量。
+    size_t waiting_messages = 0u;
+    /// 会话开始以来队列达到的最大深度。
+    size_t max_queue_depth = 0u;
+    /// 成功发送的消息数量。
+    uint64_t sent_messages = 0u;
+    /// 因队列已满而丢弃的消息数量。
+    uint64_t dropped_messages = 0u;
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -12,12 +12,51 @@ namespace carla {
 namespace streaming {
 namespace detail {
 
+  static profiler::MetricLabels MakeStreamLabels(const token_type &token) {
+    return {{"stream", std::to_string(token.get_stream_id())}};
+  }
+
   StreamStateBase::StreamStateBase(const token_type &token)
     : _token(token),
-      _buffer_pool(std::make_shared<BufferPool>()) {}
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _buffer_pool_metrics(profiler::MetricsRegistry::Get().AddCollector(
+          [pool = std::weak_ptr<BufferPool>(_buffer_pool), labels = MakeStreamLabels(token)](
+              profiler::MetricsRegistry::Writer &writer) {
+        auto buffer_pool = pool.lock();
+        if (buffer_pool == nullptr) {
+          return;
+        }
+        const auto statistics = buffer_pool->GetStatistics();
+        writer.AddCounter(
+            "carla_buffer_pool_hits_total",
+            "Buffers taken from a stream's buffer pool that were reused.",
+            labels,
+            static_cast<double>(statistics.hits));
+        writer.AddCounter(
+            "carla_buffer_pool_misses_total",
+            "Buffers taken from a stream's buffer pool that had to be allocated.",
+            labels,
+            static_cast<double>(statistics.misses));
+        writer.AddCounter(
+            "carla_buffer_pool_reallocations_total",
+            "Reused buffers that had to grow.",
+            labels,
+            static_cast<double>(statistics.reallocations));
+        writer.AddGauge(
+            "carla_buffer_pool_idle_bytes",
+            "Capacity of the idle buffers in a stream's buffer pool.",
+            labels,
+            static_cast<double>(statistics.idle_bytes));
+      })) {}
 
   StreamStateBase::~StreamStateBase() = default;
 
+  std::shared_ptr<profiler::Counter> StreamStateBase::MakeStreamCounter(
+      const std::string &name,
+      const std::string &help) const {
+    return profiler::MetricsRegistry::Get().GetCounter(name, help, MakeStreamLabels(_token));
+  }
+
   Buffer StreamStateBase::MakeBuffer() {
     auto pool = _buffer_pool;
     return pool->Pop();
@@ -10,6 +10,7 @@
  * @brief 包含StreamStateBase类的定义，它是流状态的基础类。
  */
 #include "carla/NonCopyable.h"
+#include "carla/profiler/Metrics.h"
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
 
@@ -80,6 +81,11 @@ namespace detail {
      */
     virtual void ClearSessions() = 0;
 
+  protected:
+
+    /// 带有本流标签的计数器，随流一起销毁。
+    std::shared_ptr<profiler::Counter> MakeStreamCounter(const std::string &name, const std::string &help) const;
+
   private:
       /**
      * @brief 用于初始化对象的令牌。
@@ -89,6 +95,9 @@ namespace detail {
      * @brief 指向缓冲区池的共享指针，用于管理缓冲区。
      */
     const std::shared_ptr<BufferPool> _buffer_pool;
+
+    /// 导出缓冲区池的统计信息，随流一起注销。
+    const std::shared_ptr<const profiler::MetricsRegistry::Collector> _buffer_pool_metrics;
   };
 
 } // namespace detail
@@ -49,7 +49,8 @@ namespace detail {
     enum class protocol : uint8_t {
       not_set,///< 未设置协议
       tcp,///< TCP协议
-      udp ///< UDP协议
+      udp,///< UDP协议
+      shm ///< 共享内存（同一主机上的客户端），使用TCP端点作为控制通道
     } protocol = protocol::not_set;
     /**
     * @brief 地址类型枚举，指示IP地址的版本。
@@ -280,6 +281,25 @@ namespace detail {
       return _token.protocol == token_data::protocol::tcp;
     }
     /**
+ * @brief 检查协议是否为共享内存。
+ *
+ * @return 如果协议是共享内存，则返回true；否则返回false。
+ */
+    bool protocol_is_shm() const {
+      return _token.protocol == token_data::protocol::shm;
+    }
+    /**
+ * @brief 在TCP与共享内存协议之间切换。
+ *
+ * 共享内存令牌与TCP令牌使用相同的端点，该端点用作控制通道。
+ *
+ * @param enable 为true时使用共享内存协议，否则使用TCP协议。
+ */
+    void set_shared_memory(bool enable) {
+      DEBUG_ASSERT(!protocol_is_udp());
+      _token.protocol = enable ? token_data::protocol::shm : token_data::protocol::tcp;
+    }
+    /**
  * @brief 检查是否具有相同的协议。
  *
  * 比较当前令牌的协议与给定端点的协议。
@@ -0,0 +1,115 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Client.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/streaming/detail/shm/Protocol.h"
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      callback_function_type callback)
+    : _io_context(io_context),
+      _token(token),
+      _callback(std::move(callback)),
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    if (!_token.protocol_is_shm()) {
+      throw_exception(std::invalid_argument("invalid token, only shared memory tokens supported"));
+    }
+  }
+
+  Client::~Client() = default;
+
+  void Client::Connect() {
+    // 控制通道是一个普通的 TCP 连接，握手时发送带有请求标志位的流 ID。
+    token_type control_token = _token;
+    control_token.set_shared_memory(false);
+    control_token.set_stream_id(_token.get_stream_id() | SHARED_MEMORY_REQUEST_FLAG);
+
+    std::weak_ptr<Client> weak = shared_from_this();
+    _control = std::make_shared<tcp::Client>(
+        _io_context,
+        control_token,
+        [weak](Buffer notification) {
+          auto self = weak.lock();
+          if (self) {
+            self->OnNotification(std::move(notification));
+          }
+        });
+    _control->Connect();
+  }
+
+  void Client::Stop() {
+    if (_control != nullptr) {
+      _control->Stop();
+    }
+  }
+
+  void Client::OnNotification(Buffer message) {
+    if (message.size() < sizeof(Notification)) {
+      log_warning("streaming client: invalid shared memory notification of", message.size(), "bytes");
+      return;
+    }
+    Notification notification;
+    std::memcpy(&notification, message.data(), sizeof(notification));
+
+    if (notification.kind == Notification::Kind::Inline) {
+      if (message.size() != sizeof(notification) + notification.size) {
+        log_warning("streaming client: invalid inline message size");
+        return;
+      }
+      auto buffer = _buffer_pool->Pop(notification.size);
+      buffer.copy_from(message.data() + sizeof(notification), notification.size);
+      _callback(std::move(buffer));
+      return;
+    }
+
+    notification.segment[MAX_SEGMENT_NAME_LENGTH - 1u] = '\0';
+    if (notification.slot >= _slots.size()) {
+      _slots.resize(notification.slot + 1u);
+    }
+    auto &memory = _slots[notification.slot];
+    if ((memory == nullptr) || (memory->name() != notification.segment)) {
+      memory = SharedMemory::Open(notification.segment);
+    }
+    if ((memory == nullptr) || (memory->size() < SLOT_DATA_OFFSET + notification.size)) {
+      log_warning("streaming client: shared memory slot not available, message discarded");
+      return;
+    }
+
+    // 顺序锁读取：复制前后的序号都必须与通知中的一致，否则该槽已被覆盖。
+    const auto *header = reinterpret_cast<const SlotHeader *>(memory->data());
+    if (header->sequence.load(std::memory_order_acquire) != notification.sequence) {
+      log_debug("streaming client: connection too slow: shared memory message discarded");
+      return;
+    }
+    auto buffer = _buffer_pool->Pop(notification.size);
+    buffer.copy_from(memory->data() + SLOT_DATA_OFFSET, notification.size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->sequence.load(std::memory_order_relaxed) != notification.sequence) {
+      log_debug("streaming client: connection too slow: shared memory message discarded");
+      return;
+    }
+    _callback(std::move(buffer));
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
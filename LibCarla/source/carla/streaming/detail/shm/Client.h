@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/SharedMemory.h"
+#include "carla/streaming/detail/tcp/Client.h"
+
+#include <boost/asio/io_context.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 通过共享内存订阅流的客户端。
+  ///
+  /// 使用一个 tcp::Client 作为控制通道接收服务器的通知，消息数据从服务器
+  /// 创建的共享内存槽中读取（以只读方式映射）。数据不经过套接字，但仍然在
+  /// 顺序锁的保护下复制到一个缓冲区中再交给回调，因为槽之后会被覆盖。
+  /// 段只对服务器进程的用户可读，其他用户的客户端无法打开并丢弃消息。
+  /// 如果服务器判断客户端不在同一主机上，数据会直接附加在通知之后，此时的
+  /// 行为与 tcp::Client 相同。
+  class Client
+    : public std::enable_shared_from_this<Client>,
+      private NonCopyable {
+  public:
+
+    using endpoint = tcp::Client::endpoint;
+    using protocol_type = tcp::Client::protocol_type;
+    using callback_function_type = tcp::Client::callback_function_type;
+
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback);
+
+    ~Client();
+
+    void Connect();
+
+    stream_id_type GetStreamId() const {
+      return _token.get_stream_id();
+    }
+
+    void Stop();
+
+  private:
+
+    /// 处理控制通道上收到的一条通知，在控制通道的 strand 中调用。
+    void OnNotification(Buffer notification);
+
+    boost::asio::io_context &_io_context;
+
+    const token_type _token;
+
+    callback_function_type _callback;
+
+    std::shared_ptr<tcp::Client> _control;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    /// 按槽编号索引的已映射共享内存段。
+    std::vector<std::unique_ptr<SharedMemory>> _slots;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
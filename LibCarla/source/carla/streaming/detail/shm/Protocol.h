@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+/// @file
+/// @brief 共享内存流传输的线路协议定义。
+///
+/// 共享内存传输仍然使用 TCP 连接作为控制通道：客户端连接后发送带有
+/// SHARED_MEMORY_REQUEST_FLAG 标志位的流 ID，之后服务器发送的每一帧都以
+/// Notification 开头。数据本身写入一组共享内存槽中，客户端以只读方式映射。
+
+#include "carla/streaming/detail/Types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 客户端在握手时将此标志位与流 ID 合并，请求使用共享内存传输。
+  constexpr stream_id_type SHARED_MEMORY_REQUEST_FLAG = 1u << 31u;
+
+  /// 共享内存段名称的最大长度（包括结尾的 '\0'）。
+  constexpr size_t MAX_SEGMENT_NAME_LENGTH = 64u;
+
+  /// 每个共享内存槽的头部，位于槽的起始位置。
+  ///
+  /// @a sequence 作为顺序锁（seqlock）使用：写入过程中为奇数，写入完成后为
+  /// 偶数。客户端复制数据前后各读取一次，若两次的值与通知中的不一致，则说明
+  /// 该槽在读取过程中已被覆盖，此帧被丢弃。
+  struct SlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint64_t size;
+  };
+
+  static_assert(
+      ATOMIC_LLONG_LOCK_FREE == 2,
+      "shared memory transport requires lock-free 64-bit atomics");
+
+  /// 数据在共享内存中所占用的字节偏移量。
+  constexpr size_t SLOT_DATA_OFFSET = sizeof(SlotHeader);
+
+  /// 一个会话最多的共享内存槽数量，由通知中槽编号的宽度决定。
+  constexpr size_t MAX_NUMBER_OF_SLOTS = 256u;
+
+#pragma pack(push, 1)
+  /// 服务器通过控制通道为每条消息发送的通知。
+  struct Notification {
+    enum class Kind : uint8_t {
+      /// 消息数据紧跟在通知之后（无法使用共享内存时的回退方式）。
+      Inline,
+      /// 消息数据位于名为 @a segment 的共享内存槽中。
+      Slot
+    } kind;
+    uint8_t slot;
+    uint64_t sequence;
+    message_size_type size;
+    char segment[MAX_SEGMENT_NAME_LENGTH];
+  };
+#pragma pack(pop)
+
+  static_assert(
+      MAX_NUMBER_OF_SLOTS - 1u <= std::numeric_limits<decltype(Notification::slot)>::max(),
+      "slot numbers do not fit in the notification");
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,114 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Publisher.h"
+
+#include "carla/BufferView.h"
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 槽的容量按此粒度向上取整，避免图像尺寸的微小变化导致频繁重新创建。
+  static constexpr size_t SLOT_GRANULARITY = 1u << 20u;
+
+  static Notification MakeNotification(Notification::Kind kind, message_size_type size) {
+    Notification notification;
+    std::memset(&notification, 0, sizeof(notification));
+    notification.kind = kind;
+    notification.size = size;
+    return notification;
+  }
+
+  static std::shared_ptr<const tcp::Message> MakeMessage(Buffer &&buffer) {
+    return std::make_shared<const tcp::Message>(BufferView::CreateFrom(std::move(buffer)));
+  }
+
+  /// 将 @a message 中的数据（不包括长度前缀）复制到 @a destination。
+  static void CopyPayload(const tcp::Message &message, unsigned char *destination) {
+    auto sequence = message.GetBufferSequence();
+    for (auto it = sequence.begin() + 1u; it != sequence.end(); ++it) {
+      const auto size = boost::asio::buffer_size(*it);
+      std::memcpy(destination, it->data(), size);
+      destination += size;
+    }
+  }
+
+  Publisher::Publisher(std::string prefix, const size_t number_of_slots)
+    : _prefix(std::move(prefix)),
+      _slots(number_of_slots) {
+    if ((number_of_slots == 0u) || (number_of_slots > MAX_NUMBER_OF_SLOTS)) {
+      throw_exception(std::invalid_argument(
+          "shared memory publisher: number of slots must be between 1 and " +
+          std::to_string(MAX_NUMBER_OF_SLOTS)));
+    }
+  }
+
+  SharedMemory *Publisher::Reserve(const size_t index, const size_t size) {
+    auto &slot = _slots[index];
+    if ((slot.memory == nullptr) || (slot.memory->size() < size)) {
+      const auto capacity = ((size + SLOT_GRANULARITY - 1u) / SLOT_GRANULARITY) * SLOT_GRANULARITY;
+      const auto name =
+          _prefix + "-" + std::to_string(index) + "-" + std::to_string(++slot.generation);
+      // 旧的段在此被解除链接，已映射它的客户端在重新映射前仍可安全读取。
+      slot.memory = SharedMemory::Create(name, capacity);
+      if (slot.memory == nullptr) {
+        return nullptr;
+      }
+      new (slot.memory->data()) SlotHeader();
+    }
+    return slot.memory.get();
+  }
+
+  std::shared_ptr<const tcp::Message> Publisher::Publish(const tcp::Message &message) {
+    const auto index = _next_slot;
+    auto *memory = Reserve(index, SLOT_DATA_OFFSET + message.size());
+    if (memory == nullptr) {
+      return MakeInline(message);
+    }
+    _next_slot = (_next_slot + 1u) % _slots.size();
+
+    // 顺序锁：写入期间序号为奇数，写入完成后为偶数。
+    auto *header = reinterpret_cast<SlotHeader *>(memory->data());
+    const uint64_t sequence = (_sequence += 2u);
+    header->sequence.store(sequence - 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    CopyPayload(message, memory->data() + SLOT_DATA_OFFSET);
+    header->size = message.size();
+    header->sequence.store(sequence, std::memory_order_release);
+
+    auto notification = MakeNotification(Notification::Kind::Slot, message.size());
+    notification.slot = static_cast<uint8_t>(index);
+    notification.sequence = sequence;
+    std::strncpy(notification.segment, memory->name().c_str(), MAX_SEGMENT_NAME_LENGTH - 1u);
+    return MakeMessage(Buffer(
+        reinterpret_cast<const unsigned char *>(&notification),
+        sizeof(notification)));
+  }
+
+  std::shared_ptr<const tcp::Message> Publisher::MakeInline(const tcp::Message &message) {
+    const auto notification = MakeNotification(Notification::Kind::Inline, message.size());
+    Buffer buffer;
+    buffer.reset(static_cast<uint64_t>(sizeof(notification) + message.size()));
+    std::memcpy(buffer.data(), &notification, sizeof(notification));
+    CopyPayload(message, buffer.data() + sizeof(notification));
+    return MakeMessage(std::move(buffer));
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
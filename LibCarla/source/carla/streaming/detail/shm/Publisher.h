@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/shm/Protocol.h"
+#include "carla/streaming/detail/shm/SharedMemory.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 服务器端的共享内存写入器，每个使用共享内存传输的会话拥有一个。
+  ///
+  /// 消息依次写入一个由若干槽组成的环中，每个槽是一个独立的共享内存段。
+  /// 当消息大于槽的容量时，该槽会以新的名称重新创建，客户端根据通知中的
+  /// 段名称重新映射。客户端落后超过一整圈时，被覆盖的帧会被客户端丢弃。
+  ///
+  /// @warning 此类不是线程安全的，调用者需要保证 Publish 串行调用。
+  class Publisher : private NonCopyable {
+  public:
+
+    /// @param prefix 用于生成各槽共享内存段名称的前缀，见 SharedMemory::MakePrefix。
+    /// @param number_of_slots 环中槽的数量，为 1 到 MAX_NUMBER_OF_SLOTS，否则
+    /// 抛出 std::invalid_argument。
+    explicit Publisher(std::string prefix, size_t number_of_slots = 3u);
+
+    /// 将 @a message 的内容写入下一个槽，并返回需要通过控制通道发送的通知。
+    /// 如果无法分配共享内存，则退化为 MakeInline。
+    std::shared_ptr<const tcp::Message> Publish(const tcp::Message &message);
+
+    /// 返回一个将 @a message 的内容直接附加在通知之后的消息，用于客户端不在
+    /// 本机或平台不支持共享内存的情况。
+    static std::shared_ptr<const tcp::Message> MakeInline(const tcp::Message &message);
+
+  private:
+
+    struct Slot {
+      std::unique_ptr<SharedMemory> memory;
+      uint32_t generation = 0u;
+    };
+
+    /// 确保槽 @a index 至少有 @a size 字节，返回 nullptr 表示分配失败。
+    SharedMemory *Reserve(size_t index, size_t size);
+
+    const std::string _prefix;
+
+    std::vector<Slot> _slots;
+
+    size_t _next_slot = 0u;
+
+    uint64_t _sequence = 0u;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
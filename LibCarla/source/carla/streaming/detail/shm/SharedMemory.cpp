@@ -0,0 +1,129 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/SharedMemory.h"
+
+#include "carla/Logging.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif // _WIN32
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+#ifndef _WIN32
+
+  static std::string ErrorString(const char *what, const std::string &name) {
+    return std::string(what) + " '" + name + "': " + std::strerror(errno);
+  }
+
+  bool SharedMemory::IsSupported() {
+    return true;
+  }
+
+  std::string SharedMemory::MakePrefix(const uint16_t port, const size_t session_id) {
+    return "/carla-" + std::to_string(::getpid()) + "-" +
+        std::to_string(port) + "-" + std::to_string(session_id);
+  }
+
+  std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string &name, const size_t size) {
+    // 段只由服务器写入，客户端只需要读权限；只允许同一用户的客户端读取。
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if ((fd < 0) && (errno == EEXIST)) {
+      // 名称包含本进程的 pid，已存在的段是之前使用同一 pid 的进程崩溃后留下的
+      log_debug("removing stale shared memory", name);
+      ::shm_unlink(name.c_str());
+      fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+      log_warning(ErrorString("failed to create shared memory", name));
+      return nullptr;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      log_warning(ErrorString("failed to resize shared memory", name));
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      return nullptr;
+    }
+    void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      log_warning(ErrorString("failed to map shared memory", name));
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      return nullptr;
+    }
+    ::close(fd);
+    log_debug("shared memory", name, "created,", size, "bytes");
+    return std::unique_ptr<SharedMemory>(
+        new SharedMemory(name, static_cast<unsigned char *>(data), size, true));
+  }
+
+  std::unique_ptr<SharedMemory> SharedMemory::Open(const std::string &name) {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      log_warning(ErrorString("failed to open shared memory", name));
+      return nullptr;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      log_warning(ErrorString("failed to query shared memory", name));
+      ::close(fd);
+      return nullptr;
+    }
+    const auto size = static_cast<size_t>(info.st_size);
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      log_warning(ErrorString("failed to map shared memory", name));
+      ::close(fd);
+      return nullptr;
+    }
+    ::close(fd);
+    return std::unique_ptr<SharedMemory>(
+        new SharedMemory(name, static_cast<unsigned char *>(data), size, false));
+  }
+
+  SharedMemory::~SharedMemory() {
+    ::munmap(_data, _size);
+    if (_owner) {
+      ::shm_unlink(_name.c_str());
+    }
+  }
+
+#else
+
+  bool SharedMemory::IsSupported() {
+    return false;
+  }
+
+  std::string SharedMemory::MakePrefix(uint16_t, size_t) {
+    return {};
+  }
+
+  std::unique_ptr<SharedMemory> SharedMemory::Create(const std::string &, size_t) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedMemory> SharedMemory::Open(const std::string &) {
+    return nullptr;
+  }
+
+  SharedMemory::~SharedMemory() = default;
+
+#endif // _WIN32
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
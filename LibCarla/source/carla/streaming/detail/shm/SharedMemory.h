@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 一个映射到本进程地址空间的 POSIX 命名共享内存段。
+  ///
+  /// 由 Create 创建的段可读写，并在对象销毁时解除链接（unlink）；由 Open
+  /// 打开的段以只读方式映射。已映射的内存在段被解除链接后仍然有效，直到
+  /// 对象销毁为止。
+  class SharedMemory : private NonCopyable {
+  public:
+
+    /// 当前平台是否支持共享内存传输。
+    static bool IsSupported();
+
+    /// 服务器会话 @a session_id 的段名称前缀。包含进程的 pid，服务器崩溃后
+    /// 留下的段不会与使用同一端口的新服务器冲突。
+    static std::string MakePrefix(uint16_t port, size_t session_id);
+
+    /// 创建名为 @a name、大小为 @a size 字节的共享内存段。
+    ///
+    /// @return 如果无法创建或映射该段则返回 nullptr。
+    static std::unique_ptr<SharedMemory> Create(const std::string &name, size_t size);
+
+    /// 以只读方式打开已存在的共享内存段。
+    ///
+    /// @return 如果无法打开或映射该段则返回 nullptr。
+    static std::unique_ptr<SharedMemory> Open(const std::string &name);
+
+    ~SharedMemory();
+
+    const std::string &name() const {
+      return _name;
+    }
+
+    unsigned char *data() {
+      return _data;
+    }
+
+    const unsigned char *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    SharedMemory(std::string name, unsigned char *data, size_t size, bool owner)
+      : _name(std::move(name)),
+        _data(data),
+        _size(size),
+        _owner(owner) {}
+
+    const std::string _name;
+
+    unsigned char *const _data;
+
+    const size_t _size;
+
+    /// 是否由本对象创建，创建者负责解除链接。
+    const bool _owner;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
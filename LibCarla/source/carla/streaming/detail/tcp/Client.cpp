@@ -35,16 +35,17 @@ namespace tcp {
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    IncomingMessage() = default;
 
     // 获取缓冲区的大小
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
     }
 
-    // 获取消息的缓冲区
-    boost::asio::mutable_buffer buffer() {
+    // 获取消息的缓冲区，知道消息大小后才从池中取出容量足够的缓冲区
+    boost::asio::mutable_buffer buffer(BufferPool &pool) {
       DEBUG_ASSERT(_size > 0u);
+      _message = pool.Pop(_size);
       _message.reset(_size);
       return _message.buffer();
     }
@@ -186,7 +187,7 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>();
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -216,7 +217,7 @@ namespace tcp {
           // 现在我们知道了即将到来的缓冲区的大小，我们可以分配缓冲区并开始将数据放入其中。
           boost::asio::async_read(
               _socket,
-              message->buffer(),
+              message->buffer(*_buffer_pool),
               boost::asio::bind_executor(_strand, handle_read_data));
         } else if (!_done) {
           log_debug("streaming client: failed to read header:", ec.message());
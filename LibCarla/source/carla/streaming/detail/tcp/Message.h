@@ -122,10 +122,12 @@ namespace tcp {
 
   // class MessageTmpl
 
-/// @brief 一个TCP消息类型，最多包含2个缓冲区。这通常用于包含头部和主体的消息。
+/// @brief 一个TCP消息类型，最多包含4个缓冲区。
 ///
-/// @note 该类型是通过将`MessageTmpl`模板的特化参数设置为2来创建的。
-  using Message = MessageTmpl<2u>;
+/// @note 除了传感器头部和主体外，还允许将序列化器的子头部（例如图像头部）
+///       与渲染回读得到的像素数据作为独立的缓冲区分散-聚集（scatter-gather）
+///       写入套接字，而无需先将它们复制到同一个缓冲区中。
+  using Message = MessageTmpl<4u>;
 
 } // namespace tcp
 } // namespace detail
@@ -8,6 +8,7 @@
 
 #include "carla/NonCopyable.h" // 引入carla命名空间下的NonCopyable类，该类用于防止对象被复制
 #include "carla/Time.h"
+#include "carla/streaming/detail/SessionQueue.h"
 #include "carla/streaming/detail/tcp/ServerSession.h"
 
 #include <boost/asio/io_context.hpp> // 引入Boost库的asio模块中的io_context类，用于事件处理和I/O操作
@@ -15,6 +16,7 @@
 #include <boost/asio/post.hpp> // 引入Boost库的asio模块中的post函数，用于在io_context上安排函数执行
 
 #include <atomic> // 引入C++标准库中的原子操作模板，用于线程安全的共享变量操作
+#include <mutex>
 
 namespace carla {
 namespace streaming {
@@ -59,6 +61,16 @@ namespace tcp {
     bool IsSynchronousMode() const {  // 获取服务器是否运行在同步模式
       return _synchronous;
     }
+    // 设置所有会话发送队列的配置，对已打开的会话同样生效
+    void SetSessionQueueSettings(const SessionQueueSettings &settings) {
+      std::lock_guard<std::mutex> lock(_queue_settings_mutex);
+      _queue_settings = settings;
+    }
+    // 获取会话发送队列的配置
+    SessionQueueSettings GetSessionQueueSettings() const {
+      std::lock_guard<std::mutex> lock(_queue_settings_mutex);
+      return _queue_settings;
+    }
 
   private:
 
@@ -74,6 +86,8 @@ namespace tcp {
     std::atomic<time_duration> _timeout; // 原子操作的超时时间，用于线程安全的超时时间设置
 
     bool _synchronous; // 布尔值，表示服务器是否运行在同步模式
+    mutable std::mutex _queue_settings_mutex; // 保护会话发送队列配置的互斥锁
+    SessionQueueSettings _queue_settings; // 会话发送队列的配置
   };
 
 } // namespace tcp
@@ -6,6 +6,7 @@
 
 #include "carla/streaming/detail/tcp/ServerSession.h"
 #include "carla/streaming/detail/tcp/Server.h"
+#include "carla/streaming/detail/shm/Protocol.h"
 
 #include "carla/Debug.h"
 #include "carla/Logging.h"
@@ -15,8 +16,8 @@
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <thread>
 
 namespace carla {
 namespace streaming {
@@ -39,7 +40,8 @@ namespace tcp {
       _socket(io_context),
       _timeout(timeout),
       _deadline(io_context),
-      _strand(io_context) {}
+      _strand(io_context),
+      _waiting_deadline(io_context) {}
 // 打开会话的函数
   // @param on_opened 会话打开成功的回调函数
   // @param on_closed 会话关闭的回调函数
@@ -54,6 +56,8 @@ namespace tcp {
     // 将Linux上的同步模式速度提高了约3倍。
     const boost::asio::ip::tcp::no_delay option(true);
     _socket.set_option(option);
+    // 内核支持时，大的消息使用零拷贝发送
+    _zero_copy = ZeroCopyWriter::Create(_socket, _strand);
  // 启动定时器
     StartTimer();
     // 获取自身的共享指针，以便在异步操作中保持对象存活
@@ -66,6 +70,10 @@ namespace tcp {
         if (!ec) {
         	// 断言接收到的字节数等于流ID的大小
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          if ((_stream_id & shm::SHARED_MEMORY_REQUEST_FLAG) != 0u) {
+            _stream_id &= ~shm::SHARED_MEMORY_REQUEST_FLAG;
+            OpenSharedMemory();
+          }
           // 打印调试信息，表示会话已启动
           log_debug("session", _session_id, "for stream", _stream_id, " started");
           // 在strand的上下文环境中执行回调函数
@@ -93,26 +101,81 @@ namespace tcp {
   	// 断言消息不为空且消息内容不为空
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
       if (!_socket.is_open()) {
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // 等待上一条消息发送完毕
-          while (_is_writing) {
-            std::this_thread::yield();
+      {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        if (_is_writing) {
+          const auto settings = _server.GetSessionQueueSettings();
+          if (!_waiting.empty() || (_queue.size() >= settings.max_depth)) {
+            if (_server.IsSynchronousMode() || (settings.policy == OverflowPolicy::Block)) {
+              // 不阻塞写入线程（多个会话共用），消息在会话中等待队列有空间，超时后
+              // 由 strand 中的定时器丢弃
+              const time_duration wait = (settings.timeout.milliseconds() == 0u) ? _timeout : settings.timeout;
+              const bool arm_timer = _waiting.empty();
+              _waiting.push_back({
+                  std::move(message),
+                  boost::asio::deadline_timer::traits_type::now() + wait.to_posix_time()});
+              if (arm_timer) {
+                boost::asio::post(_strand, [self=shared_from_this()]() { self->StartWaitingTimer(); });
+              }
+              return;
+            } else if ((settings.policy == OverflowPolicy::DropOldest) && !_queue.empty()) {
+              // 丢弃最旧的消息，为新消息腾出空间
+              _queue.pop_front();
+              ++_statistics.dropped_messages;
+            } else {
+              // 忽略该消息
+              ++_statistics.dropped_messages;
+              LOG_RATE_LIMITED(1.0, log_debug, "session", _session_id, ": connection too slow: message discarded");
+              return;
+            }
+          }
+          if (_is_writing) {
+            _queue.emplace_back(std::move(message));
+            _statistics.max_queue_depth = std::max(_statistics.max_queue_depth, _queue.size());
+            return;
           }
-        } else {
-          // 忽略该消息
-          log_debug("session", _session_id, ": connection too slow: message discarded");
-          return;
         }
+        _is_writing = true;
+      }
+      StartWrite(std::move(message));
+  }
+
+  void ServerSession::StartWrite(std::shared_ptr<const Message> message) {
+    auto self = shared_from_this();
+      // 共享内存会话只通过套接字发送通知，数据写入共享内存槽中
+      if (_is_shared_memory_session) {
+        message = (_shared_memory != nullptr) ?
+            _shared_memory->Publish(*message) :
+            shm::Publisher::MakeInline(*message);
       }
-      _is_writing = true;
-// 定义消息发送完成后的回调函数
+// 定义消息发送完成后的回调函数，如果队列中还有消息则继续发送下一条
       auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
+        std::shared_ptr<const Message> next;
+        {
+          std::lock_guard<std::mutex> lock(_queue_mutex);
+          if (ec) {
+            _statistics.dropped_messages += _queue.size() + _waiting.size();
+            _queue.clear();
+            _waiting.clear();
+          } else {
+            ++_statistics.sent_messages;
+            if (!_queue.empty()) {
+              next = std::move(_queue.front());
+              _queue.pop_front();
+              if (!_waiting.empty()) {
+                _queue.emplace_back(std::move(_waiting.front().message));
+                _waiting.pop_front();
+              }
+            } else if (!_waiting.empty()) {
+              next = std::move(_waiting.front().message);
+              _waiting.pop_front();
+            }
+          }
+          _is_writing = (next != nullptr);
+        }
         if (ec) {
         	// 如果发送出错，打印错误信息并立即关闭会话
           log_info("session", _session_id, ": error sending data :", ec.message());
@@ -121,16 +184,78 @@ namespace tcp {
         	// 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
           DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
           DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+          if (next != nullptr) {
+            StartWrite(std::move(next));
+          }
         }
       };
 // 打印调试信息，表示要发送的消息大小
       log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
 // 设置消息发送的截止时间
       _deadline.expires_from_now(_timeout);
+      if ((_zero_copy != nullptr) &&
+          !_is_shared_memory_session &&
+          (message->size() >= ZeroCopyWriter::MIN_MESSAGE_SIZE)) {
+        // 零拷贝发送在 strand 中进行，完成时可能同步调用 handle_sent，使用 post 以免递归
+        boost::asio::post(_strand, [this, self, message, handle_sent]() {
+          _zero_copy->AsyncWrite(message, handle_sent);
+        });
+        return;
+      }
       // 异步写入消息
       boost::asio::async_write(_socket, message->GetBufferSequence(), 
         boost::asio::bind_executor(_strand, handle_sent));
   }
+
+  SessionStatistics ServerSession::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    auto statistics = _statistics;
+    statistics.queue_depth = _queue.size();
+    statistics.waiting_messages = _waiting.size();
+    return statistics;
+  }
+
+  void ServerSession::StartWaitingTimer() {
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      const auto now = boost::asio::deadline_timer::traits_type::now();
+      while (!_waiting.empty() && (_waiting.front().expires_at <= now)) {
+        _waiting.pop_front();
+        ++_statistics.dropped_messages;
+        LOG_RATE_LIMITED(1.0, log_debug, "session", _session_id, ": connection too slow: timed out, message discarded");
+      }
+      if (_waiting.empty()) {
+        return;
+      }
+      _waiting_deadline.expires_at(_waiting.front().expires_at);
+    }
+    _waiting_deadline.async_wait(boost::asio::bind_executor(_strand,
+        [this, self=shared_from_this()](const boost::system::error_code &ec) {
+      if (ec != boost::asio::error::operation_aborted) {
+        StartWaitingTimer();
+      }
+    }));
+  }
+// 为请求共享内存传输的会话创建共享内存写入器，仅当客户端与服务器位于同一主机时
+  // 才使用共享内存，否则数据直接附加在通知之后发送
+  void ServerSession::OpenSharedMemory() {
+    _is_shared_memory_session = true;
+    if (!shm::SharedMemory::IsSupported()) {
+      return;
+    }
+    boost::system::error_code ec_remote;
+    boost::system::error_code ec_local;
+    const auto remote = _socket.remote_endpoint(ec_remote);
+    const auto local = _socket.local_endpoint(ec_local);
+    if (ec_remote || ec_local) {
+      return;
+    }
+    if (remote.address().is_loopback() || (remote.address() == local.address())) {
+      _shared_memory = std::make_unique<shm::Publisher>(
+          shm::SharedMemory::MakePrefix(local.port(), _session_id));
+      log_debug("session", _session_id, ": using shared memory");
+    }
+  }
 // 关闭会话的函数
   void ServerSession::Close() {
     boost::asio::post(_strand, [self=shared_from_this()]() { self->CloseNow(); });
@@ -161,6 +286,12 @@ namespace tcp {
         _socket.close();
       }
     }
+    _waiting_deadline.cancel();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _statistics.dropped_messages += _waiting.size();
+      _waiting.clear();
+    }
     _on_closed(shared_from_this());
     log_debug("session", _session_id, "closed");
   }
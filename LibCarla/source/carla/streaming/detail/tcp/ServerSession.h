@@ -42,13 +42,16 @@
       *
       * 此文件定义了流处理模块中使用的底层类型，如流ID和消息大小类型。
       */
+#include "carla/streaming/detail/SessionQueue.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/Publisher.h"
       /**
        * @brief 引入Carla流处理模块中TCP消息类的定义。
        *
        * 此类用于表示TCP通信中传输的消息，包括消息头和消息体。
        */
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/ZeroCopyWriter.h"
        /**
         * @brief Clang编译器的警告控制区域开始。
         *
@@ -102,6 +105,9 @@
                * 该头文件提供了智能指针、动态内存分配和对象生命周期管理等功能。
                */
 #include <memory>
+
+#include <deque>
+#include <mutex>
                /**
                 * @namespace carla::streaming::detail::tcp
                 * @brief 包含Carla流处理模块中TCP通信的详细实现。
@@ -210,6 +216,9 @@ namespace tcp {
       Write(MakeMessage(buffers...));
     }
 
+    /// @brief 返回发送队列的统计信息，可以在任意线程中调用。
+    SessionStatistics GetStatistics() const;
+
     /// @brief 发布一个关闭会话的任务。
 /// 
 /// 该函数安排一个任务来关闭当前会话，但不会立即关闭。
@@ -225,6 +234,12 @@ namespace tcp {
 /// 该函数用于立即关闭会话，可选地接受一个错误代码参数来表示关闭的原因。
 /// @param ec 关闭会话时的错误代码，默认为无错误。
     void CloseNow(boost::system::error_code ec = boost::system::error_code());
+    /// @brief 开始异步发送 @a message，调用前需将 _is_writing 置为 true。
+    void StartWrite(std::shared_ptr<const Message> message);
+    /// @brief 在 strand 中丢弃等待超时的消息，并为下一条等待的消息设置定时器。
+    void StartWaitingTimer();
+    /// @brief 客户端请求了共享内存传输时调用。
+    void OpenSharedMemory();
     /// @brief 允许 Server 类访问私有成员。
     friend class Server;
     /// @brief 对 Server 对象的引用。
@@ -243,8 +258,28 @@ namespace tcp {
     boost::asio::io_context::strand _strand;
     /// @brief 会话关闭时的回调函数。
     callback_function_type _on_closed;
+    /// @brief 保护发送队列、写入标志和统计信息的互斥锁。
+    mutable std::mutex _queue_mutex;
+    /// @brief 等待发送的消息，不包括正在发送的消息。
+    std::deque<std::shared_ptr<const Message>> _queue;
+    /// @brief 队列已满时按 Block 策略等待进入队列的消息及其截止时间。
+    struct WaitingMessage {
+      std::shared_ptr<const Message> message;
+      boost::posix_time::ptime expires_at;
+    };
+    std::deque<WaitingMessage> _waiting;
+    /// @brief _waiting 中第一条消息的截止时间到达时触发。
+    boost::asio::deadline_timer _waiting_deadline;
+    /// @brief 发送队列的统计信息，queue_depth 由 _queue 计算。
+    SessionStatistics _statistics;
     /// @brief 表示当前是否正在进行写入操作的标志。
     bool _is_writing = false;
+    /// @brief 客户端是否请求了共享内存传输，此时发送的每条消息都以通知开头。
+    bool _is_shared_memory_session = false;
+    /// @brief 共享内存写入器，仅当客户端位于同一主机时存在。
+    std::unique_ptr<shm::Publisher> _shared_memory;
+    /// @brief 大消息的零拷贝发送，仅在以 LIBCARLA_ENABLE_ZEROCOPY 编译且内核支持时存在。
+    std::unique_ptr<ZeroCopyWriter> _zero_copy;
   };
 
 } // namespace tcp
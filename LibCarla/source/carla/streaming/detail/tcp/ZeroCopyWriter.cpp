@@ -0,0 +1,207 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/ZeroCopyWriter.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+
+#include <array>
+
+#if defined(LIBCARLA_ENABLE_ZEROCOPY) && defined(__linux__)
+#  include <linux/errqueue.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#  include <cerrno>
+#  include <cstring>
+#  define LIBCARLA_ZEROCOPY_SUPPORTED
+#  ifndef SO_ZEROCOPY
+#    define SO_ZEROCOPY 60
+#  endif
+#  ifndef MSG_ZEROCOPY
+#    define MSG_ZEROCOPY 0x4000000
+#  endif
+#  ifndef SO_EE_ORIGIN_ZEROCOPY
+#    define SO_EE_ORIGIN_ZEROCOPY 5
+#  endif
+#endif
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  struct ZeroCopyWriter::Operation {
+    std::shared_ptr<const Message> message;
+
+    handler_type handler;
+
+    size_t total_size = 0u;
+
+    size_t bytes_sent = 0u;
+
+    /// 是否有部分数据以零拷贝发送，以及最后一次零拷贝 sendmsg 调用的编号。
+    bool has_zero_copy_sends = false;
+
+    uint32_t last_id = 0u;
+  };
+
+  ZeroCopyWriter::ZeroCopyWriter(socket_type &socket, boost::asio::io_context::strand &strand)
+    : _socket(socket),
+      _strand(strand) {}
+
+  ZeroCopyWriter::~ZeroCopyWriter() = default;
+
+#ifndef LIBCARLA_ZEROCOPY_SUPPORTED
+
+  std::unique_ptr<ZeroCopyWriter> ZeroCopyWriter::Create(
+      socket_type &,
+      boost::asio::io_context::strand &) {
+    return nullptr;
+  }
+
+  void ZeroCopyWriter::AsyncWrite(std::shared_ptr<const Message>, handler_type) {
+    DEBUG_ASSERT(false);
+  }
+
+  void ZeroCopyWriter::SendSome(std::shared_ptr<Operation>) {}
+
+  void ZeroCopyWriter::Finish(Operation &, const boost::system::error_code &) {}
+
+  void ZeroCopyWriter::ReapCompletions() {}
+
+#else
+
+  std::unique_ptr<ZeroCopyWriter> ZeroCopyWriter::Create(
+      socket_type &socket,
+      boost::asio::io_context::strand &strand) {
+    const int enable = 1;
+    if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) != 0) {
+      log_debug("streaming: MSG_ZEROCOPY not supported:", std::strerror(errno));
+      return nullptr;
+    }
+    return std::unique_ptr<ZeroCopyWriter>(new ZeroCopyWriter(socket, strand));
+  }
+
+  void ZeroCopyWriter::AsyncWrite(std::shared_ptr<const Message> message, handler_type handler) {
+    DEBUG_ASSERT(message != nullptr);
+    auto operation = std::make_shared<Operation>();
+    operation->total_size = sizeof(message_size_type) + message->size();
+    operation->message = std::move(message);
+    operation->handler = std::move(handler);
+    SendSome(std::move(operation));
+  }
+
+  void ZeroCopyWriter::SendSome(std::shared_ptr<Operation> operation) {
+    // 先清空错误队列：队列不为空时 epoll 一直报告 EPOLLERR，等待可写会立即返回
+    ReapCompletions();
+
+    // 跳过已经发送的部分
+    std::array<iovec, Message::max_size() + 1u> iov;
+    size_t count = 0u;
+    size_t skip = operation->bytes_sent;
+    for (const auto &buffer : operation->message->GetBufferSequence()) {
+      if (skip >= buffer.size()) {
+        skip -= buffer.size();
+        continue;
+      }
+      iov[count].iov_base = const_cast<char *>(static_cast<const char *>(buffer.data())) + skip;
+      iov[count].iov_len = buffer.size() - skip;
+      skip = 0u;
+      ++count;
+    }
+    DEBUG_ASSERT(count > 0u);
+
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+
+    const int fd = _socket.native_handle();
+    const int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+    bool is_zero_copy = true;
+    ssize_t result = ::sendmsg(fd, &msg, flags | MSG_ZEROCOPY);
+    if ((result < 0) && (errno == ENOBUFS)) {
+      // 未完成的零拷贝发送超过了 optmem 的限制，这一部分改为普通发送
+      is_zero_copy = false;
+      result = ::sendmsg(fd, &msg, flags);
+    }
+    if (result >= 0) {
+      if (is_zero_copy) {
+        operation->last_id = _next_id++;
+        operation->has_zero_copy_sends = true;
+      }
+      operation->bytes_sent += static_cast<size_t>(result);
+      if (operation->bytes_sent == operation->total_size) {
+        Finish(*operation, boost::system::error_code{});
+        return;
+      }
+    } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+      Finish(*operation, boost::system::error_code(errno, boost::system::system_category()));
+      return;
+    }
+
+    // 套接字缓冲区已满，等待可写后继续发送剩余的部分
+    _socket.async_wait(
+        socket_type::wait_write,
+        boost::asio::bind_executor(_strand, [this, operation](const boost::system::error_code &ec) {
+          if (ec) {
+            Finish(*operation, ec);
+          } else {
+            SendSome(operation);
+          }
+        }));
+  }
+
+  void ZeroCopyWriter::Finish(Operation &operation, const boost::system::error_code &ec) {
+    // 即使发送失败，内核也可能仍在使用已经零拷贝发送的部分
+    if (operation.has_zero_copy_sends) {
+      _pending.emplace_back(operation.last_id, std::move(operation.message));
+    }
+    auto handler = std::move(operation.handler);
+    handler(ec, operation.bytes_sent);
+  }
+
+  void ZeroCopyWriter::ReapCompletions() {
+    const int fd = _socket.native_handle();
+    while (!_pending.empty()) {
+      char control[128];
+      msghdr msg{};
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+        return;
+      }
+      for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        const bool is_ip_error =
+            ((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) ||
+            ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR));
+        if (!is_ip_error) {
+          continue;
+        }
+        sock_extended_err error;
+        std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+        if ((error.ee_errno != 0) || (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+          continue;
+        }
+        // 编号在 [ee_info, ee_data] 之间的发送已经完成，通知按顺序到达
+        const uint32_t last = error.ee_data;
+        while (!_pending.empty() &&
+               (static_cast<int32_t>(_pending.front().first - last) <= 0)) {
+          _pending.pop_front();
+        }
+      }
+    }
+  }
+
+#endif // LIBCARLA_ZEROCOPY_SUPPORTED
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// 使用 Linux 的 MSG_ZEROCOPY 发送大的消息，内核直接从消息的缓冲区发送数据，
+  /// 不再复制到套接字缓冲区。
+  ///
+  /// 内核在发送完成后才释放对用户内存的引用，因此每条消息被保留到套接字的
+  /// 错误队列上收到对应的完成通知为止，在此之前其缓冲区不会回到 BufferPool。
+  ///
+  /// 需要以 LIBCARLA_ENABLE_ZEROCOPY 编译（CMake 选项 LIBCARLA_STREAMING_ZEROCOPY），
+  /// 否则或者内核不支持时 Create 返回空指针，会话使用普通的 async_write。
+  ///
+  /// @warning 所有方法都必须在会话的 strand 中调用。
+  class ZeroCopyWriter : private NonCopyable {
+  public:
+
+    using socket_type = boost::asio::ip::tcp::socket;
+
+    using handler_type = std::function<void(const boost::system::error_code &, size_t)>;
+
+    /// 小于此大小的消息复制的开销低于处理完成通知的开销，不使用零拷贝。
+    static constexpr size_t MIN_MESSAGE_SIZE = 64u * 1024u;
+
+    /// 为 @a socket 启用零拷贝发送，不支持时返回空指针。
+    static std::unique_ptr<ZeroCopyWriter> Create(
+        socket_type &socket,
+        boost::asio::io_context::strand &strand);
+
+    ~ZeroCopyWriter();
+
+    /// 异步发送整条消息（包括大小前缀），完成时在 strand 中调用 @a handler。
+    void AsyncWrite(std::shared_ptr<const Message> message, handler_type handler);
+
+    /// 已发送但尚未收到完成通知的消息数量。
+    size_t GetPendingMessages() const {
+      return _pending.size();
+    }
+
+  private:
+
+    struct Operation;
+
+    ZeroCopyWriter(socket_type &socket, boost::asio::io_context::strand &strand);
+
+    void SendSome(std::shared_ptr<Operation> operation);
+
+    void Finish(Operation &operation, const boost::system::error_code &ec);
+
+    /// 读取套接字错误队列中的完成通知，释放已完成的消息。
+    void ReapCompletions();
+
+    socket_type &_socket;
+
+    boost::asio::io_context::strand &_strand;
+
+    /// 下一次零拷贝 sendmsg 调用的编号，与内核的计数相同。
+    uint32_t _next_id = 0u;
+
+    /// 等待完成通知的消息，以及其最后一次 sendmsg 调用的编号。
+    std::deque<std::pair<uint32_t, std::shared_ptr<const Message>>> _pending;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/Client.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/asio/post.hpp>
+
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      callback_function_type callback)
+    : _token(token),
+      _callback(std::move(callback)),
+      _socket(io_context),
+      _strand(io_context),
+      _datagram(MAX_DATAGRAM_SIZE),
+      _reassembler(token.get_stream_id()) {
+    if (!_token.protocol_is_udp()) {
+      throw_exception(std::invalid_argument("invalid token, only UDP tokens supported"));
+    }
+  }
+
+  Client::~Client() = default;
+
+  void Client::Connect() {
+    DEBUG_ASSERT(_token.is_valid());
+    const auto group = _token.get_address();
+    if (!group.is_multicast()) {
+      throw_exception(std::invalid_argument("invalid token, the address is not a multicast group"));
+    }
+    // 绑定到组播端口的任意地址，多个客户端（以及多个流）可以共用同一个端口
+    const endpoint listen_endpoint{
+        group.is_v4() ?
+            boost::asio::ip::address(boost::asio::ip::address_v4::any()) :
+            boost::asio::ip::address(boost::asio::ip::address_v6::any()),
+        _token.get_port()};
+    _socket.open(listen_endpoint.protocol());
+    _socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+    _socket.bind(listen_endpoint);
+    _socket.set_option(boost::asio::ip::multicast::join_group(group));
+    log_debug("streaming client: joined multicast group", group, "port", _token.get_port());
+    ReadData();
+  }
+
+  void Client::Stop() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      _done = true;
+      if (_socket.is_open()) {
+        _socket.close();
+      }
+    });
+  }
+
+  void Client::ReadData() {
+    auto self = shared_from_this();
+    if (_done) {
+      return;
+    }
+    auto handle_receive = [this, self](boost::system::error_code ec, size_t bytes) {
+      if (_done) {
+        return;
+      }
+      if (ec) {
+        if (ec == boost::asio::error::operation_aborted) {
+          return;
+        }
+        log_debug("streaming client: failed to receive multicast datagram:", ec.message());
+      } else {
+        auto message = _reassembler.Add(_datagram.data(), bytes);
+        if (message) {
+          _callback(std::move(*message));
+        }
+      }
+      ReadData();
+    };
+    _socket.async_receive_from(
+        boost::asio::buffer(_datagram),
+        _sender,
+        boost::asio::bind_executor(_strand, handle_receive));
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
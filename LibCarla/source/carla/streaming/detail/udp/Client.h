@@ -0,0 +1,83 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/udp/Reassembler.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 通过 UDP 组播订阅流的客户端。令牌中的地址和端口为组播组。
+  ///
+  /// 组播不保证送达，丢失的消息（FEC 无法恢复时）直接跳过，回调只收到完整的消息。
+  ///
+  /// @warning 在释放共享指针之前，应该先停止这个客户端，否则它将不会被销毁。
+  class Client
+    : public std::enable_shared_from_this<Client>,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+    using callback_function_type = std::function<void (Buffer)>;
+
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback);
+
+    ~Client();
+
+    /// 加入组播组并开始接收数据。
+    void Connect();
+
+    stream_id_type GetStreamId() const {
+      return _token.get_stream_id();
+    }
+
+    void Stop();
+
+  private:
+
+    void ReadData();
+
+    const token_type _token;
+
+    callback_function_type _callback;
+
+    boost::asio::ip::udp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    endpoint _sender;
+
+    std::vector<unsigned char> _datagram;
+
+    Reassembler _reassembler;
+
+    std::atomic_bool _done{false};
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,131 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/MulticastSender.h"
+
+#include "carla/Logging.h"
+
+#include <boost/asio/ip/multicast.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  MulticastSender::MulticastSender(
+      boost::asio::io_context &io_context,
+      endpoint group,
+      MulticastSettings settings)
+    : _group(std::move(group)),
+      _settings(settings),
+      _socket(io_context) {
+    DEBUG_ASSERT(_settings.fragment_size > 0u);
+    // 服务器端不抛出异常，失败时记录错误，之后的发送也会失败
+    boost::system::error_code ec;
+    _socket.open(_group.protocol(), ec);
+    if (!ec) {
+      _socket.set_option(boost::asio::ip::multicast::hops(_settings.ttl), ec);
+    }
+    if (!ec) {
+      // 允许同一主机上的客户端收到数据
+      _socket.set_option(boost::asio::ip::multicast::enable_loopback(true), ec);
+    }
+    if (ec) {
+      log_error("streaming: failed to open multicast socket:", ec.message());
+      return;
+    }
+    log_info("streaming: sending multicast to", _group);
+  }
+
+  void MulticastSender::SendDatagram(
+      const DatagramHeader &header,
+      const unsigned char *data,
+      const size_t size) {
+    const std::array<boost::asio::const_buffer, 2u> datagram{{
+        boost::asio::buffer(&header, sizeof(header)),
+        boost::asio::buffer(data, size)}};
+    boost::system::error_code ec;
+    _socket.send_to(datagram, _group, 0, ec);
+    if (ec) {
+      if (!_has_logged_error) {
+        log_error("streaming: failed to send multicast datagram:", ec.message());
+        _has_logged_error = true;
+      }
+      return;
+    }
+    ++_sent_datagrams;
+  }
+
+  void MulticastSender::Send(
+      const stream_id_type stream_id,
+      const uint32_t sequence,
+      const tcp::Message &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // 第一个缓冲区是 TCP 使用的消息大小，跳过
+    auto sequence_of_buffers = message.GetBufferSequence();
+    const std::vector<boost::asio::const_buffer> parts(
+        std::next(sequence_of_buffers.begin()),
+        sequence_of_buffers.end());
+    _message.copy_from(parts);
+
+    const size_t fragment_size = _settings.fragment_size;
+    const size_t size = _message.size();
+    const size_t count = std::max<size_t>(1u, (size + fragment_size - 1u) / fragment_size);
+    if (count > std::numeric_limits<uint16_t>::max()) {
+      log_warning("streaming: message of", size, "bytes is too big for multicast, dropping it");
+      return;
+    }
+
+    DatagramHeader header;
+    header.magic = DATAGRAM_MAGIC;
+    header.stream_id = stream_id;
+    header.sequence = sequence;
+    header.message_size = static_cast<uint32_t>(size);
+    header.fragment_count = static_cast<uint16_t>(count);
+    header.fragment_size = static_cast<uint16_t>(fragment_size);
+    header.fec_group_size = _settings.fec_group_size;
+
+    const size_t group_size = _settings.fec_group_size;
+    if (group_size > 0u) {
+      _parity.reset(static_cast<Buffer::size_type>(fragment_size));
+    }
+
+    for (size_t i = 0u; i < count; ++i) {
+      const size_t offset = i * fragment_size;
+      const size_t length = std::min(fragment_size, size - offset);
+      const auto *data = _message.data() + offset;
+      header.fragment_index = static_cast<uint16_t>(i);
+      header.is_parity = 0u;
+      SendDatagram(header, data, length);
+
+      if (group_size > 0u) {
+        if (i % group_size == 0u) {
+          std::memset(_parity.data(), 0, fragment_size);
+        }
+        for (size_t j = 0u; j < length; ++j) {
+          _parity.data()[j] ^= data[j];
+        }
+        if ((i % group_size == group_size - 1u) || (i + 1u == count)) {
+          header.fragment_index = static_cast<uint16_t>(i / group_size);
+          header.is_parity = 1u;
+          SendDatagram(header, _parity.data(), fragment_size);
+        }
+      }
+    }
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
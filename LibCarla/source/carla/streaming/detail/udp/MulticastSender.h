@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/udp/Protocol.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 将流的消息发送到一个 UDP 组播组。无论有多少个客户端订阅，每条消息只
+  /// 发送一次，适用于可以容忍丢帧的广播式的流。
+  ///
+  /// 大的消息被分为多个数据报（见 DatagramHeader），可以选择附加 XOR 校验分片。
+  /// 多个流可以共用同一个组播组，客户端根据流 ID 过滤。
+  ///
+  /// 可以在任意线程中调用 Send，发送是同步的。
+  class MulticastSender : private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+
+    MulticastSender(
+        boost::asio::io_context &io_context,
+        endpoint group,
+        MulticastSettings settings = {});
+
+    const endpoint &GetGroup() const {
+      return _group;
+    }
+
+    const MulticastSettings &GetSettings() const {
+      return _settings;
+    }
+
+    /// 将 @a message 作为流 @a stream_id 的第 @a sequence 条消息发送。
+    void Send(stream_id_type stream_id, uint32_t sequence, const tcp::Message &message);
+
+    uint64_t GetSentDatagrams() const {
+      return _sent_datagrams;
+    }
+
+  private:
+
+    void SendDatagram(const DatagramHeader &header, const unsigned char *data, size_t size);
+
+    const endpoint _group;
+
+    const MulticastSettings _settings;
+
+    std::mutex _mutex;
+
+    boost::asio::ip::udp::socket _socket;
+
+    /// 连续存放的消息内容，在多次发送之间重用。
+    Buffer _message;
+
+    Buffer _parity;
+
+    std::atomic<uint64_t> _sent_datagrams{0u};
+
+    bool _has_logged_error = false;
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 组播传输的配置。
+  struct MulticastSettings {
+    /// 组播数据报的生存时间（可以经过的路由器数量），1 表示只在本网段内。
+    uint8_t ttl = 1u;
+    /// 每个数据报携带的最大负载（字节），应小于网络的 MTU。
+    uint16_t fragment_size = 1400u;
+    /// 每多少个分片生成一个 XOR 校验分片，0 表示不使用前向纠错（FEC）。
+    /// 每组分片中丢失一个时可以恢复。
+    uint8_t fec_group_size = 0u;
+  };
+
+#pragma pack(push, 1)
+
+  /// 每个组播数据报的头部，之后是分片的负载。
+  ///
+  /// 一条消息被分为 fragment_count 个数据分片，除最后一个外大小都是
+  /// fragment_size。启用 FEC 时，每 fec_group_size 个数据分片之后发送一个校验
+  /// 分片（is_parity = 1），其负载为该组分片负载的异或（不足 fragment_size 的部分补零），
+  /// fragment_index 为组的编号。
+  struct DatagramHeader {
+    uint32_t magic;
+    stream_id_type stream_id;
+    /// 消息在该流中的序号，从 1 开始递增。
+    uint32_t sequence;
+    /// 整条消息的大小。
+    uint32_t message_size;
+    uint16_t fragment_index;
+    uint16_t fragment_count;
+    uint16_t fragment_size;
+    uint8_t fec_group_size;
+    uint8_t is_parity;
+  };
+
+#pragma pack(pop)
+
+  constexpr uint32_t DATAGRAM_MAGIC = 0x43524d43u; // "CMRC"
+
+  /// 一次接收的最大数据报大小。
+  constexpr size_t MAX_DATAGRAM_SIZE = 65507u;
+
+  static_assert(sizeof(DatagramHeader) == 24u, "Invalid datagram header size");
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,187 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/Reassembler.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  Reassembler::Reassembler(stream_id_type stream_id, size_t max_pending_messages)
+    : _stream_id(stream_id),
+      _max_pending_messages(std::max<size_t>(1u, max_pending_messages)),
+      _buffer_pool(std::make_shared<BufferPool>()) {}
+
+  Reassembler::~Reassembler() = default;
+
+  static bool IsConsistent(const DatagramHeader &lhs, const DatagramHeader &rhs) {
+    return (lhs.message_size == rhs.message_size) &&
+           (lhs.fragment_count == rhs.fragment_count) &&
+           (lhs.fragment_size == rhs.fragment_size) &&
+           (lhs.fec_group_size == rhs.fec_group_size);
+  }
+
+  boost::optional<Buffer> Reassembler::Add(const unsigned char *data, const size_t size) {
+    if (size < sizeof(DatagramHeader)) {
+      return boost::none;
+    }
+    DatagramHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if ((header.magic != DATAGRAM_MAGIC) || (header.stream_id != _stream_id)) {
+      return boost::none;
+    }
+    const auto *payload = data + sizeof(header);
+    const size_t payload_size = size - sizeof(header);
+
+    const size_t fragment_size = header.fragment_size;
+    const size_t count = header.fragment_count;
+    if ((fragment_size == 0u) || (count == 0u) ||
+        (header.message_size > count * fragment_size)) {
+      LOG_RATE_LIMITED(1.0, log_debug, "streaming client: invalid multicast datagram");
+      return boost::none;
+    }
+
+    // 从收到的第一条消息开始计算丢失的消息
+    if (!_has_sequence) {
+      _last_sequence = header.sequence - 1u;
+      _has_sequence = true;
+    }
+
+    // 忽略已交付或已丢弃的消息（序号回绕时使用带符号的差值比较）
+    if (static_cast<int32_t>(header.sequence - _last_sequence) <= 0) {
+      return boost::none;
+    }
+
+    auto it = _pending.find(header.sequence);
+    if (it == _pending.end()) {
+      while (_pending.size() >= _max_pending_messages) {
+        auto oldest = _pending.begin();
+        Skip(oldest->first);
+        ++_lost_messages;
+        _pending.erase(oldest);
+      }
+      PendingMessage message;
+      message.header = header;
+      message.data = _buffer_pool->Pop(header.message_size);
+      message.data.reset(header.message_size);
+      message.is_received.resize(count, false);
+      if (header.fec_group_size > 0u) {
+        message.parity.resize((count + header.fec_group_size - 1u) / header.fec_group_size);
+      }
+      it = _pending.emplace(header.sequence, std::move(message)).first;
+    }
+    auto &message = it->second;
+    if (!IsConsistent(message.header, header)) {
+      LOG_RATE_LIMITED(1.0, log_debug, "streaming client: inconsistent multicast datagram");
+      return boost::none;
+    }
+
+    size_t group = 0u;
+    if (header.is_parity != 0u) {
+      group = header.fragment_index;
+      if ((group >= message.parity.size()) || (payload_size != fragment_size)) {
+        return boost::none;
+      }
+      message.parity[group].copy_from(payload, static_cast<Buffer::size_type>(payload_size));
+    } else {
+      const size_t index = header.fragment_index;
+      if (index >= count) {
+        return boost::none;
+      }
+      const size_t offset = index * fragment_size;
+      const size_t expected = std::min(fragment_size, header.message_size - offset);
+      if (payload_size != expected) {
+        return boost::none;
+      }
+      if (!message.is_received[index]) {
+        std::memcpy(message.data.data() + offset, payload, payload_size);
+        message.is_received[index] = true;
+        ++message.number_of_received;
+      }
+      group = (header.fec_group_size > 0u) ? index / header.fec_group_size : 0u;
+    }
+
+    if (!message.parity.empty()) {
+      TryRecover(message, group);
+    }
+    if (message.number_of_received == count) {
+      return Complete(header.sequence, message);
+    }
+    return boost::none;
+  }
+
+  void Reassembler::TryRecover(PendingMessage &message, const size_t group) {
+    auto &parity = message.parity[group];
+    if (parity.empty()) {
+      return;
+    }
+    const size_t group_size = message.header.fec_group_size;
+    const size_t fragment_size = message.header.fragment_size;
+    const size_t first = group * group_size;
+    const size_t last = std::min<size_t>(first + group_size, message.is_received.size());
+
+    size_t missing = last;
+    for (size_t i = first; i < last; ++i) {
+      if (!message.is_received[i]) {
+        if (missing != last) {
+          return; // 丢失了多于一个分片，无法恢复
+        }
+        missing = i;
+      }
+    }
+    if (missing == last) {
+      return;
+    }
+
+    // 缺少的分片等于校验分片与组内其他分片的异或
+    for (size_t i = first; i < last; ++i) {
+      if (i == missing) {
+        continue;
+      }
+      const size_t offset = i * fragment_size;
+      const size_t length = std::min(fragment_size, message.header.message_size - offset);
+      const auto *fragment = message.data.data() + offset;
+      for (size_t j = 0u; j < length; ++j) {
+        parity.data()[j] ^= fragment[j];
+      }
+    }
+    const size_t offset = missing * fragment_size;
+    const size_t length = std::min(fragment_size, message.header.message_size - offset);
+    std::memcpy(message.data.data() + offset, parity.data(), length);
+    message.is_received[missing] = true;
+    ++message.number_of_received;
+    ++_recovered_fragments;
+    parity.clear();
+  }
+
+  boost::optional<Buffer> Reassembler::Complete(const uint32_t sequence, PendingMessage &message) {
+    Buffer result = std::move(message.data);
+    // 比这条消息更旧的未完成消息不会再交付，它们在 Skip 中计为丢失
+    while (!_pending.empty() && (static_cast<int32_t>(_pending.begin()->first - sequence) < 0)) {
+      _pending.erase(_pending.begin());
+    }
+    _pending.erase(sequence);
+    Skip(sequence);
+    return result;
+  }
+
+  void Reassembler::Skip(const uint32_t sequence) {
+    _lost_messages += static_cast<uint32_t>(sequence - _last_sequence) - 1u;
+    _last_sequence = sequence;
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/udp/Protocol.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// 将一个流的组播数据报重新组装为完整的消息。
+  ///
+  /// 同时最多保留 @a max_pending_messages 条未完成的消息，收到更新的消息时
+  /// 最旧的未完成消息被丢弃。启用 FEC 时，每组分片中丢失的一个可以由校验分片恢复。
+  /// 序号比已交付的消息更旧的数据报被忽略，因此消息总是按顺序交付。
+  ///
+  /// @warning 不是线程安全的。
+  class Reassembler : private NonCopyable {
+  public:
+
+    explicit Reassembler(stream_id_type stream_id, size_t max_pending_messages = 4u);
+
+    ~Reassembler();
+
+    /// 处理一个收到的数据报，如果它使一条消息完整，返回该消息。
+    boost::optional<Buffer> Add(const unsigned char *data, size_t size);
+
+    /// 丢失（未能完整收到）的消息数量。
+    uint64_t GetLostMessages() const {
+      return _lost_messages;
+    }
+
+    /// 通过校验分片恢复的分片数量。
+    uint64_t GetRecoveredFragments() const {
+      return _recovered_fragments;
+    }
+
+  private:
+
+    struct PendingMessage {
+      DatagramHeader header;
+
+      Buffer data;
+
+      std::vector<bool> is_received;
+
+      size_t number_of_received = 0u;
+
+      /// 每组的校验分片，未收到时为空。
+      std::vector<Buffer> parity;
+    };
+
+    boost::optional<Buffer> Complete(uint32_t sequence, PendingMessage &message);
+
+    void TryRecover(PendingMessage &message, size_t group);
+
+    /// 将 @a sequence 标记为最后处理的消息，其间跳过的消息计为丢失。
+    void Skip(uint32_t sequence);
+
+    const stream_id_type _stream_id;
+
+    const size_t _max_pending_messages;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::map<uint32_t, PendingMessage> _pending;
+
+    /// 最后交付或丢弃的消息的序号。
+    uint32_t _last_sequence = 0u;
+
+    bool _has_sequence = false;
+
+    uint64_t _lost_messages = 0u;
+
+    uint64_t _recovered_fragments = 0u;
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
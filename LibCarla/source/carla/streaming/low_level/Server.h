@@ -7,11 +7,16 @@
 #pragma once
 
 #include "carla/streaming/detail/Dispatcher.h" // 引入 Dispatcher 头文件
+#include "carla/streaming/detail/SessionQueue.h"
 #include "carla/streaming/detail/Types.h"      // 引入类型定义头文件
+#include "carla/streaming/detail/udp/MulticastSender.h"
 #include "carla/streaming/Stream.h"            // 引入 Stream 头文件
 
 #include <boost/asio/io_context.hpp>           // 引入 Boost.Asio 的 IO 上下文头文件
 
+#include <memory>
+#include <vector>
+
 namespace carla {
 namespace streaming {
 namespace low_level {
@@ -38,7 +43,8 @@ namespace low_level {
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep, // 内部端点
         detail::EndPoint<protocol_type, ExternalEPType> external_ep) // 外部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(std::move(external_ep)) { // 初始化调度器
       StartServer(); // 启动服务器
     }
@@ -48,7 +54,8 @@ namespace low_level {
     explicit Server(
         boost::asio::io_context &io_context, // 输入 IO 上下文引用
         detail::EndPoint<protocol_type, InternalEPType> internal_ep) // 内部端点
-      : _server(io_context, std::move(internal_ep)), // 初始化底层服务器
+      : _io_context(io_context),
+        _server(io_context, std::move(internal_ep)), // 初始化底层服务器
         _dispatcher(make_endpoint<protocol_type>(_server.GetLocalEndpoint().port())) { // 创建调度器
       StartServer(); // 启动服务器
     }
@@ -83,6 +90,41 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro); // 设置底层服务器的同步模式
     }
 
+    /// 设置此后创建的流是否向同一主机上的客户端提供共享内存传输。
+    void SetSharedMemoryMode(bool enable) {
+      _dispatcher.SetSharedMemoryMode(enable);
+    }
+
+    /// 设置组播流使用的组播组，已经启用组播的流继续使用原来的组。
+    void SetMulticastGroup(
+        const boost::asio::ip::udp::endpoint &group,
+        const detail::udp::MulticastSettings &settings = {}) {
+      _multicast_sender = std::make_shared<detail::udp::MulticastSender>(_io_context, group, settings);
+    }
+
+    /// 通过组播组发送指定流的消息。尚未设置组播组或流不存在时返回 false。
+    bool EnableMulticast(stream_id sensor_id) {
+      if (_multicast_sender == nullptr) {
+        log_error("Cannot enable multicast: no multicast group set");
+        return false;
+      }
+      return _dispatcher.EnableMulticast(sensor_id, _multicast_sender);
+    }
+
+    void DisableMulticast(stream_id sensor_id) {
+      _dispatcher.DisableMulticast(sensor_id);
+    }
+
+    // 设置每个会话发送队列的配置
+    void SetSessionQueueSettings(const detail::SessionQueueSettings &settings) {
+      _server.SetSessionQueueSettings(settings);
+    }
+
+    // 获取指定流的每个会话发送队列的统计信息
+    std::vector<detail::SessionStatistics> GetSessionStatistics(stream_id sensor_id) {
+      return _dispatcher.GetSessionStatistics(sensor_id);
+    }
+
     // 获取流的令牌
     token_type GetToken(stream_id sensor_id) {
       return _dispatcher.GetToken(sensor_id); // 从调度器获取流的令牌
@@ -121,9 +163,13 @@ namespace low_level {
       _server.Listen(on_session_opened, on_session_closed); // 开始监听会话
     }
 
+    boost::asio::io_context &_io_context;
+
     underlying_server _server; // 底层服务器实例
 
     detail::Dispatcher _dispatcher; // 调度器实例
+
+    std::shared_ptr<detail::udp::MulticastSender> _multicast_sender;
   };
 
 } // namespace low_level
@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <limits>
+
 #include "boost/pointer_cast.hpp"
 
 #include "carla/client/Actor.h" //导入 Actor 类
@@ -46,27 +49,44 @@ ALSM::ALSM(
 void ALSM::Update() {
   //获取是否启用混合物理模式参数
   bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
-  //定义两个集合用于存储世界中的车辆 ID 和行人 ID
-  std::set<ActorId> world_vehicle_ids;
-  std::set<ActorId> world_pedestrian_ids;
-  //存储待删除的未注册参与者的 ID 列表
-  std::vector<ActorId> unregistered_list_to_be_deleted;
-
-  current_timestamp = world.GetSnapshot().GetTimestamp(); //获取当前时间截
-  ActorList world_actors = world.GetActors();//获取当前世界中的所有参与者列表
-
-  // 找到已经销毁的参与者并进行清理
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
-  
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+  current_timestamp = world_snapshot.GetTimestamp(); //获取当前时间截
+
+  // 根据接收到的剧集状态中参与者列表的变化找出出现和销毁的参与者，只有第一次
+  // 更新或者变化的历史不够时才获取完整的参与者列表
+  const cc::ActorListChanges actor_list_changes = world.GetActorListChanges(actor_list_sequence);
+  actor_list_sequence = actor_list_changes.sequence;
+  ALSM::DestroyeddActors destroyed_actors;
+  ActorList new_actors;
+  if (actor_list_synchronized && actor_list_changes.complete) {
+    destroyed_actors = IdentifyDestroyedActors(actor_list_changes.destroyed);
+    // 新出现的参与者和被交通管理器释放的车辆，在一次调用中获取
+    std::vector<ActorId> new_actor_ids = actor_list_changes.spawned;
+    for (const ActorId actor_id : released_vehicles) {
+      if (std::find(actor_list_changes.destroyed.begin(), actor_list_changes.destroyed.end(), actor_id) == actor_list_changes.destroyed.end()) {
+        new_actor_ids.push_back(actor_id);
+      }
+    }
+    if (!new_actor_ids.empty()) {
+      new_actors = world.GetActors(new_actor_ids);
+    }
+  } else {
+    new_actors = world.GetActors(); //获取当前世界中的所有参与者列表
+    destroyed_actors = IdentifyDestroyedActors(new_actors);
+    registered_vehicles_state = registered_vehicles.GetState();
+    actor_list_synchronized = true;
+  }
+  released_vehicles.clear();
+
   //处理已注册的被销毁的参与者
   const ActorIdSet &destroyed_registered = destroyed_actors.first;
   for (const auto &deletion_id: destroyed_registered) {
-    RemoveActor(deletion_id, true); //删除角色并标记为注册参与者
+    DeleteActorData(deletion_id, true); //删除角色并标记为注册参与者
   }
   //处理未注册的被销毁参与者
   const ActorIdSet &destroyed_unregistered = destroyed_actors.second;
   for (auto deletion_id : destroyed_unregistered) {
-    RemoveActor(deletion_id, false);
+    DeleteActorData(deletion_id, false);
   }
 
   // 检查英雄参与者是否存活，如果英雄参与者已被销毁，则将其从英雄列表中移除
@@ -91,7 +111,9 @@ void ALSM::Update() {
   }
 
   // 扫描并识别新的未注册参与者
-  IdentifyNewActors(world_actors);
+  if (new_actors != nullptr) {
+    IdentifyNewActors(new_actors);
+  }
 
   // 更新所有已注册的车辆的动态状态和静态属性
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -104,7 +126,7 @@ void ALSM::Update() {
     // 如果车辆被卡住，且它不是英雄参与者，并且距离上次销毁的时间超过了预设的时间间隔，则销毁该车辆。
     
 	registered_vehicles.Destroy(max_idle_time.first); // 销毁长时间停滞不动的车辆
-    RemoveActor(max_idle_time.first, true); //从已注册的参与者中移除该辆车
+    DeleteActorData(max_idle_time.first, true); //从已注册的参与者中移除该辆车
     elapsed_last_actor_destruction = current_timestamp.elapsed_seconds;//更新上一次销毁的时间
   }
 
@@ -113,13 +135,13 @@ void ALSM::Update() {
   	//如果系统处于 OSM 模式，遍历标记为移除的参与者列表
     for (const ActorId& actor_id: marked_for_removal) {
       registered_vehicles.Destroy(actor_id); //销毁这些标记为移除的车辆
-      RemoveActor(actor_id, true); //从已注册参与者列表中移除
+      DeleteActorData(actor_id, true); //从已注册参与者列表中移除
     }
     marked_for_removal.clear(); //清空标记为移除的参与者列表
   }
 
   // 更新未注册参与者的动态状态和静态属性
-  UpdateUnregisteredActorsData();
+  UpdateUnregisteredActorsData(world_snapshot);
 }
 
 //识别新的参与者
@@ -188,6 +210,33 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   return destroyed_actors;
 }
 
+ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const std::vector<ActorId> &destroyed_ids) {
+
+  ALSM::DestroyeddActors destroyed_actors;
+  ActorIdSet &deleted_registered = destroyed_actors.first;
+  ActorIdSet &deleted_unregistered = destroyed_actors.second;
+
+  for (const ActorId actor_id : destroyed_ids) {
+    if (registered_vehicles.Contains(actor_id)) {
+      deleted_registered.insert(actor_id);
+    } else if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+      deleted_unregistered.insert(actor_id);
+    }
+  }
+
+  // 只有已注册车辆的集合改变后才需要查找已经注册为车辆的未注册参与者
+  const int current_state = registered_vehicles.GetState();
+  if (current_state != registered_vehicles_state) {
+    registered_vehicles_state = current_state;
+    for (const ActorId &actor_id : registered_vehicles.GetIDList()) {
+      if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+        deleted_unregistered.insert(actor_id);
+      }
+    }
+  }
+  return destroyed_actors;
+}
+
 void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
 
   //获取所有注册车辆的列表
@@ -245,19 +294,17 @@ void ALSM::UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
   }
 
   // 检查当前车辆是否在英雄车辆的范围内，并在混合物理模式下启用物理仿真
-  bool in_range_of_hero_actor = false;
+  float hero_distance_square = std::numeric_limits<float>::infinity();
   if (hero_actor_present && hybrid_physics_mode) {
     for (auto &hero_actor_info: hero_actors) {
       const ActorId &hero_actor_id =  hero_actor_info.first;
       if (simulation_state.ContainsActor(hero_actor_id)) {
         const cg::Location &hero_location = simulation_state.GetLocation(hero_actor_id);
-        if (cg::Math::DistanceSquared(vehicle_location, hero_location) < physics_radius_square) {
-          in_range_of_hero_actor = true;
-          break;
-        }
+        hero_distance_square = std::min(hero_distance_square, cg::Math::DistanceSquared(vehicle_location, hero_location));
       }
     }
   }
+  bool in_range_of_hero_actor = hero_distance_square < physics_radius_square;
 
   //根据混合物理模式和是否在英雄车辆范围内决定是否启用物理仿真
   bool enable_physics = hybrid_physics_mode ? in_range_of_hero_actor : true;
@@ -305,19 +352,72 @@ void ALSM::UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
     // 将新的车辆及其状态添加到仿真状态中
     simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
   }
+
+  // 被传送的车辆按与最近的英雄车辆的距离选择细节层次，没有英雄车辆时不降到最低层次
+  DetailLevel detail_level = DetailLevel::Full;
+  const float mesoscopic_radius = parameters.GetMesoscopicRadius();
+  if (!enable_physics && mesoscopic_radius > 0.0f) {
+    const bool beyond_mesoscopic_radius = hero_actor_present && hero_distance_square >= SQUARE(mesoscopic_radius);
+    detail_level = beyond_mesoscopic_radius ? DetailLevel::Mesoscopic : DetailLevel::Reduced;
+  }
+  simulation_state.UpdateDetailLevel(actor_id, detail_level);
 }
 
 
-void ALSM::UpdateUnregisteredActorsData() {
-  //遍历所有未注册的参与者
-  for (auto &actor_info: unregistered_actors) {
+void ALSM::UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot) {
+  // 分片模式下只跟踪本分片边界附近的未注册参与者，其余的由相邻分片负责
+  const std::shared_ptr<const ShardLayout> shard_layout = parameters.GetShardLayout();
+
+  // 只有已注册车辆附近的未注册参与者会影响交通管理器的决策，英雄参与者总是需要
+  ActorIdSet nearby_actors;
+  for (auto &hero_actor_info: hero_actors) {
+    nearby_actors.insert(hero_actor_info.first);
+  }
+  for (const ActorId &vehicle_id : registered_vehicles.GetIDList()) {
+    if (!simulation_state.ContainsActor(vehicle_id)) {
+      continue;
+    }
+    const float tracking_radius = UNREGISTERED_TRACKING_RADIUS_MIN
+        + UNREGISTERED_TRACKING_RADIUS_RATE * simulation_state.GetVelocity(vehicle_id).Length();
+    for (const ActorId actor_id : world_snapshot.GetActorIdsInRadius(simulation_state.GetLocation(vehicle_id), tracking_radius)) {
+      if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+        nearby_actors.insert(actor_id);
+      }
+    }
+  }
+
+  // 离开范围的参与者不再跟踪，回到范围内时重新加入
+  for (auto iter = tracked_unregistered.begin(); iter != tracked_unregistered.end();) {
+    if (nearby_actors.find(*iter) == nearby_actors.end()) {
+      track_traffic.DeleteActor(*iter);
+      simulation_state.RemoveActor(*iter);
+      iter = tracked_unregistered.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  //遍历附近的未注册参与者
+  for (const ActorId actor_id : nearby_actors) {
 
-    const ActorId actor_id = actor_info.first; //获取参与者的 ID
-    const ActorPtr actor_ptr = actor_info.second; //获取参与者的指针
+    auto actor_info = unregistered_actors.find(actor_id);
+    if (actor_info == unregistered_actors.end()) {
+      continue;
+    }
+    const ActorPtr actor_ptr = actor_info->second; //获取参与者的指针
     const std::string type_id = actor_ptr->GetTypeId(); //获取参与者的类型 ID
      
     const cg::Transform actor_transform = actor_ptr->GetTransform(); //获取参与者的变换信息
     const cg::Location actor_location = actor_transform.location; //获取参与者的位置
+    if (shard_layout != nullptr && !shard_layout->IsInBoundaryRegion(actor_location)) {
+      if (simulation_state.ContainsActor(actor_id)) {
+        track_traffic.DeleteActor(actor_id);
+        simulation_state.RemoveActor(actor_id);
+      }
+      tracked_unregistered.erase(actor_id);
+      continue;
+    }
+    tracked_unregistered.insert(actor_id);
     const cg::Rotation actor_rotation = actor_transform.rotation; //获取参与者的旋转信息
     const cg::Vector3D actor_velocity = actor_ptr->GetVelocity(); //获取参与者的速度
     const bool actor_is_dormant = actor_ptr->IsDormant(); //判断参与者是否处于休眠状态
@@ -424,6 +524,14 @@ bool ALSM::IsVehicleStuck(const ActorId& actor_id) {
 
 // 移除指定的参与者
 void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
+  DeleteActorData(actor_id, registered_actor);
+  // 车辆可能仍在世界中，之后作为未注册参与者跟踪
+  if (registered_actor) {
+    released_vehicles.push_back(actor_id);
+  }
+}
+
+void ALSM::DeleteActorData(const ActorId actor_id, const bool registered_actor) {
   // 如果参与者是已注册的
   if (registered_actor) {
     // 从注册车辆中移除参与者
@@ -441,6 +549,7 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
     // 如果参与者未注册，则从未注册参与者和英雄参与者集合中移除
     unregistered_actors.erase(actor_id);
     hero_actors.erase(actor_id);
+    tracked_unregistered.erase(actor_id);
   }
 
   //从交通监控系统中删除参与者
@@ -455,6 +564,11 @@ void ALSM::Reset() {
   unregistered_actors.clear();
   idle_time.clear();
   hero_actors.clear();
+  tracked_unregistered.clear();
+  released_vehicles.clear();
+  // 下一次更新时重新获取完整的参与者列表
+  actor_list_synchronized = false;
+  registered_vehicles_state = -1;
   elapsed_last_actor_destruction = 0.0; // 重置上次参与者销毁的时间
   current_timestamp = world.GetSnapshot().GetTimestamp(); // 更新当前时间截
 }
@@ -4,8 +4,10 @@
 #include <memory>
 
 #include "carla/client/ActorList.h"
+#include "carla/client/ActorListChanges.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
@@ -25,13 +27,14 @@ namespace traffic_manager {
 
 using namespace constants::HybridMode;  // 引入混合模式常量
 using namespace constants::VehicleRemoval; // 引入车辆移除常量
+using namespace constants::ActorTracking;
 
 namespace chr = std::chrono;  // 引用时间相关的命名空间
 namespace cg = carla::geom;   // 引用几何相关的命名空间
 namespace cc = carla::client;  // 引用客户端相关的命名空间
 
-using ParticipantList = carla::SharedPtr<cc::ActorList>; // 定义参与者列表共享指针类型
-using ParticipantMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
+using ActorList = carla::SharedPtr<cc::ActorList>; // 定义参与者列表共享指针类型
+using ActorMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
 using IdleTimeMap = std::unordered_map<ActorId, double>; // 定义闲置时间映射表类型
 using LocalMapPtr = std::shared_ptr<InMemoryMap>; // 定义本地地图共享指针类型
 
@@ -42,10 +45,10 @@ class ALSM {
 
 private:
   AtomicActorSet &registered_vehicles; // 引用已注册参与者的原子集合
-  ParticipantMap unregistered_participants; // 存储未注册参与者的结构
+  ActorMap unregistered_actors; // 存储未注册参与者的结构
   BufferMap &buffer_map; // 引用缓冲区映射
   IdleTimeMap idle_time; // 存储参与者在位置上停留时间的结构
-  ParticipantMap hero_participants; // 存储角色名称为"hero"的参与者
+  ActorMap hero_actors; // 存储角色名称为"hero"的参与者
   TrackTraffic &track_traffic; // 引用交通跟踪对象
   std::vector<ActorId>& marked_for_removal; // 标记待移除参与者的数组
   const Parameters &parameters; // 引用参数对象
@@ -57,9 +60,18 @@ private:
   TrafficLightStage &traffic_light_stage; // 引用交通灯阶段对象
   MotionPlanStage &motion_plan_stage; // 引用运动规划阶段对象
   VehicleLightStage &vehicle_light_stage; // 引用车辆灯光阶段对象
-  double elapsed_last_participant_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
+  double elapsed_last_actor_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
   cc::Timestamp current_timestamp; // 当前时间戳
   std::unordered_map<ActorId, bool> has_physics_enabled; // 存储每个参与者是否启用物理的映射
+  // 上一次读取的参与者列表变化的序号；actor_list_synchronized 为 false 时重新获取完整的参与者列表
+  uint64_t actor_list_sequence {0u};
+  bool actor_list_synchronized {false};
+  // 上一次检查时已注册车辆集合的状态计数
+  int registered_vehicles_state {-1};
+  // 从交通管理器中移除、但可能仍在世界中的车辆，下一次更新时作为未注册参与者加入
+  std::vector<ActorId> released_vehicles;
+  // 当前在仿真状态中跟踪的未注册参与者，只包括已注册车辆附近的
+  ActorIdSet tracked_unregistered;
 
   // 更新已注册参与者在某位置上停留的时间
   void UpdateIdleTime(std::pair<ActorId, double>& max_idle_time, const ActorId& actor_id);
@@ -68,22 +80,29 @@ private:
   bool IsVehicleStuck(const ActorId& actor_id);
 
   // 确定自上次更新以来在仿真中新生成的参与者
-  void IdentifyNewParticipants(const ParticipantList &participant_list);
+  void IdentifyNewActors(const ActorList &actor_list);
 
-  using DestroyeddParticipants = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
+  using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
   // 确定在上一帧中删除的参与者
   // 返回已注册和未注册参与者的数组
-  DestroyeddParticipants IdentifyDestroyedParticipants(const ParticipantList &participant_list);
+  DestroyeddActors IdentifyDestroyedActors(const ActorList &actor_list);
+
+  // 与上面相同，但只检查参与者列表变化中销毁的参与者，以及已注册车辆集合
+  // 改变后新注册的车辆
+  DestroyeddActors IdentifyDestroyedActors(const std::vector<ActorId> &destroyed_ids);
 
   using IdleInfo = std::pair<ActorId, double>; // 定义闲置信息的数据类型
-  void UpdateRegisteredParticipantsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
+  void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
 
   // 更新参与者数据
   void UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
                   const bool hero_actor_present, const float physics_radius_square);
 
-  // 更新未注册参与者的数据
-  void UpdateUnregisteredParticipantsData();
+  // 更新已注册车辆附近的未注册参与者的数据
+  void UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot);
+
+  // 清理与参与者相关的数据
+  void DeleteActorData(const ActorId actor_id, const bool registered_actor);
 
 public:
   // 构造函数
@@ -105,8 +124,11 @@ public:
   void Update();
 
   // 从交通管理中移除参与者，并清理与该车辆相关的各种数据
-  void RemoveParticipant(const ActorId actor_id, const bool registered_actor);
+  void RemoveActor(const ActorId actor_id, const bool registered_actor);
 
   // 重置方法
   void Reset();
-};
\ No newline at end of file
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+using ActorId = carla::ActorId;
+
+/// 按参与者在 XY 平面上的位置划分的均匀网格，用于查找某一位置附近的参与者。
+/// 每个周期用 Clear 和 Insert 重建；单元的存储在重建之间保留，以避免重复分配。
+class ActorSpatialHash {
+public:
+
+  explicit ActorSpatialHash(const float cell_size)
+    : inv_cell_size(1.0f / cell_size) {}
+
+  /// 清空所有单元中的参与者。
+  void Clear() {
+    for (auto &cell : cells) {
+      cell.second.clear();
+    }
+  }
+
+  void Insert(const ActorId actor_id, const cg::Location &location) {
+    cells[MakeKey(CellIndex(location.x), CellIndex(location.y))].push_back(actor_id);
+  }
+
+  /// 对覆盖以 @a center 为中心、边长为 2 * @a radius 的正方形的单元中的每个参与者
+  /// 调用 @a callback(actor_id)。结果可能包含距离大于 @a radius 的参与者，
+  /// 由调用者进一步筛选。
+  template <typename CallbackT>
+  void ForEachInRadius(const cg::Location &center, const float radius, CallbackT &&callback) const {
+    const int32_t min_x = CellIndex(center.x - radius);
+    const int32_t max_x = CellIndex(center.x + radius);
+    const int32_t min_y = CellIndex(center.y - radius);
+    const int32_t max_y = CellIndex(center.y + radius);
+    const double number_of_cells =
+        (static_cast<double>(max_x) - min_x + 1.0) * (static_cast<double>(max_y) - min_y + 1.0);
+    if (number_of_cells > static_cast<double>(cells.size())) {
+      // 半径很大时，直接遍历所有单元比逐个查找覆盖的单元更快
+      for (const auto &cell : cells) {
+        for (const ActorId actor_id : cell.second) {
+          callback(actor_id);
+        }
+      }
+      return;
+    }
+    for (int32_t x = min_x; x <= max_x; ++x) {
+      for (int32_t y = min_y; y <= max_y; ++y) {
+        auto it = cells.find(MakeKey(x, y));
+        if (it != cells.end()) {
+          for (const ActorId actor_id : it->second) {
+            callback(actor_id);
+          }
+        }
+      }
+    }
+  }
+
+private:
+
+  int32_t CellIndex(const float coordinate) const {
+    return static_cast<int32_t>(std::floor(coordinate * inv_cell_size));
+  }
+
+  static uint64_t MakeKey(const int32_t x, const int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32u) |
+        static_cast<uint64_t>(static_cast<uint32_t>(y));
+  }
+
+  const float inv_cell_size;
+
+  std::unordered_map<uint64_t, std::vector<ActorId>> cells;
+};
+
+} // namespace traffic_manager
+} // namespace carla
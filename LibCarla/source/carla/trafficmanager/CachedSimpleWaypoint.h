@@ -7,6 +7,10 @@
 #pragma once
 
 #include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+#include "carla/Exception.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
 
@@ -38,11 +42,11 @@ namespace traffic_manager {   // 命名空间 traffic_manager 开始
 
     void Read(std::ifstream &in_file);  // 从输入文件流中读取路点信息的函数
 
-    void Write(std::ofstream &out_file);   // 将路点信息写入输出文件流的函数
+    void Write(std::ostream &out_file);   // 将路点信息写入输出流的函数
 
   private:
     template <typename T>
-    void WriteValue(std::ofstream &out_file, const T &in_obj) {
+    void WriteValue(std::ostream &out_file, const T &in_obj) {
       out_file.write(reinterpret_cast<const char *>(&in_obj), sizeof(T));
     }
     // 模板函数，将输入对象写入输出文件流，用于将不同类型的数据写入文件
@@ -55,10 +59,14 @@ namespace traffic_manager {   // 命名空间 traffic_manager 开始
 
     template <typename T>
     void ReadValue(const std::vector<uint8_t>& content, unsigned long& start, T &out_obj) {
+      if (start + sizeof(T) > content.size()) {
+        throw_exception(std::out_of_range("truncated InMemoryMap cache"));
+      }
       memcpy(&out_obj, &content[start], sizeof(T));
       start += sizeof(T);
     }
     // 模板函数，从字节向量中读取数据并存储到输出对象中，同时更新起始位置，用于从字节向量中读取不同类型的数据
+    // 数据不完整时抛出 std::out_of_range
 
   };
 
@@ -14,6 +14,7 @@ using TLS = carla::rpc::TrafficLightState; // 简化交通信号灯状态的命
 
 using namespace constants::Collision; // 引入碰撞相关的常量
 using constants::WaypointSelection::JUNCTION_LOOK_AHEAD; // 引入路口前瞻距离常量
+using constants::HybridMode::REDUCED_DETAIL_COLLISION_INTERVAL;
 
 // 碰撞阶段的构造函数
 CollisionStage::CollisionStage(
@@ -40,20 +41,49 @@ void CollisionStage::Update(const unsigned long index) {
 
   // 获取当前车辆的ID
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (simulation_state.ContainsActor(ego_actor_id)) { // 检查仿真中是否包含此车辆
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id); // 获取车辆当前位置
+  const VehicleParameters &ego_parameters = parameters.GetVehicleParameters(index);
+
+  // 从上一周期的碰撞锁开始，本次更新中的修改只写入这辆车的缓冲
+  boost::optional<CollisionLock> &ego_lock = next_collision_locks.at(index);
+  auto previous_lock = collision_locks.find(ego_actor_id);
+  if (previous_lock != collision_locks.end()) {
+    ego_lock = previous_lock->second;
+  } else {
+    ego_lock = boost::none;
+  }
+  const ActorStateIndex ego_state_index = simulation_state.GetVehicleIndex(index);
+  CollisionHazardData &output_element = output_array.at(index);
+
+  // 低细节层次的车辆：Reduced 每隔几个周期检测一次，其余周期重用上一次的结果；
+  // Mesoscopic 只跟随前车，不使用碰撞锁
+  const DetailLevel detail_level = ego_state_index.IsValid() ? simulation_state.GetDetailLevel(ego_state_index) : DetailLevel::Full;
+  if (detail_level == DetailLevel::Mesoscopic) {
+    ego_lock = boost::none;
+    output_element = GetMesoscopicHazard(ego_actor_id, ego_state_index, ego_parameters);
+    return;
+  }
+  if (detail_level == DetailLevel::Reduced
+      && (cycle_number + ego_actor_id) % REDUCED_DETAIL_COLLISION_INTERVAL != 0u) {
+    auto previous_hazard = reduced_detail_hazards.find(ego_actor_id);
+    if (previous_hazard != reduced_detail_hazards.end()
+        && (!previous_hazard->second.hazard || simulation_state.ContainsActor(previous_hazard->second.hazard_actor_id))) {
+      output_element = previous_hazard->second;
+      next_reduced_detail_hazards.at(index) = output_element;
+      return;
+    }
+  }
+
+  if (ego_state_index.IsValid()) { // 检查仿真中是否包含此车辆
+    const cg::Location ego_location = simulation_state.GetLocation(ego_state_index); // 获取车辆当前位置
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id); // 获取车辆的路径缓存
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second; // 计算前瞻路径点索引
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length(); // 获取车辆速度
+    const float velocity = simulation_state.GetVelocity(ego_state_index).Length(); // 获取车辆速度
 
-    // 获取与当前车辆路径重叠的其他车辆ID
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids; // 碰撞候选车辆ID列表
     // 根据速度和参数计算碰撞检测的最大半径平方
-    const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id); // 获取前车的安全距离
+    const float distance_to_leading = ego_parameters.distance_to_leading_vehicle; // 获取前车的安全距离
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN); // 碰撞半径平方
     if (velocity < 2.0f) { // 如果车辆速度较低
-      const float length = simulation_state.GetDimensions(ego_actor_id).x; // 获取车辆长度
+      const float length = simulation_state.GetDimensions(ego_state_index).x; // 获取车辆长度
       const float collision_radius_stop = COLLISION_RADIUS_STOP + length; // 设置静止时的碰撞半径
       collision_radius_square = SQUARE(collision_radius_stop);
     }
@@ -61,47 +91,47 @@ void CollisionStage::Update(const unsigned long index) {
         collision_radius_square = SQUARE(distance_to_leading);
     }
 
-    // 遍历重叠路径上的其他车辆，筛选碰撞候选车辆
-    for (ActorId overlapping_actor_id : overlapping_actors) {
-      // 如果其他车辆在最大碰撞避免范围内，并且垂直方向有重叠
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id); // 获取重叠车辆的位置
-      if (overlapping_actor_id != ego_actor_id // 排除自身
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square  // 检测是否在碰撞半径范围内
-          && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) { // 检测垂直方向的重叠
-        collision_candidate_ids.push_back(overlapping_actor_id); // 添加到碰撞候选列表
+    // 从网格中取出碰撞半径范围内的参与者，只保留与当前车辆路径重叠、
+    // 并且垂直方向有重叠的参与者作为碰撞候选，保存它们与自车距离的平方
+    std::vector<std::pair<float, ActorId>> collision_candidates;
+    actor_spatial_hash.ForEachInRadius(ego_location, std::sqrt(collision_radius_square), [&](const ActorId other_actor_id) {
+      if (other_actor_id == ego_actor_id) { // 排除自身
+        return;
       }
-    }
+      const cg::Location other_actor_location = simulation_state.GetLocation(other_actor_id);
+      const float distance_square = cg::Math::DistanceSquared(other_actor_location, ego_location);
+      if (distance_square < collision_radius_square  // 检测是否在碰撞半径范围内
+          && std::abs(ego_location.z - other_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD  // 检测垂直方向的重叠
+          && track_traffic.IsOverlapping(ego_actor_id, other_actor_id)) { // 检测路径是否重叠
+        collision_candidates.emplace_back(distance_square, other_actor_id);
+      }
+    });
 
-    // 按与自车的距离对潜在碰撞对象进行升序排序
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location; // 自车位置
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1); // 对象1的位置
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2); // 对象2的位置
-                // 按距离平方排序，避免使用平方根计算，提升性能
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
-              });
+    // 按与自车的距离对潜在碰撞对象进行升序排序，距离相同时按ID排序
+    std::sort(collision_candidates.begin(), collision_candidates.end());
 
     // 遍历排序后的对象，检查每个对象是否构成碰撞威胁
-    for (auto iter = collision_candidate_ids.begin();
-         iter != collision_candidate_ids.end() && !collision_hazard;
+    RandomStream collision_random = random_device.GetStream(ego_actor_id, RandomStreamId::Collision);
+    for (auto iter = collision_candidates.begin();
+         iter != collision_candidates.end() && !collision_hazard;
          ++iter) {
-      const ActorId other_actor_id = *iter; // 当前检查的对象ID
+      const ActorId other_actor_id = iter->second; // 当前检查的对象ID
       const ActorType other_actor_type = simulation_state.GetType(other_actor_id); // 对象的类型（车辆/行人）
       // 检查碰撞检测条件是否满足
-      if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id) // 检查自车与目标车之间的碰撞检测设置
+      if ((!ego_parameters.ignores_collisions || parameters.GetCollisionDetection(ego_actor_id, other_actor_id)) // 检查自车与目标车之间的碰撞检测设置
           && buffer_map.find(ego_actor_id) != buffer_map.end()           // 检查缓冲区是否存在自车
           && simulation_state.ContainsActor(other_actor_id)) {           // 检查目标对象是否仍在场景中
         // 通过协商函数计算碰撞威胁
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       look_ahead_index,
+                                                                       ego_lock);
         if (negotiation_result.first) { // 如果存在碰撞威胁
           // 根据对象类型和随机概率，决定是否忽略此威胁
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && ego_parameters.perc_ignore_vehicles <= collision_random.next())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && ego_parameters.perc_ignore_walkers <= collision_random.next())) {
             collision_hazard = true;      // 标记碰撞威胁
             obstacle_id = other_actor_id; // 记录威胁对象ID
             available_distance_margin = negotiation_result.second; // 记录距离裕度
@@ -112,23 +142,108 @@ void CollisionStage::Update(const unsigned long index) {
   }
 
   // 更新输出碰撞数据
-  CollisionHazardData &output_element = output_array.at(index);
   output_element.hazard_actor_id = obstacle_id; // 威胁对象ID
   output_element.hazard = collision_hazard;     // 是否存在碰撞威胁
   output_element.available_distance_margin = available_distance_margin; // 距离裕度
+  if (detail_level == DetailLevel::Reduced) {
+    next_reduced_detail_hazards.at(index) = output_element;
+  }
+}
+
+CollisionHazardData CollisionStage::GetMesoscopicHazard(const ActorId ego_actor_id,
+                                                        const ActorStateIndex ego_state_index,
+                                                        const VehicleParameters &ego_parameters) const {
+  CollisionHazardData hazard_data{std::numeric_limits<float>::infinity(), 0u, false};
+
+  const cg::Location ego_location = simulation_state.GetLocation(ego_state_index);
+  const cg::Vector3D ego_heading = simulation_state.GetHeading(ego_state_index);
+  const float ego_half_length = simulation_state.GetDimensions(ego_state_index).x;
+  const float velocity = simulation_state.GetVelocity(ego_state_index).Length();
+  const float follow_distance = std::max(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN,
+                                         ego_parameters.distance_to_leading_vehicle);
+
+  for (const ActorId other_actor_id : track_traffic.GetOverlappingVehicles(ego_actor_id)) {
+    if (other_actor_id == ego_actor_id
+        || !simulation_state.ContainsActor(other_actor_id)
+        || (ego_parameters.ignores_collisions && !parameters.GetCollisionDetection(ego_actor_id, other_actor_id))) {
+      continue;
+    }
+    const ActorStateIndex other_state_index = simulation_state.GetIndex(other_actor_id);
+    const cg::Vector3D relative_location = simulation_state.GetLocation(other_state_index) - ego_location;
+    // 只考虑前方且垂直方向重叠的车辆
+    if (cg::Math::Dot(relative_location, ego_heading) <= 0.0f
+        || std::abs(relative_location.z) >= VERTICAL_OVERLAP_THRESHOLD) {
+      continue;
+    }
+    const float gap = relative_location.Length() - ego_half_length
+                      - simulation_state.GetDimensions(other_state_index).x;
+    if (gap < follow_distance && gap < hazard_data.available_distance_margin) {
+      hazard_data = CollisionHazardData{std::max(gap, 0.0f), other_actor_id, true};
+    }
+  }
+
+  return hazard_data;
 }
 
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   // 移除特定对象的碰撞锁定
   collision_locks.erase(actor_id);
+  reduced_detail_hazards.erase(actor_id);
+  geodesic_boundary_map.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   // 清空所有碰撞锁定
   collision_locks.clear();
+  next_collision_locks.clear();
+  reduced_detail_hazards.clear();
+  next_reduced_detail_hazards.clear();
+  geodesic_boundary_map.clear();
+  geometry_cache.clear();
+  cycle_number = 0u;
+}
+
+void CollisionStage::PrepareCycle() {
+  next_collision_locks.clear();
+  next_collision_locks.resize(vehicle_id_list.size());
+  next_reduced_detail_hazards.clear();
+  next_reduced_detail_hazards.resize(vehicle_id_list.size());
+  ++cycle_number;
+
+  // 用参与者当前的位置重建网格
+  actor_spatial_hash.Clear();
+  const std::vector<ActorId> &actor_ids = simulation_state.GetActorIds();
+  for (size_t i = 0u; i < actor_ids.size(); ++i) {
+    actor_spatial_hash.Insert(actor_ids[i], simulation_state.GetLocation(ActorStateIndex{i}));
+  }
+}
+
+void CollisionStage::ApplyCollisionLocks() {
+  for (unsigned long index = 0u; index < next_collision_locks.size(); ++index) {
+    const ActorId actor_id = vehicle_id_list.at(index);
+    const boost::optional<CollisionLock> &lock = next_collision_locks[index];
+    if (lock) {
+      collision_locks[actor_id] = *lock;
+    } else {
+      collision_locks.erase(actor_id);
+    }
+    const boost::optional<CollisionHazardData> &hazard = next_reduced_detail_hazards[index];
+    if (hazard) {
+      reduced_detail_hazards[actor_id] = *hazard;
+    } else if (!reduced_detail_hazards.empty()) {
+      reduced_detail_hazards.erase(actor_id);
+    }
+  }
+  next_collision_locks.clear();
+  next_reduced_detail_hazards.clear();
 }
 
 float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+  auto it = collision_locks.find(actor_id);
+  return GetBoundingBoxExtention(actor_id, it != collision_locks.end() ? &it->second : nullptr);
+}
+
+float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id, const CollisionLock *lock) {
   // 根据速度计算对象的碰撞边界延伸
   const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id)); // 计算对象的速度
   float bbox_extension;
@@ -136,11 +251,10 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   float velocity_extension = VEL_EXT_FACTOR * velocity; // 根据速度计算延伸因子
   bbox_extension = BOUNDARY_EXTENSION_MINIMUM + velocity_extension * velocity_extension; // 基础边界延伸
   // 如果对象有有效的碰撞锁定，调整边界以保持锁定
-  if (collision_locks.find(actor_id) != collision_locks.end()) {
-    const CollisionLock &lock = collision_locks.at(actor_id);
-    float lock_boundary_length = static_cast<float>(lock.distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
+  if (lock != nullptr) {
+    float lock_boundary_length = static_cast<float>(lock->distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
     // 仅当前车辆距离未超过速度相关延伸的最大值时，才延伸边界跟踪车辆
-    if ((lock_boundary_length - lock.initial_lock_distance) < MAX_LOCKING_EXTENSION) {
+    if ((lock_boundary_length - lock->initial_lock_distance) < MAX_LOCKING_EXTENSION) {
       bbox_extension = lock_boundary_length;
     }
   }
@@ -182,75 +296,129 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
 LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
   LocationVector geodesic_boundary;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    // 如果地理边界已经缓存，则直接获取
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
+  const LocationVector bbox = GetBoundary(actor_id); //获取边界框
+
+  if (buffer_map.find(actor_id) != buffer_map.end()) {
+    float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
+    const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
+    bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
+    const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
+
+    LocationVector left_boundary; // 左边界点集合
+    LocationVector right_boundary; // 右边界点集合
+    cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
+    const float width = dimensions.y; // 宽度
+    const float length = dimensions.x; // 长度
+
+    const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
+    const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
+    const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
+    const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
+
+    // 在无信号交叉口，我们扩展边界穿过交叉口
+    // 在所有其他情况下，边界长度与速度相关
+    SimpleWaypointPtr boundary_end = nullptr;
+    SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
+    bool reached_distance = false;
+    for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
+      if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+        reached_distance = true;
+      }
+      if (boundary_end == nullptr
+          || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
+          || reached_distance) {
+
+        const cg::Vector3D heading_vector = current_point->GetForwardVector();
+        const cg::Location location = current_point->GetLocation();
+        cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
+        perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
+        // 方向根据左手坐标系确定
+        const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
+        left_boundary.push_back(location + cg::Location(scaled_perpendicular));
+        right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
+
+        boundary_end = current_point;
+      }
+
+      current_point = waypoint_buffer.at(j);
+    }
+
+    // 反向右边界以构建顺时针（左手坐标系）
+    // 边界。这是因为左边界和右边界向量都有
+    // 在右边界的起始索引处与车辆的最近点
+    // 边界
+    // 我们希望从最远的点开始，以获得顺时针轨迹
+    std::reverse(right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
   } else {
-    const LocationVector bbox = GetBoundary(actor_id); //获取边界框
-
-    if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
-      bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
-      const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
-
-      LocationVector left_boundary; // 左边界点集合
-      LocationVector right_boundary; // 右边界点集合
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
-      const float width = dimensions.y; // 宽度
-      const float length = dimensions.x; // 长度
-
-      const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
-      const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
-      const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
-
-      // 在无信号交叉口，我们扩展边界穿过交叉口
-      // 在所有其他情况下，边界长度与速度相关
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
-      bool reached_distance = false;
-      for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
-          reached_distance = true;
-        }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
-            || reached_distance) {
-
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
-          cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
-          perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
-          // 方向根据左手坐标系确定
-          const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
-          left_boundary.push_back(location + cg::Location(scaled_perpendicular));
-          right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
-
-          boundary_end = current_point;
-        }
 
-        current_point = waypoint_buffer.at(j);
-      }
+    geodesic_boundary = bbox;
+  }
 
-      // 反向右边界以构建顺时针（左手坐标系）
-      // 边界。这是因为左边界和右边界向量都有
-      // 在右边界的起始索引处与车辆的最近点
-      // 边界
-      // 我们希望从最远的点开始，以获得顺时针轨迹
-      std::reverse(right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
-    } else {
+  return geodesic_boundary;
+}
 
-      geodesic_boundary = bbox;
+BoundarySignature CollisionStage::GetBoundarySignature(const ActorId actor_id) {
+  const auto quantize = [](const float value, const float quantum) {
+    return static_cast<int64_t>(std::llround(static_cast<double>(value) / static_cast<double>(quantum)));
+  };
+  const cg::Location location = simulation_state.GetLocation(actor_id);
+  const cg::Vector3D heading = simulation_state.GetHeading(actor_id);
+
+  BoundarySignature signature;
+  signature.x = quantize(location.x, BOUNDARY_CACHE_LOCATION_QUANTUM);
+  signature.y = quantize(location.y, BOUNDARY_CACHE_LOCATION_QUANTUM);
+  signature.z = quantize(location.z, BOUNDARY_CACHE_LOCATION_QUANTUM);
+  signature.heading_x = quantize(heading.x, BOUNDARY_CACHE_HEADING_QUANTUM);
+  signature.heading_y = quantize(heading.y, BOUNDARY_CACHE_HEADING_QUANTUM);
+
+  // 与 GetBoundary 和 GetGeodesicBoundary 使用相同的边界扩展
+  float extension = 0.0f;
+  signature.buffer_front_id = 0u;
+  signature.buffer_back_id = 0u;
+  signature.buffer_size = 0u;
+  auto buffer_it = buffer_map.find(actor_id);
+  if (buffer_it != buffer_map.end()) {
+    extension = std::max(parameters.GetDistanceToLeadingVehicle(actor_id), GetBoundingBoxExtention(actor_id));
+    const Buffer &waypoint_buffer = buffer_it->second;
+    if (!waypoint_buffer.empty()) {
+      signature.buffer_front_id = waypoint_buffer.front()->GetId();
+      signature.buffer_back_id = waypoint_buffer.back()->GetId();
+      signature.buffer_size = waypoint_buffer.size();
     }
+  }
+  if (simulation_state.GetType(actor_id) == ActorType::Pedestrian) {
+    extension += simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+  }
+  signature.extension = quantize(extension, BOUNDARY_CACHE_LOCATION_QUANTUM);
+
+  return signature;
+}
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+std::shared_ptr<const BoundaryGeometry> CollisionStage::GetBoundaryGeometry(const ActorId actor_id) {
+  const BoundarySignature signature = GetBoundarySignature(actor_id);
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = geodesic_boundary_map.find(actor_id);
+    if (it != geodesic_boundary_map.end() && it->second.geometry->signature == signature) {
+      // 边界没有改变，直接使用缓存
+      it->second.last_used_cycle = cycle_number;
+      return it->second.geometry;
+    }
   }
 
-  return geodesic_boundary;
+  auto geometry = std::make_shared<BoundaryGeometry>();
+  geometry->signature = signature;
+  geometry->geodesic_boundary = GetGeodesicBoundary(actor_id);
+  geometry->polygon = GetPolygon(GetBoundary(actor_id));
+  geometry->geodesic_polygon = GetPolygon(geometry->geodesic_boundary);
+
+  // 计算时不持有锁，其他线程可能已经插入了相同的结果
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  geodesic_boundary_map[actor_id] = CachedBoundary{geometry, cycle_number};
+  return geometry;
 }
 
 Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
@@ -285,22 +453,39 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0}; // 默认比较结果，初始化为-1.0
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
-    // 如果几何关系已缓存，则直接获取
-    comparision_result = geometry_cache.at(actor_id_key);
-    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
-    // 交换参考车辆到其他车辆的距离和相反方向的距离
-    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
-    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+  // 缓存的结果只在两辆车的边界都没有改变时有效
+  const std::shared_ptr<const BoundaryGeometry> reference_geometry = GetBoundaryGeometry(reference_vehicle_id);
+  const std::shared_ptr<const BoundaryGeometry> other_geometry = GetBoundaryGeometry(other_actor_id);
+  const bool reference_is_first = key_parts.first == reference_vehicle_id;
+  const BoundarySignature &first_signature = reference_is_first ? reference_geometry->signature : other_geometry->signature;
+  const BoundarySignature &second_signature = reference_is_first ? other_geometry->signature : reference_geometry->signature;
+
+  bool is_cached = false;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = geometry_cache.find(actor_id_key);
+    if (it != geometry_cache.end()
+        && it->second.first_signature == first_signature
+        && it->second.second_signature == second_signature) {
+      comparision_result = it->second.comparison;
+      it->second.last_used_cycle = cycle_number;
+      is_cached = true;
+    }
+  }
+  if (is_cached) {
+    // 缓存的结果以键中较小的 ID 为参考车辆
+    if (!reference_is_first) {
+      // 交换参考车辆到其他车辆的距离和相反方向的距离
+      double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
+      comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
+      comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+    }
   } else {
-    // 获取参考车辆的边界多边形
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    // 获取其他实体的边界多边形
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
-    // 获取参考车辆的地理边界多边形
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
-    //获取其他实体的地理边界多边形
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    // 参考车辆和其他实体的边界框多边形以及路径边界多边形
+    const Polygon &reference_polygon = reference_geometry->polygon;
+    const Polygon &other_polygon = other_geometry->polygon;
+    const Polygon &reference_geodesic_polygon = reference_geometry->geodesic_polygon;
+    const Polygon &other_geodesic_polygon = other_geometry->geodesic_polygon;
     // 计算参考车辆到其他实体地理边界的距离
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     // 计算其他实体到参考车辆地理边界的距离
@@ -314,8 +499,13 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               other_vehicle_to_reference_geodesic,
               inter_geodesic_distance,
               inter_bbox_distance};
-    // 将结果缓存
-    geometry_cache.insert({actor_id_key, comparision_result});
+    // 将结果以键中较小的 ID 为参考车辆缓存
+    GeometryComparison cached_result = comparision_result;
+    if (!reference_is_first) {
+      std::swap(cached_result.reference_vehicle_to_other_geodesic, cached_result.other_vehicle_to_reference_geodesic);
+    }
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    geometry_cache[actor_id_key] = CachedGeometryComparison{first_signature, second_signature, cached_result, cycle_number};
   }
 
   return comparision_result; // 返回几何比较结果
@@ -323,7 +513,8 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          boost::optional<CollisionLock> &reference_lock) {
   // 方法的输出变量
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
@@ -347,7 +538,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id, reference_lock.get_ptr());
   float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
   // 计算车辆之间考虑碰撞协商的最小距离
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
@@ -404,8 +595,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // 这使得我们能够平稳地接近前车
 
       // 当发现可能的碰撞时，检查是否存在碰撞锁的条目
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock) {
+        CollisionLock &lock = *reference_lock;
         // 检查同一车辆是否处于锁定状态
         if (other_actor_id == lock.lead_vehicle_id) {
           // 如果领头车辆的车身与参考车辆的边界框接触
@@ -422,25 +613,40 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // 如果锁条目不存在，则插入并初始化锁条目
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock = CollisionLock{geometry_comparison.inter_bbox_distance,
+                                       geometry_comparison.inter_bbox_distance,
+                                       other_actor_id};
       }
     }
   }
 
   // 如果没有检测到碰撞危险，则清除车辆持有的碰撞锁定
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard) {
+    reference_lock = boost::none;
   }
 
   return {hazard, available_distance_margin};
 }
 
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
-  geometry_cache.clear();
+  // 静止车辆的条目每个周期都会被使用；只删除长时间未使用的，包括已经销毁的参与者
+  const auto is_stale = [this](const uint64_t last_used_cycle) {
+    return cycle_number - last_used_cycle > BOUNDARY_CACHE_RETENTION_CYCLES;
+  };
+  for (auto it = geodesic_boundary_map.begin(); it != geodesic_boundary_map.end();) {
+    if (is_stale(it->second.last_used_cycle)) {
+      it = geodesic_boundary_map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = geometry_cache.begin(); it != geometry_cache.end();) {
+    if (is_stale(it->second.last_used_cycle)) {
+      it = geometry_cache.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 } // namespace traffic_manager
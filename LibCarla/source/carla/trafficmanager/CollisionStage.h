@@ -2,6 +2,9 @@
 #pragma once // 防止头文件重复包含
 
 #include <memory> // 引入智能指针的支持
+#include <mutex>
+
+#include <boost/optional.hpp>
 
 #if defined(__clang__) // 如果使用 clang 编译器
 #  pragma clang diagnostic push // 保存当前警告状态
@@ -15,11 +18,14 @@
 #  pragma clang diagnostic pop // 恢复之前的警告状态
 #endif
 
+#include "carla/trafficmanager/ActorSpatialHash.h" // 引入查找附近参与者的网格
+#include "carla/trafficmanager/Constants.h" // 引入常量的定义
 #include "carla/trafficmanager/DataStructures.h" // 引入数据结构的定义
 #include "carla/trafficmanager/Parameters.h" // 引入参数的定义
 #include "carla/trafficmanager/RandomGenerator.h" // 引入随机数生成器的定义
 #include "carla/trafficmanager/SimulationState.h" // 引入仿真状态的定义
 #include "carla/trafficmanager/Stage.h" // 引入阶段的定义
+#include "carla/trafficmanager/TrackTraffic.h" // 引入交通跟踪的定义
 
 namespace carla { // 定义 carla 命名空间
 namespace traffic_manager { // 定义 traffic_manager 命名空间
@@ -44,10 +50,55 @@ namespace bg = boost::geometry; // 简化 boost::geometry 的命名空间
 using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>; // 定义 waypoint 缓冲区
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>; // 定义缓冲区映射表
 using LocationVector = std::vector<cg::Location>; // 定义位置向量
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>; // 定义测地边界映射表
-using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>; // 定义几何比较映射表
 using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>; // 定义多边形类型
 
+/// 决定参与者边界的输入经过量化后的值：位置、朝向、边界扩展长度以及路径缓冲区
+/// 的版本（首尾路径点和长度）。与缓存中的值相同时边界不需要重新计算。
+struct BoundarySignature {
+  int64_t x, y, z;
+  int64_t heading_x, heading_y;
+  int64_t extension;
+  uint64_t buffer_front_id, buffer_back_id;
+  uint64_t buffer_size;
+
+  bool operator==(const BoundarySignature &rhs) const {
+    return x == rhs.x && y == rhs.y && z == rhs.z &&
+           heading_x == rhs.heading_x && heading_y == rhs.heading_y &&
+           extension == rhs.extension &&
+           buffer_front_id == rhs.buffer_front_id &&
+           buffer_back_id == rhs.buffer_back_id &&
+           buffer_size == rhs.buffer_size;
+  }
+
+  bool operator!=(const BoundarySignature &rhs) const {
+    return !(*this == rhs);
+  }
+};
+
+/// 一个参与者的边界框和路径边界，以及由它们构造的多边形。
+struct BoundaryGeometry {
+  BoundarySignature signature;
+  LocationVector geodesic_boundary;
+  Polygon polygon;
+  Polygon geodesic_polygon;
+};
+
+struct CachedBoundary {
+  std::shared_ptr<const BoundaryGeometry> geometry;
+  uint64_t last_used_cycle;
+};
+
+/// 两个参与者的几何比较结果，只在两者的边界都没有改变时有效。
+struct CachedGeometryComparison {
+  BoundarySignature first_signature;
+  BoundarySignature second_signature;
+  GeometryComparison comparison;
+  uint64_t last_used_cycle;
+};
+
+using GeodesicBoundaryMap = std::unordered_map<ActorId, CachedBoundary>; // 定义测地边界映射表
+using GeometryComparisonMap = std::unordered_map<uint64_t, CachedGeometryComparison>; // 定义几何比较映射表
+
 /// 该类具有检测与附近演员潜在碰撞的功能。
 class CollisionStage : Stage { // 定义 CollisionStage 类，继承自 Stage
 private:
@@ -57,28 +108,58 @@ private:
   const TrackTraffic &track_traffic; // 跟踪交通
   const Parameters &parameters; // 参数
   CollisionFrame &output_array; // 输出数组
-  CollisionLockMap collision_locks; // 存储阻塞的前方车辆信息
+  // 存储阻塞的前方车辆信息。本周期的 Update 只读取上一周期的碰撞锁，
+  // 新的碰撞锁写入 next_collision_locks 中车辆对应的位置，由
+  // ApplyCollisionLocks 统一应用，因此不同车辆的 Update 可以并行执行
+  CollisionLockMap collision_locks;
+  std::vector<boost::optional<CollisionLock>> next_collision_locks;
+  // DetailLevel::Reduced 的车辆上一次检测碰撞的结果，在不检测的周期中重用。
+  // 与碰撞锁一样，本周期的结果先写入 next_reduced_detail_hazards
+  std::unordered_map<ActorId, CollisionHazardData> reduced_detail_hazards;
+  std::vector<boost::optional<CollisionHazardData>> next_reduced_detail_hazards;
+  uint64_t cycle_number = 0u; // PrepareCycle 的调用次数，用于错开各车辆检测碰撞的周期
+  // 车辆边界及其几何比较结果的缓存，跨周期保留，只在参与者的位置、朝向、
+  // 边界扩展或者路径缓冲区改变时重新计算，因此静止的车辆不需要重新构造多边形
   GeometryComparisonMap geometry_cache; // 存储车辆边界的几何比较结果
   GeodesicBoundaryMap geodesic_boundary_map; // 存储车辆的测地边界
-  RandomGenerator &random_device; // 随机数生成器
+  std::mutex cache_mutex; // 保护 geometry_cache 和 geodesic_boundary_map
+  // 按位置索引所有参与者的网格，每个周期在 PrepareCycle 中重建，用于查找碰撞候选
+  ActorSpatialHash actor_spatial_hash{constants::Collision::SPATIAL_HASH_CELL_SIZE};
+  // 随机数生成器，每辆车使用自己的随机数流，不需要加锁
+  RandomGenerator &random_device;
 
-  // 方法：确定车辆是否与另一辆车处于碰撞路径
+  // 方法：确定车辆是否与另一辆车处于碰撞路径，并更新参考车辆的碰撞锁 @a reference_lock
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
-
-  // 方法：计算车辆前方的边界框扩展长度
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            boost::optional<CollisionLock> &reference_lock);
+
+  // 方法：DetailLevel::Mesoscopic 的车辆不比较几何形状，只把路径重叠的车辆中
+  // 位于前方的最近一辆作为危险，距离余量为两车中心距离减去两车的半长
+  CollisionHazardData GetMesoscopicHazard(const ActorId ego_actor_id,
+                                          const ActorStateIndex ego_state_index,
+                                          const VehicleParameters &ego_parameters) const;
+  // 方法：计算车辆前方的边界框扩展长度，使用上一周期的碰撞锁
   float GetBoundingBoxExtention(const ActorId actor_id);
 
+  // 方法：按碰撞锁 @a lock（可以为空）计算车辆前方的边界框扩展长度
+  float GetBoundingBoxExtention(const ActorId actor_id, const CollisionLock *lock);
+
   // 方法：计算车辆边界的多边形点
   LocationVector GetBoundary(const ActorId actor_id);
 
   // 方法：构造车辆路径边界的多边形点
   LocationVector GetGeodesicBoundary(const ActorId actor_id);
 
+  // 方法：计算车辆当前的边界签名
+  BoundarySignature GetBoundarySignature(const ActorId actor_id);
+
+  // 方法：返回车辆当前的边界和多边形，签名未改变时使用缓存
+  std::shared_ptr<const BoundaryGeometry> GetBoundaryGeometry(const ActorId actor_id);
+
   Polygon GetPolygon(const LocationVector &boundary); // 获取多边形对象
 
-  // 方法：比较路径边界、车辆的边界框，并缓存当前更新周期的结果
+  // 方法：比较路径边界、车辆的边界框，并缓存结果直到其中一辆车的边界改变
   GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
                                               const ActorId other_actor_id);
 
@@ -95,13 +176,20 @@ public:
                  CollisionFrame &output_array,
                  RandomGenerator &random_device);
 
-  void Update (const unsigned long index) override; // 更新方法
+  // 更新方法。调用之前需要调用 PrepareCycle；不同 @a index 的调用可以在不同线程中同时进行
+  void Update (const unsigned long index) override;
 
   void RemoveActor(const ActorId actor_id) override; // 移除参与者方法
 
   void Reset() override; // 重置方法
 
-  // 方法：清除当前更新周期的缓存
+  // 方法：在本周期调用 Update 之前，为每辆车准备碰撞锁的写缓冲，并重建参与者网格
+  void PrepareCycle();
+
+  // 方法：在本周期所有 Update 完成之后，应用写缓冲中的碰撞锁和低细节层次车辆的碰撞结果
+  void ApplyCollisionLocks();
+
+  // 方法：删除最近 BOUNDARY_CACHE_RETENTION_CYCLES 个周期中没有使用过的缓存条目
   void ClearCycleCache();
 };
 
@@ -35,8 +35,14 @@ static const float HYBRID_MODE_DT_FL = 0.05f; // 混合模式时的时间步长
 static const double HYBRID_MODE_DT = 0.05; // 混合模式时的时间步长（双精度）
 static const double INV_HYBRID_DT = 1.0 / HYBRID_MODE_DT; // 混合模式时间步长的倒数
 static const float PHYSICS_RADIUS = 50.0f; // 物理半径
+static const uint64_t REDUCED_DETAIL_COLLISION_INTERVAL = 5u; // 低细节层次车辆检测碰撞的周期间隔
 } // namespace HybridMode
 
+namespace ActorTracking {
+static const float UNREGISTERED_TRACKING_RADIUS_MIN = 50.0f; // 跟踪已注册车辆附近未注册参与者的最小半径
+static const float UNREGISTERED_TRACKING_RADIUS_RATE = 4.0f; // 跟踪半径随车速增加的比率（秒）
+} // namespace ActorTracking
+
 namespace SpeedThreshold {
 static const float HIGHWAY_SPEED = 60.0f / 3.6f; // 高速公路速度（米/秒）
 static const float AFTER_JUNCTION_MIN_SPEED = 5.0f / 3.6f; // 交叉口后最小速度（米/秒）
@@ -87,6 +93,10 @@ static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon(); // 
 static const float MIN_REFERENCE_DISTANCE = 0.5f; // 最小参考距离
 static const float MIN_VELOCITY_COLL_RADIUS = 2.0f; // 最小速度碰撞半径
 static const float VEL_EXT_FACTOR = 0.36f; // 速度扩展因子
+static const float SPATIAL_HASH_CELL_SIZE = 25.0f; // 查找附近参与者的网格单元边长
+static const float BOUNDARY_CACHE_LOCATION_QUANTUM = 0.01f; // 边界缓存中位置和边界扩展的量化步长（米）
+static const float BOUNDARY_CACHE_HEADING_QUANTUM = 0.001f; // 边界缓存中朝向单位向量分量的量化步长
+static const uint64_t BOUNDARY_CACHE_RETENTION_CYCLES = 10u; // 缓存条目在多少个周期未被使用后删除
 } // namespace Collision
 
 namespace FrameMemory {
@@ -105,6 +115,8 @@ static float const DELTA = 25.0f; // 增量
 static float const Z_DELTA = 500.0f; // Z轴增量
 static float const STRAIGHT_DEG = 19.0f; // 直行角度
 static const double MIN_LANE_WIDTH = 1.0f; // 最小车道宽度
+static const uint32_t CACHE_FILE_MAGIC = 0x434D5443u; // 缓存文件的标识（"CTMC"）
+static const uint32_t CACHE_FILE_VERSION = 1u; // 缓存文件格式的版本，格式改变时递增
 } // namespace Map
 
 namespace TrafficLight {
@@ -159,6 +171,16 @@ static const uint64_t BUFFER_STEP_THROUGH = 5; // 缓冲步骤
 static const float INV_BUFFER_STEP_THROUGH = 1.0f / static_cast<float>(BUFFER_STEP_THROUGH); // 缓冲步骤的倒数
 } // namespace TrackTraffic
 
+namespace RoutePlanning {
+static const size_t NUMBER_OF_LANDMARKS = 8u; // ALT启发函数使用的地标数量
+static const size_t MAX_CACHED_ROUTES = 8192u; // 路线缓存的最大条目数，超过后清空
+} // namespace RoutePlanning
+
+namespace Sharding {
+static const float BOUNDARY_MARGIN = 50.0f; // 分片区域外仍跟踪其他参与者的距离
+static const float HANDOFF_HYSTERESIS = 5.0f; // 车辆离开分片区域超过该距离后才移交给相邻分片
+} // namespace Sharding
+
 } // namespace constants
 } // namespace traffic_manager
 } // namespace carla
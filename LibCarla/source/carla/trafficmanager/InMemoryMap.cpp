@@ -4,11 +4,17 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/ContentHash.h"
+#include "carla/Exception.h"
 #include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include <boost/geometry/geometries/box.hpp>
+
+#include <sstream>
+#include <stdexcept>
 // 定义在carla命名空间下的traffic_manager命名空间
 namespace carla {
 namespace traffic_manager {
@@ -99,9 +105,24 @@ namespace traffic_manager {
       return;
     }
 
+    Write(out_file);
+
+    out_file.close();
+    return;
+  }
+
+  void InMemoryMap::Write(std::ostream &out_stream) {
+    // 写入文件头：标识、格式版本和 OpenDRIVE 内容标识
+    out_stream.write(reinterpret_cast<const char *>(&CACHE_FILE_MAGIC), sizeof(uint32_t));
+    out_stream.write(reinterpret_cast<const char *>(&CACHE_FILE_VERSION), sizeof(uint32_t));
+    const std::string &hash = GetOpenDriveHash();
+    uint16_t hash_size = static_cast<uint16_t>(hash.size());
+    out_stream.write(reinterpret_cast<const char *>(&hash_size), sizeof(uint16_t));
+    out_stream.write(hash.data(), hash_size);
+
     // 将所有记录的总数写入文件中
     uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+    out_stream.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
 
     // 创建或记录一些基本的导航点
     std::unordered_set<uint64_t> used_ids;
@@ -110,13 +131,10 @@ namespace traffic_manager {
         log_error("Could not generate the binary file. There are repeated waypoints");
       }
       CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+      cached_wp.Write(out_stream);
 
       used_ids.insert(wp->GetId());
     }
-
-    out_file.close();
-    return;
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
@@ -124,55 +142,130 @@ namespace traffic_manager {
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
 
-    // 读取总记录数
-    uint32_t total;
-    memcpy(&total, &content[pos], sizeof(total));
-    pos += sizeof(total);
-
-    // 读取简单航点
-    for (uint32_t i=0; i < total; i++) {
-      CachedSimpleWaypoint cached_wp;
-      cached_wp.Read(content, pos);
-      cached_waypoints.push_back(cached_wp);
-      id2index.insert({cached_wp.waypoint_id, i});
-
-      WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(cached_wp.road_id, cached_wp.lane_id, cached_wp.s);
-      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
-      wp->SetGeodesicGridId(cached_wp.geodesic_grid_id);
-      wp->SetIsJunction(cached_wp.is_junction);
-      wp->SetRoadOption(static_cast<RoadOption>(cached_wp.road_option));
-      dense_topology.push_back(wp);
-    }
-
-    // 连接航点
-    for (uint32_t i=0; i < dense_topology.size(); i++) {
-      auto wp = dense_topology.at(i);
-      auto cached_wp = cached_waypoints.at(i);
-
-      std::vector<SimpleWaypointPtr> next_waypoints;
-      for (auto id : cached_wp.next_waypoints) {
-        next_waypoints.push_back(dense_topology.at(id2index.at(id)));
+    auto read_value = [&](void *out_obj, size_t size) {
+      if (pos + size > content.size()) {
+        throw_exception(std::out_of_range("truncated InMemoryMap cache"));
       }
-      std::vector<SimpleWaypointPtr> previous_waypoints;
-      for (auto id : cached_wp.previous_waypoints) {
-        previous_waypoints.push_back(dense_topology.at(id2index.at(id)));
+      memcpy(out_obj, &content[pos], size);
+      pos += size;
+    };
+
+    try {
+      // 检查文件头。没有标识的文件是旧格式，第一个字段直接是记录总数，
+      // 无法确认它属于此地图
+      uint32_t magic = 0u;
+      read_value(&magic, sizeof(magic));
+      if (magic == CACHE_FILE_MAGIC) {
+        uint32_t version = 0u;
+        read_value(&version, sizeof(version));
+        if (version != CACHE_FILE_VERSION) {
+          log_warning("InMemoryMap cache has format version", version, "expected", CACHE_FILE_VERSION);
+          return false;
+        }
+        uint16_t hash_size = 0u;
+        read_value(&hash_size, sizeof(hash_size));
+        std::string hash(hash_size, '\0');
+        read_value(&hash[0], hash_size);
+        if (hash != GetOpenDriveHash()) {
+          log_warning("InMemoryMap cache was generated for a different OpenDRIVE file");
+          return false;
+        }
+      } else {
+        log_warning("InMemoryMap cache has no version information, it can not be checked against the map");
+        pos = 0u;
       }
-      wp->SetNextWaypoint(next_waypoints);
-      wp->SetPreviousWaypoint(previous_waypoints);
-      if (cached_wp.next_left_waypoint > 0) {
-        wp->SetLeftWaypoint(dense_topology.at(id2index.at(cached_wp.next_left_waypoint)));
+
+      // 读取总记录数
+      uint32_t total;
+      read_value(&total, sizeof(total));
+
+      // 读取简单航点
+      for (uint32_t i=0; i < total; i++) {
+        CachedSimpleWaypoint cached_wp;
+        cached_wp.Read(content, pos);
+        cached_waypoints.push_back(cached_wp);
+        id2index.insert({cached_wp.waypoint_id, i});
+
+        WaypointPtr waypoint_ptr = _world_map->GetWaypointXODR(cached_wp.road_id, cached_wp.lane_id, cached_wp.s);
+        if (waypoint_ptr == nullptr) {
+          throw_exception(std::out_of_range("InMemoryMap cache refers to a missing lane"));
+        }
+        SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
+        wp->SetGeodesicGridId(cached_wp.geodesic_grid_id);
+        wp->SetIsJunction(cached_wp.is_junction);
+        wp->SetRoadOption(static_cast<RoadOption>(cached_wp.road_option));
+        dense_topology.push_back(wp);
       }
-      if (cached_wp.next_right_waypoint > 0) {
-        wp->SetRightWaypoint(dense_topology.at(id2index.at(cached_wp.next_right_waypoint)));
+
+      // 连接航点
+      for (uint32_t i=0; i < dense_topology.size(); i++) {
+        auto wp = dense_topology.at(i);
+        auto cached_wp = cached_waypoints.at(i);
+
+        std::vector<SimpleWaypointPtr> next_waypoints;
+        for (auto id : cached_wp.next_waypoints) {
+          next_waypoints.push_back(dense_topology.at(id2index.at(id)));
+        }
+        std::vector<SimpleWaypointPtr> previous_waypoints;
+        for (auto id : cached_wp.previous_waypoints) {
+          previous_waypoints.push_back(dense_topology.at(id2index.at(id)));
+        }
+        wp->SetNextWaypoint(next_waypoints);
+        wp->SetPreviousWaypoint(previous_waypoints);
+        if (cached_wp.next_left_waypoint > 0) {
+          wp->SetLeftWaypoint(dense_topology.at(id2index.at(cached_wp.next_left_waypoint)));
+        }
+        if (cached_wp.next_right_waypoint > 0) {
+          wp->SetRightWaypoint(dense_topology.at(id2index.at(cached_wp.next_right_waypoint)));
+        }
       }
+    } catch (const std::exception &e) {
+      log_warning("failed to load InMemoryMap cache:", e.what());
+      dense_topology.clear();
+      return false;
     }
 
     // 创建空间树
     SetUpSpatialTree();
 
+    // 创建紧凑路径点图
+    waypoint_graph.Build(dense_topology);
+
     return true;
   }
 
+  const std::string &InMemoryMap::GetOpenDriveHash() {
+    if (open_drive_hash.empty()) {
+      assert(_world_map != nullptr && "No map reference found.");
+      open_drive_hash = ContentHash::Compute(_world_map->GetOpenDrive());
+    }
+    return open_drive_hash;
+  }
+
+  std::string InMemoryMap::GetContentCachePath() {
+    return std::string("ContentCache/") + GetOpenDriveHash() + ".tm.bin";
+  }
+
+  bool InMemoryMap::LoadFromContentCache() {
+    const std::string path = GetContentCachePath();
+    const std::vector<uint8_t> content = cc::FileTransfer::ReadFile(path);
+    if (content.empty()) {
+      return false;
+    }
+    log_debug("using cached InMemoryMap", path);
+    return Load(content);
+  }
+
+  void InMemoryMap::SaveToContentCache() {
+    std::ostringstream out_stream(std::ios::binary);
+    Write(out_stream);
+    const std::string data = out_stream.str();
+    const std::string path = GetContentCachePath();
+    if (!cc::FileTransfer::WriteFile(path, reinterpret_cast<const uint8_t *>(data.data()), data.size())) {
+      log_warning("could not save InMemoryMap cache", path);
+    }
+  }
+
   void InMemoryMap::SetUp() {
 
     // 1. 构建路段拓扑（即，定义路段的前驱和后继集合）
@@ -373,16 +466,23 @@ namespace traffic_manager {
 
     // 为每个 SimpleWaypoint 指定一个 RoadOption
     SetUpRoadOption();
+
+    // 所有连接和道路选项确定之后创建紧凑路径点图
+    waypoint_graph.Build(dense_topology);
   }
 
   void InMemoryMap::SetUpSpatialTree() {
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
     for (auto &simple_waypoint: dense_topology) {
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, simple_waypoint);
       }
     }
+    // 路点建好以后不再改变，一次性打包建树比逐个插入快，查询也更快
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -518,6 +618,10 @@ namespace traffic_manager {
     return dense_topology;
   }
 
+  const WaypointGraph &InMemoryMap::GetWaypointGraph() const {
+    return waypoint_graph;
+  }
+
   void InMemoryMap::FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint) {
 
     const WaypointPtr raw_waypoint = reference_waypoint->GetWaypoint();
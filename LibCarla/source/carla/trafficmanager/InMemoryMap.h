@@ -32,6 +32,7 @@
 #include "carla/trafficmanager/RandomGenerator.h"  // 引入随机生成器定义
 #include "carla/trafficmanager/SimpleWaypoint.h"  // 引入简单路径点定义
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"  // 引入缓存的简单路径点定义
+#include "carla/trafficmanager/WaypointGraph.h"  // 引入紧凑路径点图定义
 
 namespace carla {
 namespace traffic_manager {
@@ -69,6 +70,10 @@ private:
     NodeList dense_topology;
     /// 用于索引和查询路径点的空间二维R树。
     Rtree rtree;
+    /// dense_topology的紧凑表示，按索引遍历路径点之间的连接。
+    WaypointGraph waypoint_graph;
+    /// 世界地图 OpenDRIVE 内容的 ContentHash，第一次使用时计算。
+    std::string open_drive_hash;
 
 public:
 
@@ -78,7 +83,15 @@ public:
     static void Cook(WorldMap world_map, const std::string& path);  // 静态方法，用于处理地图并保存到指定路径
 
     //bool Load(const std::string& filename);  // 加载地图的方法（未实现）
-    bool Load(const std::vector<uint8_t>& content);  // 从字节内容加载地图的方法
+    /// 从缓存文件的内容加载本地地图。文件的格式版本或 OpenDRIVE 标识与当前地图
+    /// 不符、或内容不完整时返回 false，此时需要调用 SetUp 重新构建。
+    bool Load(const std::vector<uint8_t>& content);
+
+    /// 从客户端按 OpenDRIVE 内容标识保存的缓存中加载本地地图，没有可用的缓存时返回 false。
+    bool LoadFromContentCache();
+
+    /// 把本地地图保存到客户端按 OpenDRIVE 内容标识保存的缓存中，供之后启动的交通管理器使用。
+    void SaveToContentCache();
 
     /// 此方法以采样分辨率构建本地地图。
     void SetUp();
@@ -92,6 +105,9 @@ public:
     /// 此方法返回本地缓存中离散样本的完整列表。
     NodeList GetDenseTopology() const;
 
+    /// 此方法返回本地地图的紧凑路径点图，在SetUp或Load之后有效。
+    const WaypointGraph &GetWaypointGraph() const;
+
     std::string GetMapName();  // 获取地图名称
 
     const cc::Map& GetMap() const;  // 获取地图引用
@@ -99,6 +115,14 @@ public:
 private:
     void Save(const std::string& path);  // 保存地图到指定路径
 
+    void Write(std::ostream &out_stream);  // 将地图写入输出流
+
+    /// 返回世界地图 OpenDRIVE 内容的 ContentHash，用于确认缓存文件属于此地图。
+    const std::string &GetOpenDriveHash();
+
+    /// 客户端缓存中此地图文件的路径。
+    std::string GetContentCachePath();
+
     void SetUpDenseTopology();  // 设置稠密拓扑
     void SetUpSpatialTree();  // 设置空间树
     void SetUpRoadOption();  // 设置道路选项
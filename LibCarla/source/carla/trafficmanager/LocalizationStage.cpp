@@ -40,9 +40,10 @@ void LocalizationStage::Update(const unsigned long index) {
 
     // 获取当前车辆的ID和相关信息
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
+  const ActorStateIndex state_index = simulation_state.GetVehicleIndex(index);
+  const cg::Location vehicle_location = simulation_state.GetLocation(state_index);
+  const cg::Vector3D heading_vector = simulation_state.GetHeading(state_index);
+  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(state_index);
   const float vehicle_speed = vehicle_velocity_vector.Length();
 
   // 速度相关的航点视野长度
@@ -90,9 +91,10 @@ void LocalizationStage::Update(const unsigned long index) {
       bool front_waypoint_junction = front_waypoint->CheckJunction();
       is_at_junction_entrance = !front_waypoint_junction && look_ahead_point->CheckJunction();
       if (!is_at_junction_entrance) {
-        std::vector<SimpleWaypointPtr> last_passed_waypoints = front_waypoint->GetPreviousWaypoint();
+        const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
+        const WaypointGraph::IndexRange last_passed_waypoints = waypoint_graph.GetPrevious(front_waypoint->GetGraphIndex());
         if (last_passed_waypoints.size() == 1) {
-          is_at_junction_entrance = !last_passed_waypoints.front()->CheckJunction() && front_waypoint_junction;
+          is_at_junction_entrance = !waypoint_graph.GetNode(last_passed_waypoints.front()).is_junction && front_waypoint_junction;
         }
       }
       if (is_at_junction_entrance
@@ -119,18 +121,23 @@ void LocalizationStage::Update(const unsigned long index) {
   }
 
   // 分配变道
-  const ChangeLaneInfo lane_change_info = parameters.GetForceLaneChange(actor_id);
+  const VehicleParameters &vehicle_parameters = parameters.GetVehicleParameters(index);
+  const ChangeLaneInfo lane_change_info = vehicle_parameters.force_lane_change ? parameters.GetForceLaneChange(actor_id) : ChangeLaneInfo{};
   bool force_lane_change = lane_change_info.change_lane;
   bool lane_change_direction = lane_change_info.direction;
 
+  // 最低细节层次的车辆只执行强制变道
+  const bool is_mesoscopic = simulation_state.GetDetailLevel(state_index) == DetailLevel::Mesoscopic;
+
   //应用保持右侧规则和随机变道参数
-  if (!force_lane_change && vehicle_speed > MIN_LANE_CHANGE_SPEED){
-    const float perc_keep_right = parameters.GetKeepRightPercentage(actor_id);
-    const float perc_random_leftlanechange = parameters.GetRandomLeftLaneChangePercentage(actor_id);
-    const float perc_random_rightlanechange = parameters.GetRandomRightLaneChangePercentage(actor_id);
-    const bool is_keep_right = perc_keep_right > random_device.next();
-    const bool is_random_left_change = perc_random_leftlanechange >= random_device.next();
-    const bool is_random_right_change = perc_random_rightlanechange >= random_device.next();
+  if (!force_lane_change && !is_mesoscopic && vehicle_speed > MIN_LANE_CHANGE_SPEED){
+    const float perc_keep_right = vehicle_parameters.perc_keep_right;
+    const float perc_random_leftlanechange = vehicle_parameters.perc_random_left;
+    const float perc_random_rightlanechange = vehicle_parameters.perc_random_right;
+    RandomStream lane_change_random = random_device.GetStream(actor_id, RandomStreamId::LaneChange);
+    const bool is_keep_right = perc_keep_right > lane_change_random.next();
+    const bool is_random_left_change = perc_random_leftlanechange >= lane_change_random.next();
+    const bool is_random_right_change = perc_random_rightlanechange >= lane_change_random.next();
 
     //确定应应用的参数
     if (is_keep_right || is_random_right_change) {
@@ -143,7 +150,7 @@ void LocalizationStage::Update(const unsigned long index) {
         lane_change_direction = false;
       } else {
         // 左右车道变更都是强制性的。请在其中选择一个
-        lane_change_direction = FIFTYPERC > random_device.next();
+        lane_change_direction = FIFTYPERC > lane_change_random.next();
       }
     }
   }
@@ -158,7 +165,7 @@ void LocalizationStage::Update(const unsigned long index) {
     done_with_previous_lane_change = distance_frm_previous > lane_change_distance;
     if (done_with_previous_lane_change) last_lane_change_swpt.erase(actor_id);
   }
-  bool auto_or_force_lane_change = parameters.GetAutoLaneChange(actor_id) || force_lane_change;
+  bool auto_or_force_lane_change = (!is_mesoscopic && vehicle_parameters.auto_lane_change) || force_lane_change;
   bool front_waypoint_not_junction = !front_waypoint->CheckJunction();
 
   if (auto_or_force_lane_change
@@ -182,8 +189,8 @@ void LocalizationStage::Update(const unsigned long index) {
     }
   }
 
-  Path imported_path = parameters.GetCustomPath(actor_id);
-  Route imported_actions = parameters.GetImportedRoute(actor_id);
+  Path imported_path = vehicle_parameters.custom_path ? parameters.GetCustomPath(actor_id) : Path{};
+  Route imported_actions = vehicle_parameters.imported_route ? parameters.GetImportedRoute(actor_id) : Route{};
   // 我们实际上是在导入一个路径
   if (!imported_path.empty()) {
 
@@ -197,13 +204,18 @@ void LocalizationStage::Update(const unsigned long index) {
 
   // 通过随机选择航点填充缓冲区
   else {
-    while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
-      SimpleWaypointPtr furthest_waypoint = waypoint_buffer.back();
-      std::vector<SimpleWaypointPtr> next_waypoints = furthest_waypoint->GetNextWaypoint();
+    // 沿紧凑路径点图按索引扩展，只在压入缓冲区时取出 SimpleWaypointPtr
+    const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
+    const cg::Location front_location = waypoint_buffer.front()->GetLocation();
+    const uint64_t front_id = waypoint_buffer.front()->GetId();
+    WaypointIndex furthest_index = waypoint_buffer.back()->GetGraphIndex();
+    RandomStream path_random = random_device.GetStream(actor_id, RandomStreamId::PathSelection);
+    while (cg::Math::DistanceSquared(waypoint_graph.GetNode(furthest_index).location, front_location) <= horizon_square) {
+      const WaypointGraph::IndexRange next_waypoints = waypoint_graph.GetNext(furthest_index);
       uint64_t selection_index = 0u;
       // 伪随机路径选择，如果发现多个选择
       if (next_waypoints.size() > 1) {
-        double r_sample = random_device.next();
+        double r_sample = path_random.next();
         selection_index = static_cast<uint64_t>(r_sample*next_waypoints.size()*0.01);
       } else if (next_waypoints.size() == 0) {
         if (!parameters.GetOSMMode()) {
@@ -212,9 +224,10 @@ void LocalizationStage::Update(const unsigned long index) {
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      furthest_index = next_waypoints[selection_index];
+      SimpleWaypointPtr next_wp_selection = waypoint_graph.GetWaypoint(furthest_index);
       PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
-      if (next_wp_selection->GetId() == waypoint_buffer.front()->GetId()){
+      if (next_wp_selection->GetId() == front_id){
         // 发现了一个环，停止。不要使用零距离，因为可能有两个航点在同一位置
         break;
       }
@@ -234,9 +247,6 @@ void LocalizationStage::Update(const unsigned long index) {
     output.junction_end_point = nullptr;
     output.safe_point = nullptr;
   }
-
-  // 更新参与者的测地线网格位置
-  track_traffic.UpdateGridPosition(actor_id, waypoint_buffer);
 }
 
 void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
@@ -275,12 +285,13 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
 
     // 如果未找到安全点，则扩展缓冲区
     if (!safe_point_found) {
+      const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
       bool abort = false;
 
       while (!past_junction && !abort) {
-        NodeList next_waypoints = current_waypoint->GetNextWaypoint();
+        const WaypointGraph::IndexRange next_waypoints = waypoint_graph.GetNext(current_waypoint->GetGraphIndex());
         if (!next_waypoints.empty()) {
-          current_waypoint = next_waypoints.front();
+          current_waypoint = waypoint_graph.GetWaypoint(next_waypoints.front());
           PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
           if (!current_waypoint->CheckJunction()) {
             past_junction = true;
@@ -292,7 +303,7 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
 
       while (!safe_point_found && !abort) {
-        std::vector<SimpleWaypointPtr> next_waypoints = current_waypoint->GetNextWaypoint();
+        const WaypointGraph::IndexRange next_waypoints = waypoint_graph.GetNext(current_waypoint->GetGraphIndex());
         if ((junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared)
             || next_waypoints.size() > 1
             || current_waypoint->CheckJunction()) {
@@ -301,7 +312,7 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
           safe_point_after_junction = current_waypoint;
         } else {
           if (!next_waypoints.empty()) {
-            current_waypoint = next_waypoints.front();
+            current_waypoint = waypoint_graph.GetWaypoint(next_waypoints.front());
             PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
           } else {
             abort = true;
@@ -447,11 +458,14 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
     if (change_over_point != nullptr) {
       const float change_over_distance = cg::Math::Clamp(1.5f * vehicle_speed, MIN_WPT_DISTANCE, MAX_WPT_DISTANCE);
-      const SimpleWaypointPtr starting_point = change_over_point;
-      while (change_over_point->DistanceSquared(starting_point) < SQUARE(change_over_distance) &&
-             !change_over_point->CheckJunction()) {
-        change_over_point = change_over_point->GetNextWaypoint().front();
+      const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
+      const cg::Location starting_location = change_over_point->GetLocation();
+      WaypointIndex change_over_index = change_over_point->GetGraphIndex();
+      while (cg::Math::DistanceSquared(waypoint_graph.GetNode(change_over_index).location, starting_location) < SQUARE(change_over_distance) &&
+             !waypoint_graph.GetNode(change_over_index).is_junction) {
+        change_over_index = waypoint_graph.GetNext(change_over_index).front();
       }
+      change_over_point = waypoint_graph.GetWaypoint(change_over_index);
     }
   }
 
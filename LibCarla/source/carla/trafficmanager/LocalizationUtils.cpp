@@ -42,6 +42,7 @@ void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和
   const uint64_t waypoint_id = waypoint->GetId(); // 获取航点ID
   buffer.push_back(waypoint); // 将航点添加到缓冲区
   track_traffic.UpdatePassingVehicle(waypoint_id, actor_id); // 更新经过该航点的车辆信息
+  track_traffic.AddPathGrid(actor_id, waypoint->GetGeodesicGridId()); // 更新路径所在的网格
 }
 
 // 从缓冲区中移除一个航点并更新经过的车辆信息
@@ -55,6 +56,7 @@ void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和
     buffer.pop_back(); // 移除后方航点
   }
   track_traffic.RemovePassingVehicle(removed_waypoint_id, actor_id); // 更新经过的车辆信息
+  track_traffic.RemovePathGrid(actor_id, removed_waypoint->GetGeodesicGridId()); // 更新路径所在的网格
 }
 
 // 获取目标航点及其索引
@@ -60,20 +60,49 @@ MotionPlanStage::MotionPlanStage(
     random_device(random_device),
     local_map(local_map) {}
 
+void MotionPlanStage::UpdateWorldInfo() {
+  UpdateWorldInfo(world.GetSnapshot().GetTimestamp());
+}
+
+void MotionPlanStage::UpdateWorldInfo(const cc::Timestamp &timestamp) {
+  current_timestamp = timestamp;
+  actuation_batch.Resize(vehicle_id_list.size());
+  actuation_states.assign(vehicle_id_list.size(), nullptr);
+}
+
+void MotionPlanStage::PartitionForParallelUpdate(std::vector<unsigned long> &parallel_indices,
+                                                 std::vector<unsigned long> &sequential_indices) {
+  parallel_indices.clear();
+  sequential_indices.clear();
+  for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+    const ActorId actor_id = vehicle_id_list.at(index);
+    const ActorStateIndex state_index = simulation_state.GetVehicleIndex(index);
+    // 与 Update 中选择 PID 控制器的条件相同
+    if (simulation_state.IsPhysicsEnabled(state_index) && !simulation_state.IsDormant(state_index)) {
+      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
+        pid_state_map.insert({actor_id, StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f}});
+      }
+      parallel_indices.push_back(index);
+    } else {
+      sequential_indices.push_back(index);
+    }
+  }
+}
+
 void MotionPlanStage::Update(const unsigned long index) {
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+  const ActorStateIndex state_index = simulation_state.GetVehicleIndex(index);
+  const cg::Location vehicle_location = simulation_state.GetLocation(state_index);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(state_index);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(state_index);
   const float vehicle_speed = vehicle_velocity.Length();
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(state_index);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(state_index);
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(state_index);
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
   const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // 实例化传送变换为当前载具变换
@@ -83,7 +112,7 @@ void MotionPlanStage::Update(const unsigned long index) {
   cg::Location hero_location = track_traffic.GetHeroLocation();
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+  if (simulation_state.IsDormant(state_index) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
     // 冲洗车辆的控制器状态
     current_state = {current_timestamp,
                     0.0f, 0.0f,
@@ -103,7 +132,8 @@ void MotionPlanStage::Update(const unsigned long index) {
     double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
 
     if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
-      float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
+      RandomStream respawn_random = random_device.GetStream(actor_id, RandomStreamId::Respawn);
+      float random_sample = (static_cast<float>(respawn_random.next())*dilate_factor) + lower_bound;
       NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
       if (!teleport_waypoint_list.empty()) {
         for (auto &teleport_waypoint : teleport_waypoint_list) {
@@ -123,7 +153,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     KinematicState kinematic_state{teleportation_transform.location,
                                    teleportation_transform.rotation,
                                    vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
+                                   vehicle_physics_enabled, simulation_state.IsDormant(state_index),
                                    teleportation_transform.location};
     simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
@@ -131,10 +161,11 @@ void MotionPlanStage::Update(const unsigned long index) {
   else {
 
     // 目标车速
-    float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
+    const VehicleParameters &vehicle_parameters = parameters.GetVehicleParameters(index);
+    float max_target_velocity = vehicle_parameters.GetTargetVelocity(vehicle_speed_limit) / 3.6f;
 
     // 接近地标时减速的算法
-    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
+    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, vehicle_parameters, max_target_velocity);
 
     // 转弯处减速算法
     float max_turn_target_velocity = GetTurnTargetVelocity(waypoint_buffer, max_target_velocity);
@@ -152,15 +183,14 @@ void MotionPlanStage::Update(const unsigned long index) {
     // 遇到碰撞或交通灯危险时
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {
-      ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};
+    if (vehicle_physics_enabled && !simulation_state.IsDormant(state_index)) {
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
                                                   MIN_TARGET_WAYPOINT_DISTANCE);
       const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;
       cg::Location target_location = target_waypoint->GetLocation();
 
-      float offset = parameters.GetLaneOffset(actor_id);
+      float offset = vehicle_parameters.lane_offset;
       auto right_vector = target_waypoint->GetTransform().GetRightVector();
       auto offset_location = cg::Location(cg::Vector3D(offset*right_vector.x, offset*right_vector.y, 0.0f));
       target_location = target_location + offset_location;
@@ -179,47 +209,16 @@ void MotionPlanStage::Update(const unsigned long index) {
         pid_state_map.insert({actor_id, initial_state});
       }
 
-      // 检索先前状态
-      traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
-
-      // 选择PID参数
-      std::vector<float> longitudinal_parameters;
-      std::vector<float> lateral_parameters;
-      if (vehicle_speed > HIGHWAY_SPEED) {
-        longitudinal_parameters = highway_longitudinal_parameters;
-        lateral_parameters = highway_lateral_parameters;
-      } else {
-        longitudinal_parameters = urban_longitudinal_parameters;
-        lateral_parameters = urban_lateral_parameters;
-      }
-
-      //如果为车辆启用了物理效果，请使用PID控制器
-      // 车辆状态更新
-      current_state = {current_timestamp, angular_deviation, velocity_deviation, 0.0f};
-
-      // 控制器驱动
-      actuation_signal = PID::RunStep(current_state, previous_state,
-                                      longitudinal_parameters, lateral_parameters);
-
-      if (emergency_stop) {
-        actuation_signal.throttle = 0.0f;
-        actuation_signal.brake = 1.0f;
-      }
-
-      // 构建执行信号
-
-      carla::rpc::VehicleControl vehicle_control;
-      vehicle_control.throttle = actuation_signal.throttle;
-      vehicle_control.brake = actuation_signal.brake;
-      vehicle_control.steer = actuation_signal.steer;
-
-      output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(actor_id, vehicle_control);
-
-      // 更新PID状态
-      current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
-      state = current_state;
+      // 记录控制器的输入，执行信号由 ApplyActuation 对所有车辆批量计算
+      StateEntry &previous_state = pid_state_map.at(actor_id);
+      actuation_batch.angular_deviation[index] = angular_deviation;
+      actuation_batch.velocity_deviation[index] = velocity_deviation;
+      actuation_batch.previous_angular_deviation[index] = previous_state.angular_deviation;
+      actuation_batch.previous_velocity_deviation[index] = previous_state.velocity_deviation;
+      actuation_batch.previous_steer[index] = previous_state.steer;
+      actuation_batch.highway[index] = vehicle_speed > HIGHWAY_SPEED;
+      actuation_batch.emergency_stop[index] = emergency_stop;
+      actuation_states[index] = &previous_state;
     }
     // 对于无物理特性的载具，确定传送时的位置和方向
     else {
@@ -258,7 +257,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       // 在紧急停止的情况下，请保持在同一位置
       // 此外，在异步模式下，每 dt 时间仅传送一次
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(state_index));
       }
       // 构建执行信号
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
@@ -267,6 +266,32 @@ void MotionPlanStage::Update(const unsigned long index) {
   }
 }
 
+void MotionPlanStage::ApplyActuation() {
+  PID::RunBatch(actuation_batch,
+                urban_longitudinal_parameters, highway_longitudinal_parameters,
+                urban_lateral_parameters, highway_lateral_parameters);
+
+  for (unsigned long index = 0u; index < actuation_states.size(); ++index) {
+    StateEntry *state = actuation_states[index];
+    if (state == nullptr) {
+      continue;
+    }
+
+    // 构建执行信号
+    carla::rpc::VehicleControl vehicle_control;
+    vehicle_control.throttle = actuation_batch.throttle[index];
+    vehicle_control.brake = actuation_batch.brake[index];
+    vehicle_control.steer = actuation_batch.steer[index];
+    output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(vehicle_id_list.at(index), vehicle_control);
+
+    // 更新PID状态
+    *state = StateEntry{current_timestamp,
+                        actuation_batch.angular_deviation[index],
+                        actuation_batch.velocity_deviation[index],
+                        actuation_batch.steer[index]};
+  }
+}
+
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {
@@ -359,7 +384,7 @@ std::pair<bool, float> MotionPlanStage::CollisionHandling(const CollisionHazardD
 
 float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
                                                  const cg::Location vehicle_location,
-                                                 const ActorId actor_id,
+                                                 const VehicleParameters &vehicle_parameters,
                                                  float max_target_velocity) {
 
     auto const max_distance = LANDMARK_DETECTION_TIME * max_target_velocity;
@@ -387,7 +412,7 @@ float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
         minimum_velocity = YIELD_TARGET_VELOCITY;
       } else if (landmark_type == "274") {  // 速度限制
         float value = static_cast<float>(landmark->GetValue()) / 3.6f;
-        value = parameters.GetVehicleTargetVelocity(actor_id, value);
+        value = vehicle_parameters.GetTargetVelocity(value);
         minimum_velocity = (value < max_target_velocity) ? value : max_target_velocity;
       } else {
         continue;
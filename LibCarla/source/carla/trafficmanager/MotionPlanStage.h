@@ -8,6 +8,7 @@
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
 #include "carla/trafficmanager/Parameters.h"
+#include "carla/trafficmanager/PIDBatch.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
 #include "carla/trafficmanager/Stage.h"
@@ -38,11 +39,16 @@ private:
   const cc::World &world;
   // Structure holding the controller state for registered vehicles.
   std::unordered_map<ActorId, StateEntry> pid_state_map;
+  // 本周期使用 PID 控制器的车辆的控制器输入和输出，按车辆索引存放。
+  PID::ActuationBatch actuation_batch;
+  // 每个车辆索引在 pid_state_map 中的控制器状态，本周期不使用 PID 控制器的车辆为空。
+  // unordered_map 插入时不会使已有元素的指针失效。
+  std::vector<StateEntry *> actuation_states;
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;// 当前时间戳。
+  cc::Timestamp current_timestamp;// 当前时间戳，每个周期由 UpdateWorldInfo 更新一次。
   RandomGenerator &random_device;// 引用随机数生成器对象。
   const LocalMapPtr &local_map;// 引用本地地图指针对象。
 // 处理碰撞的私有方法。
@@ -58,7 +64,7 @@ private:
  // 根据地标获取目标速度的私有方法。
   float GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
                                   const cg::Location vehicle_location,
-                                  const ActorId actor_id,
+                                  const VehicleParameters &vehicle_parameters,
                                   float max_target_velocity);
 // 根据路点缓冲区获取转弯目标速度的私有方法。
   float GetTurnTargetVelocity(const Buffer &waypoint_buffer,
@@ -86,8 +92,22 @@ public:
                   ControlFrame &output_array,
                   RandomGenerator &random_device,
                   const LocalMapPtr &local_map);
- // 更新方法，根据给定的索引进行更新。
+ // 获取本周期的时间戳并为本周期的控制器输入分配空间，在本周期调用 Update 之前调用。
+  void UpdateWorldInfo();
+ // 与 UpdateWorldInfo 相同，但使用给定的时间戳而不向模拟器请求快照，供没有模拟器的基准测试使用。
+  void UpdateWorldInfo(const cc::Timestamp &timestamp);
+ // 将车辆索引分为可以并行更新的和必须顺序更新的两部分。使用 PID 控制器的
+ // 车辆的 Update 只写入自己的控制器状态和输出，此方法会预先为它们插入控制器
+ // 状态条目，之后可以在不同线程中同时调用它们的 Update；被传送的车辆会修改
+ // 交通跟踪和模拟状态，必须在并行部分结束后顺序更新。
+  void PartitionForParallelUpdate(std::vector<unsigned long> &parallel_indices,
+                                  std::vector<unsigned long> &sequential_indices);
+ // 更新方法，根据给定的索引进行更新。使用 PID 控制器的车辆只记录控制器输入，
+ // 控制命令由 ApplyActuation 统一写入。
   void Update(const unsigned long index);
+ // 对本周期所有使用 PID 控制器的车辆批量计算执行信号，写入控制命令并更新控制器
+ // 状态。在本周期所有 Update 之后调用一次。
+  void ApplyActuation();
 // 移除指定 actor 的方法。
   void RemoveActor(const ActorId actor_id);
 // 重置方法。
@@ -0,0 +1,164 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "carla/trafficmanager/Constants.h"
+
+namespace carla {
+namespace traffic_manager {
+namespace PID {
+
+  /// 一组车辆的 PID 控制器输入和输出，每个数组的第 i 个元素属于同一辆车。
+  ///
+  /// 输入和输出按数组分别存放，RunBatch 的循环没有分支和查找，编译器可以把它
+  /// 向量化（SSE/AVX2/NEON，取决于编译选项）。数组的长度补齐到 LANES 的倍数，
+  /// 补齐的元素的结果没有意义。
+  struct ActuationBatch {
+    /// 每次循环处理的车辆数，为 AVX2 一个寄存器中 float 的个数。
+    static constexpr size_t LANES = 8u;
+
+    std::vector<float> angular_deviation;
+    std::vector<float> velocity_deviation;
+    std::vector<float> previous_angular_deviation;
+    std::vector<float> previous_velocity_deviation;
+    std::vector<float> previous_steer;
+    /// 非零时使用高速公路的参数。
+    std::vector<uint32_t> highway;
+    /// 非零时忽略纵向控制的结果，全力刹车。
+    std::vector<uint32_t> emergency_stop;
+
+    std::vector<float> throttle;
+    std::vector<float> brake;
+    std::vector<float> steer;
+
+    /// 车辆数，不含补齐的元素。
+    size_t Size() const {
+      return number_of_vehicles;
+    }
+
+    void Resize(const size_t size) {
+      number_of_vehicles = size;
+      const size_t padded_size = (size + LANES - 1u) / LANES * LANES;
+      angular_deviation.resize(padded_size);
+      velocity_deviation.resize(padded_size);
+      previous_angular_deviation.resize(padded_size);
+      previous_velocity_deviation.resize(padded_size);
+      previous_steer.resize(padded_size);
+      highway.resize(padded_size);
+      emergency_stop.resize(padded_size);
+      throttle.resize(padded_size);
+      brake.resize(padded_size);
+      steer.resize(padded_size);
+    }
+
+  private:
+
+    size_t number_of_vehicles = 0u;
+  };
+
+namespace detail {
+
+  /// 一组 PID 参数与时间步长合并后的增益。
+  struct Gains {
+    float kp_v, ki_v, kd_v;
+    float kp_a, ki_a, kd_a;
+
+    Gains(const std::vector<float> &longitudinal_parameters, const std::vector<float> &lateral_parameters)
+      : kp_v(longitudinal_parameters[0]),
+        ki_v(longitudinal_parameters[1] * constants::PID::DT),
+        kd_v(longitudinal_parameters[2] * constants::PID::INV_DT),
+        kp_a(lateral_parameters[0]),
+        ki_a(lateral_parameters[1] * constants::PID::DT),
+        kd_a(lateral_parameters[2] * constants::PID::INV_DT) {}
+  };
+
+  /// RunBatch 的循环，处理 @a number_of_blocks 组、每组 ActuationBatch::LANES 辆车。
+  /// 数组互不重叠，参数用 __restrict 声明；内层循环的次数固定，编译器不需要在
+  /// 运行时检查别名，也不需要处理剩余的元素，在 -O2 下就可以向量化。
+  inline void RunBatchKernel(
+      const size_t number_of_blocks,
+      const Gains urban,
+      const Gains highway,
+      const float *__restrict angular_deviation,
+      const float *__restrict velocity_deviation,
+      const float *__restrict previous_angular_deviation,
+      const float *__restrict previous_velocity_deviation,
+      const float *__restrict previous_steer,
+      const uint32_t *__restrict is_highway,
+      const uint32_t *__restrict emergency_stop,
+      float *__restrict throttle,
+      float *__restrict brake,
+      float *__restrict steer) {
+    using namespace constants::PID;
+
+    constexpr size_t LANES = ActuationBatch::LANES;
+    for (size_t block = 0u; block < number_of_blocks; ++block) {
+      for (size_t i = block * LANES; i < (block + 1u) * LANES; ++i) {
+        const bool use_highway = is_highway[i] != 0u;
+        const float kp_v = use_highway ? highway.kp_v : urban.kp_v;
+        const float ki_v = use_highway ? highway.ki_v : urban.ki_v;
+        const float kd_v = use_highway ? highway.kd_v : urban.kd_v;
+        const float kp_a = use_highway ? highway.kp_a : urban.kp_a;
+        const float ki_a = use_highway ? highway.ki_a : urban.ki_a;
+        const float kd_a = use_highway ? highway.kd_a : urban.kd_a;
+
+        // 纵向控制：正值为油门，负值为刹车
+        const float expr_v =
+            kp_v * velocity_deviation[i] +
+            ki_v * (velocity_deviation[i] + previous_velocity_deviation[i]) +
+            kd_v * (velocity_deviation[i] - previous_velocity_deviation[i]);
+        const bool is_emergency_stop = emergency_stop[i] != 0u;
+        const float throttle_value = std::min(std::max(expr_v, 0.0f), MAX_THROTTLE);
+        const float brake_value = std::min(std::max(-expr_v, 0.0f), MAX_BRAKE);
+        throttle[i] = is_emergency_stop ? 0.0f : throttle_value;
+        brake[i] = is_emergency_stop ? 1.0f : brake_value;
+
+        // 横向控制，限制每一步转向的变化和转向的范围
+        float steer_value =
+            kp_a * angular_deviation[i] +
+            ki_a * (angular_deviation[i] + previous_angular_deviation[i]) +
+            kd_a * (angular_deviation[i] - previous_angular_deviation[i]);
+        steer_value = std::max(previous_steer[i] - MAX_STEERING_DIFF,
+                               std::min(steer_value, previous_steer[i] + MAX_STEERING_DIFF));
+        steer[i] = std::max(-MAX_STEERING, std::min(steer_value, MAX_STEERING));
+      }
+    }
+  }
+
+} // namespace detail
+
+  /// 对 @a batch 中的每辆车进行与 RunStep 相同的计算，紧急刹车的车辆油门为 0、
+  /// 刹车为 1。参数的格式与 RunStep 相同：{比例, 积分, 微分}。
+  inline void RunBatch(
+      ActuationBatch &batch,
+      const std::vector<float> &urban_longitudinal_parameters,
+      const std::vector<float> &highway_longitudinal_parameters,
+      const std::vector<float> &urban_lateral_parameters,
+      const std::vector<float> &highway_lateral_parameters) {
+    detail::RunBatchKernel(
+        batch.angular_deviation.size() / ActuationBatch::LANES,
+        detail::Gains(urban_longitudinal_parameters, urban_lateral_parameters),
+        detail::Gains(highway_longitudinal_parameters, highway_lateral_parameters),
+        batch.angular_deviation.data(),
+        batch.velocity_deviation.data(),
+        batch.previous_angular_deviation.data(),
+        batch.previous_velocity_deviation.data(),
+        batch.previous_steer.data(),
+        batch.highway.data(),
+        batch.emergency_stop.data(),
+        batch.throttle.data(),
+        batch.brake.data(),
+        batch.steer.data());
+  }
+
+} // namespace PID
+} // namespace traffic_manager
+} // namespace carla
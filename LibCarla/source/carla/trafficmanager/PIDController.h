@@ -6,7 +6,7 @@
 
 #pragma once
 
-##include <algorithm>  // 引入算法库
+#include <algorithm>  // 引入算法库
 
 #include "carla/trafficmanager/Constants.h"  // 引入常量定义
 #include "carla/trafficmanager/DataStructures.h"  // 引入数据结构定义
@@ -6,6 +6,7 @@
 
 #include "carla/trafficmanager/Parameters.h"  // 引入参数头文件
 #include "carla/trafficmanager/Constants.h"  // 引入常量头文件
+#include "carla/Logging.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -24,6 +25,10 @@ void Parameters::SetHybridPhysicsMode(const bool mode_switch) {  // 设置混合
   hybrid_physics_mode.store(mode_switch);  // 存储模式开关状态
 }
 
+void Parameters::SetStageWorkerThreads(const uint32_t number_of_threads) {  // 设置阶段的线程数
+  stage_worker_threads.store(number_of_threads);
+}
+
 void Parameters::SetRespawnDormantVehicles(const bool mode_switch) {  // 设置重生休眠车辆
   respawn_dormant_vehicles.store(mode_switch);  // 存储重生休眠车辆的状态
 }
@@ -44,11 +49,13 @@ void Parameters::SetPercentageSpeedDifference(const ActorPtr &actor, const float
   if (exact_desired_speed.Contains(actor->GetId())) {  // 如果参与者的精确期望速度存在
     exact_desired_speed.RemoveEntry(actor->GetId());  // 移除该参与者的精确期望速度
   }
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetLaneOffset(const ActorPtr &actor, const float offset) {  // 设置车道偏移
   const auto entry = std::make_pair(actor->GetId(), offset);  // 创建参与者ID和偏移的条目
   lane_offset.AddEntry(entry);  // 添加车道偏移记录
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {  // 设置期望速度
@@ -57,15 +64,18 @@ void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {  //
   if (percentage_difference_from_speed_limit.Contains(actor->GetId())) {  // 如果速度差记录存在
     percentage_difference_from_speed_limit.RemoveEntry(actor->GetId());  // 移除该参与者的速度差记录
   }
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetGlobalPercentageSpeedDifference(const float percentage) {  // 设置全局速度差百分比
   float new_percentage = std::min(100.0f, percentage);  // 限制最大百分比为100
   global_percentage_difference_from_limit = new_percentage;  // 设置全局速度差
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetGlobalLaneOffset(const float offset) {  // 设置全局车道偏移
   global_lane_offset = offset;  // 设置全局偏移量
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const ActorPtr &other_actor, const bool detect_collision) {  // 设置碰撞检测
@@ -92,27 +102,32 @@ void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const Ac
       ignore_collision.AddEntry(entry);  // 添加条目到忽略碰撞列表
     }
   }
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction) {  // 设置强制变道
   const ChangeLaneInfo lane_change_info = {true, direction};  // 创建变道信息
   const auto entry = std::make_pair(actor->GetId(), lane_change_info);  // 创建参与者ID和变道信息的条目
   force_lane_change.AddEntry(entry);  // 添加变道记录
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetKeepRightPercentage(const ActorPtr &actor, const float percentage) {  // 设置保持右侧的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和保持右侧百分比的条目
   perc_keep_right.AddEntry(entry);  // 添加保持右侧记录
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetRandomLeftLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机左变道的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机左变道百分比的条目
   perc_random_left.AddEntry(entry);  // 添加随机左变道记录
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetRandomRightLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机右变道的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机右变道百分比的条目
   perc_random_right.AddEntry(entry);  // 添加随机右变道记录
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_update) {
@@ -121,6 +136,7 @@ void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_upd
     // 创建参与者ID和更新状态的条目
     auto_update_vehicle_lights.AddEntry(entry);
     // 将条目添加到自动更新车辆灯光列表中
+    ++vehicle_parameters_version;
 }
 
 void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
@@ -129,6 +145,7 @@ void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
     // 创建参与者ID和变道使能状态的条目
     auto_lane_change.AddEntry(entry);
     // 将条目添加到自动变道列表中
+    ++vehicle_parameters_version;
 }
 
 void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float distance) {
@@ -139,6 +156,7 @@ void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float
     // 创建参与者ID和距离的条目
     distance_to_leading_vehicle.AddEntry(entry);
     // 将条目添加到前车距离列表中
+    ++vehicle_parameters_version;
 }
 
 void Parameters::SetSynchronousMode(const bool mode_switch) {
@@ -154,6 +172,7 @@ void Parameters::SetSynchronousModeTimeOutInMiliSecond(const double time) {
 void Parameters::SetGlobalDistanceToLeadingVehicle(const float dist) {
     // 设置全局前车距离
    distance_margin.store(dist);
+   ++vehicle_parameters_version;
 }
 
 void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float perc) {
@@ -164,6 +183,7 @@ void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float pe
     // 创建参与者ID和百分比的条目
     perc_run_traffic_light.AddEntry(entry);
     // 将条目添加到运行信号灯百分比列表中
+    ++vehicle_parameters_version;
 }
 
 void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float perc) {
@@ -171,6 +191,7 @@ void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float per
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_run_traffic_sign.AddEntry(entry);
+   ++vehicle_parameters_version;
 }
 
 void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float perc) {
@@ -178,6 +199,7 @@ void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_ignore_vehicles.AddEntry(entry);
+   ++vehicle_parameters_version;
 }
 
 void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float perc) {
@@ -185,6 +207,65 @@ void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float p
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_ignore_walkers.AddEntry(entry);
+   ++vehicle_parameters_version;
+}
+
+void Parameters::SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) {
+  for (const VehicleParameterUpdate &update : updates) {
+    const ActorId actor_id = update.actor_id;
+    const float value = update.value;
+    switch (update.parameter) {
+      case VehicleParameter::PercentageSpeedDifference:
+        percentage_difference_from_speed_limit.AddEntry({actor_id, std::min(100.0f, value)});
+        exact_desired_speed.RemoveEntry(actor_id);
+        break;
+      case VehicleParameter::LaneOffset:
+        lane_offset.AddEntry({actor_id, value});
+        break;
+      case VehicleParameter::DesiredSpeed:
+        exact_desired_speed.AddEntry({actor_id, std::max(0.0f, value)});
+        percentage_difference_from_speed_limit.RemoveEntry(actor_id);
+        break;
+      case VehicleParameter::DistanceToLeadingVehicle:
+        distance_to_leading_vehicle.AddEntry({actor_id, std::max(0.0f, value)});
+        break;
+      case VehicleParameter::AutoLaneChange:
+        auto_lane_change.AddEntry({actor_id, value != 0.0f});
+        break;
+      case VehicleParameter::ForceLaneChange:
+        force_lane_change.AddEntry({actor_id, ChangeLaneInfo{true, value != 0.0f}});
+        break;
+      case VehicleParameter::UpdateVehicleLights:
+        auto_update_vehicle_lights.AddEntry({actor_id, value != 0.0f});
+        break;
+      case VehicleParameter::PercentageRunningLight:
+        perc_run_traffic_light.AddEntry({actor_id, cg::Math::Clamp(value, 0.0f, 100.0f)});
+        break;
+      case VehicleParameter::PercentageRunningSign:
+        perc_run_traffic_sign.AddEntry({actor_id, cg::Math::Clamp(value, 0.0f, 100.0f)});
+        break;
+      case VehicleParameter::PercentageIgnoreVehicles:
+        perc_ignore_vehicles.AddEntry({actor_id, cg::Math::Clamp(value, 0.0f, 100.0f)});
+        break;
+      case VehicleParameter::PercentageIgnoreWalkers:
+        perc_ignore_walkers.AddEntry({actor_id, cg::Math::Clamp(value, 0.0f, 100.0f)});
+        break;
+      case VehicleParameter::KeepRightPercentage:
+        perc_keep_right.AddEntry({actor_id, value});
+        break;
+      case VehicleParameter::RandomLeftLaneChangePercentage:
+        perc_random_left.AddEntry({actor_id, value});
+        break;
+      case VehicleParameter::RandomRightLaneChangePercentage:
+        perc_random_right.AddEntry({actor_id, value});
+        break;
+      default:
+        log_warning("SetVehicleParameters: unknown parameter", static_cast<int>(update.parameter));
+        continue;
+    }
+  }
+  // 整批只使参数块重新生成一次
+  ++vehicle_parameters_version;
 }
 
 void Parameters::SetHybridPhysicsRadius(const float radius) {
@@ -194,11 +275,21 @@ void Parameters::SetHybridPhysicsRadius(const float radius) {
     hybrid_physics_radius.store(new_radius);
 }
 
+void Parameters::SetMesoscopicRadius(const float radius) {
+    // 设置细节层次半径，确保半径不小于0
+    mesoscopic_radius.store(std::max(radius, 0.0f));
+}
+
 void Parameters::SetOSMMode(const bool mode_switch) {
     // 设置开放街图模式开关
     osm_mode.store(mode_switch);
 }
 
+void Parameters::SetShardLayout(std::shared_ptr<const ShardLayout> layout) {
+    // 设置分片区域，运行线程在每个周期开始时读取
+    std::atomic_store(&shard_layout, std::move(layout));
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     // 设置参与者的自定义路径
     const auto entry = std::make_pair(actor->GetId(), path);
@@ -207,6 +298,7 @@ void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const boo
     const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
     upload_path.AddEntry(entry2);
     // 将空缓冲区条目添加到上传路径列表中
+    ++vehicle_parameters_version;
 }
 
 void Parameters::RemoveUploadPath(const ActorId &actor_id, const bool remove_path) {
@@ -215,6 +307,7 @@ void Parameters::RemoveUploadPath(const ActorId &actor_id, const bool remove_pat
         upload_path.RemoveEntry(actor_id);
     } else {
         custom_path.RemoveEntry(actor_id);
+        ++vehicle_parameters_version;
     }
 }
 
@@ -233,6 +326,7 @@ void Parameters::SetImportedRoute(const ActorPtr &actor, const Route route, cons
     custom_route.AddEntry(entry);
     const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
     upload_route.AddEntry(entry2);
+    ++vehicle_parameters_version;
 }
 
 void Parameters::RemoveImportedRoute(const ActorId &actor_id, const bool remove_path) {
@@ -241,6 +335,7 @@ void Parameters::RemoveImportedRoute(const ActorId &actor_id, const bool remove_
         upload_route.RemoveEntry(actor_id);
     } else {
         custom_route.RemoveEntry(actor_id);
+        ++vehicle_parameters_version;
     }
 }
 
@@ -260,6 +355,11 @@ float Parameters::GetHybridPhysicsRadius() const {
    return hybrid_physics_radius.load();
 }
 
+float Parameters::GetMesoscopicRadius() const {
+    // 获取细节层次半径
+   return mesoscopic_radius.load();
+}
+
 bool Parameters::GetSynchronousMode() const {
     // 获取同步模式状态
     return synchronous_mode.load();
@@ -319,11 +419,11 @@ ChangeLaneInfo Parameters::GetForceLaneChange(const ActorId &actor_id) {
     // 如果参与者的强制车道变更存在，获取其信息
     if (force_lane_change.Contains(actor_id)) {
         change_lane_info = force_lane_change.GetValue(actor_id);
+        // 移除该参与者的强制车道变更条目，下一个周期的参数块不再需要读取
+        force_lane_change.RemoveEntry(actor_id);
+        ++vehicle_parameters_version;
     }
 
-    // 移除该参与者的强制车道变更条目
-    force_lane_change.RemoveEntry(actor_id);
-
    return change_lane_info; // 返回车道变更信息
 }
 
@@ -454,6 +554,11 @@ bool Parameters::GetHybridPhysicsMode() const {
    return hybrid_physics_mode.load();
 }
 
+uint32_t Parameters::GetStageWorkerThreads() const {
+    // 返回执行各阶段逐车辆更新的线程数
+   return stage_worker_threads.load();
+}
+
 bool Parameters::GetRespawnDormantVehicles() const {
     // 返回是否重新生成休眠车辆的设置
    return respawn_dormant_vehicles.load();
@@ -474,6 +579,11 @@ bool Parameters::GetOSMMode() const {
    return osm_mode.load();
 }
 
+std::shared_ptr<const ShardLayout> Parameters::GetShardLayout() const {
+    // 返回分片区域，未启用分片模式时为空
+   return std::atomic_load(&shard_layout);
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
     // 初始化自定义路径标志
     bool custom_path_bool = false;
@@ -522,6 +632,49 @@ Route Parameters::GetImportedRoute(const ActorId &actor_id) const {
    return custom_route_import; // 返回自定义路线
 }
 
+VehicleParameters Parameters::MakeVehicleParameters(const ActorId actor_id) {
+    VehicleParameters result;
+    result.use_exact_desired_speed =
+        !percentage_difference_from_speed_limit.Contains(actor_id) && exact_desired_speed.Contains(actor_id);
+    if (result.use_exact_desired_speed) {
+        result.exact_desired_speed = exact_desired_speed.GetValue(actor_id);
+    } else if (percentage_difference_from_speed_limit.Contains(actor_id)) {
+        result.percentage_speed_difference = percentage_difference_from_speed_limit.GetValue(actor_id);
+    } else {
+        result.percentage_speed_difference = global_percentage_difference_from_limit;
+    }
+    result.lane_offset = GetLaneOffset(actor_id);
+    result.distance_to_leading_vehicle = GetDistanceToLeadingVehicle(actor_id);
+    result.auto_lane_change = GetAutoLaneChange(actor_id);
+    result.update_vehicle_lights = GetUpdateVehicleLights(actor_id);
+    result.perc_run_traffic_light = GetPercentageRunningLight(actor_id);
+    result.perc_run_traffic_sign = GetPercentageRunningSign(actor_id);
+    result.perc_ignore_vehicles = GetPercentageIgnoreVehicles(actor_id);
+    result.perc_ignore_walkers = GetPercentageIgnoreWalkers(actor_id);
+    result.perc_keep_right = GetKeepRightPercentage(actor_id);
+    result.perc_random_left = GetRandomLeftLaneChangePercentage(actor_id);
+    result.perc_random_right = GetRandomRightLaneChangePercentage(actor_id);
+    result.ignores_collisions = ignore_collision.Contains(actor_id);
+    result.force_lane_change = force_lane_change.Contains(actor_id);
+    result.custom_path = custom_path.Contains(actor_id);
+    result.imported_route = custom_route.Contains(actor_id);
+    return result;
+}
+
+void Parameters::RefreshVehicleParameters(const std::vector<ActorId> &vehicle_id_list) {
+    // 先读取版本，生成期间的修改使下一个周期重新生成
+    const uint64_t version = vehicle_parameters_version.load();
+    if (version == built_vehicle_parameters_version && vehicle_id_list == vehicle_parameters_ids) {
+        return;
+    }
+    built_vehicle_parameters_version = version;
+    vehicle_parameters_ids = vehicle_id_list;
+    vehicle_parameters.resize(vehicle_id_list.size());
+    for (size_t i = 0u; i < vehicle_id_list.size(); ++i) {
+        vehicle_parameters[i] = MakeVehicleParameters(vehicle_id_list[i]);
+    }
+}
+
 
 } // namespace traffic_manager
 } // namespace carla
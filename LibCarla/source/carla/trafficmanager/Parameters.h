@@ -8,8 +8,10 @@
 
 #include <atomic>  /// 提供原子操作，确保线程安全
 #include <chrono>  /// 提供时间功能，用于时间计算
+#include <memory>  /// 提供智能指针
 #include <random>  /// 提供随机数生成功能
 #include <unordered_map> /// 提供无序映射容器，用于快速查找
+#include <vector>
 /// 包含Carla客户端相关的头文件
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
@@ -18,6 +20,8 @@
 
 #include "carla/trafficmanager/AtomicActorSet.h"/// 包含Carla交通管理器的相关头文件
 #include "carla/trafficmanager/AtomicMap.h"
+#include "carla/trafficmanager/ShardLayout.h"
+#include "carla/trafficmanager/VehicleParameterUpdate.h"
 
 namespace carla {
     namespace traffic_manager {
@@ -33,6 +37,42 @@ namespace carla {
             bool change_lane = false;/// 是否换道
             bool direction = false;/// 换道方向
         };
+        /// 一辆车的参数，已经代入了全局的默认值。
+        ///
+        /// 由 Parameters::RefreshVehicleParameters 在每个周期开始时按车辆列表的
+        /// 顺序生成，各阶段更新期间不会改变，按车辆索引不加锁地读取。周期中间的
+        /// 设置在下一个周期生效。
+        struct VehicleParameters {
+            /// 为 true 时目标速度为 exact_desired_speed，否则按限速和百分比计算
+            bool use_exact_desired_speed = false;
+            float exact_desired_speed = 0.0f;
+            float percentage_speed_difference = 0.0f;
+            float lane_offset = 0.0f;
+            float distance_to_leading_vehicle = 0.0f;
+            bool auto_lane_change = true;
+            bool update_vehicle_lights = false;
+            float perc_run_traffic_light = 0.0f;
+            float perc_run_traffic_sign = 0.0f;
+            float perc_ignore_vehicles = 0.0f;
+            float perc_ignore_walkers = 0.0f;
+            /// 小于 0 时不使用
+            float perc_keep_right = -1.0f;
+            float perc_random_left = -1.0f;
+            float perc_random_right = -1.0f;
+            /// 以下只表示 Parameters 中可能有这辆车的项，为 true 时再按 ID 读取
+            bool ignores_collisions = false;
+            bool force_lane_change = false;
+            bool custom_path = false;
+            bool imported_route = false;
+
+            /// 与 Parameters::GetVehicleTargetVelocity 相同
+            float GetTargetVelocity(const float speed_limit) const {
+                if (use_exact_desired_speed) {
+                    return exact_desired_speed;
+                }
+                return speed_limit * (1.0f - percentage_speed_difference / 100.0f);
+            }
+        };
         /// 交通管理参数
         class Parameters {
 
@@ -89,6 +129,10 @@ namespace carla {
             float max_upper_bound;
             /// 混合物理半径
             std::atomic<float> hybrid_physics_radius{ 70.0 };
+            /// 混合物理模式下细节层次的半径，为 0 时不区分细节层次
+            std::atomic<float> mesoscopic_radius{ 0.0f };
+            /// 执行各阶段逐车辆更新的线程数，不大于 1 时顺序执行
+            std::atomic<uint32_t> stage_worker_threads{ 1u };
             /// Open Street Map模式参数
             std::atomic<bool> osm_mode{ true };
             /// 是否导入自定义路径的参数映射
@@ -99,6 +143,16 @@ namespace carla {
             AtomicMap<ActorId, bool> upload_route;
             /// 存储所有自定义路线的结构
             AtomicMap<ActorId, Route> custom_route;
+            /// 分片模式下本交通管理器负责的区域，为空时不分片。用 std::atomic_load 和 std::atomic_store 访问
+            std::shared_ptr<const ShardLayout> shard_layout;
+            /// 影响 VehicleParameters 的设置每次修改后加一
+            std::atomic<uint64_t> vehicle_parameters_version{ 1u };
+            /// 以下只由交通管理器的线程在 RefreshVehicleParameters 中修改
+            uint64_t built_vehicle_parameters_version = 0u;
+            std::vector<ActorId> vehicle_parameters_ids;
+            std::vector<VehicleParameters> vehicle_parameters;
+
+            VehicleParameters MakeVehicleParameters(const ActorId actor_id);
 
         public:
             /// 构造函数
@@ -182,9 +236,18 @@ namespace carla {
             /// 设置混合物理半径的方法
             void SetHybridPhysicsRadius(const float radius);///< 混合物理半径值
 
+            /// 设置细节层次半径的方法
+            void SetMesoscopicRadius(const float radius);///< 细节层次半径值，为 0 时不区分细节层次
+
+            /// 设置执行各阶段逐车辆更新的线程数的方法
+            void SetStageWorkerThreads(const uint32_t number_of_threads);///< 线程数，不大于 1 时顺序执行
+
             /// 设置Open Street Map模式的方法
             void SetOSMMode(const bool mode_switch);///< 是否启用OSM模式的布尔值
 
+            /// 设置分片模式下本交通管理器负责的区域的方法
+            void SetShardLayout(std::shared_ptr<const ShardLayout> layout);///< 区域及相邻分片，为空时关闭分片模式
+
             /// 设置是否自动重生休眠车辆的方法
             void SetRespawnDormantVehicles(const bool mode_switch); ///< 是否启用的布尔值
 
@@ -212,11 +275,17 @@ namespace carla {
             /// 更新已设置路线的方法
             void UpdateImportedRoute(const ActorId& actor_id, const Route route);///< 车辆ID和新的路线数据
 
+            /// 按顺序应用一组车辆参数，每一项与对应的单个设置函数相同
+            void SetVehicleParameters(const std::vector<VehicleParameterUpdate>& updates);
+
             ///////////////////////////////// 获取器 /////////////////////////////////////
 
             /// 获取混合物理半径的方法
             float GetHybridPhysicsRadius() const;
 
+            /// 获取细节层次半径的方法
+            float GetMesoscopicRadius() const;
+
             /// 查询车辆目标速度的方法
             float GetVehicleTargetVelocity(const ActorId& actor_id, const float speed_limit) const;
 
@@ -268,6 +337,9 @@ namespace carla {
             /// 获取混合物理模式的方法
             bool GetHybridPhysicsMode() const;
 
+            /// 获取执行各阶段逐车辆更新的线程数的方法
+            uint32_t GetStageWorkerThreads() const;
+
             /// 获取是否自动重生载具的方法
             bool GetRespawnDormantVehicles() const;
 
@@ -280,6 +352,9 @@ namespace carla {
             /// 获取Open Street Map模式的方法
             bool GetOSMMode() const;
 
+            /// 获取分片模式下本交通管理器负责的区域的方法，未启用分片模式时为空
+            std::shared_ptr<const ShardLayout> GetShardLayout() const;
+
             /// 获取是否正在上传路径的方法
             bool GetUploadPath(const ActorId& actor_id) const;
 
@@ -292,6 +367,15 @@ namespace carla {
             /// 获取自定义路由的方法
             Route GetImportedRoute(const ActorId& actor_id) const;
 
+            /// 按 @a vehicle_id_list 的顺序生成每辆车的参数块，只在设置或车辆列表
+            /// 改变后重新生成。在本周期 ALSM 更新之后、各阶段更新之前调用
+            void RefreshVehicleParameters(const std::vector<ActorId>& vehicle_id_list);
+
+            /// 获取 vehicle_id_list 中第 @a vehicle_index 辆车的参数块
+            const VehicleParameters& GetVehicleParameters(const unsigned long vehicle_index) const {
+                return vehicle_parameters.at(vehicle_index);
+            }
+
             /// 同步模式超时变量
             std::chrono::duration<double, std::milli> synchronous_time_out;
         };
@@ -6,23 +6,106 @@
 // 引入无序映射相关头文件，虽然在此代码片段中未体现其具体使用，但可能在更广泛的上下文中会涉及
 #include <unordered_map>
 
-// 引入Carla项目中定义ActorId相关的头文件，此处代码未直接体现其使用，但可能与之相关联
+#include <cstdint>
+
+// 引入Carla项目中定义ActorId相关的头文件，用于按参与者划分随机数流
 #include "carla/rpc/ActorId.h"
 
 namespace carla {
 namespace traffic_manager {
 
+/// 随机数流的用途。同一辆车在同一帧中不同用途的随机数互不相关，
+/// 增加一处随机决策不会改变其它决策的结果。
+enum class RandomStreamId : uint32_t {
+  LaneChange,
+  PathSelection,
+  TrafficLight,
+  TrafficSign,
+  Collision,
+  Respawn,
+};
+
+/// 基于计数器的随机数流（Philox4x32-10）。每个数只由（种子、参与者、帧、用途、
+/// 序号）决定，没有共享状态，因此在多个线程中并行更新车辆时结果与线程调度无关。
+class RandomStream {
+public:
+
+  RandomStream(const uint64_t seed, const ActorId actor_id, const uint64_t frame, const RandomStreamId id)
+    : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32u)},
+      counter{0u,
+              static_cast<uint32_t>(id) | (static_cast<uint32_t>(frame >> 32u) << 8u),
+              static_cast<uint32_t>(actor_id),
+              static_cast<uint32_t>(frame)} {}
+
+  /// 返回流中的下一个数，范围为 [0, 100)，与 RandomGenerator::next() 相同。
+  double next() {
+    uint32_t block[4];
+    Philox(block);
+    ++counter[0];
+    // 用 53 位构造 [0, 1) 中的双精度数
+    const uint64_t bits = (static_cast<uint64_t>(block[0]) << 21u) | (block[1] >> 11u);
+    return static_cast<double>(bits) * (100.0 / 9007199254740992.0);
+  }
+
+private:
+
+  static void MulHiLo(const uint32_t a, const uint32_t b, uint32_t &hi, uint32_t &lo) {
+    const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    hi = static_cast<uint32_t>(product >> 32u);
+    lo = static_cast<uint32_t>(product);
+  }
+
+  void Philox(uint32_t (&out)[4]) const {
+    uint32_t c[4] = {counter[0], counter[1], counter[2], counter[3]};
+    uint32_t k[2] = {key[0], key[1]};
+    for (int round = 0; round < 10; ++round) {
+      uint32_t hi0, lo0, hi1, lo1;
+      MulHiLo(0xD2511F53u, c[0], hi0, lo0);
+      MulHiLo(0xCD9E8D57u, c[2], hi1, lo1);
+      const uint32_t next[4] = {hi1 ^ c[1] ^ k[0], lo1, hi0 ^ c[3] ^ k[1], lo0};
+      c[0] = next[0];
+      c[1] = next[1];
+      c[2] = next[2];
+      c[3] = next[3];
+      k[0] += 0x9E3779B9u;
+      k[1] += 0xBB67AE85u;
+    }
+    out[0] = c[0];
+    out[1] = c[1];
+    out[2] = c[2];
+    out[3] = c[3];
+  }
+
+  uint32_t key[2];
+
+  /// counter[0] 为流中的序号，其余为参与者、帧和用途。
+  uint32_t counter[4];
+};
+
 // 定义随机数生成器类，用于生成特定范围内的随机数
 class RandomGenerator {
 public:
     // 构造函数，接收一个无符号64位整数作为随机数生成器的种子
     // 使用该种子初始化一个基于梅森旋转算法的伪随机数生成器（std::mt19937），并设定生成的随机数范围为0.0到100.0
-    RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
-    
+    RandomGenerator(const uint64_t _seed): seed(_seed), mt(std::mt19937(_seed)), dist(0.0, 100.0) {}
+
     // 生成并返回下一个随机数，通过调用std::uniform_real_distribution的操作符，利用已初始化的随机数生成器（mt）来生成符合设定范围（0.0到100.0）的随机数
+    // 结果取决于调用顺序，不是线程安全的，车辆的更新中应使用 GetStream()
     double next() { return dist(mt); }
 
+    /// 设置当前帧，在每个循环开始、各阶段更新车辆之前调用。
+    void SetFrame(const uint64_t _frame) { frame = _frame; }
+
+    uint64_t GetFrame() const { return frame; }
+
+    /// 返回给定参与者在当前帧中用于 @a id 的随机数流。
+    RandomStream GetStream(const ActorId actor_id, const RandomStreamId id) const {
+      return RandomStream(seed, actor_id, frame, id);
+    }
+
 private:
+    uint64_t seed;
+    uint64_t frame = 0u;
     // 基于梅森旋转算法的伪随机数生成器对象，用于生成伪随机数序列的基础，其状态由传入的种子决定
     std::mt19937 mt;
     // 均匀分布的实数随机数分布对象，定义了生成随机数的范围（在此为0.0到100.0），与随机数生成器（mt）配合使用来生成符合该范围的随机数
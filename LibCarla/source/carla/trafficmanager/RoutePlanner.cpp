@@ -0,0 +1,386 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/RoutePlanner.h"
+
+#include "carla/trafficmanager/Constants.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+namespace carla {
+namespace traffic_manager {
+
+  using namespace constants::RoutePlanning;
+
+  constexpr RoutePlanner::ChainId RoutePlanner::INVALID_CHAIN;
+
+  static constexpr float INFINITE_COST = std::numeric_limits<float>::infinity();
+
+  RoutePlanner::RoutePlanner(LocalMapPtr map)
+    : local_map(std::move(map)),
+      waypoint_graph(local_map->GetWaypointGraph()) {
+    Initialize();
+  }
+
+  RoutePlanner::RoutePlanner(const WaypointGraph &graph)
+    : waypoint_graph(graph) {
+    Initialize();
+  }
+
+  void RoutePlanner::Initialize() {
+    BuildChains();
+    SelectLandmarks();
+  }
+
+  void RoutePlanner::BuildChains() {
+    const size_t number_of_waypoints = waypoint_graph.Size();
+    waypoint_chain.assign(number_of_waypoints, INVALID_CHAIN);
+    waypoint_position.assign(number_of_waypoints, 0u);
+    chain_offsets.clear();
+    chain_waypoints.clear();
+    chain_waypoints.reserve(number_of_waypoints);
+
+    // 前驱不唯一、或唯一的前驱有多个后继的路径点是链的起点
+    auto is_chain_head = [this](const WaypointIndex index) {
+      const auto previous = waypoint_graph.GetPrevious(index);
+      return previous.size() != 1u || waypoint_graph.GetNext(previous.front()).size() != 1u;
+    };
+
+    auto add_chain = [&](const WaypointIndex head) {
+      const ChainId chain = static_cast<ChainId>(chain_offsets.size());
+      chain_offsets.push_back(static_cast<uint32_t>(chain_waypoints.size()));
+      WaypointIndex current = head;
+      uint32_t position = 0u;
+      while (true) {
+        waypoint_chain[current] = chain;
+        waypoint_position[current] = position++;
+        chain_waypoints.push_back(current);
+        const auto next = waypoint_graph.GetNext(current);
+        if (next.size() != 1u
+            || waypoint_chain[next.front()] != INVALID_CHAIN
+            || is_chain_head(next.front())) {
+          break;
+        }
+        current = next.front();
+      }
+    };
+
+    for (WaypointIndex index = 0u; index < number_of_waypoints; ++index) {
+      if (waypoint_chain[index] == INVALID_CHAIN && is_chain_head(index)) {
+        add_chain(index);
+      }
+    }
+    // 剩下的路径点属于没有分支的环路，从任意一点开始
+    for (WaypointIndex index = 0u; index < number_of_waypoints; ++index) {
+      if (waypoint_chain[index] == INVALID_CHAIN) {
+        add_chain(index);
+      }
+    }
+    const size_t number_of_chains = chain_offsets.size();
+    chain_offsets.push_back(static_cast<uint32_t>(chain_waypoints.size()));
+
+    // 链之间的边，权重为链自身的长度加上到后继链起点的距离
+    std::vector<std::tuple<ChainId, ChainId, float>> edges;
+    for (ChainId chain = 0u; chain < number_of_chains; ++chain) {
+      const uint32_t begin = chain_offsets[chain];
+      const uint32_t end = chain_offsets[chain + 1u];
+      float length = 0.0f;
+      for (uint32_t i = begin + 1u; i < end; ++i) {
+        length += waypoint_graph.GetNode(chain_waypoints[i - 1u]).location.Distance(
+            waypoint_graph.GetNode(chain_waypoints[i]).location);
+      }
+      const WaypointIndex last = chain_waypoints[end - 1u];
+      for (const WaypointIndex next : waypoint_graph.GetNext(last)) {
+        const float weight = length + waypoint_graph.GetNode(last).location.Distance(
+            waypoint_graph.GetNode(next).location);
+        edges.emplace_back(chain, waypoint_chain[next], weight);
+      }
+    }
+
+    // 按 CSR 格式存放正向和反向的边
+    auto build_csr = [&](const bool reverse,
+                         std::vector<uint32_t> &offsets,
+                         std::vector<ChainId> &targets,
+                         std::vector<float> &weights) {
+      offsets.assign(number_of_chains + 1u, 0u);
+      for (const auto &edge : edges) {
+        ++offsets[(reverse ? std::get<1>(edge) : std::get<0>(edge)) + 1u];
+      }
+      for (size_t i = 1u; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1u];
+      }
+      targets.resize(edges.size());
+      weights.resize(edges.size());
+      std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+      for (const auto &edge : edges) {
+        const ChainId from = reverse ? std::get<1>(edge) : std::get<0>(edge);
+        const ChainId to = reverse ? std::get<0>(edge) : std::get<1>(edge);
+        targets[fill[from]] = to;
+        weights[fill[from]] = std::get<2>(edge);
+        ++fill[from];
+      }
+    };
+    build_csr(false, edge_offsets, edge_targets, edge_weights);
+    build_csr(true, reverse_edge_offsets, reverse_edge_targets, reverse_edge_weights);
+
+    g_score.assign(number_of_chains, INFINITE_COST);
+    came_from.assign(number_of_chains, INVALID_CHAIN);
+    visit_stamp.assign(number_of_chains, 0u);
+    current_stamp = 0u;
+  }
+
+  void RoutePlanner::SelectLandmarks() {
+    const size_t number_of_chains = chain_offsets.size() - 1u;
+    distances_from_landmark.clear();
+    distances_to_landmark.clear();
+    if (number_of_chains == 0u) {
+      return;
+    }
+
+    // 在链起点的位置上依次选择离已选地标最远的链作为地标
+    auto chain_location = [this](const ChainId chain) {
+      return waypoint_graph.GetNode(chain_waypoints[chain_offsets[chain]]).location;
+    };
+    std::vector<float> closest_landmark_distance(number_of_chains, INFINITE_COST);
+    const cg::Location first_location = chain_location(0u);
+    ChainId landmark = 0u;
+    float farthest = -1.0f;
+    for (ChainId chain = 0u; chain < number_of_chains; ++chain) {
+      const float distance = cg::Math::DistanceSquared(chain_location(chain), first_location);
+      if (distance > farthest) {
+        farthest = distance;
+        landmark = chain;
+      }
+    }
+
+    const size_t number_of_landmarks = std::min(NUMBER_OF_LANDMARKS, number_of_chains);
+    distances_from_landmark.resize(number_of_landmarks);
+    distances_to_landmark.resize(number_of_landmarks);
+    for (size_t l = 0u; l < number_of_landmarks; ++l) {
+      Dijkstra(landmark, edge_offsets, edge_targets, edge_weights, distances_from_landmark[l]);
+      Dijkstra(landmark, reverse_edge_offsets, reverse_edge_targets, reverse_edge_weights, distances_to_landmark[l]);
+
+      const cg::Location landmark_location = chain_location(landmark);
+      farthest = -1.0f;
+      ChainId next_landmark = landmark;
+      for (ChainId chain = 0u; chain < number_of_chains; ++chain) {
+        closest_landmark_distance[chain] = std::min(
+            closest_landmark_distance[chain],
+            cg::Math::DistanceSquared(chain_location(chain), landmark_location));
+        if (closest_landmark_distance[chain] > farthest) {
+          farthest = closest_landmark_distance[chain];
+          next_landmark = chain;
+        }
+      }
+      landmark = next_landmark;
+    }
+  }
+
+  void RoutePlanner::Dijkstra(
+      const ChainId source,
+      const std::vector<uint32_t> &offsets,
+      const std::vector<ChainId> &targets,
+      const std::vector<float> &weights,
+      std::vector<float> &distances) const {
+    using Entry = std::pair<float, ChainId>;
+    distances.assign(offsets.size() - 1u, INFINITE_COST);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    distances[source] = 0.0f;
+    open.emplace(0.0f, source);
+    while (!open.empty()) {
+      const Entry entry = open.top();
+      open.pop();
+      if (entry.first > distances[entry.second]) {
+        continue;
+      }
+      for (uint32_t e = offsets[entry.second]; e < offsets[entry.second + 1u]; ++e) {
+        const float distance = entry.first + weights[e];
+        if (distance < distances[targets[e]]) {
+          distances[targets[e]] = distance;
+          open.emplace(distance, targets[e]);
+        }
+      }
+    }
+  }
+
+  float RoutePlanner::Heuristic(const ChainId chain, const ChainId goal) const {
+    // 由三角不等式 d(L, goal) <= d(L, chain) + d(chain, goal) 和
+    // d(chain, L) <= d(chain, goal) + d(goal, L) 得到的下界
+    float bound = 0.0f;
+    for (size_t l = 0u; l < distances_from_landmark.size(); ++l) {
+      const float from_chain = distances_from_landmark[l][chain];
+      const float from_goal = distances_from_landmark[l][goal];
+      if (from_chain != INFINITE_COST && from_goal != INFINITE_COST) {
+        bound = std::max(bound, from_goal - from_chain);
+      }
+      const float to_chain = distances_to_landmark[l][chain];
+      const float to_goal = distances_to_landmark[l][goal];
+      if (to_chain != INFINITE_COST && to_goal != INFINITE_COST) {
+        bound = std::max(bound, to_chain - to_goal);
+      }
+    }
+    return bound;
+  }
+
+  RoutePlanner::ChainRoute RoutePlanner::FindChainRoute(const ChainId origin, const ChainId goal) {
+    ++current_stamp;
+    if (current_stamp == 0u) {
+      std::fill(visit_stamp.begin(), visit_stamp.end(), 0u);
+      current_stamp = 1u;
+    }
+    auto score = [this](const ChainId chain) {
+      return visit_stamp[chain] == current_stamp ? g_score[chain] : INFINITE_COST;
+    };
+
+    // 条目为 (f, g, 链)，g 大于记录值的条目已经过时
+    using Entry = std::tuple<float, float, ChainId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    auto relax = [&](const ChainId from) {
+      const float g = (from == origin && visit_stamp[origin] != current_stamp) ? 0.0f : g_score[from];
+      for (uint32_t e = edge_offsets[from]; e < edge_offsets[from + 1u]; ++e) {
+        const ChainId to = edge_targets[e];
+        const float tentative = g + edge_weights[e];
+        if (tentative < score(to)) {
+          g_score[to] = tentative;
+          came_from[to] = from;
+          visit_stamp[to] = current_stamp;
+          open.emplace(tentative + Heuristic(to, goal), tentative, to);
+        }
+      }
+    };
+
+    // 从起点链的后继开始搜索，这样终点链与起点链相同时也能找到绕回的路线
+    relax(origin);
+    ChainRoute route;
+    while (!open.empty()) {
+      const Entry entry = open.top();
+      open.pop();
+      const ChainId chain = std::get<2>(entry);
+      if (std::get<1>(entry) > score(chain)) {
+        continue;
+      }
+      if (chain == goal) {
+        ChainId current = goal;
+        do {
+          route.sequence.push_back(current);
+          current = came_from[current];
+        } while (current != origin);
+        std::reverse(route.sequence.begin(), route.sequence.end());
+        route.found = true;
+        return route;
+      }
+      relax(chain);
+    }
+    return route;
+  }
+
+  const RoutePlanner::ChainRoute &RoutePlanner::GetChainRoute(const ChainId origin, const ChainId goal) {
+    const uint64_t key = (static_cast<uint64_t>(origin) << 32u) | static_cast<uint64_t>(goal);
+    auto it = route_cache.find(key);
+    if (it != route_cache.end()) {
+      return it->second;
+    }
+    if (route_cache.size() >= MAX_CACHED_ROUTES) {
+      route_cache.clear();
+    }
+    return route_cache.emplace(key, FindChainRoute(origin, goal)).first->second;
+  }
+
+  Path RoutePlanner::PlanRoute(const cg::Location &origin, const cg::Location &destination) {
+    Path path;
+    if (local_map == nullptr || waypoint_graph.Size() == 0u) {
+      return path;
+    }
+    const WaypointIndex origin_index = local_map->GetWaypoint(origin)->GetGraphIndex();
+    const WaypointIndex destination_index = local_map->GetWaypoint(destination)->GetGraphIndex();
+    if (origin_index >= waypoint_graph.Size() || destination_index >= waypoint_graph.Size()) {
+      return path;
+    }
+    const ChainId origin_chain = waypoint_chain[origin_index];
+    const ChainId destination_chain = waypoint_chain[destination_index];
+    const cg::Location destination_location = waypoint_graph.GetNode(destination_index).location;
+
+    if (origin_chain == destination_chain
+        && waypoint_position[origin_index] <= waypoint_position[destination_index]) {
+      path.push_back(destination_location);
+      return path;
+    }
+
+    const ChainRoute &route = GetChainRoute(origin_chain, destination_chain);
+    if (!route.found) {
+      return path;
+    }
+
+    // 只输出路口之外每条链的第一个路径点和终点。LocalizationStage 在分岔处
+    // 按下一个导入点所在的道路选择后继，所以导入点需要位于路口之后的道路上
+    for (const ChainId chain : route.sequence) {
+      if (chain == destination_chain) {
+        break;
+      }
+      const WaypointIndex head = chain_waypoints[chain_offsets[chain]];
+      const WaypointGraph::Node &node = waypoint_graph.GetNode(head);
+      if (!node.is_junction) {
+        path.push_back(node.location);
+      }
+    }
+    path.push_back(destination_location);
+    return path;
+  }
+
+  std::vector<WaypointIndex> RoutePlanner::PlanWaypointRoute(
+      const WaypointIndex origin,
+      const WaypointIndex destination) {
+    std::vector<WaypointIndex> route;
+    if (origin >= waypoint_graph.Size() || destination >= waypoint_graph.Size()) {
+      return route;
+    }
+    const ChainId origin_chain = waypoint_chain[origin];
+    const ChainId destination_chain = waypoint_chain[destination];
+    auto chain_begin = [this](const ChainId chain) {
+      return chain_waypoints.begin() + chain_offsets[chain];
+    };
+
+    if (origin_chain == destination_chain
+        && waypoint_position[origin] <= waypoint_position[destination]) {
+      route.assign(
+          chain_begin(origin_chain) + waypoint_position[origin],
+          chain_begin(origin_chain) + waypoint_position[destination] + 1u);
+      return route;
+    }
+
+    const ChainRoute &chain_route = GetChainRoute(origin_chain, destination_chain);
+    if (!chain_route.found) {
+      return route;
+    }
+    route.insert(route.end(),
+        chain_begin(origin_chain) + waypoint_position[origin],
+        chain_begin(origin_chain + 1u));
+    for (const ChainId chain : chain_route.sequence) {
+      if (chain == destination_chain) {
+        route.insert(route.end(),
+            chain_begin(chain),
+            chain_begin(chain) + waypoint_position[destination] + 1u);
+        break;
+      }
+      route.insert(route.end(), chain_begin(chain), chain_begin(chain + 1u));
+    }
+    return route;
+  }
+
+  std::vector<Path> RoutePlanner::PlanRoutes(const std::vector<OriginDestination> &queries) {
+    std::vector<Path> paths;
+    paths.reserve(queries.size());
+    for (const auto &query : queries) {
+      paths.emplace_back(PlanRoute(query.first, query.second));
+    }
+    return paths;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+  using Path = std::vector<cg::Location>;
+
+  /// 在本地地图上为车辆计算从起点到终点的路线。
+  ///
+  /// 构造时把 WaypointGraph 中没有分支的路径点链收缩为一个节点，得到规模小得多的
+  /// 链图，并预先计算若干地标到所有节点以及所有节点到地标的距离。查询使用以地标
+  /// 三角不等式为启发函数的 A*（ALT），结果按起点和终点所在的链缓存。
+  ///
+  /// 路线只沿车道的后继连接，不包含变道。
+  class RoutePlanner : private NonCopyable {
+  public:
+
+    using OriginDestination = std::pair<cg::Location, cg::Location>;
+
+    explicit RoutePlanner(LocalMapPtr local_map);
+
+    /// 直接在 @a graph 上规划，没有本地地图，只能使用按索引查询的
+    /// PlanWaypointRoute。@a graph 的生命周期必须长于本对象。
+    explicit RoutePlanner(const WaypointGraph &graph);
+
+    /// 返回从 @a origin 附近的路径点到 @a destination 附近的路径点的路线，
+    /// 格式与 TrafficManager::SetCustomPath 使用的路径相同。终点不可达时为空。
+    Path PlanRoute(const cg::Location &origin, const cg::Location &destination);
+
+    /// 返回从路径点 @a origin 到 @a destination 依次经过的所有路径点，
+    /// 包括起点和终点。终点不可达时为空。
+    std::vector<WaypointIndex> PlanWaypointRoute(WaypointIndex origin, WaypointIndex destination);
+
+    /// 依次计算 @a queries 中每对起点和终点的路线，结果与 @a queries 一一对应。
+    std::vector<Path> PlanRoutes(const std::vector<OriginDestination> &queries);
+
+  private:
+
+    using ChainId = uint32_t;
+
+    static constexpr ChainId INVALID_CHAIN = std::numeric_limits<ChainId>::max();
+
+    void Initialize();
+
+    void BuildChains();
+
+    void SelectLandmarks();
+
+    /// 从 @a source 出发沿 @a offsets 和 @a targets 描述的边计算到所有链的距离。
+    void Dijkstra(
+        ChainId source,
+        const std::vector<uint32_t> &offsets,
+        const std::vector<ChainId> &targets,
+        const std::vector<float> &weights,
+        std::vector<float> &distances) const;
+
+    float Heuristic(ChainId chain, ChainId goal) const;
+
+    /// 以起点链和终点链为键的路线，sequence 为从 @a origin 出发依次经过的链
+    /// （不含起点链，含终点链）。found 为 false 表示不可达。
+    struct ChainRoute {
+      bool found = false;
+      std::vector<ChainId> sequence;
+    };
+
+    /// 用 A* 计算从 @a origin 链到 @a goal 链的路线。
+    ChainRoute FindChainRoute(ChainId origin, ChainId goal);
+
+    /// 返回缓存的路线，不在缓存中时计算并加入缓存。
+    const ChainRoute &GetChainRoute(ChainId origin, ChainId goal);
+
+    LocalMapPtr local_map;
+
+    const WaypointGraph &waypoint_graph;
+
+    /// 链 c 的路径点为 chain_waypoints[chain_offsets[c], chain_offsets[c + 1])。
+    std::vector<uint32_t> chain_offsets;
+    std::vector<WaypointIndex> chain_waypoints;
+
+    /// 每个路径点所在的链及其在链中的位置。
+    std::vector<ChainId> waypoint_chain;
+    std::vector<uint32_t> waypoint_position;
+
+    /// 链之间的边，权重为从链的起点走到后继链起点的距离。
+    std::vector<uint32_t> edge_offsets;
+    std::vector<ChainId> edge_targets;
+    std::vector<float> edge_weights;
+
+    /// 反向的边，用于计算各链到地标的距离。
+    std::vector<uint32_t> reverse_edge_offsets;
+    std::vector<ChainId> reverse_edge_targets;
+    std::vector<float> reverse_edge_weights;
+
+    /// 第 l 个地标到各链的距离和各链到第 l 个地标的距离。
+    std::vector<std::vector<float>> distances_from_landmark;
+    std::vector<std::vector<float>> distances_to_landmark;
+
+    /// A* 的工作数组，在查询之间重用。visit_stamp 与 current_stamp 不同的
+    /// 条目视为尚未访问，这样每次查询不需要重新初始化整个数组。
+    std::vector<float> g_score;
+    std::vector<ChainId> came_from;
+    std::vector<uint32_t> visit_stamp;
+    uint32_t current_stamp = 0u;
+
+    std::unordered_map<uint64_t, ChainRoute> route_cache;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
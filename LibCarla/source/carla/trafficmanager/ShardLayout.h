@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Location.h"
+#include "carla/trafficmanager/Constants.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+using constants::Sharding::BOUNDARY_MARGIN;
+using constants::Sharding::HANDOFF_HYSTERESIS;
+
+/// 相邻分片的交通管理器及其负责的区域。
+struct ShardNeighbour {
+  std::string host;
+  uint16_t port = 0u;
+  cg::BoundingBox region;
+};
+
+/// 分片模式下本交通管理器负责的区域及其相邻分片。
+///
+/// 每个分片只控制自己区域内的车辆，车辆越过区域边界进入相邻分片的区域后移交给
+/// 该分片的交通管理器。区域外的其他参与者只在距区域边界 BOUNDARY_MARGIN 以内时
+/// 才被跟踪。区域只考虑 XY 平面，忽略包围盒的旋转。
+class ShardLayout {
+public:
+
+  static constexpr size_t NO_NEIGHBOUR = std::numeric_limits<size_t>::max();
+
+  ShardLayout(const cg::BoundingBox &_region, std::vector<ShardNeighbour> _neighbours)
+    : region(_region),
+      neighbours(std::move(_neighbours)) {}
+
+  const std::vector<ShardNeighbour> &GetNeighbours() const {
+    return neighbours;
+  }
+
+  /// @a location 是否在本分片区域向外扩展 BOUNDARY_MARGIN 的范围内。
+  bool IsInBoundaryRegion(const cg::Location &location) const {
+    return Contains(region, location, BOUNDARY_MARGIN);
+  }
+
+  /// 返回位于 @a location 的车辆应移交到的邻居在 GetNeighbours() 中的索引，
+  /// 车辆仍属于本分片或不在任何邻居的区域内时返回 NO_NEIGHBOUR。车辆离开本分片
+  /// 区域超过 HANDOFF_HYSTERESIS 后才移交，避免在边界上来回移交。
+  size_t FindHandOffTarget(const cg::Location &location) const {
+    if (Contains(region, location, HANDOFF_HYSTERESIS)) {
+      return NO_NEIGHBOUR;
+    }
+    for (size_t i = 0u; i < neighbours.size(); ++i) {
+      if (Contains(neighbours[i].region, location, 0.0f)) {
+        return i;
+      }
+    }
+    return NO_NEIGHBOUR;
+  }
+
+private:
+
+  static bool Contains(const cg::BoundingBox &box, const cg::Location &location, const float margin) {
+    return std::abs(location.x - box.location.x) <= box.extent.x + margin
+        && std::abs(location.y - box.location.y) <= box.extent.y + margin;
+  }
+
+  const cg::BoundingBox region;
+
+  const std::vector<ShardNeighbour> neighbours;
+};
+
+} // namespace traffic_manager
+} // namespace carla
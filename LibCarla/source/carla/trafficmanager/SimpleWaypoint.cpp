@@ -140,5 +140,13 @@ namespace traffic_manager {
     return road_option; // 返回道路选项
   }
 
+  void SimpleWaypoint::SetGraphIndex(WaypointIndex index) { // 设置在WaypointGraph中的索引
+    graph_index = index; // 更新索引
+  }
+
+  WaypointIndex SimpleWaypoint::GetGraphIndex() const { // 获取在WaypointGraph中的索引
+    return graph_index; // 返回索引
+  }
+
 } // namespace traffic_manager
 } // namespace carla
\ No newline at end of file
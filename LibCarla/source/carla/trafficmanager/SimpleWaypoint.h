@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <limits> // 引入数值极限相关的头文件
 #include <memory.h> // 引入内存操作相关的头文件
 
 #include "carla/client/Waypoint.h" // 引入Carla客户端的Waypoint类
@@ -22,6 +23,7 @@ namespace traffic_manager {
   namespace cg = carla::geom; // 简化命名空间cg为carla::geom
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>; // 定义WaypointPtr为Waypoint的智能指针类型
   using GeoGridId = carla::road::JuncId; // 定义GeoGridId为交叉口ID类型
+  using WaypointIndex = uint32_t; // 定义WaypointIndex为路径点在WaypointGraph中的索引类型
   enum class RoadOption : uint8_t { // 定义道路选项的枚举类
     Void = 0, // 无效选项
     Left = 1, // 向左
@@ -57,6 +59,8 @@ namespace traffic_manager {
     GeoGridId geodesic_grid_id = 0; // 初始化为0
     // 布尔值，表示waypoint是否属于交叉口。
     bool _is_junction = false; // 默认设置为false
+    /// waypoint在本地地图WaypointGraph中的索引。
+    WaypointIndex graph_index = std::numeric_limits<WaypointIndex>::max(); // 默认不属于任何图
 
   public:
 
@@ -136,6 +140,12 @@ namespace traffic_manager {
     
     // 访问器方法，用于获取道路选项。
     RoadOption GetRoadOption();
+
+    /// 访问器方法，用于设置waypoint在WaypointGraph中的索引。
+    void SetGraphIndex(WaypointIndex index);
+
+    /// 访问器方法，用于获取waypoint在WaypointGraph中的索引。
+    WaypointIndex GetGraphIndex() const;
   };
 
 } // namespace traffic_manager
@@ -5,101 +5,122 @@ namespace carla {
 namespace traffic_manager {
 // 构造函数，初始化 SimulationState 对象
 SimulationState::SimulationState() {}
-// 向模拟状态中添加一个actor
+// 向模拟状态中添加一个actor，已存在的actor保持不变
 void SimulationState::AddActor(ActorId actor_id,
                                KinematicState kinematic_state,
                                StaticAttributes attributes,
                                TrafficLightState tl_state) {
-  actor_set.insert(actor_id);// 将actor的ID 插入到 actor_set 中
-  kinematic_state_map.insert({actor_id, kinematic_state});// 将actor的ID和运动状态插入到 kinematic_state_map 中
-  static_attribute_map.insert({actor_id, attributes});// 将actor的ID和静态属性插入到 static_attribute_map 中
-  tl_state_map.insert({actor_id, tl_state});// 将actor的ID和交通灯状态插入到 tl_state_map 中
+  if (!actor_index_map.emplace(actor_id, actor_ids.size()).second) {
+    return;
+  }
+  actor_ids.push_back(actor_id);
+  locations.push_back(kinematic_state.location);
+  rotations.push_back(kinematic_state.rotation);
+  velocities.push_back(kinematic_state.velocity);
+  speed_limits.push_back(kinematic_state.speed_limit);
+  physics_enabled.push_back(kinematic_state.physics_enabled ? 1u : 0u);
+  dormant.push_back(kinematic_state.is_dormant ? 1u : 0u);
+  hybrid_end_locations.push_back(kinematic_state.hybrid_end_location);
+  detail_levels.push_back(DetailLevel::Full);
+  actor_types.push_back(attributes.actor_type);
+  dimensions.emplace_back(attributes.half_length, attributes.half_width, attributes.half_height);
+  tl_states.push_back(tl_state);
 }
 // 检查模拟状态中是否包含特定的actor的ID
 bool SimulationState::ContainsActor(ActorId actor_id) const {
-// 如果在 actor_set 中找到该actor的ID，则返回 true，否则返回 false
-  return actor_set.find(actor_id) != actor_set.end();
+  return actor_index_map.find(actor_id) != actor_index_map.end();
+}
+// 记录注册车辆在数组中的位置
+void SimulationState::RefreshVehicleIndices(const std::vector<ActorId> &vehicle_id_list) {
+  vehicle_indices.resize(vehicle_id_list.size());
+  for (size_t i = 0u; i < vehicle_id_list.size(); ++i) {
+    auto it = actor_index_map.find(vehicle_id_list[i]);
+    vehicle_indices[i] = (it != actor_index_map.end()) ? ActorStateIndex{it->second} : ActorStateIndex{};
+  }
 }
-// 从模拟状态中移除一个actor
+// 从模拟状态中移除特定的actor，最后一个actor被移到它的位置
 void SimulationState::RemoveActor(ActorId actor_id) {
-  actor_set.erase(actor_id); // 从 actor_set 中删除该actor的ID
-  kinematic_state_map.erase(actor_id);// 从 kinematic_state_map 中删除该actor的运动状态
-  static_attribute_map.erase(actor_id);// 从 static_attribute_map 中删除该actor的静态属性
-  tl_state_map.erase(actor_id);// 从 tl_state_map 中删除该actor的交通灯状态
-}
-// 重置模拟状态，清空所有数据结构
+  auto it = actor_index_map.find(actor_id);
+  if (it == actor_index_map.end()) {
+    return;
+  }
+  const size_t index = it->second;
+  const size_t last = actor_ids.size() - 1u;
+  actor_index_map.erase(it);
+  if (index != last) {
+    actor_ids[index] = actor_ids[last];
+    locations[index] = locations[last];
+    rotations[index] = rotations[last];
+    velocities[index] = velocities[last];
+    speed_limits[index] = speed_limits[last];
+    physics_enabled[index] = physics_enabled[last];
+    dormant[index] = dormant[last];
+    hybrid_end_locations[index] = hybrid_end_locations[last];
+    detail_levels[index] = detail_levels[last];
+    actor_types[index] = actor_types[last];
+    dimensions[index] = dimensions[last];
+    tl_states[index] = tl_states[last];
+    actor_index_map.at(actor_ids[index]) = index;
+  }
+  actor_ids.pop_back();
+  locations.pop_back();
+  rotations.pop_back();
+  velocities.pop_back();
+  speed_limits.pop_back();
+  physics_enabled.pop_back();
+  dormant.pop_back();
+  hybrid_end_locations.pop_back();
+  detail_levels.pop_back();
+  actor_types.pop_back();
+  dimensions.pop_back();
+  tl_states.pop_back();
+  // 移除改变了其他actor的位置，之前记录的车辆位置不再有效
+  vehicle_indices.clear();
+}
+// 重置模拟状态，清空所有数据
 void SimulationState::Reset() {
-  actor_set.clear();// 清空 actor_set
-  kinematic_state_map.clear();// 清空 kinematic_state_map
-  static_attribute_map.clear();// 清空 static_attribute_map
-  tl_state_map.clear(); // 清空 tl_state_map
+  actor_index_map.clear();
+  actor_ids.clear();
+  locations.clear();
+  rotations.clear();
+  velocities.clear();
+  speed_limits.clear();
+  physics_enabled.clear();
+  dormant.clear();
+  hybrid_end_locations.clear();
+  detail_levels.clear();
+  actor_types.clear();
+  dimensions.clear();
+  tl_states.clear();
+  vehicle_indices.clear();
 }
 // 更新特定actor的运动状态
 void SimulationState::UpdateKinematicState(ActorId actor_id, KinematicState state) {
-  kinematic_state_map.at(actor_id) = state;// 使用 at 方法访问并更新特定actor的运动状态
+  const size_t index = actor_index_map.at(actor_id);
+  locations[index] = state.location;
+  rotations[index] = state.rotation;
+  velocities[index] = state.velocity;
+  speed_limits[index] = state.speed_limit;
+  physics_enabled[index] = state.physics_enabled ? 1u : 0u;
+  dormant[index] = state.is_dormant ? 1u : 0u;
+  hybrid_end_locations[index] = state.hybrid_end_location;
 }
 // 更新特定actor的混合结束位置
 void SimulationState::UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location) {
-  kinematic_state_map.at(actor_id).hybrid_end_location = location;// 使用 at 方法访问并更新特定actor的混合结束位置
+  hybrid_end_locations[actor_index_map.at(actor_id)] = location;
 }
-// 更新特定actor的交通灯状态，注意特殊的绿色-黄色状态过渡处理
+// 更新特定actor的交通灯状态，之前在交通灯处为绿灯时保持绿灯
 void SimulationState::UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
-  // The green-yellow state transition is not notified to the vehicle. This is done to avoid
-  // having vehicles stopped very near the intersection when only the rear part of the vehicle
-  // is colliding with the trigger volume of the traffic light.
-  auto previous_tl_state = GetTLS(actor_id);
+  const size_t index = actor_index_map.at(actor_id);
+  const TrafficLightState &previous_tl_state = tl_states[index];
   if (previous_tl_state.at_traffic_light && previous_tl_state.tl_state == TLS::Green) {
     state.tl_state = TLS::Green;
   }
-// 使用 at 方法访问并更新特定actor的交通灯状态
-  tl_state_map.at(actor_id) = state;
-}
-// 获取特定actor的位置
-cg::Location SimulationState::GetLocation(ActorId actor_id) const {
-// 使用 at 方法访问并返回特定actor的位置	
-  return kinematic_state_map.at(actor_id).location;
-}
-// 获取特定actor的混合结束位置
-cg::Location SimulationState::GetHybridEndLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).hybrid_end_location;// 使用 at 方法访问并返回特定actor的混合结束位置
-}
-// 获取特定actor的旋转状态
-cg::Rotation SimulationState::GetRotation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation;// 使用 at 方法访问并返回特定actor的旋转状态
-}
-// 获取特定actor的前进方向向量
-cg::Vector3D SimulationState::GetHeading(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation.GetForwardVector(); // 使用 at 方法访问特定actor的旋转状态，然后获取其前进方向向量并返回
-}
-// 获取特定actor的速度向量
-cg::Vector3D SimulationState::GetVelocity(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).velocity;// 使用 at 方法访问并返回特定actor的速度向量
-}
-// 获取特定actor的速度限制
-float SimulationState::GetSpeedLimit(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).speed_limit; // 使用 at 方法访问并返回特定actor的速度限制
-}
-// 检查特定actor的物理模拟是否启用
-bool SimulationState::IsPhysicsEnabled(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).physics_enabled; // 使用 at 方法访问并返回特定actor的物理模拟启用状态
-}
-// 检查特定actor是否处于休眠状态
-bool SimulationState::IsDormant(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).is_dormant;// 使用 at 方法访问并返回特定actor的休眠状态
-}
-// 获取特定actor的交通灯状态
-TrafficLightState SimulationState::GetTLS(ActorId actor_id) const {
-  return tl_state_map.at(actor_id);// 使用 at 方法访问并返回特定actor的交通灯状态
-}
-// 获取特定actor的类型
-ActorType SimulationState::GetType(ActorId actor_id) const {
-  return static_attribute_map.at(actor_id).actor_type; // 使用 at 方法访问特定actor的静态属性，然后返回actor类型
+  tl_states[index] = state;
 }
-// 获取特定actor的尺寸
-cg::Vector3D SimulationState::GetDimensions(ActorId actor_id) const {
-// 使用 at 方法访问特定actor的静态属性，然后构建并返回actor的尺寸向量	
-  const StaticAttributes &attributes = static_attribute_map.at(actor_id);
-  return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+// 更新特定actor的细节层次
+void SimulationState::UpdateDetailLevel(ActorId actor_id, DetailLevel detail_level) {
+  detail_levels[actor_index_map.at(actor_id)] = detail_level;
 }
 
 } // namespace  traffic_manager
@@ -1,8 +1,12 @@
 
 #pragma once
 
-#include <unordered_set> // 引入无序集合头文件
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
+#include "carla/Debug.h"
 #include "carla/trafficmanager/DataStructures.h" // 引入数据结构的头文件
 
 namespace carla {
@@ -15,6 +19,18 @@ enum ActorType {
   Any           // 任意类型
 };
 
+/// 混合物理模式下车辆的细节层次。
+///
+/// Full 为启用物理的车辆；Reduced 为混合物理半径以外、细节层次半径以内被传送的
+/// 车辆，每隔 REDUCED_DETAIL_COLLISION_INTERVAL 个周期检测一次碰撞；Mesoscopic
+/// 为细节层次半径以外的车辆，只跟随同一路径上的前车行驶，不进行几何碰撞检测，
+/// 也不主动变道。
+enum class DetailLevel : uint8_t {
+  Full,
+  Reduced,
+  Mesoscopic
+};
+
 // 描述运动状态的结构体
 struct KinematicState {
   cg::Location location;         // 位置
@@ -25,14 +41,12 @@ struct KinematicState {
   bool is_dormant;              // 是否处于休眠状态
   cg::Location hybrid_end_location; // 混合结束位置
 };
-using KinematicStateMap = std::unordered_map<ActorId, KinematicState>; // 定义运动状态映射
 
 // 描述交通灯状态的结构体
 struct TrafficLightState {
   TLS tl_state;                // 交通灯状态
   bool at_traffic_light;       // 是否在交通灯处
 };
-using TrafficLightStateMap = std::unordered_map<ActorId, TrafficLightState>; // 定义交通灯状态映射
 
 // 描述静态属性的结构体
 struct StaticAttributes {
@@ -41,20 +55,53 @@ struct StaticAttributes {
   float half_width;            // 半宽
   float half_height;           // 半高
 };
-using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>; // 定义静态属性映射
+
+/// 参与者的状态在 SimulationState 的稠密数组中的位置。
+///
+/// 添加参与者不会改变已有参与者的位置，移除参与者会把最后一个参与者移到
+/// 被移除的位置，因此位置只在两次移除之间有效。
+struct ActorStateIndex {
+  static constexpr size_t INVALID = std::numeric_limits<size_t>::max();
+
+  size_t value = INVALID;
+
+  bool IsValid() const {
+    return value != INVALID;
+  }
+};
 
 /// 该类保持了仿真中所有车辆的状态。
+///
+/// 状态按字段存放在以参与者位置为下标的稠密数组中（结构数组），按 ID 访问时
+/// 只需查找一次位置。各阶段在每个周期开始时通过 RefreshVehicleIndices 取得
+/// 注册车辆的位置，之后按车辆在 vehicle_id_list 中的索引直接访问，不再查找。
 class SimulationState {
 
 private:
-  // 存储仿真中所有参与者的ID的结构
-  std::unordered_set<ActorId> actor_set; 
-  // 存储参与者动态运动相关状态的结构
-  KinematicStateMap kinematic_state_map; 
-  // 存储参与者静态属性的结构
-  StaticAttributeMap static_attribute_map; 
-  // 存储参与者动态交通灯相关状态的结构
-  TrafficLightStateMap tl_state_map; 
+  // 参与者ID到其在数组中位置的映射
+  std::unordered_map<ActorId, size_t> actor_index_map;
+  // 每个位置上参与者的ID
+  std::vector<ActorId> actor_ids;
+
+  // 参与者动态运动相关状态
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  std::vector<uint8_t> physics_enabled;
+  std::vector<uint8_t> dormant;
+  std::vector<cg::Location> hybrid_end_locations;
+  std::vector<DetailLevel> detail_levels;
+
+  // 参与者静态属性
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
+
+  // 参与者动态交通灯相关状态
+  std::vector<TrafficLightState> tl_states;
+
+  // 按 vehicle_id_list 的顺序保存的注册车辆的位置
+  std::vector<ActorStateIndex> vehicle_indices;
 
 public :
   SimulationState(); // 构造函数
@@ -68,6 +115,25 @@ public :
   // 验证参与者是否当前存在于仿真状态中的方法
   bool ContainsActor(ActorId actor_id) const;
 
+  // 返回仿真中所有参与者的ID，顺序与其在数组中的位置一致
+  const std::vector<ActorId> &GetActorIds() const {
+    return actor_ids;
+  }
+
+  // 返回参与者在数组中的位置，参与者不存在时抛出 std::out_of_range
+  ActorStateIndex GetIndex(const ActorId actor_id) const {
+    return ActorStateIndex{actor_index_map.at(actor_id)};
+  }
+
+  // 按 @a vehicle_id_list 的顺序记录注册车辆的位置，
+  // 在本周期 ALSM 更新之后、各阶段更新之前调用
+  void RefreshVehicleIndices(const std::vector<ActorId> &vehicle_id_list);
+
+  // 返回 vehicle_id_list 中第 @a vehicle_index 辆车的位置，车辆没有状态时无效
+  ActorStateIndex GetVehicleIndex(const unsigned long vehicle_index) const {
+    return vehicle_indices.at(vehicle_index);
+  }
+
   // 从仿真状态中移除参与者的方法
   void RemoveActor(ActorId actor_id);
 
@@ -83,42 +149,132 @@ public :
   // 更新交通灯状态的方法
   void UpdateTrafficLightState(ActorId actor_id, TrafficLightState state);
 
+  // 更新参与者细节层次的方法，新添加的参与者为 DetailLevel::Full
+  void UpdateDetailLevel(ActorId actor_id, DetailLevel detail_level);
+
+  /// @name 按位置访问状态
+  /// @{
+
+  cg::Location GetLocation(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return locations[index.value];
+  }
+
+  cg::Location GetHybridEndLocation(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return hybrid_end_locations[index.value];
+  }
+
+  cg::Rotation GetRotation(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return rotations[index.value];
+  }
+
+  cg::Vector3D GetHeading(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return rotations[index.value].GetForwardVector();
+  }
+
+  cg::Vector3D GetVelocity(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return velocities[index.value];
+  }
+
+  float GetSpeedLimit(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return speed_limits[index.value];
+  }
+
+  bool IsPhysicsEnabled(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return physics_enabled[index.value] != 0u;
+  }
+
+  bool IsDormant(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return dormant[index.value] != 0u;
+  }
+
+  TrafficLightState GetTLS(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return tl_states[index.value];
+  }
+
+  DetailLevel GetDetailLevel(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return detail_levels[index.value];
+  }
+
+  ActorType GetType(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return actor_types[index.value];
+  }
+
+  cg::Vector3D GetDimensions(const ActorStateIndex index) const {
+    DEBUG_ASSERT(index.IsValid());
+    return dimensions[index.value];
+  }
+
+  /// @}
+  /// @name 按 ID 访问状态，参与者不存在时抛出 std::out_of_range
+  /// @{
+
   // 获取参与者位置的方法
-  cg::Location GetLocation(const ActorId actor_id) const;
+  cg::Location GetLocation(const ActorId actor_id) const {
+    return GetLocation(GetIndex(actor_id));
+  }
 
   // 获取参与者混合结束位置的方法
-  cg::Location GetHybridEndLocation(const ActorId actor_id) const;
+  cg::Location GetHybridEndLocation(const ActorId actor_id) const {
+    return GetHybridEndLocation(GetIndex(actor_id));
+  }
 
   // 获取参与者旋转的方法
-  cg::Rotation GetRotation(const ActorId actor_id) const;
+  cg::Rotation GetRotation(const ActorId actor_id) const {
+    return GetRotation(GetIndex(actor_id));
+  }
 
   // 获取参与者朝向的方法
-  cg::Vector3D GetHeading(const ActorId actor_id) const;
+  cg::Vector3D GetHeading(const ActorId actor_id) const {
+    return GetHeading(GetIndex(actor_id));
+  }
 
   // 获取参与者速度的方法
-  cg::Vector3D GetVelocity(const ActorId actor_id) const;
+  cg::Vector3D GetVelocity(const ActorId actor_id) const {
+    return GetVelocity(GetIndex(actor_id));
+  }
 
   // 获取速度限制的方法
-  float GetSpeedLimit(const ActorId actor_id) const;
+  float GetSpeedLimit(const ActorId actor_id) const {
+    return GetSpeedLimit(GetIndex(actor_id));
+  }
 
   // 检查物理是否启用的方法
-  bool IsPhysicsEnabled(const ActorId actor_id) const;
+  bool IsPhysicsEnabled(const ActorId actor_id) const {
+    return IsPhysicsEnabled(GetIndex(actor_id));
+  }
 
   // 检查参与者是否处于休眠状态的方法
-  bool IsDormant(const ActorId actor_id) const;
-
-  // 获取英雄位置的方法
-  cg::Location GetHeroLocation(const ActorId actor_id) const;
+  bool IsDormant(const ActorId actor_id) const {
+    return IsDormant(GetIndex(actor_id));
+  }
 
   // 获取交通灯状态的方法
-  TrafficLightState GetTLS(const ActorId actor_id) const;
+  TrafficLightState GetTLS(const ActorId actor_id) const {
+    return GetTLS(GetIndex(actor_id));
+  }
 
   // 获取参与者类型的方法
-  ActorType GetType(const ActorId actor_id) const;
+  ActorType GetType(const ActorId actor_id) const {
+    return GetType(GetIndex(actor_id));
+  }
 
   // 获取参与者尺寸的方法
-  cg::Vector3D GetDimensions(const ActorId actor_id) const;
+  cg::Vector3D GetDimensions(const ActorId actor_id) const {
+    return GetDimensions(GetIndex(actor_id));
+  }
 
+  /// @}
 };
 
 } // namespace traffic_manager
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/TaskScheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace carla {
+namespace traffic_manager {
+
+/// 在多个线程上执行阶段中逐车辆更新。
+///
+/// 任务提交到进程共用的 TaskScheduler，不创建自己的线程。索引范围被划分为
+/// 小块，各线程（包括调用线程）每次取下一块，先完成的线程会继续处理剩余的
+/// 块，因此不同车辆的计算量不均匀时负载也能保持平衡。
+class StageWorkerPool : private NonCopyable {
+public:
+
+  /// @a threads 包括调用 ParallelFor 的线程，是同时参与计算的最大线程数，
+  /// 实际线程数不超过调度器的线程数。
+  explicit StageWorkerPool(const size_t threads)
+    : number_of_threads(std::max<size_t>(threads, 1u)) {}
+
+  size_t GetNumberOfThreads() const {
+    return number_of_threads;
+  }
+
+  /// 对 [0, @a count) 中的每个索引调用 @a functor(index)，所有调用完成后返回。
+  /// 同一索引只被调用一次，但不同索引的调用顺序和所在线程不确定。
+  /// 如果某次调用抛出异常，等待其余线程结束后重新抛出第一个异常。
+  template <typename FunctorT>
+  void ParallelFor(const unsigned long count, FunctorT &&functor) {
+    TaskScheduler::Get().ParallelFor(
+        static_cast<size_t>(count),
+        [&functor](const size_t index) { functor(static_cast<unsigned long>(index)); },
+        1u,
+        number_of_threads);
+  }
+
+private:
+
+  const size_t number_of_threads;
+};
+
+} // namespace traffic_manager
+} // namespace carla
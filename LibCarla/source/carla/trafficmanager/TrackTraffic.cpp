@@ -16,78 +16,44 @@ void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
 // 删除指定参与者的现有信息
     DeleteActor(actor_id);
 
-    std::unordered_set<GeoGridId> current_grids;
-    // Step through waypoints and update grid list for actor and actor list for grids.
+    // 未注册的参与者没有路径缓冲，每个周期按最近的路点重新记录
     for (auto &waypoint : waypoints) {
     	 // 更新经过的车辆信息
         UpdatePassingVehicle(waypoint->GetId(), actor_id);
-// 获取路点的地理网格 ID
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
-        // 将网格 ID 插入当前网格集合
-        current_grids.insert(ggid);
-// 如果网格到参与者的映射中存在该网格 ID
-        if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
-        	// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
-        } else {
-        	// 如果映射中不存在该网格 ID，创建新的映射关系
-            grid_to_actors.insert({ggid, {actor_id}});
-        }
+        AddPathGrid(actor_id, waypoint->GetGeodesicGridId());
     }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-    actor_to_grids.insert({actor_id, current_grids});
 }
 
-void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
-	// 如果缓冲区不为空
-    if (!buffer.empty()) {
-
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            // 遍历当前参与者所在的网格集合
-            for (auto &grid_id : current_grids) {
-            	// 如果网格到参与者的映射中存在该网格 ID
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                	// 获取对应网格的参与者集合
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    // 从集合中删除该参与者 ID
-                    actor_ids.erase(actor_id);
-                }
-            }
-// 从参与者到网格的映射中删除该参与者
-            actor_to_grids.erase(actor_id);
-        }
+void TrackTraffic::AddPathGrid(const ActorId actor_id, const GeoGridId geogrid_id) {
+    uint32_t &count = actor_to_grids[actor_id][geogrid_id];
+    // 路径第一次进入该网格时，把参与者加入网格的参与者集合
+    if (count++ == 0u) {
+        grid_to_actors[geogrid_id].insert(actor_id);
+    }
+}
 
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
-        uint64_t buffer_size = buffer.size();
-        // 遍历缓冲区中的路点
-        for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
-            }
-// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
+void TrackTraffic::RemovePathGrid(const ActorId actor_id, const GeoGridId geogrid_id) {
+    auto grids = actor_to_grids.find(actor_id);
+    if (grids == actor_to_grids.end()) {
+        return;
+    }
+    auto count = grids->second.find(geogrid_id);
+    if (count == grids->second.end()) {
+        return;
+    }
+    // 路径离开该网格时，把参与者从网格的参与者集合中删除
+    if (--count->second == 0u) {
+        grids->second.erase(count);
+        if (grids->second.empty()) {
+            actor_to_grids.erase(grids);
+        }
+        auto actor_ids = grid_to_actors.find(geogrid_id);
+        if (actor_ids != grid_to_actors.end()) {
+            actor_ids->second.erase(actor_id);
         }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-        actor_to_grids.insert({actor_id, current_grids});
     }
 }
 
-
 bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
     if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
         return grid_to_actors.at(geogrid_id).empty();
@@ -116,13 +82,13 @@ ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
     ActorIdSet actor_id_set;
 // 如果参与者在参与者到网格的映射中
     if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        const std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
+        const GridCountMap &grid_ids = actor_to_grids.at(actor_id);
         // 遍历参与者所在的网格集合
         for (auto &grid_id : grid_ids) {
         	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
+            if (grid_to_actors.find(grid_id.first) != grid_to_actors.end()) {
             	 // 获取对应网格的参与者集合
-                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
+                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id.first);
                  // 将集合中的参与者 ID 插入结果集合
                 actor_id_set.insert(actor_ids.begin(), actor_ids.end());
             }
@@ -132,20 +98,34 @@ ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
     return actor_id_set;
 }
 
+bool TrackTraffic::IsOverlapping(ActorId actor_id, ActorId other_actor_id) const {
+    auto grids = actor_to_grids.find(actor_id);
+    if (grids == actor_to_grids.end()) {
+        return false;
+    }
+    for (auto &grid_id : grids->second) {
+        auto actor_ids = grid_to_actors.find(grid_id.first);
+        if (actor_ids != grid_to_actors.end()
+            && actor_ids->second.find(other_actor_id) != actor_ids->second.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void TrackTraffic::DeleteActor(ActorId actor_id) {
 	// 如果参与者在参与者到网格的映射中
     if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
+        const GridCountMap &grid_ids = actor_to_grids.at(actor_id);
         // 遍历参与者所在的网格集合
         for (auto &grid_id : grid_ids) {
         	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-            	// 获取对应网格的参与者集合
-                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
+            auto actor_ids = grid_to_actors.find(grid_id.first);
+            if (actor_ids != grid_to_actors.end()) {
                 // 从集合中删除该参与者 ID
-                actor_ids.erase(actor_id);
-                }
+                actor_ids->second.erase(actor_id);
             }
+        }
             // 从参与者到网格的映射中删除该参与者
         actor_to_grids.erase(actor_id);
     }
@@ -28,8 +28,9 @@ private:
     using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
     WaypointOccupancyMap waypoint_occupied;
 
-    /// 参与者路径所占据的测地线网格
-    std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
+    /// 参与者路径所占据的测地线网格及路径在每个网格中的路点数
+    using GridCountMap = std::unordered_map<GeoGridId, uint32_t>;
+    std::unordered_map<ActorId, GridCountMap> actor_to_grids;
     /// 参与者当前经过的网格
     std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
     /// 当前英雄位置
@@ -44,11 +45,18 @@ public:
     void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
 
-    void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
+    /// 参与者的路径缓冲压入、弹出位于 @a geogrid_id 的路点时调用。
+    /// 按网格记录路径中的路点数，只在计数变为 1 或 0 时修改网格的参与者集合，
+    /// 不需要每个周期按整个缓冲重建。
+    void AddPathGrid(const ActorId actor_id, const GeoGridId geogrid_id);
+    void RemovePathGrid(const ActorId actor_id, const GeoGridId geogrid_id);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
                                         const std::vector<SimpleWaypointPtr> waypoints);
 
     ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// 返回 @a other_actor_id 是否在 GetOverlappingVehicles(@a actor_id) 的结果中，
+    /// 不需要构造整个集合。
+    bool IsOverlapping(ActorId actor_id, ActorId other_actor_id) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
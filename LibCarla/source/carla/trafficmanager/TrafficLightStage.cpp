@@ -30,30 +30,50 @@ TrafficLightStage::TrafficLightStage(
     output_array(output_array), // 初始化输出数组
     random_device(random_device) {} // 初始化随机数生成器
 
+void TrafficLightStage::UpdateWorldInfo() {
+  current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
+}
+
 // 更新函数
 void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false; // 交通信号灯危险标志
 
   const ActorId ego_actor_id = vehicle_id_list.at(index); // 获取当前车辆 ID
-  if (!simulation_state.IsDormant(ego_actor_id)) { // 如果车辆不处于休眠状态
+  const ActorStateIndex ego_state_index = simulation_state.GetVehicleIndex(index); // 获取当前车辆状态的位置
+  if (!simulation_state.IsDormant(ego_state_index)) { // 如果车辆不处于休眠状态
 
     JunctionID current_junction_id = -1; // 当前交叉口 ID 初始化为 -1
     if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) {
       current_junction_id = vehicle_last_junction.at(ego_actor_id); // 获取上次的交叉口 ID
     }
-    auto affected_junction_id = GetAffectedJunctionId(ego_actor_id); // 获取受影响的交叉口 ID
-
-    current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
 
-    const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id); // 获取交通信号灯状态
+    const TrafficLightState tl_state = simulation_state.GetTLS(ego_state_index); // 获取交通信号灯状态
     const TLS traffic_light_state = tl_state.tl_state; // 交通信号灯当前状态
     const bool is_at_traffic_light = tl_state.at_traffic_light; // 判断是否在交通信号灯处
+    const uint64_t front_waypoint_id = buffer_map.at(ego_actor_id).front()->GetId(); // 路径缓冲区的起点
+
+    // 不在无信号灯路口队列中的车辆，输入没有变化时结果与上一次相同：
+    // 在交通灯处时只取决于交通灯的状态，否则前方没有路口时总是没有危险
+    auto evaluation = last_evaluation.find(ego_actor_id);
+    if (current_junction_id == -1 &&
+        evaluation != last_evaluation.end() &&
+        evaluation->second.traffic_light_state == traffic_light_state &&
+        evaluation->second.at_traffic_light == is_at_traffic_light &&
+        (is_at_traffic_light ||
+         (evaluation->second.front_waypoint_id == front_waypoint_id &&
+          evaluation->second.affected_junction_id == -1))) {
+      output_array.at(index) = evaluation->second.traffic_light_hazard;
+      return;
+    }
+
+    auto affected_junction_id = GetAffectedJunctionId(ego_actor_id); // 获取受影响的交叉口 ID
 
     // 如果车辆在交通信号灯处且信号灯为黄灯或红灯
     if (is_at_traffic_light &&
         traffic_light_state != TLS::Green &&
         traffic_light_state != TLS::Off &&
-        parameters.GetPercentageRunningLight(ego_actor_id) <= random_device.next()) {
+        parameters.GetVehicleParameters(index).perc_run_traffic_light <=
+            random_device.GetStream(ego_actor_id, RandomStreamId::TrafficLight).next()) {
       // 如果车辆在受交通信号灯影响的非信号交叉口，移除车辆
       if (current_junction_id != -1) {
         RemoveActor(ego_actor_id);
@@ -73,11 +93,20 @@ void TrafficLightStage::Update(const unsigned long index) {
     else if (affected_junction_id != -1 &&
             !is_at_traffic_light &&
             traffic_light_state != TLS::Green &&
-            parameters.GetPercentageRunningSign(ego_actor_id) <= random_device.next()) {
+            parameters.GetVehicleParameters(index).perc_run_traffic_sign <=
+                random_device.GetStream(ego_actor_id, RandomStreamId::TrafficSign).next()) {
 
       AddActorToNonSignalisedJunction(ego_actor_id, affected_junction_id); // 将车辆添加到非信号交叉口
       traffic_light_hazard = true; // 设置交通信号灯危险标志为真
     }
+
+    // 记录本次评估的输入和结果
+    JunctionEvaluation &entry = last_evaluation[ego_actor_id];
+    entry.front_waypoint_id = front_waypoint_id;
+    entry.affected_junction_id = affected_junction_id;
+    entry.traffic_light_state = traffic_light_state;
+    entry.at_traffic_light = is_at_traffic_light;
+    entry.traffic_light_hazard = traffic_light_hazard;
   }
   output_array.at(index) = traffic_light_hazard; // 将结果输出到数组
 }
@@ -168,6 +197,7 @@ JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id)
 }
 
 void TrafficLightStage::RemoveActor(const ActorId actor_id) {
+  last_evaluation.erase(actor_id); // 下一次更新时重新评估
   if (vehicle_last_junction.find(actor_id) != vehicle_last_junction.end()) { // 检查车辆是否有记录的最后交叉口
     auto junction_id = vehicle_last_junction.at(actor_id); // 获取该车辆的最后交叉口ID
 
@@ -189,6 +219,7 @@ void TrafficLightStage::Reset() {
   entering_vehicles_map.clear(); // 清空进入车辆的映射
   vehicle_last_junction.clear(); // 清空最后交叉口的映射
   vehicle_stop_time.clear(); // 清空停车时间记录
+  last_evaluation.clear(); // 清空上一次评估的记录
 }
 
 } // namespace traffic_manager
@@ -27,6 +27,16 @@ private:
   std::unordered_map<ActorId, JunctionID> vehicle_last_junction;     // 车辆 ID 到路口 ID 的无序映射
   // 包含参与者首次在停车标志处停止的时间戳的映射。
   std::unordered_map<ActorId, cc::Timestamp> vehicle_stop_time;    // 车辆 ID 到时间戳的无序映射
+  // 车辆上一次评估时的输入和结果。不在无信号灯路口队列中的车辆，如果交通灯状态和
+  // 路径缓冲区的起点都没有变化，直接使用上一次的结果，不再查找路口和抽取随机数。
+  struct JunctionEvaluation {
+    uint64_t front_waypoint_id = 0u;
+    JunctionID affected_junction_id = -1;
+    TLS traffic_light_state = TLS::Unknown;
+    bool at_traffic_light = false;
+    bool traffic_light_hazard = false;
+  };
+  std::unordered_map<ActorId, JunctionEvaluation> last_evaluation;
   TLFrame &output_array;   // 输出数组的引用
   RandomGenerator &random_device;        // 随机数生成器的引用
   cc::Timestamp current_timestamp; // 当前时间戳
@@ -49,6 +59,9 @@ public:
                     const cc::World &world,
                     TLFrame &output_array,
                     RandomGenerator &random_device);
+
+  // 获取本周期的时间戳，在本周期调用 Update 之前调用。
+  void UpdateWorldInfo();
 // 构造函数
 
   void Update(const unsigned long index) override;     // 重写的更新函数
@@ -72,6 +72,17 @@ public:
     }
   }
 
+  /// \brief 设置分片模式下本交通管理器负责的区域。  
+  /// \param region 本分片的区域，范围为零时关闭分片模式。  
+  /// \param neighbour_endpoints 相邻分片交通管理器的地址，格式为"host:port"。  
+  /// \param neighbour_regions 相邻分片的区域，与neighbour_endpoints一一对应。
+  void SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetShardRegion(region, neighbour_endpoints, neighbour_regions);
+    }
+  }
+
   /// \brief 设置自定义路径。  
 /// \param actor 对应的Actor指针。  
 /// \param path 要设置的路径。  
@@ -134,6 +145,36 @@ public:
     }
   }
 
+  /// \brief 为一组车辆规划到各自终点的路线，并作为自定义路径设置。  
+/// \param actors 要设置路线的车辆。  
+/// \param destinations 每辆车的终点，与actors一一对应。  
+/// \param empty_buffer 如果为true，则在设置新路径前清空缓冲区。
+  void SetDestinations(const std::vector<ActorPtr> &actors, const std::vector<cg::Location> &destinations, const bool empty_buffer) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetDestinations(actors, destinations, empty_buffer);
+    }
+  }
+
+  /// \brief 批量设置车辆参数，远程交通管理器只需要一次调用。  
+/// \param updates 每一项为一辆车的一个参数的新值，按顺序应用。
+  void SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetVehicleParameters(updates);
+    }
+  }
+
+  /// \brief 注册车辆，并在它们第一次更新之前应用参数预设。  
+/// \param actor_list 要注册的车辆列表。  
+/// \param presets 车辆的参数，与SetVehicleParameters相同。
+  void RegisterVehicles(const std::vector<ActorPtr> &actor_list, const std::vector<VehicleParameterUpdate> &presets) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->RegisterVehicles(actor_list, presets);
+    }
+  }
+
   /// \brief 设置是否自动重生车辆。  
 /// \param mode_switch 如果为true，则启用自动重生；如果为false，则禁用。
   void SetRespawnDormantVehicles(const bool mode_switch) {
@@ -183,6 +224,25 @@ public:
     }
   }
 
+  /// @brief 设置混合物理模式下细节层次的半径。
+  /// @param radius 细节层次半径，为 0 时不区分细节层次。
+  void SetMesoscopicRadius(const float radius) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetMesoscopicRadius(radius);
+    }
+  }
+
+  /// @brief 设置执行各阶段逐车辆更新的线程数。
+  /// 车辆很多时，碰撞检测和运动规划中的逐车辆计算可以分配到多个线程上。
+  /// @param number_of_threads 线程数，不大于 1 时各阶段顺序执行。
+  void SetStageWorkerThreads(const uint32_t number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetStageWorkerThreads(number_of_threads);
+    }
+  }
+
   /// @brief 向交通管理器注册车辆。  
 /// 此方法用于将一组车辆注册到TrafficManager中。  
 /// @param actor_list 要注册的车辆列表。
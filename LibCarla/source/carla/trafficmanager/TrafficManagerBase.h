@@ -7,8 +7,12 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
+#include "carla/geom/BoundingBox.h"/// @brief 包含CARLA几何库中BoundingBox类的定义
 #include "carla/client/Actor.h"/// @brief 包含CARLA客户端中Actor类的定义
 #include "carla/trafficmanager/SimpleWaypoint.h"/// @brief 包含CARLA交通管理器中SimpleWaypoint类的定义
+#include "carla/trafficmanager/VehicleParameterUpdate.h"
 /**
  * @namespace carla::traffic_manager
  * @brief CARLA交通管理器的命名空间。
@@ -280,6 +284,23 @@ public:
  */
   virtual void SetHybridPhysicsRadius(const float radius) = 0;
 
+  /**
+ * @brief 设置混合物理模式下细节层次的半径。
+ *
+ * 混合物理半径以外、该半径以内的车辆每隔几个周期才检测一次碰撞，该半径以外的
+ * 车辆只跟随同一路径上的前车行驶，不进行几何碰撞检测，也不主动变道。
+ *
+ * @param radius 细节层次半径，为 0 时不区分细节层次。
+ */
+  virtual void SetMesoscopicRadius(const float radius) = 0;
+
+  /**
+ * @brief 设置执行各阶段逐车辆更新的线程数。
+ *
+ * @param number_of_threads 线程数，不大于 1 时各阶段顺序执行。
+ */
+  virtual void SetStageWorkerThreads(const uint32_t number_of_threads) = 0;
+
   /**
  * @brief 设置随机化种子。
  *
@@ -294,6 +315,15 @@ public:
  */
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /**
+ * @brief 设置分片模式下本交通管理器负责的区域。
+ *
+ * @param region 本分片的区域，范围为零时关闭分片模式。
+ * @param neighbour_endpoints 相邻分片交通管理器的地址，格式为 "host:port"。
+ * @param neighbour_regions 相邻分片的区域，与 neighbour_endpoints 一一对应。
+ */
+  virtual void SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions) = 0;
+
   /**
    * @brief 设置自定义导入路径。
    *
@@ -344,6 +374,30 @@ public:
   */
   virtual void UpdateImportedRoute(const ActorId &actor_id, const Route route) = 0;
 
+  /**
+ * @brief 为一组车辆规划到各自终点的路线，并作为自定义路径设置。
+ *
+ * @param actors 车辆指针列表。
+ * @param destinations 每辆车的终点，与 actors 一一对应。
+ * @param empty_buffer 是否清空缓冲区。
+ */
+  virtual void SetDestinations(const std::vector<ActorPtr> &actors, const std::vector<cg::Location> &destinations, const bool empty_buffer) = 0;
+
+  /**
+ * @brief 按顺序批量设置车辆参数，每一项与对应的单个设置函数相同。
+ *
+ * @param updates 每一项为一辆车的一个参数的新值。
+ */
+  virtual void SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) = 0;
+
+  /**
+ * @brief 注册车辆，并在它们第一次更新之前应用参数预设。
+ *
+ * @param actor_list 车辆列表。
+ * @param presets 车辆的参数，与 SetVehicleParameters 相同。
+ */
+  virtual void RegisterVehicles(const std::vector<ActorPtr> &actor_list, const std::vector<VehicleParameterUpdate> &presets) = 0;
+
   /**
  * @brief 设置休眠车辆的自动重生。
  *
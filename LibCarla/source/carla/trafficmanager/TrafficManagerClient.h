@@ -8,6 +8,7 @@
 
 #include "carla/trafficmanager/Constants.h"// 引入常量定义
 #include "carla/rpc/Actor.h"// 引入Actor类的定义
+#include "carla/trafficmanager/VehicleParameterUpdate.h"
 
 #include <rpc/client.h>// 引入RPC客户端库
 
@@ -278,6 +279,18 @@ public:
     _client->call("set_hybrid_physics_radius", radius);/// 调用_client的call方法设置混合物理模式的半径
   }
 
+  /// 设置混合物理模式下细节层次的半径
+  void SetMesoscopicRadius(const float radius) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_mesoscopic_radius", radius);
+  }
+
+  /// 设置执行各阶段逐车辆更新的线程数
+  void SetStageWorkerThreads(const uint32_t number_of_threads) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_stage_worker_threads", number_of_threads);
+  }
+
   /// 设置随机化种子
   void SetRandomDeviceSeed(const uint64_t seed) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
@@ -290,6 +303,12 @@ public:
     _client->call("set_osm_mode", mode_switch);/// 调用_client的call方法设置Open Street Map模式
   }
 
+  /// 设置分片模式下交通管理器负责的区域
+  void SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_shard_region", region, neighbour_endpoints, neighbour_regions);/// 调用_client的call方法设置分片区域
+  }
+
   /// 设置自定义路径
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
@@ -326,6 +345,24 @@ public:
     _client->call("update_imported_route", actor_id, route);/// 调用_client的call方法，传入"update_imported_route"指令、actor_id和route
   }
 
+  /// 为一组车辆规划到各自终点的路线的方法
+  void SetDestinations(const std::vector<carla::rpc::Actor> &actors, const std::vector<cg::Location> &destinations, const bool empty_buffer) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client不为nullptr
+    _client->call("set_destinations", actors, destinations, empty_buffer);/// 调用_client的call方法，传入"set_destinations"指令、actors、destinations和empty_buffer
+  }
+
+  /// 批量设置车辆参数的方法，只发送车辆的 ID
+  void SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_vehicle_parameters", updates);
+  }
+
+  /// 注册车辆并应用参数预设的方法
+  void RegisterVehicle(const std::vector<carla::rpc::Actor> &actor_list, const std::vector<VehicleParameterUpdate> &presets) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("register_vehicle_with_parameters", actor_list, presets);
+  }
+
   /// 设置休眠车辆的自动重生模式的方法
   void SetRespawnDormantVehicles(const bool mode_switch) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client不为nullptr
@@ -5,6 +5,8 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <algorithm>
+#include <cstdlib>
+#include <exception>
 
 #include "carla/Logging.h"
 
@@ -44,13 +46,14 @@ TrafficManagerLocal::TrafficManagerLocal(
                                          localization_frame,
                                          random_device)),
 
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_device)),
+    // CollisionStage 包含互斥锁，不能移动，因此直接构造
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    parameters,
+                    collision_frame,
+                    random_device),
 
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
@@ -97,7 +100,9 @@ TrafficManagerLocal::TrafficManagerLocal(
               motion_plan_stage,
               vehicle_light_stage)),
 
-    server(TrafficManagerServer(RPCportTM, static_cast<carla::traffic_manager::TrafficManagerBase *>(this))) {
+    server(TrafficManagerServer(RPCportTM, static_cast<carla::traffic_manager::TrafficManagerBase *>(this))),
+
+    metrics(server.port()) {
 
   parameters.SetGlobalPercentageSpeedDifference(perc_difference_from_limit);
 
@@ -108,27 +113,68 @@ TrafficManagerLocal::TrafficManagerLocal(
   Start();
 }
 
+TrafficManagerLocal::Metrics::Metrics(const uint16_t port) {
+  auto &registry = carla::profiler::MetricsRegistry::Get();
+  const carla::profiler::MetricLabels labels = {{"port", std::to_string(port)}};
+  auto stage = [&](const char *name) {
+    carla::profiler::MetricLabels stage_labels = labels;
+    stage_labels.emplace_back("stage", name);
+    return registry.GetHistogram(
+        "carla_traffic_manager_stage_duration_seconds",
+        "Time spent in each traffic manager stage per cycle.",
+        stage_labels);
+  };
+  cycles = registry.GetCounter(
+      "carla_traffic_manager_cycles_total",
+      "Traffic manager cycles run.",
+      labels);
+  cycle_duration = registry.GetHistogram(
+      "carla_traffic_manager_cycle_duration_seconds",
+      "Time from the start of a traffic manager cycle to sending its commands.",
+      labels);
+  alsm = stage("alsm");
+  localization = stage("localization");
+  collision = stage("collision");
+  planning = stage("motion_planning");
+  vehicle_light = stage("vehicle_light");
+  send_control = stage("send_control");
+  registered_vehicles = registry.GetGauge(
+      "carla_traffic_manager_registered_vehicles",
+      "Vehicles registered with the traffic manager.",
+      labels);
+}
+
 TrafficManagerLocal::~TrafficManagerLocal() {
   episode_proxy.Lock()->DestroyTrafficManager(server.port());
   Release();
 }
 
 void TrafficManagerLocal::SetupLocalMap() {
+  {
+    // 路线规划器引用旧的本地地图
+    std::lock_guard<std::mutex> lock(route_planner_mutex);
+    route_planner.reset();
+  }
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();
   local_map = std::make_shared<InMemoryMap>(world_map);
 
+  // 优先使用服务器随地图分发的缓存，其次是本机之前保存的缓存，
+  // 都不可用时才重新构建并保存到本机缓存
+  bool loaded = false;
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
   if (!files.empty()) {
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
     if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
+      loaded = local_map->Load(content);
     }
-  } else {
+  }
+  if (!loaded) {
+    loaded = local_map->LoadFromContentCache();
+  }
+  if (!loaded) {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
     local_map->SetUp();
+    local_map->SaveToContentCache();
   }
 }
 
@@ -171,17 +217,30 @@ void TrafficManagerLocal::Run() {
     }
 
     // 停止TM处理同一帧多次
+    const carla::client::Timestamp timestamp = world.GetSnapshot().GetTimestamp();
     if (!synchronous_mode) {
-      carla::client::Timestamp timestamp = world.GetSnapshot().GetTimestamp();
       if (timestamp.frame == last_frame) {
         continue;
       }
       last_frame = timestamp.frame;
     }
+    // 各阶段的随机决策由（种子、车辆、帧）决定，与并行更新的顺序无关
+    random_device.SetFrame(timestamp.frame);
+
+    carla::profiler::LapTimer stage_timer;
+    carla::profiler::ScopedHistogramTimer cycle_timer(metrics.cycle_duration.get());
+    metrics.cycles->Increment();
 
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // 更新模拟状态、角色生命周期并执行必要的清理
     alsm.Update();
+    stage_timer.Lap(metrics.alsm.get());
+
+    // 分片模式下，离开本分片区域的车辆不再由本交通管理器控制
+    const std::shared_ptr<const ShardLayout> shard_layout = parameters.GetShardLayout();
+    if (shard_layout != nullptr) {
+      CollectShardHandOffs(*shard_layout);
+    }
 
     // 基于已注册车辆数量变化的阶段间通信帧重新分配
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -202,6 +261,7 @@ void TrafficManagerLocal::Run() {
 
       registered_vehicles_state = registered_vehicles.GetState();
     }
+    metrics.registered_vehicles->Set(static_cast<double>(number_of_vehicles));
 
     // 重置当前周期的帧
     localization_frame.clear();
@@ -218,33 +278,174 @@ void TrafficManagerLocal::Run() {
     // 这将在运动规划阶段插入
     control_frame.resize(number_of_vehicles);
 
-    // 运行核心操作阶段
+    // ALSM 可能增删了参与者，重新查找已注册车辆在模拟状态数组中的位置
+    simulation_state.RefreshVehicleIndices(vehicle_id_list);
+    // 各阶段按车辆索引读取本周期的参数块
+    parameters.RefreshVehicleParameters(vehicle_id_list);
+
+    // 根据设置的线程数创建或释放线程池
+    const uint32_t stage_worker_threads = parameters.GetStageWorkerThreads();
+    if (stage_worker_threads <= 1u) {
+      stage_worker_pool.reset();
+    } else if (stage_worker_pool == nullptr || stage_worker_pool->GetNumberOfThreads() != stage_worker_threads) {
+      stage_worker_pool = std::make_unique<StageWorkerPool>(stage_worker_threads);
+    }
+
+    // 运行核心操作阶段。定位阶段会修改交通跟踪和其他车辆读取的路径缓冲，
+    // 交通灯阶段按车辆的顺序决定无信号灯路口的通行权，因此始终顺序执行
+    stage_timer.Lap(nullptr);
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       localization_stage.Update(index);
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
+    stage_timer.Lap(metrics.localization.get());
+    collision_stage.PrepareCycle();
+    if (stage_worker_pool != nullptr) {
+      stage_worker_pool->ParallelFor(static_cast<unsigned long>(vehicle_id_list.size()), [this](const unsigned long index) {
+        collision_stage.Update(index);
+      });
+    } else {
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        collision_stage.Update(index);
+      }
     }
+    collision_stage.ApplyCollisionLocks();
     collision_stage.ClearCycleCache();
+    stage_timer.Lap(metrics.collision.get());
     vehicle_light_stage.UpdateWorldInfo();
+    traffic_light_stage.UpdateWorldInfo();
+    motion_plan_stage.UpdateWorldInfo();
+    if (stage_worker_pool != nullptr) {
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        traffic_light_stage.Update(index);
+      }
+      // 运动规划阶段只读取交通灯、碰撞和定位帧中自己的元素，使用 PID 控制器的
+      // 车辆可以并行更新，被传送的车辆在之后顺序更新
+      motion_plan_stage.PartitionForParallelUpdate(parallel_indices, sequential_indices);
+      stage_worker_pool->ParallelFor(static_cast<unsigned long>(parallel_indices.size()), [this](const unsigned long i) {
+        motion_plan_stage.Update(parallel_indices[i]);
+      });
+      for (const unsigned long index : sequential_indices) {
+        motion_plan_stage.Update(index);
+      }
+    } else {
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        traffic_light_stage.Update(index);
+        motion_plan_stage.Update(index);
+      }
+    }
+    // 批量计算使用 PID 控制器的车辆的控制命令
+    motion_plan_stage.ApplyActuation();
+    stage_timer.Lap(metrics.planning.get());
+    // 车辆灯光阶段读取控制命令并向控制帧追加命令，必须在运动规划之后顺序执行
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
       vehicle_light_stage.Update(index);
     }
+    stage_timer.Lap(metrics.vehicle_light.get());
 
     registration_lock.unlock();
 
     // 将当前周期的批处理命令发送给模拟器
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+      SendControlFrame();
       step_end.store(true);
       step_end_trigger.notify_one();
     } else {
       if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+        SendControlFrame();
       }
     }
+    stage_timer.Lap(metrics.send_control.get());
+
+    // 在释放注册锁之后移交车辆，相邻分片可能同时向本交通管理器移交车辆
+    if (shard_layout != nullptr) {
+      SendShardHandOffs(*shard_layout);
+    }
+  }
+}
+
+void TrafficManagerLocal::SendControlFrame() {
+  auto simulator = episode_proxy.Lock();
+  if (!vehicle_controls_supported) {
+    simulator->ApplyBatchSync(control_frame, false);
+    return;
+  }
+
+  // 车辆控制不用等待游戏线程处理，只有灯光等其余命令走apply_batch
+  vehicle_control_frame.clear();
+  other_control_frame.clear();
+  for (const carla::rpc::Command &command : control_frame) {
+    const auto *control = boost::variant2::get_if<carla::rpc::Command::ApplyVehicleControl>(&command.command);
+    if (control != nullptr) {
+      vehicle_control_frame.emplace_back(*control);
+    } else {
+      other_control_frame.emplace_back(command);
+    }
+  }
+
+  if (!vehicle_control_frame.empty()) {
+    bool applied = false;
+    try {
+      applied = simulator->ApplyVehicleControls(vehicle_control_frame);
+      if (!applied) {
+        log_warning("batched vehicle control not available, falling back to apply_batch");
+        vehicle_controls_supported = false;
+      }
+    } catch (const std::exception &e) {
+      // 服务器拒绝整批时不会应用其中任何控制，这一帧改用apply_batch逐个应用
+      log_warning("batched vehicle control rejected, sending this frame with apply_batch:", e.what());
+    }
+    if (!applied) {
+      simulator->ApplyBatchSync(control_frame, false);
+      return;
+    }
+  }
+  if (parameters.GetSynchronousMode() || !other_control_frame.empty()) {
+    simulator->ApplyBatchSync(other_control_frame, false);
+  }
+}
+
+void TrafficManagerLocal::CollectShardHandOffs(const ShardLayout &shard_layout) {
+  shard_handoffs.resize(shard_layout.GetNeighbours().size());
+  for (const ActorPtr &vehicle : registered_vehicles.GetList()) {
+    const ActorId actor_id = vehicle->GetId();
+    if (!simulation_state.ContainsActor(actor_id)) {
+      continue;
+    }
+    const size_t target = shard_layout.FindHandOffTarget(simulation_state.GetLocation(actor_id));
+    if (target != ShardLayout::NO_NEIGHBOUR) {
+      shard_handoffs[target].push_back(vehicle);
+      alsm.RemoveActor(actor_id, true);
+    }
+  }
+}
+
+void TrafficManagerLocal::SendShardHandOffs(const ShardLayout &shard_layout) {
+  const std::vector<ShardNeighbour> &neighbours = shard_layout.GetNeighbours();
+  for (unsigned long i = 0u; i < shard_handoffs.size(); ++i) {
+    std::vector<ActorPtr> &vehicles = shard_handoffs[i];
+    if (vehicles.empty()) {
+      continue;
+    }
+    const ShardNeighbour &neighbour = neighbours[i];
+    std::vector<carla::rpc::Actor> actors;
+    actors.reserve(vehicles.size());
+    for (const ActorPtr &vehicle : vehicles) {
+      actors.emplace_back(vehicle->Serialize());
+    }
+    try {
+      std::unique_ptr<TrafficManagerClient> &client =
+          shard_clients[neighbour.host + ":" + std::to_string(neighbour.port)];
+      if (client == nullptr) {
+        client = std::make_unique<TrafficManagerClient>(neighbour.host, neighbour.port);
+      }
+      client->RegisterVehicle(actors);
+    } catch (const std::exception &e) {
+      log_warning("failed to hand off vehicles to the traffic manager at",
+                  neighbour.host + ":" + std::to_string(neighbour.port), ":", e.what());
+      // 移交失败的车辆继续由本分片控制，下一个周期重试
+      RegisterVehicles(vehicles);
+    }
+    vehicles.clear();
   }
 }
 
@@ -273,6 +474,9 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();
   }
+  stage_worker_pool.reset();
+  shard_clients.clear();
+  shard_handoffs.clear();
 
   vehicle_id_list.clear();
   registered_vehicles.Clear();
@@ -318,6 +522,18 @@ void TrafficManagerLocal::RegisterVehicles(const std::vector<ActorPtr> &vehicle_
   registered_vehicles.Insert(vehicle_list);
 }
 
+void TrafficManagerLocal::RegisterVehicles(const std::vector<ActorPtr> &vehicle_list,
+                                           const std::vector<VehicleParameterUpdate> &presets) {
+  std::lock_guard<std::mutex> registration_lock(registration_mutex);
+  // 先应用参数，车辆注册后的第一个周期就使用它们
+  parameters.SetVehicleParameters(presets);
+  registered_vehicles.Insert(vehicle_list);
+}
+
+void TrafficManagerLocal::SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) {
+  parameters.SetVehicleParameters(updates);
+}
+
 void TrafficManagerLocal::UnregisterVehicles(const std::vector<ActorPtr> &actor_list) {
   std::lock_guard<std::mutex> registration_lock(registration_mutex);
   std::vector<ActorId> actor_id_list;
@@ -407,10 +623,52 @@ void TrafficManagerLocal::SetHybridPhysicsRadius(const float radius) {
   parameters.SetHybridPhysicsRadius(radius);
 }
 
+void TrafficManagerLocal::SetMesoscopicRadius(const float radius) {
+  parameters.SetMesoscopicRadius(radius);
+}
+
+void TrafficManagerLocal::SetStageWorkerThreads(const uint32_t number_of_threads) {
+  parameters.SetStageWorkerThreads(number_of_threads);
+}
+
 void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetShardRegion(const cg::BoundingBox &region,
+                                         const std::vector<std::string> &neighbour_endpoints,
+                                         const std::vector<cg::BoundingBox> &neighbour_regions) {
+  if (region.extent.x <= 0.0f || region.extent.y <= 0.0f) {
+    parameters.SetShardLayout(nullptr);
+    return;
+  }
+  if (neighbour_endpoints.size() != neighbour_regions.size()) {
+    log_warning("SetShardRegion: the number of neighbour endpoints and regions differ");
+    return;
+  }
+
+  std::vector<ShardNeighbour> neighbours;
+  neighbours.reserve(neighbour_endpoints.size());
+  for (unsigned long i = 0u; i < neighbour_endpoints.size(); ++i) {
+    // 地址的格式为 "host:port"
+    const std::string &endpoint = neighbour_endpoints[i];
+    const size_t separator = endpoint.rfind(':');
+    char *end = nullptr;
+    const unsigned long port = (separator == std::string::npos) ? 0u :
+        std::strtoul(endpoint.c_str() + separator + 1u, &end, 10);
+    if (separator == 0u || port == 0u || port > 65535u || end == nullptr || *end != '\0') {
+      log_warning("SetShardRegion: invalid neighbour endpoint", endpoint);
+      return;
+    }
+    ShardNeighbour neighbour;
+    neighbour.host = endpoint.substr(0u, separator);
+    neighbour.port = static_cast<uint16_t>(port);
+    neighbour.region = neighbour_regions[i];
+    neighbours.push_back(neighbour);
+  }
+  parameters.SetShardLayout(std::make_shared<const ShardLayout>(region, std::move(neighbours)));
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
@@ -435,6 +693,37 @@ void TrafficManagerLocal::UpdateImportedRoute(const ActorId &actor_id, const Rou
   parameters.UpdateImportedRoute(actor_id, route);
 }
 
+void TrafficManagerLocal::SetDestinations(const std::vector<ActorPtr> &actors,
+                                          const std::vector<cg::Location> &destinations,
+                                          const bool empty_buffer) {
+  if (actors.size() != destinations.size()) {
+    log_warning("SetDestinations: the number of vehicles and destinations differ");
+    return;
+  }
+  std::vector<RoutePlanner::OriginDestination> queries;
+  queries.reserve(actors.size());
+  for (unsigned long i = 0u; i < actors.size(); ++i) {
+    queries.emplace_back(actors[i]->GetLocation(), destinations[i]);
+  }
+
+  std::vector<Path> paths;
+  {
+    std::lock_guard<std::mutex> lock(route_planner_mutex);
+    if (route_planner == nullptr) {
+      route_planner = std::make_unique<RoutePlanner>(local_map);
+    }
+    paths = route_planner->PlanRoutes(queries);
+  }
+
+  for (unsigned long i = 0u; i < actors.size(); ++i) {
+    if (paths[i].empty()) {
+      log_warning("SetDestinations: no route found for vehicle", actors[i]->GetId());
+    } else {
+      parameters.SetCustomPath(actors[i], paths[i], empty_buffer);
+    }
+  }
+}
+
 void TrafficManagerLocal::SetRespawnDormantVehicles(const bool mode_switch) {
   parameters.SetRespawnDormantVehicles(mode_switch);
 }
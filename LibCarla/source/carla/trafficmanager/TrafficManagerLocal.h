@@ -9,22 +9,28 @@
 #include <atomic>///@brief 包含C++原子操作库，用于线程安全的计数器和标志位
 #include <chrono>///@brief 包含C++时间库，用于时间测量和延迟
 #include <mutex>///@brief 包含C++互斥锁库，用于线程同步
+#include <string>///@brief 包含C++字符串库
 #include <thread>///@brief 包含C++线程库，用于多线程编程
+#include <unordered_map>///@brief 包含C++无序映射库
 #include <vector>///@brief 包含C++动态数组库，用于存储和管理序列化的数据
 
 #include "carla/client/detail/EpisodeProxy.h"///@brief 包含CARLA客户端的Episode代理类，用于管理仿真场景的一个回合
 #include "carla/client/TrafficLight.h"///@brief 包含CARLA客户端的交通灯控制类
 #include "carla/client/World.h"///@brief 包含CARLA客户端的世界管理类，用于访问和修改仿真世界
 #include "carla/Memory.h"///@brief 包含CARLA的内存管理类，用于管理内存分配和释放
+#include "carla/profiler/Metrics.h"///@brief 包含导出到监控系统的指标
 #include "carla/rpc/Command.h"///@brief 包含CARLA的RPC命令处理类，用于远程过程调用
 
 #include "carla/trafficmanager/AtomicActorSet.h"///@brief 包含交通管理器中的原子参与者集合类，用于管理仿真中的参与者（如车辆、行人）
 #include "carla/trafficmanager/InMemoryMap.h"///@brief 包含交通管理器的内存地图类，用于在内存中存储地图数据
 #include "carla/trafficmanager/Parameters.h"///@brief 包含交通管理器的参数配置类，用于配置交通管理器的各种参数
 #include "carla/trafficmanager/RandomGenerator.h"///@brief 包含交通管理器的随机数生成器类，用于生成随机数或随机序列
+#include "carla/trafficmanager/RoutePlanner.h"///@brief 包含在本地地图上规划车辆路线的类
 #include "carla/trafficmanager/SimulationState.h"///@brief 包含交通管理器的仿真状态类，用于管理仿真的全局状态
+#include "carla/trafficmanager/StageWorkerPool.h"///@brief 包含执行各阶段逐车辆更新的线程池
 #include "carla/trafficmanager/TrackTraffic.h"///@brief 包含交通管理器的流量跟踪类，用于跟踪和管理仿真中的交通流量
 #include "carla/trafficmanager/TrafficManagerBase.h"///@brief 包含交通管理器的基类，定义了交通管理器的基本接口和功能
+#include "carla/trafficmanager/TrafficManagerClient.h"///@brief 包含交通管理器的客户端类，用于向相邻分片移交车辆
 #include "carla/trafficmanager/TrafficManagerServer.h"///@brief 包含交通管理器的服务器类，用于管理交通管理器的网络通信
 
 #include "carla/trafficmanager/ALSM.h"///@brief 包含交通管理器的ALSM（高级状态机）类，用于管理交通参与者的状态转换
@@ -138,6 +144,9 @@ private:
   /// @brief 用于跟踪当前为帧保留的数组空间的变量 
   /// 这是一个无符号64位整数，用于记录为各个帧数组预留的空间大小
   uint64_t current_reserved_capacity {0u};
+  /// @brief 并行执行时，运动规划阶段可以并行更新和必须顺序更新的车辆索引
+  std::vector<unsigned long> parallel_indices;
+  std::vector<unsigned long> sequential_indices;
   /// @brief 表示交通管理器核心操作的各种阶段  
   /// 这些阶段包括定位、碰撞避免、交通灯响应、运动规划和车辆灯光控制等
   LocalizationStage localization_stage;
@@ -151,6 +160,20 @@ private:
   /// @brief 交通管理器服务器实例。  
   /// 负责处理来自客户端的请求，并管理交通管理器的运行
   TrafficManagerServer server;
+  /// @brief 导出的运行周期与各阶段耗时，以及已注册的车辆数，标签为交通管理器的端口
+  struct Metrics {
+    explicit Metrics(uint16_t port);
+    std::shared_ptr<carla::profiler::Counter> cycles;
+    std::shared_ptr<carla::profiler::Histogram> cycle_duration;
+    std::shared_ptr<carla::profiler::Histogram> alsm;
+    std::shared_ptr<carla::profiler::Histogram> localization;
+    std::shared_ptr<carla::profiler::Histogram> collision;
+    std::shared_ptr<carla::profiler::Histogram> planning;
+    std::shared_ptr<carla::profiler::Histogram> vehicle_light;
+    std::shared_ptr<carla::profiler::Histogram> send_control;
+    std::shared_ptr<carla::profiler::Gauge> registered_vehicles;
+  };
+  Metrics metrics;
   /// @brief 用于打开/关闭交通管理器的开关  
   /// 这是一个原子布尔变量，用于线程安全地控制交通管理器的运行状态
   std::atomic<bool> run_traffic_manger{true};
@@ -168,6 +191,16 @@ private:
   /// @brief 用于顺序执行子组件的单个工作线程  
   /// 使用std::unique_ptr<std::thread>管理线程的生命周期，确保线程在不再需要时能够被正确销毁
   std::unique_ptr<std::thread> worker_thread;
+  /// @brief 并行执行各阶段逐车辆更新的线程池，顺序执行时为空
+  std::unique_ptr<StageWorkerPool> stage_worker_pool;
+  /// @brief 在本地地图上规划路线，第一次调用SetDestinations时创建，地图重新加载时释放
+  std::unique_ptr<RoutePlanner> route_planner;
+  /// @brief 保护route_planner的互斥锁
+  std::mutex route_planner_mutex;
+  /// @brief 分片模式下与相邻分片交通管理器的连接，键为"host:port"，只在运行线程中使用
+  std::unordered_map<std::string, std::unique_ptr<TrafficManagerClient>> shard_clients;
+  /// @brief 本周期要移交给各相邻分片的车辆，与ShardLayout::GetNeighbours()一一对应
+  std::vector<std::vector<ActorPtr>> shard_handoffs;
   /// @brief 随机化种子  
   /// 使用当前时间作为随机化种子，确保每次程序运行时都能产生不同的随机序列
   uint64_t seed {static_cast<uint64_t>(time(NULL))};
@@ -185,6 +218,24 @@ private:
   /// @param tl_to_freeze 要检查的交通灯组 
   /// @return 如果所有交通灯都被冻结，则返回true；否则返回false
   bool CheckAllFrozen(TLGroup tl_to_freeze);
+  /// @brief 把离开本分片区域、进入相邻分片区域的车辆从本交通管理器中移除，并记录到shard_handoffs
+  ///
+  /// @param shard_layout 本周期使用的分片区域
+  void CollectShardHandOffs(const ShardLayout &shard_layout);
+  /// @brief 把shard_handoffs中的车辆注册到相邻分片的交通管理器上，失败的车辆重新注册到本交通管理器
+  ///
+  /// 会发起RPC调用，不能在持有registration_mutex时调用，否则两个分片同时移交时会死锁
+  ///
+  /// @param shard_layout 与CollectShardHandOffs使用的相同的分片区域
+  void SendShardHandOffs(const ShardLayout &shard_layout);
+  /// @brief 控制帧中的车辆控制命令，通过不等待游戏线程的批量车辆控制接口发送
+  std::vector<carla::rpc::Command::ApplyVehicleControl> vehicle_control_frame;
+  /// @brief 控制帧中的其余命令，仍然通过apply_batch发送
+  ControlFrame other_control_frame;
+  /// @brief 服务器是否支持批量车辆控制接口，旧版本的服务器不支持
+  bool vehicle_controls_supported {true};
+  /// @brief 把控制帧发送给模拟器，返回时命令都已被服务器接收
+  void SendControlFrame();
 
 public:
     /// @brief 私有构造函数，用于单例生命周期管理  
@@ -372,6 +423,16 @@ public:
 /// @param radius 混合物理模式的半径值
   void SetHybridPhysicsRadius(const float radius);
 
+  /// @brief 设置混合物理模式下细节层次的半径。
+  ///
+  /// @param radius 细节层次半径，为 0 时不区分细节层次
+  void SetMesoscopicRadius(const float radius);
+
+  /// @brief 设置执行各阶段逐车辆更新的线程数。
+///
+/// @param number_of_threads 线程数，不大于 1 时各阶段顺序执行
+  void SetStageWorkerThreads(const uint32_t number_of_threads);
+
   /// @brief 设置随机化种子。  
 ///   
 /// @param _seed 随机化种子值
@@ -382,6 +443,13 @@ public:
 /// @param mode_switch 是否启用Open Street Map模式。如果为true，则启用；如果为false，则禁用.
   void SetOSMMode(const bool mode_switch);
 
+  /// @brief 设置分片模式下本交通管理器负责的区域。  
+///   
+/// @param region 本分片的区域，范围为零时关闭分片模式。  
+/// @param neighbour_endpoints 相邻分片交通管理器的地址，格式为"host:port"。  
+/// @param neighbour_regions 相邻分片的区域，与neighbour_endpoints一一对应。
+  void SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions);
+
   /// @brief 设置自定义路径。  
 ///   
 /// @param actor 要设置路径的车辆指针。  
@@ -420,6 +488,24 @@ public:
 /// @param route 新的路线
   void UpdateImportedRoute(const ActorId &actor_id, const Route route);
 
+  /// @brief 为一组车辆规划到各自终点的路线，并作为自定义路径设置。  
+///   
+/// @param actors 要设置路线的车辆。  
+/// @param destinations 每辆车的终点，与actors一一对应。  
+/// @param empty_buffer 是否清空已有的路径缓冲区。找不到路线的车辆保持原来的路径
+  void SetDestinations(const std::vector<ActorPtr> &actors, const std::vector<cg::Location> &destinations, const bool empty_buffer);
+
+  /// @brief 按顺序批量设置车辆参数。  
+///   
+/// @param updates 每一项为一辆车的一个参数的新值
+  void SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates);
+
+  /// @brief 注册车辆，并在它们第一次更新之前应用参数预设。  
+///   
+/// @param actor_list 要注册的车辆列表。  
+/// @param presets 车辆的参数
+  void RegisterVehicles(const std::vector<ActorPtr> &actor_list, const std::vector<VehicleParameterUpdate> &presets);
+
   /// @brief 设置休眠车辆的自动重生模式。  
 ///   
 /// @param mode_switch 是否启用休眠车辆的自动重生模式。如果为true，则启用；如果为false，则禁用
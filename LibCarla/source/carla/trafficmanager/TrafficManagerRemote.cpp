@@ -6,6 +6,7 @@
 
 #include <thread>
 // 引入线程库
+#include <unordered_map>
 
 #include "carla/client/detail/Simulator.h"
 // 引入 Carla 客户端的模拟器实现细节头文件
@@ -282,11 +283,26 @@ void TrafficManagerRemote::SetHybridPhysicsRadius(const float radius) {
 // 通过客户端设置混合物理模式半径
 }
 
+void TrafficManagerRemote::SetMesoscopicRadius(const float radius) {
+  client.SetMesoscopicRadius(radius);
+// 通过客户端设置细节层次半径
+}
+
+void TrafficManagerRemote::SetStageWorkerThreads(const uint32_t number_of_threads) {
+  client.SetStageWorkerThreads(number_of_threads);
+// 通过客户端设置执行各阶段的线程数
+}
+
 void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
   client.SetOSMMode(mode_switch);
 // 通过客户端设置 OSM 模式开关
 }
 
+void TrafficManagerRemote::SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions) {
+  client.SetShardRegion(region, neighbour_endpoints, neighbour_regions);
+// 通过客户端设置分片区域
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 // 将输入的车辆转换为 rpc 格式的车辆
@@ -323,6 +339,60 @@ void TrafficManagerRemote::UpdateImportedRoute(const ActorId &actor_id, const Ro
 // 通过客户端更新车辆的导入路线
 }
 
+void TrafficManagerRemote::SetDestinations(const std::vector<ActorPtr> &_actors, const std::vector<cg::Location> &destinations, const bool empty_buffer) {
+  std::vector<carla::rpc::Actor> actors;
+  actors.reserve(_actors.size());
+  for (auto &&actor : _actors) {
+    actors.emplace_back(actor->Serialize());
+  }
+// 将输入的车辆转换为 rpc 格式的车辆
+
+  client.SetDestinations(actors, destinations, empty_buffer);
+// 通过客户端为车辆规划并设置路线
+}
+
+// 同一辆车的同一个参数只保留最后一个值，其余的项保持原来的顺序
+static std::vector<VehicleParameterUpdate> CollapseVehicleParameterUpdates(
+    const std::vector<VehicleParameterUpdate> &updates) {
+  std::unordered_map<uint64_t, size_t> last_update;
+  last_update.reserve(updates.size());
+  for (size_t i = 0u; i < updates.size(); ++i) {
+    const uint64_t key = (static_cast<uint64_t>(updates[i].actor_id) << 8u) |
+                         static_cast<uint64_t>(updates[i].parameter);
+    last_update[key] = i;
+  }
+  if (last_update.size() == updates.size()) {
+    return updates;
+  }
+  std::vector<VehicleParameterUpdate> result;
+  result.reserve(last_update.size());
+  for (size_t i = 0u; i < updates.size(); ++i) {
+    const uint64_t key = (static_cast<uint64_t>(updates[i].actor_id) << 8u) |
+                         static_cast<uint64_t>(updates[i].parameter);
+    if (last_update.at(key) == i) {
+      result.emplace_back(updates[i]);
+    }
+  }
+  return result;
+}
+
+void TrafficManagerRemote::SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates) {
+  if (updates.empty()) {
+    return;
+  }
+  client.SetVehicleParameters(CollapseVehicleParameterUpdates(updates));
+}
+
+void TrafficManagerRemote::RegisterVehicles(const std::vector<ActorPtr> &_actor_list,
+                                            const std::vector<VehicleParameterUpdate> &presets) {
+  std::vector<carla::rpc::Actor> actor_list;
+  actor_list.reserve(_actor_list.size());
+  for (auto &&actor : _actor_list) {
+    actor_list.emplace_back(actor->Serialize());
+  }
+  client.RegisterVehicle(actor_list, CollapseVehicleParameterUpdates(presets));
+}
+
 void TrafficManagerRemote::SetRespawnDormantVehicles(const bool mode_switch) {
   client.SetRespawnDormantVehicles(mode_switch);
 // 通过客户端设置是否复活休眠车辆
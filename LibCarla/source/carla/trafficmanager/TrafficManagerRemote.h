@@ -286,6 +286,20 @@ public:
  */
   void SetHybridPhysicsRadius(const float radius);
 
+  /**
+ * @brief 设置混合物理模式下细节层次的半径。
+ *
+ * @param radius 细节层次半径，为 0 时不区分细节层次。
+ */
+  void SetMesoscopicRadius(const float radius);
+
+  /**
+ * @brief 设置执行各阶段逐车辆更新的线程数。
+ *
+ * @param number_of_threads 线程数，不大于 1 时各阶段顺序执行。
+ */
+  void SetStageWorkerThreads(const uint32_t number_of_threads);
+
   /**
  * @brief 设置Open Street Map（OSM）模式。
  *
@@ -293,6 +307,15 @@ public:
  */
   void SetOSMMode(const bool mode_switch);
 
+  /**
+ * @brief 设置分片模式下本交通管理器负责的区域。
+ *
+ * @param region 本分片的区域，范围为零时关闭分片模式。
+ * @param neighbour_endpoints 相邻分片交通管理器的地址，格式为 "host:port"。
+ * @param neighbour_regions 相邻分片的区域，与 neighbour_endpoints 一一对应。
+ */
+  void SetShardRegion(const cg::BoundingBox &region, const std::vector<std::string> &neighbour_endpoints, const std::vector<cg::BoundingBox> &neighbour_regions);
+
   /**
  * @brief 设置自定义路径。
  *
@@ -343,6 +366,32 @@ public:
  */
   void UpdateImportedRoute(const ActorId &actor_id, const Route route);
 
+  /**
+  * @brief 为一组车辆规划到各自终点的路线，并作为自定义路径设置。
+  *
+  * @param actors 车辆指针列表。
+  * @param destinations 每辆车的终点，与 actors 一一对应。
+  * @param empty_buffer 是否清空缓冲区。
+  */
+  void SetDestinations(const std::vector<ActorPtr> &actors, const std::vector<cg::Location> &destinations, const bool empty_buffer);
+
+  /**
+  * @brief 在一次调用中批量设置车辆参数。
+  *
+  * 同一辆车的同一个参数只发送最后一个值。
+  *
+  * @param updates 每一项为一辆车的一个参数的新值。
+  */
+  void SetVehicleParameters(const std::vector<VehicleParameterUpdate> &updates);
+
+  /**
+  * @brief 在一次调用中注册车辆并应用参数预设。
+  *
+  * @param actor_list 需要注册的车辆列表。
+  * @param presets 车辆的参数。
+  */
+  void RegisterVehicles(const std::vector<ActorPtr> &actor_list, const std::vector<VehicleParameterUpdate> &presets);
+
   /**
   * @brief 设置自动重生休眠车辆的模式。
   *
@@ -293,12 +293,32 @@ public:
         tm->SetHybridPhysicsRadius(radius);
       });
 
+      /// 设置细节层次半径的方法
+      /// @param radius 细节层次的半径
+      server->bind("set_mesoscopic_radius", [=](const float radius) {
+        tm->SetMesoscopicRadius(radius);
+      });
+
+      /// 设置执行各阶段逐车辆更新的线程数的方法
+      /// @param number_of_threads 线程数，不大于 1 时顺序执行
+      server->bind("set_stage_worker_threads", [=](const uint32_t number_of_threads) {
+        tm->SetStageWorkerThreads(number_of_threads);
+      });
+
       /// 设置OSM（OpenStreetMap）模式的方法  
       /// @param mode_switch 是否开启OSM模式
       server->bind("set_osm_mode", [=](const bool mode_switch) {
         tm->SetOSMMode(mode_switch);
       });
 
+      /// 设置分片区域的方法  
+      /// @param region 本分片的区域  
+      /// @param neighbour_endpoints 相邻分片交通管理器的地址  
+      /// @param neighbour_regions 相邻分片的区域
+      server->bind("set_shard_region", [=](const cg::BoundingBox region, const std::vector<std::string> neighbour_endpoints, const std::vector<cg::BoundingBox> neighbour_regions) {
+        tm->SetShardRegion(region, neighbour_endpoints, neighbour_regions);
+      });
+
       /// 设置自定义路径的方法  
       /// @param actor CARLA中的Actor对象  
       /// @param path 自定义的路径  
@@ -348,6 +368,37 @@ public:
         tm->UpdateImportedRoute(actor_id, route);
       });
 
+      /// 为一组车辆规划到各自终点的路线的方法。  
+      /// @param actors 需要设置路线的Actor对象列表  
+      /// @param destinations 每个Actor的终点  
+      /// @param empty_buffer 一个布尔值，指示是否清空缓冲区
+      server->bind("set_destinations", [=](std::vector<carla::rpc::Actor> _actors, const std::vector<cg::Location> destinations, const bool empty_buffer) {
+        std::vector<ActorPtr> actors;
+        actors.reserve(_actors.size());
+        for (auto &&actor : _actors) {
+          actors.emplace_back(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()));
+        }
+        tm->SetDestinations(actors, destinations, empty_buffer);
+      });
+
+      /// 批量设置车辆参数的方法。  
+      /// @param updates 每一项为一辆车的一个参数的新值
+      server->bind("set_vehicle_parameters", [=](const std::vector<VehicleParameterUpdate> updates) {
+        tm->SetVehicleParameters(updates);
+      });
+
+      /// 注册车辆并应用参数预设的方法。  
+      /// @param _actor_list 需要注册的车辆列表  
+      /// @param presets 车辆的参数
+      server->bind("register_vehicle_with_parameters", [=](std::vector<carla::rpc::Actor> _actor_list, const std::vector<VehicleParameterUpdate> presets) {
+        std::vector<ActorPtr> actor_list;
+        actor_list.reserve(_actor_list.size());
+        for (auto &&actor : _actor_list) {
+          actor_list.emplace_back(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()));
+        }
+        tm->RegisterVehicles(actor_list, presets);
+      });
+
       /// 设置重生休眠车辆模式的方法。   
       /// @param server 用于绑定方法的服务器对象。  
       /// @param mode_switch 一个布尔值，指示是否开启重生休眠车辆模式
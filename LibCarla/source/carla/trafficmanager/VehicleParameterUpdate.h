@@ -0,0 +1,55 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 可以批量设置的车辆参数，每一项对应交通管理器中同名的单个设置函数。
+  enum class VehicleParameter : uint8_t {
+    PercentageSpeedDifference,
+    LaneOffset,
+    DesiredSpeed,
+    DistanceToLeadingVehicle,
+    /// 非 0 时启用
+    AutoLaneChange,
+    /// 非 0 时向右变道，否则向左
+    ForceLaneChange,
+    /// 非 0 时启用
+    UpdateVehicleLights,
+    PercentageRunningLight,
+    PercentageRunningSign,
+    PercentageIgnoreVehicles,
+    PercentageIgnoreWalkers,
+    KeepRightPercentage,
+    RandomLeftLaneChangePercentage,
+    RandomRightLaneChangePercentage,
+  };
+
+  /// 一辆车的一个参数的新值。只发送车辆的 ID，不需要像单个设置函数那样序列化
+  /// 整个参与者。
+  struct VehicleParameterUpdate {
+
+    rpc::ActorId actor_id = 0u;
+
+    VehicleParameter parameter = VehicleParameter::PercentageSpeedDifference;
+
+    /// 布尔参数以非 0 表示 true。
+    float value = 0.0f;
+
+    MSGPACK_DEFINE_ARRAY(actor_id, parameter, value);
+  };
+
+} // namespace traffic_manager
+} // namespace carla
+
+MSGPACK_ADD_ENUM(carla::traffic_manager::VehicleParameter);
@@ -0,0 +1,112 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  constexpr WaypointIndex WaypointGraph::INVALID_INDEX;
+
+  // 返回路径点在图中的索引，空指针或不在图中的路径点返回 INVALID_INDEX
+  static WaypointIndex GetIndexOf(
+      const SimpleWaypointPtr &simple_waypoint,
+      const std::vector<SimpleWaypointPtr> &dense_topology) {
+    if (simple_waypoint == nullptr) {
+      return WaypointGraph::INVALID_INDEX;
+    }
+    const WaypointIndex index = simple_waypoint->GetGraphIndex();
+    if (index >= dense_topology.size() || dense_topology[index] != simple_waypoint) {
+      return WaypointGraph::INVALID_INDEX;
+    }
+    return index;
+  }
+
+  // 把 @a neighbours 中属于图的路径点的索引追加到 CSR 数组中
+  static void AppendNeighbours(
+      const std::vector<SimpleWaypointPtr> &neighbours,
+      const std::vector<SimpleWaypointPtr> &dense_topology,
+      std::vector<uint32_t> &offsets,
+      std::vector<WaypointIndex> &indices) {
+    for (auto &neighbour : neighbours) {
+      const WaypointIndex index = GetIndexOf(neighbour, dense_topology);
+      if (index != WaypointGraph::INVALID_INDEX) {
+        indices.push_back(index);
+      }
+    }
+    offsets.push_back(static_cast<uint32_t>(indices.size()));
+  }
+
+  void WaypointGraph::Build(const std::vector<SimpleWaypointPtr> &dense_topology) {
+    const size_t size = dense_topology.size();
+
+    nodes.clear();
+    next_offsets.clear();
+    next_indices.clear();
+    previous_offsets.clear();
+    previous_indices.clear();
+    waypoints = dense_topology;
+
+    // 先分配索引，连接时才能找到邻居的位置
+    for (size_t i = 0u; i < size; ++i) {
+      dense_topology[i]->SetGraphIndex(static_cast<WaypointIndex>(i));
+    }
+
+    nodes.reserve(size);
+    next_offsets.reserve(size + 1u);
+    previous_offsets.reserve(size + 1u);
+    next_offsets.push_back(0u);
+    previous_offsets.push_back(0u);
+    for (auto &simple_waypoint : dense_topology) {
+      Node node;
+      node.location = simple_waypoint->GetLocation();
+      node.left = GetIndexOf(simple_waypoint->GetLeftWaypoint(), dense_topology);
+      node.right = GetIndexOf(simple_waypoint->GetRightWaypoint(), dense_topology);
+      node.geodesic_grid_id = simple_waypoint->GetGeodesicGridId();
+      node.road_option = simple_waypoint->GetRoadOption();
+      node.is_junction = simple_waypoint->CheckJunction();
+      nodes.push_back(node);
+
+      AppendNeighbours(simple_waypoint->GetNextWaypoint(), dense_topology, next_offsets, next_indices);
+      AppendNeighbours(simple_waypoint->GetPreviousWaypoint(), dense_topology, previous_offsets, previous_indices);
+    }
+    next_indices.shrink_to_fit();
+    previous_indices.shrink_to_fit();
+  }
+
+  void WaypointGraph::Build(
+      std::vector<Node> graph_nodes,
+      const std::vector<std::vector<WaypointIndex>> &successors) {
+    const size_t size = graph_nodes.size();
+    DEBUG_ASSERT(successors.size() == size);
+
+    nodes = std::move(graph_nodes);
+    waypoints.clear();
+
+    next_offsets.assign(1u, 0u);
+    next_indices.clear();
+    std::vector<std::vector<WaypointIndex>> predecessors(size);
+    for (size_t i = 0u; i < size; ++i) {
+      for (const WaypointIndex next : successors[i]) {
+        DEBUG_ASSERT(next < size);
+        next_indices.push_back(next);
+        predecessors[next].push_back(static_cast<WaypointIndex>(i));
+      }
+      next_offsets.push_back(static_cast<uint32_t>(next_indices.size()));
+    }
+
+    previous_offsets.assign(1u, 0u);
+    previous_indices.clear();
+    for (const auto &previous : predecessors) {
+      previous_indices.insert(previous_indices.end(), previous.begin(), previous.end());
+      previous_offsets.push_back(static_cast<uint32_t>(previous_indices.size()));
+    }
+  }
+
+} // namespace traffic_manager
+} // namespace carla
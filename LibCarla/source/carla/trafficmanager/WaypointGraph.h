@@ -0,0 +1,138 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+
+  /// 本地地图路径点图的紧凑表示。
+  ///
+  /// 节点按 SimpleWaypoint 在稠密拓扑中的顺序存放在连续数组中，节点之间用
+  /// WaypointIndex 相互引用；后继和前驱以压缩稀疏行（CSR）的格式存放在共享的
+  /// 数组中。遍历时既不需要复制 SimpleWaypointPtr 的列表，也没有引用计数
+  /// 和跨对象的指针访问。
+  class WaypointGraph {
+  public:
+
+    static constexpr WaypointIndex INVALID_INDEX = std::numeric_limits<WaypointIndex>::max();
+
+    struct Node {
+      cg::Location location;
+      /// 变道的目标节点，不存在时为 INVALID_INDEX。
+      WaypointIndex left = INVALID_INDEX;
+      WaypointIndex right = INVALID_INDEX;
+      /// 与 SimpleWaypoint::GetGeodesicGridId 相同（路口中为路口 ID）。
+      GeoGridId geodesic_grid_id = 0;
+      RoadOption road_option = RoadOption::Void;
+      /// 与 SimpleWaypoint::CheckJunction 相同。
+      bool is_junction = false;
+    };
+
+    /// 连续存放的一组相邻节点的索引。
+    class IndexRange {
+    public:
+
+      IndexRange(const WaypointIndex *begin, const WaypointIndex *end)
+        : _begin(begin),
+          _end(end) {}
+
+      const WaypointIndex *begin() const {
+        return _begin;
+      }
+
+      const WaypointIndex *end() const {
+        return _end;
+      }
+
+      size_t size() const {
+        return static_cast<size_t>(_end - _begin);
+      }
+
+      bool empty() const {
+        return _begin == _end;
+      }
+
+      WaypointIndex front() const {
+        return *_begin;
+      }
+
+      WaypointIndex operator[](const size_t i) const {
+        return _begin[i];
+      }
+
+    private:
+
+      const WaypointIndex *_begin;
+      const WaypointIndex *_end;
+    };
+
+    /// 由 @a dense_topology 重建图，并把每个路径点在图中的索引写回
+    /// SimpleWaypoint。必须在路径点之间的连接全部建立之后调用。
+    void Build(const std::vector<SimpleWaypointPtr> &dense_topology);
+
+    /// 由节点和每个节点的后继直接构建图，前驱由后继推出。这样构建的图没有
+    /// 对应的 SimpleWaypoint，不能调用 GetWaypoint。
+    void Build(std::vector<Node> graph_nodes, const std::vector<std::vector<WaypointIndex>> &successors);
+
+    size_t Size() const {
+      return nodes.size();
+    }
+
+    const Node &GetNode(const WaypointIndex index) const {
+      return nodes[index];
+    }
+
+    IndexRange GetNext(const WaypointIndex index) const {
+      return MakeRange(next_offsets, next_indices, index);
+    }
+
+    IndexRange GetPrevious(const WaypointIndex index) const {
+      return MakeRange(previous_offsets, previous_indices, index);
+    }
+
+    /// 返回索引对应的 SimpleWaypoint，用于与路径点缓冲区等按指针访问的代码交互。
+    const SimpleWaypointPtr &GetWaypoint(const WaypointIndex index) const {
+      return waypoints[index];
+    }
+
+  private:
+
+    static IndexRange MakeRange(
+        const std::vector<uint32_t> &offsets,
+        const std::vector<WaypointIndex> &indices,
+        const WaypointIndex index) {
+      const WaypointIndex *data = indices.data();
+      return IndexRange(data + offsets[index], data + offsets[index + 1u]);
+    }
+
+    std::vector<Node> nodes;
+
+    /// 节点 i 的后继为 next_indices[next_offsets[i], next_offsets[i + 1])。
+    std::vector<uint32_t> next_offsets;
+    std::vector<WaypointIndex> next_indices;
+
+    /// 节点 i 的前驱为 previous_indices[previous_offsets[i], previous_offsets[i + 1])。
+    std::vector<uint32_t> previous_offsets;
+    std::vector<WaypointIndex> previous_indices;
+
+    std::vector<SimpleWaypointPtr> waypoints;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
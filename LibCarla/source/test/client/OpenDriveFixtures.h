@@ -0,0 +1,208 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace util {
+namespace fixtures {
+
+  /// 两条首尾相连的 60 米直路，道路 0 的终点接道路 1 的起点。每条路两个方向
+  /// 各两条行车道，同方向的两条车道之间是允许变道的虚线，中心线和外侧为实线。
+  /// 每条路的车道 id 与相连道路的相同。
+  static constexpr const char TWO_ROADS_XODR[] = R"(<?xml version="1.0" standalone="yes"?>
+<OpenDRIVE>
+  <header revMajor="1" revMinor="4" name="two_roads" version="1"/>
+  <road name="Road 0" length="60" id="0" junction="-1">
+    <link><successor elementType="road" elementId="1" contactPoint="start"/></link>
+    <type s="0" type="town"><speed max="50" unit="km/h"/></type>
+    <planView>
+      <geometry s="0" x="0" y="0" hdg="0" length="60"><line/></geometry>
+    </planView>
+    <elevationProfile><elevation s="0" a="0" b="0" c="0" d="0"/></elevationProfile>
+    <lateralProfile/>
+    <lanes>
+      <laneOffset s="0" a="0" b="0" c="0" d="0"/>
+      <laneSection s="0">
+        <left>
+          <lane id="2" type="driving" level="false">
+            <link><successor id="2"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="solid" material="standard" color="white" width="0.15" laneChange="none"/>
+          </lane>
+          <lane id="1" type="driving" level="false">
+            <link><successor id="1"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="broken" material="standard" color="white" width="0.15" laneChange="both"/>
+          </lane>
+        </left>
+        <center>
+          <lane id="0" type="none" level="false">
+            <roadMark sOffset="0" type="solid solid" material="standard" color="yellow" width="0.15" laneChange="none"/>
+          </lane>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <link><successor id="-1"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="broken" material="standard" color="white" width="0.15" laneChange="both"/>
+          </lane>
+          <lane id="-2" type="driving" level="false">
+            <link><successor id="-2"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="solid" material="standard" color="white" width="0.15" laneChange="none"/>
+          </lane>
+        </right>
+      </laneSection>
+    </lanes>
+  </road>
+  <road name="Road 1" length="60" id="1" junction="-1">
+    <link><predecessor elementType="road" elementId="0" contactPoint="end"/></link>
+    <type s="0" type="town"><speed max="50" unit="km/h"/></type>
+    <planView>
+      <geometry s="0" x="60" y="0" hdg="0" length="60"><line/></geometry>
+    </planView>
+    <elevationProfile><elevation s="0" a="0" b="0" c="0" d="0"/></elevationProfile>
+    <lateralProfile/>
+    <lanes>
+      <laneOffset s="0" a="0" b="0" c="0" d="0"/>
+      <laneSection s="0">
+        <left>
+          <lane id="2" type="driving" level="false">
+            <link><predecessor id="2"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="solid" material="standard" color="white" width="0.15" laneChange="none"/>
+          </lane>
+          <lane id="1" type="driving" level="false">
+            <link><predecessor id="1"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="broken" material="standard" color="white" width="0.15" laneChange="both"/>
+          </lane>
+        </left>
+        <center>
+          <lane id="0" type="none" level="false">
+            <roadMark sOffset="0" type="solid solid" material="standard" color="yellow" width="0.15" laneChange="none"/>
+          </lane>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <link><predecessor id="-1"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="broken" material="standard" color="white" width="0.15" laneChange="both"/>
+          </lane>
+          <lane id="-2" type="driving" level="false">
+            <link><predecessor id="-2"/></link>
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+            <roadMark sOffset="0" type="solid" material="standard" color="white" width="0.15" laneChange="none"/>
+          </lane>
+        </right>
+      </laneSection>
+    </lanes>
+  </road>
+</OpenDRIVE>
+)";
+
+  /// 合成的地图：@a rows 行互不相连的道路，每行由 @a roads_per_row 条首尾相连的
+  /// 道路组成，直线与左右弯曲的圆弧交替出现。每条道路两个方向各两条行车道，
+  /// 外侧是人行道。
+  inline std::string GenerateRoadRows(size_t rows, size_t roads_per_row) {
+    constexpr double length = 50.0;
+    constexpr double curvature = 0.01;
+    constexpr double row_spacing = 80.0;
+    std::ostringstream xodr;
+    xodr << std::setprecision(12);
+    xodr << "<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+         << "<OpenDRIVE>\n"
+         << "  <header revMajor=\"1\" revMinor=\"4\" name=\"synthetic\" version=\"1\"/>\n";
+    const auto lane = [&](int id, const char *type, double width, bool solid_mark, bool has_predecessor, bool has_successor) {
+      xodr << "          <lane id=\"" << id << "\" type=\"" << type << "\" level=\"false\">\n"
+           << "            <link>";
+      // 左侧车道的方向与道路相反，前后连接的车道 id 相同
+      if (has_predecessor) {
+        xodr << "<predecessor id=\"" << id << "\"/>";
+      }
+      if (has_successor) {
+        xodr << "<successor id=\"" << id << "\"/>";
+      }
+      xodr << "</link>\n"
+           << "            <width sOffset=\"0\" a=\"" << width << "\" b=\"0\" c=\"0\" d=\"0\"/>\n"
+           << "            <roadMark sOffset=\"0\" type=\"" << (solid_mark ? "solid" : "broken")
+           << "\" material=\"standard\" color=\"white\" width=\"0.15\" laneChange=\"none\"/>\n"
+           << "          </lane>\n";
+    };
+    for (size_t row = 0u; row < rows; ++row) {
+      double x = 0.0;
+      double y = row_spacing * static_cast<double>(row);
+      double heading = 0.0;
+      for (size_t i = 0u; i < roads_per_row; ++i) {
+        const size_t id = row * roads_per_row + i;
+        const bool has_predecessor = i > 0u;
+        const bool has_successor = i + 1u < roads_per_row;
+        xodr << "  <road name=\"Road " << id << "\" length=\"" << length
+             << "\" id=\"" << id << "\" junction=\"-1\">\n"
+             << "    <link>";
+        if (has_predecessor) {
+          xodr << "<predecessor elementType=\"road\" elementId=\"" << id - 1u << "\" contactPoint=\"end\"/>";
+        }
+        if (has_successor) {
+          xodr << "<successor elementType=\"road\" elementId=\"" << id + 1u << "\" contactPoint=\"start\"/>";
+        }
+        xodr << "</link>\n"
+             << "    <type s=\"0\" type=\"town\"><speed max=\"50\" unit=\"km/h\"/></type>\n"
+             << "    <planView>\n"
+             << "      <geometry s=\"0\" x=\"" << x << "\" y=\"" << y << "\" hdg=\"" << heading
+             << "\" length=\"" << length << "\">";
+        // 直线、左弯、右弯依次出现，所以每三条道路之后航向恢复
+        const double k = (i % 3u == 1u) ? curvature : (i % 3u == 2u) ? -curvature : 0.0;
+        if (k == 0.0) {
+          xodr << "<line/>";
+          x += length * std::cos(heading);
+          y += length * std::sin(heading);
+        } else {
+          xodr << "<arc curvature=\"" << k << "\"/>";
+          const double end_heading = heading + k * length;
+          x += (std::sin(end_heading) - std::sin(heading)) / k;
+          y -= (std::cos(end_heading) - std::cos(heading)) / k;
+          heading = end_heading;
+        }
+        xodr << "</geometry>\n"
+             << "    </planView>\n"
+             << "    <elevationProfile><elevation s=\"0\" a=\"0\" b=\"0\" c=\"0\" d=\"0\"/></elevationProfile>\n"
+             << "    <lateralProfile/>\n"
+             << "    <lanes>\n"
+             << "      <laneOffset s=\"0\" a=\"0\" b=\"0\" c=\"0\" d=\"0\"/>\n"
+             << "      <laneSection s=\"0\">\n"
+             << "        <left>\n";
+        lane(3, "sidewalk", 2.0, true, has_predecessor, has_successor);
+        lane(2, "driving", 3.5, false, has_predecessor, has_successor);
+        lane(1, "driving", 3.5, true, has_predecessor, has_successor);
+        xodr << "        </left>\n"
+             << "        <center>\n"
+             << "          <lane id=\"0\" type=\"none\" level=\"false\">\n"
+             << "            <roadMark sOffset=\"0\" type=\"solid solid\" material=\"standard\" color=\"yellow\" width=\"0.15\" laneChange=\"none\"/>\n"
+             << "          </lane>\n"
+             << "        </center>\n"
+             << "        <right>\n";
+        lane(-1, "driving", 3.5, true, has_predecessor, has_successor);
+        lane(-2, "driving", 3.5, false, has_predecessor, has_successor);
+        lane(-3, "sidewalk", 2.0, true, has_predecessor, has_successor);
+        xodr << "        </right>\n"
+             << "      </laneSection>\n"
+             << "    </lanes>\n"
+             << "  </road>\n";
+      }
+    }
+    xodr << "</OpenDRIVE>\n";
+    return xodr.str();
+  }
+
+} // namespace fixtures
+} // namespace util
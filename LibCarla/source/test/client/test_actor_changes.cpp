@@ -0,0 +1,80 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/ActorChangeFeed.h>
+
+#include <vector>
+
+using namespace carla::client;
+using Kind = detail::ActorChangeFeed::ActorKind;
+
+static ActorSnapshot MakeActor(carla::rpc::ActorId id, float x) {
+  ActorSnapshot actor{};
+  actor.id = id;
+  actor.transform.location.x = x;
+  return actor;
+}
+
+// 1 为车辆，2 为交通灯，3 为行人
+static Kind KindOf(carla::rpc::ActorId id) {
+  return id == 1u ? Kind::Vehicle : (id == 2u ? Kind::TrafficLight : Kind::Other);
+}
+
+TEST(client, actor_changes) {
+  detail::ActorChangeFeed feed;
+  feed.SetMoveThreshold(1.0f);
+
+  std::vector<ActorSnapshot> actors = {MakeActor(1u, 0.0f), MakeActor(2u, 0.0f), MakeActor(3u, 0.0f)};
+  actors[1u].state.traffic_light_data.state = carla::rpc::TrafficLightState::Red;
+  auto changes = feed.Update(1u, actors, KindOf);
+  ASSERT_EQ(changes.frame, 1u);
+  ASSERT_EQ(changes.spawned, (std::vector<carla::rpc::ActorId>{1u, 2u, 3u}));
+  ASSERT_TRUE(changes.moved.empty());
+  ASSERT_TRUE(changes.traffic_lights.empty());
+
+  // 没有变化
+  ASSERT_TRUE(feed.Update(2u, actors, KindOf).empty());
+
+  // 每帧移动 0.6 米，累计超过阈值时才报告
+  actors[0u].transform.location.x = 0.6f;
+  ASSERT_TRUE(feed.Update(3u, actors, KindOf).empty());
+  actors[0u].transform.location.x = 1.2f;
+  changes = feed.Update(4u, actors, KindOf);
+  ASSERT_EQ(changes.moved, (std::vector<carla::rpc::ActorId>{1u}));
+  ASSERT_TRUE(feed.Update(5u, actors, KindOf).empty());
+
+  actors[0u].state.vehicle_data.light_state = 0x3u;
+  actors[1u].state.traffic_light_data.state = carla::rpc::TrafficLightState::Green;
+  actors.pop_back();
+  actors.push_back(MakeActor(4u, 0.0f));
+  changes = feed.Update(6u, actors, KindOf);
+  ASSERT_EQ(changes.spawned, (std::vector<carla::rpc::ActorId>{4u}));
+  ASSERT_EQ(changes.destroyed, (std::vector<carla::rpc::ActorId>{3u}));
+  ASSERT_EQ(changes.vehicle_lights.size(), 1u);
+  ASSERT_EQ(changes.vehicle_lights[0u].id, 1u);
+  ASSERT_EQ(changes.vehicle_lights[0u].previous, 0u);
+  ASSERT_EQ(changes.vehicle_lights[0u].state, 0x3u);
+  ASSERT_EQ(changes.traffic_lights.size(), 1u);
+  ASSERT_EQ(changes.traffic_lights[0u].previous, carla::rpc::TrafficLightState::Red);
+  ASSERT_EQ(changes.traffic_lights[0u].state, carla::rpc::TrafficLightState::Green);
+
+  // 新剧集中之前的参与者都报告为销毁，即使 ID 相同
+  feed.OnEpisodeChanged();
+  changes = feed.Update(1u, std::vector<ActorSnapshot>{MakeActor(1u, 5.0f)}, KindOf);
+  ASSERT_TRUE(changes.episode_changed);
+  ASSERT_EQ(changes.destroyed, (std::vector<carla::rpc::ActorId>{1u, 2u, 4u}));
+  ASSERT_EQ(changes.spawned, (std::vector<carla::rpc::ActorId>{1u}));
+  ASSERT_TRUE(changes.moved.empty());
+}
+
+TEST(client, actor_changes_kind) {
+  ASSERT_EQ(detail::ActorChangeFeed::GetActorKind("vehicle.tesla.model3"), Kind::Vehicle);
+  ASSERT_EQ(detail::ActorChangeFeed::GetActorKind("traffic.traffic_light"), Kind::TrafficLight);
+  ASSERT_EQ(detail::ActorChangeFeed::GetActorKind("traffic.stop"), Kind::Other);
+  ASSERT_EQ(detail::ActorChangeFeed::GetActorKind("walker.pedestrian.0001"), Kind::Other);
+}
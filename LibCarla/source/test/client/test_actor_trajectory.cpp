@@ -0,0 +1,55 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/ActorTrajectory.h>
+
+#include <vector>
+
+using namespace carla::client;
+
+// 匀加速运动（时间间隔不均匀）的导数在所有样本上都是精确的，yaw 跨过 180 度时
+// 按最短方向计算。
+TEST(client, actor_trajectory_derivatives) {
+  const std::vector<double> times = {0.0, 0.1, 0.3, 0.4, 0.7};
+  const float zero[ActorTrajectory::VECTOR_SIZE] = {0.0f, 0.0f, 0.0f};
+  ActorTrajectory trajectory(5u);
+  for (auto i = 0u; i < times.size(); ++i) {
+    const auto t = static_cast<float>(times[i]);
+    float yaw = 170.0f + 100.0f * t;
+    if (yaw >= 180.0f) {
+      yaw -= 360.0f;
+    }
+    const float transform[ActorTrajectory::TRANSFORM_SIZE] = {
+        2.0f * t + 1.5f * t * t, -3.0f * t, 4.0f, 0.0f, yaw, 0.0f};
+    trajectory.Append(i, times[i], transform, zero, zero, zero);
+  }
+  ASSERT_EQ(trajectory.size(), times.size());
+  ASSERT_EQ(trajectory.GetFrames(), (std::vector<uint64_t>{0u, 1u, 2u, 3u, 4u}));
+
+  const auto derivatives = trajectory.ComputeDerivatives();
+  ASSERT_EQ(derivatives.velocities.size(), times.size() * ActorTrajectory::VECTOR_SIZE);
+  for (auto i = 0u; i < times.size(); ++i) {
+    const auto row = i * ActorTrajectory::VECTOR_SIZE;
+    EXPECT_NEAR(derivatives.velocities[row], 2.0 + 3.0 * times[i], 1e-3);
+    EXPECT_NEAR(derivatives.velocities[row + 1u], -3.0, 1e-3);
+    EXPECT_NEAR(derivatives.velocities[row + 2u], 0.0, 1e-3);
+    EXPECT_NEAR(derivatives.accelerations[row], 3.0, 1e-2);
+    EXPECT_NEAR(derivatives.accelerations[row + 1u], 0.0, 1e-2);
+    EXPECT_NEAR(derivatives.rotation_rates[row + 1u], 100.0, 1e-2);
+  }
+}
+
+// 只有一个样本时没有导数。
+TEST(client, actor_trajectory_single_sample) {
+  const float values[ActorTrajectory::TRANSFORM_SIZE] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  ActorTrajectory trajectory(5u);
+  trajectory.Append(10u, 1.0, values, values, values, values);
+  const auto derivatives = trajectory.ComputeDerivatives();
+  ASSERT_EQ(derivatives.velocities, std::vector<float>(ActorTrajectory::VECTOR_SIZE, 0.0f));
+  ASSERT_EQ(derivatives.accelerations, std::vector<float>(ActorTrajectory::VECTOR_SIZE, 0.0f));
+}
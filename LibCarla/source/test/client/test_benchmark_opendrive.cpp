@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "OpenDriveFixtures.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Location.h>
+#include <carla/geom/Math.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/Map.h>
+#include <carla/rpc/OpendriveGenerationParameters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using carla::opendrive::OpenDriveParser;
+using carla::road::Map;
+
+// 道路地图各项操作的耗时：加载、最近路径点查询、生成路径点、生成拓扑、计算
+// 变换与生成网格。在测试内容中的每个 OpenDRIVE 文件以及合成的大地图上运行，
+// 每次的结果追加到当前目录的 benchmark_opendrive.jsonl 中，便于比较不同版本。
+
+static double Elapsed(const carla::StopWatch &stop_watch) {
+  return 1e-3 * static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>());
+}
+
+// 对 @a xodr 运行所有的测量，结果打印到标准输出并追加到 benchmark_opendrive.jsonl。
+static void benchmark_opendrive(const std::string &map_name, const std::string &xodr) {
+  constexpr auto number_of_queries = 10'000u;
+  constexpr auto loads = 3u;
+
+  // 加载取多次的最小值，避免第一次加载时的缓存与分配影响结果
+  double load_ms = 0.0;
+  boost::optional<Map> map;
+  for (auto i = 0u; i < loads; ++i) {
+    carla::StopWatch stop_watch;
+    map = OpenDriveParser::Load(xodr);
+    const double elapsed = Elapsed(stop_watch);
+    load_ms = (i == 0u) ? elapsed : std::min(load_ms, elapsed);
+  }
+  ASSERT_TRUE(map.has_value());
+
+  carla::StopWatch stop_watch;
+  const auto waypoints = map->GenerateWaypoints(2.0);
+  const double generate_waypoints_ms = Elapsed(stop_watch);
+  ASSERT_FALSE(waypoints.empty());
+
+  stop_watch.Restart();
+  const auto topology = map->GenerateTopology();
+  const double generate_topology_ms = Elapsed(stop_watch);
+
+  stop_watch.Restart();
+  std::vector<carla::geom::Location> locations;
+  locations.reserve(waypoints.size());
+  for (const auto &waypoint : waypoints) {
+    locations.emplace_back(map->ComputeTransform(waypoint).location);
+  }
+  const double compute_transform_ms = Elapsed(stop_watch);
+
+  // 查询位置在路径点附近随机偏移，随机数种子固定，每次运行的查询相同
+  std::mt19937_64 engine(42u);
+  std::uniform_int_distribution<size_t> pick(0u, locations.size() - 1u);
+  std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+  std::vector<carla::geom::Location> queries;
+  queries.reserve(number_of_queries);
+  for (auto i = 0u; i < number_of_queries; ++i) {
+    auto location = locations[pick(engine)];
+    location.x += offset(engine);
+    location.y += offset(engine);
+    queries.emplace_back(location);
+  }
+  stop_watch.Restart();
+  size_t found = 0u;
+  for (const auto &location : queries) {
+    found += map->GetClosestWaypointOnRoad(location).has_value() ? 1u : 0u;
+  }
+  const double closest_waypoint_ms = Elapsed(stop_watch);
+  ASSERT_EQ(found, queries.size());
+
+  stop_watch.Restart();
+  const auto mesh = map->GenerateMesh(2.0);
+  const double mesh_ms = Elapsed(stop_watch);
+
+  carla::rpc::OpendriveGenerationParameters parameters;
+  stop_watch.Restart();
+  const auto chunks = map->GenerateChunkedMesh(parameters);
+  const double chunked_mesh_ms = Elapsed(stop_watch);
+
+  const auto time = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  std::ostringstream json;
+  json << "{\"benchmark\":\"opendrive\",\"map\":\"" << map_name
+       << "\",\"time\":" << time
+       << ",\"xodr_bytes\":" << xodr.size()
+       << ",\"waypoints\":" << waypoints.size()
+       << ",\"topology\":" << topology.size()
+       << ",\"load_ms\":" << load_ms
+       << ",\"generate_waypoints_ms\":" << generate_waypoints_ms
+       << ",\"generate_topology_ms\":" << generate_topology_ms
+       << ",\"compute_transform_us\":" << 1e3 * compute_transform_ms / static_cast<double>(waypoints.size())
+       << ",\"closest_waypoint_us\":" << 1e3 * closest_waypoint_ms / static_cast<double>(queries.size())
+       << ",\"mesh_ms\":" << mesh_ms
+       << ",\"mesh_vertices\":" << mesh.GetVerticesNum()
+       << ",\"chunked_mesh_ms\":" << chunked_mesh_ms
+       << ",\"chunks\":" << chunks.size()
+       << "}";
+  std::cout << json.str() << std::endl;
+  std::ofstream("benchmark_opendrive.jsonl", std::ios_base::app) << json.str() << '\n';
+}
+
+TEST(benchmark_opendrive, test_maps) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    benchmark_opendrive(file, util::OpenDrive::Load(file));
+  }
+}
+
+TEST(benchmark_opendrive, synthetic_small) {
+  benchmark_opendrive("synthetic_10x10", util::fixtures::GenerateRoadRows(10u, 10u));
+}
+
+TEST(benchmark_opendrive, synthetic_large) {
+  benchmark_opendrive("synthetic_50x60", util::fixtures::GenerateRoadRows(50u, 60u));
+}
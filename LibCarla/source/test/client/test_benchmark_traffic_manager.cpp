@@ -0,0 +1,315 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/client/Timestamp.h>
+#include <carla/client/World.h>
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/Constants.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/LocalizationStage.h>
+#include <carla/trafficmanager/MotionPlanStage.h>
+#include <carla/trafficmanager/Parameters.h>
+#include <carla/trafficmanager/RandomGenerator.h>
+#include <carla/trafficmanager/SimulationState.h>
+#include <carla/trafficmanager/StageWorkerPool.h>
+#include <carla/trafficmanager/TrackTraffic.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cc = carla::client;
+namespace cg = carla::geom;
+namespace ctm = carla::traffic_manager;
+
+// 交通管理器各阶段每个周期的耗时与车辆数的关系，不需要模拟器：车辆状态由
+// 测试合成，沿路径缓冲中的路径点匀速行驶。
+
+// 使用测试内容中最大的 OpenDRIVE 文件，所有测试共用同一个本地地图。
+static std::shared_ptr<ctm::InMemoryMap> GetLocalMap(std::string &map_name) {
+  static std::string name;
+  static std::shared_ptr<ctm::InMemoryMap> local_map = []() -> std::shared_ptr<ctm::InMemoryMap> {
+    std::string content;
+    for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+      auto xodr = util::OpenDrive::Load(file);
+      if (xodr.size() > content.size()) {
+        name = file;
+        content = std::move(xodr);
+      }
+    }
+    if (content.empty()) {
+      return nullptr;
+    }
+    auto world_map = carla::MakeShared<const cc::Map>(name, content);
+    auto result = std::make_shared<ctm::InMemoryMap>(world_map);
+    result->SetUp();
+    return result;
+  }();
+  map_name = name;
+  return local_map;
+}
+
+static size_t get_max_concurrency() {
+  return std::max<size_t>(2u, std::thread::hardware_concurrency());
+}
+
+class TrafficManagerBenchmark {
+public:
+
+  struct StageTimings {
+    double localization_ms = 0.0;
+    double collision_ms = 0.0;
+    double motion_plan_ms = 0.0;
+  };
+
+  TrafficManagerBenchmark(
+      std::shared_ptr<ctm::InMemoryMap> local_map,
+      size_t number_of_vehicles,
+      uint32_t number_of_threads)
+    : _local_map(std::move(local_map)),
+      _random_device(42u),
+      _world(cc::detail::EpisodeProxy{}),
+      _localization_stage(_vehicle_id_list, _buffer_map, _simulation_state, _track_traffic,
+          _local_map, _parameters, _marked_for_removal, _localization_frame, _random_device),
+      _collision_stage(_vehicle_id_list, _simulation_state, _buffer_map, _track_traffic,
+          _parameters, _collision_frame, _random_device),
+      _motion_plan_stage(_vehicle_id_list, _simulation_state, _parameters, _buffer_map, _track_traffic,
+          ctm::constants::PID::LONGITUDIAL_PARAM, ctm::constants::PID::LONGITUDIAL_HIGHWAY_PARAM,
+          ctm::constants::PID::LATERAL_PARAM, ctm::constants::PID::LATERAL_HIGHWAY_PARAM,
+          _localization_frame, _collision_frame, _tl_frame, _world, _control_frame,
+          _random_device, _local_map) {
+    _parameters.SetSynchronousMode(true);
+    if (number_of_threads > 1u) {
+      _parameters.SetStageWorkerThreads(number_of_threads);
+      _worker_pool = std::make_unique<ctm::StageWorkerPool>(number_of_threads);
+    }
+    SpawnVehicles(number_of_vehicles);
+  }
+
+  /// 运行一个周期并累加每个阶段的耗时。
+  void Tick(StageTimings &timings) {
+    const size_t size = _vehicle_id_list.size();
+    _localization_frame.assign(size, ctm::LocalizationData{});
+    _collision_frame.assign(size, ctm::CollisionHazardData{});
+    _tl_frame.assign(size, false);
+    _control_frame.clear();
+    _control_frame.resize(size);
+    _simulation_state.RefreshVehicleIndices(_vehicle_id_list);
+
+    carla::StopWatch stop_watch;
+    for (unsigned long index = 0u; index < size; ++index) {
+      _localization_stage.Update(index);
+    }
+    timings.localization_ms += Elapsed(stop_watch);
+
+    stop_watch.Restart();
+    _collision_stage.PrepareCycle();
+    ForEachVehicle([this](const unsigned long index) { _collision_stage.Update(index); });
+    _collision_stage.ApplyCollisionLocks();
+    _collision_stage.ClearCycleCache();
+    timings.collision_ms += Elapsed(stop_watch);
+
+    stop_watch.Restart();
+    _motion_plan_stage.UpdateWorldInfo(_timestamp);
+    if (_worker_pool != nullptr) {
+      _motion_plan_stage.PartitionForParallelUpdate(_parallel_indices, _sequential_indices);
+      _worker_pool->ParallelFor(static_cast<unsigned long>(_parallel_indices.size()), [this](const unsigned long i) {
+        _motion_plan_stage.Update(_parallel_indices[i]);
+      });
+      for (const unsigned long index : _sequential_indices) {
+        _motion_plan_stage.Update(index);
+      }
+    } else {
+      for (unsigned long index = 0u; index < size; ++index) {
+        _motion_plan_stage.Update(index);
+      }
+    }
+    _motion_plan_stage.ApplyActuation();
+    timings.motion_plan_ms += Elapsed(stop_watch);
+
+    MoveVehicles();
+  }
+
+private:
+
+  static constexpr float DeltaSeconds = 0.05f;
+
+  static constexpr float Speed = 8.0f;
+
+  static double Elapsed(const carla::StopWatch &stop_watch) {
+    return 1e-6 * static_cast<double>(stop_watch.GetElapsedTime<std::chrono::nanoseconds>());
+  }
+
+  template <typename FunctorT>
+  void ForEachVehicle(FunctorT &&functor) {
+    const auto size = static_cast<unsigned long>(_vehicle_id_list.size());
+    if (_worker_pool != nullptr) {
+      _worker_pool->ParallelFor(size, std::forward<FunctorT>(functor));
+    } else {
+      for (unsigned long index = 0u; index < size; ++index) {
+        functor(index);
+      }
+    }
+  }
+
+  /// 在稠密拓扑中均匀地选取车辆的初始位置。
+  void SpawnVehicles(size_t number_of_vehicles) {
+    const auto topology = _local_map->GetDenseTopology();
+    ASSERT_FALSE(topology.empty());
+    const size_t step = std::max<size_t>(1u, topology.size() / number_of_vehicles);
+    for (size_t i = 0u; i < number_of_vehicles; ++i) {
+      const auto &waypoint = topology[(i * step) % topology.size()];
+      const auto transform = waypoint->GetTransform();
+      const auto actor_id = static_cast<carla::ActorId>(i + 1u);
+      _simulation_state.AddActor(
+          actor_id,
+          ctm::KinematicState{
+              transform.location,
+              transform.rotation,
+              waypoint->GetForwardVector() * Speed,
+              30.0f,
+              true,
+              false,
+              transform.location},
+          ctm::StaticAttributes{ctm::ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+          ctm::TrafficLightState{carla::rpc::TrafficLightState::Green, false});
+      _vehicle_id_list.push_back(actor_id);
+    }
+  }
+
+  /// 车辆朝路径缓冲中前方的路径点匀速行驶，代替模拟器更新车辆状态。
+  void MoveVehicles() {
+    _timestamp.frame += 1u;
+    _timestamp.elapsed_seconds += DeltaSeconds;
+    _timestamp.delta_seconds = DeltaSeconds;
+    for (const auto actor_id : _vehicle_id_list) {
+      auto it = _buffer_map.find(actor_id);
+      if (it == _buffer_map.end() || it->second.empty()) {
+        continue;
+      }
+      const auto &buffer = it->second;
+      const cg::Location location = _simulation_state.GetLocation(actor_id);
+      const cg::Location target = buffer.at(std::min<size_t>(2u, buffer.size() - 1u))->GetLocation();
+      cg::Vector3D direction = target - location;
+      if (direction.Length() < 1e-3f) {
+        continue;
+      }
+      direction = direction.MakeUnitVector();
+      const cg::Rotation rotation{0.0f, cg::Math::ToDegrees(std::atan2(direction.y, direction.x)), 0.0f};
+      const cg::Location next = location + direction * (Speed * DeltaSeconds);
+      _simulation_state.UpdateKinematicState(actor_id, ctm::KinematicState{
+          next, rotation, direction * Speed, 30.0f, true, false, next});
+    }
+  }
+
+  std::shared_ptr<ctm::InMemoryMap> _local_map;
+
+  std::vector<carla::ActorId> _vehicle_id_list;
+
+  ctm::BufferMap _buffer_map;
+
+  ctm::SimulationState _simulation_state;
+
+  ctm::TrackTraffic _track_traffic;
+
+  ctm::Parameters _parameters;
+
+  std::vector<carla::ActorId> _marked_for_removal;
+
+  ctm::LocalizationFrame _localization_frame;
+
+  ctm::CollisionFrame _collision_frame;
+
+  ctm::TLFrame _tl_frame;
+
+  ctm::ControlFrame _control_frame;
+
+  ctm::RandomGenerator _random_device;
+
+  cc::World _world;
+
+  cc::Timestamp _timestamp;
+
+  ctm::LocalizationStage _localization_stage;
+
+  ctm::CollisionStage _collision_stage;
+
+  ctm::MotionPlanStage _motion_plan_stage;
+
+  std::unique_ptr<ctm::StageWorkerPool> _worker_pool;
+
+  std::vector<unsigned long> _parallel_indices;
+
+  std::vector<unsigned long> _sequential_indices;
+};
+
+// 先运行几个周期建立路径缓冲，再测量每个阶段每个周期的平均耗时。结果打印到
+// 标准输出，并追加到当前目录的 benchmark_traffic_manager.jsonl 中。
+static void benchmark_traffic_manager(size_t number_of_vehicles, uint32_t number_of_threads) {
+  constexpr auto warm_up_ticks = 5u;
+  constexpr auto number_of_ticks = 20u;
+  std::string map_name;
+  auto local_map = GetLocalMap(map_name);
+  if (local_map == nullptr) {
+    carla::log_warning("no OpenDRIVE file found, skipping traffic manager benchmark");
+    return;
+  }
+  TrafficManagerBenchmark benchmark(local_map, number_of_vehicles, number_of_threads);
+  TrafficManagerBenchmark::StageTimings timings;
+  for (auto i = 0u; i < warm_up_ticks; ++i) {
+    benchmark.Tick(timings);
+  }
+  timings = {};
+  for (auto i = 0u; i < number_of_ticks; ++i) {
+    benchmark.Tick(timings);
+  }
+  const double ticks = static_cast<double>(number_of_ticks);
+  const double total_ms = timings.localization_ms + timings.collision_ms + timings.motion_plan_ms;
+  std::ostringstream json;
+  json << "{\"benchmark\":\"traffic_manager\",\"map\":\"" << map_name
+       << "\",\"vehicles\":" << number_of_vehicles
+       << ",\"threads\":" << number_of_threads
+       << ",\"ticks\":" << number_of_ticks
+       << ",\"localization_ms\":" << timings.localization_ms / ticks
+       << ",\"collision_ms\":" << timings.collision_ms / ticks
+       << ",\"motion_plan_ms\":" << timings.motion_plan_ms / ticks
+       << ",\"total_ms\":" << total_ms / ticks
+       << ",\"us_per_vehicle\":" << 1e3 * total_ms / ticks / static_cast<double>(number_of_vehicles)
+       << "}";
+  std::cout << json.str() << std::endl;
+  std::ofstream("benchmark_traffic_manager.jsonl", std::ios_base::app) << json.str() << '\n';
+}
+
+TEST(benchmark_traffic_manager, vehicles_100) {
+  benchmark_traffic_manager(100u, 1u);
+}
+
+TEST(benchmark_traffic_manager, vehicles_1000) {
+  benchmark_traffic_manager(1000u, 1u);
+}
+
+TEST(benchmark_traffic_manager, vehicles_5000) {
+  benchmark_traffic_manager(5000u, 1u);
+}
+
+TEST(benchmark_traffic_manager, vehicles_1000_mt) {
+  benchmark_traffic_manager(1000u, static_cast<uint32_t>(get_max_concurrency()));
+}
+
+TEST(benchmark_traffic_manager, vehicles_5000_mt) {
+  benchmark_traffic_manager(5000u, static_cast<uint32_t>(get_max_concurrency()));
+}
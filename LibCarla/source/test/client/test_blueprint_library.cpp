@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/BlueprintLibrary.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace carla::client;
+
+static carla::rpc::ActorDefinition MakeDefinition(
+    const std::string &id,
+    const std::string &tags,
+    const std::string &color,
+    std::vector<std::string> recommended_generations) {
+  carla::rpc::ActorDefinition definition;
+  definition.id = id;
+  definition.tags = tags;
+  carla::rpc::ActorAttribute base;
+  base.id = "color";
+  base.type = carla::rpc::ActorAttributeType::String;
+  base.value = color;
+  definition.attributes.emplace_back(base);
+  base.id = "generation";
+  base.type = carla::rpc::ActorAttributeType::Int;
+  base.value = recommended_generations.empty() ? "0" : recommended_generations.front();
+  base.recommended_values = std::move(recommended_generations);
+  definition.attributes.emplace_back(base);
+  return definition;
+}
+
+static std::set<std::string> GetIds(const BlueprintLibrary &library) {
+  std::set<std::string> result;
+  for (auto &blueprint : library) {
+    result.insert(blueprint.GetId());
+  }
+  return result;
+}
+
+// 使用索引的过滤结果与逐个调用 MatchTags 相同，重复的模式返回同一个库。
+TEST(client, blueprint_library_filter) {
+  BlueprintLibrary library({
+      MakeDefinition("vehicle.audi.tt", "vehicle,car,audi", "red", {"1", "2"}),
+      MakeDefinition("vehicle.tesla.model3", "vehicle,car,tesla", "blue", {"2"}),
+      MakeDefinition("vehicle.bh.crossbike", "vehicle,bike", "red", {}),
+      MakeDefinition("walker.pedestrian.0001", "walker,pedestrian", "", {"1", "1"}),
+      MakeDefinition("static.prop.car", "static,prop", "", {})});
+
+  const std::vector<std::string> patterns = {
+      "*", "vehicle.*", "vehicle", "car", "*car*", "walker.pedestrian.000?",
+      "vehicle.[at]*", "vehicle.audi.tt", "veh*", "*bike", "none", "", "static.prop.car"};
+  for (auto &pattern : patterns) {
+    std::set<std::string> expected;
+    for (auto &blueprint : library) {
+      if (blueprint.MatchTags(pattern)) {
+        expected.insert(blueprint.GetId());
+      }
+    }
+    auto filtered = library.Filter(pattern);
+    ASSERT_EQ(GetIds(*filtered), expected) << "pattern: " << pattern;
+    ASSERT_EQ(library.Filter(pattern), filtered);
+  }
+
+  ASSERT_EQ(GetIds(*library.FilterByAttribute("color", "red")),
+      (std::set<std::string>{"vehicle.audi.tt", "vehicle.bh.crossbike"}));
+  ASSERT_EQ(GetIds(*library.FilterByAttribute("generation", "2")),
+      (std::set<std::string>{"vehicle.audi.tt", "vehicle.tesla.model3"}));
+  ASSERT_EQ(GetIds(*library.FilterByAttribute("generation", "1")),
+      (std::set<std::string>{"vehicle.audi.tt", "walker.pedestrian.0001"}));
+  ASSERT_EQ(GetIds(*library.FilterByAttribute("generation", "0")),
+      (std::set<std::string>{"vehicle.bh.crossbike", "static.prop.car"}));
+  ASSERT_TRUE(library.FilterByAttribute("missing", "red")->empty());
+
+  // 过滤得到的库有自己的索引
+  auto vehicles = library.Filter("vehicle.*");
+  ASSERT_EQ(GetIds(*vehicles->Filter("car")),
+      (std::set<std::string>{"vehicle.audi.tt", "vehicle.tesla.model3"}));
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/ActorSpatialGrid.h>
+#include <carla/client/detail/CachedActorList.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace carla::client;
+using namespace carla::client::detail;
+
+static carla::rpc::Actor MakeActor(carla::ActorId id, std::string type_id) {
+  carla::rpc::Actor actor;
+  actor.id = id;
+  actor.description.id = std::move(type_id);
+  return actor;
+}
+
+static std::vector<carla::ActorId> GetIds(const std::vector<carla::rpc::Actor> &actors) {
+  std::vector<carla::ActorId> ids;
+  for (auto &&actor : actors) {
+    ids.emplace_back(actor.id);
+  }
+  return ids;
+}
+
+// 按类型 ID 过滤时返回排序后的匹配参与者，删除的参与者不再返回。
+TEST(client, cached_actor_list_type_index) {
+  CachedActorList list;
+  list.Insert(MakeActor(3u, "vehicle.tesla.model3"));
+  list.Insert(MakeActor(1u, "walker.pedestrian.0001"));
+  list.Insert(MakeActor(2u, "vehicle.audi.a2"));
+  list.Insert(MakeActor(4u, "sensor.camera.rgb"));
+
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("vehicle.*")), (std::vector<carla::ActorId>{2u, 3u}));
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("*.rgb")), (std::vector<carla::ActorId>{4u}));
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("vehicle.audi.a2")), (std::vector<carla::ActorId>{2u}));
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("*")), (std::vector<carla::ActorId>{4u, 2u, 3u, 1u}));
+  ASSERT_TRUE(list.GetActorsByTypeId("traffic.*").empty());
+
+  list.Update(std::vector<carla::ActorId>{}, std::vector<carla::ActorId>{3u});
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("vehicle.*")), (std::vector<carla::ActorId>{2u}));
+  ASSERT_TRUE(list.GetActorsById(std::vector<carla::ActorId>{3u}).empty());
+}
+
+// 新出现的参与者记为待获取，获取期间被删除的参与者不会被插入。
+TEST(client, cached_actor_list_pending) {
+  CachedActorList list;
+  list.Insert(MakeActor(1u, "vehicle.audi.a2"));
+  list.Update(std::vector<carla::ActorId>{1u, 2u, 3u}, std::vector<carla::ActorId>{});
+
+  auto pending = list.GetPendingIds();
+  std::sort(pending.begin(), pending.end());
+  ASSERT_EQ(pending, (std::vector<carla::ActorId>{2u, 3u}));
+
+  list.Update(std::vector<carla::ActorId>{}, std::vector<carla::ActorId>{3u});
+  list.ResolvePending(pending, {MakeActor(2u, "vehicle.mini.cooper"), MakeActor(3u, "vehicle.nissan.patrol")});
+  ASSERT_TRUE(list.GetPendingIds().empty());
+  ASSERT_EQ(GetIds(list.GetActorsByTypeId("vehicle.*")), (std::vector<carla::ActorId>{1u, 2u}));
+}
+
+// 网格查询的结果与逐个计算距离的结果一致。
+TEST(client, actor_spatial_grid) {
+  namespace cg = carla::geom;
+  std::vector<ActorSnapshot> snapshots;
+  carla::ActorId id = 0u;
+  for (auto x = -300.0f; x <= 300.0f; x += 25.0f) {
+    for (auto y = -300.0f; y <= 300.0f; y += 25.0f) {
+      ActorSnapshot snapshot;
+      snapshot.id = ++id;
+      snapshot.transform.location = cg::Location{x, y, 0.5f};
+      snapshots.emplace_back(snapshot);
+    }
+  }
+  ActorSpatialGrid grid(snapshots.begin(), snapshots.end());
+
+  const cg::Location center{12.0f, -40.0f, 0.0f};
+  for (auto radius : {0.0f, 10.0f, 60.0f, 170.0f, 10000.0f}) {
+    std::vector<carla::ActorId> expected;
+    for (auto &&snapshot : snapshots) {
+      if (cg::Math::DistanceSquared(snapshot.transform.location, center) <= radius * radius) {
+        expected.emplace_back(snapshot.id);
+      }
+    }
+    auto result = grid.GetActorIdsInRadius(center, radius);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, expected);
+  }
+}
@@ -218,3 +218,52 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+// 测试并行的原地转换与 boost::gil 的颜色转换视图结果相同
+TEST(image, parallel_conversion) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  // 足够大，会分成多个块用多个线程转换
+  constexpr auto width = 1031u;
+  constexpr auto height = 257u;
+  auto img_bgra8 = MakeTestImage<bgra8_pixel_t>(width, height);
+  {
+    uint32_t seed = 12345u;
+    for (auto &p : img_bgra8.view) {
+      for (auto c = 0u; c < 4u; ++c) {
+        seed = seed * 1664525u + 1013904223u;
+        p[c] = static_cast<uint8_t>(seed >> 24u);
+      }
+    }
+  }
+
+  auto check = [&](auto converter) {
+    using converter_type = decltype(converter);
+    auto expected = ImageView::MakeColorConvertedView<decltype(img_bgra8.view), bgra8_pixel_t>(
+        img_bgra8.view,
+        converter_type());
+    auto bgra8 = MakeTestImage<bgra8_pixel_t>(width, height);
+    ImageConverter::CopyPixels(img_bgra8.view, bgra8.view);
+    ImageConverter::ConvertInPlace(bgra8.view, converter_type());
+    auto rgba8 = MakeTestImage<rgba8_pixel_t>(width, height);
+    ImageConverter::CopyPixels(img_bgra8.view, rgba8.view);
+    ImageConverter::ConvertInPlace(rgba8.view, converter_type());
+
+    auto it_expected = expected.begin();
+    auto it_bgra8 = bgra8.view.begin();
+    auto it_rgba8 = rgba8.view.begin();
+    for (auto i = 0u; i < width * height; ++i) {
+      bgra8_pixel_t p_expected = *it_expected;
+      ASSERT_EQ(p_expected, *it_bgra8) << "at " << i;
+      bgra8_pixel_t p_rgba8;
+      color_convert(*it_rgba8, p_rgba8);
+      ASSERT_EQ(p_expected, p_rgba8) << "at " << i;
+      ++it_expected;
+      ++it_bgra8;
+      ++it_rgba8;
+    }
+  };
+  check(ColorConverter::Depth());
+  check(ColorConverter::LogarithmicDepth());
+  check(ColorConverter::CityScapesPalette());
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/data/ConvertedImage.h>
+#include <carla/sensor/data/InstanceBox.h>
+#include <carla/sensor/s11n/ImageConversion.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cmath>
+
+using namespace carla::sensor::s11n;
+
+TEST(image_conversion, from_string) {
+  ImageFormat format;
+  ASSERT_TRUE(ImageConversion::FromString("depth16f", format));
+  ASSERT_EQ(format, ImageFormat::Depth16F);
+  ASSERT_TRUE(ImageConversion::FromString("label8", format));
+  ASSERT_EQ(format, ImageFormat::Label8);
+  ASSERT_TRUE(ImageConversion::FromString("bgra8", format));
+  ASSERT_EQ(format, ImageFormat::BGRA8);
+  ASSERT_FALSE(ImageConversion::FromString("rgb565", format));
+  ASSERT_EQ(ImageConversion::GetBytesPerPixel(ImageFormat::Depth32F), 4u);
+  ASSERT_EQ(ImageConversion::GetBytesPerPixel(ImageFormat::Label8), 1u);
+}
+
+// 感兴趣区域限制在图像之内，缩小后不足一个块的像素被舍弃
+TEST(image_conversion, output_size) {
+  ImageConversion conversion;
+  ASSERT_TRUE(conversion.IsIdentity(800u, 600u));
+  ASSERT_EQ(conversion.GetOutputWidth(800u, 600u), 800u);
+
+  conversion.roi.x = 100u;
+  conversion.roi.y = 500u;
+  conversion.roi.width = 300u;
+  ASSERT_FALSE(conversion.IsIdentity(800u, 600u));
+  const auto region = conversion.GetRegion(800u, 600u);
+  ASSERT_EQ(region.x, 100u);
+  ASSERT_EQ(region.width, 300u);
+  ASSERT_EQ(region.height, 100u);
+
+  conversion.roi.width = 10000u;
+  conversion.downscale = 4u;
+  ASSERT_EQ(conversion.GetOutputWidth(800u, 600u), 175u);
+  ASSERT_EQ(conversion.GetOutputHeight(800u, 600u), 25u);
+
+  conversion.roi = ImageRegion{};
+  conversion.downscale = 1u;
+  conversion.format = ImageFormat::Label8;
+  ASSERT_FALSE(conversion.IsIdentity(800u, 600u));
+}
+
+// 格式与压缩标志保存在不同的字节中，互不影响，也不改变传感器类型
+TEST(image_conversion, header_payload_format) {
+  SensorHeaderSerializer::Header header{};
+  header.sensor_type = 12u;
+  SensorHeaderSerializer::SetPayloadFormat(header, static_cast<uint8_t>(ImageFormat::Depth32F));
+  SensorHeaderSerializer::SetCompression(header, 1u);
+  ASSERT_EQ(SensorHeaderSerializer::GetSensorTypeId(header), 12u);
+  ASSERT_EQ(SensorHeaderSerializer::GetPayloadFormat(header), 2u);
+  SensorHeaderSerializer::SetCompression(header, 0u);
+  ASSERT_EQ(SensorHeaderSerializer::GetPayloadFormat(header), 2u);
+  ASSERT_EQ(SensorHeaderSerializer::GetCompression(header), 0u);
+}
+
+// 实例包围盒不是像素格式，不能通过 output_format 选择
+TEST(image_conversion, instance_boxes) {
+  ImageFormat format;
+  ASSERT_FALSE(ImageConversion::FromString("instance_boxes", format));
+  ASSERT_STREQ(ImageConversion::ToString(ImageFormat::InstanceBoxes), "instance_boxes");
+
+  carla::sensor::data::InstanceBox box;
+  box.x_min = 10u;
+  box.x_max = 19u;
+  box.y_min = 5u;
+  box.y_max = 5u;
+  ASSERT_EQ(box.GetBoxArea(), 10u);
+  ASSERT_EQ(box.occlusion, -1.0f);
+}
+
+TEST(image_conversion, half_to_float) {
+  using carla::sensor::data::ConvertedImage;
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0x0000u), 0.0f);
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0x3C00u), 1.0f);
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0xC000u), -2.0f);
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0x3555u), 0.333251953125f);
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0x63D0u), 1000.0f);
+  ASSERT_EQ(ConvertedImage::HalfToFloat(0x0001u), std::ldexp(1.0f, -24));
+  ASSERT_TRUE(std::isinf(ConvertedImage::HalfToFloat(0x7C00u)));
+  ASSERT_TRUE(std::isnan(ConvertedImage::HalfToFloat(0x7E00u)));
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/BufferPool.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/Image.h>
+#include <carla/sensor/data/LazyData.h>
+#include <carla/sensor/s11n/Compression.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using carla::sensor::Deserializer;
+using carla::sensor::SensorData;
+using carla::sensor::SensorRegistry;
+using carla::sensor::data::Image;
+using carla::sensor::data::LazyData;
+using namespace carla::sensor::s11n;
+
+static constexpr uint32_t WIDTH = 64u;
+static constexpr uint32_t HEIGHT = 48u;
+static constexpr size_t PIXELS_SIZE = WIDTH * HEIGHT * 4u;
+
+static constexpr uint64_t CAMERA_TYPE_ID = SensorRegistry::get<ASceneCaptureCamera *>::index;
+
+static SensorHeaderSerializer::Header MakeHeader(uint64_t frame) {
+  SensorHeaderSerializer::Header header{};
+  header.sensor_type = CAMERA_TYPE_ID;
+  header.frame = frame;
+  header.timestamp = 0.05 * static_cast<double>(frame);
+  header.sensor_transform = carla::geom::Transform{
+      carla::geom::Location{1.0f, -2.0f, 3.5f},
+      carla::geom::Rotation{10.0f, 20.0f, -30.0f}};
+  return header;
+}
+
+// 相机图像的负载：图像头与 BGRA 像素，alpha 为 0（反序列化时会被设为 255）
+static std::vector<unsigned char> MakeImagePayload() {
+  const ImageSerializer::ImageHeader image_header{WIDTH, HEIGHT, 90.0f};
+  std::vector<unsigned char> payload(sizeof(image_header) + PIXELS_SIZE);
+  std::memcpy(payload.data(), &image_header, sizeof(image_header));
+  for (size_t i = 0u; i < PIXELS_SIZE; ++i) {
+    payload[sizeof(image_header) + i] = (i % 4u == 3u) ? 0u : static_cast<unsigned char>((i * 7u) % 251u);
+  }
+  return payload;
+}
+
+static void WriteMessage(
+    carla::Buffer &message,
+    const SensorHeaderSerializer::Header &header,
+    const std::vector<unsigned char> &payload) {
+  message.copy_from(sizeof(header), payload.data(), payload.size());
+  std::memcpy(message.data(), &header, sizeof(header));
+}
+
+static carla::Buffer MakeImageMessage(uint64_t frame) {
+  carla::Buffer message;
+  WriteMessage(message, MakeHeader(frame), MakeImagePayload());
+  return message;
+}
+
+static carla::Buffer MakeCompressedImageMessage(uint64_t frame) {
+  auto header = MakeHeader(frame);
+  SensorHeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::Deflate));
+  const auto payload = MakeImagePayload();
+  auto compressed = Compression::Compress(
+      CompressionType::Deflate, {boost::asio::buffer(payload)}, carla::Buffer{});
+  carla::Buffer message;
+  message.copy_from(sizeof(header), compressed);
+  std::memcpy(message.data(), &header, sizeof(header));
+  return message;
+}
+
+static void ExpectSameHeader(const SensorData &lhs, const SensorData &rhs) {
+  ASSERT_EQ(lhs.GetFrame(), rhs.GetFrame());
+  ASSERT_EQ(lhs.GetTimestamp(), rhs.GetTimestamp());
+  ASSERT_EQ(lhs.GetSensorTransform(), rhs.GetSensorTransform());
+}
+
+static void ExpectSameImage(const Image &lhs, const Image &rhs) {
+  ExpectSameHeader(lhs, rhs);
+  ASSERT_EQ(lhs.GetWidth(), rhs.GetWidth());
+  ASSERT_EQ(lhs.GetHeight(), rhs.GetHeight());
+  ASSERT_EQ(lhs.GetFOVAngle(), rhs.GetFOVAngle());
+  ASSERT_EQ(lhs.size(), rhs.size());
+  ASSERT_EQ(std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(*lhs.data())), 0);
+}
+
+// 反序列化之前从 LazyData 读到的数据头，与反序列化之后以及直接反序列化得到的相同
+static void CheckLazyMatchesEager(carla::Buffer (*make_message)(uint64_t)) {
+  const uint64_t frame = 42u;
+  auto eager = boost::dynamic_pointer_cast<Image>(Deserializer::Deserialize(make_message(frame)));
+  ASSERT_NE(eager, nullptr);
+  auto message = make_message(frame);
+  const auto message_size = message.size();
+  auto lazy = boost::dynamic_pointer_cast<LazyData>(Deserializer::DeserializeLazy(std::move(message)));
+  ASSERT_NE(lazy, nullptr);
+
+  ASSERT_FALSE(lazy->IsMaterialized());
+  ASSERT_EQ(lazy->GetSensorTypeId(), CAMERA_TYPE_ID);
+  ASSERT_EQ(lazy->size(), message_size - SensorHeaderSerializer::header_offset);
+  ExpectSameHeader(*lazy, *eager);
+  const auto frame_before = lazy->GetFrame();
+  const auto timestamp_before = lazy->GetTimestamp();
+  const auto transform_before = lazy->GetSensorTransform();
+
+  auto image = boost::dynamic_pointer_cast<Image>(lazy->Get());
+  ASSERT_NE(image, nullptr);
+  ASSERT_TRUE(lazy->IsMaterialized());
+  ExpectSameImage(*image, *eager);
+  ASSERT_EQ(lazy->GetFrame(), frame_before);
+  ASSERT_EQ(lazy->GetTimestamp(), timestamp_before);
+  ASSERT_EQ(lazy->GetSensorTransform(), transform_before);
+  ASSERT_EQ(image->GetFrame(), frame_before);
+  // 之后的调用返回同一个对象
+  ASSERT_EQ(lazy->Get(), image);
+}
+
+TEST(lazy_sensor_data, same_values_before_and_after_get) {
+  CheckLazyMatchesEager(&MakeImageMessage);
+}
+
+TEST(lazy_sensor_data, same_values_before_and_after_get_compressed) {
+  CheckLazyMatchesEager(&MakeCompressedImageMessage);
+}
+
+// 缓冲区来自池，只有在最后一个引用它的对象释放之后才放回池中
+TEST(lazy_sensor_data, buffer_outlives_lazy_data) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  const auto header = MakeHeader(7u);
+  const auto payload = MakeImagePayload();
+  {
+    auto message = pool->Pop(sizeof(header) + payload.size());
+    WriteMessage(message, header, payload);
+    auto lazy = Deserializer::DeserializeLazy(std::move(message));
+    ASSERT_EQ(pool->GetStatistics().idle_bytes, 0u);
+  }
+  // 没有调用 Get 的 LazyData 释放时缓冲区回到池中
+  ASSERT_GT(pool->GetStatistics().idle_bytes, 0u);
+
+  // 取回刚放回池中的缓冲区
+  auto message = pool->Pop();
+  WriteMessage(message, header, payload);
+  const auto *pixels = message.data() + sizeof(header) + sizeof(ImageSerializer::ImageHeader);
+  ASSERT_EQ(pool->GetStatistics().idle_bytes, 0u);
+  auto lazy = boost::dynamic_pointer_cast<LazyData>(Deserializer::DeserializeLazy(std::move(message)));
+  ASSERT_NE(lazy, nullptr);
+  auto image = boost::dynamic_pointer_cast<Image>(lazy->Get());
+  ASSERT_NE(image, nullptr);
+  lazy.reset();
+
+  // 图像直接引用原来的缓冲区，LazyData 释放之后缓冲区仍然有效
+  ASSERT_EQ(reinterpret_cast<const unsigned char *>(image->data()), pixels);
+  ASSERT_EQ(pool->GetStatistics().idle_bytes, 0u);
+  ASSERT_EQ(image->GetFrame(), 7u);
+  ASSERT_EQ(image->GetWidth(), WIDTH);
+  for (size_t i = 0u; i < image->size(); ++i) {
+    const auto &pixel = (*image)[i];
+    ASSERT_EQ(pixel.b, payload[sizeof(ImageSerializer::ImageHeader) + 4u * i]);
+    ASSERT_EQ(pixel.a, 255u);
+  }
+  image.reset();
+  ASSERT_GT(pool->GetStatistics().idle_bytes, 0u);
+}
@@ -14,13 +14,18 @@
 #include <carla/geom/Math.h>/// @brief 包含几何数学运算相关的函数和类。
 #include <carla/opendrive/OpenDriveParser.h>/// @brief 包含OpenDrive解析器类，用于解析OpenDrive格式的地图文件。
 #include <carla/road/MapBuilder.h>/// @brief 包含CARLA的路网构建器类，用于构建路网。
+#include <carla/road/SignalType.h>
+#include <carla/road/element/Geometry.h>
 #include <carla/road/element/RoadInfoElevation.h>/// @brief 包含道路高程信息相关的类。
 #include <carla/road/element/RoadInfoGeometry.h>/// @brief 包含道路几何信息相关的类。
 #include <carla/road/element/RoadInfoMarkRecord.h>/// @brief 包含道路标记记录信息相关的类
+#include <carla/road/element/RoadInfoSignal.h>
 #include <carla/road/element/RoadInfoVisitor.h>/// @brief 包含道路信息访问者模式的基类，用于遍历路网元素。
 
+#include <odrSpiral/odrSpiral.h>
 #include <pugixml/pugixml.hpp>/// @brief 包含pugixml库的头文件，用于XML解析和生成。
 
+#include <sstream>
 #include <fstream>/// @brief 包含C++标准库的文件流类，用于文件读写。
 #include <string>/// @brief 包含C++标准库的字符串类。
 
@@ -457,3 +462,256 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, load_serialized_rtree) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto generated = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(generated.has_value());
+    ASSERT_FALSE(generated->IsRtreeLoaded());
+    const auto rtree_data = generated->SerializeRtree();
+    auto loaded = OpenDriveParser::Load(opendrive, rtree_data.data(), rtree_data.size());
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_TRUE(loaded->IsRtreeLoaded());
+    for (auto i = 0u; i < 1'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      auto expected = generated->GetClosestWaypointOnRoad(location);
+      auto actual = loaded->GetClosestWaypointOnRoad(location);
+      ASSERT_EQ(expected.has_value(), actual.has_value());
+      if (expected.has_value()) {
+        ASSERT_EQ(expected->road_id, actual->road_id);
+        ASSERT_EQ(expected->section_id, actual->section_id);
+        ASSERT_EQ(expected->lane_id, actual->lane_id);
+        ASSERT_NEAR(expected->s, actual->s, 1e-6);
+      }
+    }
+    // 截断的数据被拒绝，R树重新生成
+    auto truncated = OpenDriveParser::Load(opendrive, rtree_data.data(), rtree_data.size() - 1u);
+    ASSERT_TRUE(truncated.has_value());
+    ASSERT_FALSE(truncated->IsRtreeLoaded());
+  }
+}
+
+TEST(road, get_waypoints_batched) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 2'000u; ++i) {
+      locations.push_back(Random::Location(-500.0f, 500.0f));
+    }
+    const auto closest = map.GetClosestWaypointsOnRoad(locations);
+    const auto exact = map.GetWaypoints(locations);
+    ASSERT_EQ(closest.size(), locations.size());
+    ASSERT_EQ(exact.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      const auto expected_closest = map.GetClosestWaypointOnRoad(locations[i]);
+      ASSERT_EQ(closest[i].has_value(), expected_closest.has_value());
+      if (expected_closest.has_value()) {
+        ASSERT_EQ(closest[i]->road_id, expected_closest->road_id);
+        ASSERT_EQ(closest[i]->lane_id, expected_closest->lane_id);
+        ASSERT_EQ(closest[i]->s, expected_closest->s);
+      }
+      const auto expected_exact = map.GetWaypoint(locations[i]);
+      ASSERT_EQ(exact[i].has_value(), expected_exact.has_value());
+    }
+  }
+}
+
+// 在车道内结束的搜索与直接遍历道路上的信号结果相同，其他结果都在搜索距离内
+// 且对所在车道有效。
+TEST(road, get_signals_in_distance) {
+  constexpr double distance = 30.0;
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    for (const auto &waypoint : map.GenerateWaypoints(10.0)) {
+      const auto found = map.GetSignalsInDistance(waypoint, distance);
+      for (const auto &data : found) {
+        ASSERT_GE(data.accumulated_s, -1e-6);
+        ASSERT_LE(data.accumulated_s, distance + 1e-6);
+        bool is_valid = false;
+        for (const auto &validity : data.signal->GetValidities()) {
+          is_valid |= data.waypoint.lane_id >= validity._from_lane &&
+                      data.waypoint.lane_id <= validity._to_lane;
+        }
+        ASSERT_TRUE(is_valid);
+      }
+
+      const auto &lane = map.GetLane(waypoint);
+      const double relative_s = waypoint.s - lane.GetDistance();
+      const double remaining = waypoint.lane_id <= 0 ? lane.GetLength() - relative_s : relative_s;
+      if (distance <= remaining) {
+        const double end_s = waypoint.lane_id <= 0 ? waypoint.s + distance : waypoint.s - distance;
+        std::vector<const RoadInfoSignal *> expected;
+        for (auto *signal : map.GetMap().GetRoad(waypoint.road_id).GetInfosInRange<RoadInfoSignal>(waypoint.s, end_s)) {
+          for (const auto &validity : signal->GetValidities()) {
+            if (waypoint.lane_id >= validity._from_lane && waypoint.lane_id <= validity._to_lane) {
+              expected.emplace_back(signal);
+              break;
+            }
+          }
+        }
+        ASSERT_EQ(found.size(), expected.size());
+        for (auto i = 0u; i < expected.size(); ++i) {
+          ASSERT_EQ(found[i].signal, expected[i]);
+        }
+      }
+    }
+  }
+}
+
+// 控制通行的信号是车道上信号的子集，下一个控制信号与沿行驶方向线性查找的结果相同。
+TEST(road, get_next_controlling_signal) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    for (const auto &waypoint : map.GenerateWaypoints(10.0)) {
+      const auto &signals = map.GetLaneControllingSignals(waypoint.road_id, waypoint.lane_id);
+      const RoadInfoSignal *expected = nullptr;
+      for (auto *signal : signals) {
+        const auto type = signal->GetSignal()->GetType();
+        ASSERT_TRUE(carla::road::SignalType::IsTrafficLight(type) ||
+                    type == carla::road::SignalType::StopSign() ||
+                    type == carla::road::SignalType::YieldSign());
+        if (waypoint.lane_id <= 0) {
+          if (expected == nullptr && signal->GetDistance() >= waypoint.s) {
+            expected = signal;
+          }
+        } else if (signal->GetDistance() <= waypoint.s) {
+          expected = signal;
+        }
+      }
+      ASSERT_EQ(map.GetNextControllingSignal(waypoint), expected);
+    }
+  }
+}
+
+TEST(road, incremental_map_update) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    const std::string xodr = util::OpenDrive::Load(file);
+    auto m = OpenDriveParser::Load(xodr);
+    ASSERT_TRUE(m.has_value());
+
+    // 内容不变时没有变化的道路，路径点的查询结果相同
+    auto same = OpenDriveParser::LoadUpdate(xodr, *m);
+    ASSERT_TRUE(same.has_value());
+    ASSERT_TRUE(same->GetUpdate().IsEmpty());
+    for (const auto &waypoint : m->GenerateWaypoints(10.0)) {
+      const auto location = m->ComputeTransform(waypoint).location;
+      auto expected = m->GetClosestWaypointOnRoad(location);
+      auto found = same->GetClosestWaypointOnRoad(location);
+      ASSERT_TRUE(expected.has_value());
+      ASSERT_TRUE(found.has_value());
+      ASSERT_EQ(*found, *expected);
+    }
+
+    // 修改一条道路的定义，只有这条道路被替换
+    pugi::xml_document document;
+    ASSERT_TRUE(document.load_string(xodr.c_str()));
+    pugi::xml_node road = document.child("OpenDRIVE").child("road");
+    if (!road) {
+      continue;
+    }
+    const auto road_id = static_cast<carla::road::RoadId>(road.attribute("id").as_uint());
+    if (!road.attribute("name")) {
+      road.append_attribute("name");
+    }
+    road.attribute("name").set_value("incremental_map_update");
+    std::ostringstream stream;
+    document.save(stream);
+
+    auto updated = OpenDriveParser::LoadUpdate(stream.str(), *m);
+    ASSERT_TRUE(updated.has_value());
+    const auto &update = updated->GetUpdate();
+    ASSERT_TRUE(update.added_roads.empty());
+    ASSERT_TRUE(update.removed_roads.empty());
+    ASSERT_EQ(update.replaced_roads, std::vector<carla::road::RoadId>{road_id});
+    for (const auto &waypoint : m->GenerateWaypoints(10.0)) {
+      const auto location = m->ComputeTransform(waypoint).location;
+      auto expected = m->GetClosestWaypointOnRoad(location);
+      auto found = updated->GetClosestWaypointOnRoad(location);
+      ASSERT_TRUE(found.has_value());
+      // 重叠的车道上可能有距离相同的多个结果
+      ASSERT_NEAR(
+          carla::geom::Math::Distance(updated->ComputeTransform(*found).location, location),
+          carla::geom::Math::Distance(m->ComputeTransform(*expected).location, location),
+          1e-3);
+    }
+  }
+}
+
+TEST(road, geometry_arc_length_tables) {
+  // 螺旋线的查找表与直接调用 odrSpiral 的结果相同（误差在 1 毫米以内）
+  const double length = 60.0;
+  const double heading = 0.3;
+  const double curve_start = 0.0;
+  const double curve_end = 0.08;
+  GeometrySpiral spiral(0.0, length, heading, Location(10.0f, -5.0f, 0.0f), curve_start, curve_end);
+  const double curve_dot = (curve_end - curve_start) / length;
+  const double s_o = curve_start / curve_dot;
+  double x_o, y_o, t_o;
+  odrSpiral(s_o, curve_dot, &x_o, &y_o, &t_o);
+  for (double dist = 0.0; dist <= length; dist += 0.37) {
+    double x, y, t;
+    odrSpiral(s_o + dist, curve_dot, &x, &y, &t);
+    const double angle = heading - t_o;
+    const double expected_x = 10.0 + (x - x_o) * std::cos(angle) - (y - y_o) * std::sin(angle);
+    const double expected_y = -5.0 + (y - y_o) * std::cos(angle) + (x - x_o) * std::sin(angle);
+    const auto point = spiral.PosFromDist(dist);
+    ASSERT_NEAR(point.location.x, expected_x, 1e-3);
+    ASSERT_NEAR(point.location.y, expected_y, 1e-3);
+    ASSERT_NEAR(point.tangent, heading + t - t_o, 1e-6);
+    ASSERT_EQ(point, spiral.PosFromDist(dist));
+  }
+
+  // 以弧长为参数的直线
+  GeometryParamPoly3 line(0.0, 25.0, 0.0, Location(0.0f, 0.0f, 0.0f), 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, true);
+  for (double dist = 0.0; dist <= 25.0; dist += 0.29) {
+    const auto point = line.PosFromDist(dist);
+    ASSERT_NEAR(point.location.x, dist, 1e-4);
+    ASSERT_NEAR(point.location.y, 0.0, 1e-6);
+    ASSERT_NEAR(point.tangent, 0.0, 1e-9);
+  }
+}
+
+TEST(road, sample_lane) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    constexpr double distance = 2.0;
+    constexpr size_t count = 200u;
+    for (const auto &start : map.GenerateWaypointsOnRoadEntries()) {
+      for (const bool forward : {true, false}) {
+        const auto path = map.SampleLane(start, distance, count, forward);
+        ASSERT_LE(path.size(), count);
+        auto expected = start;
+        for (const auto &waypoint : path) {
+          const auto next = forward ?
+              map.GetNext(expected, distance) :
+              map.GetPrevious(expected, distance);
+          ASSERT_FALSE(next.empty());
+          expected = next.front();
+          ASSERT_EQ(waypoint.road_id, expected.road_id);
+          ASSERT_EQ(waypoint.section_id, expected.section_id);
+          ASSERT_EQ(waypoint.lane_id, expected.lane_id);
+          ASSERT_EQ(waypoint.s, expected.s);
+        }
+        const auto until_end = map.SampleLane(start, distance, count, forward, true);
+        for (const auto &waypoint : until_end) {
+          ASSERT_EQ(waypoint.road_id, start.road_id);
+        }
+      }
+    }
+  }
+}
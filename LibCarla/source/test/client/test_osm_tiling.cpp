@@ -0,0 +1,230 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/opendrive/OpenDriveStitcher.h>
+#include <carla/opendrive/OsmStreamReader.h>
+#include <carla/opendrive/OsmTileSplitter.h>
+
+#include <pugixml/pugixml.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace carla::opendrive;
+
+static std::string WriteOsm(const std::string &name, const std::string &content) {
+  const std::string path = testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+  return path;
+}
+
+// 约 0.02 x 0.02 度，划分为 2 x 2 个图块。way 1 自西向东穿过两个图块，与 way 2
+// 相交于节点 3
+static const char *OSM_MAP = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!-- 测试地图 -->
+<osm version="0.6" generator="test">
+  <bounds minlat="0.0" minlon="0.0" maxlat="0.02" maxlon="0.02"/>
+  <node id="1" lat="0.005" lon="0.001"/>
+  <node id="2" lat="0.005" lon="0.009"/>
+  <node id="3" lat="0.005" lon="0.005">
+    <tag k="highway" v="traffic_signals"/>
+  </node>
+  <node id="4" lat="0.005" lon="0.011"/>
+  <node id="5" lat="0.005" lon="0.019"/>
+  <node id="6" lat="0.001" lon="0.005"/>
+  <node id="7" lat="0.009" lon="0.005"/>
+  <node id="8" lat="0.015" lon="0.015"/>
+  <way id="1">
+    <nd ref="1"/><nd ref="3"/><nd ref="2"/><nd ref="4"/><nd ref="5"/>
+    <tag k="highway" v="primary"/>
+    <tag k="name" v="A &amp; B"/>
+  </way>
+  <way id="2">
+    <nd ref="6"/><nd ref="3"/><nd ref="7"/>
+    <tag k="highway" v="residential"/>
+  </way>
+  <way id="3">
+    <nd ref="4"/><nd ref="5"/><nd ref="8"/><nd ref="4"/>
+    <tag k="building" v="yes"/>
+  </way>
+  <relation id="1">
+    <member type="way" ref="1" role="from"/>
+    <member type="node" ref="3" role="via"/>
+    <member type="way" ref="2" role="to"/>
+    <tag k="type" v="restriction"/>
+    <tag k="restriction" v="no_left_turn"/>
+  </relation>
+</osm>
+)";
+
+TEST(osm_tiling, stream_reader) {
+  const auto path = WriteOsm("carla_test_osm_reader.osm", OSM_MAP);
+  OsmStreamReader reader(path);
+  std::map<std::string, int> count;
+  pugi::xml_document element;
+  while (reader.Next(element)) {
+    ++count[element.first_child().name()];
+  }
+  ASSERT_EQ(count["bounds"], 1);
+  ASSERT_EQ(count["node"], 8);
+  ASSERT_EQ(count["way"], 3);
+  ASSERT_EQ(count["relation"], 1);
+  ASSERT_EQ(count.size(), 4u);
+  std::remove(path.c_str());
+  ASSERT_THROW(OsmStreamReader("carla_test_missing.osm"), std::runtime_error);
+}
+
+TEST(osm_tiling, split) {
+  const auto path = WriteOsm("carla_test_osm_split.osm", OSM_MAP);
+  const auto tiles = OsmTileSplitter::Split(path, testing::TempDir(), 0.01 * 111320.0);
+  ASSERT_EQ(tiles.size(), 2u);
+  ASSERT_EQ(tiles[0u].row, 0u);
+  ASSERT_EQ(tiles[0u].column, 0u);
+  ASSERT_EQ(tiles[0u].ways, 2u);
+  ASSERT_EQ(tiles[1u].row, 0u);
+  ASSERT_EQ(tiles[1u].column, 1u);
+  ASSERT_EQ(tiles[1u].ways, 1u);
+
+  pugi::xml_document west, east;
+  ASSERT_TRUE(west.load_file(tiles[0u].path.c_str()));
+  ASSERT_TRUE(east.load_file(tiles[1u].path.c_str()));
+  auto find_way = [](const pugi::xml_document &doc, const char *id) {
+    return doc.child("osm").find_child_by_attribute("way", "id", id);
+  };
+
+  // way 1 在节点 2 和节点 4 的中点切断，切点是两侧道路的端点
+  const auto west_way = find_way(west, "1");
+  const auto east_way = find_way(east, "1");
+  ASSERT_TRUE(west_way);
+  ASSERT_TRUE(east_way);
+  const std::string border = west_way.last_child().previous_sibling().previous_sibling().attribute("ref").value();
+  ASSERT_EQ(border, east_way.child("nd").attribute("ref").value());
+  ASSERT_EQ(east_way.find_child_by_attribute("tag", "k", "name").attribute("v").value(), std::string("A & B"));
+  for (const auto *doc : {&west, &east}) {
+    const auto node = doc->child("osm").find_child_by_attribute("node", "id", border.c_str());
+    ASSERT_TRUE(node);
+    ASSERT_NEAR(node.attribute("lat").as_double(), 0.005, 1e-9);
+    ASSERT_NEAR(node.attribute("lon").as_double(), 0.010, 1e-9);
+  }
+
+  // 交叉口及其节点、转向限制只位于一个图块中，其他 way 被丢弃
+  ASSERT_TRUE(find_way(west, "2"));
+  ASSERT_FALSE(find_way(east, "3"));
+  const auto signal = west.child("osm").find_child_by_attribute("node", "id", "3");
+  ASSERT_EQ(signal.child("tag").attribute("v").value(), std::string("traffic_signals"));
+  ASSERT_FALSE(east.child("osm").find_child_by_attribute("node", "id", "3"));
+  ASSERT_FALSE(east.child("osm").find_child_by_attribute("node", "id", "8"));
+  ASSERT_TRUE(west.child("osm").child("relation"));
+  ASSERT_FALSE(east.child("osm").child("relation"));
+
+  for (const auto &tile : tiles) {
+    std::remove(tile.path.c_str());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(osm_tiling, split_requires_nodes_before_ways) {
+  const auto path = WriteOsm("carla_test_osm_order.osm", R"(<osm>
+    <node id="1" lat="0.0" lon="0.0"/>
+    <node id="2" lat="0.0" lon="0.001"/>
+    <way id="1"><nd ref="1"/><nd ref="2"/><tag k="highway" v="primary"/></way>
+    <node id="3" lat="0.0" lon="0.002"/>
+  </osm>)");
+  ASSERT_THROW(OsmTileSplitter::Split(path, testing::TempDir(), 1000.0), std::runtime_error);
+  ASSERT_THROW(OsmTileSplitter::Split(path, testing::TempDir(), 0.0), std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+static std::string MakeRoad(const char *id, double x, double y, double hdg, const char *extra = "") {
+  char buffer[1024];
+  std::snprintf(buffer, sizeof(buffer), R"(
+  <road name="" length="10" id="%s" junction="-1">%s
+    <planView>
+      <geometry s="0" x="%f" y="%f" hdg="%f" length="10"><line/></geometry>
+    </planView>
+    <lanes>
+      <laneSection s="0">
+        <left><lane id="1" type="driving" level="false"/></left>
+        <center><lane id="0" type="none" level="false"/></center>
+        <right><lane id="-1" type="driving" level="false"/></right>
+      </laneSection>
+    </lanes>
+    <signals><signal s="5" t="0" id="%s" name="" dynamic="no" orientation="+"/></signals>
+  </road>)", id, extra, x, y, hdg, id);
+  return buffer;
+}
+
+static std::string MakeTile(const std::string &roads, double west, double east) {
+  char header[256];
+  std::snprintf(header, sizeof(header),
+      R"(<?xml version="1.0"?><OpenDRIVE><header revMajor="1" revMinor="4" north="10" south="-10" east="%f" west="%f"/>)",
+      east, west);
+  return header + roads + "</OpenDRIVE>";
+}
+
+TEST(osm_tiling, stitch) {
+  // 图块 A 的道路 1 的终点与图块 B 的道路 1 的起点相接；图块 B 的道路 2 与
+  // 图块 A 的道路 2 相向相接；道路 3 虽然距离很近但方向相同，不连接
+  const auto tile_a = MakeTile(
+      MakeRoad("1", 0.0, 0.0, 0.0) + MakeRoad("2", 0.0, 50.0, 0.0) + MakeRoad("3", 0.0, 100.0, 0.0),
+      0.0, 10.0);
+  const auto tile_b = MakeTile(
+      MakeRoad("1", 10.2, 0.0, 0.0) + MakeRoad("2", 20.0, 50.0, 3.14159265) +
+      MakeRoad("3", 10.0, 100.0, 3.14159265 * 0.5),
+      10.0, 20.0);
+
+  pugi::xml_document doc;
+  ASSERT_TRUE(doc.load_string(OpenDriveStitcher::Stitch({tile_a, tile_b}, 0.5, true).c_str()));
+  const auto root = doc.child("OpenDRIVE");
+
+  std::vector<pugi::xml_node> roads;
+  std::map<std::string, int> ids;
+  for (auto road : root.children("road")) {
+    roads.push_back(road);
+    ++ids[road.attribute("id").value()];
+    ++ids[road.child("signals").child("signal").attribute("id").value()];
+  }
+  ASSERT_EQ(roads.size(), 6u);
+  ASSERT_EQ(ids.size(), 6u);
+
+  const auto a1 = roads[0u], a2 = roads[1u], a3 = roads[2u];
+  const auto b1 = roads[3u], b2 = roads[4u], b3 = roads[5u];
+
+  auto successor = a1.child("link").child("successor");
+  ASSERT_EQ(successor.attribute("elementId").value(), std::string(b1.attribute("id").value()));
+  ASSERT_EQ(successor.attribute("contactPoint").value(), std::string("start"));
+  auto predecessor = b1.child("link").child("predecessor");
+  ASSERT_EQ(predecessor.attribute("elementId").value(), std::string(a1.attribute("id").value()));
+  ASSERT_EQ(predecessor.attribute("contactPoint").value(), std::string("end"));
+  auto lane = a1.child("lanes").child("laneSection").child("right").child("lane");
+  ASSERT_EQ(lane.child("link").child("successor").attribute("id").as_int(), -1);
+  ASSERT_FALSE(a1.child("link").child("predecessor"));
+
+  successor = a2.child("link").child("successor");
+  ASSERT_EQ(successor.attribute("elementId").value(), std::string(b2.attribute("id").value()));
+  ASSERT_EQ(successor.attribute("contactPoint").value(), std::string("end"));
+  lane = a2.child("lanes").child("laneSection").child("left").child("lane");
+  ASSERT_EQ(lane.child("link").child("successor").attribute("id").as_int(), -1);
+
+  ASSERT_FALSE(a3.child("link"));
+  ASSERT_FALSE(b3.child("link"));
+
+  // 平移到路网中心，平移量记录在 offset 中
+  const auto header = root.child("header");
+  ASSERT_NEAR(header.child("offset").attribute("x").as_double(), 10.1, 1e-6);
+  ASSERT_NEAR(header.child("offset").attribute("y").as_double(), 55.0, 1e-6);
+  ASSERT_NEAR(header.attribute("east").as_double(), 9.9, 1e-6);
+  ASSERT_NEAR(header.attribute("west").as_double(), -10.1, 1e-6);
+  ASSERT_NEAR(a1.child("planView").child("geometry").attribute("x").as_double(), -10.1, 1e-6);
+
+  ASSERT_THROW(OpenDriveStitcher::Stitch({tile_a, "<OpenDRIVE"}), std::invalid_argument);
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "OpenDriveFixtures.h"
+
+#include <carla/ParallelFor.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/Map.h>
+
+#include <boost/optional.hpp>
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using carla::opendrive::OpenDriveParser;
+using carla::road::Lane;
+using carla::road::Map;
+using carla::road::element::Waypoint;
+
+// 地图构建（MapBuilder）与路径点、拓扑的生成在 ParallelFor 中按道路、车道和
+// 交叉口并行执行。这里在 ScopedSerialParallelFor 下得到串行的结果，检查并行的
+// 结果与它完全相同，顺序也相同。
+
+static constexpr double WAYPOINT_DISTANCE = 2.0;
+
+// 合成地图的道路足够多，ParallelFor 会真正使用多个线程
+static constexpr size_t FIXTURE_ROWS = 8u;
+static constexpr size_t FIXTURE_ROADS_PER_ROW = 40u;
+
+struct MapOutput {
+  boost::optional<Map> map;
+  std::vector<Waypoint> waypoints;
+  std::vector<std::pair<Waypoint, Waypoint>> topology;
+};
+
+static MapOutput BuildMap(const std::string &xodr) {
+  MapOutput output;
+  output.map = OpenDriveParser::Load(xodr);
+  if (output.map.has_value()) {
+    output.waypoints = output.map->GenerateWaypoints(WAYPOINT_DISTANCE);
+    output.topology = output.map->GenerateTopology();
+  }
+  return output;
+}
+
+static MapOutput BuildMapSerially(const std::string &xodr) {
+  carla::ScopedSerialParallelFor serial;
+  return BuildMap(xodr);
+}
+
+static auto Key(const Waypoint &waypoint) {
+  return std::make_tuple(waypoint.road_id, waypoint.section_id, waypoint.lane_id, waypoint.s);
+}
+
+static auto Key(const Lane *lane) {
+  return std::make_tuple(lane->GetRoad()->GetId(), lane->GetDistance(), lane->GetId());
+}
+
+template <typename T, typename F>
+static auto Keys(const std::vector<T> &items, F &&key) {
+  std::vector<decltype(key(items.front()))> result;
+  result.reserve(items.size());
+  for (const auto &item : items) {
+    result.push_back(key(item));
+  }
+  return result;
+}
+
+// 比较两张地图中由 MapBuilder 并行建立的连接：相邻道路、车道的前后连接，
+// 以及交叉口的包围盒与冲突道路。
+static void CompareLinks(Map &serial, Map &parallel) {
+  const auto &serial_roads = serial.GetMap().GetRoads();
+  const auto &parallel_roads = parallel.GetMap().GetRoads();
+  ASSERT_EQ(serial_roads.size(), parallel_roads.size());
+  auto road_id = [](const carla::road::Road *road) { return road->GetId(); };
+  auto lane_key = [](const Lane *lane) { return Key(lane); };
+  for (const auto &item : serial_roads) {
+    const auto &serial_road = item.second;
+    const auto &parallel_road = parallel_roads.at(item.first);
+    ASSERT_EQ(Keys(serial_road.GetNexts(), road_id), Keys(parallel_road.GetNexts(), road_id));
+    ASSERT_EQ(Keys(serial_road.GetPrevs(), road_id), Keys(parallel_road.GetPrevs(), road_id));
+
+    auto serial_sections = serial_road.GetLaneSections();
+    auto parallel_sections = parallel_road.GetLaneSections();
+    auto parallel_section = parallel_sections.begin();
+    for (const auto &serial_section : serial_sections) {
+      ASSERT_NE(parallel_section, parallel_sections.end());
+      const auto &serial_lanes = serial_section.GetLanes();
+      const auto &parallel_lanes = parallel_section->GetLanes();
+      ASSERT_EQ(serial_lanes.size(), parallel_lanes.size());
+      for (const auto &lane : serial_lanes) {
+        const Lane &other = parallel_lanes.at(lane.first);
+        ASSERT_EQ(Keys(lane.second.GetNextLanes(), lane_key), Keys(other.GetNextLanes(), lane_key));
+        ASSERT_EQ(Keys(lane.second.GetPreviousLanes(), lane_key), Keys(other.GetPreviousLanes(), lane_key));
+      }
+      ++parallel_section;
+    }
+    ASSERT_EQ(parallel_section, parallel_sections.end());
+  }
+
+  const auto &serial_junctions = serial.GetMap().GetJunctions();
+  const auto &parallel_junctions = parallel.GetMap().GetJunctions();
+  ASSERT_EQ(serial_junctions.size(), parallel_junctions.size());
+  for (const auto &item : serial_junctions) {
+    const auto &junction = item.second;
+    const auto &other = parallel_junctions.at(item.first);
+    const auto box = junction.GetBoundingBox();
+    const auto other_box = other.GetBoundingBox();
+    ASSERT_EQ(box.location, other_box.location);
+    ASSERT_EQ(box.extent, other_box.extent);
+    for (const auto &road : serial_roads) {
+      ASSERT_EQ(junction.RoadHasConflicts(road.first), other.RoadHasConflicts(road.first));
+      if (junction.RoadHasConflicts(road.first)) {
+        ASSERT_EQ(junction.GetConflictsOfRoad(road.first), other.GetConflictsOfRoad(road.first));
+      }
+    }
+  }
+}
+
+static void CompareOutputs(const std::string &xodr) {
+  auto serial = BuildMapSerially(xodr);
+  auto parallel = BuildMap(xodr);
+  ASSERT_TRUE(serial.map.has_value());
+  ASSERT_TRUE(parallel.map.has_value());
+  CompareLinks(*serial.map, *parallel.map);
+
+  ASSERT_FALSE(serial.waypoints.empty());
+  ASSERT_EQ(serial.waypoints.size(), parallel.waypoints.size());
+  for (size_t i = 0u; i < serial.waypoints.size(); ++i) {
+    ASSERT_EQ(Key(serial.waypoints[i]), Key(parallel.waypoints[i])) << "waypoint " << i;
+  }
+  ASSERT_EQ(serial.topology.size(), parallel.topology.size());
+  for (size_t i = 0u; i < serial.topology.size(); ++i) {
+    ASSERT_EQ(Key(serial.topology[i].first), Key(parallel.topology[i].first)) << "segment " << i;
+    ASSERT_EQ(Key(serial.topology[i].second), Key(parallel.topology[i].second)) << "segment " << i;
+  }
+}
+
+TEST(road, parallel_map_building_matches_serial) {
+  CompareOutputs(util::fixtures::GenerateRoadRows(FIXTURE_ROWS, FIXTURE_ROADS_PER_ROW));
+  CompareOutputs(util::fixtures::TWO_ROADS_XODR);
+}
+
+TEST(road, parallel_map_building_matches_serial_on_test_content) {
+  // 测试内容中的地图包含交叉口，覆盖交叉口包围盒与冲突道路的并行计算
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Checking parallel map building:", file);
+    CompareOutputs(util::OpenDrive::Load(file));
+  }
+}
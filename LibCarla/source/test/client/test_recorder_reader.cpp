@@ -0,0 +1,411 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/recorder/RecorderReader.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace carla::recorder;
+
+namespace {
+
+  // 按服务器端 CarlaRecorder 的格式生成记录文件
+  class RecordingBuilder {
+  public:
+
+    RecordingBuilder() {
+      Write<uint16_t>(1u);
+      WriteString("CARLA_RECORDER");
+      Write<int64_t>(1234);
+      WriteString("Town01");
+    }
+
+    void BeginFrame(uint64_t id, double elapsed) {
+      if (_last_duration != 0u) {
+        const double duration = elapsed - _last_elapsed;
+        std::memcpy(_data.data() + _last_duration, &duration, sizeof(double));
+      }
+      _frames.push_back({elapsed, _data.size()});
+      BeginPacket(0u);
+      Write<uint64_t>(id);
+      _last_duration = _data.size();
+      Write<double>(-1.0);
+      Write<double>(elapsed);
+      EndPacket();
+      _last_elapsed = elapsed;
+    }
+
+    void EndFrame() {
+      BeginPacket(1u);
+      EndPacket();
+    }
+
+    /// 关键帧嵌套其他数据包，在 BeginKeyFrame 与 EndKeyFrame 之间写入。
+    void BeginKeyFrame() {
+      Write<uint8_t>(24u);
+      _key_frame = _data.size();
+      Write<uint32_t>(0u);
+    }
+
+    void EndKeyFrame() {
+      const uint32_t size = static_cast<uint32_t>(_data.size() - _key_frame - sizeof(uint32_t));
+      std::memcpy(_data.data() + _key_frame, &size, sizeof(uint32_t));
+    }
+
+    void AddActor(uint32_t id, uint8_t type, const std::string &type_id, const std::string &role_name) {
+      BeginPacket(2u);
+      Write<uint16_t>(1u);
+      Write<uint32_t>(id);
+      Write<uint8_t>(type);
+      for (auto i = 0u; i < 6u; ++i) {
+        Write<float>(0.0f);
+      }
+      Write<uint32_t>(1u);
+      WriteString(type_id);
+      Write<uint16_t>(1u);
+      Write<uint8_t>(0u);
+      WriteString("role_name");
+      WriteString(role_name);
+      EndPacket();
+    }
+
+    void DeleteActor(uint32_t id) {
+      BeginPacket(3u);
+      Write<uint16_t>(1u);
+      Write<uint32_t>(id);
+      EndPacket();
+    }
+
+    void Collision(uint32_t actor1, uint32_t actor2, bool hero1, bool hero2) {
+      BeginPacket(5u);
+      Write<uint16_t>(1u);
+      Write<uint32_t>(0u);
+      Write<uint32_t>(actor1);
+      Write<uint32_t>(actor2);
+      Write<uint8_t>(hero1);
+      Write<uint8_t>(hero2);
+      EndPacket();
+    }
+
+    /// 位置单位为厘米。
+    void Positions(const std::vector<std::pair<uint32_t, float>> &actors) {
+      BeginPacket(6u);
+      Write<uint16_t>(static_cast<uint16_t>(actors.size()));
+      for (auto &actor : actors) {
+        Write<uint32_t>(actor.first);
+        Write<float>(actor.second);
+        Write<float>(2.0f * actor.second);
+        Write<float>(50.0f);
+        Write<float>(0.0f);
+        Write<float>(0.0f);
+        Write<float>(90.0f);
+      }
+      EndPacket();
+    }
+
+    /// 与 CarlaRecorderPositions::WriteDelta 相同的增量编码，只写变化的位置。
+    void PositionsDelta(const std::vector<std::pair<uint32_t, float>> &actors, bool reset) {
+      BeginPacket(26u);
+      bool new_ids = reset || (actors.size() != _previous.size());
+      for (auto i = 0u; !new_ids && i < actors.size(); ++i) {
+        new_ids = (actors[i].first != _previous[i].first);
+      }
+      Write<uint8_t>((new_ids ? 1u : 0u) | (reset ? 2u : 0u));
+      Write<uint16_t>(static_cast<uint16_t>(actors.size()));
+      if (new_ids) {
+        for (auto &actor : actors) {
+          Write<uint32_t>(actor.first);
+        }
+      }
+      std::vector<const float *> previous(actors.size(), nullptr);
+      for (auto i = 0u; !reset && i < actors.size(); ++i) {
+        for (auto &item : _previous) {
+          if (item.first == actors[i].first) {
+            previous[i] = item.second.data();
+          }
+        }
+      }
+      std::vector<std::pair<uint32_t, std::array<float, 6u>>> current;
+      std::vector<uint8_t> mask((actors.size() + 7u) / 8u, 0u);
+      for (auto i = 0u; i < actors.size(); ++i) {
+        const std::array<float, 6u> values = {
+            actors[i].second, 2.0f * actors[i].second, 50.0f, 0.0f, 0.0f, 90.0f};
+        if ((previous[i] == nullptr) || !std::equal(values.begin(), values.end(), previous[i])) {
+          mask[i / 8u] |= static_cast<uint8_t>(1u << (i % 8u));
+        }
+        current.emplace_back(actors[i].first, values);
+      }
+      _data.insert(_data.end(), mask.begin(), mask.end());
+      for (auto i = 0u; i < actors.size(); ++i) {
+        if ((mask[i / 8u] & (1u << (i % 8u))) == 0u) {
+          continue;
+        }
+        if (previous[i] == nullptr) {
+          Write<uint8_t>(1u);
+          for (auto value : current[i].second) {
+            Write<float>(value);
+          }
+        } else {
+          Write<uint8_t>(0u);
+          for (auto k = 0u; k < 6u; ++k) {
+            Write<int16_t>(static_cast<int16_t>(std::lround((current[i].second[k] - previous[i][k]) / 0.01f)));
+          }
+        }
+      }
+      _previous = std::move(current);
+      EndPacket();
+    }
+
+    /// 与 CarlaRecorderFrameIndex 相同的帧索引。
+    void WriteIndex() {
+      const uint64_t start = _data.size();
+      BeginPacket(25u);
+      Write<uint32_t>(static_cast<uint32_t>(_frames.size()));
+      for (auto &frame : _frames) {
+        Write<double>(frame.first);
+        Write<uint64_t>(frame.second);
+        Write<uint8_t>(0u);
+      }
+      Write<uint64_t>(start);
+      EndPacket();
+    }
+
+    const std::vector<uint8_t> &data() const {
+      return _data;
+    }
+
+  private:
+
+    template <typename T>
+    void Write(T value) {
+      const auto size = _data.size();
+      _data.resize(size + sizeof(T));
+      std::memcpy(_data.data() + size, &value, sizeof(T));
+    }
+
+    void WriteString(const std::string &value) {
+      Write<uint16_t>(static_cast<uint16_t>(value.size()));
+      _data.insert(_data.end(), value.begin(), value.end());
+    }
+
+    void BeginPacket(uint8_t id) {
+      Write<uint8_t>(id);
+      _packet = _data.size();
+      Write<uint32_t>(0u);
+    }
+
+    void EndPacket() {
+      const uint32_t size = static_cast<uint32_t>(_data.size() - _packet - sizeof(uint32_t));
+      std::memcpy(_data.data() + _packet, &size, sizeof(uint32_t));
+    }
+
+    std::vector<uint8_t> _data;
+
+    std::vector<std::pair<double, uint64_t>> _frames;
+
+    size_t _packet = 0u;
+
+    size_t _key_frame = 0u;
+
+    size_t _last_duration = 0u;
+
+    double _last_elapsed = 0.0;
+
+    std::vector<std::pair<uint32_t, std::array<float, 6u>>> _previous;
+  };
+
+  // 车辆 1（hero）一直移动；车辆 2 在 t=1s 停下；行人 3 在 t=2s 被撞后删除
+  static std::vector<uint8_t> MakeRecording(bool with_index, bool delta = false) {
+    RecordingBuilder builder;
+    for (auto i = 0u; i < 100u; ++i) {
+      builder.BeginFrame(i + 1u, 0.1 * i);
+      if (i == 0u) {
+        builder.AddActor(1u, 1u, "vehicle.tesla.model3", "hero");
+        builder.AddActor(2u, 1u, "vehicle.audi.tt", "autopilot");
+        builder.AddActor(3u, 2u, "walker.pedestrian.0001", "");
+      }
+      if (i >= 20u && i < 23u) {
+        builder.Collision(1u, 3u, true, false);
+      }
+      if (i == 25u) {
+        builder.Collision(1u, 3u, true, false);
+        builder.Collision(2u, static_cast<uint32_t>(-1), false, false);
+      }
+      if (i == 30u) {
+        builder.DeleteActor(3u);
+      }
+      std::vector<std::pair<uint32_t, float>> positions;
+      positions.emplace_back(1u, 100.0f * i);
+      positions.emplace_back(2u, 100.0f * std::min(i, 10u));
+      if (i < 30u) {
+        positions.emplace_back(3u, 5.0f);
+      }
+      if (delta) {
+        // 与录制时相同，每个关键帧重新开始
+        builder.PositionsDelta(positions, i % 50u == 0u);
+      } else {
+        builder.Positions(positions);
+      }
+      builder.EndFrame();
+    }
+    if (with_index) {
+      builder.WriteIndex();
+    }
+    return builder.data();
+  }
+
+  // 与 CarlaRecorderBlockFile 相同的按块压缩格式
+  static std::vector<uint8_t> Compress(const std::vector<uint8_t> &data, size_t block_size) {
+    std::vector<uint8_t> result = {'C', 'R', 'B', 'L', 'O', 'C', 'K', 'S'};
+    for (size_t begin = 0u; begin < data.size(); begin += block_size) {
+      const uLong size = static_cast<uLong>(std::min(block_size, data.size() - begin));
+      uLongf stored_size = compressBound(size);
+      std::vector<uint8_t> block(stored_size);
+      EXPECT_EQ(compress2(block.data(), &stored_size, data.data() + begin, size, 6), Z_OK);
+      const uint32_t header[2u] = {static_cast<uint32_t>(stored_size), static_cast<uint32_t>(size)};
+      const auto *bytes = reinterpret_cast<const uint8_t *>(header);
+      result.insert(result.end(), bytes, bytes + sizeof(header));
+      result.push_back(1u);
+      result.insert(result.end(), block.begin(), block.begin() + stored_size);
+    }
+    return result;
+  }
+
+  static std::string WriteFile(const std::vector<uint8_t> &data) {
+    const std::string path = testing::TempDir() + "carla_test_recorder_reader.log";
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return path;
+  }
+
+  static void CheckRecording(const RecorderReader &reader) {
+    const auto &info = reader.GetInfo();
+    ASSERT_EQ(info.map_name, "Town01");
+    ASSERT_EQ(info.frames, 100u);
+    ASSERT_NEAR(info.duration, 9.9, 1e-9);
+
+    const auto &actors = reader.GetActors();
+    ASSERT_EQ(actors.size(), 3u);
+    ASSERT_EQ(actors[0u].id, 1u);
+    ASSERT_TRUE(actors[0u].IsHero());
+    ASSERT_EQ(actors[0u].type_id, "vehicle.tesla.model3");
+    ASSERT_EQ(actors[2u].GetCategory(), 'w');
+    ASSERT_DOUBLE_EQ(actors[1u].destroyed, -1.0);
+    ASSERT_NEAR(actors[2u].destroyed, 3.0, 1e-9);
+
+    // 连续几帧的同一碰撞只报告一次，中断后重新开始的碰撞再报告一次
+    const auto all = reader.GetCollisions();
+    ASSERT_EQ(all.size(), 3u);
+    ASSERT_EQ(all[0u].frame, 21u);
+    ASSERT_EQ(all[1u].frame, 26u);
+    const auto hero = reader.GetCollisions('h', 'w');
+    ASSERT_EQ(hero.size(), 2u);
+    ASSERT_EQ(hero[0u].actor2, 3u);
+    const auto other = reader.GetCollisions('v', 'o');
+    ASSERT_EQ(other.size(), 1u);
+    ASSERT_EQ(other[0u].actor1, 2u);
+
+    const auto blocked = reader.GetBlockedActors(2.0, 0.1);
+    ASSERT_EQ(blocked.size(), 2u);
+    ASSERT_EQ(blocked[0u].id, 2u);
+    ASSERT_NEAR(blocked[0u].time, 1.1, 1e-9);
+    ASSERT_NEAR(blocked[0u].duration, 8.8, 1e-9);
+    ASSERT_EQ(blocked[1u].id, 3u);
+
+    const auto trajectory = reader.GetTrajectory(1u);
+    ASSERT_EQ(trajectory.size(), 100u);
+    ASSERT_NEAR(trajectory.times[50u], 5.0, 1e-9);
+    ASSERT_FLOAT_EQ(trajectory.locations[3u * 50u + 0u], 50.0f);
+    ASSERT_FLOAT_EQ(trajectory.locations[3u * 50u + 1u], 100.0f);
+    ASSERT_FLOAT_EQ(trajectory.locations[3u * 50u + 2u], 0.5f);
+    ASSERT_FLOAT_EQ(trajectory.rotations[3u * 50u + 2u], 90.0f);
+
+    const auto trajectories = reader.GetTrajectories();
+    ASSERT_EQ(trajectories.size(), 3u);
+    ASSERT_EQ(trajectories[2u].actor_id, 3u);
+    ASSERT_EQ(trajectories[2u].size(), 30u);
+  }
+
+} // namespace
+
+TEST(recorder_reader, plain) {
+  const auto path = WriteFile(MakeRecording(false));
+  RecorderReader reader(path);
+  ASSERT_FALSE(reader.GetInfo().indexed);
+  ASSERT_FALSE(reader.GetInfo().compressed);
+  CheckRecording(reader);
+  std::remove(path.c_str());
+}
+
+TEST(recorder_reader, indexed) {
+  const auto path = WriteFile(MakeRecording(true));
+  RecorderReader reader(path);
+  ASSERT_TRUE(reader.GetInfo().indexed);
+  CheckRecording(reader);
+  std::remove(path.c_str());
+}
+
+TEST(recorder_reader, compressed) {
+  const auto path = WriteFile(Compress(MakeRecording(true), 1000u));
+  RecorderReader reader(path);
+  ASSERT_TRUE(reader.GetInfo().compressed);
+  ASSERT_TRUE(reader.GetInfo().indexed);
+  CheckRecording(reader);
+  std::remove(path.c_str());
+}
+
+TEST(recorder_reader, delta_positions) {
+  const auto path = WriteFile(MakeRecording(true, true));
+  RecorderReader reader(path);
+  CheckRecording(reader);
+  std::remove(path.c_str());
+}
+
+// “黑匣子”记录的文件：actor 在第一帧之前就存在，只出现在第一帧的关键帧里
+TEST(recorder_reader, key_frame_actors) {
+  RecordingBuilder builder;
+  for (auto i = 0u; i < 20u; ++i) {
+    builder.BeginFrame(i + 1u, 0.1 * i);
+    builder.BeginKeyFrame();
+    if (i % 10u == 0u) {
+      builder.AddActor(1u, 1u, "vehicle.tesla.model3", "hero");
+      builder.AddActor(2u, 2u, "walker.pedestrian.0001", "");
+    }
+    builder.EndKeyFrame();
+    if (i == 15u) {
+      builder.DeleteActor(2u);
+    }
+    builder.Positions({{1u, 100.0f * i}});
+    builder.EndFrame();
+  }
+  const auto path = WriteFile(builder.data());
+  RecorderReader reader(path);
+  const auto &actors = reader.GetActors();
+  ASSERT_EQ(actors.size(), 2u);
+  ASSERT_TRUE(actors[0u].IsHero());
+  ASSERT_DOUBLE_EQ(actors[0u].created, 0.0);
+  ASSERT_DOUBLE_EQ(actors[0u].destroyed, -1.0);
+  ASSERT_NEAR(actors[1u].destroyed, 1.5, 1e-9);
+  ASSERT_EQ(reader.GetTrajectory(1u).size(), 20u);
+  std::remove(path.c_str());
+}
+
+TEST(recorder_reader, invalid_file) {
+  const auto path = WriteFile(std::vector<uint8_t>(64u, 0u));
+  ASSERT_THROW(RecorderReader{path}, std::runtime_error);
+  std::remove(path.c_str());
+}
@@ -8,7 +8,15 @@
 
 #include <carla/RecurrentSharedFuture.h>
 #include <carla/ThreadGroup.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
 
 using namespace std::chrono_literals;
 // 测试 RecurrentSharedFuture 的用例
@@ -88,3 +96,136 @@ TEST(recurrent_shared_future, exception) {
     ASSERT_STREQ(e.what(), message.c_str());
   }
 }
+
+
+namespace benchmark_wake_up {
+
+  // 与之前的实现相同：每个等待的线程在 std::map 中有一个槽位，由互斥量与条件
+  // 变量保护，用作比较的基准。
+  template <typename T>
+  class ConditionVariableFuture {
+  public:
+
+    boost::optional<T> WaitFor(carla::time_duration timeout) {
+      static thread_local const char tag{};
+      std::unique_lock<std::mutex> lock(_mutex);
+      auto &slot = _map[&tag];
+      slot.first = true;
+      if (!_cv.wait_for(lock, timeout.to_chrono(), [&]() { return !slot.first; })) {
+        return {};
+      }
+      return slot.second;
+    }
+
+    void SetValue(const T &value) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &pair : _map) {
+        pair.second.first = false;
+        pair.second.second = value;
+      }
+      _cv.notify_all();
+    }
+
+  private:
+
+    std::mutex _mutex;
+
+    std::condition_variable _cv;
+
+    std::map<const char *, std::pair<bool, T>> _map;
+  };
+
+  using clock = std::chrono::steady_clock;
+
+  struct WakeUpLatency {
+    /// 所有线程醒来耗时的平均值（微秒）。
+    double mean_us = 0.0;
+    /// 每轮中最后一个线程醒来的耗时（微秒），已排序。
+    std::vector<double> last_us;
+  };
+
+  // 每轮在所有线程开始等待后设置一次值，记录从设置值到每个线程醒来的时间。
+  template <typename FutureT>
+  WakeUpLatency MeasureWakeUp(size_t number_of_waiters, int rounds) {
+    FutureT future;
+    std::atomic<int> ready{0};
+    // 在设置值之前写入，线程得到值之后读取
+    std::vector<clock::time_point> begin(static_cast<size_t>(rounds));
+    std::vector<std::atomic<int64_t>> last_ns(static_cast<size_t>(rounds));
+    for (auto &value : last_ns) {
+      value = 0;
+    }
+    std::atomic<int64_t> total_ns{0};
+    std::atomic<int64_t> wake_ups{0};
+    carla::ThreadGroup threads;
+    threads.CreateThreads(number_of_waiters, [&]() {
+      int round = 0;
+      while (round < rounds) {
+        ++ready;
+        auto result = future.WaitFor(carla::time_duration::seconds(5));
+        const auto now = clock::now();
+        if (!result.has_value()) {
+          return;
+        }
+        round = *result;
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - begin[static_cast<size_t>(round - 1)]).count();
+        total_ns += ns;
+        ++wake_ups;
+        auto &slot = last_ns[static_cast<size_t>(round - 1)];
+        auto previous = slot.load();
+        while ((previous < ns) && !slot.compare_exchange_weak(previous, ns)) {}
+      }
+    });
+    for (int round = 1; round <= rounds; ++round) {
+      // 等到所有线程都调用了 WaitFor，再留一点时间让它们进入阻塞。被调度器
+      // 耽误而错过一轮的线程不会阻止测量继续。
+      const auto deadline = clock::now() + 10ms;
+      while ((ready.load() < static_cast<int>(number_of_waiters) * round) && (clock::now() < deadline)) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(200us);
+      begin[static_cast<size_t>(round - 1)] = clock::now();
+      future.SetValue(round);
+    }
+    threads.JoinAll();
+    WakeUpLatency result;
+    result.mean_us = 1e-3 * static_cast<double>(total_ns.load()) / static_cast<double>(std::max<int64_t>(wake_ups.load(), 1));
+    for (auto &value : last_ns) {
+      result.last_us.push_back(1e-3 * static_cast<double>(value.load()));
+    }
+    std::sort(result.last_us.begin(), result.last_us.end());
+    return result;
+  }
+
+  template <typename FutureT>
+  void Report(const char *implementation, size_t number_of_waiters) {
+    constexpr int rounds = 200;
+    const auto latency = MeasureWakeUp<FutureT>(number_of_waiters, rounds);
+    const auto percentile = [&](double p) {
+      return latency.last_us[static_cast<size_t>(p * static_cast<double>(latency.last_us.size() - 1u))];
+    };
+    std::ostringstream json;
+    json << "{\"benchmark\":\"recurrent_shared_future\",\"implementation\":\"" << implementation
+         << "\",\"waiters\":" << number_of_waiters
+         << ",\"rounds\":" << rounds
+         << ",\"mean_us\":" << latency.mean_us
+         << ",\"last_p50_us\":" << percentile(0.5)
+         << ",\"last_p99_us\":" << percentile(0.99)
+         << ",\"last_max_us\":" << latency.last_us.back()
+         << "}";
+    std::cout << json.str() << std::endl;
+    std::ofstream("benchmark_recurrent_shared_future.jsonl", std::ios_base::app) << json.str() << '\n';
+  }
+
+} // namespace benchmark_wake_up
+
+// 从设置值到等待的线程醒来的延迟与等待线程数的关系，并与之前基于互斥量和
+// 条件变量的实现比较。"last" 为每轮中最后一个醒来的线程。
+TEST(recurrent_shared_future, benchmark_wake_up_latency) {
+  using namespace benchmark_wake_up;
+  for (size_t waiters : {1u, 4u, 16u, 64u}) {
+    Report<carla::RecurrentSharedFuture<int>>("version_counter", waiters);
+    Report<ConditionVariableFuture<int>>("condition_variable", waiters);
+  }
+}
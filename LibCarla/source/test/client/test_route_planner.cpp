@@ -0,0 +1,190 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/RoutePlanner.h>
+#include <carla/trafficmanager/WaypointGraph.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace cg = carla::geom;
+namespace ctm = carla::traffic_manager;
+
+using ctm::WaypointIndex;
+
+static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+// 合成的路网：GRID_SIZE x GRID_SIZE 个路口，每条路用两个中间路径点细分，
+// 所以路口之间是没有分支的链。每行向右通行，偶数列向下、奇数列向上通行，
+// 形成多条环路。另有一个三个路径点组成的环形孤岛，与主路网不连通。
+static constexpr uint32_t GRID_SIZE = 5u;
+static constexpr uint32_t SUBDIVISIONS = 3u;
+static constexpr uint32_t ISLAND_SIZE = 3u;
+
+struct SyntheticGraph {
+  ctm::WaypointGraph graph;
+  std::vector<std::vector<WaypointIndex>> successors;
+  std::vector<cg::Location> locations;
+  std::vector<WaypointIndex> island;
+};
+
+static WaypointIndex AddNode(SyntheticGraph &result, const cg::Location &location) {
+  result.locations.push_back(location);
+  result.successors.emplace_back();
+  return static_cast<WaypointIndex>(result.locations.size() - 1u);
+}
+
+// 从 @a from 到 @a to 添加一条细分为 SUBDIVISIONS 段的单向道路
+static void AddRoad(SyntheticGraph &result, const WaypointIndex from, const WaypointIndex to) {
+  const cg::Location a = result.locations[from];
+  const cg::Location b = result.locations[to];
+  WaypointIndex previous = from;
+  for (uint32_t i = 1u; i < SUBDIVISIONS; ++i) {
+    const float t = static_cast<float>(i) / static_cast<float>(SUBDIVISIONS);
+    const WaypointIndex current = AddNode(result, a + (b - a) * t);
+    result.successors[previous].push_back(current);
+    previous = current;
+  }
+  result.successors[previous].push_back(to);
+}
+
+static SyntheticGraph MakeSyntheticGraph() {
+  SyntheticGraph result;
+  std::vector<WaypointIndex> junctions;
+  for (uint32_t row = 0u; row < GRID_SIZE; ++row) {
+    for (uint32_t column = 0u; column < GRID_SIZE; ++column) {
+      // 稍微打乱位置，避免等长的路线
+      const float jitter = static_cast<float>((row * 7u + column * 3u) % 5u);
+      junctions.push_back(AddNode(result, cg::Location(
+          100.0f * static_cast<float>(column) + jitter,
+          100.0f * static_cast<float>(row) - jitter,
+          0.0f)));
+    }
+  }
+  auto junction = [&](const uint32_t row, const uint32_t column) {
+    return junctions[row * GRID_SIZE + column];
+  };
+  for (uint32_t row = 0u; row < GRID_SIZE; ++row) {
+    for (uint32_t column = 0u; column < GRID_SIZE; ++column) {
+      if (column + 1u < GRID_SIZE) {
+        AddRoad(result, junction(row, column), junction(row, column + 1u));
+      }
+      if (row + 1u < GRID_SIZE) {
+        if (column % 2u == 0u) {
+          AddRoad(result, junction(row, column), junction(row + 1u, column));
+        } else {
+          AddRoad(result, junction(row + 1u, column), junction(row, column));
+        }
+      }
+    }
+  }
+  // 最后一行向左返回第一列，使大部分路口相互可达
+  AddRoad(result, junction(GRID_SIZE - 1u, GRID_SIZE - 1u), junction(GRID_SIZE - 1u, 0u));
+
+  for (uint32_t i = 0u; i < ISLAND_SIZE; ++i) {
+    result.island.push_back(AddNode(result, cg::Location(
+        -1000.0f - 10.0f * static_cast<float>(i),
+        -1000.0f + 10.0f * static_cast<float>(i * i),
+        0.0f)));
+  }
+  for (uint32_t i = 0u; i < ISLAND_SIZE; ++i) {
+    result.successors[result.island[i]].push_back(result.island[(i + 1u) % ISLAND_SIZE]);
+  }
+
+  std::vector<ctm::WaypointGraph::Node> nodes(result.locations.size());
+  for (size_t i = 0u; i < nodes.size(); ++i) {
+    nodes[i].location = result.locations[i];
+  }
+  result.graph.Build(std::move(nodes), result.successors);
+  return result;
+}
+
+// 路径点图上不做任何收缩的 Dijkstra，作为参考结果
+static std::vector<float> Dijkstra(const SyntheticGraph &input, const WaypointIndex source) {
+  using Entry = std::pair<float, WaypointIndex>;
+  std::vector<float> distances(input.locations.size(), UNREACHABLE);
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  distances[source] = 0.0f;
+  open.emplace(0.0f, source);
+  while (!open.empty()) {
+    const Entry entry = open.top();
+    open.pop();
+    if (entry.first > distances[entry.second]) {
+      continue;
+    }
+    for (const WaypointIndex next : input.successors[entry.second]) {
+      const float distance = entry.first + input.locations[entry.second].Distance(input.locations[next]);
+      if (distance < distances[next]) {
+        distances[next] = distance;
+        open.emplace(distance, next);
+      }
+    }
+  }
+  return distances;
+}
+
+// 检查路线沿图中的边前进，并返回其长度
+static float RouteLength(const SyntheticGraph &input, const std::vector<WaypointIndex> &route) {
+  float length = 0.0f;
+  for (size_t i = 1u; i < route.size(); ++i) {
+    const auto &next = input.successors[route[i - 1u]];
+    EXPECT_NE(std::find(next.begin(), next.end(), route[i]), next.end())
+        << "no edge from " << route[i - 1u] << " to " << route[i];
+    length += input.locations[route[i - 1u]].Distance(input.locations[route[i]]);
+  }
+  return length;
+}
+
+TEST(route_planner, matches_dijkstra_on_synthetic_graph) {
+  const auto input = MakeSyntheticGraph();
+  ctm::RoutePlanner planner(input.graph);
+  const auto size = static_cast<WaypointIndex>(input.locations.size());
+  size_t reachable_pairs = 0u;
+  size_t unreachable_pairs = 0u;
+  for (WaypointIndex origin = 0u; origin < size; ++origin) {
+    const auto expected = Dijkstra(input, origin);
+    for (WaypointIndex destination = 0u; destination < size; ++destination) {
+      const auto route = planner.PlanWaypointRoute(origin, destination);
+      if (expected[destination] == UNREACHABLE) {
+        ++unreachable_pairs;
+        ASSERT_TRUE(route.empty()) << origin << " -> " << destination;
+        continue;
+      }
+      ++reachable_pairs;
+      ASSERT_FALSE(route.empty()) << origin << " -> " << destination;
+      ASSERT_EQ(route.front(), origin);
+      ASSERT_EQ(route.back(), destination);
+      ASSERT_NEAR(RouteLength(input, route), expected[destination], 1e-3f * (1.0f + expected[destination]))
+          << origin << " -> " << destination;
+    }
+  }
+  // 合成的路网同时包含可达和不可达的组合
+  ASSERT_GT(reachable_pairs, 0u);
+  ASSERT_GT(unreachable_pairs, 0u);
+}
+
+TEST(route_planner, disconnected_goal_has_no_route) {
+  const auto input = MakeSyntheticGraph();
+  ctm::RoutePlanner planner(input.graph);
+  const WaypointIndex origin = 0u;
+  for (const WaypointIndex goal : input.island) {
+    ASSERT_TRUE(planner.PlanWaypointRoute(origin, goal).empty());
+    ASSERT_TRUE(planner.PlanWaypointRoute(goal, origin).empty());
+    // 查询结果被缓存，再次查询仍然不可达
+    ASSERT_TRUE(planner.PlanWaypointRoute(origin, goal).empty());
+  }
+  // 孤岛内部沿环路可达
+  const auto route = planner.PlanWaypointRoute(input.island[1u], input.island[0u]);
+  ASSERT_EQ(route.size(), ISLAND_SIZE);
+  ASSERT_EQ(route.front(), input.island[1u]);
+  ASSERT_EQ(route.back(), input.island[0u]);
+}
@@ -13,7 +13,9 @@
 #include <carla/rpc/Response.h>
 #include <carla/rpc/Server.h>
 
+#include <future>
 #include <thread>
+#include <vector>
 
 using namespace carla::rpc;
 using namespace std::chrono_literals;
@@ -78,3 +80,65 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   // 断言任务已完成
   ASSERT_TRUE(done);
 }
+
+// 在同一连接上同时发出多个请求，不等待前一个请求返回。
+TEST(rpc, pipelined_calls) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  server.BindSync("add", [](int x, int y) -> int { return x + y; });
+  server.AsyncRun(1u);
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    std::vector<std::future<clmdep_msgpack::object_handle>> futures;
+    for (auto i = 0; i < 100; ++i) {
+      futures.emplace_back(client.pipelined_call("add", i, 1));
+    }
+    for (auto i = 0; i < 100; ++i) {
+      EXPECT_EQ(futures[i].get().as<int>(), i + 1);
+    }
+    done = true;
+  });
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  ASSERT_TRUE(done);
+}
+
+// 服务器拒绝请求（部分 id 无效）时返回 Response 错误，不能当作服务器不支持该函数；
+// 只有没有绑定的函数才会抛出“找不到函数”的 ::rpc::rpc_error。
+TEST(rpc, rejected_call_is_not_function_not_found) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  server.BindSync("apply_some", [](std::vector<int> ids) -> Response<void> {
+    for (auto id : ids) {
+      if (id < 0) {
+        return ResponseError("apply_some: actor ids out of range");
+      }
+    }
+    return Response<void>::Success();
+  });
+  server.AsyncRun(1u);
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    auto response = client.call("apply_some", std::vector<int>{1, -1, 2}).as<Response<void>>();
+    EXPECT_TRUE(response.HasError());
+    response = client.call("apply_some", std::vector<int>{1, 2}).as<Response<void>>();
+    EXPECT_FALSE(response.HasError());
+    bool not_found = false;
+    try {
+      client.call("apply_other", std::vector<int>{1});
+    } catch (::rpc::rpc_error &e) {
+      not_found = Client::IsFunctionNotFound(e);
+    }
+    EXPECT_TRUE(not_found);
+    done = true;
+  });
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  ASSERT_TRUE(done);
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/ActorSnapshotColumns.h>
+
+#include <vector>
+
+using namespace carla::client;
+
+// 列按参与者 ID 排序，每一行的数据与对应的快照一致。
+TEST(client, actor_snapshot_columns) {
+  namespace cg = carla::geom;
+  std::vector<ActorSnapshot> snapshots(3u);
+  const carla::ActorId ids[] = {42u, 7u, 13u};
+  for (auto i = 0u; i < snapshots.size(); ++i) {
+    const auto value = static_cast<float>(ids[i]);
+    snapshots[i].id = ids[i];
+    snapshots[i].transform = cg::Transform{
+        cg::Location{value, value + 1.0f, value + 2.0f},
+        cg::Rotation{value + 3.0f, value + 4.0f, value + 5.0f}};
+    snapshots[i].velocity = cg::Vector3D{value, 0.0f, 0.0f};
+    snapshots[i].angular_velocity = cg::Vector3D{0.0f, value, 0.0f};
+    snapshots[i].acceleration = cg::Vector3D{0.0f, 0.0f, value};
+  }
+
+  ActorSnapshotColumns columns(snapshots.begin(), snapshots.end());
+  ASSERT_EQ(columns.size(), 3u);
+  ASSERT_EQ(columns.GetIds(), (std::vector<carla::ActorId>{7u, 13u, 42u}));
+  ASSERT_EQ(columns.GetTransforms().size(), 3u * ActorSnapshotColumns::TRANSFORM_SIZE);
+  ASSERT_EQ(columns.GetVelocities().size(), 3u * ActorSnapshotColumns::VECTOR_SIZE);
+
+  auto index = columns.FindIndex(13u);
+  ASSERT_TRUE(index.has_value());
+  ASSERT_EQ(*index, 1u);
+  ASSERT_FALSE(columns.FindIndex(8u).has_value());
+
+  const float *transform = &columns.GetTransforms()[*index * ActorSnapshotColumns::TRANSFORM_SIZE];
+  for (auto i = 0u; i < ActorSnapshotColumns::TRANSFORM_SIZE; ++i) {
+    ASSERT_EQ(transform[i], 13.0f + static_cast<float>(i));
+  }
+  const auto row = *index * ActorSnapshotColumns::VECTOR_SIZE;
+  ASSERT_EQ(columns.GetVelocities()[row], 13.0f);
+  ASSERT_EQ(columns.GetAngularVelocities()[row + 1u], 13.0f);
+  ASSERT_EQ(columns.GetAccelerations()[row + 2u], 13.0f);
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDriveFixtures.h"
+
+#include <carla/client/Map.h>
+#include <carla/client/Waypoint.h>
+#include <carla/trafficmanager/Constants.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/WaypointGraph.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <set>
+
+namespace cc = carla::client;
+namespace ctm = carla::traffic_manager;
+
+using ctm::WaypointGraph;
+using ctm::WaypointIndex;
+
+static std::shared_ptr<ctm::InMemoryMap> MakeLocalMap() {
+  auto world_map = carla::MakeShared<const cc::Map>("two_roads", util::fixtures::TWO_ROADS_XODR);
+  auto local_map = std::make_shared<ctm::InMemoryMap>(world_map);
+  local_map->SetUp();
+  return local_map;
+}
+
+TEST(waypoint_graph, matches_dense_topology) {
+  const auto local_map = MakeLocalMap();
+  const WaypointGraph &graph = local_map->GetWaypointGraph();
+  const auto dense_topology = local_map->GetDenseTopology();
+  ASSERT_GT(graph.Size(), 0u);
+  ASSERT_EQ(graph.Size(), dense_topology.size());
+
+  for (WaypointIndex index = 0u; index < graph.Size(); ++index) {
+    const auto &simple_waypoint = dense_topology[index];
+    ASSERT_EQ(simple_waypoint->GetGraphIndex(), index);
+    ASSERT_EQ(graph.GetWaypoint(index), simple_waypoint);
+    ASSERT_EQ(graph.GetNode(index).location, simple_waypoint->GetLocation());
+
+    const auto next = simple_waypoint->GetNextWaypoint();
+    const auto graph_next = graph.GetNext(index);
+    ASSERT_EQ(graph_next.size(), next.size());
+    for (size_t i = 0u; i < next.size(); ++i) {
+      ASSERT_EQ(graph_next[i], next[i]->GetGraphIndex());
+    }
+    const auto previous = simple_waypoint->GetPreviousWaypoint();
+    const auto graph_previous = graph.GetPrevious(index);
+    ASSERT_EQ(graph_previous.size(), previous.size());
+    for (size_t i = 0u; i < previous.size(); ++i) {
+      ASSERT_EQ(graph_previous[i], previous[i]->GetGraphIndex());
+    }
+  }
+}
+
+TEST(waypoint_graph, successor_edges_follow_lanes) {
+  const auto local_map = MakeLocalMap();
+  const WaypointGraph &graph = local_map->GetWaypointGraph();
+
+  std::set<int> forward_crossings;
+  std::set<int> backward_crossings;
+  for (WaypointIndex index = 0u; index < graph.Size(); ++index) {
+    const auto waypoint = graph.GetWaypoint(index)->GetWaypoint();
+    for (const WaypointIndex next : graph.GetNext(index)) {
+      const auto next_waypoint = graph.GetWaypoint(next)->GetWaypoint();
+      // 两条路的车道 id 相同，沿后继不会换到其他车道
+      ASSERT_EQ(next_waypoint->GetLaneId(), waypoint->GetLaneId());
+      ASSERT_LE(graph.GetNode(index).location.Distance(graph.GetNode(next).location),
+          2.0f * ctm::constants::Map::MAP_RESOLUTION);
+      // 右侧车道沿 +x 行驶，左侧车道沿 -x 行驶
+      const float dx = graph.GetNode(next).location.x - graph.GetNode(index).location.x;
+      if (waypoint->GetLaneId() < 0) {
+        ASSERT_GE(dx, 0.0f);
+      } else {
+        ASSERT_LE(dx, 0.0f);
+      }
+      ASSERT_TRUE(graph.GetPrevious(next).end() !=
+          std::find(graph.GetPrevious(next).begin(), graph.GetPrevious(next).end(), index));
+      if (next_waypoint->GetRoadId() != waypoint->GetRoadId()) {
+        if (waypoint->GetLaneId() < 0) {
+          ASSERT_EQ(waypoint->GetRoadId(), 0u);
+          forward_crossings.insert(waypoint->GetLaneId());
+        } else {
+          ASSERT_EQ(waypoint->GetRoadId(), 1u);
+          backward_crossings.insert(waypoint->GetLaneId());
+        }
+      }
+    }
+  }
+  // 每条车道都从一条路连到另一条路
+  ASSERT_EQ(forward_crossings, (std::set<int>{-2, -1}));
+  ASSERT_EQ(backward_crossings, (std::set<int>{1, 2}));
+}
+
+TEST(waypoint_graph, lane_change_edges) {
+  const auto local_map = MakeLocalMap();
+  const WaypointGraph &graph = local_map->GetWaypointGraph();
+
+  size_t links_towards_center = 0u;
+  size_t links_away_from_center = 0u;
+  auto check_link = [&](const WaypointIndex from, const WaypointIndex to, const bool towards_center) {
+    const auto waypoint = graph.GetWaypoint(from)->GetWaypoint();
+    const auto target = graph.GetWaypoint(to)->GetWaypoint();
+    // 只能换到同方向的相邻车道，两条路的车道 id 相同
+    ASSERT_GT(target->GetLaneId() * waypoint->GetLaneId(), 0);
+    const int from_lane = std::abs(waypoint->GetLaneId());
+    const int to_lane = std::abs(target->GetLaneId());
+    ASSERT_EQ(to_lane, towards_center ? from_lane - 1 : from_lane + 1);
+    ASSERT_NEAR(std::abs(graph.GetNode(to).location.y - graph.GetNode(from).location.y), 3.5f, 0.1f);
+    ++(towards_center ? links_towards_center : links_away_from_center);
+  };
+
+  for (WaypointIndex index = 0u; index < graph.Size(); ++index) {
+    const auto &node = graph.GetNode(index);
+    // 每侧的内侧车道在左边，外侧车道在右边
+    if (node.left != WaypointGraph::INVALID_INDEX) {
+      check_link(index, node.left, true);
+    }
+    if (node.right != WaypointGraph::INVALID_INDEX) {
+      check_link(index, node.right, false);
+    }
+  }
+  ASSERT_GT(links_towards_center, 0u);
+  ASSERT_GT(links_away_from_center, 0u);
+}
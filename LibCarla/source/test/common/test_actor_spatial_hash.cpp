@@ -0,0 +1,52 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/ActorSpatialHash.h>
+
+#include <algorithm>
+#include <vector>
+
+using carla::traffic_manager::ActorSpatialHash;
+
+// 查询结果包含半径内的所有参与者，重建之后不再包含旧的位置。
+TEST(actor_spatial_hash, radius_query) {
+  namespace cg = carla::geom;
+  ActorSpatialHash hash(25.0f);
+  std::vector<cg::Location> locations;
+  for (auto x = -200.0f; x <= 200.0f; x += 15.0f) {
+    for (auto y = -200.0f; y <= 200.0f; y += 15.0f) {
+      hash.Insert(static_cast<carla::ActorId>(locations.size()), cg::Location{x, y, 0.0f});
+      locations.emplace_back(x, y, 0.0f);
+    }
+  }
+
+  const cg::Location center{-7.0f, 31.0f, 0.0f};
+  for (auto radius : {0.0f, 12.0f, 40.0f, 130.0f, 5000.0f}) {
+    std::vector<carla::ActorId> found;
+    hash.ForEachInRadius(center, radius, [&](const carla::ActorId id) {
+      if (cg::Math::DistanceSquared(locations[id], center) <= radius * radius) {
+        found.emplace_back(id);
+      }
+    });
+    std::sort(found.begin(), found.end());
+    std::vector<carla::ActorId> expected;
+    for (auto id = 0u; id < locations.size(); ++id) {
+      if (cg::Math::DistanceSquared(locations[id], center) <= radius * radius) {
+        expected.emplace_back(id);
+      }
+    }
+    ASSERT_EQ(found, expected);
+  }
+
+  hash.Clear();
+  hash.Insert(0u, center);
+  std::vector<carla::ActorId> found;
+  hash.ForEachInRadius(center, 5000.0f, [&](const carla::ActorId id) { found.emplace_back(id); });
+  ASSERT_EQ(found, std::vector<carla::ActorId>{0u});
+}
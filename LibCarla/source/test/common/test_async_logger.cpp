@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/AsyncLogger.h>
+#include <carla/ThreadGroup.h>
+
+#include <sstream>
+#include <string>
+
+using carla::AsyncLogger;
+using carla::LogFormat;
+
+static size_t CountLines(const std::string &text) {
+  return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+// 多个线程的消息都被写出，格式与同步写入一致，警告以上写入错误流。
+TEST(async_logger, text) {
+  std::ostringstream out;
+  std::ostringstream err;
+  {
+    AsyncLogger logger(LogFormat::Text, out, err, 1u << 16u);
+    carla::ThreadGroup threads;
+    threads.CreateThreads(4u, [&]() {
+      for (int i = 0; i < 1000; ++i) {
+        logger.Write(LIBCARLA_LOG_LEVEL_INFO, "message " + std::to_string(i));
+      }
+    });
+    threads.JoinAll();
+    logger.Write(LIBCARLA_LOG_LEVEL_ERROR, "failure");
+    logger.Flush();
+    ASSERT_EQ(CountLines(out.str()), 4000u);
+    ASSERT_EQ(err.str(), "ERROR: failure\n");
+    ASSERT_EQ(logger.GetNumberOfDroppedMessages(), 0u);
+  }
+  ASSERT_EQ(out.str().substr(0u, 17u), "INFO:  message 0\n");
+}
+
+TEST(async_logger, json) {
+  std::ostringstream out;
+  AsyncLogger logger(LogFormat::Json, out, out);
+  logger.Write(LIBCARLA_LOG_LEVEL_WARNING, "quote \" backslash \\ newline\n");
+  logger.Flush();
+  const auto line = out.str();
+  ASSERT_NE(line.find("\"level\": \"warning\""), std::string::npos);
+  ASSERT_NE(line.find("\"message\": \"quote \\\" backslash \\\\ newline\\n\"}"), std::string::npos);
+  ASSERT_EQ(CountLines(line), 1u);
+}
+
+// 队列满时丢弃新消息而不阻塞，之后报告丢弃的数量。
+TEST(async_logger, overflow) {
+  std::ostringstream out;
+  AsyncLogger logger(LogFormat::Text, out, out, 4u);
+  for (int i = 0; i < 10000; ++i) {
+    logger.Write(LIBCARLA_LOG_LEVEL_DEBUG, "message");
+  }
+  logger.Flush();
+  const size_t dropped = logger.GetNumberOfDroppedMessages();
+  const auto text = out.str();
+  size_t written = 0u;
+  for (auto pos = text.find("DEBUG: message\n"); pos != std::string::npos; pos = text.find("DEBUG: message\n", pos + 1u)) {
+    ++written;
+  }
+  ASSERT_EQ(written + dropped, 10000u);
+  ASSERT_EQ(dropped > 0u, text.find("log queue full") != std::string::npos);
+}
+
+// 通过后端记录的消息不带前缀，运行时级别与频率限制在调用者线程中生效。
+TEST(async_logger, backend_and_rate_limit) {
+  std::ostringstream out;
+  AsyncLogger logger(LogFormat::Text, out, out);
+  const int level = carla::logging::GetLevel();
+  carla::logging::SetBackend(&logger);
+  carla::logging::SetLevel(LIBCARLA_LOG_LEVEL_WARNING);
+  carla::log_info("hidden");
+  carla::log_warning("visible", 42);
+  for (int i = 0; i < 100; ++i) {
+    LOG_RATE_LIMITED(3600.0, carla::log_warning, "limited");
+  }
+  carla::logging::SetLevel(level);
+  carla::logging::SetBackend(nullptr);
+  logger.Flush();
+  // 调用点的限制器是静态的，重复运行测试时可能已经处于限制期内
+  const auto text = out.str();
+  ASSERT_EQ(text.substr(0u, 20u), "WARNING: visible 42\n");
+  ASSERT_LE(CountLines(text), 2u);
+
+  carla::logging::RateLimiter limiter(0.0);
+  size_t suppressed = 1u;
+  ASSERT_TRUE(limiter.Allow(suppressed));
+  ASSERT_EQ(suppressed, 0u);
+}
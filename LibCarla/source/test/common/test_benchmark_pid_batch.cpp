@@ -0,0 +1,129 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/PIDBatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace PID = carla::traffic_manager::PID;
+namespace constants = carla::traffic_manager::constants;
+
+static constexpr size_t NUMBER_OF_VEHICLES = 4096u;
+
+// 与 PID::RunStep 相同的逐车辆计算，用作参照。
+static void RunStepReference(const PID::ActuationBatch &batch, const size_t i,
+                             float &throttle, float &brake, float &steer) {
+  using namespace constants::PID;
+  const bool is_highway = batch.highway[i] != 0u;
+  const std::vector<float> &longitudinal = is_highway ? LONGITUDIAL_HIGHWAY_PARAM : LONGITUDIAL_PARAM;
+  const std::vector<float> &lateral = is_highway ? LATERAL_HIGHWAY_PARAM : LATERAL_PARAM;
+
+  const float expr_v =
+      longitudinal[0] * batch.velocity_deviation[i] +
+      longitudinal[1] * (batch.velocity_deviation[i] + batch.previous_velocity_deviation[i]) * DT +
+      longitudinal[2] * (batch.velocity_deviation[i] - batch.previous_velocity_deviation[i]) * INV_DT;
+  if (expr_v > 0.0f) {
+    throttle = std::min(expr_v, MAX_THROTTLE);
+    brake = 0.0f;
+  } else {
+    throttle = 0.0f;
+    brake = std::min(std::abs(expr_v), MAX_BRAKE);
+  }
+  if (batch.emergency_stop[i] != 0u) {
+    throttle = 0.0f;
+    brake = 1.0f;
+  }
+
+  steer =
+      lateral[0] * batch.angular_deviation[i] +
+      lateral[1] * (batch.angular_deviation[i] + batch.previous_angular_deviation[i]) * DT +
+      lateral[2] * (batch.angular_deviation[i] - batch.previous_angular_deviation[i]) * INV_DT;
+  steer = std::max(batch.previous_steer[i] - MAX_STEERING_DIFF, std::min(steer, batch.previous_steer[i] + MAX_STEERING_DIFF));
+  steer = std::max(-MAX_STEERING, std::min(steer, MAX_STEERING));
+}
+
+static PID::ActuationBatch MakeRandomBatch(const size_t size) {
+  std::mt19937 generator(42u);
+  std::uniform_real_distribution<float> deviation(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> steer(-constants::PID::MAX_STEERING, constants::PID::MAX_STEERING);
+  std::bernoulli_distribution flag(0.3);
+
+  PID::ActuationBatch batch;
+  batch.Resize(size);
+  for (size_t i = 0u; i < size; ++i) {
+    batch.angular_deviation[i] = deviation(generator);
+    batch.velocity_deviation[i] = deviation(generator);
+    batch.previous_angular_deviation[i] = deviation(generator);
+    batch.previous_velocity_deviation[i] = deviation(generator);
+    batch.previous_steer[i] = steer(generator);
+    batch.highway[i] = flag(generator);
+    batch.emergency_stop[i] = flag(generator);
+  }
+  return batch;
+}
+
+static void RunBatch(PID::ActuationBatch &batch) {
+  using namespace constants::PID;
+  PID::RunBatch(batch, LONGITUDIAL_PARAM, LONGITUDIAL_HIGHWAY_PARAM, LATERAL_PARAM, LATERAL_HIGHWAY_PARAM);
+}
+
+// 批量计算的结果与逐车辆计算相同（允许浮点运算顺序带来的误差），车辆数不是
+// LANES 的倍数时也一样。
+TEST(pid_batch, matches_scalar_controller) {
+  for (size_t size : {13u, 4093u}) {
+    PID::ActuationBatch batch = MakeRandomBatch(size);
+    ASSERT_EQ(batch.Size(), size);
+    RunBatch(batch);
+    for (size_t i = 0u; i < batch.Size(); ++i) {
+      float throttle, brake, steer;
+      RunStepReference(batch, i, throttle, brake, steer);
+      ASSERT_NEAR(batch.throttle[i], throttle, 1e-4f) << "vehicle " << i;
+      ASSERT_NEAR(batch.brake[i], brake, 1e-4f) << "vehicle " << i;
+      ASSERT_NEAR(batch.steer[i], steer, 1e-4f) << "vehicle " << i;
+    }
+  }
+}
+
+TEST(pid_batch, empty_batch) {
+  PID::ActuationBatch batch;
+  RunBatch(batch);
+  ASSERT_EQ(batch.Size(), 0u);
+}
+
+TEST(pid_batch, benchmark_4k_vehicles) {
+  constexpr size_t number_of_iterations = 1000u;
+  PID::ActuationBatch batch = MakeRandomBatch(NUMBER_OF_VEHICLES);
+  std::vector<float> output(3u * NUMBER_OF_VEHICLES);
+
+  carla::StopWatch scalar_watch;
+  for (size_t n = 0u; n < number_of_iterations; ++n) {
+    for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+      RunStepReference(batch, i, output[3u * i], output[3u * i + 1u], output[3u * i + 2u]);
+    }
+  }
+  scalar_watch.Stop();
+
+  carla::StopWatch batch_watch;
+  for (size_t n = 0u; n < number_of_iterations; ++n) {
+    RunBatch(batch);
+  }
+  batch_watch.Stop();
+
+  const auto scalar_time = scalar_watch.GetElapsedTime<std::chrono::microseconds>();
+  const auto batch_time = batch_watch.GetElapsedTime<std::chrono::microseconds>();
+  std::cout << "PID for " << NUMBER_OF_VEHICLES << " vehicles: scalar "
+            << static_cast<double>(scalar_time) / number_of_iterations << "us, batched "
+            << static_cast<double>(batch_time) / number_of_iterations << "us per cycle" << std::endl;
+  // 结果需要被使用，避免编译器优化掉参照计算
+  ASSERT_FALSE(std::isnan(output[0]));
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/BoundedTaskQueue.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+
+using carla::BoundedTaskQueue;
+
+// 所有的任务都会执行，Wait 返回时队列为空。
+TEST(bounded_task_queue, runs_every_task) {
+  BoundedTaskQueue queue(8u, 3u);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.Push([&]() { ++count; }, true));
+  }
+  queue.Wait();
+  ASSERT_EQ(count.load(), 100);
+  const auto statistics = queue.GetStatistics();
+  ASSERT_EQ(statistics.pending, 0u);
+  ASSERT_EQ(statistics.completed, 100u);
+  ASSERT_EQ(statistics.dropped, 0u);
+}
+
+// 队列满时不阻塞的 Push 丢弃任务，并计入统计。
+TEST(bounded_task_queue, drops_when_full) {
+  BoundedTaskQueue queue(2u, 1u);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::promise<void> started;
+  ASSERT_TRUE(queue.Push([&]() { started.set_value(); released.wait(); }, false));
+  started.get_future().wait();
+  ASSERT_TRUE(queue.Push([]() {}, false));
+  ASSERT_TRUE(queue.Push([]() {}, false));
+  ASSERT_FALSE(queue.Push([]() {}, false));
+  auto statistics = queue.GetStatistics();
+  ASSERT_EQ(statistics.pending, 3u);
+  ASSERT_EQ(statistics.dropped, 1u);
+  release.set_value();
+  queue.Wait();
+  statistics = queue.GetStatistics();
+  ASSERT_EQ(statistics.pending, 0u);
+  ASSERT_EQ(statistics.completed, 3u);
+}
+
+// 任务的异常不会传播，只记录下来。
+TEST(bounded_task_queue, failures) {
+  BoundedTaskQueue queue(4u, 2u);
+  ASSERT_TRUE(queue.Push([]() { throw std::runtime_error("disk full"); }, true));
+  ASSERT_TRUE(queue.Push([]() {}, true));
+  queue.Wait();
+  const auto statistics = queue.GetStatistics();
+  ASSERT_EQ(statistics.completed, 2u);
+  ASSERT_EQ(statistics.failed, 1u);
+  ASSERT_EQ(statistics.last_error, "disk full");
+}
+
+// Stop 执行完剩余的任务，之后不再接受新任务。
+TEST(bounded_task_queue, stop_drains) {
+  std::atomic<int> count{0};
+  BoundedTaskQueue queue(16u, 1u);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.Push([&]() { ++count; }, true));
+  }
+  queue.Stop();
+  ASSERT_EQ(count.load(), 10);
+  ASSERT_FALSE(queue.Push([&]() { ++count; }, true));
+  ASSERT_EQ(count.load(), 10);
+}
@@ -139,3 +139,66 @@ TEST(buffer, buffer_pool) {
   // 现在清空缓存池来测试缓存里面的弱引用
   pool.reset();
 }
+
+// 测试缓冲区池按容量分组，小的缓冲区不会被用于大的数据
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto small = pool->Pop(16u);
+    small.reset(16u);
+    auto big = pool->Pop(1024u * 1024u);
+    big.reset(1024u * 1024u);
+  }
+  auto big = pool->Pop(1000u * 1000u);
+  ASSERT_GE(big.capacity(), 1000u * 1000u);
+  auto small = pool->Pop(10u);
+  ASSERT_GE(small.capacity(), 10u);
+  ASSERT_LT(small.capacity(), 1024u);
+  auto other = pool->Pop(1024u * 1024u);
+  ASSERT_EQ(other.capacity(), 0u);
+
+  const auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.hits, 2u);
+  ASSERT_EQ(statistics.misses, 3u);
+  ASSERT_EQ(statistics.reallocations, 0u);
+  ASSERT_EQ(statistics.idle_bytes, 0u);
+}
+
+// 测试从池中取出的缓冲区容量不足时记录重新分配
+TEST(buffer, buffer_pool_reallocations) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto buff = pool->Pop();
+    buff.reset(16u);
+  }
+  {
+    auto buff = pool->Pop();
+    ASSERT_EQ(buff.capacity(), 16u);
+    buff.reset(1024u);
+  }
+  const auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.reallocations, 1u);
+  ASSERT_EQ(statistics.idle_bytes, 1024u);
+}
+
+// 测试空闲缓冲区超过容量上限时释放最大的缓冲区
+TEST(buffer, buffer_pool_trim) {
+  constexpr size_t max_idle_bytes = 4096u;
+  auto pool = std::make_shared<carla::BufferPool>(max_idle_bytes);
+  {
+    std::vector<Buffer> buffers;
+    for (auto size : {1024u, 1024u, 1024u, 65536u}) {
+      buffers.emplace_back(pool->Pop(size));
+      buffers.back().reset(size);
+    }
+  }
+  auto statistics = pool->GetStatistics();
+  ASSERT_LE(statistics.idle_bytes, max_idle_bytes);
+  ASSERT_EQ(statistics.idle_bytes, 3u * 1024u);
+  ASSERT_EQ(statistics.trimmed, 1u);
+
+  pool->SetMaxIdleBytes(1024u);
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.idle_bytes, 1024u);
+  ASSERT_EQ(statistics.trimmed, 3u);
+}
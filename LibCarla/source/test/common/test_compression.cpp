@@ -0,0 +1,145 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/sensor/s11n/Compression.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/sensor/s11n/VideoStream.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace carla::sensor::s11n;
+
+// 压缩后再解压得到与原消息相同的数据，数据头中的压缩标志被清除
+TEST(compression, deflate_roundtrip) {
+  using Header = SensorHeaderSerializer::Header;
+  Header header{};
+  header.sensor_type = 7u;
+  header.frame = 42u;
+  header.timestamp = 1.5;
+  SensorHeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::Deflate));
+  ASSERT_EQ(SensorHeaderSerializer::GetSensorTypeId(header), 7u);
+  ASSERT_EQ(SensorHeaderSerializer::GetCompression(header), 1u);
+
+  // 两段负载，模拟图像的数据头与像素
+  std::vector<unsigned char> part0(64u, 'a');
+  std::vector<unsigned char> part1(1024u * 1024u);
+  for (auto i = 0u; i < part1.size(); ++i) {
+    part1[i] = static_cast<unsigned char>((i / 16u) % 251u);
+  }
+
+  auto payload = Compression::Compress(
+      CompressionType::Deflate,
+      {boost::asio::buffer(part0), boost::asio::buffer(part1)},
+      carla::Buffer{});
+  ASSERT_FALSE(payload.empty());
+  ASSERT_LT(payload.size(), part0.size() + part1.size());
+
+  carla::Buffer message;
+  message.copy_from(sizeof(header), payload);
+  std::memcpy(message.data(), &header, sizeof(header));
+  ASSERT_EQ(Compression::GetUncompressedSize(message), part0.size() + part1.size());
+
+  auto result = Compression::Decompress(std::move(message));
+  ASSERT_EQ(result.size(), sizeof(header) + part0.size() + part1.size());
+  const auto &result_header = SensorHeaderSerializer::Deserialize(result);
+  ASSERT_EQ(result_header.sensor_type, 7u);
+  ASSERT_EQ(result_header.frame, 42u);
+  ASSERT_EQ(std::memcmp(result.data() + sizeof(header), part0.data(), part0.size()), 0);
+  ASSERT_EQ(std::memcmp(result.data() + sizeof(header) + part0.size(), part1.data(), part1.size()), 0);
+}
+
+// 未压缩的消息原样返回
+TEST(compression, uncompressed_passthrough) {
+  SensorHeaderSerializer::Header header{};
+  header.sensor_type = 3u;
+  carla::Buffer message(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+  const auto *data = message.data();
+  auto result = Compression::Decompress(std::move(message));
+  ASSERT_EQ(result.data(), data);
+  ASSERT_EQ(result.size(), sizeof(header));
+}
+
+TEST(compression, from_string) {
+  CompressionType compression;
+  ASSERT_TRUE(Compression::FromString("deflate", compression));
+  ASSERT_EQ(compression, CompressionType::Deflate);
+  ASSERT_TRUE(Compression::FromString("none", compression));
+  ASSERT_EQ(compression, CompressionType::None);
+  ASSERT_TRUE(Compression::FromString("video", compression));
+  ASSERT_EQ(compression, CompressionType::Video);
+  ASSERT_FALSE(Compression::FromString("lz4", compression));
+}
+
+// 将编码后的负载与数据头组成视频帧消息
+static carla::Buffer MakeVideoMessage(uint64_t frame, const carla::Buffer &payload) {
+  SensorHeaderSerializer::Header header{};
+  header.sensor_type = 5u;
+  header.frame = frame;
+  SensorHeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::Video));
+  carla::Buffer message;
+  message.copy_from(sizeof(header), payload);
+  std::memcpy(message.data(), &header, sizeof(header));
+  return message;
+}
+
+// 逐帧编码再解码得到原来的帧，只有少量像素变化的帧远小于关键帧
+TEST(compression, video_roundtrip) {
+  DeltaVideoEncoder encoder(10u);
+  DeltaVideoDecoder decoder;
+  std::vector<unsigned char> image(256u * 256u * 4u);
+  // 伪随机的像素，关键帧几乎无法压缩
+  uint32_t state = 12345u;
+  for (auto &pixel : image) {
+    state = state * 1664525u + 1013904223u;
+    pixel = static_cast<unsigned char>(state >> 24u);
+  }
+  size_t keyframe_size = 0u;
+  for (auto frame = 0u; frame < 25u; ++frame) {
+    image[(frame * 4099u) % image.size()] ^= 0x5Au;
+    auto payload = encoder.Encode({boost::asio::buffer(image)}, carla::Buffer{});
+    ASSERT_FALSE(payload.empty());
+    if (frame == 0u) {
+      keyframe_size = payload.size();
+    } else if (frame % 10u != 0u) {
+      ASSERT_LT(payload.size() * 10u, keyframe_size);
+    }
+    auto result = decoder.Decode(MakeVideoMessage(frame, payload));
+    ASSERT_EQ(result.size(), sizeof(SensorHeaderSerializer::Header) + image.size());
+    const auto &header = SensorHeaderSerializer::Deserialize(result);
+    ASSERT_EQ(SensorHeaderSerializer::GetCompression(header), 0u);
+    ASSERT_EQ(header.frame, frame);
+    ASSERT_EQ(std::memcmp(result.data() + sizeof(header), image.data(), image.size()), 0);
+  }
+}
+
+// 中途订阅的解码器在第一个关键帧之前不输出帧，丢失帧之后等待下一个关键帧
+TEST(compression, video_waits_for_keyframe) {
+  DeltaVideoEncoder encoder(0u);
+  DeltaVideoDecoder decoder;
+  std::vector<unsigned char> image(1024u, 1u);
+  std::vector<carla::Buffer> messages;
+  for (auto frame = 0u; frame < 4u; ++frame) {
+    image[frame] = 2u;
+    if (frame == 2u) {
+      encoder.RequestKeyframe();
+    }
+    messages.emplace_back(MakeVideoMessage(frame, encoder.Encode({boost::asio::buffer(image)}, carla::Buffer{})));
+  }
+  // 没有收到第 0 帧（关键帧）
+  ASSERT_TRUE(decoder.Decode(std::move(messages[1u])).empty());
+  // 第 2 帧是请求的关键帧
+  auto keyframe = decoder.Decode(std::move(messages[2u]));
+  ASSERT_FALSE(keyframe.empty());
+  auto result = decoder.Decode(std::move(messages[3u]));
+  ASSERT_EQ(std::memcmp(result.data() + sizeof(SensorHeaderSerializer::Header), image.data(), image.size()), 0);
+  // 视频帧不能单独解压
+  DeltaVideoEncoder other(0u);
+  ASSERT_ANY_THROW(Compression::Decompress(MakeVideoMessage(0u, other.Encode({boost::asio::buffer(image)}, carla::Buffer{}))));
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::s11n::EpisodeStateSerializer;
+
+// 只有变化超过阈值的参与者才会被写入增量消息。
+TEST(episode_state, delta_has_changed) {
+  ActorDynamicState a{};
+  a.id = 1u;
+  a.transform = carla::geom::Transform{carla::geom::Location{1.0f, 2.0f, 3.0f}};
+  ActorDynamicState b = a;
+  ASSERT_FALSE(EpisodeStateSerializer::HasChanged(a, b, 1e-3f));
+
+  b.transform.location.x += 1e-4f;
+  ASSERT_FALSE(EpisodeStateSerializer::HasChanged(a, b, 1e-3f));
+  ASSERT_TRUE(EpisodeStateSerializer::HasChanged(a, b, 0.0f));
+
+  b = a;
+  b.velocity.z = 0.5f;
+  ASSERT_TRUE(EpisodeStateSerializer::HasChanged(a, b, 1e-3f));
+
+  b = a;
+  b.state.traffic_light_data.state = carla::rpc::TrafficLightState::Green;
+  ASSERT_TRUE(EpisodeStateSerializer::HasChanged(a, b, 1e-3f));
+
+  b = a;
+  b.id = 2u;
+  ASSERT_TRUE(EpisodeStateSerializer::HasChanged(a, b, 1e-3f));
+}
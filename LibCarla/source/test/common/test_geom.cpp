@@ -9,7 +9,12 @@
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/BoundingBox.h>
+#include <carla/geom/CameraProjection.h>
 #include <carla/geom/Transform.h>
+#include <carla/geom/Mesh.h>
+#include <carla/geom/Rtree.h>
+#include <carla/geom/Simplification.h>
+#include <cmath>
 #include <limits>
 // 定义一个名为carla的命名空间，用于组织相关的代码和类型
 namespace carla {
@@ -349,3 +354,193 @@ TEST(geom, nearest_point_arc) {
       1.0f,  // 预期的距离值
       0.01f);  // 容忍的误差范围
 }
+
+// 每个四边形使用各自的 4 个顶点的网格，焊接后应与共享顶点的网格相同。
+TEST(geom, simplification_generate_lods) {
+  constexpr size_t N = 32u;
+  Mesh mesh;
+  for (size_t i = 0u; i < N; ++i) {
+    for (size_t j = 0u; j < N; ++j) {
+      const size_t first = mesh.GetVerticesNum() + 1u;
+      for (size_t k = 0u; k < 4u; ++k) {
+        const float x = static_cast<float>(i + k % 2u);
+        const float y = static_cast<float>(j + k / 2u);
+        mesh.AddVertex(Vector3D(x, y, 0.1f * std::sin(0.3f * x) * std::cos(0.2f * y)));
+      }
+      for (size_t index : {first, first + 1u, first + 2u, first + 1u, first + 3u, first + 2u}) {
+        mesh.AddIndex(index);
+      }
+    }
+  }
+
+  const auto lods = Simplification::GenerateLODs(mesh, {0.5f, 0.25f, 0.1f});
+  ASSERT_EQ(lods.size(), 4u);
+  // 焊接后顶点数为 (N + 1)²，三角形不变
+  ASSERT_EQ(lods[0]->GetVerticesNum(), (N + 1u) * (N + 1u));
+  ASSERT_EQ(lods[0]->GetIndexes().size(), mesh.GetIndexes().size());
+  for (size_t l = 0u; l < lods.size(); ++l) {
+    const auto &indexes = lods[l]->GetIndexes();
+    ASSERT_EQ(indexes.size() % 3u, 0u);
+    ASSERT_FALSE(indexes.empty());
+    for (size_t index : indexes) {
+      ASSERT_GE(index, 1u);
+      ASSERT_LE(index, lods[l]->GetVerticesNum());
+    }
+    if (l > 0u) {
+      ASSERT_LT(indexes.size(), lods[l - 1u]->GetIndexes().size());
+      ASSERT_LE(lods[l]->GetVerticesNum(), lods[l - 1u]->GetVerticesNum());
+    }
+  }
+}
+
+// 批量变换的结果与逐点变换相同（允许浮点运算顺序带来的误差）。
+TEST(geom, batched_transform_points_and_world_vertices) {
+  constexpr size_t count = 37u;
+  std::vector<Transform> transforms;
+  std::vector<BoundingBox> boxes;
+  std::vector<float> x, y, z;
+  for (size_t i = 0u; i < count; ++i) {
+    const float f = static_cast<float>(i);
+    transforms.emplace_back(
+        Location(10.0f * f, -3.0f * f, 0.5f * f),
+        Rotation(7.0f * f - 60.0f, 23.0f * f, 180.0f - 11.0f * f));
+    boxes.emplace_back(
+        Location(0.1f * f, 0.2f, -0.3f * f),
+        Vector3D(1.0f + 0.1f * f, 2.0f, 0.5f + 0.05f * f),
+        Rotation(3.0f * f, -5.0f * f, 2.0f * f));
+    x.push_back(f - 20.0f);
+    y.push_back(0.5f * f * f);
+    z.push_back(-f);
+  }
+
+  for (const auto &transform : transforms) {
+    auto tx = x, ty = y, tz = z;
+    transform.TransformPoints(tx.data(), ty.data(), tz.data(), count);
+    auto ix = tx, iy = ty, iz = tz;
+    transform.InverseTransformPoints(ix.data(), iy.data(), iz.data(), count);
+    for (size_t i = 0u; i < count; ++i) {
+      Vector3D point(x[i], y[i], z[i]);
+      transform.TransformPoint(point);
+      ASSERT_NEAR(tx[i], point.x, 1e-3f);
+      ASSERT_NEAR(ty[i], point.y, 1e-3f);
+      ASSERT_NEAR(tz[i], point.z, 1e-3f);
+      ASSERT_NEAR(ix[i], x[i], 1e-3f);
+      ASSERT_NEAR(iy[i], y[i], 1e-3f);
+      ASSERT_NEAR(iz[i], z[i], 1e-3f);
+    }
+  }
+
+  std::vector<float> vx(8u * count), vy(8u * count), vz(8u * count);
+  BoundingBox::GetWorldVertices(boxes.data(), transforms.data(), count, vx.data(), vy.data(), vz.data());
+  for (size_t i = 0u; i < count; ++i) {
+    const auto expected = boxes[i].GetWorldVertices(transforms[i]);
+    for (size_t k = 0u; k < 8u; ++k) {
+      ASSERT_NEAR(vx[8u * i + k], expected[k].x, 1e-3f);
+      ASSERT_NEAR(vy[8u * i + k], expected[k].y, 1e-3f);
+      ASSERT_NEAR(vz[8u * i + k], expected[k].z, 1e-3f);
+    }
+  }
+}
+
+TEST(geom, camera_projection) {
+  const Transform camera(Location(2.0f, -1.0f, 1.5f), Rotation(-10.0f, 30.0f, 5.0f));
+  const Transform lidar(Location(1.0f, 0.0f, 2.4f), Rotation(0.0f, 20.0f, 0.0f));
+  const CameraProjection projection(camera, 800u, 600u, 90.0f);
+  ASSERT_NEAR(projection.GetFocalLength(), 400.0f, 1e-3f);
+
+  // 超过一个线程的点数，包括相机后方的点
+  const size_t count = 3u * CameraProjection::MinPointsPerThread + 17u;
+  std::vector<float> points(4u * count);
+  for (size_t i = 0u; i < count; ++i) {
+    const float f = static_cast<float>(i % 997u);
+    points[4u * i] = 0.05f * f - 10.0f;
+    points[4u * i + 1u] = std::sin(f) * 20.0f;
+    points[4u * i + 2u] = std::cos(0.3f * f) * 3.0f;
+    points[4u * i + 3u] = 1.0f;
+  }
+  std::vector<float> u(count), v(count), depth(count);
+  projection.ProjectPoints(lidar, points.data(), 4u, count, u.data(), v.data(), depth.data());
+  for (size_t i = 0u; i < count; i += 101u) {
+    Vector3D point(points[4u * i], points[4u * i + 1u], points[4u * i + 2u]);
+    lidar.TransformPoint(point);
+    camera.InverseTransformPoint(point);
+    ASSERT_NEAR(depth[i], point.x, 1e-3f);
+    if (point.x > 0.0f) {
+      ASSERT_NEAR(u[i], 400.0f + 400.0f * point.y / point.x, 1e-2f * (1.0f + std::abs(u[i])));
+      ASSERT_NEAR(v[i], 300.0f - 400.0f * point.z / point.x, 1e-2f * (1.0f + std::abs(v[i])));
+    } else {
+      ASSERT_TRUE(std::isnan(u[i]));
+      ASSERT_TRUE(std::isnan(v[i]));
+    }
+  }
+
+  // 深度图中每个像素保留最近的点
+  std::vector<float> image(800u * 600u, 0.0f);
+  const size_t rendered = projection.RenderDepth(u.data(), v.data(), depth.data(), count, image.data());
+  ASSERT_GT(rendered, 0u);
+  for (size_t i = 0u; i < count; ++i) {
+    if (depth[i] > 0.0f && u[i] >= 0.0f && u[i] < 800.0f && v[i] >= 0.0f && v[i] < 600.0f) {
+      const float value = image[static_cast<size_t>(v[i]) * 800u + static_cast<size_t>(u[i])];
+      ASSERT_GT(value, 0.0f);
+      ASSERT_LE(value, depth[i]);
+    }
+  }
+
+  // 按坐标分别存放的世界空间中的点
+  const std::vector<float> x = {10.0f, 2.0f, -5.0f};
+  const std::vector<float> y = {3.0f, -1.0f, 0.0f};
+  const std::vector<float> z = {1.0f, 1.5f, 0.0f};
+  std::vector<float> wu(3u), wv(3u), wdepth(3u);
+  projection.ProjectWorldPoints(x.data(), y.data(), z.data(), 3u, wu.data(), wv.data(), wdepth.data());
+  for (size_t i = 0u; i < 3u; ++i) {
+    Vector3D point(x[i], y[i], z[i]);
+    camera.InverseTransformPoint(point);
+    ASSERT_NEAR(wdepth[i], point.x, 1e-3f);
+  }
+}
+
+TEST(geom, packed_rtree_nearest_neighbours) {
+  using Rtree = PointCloudRtree<size_t>;
+  std::vector<Rtree::TreeElement> elements;
+  std::vector<Vector3D> points;
+  uint32_t seed = 12345u;
+  const auto random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8u) / static_cast<float>(1u << 24u) * 1000.0f - 500.0f;
+  };
+  for (size_t i = 0u; i < 5'000u; ++i) {
+    points.emplace_back(random(), random(), random());
+    elements.emplace_back(Rtree::BPoint(points.back().x, points.back().y, points.back().z), i);
+  }
+  Rtree packed;
+  packed.Build(elements);
+  ASSERT_EQ(packed.GetTreeSize(), elements.size());
+  for (size_t i = 0u; i < 200u; ++i) {
+    const Vector3D query(random(), random(), random());
+    const auto result = packed.GetNearestNeighbours(Rtree::BPoint(query.x, query.y, query.z));
+    ASSERT_EQ(result.size(), 1u);
+    float best = std::numeric_limits<float>::max();
+    for (const auto &point : points) {
+      best = std::min(best, Math::DistanceSquared(point, query));
+    }
+    ASSERT_FLOAT_EQ(Math::DistanceSquared(points[result.front().second], query), best);
+  }
+
+  // Build 替换之前的元素
+  packed.Build({elements.begin(), elements.begin() + 10});
+  ASSERT_EQ(packed.GetTreeSize(), 10u);
+
+  using SegmentRtree = SegmentCloudRtree<size_t>;
+  std::vector<SegmentRtree::TreeElement> segments;
+  for (size_t i = 0u; i < 100u; ++i) {
+    const float x = static_cast<float>(i) * 10.0f;
+    segments.emplace_back(
+        SegmentRtree::BSegment(SegmentRtree::BPoint(x, 0.0f, 0.0f), SegmentRtree::BPoint(x + 10.0f, 0.0f, 0.0f)),
+        std::make_pair(i, i + 1u));
+  }
+  SegmentRtree segment_rtree;
+  segment_rtree.Build(segments);
+  const auto nearest = segment_rtree.GetNearestNeighbours(SegmentRtree::BPoint(455.0f, 3.0f, 0.0f));
+  ASSERT_EQ(nearest.size(), 1u);
+  ASSERT_EQ(nearest.front().second.first, 45u);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+
+#include <cstring>
+#include <vector>
+
+using carla::sensor::data::LidarData;
+using carla::sensor::data::LidarDetection;
+using carla::sensor::data::LidarPointLayout;
+using carla::sensor::s11n::LidarSerializer;
+
+// 两个通道：通道 0 的前两个点落在同一个体素里，通道 1 的点与通道 0 的第三个点
+// 同一个体素，合并后计入通道 0
+static void Fill(LidarData &data) {
+  data.SetLayout(LidarPointLayout::SoA);
+  data.ResetMemory({3u, 2u});
+  LidarDetection a(0.1f, 0.1f, 0.1f, 1.0f);
+  LidarDetection b(0.3f, 0.3f, 0.3f, 0.0f);
+  LidarDetection c(5.1f, 0.1f, 0.1f, 1.0f);
+  LidarDetection d(5.2f, 0.2f, 0.2f, 1.0f);
+  LidarDetection e(-0.1f, 0.1f, 0.1f, 0.5f);
+  data.WritePointSync(a, 1u);
+  data.WritePointSync(b, 2u);
+  data.WritePointSync(c, 3u);
+  data.WritePointSync(d, 4u);
+  data.WritePointSync(e, 5u);
+  data.WriteChannelCount({3u, 2u});
+}
+
+static std::vector<float> ReadFloats(const carla::Buffer &buffer, size_t offset, size_t count) {
+  std::vector<float> result(count);
+  std::memcpy(result.data(), buffer.data() + offset, sizeof(float) * count);
+  return result;
+}
+
+TEST(lidar_columns, serialize_columns) {
+  LidarData data(2u);
+  Fill(data);
+  auto buffer = LidarSerializer::Serialize(0, data, carla::Buffer());
+  const size_t header = sizeof(uint32_t) * 4u;
+  ASSERT_EQ(buffer.size(), header + LidarSerializer::column_point_size * 5u);
+
+  uint32_t counts[2u];
+  std::memcpy(counts, buffer.data() + 2u * sizeof(uint32_t), sizeof(counts));
+  ASSERT_EQ(counts[0u], 3u);
+  ASSERT_EQ(counts[1u], 2u);
+
+  const auto x = ReadFloats(buffer, header, 5u);
+  ASSERT_EQ(x, (std::vector<float>{0.1f, 0.3f, 5.1f, 5.2f, -0.1f}));
+  const auto intensity = ReadFloats(buffer, header + 3u * sizeof(float) * 5u, 5u);
+  ASSERT_EQ(intensity, (std::vector<float>{1.0f, 0.0f, 1.0f, 1.0f, 0.5f}));
+  const unsigned char *tags = buffer.data() + header + 4u * sizeof(float) * 5u;
+  ASSERT_EQ(tags[0u], 1u);
+  ASSERT_EQ(tags[4u], 5u);
+}
+
+TEST(lidar_columns, voxel_grid) {
+  LidarData data(2u);
+  Fill(data);
+  data.DownsampleVoxelGrid(1.0f);
+  // (0.1, 0.1, 0.1) 和 (0.3, 0.3, 0.3) 合并；(-0.1, ...) 在另一个体素里
+  ASSERT_EQ(data.GetPointCount(), 3u);
+
+  auto buffer = LidarSerializer::Serialize(0, data, carla::Buffer());
+  const size_t header = sizeof(uint32_t) * 4u;
+  uint32_t counts[2u];
+  std::memcpy(counts, buffer.data() + 2u * sizeof(uint32_t), sizeof(counts));
+  ASSERT_EQ(counts[0u], 2u);
+  ASSERT_EQ(counts[1u], 1u);
+
+  const auto x = ReadFloats(buffer, header, 3u);
+  ASSERT_FLOAT_EQ(x[0u], 0.2f);
+  ASSERT_FLOAT_EQ(x[1u], 5.15f);
+  ASSERT_FLOAT_EQ(x[2u], -0.1f);
+  const auto intensity = ReadFloats(buffer, header + 3u * sizeof(float) * 3u, 3u);
+  ASSERT_FLOAT_EQ(intensity[0u], 0.5f);
+  const unsigned char *tags = buffer.data() + header + 4u * sizeof(float) * 3u;
+  ASSERT_EQ(tags[0u], 1u);
+  ASSERT_EQ(tags[1u], 3u);
+  ASSERT_EQ(tags[2u], 5u);
+}
+
+TEST(lidar_columns, voxel_grid_disabled) {
+  LidarData data(2u);
+  Fill(data);
+  data.DownsampleVoxelGrid(0.0f);
+  ASSERT_EQ(data.GetPointCount(), 5u);
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/profiler/Metrics.h>
+#include <carla/profiler/MetricsServer.h>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+
+#include <string>
+
+using carla::profiler::MetricsRegistry;
+
+static bool Contains(const std::string &text, const std::string &line) {
+  return text.find(line + "\n") != std::string::npos;
+}
+
+TEST(metrics, export_prometheus) {
+  MetricsRegistry registry;
+  auto counter = registry.GetCounter("test_calls_total", "Calls.", {{"function", "a\"b"}});
+  counter->Increment(3u);
+  ASSERT_EQ(registry.GetCounter("test_calls_total", "Calls.", {{"function", "a\"b"}}), counter);
+  auto gauge = registry.GetGauge("test_value", "Value.");
+  gauge->Set(1.5);
+  auto histogram = registry.GetHistogram("test_duration_seconds", "Duration.", {}, {0.1, 1.0});
+  histogram->Observe(0.05);
+  histogram->Observe(0.5);
+  histogram->Observe(5.0);
+  auto collector = registry.AddCollector([](MetricsRegistry::Writer &writer) {
+    writer.AddCounter("test_collected_total", "Collected.", {{"stream", "1"}}, 7.0);
+  });
+
+  const auto text = registry.ExportPrometheus();
+  ASSERT_TRUE(Contains(text, "# TYPE test_calls_total counter"));
+  ASSERT_TRUE(Contains(text, "test_calls_total{function=\"a\\\"b\"} 3"));
+  ASSERT_TRUE(Contains(text, "test_value 1.5"));
+  ASSERT_TRUE(Contains(text, "# TYPE test_duration_seconds histogram"));
+  ASSERT_TRUE(Contains(text, "test_duration_seconds_bucket{le=\"0.1\"} 1"));
+  ASSERT_TRUE(Contains(text, "test_duration_seconds_bucket{le=\"1\"} 2"));
+  ASSERT_TRUE(Contains(text, "test_duration_seconds_bucket{le=\"+Inf\"} 3"));
+  ASSERT_TRUE(Contains(text, "test_duration_seconds_sum 5.55"));
+  ASSERT_TRUE(Contains(text, "test_duration_seconds_count 3"));
+  ASSERT_TRUE(Contains(text, "test_collected_total{stream=\"1\"} 7"));
+}
+
+// 指标由持有者决定生命周期，销毁后不再导出。
+TEST(metrics, lifetime) {
+  MetricsRegistry registry;
+  auto counter = registry.GetCounter("test_stream_bytes_total", "Bytes.", {{"stream", "1"}});
+  auto collector = registry.AddCollector([](MetricsRegistry::Writer &writer) {
+    writer.AddGauge("test_collected", "Collected.", {}, 1.0);
+  });
+  ASSERT_NE(registry.ExportPrometheus().find("test_stream_bytes_total"), std::string::npos);
+  counter.reset();
+  collector.reset();
+  ASSERT_EQ(registry.ExportPrometheus(), "");
+  ASSERT_EQ(registry.GetCounter("test_stream_bytes_total", "Bytes.", {{"stream", "1"}})->Get(), 0u);
+}
+
+static std::string HttpGet(uint16_t port, const std::string &path) {
+  using boost::asio::ip::tcp;
+  boost::asio::io_context io_context;
+  tcp::socket socket(io_context);
+  socket.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+  const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+  std::string response;
+  boost::system::error_code ec;
+  boost::asio::read(socket, boost::asio::dynamic_buffer(response), ec);
+  return response;
+}
+
+TEST(metrics, server) {
+  MetricsRegistry registry;
+  auto counter = registry.GetCounter("test_requests_total", "Requests.");
+  counter->Increment();
+  carla::profiler::MetricsServer server(0u, registry);
+  const auto response = HttpGet(server.GetPort(), "/metrics");
+  ASSERT_EQ(response.substr(0u, 15u), "HTTP/1.1 200 OK");
+  ASSERT_TRUE(Contains(response, "test_requests_total 1"));
+  ASSERT_EQ(HttpGet(server.GetPort(), "/other").substr(0u, 12u), "HTTP/1.1 404");
+}
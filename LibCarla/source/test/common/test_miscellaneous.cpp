@@ -6,8 +6,49 @@
 
 #include "test.h"
 
+#include <carla/ContentHash.h>
+#include <carla/ThreadSettings.h>
 #include <carla/Version.h>
 
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, content_hash_in_chunks) {
+  using carla::ContentHash;
+  const std::string data = "content hashed in several chunks";
+  uint64_t hash = ContentHash::InitialValue();
+  for (size_t offset = 0u; offset < data.size(); offset += 5u) {
+    const auto count = std::min<size_t>(5u, data.size() - offset);
+    hash = ContentHash::ComputeValue(data.data() + offset, count, hash);
+  }
+  ASSERT_EQ(hash, ContentHash::ComputeValue(data.data(), data.size()));
+  ASSERT_EQ(ContentHash::Format(hash, data.size()), ContentHash::Compute(data));
+  ASSERT_NE(ContentHash::Compute(data), ContentHash::Compute(data.substr(1u)));
+}
+
+TEST(miscellaneous, thread_settings_parsing) {
+  using carla::ThreadSettings;
+  std::vector<size_t> cpus;
+  ASSERT_TRUE(ThreadSettings::ParseCpuList("0-3, 8,2", cpus));
+  ASSERT_EQ(cpus, (std::vector<size_t>{0u, 1u, 2u, 3u, 8u}));
+  ASSERT_TRUE(ThreadSettings::ParseCpuList("5", cpus));
+  ASSERT_EQ(cpus, (std::vector<size_t>{5u}));
+  // 无效的列表不修改结果
+  ASSERT_FALSE(ThreadSettings::ParseCpuList("", cpus));
+  ASSERT_FALSE(ThreadSettings::ParseCpuList("3-1", cpus));
+  ASSERT_FALSE(ThreadSettings::ParseCpuList("a,b", cpus));
+  ASSERT_FALSE(ThreadSettings::ParseCpuList("1,,2", cpus));
+  ASSERT_EQ(cpus, (std::vector<size_t>{5u}));
+
+  carla::ThreadPriority priority = carla::ThreadPriority::Normal;
+  ASSERT_TRUE(ThreadSettings::ParsePriority("High", priority));
+  ASSERT_EQ(priority, carla::ThreadPriority::High);
+  ASSERT_TRUE(ThreadSettings::ParsePriority("low", priority));
+  ASSERT_EQ(priority, carla::ThreadPriority::Low);
+  ASSERT_FALSE(ThreadSettings::ParsePriority("realtime", priority));
+  ASSERT_EQ(priority, carla::ThreadPriority::Low);
+
+  ASSERT_TRUE(ThreadSettings{}.IsDefault());
+  ASSERT_TRUE(ThreadSettings{}.ApplyToCurrentThread());
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/MonotonicArena.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using carla::ArenaAllocator;
+using carla::MonotonicArena;
+
+// 分配满足对齐要求，空间不足时按倍数增加新块。
+TEST(monotonic_arena, allocate) {
+  MonotonicArena arena(64u);
+  ASSERT_EQ(arena.GetNumberOfBlocks(), 1u);
+  for (size_t alignment : {1u, 2u, 4u, 8u, 16u, 64u}) {
+    auto *pointer = arena.Allocate(3u, alignment);
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(pointer) % alignment, 0u);
+  }
+  ASSERT_EQ(arena.GetAllocatedBytes(), 18u);
+  arena.Allocate(1000u);
+  ASSERT_GE(arena.GetCapacity(), 1064u);
+  const size_t blocks = arena.GetNumberOfBlocks();
+  for (int i = 0; i < 1000; ++i) {
+    arena.Allocate(8u);
+  }
+  ASSERT_LE(arena.GetNumberOfBlocks(), blocks + 4u);
+
+  MonotonicArena empty;
+  ASSERT_EQ(empty.GetCapacity(), 0u);
+  ASSERT_NE(empty.Allocate(1u), nullptr);
+}
+
+TEST(monotonic_arena, containers) {
+  MonotonicArena arena;
+  using Map = std::unordered_map<
+      int, std::vector<int>, std::hash<int>, std::equal_to<int>,
+      ArenaAllocator<std::pair<const int, std::vector<int>>>>;
+  Map map{Map::allocator_type(arena)};
+  for (int i = 0; i < 1000; ++i) {
+    map[i].push_back(i);
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    map.erase(i);
+  }
+  ASSERT_EQ(map.size(), 500u);
+  ASSERT_EQ(map.at(999).front(), 999);
+  ASSERT_GT(arena.GetAllocatedBytes(), 500u * sizeof(Map::value_type));
+  ASSERT_TRUE(Map::allocator_type(arena) == ArenaAllocator<int>(arena));
+}
@@ -7,7 +7,12 @@
 #include "test.h"
 #include <carla/MsgPackAdaptors.h>
 #include <carla/rpc/Actor.h>
+#include <carla/rpc/ActorQuery.h>
+#include <carla/rpc/ActorQueryResult.h>
+#include <carla/rpc/ActorSpawnBatch.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/ResponseView.h>
+#include <carla/rpc/WalkerStates.h>
 // 引入线程相关的头文件，可能在测试中用于模拟并发场景
 #include <thread>
 // 使用 carla::rpc 命名空间
@@ -74,6 +79,93 @@ TEST(msgpack, actor) {
   ASSERT_EQ(result.description.id, actor.description.id);
   ASSERT_EQ(result.bounding_box, actor.bounding_box);
 }
+// 测试 MsgPack 对按列存储的演员查询结果的序列化和反序列化功能
+TEST(msgpack, actor_query) {
+  namespace c = carla;
+  namespace cg = carla::geom;
+  ActorQuery query;
+  query.actor_ids = {1u, 2u, 3u};
+  query.type_id_filter = "vehicle.*";
+  query.radius = 50.0f;
+  query.fields =
+      static_cast<ActorQueryFieldType>(ActorQueryField::Transform) |
+      static_cast<ActorQueryFieldType>(ActorQueryField::Velocity);
+  auto unpacked_query = c::MsgPack::UnPack<ActorQuery>(c::MsgPack::Pack(query));
+  ASSERT_EQ(unpacked_query.actor_ids, query.actor_ids);
+  ASSERT_EQ(unpacked_query.type_id_filter, query.type_id_filter);
+  ASSERT_EQ(unpacked_query.radius, query.radius);
+  ASSERT_TRUE(unpacked_query.HasField(ActorQueryField::Velocity));
+  ASSERT_FALSE(unpacked_query.HasField(ActorQueryField::Attributes));
+
+  ActorQueryResult result;
+  result.fields = query.fields;
+  result.ids = query.actor_ids;
+  result.transforms.resize(3u, cg::Transform{cg::Location{1.0f, 2.0f, 3.0f}});
+  result.velocities.resize(3u, cg::Vector3D{4.0f, 5.0f, 6.0f});
+  auto unpacked_result = c::MsgPack::UnPack<ActorQueryResult>(c::MsgPack::Pack(result));
+  ASSERT_EQ(unpacked_result.size(), 3u);
+  ASSERT_EQ(unpacked_result.transforms, result.transforms);
+  ASSERT_EQ(unpacked_result.velocities, result.velocities);
+  ASSERT_TRUE(unpacked_result.type_ids.empty());
+}
+// 测试 MsgPack 对批量生成请求的序列化和反序列化功能
+TEST(msgpack, actor_spawn_batch) {
+  namespace c = carla;
+  namespace cg = carla::geom;
+  ActorSpawnBatch batch;
+  ActorDescription description;
+  description.uid = 7u;
+  description.id = "vehicle.tesla.model3";
+  const auto index = batch.AddDescription(description);
+  batch.Add(index, cg::Transform{cg::Location{1.0f, 2.0f, 3.0f}});
+  batch.Add(index, cg::Transform{cg::Location{4.0f, 5.0f, 6.0f}}, 42u, AttachmentType::SpringArm, "socket");
+  batch.validation_radius = 2.5f;
+  auto unpacked = c::MsgPack::UnPack<ActorSpawnBatch>(c::MsgPack::Pack(batch));
+  ASSERT_EQ(unpacked.descriptions.size(), 1u);
+  ASSERT_EQ(unpacked.descriptions[0u].id, description.id);
+  ASSERT_EQ(unpacked.descriptions[0u].uid, description.uid);
+  ASSERT_EQ(unpacked.entries.size(), 2u);
+  ASSERT_EQ(unpacked.entries[0u].parent, 0u);
+  ASSERT_EQ(unpacked.entries[1u].description, index);
+  ASSERT_EQ(unpacked.entries[1u].transform, batch.entries[1u].transform);
+  ASSERT_EQ(unpacked.entries[1u].parent, 42u);
+  ASSERT_EQ(unpacked.entries[1u].attachment_type, AttachmentType::SpringArm);
+  ASSERT_EQ(unpacked.entries[1u].socket_name, "socket");
+  ASSERT_EQ(unpacked.validation_radius, batch.validation_radius);
+}
+// 测试不复制数据地读取序列化后的 Response
+TEST(msgpack, response_view) {
+  namespace c = carla;
+  using string_view = c::MsgPackView::string_view;
+
+  Response<std::string> text{std::string("<OpenDRIVE/>")};
+  {
+    ResponseView view(c::MsgPackView::UnPack(c::MsgPack::Pack(text)));
+    ASSERT_FALSE(view.HasError());
+    // 值的视图持有 object_handle，ResponseView 销毁后仍然有效。
+    auto value = view.Get();
+    auto xml = value.AsStringView();
+    ASSERT_EQ(xml, string_view("<OpenDRIVE/>"));
+
+    Response<std::vector<uint8_t>> mesh{std::vector<uint8_t>{1u, 2u, 3u}};
+    auto bytes_view = ResponseView(c::MsgPackView::UnPack(c::MsgPack::Pack(mesh))).Get();
+    auto bytes = bytes_view.AsBytes();
+    ASSERT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()), mesh.Get());
+  }
+
+  Response<std::vector<std::string>> files{std::vector<std::string>{"a.xodr", "b.bin"}};
+  auto names = ResponseView(c::MsgPackView::UnPack(c::MsgPack::Pack(files))).Get();
+  auto name_views = names.AsStringViewArray();
+  ASSERT_EQ(name_views.size(), 2u);
+  ASSERT_EQ(name_views[0u], string_view("a.xodr"));
+  ASSERT_EQ(name_views[1u], string_view("b.bin"));
+
+  Response<std::string> error;
+  error.SetError("map not loaded");
+  ResponseView error_view(c::MsgPackView::UnPack(c::MsgPack::Pack(error)));
+  ASSERT_TRUE(error_view.HasError());
+  ASSERT_EQ(error_view.GetError().What(), "map not loaded");
+}
 // 测试 MsgPack 对 boost::variant 的序列化和反序列化功能
 TEST(msgpack, variant) {
   using mp = carla::MsgPack;
@@ -111,3 +203,20 @@ TEST(msgpack, optional) {
   ASSERT_TRUE(result.has_value());
   ASSERT_EQ(*result, 42.0f);
 }
+// 测试 MsgPack 对按列存储的行人状态的序列化和反序列化功能
+TEST(msgpack, walker_states) {
+  using mp = carla::MsgPack;
+  WalkerStates states;
+  states.Reserve(2u);
+  states.Add(7u, carla::geom::Transform{carla::geom::Location{1.0f, 2.0f, 3.0f}}, 1.5f);
+  states.Add(42u, carla::geom::Transform{}, 0.0f);
+  auto result = mp::UnPack<WalkerStates>(mp::Pack(states));
+  ASSERT_EQ(result.size(), 2u);
+  ASSERT_EQ(result.actors, states.actors);
+  ASSERT_EQ(result.transforms, states.transforms);
+  ASSERT_EQ(result.speeds, states.speeds);
+  // 清空后保留内存
+  result.clear();
+  ASSERT_TRUE(result.empty());
+  ASSERT_GE(result.transforms.capacity(), 2u);
+}
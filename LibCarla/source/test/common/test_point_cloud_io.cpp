@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/data/SemanticLidarData.h>
+
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <vector>
+
+using carla::pointcloud::PointCloudIO;
+using carla::sensor::data::SemanticLidarDetection;
+
+using Format = PointCloudIO::BinaryFormat;
+
+static std::vector<SemanticLidarDetection> MakeDetections(size_t count) {
+  std::vector<SemanticLidarDetection> detections;
+  for (size_t i = 0u; i < count; ++i) {
+    const auto value = static_cast<float>(i);
+    detections.emplace_back(value, -value, 0.5f * value, 0.25f, static_cast<uint32_t>(i), 7u);
+  }
+  return detections;
+}
+
+// PCD 的文件头之后直接是点的原始字节。
+TEST(point_cloud_io, pcd_binary) {
+  const auto detections = MakeDetections(10u);
+  std::ostringstream out;
+  PointCloudIO::DumpBinary(out, detections.data(), detections.data() + detections.size(), Format::Pcd);
+  const auto result = out.str();
+  const auto data_begin = result.find("DATA binary\n");
+  ASSERT_NE(data_begin, std::string::npos);
+  ASSERT_NE(result.find("TYPE F F F F U U\n"), std::string::npos);
+  ASSERT_NE(result.find("POINTS 10\n"), std::string::npos);
+  const auto header_size = data_begin + std::strlen("DATA binary\n");
+  ASSERT_EQ(result.size(), header_size + detections.size() * sizeof(SemanticLidarDetection));
+  ASSERT_EQ(std::memcmp(result.data() + header_size, detections.data(), result.size() - header_size), 0);
+}
+
+// 写入内存与写入流的结果相同，不连续存放的点也一样。
+TEST(point_cloud_io, write_binary_to_memory) {
+  const auto detections = MakeDetections(100u);
+  const std::list<SemanticLidarDetection> list(detections.begin(), detections.end());
+  for (auto format : {Format::Ply, Format::Pcd, Format::Npy}) {
+    std::ostringstream out;
+    PointCloudIO::DumpBinary(out, list.begin(), list.end(), format);
+    const auto expected = out.str();
+    const auto size = PointCloudIO::GetBinarySize(format, detections.begin(), detections.end());
+    ASSERT_EQ(size, expected.size());
+    std::vector<unsigned char> memory(size);
+    const auto written = PointCloudIO::WriteBinary(
+        format,
+        detections.data(),
+        detections.data() + detections.size(),
+        memory.data());
+    ASSERT_EQ(written, size);
+    ASSERT_EQ(std::memcmp(memory.data(), expected.data(), size), 0);
+  }
+}
+
+// 空的点云只有文件头。
+TEST(point_cloud_io, empty) {
+  const std::vector<SemanticLidarDetection> detections;
+  for (auto format : {Format::Ply, Format::Pcd, Format::Npy}) {
+    std::ostringstream out;
+    PointCloudIO::DumpBinary(out, detections.begin(), detections.end(), format);
+    ASSERT_EQ(out.str().size(), PointCloudIO::GetBinarySize(format, detections.begin(), detections.end()));
+  }
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/RandomGenerator.h>
+
+#include <vector>
+
+using carla::traffic_manager::RandomGenerator;
+using carla::traffic_manager::RandomStream;
+using carla::traffic_manager::RandomStreamId;
+
+static std::vector<double> Draw(RandomStream stream, size_t count) {
+  std::vector<double> result;
+  for (size_t i = 0u; i < count; ++i) {
+    result.push_back(stream.next());
+  }
+  return result;
+}
+
+// 同样的（种子、参与者、帧、用途）总是得到同样的序列，与其它流的使用无关。
+TEST(random_generator, streams_are_deterministic) {
+  RandomGenerator generator(42u);
+  generator.SetFrame(1000u);
+  const auto expected = Draw(generator.GetStream(7u, RandomStreamId::Collision), 16u);
+  Draw(generator.GetStream(8u, RandomStreamId::Collision), 100u);
+  generator.next();
+  ASSERT_EQ(Draw(generator.GetStream(7u, RandomStreamId::Collision), 16u), expected);
+  ASSERT_EQ(Draw(RandomStream(42u, 7u, 1000u, RandomStreamId::Collision), 16u), expected);
+}
+
+// 改变种子、参与者、帧或用途中的任意一个都得到不同的序列。
+TEST(random_generator, streams_are_independent) {
+  const auto reference = Draw(RandomStream(42u, 7u, 1000u, RandomStreamId::LaneChange), 4u);
+  ASSERT_NE(Draw(RandomStream(43u, 7u, 1000u, RandomStreamId::LaneChange), 4u), reference);
+  ASSERT_NE(Draw(RandomStream(42u, 8u, 1000u, RandomStreamId::LaneChange), 4u), reference);
+  ASSERT_NE(Draw(RandomStream(42u, 7u, 1001u, RandomStreamId::LaneChange), 4u), reference);
+  ASSERT_NE(Draw(RandomStream(42u, 7u, 1000u + (uint64_t{1} << 32u), RandomStreamId::LaneChange), 4u), reference);
+  ASSERT_NE(Draw(RandomStream(42u, 7u, 1000u, RandomStreamId::PathSelection), 4u), reference);
+}
+
+// 结果在 [0, 100) 中并且大致均匀分布。
+TEST(random_generator, stream_range) {
+  constexpr size_t count = 100000u;
+  RandomStream stream(1u, 2u, 3u, RandomStreamId::TrafficLight);
+  size_t below_half = 0u;
+  double sum = 0.0;
+  for (size_t i = 0u; i < count; ++i) {
+    const double value = stream.next();
+    ASSERT_GE(value, 0.0);
+    ASSERT_LT(value, 100.0);
+    sum += value;
+    if (value < 50.0) {
+      ++below_half;
+    }
+  }
+  ASSERT_NEAR(sum / count, 50.0, 1.0);
+  ASSERT_NEAR(static_cast<double>(below_half) / count, 0.5, 0.01);
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/RcuList.h>
+#include <carla/ThreadGroup.h>
+#include <carla/client/detail/CallbackList.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using carla::RcuList;
+
+static std::vector<int> ToVector(const RcuList<int> &list) {
+  std::vector<int> result;
+  list.ForEach([&](const int value) { result.push_back(value); });
+  return result;
+}
+
+TEST(rcu_list, modify) {
+  RcuList<int> list;
+  ASSERT_EQ(list.size(), 0u);
+  for (int i = 0; i < 5; ++i) {
+    list.Push(i);
+  }
+  ASSERT_EQ(ToVector(list), (std::vector<int>{0, 1, 2, 3, 4}));
+  list.DeleteByIndex(1u);
+  list.DeleteByValue(3);
+  ASSERT_EQ(ToVector(list), (std::vector<int>{0, 2, 4}));
+  list.Clear();
+  ASSERT_EQ(list.size(), 0u);
+}
+
+// 遍历中修改列表不影响本次遍历，也不会阻塞；回调抛出异常后列表仍可使用。
+TEST(rcu_list, modify_while_iterating) {
+  RcuList<int> list;
+  list.Push(1);
+  list.Push(2);
+  std::vector<int> seen;
+  list.ForEach([&](const int value) {
+    seen.push_back(value);
+    list.Push(10 * value);
+    list.DeleteByValue(value);
+  });
+  ASSERT_EQ(seen, (std::vector<int>{1, 2}));
+  ASSERT_EQ(ToVector(list), (std::vector<int>{10, 20}));
+  ASSERT_THROW(list.ForEach([](int) { throw std::runtime_error("failure"); }), std::runtime_error);
+  for (int i = 100; i < 200; ++i) {
+    list.Push(i);
+    list.DeleteByValue(i);
+  }
+  ASSERT_EQ(ToVector(list), (std::vector<int>{10, 20}));
+}
+
+// 并发的遍历总是看到某个完整的版本：元素按加入的顺序递增。
+TEST(rcu_list, concurrent_readers) {
+  RcuList<int> list;
+  std::atomic_bool done{false};
+  std::atomic_bool failed{false};
+  carla::ThreadGroup threads;
+  threads.CreateThreads(4u, [&]() {
+    while (!done) {
+      int previous = 0;
+      list.ForEach([&](const int value) {
+        if ((value <= previous) || (value >= 20'000)) {
+          failed = true;
+        }
+        previous = value;
+      });
+    }
+  });
+  for (int i = 1; i < 20'000; ++i) {
+    list.Push(i);
+    if (i % 3 == 0) {
+      list.DeleteByValue(i - 1);
+    }
+    if (i % 50 == 0) {
+      list.Clear();
+    }
+  }
+  done = true;
+  threads.JoinAll();
+  ASSERT_FALSE(failed);
+}
+
+TEST(rcu_list, callback_list) {
+  carla::client::detail::CallbackList<int> callbacks;
+  int sum = 0;
+  const auto first = callbacks.Push([&](int value) { sum += value; });
+  size_t second = 0u;
+  second = callbacks.Push([&](int value) {
+    sum += 10 * value;
+    callbacks.Remove(second);
+  });
+  callbacks.Call(1);
+  ASSERT_EQ(sum, 11);
+  callbacks.Call(1);
+  ASSERT_EQ(sum, 12);
+  callbacks.Remove(first);
+  callbacks.Call(1);
+  ASSERT_EQ(sum, 12);
+}
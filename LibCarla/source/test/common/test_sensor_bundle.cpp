@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/sensor/s11n/SensorBundleSerializer.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace carla::sensor::s11n;
+
+static std::vector<boost::asio::const_buffer> MakeMessage(const std::string &str) {
+  return {boost::asio::buffer(str)};
+}
+
+static carla::Buffer Concatenate(std::pair<carla::Buffer, carla::Buffer> &&bundle) {
+  carla::Buffer message;
+  message.copy_from(std::array<boost::asio::const_buffer, 2u>{
+      bundle.first.cbuffer(), bundle.second.cbuffer()});
+  return message;
+}
+
+static std::string AsString(const carla::Buffer &buffer) {
+  return std::string(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+}
+
+// 所有传感器送达同一帧后才生成组消息，拆分后按创建组时的顺序排列
+TEST(sensor_bundle, complete_frame) {
+  SensorBundleBuilder builder({10u, 20u, 30u});
+  const std::string a = "camera", b = "lidar", c = "imu";
+  ASSERT_FALSE(builder.Add(20u, 1u, MakeMessage(b)));
+  ASSERT_FALSE(builder.Add(30u, 1u, MakeMessage(c)));
+  ASSERT_FALSE(builder.Add(99u, 1u, MakeMessage(c)));
+  auto bundle = builder.Add(10u, 1u, MakeMessage(a));
+  ASSERT_TRUE(bundle);
+
+  auto parts = SensorBundleSerializer::Deserialize(Concatenate(std::move(*bundle)));
+  ASSERT_EQ(parts.size(), 3u);
+  ASSERT_EQ(parts[0u].first, 10u);
+  ASSERT_EQ(AsString(parts[0u].second), a);
+  ASSERT_EQ(parts[1u].first, 20u);
+  ASSERT_EQ(AsString(parts[1u].second), b);
+  ASSERT_EQ(parts[2u].first, 30u);
+  ASSERT_EQ(AsString(parts[2u].second), c);
+}
+
+// 帧可以交错到达，更旧的未完成帧在新帧完成时被丢弃
+TEST(sensor_bundle, interleaved_and_dropped_frames) {
+  SensorBundleBuilder builder({1u, 2u}, 2u);
+  const std::string big(1024u * 1024u, 'x');
+  ASSERT_FALSE(builder.Add(1u, 5u, MakeMessage("old")));
+  ASSERT_FALSE(builder.Add(1u, 6u, MakeMessage(big)));
+  ASSERT_FALSE(builder.Add(1u, 6u, MakeMessage("duplicate")));
+  auto bundle = builder.Add(2u, 6u, MakeMessage(big));
+  ASSERT_TRUE(bundle);
+  ASSERT_EQ(builder.GetDroppedFrames(), 1u);
+  auto parts = SensorBundleSerializer::Deserialize(Concatenate(std::move(*bundle)));
+  ASSERT_EQ(parts.size(), 2u);
+  ASSERT_EQ(AsString(parts[0u].second), big);
+  ASSERT_EQ(AsString(parts[1u].second), big);
+
+  // 超过未完成帧的上限时丢弃最旧的帧
+  ASSERT_FALSE(builder.Add(1u, 7u, MakeMessage("a")));
+  ASSERT_FALSE(builder.Add(1u, 8u, MakeMessage("b")));
+  ASSERT_FALSE(builder.Add(1u, 9u, MakeMessage("c")));
+  ASSERT_EQ(builder.GetDroppedFrames(), 2u);
+  ASSERT_FALSE(builder.Add(2u, 7u, MakeMessage("a")));
+  ASSERT_TRUE(builder.Add(2u, 9u, MakeMessage("c")));
+  ASSERT_EQ(builder.GetDroppedFrames(), 3u);
+}
+
+TEST(sensor_bundle, invalid_message) {
+  carla::Buffer message(std::string("\x05\x00\x00\x00", 4u));
+  ASSERT_THROW(SensorBundleSerializer::Deserialize(message), std::invalid_argument);
+}
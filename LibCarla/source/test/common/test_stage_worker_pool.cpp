@@ -0,0 +1,45 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/StageWorkerPool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using carla::traffic_manager::StageWorkerPool;
+
+// 每个索引恰好被调用一次，与线程数和元素个数无关。
+TEST(stage_worker_pool, every_index_once) {
+  for (size_t threads : {1u, 2u, 7u}) {
+    StageWorkerPool pool(threads);
+    ASSERT_EQ(pool.GetNumberOfThreads(), threads);
+    for (unsigned long count : {0ul, 1ul, 5ul, 1500ul}) {
+      std::vector<std::atomic<int>> calls(count);
+      pool.ParallelFor(count, [&](const unsigned long index) {
+        ++calls[index];
+      });
+      for (auto &&value : calls) {
+        ASSERT_EQ(value.load(), 1);
+      }
+    }
+  }
+}
+
+// 调用抛出的异常在所有线程结束后传回调用者，线程池之后仍可使用。
+TEST(stage_worker_pool, exception) {
+  StageWorkerPool pool(4u);
+  ASSERT_THROW(pool.ParallelFor(1000ul, [](const unsigned long index) {
+    if (index == 500ul) {
+      throw std::runtime_error("failure");
+    }
+  }), std::runtime_error);
+  std::atomic<unsigned long> sum{0u};
+  pool.ParallelFor(100ul, [&](const unsigned long index) { sum += index; });
+  ASSERT_EQ(sum.load(), 4950ul);
+}
@@ -10,8 +10,11 @@
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
+#include <carla/streaming/detail/shm/Publisher.h>
+#include <carla/streaming/detail/shm/SharedMemory.h>
 #include <carla/streaming/detail/tcp/Client.h>
 #include <carla/streaming/detail/tcp/Server.h>
+#include <carla/streaming/detail/udp/Reassembler.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
@@ -280,3 +283,305 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, scatter_gather_external_memory) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+  const std::string header = "header|";
+  const std::string sub_header = "image|";
+  const std::string pixels = "pixels";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t message_count{0u};
+  Client c;
+  c.AsyncRun(1u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    ASSERT_EQ(result, header + sub_header + pixels);
+    ++message_count;
+  });
+
+  // 外部内存通过持有者保持有效，不会复制到 Buffer 中
+  auto owner = std::make_shared<std::string>(pixels);
+  std::weak_ptr<std::string> weak_owner = owner;
+  {
+    auto HeaderView = carla::BufferView::CreateFrom(carla::Buffer(boost::asio::buffer(header)));
+    auto SubHeaderView = carla::BufferView::CreateFrom(carla::Buffer(boost::asio::buffer(sub_header)));
+    auto PixelsView = carla::BufferView::CreateFrom(
+        reinterpret_cast<const unsigned char *>(owner->data()),
+        static_cast<carla::BufferView::size_type>(owner->size()),
+        owner);
+    ASSERT_EQ(PixelsView->data(), reinterpret_cast<const unsigned char *>(owner->data()));
+    owner.reset();
+
+    std::this_thread::sleep_for(6ms);
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      std::this_thread::sleep_for(6ms);
+      carla::SharedBufferView View0 = HeaderView;
+      carla::SharedBufferView View1 = SubHeaderView;
+      carla::SharedBufferView View2 = PixelsView;
+      stream.Write(View0, View1, View2);
+    }
+    std::this_thread::sleep_for(6ms);
+  }
+
+  ASSERT_GE(message_count, number_of_messages - 3u);
+  // 所有消息发送完毕后外部内存被释放
+  std::this_thread::sleep_for(20ms);
+  ASSERT_TRUE(weak_owner.expired());
+}
+
+TEST(streaming, shared_memory_stream) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemoryMode(true);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  ASSERT_TRUE(detail::token_type(stream.token()).protocol_is_shm());
+
+  std::atomic_size_t message_count{0u};
+  std::atomic_size_t last_size{0u};
+  Client c;
+  c.AsyncRun(1u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    ASSERT_FALSE(result.empty());
+    ASSERT_EQ(result, std::string(result.size(), result.front()));
+    last_size = result.size();
+    ++message_count;
+  });
+
+  std::this_thread::sleep_for(6ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(6ms);
+    // 消息逐渐变大，超过槽的容量时需要重新创建共享内存段
+    const std::string message(1u + i * 64u * 1024u, static_cast<char>('a' + (i % 26u)));
+    carla::SharedBufferView View = carla::BufferView::CreateFrom(
+        carla::Buffer(boost::asio::buffer(message)));
+    stream.Write(View);
+  }
+  std::this_thread::sleep_for(20ms);
+
+  ASSERT_GE(message_count, number_of_messages - 3u);
+  ASSERT_EQ(last_size, 1u + (number_of_messages - 1u) * 64u * 1024u);
+}
+
+// 服务器崩溃后留下的同名段不影响新的服务器创建段
+TEST(streaming, shared_memory_stale_segment) {
+  using namespace carla::streaming::detail::shm;
+  if (!SharedMemory::IsSupported()) {
+    return;
+  }
+  const auto name = SharedMemory::MakePrefix(TESTING_PORT, 0u) + "-test";
+  auto stale = SharedMemory::Create(name, 4096u);
+  ASSERT_NE(stale, nullptr);
+  ASSERT_NE(stale->name(), std::string());
+  // 不销毁旧对象，模拟崩溃后没有解除链接的段
+  auto fresh = SharedMemory::Create(name, 8192u);
+  ASSERT_NE(fresh, nullptr);
+  ASSERT_EQ(fresh->size(), 8192u);
+  auto reader = SharedMemory::Open(name);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(reader->size(), 8192u);
+}
+
+TEST(streaming, shared_memory_number_of_slots) {
+  using namespace carla::streaming::detail::shm;
+  ASSERT_THROW(Publisher("/carla-test", 0u), std::invalid_argument);
+  ASSERT_THROW(Publisher("/carla-test", MAX_NUMBER_OF_SLOTS + 1u), std::invalid_argument);
+  Publisher publisher("/carla-test", MAX_NUMBER_OF_SLOTS);
+}
+
+TEST(streaming, large_messages_keep_content) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 40u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t message_count{0u};
+  std::atomic_bool has_errors{false};
+  Client c;
+  c.AsyncRun(1u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    if (result.empty() || (result != std::string(result.size(), result.front()))) {
+      has_errors = true;
+    }
+    ++message_count;
+  });
+
+  std::this_thread::sleep_for(6ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(4ms);
+    // 足够大的消息在启用零拷贝时不经过复制发送，发送后立即复用缓冲区不得影响已发送的数据
+    auto buffer = stream.MakeBuffer();
+    buffer.reset(static_cast<carla::Buffer::size_type>(256u * 1024u + i));
+    std::memset(buffer.data(), 'a' + static_cast<int>(i % 26u), buffer.size());
+    stream.Write(carla::BufferView::CreateFrom(std::move(buffer)));
+  }
+  std::this_thread::sleep_for(50ms);
+
+  ASSERT_FALSE(has_errors);
+  ASSERT_GE(message_count, number_of_messages - 3u);
+}
+
+TEST(streaming, multicast_stream) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+
+  Server srv(TESTING_PORT);
+  detail::udp::MulticastSettings settings;
+  settings.fragment_size = 1000u;
+  settings.fec_group_size = 4u;
+  srv.SetMulticastGroup("239.255.76.67", 52101u, settings);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  const auto stream_id = detail::token_type(stream.token()).get_stream_id();
+  ASSERT_TRUE(srv.EnableMulticast(stream_id));
+  const detail::token_type token = srv.GetToken(stream_id);
+  ASSERT_TRUE(token.protocol_is_udp());
+  ASSERT_EQ(token.get_stream_id(), stream_id);
+
+  std::atomic_size_t message_count{0u};
+  Client c;
+  c.AsyncRun(1u);
+  try {
+    c.Subscribe(token, [&](auto buffer) {
+      const std::string result = as_string(buffer);
+      ASSERT_FALSE(result.empty());
+      ASSERT_EQ(result, std::string(result.size(), result.front()));
+      ++message_count;
+    });
+  } catch (const std::exception &e) {
+    // 沙盒等环境中可能没有支持组播的网络接口
+    carla::log_warning("multicast not available, skipping test:", e.what());
+    return;
+  }
+
+  std::this_thread::sleep_for(6ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    const std::string message(1u + i * 997u, static_cast<char>('a' + (i % 26u)));
+    carla::SharedBufferView View = carla::BufferView::CreateFrom(
+        carla::Buffer(boost::asio::buffer(message)));
+    stream.Write(View);
+  }
+  std::this_thread::sleep_for(20ms);
+
+  ASSERT_GE(message_count, number_of_messages - 3u);
+}
+
+TEST(streaming, multicast_reassembler_recovers_fragment) {
+  using namespace carla::streaming::detail::udp;
+  constexpr carla::streaming::detail::stream_id_type stream_id = 42u;
+  const std::string message = "0123456789";
+  const size_t fragment_size = 4u;
+
+  auto make_datagram = [&](uint32_t sequence, uint16_t index, bool is_parity, std::string payload) {
+    DatagramHeader header;
+    header.magic = DATAGRAM_MAGIC;
+    header.stream_id = stream_id;
+    header.sequence = sequence;
+    header.message_size = static_cast<uint32_t>(message.size());
+    header.fragment_index = index;
+    header.fragment_count = 3u;
+    header.fragment_size = fragment_size;
+    header.fec_group_size = 3u;
+    header.is_parity = is_parity ? 1u : 0u;
+    std::vector<unsigned char> datagram(sizeof(header) + payload.size());
+    std::memcpy(datagram.data(), &header, sizeof(header));
+    std::memcpy(datagram.data() + sizeof(header), payload.data(), payload.size());
+    return datagram;
+  };
+
+  std::string parity(fragment_size, '\0');
+  for (size_t i = 0u; i < message.size(); ++i) {
+    parity[i % fragment_size] ^= message[i];
+  }
+
+  Reassembler reassembler(stream_id);
+  // 序号 1 的消息只收到一个分片，交付序号 2 的消息时计为丢失
+  auto first = make_datagram(1u, 0u, false, message.substr(0u, fragment_size));
+  ASSERT_FALSE(reassembler.Add(first.data(), first.size()));
+
+  // 缺少第二个分片，由校验分片恢复
+  auto a = make_datagram(2u, 0u, false, message.substr(0u, fragment_size));
+  auto c = make_datagram(2u, 2u, false, message.substr(2u * fragment_size));
+  auto p = make_datagram(2u, 0u, true, parity);
+  ASSERT_FALSE(reassembler.Add(a.data(), a.size()));
+  ASSERT_FALSE(reassembler.Add(p.data(), p.size()));
+  auto result = reassembler.Add(c.data(), c.size());
+  ASSERT_TRUE(result);
+  ASSERT_EQ(util::buffer::as_string(*result), message);
+  ASSERT_EQ(reassembler.GetRecoveredFragments(), 1u);
+  ASSERT_EQ(reassembler.GetLostMessages(), 1u);
+
+  // 已交付的消息不会再次交付
+  ASSERT_FALSE(reassembler.Add(first.data(), first.size()));
+  ASSERT_FALSE(reassembler.Add(a.data(), a.size()));
+}
+
+TEST(streaming, session_queue_overflow_policies) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  using detail::OverflowPolicy;
+  constexpr size_t number_of_messages = 40u;
+  constexpr size_t max_depth = 2u;
+  // 消息足够大，使套接字缓冲区很快被填满
+  const std::string message(4u * 1024u * 1024u, 'x');
+
+  for (auto policy : {OverflowPolicy::DropNewest, OverflowPolicy::DropOldest, OverflowPolicy::Block}) {
+    Server srv(TESTING_PORT);
+    detail::SessionQueueSettings settings;
+    settings.policy = policy;
+    settings.max_depth = max_depth;
+    settings.timeout = carla::time_duration::milliseconds(1u);
+    srv.SetSessionQueueSettings(settings);
+    srv.AsyncRun(2u);
+    auto stream = srv.MakeStream();
+    const auto stream_id = detail::token_type(stream.token()).get_stream_id();
+
+    std::atomic_size_t message_count{0u};
+    Client c;
+    c.AsyncRun(1u);
+    c.Subscribe(stream.token(), [&](auto buffer) {
+      ASSERT_EQ(buffer.size(), message.size());
+      ++message_count;
+      // 模拟处理较慢的客户端
+      std::this_thread::sleep_for(20ms);
+    });
+
+    carla::SharedBufferView BufView = carla::BufferView::CreateFrom(
+        carla::Buffer(boost::asio::buffer(message)));
+    for (auto i = 0u; (i < 100u) && srv.GetSessionStatistics(stream_id).empty(); ++i) {
+      std::this_thread::sleep_for(6ms);
+    }
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      carla::SharedBufferView View = BufView;
+      stream.Write(View);
+    }
+    // Block 策略不阻塞写入线程，等待超时的消息稍后才被丢弃
+    std::this_thread::sleep_for(20ms);
+
+    auto statistics = srv.GetSessionStatistics(stream_id);
+    ASSERT_EQ(statistics.size(), 1u);
+    ASSERT_LE(statistics[0].queue_depth, max_depth);
+    ASSERT_LE(statistics[0].max_queue_depth, max_depth);
+    ASSERT_GT(statistics[0].dropped_messages, 0u);
+    const auto accounted = statistics[0].sent_messages + statistics[0].queue_depth +
+        statistics[0].waiting_messages + statistics[0].dropped_messages;
+    ASSERT_LE(accounted, number_of_messages);
+    ASSERT_GE(accounted + 1u, number_of_messages);
+  }
+}
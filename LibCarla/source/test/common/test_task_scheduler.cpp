@@ -0,0 +1,124 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ParallelFor.h>
+#include <carla/TaskScheduler.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using carla::TaskGraph;
+using carla::TaskScheduler;
+
+// 每个索引恰好被调用一次，嵌套调用时也可以在工作线程中完成。
+TEST(task_scheduler, parallel_for) {
+  TaskScheduler scheduler(3u);
+  ASSERT_EQ(scheduler.GetConcurrency(), 4u);
+  for (size_t count : {0u, 1u, 7u, 1000u, 100'000u}) {
+    std::vector<std::atomic<int>> calls(count);
+    scheduler.ParallelFor(count, [&](const size_t index) { ++calls[index]; }, 1u);
+    for (auto &&value : calls) {
+      ASSERT_EQ(value.load(), 1);
+    }
+  }
+  std::atomic<size_t> sum{0u};
+  scheduler.ParallelFor(16u, [&](const size_t outer) {
+    scheduler.ParallelFor(100u, [&](const size_t inner) { sum += outer * 100u + inner; }, 1u);
+  }, 1u);
+  ASSERT_EQ(sum.load(), 1599u * 1600u / 2u);
+}
+
+// 第一个异常在所有线程结束后重新抛出，调度器之后仍可使用。
+TEST(task_scheduler, parallel_for_exception) {
+  TaskScheduler scheduler(2u);
+  ASSERT_THROW(scheduler.ParallelFor(1000u, [](const size_t index) {
+    if (index == 500u) {
+      throw std::runtime_error("failure");
+    }
+  }, 1u), std::runtime_error);
+  std::atomic<size_t> sum{0u};
+  carla::ParallelFor(100u, [&](const size_t index) { sum += index; }, 1u);
+  ASSERT_EQ(sum.load(), 4950u);
+}
+
+// ScopedSerialParallelFor 作用域内 ParallelFor 在调用线程中按顺序执行，离开后恢复并行。
+TEST(task_scheduler, scoped_serial_parallel_for) {
+  const auto caller = std::this_thread::get_id();
+  std::vector<size_t> order;
+  bool on_caller_thread = true;
+  {
+    carla::ScopedSerialParallelFor serial;
+    carla::ParallelFor(10000u, [&](const size_t index) {
+      order.push_back(index);
+      on_caller_thread = on_caller_thread && (std::this_thread::get_id() == caller);
+    }, 1u);
+  }
+  ASSERT_TRUE(on_caller_thread);
+  ASSERT_EQ(order.size(), 10000u);
+  for (size_t i = 0u; i < order.size(); ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+  std::atomic<size_t> sum{0u};
+  carla::ParallelFor(100u, [&](const size_t index) { sum += index; }, 1u);
+  ASSERT_EQ(sum.load(), 4950u);
+}
+
+// Submit 的结果与异常通过 future 返回，在工作线程中等待也不会死锁。
+TEST(task_scheduler, submit) {
+  TaskScheduler scheduler(1u);
+  auto result = scheduler.Submit([&]() {
+    auto inner = scheduler.Submit([]() { return 21; });
+    scheduler.Wait(inner);
+    return 2 * inner.get();
+  });
+  scheduler.Wait(result);
+  ASSERT_EQ(result.get(), 42);
+  auto failure = scheduler.Submit([]() -> int { throw std::runtime_error("failure"); });
+  ASSERT_THROW(failure.get(), std::runtime_error);
+}
+
+// 每个任务在它依赖的任务之后执行；失败后其余的任务不再执行。
+TEST(task_scheduler, task_graph) {
+  TaskScheduler scheduler(3u);
+  constexpr size_t layers = 10u;
+  constexpr size_t width = 8u;
+  std::vector<std::atomic<int>> order(layers * width);
+  std::atomic<int> clock{0};
+  TaskGraph graph;
+  for (size_t layer = 0u; layer < layers; ++layer) {
+    for (size_t i = 0u; i < width; ++i) {
+      const auto id = graph.AddTask([&, layer, i]() { order[layer * width + i] = ++clock; });
+      ASSERT_EQ(id, layer * width + i);
+      if (layer > 0u) {
+        graph.Precede((layer - 1u) * width + i, id);
+        graph.Precede((layer - 1u) * width + (i + 1u) % width, id);
+      }
+    }
+  }
+  for (int run = 0; run < 2; ++run) {
+    clock = 0;
+    graph.Run(scheduler);
+    ASSERT_EQ(clock.load(), static_cast<int>(layers * width));
+    for (size_t layer = 1u; layer < layers; ++layer) {
+      for (size_t i = 0u; i < width; ++i) {
+        ASSERT_GT(order[layer * width + i].load(), order[(layer - 1u) * width + i].load());
+        ASSERT_GT(order[layer * width + i].load(), order[(layer - 1u) * width + (i + 1u) % width].load());
+      }
+    }
+  }
+
+  TaskGraph failing;
+  std::atomic<int> executed{0};
+  const auto first = failing.AddTask([]() { throw std::runtime_error("failure"); });
+  const auto second = failing.AddTask([&]() { ++executed; });
+  failing.Precede(first, second);
+  ASSERT_THROW(failing.Run(scheduler), std::runtime_error);
+  ASSERT_EQ(executed.load(), 0);
+}
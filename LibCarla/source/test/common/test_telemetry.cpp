@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/sensor/s11n/TelemetrySerializer.h>
+
+#include <cstring>
+
+using carla::rpc::VehicleTelemetryData;
+using carla::rpc::WheelTelemetryData;
+using carla::sensor::data::TelemetryData;
+using carla::sensor::data::VehicleTelemetrySample;
+using carla::sensor::data::WheelTelemetrySample;
+using carla::sensor::s11n::TelemetrySerializer;
+
+static WheelTelemetryData MakeWheel(float first) {
+  return WheelTelemetryData(
+      first, first + 1.0f, first + 2.0f, first + 3.0f, first + 4.0f, first + 5.0f,
+      first + 6.0f, first + 7.0f, first + 8.0f, first + 9.0f, first + 10.0f);
+}
+
+// 头部为车辆数和每辆车的（ID，车轮数），之后是所有车辆，最后按车辆依次排列所有车轮。
+TEST(telemetry, serialize_layout) {
+  TelemetryData data;
+  data.WriteVehicle(20u, VehicleTelemetryData(10.0f, 0.5f, 1.0f, 0.0f, 3000.0f, 2, 0.1f,
+      {MakeWheel(0.0f), MakeWheel(11.0f)}));
+  data.WriteVehicle(21u, VehicleTelemetryData(5.0f, -0.5f, 0.0f, 1.0f, 800.0f, -1, 0.2f, {}));
+  ASSERT_EQ(data.GetVehicleCount(), 2u);
+
+  const int sensor = 0;
+  carla::Buffer buffer = TelemetrySerializer::Serialize(sensor, data, carla::Buffer{});
+  const uint32_t expected_header[] = {2u, 20u, 2u, 21u, 0u};
+  ASSERT_EQ(
+      buffer.size(),
+      sizeof(expected_header) + 2u * sizeof(VehicleTelemetrySample) + 2u * sizeof(WheelTelemetrySample));
+  ASSERT_EQ(std::memcmp(buffer.data(), expected_header, sizeof(expected_header)), 0);
+
+  const auto *vehicles = reinterpret_cast<const VehicleTelemetrySample *>(
+      buffer.data() + sizeof(expected_header));
+  ASSERT_EQ(vehicles[0u].engine_rpm, 3000.0f);
+  ASSERT_EQ(vehicles[0u].gear, 2);
+  ASSERT_EQ(vehicles[1u].speed, 5.0f);
+  ASSERT_EQ(vehicles[1u].gear, -1);
+
+  const float *wheels = reinterpret_cast<const float *>(vehicles + 2u);
+  for (size_t i = 0u; i < 22u; ++i) {
+    ASSERT_EQ(wheels[i], static_cast<float>(i));
+  }
+
+  // Reset 之后不保留上一帧的车辆
+  data.Reset();
+  ASSERT_EQ(data.GetVehicleCount(), 0u);
+  buffer = TelemetrySerializer::Serialize(sensor, data, std::move(buffer));
+  ASSERT_EQ(buffer.size(), sizeof(uint32_t));
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/profiler/TraceProfiler.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using carla::profiler::TraceProfiler;
+
+static const TraceProfiler::ScopeStatistics *FindScope(
+    const std::vector<TraceProfiler::ScopeStatistics> &statistics,
+    const std::string &name) {
+  for (const auto &item : statistics) {
+    if (item.name == name) {
+      return &item;
+    }
+  }
+  return nullptr;
+}
+
+// 关闭时不记录任何作用域。
+TEST(trace_profiler, disabled) {
+  auto &profiler = TraceProfiler::Get();
+  profiler.Reset();
+  profiler.SetEnabled(false);
+  for (int i = 0; i < 10; ++i) {
+    CARLA_TRACE_SCOPE(test, disabled);
+  }
+  ASSERT_TRUE(profiler.GetStatistics().empty());
+}
+
+// 嵌套的作用域分别汇总，百分位数不超过最大值，Chrome trace 中包含每个事件。
+TEST(trace_profiler, nested_scopes) {
+  auto &profiler = TraceProfiler::Get();
+  profiler.Reset();
+  profiler.SetTraceCapacity(100u);
+  profiler.SetEnabled(true);
+  for (int i = 0; i < 5; ++i) {
+    CARLA_TRACE_SCOPE(test, outer);
+    for (int j = 0; j < 2; ++j) {
+      CARLA_TRACE_SCOPE(test, inner);
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+  profiler.SetEnabled(false);
+  const auto statistics = profiler.GetStatistics();
+  const auto *outer = FindScope(statistics, "test.outer");
+  const auto *inner = FindScope(statistics, "test.inner");
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  ASSERT_EQ(outer->count, 5u);
+  ASSERT_EQ(inner->count, 10u);
+  ASSERT_GE(outer->total_ms, inner->total_ms);
+  ASSERT_GE(inner->p50_ms, 0.1);
+  ASSERT_LE(inner->p50_ms, inner->p99_ms);
+  ASSERT_LE(inner->p99_ms, inner->max_ms);
+  ASSERT_EQ(profiler.GetDroppedCount(), 0u);
+  std::ostringstream out;
+  profiler.WriteChromeTrace(out);
+  const auto json = out.str();
+  ASSERT_EQ(json.find("{\"traceEvents\":["), 0u);
+  size_t events = 0u;
+  for (auto pos = json.find("\"ph\":\"X\""); pos != std::string::npos; pos = json.find("\"ph\":\"X\"", pos + 1u)) {
+    ++events;
+  }
+  ASSERT_EQ(events, 15u);
+  ASSERT_NE(json.find("\"depth\":1"), std::string::npos);
+  profiler.SetTraceCapacity(0u);
+  profiler.Reset();
+}
+
+// 每个线程写入自己的缓冲区，线程结束后的事件仍然被汇总。
+TEST(trace_profiler, multiple_threads) {
+  auto &profiler = TraceProfiler::Get();
+  profiler.Reset();
+  profiler.SetEnabled(true);
+  profiler.StartAggregation(std::chrono::milliseconds(1));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 1000; ++i) {
+        CARLA_TRACE_SCOPE(test, worker);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  profiler.StopAggregation();
+  profiler.SetEnabled(false);
+  const auto statistics = profiler.GetStatistics();
+  const auto *worker = FindScope(statistics, "test.worker");
+  ASSERT_NE(worker, nullptr);
+  ASSERT_EQ(worker->count + profiler.GetDroppedCount(), 4000u);
+  profiler.Reset();
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/sensor/s11n/WalkerPoseSerializer.h>
+
+#include <cstring>
+
+using carla::sensor::data::WalkerBonePose;
+using carla::sensor::data::WalkerPoseData;
+using carla::sensor::s11n::WalkerPoseSerializer;
+
+// 头部为行人个数和每个行人的（ID，骨骼数），之后按行人依次排列所有骨骼。
+TEST(walker_pose, serialize_layout) {
+  WalkerPoseData data;
+  data.SetWalkers({{10u, 2u}, {11u, 0u}, {12u, 1u}});
+  ASSERT_EQ(data.GetWalkerCount(), 3u);
+  ASSERT_EQ(data.GetBoneCount(), 3u);
+  data.GetBones(0u)[0u] = WalkerBonePose{1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  data.GetBones(0u)[1u] = WalkerBonePose{7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f};
+  data.GetBones(2u)[0u] = WalkerBonePose{13.0f, 14.0f, 15.0f, 16.0f, 17.0f, 18.0f};
+
+  const int sensor = 0;
+  carla::Buffer buffer = WalkerPoseSerializer::Serialize(sensor, data, carla::Buffer{});
+  const uint32_t expected_header[] = {3u, 10u, 2u, 11u, 0u, 12u, 1u};
+  ASSERT_EQ(buffer.size(), sizeof(expected_header) + 3u * sizeof(WalkerBonePose));
+  ASSERT_EQ(std::memcmp(buffer.data(), expected_header, sizeof(expected_header)), 0);
+
+  const float *bones = reinterpret_cast<const float *>(buffer.data() + sizeof(expected_header));
+  for (size_t i = 0u; i < 18u; ++i) {
+    ASSERT_EQ(bones[i], static_cast<float>(i + 1u));
+  }
+
+  // 重新设置行人时不保留上一帧的数据
+  data.SetWalkers({});
+  ASSERT_EQ(data.GetWalkerCount(), 0u);
+  buffer = WalkerPoseSerializer::Serialize(sensor, data, std::move(buffer));
+  ASSERT_EQ(buffer.size(), sizeof(uint32_t));
+}
@@ -8,12 +8,22 @@
 
 #include <carla/Buffer.h>
 #include <carla/BufferView.h>
+#include <carla/StopWatch.h>
+#include <carla/sensor/s11n/Compression.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 
 #include <boost/asio/post.hpp>
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
 
 using namespace carla::streaming;
 using namespace std::chrono_literals;
@@ -179,3 +189,327 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+// 基准测试单个流向多个会话的分发，测量每次写入流的平均耗时
+static void benchmark_fan_out(const size_t number_of_sessions) {
+  constexpr auto number_of_messages = 200u;
+  constexpr auto message_size = 4u * 800u * 600u;
+  carla::logging::log("Benchmark:", "fan-out to", number_of_sessions, "sessions.");
+
+  Server server(TESTING_PORT);
+  server.AsyncRun(std::max<size_t>(2u, number_of_sessions));
+  Stream stream = server.MakeStream();
+  const auto message = make_special_message(message_size);
+
+  std::atomic_size_t number_of_messages_received{0u};
+  std::vector<std::unique_ptr<Client>> clients;
+  for (auto i = 0u; i < number_of_sessions; ++i) {
+    clients.emplace_back(std::make_unique<Client>());
+    clients.back()->AsyncRun(1u);
+    clients.back()->Subscribe(stream.token(), [&](carla::Buffer msg) {
+      DEBUG_ASSERT_EQ(msg.size(), message_size);
+      ++number_of_messages_received;
+    });
+  }
+
+  std::this_thread::sleep_for(1s); // 等待所有客户端连接
+
+  size_t total_write_time_ns = 0u;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(11ms); // 约90帧
+    carla::StopWatch stop_watch;
+    carla::SharedBufferView View = message;
+    stream.Write(View);
+    total_write_time_ns += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+  }
+
+  const auto expected_number_of_messages = number_of_sessions * number_of_messages;
+  for (auto i = 0u; (i < 10u) && (number_of_messages_received < expected_number_of_messages); ++i) {
+    std::this_thread::sleep_for(100ms);
+  }
+
+  std::cout << "fan-out to " << number_of_sessions << " sessions: "
+            << (total_write_time_ns / number_of_messages) << " ns per write, received "
+            << number_of_messages_received << " of " << expected_number_of_messages
+            << " messages." << std::endl;
+
+#ifdef NDEBUG
+  ASSERT_GE(number_of_messages_received, static_cast<size_t>(0.9 * expected_number_of_messages));
+#endif // NDEBUG
+}
+
+TEST(benchmark_streaming, fan_out_1_session) {
+  benchmark_fan_out(1u);
+}
+
+TEST(benchmark_streaming, fan_out_4_sessions) {
+  benchmark_fan_out(4u);
+}
+
+TEST(benchmark_streaming, fan_out_16_sessions) {
+  benchmark_fan_out(16u);
+}
+
+// =============================================================================
+// -- 传感器组合的端到端基准测试 ------------------------------------------------
+// =============================================================================
+
+namespace sensor_mix {
+
+  using carla::sensor::s11n::Compression;
+  using carla::sensor::s11n::CompressionType;
+  using carla::sensor::s11n::SensorHeaderSerializer;
+
+  enum class Transport {
+    Tcp,
+    SharedMemory,
+    TcpCompressed
+  };
+
+  static const char *ToString(Transport transport) {
+    switch (transport) {
+      case Transport::Tcp: return "tcp";
+      case Transport::SharedMemory: return "shm";
+      case Transport::TcpCompressed: return "tcp_deflate";
+      default: return "unknown";
+    }
+  }
+
+  /// 一类传感器：数量与每条消息负载的大小，所有传感器每帧发送一次。
+  struct SensorKind {
+    std::string name;
+    size_t count;
+    size_t payload_size;
+  };
+
+  /// 8 个 800x600 的 RGBA 相机、4 个每帧约 5000 个点的激光雷达、IMU 与 GNSS。
+  static std::vector<SensorKind> MakeDefaultMix() {
+    return {
+      {"camera", 8u, 4u * 800u * 600u},
+      {"lidar", 4u, 16u * 5000u},
+      {"imu", 1u, 7u * sizeof(float)},
+      {"gnss", 1u, 3u * sizeof(double)}};
+  }
+
+  /// 像素为平滑渐变、点为周期变化的坐标，压缩率接近真实的数据。
+  static std::vector<unsigned char> MakePayload(const SensorKind &kind, size_t index) {
+    std::vector<unsigned char> payload(kind.payload_size);
+    for (size_t i = 0u; i < payload.size(); ++i) {
+      payload[i] = static_cast<unsigned char>(((i / 4u) + index * 31u + (i % 4u) * 17u) % 251u);
+    }
+    return payload;
+  }
+
+  static double Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// 数据头中的 timestamp 为发送时 steady_clock 的秒数，用于计算延迟。
+  static carla::SharedBufferView MakeMessage(
+      const std::vector<unsigned char> &payload,
+      uint64_t frame,
+      bool compress) {
+    SensorHeaderSerializer::Header header{};
+    header.frame = frame;
+    header.timestamp = Now();
+    carla::Buffer message;
+    if (compress) {
+      SensorHeaderSerializer::SetCompression(header, static_cast<uint8_t>(CompressionType::Deflate));
+      auto compressed = Compression::Compress(
+          CompressionType::Deflate, {boost::asio::buffer(payload)}, carla::Buffer{});
+      message.copy_from(sizeof(header), compressed);
+    } else {
+      message.copy_from(sizeof(header), boost::asio::buffer(payload));
+    }
+    std::memcpy(message.data(), &header, sizeof(header));
+    return carla::BufferView::CreateFrom(std::move(message));
+  }
+
+  /// 每类传感器接收到的消息的延迟与字节数。
+  class Recorder {
+  public:
+
+    void Add(const std::string &kind, double latency, size_t bytes) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto &record = _records[kind];
+      record.latencies.emplace_back(latency);
+      record.bytes += bytes;
+    }
+
+    size_t GetNumberOfMessages() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      size_t count = 0u;
+      for (const auto &item : _records) {
+        count += item.second.latencies.size();
+      }
+      return count;
+    }
+
+    /// 以一个 JSON 对象写出结果，延迟单位为毫秒，吞吐量为每秒收到的消息
+    /// 字节数（压缩时为压缩后的大小），单位为 MB/s。
+    void WriteJson(
+        std::ostream &out,
+        const std::string &name,
+        Transport transport,
+        size_t number_of_subscribers,
+        double elapsed_seconds,
+        size_t expected_messages) const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      size_t received = 0u;
+      size_t total_bytes = 0u;
+      std::vector<double> all;
+      std::ostringstream sensors;
+      bool first = true;
+      for (const auto &item : _records) {
+        auto latencies = item.second.latencies;
+        received += latencies.size();
+        total_bytes += item.second.bytes;
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        sensors << (first ? "" : ",") << '"' << item.first << "\":{";
+        WriteStatistics(sensors, latencies, item.second.bytes, elapsed_seconds);
+        sensors << '}';
+        first = false;
+      }
+      out << "{\"benchmark\":\"" << name
+          << "\",\"transport\":\"" << ToString(transport)
+          << "\",\"subscribers\":" << number_of_subscribers
+          << ",\"expected_messages\":" << expected_messages
+          << ",\"received_messages\":" << received
+          << ",\"elapsed_s\":" << elapsed_seconds << ',';
+      WriteStatistics(out, all, total_bytes, elapsed_seconds);
+      out << ",\"sensors\":{" << sensors.str() << "}}";
+    }
+
+  private:
+
+    struct Record {
+      std::vector<double> latencies;
+      size_t bytes = 0u;
+    };
+
+    static double Percentile(const std::vector<double> &sorted, double p) {
+      if (sorted.empty()) {
+        return 0.0;
+      }
+      const auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1u) + 0.5);
+      return sorted[std::min(index, sorted.size() - 1u)];
+    }
+
+    static void WriteStatistics(
+        std::ostream &out,
+        std::vector<double> &latencies,
+        size_t bytes,
+        double elapsed_seconds) {
+      std::sort(latencies.begin(), latencies.end());
+      const double to_ms = 1e3;
+      out << "\"messages\":" << latencies.size()
+          << ",\"throughput_mb_s\":" << (elapsed_seconds > 0.0 ? (1e-6 * static_cast<double>(bytes) / elapsed_seconds) : 0.0)
+          << ",\"latency_p50_ms\":" << to_ms * Percentile(latencies, 0.5)
+          << ",\"latency_p99_ms\":" << to_ms * Percentile(latencies, 0.99)
+          << ",\"latency_max_ms\":" << to_ms * (latencies.empty() ? 0.0 : latencies.back());
+    }
+
+    mutable std::mutex _mutex;
+
+    std::map<std::string, Record> _records;
+  };
+
+  /// 以 20 帧每秒在游戏线程中依次写入所有传感器的流，@a number_of_subscribers
+  /// 个客户端各自订阅所有的流。结果打印到标准输出，并追加到当前目录的
+  /// benchmark_streaming.jsonl 中（每行一个 JSON 对象）。
+  static void Run(
+      const std::string &name,
+      Transport transport,
+      size_t number_of_subscribers,
+      double success_ratio = 0.9) {
+    constexpr auto number_of_frames = 60u;
+    constexpr auto frame_time = 50ms;
+    const auto mix = MakeDefaultMix();
+    const bool compress = (transport == Transport::TcpCompressed);
+
+    Server server(TESTING_PORT);
+    server.SetSharedMemoryMode(transport == Transport::SharedMemory);
+    server.AsyncRun(std::max<size_t>(2u, get_max_concurrency()));
+
+    struct SensorStream {
+      const SensorKind *kind;
+      std::vector<unsigned char> payload;
+      Stream stream;
+    };
+    std::vector<SensorStream> streams;
+    for (const auto &kind : mix) {
+      for (auto i = 0u; i < kind.count; ++i) {
+        streams.push_back(SensorStream{&kind, MakePayload(kind, i), server.MakeStream()});
+      }
+    }
+
+    Recorder recorder;
+    std::vector<std::unique_ptr<Client>> clients;
+    for (auto i = 0u; i < number_of_subscribers; ++i) {
+      clients.emplace_back(std::make_unique<Client>());
+      clients.back()->AsyncRun(2u);
+      for (auto &sensor : streams) {
+        const std::string kind = sensor.kind->name;
+        clients.back()->Subscribe(sensor.stream.token(), [&recorder, kind](carla::Buffer message) {
+          const auto size = message.size();
+          // 解压也计入延迟，与客户端反序列化时相同
+          auto data = Compression::Decompress(std::move(message));
+          const auto &header = SensorHeaderSerializer::Deserialize(data);
+          recorder.Add(kind, Now() - header.timestamp, size);
+        });
+      }
+    }
+
+    std::this_thread::sleep_for(1s); // 等待所有客户端连接
+
+    carla::StopWatch stop_watch;
+    for (auto frame = 0u; frame < number_of_frames; ++frame) {
+      const auto next_frame = std::chrono::steady_clock::now() + frame_time;
+      for (auto &sensor : streams) {
+        sensor.stream.Write(MakeMessage(sensor.payload, frame, compress));
+      }
+      std::this_thread::sleep_until(next_frame);
+    }
+
+    const auto expected_messages = number_of_subscribers * streams.size() * number_of_frames;
+    for (auto i = 0u; (i < 20u) && (recorder.GetNumberOfMessages() < expected_messages); ++i) {
+      std::this_thread::sleep_for(100ms);
+    }
+    const double elapsed_seconds =
+        1e-3 * static_cast<double>(stop_watch.GetElapsedTime<std::chrono::milliseconds>());
+    clients.clear();
+
+    std::ostringstream json;
+    recorder.WriteJson(json, name, transport, number_of_subscribers, elapsed_seconds, expected_messages);
+    std::cout << json.str() << std::endl;
+    std::ofstream("benchmark_streaming.jsonl", std::ios_base::app) << json.str() << '\n';
+
+#ifdef NDEBUG
+    ASSERT_GE(recorder.GetNumberOfMessages(), static_cast<size_t>(success_ratio * expected_messages));
+#else
+    (void)success_ratio;
+#endif // NDEBUG
+  }
+
+} // namespace sensor_mix
+
+TEST(benchmark_streaming, sensor_mix_tcp) {
+  sensor_mix::Run("sensor_mix", sensor_mix::Transport::Tcp, 1u);
+}
+
+TEST(benchmark_streaming, sensor_mix_tcp_4_subscribers) {
+  // 会话队列在客户端跟不上时丢弃旧的帧，这里的丢帧率正是要监测的
+  sensor_mix::Run("sensor_mix", sensor_mix::Transport::Tcp, 4u, 0.75);
+}
+
+TEST(benchmark_streaming, sensor_mix_shm) {
+  sensor_mix::Run("sensor_mix", sensor_mix::Transport::SharedMemory, 1u);
+}
+
+TEST(benchmark_streaming, sensor_mix_shm_4_subscribers) {
+  sensor_mix::Run("sensor_mix", sensor_mix::Transport::SharedMemory, 4u);
+}
+
+TEST(benchmark_streaming, sensor_mix_compressed) {
+  sensor_mix::Run("sensor_mix", sensor_mix::Transport::TcpCompressed, 1u);
+}
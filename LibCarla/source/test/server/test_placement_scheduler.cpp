@@ -0,0 +1,120 @@
+﻿// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/multigpu/placementScheduler.h>
+
+using carla::multigpu::PlacementScheduler;
+
+// 服务器的标识只用来比较
+static int servers[3];
+
+static const double camera_4k = PlacementScheduler::GetSensorWeight("sensor.camera.rgb", 3840u, 2160u);
+static const double gnss = PlacementScheduler::GetSensorWeight("sensor.other.gnss", 0u, 0u);
+
+// 按类型和分辨率估计权重
+TEST(placement_scheduler, sensor_weight) {
+  ASSERT_DOUBLE_EQ(PlacementScheduler::GetSensorWeight("sensor.camera.rgb", 1920u, 1080u), 1.0);
+  ASSERT_DOUBLE_EQ(camera_4k, 4.0);
+  ASSERT_DOUBLE_EQ(PlacementScheduler::GetSensorWeight("sensor.camera.depth", 1920u, 1080u), 0.5);
+  ASSERT_LT(PlacementScheduler::GetSensorWeight("sensor.lidar.ray_cast", 0u, 0u), 1.0);
+  ASSERT_LT(gnss, PlacementScheduler::GetSensorWeight("sensor.lidar.ray_cast", 0u, 0u));
+}
+
+// 没有报告时按权重分配，重的相机不会都放在同一台服务器上
+TEST(placement_scheduler, place_by_weight) {
+  PlacementScheduler scheduler;
+  ASSERT_EQ(scheduler.Place(1u, camera_4k), nullptr);
+  scheduler.AddServer(&servers[0]);
+  scheduler.AddServer(&servers[1]);
+
+  for (auto i = 0u; i < 6u; ++i) {
+    scheduler.Place(10u + i, camera_4k);
+  }
+  scheduler.Place(20u, gnss);
+  scheduler.Place(21u, gnss);
+
+  auto on_first = 0u;
+  for (auto i = 0u; i < 6u; ++i) {
+    on_first += (scheduler.GetServer(10u + i) == &servers[0]) ? 1u : 0u;
+  }
+  ASSERT_EQ(on_first, 3u);
+  // 已经放置的传感器留在原来的服务器上
+  const auto server = scheduler.GetServer(10u);
+  ASSERT_EQ(scheduler.Place(10u, camera_4k), server);
+
+  scheduler.RemoveServer(&servers[0]);
+  for (auto i = 0u; i < 6u; ++i) {
+    ASSERT_NE(scheduler.GetServer(10u + i), &servers[0]);
+  }
+}
+
+// 较慢的服务器分到较少的传感器
+TEST(placement_scheduler, place_by_frame_time) {
+  PlacementScheduler scheduler;
+  scheduler.AddServer(&servers[0]);
+  scheduler.AddServer(&servers[1]);
+  scheduler.ReportFrameTime(&servers[0], 30.0);
+  scheduler.ReportFrameTime(&servers[1], 10.0);
+
+  auto on_slow = 0u;
+  for (auto i = 0u; i < 8u; ++i) {
+    on_slow += (scheduler.Place(i, 1.0) == &servers[0]) ? 1u : 0u;
+  }
+  ASSERT_EQ(on_slow, 1u);
+}
+
+// 不平衡持续几次报告后才迁移，并且迁移后不再不平衡
+TEST(placement_scheduler, migrate) {
+  PlacementScheduler scheduler;
+  scheduler.SetImbalanceThreshold(1.5, 3u);
+  scheduler.AddServer(&servers[0]);
+  scheduler.AddServer(&servers[1]);
+  for (auto i = 0u; i < 4u; ++i) {
+    scheduler.Place(i, 1.0);
+  }
+
+  // 第一台服务器的 GPU 慢三倍
+  auto report = [&]() {
+    for (auto k = 0u; k < 2u; ++k) {
+      double weight = 0.0;
+      for (auto i = 0u; i < 4u; ++i) {
+        weight += (scheduler.GetServer(i) == &servers[k]) ? 1.0 : 0.0;
+      }
+      scheduler.ReportFrameTime(&servers[k], (k == 0u ? 3.0 : 1.0) * (weight + 1.0));
+    }
+    return scheduler.Balance();
+  };
+
+  ASSERT_TRUE(report().empty());
+  ASSERT_TRUE(report().empty());
+  auto migrations = report();
+  ASSERT_EQ(migrations.size(), 1u);
+  ASSERT_EQ(migrations[0].from, &servers[0]);
+  ASSERT_EQ(migrations[0].to, &servers[1]);
+  ASSERT_EQ(scheduler.GetServer(migrations[0].sensor), &servers[1]);
+
+  // 3 * (1 + 1) = 6 和 1 * (3 + 1) = 4，差别在阈值以内
+  for (auto i = 0u; i < 5u; ++i) {
+    ASSERT_TRUE(report().empty());
+  }
+}
+
+// 一个传感器就造成不平衡时迁移也没有用
+TEST(placement_scheduler, single_heavy_sensor) {
+  PlacementScheduler scheduler;
+  scheduler.SetImbalanceThreshold(1.5, 1u);
+  scheduler.AddServer(&servers[0]);
+  scheduler.AddServer(&servers[1]);
+  scheduler.Place(1u, camera_4k);
+  scheduler.Place(2u, gnss);
+  const auto heavy = scheduler.GetServer(1u);
+  scheduler.ReportFrameTime(heavy, 50.0);
+  scheduler.ReportFrameTime(heavy == &servers[0] ? &servers[1] : &servers[0], 10.0);
+  ASSERT_TRUE(scheduler.Balance().empty());
+  ASSERT_EQ(scheduler.GetServer(1u), heavy);
+}
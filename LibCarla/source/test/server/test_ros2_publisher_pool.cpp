@@ -0,0 +1,118 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ros2/ROS2PublisherPool.h>
+
+#include <atomic>
+#include <future>
+
+using carla::ros2::ROS2DropPolicy;
+using carla::ros2::ROS2PublisherPool;
+using carla::ros2::ROS2PublisherStats;
+
+// 发布者的标识只用来比较
+static int publishers[2];
+
+static ROS2PublisherStats find_stats(const ROS2PublisherPool &pool, const std::string &name) {
+  for (auto &stats : pool.GetStats()) {
+    if (stats.name == name)
+      return stats;
+  }
+  return {};
+}
+
+// 没有启动时在调用线程上执行
+TEST(ros2_publisher_pool, inline_when_stopped) {
+  ROS2PublisherPool pool;
+  const auto id = std::this_thread::get_id();
+  std::thread::id task_id;
+  pool.Push(&publishers[0], "camera", [&]() { task_id = std::this_thread::get_id(); });
+  ASSERT_EQ(task_id, id);
+  ASSERT_TRUE(pool.GetStats().empty());
+}
+
+// 同一个发布者的任务按顺序执行，不阻塞调用线程
+TEST(ros2_publisher_pool, ordered_per_publisher) {
+  ROS2PublisherPool pool;
+  pool.Start(4u);
+  constexpr int count = 100;
+  pool.SetQueue(&publishers[0], count, ROS2DropPolicy::DropNewest);
+  std::vector<int> order;
+  std::promise<void> done;
+  for (int i = 0; i < count; ++i) {
+    pool.Push(&publishers[0], "camera", [&, i]() {
+      order.push_back(i);
+      if (i == count - 1)
+        done.set_value();
+    });
+  }
+  ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  ASSERT_EQ(order.size(), static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+  pool.Stop();
+}
+
+// 发布者很慢时按策略丢弃数据
+TEST(ros2_publisher_pool, drop_policies) {
+  ROS2PublisherPool pool;
+  pool.Start(2u);
+  pool.SetQueue(&publishers[1], 1u, ROS2DropPolicy::DropNewest);
+
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::promise<void> started[2];
+  std::atomic<int> last[2] = {{-1}, {-1}};
+  for (int i = 0; i < 5; ++i) {
+    for (int p = 0; p < 2; ++p) {
+      pool.Push(&publishers[p], p == 0 ? "oldest" : "newest", [&, i, p, released]() {
+        if (i == 0) {
+          started[p].set_value();
+          released.wait();
+        }
+        last[p] = i;
+      });
+    }
+    if (i == 0) {
+      // 第一个任务开始执行以后，后面的任务才会排队
+      started[0].get_future().wait();
+      started[1].get_future().wait();
+    }
+  }
+  release.set_value();
+  for (int tries = 0; tries < 500; ++tries) {
+    if (find_stats(pool, "oldest").published + find_stats(pool, "newest").published == 5u)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // 默认队列长度是 2，保留最后两个
+  const auto oldest = find_stats(pool, "oldest");
+  ASSERT_EQ(last[0], 4);
+  ASSERT_EQ(oldest.published, 3u);
+  ASSERT_EQ(oldest.dropped, 2u);
+  // 队列长度是 1，保留第一个排队的
+  const auto newest = find_stats(pool, "newest");
+  ASSERT_EQ(last[1], 1);
+  ASSERT_EQ(newest.published, 2u);
+  ASSERT_EQ(newest.dropped, 3u);
+  ASSERT_GE(oldest.max_latency_ms, oldest.mean_latency_ms);
+  pool.Stop();
+}
+
+// 移除的发布者不再出现在统计中
+TEST(ros2_publisher_pool, remove) {
+  ROS2PublisherPool pool;
+  pool.Start(1u);
+  std::promise<void> done;
+  pool.Push(&publishers[0], "camera", [&]() { done.set_value(); });
+  done.get_future().wait();
+  pool.Remove(&publishers[0]);
+  ASSERT_TRUE(pool.GetStats().empty());
+  pool.Stop();
+}
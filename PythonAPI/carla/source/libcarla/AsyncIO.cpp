@@ -0,0 +1,337 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/NonCopyable.h>
+#include <carla/PythonUtil.h>
+#include <carla/Time.h>
+#include <carla/client/RpcFuture.h>
+#include <carla/sensor/SensorData.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// asyncio 支持。RPC 的结果和流的数据在 LibCarla 的线程中到达，通过
+// loop.call_soon_threadsafe 交给事件循环，asyncio.Future 在事件循环的线程中完成。
+// 一个事件循环可以同时等待任意多个模拟器，不需要为每个连接创建线程。
+
+// 在事件循环的线程中调用，future 可能已经被取消
+static void CompleteAsyncIOFuture(
+    boost::python::object future,
+    boost::python::object result,
+    boost::python::object exception) {
+  namespace py = boost::python;
+  if (py::extract<bool>(future.attr("done")())) {
+    return;
+  }
+  if (exception.is_none()) {
+    future.attr("set_result")(result);
+  } else {
+    future.attr("set_exception")(exception);
+  }
+}
+
+static PyObject *StopAsyncIterationType() {
+#if PY_MAJOR_VERSION >= 3
+  return PyExc_StopAsyncIteration;
+#else
+  // Python 2 没有 asyncio，只是为了能够编译
+  return PyExc_StopIteration;
+#endif
+}
+
+// 用注册的异常转换器把 C++ 异常转换为 Python 异常对象，调用时必须持有 GIL
+static boost::python::object MakePythonException(std::exception_ptr error) {
+  namespace py = boost::python;
+  py::handle_exception([&]() { std::rethrow_exception(error); });
+  PyObject *type = nullptr;
+  PyObject *value = nullptr;
+  PyObject *traceback = nullptr;
+  PyErr_Fetch(&type, &value, &traceback);
+  PyErr_NormalizeException(&type, &value, &traceback);
+  Py_XDECREF(type);
+  Py_XDECREF(traceback);
+  if (value == nullptr) {
+    return py::object(py::handle<>(PyObject_CallFunction(PyExc_RuntimeError, "s", "unknown error")));
+  }
+  return py::object(py::handle<>(value));
+}
+
+// 当前事件循环中的 asyncio.Future，可以在任何线程中完成。除了构造函数，
+// 所有函数都可以在任何线程中调用，但必须持有 GIL；复制和销毁不需要 GIL
+class AsyncIOFuture {
+public:
+
+  /// 调用时必须持有 GIL，在协程中调用时使用正在运行的事件循环。
+  AsyncIOFuture() {
+    namespace py = boost::python;
+    py::object loop = py::import("asyncio").attr("get_event_loop")();
+    py::object future = loop.attr("create_future")();
+    _state = std::shared_ptr<State>(
+        new State{std::move(loop), std::move(future)},
+        carla::PythonUtil::AcquireGILDeleter());
+  }
+
+  boost::python::object GetFuture() const {
+    return _state->future;
+  }
+
+  void SetResult(boost::python::object result) const {
+    Complete(std::move(result), boost::python::object());
+  }
+
+  void SetException(boost::python::object exception) const {
+    Complete(boost::python::object(), std::move(exception));
+  }
+
+  void SetException(std::exception_ptr error) const {
+    SetException(MakePythonException(error));
+  }
+
+private:
+
+  void Complete(boost::python::object result, boost::python::object exception) const {
+    namespace py = boost::python;
+    // 不销毁，退出时不再持有 GIL
+    static auto *complete = new py::object(py::make_function(&CompleteAsyncIOFuture));
+    try {
+      _state->loop.attr("call_soon_threadsafe")(*complete, _state->future, result, exception);
+    } catch (const py::error_already_set &) {
+      // 事件循环已经关闭
+      PyErr_Clear();
+    }
+  }
+
+  struct State {
+    boost::python::object loop;
+    boost::python::object future;
+  };
+
+  std::shared_ptr<State> _state;
+};
+
+// 在一个后台线程中等待尚未完成的操作，完成后在持有 GIL 时调用其回调。最早的
+// 操作阻塞等待，其它的在每一轮中轮询，因此最多 1 毫秒后就会发现它们完成。
+class AsyncIOWaiter {
+public:
+
+  /// 等待最多给定的时间，返回操作是否已经完成，在不持有 GIL 时调用。
+  using WaitFunction = std::function<bool(carla::time_duration)>;
+
+  /// 在持有 GIL 时调用。
+  using CompleteFunction = std::function<void()>;
+
+  static AsyncIOWaiter &Get() {
+    // 不销毁，退出时由 atexit 停止线程
+    static auto *instance = new AsyncIOWaiter;
+    return *instance;
+  }
+
+  void Add(WaitFunction wait, CompleteFunction complete) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_stopped) {
+        return;
+      }
+      if (!_thread.joinable()) {
+        _thread = std::thread([this]() { Run(); });
+      }
+      _added.emplace_back(std::move(wait), std::move(complete));
+    }
+    _condition.notify_one();
+  }
+
+  /// 尽快在后台线程中调用 @a complete，可以在不持有 GIL 的线程（例如流客户端
+  /// 的线程）中调用。
+  void Post(CompleteFunction complete) {
+    Add([](carla::time_duration) { return true; }, std::move(complete));
+  }
+
+  /// 停止后台线程，尚未完成的操作不再完成，调用时必须持有 GIL。
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopped = true;
+    }
+    _condition.notify_one();
+    if (_thread.joinable()) {
+      // 线程可能正在等待 GIL
+      carla::PythonUtil::ReleaseGIL unlock;
+      _thread.join();
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _added.clear();
+  }
+
+private:
+
+  using Operation = std::pair<WaitFunction, CompleteFunction>;
+
+  void Run() {
+    const auto poll_interval = carla::time_duration::milliseconds(1u);
+    const auto no_wait = carla::time_duration::milliseconds(0u);
+    std::vector<Operation> pending;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [&]() { return _stopped || !_added.empty() || !pending.empty(); });
+        if (_stopped) {
+          break;
+        }
+        pending.insert(
+            pending.end(),
+            std::make_move_iterator(_added.begin()),
+            std::make_move_iterator(_added.end()));
+        _added.clear();
+      }
+      std::vector<CompleteFunction> done;
+      for (size_t i = 0u; i < pending.size();) {
+        if (pending[i].first(i == 0u ? poll_interval : no_wait)) {
+          done.emplace_back(std::move(pending[i].second));
+          pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+          ++i;
+        }
+      }
+      if (!done.empty()) {
+        carla::PythonUtil::AcquireGIL lock;
+        for (auto &complete : done) {
+          complete();
+        }
+        // 回调在持有 GIL 时释放
+        done.clear();
+      }
+    }
+    carla::PythonUtil::AcquireGIL lock;
+    pending.clear();
+  }
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::vector<Operation> _added;
+
+  std::thread _thread;
+
+  bool _stopped = false;
+};
+
+// 返回一个 asyncio.Future，@a future 就绪后以 convert(future) 的结果完成。
+// convert 在持有 GIL 时调用，调用时必须持有 GIL。
+template <typename T, typename Convert>
+static boost::python::object AwaitRpcFuture(carla::client::RpcFuture<T> future, Convert convert) {
+  AsyncIOFuture result;
+  AsyncIOWaiter::Get().Add(
+      [future](carla::time_duration timeout) { return future.WaitFor(timeout); },
+      [future, result, convert]() {
+        try {
+          result.SetResult(convert(future));
+        } catch (...) {
+          result.SetException(std::current_exception());
+        }
+      });
+  return result.GetFuture();
+}
+
+// 传感器数据的异步迭代器，用于 "async for data in sensor.listen_async()"。
+// 网络线程放入数据时不需要 GIL，队列满时丢弃最旧的数据。
+class AsyncSensorDataStream : private carla::NonCopyable {
+public:
+
+  using Message = carla::SharedPtr<carla::sensor::SensorData>;
+
+  explicit AsyncSensorDataStream(size_t maxlen) : _maxlen(maxlen) {}
+
+  void Push(Message message) {
+    std::unique_ptr<AsyncIOFuture> waiter;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_closed) {
+        return;
+      }
+      if (_waiter == nullptr) {
+        if (_maxlen > 0u && _queue.size() >= _maxlen) {
+          _queue.pop_front();
+          ++_dropped;
+        }
+        _queue.emplace_back(std::move(message));
+        return;
+      }
+      waiter = std::move(_waiter);
+    }
+    AsyncIOWaiter::Get().Post([waiter=std::shared_ptr<AsyncIOFuture>(std::move(waiter)), message]() {
+      waiter->SetResult(boost::python::object(message));
+    });
+  }
+
+  /// 返回以下一个数据完成的 asyncio.Future，在事件循环的线程中调用。
+  boost::python::object Next() {
+    namespace py = boost::python;
+    AsyncIOFuture future;
+    Message message;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_closed) {
+        PyErr_SetNone(StopAsyncIterationType());
+        py::throw_error_already_set();
+      }
+      if (_waiter != nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "another coroutine is already waiting for the next measurement");
+        py::throw_error_already_set();
+      }
+      if (_queue.empty()) {
+        _waiter = std::make_unique<AsyncIOFuture>(future);
+        return future.GetFuture();
+      }
+      message = std::move(_queue.front());
+      _queue.pop_front();
+    }
+    py::object result = future.GetFuture();
+    result.attr("set_result")(py::object(message));
+    return result;
+  }
+
+  /// 结束迭代，正在等待的协程收到 StopAsyncIteration。
+  void Close() {
+    std::unique_ptr<AsyncIOFuture> waiter;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+      _queue.clear();
+      waiter = std::move(_waiter);
+    }
+    if (waiter != nullptr) {
+      waiter->SetException(boost::python::object(
+          boost::python::handle<>(boost::python::borrowed(StopAsyncIterationType()))));
+    }
+  }
+
+  size_t GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+  }
+
+private:
+
+  const size_t _maxlen;
+
+  mutable std::mutex _mutex;
+
+  std::deque<Message> _queue;
+
+  std::unique_ptr<AsyncIOFuture> _waiter;
+
+  size_t _dropped = 0u;
+
+  bool _closed = false;
+};
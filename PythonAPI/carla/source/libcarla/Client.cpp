@@ -5,13 +5,17 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "carla/PythonUtil.h"
+#include "carla/client/ActorBlueprint.h"
 #include "carla/client/Client.h"
 #include "carla/client/World.h"
 #include "carla/Logging.h"
 #include "carla/rpc/ActorId.h"
+#include "carla/rpc/ActorSpawnBatch.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include <boost/python/stl_iterator.hpp>
 
@@ -42,43 +46,89 @@ static auto GetAvailableMaps(const carla::client::Client &self) {
 }
 //该静态函数用于获取客户端可用的地图列表。首先创建一个boost::python::list类型的对象result用于存储最终要返回给 Python 的结果，以及一个std::vector<std::string>类型的maps用于临时存储从客户端获取到的地图名称字符串向量。
 //在获取地图名称列表时，先通过carla::PythonUtil::ReleaseGIL释放全局解释器锁（GIL），这是为了在执行可能耗时的self.GetAvailableMaps()操作时，允许其他 Python 线程继续执行，避免阻塞整个 Python 解释器。然后将获取到的地图名称逐个添加到result列表中，最后返回这个列表，以便在 Python 环境中可以方便地访问可用地图的名称。
-static auto GetRequiredFiles(const carla::client::Client &self, const std::string &folder, const bool download) {
+// 下载进度回调在下载的线程中调用，调用 Python 前重新获取 GIL。
+static carla::client::FileTransfer::ProgressCallback MakeFileProgressCallback(boost::python::object callback) {
+  namespace py = boost::python;
+  if (callback.is_none()) {
+    return {};
+  }
+  if (!PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "progress argument must be callable!");
+    py::throw_error_already_set();
+  }
+  using Deleter = carla::PythonUtil::AcquireGILDeleter;
+  auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+  return [callback=std::move(callback_ptr)](const std::string &name, size_t received, size_t total) {
+    carla::PythonUtil::AcquireGIL lock;
+    try {
+      py::call<void>(callback->ptr(), name, received, total);
+    } catch (const py::error_already_set &) {
+      PyErr_Print();
+    }
+  };
+}
+
+static auto GetRequiredFiles(
+    const carla::client::Client &self,
+    const std::string &folder,
+    const bool download,
+    boost::python::object progress) {
   boost::python::list result;
-  for (const auto &str : self.GetRequiredFiles(folder, download)) {
+  const auto callback = MakeFileProgressCallback(progress);
+  std::vector<std::string> files;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    files = self.GetRequiredFiles(folder, download, callback);
+  }
+  for (const auto &str : files) {
     result.append(str);
   }
   return result;
 }
+
+static void RequestFile(
+    const carla::client::Client &self,
+    const std::string &name,
+    boost::python::object progress) {
+  const auto callback = MakeFileProgressCallback(progress);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.RequestFile(name, callback);
+}
 //此函数用于获取客户端在指定文件夹下所需的文件列表。同样先创建一个boost::python::list类型的result对象用于存储结果。
 //它接受客户端对象引用、一个表示文件夹路径的字符串以及一个表示是否下载的布尔值作为参数。通过遍历客户端对象的GetRequiredFiles方法返回的文件名称字符串向量，将每个文件名称添加到result列表中，最后返回该列表，使得在 Python 环境中可以获取到这些文件信息。
+// A batch of commands already converted to C++, see command.CommandBatch. It
+// can be passed to any of the apply_batch methods in place of a list.
+struct CommandBatch {
+  std::vector<carla::rpc::Command> commands;
+};
+
+// Read the commands of a command.CommandBatch or of any iterable of commands.
+static std::vector<carla::rpc::Command> ReadCommands(const boost::python::object &commands) {
+  using CommandType = carla::rpc::Command;
+  boost::python::extract<const CommandBatch &> batch(commands);
+  if (batch.check()) {
+    return batch().commands;
+  }
+  return std::vector<CommandType>{
+    boost::python::stl_input_iterator<CommandType>(commands),
+    boost::python::stl_input_iterator<CommandType>()};
+}
+
 static void ApplyBatchCommands(
     const carla::client::Client &self,
     const boost::python::object &commands,
     bool do_tick) {
-  using CommandType = carla::rpc::Command;
-  std::vector<CommandType> cmds{
-    boost::python::stl_input_iterator<CommandType>(commands),
-        boost::python::stl_input_iterator<CommandType>()};
-  self.ApplyBatch(std::move(cmds), do_tick);
+  self.ApplyBatch(ReadCommands(commands), do_tick);
 }
 //这个函数用于向客户端应用一批命令。它接受客户端对象引用、一个boost::python::object类型的commands对象（应该是包含一系列命令的可迭代对象，具体类型可能通过后续的迭代器转换确定）以及一个表示是否执行tick操作的布尔值作为参数。
 在函数内部，首先定义了一个CommandType类型别名（等同于carla::rpc::Command），然后通过boost::python::stl_input_iterator将commands对象转换为CommandType类型的向量cmds。最后调用客户端对象的ApplyBatch方法，将转换后的命令向量传递进去，并根据do_tick的值决定是否执行相关的tick操作。
-static auto ApplyBatchCommandsSync(
+// Registers in the traffic manager the vehicles whose autopilot was changed by
+// a batch of commands.
+static void UpdateAutopilotFromBatch(
     const carla::client::Client &self,
-    const boost::python::object &commands,
-    bool do_tick) {
-
+    const std::vector<carla::rpc::Command> &cmds,
+    const std::vector<carla::rpc::CommandResponse> &responses) {
   using CommandType = carla::rpc::Command;
-  std::vector<CommandType> cmds {
-    boost::python::stl_input_iterator<CommandType>(commands),
-    boost::python::stl_input_iterator<CommandType>()
-  };
-
-  boost::python::list result;
-  auto responses = self.ApplyBatchSync(cmds, do_tick);
-  for (auto &response : responses) {
-    result.append(std::move(response));
-  }
 
   // check for autopilot command
   std::vector<carla::traffic_manager::ActorPtr> vehicles_to_enable(cmds.size(), nullptr);
@@ -99,7 +149,7 @@ static auto ApplyBatchCommandsSync(
         bool isAutopilot = false;
         bool autopilotValue = false;
 
-        CommandType::CommandType& cmd_type = cmds[i].command;
+        const CommandType::CommandType& cmd_type = cmds[i].command;
 
         // check SpawnActor command
         if (const auto *maybe_spawn_actor_cmd = boost::variant2::get_if<carla::rpc::Command::SpawnActor>(&cmd_type)) {
@@ -180,9 +230,30 @@ static auto ApplyBatchCommandsSync(
     self.GetInstanceTM(tm_port).RegisterVehicles(sorted_vehicle_to_enable);
     self.GetInstanceTM(tm_port).UnregisterVehicles(sorted_vehicle_to_disable);
   }
+}
+
+static auto ApplyBatchCommandsSync(
+    const carla::client::Client &self,
+    const boost::python::object &commands,
+    bool do_tick) {
+
+  std::vector<carla::rpc::Command> cmds = ReadCommands(commands);
 
+  // 等待服务器的响应与在交通管理器中注册车辆时都不需要 GIL
+  auto responses = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    auto batch_responses = self.ApplyBatchSync(cmds, do_tick);
+    UpdateAutopilotFromBatch(self, cmds, batch_responses);
+    return batch_responses;
+  }();
+
+  boost::python::list result;
+  for (auto &response : responses) {
+    result.append(std::move(response));
+  }
   return result;
 }
+
 /*此函数与ApplyBatchCommands类似，但它是同步执行批量命令并进行一些额外的处理。
 首先同样将boost::python::object类型的commands对象转换为CommandType类型的向量cmds，然后调用客户端的ApplyBatchSync方法获取命令执行的响应结果，并将这些结果逐个添加到boost::python::list类型的result对象中。
 接下来，主要进行了与自动驾驶相关命令的处理：
@@ -193,13 +264,185 @@ static auto ApplyBatchCommandsSync(
 为了并行处理这些命令检查，将命令分成多个批次，每个批次最多处理TaskLimit个命令，创建相应数量的线程来并行执行ProcessCommand函数处理每个批次的命令。
 在所有线程执行完毕后，根据实际添加到vehicles_to_enable和vehicles_to_disable向量中的元素数量调整向量大小，并进行内存释放操作（通过shrink_to_fit）。
 最后，对要启用和禁用自动驾驶的车辆指针向量进行排序，确保按照演员 ID 从小到大的顺序排列，然后如果这两个向量中有元素，就通过客户端获取交通管理器实例，并分别注册要启用自动驾驶的车辆和注销要禁用自动驾驶的车辆。*/
+
+// Result of a batch sent with apply_batch_async or spawn_actors_async. The
+// autopilot of the spawned vehicles is updated in the traffic manager when the
+// result is retrieved. It can also be awaited in asyncio.
+class BatchResponseFuture {
+public:
+
+  BatchResponseFuture(
+      carla::client::Client client,
+      carla::client::RpcFuture<std::vector<carla::rpc::CommandResponse>> future)
+    : _client(std::move(client)),
+      _future(std::move(future)) {}
+
+  BatchResponseFuture(
+      carla::client::Client client,
+      std::vector<carla::rpc::Command> commands)
+    : _client(std::move(client)),
+      _commands(std::make_shared<Commands>(std::move(commands))),
+      _future(_client.ApplyBatchAsync(_commands->commands)) {}
+
+  bool IsReady() const {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return _future.IsReady();
+  }
+
+  bool Wait(double seconds) const {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return _future.WaitFor(TimeDurationFromSeconds(seconds));
+  }
+
+  boost::python::list Get() const {
+    std::vector<carla::rpc::CommandResponse> responses;
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      responses = _future.Get();
+      if (_commands != nullptr) {
+        std::lock_guard<std::mutex> lock(_commands->mutex);
+        // Only once, the result is cached by the future.
+        if (!_commands->autopilot_updated) {
+          UpdateAutopilotFromBatch(_client, _commands->commands, responses);
+          _commands->autopilot_updated = true;
+        }
+      }
+    }
+    boost::python::list result;
+    for (auto &response : responses) {
+      result.append(std::move(response));
+    }
+    return result;
+  }
+
+  // Returns the iterator of an asyncio.Future, the responses are retrieved in
+  // the background thread of AsyncIOWaiter instead of blocking the event loop.
+  boost::python::object Await() const {
+    auto self = *this;
+    auto future = AwaitRpcFuture(_future, [self](const auto &) {
+      return boost::python::object(self.Get());
+    });
+    return future.attr("__await__")();
+  }
+
+private:
+
+  // Shared by the copies, an awaited future is copied to the waiter thread.
+  struct Commands {
+    explicit Commands(std::vector<carla::rpc::Command> in_commands)
+      : commands(std::move(in_commands)) {}
+
+    std::mutex mutex;
+    std::vector<carla::rpc::Command> commands;
+    bool autopilot_updated = false;
+  };
+
+  carla::client::Client _client;
+
+  std::shared_ptr<Commands> _commands;
+
+  carla::client::RpcFuture<std::vector<carla::rpc::CommandResponse>> _future;
+};
+
+static auto ApplyBatchCommandsAsync(
+    const carla::client::Client &self,
+    const boost::python::object &commands) {
+  std::vector<carla::rpc::Command> cmds = ReadCommands(commands);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return BatchResponseFuture(self, std::move(cmds));
+}
+
+// Make a spawn request, the description of each blueprint object is sent only
+// once no matter how many actors use it.
+static carla::rpc::ActorSpawnBatch MakeActorSpawnBatch(
+    const boost::python::object &blueprints,
+    const boost::python::object &transforms,
+    const boost::python::object &parents,
+    float validation_radius) {
+  namespace bp = boost::python;
+  const auto size = bp::len(transforms);
+  if ((bp::len(blueprints) != size) || (!parents.is_none() && (bp::len(parents) != size))) {
+    PyErr_SetString(PyExc_ValueError, "blueprints, transforms and parents must have the same length");
+    bp::throw_error_already_set();
+  }
+  carla::rpc::ActorSpawnBatch batch;
+  batch.validation_radius = validation_radius;
+  batch.entries.reserve(static_cast<size_t>(size));
+  std::unordered_map<PyObject *, uint32_t> descriptions;
+  for (auto i = 0; i < size; ++i) {
+    bp::object blueprint = blueprints[i];
+    auto it = descriptions.find(blueprint.ptr());
+    if (it == descriptions.end()) {
+      const carla::client::ActorBlueprint &actor_blueprint =
+          bp::extract<const carla::client::ActorBlueprint &>(blueprint);
+      it = descriptions.emplace(
+          blueprint.ptr(),
+          batch.AddDescription(actor_blueprint.MakeActorDescription())).first;
+    }
+    carla::rpc::ActorId parent = 0u;
+    if (!parents.is_none()) {
+      bp::object parent_actor = parents[i];
+      if (!parent_actor.is_none()) {
+        parent = bp::extract<carla::rpc::ActorId>(parent_actor.attr("id"));
+      }
+    }
+    batch.Add(it->second, bp::extract<carla::geom::Transform>(transforms[i]), parent);
+  }
+  return batch;
+}
+
+static auto SpawnActors(
+    const carla::client::Client &self,
+    const boost::python::object &blueprints,
+    const boost::python::object &transforms,
+    const boost::python::object &parents,
+    float validation_radius) {
+  auto batch = MakeActorSpawnBatch(blueprints, transforms, parents, validation_radius);
+  std::vector<carla::rpc::CommandResponse> responses;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    responses = self.SpawnActors(batch);
+  }
+  boost::python::list result;
+  for (auto &response : responses) {
+    result.append(std::move(response));
+  }
+  return result;
+}
+
+static auto SpawnActorsAsync(
+    const carla::client::Client &self,
+    const boost::python::object &blueprints,
+    const boost::python::object &transforms,
+    const boost::python::object &parents,
+    float validation_radius) {
+  auto batch = MakeActorSpawnBatch(blueprints, transforms, parents, validation_radius);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return BatchResponseFuture(self, self.SpawnActorsAsync(batch));
+}
+
+static auto ApplyBatchesSync(
+    const carla::client::Client &self,
+    const boost::python::object &batches) {
+  // Send every batch before waiting for the first response, so that all of
+  // them are in flight at the same time.
+  std::vector<BatchResponseFuture> futures;
+  for (boost::python::stl_input_iterator<boost::python::object> it(batches), end; it != end; ++it) {
+    futures.emplace_back(ApplyBatchCommandsAsync(self, *it));
+  }
+  boost::python::list result;
+  for (auto &future : futures) {
+    result.append(future.Get());
+  }
+  return result;
+}
 void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
   namespace rpc = carla::rpc;
 
   class_<rpc::OpendriveGenerationParameters>("OpendriveGenerationParameters",
-      init<double, double, double, double, bool, bool, bool>((arg("vertex_distance")=2.0, arg("max_road_length")=50.0, arg("wall_height")=1.0, arg("additional_width")=0.6, arg("smooth_junctions")=true, arg("enable_mesh_visibility")=true, arg("enable_pedestrian_navigation")=true)))
+      init<double, double, double, double, bool, bool, bool, bool>((arg("vertex_distance")=2.0, arg("max_road_length")=50.0, arg("wall_height")=1.0, arg("additional_width")=0.6, arg("smooth_junctions")=true, arg("enable_mesh_visibility")=true, arg("enable_pedestrian_navigation")=true, arg("enable_mesh_streaming")=false)))
     .def_readwrite("vertex_distance", &rpc::OpendriveGenerationParameters::vertex_distance)
     .def_readwrite("max_road_length", &rpc::OpendriveGenerationParameters::max_road_length)
     .def_readwrite("wall_height", &rpc::OpendriveGenerationParameters::wall_height)
@@ -207,6 +450,14 @@ void export_client() {
     .def_readwrite("smooth_junctions", &rpc::OpendriveGenerationParameters::smooth_junctions)
     .def_readwrite("enable_mesh_visibility", &rpc::OpendriveGenerationParameters::enable_mesh_visibility)
     .def_readwrite("enable_pedestrian_navigation", &rpc::OpendriveGenerationParameters::enable_pedestrian_navigation)
+    .def_readwrite("enable_mesh_streaming", &rpc::OpendriveGenerationParameters::enable_mesh_streaming)
+  ;
+
+  class_<BatchResponseFuture>("BatchResponseFuture", no_init)
+    .def("done", &BatchResponseFuture::IsReady)
+    .def("wait", &BatchResponseFuture::Wait, (arg("seconds")))
+    .def("get", &BatchResponseFuture::Get)
+    .def("__await__", &BatchResponseFuture::Await)
   ;
 
   class_<cc::Client>("Client",
@@ -217,15 +468,18 @@ void export_client() {
     .def("get_world", &cc::Client::GetWorld)
     .def("get_available_maps", &GetAvailableMaps)
     .def("set_files_base_folder", &cc::Client::SetFilesBaseFolder, (arg("path")))
-    .def("get_required_files", &GetRequiredFiles, (arg("folder")="", arg("download")=true))
-    .def("request_file", &cc::Client::RequestFile, (arg("name")))
+    .def("get_required_files", &GetRequiredFiles, (arg("folder")="", arg("download")=true, arg("progress")=boost::python::object()))
+    .def("request_file", &RequestFile, (arg("name"), arg("progress")=boost::python::object()))
     .def("reload_world", CONST_CALL_WITHOUT_GIL_1(cc::Client, ReloadWorld, bool), (arg("reset_settings")=true))
+    .def("soft_reset_world", CONST_CALL_WITHOUT_GIL_1(cc::Client, SoftResetWorld, bool), (arg("reset_settings")=true))
     .def("load_world", CONST_CALL_WITHOUT_GIL_3(cc::Client, LoadWorld, std::string, bool, rpc::MapLayer), (arg("map_name"), arg("reset_settings")=true, arg("map_layers")=rpc::MapLayer::All))
     .def("load_world_if_different", &cc::Client::LoadWorldIfDifferent, (arg("map_name"), arg("reset_settings")=true, arg("map_layers")=rpc::MapLayer::All))
     .def("generate_opendrive_world", CONST_CALL_WITHOUT_GIL_3(cc::Client, GenerateOpenDriveWorld, std::string,
         rpc::OpendriveGenerationParameters, bool), (arg("opendrive"), arg("parameters")=rpc::OpendriveGenerationParameters(),
         arg("reset_settings")=true))
-    .def("start_recorder", CALL_WITHOUT_GIL_2(cc::Client, StartRecorder, std::string, bool), (arg("name"), arg("additional_data")=false))
+    .def("start_recorder", CALL_WITHOUT_GIL_3(cc::Client, StartRecorder, std::string, bool, bool), (arg("name"), arg("additional_data")=false, arg("compressed")=false))
+    .def("start_flight_recorder", CALL_WITHOUT_GIL_5(cc::Client, StartFlightRecorder, std::string, double, double, bool, bool), (arg("name"), arg("seconds"), arg("seconds_after"), arg("additional_data")=false, arg("compressed")=false))
+    .def("trigger_flight_recorder", CALL_WITHOUT_GIL(cc::Client, TriggerFlightRecorder))
     .def("stop_recorder", &cc::Client::StopRecorder)
     .def("show_recorder_file_info", CALL_WITHOUT_GIL_2(cc::Client, ShowRecorderFileInfo, std::string, bool), (arg("name"), arg("show_all")))
     .def("show_recorder_collisions", CALL_WITHOUT_GIL_3(cc::Client, ShowRecorderCollisions, std::string, char, char), (arg("name"), arg("type1"), arg("type2")))
@@ -235,8 +489,15 @@ void export_client() {
     .def("set_replayer_time_factor", &cc::Client::SetReplayerTimeFactor, (arg("time_factor")))
     .def("set_replayer_ignore_hero", &cc::Client::SetReplayerIgnoreHero, (arg("ignore_hero")))
     .def("set_replayer_ignore_spectator", &cc::Client::SetReplayerIgnoreSpectator, (arg("ignore_spectator")))
+    .def("set_replayer_skip_physics", &cc::Client::SetReplayerSkipPhysics, (arg("skip_physics")))
+    .def("set_replayer_frame_step", &cc::Client::SetReplayerFrameStep, (arg("frame_step")))
+    .def("get_replayer_frame", CONST_CALL_WITHOUT_GIL(cc::Client, GetReplayerFrame))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("apply_batch_async", &ApplyBatchCommandsAsync, (arg("commands")))
+    .def("apply_batches_sync", &ApplyBatchesSync, (arg("batches")))
+    .def("spawn_actors", &SpawnActors, (arg("blueprints"), arg("transforms"), arg("parents")=object(), arg("validation_radius")=0.0f))
+    .def("spawn_actors_async", &SpawnActorsAsync, (arg("blueprints"), arg("transforms"), arg("parents")=object(), arg("validation_radius")=0.0f))
     .def("get_trafficmanager", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetInstanceTM, uint16_t), (arg("port")=ctm::TM_DEFAULT_PORT))
   ;
 }
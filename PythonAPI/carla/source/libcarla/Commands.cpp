@@ -8,6 +8,10 @@
 #include <carla/rpc/Command.h>
 #include <carla/rpc/CommandResponse.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 // 定义默认端口号
 #define TM_DEFAULT_PORT     8000
 
@@ -49,6 +53,223 @@ namespace command_impl {
     return self;
   }
 
+  // ===========================================================================
+  // -- 从数组批量创建命令 ------------------------------------------------------
+  // ===========================================================================
+
+  // 按行存放的数值数组，一维数组的每行只有一个元素
+  struct NumericArray {
+    std::vector<double> data;
+    size_t rows = 0u;
+    size_t columns = 1u;
+
+    double At(size_t row, size_t column) const {
+      return data[row * columns + column];
+    }
+  };
+
+  static void ThrowValueError(const std::string &message) {
+    PyErr_SetString(PyExc_ValueError, message.c_str());
+    boost::python::throw_error_already_set();
+  }
+
+#if PY_MAJOR_VERSION >= 3
+
+  template <typename T>
+  static void CopyBufferData(const void *buffer, NumericArray &array) {
+    const auto *data = static_cast<const T *>(buffer);
+    array.data.resize(array.rows * array.columns);
+    for (size_t i = 0u; i < array.data.size(); ++i) {
+      array.data[i] = static_cast<double>(data[i]);
+    }
+  }
+
+  // 从形状为 (N,) 或 (N, K) 的数值缓冲区（如 numpy 数组）复制数据，
+  // 支持浮点数、整数与布尔类型
+  static bool ReadBufferData(PyObject *object, NumericArray &array) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+      PyErr_Clear();
+      return false;
+    }
+    std::string format = (view.format != nullptr) ? view.format : "B";
+    if (!format.empty() && (format[0u] == '<' || format[0u] == '=' || format[0u] == '@')) {
+      format.erase(0u, 1u);
+    }
+    bool valid = ((view.ndim == 1) || (view.ndim == 2)) && (format.size() == 1u);
+    if (valid) {
+      array.rows = static_cast<size_t>(view.shape[0u]);
+      array.columns = (view.ndim == 2) ? static_cast<size_t>(view.shape[1u]) : 1u;
+      const bool is_signed = std::string("bhilq").find(format[0u]) != std::string::npos;
+      const bool is_unsigned = std::string("BHILQ?").find(format[0u]) != std::string::npos;
+      if (format[0u] == 'f' && view.itemsize == 4) {
+        CopyBufferData<float>(view.buf, array);
+      } else if (format[0u] == 'd' && view.itemsize == 8) {
+        CopyBufferData<double>(view.buf, array);
+      } else if (is_signed || is_unsigned) {
+        switch (view.itemsize) {
+          case 1: is_signed ? CopyBufferData<int8_t>(view.buf, array) : CopyBufferData<uint8_t>(view.buf, array); break;
+          case 2: is_signed ? CopyBufferData<int16_t>(view.buf, array) : CopyBufferData<uint16_t>(view.buf, array); break;
+          case 4: is_signed ? CopyBufferData<int32_t>(view.buf, array) : CopyBufferData<uint32_t>(view.buf, array); break;
+          case 8: is_signed ? CopyBufferData<int64_t>(view.buf, array) : CopyBufferData<uint64_t>(view.buf, array); break;
+          default: valid = false;
+        }
+      } else {
+        valid = false;
+      }
+    }
+    PyBuffer_Release(&view);
+    return valid;
+  }
+
+#endif // PY_MAJOR_VERSION >= 3
+
+  // 读取形状为 (N,) 或 (N, K) 的数值数组，也接受由数字或数字序列组成的序列
+  static NumericArray ReadNumericArray(const boost::python::object &object, const char *name) {
+    namespace py = boost::python;
+    NumericArray array;
+#if PY_MAJOR_VERSION >= 3
+    if (PyObject_CheckBuffer(object.ptr()) != 0) {
+      if (!ReadBufferData(object.ptr(), array)) {
+        ThrowValueError(std::string(name) + " must be a contiguous array of shape (N,) or (N, K) of numbers");
+      }
+      return array;
+    }
+#endif // PY_MAJOR_VERSION >= 3
+    array.rows = static_cast<size_t>(py::len(object));
+    for (size_t i = 0u; i < array.rows; ++i) {
+      py::object row = object[i];
+      const bool is_sequence = PySequence_Check(row.ptr()) != 0;
+      const size_t columns = is_sequence ? static_cast<size_t>(py::len(row)) : 1u;
+      if (i == 0u) {
+        array.columns = columns;
+        array.data.reserve(array.rows * array.columns);
+      } else if (columns != array.columns) {
+        ThrowValueError(std::string(name) + " must have the same number of elements in each row");
+      }
+      if (is_sequence) {
+        for (size_t j = 0u; j < columns; ++j) {
+          array.data.push_back(py::extract<double>(row[j]));
+        }
+      } else {
+        array.data.push_back(py::extract<double>(row));
+      }
+    }
+    return array;
+  }
+
+  // 读取 @a size 行、每行 @a min_columns 到 @a max_columns 个元素的数组
+  static NumericArray ReadRows(
+      const boost::python::object &object,
+      const char *name,
+      size_t size,
+      size_t min_columns,
+      size_t max_columns) {
+    NumericArray array = ReadNumericArray(object, name);
+    if (array.rows != size) {
+      ThrowValueError(std::string(name) + " must have one row per actor");
+    }
+    if ((size > 0u) && ((array.columns < min_columns) || (array.columns > max_columns))) {
+      ThrowValueError(
+          std::string(name) + " must have between " + std::to_string(min_columns) +
+          " and " + std::to_string(max_columns) + " columns");
+    }
+    return array;
+  }
+
+  static std::vector<carla::rpc::ActorId> ReadActorIds(const boost::python::object &object) {
+    NumericArray array = ReadNumericArray(object, "actor_ids");
+    if ((array.rows > 0u) && (array.columns != 1u)) {
+      ThrowValueError("actor_ids must be a one-dimensional array");
+    }
+    std::vector<carla::rpc::ActorId> ids(array.rows);
+    for (size_t i = 0u; i < array.rows; ++i) {
+      ids[i] = static_cast<carla::rpc::ActorId>(array.At(i, 0u));
+    }
+    return ids;
+  }
+
+  // 每行为 [x, y, z, pitch, yaw, roll]
+  static carla::geom::Transform ReadTransform(const NumericArray &array, size_t row) {
+    return carla::geom::Transform(
+        carla::geom::Location(
+            static_cast<float>(array.At(row, 0u)),
+            static_cast<float>(array.At(row, 1u)),
+            static_cast<float>(array.At(row, 2u))),
+        carla::geom::Rotation(
+            static_cast<float>(array.At(row, 3u)),
+            static_cast<float>(array.At(row, 4u)),
+            static_cast<float>(array.At(row, 5u))));
+  }
+
+  static CommandBatch MakeApplyTransformBatch(
+      const boost::python::object &actor_ids,
+      const boost::python::object &transforms) {
+    const auto ids = ReadActorIds(actor_ids);
+    const auto values = ReadRows(transforms, "transforms", ids.size(), 6u, 6u);
+    CommandBatch batch;
+    batch.commands.reserve(ids.size());
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      batch.commands.emplace_back(carla::rpc::Command::ApplyTransform{ids[i], ReadTransform(values, i)});
+    }
+    return batch;
+  }
+
+  // 每行为 [throttle, steer, brake, hand_brake, reverse, manual_gear_shift, gear]，
+  // 可以省略末尾的列，省略的值取默认值
+  static CommandBatch MakeApplyVehicleControlBatch(
+      const boost::python::object &actor_ids,
+      const boost::python::object &controls) {
+    const auto ids = ReadActorIds(actor_ids);
+    const auto values = ReadRows(controls, "controls", ids.size(), 1u, 7u);
+    CommandBatch batch;
+    batch.commands.reserve(ids.size());
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      auto get = [&](size_t column) {
+        return (column < values.columns) ? values.At(i, column) : 0.0;
+      };
+      carla::rpc::VehicleControl control(
+          static_cast<float>(get(0u)),
+          static_cast<float>(get(1u)),
+          static_cast<float>(get(2u)),
+          get(3u) != 0.0,
+          get(4u) != 0.0,
+          get(5u) != 0.0,
+          static_cast<int32_t>(get(6u)));
+      batch.commands.emplace_back(carla::rpc::Command::ApplyVehicleControl{ids[i], control});
+    }
+    return batch;
+  }
+
+  // @a speeds 可以是每个行人一个值的数组，也可以是所有行人共用的一个数
+  static CommandBatch MakeApplyWalkerStateBatch(
+      const boost::python::object &actor_ids,
+      const boost::python::object &transforms,
+      const boost::python::object &speeds) {
+    namespace py = boost::python;
+    const auto ids = ReadActorIds(actor_ids);
+    const auto values = ReadRows(transforms, "transforms", ids.size(), 6u, 6u);
+    NumericArray speed_values;
+    py::extract<float> common_speed(speeds);
+    const bool is_common = common_speed.check() && (PySequence_Check(speeds.ptr()) == 0);
+    if (!is_common) {
+      speed_values = ReadRows(speeds, "speeds", ids.size(), 1u, 1u);
+    }
+    CommandBatch batch;
+    batch.commands.reserve(ids.size());
+    for (size_t i = 0u; i < ids.size(); ++i) {
+      const float speed = is_common ? common_speed() : static_cast<float>(speed_values.At(i, 0u));
+      batch.commands.emplace_back(carla::rpc::Command::ApplyWalkerState{ids[i], ReadTransform(values, i), speed});
+    }
+    return batch;
+  }
+
+  // 追加另一个批次或任意命令序列中的命令
+  static void ExtendBatch(CommandBatch &self, const boost::python::object &commands) {
+    auto other = ReadCommands(commands);
+    self.commands.insert(self.commands.end(), other.begin(), other.end());
+  }
+
 } // namespace command_impl
 
 // 导出命令的函数
@@ -295,6 +516,18 @@ void export_commands() {
    .def_readwrite("light_state", &cr::Command::SetVehicleLightState::light_state)
   ;
 
+  // 为 CommandBatch 添加 Python 绑定，批量命令在 C++ 中一次创建
+  class_<CommandBatch>("CommandBatch")
+   .def("__len__", +[](const CommandBatch &self) { return self.commands.size(); })
+   .def("extend", &command_impl::ExtendBatch, (arg("commands")))
+   .def("apply_transform", &command_impl::MakeApplyTransformBatch, (arg("actor_ids"), arg("transforms")))
+   .staticmethod("apply_transform")
+   .def("apply_vehicle_control", &command_impl::MakeApplyVehicleControlBatch, (arg("actor_ids"), arg("controls")))
+   .staticmethod("apply_vehicle_control")
+   .def("apply_walker_state", &command_impl::MakeApplyWalkerStateBatch, (arg("actor_ids"), arg("transforms"), arg("speeds")))
+   .staticmethod("apply_walker_state")
+  ;
+
   // 定义不同命令类到 carla::rpc::Command 的隐式转换
   implicitly_convertible<cr::Command::SpawnActor, cr::Command>();
   implicitly_convertible<cr::Command::DestroyActor, cr::Command>();
@@ -100,6 +100,151 @@ static void TransformList(const carla::geom::Transform &self, boost::python::lis
     self.TransformPoint(boost::python::extract<carla::geom::Vector3D &>(list[i]));
   }
 }
+#if PY_MAJOR_VERSION >= 3
+
+// 从 N×3 的 float32 或 float64 数组（如 numpy 数组）中读取位置
+static bool ReadLocationsFromBuffer(PyObject *object, std::vector<carla::geom::Location> &locations) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    return false;
+  }
+  std::string format = (view.format != nullptr) ? view.format : "B";
+  if (!format.empty() && (format[0u] == '<' || format[0u] == '=' || format[0u] == '@')) {
+    format.erase(0u, 1u);
+  }
+  const bool valid_shape = (view.ndim == 2) && (view.shape[1u] == 3);
+  if (!valid_shape || (format != "f" && format != "d")) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "locations must be an array of shape (N, 3) and type float32 or float64");
+    return false;
+  }
+  const auto size = static_cast<size_t>(view.shape[0u]);
+  locations.resize(size);
+  if (format == "f") {
+    const auto *data = static_cast<const float *>(view.buf);
+    for (size_t i = 0u; i < size; ++i) {
+      locations[i] = carla::geom::Location(data[3u * i], data[3u * i + 1u], data[3u * i + 2u]);
+    }
+  } else {
+    const auto *data = static_cast<const double *>(view.buf);
+    for (size_t i = 0u; i < size; ++i) {
+      locations[i] = carla::geom::Location(
+          static_cast<float>(data[3u * i]),
+          static_cast<float>(data[3u * i + 1u]),
+          static_cast<float>(data[3u * i + 2u]));
+    }
+  }
+  PyBuffer_Release(&view);
+  return true;
+}
+
+#endif // PY_MAJOR_VERSION >= 3
+
+#if PY_MAJOR_VERSION >= 3
+
+// 把按行存放的 float32 数据复制到新的缓冲区，返回形状为 @a shape 的内存视图，
+// 可以用 numpy.asarray 不复制地转换为数组。内存视图不能有长度为 0 的维度，
+// 没有数据时返回一维的空视图。
+static boost::python::object MakeFloatArray(const std::vector<float> &data, const std::vector<Py_ssize_t> &shape) {
+  namespace py = boost::python;
+  py::object bytes(py::handle<>(PyByteArray_FromStringAndSize(
+      reinterpret_cast<const char *>(data.data()),
+      static_cast<Py_ssize_t>(data.size() * sizeof(float)))));
+  py::object view(py::handle<>(PyMemoryView_FromObject(bytes.ptr())));
+  if (data.empty()) {
+    return view.attr("cast")("f");
+  }
+  py::list dimensions;
+  for (auto dimension : shape) {
+    dimensions.append(dimension);
+  }
+  return view.attr("cast")("f", dimensions);
+}
+
+// 读取 carla.Location 的列表或 N×3 的数组，按坐标分别存放
+static void ReadPointsSoA(
+    const boost::python::object &points,
+    std::vector<float> &x,
+    std::vector<float> &y,
+    std::vector<float> &z) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> locations;
+  if (PyObject_CheckBuffer(points.ptr()) != 0) {
+    if (!ReadLocationsFromBuffer(points.ptr(), locations)) {
+      py::throw_error_already_set();
+    }
+  } else {
+    const auto size = py::len(points);
+    locations.reserve(static_cast<size_t>(size));
+    for (auto i = 0; i < size; ++i) {
+      locations.emplace_back(py::extract<carla::geom::Location>(points[i]));
+    }
+  }
+  x.resize(locations.size());
+  y.resize(locations.size());
+  z.resize(locations.size());
+  for (size_t i = 0u; i < locations.size(); ++i) {
+    x[i] = locations[i].x;
+    y[i] = locations[i].y;
+    z[i] = locations[i].z;
+  }
+}
+
+// 把按坐标分别存放的点交错为 (..., 3) 的数组，@a shape 为去掉最后一维的形状
+static boost::python::object MakePointArray(
+    const std::vector<float> &x,
+    const std::vector<float> &y,
+    const std::vector<float> &z,
+    std::vector<Py_ssize_t> shape) {
+  std::vector<float> data(3u * x.size());
+  for (size_t i = 0u; i < x.size(); ++i) {
+    data[3u * i] = x[i];
+    data[3u * i + 1u] = y[i];
+    data[3u * i + 2u] = z[i];
+  }
+  shape.push_back(3);
+  return MakeFloatArray(data, shape);
+}
+
+// 批量变换点，返回 N×3 的数组
+template <bool Inverse>
+static boost::python::object TransformPoints(const carla::geom::Transform &self, const boost::python::object &points) {
+  std::vector<float> x, y, z;
+  ReadPointsSoA(points, x, y, z);
+  if (Inverse) {
+    self.InverseTransformPoints(x.data(), y.data(), z.data(), x.size());
+  } else {
+    self.TransformPoints(x.data(), y.data(), z.data(), x.size());
+  }
+  return MakePointArray(x, y, z, {static_cast<Py_ssize_t>(x.size())});
+}
+
+// 返回 N×8×3 的数组，第 i 个边界框的顶点用第 i 个变换转换到世界空间
+static boost::python::object GetWorldVerticesBatch(
+    const boost::python::object &boxes,
+    const boost::python::object &transforms) {
+  namespace py = boost::python;
+  const auto size = py::len(boxes);
+  if (py::len(transforms) != size) {
+    PyErr_SetString(PyExc_ValueError, "bounding_boxes and transforms must have the same length");
+    py::throw_error_already_set();
+  }
+  std::vector<carla::geom::BoundingBox> input_boxes;
+  std::vector<carla::geom::Transform> input_transforms;
+  input_boxes.reserve(static_cast<size_t>(size));
+  input_transforms.reserve(static_cast<size_t>(size));
+  for (auto i = 0; i < size; ++i) {
+    input_boxes.emplace_back(py::extract<carla::geom::BoundingBox>(boxes[i]));
+    input_transforms.emplace_back(py::extract<carla::geom::Transform>(transforms[i]));
+  }
+  std::vector<float> x(8u * input_boxes.size()), y(x.size()), z(x.size());
+  carla::geom::BoundingBox::GetWorldVertices(
+      input_boxes.data(), input_transforms.data(), input_boxes.size(), x.data(), y.data(), z.data());
+  return MakePointArray(x, y, z, {static_cast<Py_ssize_t>(size), 8});
+}
+
+#endif // PY_MAJOR_VERSION >= 3
+
 // 定义一个函数，用于将一个16元素的float数组转换为一个4x4的boost::python::list。
 static boost::python::list BuildMatrix(const std::array<float, 16> &m) {
   boost::python::list r_out;
@@ -254,6 +399,10 @@ void export_geom() {
       self.TransformVector(vector);
       return vector;
     }, arg("in_point"))
+#if PY_MAJOR_VERSION >= 3
+    .def("transform_points", &TransformPoints<false>, arg("points"))
+    .def("inverse_transform_points", &TransformPoints<true>, arg("points"))
+#endif // PY_MAJOR_VERSION >= 3
     .def("get_forward_vector", &cg::Transform::GetForwardVector)
     .def("get_right_vector", &cg::Transform::GetRightVector)
     .def("get_up_vector", &cg::Transform::GetUpVector)
@@ -278,6 +427,10 @@ void export_geom() {
     .def("contains", &cg::BoundingBox::Contains, arg("point"), arg("bbox_transform"))
     .def("get_local_vertices", CALL_RETURNING_LIST(cg::BoundingBox, GetLocalVertices))
     .def("get_world_vertices", CALL_RETURNING_LIST_1(cg::BoundingBox, GetWorldVertices, const cg::Transform&), arg("bbox_transform"))
+#if PY_MAJOR_VERSION >= 3
+    .def("get_world_vertices_batch", &GetWorldVerticesBatch, (arg("bounding_boxes"), arg("transforms")))
+    .staticmethod("get_world_vertices_batch")
+#endif // PY_MAJOR_VERSION >= 3
     .def("__eq__", &cg::BoundingBox::operator==)
     .def("__ne__", &cg::BoundingBox::operator!=)
     .def(self_ns::str(self_ns::self))
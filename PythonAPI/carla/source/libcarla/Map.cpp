@@ -10,6 +10,7 @@
 #include <carla/FileSystem.h>
 #include <carla/PythonUtil.h>
 #include <carla/client/Junction.h>
+#include <carla/client/LanePath.h>
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
 #include <carla/road/element/LaneMarking.h>
@@ -57,8 +58,11 @@ static void SaveOpenDriveToDisk(const carla::client::Map &self, std::string path
 static auto GetTopology(const carla::client::Map &self) {
   // 引入 boost::python 命名空间，用于与 Python 交互
   namespace py = boost::python;
-  // 获取地图的拓扑结构
-  auto topology = self.GetTopology();
+  // 获取地图的拓扑结构，遍历所有道路的计算在释放 GIL 时进行
+  auto topology = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return self.GetTopology();
+  }();
   // 创建一个 Python 列表，用于存储结果
   py::list result;
   // 遍历拓扑结构，并将每个键值对转换为 Python 元组后添加到结果列表中
@@ -74,7 +78,10 @@ static auto GetJunctionWaypoints(const carla::client::Junction &self, const carl
   // 引入 boost::python 命名空间，用于与 Python 交互
   namespace py = boost::python;
   // 获取交叉路口的车道点
-  auto topology = self.GetWaypoints(lane_type);
+  auto topology = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return self.GetWaypoints(lane_type);
+  }();
   // 创建一个 Python 列表，用于存储结果
   py::list result;
   // 遍历车道点，并将每个键值对转换为 Python 元组后添加到结果列表中
@@ -109,6 +116,151 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+// 定义一个静态函数，用于批量获取路点，位置可以是 carla.Location 的列表或 N×3 的数组
+static boost::python::list GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> input;
+#if PY_MAJOR_VERSION >= 3
+  const bool is_buffer = PyObject_CheckBuffer(locations.ptr()) != 0;
+  if (is_buffer && !ReadLocationsFromBuffer(locations.ptr(), input)) {
+    py::throw_error_already_set();
+  }
+#else
+  const bool is_buffer = false;
+#endif
+  if (!is_buffer) {
+    const auto size = py::len(locations);
+    input.reserve(static_cast<size_t>(size));
+    for (auto i = 0; i < size; ++i) {
+      input.emplace_back(py::extract<carla::geom::Location>(locations[i]));
+    }
+  }
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetWaypoints(input, project_to_road, lane_type);
+  }
+  py::list result;
+  for (auto &waypoint : waypoints) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+// 沿车道采样的路点的 Python 接口，保持数据在 Python 对象存活期间有效。
+struct LanePathView {
+  std::shared_ptr<const carla::client::LanePath> path;
+};
+
+// 采样路点中的一列，通过缓冲区协议导出，numpy 可以不复制数据直接使用。
+struct LanePathColumn {
+  std::shared_ptr<const carla::client::LanePath> owner;
+  const void *data = nullptr;
+  const char *format = nullptr;
+  Py_ssize_t itemsize = 0;
+  int ndim = 1;
+  Py_ssize_t shape[2u] = {0, 0};
+  Py_ssize_t strides[2u] = {0, 0};
+};
+
+#if PY_MAJOR_VERSION >= 3
+
+static int GetLanePathColumnBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "lane path columns are read-only");
+    view->obj = nullptr;
+    return -1;
+  }
+  const LanePathColumn &column = boost::python::extract<const LanePathColumn &>(exporter)();
+  Py_INCREF(exporter);
+  view->obj = exporter;
+  view->buf = const_cast<void *>(column.data);
+  view->len = column.shape[0u] * column.strides[0u];
+  view->readonly = 1;
+  view->itemsize = column.itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char *>(column.format) : nullptr;
+  view->ndim = column.ndim;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? const_cast<Py_ssize_t *>(column.shape) : nullptr;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? const_cast<Py_ssize_t *>(column.strides) : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+static PyBufferProcs LanePathColumnBufferProcs = { &GetLanePathColumnBuffer, nullptr };
+
+#endif // PY_MAJOR_VERSION >= 3
+
+// 返回列的内存视图，可以用 numpy.asarray 不复制地转换为数组。
+template <typename T>
+static boost::python::object GetLanePathColumnAsBuffer(
+    const LanePathView &self,
+    const std::vector<T> &column,
+    const char *format,
+    size_t row_size) {
+  LanePathColumn result;
+  result.owner = self.path;
+  result.data = column.data();
+  result.format = format;
+  result.itemsize = sizeof(T);
+  result.ndim = (row_size > 1u) ? 2 : 1;
+  result.shape[0u] = static_cast<Py_ssize_t>(column.size() / row_size);
+  result.shape[1u] = static_cast<Py_ssize_t>(row_size);
+  result.strides[0u] = static_cast<Py_ssize_t>(row_size * sizeof(T));
+  result.strides[1u] = static_cast<Py_ssize_t>(sizeof(T));
+  boost::python::object exporter(std::move(result));
+#if PY_MAJOR_VERSION >= 3
+  auto *ptr = PyMemoryView_FromObject(exporter.ptr());
+#else
+  // Python 2 的缓冲区不保存所有者，只要采样结果存在就有效。
+  auto *ptr = PyBuffer_FromMemory(const_cast<T *>(column.data()), sizeof(T) * column.size());
+#endif
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
+// 沿车道采样路点，采样过程中释放 GIL
+static LanePathView SampleLanePath(
+    const carla::client::Waypoint &self,
+    double distance,
+    size_t count,
+    bool until_lane_end,
+    bool forward) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return LanePathView{forward ?
+      self.SampleNext(distance, count, until_lane_end) :
+      self.SamplePrevious(distance, count, until_lane_end)};
+}
+
+// 用修改后的 OpenDRIVE 内容创建新版本的地图，生成过程中释放 GIL
+static carla::SharedPtr<carla::client::Map> MakeUpdatedMap(
+    const carla::client::Map &self,
+    std::string xodr_content) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.MakeUpdated(std::move(xodr_content));
+}
+
+// 以字典返回与前一个版本相比变化的道路
+static boost::python::dict GetMapUpdate(const carla::client::Map &self) {
+  namespace py = boost::python;
+  const auto &update = self.GetMap().GetUpdate();
+  const auto to_list = [](const std::vector<carla::road::RoadId> &roads) {
+    py::list result;
+    for (auto road_id : roads) {
+      result.append(road_id);
+    }
+    return result;
+  };
+  py::dict result;
+  result["added"] = to_list(update.added_roads);
+  result["removed"] = to_list(update.removed_roads);
+  result["replaced"] = to_list(update.replaced_roads);
+  return result;
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -190,18 +342,21 @@ void export_map() {
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     .def("get_topology", &GetTopology)
-    .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("generate_waypoints", CALL_RETURNING_LIST_WITHOUT_GIL_1(cc::Map, GenerateWaypoints, double), (args("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
     .def("get_crosswalks", CALL_RETURNING_LIST(cc::Map, GetAllCrosswalkZones))
-    .def("get_all_landmarks", CALL_RETURNING_LIST(cc::Map, GetAllLandmarks))
+    .def("get_all_landmarks", CALL_RETURNING_LIST_WITHOUT_GIL(cc::Map, GetAllLandmarks))
     .def("get_all_landmarks_from_id", CALL_RETURNING_LIST_1(cc::Map, GetLandmarksFromId, std::string), (args("opendrive_id")))
     .def("get_all_landmarks_of_type", CALL_RETURNING_LIST_1(cc::Map, GetAllLandmarksOfType, std::string), (args("type")))
     .def("get_landmark_group", CALL_RETURNING_LIST_1(cc::Map, GetLandmarkGroup, cc::Landmark), args("landmark"))
     .def("cook_in_memory_map", &cc::Map::CookInMemoryMap, (arg("path")=""))
+    .def("make_updated", &MakeUpdatedMap, (arg("xodr_content")))
+    .def("get_update", &GetMapUpdate)
     .def(self_ns::str(self_ns::self))
   ;
 
@@ -235,6 +390,12 @@ void export_map() {
     .def("previous", CALL_RETURNING_LIST_1(cc::Waypoint, GetPrevious, double), (args("distance")))
     .def("next_until_lane_end", CALL_RETURNING_LIST_1(cc::Waypoint, GetNextUntilLaneEnd, double), (args("distance")))
     .def("previous_until_lane_start", CALL_RETURNING_LIST_1(cc::Waypoint, GetPreviousUntilLaneStart, double), (args("distance")))
+    .def("sample_next", +[](const cc::Waypoint &self, double distance, size_t count, bool until_lane_end) {
+      return SampleLanePath(self, distance, count, until_lane_end, true);
+    }, (arg("distance"), arg("count"), arg("until_lane_end")=false))
+    .def("sample_previous", +[](const cc::Waypoint &self, double distance, size_t count, bool until_lane_start) {
+      return SampleLanePath(self, distance, count, until_lane_start, false);
+    }, (arg("distance"), arg("count"), arg("until_lane_start")=false))
     .def("get_right_lane", &cc::Waypoint::GetRight)
     .def("get_left_lane", &cc::Waypoint::GetLeft)
     .def("get_junction", &cc::Waypoint::GetJunction)
@@ -243,6 +404,30 @@ void export_map() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  auto lane_path_column = class_<LanePathColumn>("LanePathColumn", no_init);
+#if PY_MAJOR_VERSION >= 3
+  reinterpret_cast<PyTypeObject *>(lane_path_column.ptr())->tp_as_buffer = &LanePathColumnBufferProcs;
+#endif
+
+  class_<LanePathView>("LanePath", no_init)
+    .add_property("road_ids", +[](const LanePathView &self) {
+      return GetLanePathColumnAsBuffer(self, self.path->GetRoadIds(), "I", 1u);
+    })
+    .add_property("section_ids", +[](const LanePathView &self) {
+      return GetLanePathColumnAsBuffer(self, self.path->GetSectionIds(), "I", 1u);
+    })
+    .add_property("lane_ids", +[](const LanePathView &self) {
+      return GetLanePathColumnAsBuffer(self, self.path->GetLaneIds(), "i", 1u);
+    })
+    .add_property("s", +[](const LanePathView &self) {
+      return GetLanePathColumnAsBuffer(self, self.path->GetS(), "d", 1u);
+    })
+    .add_property("transforms", +[](const LanePathView &self) {
+      return GetLanePathColumnAsBuffer(self, self.path->GetTransforms(), "f", cc::LanePath::TRANSFORM_SIZE);
+    })
+    .def("__len__", +[](const LanePathView &self) { return self.path->size(); })
+  ;
+
   class_<cc::Junction, boost::noncopyable, boost::shared_ptr<cc::Junction>>("Junction", no_init)
     .add_property("id", &cc::Junction::GetId)
     .add_property("bounding_box", &cc::Junction::GetBoundingBox)
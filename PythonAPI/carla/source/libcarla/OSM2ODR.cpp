@@ -8,6 +8,10 @@
 // 推测这里面包含了与将OpenStreetMap地图转换为OpenDRIVE格式相关的一些类型、函数等声明内容
 #include <OSM2ODR.h>  
 
+#include <carla/PythonUtil.h>
+#include <carla/opendrive/OpenDriveStitcher.h>
+#include <carla/opendrive/OsmTileSplitter.h>
+
 // 定义一个空类OSM2ODR，这里可能是用于模拟PythonAPI中的命名空间概念，
 // 虽然类体为空，但通过它可以在C++代码里营造出类似Python中命名空间的组织结构，方便后续代码对相关功能进行分组管理
 class OSM2ODR {};
@@ -37,6 +41,28 @@ namespace osm2odr {
     void SetTLExcludedWayTypes(OSM2ODRSettings& self, boost::python::list input) {
         self.tl_excluded_highways_types = PythonLitstToVector<std::string>(input);
     }
+
+    // 以流的方式把 .osm 文件划分为图块，返回图块文件的路径。
+    // 转换器使用进程内的全局状态，图块须在不同的进程中并行转换（见 PythonAPI/util/osm_to_xodr.py）。
+    boost::python::list SplitTiles(const std::string &osm_path, const std::string &output_folder, double tile_size) {
+        std::vector<carla::opendrive::OsmTileSplitter::Tile> tiles;
+        {
+            carla::PythonUtil::ReleaseGIL unlock;
+            tiles = carla::opendrive::OsmTileSplitter::Split(osm_path, output_folder, tile_size);
+        }
+        boost::python::list result;
+        for (const auto &tile : tiles) {
+            result.append(tile.path);
+        }
+        return result;
+    }
+
+    // 合并各图块转换得到的 OpenDRIVE，并连接图块边界处的道路。
+    std::string StitchTiles(boost::python::list input, double tolerance, bool center_map) {
+        const auto tiles = PythonLitstToVector<std::string>(input);
+        carla::PythonUtil::ReleaseGIL unlock;
+        return carla::opendrive::OpenDriveStitcher::Stitch(tiles, tolerance, center_map);
+    }
 }
 
 // 定义一个名为export_osm2odr的函数，从函数名推测其功能可能是将与osm2odr相关的功能、类型等导出，
@@ -79,5 +105,10 @@ void export_osm2odr() {
        .def("convert", &ConvertOSMToOpenDRIVE, (arg("osm_file"), arg("settings") = OSM2ODRSettings()))
         // 明确指定"convert"方法为静态方法，符合在Python中调用该方法时不需要先实例化类对象的预期行为。
        .staticmethod("convert")
+        // 分块转换：split_tiles 划分的每个图块分别转换（不启用 center_map），再用 stitch_tiles 合并
+       .def("split_tiles", &SplitTiles, (arg("osm_path"), arg("output_folder"), arg("tile_size") = 2000.0))
+       .staticmethod("split_tiles")
+       .def("stitch_tiles", &StitchTiles, (arg("xodr_tiles"), arg("tolerance") = 1.0, arg("center_map") = false))
+       .staticmethod("stitch_tiles")
     ;
 }
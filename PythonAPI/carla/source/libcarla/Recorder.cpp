@@ -0,0 +1,187 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/PythonUtil.h>
+#include <carla/recorder/RecorderReader.h>
+
+#include <boost/make_shared.hpp>
+
+#include <ostream>
+
+namespace carla {
+namespace recorder {
+
+  std::ostream &operator<<(std::ostream &out, const RecorderInfo &info) {
+    out << "RecorderInfo(map_name=" << info.map_name
+        << ", frames=" << info.frames
+        << ", duration=" << info.duration << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecorderActor &actor) {
+    out << "RecorderActor(id=" << actor.id << ", type_id=" << actor.type_id << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecorderCollision &collision) {
+    out << "RecorderCollision(time=" << collision.time
+        << ", actor1=" << collision.actor1
+        << ", actor2=" << collision.actor2 << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecorderBlockedActor &blocked) {
+    out << "RecorderBlockedActor(id=" << blocked.id
+        << ", time=" << blocked.time
+        << ", duration=" << blocked.duration << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecorderTrajectory &trajectory) {
+    out << "RecorderTrajectory(actor_id=" << trajectory.actor_id << ", size=" << trajectory.size() << ')';
+    return out;
+  }
+
+} // namespace recorder
+} // namespace carla
+
+// 在释放 GIL 的情况下打开并扫描文件
+static boost::shared_ptr<carla::recorder::RecorderReader> OpenRecorderFile(const std::string &path) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return boost::make_shared<carla::recorder::RecorderReader>(path);
+}
+
+// 把数据复制到新的缓冲区，返回每行 @a columns 个值的内存视图，可以用
+// numpy.asarray 不复制地转换为数组；Python 2 返回列表。
+template <typename T>
+static boost::python::object MakeRecorderArray(const std::vector<T> &data, const char *format, size_t columns) {
+  namespace py = boost::python;
+#if PY_MAJOR_VERSION >= 3
+  py::object bytes(py::handle<>(PyByteArray_FromStringAndSize(
+      reinterpret_cast<const char *>(data.data()),
+      static_cast<Py_ssize_t>(data.size() * sizeof(T)))));
+  py::object view(py::handle<>(PyMemoryView_FromObject(bytes.ptr())));
+  // 内存视图不能有长度为 0 的维度
+  if (data.empty() || columns == 1u) {
+    return view.attr("cast")(format);
+  }
+  return view.attr("cast")(format, py::make_tuple(data.size() / columns, columns));
+#else
+  (void) format;
+  (void) columns;
+  py::list result;
+  for (auto &&value : data) {
+    result.append(value);
+  }
+  return result;
+#endif // PY_MAJOR_VERSION >= 3
+}
+
+template <typename T>
+static boost::python::list ToPythonList(const std::vector<T> &items) {
+  boost::python::list result;
+  for (auto &&item : items) {
+    result.append(item);
+  }
+  return result;
+}
+
+void export_recorder() {
+  using namespace boost::python;
+  namespace cr = carla::recorder;
+
+  class_<cr::RecorderInfo>("RecorderInfo", no_init)
+    .def_readonly("version", &cr::RecorderInfo::version)
+    .def_readonly("date", &cr::RecorderInfo::date)
+    .def_readonly("map_name", &cr::RecorderInfo::map_name)
+    .def_readonly("frames", &cr::RecorderInfo::frames)
+    .def_readonly("duration", &cr::RecorderInfo::duration)
+    .def_readonly("compressed", &cr::RecorderInfo::compressed)
+    .def_readonly("indexed", &cr::RecorderInfo::indexed)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::RecorderActor>("RecorderActor", no_init)
+    .def_readonly("id", &cr::RecorderActor::id)
+    .def_readonly("type", &cr::RecorderActor::type)
+    .def_readonly("type_id", &cr::RecorderActor::type_id)
+    .def_readonly("role_name", &cr::RecorderActor::role_name)
+    .def_readonly("created", &cr::RecorderActor::created)
+    .def_readonly("destroyed", &cr::RecorderActor::destroyed)
+    .add_property("category", &cr::RecorderActor::GetCategory)
+    .add_property("is_hero", &cr::RecorderActor::IsHero)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::RecorderCollision>("RecorderCollision", no_init)
+    .def_readonly("time", &cr::RecorderCollision::time)
+    .def_readonly("frame", &cr::RecorderCollision::frame)
+    .def_readonly("actor1", &cr::RecorderCollision::actor1)
+    .def_readonly("actor2", &cr::RecorderCollision::actor2)
+    .def_readonly("is_actor1_hero", &cr::RecorderCollision::is_actor1_hero)
+    .def_readonly("is_actor2_hero", &cr::RecorderCollision::is_actor2_hero)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::RecorderBlockedActor>("RecorderBlockedActor", no_init)
+    .def_readonly("id", &cr::RecorderBlockedActor::id)
+    .def_readonly("time", &cr::RecorderBlockedActor::time)
+    .def_readonly("duration", &cr::RecorderBlockedActor::duration)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::RecorderTrajectory>("RecorderTrajectory", no_init)
+    .def_readonly("actor_id", &cr::RecorderTrajectory::actor_id)
+    .add_property("times", +[](const cr::RecorderTrajectory &self) {
+      return MakeRecorderArray(self.times, "d", 1u);
+    })
+    .add_property("locations", +[](const cr::RecorderTrajectory &self) {
+      return MakeRecorderArray(self.locations, "f", 3u);
+    })
+    .add_property("rotations", +[](const cr::RecorderTrajectory &self) {
+      return MakeRecorderArray(self.rotations, "f", 3u);
+    })
+    .def("__len__", &cr::RecorderTrajectory::size)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::RecorderReader, boost::noncopyable, boost::shared_ptr<cr::RecorderReader>>("RecorderReader", no_init)
+    .def("__init__", make_constructor(&OpenRecorderFile, default_call_policies(), (arg("path"))))
+    .def("get_info", &cr::RecorderReader::GetInfo, return_internal_reference<>())
+    .def("get_actors", +[](const cr::RecorderReader &self) {
+      return ToPythonList(self.GetActors());
+    })
+    .def("get_collisions", +[](const cr::RecorderReader &self, char category1, char category2) {
+      std::vector<cr::RecorderCollision> result;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = self.GetCollisions(category1, category2);
+      }
+      return ToPythonList(result);
+    }, (arg("category1")='a', arg("category2")='a'))
+    .def("get_blocked_actors", +[](const cr::RecorderReader &self, double min_time, double min_distance) {
+      std::vector<cr::RecorderBlockedActor> result;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = self.GetBlockedActors(min_time, min_distance);
+      }
+      return ToPythonList(result);
+    }, (arg("min_time")=30.0, arg("min_distance")=0.1))
+    .def("get_trajectory", CONST_CALL_WITHOUT_GIL_1(cr::RecorderReader, GetTrajectory, uint32_t), (arg("actor_id")))
+    .def("get_trajectories", +[](const cr::RecorderReader &self, const list &actor_ids) {
+      std::vector<uint32_t> ids;
+      for (auto i = 0; i < len(actor_ids); ++i) {
+        ids.push_back(extract<uint32_t>(actor_ids[i]));
+      }
+      std::vector<cr::RecorderTrajectory> result;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = self.GetTrajectories(ids);
+      }
+      return ToPythonList(result);
+    }, (arg("actor_ids")=list()))
+  ;
+}
@@ -3,24 +3,339 @@
 // 本作品根据 MIT 许可证的条款进行许可。
 // 如需副本，请参阅 <https://opensource.org/licenses/MIT>.
 
+#include <carla/NonCopyable.h>
 #include <carla/PythonUtil.h>
 #include <carla/client/ClientSideSensor.h>
 #include <carla/client/LaneInvasionSensor.h>
 #include <carla/client/Sensor.h>
 #include <carla/client/ServerSideSensor.h>
+#include <carla/rpc/StreamStatistics.h>
+
+#include <boost/make_shared.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 在流客户端的线程之外调用传感器的 Python 回调。同时到达的数据在一次获取 GIL 后
+// 全部处理，网络线程只需要把数据放入队列，不会被 Python 代码阻塞。
+//   - 专用线程：由一个后台线程调用回调；
+//   - tick：数据保存到调用 world.tick() 或 world.wait_for_tick() 时在调用者的线程中处理。
+class SensorCallbackDispatcher {
+public:
+
+  using Callback = carla::SharedPtr<boost::python::object>;
+
+  using Message = carla::SharedPtr<carla::sensor::SensorData>;
+
+  static SensorCallbackDispatcher &Get() {
+    // 不销毁，退出时由 atexit 停止线程
+    static auto *instance = new SensorCallbackDispatcher;
+    return *instance;
+  }
+
+  void PostToThread(Callback callback, Message message) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_stopped) {
+        return;
+      }
+      if (!_thread.joinable()) {
+        _thread = std::thread([this]() { Run(); });
+      }
+      _thread_queue.emplace_back(std::move(callback), std::move(message));
+    }
+    _condition.notify_one();
+  }
+
+  void PostToTick(Callback callback, Message message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_stopped) {
+      _tick_queue.emplace_back(std::move(callback), std::move(message));
+    }
+  }
+
+  /// 处理等待 tick 的回调，调用时必须持有 GIL。
+  void DispatchTickCallbacks() {
+    Batch batch;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      batch.swap(_tick_queue);
+    }
+    Dispatch(batch);
+  }
+
+  /// 停止专用线程，调用时必须持有 GIL。
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopped = true;
+      _tick_queue.clear();
+    }
+    _condition.notify_one();
+    if (_thread.joinable()) {
+      // 线程可能正在等待 GIL
+      carla::PythonUtil::ReleaseGIL unlock;
+      _thread.join();
+    }
+  }
+
+private:
+
+  using Batch = std::vector<std::pair<Callback, Message>>;
+
+  static void Dispatch(Batch &batch) {
+    namespace py = boost::python;
+    for (auto &item : batch) {
+      try {
+        py::call<void>(item.first->ptr(), py::object(item.second));
+      } catch (const py::error_already_set &) {
+        PyErr_Print();
+      }
+    }
+    // 回调在持有 GIL 时释放
+    batch.clear();
+  }
+
+  void Run() {
+    for (;;) {
+      Batch batch;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]() { return _stopped || !_thread_queue.empty(); });
+        if (_stopped) {
+          return;
+        }
+        batch.swap(_thread_queue);
+      }
+      carla::PythonUtil::AcquireGIL lock;
+      Dispatch(batch);
+    }
+  }
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  Batch _thread_queue;
+
+  Batch _tick_queue;
+
+  std::thread _thread;
+
+  bool _stopped = false;
+};
+
+// 线程安全的传感器数据队列，网络线程放入数据时不需要 GIL。队列满时丢弃最旧的数据。
+class SensorDataQueue : private carla::NonCopyable {
+public:
+
+  using Message = carla::SharedPtr<carla::sensor::SensorData>;
+
+  explicit SensorDataQueue(size_t maxlen) : _maxlen(maxlen) {}
+
+  void Push(Message message) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_maxlen > 0u && _queue.size() >= _maxlen) {
+        _queue.pop_front();
+        ++_dropped;
+      }
+      _queue.emplace_back(std::move(message));
+    }
+    _condition.notify_one();
+  }
+
+  /// 等待最多 @a timeout 秒（小于 0 时一直等待），队列为空时返回 nullptr。
+  Message Pop(double timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const auto ready = [this]() { return !_queue.empty(); };
+    if (timeout < 0.0) {
+      _condition.wait(lock, ready);
+    } else if (!_condition.wait_for(lock, std::chrono::duration<double>(timeout), ready)) {
+      return nullptr;
+    }
+    Message message = std::move(_queue.front());
+    _queue.pop_front();
+    return message;
+  }
+
+  std::vector<Message> PopAll() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Message> result(
+        std::make_move_iterator(_queue.begin()),
+        std::make_move_iterator(_queue.end()));
+    _queue.clear();
+    return result;
+  }
+
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  size_t GetMaxLen() const {
+    return _maxlen;
+  }
+
+  size_t GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+  }
+
+private:
+
+  const size_t _maxlen;
+
+  mutable std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::deque<Message> _queue;
+
+  size_t _dropped = 0u;
+};
+
+// 按 executor 包装 Python 回调："stream" 在流客户端的线程中调用（默认），
+// "thread" 由专用线程调用，"tick" 在 world.tick() 中调用
+static carla::client::Sensor::CallbackFunctionType MakeSensorCallback(
+    boost::python::object callback,
+    const std::string &executor) {
+  namespace py = boost::python;
+  if (executor == "stream") {
+    return MakeCallback(std::move(callback));
+  }
+  const bool on_tick = (executor == "tick");
+  if (!on_tick && executor != "thread") {
+    PyErr_SetString(PyExc_ValueError, "executor must be 'stream', 'thread' or 'tick'");
+    py::throw_error_already_set();
+  }
+  if (!PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+    py::throw_error_already_set();
+  }
+  using Deleter = carla::PythonUtil::AcquireGILDeleter;
+  auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+  return [callback=std::move(callback_ptr), on_tick](carla::SharedPtr<carla::sensor::SensorData> message) {
+    auto &dispatcher = SensorCallbackDispatcher::Get();
+    if (on_tick) {
+      dispatcher.PostToTick(callback, std::move(message));
+    } else {
+      dispatcher.PostToThread(callback, std::move(message));
+    }
+  };
+}
 
 // 定义一个静态函数 SubscribeToStream，用于让传感器订阅流并执行回调函数
-static void SubscribeToStream(carla::client::Sensor &self, boost::python::object callback) {
-    // 通过 MakeCallback 函数将传入的 Python 对象转换为合适的回调函数，并调用传感器的 Listen 方法进行订阅
-    self.Listen(MakeCallback(std::move(callback)));
+static void SubscribeToStream(
+    carla::client::Sensor &self,
+    boost::python::object callback,
+    const std::string &executor) {
+    // 通过 MakeSensorCallback 函数将传入的 Python 对象转换为合适的回调函数，并调用传感器的 Listen 方法进行订阅
+    // 订阅需要与服务器通信，期间释放 GIL；回调中的 Python 对象在销毁时会重新获取 GIL
+    auto sensor_callback = MakeSensorCallback(std::move(callback), executor);
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.Listen(std::move(sensor_callback));
+}
+
+// 订阅传感器的数据流，数据放入返回的队列中。@a lazy 为 true 时服务器端传感器的
+// 数据以 carla.LazySensorData 的形式放入队列，被丢弃的数据不会反序列化
+static boost::shared_ptr<SensorDataQueue> SubscribeToQueue(carla::client::Sensor &self, size_t maxlen, bool lazy) {
+    auto queue = boost::make_shared<SensorDataQueue>(maxlen);
+    auto callback = [queue](carla::SharedPtr<carla::sensor::SensorData> message) {
+      queue->Push(std::move(message));
+    };
+    auto *server_side_sensor = dynamic_cast<carla::client::ServerSideSensor *>(&self);
+    carla::PythonUtil::ReleaseGIL unlock;
+    if (lazy && server_side_sensor != nullptr) {
+      server_side_sensor->ListenLazy(std::move(callback));
+    } else {
+      self.Listen(std::move(callback));
+    }
+    return queue;
+}
+
+// 与 SubscribeToStream 相同，但压缩的数据不解压，以 carla.CompressedSensorData 的形式交给回调
+static void SubscribeToStreamCompressed(
+    carla::client::ServerSideSensor &self,
+    boost::python::object callback,
+    const std::string &executor) {
+    auto sensor_callback = MakeSensorCallback(std::move(callback), executor);
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.ListenCompressed(std::move(sensor_callback));
+}
+
+// 与 SubscribeToStream 相同，但数据以 carla.LazySensorData 的形式交给回调，负载在调用 get() 时才反序列化
+static void SubscribeToStreamLazy(
+    carla::client::ServerSideSensor &self,
+    boost::python::object callback,
+    const std::string &executor) {
+    auto sensor_callback = MakeSensorCallback(std::move(callback), executor);
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.ListenLazy(std::move(sensor_callback));
 }
 
 // 定义一个静态函数 SubscribeToGBuffer，用于让服务器端传感器订阅图形缓冲区（GBuffer）并执行回调函数
 static void SubscribeToGBuffer(
     carla::client::ServerSideSensor &self,
     uint32_t GBufferId,
-    boost::python::object callback) {
-    self.ListenToGBuffer(GBufferId, MakeCallback(std::move(callback)));
+    boost::python::object callback,
+    const std::string &executor) {
+    auto sensor_callback = MakeSensorCallback(std::move(callback), executor);
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.ListenToGBuffer(GBufferId, std::move(sensor_callback));
+}
+
+// 从队列中取出一个数据，等待时释放 GIL，没有数据时抛出 queue.Empty
+static boost::python::object PopSensorData(SensorDataQueue &self, bool block, boost::python::object timeout) {
+    namespace py = boost::python;
+    double seconds = 0.0;
+    if (block) {
+      seconds = timeout.is_none() ? -1.0 : py::extract<double>(timeout)();
+    }
+    SensorDataQueue::Message message;
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      message = self.Pop(seconds);
+    }
+    if (message == nullptr) {
+#if PY_MAJOR_VERSION >= 3
+      py::object empty = py::import("queue").attr("Empty");
+#else
+      py::object empty = py::import("Queue").attr("Empty");
+#endif
+      PyErr_SetNone(empty.ptr());
+      py::throw_error_already_set();
+    }
+    return py::object(message);
+}
+
+// 订阅传感器的数据流，返回 asyncio 的异步迭代器，参数与 SubscribeToQueue 相同
+static boost::shared_ptr<AsyncSensorDataStream> SubscribeToAsyncStream(carla::client::Sensor &self, size_t maxlen, bool lazy) {
+    auto stream = boost::make_shared<AsyncSensorDataStream>(maxlen);
+    auto callback = [stream](carla::SharedPtr<carla::sensor::SensorData> message) {
+      stream->Push(std::move(message));
+    };
+    auto *server_side_sensor = dynamic_cast<carla::client::ServerSideSensor *>(&self);
+    carla::PythonUtil::ReleaseGIL unlock;
+    if (lazy && server_side_sensor != nullptr) {
+      server_side_sensor->ListenLazy(std::move(callback));
+    } else {
+      self.Listen(std::move(callback));
+    }
+    return stream;
+}
+
+static boost::python::list PopAllSensorData(SensorDataQueue &self) {
+    boost::python::list result;
+    for (auto &message : self.PopAll()) {
+      result.append(message);
+    }
+    return result;
 }
 
 // 定义一个名为 export_sensor 的函数，用于将 C++ 中的传感器类暴露给 Python
@@ -28,23 +343,64 @@ void export_sensor() {
     using namespace boost::python;
     namespace cc = carla::client;
 
+    // 定义一个名为 SensorStreamStatistics 的 Python 类，表示服务器端传感器流的发送队列统计信息
+    class_<carla::rpc::StreamStatistics>("SensorStreamStatistics", no_init)
+        .def_readonly("number_of_sessions", &carla::rpc::StreamStatistics::number_of_sessions)
+        .def_readonly("queue_depth", &carla::rpc::StreamStatistics::queue_depth)
+        .def_readonly("max_queue_depth", &carla::rpc::StreamStatistics::max_queue_depth)
+        .def_readonly("sent_messages", &carla::rpc::StreamStatistics::sent_messages)
+        .def_readonly("dropped_messages", &carla::rpc::StreamStatistics::dropped_messages)
+    ;
+
+    // 进程退出前停止调用回调的专用线程和等待 asyncio 操作的线程
+    import("atexit").attr("register")(make_function(+[]() {
+      SensorCallbackDispatcher::Get().Stop();
+      AsyncIOWaiter::Get().Stop();
+    }));
+
+    class_<SensorDataQueue, boost::noncopyable, boost::shared_ptr<SensorDataQueue>>("SensorDataQueue", no_init)
+        .def("get", &PopSensorData, (arg("block")=true, arg("timeout")=object()))
+        .def("get_nowait", +[](SensorDataQueue &self) { return PopSensorData(self, false, object()); })
+        .def("get_all", &PopAllSensorData)
+        .def("qsize", &SensorDataQueue::Size)
+        .def("empty", +[](const SensorDataQueue &self) { return self.Size() == 0u; })
+        .def("__len__", &SensorDataQueue::Size)
+        .add_property("maxlen", &SensorDataQueue::GetMaxLen)
+        .add_property("dropped", &SensorDataQueue::GetDroppedCount)
+    ;
+
+    class_<AsyncSensorDataStream, boost::noncopyable, boost::shared_ptr<AsyncSensorDataStream>>("SensorDataStream", no_init)
+        .def("__aiter__", +[](object self) { return self; })
+        .def("__anext__", &AsyncSensorDataStream::Next)
+        .def("close", &AsyncSensorDataStream::Close)
+        .add_property("dropped", &AsyncSensorDataStream::GetDroppedCount)
+    ;
+
     // 定义一个名为 Sensor 的 Python 类，继承自 cc::Actor，并设置为不可复制，使用智能指针管理
     class_<cc::Sensor, bases<cc::Actor>, boost::noncopyable, boost::shared_ptr<cc::Sensor>>("Sensor", no_init)
-        .def("listen", &SubscribeToStream, (arg("callback")))
+        .def("listen", &SubscribeToStream, (arg("callback"), arg("executor")="stream"))
+        .def("listen_queue", &SubscribeToQueue, (arg("maxlen")=16u, arg("lazy")=false))
+        .def("listen_async", &SubscribeToAsyncStream, (arg("maxlen")=16u, arg("lazy")=false))
         .def("is_listening", &cc::Sensor::IsListening)
-        .def("stop", &cc::Sensor::Stop)
+        // 停止时可能要等待正在执行的回调，而回调需要 GIL，所以释放 GIL
+        .def("stop", CALL_WITHOUT_GIL(cc::Sensor, Stop))
         .def(self_ns::str(self_ns::self))
     ;
 
     // 定义一个名为 ServerSideSensor 的 Python 类，继承自 cc::Sensor，并设置为不可复制，使用智能指针管理
     class_<cc::ServerSideSensor, bases<cc::Sensor>, boost::noncopyable, boost::shared_ptr<cc::ServerSideSensor>>
         ("ServerSideSensor", no_init)
-        .def("listen_to_gbuffer", &SubscribeToGBuffer, (arg("gbuffer_id"), arg("callback")))
+        .def("listen_compressed", &SubscribeToStreamCompressed, (arg("callback"), arg("executor")="stream"))
+        .def("listen_lazy", &SubscribeToStreamLazy, (arg("callback"), arg("executor")="stream"))
+        .def("listen_to_gbuffer", &SubscribeToGBuffer, (arg("gbuffer_id"), arg("callback"), arg("executor")="stream"))
         .def("is_listening_gbuffer", &cc::ServerSideSensor::IsListeningGBuffer, (arg("gbuffer_id")))
-        .def("stop_gbuffer", &cc::ServerSideSensor::StopGBuffer, (arg("gbuffer_id")))
+        .def("stop_gbuffer", CALL_WITHOUT_GIL_1(cc::ServerSideSensor, StopGBuffer, uint32_t), (arg("gbuffer_id")))
         .def("enable_for_ros", &cc::ServerSideSensor::EnableForROS)
         .def("disable_for_ros", &cc::ServerSideSensor::DisableForROS)
         .def("is_enabled_for_ros", &cc::ServerSideSensor::IsEnabledForROS)
+        .def("enable_multicast", &cc::ServerSideSensor::EnableMulticast)
+        .def("disable_multicast", &cc::ServerSideSensor::DisableMulticast)
+        .def("get_stream_statistics", &cc::ServerSideSensor::GetStreamStatistics)
         .def("send", &cc::ServerSideSensor::Send, (arg("message")))
         .def(self_ns::str(self_ns::self))
     ;
@@ -4,17 +4,25 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/BoundedTaskQueue.h>
+#include <carla/NonCopyable.h>
 #include <carla/PythonUtil.h>
+#include <carla/geom/CameraProjection.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
+#include <carla/sensor/data/CompressedData.h>
+#include <carla/sensor/data/LazyData.h>
+#include <carla/sensor/data/ConvertedImage.h>
+#include <carla/sensor/data/InstanceBoxes.h>
 #include <carla/sensor/data/IMUMeasurement.h>
 #include <carla/sensor/data/ObstacleDetectionEvent.h>
 #include <carla/sensor/data/Image.h>
 #include <carla/sensor/data/LaneInvasionEvent.h>
+#include <carla/sensor/data/LidarColumns.h>
 #include <carla/sensor/data/LidarMeasurement.h>
 #include <carla/sensor/data/SemanticLidarMeasurement.h>
 #include <carla/sensor/data/GnssMeasurement.h>
@@ -22,12 +30,17 @@
 #include <carla/sensor/data/DVSEventArray.h>
 #include <carla/sensor/data/V2XEvent.h>
 #include <carla/sensor/data/V2XData.h>
+#include <carla/sensor/data/WalkerPoseMeasurement.h>
+#include <carla/sensor/data/TelemetryMeasurement.h>
 #include <carla/sensor/data/LibITS.h>
 
 #include <carla/sensor/data/RadarData.h>
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <ostream>
 #include <iostream>
 #include <cmath>
@@ -70,6 +83,16 @@ namespace data {
 
 // 为LidarMeasurement类型重载输出流运算符，输出激光雷达测量的信息，包括帧编号、时间戳和点数量。
 
+  std::ostream &operator<<(std::ostream &out, const LidarColumns &meas) {
+    out << "LidarColumns(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", number_of_points=" << std::to_string(meas.GetTotalPointCount())
+        << ')';
+    return out;
+  }
+
+// 为LidarColumns类型重载输出流运算符，输出按列存放的激光雷达测量的帧编号、时间戳和点数量。
+
   std::ostream &operator<<(std::ostream &out, const SemanticLidarMeasurement &meas) {
     out << "SemanticLidarMeasurement(frame=" << std::to_string(meas.GetFrame())
         << ", timestamp=" << std::to_string(meas.GetTimestamp())
@@ -143,6 +166,27 @@ namespace data {
 
 // 为RadarMeasurement类型重载输出流运算符，输出雷达测量信息，包括帧编号、时间戳和检测到的点数。
 
+  std::ostream &operator<<(std::ostream &out, const WalkerPoseMeasurement &meas) {
+    out << "WalkerPoseMeasurement(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", walker_count=" << std::to_string(meas.GetWalkerCount())
+        << ", bone_count=" << std::to_string(meas.size())
+        << ')';
+    return out;
+  }
+
+// 为WalkerPoseMeasurement类型重载输出流运算符，输出帧编号、时间戳、行人数和骨骼总数。
+
+  std::ostream &operator<<(std::ostream &out, const TelemetryMeasurement &meas) {
+    out << "TelemetryMeasurement(frame=" << std::to_string(meas.GetFrame())
+        << ", timestamp=" << std::to_string(meas.GetTimestamp())
+        << ", vehicle_count=" << std::to_string(meas.GetVehicleCount())
+        << ')';
+    return out;
+  }
+
+// 为TelemetryMeasurement类型重载输出流运算符，输出帧编号、时间戳和车辆数。
+
   std::ostream &operator<<(std::ostream &out, const DVSEvent &event) {
     out << "Event(x=" << std::to_string(event.x)
         << ", y=" << std::to_string(event.y)
@@ -164,6 +208,31 @@ namespace data {
 
 // 为DVSEventArray类型重载输出流运算符，输出动态视觉传感器事件数组的信息，包括帧编号、时间戳、尺寸和事件数量。
 
+  std::ostream &operator<<(std::ostream &out, const InstanceBox &box) {
+    out << "InstanceBox(actor_id=" << std::to_string(box.actor_id)
+        << ", instance_id=" << std::to_string(box.instance_id)
+        << ", semantic_tag=" << std::to_string(box.semantic_tag)
+        << ", pixel_count=" << std::to_string(box.pixel_count)
+        << ", box=(" << std::to_string(box.x_min) << ", " << std::to_string(box.y_min)
+        << ", " << std::to_string(box.x_max) << ", " << std::to_string(box.y_max) << ')'
+        << ", occlusion=" << std::to_string(box.occlusion)
+        << ')';
+    return out;
+  }
+
+// 为InstanceBox类型重载输出流运算符，输出实例的id、标签、像素数、包围盒和遮挡率。
+
+  std::ostream &operator<<(std::ostream &out, const InstanceBoxes &boxes) {
+    out << "InstanceBoxes(frame=" << std::to_string(boxes.GetFrame())
+        << ", timestamp=" << std::to_string(boxes.GetTimestamp())
+        << ", size=" << std::to_string(boxes.GetWidth()) << 'x' << std::to_string(boxes.GetHeight())
+        << ", number_of_instances=" << std::to_string(boxes.size())
+        << ')';
+    return out;
+  }
+
+// 为InstanceBoxes类型重载输出流运算符，输出帧编号、时间戳、图像尺寸和实例数量。
+
   std::ostream &operator<<(std::ostream &out, const RadarDetection &det) {
     out << "RadarDetection(velocity=" << std::to_string(det.velocity)
         << ", azimuth=" << std::to_string(det.azimuth)
@@ -263,6 +332,122 @@ static auto GetRawDataAsBuffer(T &self) {
     return boost::python::object(boost::python::handle<>(ptr));  
 }  
   
+// 将一列数据（count 个 T）转换为只读的Python内存视图对象，不复制数据
+template <typename T>
+static auto GetColumnAsBuffer(const T *column, size_t count) {
+    auto size = static_cast<Py_ssize_t>(sizeof(T) * count);
+#if PY_MAJOR_VERSION >= 3
+    auto *ptr = PyMemoryView_FromMemory(reinterpret_cast<char *>(const_cast<T *>(column)), size, PyBUF_READ);
+#else
+    auto *ptr = PyBuffer_FromMemory(const_cast<T *>(column), size);
+#endif
+    return boost::python::object(boost::python::handle<>(ptr));
+}
+
+// 传感器数据的类型化视图，通过缓冲区协议导出，保持传感器数据在视图存活期间有效。
+// numpy.asarray 不复制地转换为数组，点云等使用带字段名的结构化类型。
+struct SensorDataView {
+  boost::shared_ptr<carla::sensor::SensorData> owner;
+  const void *data = nullptr;
+  const char *format = nullptr;
+  Py_ssize_t itemsize = 0;
+  int ndim = 1;
+  Py_ssize_t shape[3u] = {0, 0, 0};
+  Py_ssize_t strides[3u] = {0, 0, 0};
+};
+
+// 与 carla::sensor::data 中结构体的内存布局一致的格式
+static_assert(sizeof(carla::sensor::data::LidarDetection) == 4u * sizeof(float), "Invalid lidar detection layout");
+static_assert(sizeof(carla::sensor::data::SemanticLidarDetection) == 6u * sizeof(float), "Invalid semantic lidar detection layout");
+static_assert(sizeof(carla::sensor::data::RadarDetection) == 4u * sizeof(float), "Invalid radar detection layout");
+static_assert(sizeof(carla::sensor::data::WalkerBonePose) == 6u * sizeof(float), "Invalid walker bone pose layout");
+// DVSEvent 按 1 字节对齐
+static_assert(sizeof(carla::sensor::data::DVSEvent) == 13u, "Invalid DVS event layout");
+static_assert(offsetof(carla::sensor::data::DVSEvent, t) == 4u, "Invalid DVS event layout");
+static_assert(offsetof(carla::sensor::data::DVSEvent, pol) == 12u, "Invalid DVS event layout");
+
+static const char *LidarDetectionFormat = "T{f:x:f:y:f:z:f:intensity:}";
+static const char *SemanticLidarDetectionFormat = "T{f:x:f:y:f:z:f:cos_inc_angle:I:object_idx:I:object_tag:}";
+static const char *RadarDetectionFormat = "T{f:velocity:f:azimuth:f:altitude:f:depth:}";
+static const char *WalkerBonePoseFormat = "T{f:x:f:y:f:z:f:pitch:f:yaw:f:roll:}";
+static const char *DVSEventFormat = "T{=H:x:=H:y:=q:t:=?:pol:}";
+
+// 每个元素为一个结构体的一维视图
+template <typename T>
+static SensorDataView MakeSensorDataView(const boost::shared_ptr<T> &self, const char *format) {
+  SensorDataView result;
+  result.owner = self;
+  result.data = self->data();
+  result.format = format;
+  result.itemsize = sizeof(typename T::value_type);
+  result.ndim = 1;
+  result.shape[0u] = static_cast<Py_ssize_t>(self->size());
+  result.strides[0u] = result.itemsize;
+  return result;
+}
+
+// 形状为 (height, width, channels) 的图像视图
+template <typename T, typename ChannelT>
+static SensorDataView MakeImageView(const boost::shared_ptr<T> &self, const char *format) {
+  constexpr auto channels = sizeof(typename T::value_type) / sizeof(ChannelT);
+  static_assert(channels * sizeof(ChannelT) == sizeof(typename T::value_type), "Invalid pixel layout");
+  SensorDataView result;
+  result.owner = self;
+  result.data = self->data();
+  result.format = format;
+  result.itemsize = sizeof(ChannelT);
+  result.ndim = 3;
+  result.shape[0u] = static_cast<Py_ssize_t>(self->GetHeight());
+  result.shape[1u] = static_cast<Py_ssize_t>(self->GetWidth());
+  result.shape[2u] = static_cast<Py_ssize_t>(channels);
+  result.strides[2u] = sizeof(ChannelT);
+  result.strides[1u] = sizeof(typename T::value_type);
+  result.strides[0u] = result.shape[1u] * result.strides[1u];
+  return result;
+}
+
+#if PY_MAJOR_VERSION >= 3
+
+static int GetSensorDataViewBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "sensor data views are read-only");
+    view->obj = nullptr;
+    return -1;
+  }
+  const SensorDataView &data = boost::python::extract<const SensorDataView &>(exporter)();
+  Py_INCREF(exporter);
+  view->obj = exporter;
+  view->buf = const_cast<void *>(data.data);
+  view->len = data.shape[0u] * data.strides[0u];
+  view->readonly = 1;
+  view->itemsize = data.itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char *>(data.format) : nullptr;
+  view->ndim = data.ndim;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? const_cast<Py_ssize_t *>(data.shape) : nullptr;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? const_cast<Py_ssize_t *>(data.strides) : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+static PyBufferProcs SensorDataViewBufferProcs = { &GetSensorDataViewBuffer, nullptr };
+
+#endif // PY_MAJOR_VERSION >= 3
+
+// 返回传感器数据的内存视图，可以用 numpy.asarray 不复制地转换为数组。
+static boost::python::object GetSensorDataAsView(SensorDataView view) {
+#if PY_MAJOR_VERSION >= 3
+  boost::python::object exporter(std::move(view));
+  auto *ptr = PyMemoryView_FromObject(exporter.ptr());
+#else
+  // Python 2 的缓冲区不保存所有者，也没有形状和类型，只要传感器数据存在就有效。
+  auto *ptr = PyBuffer_FromMemory(
+      const_cast<void *>(view.data),
+      view.shape[0u] * view.strides[0u]);
+#endif
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
 // 模板函数ConvertImage，用于根据指定的颜色转换器类型转换图像数据  
 template <typename T>  
 static void ConvertImage(T &self, EColorConverter cc) {  
@@ -422,11 +607,9 @@ static FakeImage ColorCodedFlow(
   }
   return result;
 }
-// 定义一个保存图像到磁盘的模板函数
+// 把图像写入磁盘，调用时不能持有 GIL
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
-  carla::PythonUtil::ReleaseGIL unlock;
+static std::string WriteImageToDisk(const T &self, std::string path, EColorConverter cc) {
   using namespace carla::image;
   // 将图像数据转换为图像视图
   auto view = ImageView::MakeView(self);
@@ -453,12 +636,88 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
   }
 }
 
+// 定义一个保存图像到磁盘的模板函数
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
+  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  return WriteImageToDisk(self, std::move(path), cc);
 }
 
+template <typename T>
+static std::string SavePointCloudToDisk(T &self, std::string path, bool binary) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end(), binary);
+}
+
+// 在后台线程中把传感器数据写入磁盘，模拟循环不必等待磁盘。队列满时可以阻塞
+// 等待，也可以丢弃数据，丢弃的数量通过统计报告。
+class AsyncDiskWriter : private carla::NonCopyable {
+public:
+
+  AsyncDiskWriter(size_t max_queue_size, size_t worker_threads)
+    : _queue(max_queue_size, worker_threads) {}
+
+  ~AsyncDiskWriter() {
+    Close();
+  }
+
+  template <typename T>
+  bool SaveImage(boost::shared_ptr<T> image, std::string path, EColorConverter cc, bool block) {
+    return Push(std::move(image), [path, cc](const T &data) {
+      WriteImageToDisk(data, path, cc);
+    }, block);
+  }
+
+  template <typename T>
+  bool SavePointCloud(boost::shared_ptr<T> measurement, std::string path, bool binary, bool block) {
+    return Push(std::move(measurement), [path, binary](const T &data) {
+      carla::pointcloud::PointCloudIO::SaveToDisk(path, data.begin(), data.end(), binary);
+    }, block);
+  }
+
+  void Wait() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    _queue.Wait();
+  }
+
+  // 写完队列中的数据后结束工作线程，之后的数据都被丢弃。
+  void Close() {
+    if (carla::PythonUtil::ThisThreadHasTheGIL()) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      _queue.Stop();
+    } else {
+      _queue.Stop();
+    }
+  }
+
+  size_t GetMaxQueueSize() const {
+    return _queue.GetMaxSize();
+  }
+
+  carla::BoundedTaskQueue::Statistics GetStatistics() const {
+    return _queue.GetStatistics();
+  }
+
+private:
+
+  template <typename T, typename WriteT>
+  bool Push(boost::shared_ptr<T> data, WriteT write, bool block) {
+    if (data == nullptr) {
+      throw std::invalid_argument("cannot save None to disk");
+    }
+    // 从 Python 得到的指针持有 Python 对象的引用，要在持有 GIL 时释放。
+    std::shared_ptr<boost::shared_ptr<T>> holder(
+        new boost::shared_ptr<T>(std::move(data)),
+        carla::PythonUtil::AcquireGILDeleter());
+    auto task = [holder, write]() { write(**holder); };
+    carla::PythonUtil::ReleaseGIL unlock;
+    return _queue.Push(std::move(task), block);
+  }
+
+  carla::BoundedTaskQueue _queue;
+};
+
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
 {
     boost::python::dict myDict;
@@ -491,6 +750,165 @@ static boost::python::dict GetCustomV2XData(const carla::sensor::data::CustomV2X
     
     return myDict;
 }
+#if PY_MAJOR_VERSION >= 3
+
+// 要投影的点：激光雷达的测量数据，或形状为 (N, C) 的 float32 数组（C >= 3，前三列
+// 为 x、y、z），不复制数据
+class ProjectionPoints : private carla::NonCopyable {
+public:
+
+  explicit ProjectionPoints(const boost::python::object &points) : _owner(points) {
+    namespace py = boost::python;
+    namespace csd = carla::sensor::data;
+    py::extract<const csd::LidarMeasurement &> lidar(points);
+    py::extract<const csd::SemanticLidarMeasurement &> semantic_lidar(points);
+    if (lidar.check()) {
+      Set(lidar().data(), lidar().size());
+    } else if (semantic_lidar.check()) {
+      Set(semantic_lidar().data(), semantic_lidar().size());
+    } else {
+      if (PyObject_GetBuffer(points.ptr(), &_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        py::throw_error_already_set();
+      }
+      _has_view = true;
+      std::string format = (_view.format != nullptr) ? _view.format : "B";
+      if (!format.empty() && (format[0u] == '<' || format[0u] == '=' || format[0u] == '@')) {
+        format.erase(0u, 1u);
+      }
+      if ((_view.ndim != 2) || (_view.shape[1u] < 3) || (format != "f")) {
+        PyErr_SetString(PyExc_ValueError,
+            "points must be a lidar measurement or an array of shape (N, 3 or more) and type float32");
+        py::throw_error_already_set();
+      }
+      _data = static_cast<const float *>(_view.buf);
+      _stride = static_cast<size_t>(_view.shape[1u]);
+      _count = static_cast<size_t>(_view.shape[0u]);
+    }
+  }
+
+  ~ProjectionPoints() {
+    if (_has_view) {
+      PyBuffer_Release(&_view);
+    }
+  }
+
+  const float *data() const {
+    return _data;
+  }
+
+  size_t stride() const {
+    return _stride;
+  }
+
+  size_t size() const {
+    return _count;
+  }
+
+private:
+
+  template <typename T>
+  void Set(const T *detections, size_t count) {
+    static_assert(sizeof(T) % sizeof(float) == 0u, "Invalid detection layout");
+    _data = reinterpret_cast<const float *>(detections);
+    _stride = sizeof(T) / sizeof(float);
+    _count = count;
+  }
+
+  boost::python::object _owner;
+
+  Py_buffer _view;
+
+  bool _has_view = false;
+
+  const float *_data = nullptr;
+
+  size_t _stride = 3u;
+
+  size_t _count = 0u;
+};
+
+// 把 u、v 交错为 (..., 2) 的像素坐标数组，@a shape 为去掉最后一维的形状
+static boost::python::tuple MakeProjectionResult(
+    const std::vector<float> &u,
+    const std::vector<float> &v,
+    const std::vector<float> &depth,
+    std::vector<Py_ssize_t> shape) {
+  std::vector<float> pixels(2u * u.size());
+  for (size_t i = 0u; i < u.size(); ++i) {
+    pixels[2u * i] = u[i];
+    pixels[2u * i + 1u] = v[i];
+  }
+  auto depth_array = MakeFloatArray(depth, shape);
+  shape.push_back(2);
+  return boost::python::make_tuple(MakeFloatArray(pixels, shape), depth_array);
+}
+
+// 返回 (N, 2) 的像素坐标与 (N,) 的深度
+static boost::python::tuple ProjectPoints(
+    const carla::geom::CameraProjection &self,
+    const boost::python::object &points,
+    const carla::geom::Transform &source_transform) {
+  ProjectionPoints input(points);
+  std::vector<float> u(input.size()), v(input.size()), depth(input.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.ProjectPoints(
+        source_transform, input.data(), input.stride(), input.size(), u.data(), v.data(), depth.data());
+  }
+  return MakeProjectionResult(u, v, depth, {static_cast<Py_ssize_t>(input.size())});
+}
+
+// 返回 (N, 8, 2) 的像素坐标与 (N, 8) 的深度，顶点的顺序与 BoundingBox.get_world_vertices 相同
+static boost::python::tuple ProjectBoundingBoxes(
+    const carla::geom::CameraProjection &self,
+    const boost::python::object &boxes,
+    const boost::python::object &transforms) {
+  namespace py = boost::python;
+  const auto size = py::len(boxes);
+  if (py::len(transforms) != size) {
+    PyErr_SetString(PyExc_ValueError, "bounding_boxes and transforms must have the same length");
+    py::throw_error_already_set();
+  }
+  std::vector<carla::geom::BoundingBox> input_boxes;
+  std::vector<carla::geom::Transform> input_transforms;
+  input_boxes.reserve(static_cast<size_t>(size));
+  input_transforms.reserve(static_cast<size_t>(size));
+  for (auto i = 0; i < size; ++i) {
+    input_boxes.emplace_back(py::extract<carla::geom::BoundingBox>(boxes[i]));
+    input_transforms.emplace_back(py::extract<carla::geom::Transform>(transforms[i]));
+  }
+  const size_t count = 8u * input_boxes.size();
+  std::vector<float> x(count), y(count), z(count), u(count), v(count), depth(count);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    carla::geom::BoundingBox::GetWorldVertices(
+        input_boxes.data(), input_transforms.data(), input_boxes.size(), x.data(), y.data(), z.data());
+    self.ProjectWorldPoints(x.data(), y.data(), z.data(), count, u.data(), v.data(), depth.data());
+  }
+  return MakeProjectionResult(u, v, depth, {static_cast<Py_ssize_t>(size), 8});
+}
+
+// 返回 (height, width) 的稀疏深度图，每个像素为投影到该像素的最近点的深度，没有点时为 0
+static boost::python::object RenderDepth(
+    const carla::geom::CameraProjection &self,
+    const boost::python::object &points,
+    const carla::geom::Transform &source_transform) {
+  ProjectionPoints input(points);
+  std::vector<float> image(static_cast<size_t>(self.GetImageWidth()) * self.GetImageHeight(), 0.0f);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::vector<float> u(input.size()), v(input.size()), depth(input.size());
+    self.ProjectPoints(
+        source_transform, input.data(), input.stride(), input.size(), u.data(), v.data(), depth.data());
+    self.RenderDepth(u.data(), v.data(), depth.data(), input.size(), image.data());
+  }
+  return MakeFloatArray(image, {
+      static_cast<Py_ssize_t>(self.GetImageHeight()),
+      static_cast<Py_ssize_t>(self.GetImageWidth())});
+}
+
+#endif // PY_MAJOR_VERSION >= 3
+
 /**********************************************************************************************/
 void export_sensor_data() {
   using namespace boost::python;
@@ -502,6 +920,11 @@ void export_sensor_data() {
 
   // Fake image returned from optical flow to color conversion
   // fakes the regular image object. Only used for visual purposes
+  auto sensor_data_view = class_<SensorDataView>("SensorDataView", no_init);
+#if PY_MAJOR_VERSION >= 3
+  reinterpret_cast<PyTypeObject *>(sensor_data_view.ptr())->tp_as_buffer = &SensorDataViewBufferProcs;
+#endif
+
   class_<FakeImage>("FakeImage", no_init)
       .def(vector_indexing_suite<std::vector<uint8_t>>())
       .add_property("width", &FakeImage::Width)
@@ -516,6 +939,26 @@ void export_sensor_data() {
     .add_property("transform", CALL_RETURNING_COPY(cs::SensorData, GetSensorTransform))
   ;
 
+  class_<csd::CompressedData, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CompressedData>>("CompressedSensorData", no_init)
+    .add_property("compression", &csd::CompressedData::GetCompressionName)
+    .add_property("uncompressed_size", &csd::CompressedData::GetUncompressedSize)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::CompressedData>)
+    .def("decompress", +[](const csd::CompressedData &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.Decompress();
+    })
+    .def("__len__", &csd::CompressedData::size)
+  ;
+
+  class_<csd::LazyData, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LazyData>>("LazySensorData", no_init)
+    .add_property("is_materialized", &csd::LazyData::IsMaterialized)
+    .def("get", +[](const csd::LazyData &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.Get();
+    })
+    .def("__len__", &csd::LazyData::size)
+  ;
+
   enum_<EColorConverter>("ColorConverter")
     .value("Raw", EColorConverter::Raw)
     .value("Depth", EColorConverter::Depth)
@@ -546,6 +989,9 @@ void export_sensor_data() {
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::Image> &self) {
+      return GetSensorDataAsView(MakeImageView<csd::Image, uint8_t>(self, "B"));
+    })
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
     .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
     .def("__len__", &csd::Image::size)
@@ -559,11 +1005,26 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::ConvertedImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::ConvertedImage>>("ConvertedImage", no_init)
+    .add_property("width", &csd::ConvertedImage::GetWidth)
+    .add_property("height", &csd::ConvertedImage::GetHeight)
+    .add_property("fov", &csd::ConvertedImage::GetFOVAngle)
+    .add_property("format", &csd::ConvertedImage::GetFormatName)
+    .add_property("bytes_per_pixel", &csd::ConvertedImage::GetBytesPerPixel)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::ConvertedImage>)
+    .def("get_depth", &csd::ConvertedImage::GetDepth, (arg("index")))
+    .def("get_label", &csd::ConvertedImage::GetLabel, (arg("index")))
+    .def("__len__", &csd::ConvertedImage::GetPixelCount)
+  ;
+
   class_<csd::OpticalFlowImage, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::OpticalFlowImage>>("OpticalFlowImage", no_init)
     .add_property("width", &csd::OpticalFlowImage::GetWidth)
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::OpticalFlowImage> &self) {
+      return GetSensorDataAsView(MakeImageView<csd::OpticalFlowImage, float>(self, "f"));
+    })
     .def("get_color_coded_flow", &ColorCodedFlow)
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
@@ -580,8 +1041,11 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::LidarMeasurement> &self) {
+      return GetSensorDataAsView(MakeSensorDataView(self, LidarDetectionFormat));
+    })
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -593,12 +1057,39 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::LidarColumns, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LidarColumns>>("LidarColumns", no_init)
+    .add_property("horizontal_angle", &csd::LidarColumns::GetHorizontalAngle)
+    .add_property("channels", &csd::LidarColumns::GetChannelCount)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarColumns>)
+    .add_property("x", +[](const csd::LidarColumns &self) {
+      return GetColumnAsBuffer(self.GetX(), self.GetTotalPointCount());
+    })
+    .add_property("y", +[](const csd::LidarColumns &self) {
+      return GetColumnAsBuffer(self.GetY(), self.GetTotalPointCount());
+    })
+    .add_property("z", +[](const csd::LidarColumns &self) {
+      return GetColumnAsBuffer(self.GetZ(), self.GetTotalPointCount());
+    })
+    .add_property("intensity", +[](const csd::LidarColumns &self) {
+      return GetColumnAsBuffer(self.GetIntensity(), self.GetTotalPointCount());
+    })
+    .add_property("tag", +[](const csd::LidarColumns &self) {
+      return GetColumnAsBuffer(self.GetTags(), self.GetTotalPointCount());
+    })
+    .def("get_point_count", &csd::LidarColumns::GetPointCount, (arg("channel")))
+    .def("__len__", &csd::LidarColumns::GetTotalPointCount)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::SemanticLidarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::SemanticLidarMeasurement>>("SemanticLidarMeasurement", no_init)
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::SemanticLidarMeasurement> &self) {
+      return GetSensorDataAsView(MakeSensorDataView(self, SemanticLidarDetectionFormat));
+    })
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -630,22 +1121,39 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::GnssMeasurement::Sample>("GnssSample", no_init)
+    .def_readonly("time_offset", &csd::GnssMeasurement::Sample::time_offset)
+    .def_readonly("geo_location", &csd::GnssMeasurement::Sample::geo_location)
+  ;
+
   class_<csd::GnssMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::GnssMeasurement>>("GnssMeasurement", no_init)
     .add_property("latitude", &csd::GnssMeasurement::GetLatitude)
     .add_property("longitude", &csd::GnssMeasurement::GetLongitude)
     .add_property("altitude", &csd::GnssMeasurement::GetAltitude)
+    .add_property("samples", CALL_RETURNING_LIST(csd::GnssMeasurement, GetSamples))
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::IMUMeasurement::Sample>("IMUSample", no_init)
+    .def_readonly("time_offset", &csd::IMUMeasurement::Sample::time_offset)
+    .def_readonly("accelerometer", &csd::IMUMeasurement::Sample::accelerometer)
+    .def_readonly("gyroscope", &csd::IMUMeasurement::Sample::gyroscope)
+    .def_readonly("compass", &csd::IMUMeasurement::Sample::compass)
+  ;
+
   class_<csd::IMUMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::IMUMeasurement>>("IMUMeasurement", no_init)
     .add_property("accelerometer", &csd::IMUMeasurement::GetAccelerometer)
     .add_property("gyroscope", &csd::IMUMeasurement::GetGyroscope)
     .add_property("compass", &csd::IMUMeasurement::GetCompass)
+    .add_property("samples", CALL_RETURNING_LIST(csd::IMUMeasurement, GetSamples))
     .def(self_ns::str(self_ns::self))
   ;
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::RadarMeasurement> &self) {
+      return GetSensorDataAsView(MakeSensorDataView(self, RadarDetectionFormat));
+    })
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -658,6 +1166,53 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::WalkerPoseMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::WalkerPoseMeasurement>>("WalkerPoseMeasurement", no_init)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::WalkerPoseMeasurement>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::WalkerPoseMeasurement> &self) {
+      return GetSensorDataAsView(MakeSensorDataView(self, WalkerBonePoseFormat));
+    })
+    .def("get_walker_ids", CALL_RETURNING_LIST(csd::WalkerPoseMeasurement, GetWalkerIds))
+    .def("get_bone_count", +[](const csd::WalkerPoseMeasurement &self, carla::rpc::ActorId walker_id) {
+      const int index = self.FindWalker(walker_id);
+      if (index < 0) {
+        PyErr_SetString(PyExc_KeyError, "walker not in this measurement");
+        throw_error_already_set();
+      }
+      return self.GetBoneCount(static_cast<size_t>(index));
+    }, (arg("walker_id")))
+    .def("get_bones", +[](const csd::WalkerPoseMeasurement &self, carla::rpc::ActorId walker_id) {
+      const int index = self.FindWalker(walker_id);
+      if (index < 0) {
+        PyErr_SetString(PyExc_KeyError, "walker not in this measurement");
+        throw_error_already_set();
+      }
+      boost::python::list result;
+      auto bone = self.GetBones(static_cast<size_t>(index));
+      for (size_t i = 0u; i < self.GetBoneCount(static_cast<size_t>(index)); ++i, ++bone) {
+        result.append(carla::geom::Transform(
+            carla::geom::Location(bone->x, bone->y, bone->z),
+            carla::geom::Rotation(bone->pitch, bone->yaw, bone->roll)));
+      }
+      return result;
+    }, (arg("walker_id")))
+    .def("__len__", &csd::WalkerPoseMeasurement::GetWalkerCount)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<csd::TelemetryMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::TelemetryMeasurement>>("TelemetryMeasurement", no_init)
+    .def("get_vehicle_ids", CALL_RETURNING_LIST(csd::TelemetryMeasurement, GetVehicleIds))
+    .def("get_telemetry", +[](const csd::TelemetryMeasurement &self, carla::rpc::ActorId vehicle_id) {
+      const int index = self.FindVehicle(vehicle_id);
+      if (index < 0) {
+        PyErr_SetString(PyExc_KeyError, "vehicle not in this measurement");
+        throw_error_already_set();
+      }
+      return self.GetTelemetry(static_cast<size_t>(index));
+    }, (arg("vehicle_id")))
+    .def("__len__", &csd::TelemetryMeasurement::GetVehicleCount)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::RadarDetection>("RadarDetection")
     .def_readwrite("velocity", &csd::RadarDetection::velocity)
     .def_readwrite("azimuth", &csd::RadarDetection::azimuth)
@@ -680,6 +1235,33 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<csd::InstanceBox>("InstanceBox")
+    .add_property("actor_id", &csd::InstanceBox::actor_id)
+    .add_property("instance_id", &csd::InstanceBox::instance_id)
+    .add_property("semantic_tag", &csd::InstanceBox::semantic_tag)
+    .add_property("pixel_count", &csd::InstanceBox::pixel_count)
+    .add_property("x_min", &csd::InstanceBox::x_min)
+    .add_property("y_min", &csd::InstanceBox::y_min)
+    .add_property("x_max", &csd::InstanceBox::x_max)
+    .add_property("y_max", &csd::InstanceBox::y_max)
+    .add_property("occlusion", &csd::InstanceBox::occlusion)
+    .def("get_box_area", &csd::InstanceBox::GetBoxArea)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<csd::InstanceBoxes, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::InstanceBoxes>>("InstanceBoxes", no_init)
+    .add_property("width", &csd::InstanceBoxes::GetWidth)
+    .add_property("height", &csd::InstanceBoxes::GetHeight)
+    .add_property("fov", &csd::InstanceBoxes::GetFOVAngle)
+    .add_property("raw_data", &GetRawDataAsBuffer<csd::InstanceBoxes>)
+    .def("__len__", &csd::InstanceBoxes::size)
+    .def("__iter__", iterator<csd::InstanceBoxes>())
+    .def("__getitem__", +[](const csd::InstanceBoxes &self, size_t pos) -> csd::InstanceBox {
+      return self.at(pos);
+    })
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<csd::DVSEvent>("DVSEvent")
     .add_property("x", &csd::DVSEvent::x)
     .add_property("y", &csd::DVSEvent::y)
@@ -693,6 +1275,9 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .add_property("array_view", +[](const boost::shared_ptr<csd::DVSEventArray> &self) {
+      return GetSensorDataAsView(MakeSensorDataView(self, DVSEventFormat));
+    })
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -739,4 +1324,43 @@ void export_sensor_data() {
       return self.at(pos);
     })
   ;
+
+  class_<AsyncDiskWriter, boost::noncopyable>("AsyncDiskWriter",
+      init<size_t, size_t>((arg("max_queue_size")=64u, arg("worker_threads")=2u)))
+    .add_property("max_queue_size", &AsyncDiskWriter::GetMaxQueueSize)
+    .add_property("pending", +[](const AsyncDiskWriter &self) { return self.GetStatistics().pending; })
+    .add_property("completed", +[](const AsyncDiskWriter &self) { return self.GetStatistics().completed; })
+    .add_property("dropped", +[](const AsyncDiskWriter &self) { return self.GetStatistics().dropped; })
+    .add_property("failed", +[](const AsyncDiskWriter &self) { return self.GetStatistics().failed; })
+    .add_property("last_error", +[](const AsyncDiskWriter &self) { return self.GetStatistics().last_error; })
+    .def("save_image", &AsyncDiskWriter::SaveImage<csd::Image>,
+        (arg("image"), arg("path"), arg("color_converter")=EColorConverter::Raw, arg("block")=true))
+    .def("save_point_cloud", &AsyncDiskWriter::SavePointCloud<csd::LidarMeasurement>,
+        (arg("measurement"), arg("path"), arg("binary")=false, arg("block")=true))
+    .def("save_point_cloud", &AsyncDiskWriter::SavePointCloud<csd::SemanticLidarMeasurement>,
+        (arg("measurement"), arg("path"), arg("binary")=false, arg("block")=true))
+    .def("wait", &AsyncDiskWriter::Wait)
+    .def("close", &AsyncDiskWriter::Close)
+    .def("__enter__", +[](object self) { return self; })
+    .def("__exit__", +[](AsyncDiskWriter &self, object, object, object) { self.Close(); })
+  ;
+
+#if PY_MAJOR_VERSION >= 3
+  class_<carla::geom::CameraProjection>("CameraProjection",
+      init<carla::geom::Transform, uint32_t, uint32_t, float>(
+          (arg("camera_transform"), arg("image_width"), arg("image_height"), arg("fov"))))
+    .add_property("image_width", &carla::geom::CameraProjection::GetImageWidth)
+    .add_property("image_height", &carla::geom::CameraProjection::GetImageHeight)
+    .add_property("focal_length", &carla::geom::CameraProjection::GetFocalLength)
+    .add_property("intrinsics", +[](const carla::geom::CameraProjection &self) {
+      const auto k = self.GetIntrinsics();
+      return MakeFloatArray(std::vector<float>(k.begin(), k.end()), {3, 3});
+    })
+    .def("project_points", &ProjectPoints,
+        (arg("points"), arg("source_transform")=carla::geom::Transform()))
+    .def("project_bounding_boxes", &ProjectBoundingBoxes, (arg("bounding_boxes"), arg("transforms")))
+    .def("render_depth", &RenderDepth,
+        (arg("points"), arg("source_transform")=carla::geom::Transform()))
+  ;
+#endif // PY_MAJOR_VERSION >= 3
 }
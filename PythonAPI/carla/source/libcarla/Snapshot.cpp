@@ -7,6 +7,8 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/ActorList.h>
+#include <carla/client/ActorSnapshotColumns.h>
+#include <carla/client/ActorTrajectory.h>
 #include <carla/client/World.h>
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
@@ -27,6 +29,96 @@ namespace client {
 } // namespace client
 } // namespace carla
 
+// 按列存储的快照的 Python 接口，保持列数据在 Python 对象存活期间有效。
+struct ActorSnapshotColumnsView {
+  std::shared_ptr<const carla::client::ActorSnapshotColumns> columns;
+};
+
+// 参与者轨迹的 Python 接口。
+struct ActorTrajectoryView {
+  std::shared_ptr<const carla::client::ActorTrajectory> trajectory;
+};
+
+struct ActorTrajectoryDerivativesView {
+  std::shared_ptr<const carla::client::ActorTrajectoryDerivatives> derivatives;
+};
+
+// 快照或轨迹中的一列，通过缓冲区协议导出，numpy 可以不复制数据直接使用；
+// owner 保持列所属的对象存活。
+struct SnapshotColumn {
+  std::shared_ptr<const void> owner;
+  const void *data = nullptr;
+  const char *format = nullptr;
+  Py_ssize_t itemsize = 0;
+  int ndim = 1;
+  Py_ssize_t shape[2u] = {0, 0};
+  Py_ssize_t strides[2u] = {0, 0};
+};
+
+template <typename T>
+static SnapshotColumn MakeSnapshotColumn(
+    std::shared_ptr<const void> owner,
+    const std::vector<T> &column,
+    const char *format,
+    size_t row_size) {
+  SnapshotColumn result;
+  result.owner = std::move(owner);
+  result.data = column.data();
+  result.format = format;
+  result.itemsize = sizeof(T);
+  result.ndim = (row_size > 1u) ? 2 : 1;
+  result.shape[0u] = static_cast<Py_ssize_t>(column.size() / row_size);
+  result.shape[1u] = static_cast<Py_ssize_t>(row_size);
+  result.strides[0u] = static_cast<Py_ssize_t>(row_size * sizeof(T));
+  result.strides[1u] = static_cast<Py_ssize_t>(sizeof(T));
+  return result;
+}
+
+#if PY_MAJOR_VERSION >= 3
+
+static int GetSnapshotColumnBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "snapshot columns are read-only");
+    view->obj = nullptr;
+    return -1;
+  }
+  const SnapshotColumn &column = boost::python::extract<const SnapshotColumn &>(exporter)();
+  Py_INCREF(exporter);
+  view->obj = exporter;
+  view->buf = const_cast<void *>(column.data);
+  view->len = column.shape[0u] * column.strides[0u];
+  view->readonly = 1;
+  view->itemsize = column.itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char *>(column.format) : nullptr;
+  view->ndim = column.ndim;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? const_cast<Py_ssize_t *>(column.shape) : nullptr;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? const_cast<Py_ssize_t *>(column.strides) : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+static PyBufferProcs SnapshotColumnBufferProcs = { &GetSnapshotColumnBuffer, nullptr };
+
+#endif // PY_MAJOR_VERSION >= 3
+
+// 返回列的内存视图，可以用 numpy.asarray 不复制地转换为数组。
+template <typename T>
+static boost::python::object GetSnapshotColumnAsBuffer(
+    std::shared_ptr<const void> owner,
+    const std::vector<T> &column,
+    const char *format,
+    size_t row_size) {
+  boost::python::object exporter(MakeSnapshotColumn(std::move(owner), column, format, row_size));
+#if PY_MAJOR_VERSION >= 3
+  auto *ptr = PyMemoryView_FromObject(exporter.ptr());
+#else
+  // Python 2 的缓冲区不保存所有者，只要快照或轨迹存在就有效。
+  auto *ptr = PyBuffer_FromMemory(const_cast<T *>(column.data()), sizeof(T) * column.size());
+#endif
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
 void export_snapshot() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -40,6 +132,80 @@ void export_snapshot() {
     .def(self_ns::str(self_ns::self))// 定义用于将 ActorSnapshot 对象转换为字符串的方法
   ;
   // 定义 Python 中的 WorldSnapshot 类
+  using Columns = cc::ActorSnapshotColumns;
+
+  auto snapshot_column = class_<SnapshotColumn>("SnapshotColumn", no_init);
+#if PY_MAJOR_VERSION >= 3
+  reinterpret_cast<PyTypeObject *>(snapshot_column.ptr())->tp_as_buffer = &SnapshotColumnBufferProcs;
+#endif
+
+  class_<ActorSnapshotColumnsView>("ActorSnapshotColumns", no_init)
+    .add_property("ids", +[](const ActorSnapshotColumnsView &self) {
+      return GetSnapshotColumnAsBuffer(self.columns, self.columns->GetIds(), "I", 1u);
+    })
+    .add_property("transforms", +[](const ActorSnapshotColumnsView &self) {
+      return GetSnapshotColumnAsBuffer(self.columns, self.columns->GetTransforms(), "f", Columns::TRANSFORM_SIZE);
+    })
+    .add_property("velocities", +[](const ActorSnapshotColumnsView &self) {
+      return GetSnapshotColumnAsBuffer(self.columns, self.columns->GetVelocities(), "f", Columns::VECTOR_SIZE);
+    })
+    .add_property("angular_velocities", +[](const ActorSnapshotColumnsView &self) {
+      return GetSnapshotColumnAsBuffer(self.columns, self.columns->GetAngularVelocities(), "f", Columns::VECTOR_SIZE);
+    })
+    .add_property("accelerations", +[](const ActorSnapshotColumnsView &self) {
+      return GetSnapshotColumnAsBuffer(self.columns, self.columns->GetAccelerations(), "f", Columns::VECTOR_SIZE);
+    })
+    .def("find_index", +[](const ActorSnapshotColumnsView &self, carla::ActorId id) -> object {
+      auto index = self.columns->FindIndex(id);
+      return index.has_value() ? object(*index) : object();
+    }, (arg("actor_id")))
+    .def("__len__", +[](const ActorSnapshotColumnsView &self) { return self.columns->size(); })
+  ;
+
+  using Trajectory = cc::ActorTrajectory;
+
+  class_<ActorTrajectoryDerivativesView>("ActorTrajectoryDerivatives", no_init)
+    .add_property("velocities", +[](const ActorTrajectoryDerivativesView &self) {
+      return GetSnapshotColumnAsBuffer(self.derivatives, self.derivatives->velocities, "f", Trajectory::VECTOR_SIZE);
+    })
+    .add_property("accelerations", +[](const ActorTrajectoryDerivativesView &self) {
+      return GetSnapshotColumnAsBuffer(self.derivatives, self.derivatives->accelerations, "f", Trajectory::VECTOR_SIZE);
+    })
+    .add_property("rotation_rates", +[](const ActorTrajectoryDerivativesView &self) {
+      return GetSnapshotColumnAsBuffer(self.derivatives, self.derivatives->rotation_rates, "f", Trajectory::VECTOR_SIZE);
+    })
+    .def("__len__", +[](const ActorTrajectoryDerivativesView &self) {
+      return self.derivatives->velocities.size() / Trajectory::VECTOR_SIZE;
+    })
+  ;
+
+  class_<ActorTrajectoryView>("ActorTrajectory", no_init)
+    .add_property("id", +[](const ActorTrajectoryView &self) { return self.trajectory->GetId(); })
+    .add_property("frames", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetFrames(), "Q", 1u);
+    })
+    .add_property("timestamps", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetTimestamps(), "d", 1u);
+    })
+    .add_property("transforms", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetTransforms(), "f", Trajectory::TRANSFORM_SIZE);
+    })
+    .add_property("velocities", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetVelocities(), "f", Trajectory::VECTOR_SIZE);
+    })
+    .add_property("angular_velocities", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetAngularVelocities(), "f", Trajectory::VECTOR_SIZE);
+    })
+    .add_property("accelerations", +[](const ActorTrajectoryView &self) {
+      return GetSnapshotColumnAsBuffer(self.trajectory, self.trajectory->GetAccelerations(), "f", Trajectory::VECTOR_SIZE);
+    })
+    .def("compute_derivatives", +[](const ActorTrajectoryView &self) {
+      return ActorTrajectoryDerivativesView{
+          std::make_shared<const cc::ActorTrajectoryDerivatives>(self.trajectory->ComputeDerivatives())};
+    })
+    .def("__len__", +[](const ActorTrajectoryView &self) { return self.trajectory->size(); })
+  ;
+
   class_<cc::WorldSnapshot>("WorldSnapshot", no_init)
     .add_property("id", &cc::WorldSnapshot::GetId)
     .add_property("frame", +[](const cc::WorldSnapshot &self) { return self.GetTimestamp().frame; })
@@ -52,6 +218,9 @@ void export_snapshot() {
     /// @}
     .def("has_actor", &cc::WorldSnapshot::Contains, (arg("actor_id")))
     .def("find", CALL_RETURNING_OPTIONAL_1(cc::WorldSnapshot, Find, carla::ActorId), (arg("actor_id")))
+    .def("get_columns", +[](const cc::WorldSnapshot &self) {
+      return ActorSnapshotColumnsView{self.GetColumns()};
+    })
     .def("__len__", &cc::WorldSnapshot::size)// 定义方法 __len__，返回 WorldSnapshot 中的元素数量
     .def("__iter__", range(&cc::WorldSnapshot::begin, &cc::WorldSnapshot::end)) // 定义方法 __iter__，用于迭代 WorldSnapshot 的元素
     .def("__eq__", &cc::WorldSnapshot::operator==)// 定义方法 __eq__，用于比较两个 WorldSnapshot 对象是否相等
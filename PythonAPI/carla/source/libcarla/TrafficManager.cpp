@@ -65,6 +65,16 @@ void InterSetImportedRoute(carla::traffic_manager::TrafficManager& self, const A
   self.SetImportedRoute(actor, RoadOptionToUint(input), empty_buffer); // 调用TrafficManager的SetImportedRoute方法，将Python列表转换为uint8_t的vector作为输入
 }
  
+// 为一组车辆规划并设置到各自终点的路线
+void InterSetDestinations(carla::traffic_manager::TrafficManager& self, boost::python::list actors, boost::python::list destinations, bool empty_buffer) {
+  self.SetDestinations(PythonLitstToVector<ActorPtr>(actors), PythonLitstToVector<carla::geom::Location>(destinations), empty_buffer);
+}
+
+// 设置分片模式下交通管理器负责的区域
+void InterSetShardRegion(carla::traffic_manager::TrafficManager& self, const carla::geom::BoundingBox &region, boost::python::list neighbour_endpoints, boost::python::list neighbour_regions) {
+  self.SetShardRegion(region, PythonLitstToVector<std::string>(neighbour_endpoints), PythonLitstToVector<carla::geom::BoundingBox>(neighbour_regions));
+}
+
 // 获取下一个动作
 boost::python::list InterGetNextAction(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor_ptr) {
   boost::python::list l; // 用于存储返回结果的Python列表
@@ -87,6 +97,34 @@ boost::python::list InterGetActionBuffer(carla::traffic_manager::TrafficManager&
   return l;
 }
 
+// 将 (actor, parameter, value) 的序列转换为车辆参数，actor 可以是 carla.Actor 或者它的 ID
+std::vector<carla::traffic_manager::VehicleParameterUpdate> PythonToVehicleParameterUpdates(boost::python::object input) {
+  namespace py = boost::python;
+  std::vector<carla::traffic_manager::VehicleParameterUpdate> updates;
+  const auto size = py::len(input);
+  updates.reserve(static_cast<size_t>(size));
+  for (decltype(py::len(input)) i = 0; i < size; ++i) {
+    py::object item = input[i];
+    carla::traffic_manager::VehicleParameterUpdate update;
+    py::extract<ActorPtr> actor(item[0]);
+    update.actor_id = actor.check() ? actor()->GetId() : py::extract<ActorId>(item[0])();
+    update.parameter = py::extract<carla::traffic_manager::VehicleParameter>(item[1]);
+    update.value = py::extract<float>(item[2]);
+    updates.emplace_back(update);
+  }
+  return updates;
+}
+
+// 批量设置车辆参数
+void InterSetVehicleParameters(carla::traffic_manager::TrafficManager& self, boost::python::object updates) {
+  self.SetVehicleParameters(PythonToVehicleParameterUpdates(updates));
+}
+
+// 注册车辆并应用参数预设
+void InterRegisterVehicles(carla::traffic_manager::TrafficManager& self, boost::python::list actors, boost::python::object presets) {
+  self.RegisterVehicles(PythonLitstToVector<ActorPtr>(actors), PythonToVehicleParameterUpdates(presets));
+}
+
 
 // 导出TrafficManager相关功能的函数
 void export_trafficmanager() {
@@ -94,6 +132,23 @@ void export_trafficmanager() {
   namespace ctm = carla::traffic_manager; // 定义别名简化命名空间引用
   using namespace boost::python; // 使用Boost.Python命名空间，方便后续代码调用Boost.Python的功能
 
+  enum_<ctm::VehicleParameter>("VehicleParameter")
+    .value("PercentageSpeedDifference", ctm::VehicleParameter::PercentageSpeedDifference)
+    .value("LaneOffset", ctm::VehicleParameter::LaneOffset)
+    .value("DesiredSpeed", ctm::VehicleParameter::DesiredSpeed)
+    .value("DistanceToLeadingVehicle", ctm::VehicleParameter::DistanceToLeadingVehicle)
+    .value("AutoLaneChange", ctm::VehicleParameter::AutoLaneChange)
+    .value("ForceLaneChange", ctm::VehicleParameter::ForceLaneChange)
+    .value("UpdateVehicleLights", ctm::VehicleParameter::UpdateVehicleLights)
+    .value("PercentageRunningLight", ctm::VehicleParameter::PercentageRunningLight)
+    .value("PercentageRunningSign", ctm::VehicleParameter::PercentageRunningSign)
+    .value("PercentageIgnoreVehicles", ctm::VehicleParameter::PercentageIgnoreVehicles)
+    .value("PercentageIgnoreWalkers", ctm::VehicleParameter::PercentageIgnoreWalkers)
+    .value("KeepRightPercentage", ctm::VehicleParameter::KeepRightPercentage)
+    .value("RandomLeftLaneChangePercentage", ctm::VehicleParameter::RandomLeftLaneChangePercentage)
+    .value("RandomRightLaneChangePercentage", ctm::VehicleParameter::RandomRightLaneChangePercentage)
+  ;
+
   class_<ctm::TrafficManager>("TrafficManager", no_init)
     .def("get_port", &ctm::TrafficManager::Port)
     .def("vehicle_percentage_speed_difference", &ctm::TrafficManager::SetPercentageSpeedDifference, (arg("actor"), arg("percentage")))
@@ -117,10 +172,16 @@ void export_trafficmanager() {
     .def("set_synchronous_mode", &ctm::TrafficManager::SetSynchronousMode, (arg("mode_switch")))
     .def("set_hybrid_physics_mode", &ctm::TrafficManager::SetHybridPhysicsMode, (arg("enabled")))
     .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius, (arg("r")))
+    .def("set_mesoscopic_radius", &ctm::TrafficManager::SetMesoscopicRadius, (arg("r")))
+    .def("set_stage_worker_threads", &ctm::TrafficManager::SetStageWorkerThreads, (arg("number_of_threads")))
     .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed, (arg("value")))
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode, (arg("mode_switch")))
+    .def("set_shard_region", &InterSetShardRegion, (arg("region"), arg("neighbour_endpoints")=boost::python::list(), arg("neighbour_regions")=boost::python::list()))
     .def("set_path", &InterSetCustomPath, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_route", &InterSetImportedRoute, (arg("actor"), arg("path"), arg("empty_buffer")=true))
+    .def("set_destinations", &InterSetDestinations, (arg("actors"), arg("destinations"), arg("empty_buffer")=true))
+    .def("set_vehicle_parameters", &InterSetVehicleParameters, (arg("updates")))
+    .def("register_vehicles", &InterRegisterVehicles, (arg("actors"), arg("presets")=boost::python::list()))
     .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles, (arg("mode_switch")))
     .def("set_boundaries_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles, (arg("lower_bound"), arg("upper_bound")))
     .def("get_next_action", &InterGetNextAction, (arg("actor")))
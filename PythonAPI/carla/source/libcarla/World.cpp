@@ -7,11 +7,19 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/ActorList.h>
+#include <carla/client/ActorStateChanges.h>
 #include <carla/client/World.h>
+#include <carla/sensor/SensorData.h>
+#include <carla/rpc/ActorQuery.h>
+#include <carla/rpc/ActorQueryResult.h>
 #include <carla/rpc/EnvironmentObject.h>
+#include <carla/rpc/FrameTimings.h>
 #include <carla/rpc/ObjectLabel.h>
+#include <carla/rpc/SensorTickPlan.h>
 
 // 引入标准库中的字符串处理功能
+#include <limits>
+#include <mutex>
 #include <string>
 
 // 引入Boost Python库中的vector容器相关的功能
@@ -55,7 +63,11 @@ namespace rpc {
         << ",max_substep_delta_time=" << settings.max_substep_delta_time
         << ",max_substeps=" << settings.max_substeps
         << ",max_culling_distance=" << settings.max_culling_distance
-        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls) << ')';
+        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls)
+        << ",deterministic_physics=" << BoolToStr(settings.deterministic_physics)
+        << ",kinematic_physics_distance=" << settings.kinematic_physics_distance
+        << ",physics_only_mode=" << BoolToStr(settings.physics_only_mode)
+        << ",target_realtime_factor=" << settings.target_realtime_factor << ')';
     return out;
   }
 
@@ -74,17 +86,173 @@ namespace rpc {
 
 
 static auto WaitForTick(const carla::client::World &world, double seconds) {
-  carla::PythonUtil::ReleaseGIL unlock;
-  return world.WaitForTick(TimeDurationFromSeconds(seconds));
+  auto snapshot = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return world.WaitForTick(TimeDurationFromSeconds(seconds));
+  }();
+  // 处理用 executor="tick" 注册的传感器回调
+  SensorCallbackDispatcher::Get().DispatchTickCallbacks();
+  return snapshot;
 }
 
 static size_t OnTick(carla::client::World &self, boost::python::object callback) {
   return self.OnTick(MakeCallback(std::move(callback)));
 }
 
+// 地图层加载完成的回调在 tick 回调的线程中调用，需要重新获取 GIL
+static std::function<void()> MakeMapLayerCallback(boost::python::object callback) {
+  namespace py = boost::python;
+  if (callback.is_none()) {
+    return {};
+  }
+  if (!PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+    py::throw_error_already_set();
+  }
+  using Deleter = carla::PythonUtil::AcquireGILDeleter;
+  auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+  return [callback=std::move(callback_ptr)]() {
+    carla::PythonUtil::AcquireGIL lock;
+    try {
+      py::call<void>(callback->ptr());
+    } catch (const py::error_already_set &) {
+      PyErr_Print();
+    }
+  };
+}
+
+static void LoadLevelLayerAsync(
+    const carla::client::World &self,
+    carla::rpc::MapLayer map_layers,
+    boost::python::object callback) {
+  auto on_done = MakeMapLayerCallback(std::move(callback));
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.LoadLevelLayerAsync(map_layers, std::move(on_done));
+}
+
+static void UnloadLevelLayerAsync(
+    const carla::client::World &self,
+    carla::rpc::MapLayer map_layers,
+    boost::python::object callback) {
+  auto on_done = MakeMapLayerCallback(std::move(callback));
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.UnloadLevelLayerAsync(map_layers, std::move(on_done));
+}
+
+// 传感器组的回调：在持有 GIL 时将所有传感器的数据转换为一个 Python 列表
+static uint32_t ListenToSensors(
+    carla::client::World &self,
+    boost::python::object sensors,
+    boost::python::object callback) {
+  namespace py = boost::python;
+  if (!PyCallable_Check(callback.ptr())) {
+    PyErr_SetString(PyExc_TypeError, "callback argument must be callable!");
+    py::throw_error_already_set();
+  }
+  std::vector<carla::ActorId> sensor_ids;
+  for (py::stl_input_iterator<py::object> it(sensors), end; it != end; ++it) {
+    sensor_ids.push_back(py::extract<carla::client::Actor &>(*it)().GetId());
+  }
+  using Deleter = carla::PythonUtil::AcquireGILDeleter;
+  auto callback_ptr = carla::SharedPtr<py::object>{new py::object(callback), Deleter()};
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.ListenToSensors(
+      sensor_ids,
+      [callback=std::move(callback_ptr)](std::vector<carla::SharedPtr<carla::sensor::SensorData>> bundle) {
+        carla::PythonUtil::AcquireGIL lock;
+        try {
+          py::list data;
+          for (auto &item : bundle) {
+            data.append(item);
+          }
+          py::call<void>(callback->ptr(), data);
+        } catch (const py::error_already_set &) {
+          PyErr_Print();
+        }
+      });
+}
+
 static auto Tick(carla::client::World &world, double seconds) {
+  // 处理用 executor="tick" 注册的传感器回调，包括上一次 tick 之后才到达的数据
+  SensorCallbackDispatcher::Get().DispatchTickCallbacks();
+  auto frame = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return world.Tick(TimeDurationFromSeconds(seconds));
+  }();
+  SensorCallbackDispatcher::Get().DispatchTickCallbacks();
+  return frame;
+}
+
+// tick_async 和 wait_for_tick_async 的 asyncio.Future 完成时，在事件循环的线程中
+// 处理用 executor="tick" 注册的传感器回调，在等待的协程继续执行之前
+static void DispatchTickCallbacksWhenDone(boost::python::object future) {
+  namespace py = boost::python;
+  static auto *dispatch = new py::object(py::make_function(+[](py::object) {
+    SensorCallbackDispatcher::Get().DispatchTickCallbacks();
+  }));
+  future.attr("add_done_callback")(*dispatch);
+}
+
+// 与 Tick 相同，但返回 asyncio.Future，节拍命令的响应和这一帧的快照在后台线程中等待
+static boost::python::object TickAsync(carla::client::World &world, double seconds) {
+  SensorCallbackDispatcher::Get().DispatchTickCallbacks();
+  auto future = [&]() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return world.TickAsync(TimeDurationFromSeconds(seconds));
+  }();
+  auto result = AwaitRpcFuture(future, [](const carla::client::RpcFuture<uint64_t> &cue) {
+    // 同步模式下交通管理器的节拍可能需要一段时间
+    uint64_t frame;
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      frame = cue.Get();
+    }
+    return boost::python::object(frame);
+  });
+  DispatchTickCallbacksWhenDone(result);
+  return result;
+}
+
+// 返回以下一个快照完成的 asyncio.Future，快照由流的回调提供，不占用线程等待
+static boost::python::object WaitForTickAsync(carla::client::World &world) {
+  struct PendingTick {
+    std::mutex mutex;
+    size_t callback_id = 0u;
+    bool done = false;
+  };
+  AsyncIOFuture result;
+  auto pending = std::make_shared<PendingTick>();
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::lock_guard<std::mutex> lock(pending->mutex);
+    pending->callback_id = world.OnTick([world, pending, result](carla::client::WorldSnapshot snapshot) mutable {
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      if (pending->done) {
+        return;
+      }
+      pending->done = true;
+      world.RemoveOnTick(pending->callback_id);
+      AsyncIOWaiter::Get().Post([result, snapshot]() {
+        result.SetResult(boost::python::object(snapshot));
+      });
+    });
+  }
+  auto future = result.GetFuture();
+  DispatchTickCallbacksWhenDone(future);
+  return future;
+}
+
+static auto RegisterTickParticipant(carla::client::World &world, const std::string &name, double deadline) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return world.Tick(TimeDurationFromSeconds(seconds));
+  return world.RegisterTickParticipant(name, TimeDurationFromSeconds(deadline));
+}
+
+static void NotifyTickReady(carla::client::World &world, uint32_t participant_id, boost::python::object frame) {
+  if (frame.is_none()) {
+    world.NotifyTickReady(participant_id);
+  } else {
+    world.NotifyTickReady(participant_id, boost::python::extract<uint64_t>(frame));
+  }
 }
 
 static auto ApplySettings(carla::client::World &world, carla::rpc::EpisodeSettings settings, double seconds) {
@@ -100,6 +268,84 @@ static auto GetActorsById(carla::client::World &self, const boost::python::list
   return self.GetActors(ids);
 }
 
+static auto QueryActors(
+    carla::client::World &self,
+    const boost::python::object &actor_ids,
+    const std::string &type_id,
+    const boost::python::object &semantic_tags,
+    const carla::geom::Location &center,
+    float radius,
+    carla::rpc::ActorQueryFieldType fields) {
+  carla::rpc::ActorQuery query;
+  query.actor_ids.assign(
+      boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+      boost::python::stl_input_iterator<carla::ActorId>());
+  query.type_id_filter = type_id;
+  for (boost::python::stl_input_iterator<carla::rpc::CityObjectLabel> it(semantic_tags), end; it != end; ++it) {
+    query.semantic_tags.emplace_back(static_cast<uint8_t>(*it));
+  }
+  query.center = center;
+  query.radius = radius;
+  query.fields = fields;
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.QueryActors(query);
+}
+
+template <typename T>
+static boost::python::list ColumnToList(const std::vector<T> &column) {
+  boost::python::list result;
+  for (const auto &item : column) {
+    result.append(item);
+  }
+  return result;
+}
+
+template <typename T, std::vector<T> carla::rpc::ActorQueryResult::*Column>
+static boost::python::list GetQueryColumn(const carla::rpc::ActorQueryResult &self) {
+  return ColumnToList(self.*Column);
+}
+
+static boost::python::list GetTickPlanSensors(const carla::rpc::SensorTickPlan &self) {
+  return ColumnToList(self.sensors);
+}
+
+static boost::python::list GetTickPlanFrameCosts(const carla::rpc::SensorTickPlan &self) {
+  return ColumnToList(self.frame_costs);
+}
+
+template <typename T, std::vector<T> carla::client::ActorStateChanges::*Column>
+static boost::python::list GetActorChangesColumn(const carla::client::ActorStateChanges &self) {
+  return ColumnToList(self.*Column);
+}
+
+static size_t OnActorChanges(carla::client::World &self, boost::python::object callback) {
+  return self.OnActorChanges(MakeCallback(std::move(callback)));
+}
+
+static boost::python::list GetQuerySemanticTags(const carla::rpc::ActorQueryResult &self) {
+  boost::python::list result;
+  for (const auto &tags : self.semantic_tags) {
+    boost::python::list item;
+    for (auto tag : tags) {
+      item.append(static_cast<carla::rpc::CityObjectLabel>(tag));
+    }
+    result.append(item);
+  }
+  return result;
+}
+
+static boost::python::list GetQueryAttributes(const carla::rpc::ActorQueryResult &self) {
+  boost::python::list result;
+  for (const auto &attributes : self.attributes) {
+    boost::python::dict item;
+    for (const auto &attribute : attributes) {
+      item[attribute.id] = attribute.value;
+    }
+    result.append(item);
+  }
+  return result;
+}
+
 static auto GetVehiclesLightStates(carla::client::World &self) {
   boost::python::dict dict;
   auto list = self.GetVehiclesLightStates();
@@ -125,6 +371,18 @@ static auto GetEnvironmentObjects(const carla::client::World &self, uint8_t quer
   return result;
 }
 
+static auto GetEnvironmentObjectsInRadius(
+    const carla::client::World &self,
+    const carla::geom::Location &location,
+    float radius,
+    uint8_t queried_tag) {
+  boost::python::list result;
+  for (const auto &object : self.GetEnvironmentObjectsInRadius(location, radius, queried_tag)) {
+    result.append(object);
+  }
+  return result;
+}
+
 static void EnableEnvironmentObjects(
   carla::client::World &self,
   const boost::python::object& py_env_objects_ids,
@@ -161,6 +419,65 @@ void export_world() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cr::FrameTimings>("FrameTimings", no_init)
+    .def_readonly("frame", &cr::FrameTimings::frame)
+    .def_readonly("platform_timestamp", &cr::FrameTimings::platform_timestamp)
+    .def_readonly("rpc", &cr::FrameTimings::rpc)
+    .def_readonly("pre_tick", &cr::FrameTimings::pre_tick)
+    .def_readonly("world_tick", &cr::FrameTimings::world_tick)
+    .def_readonly("post_tick", &cr::FrameTimings::post_tick)
+    .def_readonly("episode_state", &cr::FrameTimings::episode_state)
+    .def_readonly("sensors", &cr::FrameTimings::sensors)
+    .def_readonly("server_total", &cr::FrameTimings::server_total)
+    .def_readonly("budget", &cr::FrameTimings::budget)
+    .def_readonly("idle", &cr::FrameTimings::idle)
+    .def_readonly("realtime_factor", &cr::FrameTimings::realtime_factor)
+    .def_readonly("substeps", &cr::FrameTimings::substeps)
+    .def_readonly("deferred_sensors", &cr::FrameTimings::deferred_sensors)
+    .def_readonly("deserialization", &cr::FrameTimings::deserialization)
+    .def_readonly("callbacks", &cr::FrameTimings::callbacks)
+  ;
+
+  class_<cr::SensorTickPlan::Sensor>("SensorTickSchedule", no_init)
+    .def_readonly("actor_id", &cr::SensorTickPlan::Sensor::actor_id)
+    .def_readonly("period_frames", &cr::SensorTickPlan::Sensor::period_frames)
+    .def_readonly("phase_frames", &cr::SensorTickPlan::Sensor::phase_frames)
+    .def_readonly("estimated_cost", &cr::SensorTickPlan::Sensor::estimated_cost)
+    .def_readonly("measured_cost", &cr::SensorTickPlan::Sensor::measured_cost)
+  ;
+
+  class_<cr::SensorTickPlan>("SensorTickPlan", no_init)
+    .def_readonly("fixed_delta_seconds", &cr::SensorTickPlan::fixed_delta_seconds)
+    .def_readonly("first_frame", &cr::SensorTickPlan::first_frame)
+    .add_property("sensors", &GetTickPlanSensors)
+    .add_property("frame_costs", &GetTickPlanFrameCosts)
+  ;
+
+  using VehicleLightChange = cc::ActorStateChanges::VehicleLightChange;
+  using LightStateEnum = cr::VehicleLightState::LightState;
+
+  class_<cc::ActorStateChanges::TrafficLightChange>("TrafficLightStateChange", no_init)
+    .def_readonly("actor_id", &cc::ActorStateChanges::TrafficLightChange::id)
+    .def_readonly("previous", &cc::ActorStateChanges::TrafficLightChange::previous)
+    .def_readonly("state", &cc::ActorStateChanges::TrafficLightChange::state)
+  ;
+
+  class_<VehicleLightChange>("VehicleLightStateChange", no_init)
+    .def_readonly("actor_id", &VehicleLightChange::id)
+    .add_property("previous", +[](const VehicleLightChange &self) { return static_cast<LightStateEnum>(self.previous); })
+    .add_property("state", +[](const VehicleLightChange &self) { return static_cast<LightStateEnum>(self.state); })
+  ;
+
+  class_<cc::ActorStateChanges>("ActorStateChanges", no_init)
+    .def_readonly("frame", &cc::ActorStateChanges::frame)
+    .def_readonly("episode_changed", &cc::ActorStateChanges::episode_changed)
+    .add_property("spawned", &GetActorChangesColumn<carla::ActorId, &cc::ActorStateChanges::spawned>)
+    .add_property("destroyed", &GetActorChangesColumn<carla::ActorId, &cc::ActorStateChanges::destroyed>)
+    .add_property("moved", &GetActorChangesColumn<carla::ActorId, &cc::ActorStateChanges::moved>)
+    .add_property("traffic_lights", &GetActorChangesColumn<cc::ActorStateChanges::TrafficLightChange, &cc::ActorStateChanges::traffic_lights>)
+    .add_property("vehicle_lights", &GetActorChangesColumn<VehicleLightChange, &cc::ActorStateChanges::vehicle_lights>)
+  ;
+
   class_<cc::ActorList, boost::shared_ptr<cc::ActorList>>("ActorList", no_init)
     .def("find", &cc::ActorList::Find, (arg("id")))
     .def("filter", &cc::ActorList::Filter, (arg("wildcard_pattern")))
@@ -171,7 +488,7 @@ void export_world() {
   ;
 
   class_<cr::EpisodeSettings>("WorldSettings")
-    .def(init<bool, bool, double, bool, double, int, float, bool, float, float, bool>(
+    .def(init<bool, bool, double, bool, double, int, float, bool, float, float, bool, bool, float, bool, double>(
         (arg("synchronous_mode")=false,
          arg("no_rendering_mode")=false,
          arg("fixed_delta_seconds")=0.0,
@@ -182,7 +499,11 @@ void export_world() {
          arg("deterministic_ragdolls")=false,
          arg("tile_stream_distance")=3000.f,
          arg("actor_active_distance")=2000.f,
-         arg("spectator_as_ego")=true)))
+         arg("spectator_as_ego")=true,
+         arg("deterministic_physics")=false,
+         arg("kinematic_physics_distance")=0.0f,
+         arg("physics_only_mode")=false,
+         arg("target_realtime_factor")=0.0)))
     .def_readwrite("synchronous_mode", &cr::EpisodeSettings::synchronous_mode)
     .def_readwrite("no_rendering_mode", &cr::EpisodeSettings::no_rendering_mode)
     .def_readwrite("substepping", &cr::EpisodeSettings::substepping)
@@ -201,6 +522,10 @@ void export_world() {
     .def_readwrite("tile_stream_distance", &cr::EpisodeSettings::tile_stream_distance)
     .def_readwrite("actor_active_distance", &cr::EpisodeSettings::actor_active_distance)
     .def_readwrite("spectator_as_ego", &cr::EpisodeSettings::spectator_as_ego)
+    .def_readwrite("deterministic_physics", &cr::EpisodeSettings::deterministic_physics)
+    .def_readwrite("kinematic_physics_distance", &cr::EpisodeSettings::kinematic_physics_distance)
+    .def_readwrite("physics_only_mode", &cr::EpisodeSettings::physics_only_mode)
+    .def_readwrite("target_realtime_factor", &cr::EpisodeSettings::target_realtime_factor)
     .def("__eq__", &cr::EpisodeSettings::operator==)
     .def("__ne__", &cr::EpisodeSettings::operator!=)
     .def(self_ns::str(self_ns::self))
@@ -323,11 +648,40 @@ void export_world() {
       arg("attachment_type")=cr::AttachmentType::Rigid, \
       arg("bone")=std::string())
 
+  enum_<cr::ActorQueryField>("ActorQueryField")
+    .value("NONE", cr::ActorQueryField::None)
+    .value("TypeId", cr::ActorQueryField::TypeId)
+    .value("ParentId", cr::ActorQueryField::ParentId)
+    .value("SemanticTags", cr::ActorQueryField::SemanticTags)
+    .value("Attributes", cr::ActorQueryField::Attributes)
+    .value("BoundingBox", cr::ActorQueryField::BoundingBox)
+    .value("Transform", cr::ActorQueryField::Transform)
+    .value("Velocity", cr::ActorQueryField::Velocity)
+    .value("AngularVelocity", cr::ActorQueryField::AngularVelocity)
+    .value("All", cr::ActorQueryField::All)
+  ;
+
+  class_<cr::ActorQueryResult>("ActorQueryResult", no_init)
+    .def_readonly("fields", &cr::ActorQueryResult::fields)
+    .add_property("ids", &GetQueryColumn<carla::ActorId, &cr::ActorQueryResult::ids>)
+    .add_property("type_ids", &GetQueryColumn<std::string, &cr::ActorQueryResult::type_ids>)
+    .add_property("parent_ids", &GetQueryColumn<carla::ActorId, &cr::ActorQueryResult::parent_ids>)
+    .add_property("semantic_tags", &GetQuerySemanticTags)
+    .add_property("attributes", &GetQueryAttributes)
+    .add_property("bounding_boxes", &GetQueryColumn<cg::BoundingBox, &cr::ActorQueryResult::bounding_boxes>)
+    .add_property("transforms", &GetQueryColumn<cg::Transform, &cr::ActorQueryResult::transforms>)
+    .add_property("velocities", &GetQueryColumn<cg::Vector3D, &cr::ActorQueryResult::velocities>)
+    .add_property("angular_velocities", &GetQueryColumn<cg::Vector3D, &cr::ActorQueryResult::angular_velocities>)
+    .def("__len__", &cr::ActorQueryResult::size)
+  ;
+
   class_<cc::World>("World", no_init)
     .add_property("id", &cc::World::GetId)
     .add_property("debug", &cc::World::MakeDebugHelper)
     .def("load_map_layer", CONST_CALL_WITHOUT_GIL_1(cc::World, LoadLevelLayer, cr::MapLayer), arg("map_layers"))
     .def("unload_map_layer", CONST_CALL_WITHOUT_GIL_1(cc::World, UnloadLevelLayer, cr::MapLayer), arg("map_layers"))
+    .def("load_map_layer_async", &LoadLevelLayerAsync, (arg("map_layers"), arg("callback")=object()))
+    .def("unload_map_layer_async", &UnloadLevelLayerAsync, (arg("map_layers"), arg("callback")=object()))
     .def("get_blueprint_library", CONST_CALL_WITHOUT_GIL(cc::World, GetBlueprintLibrary))
     .def("get_vehicles_light_states", &GetVehiclesLightStates)
     .def("get_map", CONST_CALL_WITHOUT_GIL(cc::World, GetMap))
@@ -343,12 +697,38 @@ void export_world() {
     .def("get_actor", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActor, carla::ActorId), (arg("actor_id")))
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("get_actors", &GetActorsById, (arg("actor_ids")))
+    .def("filter_actors", CONST_CALL_WITHOUT_GIL_1(cc::World, FilterActors, std::string), (arg("wildcard_pattern")))
+    .def("configure_state_history", CALL_WITHOUT_GIL_2(cc::World, ConfigureStateHistory, double, size_t), (arg("max_duration"), arg("max_frames")=1000u))
+    .def("get_actor_trajectory", +[](const cc::World &self, carla::ActorId id, double begin, double end) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return ActorTrajectoryView{self.GetActorTrajectory(id, begin, end)};
+    }, (arg("actor_id"), arg("begin_time")=-std::numeric_limits<double>::infinity(), arg("end_time")=std::numeric_limits<double>::infinity()))
+    .def("get_actors_in_radius", CONST_CALL_WITHOUT_GIL_3(cc::World, GetActorsInRadius, cg::Location, float, std::string), (arg("location"), arg("radius"), arg("wildcard_pattern")="*"))
+    .def("query_actors", &QueryActors, (
+        arg("actor_ids")=list(),
+        arg("type_id")=std::string(),
+        arg("semantic_tags")=list(),
+        arg("center")=cg::Location(),
+        arg("radius")=0.0f,
+        arg("fields")=static_cast<cr::ActorQueryFieldType>(cr::ActorQueryField::All)))
     .def("spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(SpawnActor))
     .def("try_spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(TrySpawnActor))
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=0.0))
+    .def("get_frame_timings", CALL_RETURNING_LIST_1(cc::World, GetFrameTimings, uint64_t), (arg("count")=1u))
+    .def("get_sensor_tick_plan", CONST_CALL_WITHOUT_GIL_1(cc::World, GetSensorTickPlan, uint32_t), (arg("frames")=20u))
     .def("on_tick", &OnTick, (arg("callback")))
     .def("remove_on_tick", &cc::World::RemoveOnTick, (arg("callback_id")))
+    .def("on_actor_changes", &OnActorChanges, (arg("callback")))
+    .def("remove_on_actor_changes", &cc::World::RemoveOnActorChanges, (arg("callback_id")))
+    .def("set_actor_changes_move_threshold", &cc::World::SetActorChangesMoveThreshold, (arg("meters")))
+    .def("listen_to_sensors", &ListenToSensors, (arg("sensors"), arg("callback")))
+    .def("stop_listening_to_sensors", CALL_WITHOUT_GIL_1(cc::World, StopListeningToSensors, uint32_t), (arg("bundle_id")))
     .def("tick", &Tick, (arg("seconds")=0.0))
+    .def("tick_async", &TickAsync, (arg("seconds")=0.0))
+    .def("wait_for_tick_async", &WaitForTickAsync)
+    .def("register_tick_participant", &RegisterTickParticipant, (arg("name"), arg("deadline")=0.0))
+    .def("unregister_tick_participant", CALL_WITHOUT_GIL_1(cc::World, UnregisterTickParticipant, uint32_t), (arg("participant_id")))
+    .def("tick_ready", &NotifyTickReady, (arg("participant_id"), arg("frame")=object()))
     .def("set_pedestrians_cross_factor", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansCrossFactor, float), (arg("percentage")))
     .def("set_pedestrians_seed", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansSeed, unsigned int), (arg("seed")))
     .def("get_traffic_sign", CONST_CALL_WITHOUT_GIL_1(cc::World, GetTrafficSign, cc::Landmark), arg("landmark"))
@@ -357,10 +737,14 @@ void export_world() {
     .def("get_traffic_lights_from_waypoint", CALL_RETURNING_LIST_2(cc::World, GetTrafficLightsFromWaypoint, const cc::Waypoint&, double), (arg("waypoint"), arg("distance")))
     .def("get_traffic_lights_in_junction", CALL_RETURNING_LIST_1(cc::World, GetTrafficLightsInJunction, carla::road::JuncId), (arg("junction_id")))
     .def("reset_all_traffic_lights", &cc::World::ResetAllTrafficLights)
+    .def("save_state", CONST_CALL_WITHOUT_GIL(cc::World, SaveState))
+    .def("restore_state", CONST_CALL_WITHOUT_GIL_1(cc::World, RestoreState, uint64_t), (arg("state_id")))
+    .def("remove_state", CONST_CALL_WITHOUT_GIL_1(cc::World, RemoveState, uint64_t), (arg("state_id")))
     .def("get_lightmanager", CONST_CALL_WITHOUT_GIL(cc::World, GetLightManager))
     .def("freeze_all_traffic_lights", &cc::World::FreezeAllTrafficLights, (arg("frozen")))
     .def("get_level_bbs", &GetLevelBBs, (arg("bb_type")=cr::CityObjectLabel::Any))
     .def("get_environment_objects", &GetEnvironmentObjects, (arg("object_type")=cr::CityObjectLabel::Any))
+    .def("get_environment_objects_in_radius", &GetEnvironmentObjectsInRadius, (arg("location"), arg("radius"), arg("object_type")=cr::CityObjectLabel::Any))
     .def("enable_environment_objects", &EnableEnvironmentObjects, (arg("env_objects_ids"), arg("enable")))
     .def("cast_ray", CALL_RETURNING_LIST_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location")))
     .def("project_point", CALL_RETURNING_OPTIONAL_3(cc::World, ProjectPoint, cg::Location, cg::Vector3D, float), (arg("location"), arg("direction"), arg("search_distance")=10000.f))
@@ -447,6 +831,49 @@ void export_world() {
          arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
          arg("life_time")=-1.0f,
          arg("persistent_lines")=true))
+    .def("draw_shapes", CALL_WITHOUT_GIL_1(cc::DebugHelper, DrawShapes, const cc::DebugHelper::ShapeBatch &), arg("batch"))
+    .def("draw_shape_group", CALL_WITHOUT_GIL_2(cc::DebugHelper, DrawShapeGroup, const cc::DebugHelper::ShapeBatch &, cc::DebugHelper::ShapeGroupId), (arg("batch"), arg("group")=0u))
+    .def("clear_shape_group", CALL_WITHOUT_GIL_1(cc::DebugHelper, ClearShapeGroup, cc::DebugHelper::ShapeGroupId), arg("group"))
+  ;
+
+  class_<cc::DebugHelper::ShapeBatch>("DebugShapeBatch")
+    .def("add_point", &cc::DebugHelper::ShapeBatch::AddPoint,
+        (arg("location"),
+         arg("size")=0.1f,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
+         arg("life_time")=-1.0f,
+         arg("persistent_lines")=true))
+    .def("add_line", &cc::DebugHelper::ShapeBatch::AddLine,
+        (arg("begin"),
+         arg("end"),
+         arg("thickness")=0.1f,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
+         arg("life_time")=-1.0f,
+         arg("persistent_lines")=true))
+    .def("add_arrow", &cc::DebugHelper::ShapeBatch::AddArrow,
+        (arg("begin"),
+         arg("end"),
+         arg("thickness")=0.1f,
+         arg("arrow_size")=0.1f,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
+         arg("life_time")=-1.0f,
+         arg("persistent_lines")=true))
+    .def("add_box", &cc::DebugHelper::ShapeBatch::AddBox,
+        (arg("box"),
+         arg("rotation"),
+         arg("thickness")=0.1f,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
+         arg("life_time")=-1.0f,
+         arg("persistent_lines")=true))
+    .def("add_string", &cc::DebugHelper::ShapeBatch::AddString,
+        (arg("location"),
+         arg("text"),
+         arg("draw_shadow")=false,
+         arg("color")=cc::DebugHelper::Color(255u, 0u, 0u),
+         arg("life_time")=-1.0f,
+         arg("persistent_lines")=true))
+    .def("clear", &cc::DebugHelper::ShapeBatch::clear)
+    .def("__len__", &cc::DebugHelper::ShapeBatch::size)
   ;
   // scope HUD = class_<cc::DebugHelper>(
 
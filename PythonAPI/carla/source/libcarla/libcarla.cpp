@@ -134,6 +134,31 @@ std::vector<T> PythonLitstToVector(boost::python::list &input) {
       return result; \
     }
 
+// 与 CALL_RETURNING_LIST 相同，但在释放 GIL 时调用 @a fn，只在构造 Python 列表时持有 GIL。
+#define CALL_RETURNING_LIST_WITHOUT_GIL(cls, fn) +[](const cls &self) { \
+      auto items = [&]() { \
+        carla::PythonUtil::ReleaseGIL unlock; \
+        return self.fn(); \
+      }(); \
+      boost::python::list result; \
+      for (auto &&item : items) { \
+        result.append(item); \
+      } \
+      return result; \
+    }
+
+#define CALL_RETURNING_LIST_WITHOUT_GIL_1(cls, fn, T1_) +[](const cls &self, T1_ t1) { \
+      auto items = [&]() { \
+        carla::PythonUtil::ReleaseGIL unlock; \
+        return self.fn(std::forward<T1_>(t1)); \
+      }(); \
+      boost::python::list result; \
+      for (auto &&item : items) { \
+        result.append(item); \
+      } \
+      return result; \
+    }
+
 #define CALL_RETURNING_OPTIONAL(cls, fn) +[](const cls &self) { \
       auto optional = self.fn(); \
       return OptionalToPythonObject(optional); \
@@ -235,6 +260,7 @@ static auto MakeCallback(boost::python::object callback) {
 // 17个模块的源代码文件+1个RSS模块
 #include "V2XData.cpp"
 #include "Geom.cpp"
+#include "AsyncIO.cpp"
 #include "Actor.cpp"
 #include "Blueprint.cpp"
 #include "Client.cpp"
@@ -250,6 +276,7 @@ static auto MakeCallback(boost::python::object callback) {
 #include "TrafficManager.cpp"
 #include "LightManager.cpp"
 #include "OSM2ODR.cpp"
+#include "Recorder.cpp"
 
 #ifdef LIBCARLA_RSS_ENABLED
 #include "AdRss.cpp"
@@ -260,6 +287,8 @@ BOOST_PYTHON_MODULE(libcarla) {
 #if PY_MAJOR_VERSION < 3 || PY_MINOR_VERSION < 7
   PyEval_InitThreads();
 #endif
+  // 模块没有声明不使用 GIL：boost::python 的转换器注册表和引用计数并非线程安全，
+  // 自由线程的 CPython（3.13+）导入时会重新启用 GIL。
   scope().attr("__path__") = "libcarla";
   export_geom();
   export_control();
@@ -280,4 +309,5 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_ad_rss();
   #endif
   export_osm2odr();
+  export_recorder();
 }
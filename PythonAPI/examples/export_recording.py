@@ -0,0 +1,226 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+Export the sensor data of a recording, replaying it in shards.
+
+The recording is split by time in as many shards as servers are given, and
+each server replays its shard frame by frame (one recorded frame per tick, in
+synchronous mode) while the sensors attached to the replayed hero capture the
+data. Every file is named after the recorded frame it shows, so the output of
+all the shards merges in the same folders, and the result does not depend on
+the number of shards.
+
+The recording has to be accessible by every server (same name as used with
+start_replaying.py).
+
+    python export_recording.py -f recording.log -p 2000 2002 2004 -o _out
+"""
+
+import glob
+import os
+import sys
+
+try:
+    sys.path.append(glob.glob('../carla/dist/carla-*%d.%d-%s.egg' % (
+        sys.version_info.major,
+        sys.version_info.minor,
+        'win-amd64' if os.name == 'nt' else 'linux-x86_64'))[0])
+except IndexError:
+    pass
+
+import carla
+
+import argparse
+import multiprocessing
+import re
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+
+def get_recording_info(client, filename):
+    """Return the map, the number of frames and the duration of a recording."""
+    info = client.show_recorder_file_info(filename, False)
+    map_name = re.search(r'^Map: (.*)$', info, re.MULTILINE)
+    frames = re.search(r'^Frames: (\d+)$', info, re.MULTILINE)
+    duration = re.search(r'^Duration: ([\d.eE+-]+) seconds$', info, re.MULTILINE)
+    if not (map_name and frames and duration):
+        raise RuntimeError(info)
+    return map_name.group(1).strip(), int(frames.group(1)), float(duration.group(1))
+
+
+def make_shards(duration, frames, count):
+    """Split the recording in 'count' time ranges.
+
+    Each range starts a few frames earlier than its share: the first frames
+    are replayed before the sensors exist, and the frames do not need to last
+    the same. The repeated frames are dropped when saving.
+    """
+    overlap = 3.0 * duration / max(frames, 1)
+    size = duration / count
+    shards = []
+    for i in range(count):
+        start = max(0.0, i * size - overlap)
+        # the last shard replays until the end of the file
+        length = size + (i * size - start) if i < count - 1 else 0.0
+        shards.append((start, length))
+    return shards
+
+
+def find_actor(world, role_name):
+    for actor in world.get_actors().filter('*'):
+        if actor.attributes.get('role_name') == role_name:
+            return actor
+    return None
+
+
+def export_shard(args, index, port, time_start, duration):
+    client = carla.Client(args.host, port)
+    client.set_timeout(60.0)
+
+    world = client.load_world(args.map_name)
+    original_settings = world.get_settings()
+    settings = world.get_settings()
+    settings.synchronous_mode = True
+    settings.fixed_delta_seconds = args.delta
+    world.apply_settings(settings)
+
+    sensors = []
+    try:
+        client.set_replayer_frame_step(True)
+        client.set_replayer_skip_physics(True)
+        client.set_replayer_ignore_spectator(True)
+        print('[shard %d] %s' % (index, client.replay_file(
+            args.recorder_filename, time_start, duration, 0, False).splitlines()[-1]))
+        world.tick()
+
+        parent = find_actor(world, args.role_name)
+        if parent is None:
+            print('[shard %d] no actor with role name "%s"' % (index, args.role_name))
+            return
+
+        library = world.get_blueprint_library()
+        transform = carla.Transform(carla.Location(x=-5.5, z=2.8), carla.Rotation(pitch=-15))
+        data = queue.Queue()
+        for sensor_type in args.sensors:
+            blueprint = library.find(sensor_type)
+            if blueprint.has_attribute('image_size_x'):
+                blueprint.set_attribute('image_size_x', str(args.width))
+                blueprint.set_attribute('image_size_y', str(args.height))
+            sensor = world.spawn_actor(blueprint, transform, attach_to=parent)
+            name = sensor_type.split('.')[-1]
+            sensor.listen(lambda measurement, name=name: data.put((name, measurement)))
+            sensors.append(sensor)
+
+        # simulation frame -> recorded frame, both known right after the tick
+        recorded = {}
+        last = None
+        while True:
+            frame = world.tick()
+            current = client.get_replayer_frame()
+            if current == last:
+                # the replayer stopped, nothing new to capture
+                break
+            recorded[frame] = last = current
+            for _ in sensors:
+                name, measurement = data.get(timeout=10.0)
+                save(args, name, recorded[measurement.frame], measurement)
+        print('[shard %d] done at recorded frame %d' % (index, last))
+
+    finally:
+        client.stop_replayer(False)
+        for sensor in sensors:
+            sensor.destroy()
+        world.apply_settings(original_settings)
+
+
+def save(args, name, recorded_frame, measurement):
+    extension = 'ply' if isinstance(measurement, carla.LidarMeasurement) else 'png'
+    path = os.path.join(args.output, name, '%08d.%s' % (recorded_frame, extension))
+    if not os.path.exists(path):
+        measurement.save_to_disk(path)
+
+
+def main():
+
+    argparser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    argparser.add_argument(
+        '--host',
+        metavar='H',
+        default='127.0.0.1',
+        help='IP of the host servers (default: 127.0.0.1)')
+    argparser.add_argument(
+        '-p', '--ports',
+        metavar='P',
+        nargs='+',
+        default=[2000],
+        type=int,
+        help='TCP port of each server, one shard per server (default: 2000)')
+    argparser.add_argument(
+        '-f', '--recorder-filename',
+        metavar='F',
+        default="test1.log",
+        help='recorder filename (test1.log)')
+    argparser.add_argument(
+        '-o', '--output',
+        metavar='O',
+        default='_out',
+        help='output folder (default: _out)')
+    argparser.add_argument(
+        '--sensors',
+        metavar='S',
+        nargs='+',
+        default=['sensor.camera.rgb'],
+        help='sensors attached to the actor (default: sensor.camera.rgb)')
+    argparser.add_argument(
+        '--role-name',
+        metavar='NAME',
+        default='hero',
+        help='role name of the actor to attach the sensors to (default: hero)')
+    argparser.add_argument(
+        '--res',
+        metavar='WIDTHxHEIGHT',
+        default='1280x720',
+        help='camera resolution (default: 1280x720)')
+    args = argparser.parse_args()
+
+    args.width, args.height = [int(x) for x in args.res.split('x')]
+
+    client = carla.Client(args.host, args.ports[0])
+    client.set_timeout(60.0)
+    map_name, frames, duration = get_recording_info(client, args.recorder_filename)
+    args.map_name = os.path.basename(map_name)
+    # only used by the sensors, the replayer moves one recorded frame per tick
+    args.delta = duration / max(frames, 1)
+    print('%s: %d frames, %.2f seconds in %s' % (args.recorder_filename, frames, duration, args.map_name))
+
+    shards = make_shards(duration, frames, len(args.ports))
+    processes = []
+    for index, (port, (time_start, length)) in enumerate(zip(args.ports, shards)):
+        process = multiprocessing.Process(
+            target=export_shard,
+            args=(args, index, port, time_start, length))
+        process.start()
+        processes.append(process)
+    for process in processes:
+        process.join()
+
+
+if __name__ == '__main__':
+
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print('\ndone.')
@@ -67,6 +67,10 @@ def main():
         default=0,
         type=int,
         help='recorder duration (auto-stop)')
+    argparser.add_argument(
+        '--compressed',
+        action='store_true',
+        help='write the recording in compressed blocks')
     args = argparser.parse_args()
 
     actor_list = []
@@ -86,7 +90,7 @@ def main():
 
         count = args.number_of_vehicles
 
-        print("Recording on file: %s" % client.start_recorder(args.recorder_filename))
+        print("Recording on file: %s" % client.start_recorder(args.recorder_filename, compressed=args.compressed))
 
         if args.safe:
             blueprints = [x for x in blueprints if int(x.get_attribute('number_of_wheels')) == 4]
@@ -79,6 +79,10 @@ def main():
         '--spawn-sensors',
         action='store_true',
         help='spawn sensors in the replayed world')
+    argparser.add_argument(
+        '--skip-physics',
+        action='store_true',
+        help='teleport the actors without physics (faster, only for viewing)')
     args = argparser.parse_args()
 
     try:
@@ -95,6 +99,9 @@ def main():
         # set to ignore the spectator camera or not
         client.set_replayer_ignore_spectator(not args.move_spectator)
 
+        # set to skip the physics of the replayed actors or not
+        client.set_replayer_skip_physics(args.skip_physics)
+
         # replay the session
         print(client.replay_file(args.recorder_filename, args.start, args.duration, args.camera, args.spawn_sensors))
 
@@ -193,6 +193,33 @@ class TestSyncLidar(SyncSmokeTest):
             if not sensor.is_correct():
                 self.fail(sensor.error)
 
+    def test_depth_buffer_backend_point_count(self):
+        """
+               测试使用深度缓冲后端的LiDAR和语义LiDAR传感器点数量的方法，流程与上面的测试相同。
+               """
+        print("TestSyncLidar.test_depth_buffer_backend_point_count")
+        sensors = []
+
+        att_l00 = {'channels' : '64', 'dropoff_intensity_limit': '0.0', 'dropoff_general_rate': '0.0',
+          'range' : '50', 'points_per_second': '100000', 'rotation_frequency': '20',
+          'backend': 'depth_buffer'}
+        att_s00 = {'channels' : '64', 'range' : '100', 'points_per_second': '100000',
+          'rotation_frequency': '20', 'upper_fov': '50', 'backend': 'depth_buffer'}
+
+        sensors.append(Sensor(self, SensorType.LIDAR, att_l00))
+        sensors.append(Sensor(self, SensorType.SEMLIDAR, att_s00))
+
+        for _ in range(0, 10):
+            self.world.tick()
+        time.sleep(0.5)
+
+        for sensor in sensors:
+            sensor.destroy()
+
+        for sensor in sensors:
+            if not sensor.is_correct():
+                self.fail(sensor.error)
+
 
 class TestASyncLidar(SmokeTest):
     """
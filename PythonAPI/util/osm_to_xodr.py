@@ -2,8 +2,11 @@
 
 import argparse
 import glob
+import multiprocessing
 import os
+import shutil
 import sys
+import tempfile
 
 try:
     sys.path.append(glob.glob('../carla/dist/carla-*%d.%d-%s.egg' % (
@@ -16,11 +19,7 @@ except IndexError:
 import carla
 
 
-def convert(args):
-    # Read the .osm data
-    with open(args.input_path, mode="r", encoding="utf-8") as osmFile:
-        osm_data = osmFile.read()
-
+def make_settings(args, center_map):
     # Define the desired settings
     settings = carla.Osm2OdrSettings()
 
@@ -42,10 +41,42 @@ def convert(args):
     settings.default_lane_width = args.lane_width
     settings.generate_traffic_lights = args.traffic_lights
     settings.all_junctions_with_traffic_lights = args.all_junctions_lights
-    settings.center_map = args.center_map
+    settings.center_map = center_map
+    return settings
+
+
+def convert_tile(task):
+    tile_path, args = task
+    with open(tile_path, mode="r", encoding="utf-8") as osmFile:
+        osm_data = osmFile.read()
+    # All tiles must share the same projection, the map is centered after stitching
+    return carla.Osm2Odr.convert(osm_data, make_settings(args, center_map=False))
+
 
-    # Convert to .xodr
-    xodr_data = carla.Osm2Odr.convert(osm_data, settings)
+def convert_tiled(args):
+    # The converter keeps global state, so every tile is converted in its own process
+    tiles_folder = tempfile.mkdtemp(prefix="osm_tiles_")
+    try:
+        tiles = carla.Osm2Odr.split_tiles(args.input_path, tiles_folder, args.tile_size)
+        print('Converting %d tiles.' % len(tiles))
+        context = multiprocessing.get_context("spawn")
+        with context.Pool(args.jobs if args.jobs > 0 else None) as pool:
+            xodr_tiles = pool.map(convert_tile, [(tile, args) for tile in tiles])
+        return carla.Osm2Odr.stitch_tiles(xodr_tiles, center_map=args.center_map)
+    finally:
+        shutil.rmtree(tiles_folder, ignore_errors=True)
+
+
+def convert(args):
+    if args.tile_size > 0.0:
+        xodr_data = convert_tiled(args)
+    else:
+        # Read the .osm data
+        with open(args.input_path, mode="r", encoding="utf-8") as osmFile:
+            osm_data = osmFile.read()
+
+        # Convert to .xodr
+        xodr_data = carla.Osm2Odr.convert(osm_data, make_settings(args, args.center_map))
 
     # save opendrive file
     with open(args.output_path, "w", encoding="utf-8") as xodrFile:
@@ -85,6 +116,16 @@ def main():
         '--center-map',
         action='store_true',
         help='set center of map to the origin coordinates')
+    argparser.add_argument(
+        '--tile-size',
+        default=0.0,
+        type=float,
+        help='convert in parallel tiles of this size in meters (default: 0.0, no tiling)')
+    argparser.add_argument(
+        '-j', '--jobs',
+        default=0,
+        type=int,
+        help='number of processes for tiled conversion (default: number of CPUs)')
 
     if len(sys.argv) < 2:
         argparser.print_help()
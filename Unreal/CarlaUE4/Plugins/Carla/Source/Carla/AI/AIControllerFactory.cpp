@@ -30,6 +30,13 @@ TArray<FActorDefinition> AAIControllerFactory::GetDefinitions()
       TEXT("walker")); 
   // 设置 WalkerController 的 Class 成员，指向 AWalkerAIController 类的类对象。
   WalkerController.Class = AWalkerAIController::StaticClass();
+  // 为 true 时行人由服务器端的导航更新，不需要客户端每帧发送命令
+  FActorVariation ServerNavigation;
+  ServerNavigation.Id = TEXT("server_navigation");
+  ServerNavigation.Type = EActorAttributeType::Bool;
+  ServerNavigation.RecommendedValues = { TEXT("false") };
+  ServerNavigation.bRestrictToRecommended = false;
+  WalkerController.Variations.Emplace(ServerNavigation);
   // 返回包含 WalkerController 的数组。
   return { WalkerController }; 
 }
@@ -89,7 +89,8 @@ private:
 
 #if WITH_EDITOR
      // 如果在编辑器模式下，且GEngine对象存在
-      if (GEngine)
+      // 定义可以在其他线程中并行验证，只在游戏线程中显示
+      if (GEngine && IsInGameThread())
       {
         // 在屏幕上显示一条调试消息，消息颜色为红色
         GEngine->AddOnScreenDebugMessage(42, 15.0f, FColor::Red, Message);
@@ -372,6 +373,22 @@ static void AddVariationsForSensor(FActorDefinition& Def)
 
     // 将变化对象添加到参与者定义的变化列表中
     Def.Variations.Emplace(Tick);
+
+    // 传感器数据流的压缩方式
+    FActorVariation Compression;
+    Compression.Id = TEXT("compression");
+    Compression.Type = EActorAttributeType::String;
+    Compression.RecommendedValues = { TEXT("none"), TEXT("deflate"), TEXT("video") };
+    Compression.bRestrictToRecommended = true;
+    Def.Variations.Emplace(Compression);
+
+    // "video" 压缩方式每隔多少帧发送一个关键帧，0 表示只在需要时发送
+    FActorVariation KeyframeInterval;
+    KeyframeInterval.Id = TEXT("keyframe_interval");
+    KeyframeInterval.Type = EActorAttributeType::Int;
+    KeyframeInterval.RecommendedValues = { TEXT("30") };
+    KeyframeInterval.bRestrictToRecommended = false;
+    Def.Variations.Emplace(KeyframeInterval);
 }
 
 // 定义一个函数，用于为触发器添加变化属性
@@ -655,6 +672,78 @@ void UActorBlueprintFunctionLibrary::MakeCameraDefinition(
     // 设置是否将LensYSize的值限制在推荐值之内，这里也设置为false
     LensYSize.bRestrictToRecommended = false;
 
+    // 同步模式下是否不等待 GPU 回读，图像在之后的帧中发送（异步模式下总是如此）
+    FActorVariation PipelinedReadback;
+    PipelinedReadback.Id = TEXT("pipelined_readback");
+    PipelinedReadback.Type = EActorAttributeType::Bool;
+    PipelinedReadback.RecommendedValues = { TEXT("false") };
+    PipelinedReadback.bRestrictToRecommended = false;
+
+    // 同一父参与者上 rig 名称相同的相机在一次场景渲染中一起绘制，为空时单独渲染
+    FActorVariation Rig;
+    Rig.Id = TEXT("rig");
+    Rig.Type = EActorAttributeType::String;
+    Rig.RecommendedValues = { TEXT("") };
+    Rig.bRestrictToRecommended = false;
+
+    // 回读之前在 GPU 上转换图像：输出格式、感兴趣区域（宽高为 0 时延伸到图像边缘）
+    // 和整数倍缩小
+    FActorVariation OutputFormat;
+    OutputFormat.Id = TEXT("output_format");
+    OutputFormat.Type = EActorAttributeType::String;
+    OutputFormat.RecommendedValues = { TEXT("bgra8"), TEXT("depth16f"), TEXT("depth32f"), TEXT("label8") };
+    OutputFormat.bRestrictToRecommended = true;
+
+    FActorVariation RoiX;
+    RoiX.Id = TEXT("roi_x");
+    RoiX.Type = EActorAttributeType::Int;
+    RoiX.RecommendedValues = { TEXT("0") };
+    RoiX.bRestrictToRecommended = false;
+
+    FActorVariation RoiY;
+    RoiY.Id = TEXT("roi_y");
+    RoiY.Type = EActorAttributeType::Int;
+    RoiY.RecommendedValues = { TEXT("0") };
+    RoiY.bRestrictToRecommended = false;
+
+    FActorVariation RoiWidth;
+    RoiWidth.Id = TEXT("roi_width");
+    RoiWidth.Type = EActorAttributeType::Int;
+    RoiWidth.RecommendedValues = { TEXT("0") };
+    RoiWidth.bRestrictToRecommended = false;
+
+    FActorVariation RoiHeight;
+    RoiHeight.Id = TEXT("roi_height");
+    RoiHeight.Type = EActorAttributeType::Int;
+    RoiHeight.RecommendedValues = { TEXT("0") };
+    RoiHeight.bRestrictToRecommended = false;
+
+    FActorVariation Downscale;
+    Downscale.Id = TEXT("downscale");
+    Downscale.Type = EActorAttributeType::Int;
+    Downscale.RecommendedValues = { TEXT("1") };
+    Downscale.bRestrictToRecommended = false;
+
+    // 每个相机自己的渲染质量，与观察者的画质等级无关：渲染配置、最远可见距离（米，
+    // 0 表示不限制）和 LOD 距离缩放（大于 1 时使用更低的 LOD）
+    FActorVariation RenderQuality;
+    RenderQuality.Id = TEXT("render_quality");
+    RenderQuality.Type = EActorAttributeType::String;
+    RenderQuality.RecommendedValues = { TEXT("epic"), TEXT("medium"), TEXT("low") };
+    RenderQuality.bRestrictToRecommended = true;
+
+    FActorVariation MaxViewDistance;
+    MaxViewDistance.Id = TEXT("max_view_distance");
+    MaxViewDistance.Type = EActorAttributeType::Float;
+    MaxViewDistance.RecommendedValues = { TEXT("0.0") };
+    MaxViewDistance.bRestrictToRecommended = false;
+
+    FActorVariation LODDistanceFactor;
+    LODDistanceFactor.Id = TEXT("lod_distance_factor");
+    LODDistanceFactor.Type = EActorAttributeType::Float;
+    LODDistanceFactor.RecommendedValues = { TEXT("1.0") };
+    LODDistanceFactor.bRestrictToRecommended = false;
+
 
  // 将一系列变量（如分辨率、视野等）添加到定义的变化列表中
 Definition.Variations.Append({
@@ -666,7 +755,18 @@ Definition.Variations.Append({
     LensK,          // 镜头K值（一种镜头畸变参数）
     LensKcube,      // 镜头K立方值（另一种镜头畸变参数）
     LensXSize,      // 镜头X轴尺寸
-    LensYSize});    // 镜头Y轴尺寸
+    LensYSize,      // 镜头Y轴尺寸
+    PipelinedReadback, // 流水线式回读
+    Rig,            // 多视图合并渲染
+    OutputFormat,   // GPU 上转换的输出格式
+    RoiX,           // 感兴趣区域
+    RoiY,
+    RoiWidth,
+    RoiHeight,
+    Downscale,      // 缩小倍数
+    RenderQuality,  // 渲染质量
+    MaxViewDistance,
+    LODDistanceFactor});
  
 // 如果启用了修改后处理效果的功能
 if (bEnableModifyingPostProcessEffects)
@@ -1245,6 +1345,14 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
   BiasGyroZ.RecommendedValues = { TEXT("0.0") }; // 设置该变量的推荐值为0.0
   BiasGyroZ.bRestrictToRecommended = false; // 设置该变量不强制限制为推荐值
 
+  // - 每次节拍的采样数 --------------------------
+  // 大于 1 时在两次节拍之间插值出多个采样并在同一条消息中发送
+  FActorVariation SamplesPerTick;
+  SamplesPerTick.Id = TEXT("samples_per_tick");
+  SamplesPerTick.Type = EActorAttributeType::Int;
+  SamplesPerTick.RecommendedValues = { TEXT("1") };
+  SamplesPerTick.bRestrictToRecommended = false;
+
   // 将一系列变量添加到Definition的Variations列表中，这些变量通常用于定义某个物体的噪声和偏差特性
   Definition.Variations.Append({
       // 噪声种子，用于生成随机数序列，以模拟噪声的随机性
@@ -1275,7 +1383,10 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
       BiasGyroY, 
 
       // 陀螺仪Z轴的偏差，表示Z轴角速度测量值的固定偏移量
-      BiasGyroZ          
+      BiasGyroZ,
+
+      // 每次节拍的采样数
+      SamplesPerTick
       });
 
   // 调用CheckActorDefinition函数来检查Definition对象的有效性或配置是否正确
@@ -1376,6 +1487,13 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
       // 设置PointsPerSecond是否限制为仅使用推荐值，这里设置为false，表示不限制
       PointsPerSecond.bRestrictToRecommended = false;
 
+      // 每帧最多追踪的射线数，0表示不限制；超出的射线分摊到后续帧
+      FActorVariation MaxRaysPerTick;
+      MaxRaysPerTick.Id = TEXT("max_rays_per_tick");
+      MaxRaysPerTick.Type = EActorAttributeType::Int;
+      MaxRaysPerTick.RecommendedValues = { TEXT("0") };
+      MaxRaysPerTick.bRestrictToRecommended = false;
+
       // 噪声种子设置
       // 定义一个变量NoiseSeed，类型为FActorVariation，用于存储噪声种子的配置
       FActorVariation NoiseSeed; 
@@ -1398,6 +1516,7 @@ void UActorBlueprintFunctionLibrary::MakeIMUDefinition(
           VerticalFOV, //垂直视场角
           Range, //范围
           PointsPerSecond, //每秒点数
+          MaxRaysPerTick, //每帧射线预算
           NoiseSeed }); //噪声种子
 
       // 调用CheckActorDefinition函数检查Definition的有效性，并将结果存储在Success变量中
@@ -1524,6 +1643,26 @@ void UActorBlueprintFunctionLibrary::MakeLidarDefinition(
     StdDevLidar.Type = EActorAttributeType::Float; // 设置该因子的类型为浮点数
     StdDevLidar.RecommendedValues = { TEXT("0.0") }; // 设置该因子的推荐值为0.0
 
+    // 计算命中点的方式：CPU 射线检测或 GPU 深度缓冲重投影
+    FActorVariation Backend;
+    Backend.Id = TEXT("backend");
+    Backend.Type = EActorAttributeType::String;
+    Backend.RecommendedValues = { TEXT("ray_cast"), TEXT("depth_buffer") };
+    Backend.bRestrictToRecommended = true;
+
+    // 点的排列方式："aos" 为 {X, Y, Z, I} 数组，"soa" 为按列存放并带语义标签
+    FActorVariation PointLayout;
+    PointLayout.Id = TEXT("point_layout");
+    PointLayout.Type = EActorAttributeType::String;
+    PointLayout.RecommendedValues = { TEXT("aos"), TEXT("soa") };
+    PointLayout.bRestrictToRecommended = true;
+
+    // 在服务器端进行体素降采样的体素边长（米），0 表示不降采样
+    FActorVariation VoxelSize;
+    VoxelSize.Id = TEXT("voxel_size");
+    VoxelSize.Type = EActorAttributeType::Float;
+    VoxelSize.RecommendedValues = { TEXT("0.0") };
+
   if (Id == "ray_cast") {
     Definition.Variations.Append({
       Channels,
@@ -1538,7 +1677,10 @@ void UActorBlueprintFunctionLibrary::MakeLidarDefinition(
       DropOffIntensityLimit,
       DropOffAtZeroIntensity,
       StdDevLidar,
-      HorizontalFOV});
+      HorizontalFOV,
+      Backend,
+      PointLayout,
+      VoxelSize});
   }
   else if (Id == "ray_cast_semantic") {
     Definition.Variations.Append({
@@ -1548,7 +1690,8 @@ void UActorBlueprintFunctionLibrary::MakeLidarDefinition(
       Frequency,
       UpperFOV,
       LowerFOV,
-      HorizontalFOV});
+      HorizontalFOV,
+      Backend});
   }
   else {
     DEBUG_ASSERT(false);
@@ -1961,6 +2104,13 @@ void UActorBlueprintFunctionLibrary::MakeGnssDefinition(
   BiasAlt.RecommendedValues = { TEXT("0.0") };
   BiasAlt.bRestrictToRecommended = false;
 
+  // - Samples per tick --------------------------
+  FActorVariation SamplesPerTick;
+  SamplesPerTick.Id = TEXT("samples_per_tick");
+  SamplesPerTick.Type = EActorAttributeType::Int;
+  SamplesPerTick.RecommendedValues = { TEXT("1") };
+  SamplesPerTick.bRestrictToRecommended = false;
+
   Definition.Variations.Append({
     NoiseSeed,
     StdDevLat,
@@ -1968,7 +2118,8 @@ void UActorBlueprintFunctionLibrary::MakeGnssDefinition(
     StdDevLong,
     BiasLong,
     StdDevAlt,
-    BiasAlt});
+    BiasAlt,
+    SamplesPerTick});
 
   Success = CheckActorDefinition(Definition);
 }
@@ -2281,6 +2432,58 @@ void UActorBlueprintFunctionLibrary::MakeObstacleDetectorDefinitions(
   });
 
 }
+
+FActorDefinition UActorBlueprintFunctionLibrary::MakeWalkerPoseSensorDefinition()
+{
+  FActorDefinition Definition = MakeGenericSensorDefinition(TEXT("other"), TEXT("walker_pose"));
+  AddVariationsForSensor(Definition);
+  // Only walkers closer than this distance to the sensor, 0 means all walkers.
+  FActorVariation MaxDistance;
+  MaxDistance.Id = TEXT("max_distance");
+  MaxDistance.Type = EActorAttributeType::Float;
+  MaxDistance.RecommendedValues = { TEXT("0.0") };
+  MaxDistance.bRestrictToRecommended = false;
+  // Only walkers with this role name, empty means all walkers.
+  FActorVariation WalkerRoleName;
+  WalkerRoleName.Id = TEXT("walker_role_name");
+  WalkerRoleName.Type = EActorAttributeType::String;
+  WalkerRoleName.RecommendedValues = { TEXT("") };
+  WalkerRoleName.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({
+    MaxDistance,
+    WalkerRoleName
+  });
+
+  return Definition;
+}
+
+FActorDefinition UActorBlueprintFunctionLibrary::MakeVehicleTelemetrySensorDefinition()
+{
+  FActorDefinition Definition = MakeGenericSensorDefinition(TEXT("other"), TEXT("vehicle_telemetry"));
+  AddVariationsForSensor(Definition);
+  // The following attributes are ignored when the sensor is attached to a
+  // vehicle, it only reports that vehicle then.
+  // Only vehicles closer than this distance to the sensor, 0 means all vehicles.
+  FActorVariation MaxDistance;
+  MaxDistance.Id = TEXT("max_distance");
+  MaxDistance.Type = EActorAttributeType::Float;
+  MaxDistance.RecommendedValues = { TEXT("0.0") };
+  MaxDistance.bRestrictToRecommended = false;
+  // Only vehicles with this role name, empty means all vehicles.
+  FActorVariation VehicleRoleName;
+  VehicleRoleName.Id = TEXT("vehicle_role_name");
+  VehicleRoleName.Type = EActorAttributeType::String;
+  VehicleRoleName.RecommendedValues = { TEXT("") };
+  VehicleRoleName.bRestrictToRecommended = false;
+
+  Definition.Variations.Append({
+    MaxDistance,
+    VehicleRoleName
+  });
+
+  return Definition;
+}
 /// ============================================================================
 /// -- Helpers to retrieve attribute values ------------------------------------
 /// ============================================================================
@@ -2453,6 +2656,44 @@ void UActorBlueprintFunctionLibrary::SetCamera(
       RetrieveActorAttributeToInt("image_size_y", Description.Variations, 600));
   Camera->SetFOVAngle(
       RetrieveActorAttributeToFloat("fov", Description.Variations, 90.0f));
+  Camera->SetPipelinedReadback(
+      RetrieveActorAttributeToBool("pipelined_readback", Description.Variations, false));
+  Camera->SetRig(
+      RetrieveActorAttributeToString("rig", Description.Variations, ""));
+
+  carla::sensor::s11n::ImageConversion OutputConversion;
+  const FString OutputFormat =
+      RetrieveActorAttributeToString("output_format", Description.Variations, "bgra8");
+  if (!carla::sensor::s11n::ImageConversion::FromString(TCHAR_TO_UTF8(*OutputFormat), OutputConversion.format))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Unknown camera output format '%s', sending the images as they are rendered"), *OutputFormat);
+  }
+  OutputConversion.roi.x = FMath::Max(RetrieveActorAttributeToInt("roi_x", Description.Variations, 0), 0);
+  OutputConversion.roi.y = FMath::Max(RetrieveActorAttributeToInt("roi_y", Description.Variations, 0), 0);
+  OutputConversion.roi.width = FMath::Max(RetrieveActorAttributeToInt("roi_width", Description.Variations, 0), 0);
+  OutputConversion.roi.height = FMath::Max(RetrieveActorAttributeToInt("roi_height", Description.Variations, 0), 0);
+  OutputConversion.downscale = FMath::Max(RetrieveActorAttributeToInt("downscale", Description.Variations, 1), 1);
+  Camera->SetOutputConversion(OutputConversion);
+
+  const FString RenderQuality =
+      RetrieveActorAttributeToString("render_quality", Description.Variations, "epic");
+  if (RenderQuality == "low")
+  {
+    Camera->SetRenderQuality(ECameraRenderQuality::Low);
+  }
+  else if (RenderQuality == "medium")
+  {
+    Camera->SetRenderQuality(ECameraRenderQuality::Medium);
+  }
+  else
+  {
+    Camera->SetRenderQuality(ECameraRenderQuality::Epic);
+  }
+  constexpr float TO_CENTIMETERS = 1e2;
+  Camera->SetMaxViewDistance(
+      RetrieveActorAttributeToFloat("max_view_distance", Description.Variations, 0.0f) * TO_CENTIMETERS);
+  Camera->SetLODDistanceFactor(
+      RetrieveActorAttributeToFloat("lod_distance_factor", Description.Variations, 1.0f));
   if (Description.Variations.Contains("enable_postprocess_effects"))
   {
     Camera->EnablePostProcessingEffects(
@@ -2584,6 +2825,18 @@ void UActorBlueprintFunctionLibrary::SetLidar(
       RetrieveActorAttributeToFloat("dropoff_zero_intensity", Description.Variations, Lidar.DropOffAtZeroIntensity);
   Lidar.NoiseStdDev =
       RetrieveActorAttributeToFloat("noise_stddev", Description.Variations, Lidar.NoiseStdDev);
+  if (RetrieveActorAttributeToString("backend", Description.Variations, "ray_cast") == "depth_buffer")
+  {
+    Lidar.Backend = ELidarBackend::DepthBuffer;
+  }
+  else
+  {
+    Lidar.Backend = ELidarBackend::RayCast;
+  }
+  Lidar.bColumnLayout =
+      RetrieveActorAttributeToString("point_layout", Description.Variations, "aos") == "soa";
+  Lidar.VoxelSize =
+      FMath::Max(RetrieveActorAttributeToFloat("voxel_size", Description.Variations, Lidar.VoxelSize), 0.0f);
 }
 
 void UActorBlueprintFunctionLibrary::SetGnss(
@@ -2613,6 +2866,8 @@ void UActorBlueprintFunctionLibrary::SetGnss(
       RetrieveActorAttributeToFloat("noise_lon_bias", Description.Variations, 0.0f));
   Gnss->SetAltitudeBias(
       RetrieveActorAttributeToFloat("noise_alt_bias", Description.Variations, 0.0f));
+  Gnss->SetSamplesPerTick(
+      RetrieveActorAttributeToInt("samples_per_tick", Description.Variations, 1));
 }
 
 void UActorBlueprintFunctionLibrary::SetIMU(
@@ -2644,6 +2899,9 @@ void UActorBlueprintFunctionLibrary::SetIMU(
       RetrieveActorAttributeToFloat("noise_gyro_bias_x", Description.Variations, 0.0f),
       RetrieveActorAttributeToFloat("noise_gyro_bias_y", Description.Variations, 0.0f),
       RetrieveActorAttributeToFloat("noise_gyro_bias_z", Description.Variations, 0.0f)});
+
+  IMU->SetSamplesPerTick(
+      RetrieveActorAttributeToInt("samples_per_tick", Description.Variations, 1));
 }
 
 void UActorBlueprintFunctionLibrary::SetRadar(
@@ -2671,6 +2929,8 @@ void UActorBlueprintFunctionLibrary::SetRadar(
       RetrieveActorAttributeToFloat("range", Description.Variations, 100.0f) * TO_CENTIMETERS);
   Radar->SetPointsPerSecond(
       RetrieveActorAttributeToInt("points_per_second", Description.Variations, 1500));
+  Radar->SetMaxRaysPerTick(
+      RetrieveActorAttributeToInt("max_rays_per_tick", Description.Variations, 0));
 }
 
 void UActorBlueprintFunctionLibrary::SetV2X(
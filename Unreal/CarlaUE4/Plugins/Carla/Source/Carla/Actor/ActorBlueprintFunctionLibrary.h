@@ -176,6 +176,10 @@ public:
       const FString &Id,
       FActorDefinition &Definition);
 
+  static FActorDefinition MakeWalkerPoseSensorDefinition();
+
+  static FActorDefinition MakeVehicleTelemetrySensorDefinition();
+
   /// @}
   /// ==========================================================================
   /// @name 获取属性值的帮助程序
@@ -0,0 +1,185 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Actor/ActorDefinitionCache.h"
+
+#include "Carla/Actor/CarlaActorFactory.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/BufferArchive.h"
+#include "Serialization/MemoryReader.h"
+#include "UObject/SoftObjectPath.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Version.h>
+#include <compiler/enable-ue4-macros.h>
+
+namespace ActorDefinitionCacheConstants
+{
+  /// First bytes of the file, "CADC".
+  constexpr uint32 Magic = 0x43444143u;
+}
+
+FArchive &operator<<(FArchive &Archive, FActorVariation &Variation)
+{
+  Archive << Variation.Id;
+  Archive << Variation.Type;
+  Archive << Variation.RecommendedValues;
+  Archive << Variation.bRestrictToRecommended;
+  return Archive;
+}
+
+FArchive &operator<<(FArchive &Archive, FActorAttribute &Attribute)
+{
+  Archive << Attribute.Id;
+  Archive << Attribute.Type;
+  Archive << Attribute.Value;
+  return Archive;
+}
+
+/// The class is stored by path name, loading fails if it cannot be found.
+FArchive &operator<<(FArchive &Archive, FActorDefinition &Definition)
+{
+  Archive << Definition.Id;
+  FString ClassPath = Archive.IsSaving() ? FSoftClassPath(Definition.Class.Get()).ToString() : FString();
+  Archive << ClassPath;
+  if (Archive.IsLoading())
+  {
+    Definition.Class = ClassPath.IsEmpty() ? nullptr : FSoftClassPath(ClassPath).TryLoadClass<AActor>();
+    if (Definition.Class == nullptr)
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Actor definition cache: cannot load class '%s'"), *ClassPath);
+      Archive.SetError();
+    }
+  }
+  Archive << Definition.Tags;
+  Archive << Definition.Variations;
+  Archive << Definition.Attributes;
+  return Archive;
+}
+
+static void FActorDefinitionCache_AddFileVersion(uint32 &Hash, const FString &FilePath)
+{
+  const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*FilePath);
+  const int64 Ticks = TimeStamp.GetTicks();
+  const int64 Size = IFileManager::Get().FileSize(*FilePath);
+  Hash = FCrc::StrCrc32(*FilePath, Hash);
+  Hash = FCrc::MemCrc32(&Ticks, sizeof(Ticks), Hash);
+  Hash = FCrc::MemCrc32(&Size, sizeof(Size), Hash);
+}
+
+bool FActorDefinitionCache::IsEnabled()
+{
+  return !GIsEditor && !FParse::Param(FCommandLine::Get(), TEXT("carla-no-actor-definition-cache"));
+}
+
+FString FActorDefinitionCache::GetDefaultPath()
+{
+  return FPaths::ProjectSavedDir() + TEXT("Carla/ActorDefinitionCache.bin");
+}
+
+uint32 FActorDefinitionCache::ComputeContentVersion(const TArray<ACarlaActorFactory *> &Factories)
+{
+  uint32 Hash = FCrc::StrCrc32(ANSI_TO_TCHAR(carla::version()));
+
+  // The definitions of the C++ factories, e.g. the sensors, come with the
+  // binary.
+  FString Binary = FModuleManager::Get().GetModuleFilename(TEXT("Carla"));
+  if (Binary.IsEmpty())
+  {
+    Binary = FPlatformProcess::ExecutablePath();
+  }
+  FActorDefinitionCache_AddFileVersion(Hash, Binary);
+
+  for (const ACarlaActorFactory *Factory : Factories)
+  {
+    const UClass *Class = Factory->GetClass();
+    Hash = FCrc::StrCrc32(*Class->GetPathName(), Hash);
+    if (Class->ClassGeneratedBy != nullptr)
+    {
+      // A blueprint factory, its definitions change with its package.
+      FString PackageFile;
+      if (FPackageName::DoesPackageExist(Class->GetOutermost()->GetName(), nullptr, &PackageFile))
+      {
+        FActorDefinitionCache_AddFileVersion(Hash, PackageFile);
+      }
+    }
+  }
+
+  // Props are registered from these files, see UCarlaBlueprintRegistry.
+  TArray<FString> Registries;
+  IFileManager::Get().FindFilesRecursive(
+      Registries, *FPaths::ProjectContentDir(), TEXT("*.Package.json"), true, false);
+  Registries.Sort();
+  for (const FString &Registry : Registries)
+  {
+    FActorDefinitionCache_AddFileVersion(Hash, Registry);
+  }
+  return Hash;
+}
+
+const TArray<FActorDefinition> *FActorDefinitionCache::Find(const ACarlaActorFactory &Factory) const
+{
+  return Definitions.Find(Factory.GetClass()->GetPathName());
+}
+
+void FActorDefinitionCache::Add(const ACarlaActorFactory &Factory, TArray<FActorDefinition> FactoryDefinitions)
+{
+  Definitions.Add(Factory.GetClass()->GetPathName(), MoveTemp(FactoryDefinitions));
+}
+
+bool FActorDefinitionCache::Save(const FString &FilePath) const
+{
+  FBufferArchive Archive;
+  uint32 Magic = ActorDefinitionCacheConstants::Magic;
+  int32 FileVersion = Version;
+  uint32 SavedContentVersion = ContentVersion;
+  Archive << Magic;
+  Archive << FileVersion;
+  Archive << SavedContentVersion;
+  Archive << const_cast<TMap<FString, TArray<FActorDefinition>> &>(Definitions);
+  return FFileHelper::SaveArrayToFile(Archive, *FilePath);
+}
+
+bool FActorDefinitionCache::Load(const FString &FilePath, const uint32 ExpectedContentVersion)
+{
+  *this = FActorDefinitionCache();
+  TArray<uint8> Bytes;
+  if (!FPaths::FileExists(FilePath) || !FFileHelper::LoadFileToArray(Bytes, *FilePath))
+  {
+    return false;
+  }
+  FMemoryReader Archive(Bytes);
+  uint32 Magic = 0u;
+  int32 FileVersion = 0;
+  Archive << Magic;
+  Archive << FileVersion;
+  Archive << ContentVersion;
+  if ((Magic != ActorDefinitionCacheConstants::Magic) || (FileVersion != Version))
+  {
+    UE_LOG(LogCarla, Log, TEXT("Ignoring actor definition cache %s of another version"), *FilePath);
+    *this = FActorDefinitionCache();
+    return false;
+  }
+  if (ContentVersion != ExpectedContentVersion)
+  {
+    UE_LOG(LogCarla, Log, TEXT("Content changed, actor definition cache %s is outdated"), *FilePath);
+    *this = FActorDefinitionCache();
+    return false;
+  }
+  Archive << Definitions;
+  if (Archive.IsError())
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Ignoring corrupted actor definition cache %s"), *FilePath);
+    *this = FActorDefinitionCache();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorDefinition.h"
+
+#include "CoreMinimal.h"
+
+class ACarlaActorFactory;
+
+/// Actor definitions generated by the actor factories, saved between runs of
+/// the server so that the factories do not generate and validate them again
+/// at every startup.
+///
+/// The cache is keyed by a content version computed from the server binary,
+/// the packages of the factories and the prop registries. If any of them
+/// changes, or the server runs in the editor, the definitions are generated
+/// again as before. Launch the server with -carla-no-actor-definition-cache
+/// to disable it.
+struct CARLA_API FActorDefinitionCache
+{
+  /// Increase when the layout changes, older files are ignored.
+  static constexpr int32 Version = 1;
+
+  /// Content version the definitions were generated with.
+  uint32 ContentVersion = 0u;
+
+  /// Valid definitions of each factory, by path name of the factory class.
+  TMap<FString, TArray<FActorDefinition>> Definitions;
+
+  static bool IsEnabled();
+
+  /// Default location of the cache, in the saved directory of the project.
+  static FString GetDefaultPath();
+
+  /// Version of the content the definitions of @a Factories depend on.
+  static uint32 ComputeContentVersion(const TArray<ACarlaActorFactory *> &Factories);
+
+  /// Cached definitions of @a Factory, null if there are none.
+  const TArray<FActorDefinition> *Find(const ACarlaActorFactory &Factory) const;
+
+  void Add(const ACarlaActorFactory &Factory, TArray<FActorDefinition> FactoryDefinitions);
+
+  bool Save(const FString &FilePath) const;
+
+  /// Load the cache at @a FilePath, return false and leave it empty if the
+  /// file is missing, of another version, of another content version or
+  /// refers to a class that cannot be loaded.
+  bool Load(const FString &FilePath, uint32 ExpectedContentVersion);
+};
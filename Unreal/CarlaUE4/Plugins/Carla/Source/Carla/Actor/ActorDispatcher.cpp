@@ -12,8 +12,12 @@
 #include "Carla/Actor/CarlaActorFactory.h"
 
 #include "Carla/Game/Tagger.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
 #include "Carla/Vehicle/VehicleControl.h"
 
+#include "Async/ParallelFor.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 
 #include <compiler/disable-ue4-macros.h>
@@ -24,10 +28,7 @@ void UActorDispatcher::Bind(FActorDefinition Definition, SpawnFunctionType Funct
 {
   if (UActorBlueprintFunctionLibrary::CheckActorDefinition(Definition))
   {
-    Definition.UId = static_cast<uint32>(SpawnFunctions.Num()) + 1u;
-    Definitions.Emplace(Definition);
-    SpawnFunctions.Emplace(Functor);
-    Classes.Emplace(Definition.Class);
+    BindValidated(MoveTemp(Definition), MoveTemp(Functor));
   }
   else
   {
@@ -35,16 +36,92 @@ void UActorDispatcher::Bind(FActorDefinition Definition, SpawnFunctionType Funct
   }
 }
 
+void UActorDispatcher::BindValidated(FActorDefinition Definition, SpawnFunctionType Functor)
+{
+  Definition.UId = static_cast<uint32>(SpawnFunctions.Num()) + 1u;
+  Classes.Emplace(Definition.Class);
+  Definitions.Emplace(MoveTemp(Definition));
+  SpawnFunctions.Emplace(MoveTemp(Functor));
+}
+
 void UActorDispatcher::Bind(ACarlaActorFactory &ActorFactory)
 {
-  for (const auto &Definition : ActorFactory.GetDefinitions())
+  BindValidated(ActorFactory, FilterValidDefinitions(ActorFactory.GetDefinitions()));
+}
+
+void UActorDispatcher::BindValidated(
+    ACarlaActorFactory &ActorFactory,
+    const TArray<FActorDefinition> &FactoryDefinitions)
+{
+  Definitions.Reserve(Definitions.Num() + FactoryDefinitions.Num());
+  for (const auto &Definition : FactoryDefinitions)
   {
-    Bind(Definition, [&](const FTransform &Transform, const FActorDescription &Description) {
+    BindValidated(Definition, [&](const FTransform &Transform, const FActorDescription &Description) {
       return ActorFactory.SpawnActor(Transform, Description);
     });
   }
 }
 
+TArray<FActorDefinition> UActorDispatcher::FilterValidDefinitions(const TArray<FActorDefinition> &Definitions)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  // 每个定义要检查所有变体的推荐值，定义之间互不依赖
+  TArray<bool> ValidFlags;
+  ValidFlags.SetNumZeroed(Definitions.Num());
+  ParallelFor(Definitions.Num(), [&](int32 Index)
+  {
+    ValidFlags[Index] = UActorBlueprintFunctionLibrary::CheckActorDefinition(Definitions[Index]);
+  });
+  TArray<FActorDefinition> Valid;
+  Valid.Reserve(Definitions.Num());
+  for (int32 Index = 0; Index < Definitions.Num(); ++Index)
+  {
+    if (ValidFlags[Index])
+    {
+      Valid.Emplace(Definitions[Index]);
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Invalid definition '%s' ignored"), *Definitions[Index].Id);
+    }
+  }
+  return Valid;
+}
+
+/// Move a pooled actor to @a Transform and reset it to the state of a newly
+/// spawned one. Fails, leaving the actor hidden, if the actor would collide.
+static bool UActorDispatcher_ResetPooledActor(AActor &Actor, const FTransform &Transform)
+{
+  // The same check SpawnActor does with the collision handling of the factories.
+  if (Actor.GetWorld()->EncroachingBlockingGeometry(
+          &Actor, Transform.GetLocation(), Transform.Rotator()))
+  {
+    return false;
+  }
+  Actor.SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+
+  ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(&Actor);
+  if (Vehicle != nullptr)
+  {
+    Vehicle->SetSimulatePhysics(true);
+    Vehicle->ApplyVehicleControl(FVehicleControl{}, EVehicleInputPriority::Highest);
+    Vehicle->SetVehicleLightState(FVehicleLightState{});
+  }
+  ACharacter *Character = Cast<ACharacter>(&Actor);
+  if (Character != nullptr)
+  {
+    Character->GetCharacterMovement()->StopMovementImmediately();
+  }
+
+  // The controller was destroyed with the previous actor.
+  APawn *Pawn = Cast<APawn>(&Actor);
+  if (Pawn != nullptr && Pawn->GetController() == nullptr)
+  {
+    Pawn->SpawnDefaultController();
+  }
+  return true;
+}
+
 TPair<EActorSpawnResultStatus, FCarlaActor*> UActorDispatcher::SpawnActor(
     const FTransform &Transform,
     FActorDescription Description,
@@ -59,6 +136,26 @@ TPair<EActorSpawnResultStatus, FCarlaActor*> UActorDispatcher::SpawnActor(
   UE_LOG(LogCarla, Log, TEXT("Spawning actor '%s'"), *Description.Id);
 
   Description.Class = Classes[Description.UId - 1];
+
+  // Reuse an actor destroyed before with the same blueprint and attributes.
+  AActor *PooledActor = Registry.TakePooledActor(Description);
+  if (PooledActor != nullptr)
+  {
+    if (!UActorDispatcher_ResetPooledActor(*PooledActor, Transform))
+    {
+      Registry.PoolActor(*PooledActor, Description);
+      return MakeTuple(EActorSpawnResultStatus::Collision, nullptr);
+    }
+    FCarlaActor* View = RegisterActor(*PooledActor, std::move(Description), DesiredId);
+    if (View)
+    {
+      ATagger::TagActor(*PooledActor, true);
+      return MakeTuple(EActorSpawnResultStatus::Success, View);
+    }
+    PooledActor->Destroy();
+    return MakeTuple(EActorSpawnResultStatus::UnknownError, nullptr);
+  }
+
   FActorSpawnResult Result = SpawnFunctions[Description.UId - 1](Transform, Description);
 
   if ((Result.Status == EActorSpawnResultStatus::Success) && (Result.Actor == nullptr))
@@ -128,6 +225,9 @@ bool UActorDispatcher::DestroyActor(FCarlaActor::IdType ActorId)
 
   const FString &Id = View->GetActorInfo()->Description.Id;
 
+  // 放回池中的参与者在 SpawnActor 里重新使用，不需要重新构造
+  const bool bRecycle = Registry.IsRecyclable(*View);
+
   // 如果存在控制器，将其摧毁
   AActor* Actor = View->GetActor();
   if(Actor)
@@ -144,6 +244,20 @@ bool UActorDispatcher::DestroyActor(FCarlaActor::IdType ActorId)
       }
     }
 
+    if (bRecycle && Registry.PoolActor(*Actor, View->GetActorInfo()->Description))
+    {
+      UE_LOG(LogCarla, Log, TEXT("UActorDispatcher::Recycling actor: '%s' %x"), *Id, Actor);
+      #if defined(WITH_ROS2)
+      auto ROS2 = carla::ros2::ROS2::GetInstance();
+      if (ROS2->IsEnabled())
+      {
+        ROS2->RemoveActorRosName(reinterpret_cast<void *>(Actor));
+      }
+      #endif
+      Registry.Deregister(ActorId);
+      return true;
+    }
+
     // 摧毁参与者
     UE_LOG(LogCarla, Log, TEXT("UActorDispatcher::Destroying actor: '%s' %x"), *Id, Actor);
     UE_LOG(LogCarla, Log, TEXT("            %s"), Actor?*Actor->GetName():*FString("None"));
@@ -167,7 +281,8 @@ FCarlaActor* UActorDispatcher::RegisterActor(
   if (View)
   {
     // 待办事项：支持外部角色销毁
-    Actor.OnDestroyed.AddDynamic(this, &UActorDispatcher::OnActorDestroyed);
+    // 从池中取出的参与者已经绑定过
+    Actor.OnDestroyed.AddUniqueDynamic(this, &UActorDispatcher::OnActorDestroyed);
 
     // ROS2 中 actor 到 ros_name 的映射
     #if defined(WITH_ROS2)
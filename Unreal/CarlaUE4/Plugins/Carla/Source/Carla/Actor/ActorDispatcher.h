@@ -40,6 +40,15 @@ public:
   ///警告 无效的定义将被忽略
   void Bind(ACarlaActorFactory &ActorFactory);
 
+  /// 将 @a Definitions 绑定到 @a ActorFactory 的 spawn 函数，@a Definitions
+  /// 必须已经由 FilterValidDefinitions 验证过（例如来自 FActorDefinitionCache）
+  void BindValidated(ACarlaActorFactory &ActorFactory, const TArray<FActorDefinition> &Definitions);
+
+  /// 并行验证 @a Definitions，返回其中有效的定义，顺序不变
+  ///
+  /// 警告：无效的定义将被忽略
+  static TArray<FActorDefinition> FilterValidDefinitions(const TArray<FActorDefinition> &Definitions);
+
   ///在 @a Transform 位置基于 @a ActorDescription 生成一个角色。为了正确地
   /// 使用此函数创建的actor可以通过调用DestroyActor来销毁
   ///
@@ -64,7 +73,8 @@ public:
 
   void WakeActorUp(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpisode);
 
-  /// 销毁一个角色，并将其从注册表中正确移除
+  /// 销毁一个角色，并将其从注册表中正确移除。如果注册表的池大小不为 0，
+  /// 可以重新使用的车辆和行人会放入池中，由之后的 SpawnActor 重新使用
   ///
   /// 如果@a Actor已被销毁或已标记为销毁，则返回true
   /// 如果不可破坏或为空指针，则返回 false
@@ -98,6 +108,8 @@ private:
   UFUNCTION()
   void OnActorDestroyed(AActor *Actor);
 
+  void BindValidated(FActorDefinition Definition, SpawnFunctionType SpawnFunction);
+
   TArray<FActorDefinition> Definitions;
 
   TArray<SpawnFunctionType> SpawnFunctions;
@@ -13,6 +13,9 @@
 #include "Carla/Util/BoundingBoxCalculator.h"
 #include "Carla/Sensor/Sensor.h"
 
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
 #include <compiler/disable-ue4-macros.h>
 #include "carla/streaming/Token.h"
 #include "carla/streaming/detail/Token.h"
@@ -183,6 +186,58 @@ TSharedPtr<FCarlaActor> FActorRegistry::MakeCarlaActor(
   return CarlaActor;
 }
 
+static FString FActorRegistry_GetPoolKey(const FActorDescription &Description)
+{
+  // 属性（例如颜色）在生成时应用，所以只重新使用属性完全相同的参与者
+  TArray<FString> Names;
+  Description.Variations.GetKeys(Names);
+  Names.Sort();
+  FString Key = Description.Id;
+  for (const FString &Name : Names)
+  {
+    Key += TEXT(";") + Name + TEXT("=") + Description.Variations[Name].Value;
+  }
+  return Key;
+}
+
+static bool FActorRegistry_IsPoolable(const FCarlaActor &CarlaActor)
+{
+  // 只有没有子参与者的车辆，它们的状态都由 FVehicleData 恢复
+  return CarlaActor.GetActorType() == FCarlaActor::ActorType::Vehicle &&
+      CarlaActor.GetChildren().Num() == 0;
+}
+
+bool FActorRegistry::IsRecyclable(const FCarlaActor &CarlaActor) const
+{
+  const AActor *Actor = CarlaActor.GetActor();
+  if (ActorPoolSize <= 0 || Actor == nullptr || Actor->IsPendingKill() ||
+      CarlaActor.GetChildren().Num() > 0)
+  {
+    return false;
+  }
+  // 附加的 actor（例如传感器）会跟着隐藏起来
+  TArray<AActor *> AttachedActors;
+  Actor->GetAttachedActors(AttachedActors);
+  if (AttachedActors.Num() > 0)
+  {
+    return false;
+  }
+  switch (CarlaActor.GetActorType())
+  {
+    case FCarlaActor::ActorType::Vehicle:
+      return true;
+    case FCarlaActor::ActorType::Walker:
+    {
+      // 被撞倒的行人是布娃娃，不能重新使用
+      const ACharacter *Character = Cast<ACharacter>(Actor);
+      return Character != nullptr && CarlaActor.IsAlive() &&
+          !Character->GetMesh()->IsSimulatingPhysics();
+    }
+    default:
+      return false;
+  }
+}
+
 void FActorRegistry::PutActorToSleep(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpisode)
 {
   FCarlaActor* CarlaActor = FindCarlaActor(Id);
@@ -195,7 +250,18 @@ void FActorRegistry::PutActorToSleep(FCarlaActor::IdType Id, UCarlaEpisode* Carl
     Ids.Remove(Actor);
   }
 
-  CarlaActor->PutActorToSleep(CarlaEpisode);
+  if (Actor && ActorPoolSize > 0 && FActorRegistry_IsPoolable(*CarlaActor))
+  {
+    CarlaActor->PutActorToSleep(CarlaEpisode, false);
+    if (!PoolActor(*Actor, CarlaActor->GetActorInfo()->Description))
+    {
+      Actor->Destroy();
+    }
+  }
+  else
+  {
+    CarlaActor->PutActorToSleep(CarlaEpisode);
+  }
   for (const FCarlaActor::IdType& ChildId : CarlaActor->GetChildren())
   {
     PutActorToSleep(ChildId, CarlaEpisode);
@@ -207,7 +273,12 @@ void FActorRegistry::WakeActorUp(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpi
 {
 
   FCarlaActor* CarlaActor = FindCarlaActor(Id);
-  CarlaActor->WakeActorUp(CarlaEpisode);
+  AActor* PooledActor = nullptr;
+  if (ActorPoolSize > 0 && FActorRegistry_IsPoolable(*CarlaActor))
+  {
+    PooledActor = TakePooledActor(CarlaActor->GetActorInfo()->Description);
+  }
+  CarlaActor->WakeActorUp(CarlaEpisode, PooledActor);
   AActor* Actor = CarlaActor->GetActor();
   if (Actor)
   {
@@ -237,7 +308,136 @@ void FActorRegistry::WakeActorUp(FCarlaActor::IdType Id, UCarlaEpisode* CarlaEpi
   }
 }
 
+void FActorRegistry::QueueWakeActorUp(IdType Id)
+{
+  if (!WakeUpQueued.Contains(Id))
+  {
+    WakeUpQueued.Add(Id);
+    WakeUpQueue.Add(Id);
+  }
+}
+
+TArray<FActorRegistry::IdType> FActorRegistry::WakeQueuedActorsUp(
+    UCarlaEpisode* CarlaEpisode,
+    double TimeBudget)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FActorRegistry::WakeQueuedActorsUp);
+  TArray<IdType> Processed;
+  const double StartTime = FPlatformTime::Seconds();
+  while (WakeUpQueueHead < WakeUpQueue.Num())
+  {
+    if (Processed.Num() > 0 && FPlatformTime::Seconds() - StartTime >= TimeBudget)
+    {
+      break;
+    }
+    const IdType Id = WakeUpQueue[WakeUpQueueHead++];
+    WakeUpQueued.Remove(Id);
+    Processed.Add(Id);
+    // 排队以后可能已经被销毁或唤醒（例如和父参与者一起）
+    FCarlaActor* CarlaActor = FindCarlaActor(Id);
+    if (CarlaActor != nullptr && CarlaActor->IsDormant())
+    {
+      WakeActorUp(Id, CarlaEpisode);
+    }
+  }
+
+  // 丢弃已经处理过的部分
+  if (WakeUpQueueHead >= WakeUpQueue.Num())
+  {
+    WakeUpQueue.Reset();
+    WakeUpQueueHead = 0;
+  }
+  else if (WakeUpQueueHead > WakeUpQueue.Num() / 2)
+  {
+    WakeUpQueue.RemoveAt(0, WakeUpQueueHead, false);
+    WakeUpQueueHead = 0;
+  }
+  return Processed;
+}
+
+void FActorRegistry::SetActorPoolSize(int32 Size)
+{
+  if (Size == ActorPoolSize)
+  {
+    return;
+  }
+  ActorPoolSize = FMath::Max(Size, 0);
+  for (auto &Element : ActorPool)
+  {
+    while (Element.Value.Num() > ActorPoolSize)
+    {
+      AActor *Actor = Element.Value.Pop(false).Actor.Get();
+      if (Actor != nullptr)
+      {
+        Actor->Destroy();
+      }
+    }
+  }
+}
+
+AActor* FActorRegistry::TakePooledActor(const FActorDescription &Description)
+{
+  TArray<FPooledActor> *Pool = ActorPool.Find(FActorRegistry_GetPoolKey(Description));
+  while (Pool != nullptr && Pool->Num() > 0)
+  {
+    FPooledActor Pooled = Pool->Pop(false);
+    AActor *Actor = Pooled.Actor.Get();
+    if (Actor == nullptr || Actor->IsPendingKill())
+    {
+      continue;
+    }
+    // FActorData::RestoreActorData 或 UActorDispatcher 恢复变换、速度和物理
+    Actor->SetActorHiddenInGame(false);
+    Actor->SetActorEnableCollision(true);
+    Actor->SetActorTickEnabled(Pooled.bTickEnabled);
+    ACharacter *Character = Cast<ACharacter>(Actor);
+    if (Character != nullptr)
+    {
+      Character->GetCharacterMovement()->SetComponentTickEnabled(true);
+      Character->GetCharacterMovement()->SetDefaultMovementMode();
+    }
+    return Actor;
+  }
+  return nullptr;
+}
+
+bool FActorRegistry::PoolActor(AActor &Actor, const FActorDescription &Description)
+{
+  TArray<FPooledActor> &Pool = ActorPool.FindOrAdd(FActorRegistry_GetPoolKey(Description));
+  if (Pool.Num() >= ActorPoolSize)
+  {
+    return false;
+  }
+  FPooledActor Pooled;
+  Pooled.Actor = &Actor;
+  Pooled.bTickEnabled = Actor.IsActorTickEnabled();
+  ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(&Actor);
+  if (Vehicle != nullptr)
+  {
+    Vehicle->SetSimulatePhysics(false);
+  }
+  ACharacter *Character = Cast<ACharacter>(&Actor);
+  if (Character != nullptr)
+  {
+    // 否则隐藏的行人会一直下落
+    Character->GetCharacterMovement()->StopMovementImmediately();
+    Character->GetCharacterMovement()->DisableMovement();
+    Character->GetCharacterMovement()->SetComponentTickEnabled(false);
+  }
+  Actor.SetActorHiddenInGame(true);
+  Actor.SetActorEnableCollision(false);
+  Actor.SetActorTickEnabled(false);
+  Pool.Add(Pooled);
+  return true;
+}
+
 FString FActorRegistry::GetDescriptionFromStream(carla::streaming::detail::stream_id_type Id)
+{
+  const FActorInfo *Info = GetActorInfoFromStream(Id);
+  return (Info != nullptr) ? Info->Description.Id : FString("");
+}
+
+const FActorInfo *FActorRegistry::GetActorInfoFromStream(carla::streaming::detail::stream_id_type Id)
 {
   for (auto &Item : ActorDatabase)
   {
@@ -248,9 +448,8 @@ FString FActorRegistry::GetDescriptionFromStream(carla::streaming::detail::strea
     carla::streaming::detail::token_type token(Sensor->GetToken());
     if (token.get_stream_id() == Id)
     {
-      const FActorInfo *Info = Item.Value->GetActorInfo();
-      return Info->Description.Id;
+      return Item.Value->GetActorInfo();
     }
   }
-  return FString("");
+  return nullptr;
 }
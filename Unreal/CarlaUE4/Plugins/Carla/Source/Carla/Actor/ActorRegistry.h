@@ -92,10 +92,51 @@ public:
 
   FString GetDescriptionFromStream(carla::streaming::detail::stream_id_type Id);
 
+  /// 发布数据流 @a Id 的传感器的信息，找不到时返回 nullptr。
+  const FActorInfo *GetActorInfoFromStream(carla::streaming::detail::stream_id_type Id);
+
   void PutActorToSleep(IdType Id, UCarlaEpisode* CarlaEpisode);
 
   void WakeActorUp(IdType Id, UCarlaEpisode* CarlaEpisode);
 
+  /// 把 @a Id 加入唤醒队列，由 WakeQueuedActorsUp 在之后的帧中唤醒，这样很多
+  /// 参与者同时进入流送距离时不会在一帧中全部重新生成
+  void QueueWakeActorUp(IdType Id);
+
+  /// 按加入的顺序唤醒队列中的参与者，直到用完 @a TimeBudget 秒（至少唤醒一个）。
+  ///
+  /// @return 处理过的参与者，唤醒失败的参与者仍然是休眠的
+  TArray<IdType> WakeQueuedActorsUp(UCarlaEpisode* CarlaEpisode, double TimeBudget);
+
+  bool IsWakeUpQueued(IdType Id) const
+  {
+    return WakeUpQueued.Contains(Id);
+  }
+
+  int32 GetNumQueuedWakeUps() const
+  {
+    return WakeUpQueued.Num();
+  }
+
+  /// 休眠的车辆和销毁的车辆、行人不销毁，而是隐藏起来，唤醒或生成相同蓝图
+  /// 和属性的参与者时重新使用，每种最多保留 @a Size 个。0 表示不使用（默认）。
+  void SetActorPoolSize(int32 Size);
+
+  int32 GetActorPoolSize() const
+  {
+    return ActorPoolSize;
+  }
+
+  /// 销毁 @a CarlaActor 时是否可以放入池中：没有子参与者、没有附加的 actor
+  /// 的车辆和活着的行人
+  bool IsRecyclable(const FCarlaActor &CarlaActor) const;
+
+  /// 从池中取出与 @a Description 相同的参与者，没有时返回 nullptr
+  AActor* TakePooledActor(const FActorDescription &Description);
+
+  /// 把 @a Actor 放入池中，池满了时返回 false
+  bool PoolActor(AActor &Actor, const FActorDescription &Description);
+
   /// @}
   // ===========================================================================
   ///名称范围迭代支持
@@ -125,8 +166,27 @@ private:
   FCarlaActor MakeFakeActor(
     AActor &Actor) const;
 
+  struct FPooledActor
+  {
+    TWeakObjectPtr<AActor> Actor;
+
+    bool bTickEnabled = true;
+  };
+
   TMap<IdType, AActor *> Actors;
 
+  /// 唤醒队列，WakeUpQueueHead 之前的已经处理过
+  TArray<IdType> WakeUpQueue;
+
+  int32 WakeUpQueueHead = 0;
+
+  TSet<IdType> WakeUpQueued;
+
+  /// 按蓝图和属性分组的隐藏参与者
+  TMap<FString, TArray<FPooledActor>> ActorPool;
+
+  int32 ActorPoolSize = 0;
+
   TMap<AActor *, IdType> Ids;
 
   DatabaseType ActorDatabase;
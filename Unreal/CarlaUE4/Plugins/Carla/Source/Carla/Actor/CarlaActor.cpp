@@ -15,6 +15,7 @@
 #include "Carla/Game/Tagger.h"
 #include "Carla/Vehicle/MovementComponents/CarSimManagerComponent.h"
 #include "Carla/Vehicle/MovementComponents/ChronoMovementComponent.h"
+#include "Carla/Vehicle/MovementComponents/KinematicMovementComponent.h"
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "Components/CapsuleComponent.h"
@@ -151,20 +152,23 @@ TSharedPtr<FCarlaActor> FCarlaActor::ConstructCarlaActor(
 
 // Base FCarlaActor functions ---------------------
 
-void FCarlaActor::PutActorToSleep(UCarlaEpisode* CarlaEpisode)
+void FCarlaActor::PutActorToSleep(UCarlaEpisode* CarlaEpisode, bool bDestroyActor)
 {
   State = carla::rpc::ActorState::Dormant;
   if (ActorData)
   {
     ActorData->RecordActorData(this, CarlaEpisode);
   }
-  TheActor->Destroy();
+  if (bDestroyActor)
+  {
+    TheActor->Destroy();
+  }
   TheActor = nullptr;
 }
 
-void FCarlaActor::WakeActorUp(UCarlaEpisode* CarlaEpisode)
+void FCarlaActor::WakeActorUp(UCarlaEpisode* CarlaEpisode, AActor* PooledActor)
 {
-  TheActor = ActorData->RespawnActor(CarlaEpisode, *Info);
+  TheActor = PooledActor ? PooledActor : ActorData->RespawnActor(CarlaEpisode, *Info);
   if (TheActor == nullptr)
   {
     UE_LOG(LogCarla, Error, TEXT("Could not wake up dormant actor %d at location %s"), GetActorId(), *(ActorData->GetLocalTransform(CarlaEpisode).GetLocation().ToString()));
@@ -256,6 +260,16 @@ FVector FCarlaActor::GetActorGlobalLocation() const
   }
 }
 
+void FCarlaActor::NotifyDormantActorMoved()
+{
+  ALargeMapManager* LargeMap =
+      UCarlaStatics::GetLargeMapManager(World);
+  if (LargeMap)
+  {
+    LargeMap->OnDormantActorMoved(GetActorId(), ActorData->Location);
+  }
+}
+
 void FCarlaActor::SetActorLocalLocation(const FVector& Location, ETeleportType TeleportType)
 {
   if (IsDormant())
@@ -268,6 +282,7 @@ void FCarlaActor::SetActorLocalLocation(const FVector& Location, ETeleportType T
       GlobalLocation = LargeMap->LocalToGlobalLocation(GlobalLocation);
     }
     ActorData->Location = FDVector(GlobalLocation);
+    NotifyDormantActorMoved();
   }
   else
   {
@@ -285,6 +300,7 @@ void FCarlaActor::SetActorGlobalLocation(
   if (IsDormant())
   {
     ActorData->Location = FDVector(Location);;
+    NotifyDormantActorMoved();
   }
   else
   {
@@ -319,6 +335,7 @@ void FCarlaActor::SetActorLocalTransform(
     ActorData->Location = FDVector(GlobalTransform.GetLocation());
     ActorData->Rotation = GlobalTransform.GetRotation();
     ActorData->Scale = GlobalTransform.GetScale3D();
+    NotifyDormantActorMoved();
   }
   else
   {
@@ -338,6 +355,7 @@ void FCarlaActor::SetActorGlobalTransform(
     ActorData->Location = FDVector(Transform.GetLocation());
     ActorData->Rotation = Transform.GetRotation();
     ActorData->Scale = Transform.GetScale3D();
+    NotifyDormantActorMoved();
   }
   else
   {
@@ -1074,6 +1092,23 @@ ECarlaServerResponse FVehicleActor::EnableChronoPhysics(
   return ECarlaServerResponse::Success;
 }
 
+ECarlaServerResponse FVehicleActor::EnableKinematicPhysics()
+{
+  if (IsDormant())
+  {
+  }
+  else
+  {
+    auto Vehicle = Cast<ACarlaWheeledVehicle>(GetActor());
+    if (Vehicle == nullptr)
+    {
+      return ECarlaServerResponse::NotAVehicle;
+    }
+    UKinematicMovementComponent::CreateKinematicMovementComponent(Vehicle);
+  }
+  return ECarlaServerResponse::Success;
+}
+
 ECarlaServerResponse FVehicleActor::RestorePhysXPhysics()
 {
   if (IsDormant())
@@ -150,9 +150,12 @@ public:
 
   void BuildActorData();
 
-  void PutActorToSleep(UCarlaEpisode* CarlaEpisode);
+  /// Record the actor data and release the actor. If @a bDestroyActor is
+  /// false the actor is not destroyed, the caller keeps it (e.g. to reuse it).
+  void PutActorToSleep(UCarlaEpisode* CarlaEpisode, bool bDestroyActor = true);
 
-  void WakeActorUp(UCarlaEpisode* CarlaEpisode);
+  /// Respawn the actor, or reuse @a PooledActor if given, and restore its data.
+  void WakeActorUp(UCarlaEpisode* CarlaEpisode, AActor* PooledActor = nullptr);
 
   FActorData* GetActorData()
   {
@@ -349,6 +352,11 @@ public:
     return ECarlaServerResponse::ActorTypeMismatch;
   }
 
+  virtual ECarlaServerResponse EnableKinematicPhysics()
+  {
+    return ECarlaServerResponse::ActorTypeMismatch;
+  }
+
   virtual ECarlaServerResponse RestorePhysXPhysics()
   {
     return ECarlaServerResponse::ActorTypeMismatch;
@@ -455,6 +463,10 @@ private:
 
   friend class FActorRegistry;
 
+  /// Let the large map manager know that the location of a dormant actor
+  /// changed, so it is checked in the right tile.
+  void NotifyDormantActorMoved();
+
   AActor *TheActor = nullptr;
 
   TSharedPtr<const FActorInfo> Info = nullptr;
@@ -546,6 +558,8 @@ public:
       const FString& VehicleJSON, const FString& PowertrainJSON,
       const FString& TireJSON, const FString& BaseJSONPath) final;
 
+  virtual ECarlaServerResponse EnableKinematicPhysics() final;
+
   virtual ECarlaServerResponse RestorePhysXPhysics();
 };
 
@@ -12,6 +12,7 @@ public class Carla : ModuleRules
   bool UsingChrono = false;
   bool UsingPytorch = false;
   bool UsingRos2 = false;
+  bool UsingServerNavigation = false;
 
   // 检查目标平台是否为 Windows
   private bool IsWindows(ReadOnlyTargetRules Target)
@@ -72,6 +73,14 @@ public class Carla : ModuleRules
         PublicDefinitions.Add("WITH_ROS2");
         PrivateDefinitions.Add("WITH_ROS2");
       }
+
+      if (line.Contains("ServerNavigation ON"))
+      {
+        Console.WriteLine("Enabling server navigation");
+        UsingServerNavigation = true;
+        PublicDefinitions.Add("WITH_SERVER_NAVIGATION");
+        PrivateDefinitions.Add("WITH_SERVER_NAVIGATION");
+      }
     }
 
     // 添加公共包含路径
@@ -95,6 +104,7 @@ public class Carla : ModuleRules
         "RenderCore",
         "RHI",
         "Renderer",
+        "CarlaShaders",
         "ProceduralMeshComponent",
         "MeshDescription"
         // ... add other public dependencies that you statically link with here ...
@@ -223,6 +233,14 @@ public class Carla : ModuleRules
       {
         PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("carla_server")));
       }
+
+      // 服务器端的行人导航使用 Recast&Detour
+      if (UsingServerNavigation)
+      {
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("Recast")));
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("Detour")));
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("DetourCrowd")));
+      }
       
       // 如果使用Chrono库，则添加其依赖项
       if (UsingChrono)
@@ -257,6 +275,12 @@ public class Carla : ModuleRules
       {
         PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("carla_server")));
       }
+      if (UsingServerNavigation)
+      {
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("DetourCrowd")));
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("Detour")));
+        PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("Recast")));
+      }
       if (UsingChrono)
       {
         AddDynamicLibrary(Path.Combine(LibCarlaInstallPath, "lib", "libChronoEngine.so"));
@@ -267,6 +291,9 @@ public class Carla : ModuleRules
         bUseRTTI = true;
       }
 
+      // 传感器数据压缩使用引擎自带的 zlib（Windows 上链接的是 zlibstatic.lib）
+      AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+
       // 检查是否使用PyTorch并添加其库
       if (UsingPytorch)
       {
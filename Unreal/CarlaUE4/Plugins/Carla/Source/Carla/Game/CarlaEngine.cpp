@@ -14,9 +14,14 @@
 #include "Carla/Recorder/CarlaRecorder.h"
 #include "Carla/Settings/CarlaSettings.h"
 #include "Carla/Settings/EpisodeSettings.h"
+#include "Carla/Vehicle/MovementComponents/KinematicMovementComponent.h"
+#include "Carla/Walker/WalkerBase.h"
+#include "Carla/Weather/Weather.h"
 
+#include "EngineUtils.h"
 #include "Runtime/Core/Public/Misc/App.h"
 #include "PhysicsEngine/PhysicsSettings.h"
+#include "RHI.h"
 #include "Carla/MapGen/LargeMapManager.h"
 
 #include <compiler/disable-ue4-macros.h>
@@ -25,11 +30,14 @@
 #include <carla/multigpu/commands.h>
 #include <carla/multigpu/secondary.h>
 #include <carla/multigpu/secondaryCommands.h>
+#include <carla/multigpu/socketOptions.h>
+#include <carla/profiler/Metrics.h>
 #include <carla/ros2/ROS2.h>
 #include <carla/streaming/EndPoint.h>
 #include <carla/streaming/Server.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <chrono>
 #include <thread>
 
 // =============================================================================
@@ -39,11 +47,94 @@
 // 初始化静态变量
 uint64_t FCarlaEngine::FrameCounter = 0;
 
+// 主服务器收集次级服务器 GPU 帧时间的间隔（秒）
+static constexpr double FCarlaEngine_PlacementUpdateInterval = 1.0;
+
+// 主服务器等待次级服务器确认一帧的最长时间
+static constexpr std::chrono::milliseconds FCarlaEngine_FrameAckTimeout{1000};
+
 static uint32 FCarlaEngine_GetNumberOfThreadsForRPCServer()
 {
   return std::max(std::thread::hardware_concurrency(), 4u) - 2u;
 }
 
+// 根据命令行参数配置世界状态流的增量编码，默认关闭
+static void FCarlaEngine_SetupEpisodeStateDeltaEncoding(FWorldObserver &WorldObserver)
+{
+  if (!FParse::Param(FCommandLine::Get(), TEXT("carla-episode-state-delta")))
+  {
+    return;
+  }
+  uint32 KeyframeInterval = 30u;
+  FParse::Value(FCommandLine::Get(), TEXT("-carla-episode-state-keyframe-interval="), KeyframeInterval);
+  float Epsilon = 1e-3f;
+  FParse::Value(FCommandLine::Get(), TEXT("-carla-episode-state-delta-epsilon="), Epsilon);
+  UE_LOG(LogCarla, Log, TEXT("Episode state delta encoding enabled: keyframe every %u messages, epsilon %f"),
+      KeyframeInterval, Epsilon);
+  WorldObserver.SetDeltaEncoding(KeyframeInterval, Epsilon);
+}
+
+static float FCarlaEngine_ToMilliseconds(double Seconds)
+{
+  return static_cast<float>(Seconds * 1e3);
+}
+
+// 导出到 MetricsRegistry 的每帧时间与传感器数量，进程中只有一个引擎
+struct FCarlaEngineMetrics
+{
+  FCarlaEngineMetrics()
+  {
+    auto &Registry = carla::profiler::MetricsRegistry::Get();
+    auto Phase = [&](const char *Name)
+    {
+      return Registry.GetHistogram(
+          "carla_engine_tick_phase_duration_seconds",
+          "Time spent in each phase of a server frame.",
+          {{"phase", Name}});
+    };
+    Frames = Registry.GetCounter("carla_engine_frames_total", "Frames simulated by the server.");
+    TickDuration = Registry.GetHistogram(
+        "carla_engine_tick_duration_seconds",
+        "Time from the start of a server frame until its sensors ticked.");
+    RPC = Phase("rpc");
+    PreTick = Phase("pre_tick");
+    WorldTick = Phase("world_tick");
+    PostTick = Phase("post_tick");
+    EpisodeState = Phase("episode_state");
+    Sensors = Phase("sensors");
+    NumberOfSensors = Registry.GetGauge("carla_engine_sensors", "Sensors registered in the current episode.");
+  }
+
+  void Record(const carla::rpc::FrameTimings &Timings, int32 SensorCount)
+  {
+    Frames->Increment();
+    TickDuration->Observe(Timings.server_total * 1e-3);
+    RPC->Observe(Timings.rpc * 1e-3);
+    PreTick->Observe(Timings.pre_tick * 1e-3);
+    WorldTick->Observe(Timings.world_tick * 1e-3);
+    PostTick->Observe(Timings.post_tick * 1e-3);
+    EpisodeState->Observe(Timings.episode_state * 1e-3);
+    Sensors->Observe(Timings.sensors * 1e-3);
+    NumberOfSensors->Set(static_cast<double>(SensorCount));
+  }
+
+  std::shared_ptr<carla::profiler::Counter> Frames;
+  std::shared_ptr<carla::profiler::Histogram> TickDuration;
+  std::shared_ptr<carla::profiler::Histogram> RPC;
+  std::shared_ptr<carla::profiler::Histogram> PreTick;
+  std::shared_ptr<carla::profiler::Histogram> WorldTick;
+  std::shared_ptr<carla::profiler::Histogram> PostTick;
+  std::shared_ptr<carla::profiler::Histogram> EpisodeState;
+  std::shared_ptr<carla::profiler::Histogram> Sensors;
+  std::shared_ptr<carla::profiler::Gauge> NumberOfSensors;
+};
+
+static FCarlaEngineMetrics &FCarlaEngine_GetMetrics()
+{
+  static FCarlaEngineMetrics Metrics;
+  return Metrics;
+}
+
 static TOptional<double> FCarlaEngine_GetFixedDeltaSeconds()
 {
   return FApp::IsBenchmarking() ? FApp::GetFixedDeltaTime() : TOptional<double>{};
@@ -87,10 +178,18 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
     const auto PrimaryIP     = Settings.PrimaryIP;
     const auto PrimaryPort   = Settings.PrimaryPort;
 
+    // 默认使用系统自动调整的套接字缓冲区，只有明确指定时才固定大小
+    uint32 MultiGPUSocketBufferSize = 0u;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-multigpu-socket-buffer="), MultiGPUSocketBufferSize))
+    {
+      carla::multigpu::MultiGPUSocketBufferSize() = MultiGPUSocketBufferSize;
+    }
+
     auto BroadcastStream     = Server.Start(Settings.RPCPort, StreamingPort, SecondaryPort);
     Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
 
     WorldObserver.SetStream(BroadcastStream);
+    FCarlaEngine_SetupEpisodeStateDeltaEncoding(WorldObserver);
 
     OnPreTickHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
         this,
@@ -112,25 +211,15 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
 
       // 当命令来自主服务器时，命令执行器是指负责处理和执行这些命令的组件或模块
       auto CommandExecutor = [=](carla::multigpu::MultiGPUCommand Id, carla::Buffer Data) {
-        struct CarlaStreamBuffer : public std::streambuf
-        {
-            CarlaStreamBuffer(char *buf, std::size_t size) { setg(buf, buf, buf + size); }
-        };
         switch (Id) {
           case carla::multigpu::MultiGPUCommand::SEND_FRAME:
           {
             if(GetCurrentEpisode())
             {
               TRACE_CPUPROFILER_EVENT_SCOPE_STR("MultiGPUCommand::SEND_FRAME");
-              // 将缓冲区中的帧数据转换为输入流
-              CarlaStreamBuffer TempStream((char *) Data.data(), Data.size());
-              std::istream InStream(&TempStream);
-              GetCurrentEpisode()->GetFrameData().Read(InStream);
-              {
-                TRACE_CPUPROFILER_EVENT_SCOPE_STR("FramesToProcess.emplace_back");
-                std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
-                FramesToProcess.emplace_back(GetCurrentEpisode()->GetFrameData());
-              }
+              // 只保存缓冲区，在 OnPreTick 中原地解析，不复制帧数据
+              std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
+              FramesToProcess.emplace_back(std::move(Data));
             }
             // 强制进行一次进行单位时间操作
             Server.Tick();
@@ -191,6 +280,14 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
             Secondary->Write(std::move(buf));
             break;
           }
+          case carla::multigpu::MultiGPUCommand::GET_FRAME_TIME:
+          {
+            // 最近一帧的 GPU 时间，主服务器用它来放置传感器
+            double Milliseconds = FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles());
+            carla::Buffer buf(reinterpret_cast<unsigned char *>(&Milliseconds), (size_t) sizeof(double));
+            Secondary->Write(std::move(buf));
+            break;
+          }
           case carla::multigpu::MultiGPUCommand::IS_ENABLED_ROS:
           {
             // 获取传感器 ID
@@ -214,6 +311,11 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
     {
       // 我们是主服务器，正在启动服务器
       bIsPrimaryServer = true;
+      // 次级服务器最多落后几帧，严格同步时同步模式下每帧都等待
+      FParse::Value(FCommandLine::Get(), TEXT("-carla-multigpu-lookahead="), MultiGPULookahead);
+      bMultiGPUStrictSync = FParse::Param(FCommandLine::Get(), TEXT("carla-multigpu-strict-sync"));
+      UE_LOG(LogCarla, Log, TEXT("Multi-GPU lookahead: %u frames%s"),
+          MultiGPULookahead, bMultiGPUStrictSync ? TEXT(", strict barrier in synchronous mode") : TEXT(""));
       SecondaryServer = Server.GetSecondaryServer();
       SecondaryServer->SetNewConnectionCallback([this]()
       {
@@ -284,9 +386,43 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   if (TickType == ELevelTick::LEVELTICK_All)
   {
+    const bool bRealTime = bIsPrimaryServer && RealTimeScheduler.IsEnabled();
+    if (bRealTime)
+    {
+      // 按上一帧的时间调整这一帧的子步数和传感器预算
+      const int32 Substeps = RealTimeScheduler.GetSubsteps();
+      RealTimeScheduler.EndFrame(
+          FPlatformTime::Seconds(), FrameTimings.world_tick * 1e-3, FrameTimings.sensors * 1e-3);
+      if (RealTimeScheduler.GetSubsteps() != Substeps && UPhysicsSettings::Get()->bSubstepping)
+      {
+        UPhysicsSettings::Get()->MaxSubstepDeltaTime = RealTimeScheduler.GetSubstepDeltaTime();
+      }
+      if (CurrentEpisode)
+      {
+        CurrentEpisode->GetSensorManager().SetTickBudget(RealTimeScheduler.GetSensorBudgetMilliseconds());
+      }
+    }
+
+    FrameTimings = carla::rpc::FrameTimings{};
+    FrameTimings.platform_timestamp = FPlatformTime::Seconds();
 
     if (bIsPrimaryServer)
     {
+      if (bRealTime)
+      {
+        // 等到这一帧的开始时间，期间继续处理 RPC 命令
+        TRACE_CPUPROFILER_EVENT_SCOPE_STR("RealTimeScheduler.Wait");
+        double Remaining = RealTimeScheduler.GetNextFrameBeginSeconds() - FrameTimings.platform_timestamp;
+        while (Remaining >= 1e-3)
+        {
+          Server.RunSome(static_cast<uint32>(Remaining * 1e3));
+          Remaining = RealTimeScheduler.GetNextFrameBeginSeconds() - FPlatformTime::Seconds();
+        }
+        const double Now = FPlatformTime::Seconds();
+        FrameTimings.idle = FCarlaEngine_ToMilliseconds(Now - FrameTimings.platform_timestamp);
+        RealTimeScheduler.BeginFrame(Now);
+      }
+
       if (CurrentEpisode && !bSynchronousMode && SecondaryServer->HasClientsConnected())
       {
         // 设置为同步模式。
@@ -313,24 +449,55 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
       while (!FramesToProcess.size());
     }
 
+    const double RPCEndSeconds = FPlatformTime::Seconds();
+    FrameTimings.rpc = FCarlaEngine_ToMilliseconds(RPCEndSeconds - FrameTimings.platform_timestamp);
+
     // 更新帧计数器
-    UpdateFrameCounter();
+    FrameTimings.frame = UpdateFrameCounter();
 
     if (CurrentEpisode)
     {
       CurrentEpisode->TickTimers(DeltaSeconds);
 
+      // 服务器端导航的行人在物理之前移动，与客户端的 ApplyWalkerState 相同
+      if (bIsPrimaryServer)
+      {
+        CurrentEpisode->GetWalkerNavigation().Tick(*CurrentEpisode, DeltaSeconds);
+      }
+
+      // 远离 hero 车辆的车辆切换到运动学模型，在物理之前切换以便本帧生效
+      if (bIsPrimaryServer && CurrentSettings.KinematicPhysicsDistance > 0.0f)
+      {
+        UKinematicMovementComponent::UpdateByDistanceToHero(
+            *CurrentEpisode, CurrentSettings.KinematicPhysicsDistance);
+      }
+
       if (!bIsPrimaryServer)
       {
-        if (FramesToProcess.size())
+        carla::Buffer FrameBuffer;
         {
-          TRACE_CPUPROFILER_EVENT_SCOPE_STR("FramesToProcess.PlayFrameData");
           std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
-          FramesToProcess.front().PlayFrameData(CurrentEpisode, MappedId);
-          FramesToProcess.erase(FramesToProcess.begin()); // 移除第一个元素
+          if (!FramesToProcess.empty())
+          {
+            FrameBuffer = std::move(FramesToProcess.front());
+            FramesToProcess.pop_front(); // 移除第一个元素
+          }
+        }
+        if (!FrameBuffer.empty())
+        {
+          TRACE_CPUPROFILER_EVENT_SCOPE_STR("FramesToProcess.PlayFrameData");
+          FFrameData &FrameData = CurrentEpisode->GetFrameData();
+          FrameData.Read(FrameBuffer);
+          FrameData.PlayFrameData(CurrentEpisode, MappedId);
+          // 在 OnPostTick 中传感器渲染完后确认
+          PlayedFrame = FrameData.GetFrame();
+          bFramePlayed = true;
         }
       }
     }
+
+    PreTickEndSeconds = FPlatformTime::Seconds();
+    FrameTimings.pre_tick = FCarlaEngine_ToMilliseconds(PreTickEndSeconds - RPCEndSeconds);
   }
 }
 
@@ -338,22 +505,46 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
 void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  const double PostTickBeginSeconds = FPlatformTime::Seconds();
   // 标记录制/回放系统
   if (GetCurrentEpisode())
   {
     if (bIsPrimaryServer)
     {
       if (SecondaryServer->HasClientsConnected()) {
-        GetCurrentEpisode()->GetFrameData().GetFrameData(GetCurrentEpisode(), true, bNewConnection);
+        FFrameData &FrameData = GetCurrentEpisode()->GetFrameData();
+        FrameData.GetFrameData(GetCurrentEpisode(), true, bNewConnection);
         bNewConnection = false;
-        std::ostringstream OutStream;
-        GetCurrentEpisode()->GetFrameData().Write(OutStream);
+
+        // 一次序列化到池中的缓冲区（按上一帧的大小分配），发送完成后缓冲区回到池中
+        carla::Buffer FrameBuffer = FrameDataPool->Pop(FrameDataSize);
+        FrameBuffer.reset(FrameDataSize);
+        FrameData.Write(FrameBuffer);
+        FrameDataSize = FrameBuffer.size();
 
         // 将帧数据发送到次级服务器
-        std::string Tmp(OutStream.str());
-        SecondaryServer->GetCommander().SendFrameData(carla::Buffer(std::move((unsigned char *) Tmp.c_str()), (size_t) Tmp.size()));
+        const uint64_t Frame = FrameData.GetFrame();
+        SecondaryServer->GetCommander().SendFrameData(std::move(FrameBuffer), Frame);
+
+        FrameData.Clear();
 
-        GetCurrentEpisode()->GetFrameData().Clear();
+        // 流水线同步：次级服务器渲染前面的帧时主服务器继续模拟，最多领先 Lookahead 帧
+        const uint64_t Lookahead = (bMultiGPUStrictSync && bSynchronousMode) ? 0u : MultiGPULookahead;
+        if (Frame > Lookahead)
+        {
+          TRACE_CPUPROFILER_EVENT_SCOPE_STR("MultiGPU.WaitForFrame");
+          if (!SecondaryServer->GetCommander().WaitForFrame(Frame - Lookahead, FCarlaEngine_FrameAckTimeout))
+          {
+            UE_LOG(LogCarla, Warning, TEXT("Secondary servers did not render frame %llu in time"), Frame - Lookahead);
+          }
+        }
+
+        // 定期收集次级服务器的 GPU 帧时间，负载不平衡时迁移传感器
+        if (PostTickBeginSeconds - PlacementUpdateSeconds >= FCarlaEngine_PlacementUpdateInterval)
+        {
+          PlacementUpdateSeconds = PostTickBeginSeconds;
+          SecondaryServer->GetCommander().UpdatePlacement();
+        }
       }
     }
 
@@ -381,9 +572,36 @@ void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSec
     //worldsnapshot:
     //1·游戏开发：在游戏中，"world snapshot" 可以用来记录游戏的状态，保存玩家的位置、状态、物品等信息，以便后续恢复。
     //2·虚拟现实和增强现实：在这些环境中，世界快照可以帮助记录用户的位置和交互，便于分析和重现体验。
+    const double BroadcastBeginSeconds = FPlatformTime::Seconds();
     WorldObserver.BroadcastTick(*CurrentEpisode, DeltaSeconds, bMapChanged, LightUpdatePending);
+    const double BroadcastEndSeconds = FPlatformTime::Seconds();
     CurrentEpisode->GetSensorManager().PostPhysTick(World, TickType, DeltaSeconds);
+    const double SensorsEndSeconds = FPlatformTime::Seconds();
     ResetSimulationState();
+
+    // 次级服务器：这一帧的传感器已经渲染，通知主服务器
+    if (!bIsPrimaryServer && bFramePlayed && Secondary)
+    {
+      bFramePlayed = false;
+      carla::multigpu::FrameAck Ack;
+      Ack.frame = PlayedFrame;
+      Secondary->Write(carla::Buffer(reinterpret_cast<unsigned char *>(&Ack), (size_t) sizeof(Ack)));
+    }
+
+    FrameTimings.world_tick = FCarlaEngine_ToMilliseconds(PostTickBeginSeconds - PreTickEndSeconds);
+    FrameTimings.post_tick = FCarlaEngine_ToMilliseconds(BroadcastBeginSeconds - PostTickBeginSeconds);
+    FrameTimings.episode_state = FCarlaEngine_ToMilliseconds(BroadcastEndSeconds - BroadcastBeginSeconds);
+    FrameTimings.sensors = FCarlaEngine_ToMilliseconds(SensorsEndSeconds - BroadcastEndSeconds);
+    FrameTimings.server_total = FCarlaEngine_ToMilliseconds(SensorsEndSeconds - FrameTimings.platform_timestamp);
+    if (bIsPrimaryServer && RealTimeScheduler.IsEnabled())
+    {
+      FrameTimings.budget = FCarlaEngine_ToMilliseconds(RealTimeScheduler.GetBudgetSeconds());
+      FrameTimings.realtime_factor = RealTimeScheduler.GetRealTimeFactor();
+      FrameTimings.substeps = RealTimeScheduler.GetSubsteps();
+      FrameTimings.deferred_sensors = CurrentEpisode->GetSensorManager().GetDeferredCount();
+    }
+    Server.RecordFrameTimings(FrameTimings);
+    FCarlaEngine_GetMetrics().Record(FrameTimings, CurrentEpisode->GetSensorManager().GetTickSchedules().Num());
   }
 }
 
@@ -395,7 +613,8 @@ void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
 
   if (GEngine && GEngine->GameViewport)
   {
-    GEngine->GameViewport->bDisableWorldRendering = Settings.bNoRenderingMode;
+    GEngine->GameViewport->bDisableWorldRendering =
+        Settings.bNoRenderingMode || Settings.bPhysicsOnlyMode;
   }
 
   FCarlaEngine_SetFixedDeltaSeconds(Settings.FixedDeltaSeconds);
@@ -406,7 +625,46 @@ void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
   PhysSett->MaxSubstepDeltaTime = Settings.MaxSubstepDeltaTime;
   PhysSett->MaxSubsteps = Settings.MaxSubsteps;
 
+  // 实时因子调度从用户设置的子步长开始，之后只在 OnPreTick 中调整子步长
+  RealTimeScheduler.Configure(Settings);
+  if (!RealTimeScheduler.IsEnabled() && CurrentEpisode != nullptr)
+  {
+    CurrentEpisode->GetSensorManager().SetTickBudget(-1.0f);
+  }
+
+  // 异步子步在物理线程上和游戏线程并行，两者的先后顺序不固定
+  if (Settings.bDeterministicPhysics)
+  {
+    PhysSett->bSubsteppingAsync = false;
+  }
+  // PhysX 只在创建物理场景时读取，修改后要重新加载地图
+  if (PhysSett->bEnableEnhancedDeterminism != Settings.bDeterministicPhysics)
+  {
+    PhysSett->bEnableEnhancedDeterminism = Settings.bDeterministicPhysics;
+    UE_LOG(LogCarla, Log,
+        TEXT("Deterministic physics %s, it takes effect the next time a map is loaded"),
+        Settings.bDeterministicPhysics ? TEXT("enabled") : TEXT("disabled"));
+  }
+
   UWorld* World = CurrentEpisode->GetWorld();
+
+  // 只运行物理时跳过天气的视觉效果和画面外行人的骨骼动画，相机在 FPixelReader 中跳过
+  if (CurrentEpisode->GetWeather() != nullptr)
+  {
+    CurrentEpisode->GetWeather()->SetPhysicsOnlyMode(Settings.bPhysicsOnlyMode);
+  }
+  if (World != nullptr)
+  {
+    for (TActorIterator<AWalkerBase> It(World); It; ++It)
+    {
+      It->SetAnimateOnlyWhenRendered(Settings.bPhysicsOnlyMode);
+    }
+  }
+  if (Settings.bPhysicsOnlyMode && FApp::CanEverRender())
+  {
+    UE_LOG(LogCarla, Log,
+        TEXT("Physics-only mode enabled, start the server with -nullrhi to also skip the renderer"));
+  }
   ALargeMapManager* LargeMapManager = UCarlaStatics::GetLargeMapManager(World);
   if (LargeMapManager)
   {
@@ -12,10 +12,12 @@
 #include "Carla/Settings/EpisodeSettings.h"// EpisodeSettingsض
 #include "Carla/Util/NonCopyable.h"// NonCopyableĶ壬ڽֹ
 #include "Carla/Game/FrameData.h"// FrameDataṹĶ
+#include "Carla/Game/RealTimeScheduler.h"
 
 #include "Misc/CoreDelegates.h" // ίеĶ
 // [/UE4]
 #include <compiler/disable-ue4-macros.h>// Unreal Engine 4ĺ
+#include <carla/BufferPool.h>
 #include <carla/multigpu/router.h>// GPUROS2صCarlaͷļ 
 #include <carla/multigpu/primaryCommands.h>
 #include <carla/multigpu/secondary.h>
@@ -23,6 +25,7 @@
 #include <carla/ros2/ROS2.h>
 #include <compiler/enable-ue4-macros.h>// Unreal Engine 4ĺ
 
+#include <deque>
 #include <mutex>// C++׼mutex࣬߳ͬ
 // [ǰ]
 class UCarlaSettings;// ǰUCarlaSettings 
@@ -113,6 +116,15 @@ private:
 
   FWorldObserver WorldObserver;
 
+  /// ǰ֡׶εʱ䣬 OnPostTick ʱ档
+  carla::rpc::FrameTimings FrameTimings;
+
+  /// OnPreTick ʱƽ̨ʱ䣨룩
+  double PreTickEndSeconds = 0.0;
+
+  ///  FEpisodeSettings::TargetRealTimeFactor ÿһ֡ǽʱ䡣
+  FRealTimeScheduler RealTimeScheduler;
+
   UCarlaEpisode *CurrentEpisode = nullptr;
 
   FEpisodeSettings CurrentSettings;
@@ -133,7 +145,25 @@ private:
   std::shared_ptr<carla::multigpu::Router>    SecondaryServer;
   std::shared_ptr<carla::multigpu::Secondary> Secondary;
 
-  std::vector<FFrameData> FramesToProcess;
+  /// ֱ֡леĻһ֡ĴСԤȷ䡣
+  std::shared_ptr<carla::BufferPool> FrameDataPool = std::make_shared<carla::BufferPool>();
+  size_t FrameDataSize = 4096u;
+
+  /// ϴռμ GPU ֡ʱ䣨ڷôƽ̨ʱ䣨룩
+  double PlacementUpdateSeconds = 0.0;
+
+  /// μ֡-carla-multigpu-lookahead=N0 ʾÿ֡ȴ
+  uint32 MultiGPULookahead = 2u;
+
+  /// ͬģʽ²ʹˮߣÿ֡ȴдμ-carla-multigpu-strict-sync
+  bool bMultiGPUStrictSync = false;
+
+  /// μ֡طŵ֡Ⱦȷϡ
+  uint64_t PlayedFrame = 0u;
+  bool bFramePlayed = false;
+
+  /// ηյ֡ݻ OnPreTick ԭؽطš
+  std::deque<carla::Buffer> FramesToProcess;
   std::mutex FrameToProcessMutex;
 };
 
@@ -11,6 +11,7 @@
 #include <compiler/disable-ue4-macros.h>
 #include <carla/opendrive/OpenDriveParser.h>
 #include <carla/rpc/String.h>
+#include <carla/rpc/WeatherParameters.h>
 #include <compiler/enable-ue4-macros.h>
 
 #include "Carla/Sensor/Sensor.h"
@@ -20,6 +21,13 @@
 #include "Carla/Game/CarlaStatics.h"
 #include "Carla/Game/CarlaStaticDelegates.h"
 #include "Carla/MapGen/LargeMapManager.h"
+#include "Carla/Traffic/TrafficLightGroup.h"
+#include "Carla/Traffic/TrafficLightManager.h"
+
+#include <PxScene.h>
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 
 #include "Engine/StaticMeshActor.h"
 #include "EngineUtils.h"
@@ -124,6 +132,95 @@ bool UCarlaEpisode::LoadNewEpisode(const FString &MapString, bool ResetSettings)
   return bIsFileFound;
 }
 
+void UCarlaEpisode::SoftResetEpisode(bool ResetSettings)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  UE_LOG(LogCarla, Log, TEXT("Resetting the episode without reloading '%s'"), *GetMapName());
+
+  // Keep what belongs to the level, everything else was spawned during the
+  // episode. Sensors and controllers go first so that nothing is destroyed
+  // while its parent is still being used.
+  TArray<FCarlaActor::IdType> Attached;
+  TArray<FCarlaActor::IdType> Spawned;
+  for (auto &Element : GetActorRegistry())
+  {
+    const FCarlaActor *CarlaActor = Element.Value.Get();
+    const FCarlaActor::ActorType Type = CarlaActor->GetActorType();
+    if (Type == FCarlaActor::ActorType::TrafficLight ||
+        Type == FCarlaActor::ActorType::TrafficSign ||
+        (Spectator != nullptr && CarlaActor->GetActor() == Spectator) ||
+        CarlaActor->GetActorInfo()->Description.Id == TEXT("static.prop.mesh"))
+    {
+      continue;
+    }
+    if (Type == FCarlaActor::ActorType::Vehicle || Type == FCarlaActor::ActorType::Walker)
+    {
+      Spawned.Add(Element.Key);
+    }
+    else
+    {
+      Attached.Add(Element.Key);
+    }
+  }
+
+  // The walkers are about to be destroyed together with their controllers.
+  WalkerNavigation.Reset();
+
+  for (FCarlaActor::IdType ActorId : Attached)
+  {
+    DestroyActor(ActorId);
+  }
+  for (FCarlaActor::IdType ActorId : Spawned)
+  {
+    DestroyActor(ActorId);
+  }
+
+  ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode != nullptr)
+  {
+    GameMode->GetTrafficLightManager()->SetFrozen(false);
+  }
+  for (TActorIterator<ATrafficLightGroup> It(GetWorld()); It; ++It)
+  {
+    It->ResetGroup();
+  }
+
+  if (Weather != nullptr)
+  {
+    Weather->ApplyWeather(carla::rpc::WeatherParameters::Default);
+  }
+
+  ElapsedGameTime = 0.0;
+  SetVisualGameTime(0.0);
+
+  if (ResetSettings)
+  {
+    ApplySettings(FEpisodeSettings{});
+  }
+}
+
+uint64 UCarlaEpisode::SaveSnapshot()
+{
+  const uint64 SnapshotId = NextSnapshotId++;
+  FEpisodeSnapshot &Snapshot = Snapshots.Add(SnapshotId);
+  Snapshot.Capture(*this);
+  UE_LOG(LogCarla, Log, TEXT("Saved episode snapshot %llu with %d actors"), SnapshotId, Snapshot.GetNumActors());
+  return SnapshotId;
+}
+
+bool UCarlaEpisode::RestoreSnapshot(uint64 SnapshotId)
+{
+  const FEpisodeSnapshot *Snapshot = Snapshots.Find(SnapshotId);
+  if (Snapshot == nullptr)
+  {
+    return false;
+  }
+  Snapshot->Restore(*this);
+  // The crowd keeps its own copy of the walker positions.
+  WalkerNavigation.RelocateWalkers(*this);
+  return true;
+}
+
 static FString BuildRecastBuilderFile()
 {
   // Define filename with extension depending on if we are on Windows or not
@@ -144,6 +241,45 @@ static FString BuildRecastBuilderFile()
   return AbsoluteRecastBuilderPath;
 }
 
+/// Save the mesh of the whole map as an OBJ for RecastBuilder to @a OBJPath
+/// and launch it if the pedestrian navigation is enabled. Safe to call
+/// outside the game thread.
+static void BuildOpenDriveNavigation(
+    const carla::road::Map &CarlaMap,
+    const carla::rpc::OpendriveGenerationParameters &Params,
+    const FString &OBJPath)
+{
+  // Generate the OBJ (as string)
+  const auto RoadMesh = CarlaMap.GenerateMesh(Params.vertex_distance);
+  const auto CrosswalksMesh = CarlaMap.GetAllCrosswalkMesh();
+  const auto RecastOBJ = (RoadMesh + CrosswalksMesh).GenerateOBJForRecast();
+
+  // Store the OBJ string to a file in order to that RecastBuilder can load it
+  FFileHelper::SaveStringToFile(
+      carla::rpc::ToLongFString(RecastOBJ),
+      *OBJPath,
+      FFileHelper::EEncodingOptions::ForceUTF8,
+      &IFileManager::Get());
+
+  const FString AbsoluteRecastBuilderPath = BuildRecastBuilderFile();
+
+  if (FPaths::FileExists(AbsoluteRecastBuilderPath) &&
+      Params.enable_pedestrian_navigation)
+  {
+    /// @todo this can take too long to finish, clients need a method
+    /// to know if the navigation is available or not.
+    FPlatformProcess::CreateProc(
+        *AbsoluteRecastBuilderPath, *OBJPath,
+        true, true, true, nullptr, 0, nullptr, nullptr);
+  }
+  else
+  {
+    UE_LOG(LogCarla, Warning, TEXT("'RecastBuilder' not present under '%s', "
+        "the binaries for pedestrian navigation will not be created."),
+        *AbsoluteRecastBuilderPath);
+  }
+}
+
 bool UCarlaEpisode::LoadNewOpendriveEpisode(
     const FString &OpenDriveString,
     const carla::rpc::OpendriveGenerationParameters &Params)
@@ -155,7 +291,7 @@ bool UCarlaEpisode::LoadNewOpendriveEpisode(
   }
 
   // Build the Map from the OpenDRIVE data
-  const auto CarlaMap = carla::opendrive::OpenDriveParser::Load(
+  auto CarlaMap = carla::opendrive::OpenDriveParser::Load(
       carla::rpc::FromLongFString(OpenDriveString));
 
   // Check the Map is correclty generated
@@ -165,21 +301,6 @@ bool UCarlaEpisode::LoadNewOpendriveEpisode(
     return false;
   }
 
-  // Generate the OBJ (as string)
-  const auto RoadMesh = CarlaMap->GenerateMesh(Params.vertex_distance);
-  const auto CrosswalksMesh = CarlaMap->GetAllCrosswalkMesh();
-  const auto RecastOBJ = (RoadMesh + CrosswalksMesh).GenerateOBJForRecast();
-
-  const FString AbsoluteOBJPath = FPaths::ConvertRelativePathToFull(
-      FPaths::ProjectContentDir() + "Carla/Maps/Nav/OpenDriveMap.obj");
-
-  // Store the OBJ string to a file in order to that RecastBuilder can load it
-  FFileHelper::SaveStringToFile(
-      carla::rpc::ToLongFString(RecastOBJ),
-      *AbsoluteOBJPath,
-      FFileHelper::EEncodingOptions::ForceUTF8,
-      &IFileManager::Get());
-
   const FString AbsoluteXODRPath = FPaths::ConvertRelativePathToFull(
       FPaths::ProjectContentDir() + "Carla/Maps/OpenDrive/OpenDriveMap.xodr");
 
@@ -206,22 +327,22 @@ bool UCarlaEpisode::LoadNewOpendriveEpisode(
     carla::log_warning("Missing game instance");
   }
 
-  const FString AbsoluteRecastBuilderPath = BuildRecastBuilderFile();
+  const FString AbsoluteOBJPath = FPaths::ConvertRelativePathToFull(
+      FPaths::ProjectContentDir() + "Carla/Maps/Nav/OpenDriveMap.obj");
 
-  if (FPaths::FileExists(AbsoluteRecastBuilderPath) &&
-      Params.enable_pedestrian_navigation)
+  if (Params.enable_mesh_streaming)
   {
-    /// @todo this can take too long to finish, clients need a method
-    /// to know if the navigation is available or not.
-    FPlatformProcess::CreateProc(
-        *AbsoluteRecastBuilderPath, *AbsoluteOBJPath,
-        true, true, true, nullptr, 0, nullptr, nullptr);
+    // The OBJ needs the mesh of the whole map, with streaming it is built in
+    // the background so the new episode does not wait for it
+    auto SharedMap = std::make_shared<carla::road::Map>(std::move(*CarlaMap));
+    Async(EAsyncExecution::Thread, [SharedMap, Params, AbsoluteOBJPath]()
+    {
+      BuildOpenDriveNavigation(*SharedMap, Params, AbsoluteOBJPath);
+    });
   }
   else
   {
-    UE_LOG(LogCarla, Warning, TEXT("'RecastBuilder' not present under '%s', "
-        "the binaries for pedestrian navigation will not be created."),
-        *AbsoluteRecastBuilderPath);
+    BuildOpenDriveNavigation(*CarlaMap, Params, AbsoluteOBJPath);
   }
 
   return true;
@@ -343,6 +464,14 @@ void UCarlaEpisode::InitializeAtBeginPlay()
     UE_LOG(LogCarla, Error, TEXT("Can't find spectator!"));
   }
 
+  // Scenarios that spawn and destroy many actors can recycle them instead.
+  int32 ActorPoolSize = 0;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-carla-actor-pool-size="), ActorPoolSize))
+  {
+    UE_LOG(LogCarla, Log, TEXT("Recycling up to %d destroyed actors per blueprint"), ActorPoolSize);
+    ActorDispatcher->GetActorRegistry().SetActorPoolSize(ActorPoolSize);
+  }
+
   // material parameters collection
   UMaterialParameterCollection *Collection = LoadObject<UMaterialParameterCollection>(nullptr, TEXT("/Game/Carla/Blueprints/Game/CarlaParameters.CarlaParameters"), nullptr, LOAD_None, nullptr);
 	if (Collection != nullptr)
@@ -416,13 +545,13 @@ void UCarlaEpisode::EndPlay(void)
   }
 }
 
-std::string UCarlaEpisode::StartRecorder(std::string Name, bool AdditionalData)
+std::string UCarlaEpisode::StartRecorder(std::string Name, bool AdditionalData, bool Compressed)
 {
   std::string result;
 
   if (Recorder)
   {
-    result = Recorder->Start(Name, MapName, AdditionalData);
+    result = Recorder->Start(Name, MapName, AdditionalData, Compressed);
   }
   else
   {
@@ -432,6 +561,112 @@ std::string UCarlaEpisode::StartRecorder(std::string Name, bool AdditionalData)
   return result;
 }
 
+std::string UCarlaEpisode::StartFlightRecorder(std::string Name, double Seconds, double SecondsAfter,
+    bool AdditionalData, bool Compressed)
+{
+  std::string result;
+
+  if (Recorder)
+  {
+    result = Recorder->StartRing(Name, MapName, Seconds, SecondsAfter, AdditionalData, Compressed);
+  }
+  else
+  {
+    result = "Recorder is not ready";
+  }
+
+  return result;
+}
+
+TArray<bool> UCarlaEpisode::AreSpawnPointsFree(
+    const TArray<FTransform> &Transforms,
+    float Radius) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  TArray<bool> IsFree;
+  IsFree.Init(true, Transforms.Num());
+  UWorld *World = GetWorld();
+  if (Radius <= 0.0f || World == nullptr)
+  {
+    return IsFree;
+  }
+
+  ALargeMapManager* LargeMap = UCarlaStatics::GetLargeMapManager(World);
+  TArray<FVector> Locations;
+  Locations.Reserve(Transforms.Num());
+  for (const FTransform &Transform : Transforms)
+  {
+    Locations.Emplace(LargeMap ?
+        LargeMap->GlobalToLocalTransform(Transform).GetLocation() :
+        Transform.GetLocation());
+  }
+
+  FCollisionObjectQueryParams ObjectParams;
+  ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
+  ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Pawn);
+  ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+  const FCollisionShape Sphere = FCollisionShape::MakeSphere(Radius);
+
+  // Overlap queries against the spawned actors, one task per spawn point.
+  World->GetPhysicsScene()->GetPxScene()->lockRead();
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+    ParallelFor(Locations.Num(), [&](int32 Index) {
+      IsFree[Index] = !World->OverlapAnyTestByObjectType(
+          Locations[Index],
+          FQuat::Identity,
+          ObjectParams,
+          Sphere);
+    });
+  }
+  World->GetPhysicsScene()->GetPxScene()->unlockRead();
+
+  // The spawn points of the list must not overlap each other either, the
+  // first one wins. Bucket them in a grid so only the neighbouring cells are
+  // checked.
+  const float MinDistance = 2.0f * Radius;
+  TMap<FIntVector, TArray<int32>> Grid;
+  for (int32 Index = 0; Index < Locations.Num(); ++Index)
+  {
+    if (!IsFree[Index])
+    {
+      continue;
+    }
+    const FVector &Location = Locations[Index];
+    const FIntVector Cell(
+        FMath::FloorToInt(Location.X / MinDistance),
+        FMath::FloorToInt(Location.Y / MinDistance),
+        FMath::FloorToInt(Location.Z / MinDistance));
+    for (int32 X = -1; X <= 1 && IsFree[Index]; ++X)
+    {
+      for (int32 Y = -1; Y <= 1 && IsFree[Index]; ++Y)
+      {
+        for (int32 Z = -1; Z <= 1 && IsFree[Index]; ++Z)
+        {
+          const TArray<int32> *Others = Grid.Find(Cell + FIntVector(X, Y, Z));
+          if (Others == nullptr)
+          {
+            continue;
+          }
+          for (int32 Other : *Others)
+          {
+            if (FVector::DistSquared(Location, Locations[Other]) < MinDistance * MinDistance)
+            {
+              IsFree[Index] = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (IsFree[Index])
+    {
+      Grid.FindOrAdd(Cell).Add(Index);
+    }
+  }
+  return IsFree;
+}
+
 TPair<EActorSpawnResultStatus, FCarlaActor*> UCarlaEpisode::SpawnActorWithInfo(
     const FTransform &Transform,
     FActorDescription thisActorDescription,
@@ -13,8 +13,10 @@
 #include "Carla/Settings/EpisodeSettings.h"
 #include "Carla/Util/ActorAttacher.h"
 #include "Carla/Weather/Weather.h"
+#include "Carla/Game/EpisodeSnapshot.h"
 #include "Carla/Game/FrameData.h"
 #include "Carla/Sensor/SensorManager.h"
+#include "Carla/Walker/WalkerNavigation.h"
 
 #include "GameFramework/Pawn.h"
 #include "Materials/MaterialParameterCollectionInstance.h"
@@ -65,6 +67,36 @@ public:
       const FString &OpenDriveString,
       const carla::rpc::OpendriveGenerationParameters &Params);
 
+  /// Start over the current episode without reloading the map.
+  ///
+  /// Destroys every actor spawned during the episode, resets the traffic
+  /// lights, the weather and the simulation time. The level, its traffic
+  /// signs, movable props and the navigation mesh stay loaded, and so does
+  /// the episode Id, so the clients stay connected to the same episode.
+  UFUNCTION(BlueprintCallable)
+  void SoftResetEpisode(bool ResetSettings = true);
+
+  // ===========================================================================
+  // -- Episode snapshots ------------------------------------------------------
+  // ===========================================================================
+
+  /// Keep a copy of the current state of the episode in memory, see
+  /// FEpisodeSnapshot.
+  ///
+  /// @return the Id to restore or remove the snapshot.
+  uint64 SaveSnapshot();
+
+  /// Bring the episode back to the state saved in @a SnapshotId. The snapshot
+  /// is kept so that it can be restored again.
+  ///
+  /// @return false if there is no such snapshot.
+  bool RestoreSnapshot(uint64 SnapshotId);
+
+  bool RemoveSnapshot(uint64 SnapshotId)
+  {
+    return Snapshots.Remove(SnapshotId) > 0;
+  }
+
   // ===========================================================================
   // -- Episode settings -------------------------------------------------------
   // ===========================================================================
@@ -192,6 +224,11 @@ public:
     return ActorDispatcher->GetActorRegistry().GetDescriptionFromStream(StreamId);
   }
 
+  const FActorInfo *GetActorInfoFromStream(carla::streaming::detail::stream_id_type StreamId)
+  {
+    return ActorDispatcher->GetActorRegistry().GetActorInfoFromStream(StreamId);
+  }
+
   // ===========================================================================
   // -- Actor handling methods -------------------------------------------------
   // ===========================================================================
@@ -207,6 +244,16 @@ public:
       FActorDescription thisActorDescription,
       FCarlaActor::IdType DesiredId = 0);
 
+  /// Check in parallel whether each of the spawn points in @a Transforms is
+  /// free, i.e. there is no vehicle, walker or physics body within @a Radius
+  /// (in cm) and no previous spawn point of the same list is that close.
+  ///
+  /// @return an array with one entry per spawn point, every entry is true if
+  /// @a Radius is not positive.
+  TArray<bool> AreSpawnPointsFree(
+      const TArray<FTransform> &Transforms,
+      float Radius) const;
+
   /// Spawns an actor based on @a ActorDescription at @a Transform.
   ///
   /// @return the actor to be spawned
@@ -288,6 +335,20 @@ public:
     ActorDispatcher->WakeActorUp(ActorId, this);
   }
 
+  /// Queue @a ActorId to be woken up by WakeQueuedActorsUp in a later frame.
+  void QueueWakeActorUp(carla::rpc::ActorId ActorId)
+  {
+    ActorDispatcher->GetActorRegistry().QueueWakeActorUp(ActorId);
+  }
+
+  /// Wake up the queued actors for at most @a TimeBudget seconds.
+  ///
+  /// @return the actors processed, active if they could be woken up.
+  TArray<FCarlaActor::IdType> WakeQueuedActorsUp(double TimeBudget)
+  {
+    return ActorDispatcher->GetActorRegistry().WakeQueuedActorsUp(this, TimeBudget);
+  }
+
   // ===========================================================================
   // -- Other methods ----------------------------------------------------------
   // ===========================================================================
@@ -318,7 +379,10 @@ public:
     return Recorder->GetReplayer();
   }
 
-  std::string StartRecorder(std::string name, bool AdditionalData);
+  std::string StartRecorder(std::string name, bool AdditionalData, bool Compressed = false);
+
+  std::string StartFlightRecorder(std::string name, double Seconds, double SecondsAfter,
+      bool AdditionalData, bool Compressed = false);
 
   FIntVector GetCurrentMapOrigin() const { return CurrentMapOrigin; }
 
@@ -328,12 +392,15 @@ public:
 
   FSensorManager& GetSensorManager() { return SensorManager; }
 
+  FWalkerNavigation& GetWalkerNavigation() { return WalkerNavigation; }
+
   bool bIsPrimaryServer = true;
 
 private:
 
   friend class ACarlaGameModeBase;
   friend class FCarlaEngine;
+  friend class FEpisodeSnapshot;
 
   void InitializeAtBeginPlay();
 
@@ -344,6 +411,13 @@ private:
     ActorDispatcher->Bind(ActorFactory);
   }
 
+  /// Register @a ActorFactory with @a Definitions, already validated, instead
+  /// of the ones it generates.
+  void RegisterActorFactory(ACarlaActorFactory &ActorFactory, const TArray<FActorDefinition> &Definitions)
+  {
+    ActorDispatcher->BindValidated(ActorFactory, Definitions);
+  }
+
   std::pair<int, FCarlaActor&> TryToCreateReplayerActor(
     FVector &Location,
     FVector &Rotation,
@@ -403,6 +477,12 @@ private:
   FFrameData FrameData;
 
   FSensorManager SensorManager;
+
+  FWalkerNavigation WalkerNavigation;
+
+  TMap<uint64, FEpisodeSnapshot> Snapshots;
+
+  uint64 NextSnapshotId = 1u;
 };
 
 FString CarlaGetRelevantTagAsString(const TSet<crp::CityObjectLabel> &SemanticTags);
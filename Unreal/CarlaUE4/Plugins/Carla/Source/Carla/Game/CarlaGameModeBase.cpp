@@ -6,6 +6,8 @@
 
 #include "Carla.h"
 #include "Carla/Game/CarlaGameModeBase.h"
+#include "Carla/Actor/ActorDefinitionCache.h"
+#include "Carla/Actor/ActorDispatcher.h"
 #include "Carla/Game/CarlaHUD.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "Carla/Game/CarlaStaticDelegates.h"
@@ -18,6 +20,8 @@
 #include "Vehicle/VehicleSpawnPoint.h"
 #include "Util/BoundingBoxCalculator.h"
 #include "EngineUtils.h"
+#include "Engine/LatentActionManager.h"
+#include "LatentActions.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/opendrive/OpenDriveParser.h"
@@ -401,6 +405,7 @@ void ACarlaGameModeBase::SpawnActorFactories()
   auto *World = GetWorld();
   check(World != nullptr);
 
+  TArray<ACarlaActorFactory *> Factories;
   for (auto &FactoryClass : ActorFactories)
   {
     if (FactoryClass != nullptr)
@@ -408,7 +413,7 @@ void ACarlaGameModeBase::SpawnActorFactories()
       auto *Factory = World->SpawnActor<ACarlaActorFactory>(FactoryClass);
       if (Factory != nullptr)
       {
-        Episode->RegisterActorFactory(*Factory);
+        Factories.Add(Factory);
         ActorFactoryInstances.Add(Factory);
       }
       else
@@ -417,6 +422,40 @@ void ACarlaGameModeBase::SpawnActorFactories()
       }
     }
   }
+
+  // Generating the definitions runs the blueprints of the factories, reuse
+  // the ones of a previous run if the content did not change.
+  const bool bUseCache = FActorDefinitionCache::IsEnabled();
+  const FString CachePath = FActorDefinitionCache::GetDefaultPath();
+  FActorDefinitionCache Cache;
+  const uint32 ContentVersion = bUseCache ? FActorDefinitionCache::ComputeContentVersion(Factories) : 0u;
+  if (bUseCache)
+  {
+    Cache.Load(CachePath, ContentVersion);
+  }
+  bool bCacheChanged = false;
+  for (ACarlaActorFactory *Factory : Factories)
+  {
+    const TArray<FActorDefinition> *Cached = Cache.Find(*Factory);
+    if (Cached != nullptr)
+    {
+      Episode->RegisterActorFactory(*Factory, *Cached);
+      continue;
+    }
+    TArray<FActorDefinition> Definitions =
+        UActorDispatcher::FilterValidDefinitions(Factory->GetDefinitions());
+    Episode->RegisterActorFactory(*Factory, Definitions);
+    Cache.Add(*Factory, MoveTemp(Definitions));
+    bCacheChanged = true;
+  }
+  if (bUseCache && bCacheChanged)
+  {
+    Cache.ContentVersion = ContentVersion;
+    if (!Cache.Save(CachePath))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Failed to save the actor definition cache to %s"), *CachePath);
+    }
+  }
 }
 
 void ACarlaGameModeBase::StoreSpawnPoints()
@@ -428,7 +467,14 @@ void ACarlaGameModeBase::StoreSpawnPoints()
 
   if(SpawnPointsTransforms.Num() == 0)
   {
-    GenerateSpawnPoints();
+    if (bStartupCacheLoaded && StartupCache.SpawnPoints.Num() > 0)
+    {
+      SpawnPointsTransforms = StartupCache.SpawnPoints;
+    }
+    else
+    {
+      GenerateSpawnPoints();
+    }
   }
 
   UE_LOG(LogCarla, Log, TEXT("There are %d SpawnPoints in the map"), SpawnPointsTransforms.Num());
@@ -437,20 +483,13 @@ void ACarlaGameModeBase::StoreSpawnPoints()
 void ACarlaGameModeBase::GenerateSpawnPoints()
 {
   UE_LOG(LogCarla, Log, TEXT("Generating SpawnPoints ..."));
-  std::vector<std::pair<carla::road::element::Waypoint, carla::road::element::Waypoint>> Topology = Map->GenerateTopology();
-  UWorld* World = GetWorld();
-  for(auto& Pair : Topology)
-  {
-    carla::geom::Transform CarlaTransform = Map->ComputeTransform(Pair.first);
-    FTransform Transform(CarlaTransform);
-    Transform.AddToTranslation(FVector(0.f, 0.f, 50.0f));
-    SpawnPointsTransforms.Add(Transform);
-  }
+  SpawnPointsTransforms.Append(FMapStartupCache::ComputeSpawnPoints(*Map));
 }
 
 void ACarlaGameModeBase::ParseOpenDrive()
 {
-  std::string opendrive_xml = carla::rpc::FromLongFString(UOpenDrive::GetXODR(GetWorld()));
+  const FString XODRContent = UOpenDrive::GetXODR(GetWorld());
+  std::string opendrive_xml = carla::rpc::FromLongFString(XODRContent);
   Map = carla::opendrive::OpenDriveParser::Load(opendrive_xml);
   if (!Map.has_value()) {
     UE_LOG(LogCarla, Error, TEXT("Invalid Map"));
@@ -458,6 +497,19 @@ void ACarlaGameModeBase::ParseOpenDrive()
   else
   {
     Episode->MapGeoReference = Map->GetGeoReference();
+    LoadStartupCache(XODRContent);
+  }
+}
+
+void ACarlaGameModeBase::LoadStartupCache(const FString &XODRContent)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaGameModeBase::LoadStartupCache);
+  const FString FilePath = FMapStartupCache::GetDefaultPath(Episode->MapName);
+  bStartupCacheLoaded = StartupCache.Load(FilePath, FMapStartupCache::HashOpenDrive(XODRContent));
+  if (bStartupCacheLoaded)
+  {
+    UE_LOG(LogCarla, Log, TEXT("Loaded map startup cache %s"), *FilePath);
+    ATagger::AddTagTableEntries(StartupCache.MeshLabels);
   }
 }
 
@@ -664,7 +716,7 @@ void ACarlaGameModeBase::LoadMapLayer(int32 MapLayers)
   LatentInfo.Linkage = 0;
   LatentInfo.UUID = LatentInfoUUID;
 
-  PendingLevelsToLoad = LevelsToLoad.Num();
+  PendingLevelsToLoad += LevelsToLoad.Num();
 
   for(FName& LevelName : LevelsToLoad)
   {
@@ -688,7 +740,7 @@ void ACarlaGameModeBase::UnLoadMapLayer(int32 MapLayers)
   LatentInfo.UUID = LatentInfoUUID;
   LatentInfo.Linkage = 0;
 
-  PendingLevelsToUnLoad = LevelsToUnLoad.Num();
+  PendingLevelsToUnLoad += LevelsToUnLoad.Num();
 
   for(FName& LevelName : LevelsToUnLoad)
   {
@@ -700,6 +752,80 @@ void ACarlaGameModeBase::UnLoadMapLayer(int32 MapLayers)
 
 }
 
+uint64 ACarlaGameModeBase::LoadMapLayerAsync(int32 MapLayers)
+{
+  return StartMapLayerRequest(MapLayers, true);
+}
+
+uint64 ACarlaGameModeBase::UnLoadMapLayerAsync(int32 MapLayers)
+{
+  return StartMapLayerRequest(MapLayers, false);
+}
+
+uint64 ACarlaGameModeBase::StartMapLayerRequest(int32 MapLayers, bool bLoad)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaGameModeBase::StartMapLayerRequest);
+  const UWorld* World = GetWorld();
+
+  TArray<FName> Levels;
+  ConvertMapLayerMaskToMapNames(MapLayers, Levels);
+
+  FLatentActionInfo LatentInfo;
+  LatentInfo.CallbackTarget = this;
+  LatentInfo.ExecutionFunction = bLoad ? "OnLoadStreamLevel" : "OnUnloadStreamLevel";
+  LatentInfo.Linkage = 0;
+
+  FMapLayerRequest Request;
+  Request.bLoad = bLoad;
+  (bLoad ? PendingLevelsToLoad : PendingLevelsToUnLoad) += Levels.Num();
+
+  // Neither blocks on the load nor flushes the streaming, the levels are
+  // loaded, made visible or removed over the next frames.
+  for(FName& LevelName : Levels)
+  {
+    LatentInfo.UUID = LatentInfoUUID++;
+    Request.LatentActionUUIDs.Add(LatentInfo.UUID);
+    if(bLoad)
+    {
+      UGameplayStatics::LoadStreamLevel(World, LevelName, true, false, LatentInfo);
+    }
+    else
+    {
+      UGameplayStatics::UnloadStreamLevel(World, LevelName, LatentInfo, false);
+    }
+  }
+
+  const uint64 Id = ++MapLayerRequestCounter;
+  MapLayerRequests.Emplace(Id, MoveTemp(Request));
+  return Id;
+}
+
+bool ACarlaGameModeBase::IsMapLayerRequestDone(uint64 Id)
+{
+  const FMapLayerRequest* Request = MapLayerRequests.Find(Id);
+  if(Request == nullptr)
+  {
+    return true;
+  }
+
+  // The objects are registered again once no level is pending
+  if((Request->bLoad ? PendingLevelsToLoad : PendingLevelsToUnLoad) > 0)
+  {
+    return false;
+  }
+  FLatentActionManager& LatentActionManager = GetWorld()->GetLatentActionManager();
+  for(const int32 UUID : Request->LatentActionUUIDs)
+  {
+    if(LatentActionManager.FindExistingAction<FPendingLatentAction>(this, UUID) != nullptr)
+    {
+      return false;
+    }
+  }
+
+  MapLayerRequests.Remove(Id);
+  return true;
+}
+
 void ACarlaGameModeBase::ConvertMapLayerMaskToMapNames(int32 MapLayer, TArray<FName>& OutLevelNames)
 {
   UWorld* World = GetWorld();
@@ -18,6 +18,7 @@
 #include "Carla/Actor/CarlaActorFactory.h"
 #include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Game/CarlaGameInstance.h"
+#include "Carla/Game/MapStartupCache.h"
 #include "Carla/Game/TaggerDelegate.h"
 #include "Carla/OpenDrive/OpenDrive.h"
 #include "Carla/Recorder/CarlaRecorder.h"
@@ -66,6 +67,12 @@ public:
     return SpawnPointsTransforms;
   }
 
+  /// Cache baked for the current map and OpenDRIVE, nullptr if there is none.
+  const FMapStartupCache *GetStartupCache() const
+  {
+    return bStartupCacheLoaded ? &StartupCache : nullptr;
+  }
+
   UFUNCTION(Category = "Carla Game Mode", BlueprintCallable, CallInEditor, Exec)
   TArray<FBoundingBox> GetAllBBsOfLevel(uint8 TagQueried = 0xFF) const;
 
@@ -75,6 +82,21 @@ public:
     return ObjectRegister->GetEnvironmentObjects(QueriedTag);
   }
 
+  /// Environment objects within @a Radius (cm) of @a Center, in local
+  /// coordinates.
+  TArray<FEnvironmentObject> GetEnvironmentObjectsInRadius(
+      const FVector& Center,
+      float Radius,
+      uint8 QueriedTag = 0xFF) const
+  {
+    return ObjectRegister->GetEnvironmentObjectsInRadius(Center, Radius, QueriedTag);
+  }
+
+  UObjectRegister* GetObjectRegister() const
+  {
+    return ObjectRegister;
+  }
+
   void EnableEnvironmentObjects(const TSet<uint64>& EnvObjectIds, bool Enable);
 
   void EnableOverlapEvents();
@@ -87,6 +109,19 @@ public:
   UFUNCTION(Category = "Carla Game Mode", BlueprintCallable, CallInEditor, Exec)
   void UnLoadMapLayer(int32 MapLayers);
 
+  /// Starts streaming in the levels of @a MapLayers without blocking the game
+  /// thread, the engine time-slices the loading over the next frames. Returns
+  /// the id to pass to IsMapLayerRequestDone.
+  uint64 LoadMapLayerAsync(int32 MapLayers);
+
+  /// Same as LoadMapLayerAsync, but streams out the levels of @a MapLayers.
+  uint64 UnLoadMapLayerAsync(int32 MapLayers);
+
+  /// Whether the levels of the request @a Id are done and the environment
+  /// objects registered again. Overlapping requests finish together. Unknown
+  /// ids, e.g. of a previous map, are done.
+  bool IsMapLayerRequestDone(uint64 Id);
+
   UFUNCTION(Category = "Carla Game Mode")
   ULevel* GetULevelFromName(FString LevelName);
 
@@ -138,6 +173,9 @@ private:
 
   void ParseOpenDrive();
 
+  /// Load the startup cache baked for the current map and @a XODRContent.
+  void LoadStartupCache(const FString &XODRContent);
+
   void RegisterEnvironmentObjects();
 
   void ConvertMapLayerMaskToMapNames(int32 MapLayer, TArray<FName>& OutLevelNames);
@@ -187,6 +225,10 @@ private:
 
   boost::optional<carla::road::Map> Map;
 
+  FMapStartupCache StartupCache;
+
+  bool bStartupCacheLoaded = false;
+
   int PendingLevelsToLoad = 0;
   int PendingLevelsToUnLoad = 0;
 
@@ -196,4 +238,18 @@ private:
   // in the same tick
   int32 LatentInfoUUID = 0;
 
+  struct FMapLayerRequest
+  {
+    /// UUIDs of the latent actions streaming each level.
+    TArray<int32> LatentActionUUIDs;
+
+    bool bLoad = true;
+  };
+
+  uint64 StartMapLayerRequest(int32 MapLayers, bool bLoad);
+
+  TMap<uint64, FMapLayerRequest> MapLayerRequests;
+
+  uint64 MapLayerRequestCounter = 0u;
+
 };
@@ -0,0 +1,224 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/EpisodeSnapshot.h"
+
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Traffic/TrafficLightController.h"
+#include "Carla/Traffic/TrafficLightGroup.h"
+
+#include "EngineUtils.h"
+
+static bool FEpisodeSnapshot_IsLevelActor(const FCarlaActor &CarlaActor)
+{
+  // Traffic lights and signs are never spawned nor destroyed by the clients,
+  // the traffic light groups hold their state.
+  const FCarlaActor::ActorType Type = CarlaActor.GetActorType();
+  return Type == FCarlaActor::ActorType::TrafficLight ||
+         Type == FCarlaActor::ActorType::TrafficSign;
+}
+
+void FEpisodeSnapshot::Capture(UCarlaEpisode &Episode)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  Actors.Reset();
+  TrafficLightGroups.Reset();
+
+  FActorRegistry &Registry = Episode.GetActorRegistry();
+
+  TFunction<void(FCarlaActor &)> AddActor = [&](FCarlaActor &CarlaActor)
+  {
+    FActorState &State = Actors.AddDefaulted_GetRef();
+    State.Id = CarlaActor.GetActorId();
+    State.Type = CarlaActor.GetActorType();
+    State.ParentId = CarlaActor.GetParent();
+    State.Attachment = CarlaActor.GetAttachmentType();
+    State.Description = CarlaActor.GetActorInfo()->Description;
+    State.Transform = CarlaActor.GetActorGlobalTransform();
+    State.Velocity = CarlaActor.GetActorVelocity();
+    State.AngularVelocity = CarlaActor.GetActorAngularVelocity();
+    if (State.Type == FCarlaActor::ActorType::Vehicle)
+    {
+      CarlaActor.GetVehicleControl(State.VehicleControl);
+      CarlaActor.GetVehicleLightState(State.VehicleLightState);
+    }
+    else if (State.Type == FCarlaActor::ActorType::Walker)
+    {
+      CarlaActor.GetWalkerControl(State.WalkerControl);
+    }
+
+    for (FCarlaActor::IdType ChildId : CarlaActor.GetChildren())
+    {
+      FCarlaActor *Child = Registry.FindCarlaActor(ChildId);
+      if (Child != nullptr)
+      {
+        AddActor(*Child);
+      }
+    }
+  };
+
+  for (auto &Element : Registry)
+  {
+    FCarlaActor *CarlaActor = Element.Value.Get();
+    if (FEpisodeSnapshot_IsLevelActor(*CarlaActor) ||
+        Registry.FindCarlaActor(CarlaActor->GetParent()) != nullptr)
+    {
+      continue;
+    }
+    AddActor(*CarlaActor);
+  }
+
+  for (TActorIterator<ATrafficLightGroup> It(Episode.GetWorld()); It; ++It)
+  {
+    FTrafficLightGroupState &GroupState = TrafficLightGroups.AddDefaulted_GetRef();
+    GroupState.Group = *It;
+    GroupState.bIsFrozen = It->IsFrozen();
+    GroupState.CurrentController = It->GetCurrentControllerIndex();
+    for (const UTrafficLightController *Controller : It->GetControllers())
+    {
+      FTrafficLightControllerState &ControllerState = GroupState.Controllers.AddDefaulted_GetRef();
+      ControllerState.StateIndex = Controller->GetCurrentStateIndex();
+      ControllerState.ElapsedTime = Controller->GetElapsedTime();
+      ControllerState.LightState = Controller->GetCurrentLightState();
+    }
+  }
+
+  const AWeather *EpisodeWeather = Episode.GetWeather();
+  bHasWeather = EpisodeWeather != nullptr;
+  if (bHasWeather)
+  {
+    Weather = EpisodeWeather->GetCurrentWeather();
+  }
+
+  ElapsedGameTime = Episode.ElapsedGameTime;
+  VisualGameTime = Episode.VisualGameTime;
+}
+
+void FEpisodeSnapshot::Restore(UCarlaEpisode &Episode) const
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  RestoreActors(Episode);
+  RestoreTrafficLights();
+
+  AWeather *EpisodeWeather = Episode.GetWeather();
+  if (bHasWeather && EpisodeWeather != nullptr)
+  {
+    EpisodeWeather->ApplyWeather(Weather);
+  }
+
+  Episode.ElapsedGameTime = ElapsedGameTime;
+  Episode.SetVisualGameTime(VisualGameTime);
+}
+
+void FEpisodeSnapshot::RestoreActors(UCarlaEpisode &Episode) const
+{
+  TSet<FCarlaActor::IdType> Captured;
+  Captured.Reserve(Actors.Num());
+  for (const FActorState &State : Actors)
+  {
+    Captured.Add(State.Id);
+  }
+
+  // Destroy the actors spawned after the capture, the attached ones first.
+  TArray<FCarlaActor::IdType> Attached;
+  TArray<FCarlaActor::IdType> Spawned;
+  for (auto &Element : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *CarlaActor = Element.Value.Get();
+    if (FEpisodeSnapshot_IsLevelActor(*CarlaActor) || Captured.Contains(Element.Key))
+    {
+      continue;
+    }
+    (CarlaActor->GetParent() != 0u ? Attached : Spawned).Add(Element.Key);
+  }
+  for (FCarlaActor::IdType ActorId : Attached)
+  {
+    Episode.DestroyActor(ActorId);
+  }
+  for (FCarlaActor::IdType ActorId : Spawned)
+  {
+    Episode.DestroyActor(ActorId);
+  }
+
+  for (const FActorState &State : Actors)
+  {
+    FCarlaActor *CarlaActor = Episode.FindCarlaActor(State.Id);
+    if (CarlaActor == nullptr)
+    {
+      // Destroyed after the capture, spawn it again with the same Id.
+      auto Result = Episode.SpawnActorWithInfo(State.Transform, State.Description, State.Id);
+      if (Result.Key != EActorSpawnResultStatus::Success)
+      {
+        UE_LOG(LogCarla, Warning, TEXT("FEpisodeSnapshot: failed to respawn actor %u (%s)"),
+            State.Id, *State.Description.Id);
+        continue;
+      }
+      CarlaActor = Result.Value;
+
+      // Parents come first, so the parent has been restored already.
+      FCarlaActor *Parent = Episode.FindCarlaActor(State.ParentId);
+      if (Parent != nullptr)
+      {
+        CarlaActor->SetParent(State.ParentId);
+        CarlaActor->SetAttachmentType(State.Attachment);
+        Parent->AddChildren(CarlaActor->GetActorId());
+        if (!Parent->IsDormant())
+        {
+          Episode.AttachActors(
+              CarlaActor->GetActor(),
+              Parent->GetActor(),
+              static_cast<EAttachmentType>(State.Attachment));
+        }
+        else
+        {
+          Episode.PutActorToSleep(CarlaActor->GetActorId());
+        }
+      }
+    }
+
+    // Attached actors follow their parent.
+    if (State.ParentId == 0u)
+    {
+      CarlaActor->SetActorGlobalTransform(State.Transform, ETeleportType::TeleportPhysics);
+      CarlaActor->SetActorTargetVelocity(State.Velocity);
+      CarlaActor->SetActorTargetAngularVelocity(State.AngularVelocity);
+    }
+
+    if (State.Type == FCarlaActor::ActorType::Vehicle)
+    {
+      CarlaActor->ApplyControlToVehicle(State.VehicleControl, EVehicleInputPriority::Client);
+      CarlaActor->SetVehicleLightState(State.VehicleLightState);
+    }
+    else if (State.Type == FCarlaActor::ActorType::Walker)
+    {
+      CarlaActor->ApplyControlToWalker(State.WalkerControl);
+    }
+  }
+}
+
+void FEpisodeSnapshot::RestoreTrafficLights() const
+{
+  for (const FTrafficLightGroupState &GroupState : TrafficLightGroups)
+  {
+    ATrafficLightGroup *Group = GroupState.Group.Get();
+    if (Group == nullptr)
+    {
+      continue;
+    }
+    Group->SetFrozenGroup(GroupState.bIsFrozen);
+    Group->SetCurrentControllerIndex(GroupState.CurrentController);
+    TArray<UTrafficLightController *> &Controllers = Group->GetControllers();
+    const int32 Num = FMath::Min(Controllers.Num(), GroupState.Controllers.Num());
+    for (int32 i = 0; i < Num; ++i)
+    {
+      const FTrafficLightControllerState &ControllerState = GroupState.Controllers[i];
+      Controllers[i]->SetCurrentStateIndex(ControllerState.StateIndex);
+      Controllers[i]->SetElapsedTime(ControllerState.ElapsedTime);
+      Controllers[i]->SetTrafficLightsState(ControllerState.LightState);
+    }
+  }
+}
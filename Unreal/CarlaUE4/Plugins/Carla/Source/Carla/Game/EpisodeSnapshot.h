@@ -0,0 +1,110 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Actor/ActorDescription.h"
+#include "Carla/Actor/CarlaActor.h"
+#include "Carla/Vehicle/VehicleControl.h"
+#include "Carla/Vehicle/VehicleLightState.h"
+#include "Carla/Walker/WalkerControl.h"
+#include "Carla/Traffic/TrafficLightState.h"
+#include "Carla/Weather/WeatherParameters.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/AttachmentType.h>
+#include <compiler/enable-ue4-macros.h>
+
+class UCarlaEpisode;
+class ATrafficLightGroup;
+
+/// In-memory copy of the state of an episode, used to branch many variants
+/// of a scenario from the same starting point without simulating it again.
+///
+/// Restoring it destroys the actors spawned after the capture, respawns with
+/// the same Id the ones destroyed since, and puts back the transforms,
+/// velocities and controls of the actors, the cycle of every traffic light
+/// group, the weather and the simulation time. The episode and the frame
+/// counter are not changed, so the clients keep working on the same episode.
+class FEpisodeSnapshot
+{
+public:
+
+  /// Capture the current state of @a Episode.
+  void Capture(UCarlaEpisode &Episode);
+
+  /// Bring @a Episode back to the captured state.
+  void Restore(UCarlaEpisode &Episode) const;
+
+  int32 GetNumActors() const
+  {
+    return Actors.Num();
+  }
+
+private:
+
+  struct FActorState
+  {
+    FCarlaActor::IdType Id = 0u;
+
+    FCarlaActor::ActorType Type = FCarlaActor::ActorType::INVALID;
+
+    FCarlaActor::IdType ParentId = 0u;
+
+    carla::rpc::AttachmentType Attachment = carla::rpc::AttachmentType::INVALID;
+
+    FActorDescription Description;
+
+    FTransform Transform;
+
+    FVector Velocity = FVector::ZeroVector;
+
+    FVector AngularVelocity = FVector::ZeroVector;
+
+    FVehicleControl VehicleControl;
+
+    FVehicleLightState VehicleLightState;
+
+    FWalkerControl WalkerControl;
+  };
+
+  struct FTrafficLightControllerState
+  {
+    int StateIndex = 0;
+
+    float ElapsedTime = 0.0f;
+
+    ETrafficLightState LightState = ETrafficLightState::Green;
+  };
+
+  struct FTrafficLightGroupState
+  {
+    TWeakObjectPtr<ATrafficLightGroup> Group;
+
+    bool bIsFrozen = false;
+
+    int CurrentController = 0;
+
+    TArray<FTrafficLightControllerState> Controllers;
+  };
+
+  void RestoreActors(UCarlaEpisode &Episode) const;
+
+  void RestoreTrafficLights() const;
+
+  /// Parents always come before their children.
+  TArray<FActorState> Actors;
+
+  TArray<FTrafficLightGroupState> TrafficLightGroups;
+
+  FWeatherParameters Weather;
+
+  bool bHasWeather = false;
+
+  double ElapsedGameTime = 0.0;
+
+  double VisualGameTime = 0.0;
+};
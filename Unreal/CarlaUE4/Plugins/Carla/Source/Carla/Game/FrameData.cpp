@@ -19,6 +19,130 @@
 #include "carla/rpc/VehicleLightState.h"
 #include <compiler/enable-ue4-macros.h>
 
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  // std::streambuf writing straight into a carla::Buffer, the buffer grows
+  // when needed and the position can be moved back to patch packet sizes
+  class FFrameData_OutputBuffer : public std::streambuf
+  {
+  public:
+
+    explicit FFrameData_OutputBuffer(carla::Buffer &InBuffer) : Buffer(InBuffer)
+    {
+      MoveTo(0u);
+    }
+
+    // bytes written
+    size_t GetSize() const
+    {
+      return std::max(Size, GetPosition());
+    }
+
+  protected:
+
+    int_type overflow(int_type Char) override
+    {
+      if (traits_type::eq_int_type(Char, traits_type::eof()))
+      {
+        return traits_type::not_eof(Char);
+      }
+      Grow(GetPosition() + 1u);
+      *pptr() = traits_type::to_char_type(Char);
+      pbump(1);
+      return Char;
+    }
+
+    std::streamsize xsputn(const char *Data, std::streamsize Count) override
+    {
+      const size_t Position = GetPosition();
+      if (static_cast<std::streamsize>(epptr() - pptr()) < Count)
+      {
+        Grow(Position + static_cast<size_t>(Count));
+      }
+      std::memcpy(pptr(), Data, static_cast<size_t>(Count));
+      MoveTo(Position + static_cast<size_t>(Count));
+      return Count;
+    }
+
+    pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override
+    {
+      if (!(Which & std::ios_base::out))
+      {
+        return pos_type(off_type(-1));
+      }
+      const off_type Base =
+          (Dir == std::ios_base::beg) ? 0 :
+          (Dir == std::ios_base::cur) ? static_cast<off_type>(GetPosition()) :
+          static_cast<off_type>(GetSize());
+      const off_type Target = Base + Offset;
+      if (Target < 0 || Target > static_cast<off_type>(GetSize()))
+      {
+        return pos_type(off_type(-1));
+      }
+      MoveTo(static_cast<size_t>(Target));
+      return pos_type(Target);
+    }
+
+    pos_type seekpos(pos_type Position, std::ios_base::openmode Which) override
+    {
+      return seekoff(off_type(Position), std::ios_base::beg, Which);
+    }
+
+  private:
+
+    size_t GetPosition() const
+    {
+      return static_cast<size_t>(pptr() - pbase());
+    }
+
+    void MoveTo(size_t Position)
+    {
+      Size = GetSize();
+      SetPosition(Position);
+    }
+
+    void SetPosition(size_t Position)
+    {
+      char *Begin = reinterpret_cast<char *>(Buffer.data());
+      setp(Begin, Begin + Buffer.size());
+      pbump(static_cast<int>(Position));
+    }
+
+    void Grow(size_t MinSize)
+    {
+      const size_t Position = GetPosition();
+      Size = GetSize();
+      // keeps the bytes written
+      Buffer.resize(std::max<size_t>(MinSize, 2u * Buffer.size()));
+      SetPosition(Position);
+    }
+
+    carla::Buffer &Buffer;
+
+    // furthest position written, the current one can be behind
+    size_t Size { 0u };
+  };
+
+  // std::streambuf reading memory in place
+  class FFrameData_InputBuffer : public std::streambuf
+  {
+  public:
+
+    FFrameData_InputBuffer(const char *Begin, const char *End)
+    {
+      setg(const_cast<char *>(Begin), const_cast<char *>(Begin), const_cast<char *>(End));
+    }
+
+    size_t GetConsumed() const
+    {
+      return static_cast<size_t>(gptr() - eback());
+    }
+  };
+}
+
 
 void FFrameData::GetFrameData(UCarlaEpisode *ThisEpisode, bool bAdditionalData, bool bIncludeActorsAgain)
 {
@@ -229,77 +353,133 @@ void FFrameData::Read(std::istream& InStream)
     Header header;
     ReadValue<char>(InStream, header.Id);
     ReadValue<uint32_t>(InStream, header.Size);
-    switch (header.Id)
+    if (!ReadPacket(header.Id, InStream))
     {
-      // events add
-      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
-        EventsAdd.Read(InStream);
-        break;
-
-      // events del
-      case static_cast<char>(CarlaRecorderPacketId::EventDel):
-        EventsDel.Read(InStream);
-        break;
+      // unknown packet, just skip
+      InStream.seekg(header.Size, std::ios::cur);
+    }
+  }
+}
 
-      // events parent
-      case static_cast<char>(CarlaRecorderPacketId::EventParent):
-        EventsParent.Read(InStream);
-        break;
+void FFrameData::Write(carla::Buffer& OutBuffer)
+{
+  FFrameData_OutputBuffer StreamBuffer(OutBuffer);
+  std::ostream OutStream(&StreamBuffer);
+  Write(OutStream);
+  OutBuffer.resize(StreamBuffer.GetSize());
+}
 
-      // positions
+void FFrameData::Read(const carla::Buffer& InBuffer)
+{
+  Clear();
+  const char *Data = reinterpret_cast<const char *>(InBuffer.data());
+  const size_t Size = InBuffer.size();
+  size_t Offset = 0u;
+  while (Offset + sizeof(Header) <= Size)
+  {
+    Header header;
+    std::memcpy(&header, Data + Offset, sizeof(Header));
+    Offset += sizeof(Header);
+    switch (header.Id)
+    {
+      // plain arrays, copied as they are
       case static_cast<char>(CarlaRecorderPacketId::Position):
-        Positions.Read(InStream);
-        break;
-
-      // states
-      case static_cast<char>(CarlaRecorderPacketId::State):
-        States.Read(InStream);
+        Offset += Positions.Read(Data + Offset, Size - Offset);
         break;
 
-      // vehicle animation
-      case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
-        Vehicles.Read(InStream);
-        break;
-
-      // walker animation
       case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
-        Walkers.Read(InStream);
-        break;
-
-      // walker animation
-      case static_cast<char>(CarlaRecorderPacketId::AnimVehicleWheels):
-        Wheels.Read(InStream);
+        Offset += Walkers.Read(Data + Offset, Size - Offset);
         break;
 
-      // walker animation
-      case static_cast<char>(CarlaRecorderPacketId::AnimBiker):
-        Bikers.Read(InStream);
-        break;
-
-      // vehicle light animation
-      case static_cast<char>(CarlaRecorderPacketId::VehicleLight):
-        LightVehicles.Read(InStream);
-        break;
-
-      // scene lights animation
-      case static_cast<char>(CarlaRecorderPacketId::SceneLight):
-        LightScenes.Read(InStream);
-        break;
-
-      case static_cast<char>(CarlaRecorderPacketId::FrameCounter):
-        FrameCounter.Read(InStream);
-        break;
-
-      // unknown packet, just skip
+      // the rest is read record by record from the same memory (not all the
+      // packets write their real size, so the bytes used are counted)
       default:
-        // skip packet
-        InStream.seekg(header.Size, std::ios::cur);
+      {
+        FFrameData_InputBuffer StreamBuffer(Data + Offset, Data + Size);
+        std::istream InStream(&StreamBuffer);
+        if (ReadPacket(header.Id, InStream))
+        {
+          Offset += StreamBuffer.GetConsumed();
+        }
+        else
+        {
+          // unknown packet, just skip
+          Offset += header.Size;
+        }
         break;
-
+      }
     }
   }
 }
 
+bool FFrameData::ReadPacket(char Id, std::istream& InStream)
+{
+  switch (Id)
+  {
+    // events add
+    case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+      EventsAdd.Read(InStream);
+      return true;
+
+    // events del
+    case static_cast<char>(CarlaRecorderPacketId::EventDel):
+      EventsDel.Read(InStream);
+      return true;
+
+    // events parent
+    case static_cast<char>(CarlaRecorderPacketId::EventParent):
+      EventsParent.Read(InStream);
+      return true;
+
+    // positions
+    case static_cast<char>(CarlaRecorderPacketId::Position):
+      Positions.Read(InStream);
+      return true;
+
+    // states
+    case static_cast<char>(CarlaRecorderPacketId::State):
+      States.Read(InStream);
+      return true;
+
+    // vehicle animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimVehicle):
+      Vehicles.Read(InStream);
+      return true;
+
+    // walker animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimWalker):
+      Walkers.Read(InStream);
+      return true;
+
+    // vehicle wheels animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimVehicleWheels):
+      Wheels.Read(InStream);
+      return true;
+
+    // biker animation
+    case static_cast<char>(CarlaRecorderPacketId::AnimBiker):
+      Bikers.Read(InStream);
+      return true;
+
+    // vehicle light animation
+    case static_cast<char>(CarlaRecorderPacketId::VehicleLight):
+      LightVehicles.Read(InStream);
+      return true;
+
+    // scene lights animation
+    case static_cast<char>(CarlaRecorderPacketId::SceneLight):
+      LightScenes.Read(InStream);
+      return true;
+
+    case static_cast<char>(CarlaRecorderPacketId::FrameCounter):
+      FrameCounter.Read(InStream);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 void FFrameData::CreateRecorderEventAdd(
     uint32_t DatabaseId,
     uint8_t Type,
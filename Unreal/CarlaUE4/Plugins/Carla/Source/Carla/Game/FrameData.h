@@ -31,6 +31,9 @@
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Traffic/TrafficSignBase.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <compiler/enable-ue4-macros.h>
 
 #include <sstream>
 #include <unordered_map>
@@ -75,6 +78,9 @@ public:
 
   void SetEpisode(UCarlaEpisode* ThisEpisode) {Episode = ThisEpisode;}
 
+  // frame counter of the primary server when this data was taken
+  uint64_t GetFrame() const { return FrameCounter.FrameCounter; }
+
   void GetFrameData(UCarlaEpisode *ThisEpisode, bool bAdditionalData = false, bool bIncludeActorsAgain = false);
 
   void PlayFrameData(UCarlaEpisode *ThisEpisode, std::unordered_map<uint32_t, uint32_t>& MappedId);
@@ -84,6 +90,12 @@ public:
   void Write(std::ostream& OutStream);
   void Read(std::istream& InStream);
 
+  // serialize straight into OutBuffer (growing it if needed), to send it to
+  // the secondary servers without intermediate copies
+  void Write(carla::Buffer& OutBuffer);
+  // parse a frame from the primary server in place
+  void Read(const carla::Buffer& InBuffer);
+
   // record functions
   void CreateRecorderEventAdd(
       uint32_t DatabaseId,
@@ -96,6 +108,9 @@ public:
   void AddEvent(const CarlaRecorderEventParent &Event);
 
 private:
+  // false if the packet is unknown
+  bool ReadPacket(char Id, std::istream& InStream);
+
   void AddCollision(AActor *Actor1, AActor *Actor2);
   void AddPosition(const CarlaRecorderPosition &Position);
   void AddState(const CarlaRecorderStateTrafficLight &State);
@@ -0,0 +1,100 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/MapStartupCache.h"
+
+#include "Misc/FileHelper.h"
+#include "Serialization/BufferArchive.h"
+#include "Serialization/MemoryReader.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/road/Map.h>
+#include <compiler/enable-ue4-macros.h>
+
+namespace MapStartupCacheConstants
+{
+  /// First bytes of the file, "CMSC".
+  constexpr uint32 Magic = 0x43534D43u;
+}
+
+FArchive &operator<<(FArchive &Archive, FMapStartupCache &Cache)
+{
+  Archive << Cache.OpenDriveHash;
+  Archive << Cache.SpawnPoints;
+  Archive << Cache.MeshLabels;
+  Archive << Cache.TrafficLightActors;
+  Archive << Cache.SignActors;
+  return Archive;
+}
+
+FString FMapStartupCache::GetDefaultPath(const FString &MapName)
+{
+  return FPaths::ProjectContentDir() + TEXT("Carla/Config/MapStartupCache/") +
+      FPaths::GetBaseFilename(MapName) + TEXT(".bin");
+}
+
+uint32 FMapStartupCache::HashOpenDrive(const FString &XODRContent)
+{
+  return FCrc::StrCrc32(*XODRContent);
+}
+
+TArray<FTransform> FMapStartupCache::ComputeSpawnPoints(const carla::road::Map &Map)
+{
+  TArray<FTransform> SpawnPoints;
+  for (const auto &Pair : Map.GenerateTopology())
+  {
+    FTransform Transform(Map.ComputeTransform(Pair.first));
+    Transform.AddToTranslation(FVector(0.f, 0.f, 50.0f));
+    SpawnPoints.Add(Transform);
+  }
+  return SpawnPoints;
+}
+
+bool FMapStartupCache::Save(const FString &FilePath) const
+{
+  FBufferArchive Archive;
+  uint32 Magic = MapStartupCacheConstants::Magic;
+  int32 FileVersion = Version;
+  Archive << Magic;
+  Archive << FileVersion;
+  Archive << const_cast<FMapStartupCache &>(*this);
+  return FFileHelper::SaveArrayToFile(Archive, *FilePath);
+}
+
+bool FMapStartupCache::Load(const FString &FilePath, const uint32 ExpectedOpenDriveHash)
+{
+  *this = FMapStartupCache();
+  TArray<uint8> Bytes;
+  if (!FPaths::FileExists(FilePath) || !FFileHelper::LoadFileToArray(Bytes, *FilePath))
+  {
+    return false;
+  }
+  FMemoryReader Archive(Bytes);
+  uint32 Magic = 0u;
+  int32 FileVersion = 0;
+  Archive << Magic;
+  Archive << FileVersion;
+  if ((Magic != MapStartupCacheConstants::Magic) || (FileVersion != Version))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Ignoring map startup cache %s of another version"), *FilePath);
+    return false;
+  }
+  Archive << *this;
+  if (Archive.IsError())
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Ignoring corrupted map startup cache %s"), *FilePath);
+    *this = FMapStartupCache();
+    return false;
+  }
+  if (OpenDriveHash != ExpectedOpenDriveHash)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Ignoring map startup cache %s baked for another OpenDRIVE"), *FilePath);
+    *this = FMapStartupCache();
+    return false;
+  }
+  return true;
+}
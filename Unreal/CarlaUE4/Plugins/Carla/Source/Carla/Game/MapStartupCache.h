@@ -0,0 +1,62 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace carla {
+namespace road {
+  class Map;
+} // namespace road
+} // namespace carla
+
+/// Data of a map that the server computes at startup and that can be baked
+/// ahead of time, per map, into a binary sidecar by the BakeMapStartupCache
+/// commandlet of CarlaTools.
+///
+/// A cache is only used if it was baked for the same OpenDRIVE, anything
+/// missing from it is computed at runtime as before.
+struct CARLA_API FMapStartupCache
+{
+  /// Increase when the layout changes, older files are ignored.
+  static constexpr int32 Version = 1;
+
+  /// Hash of the OpenDRIVE the cache was baked from.
+  uint32 OpenDriveHash = 0u;
+
+  /// Recommended spawn points generated from the road topology, used when
+  /// the map has no AVehicleSpawnPoint.
+  TArray<FTransform> SpawnPoints;
+
+  /// Semantic label of the meshes used in the map, by object path.
+  TMap<FString, uint8> MeshLabels;
+
+  /// OpenDRIVE signal id to path name of the traffic light of the map
+  /// matched with it, empty if none. Only traffic light signals.
+  TMap<FString, FString> TrafficLightActors;
+
+  /// OpenDRIVE signal id to path name of the traffic sign of the map matched
+  /// with it, empty if none. Traffic light signals are not included, they
+  /// may match traffic lights spawned at runtime.
+  TMap<FString, FString> SignActors;
+
+  /// Default location of the cache of @a MapName.
+  static FString GetDefaultPath(const FString &MapName);
+
+  static uint32 HashOpenDrive(const FString &XODRContent);
+
+  /// Spawn points on every road of the topology of @a Map.
+  static TArray<FTransform> ComputeSpawnPoints(const carla::road::Map &Map);
+
+  bool Save(const FString &FilePath) const;
+
+  /// Load the cache at @a FilePath, return false and leave it empty if the
+  /// file is missing, of another version or baked for another OpenDRIVE.
+  bool Load(const FString &FilePath, uint32 ExpectedOpenDriveHash);
+
+  friend FArchive &operator<<(FArchive &Archive, FMapStartupCache &Cache);
+};
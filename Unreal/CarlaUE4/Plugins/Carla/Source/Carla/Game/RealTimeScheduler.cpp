@@ -0,0 +1,138 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Game/RealTimeScheduler.h"
+
+#include "Carla/Settings/EpisodeSettings.h"
+
+namespace RealTimeSchedulerConstants
+{
+  /// 最后一帧在工作时间和实时因子的滑动平均中的权重。
+  constexpr double Smoothing = 0.2;
+
+  /// 子步长最多为 MaxSubstepDeltaTime 的倍数。
+  constexpr double MaxSubstepCoarsening = 2.0;
+
+  /// 工作时间低于预算的这个比例时开始恢复。
+  constexpr double RecoverRatio = 0.8;
+}
+
+void FRealTimeScheduler::Configure(const FEpisodeSettings &Settings)
+{
+  using namespace RealTimeSchedulerConstants;
+  FixedDeltaSeconds = Settings.FixedDeltaSeconds.Get(0.0);
+  const bool bEnabled =
+      !Settings.bSynchronousMode &&
+      FixedDeltaSeconds > 0.0 &&
+      Settings.TargetRealTimeFactor > 0.0;
+  BudgetSeconds = bEnabled ? FixedDeltaSeconds / Settings.TargetRealTimeFactor : 0.0;
+  if (Settings.TargetRealTimeFactor > 0.0 && !bEnabled)
+  {
+    UE_LOG(LogCarla, Warning,
+        TEXT("Target real-time factor ignored, it requires asynchronous mode and a fixed delta time"));
+  }
+
+  bSubstepping = Settings.bSubstepping && Settings.MaxSubstepDeltaTime > 0.0;
+  NominalSubsteps = 1;
+  MinSubsteps = 1;
+  if (bSubstepping)
+  {
+    const int32 MaxSubsteps = FMath::Max(Settings.MaxSubsteps, 1);
+    NominalSubsteps = FMath::Clamp(
+        FMath::CeilToInt(FixedDeltaSeconds / Settings.MaxSubstepDeltaTime), 1, MaxSubsteps);
+    MinSubsteps = FMath::Clamp(
+        FMath::CeilToInt(FixedDeltaSeconds / (MaxSubstepCoarsening * Settings.MaxSubstepDeltaTime)),
+        1, NominalSubsteps);
+  }
+  Substeps = NominalSubsteps;
+  SensorBudgetMilliseconds = -1.0f;
+  WorkSeconds = -1.0;
+  SensorSeconds = 0.0;
+  RealTimeFactor = -1.0f;
+  FrameBeginSeconds = -1.0;
+  NextFrameBeginSeconds = 0.0;
+}
+
+float FRealTimeScheduler::GetSubstepDeltaTime() const
+{
+  // 稍大一点，避免舍入误差使物理多分出一个子步
+  return static_cast<float>(FixedDeltaSeconds / Substeps * (1.0 + 1e-4));
+}
+
+void FRealTimeScheduler::EndFrame(
+    const double NowSeconds,
+    const double WorldTickSeconds,
+    const double LastSensorSeconds)
+{
+  using namespace RealTimeSchedulerConstants;
+  if (!IsEnabled() || FrameBeginSeconds < 0.0)
+  {
+    return;
+  }
+  const double Work = NowSeconds - FrameBeginSeconds;
+  WorkSeconds = WorkSeconds < 0.0 ? Work : FMath::Lerp(WorkSeconds, Work, Smoothing);
+  if (LastSensorSeconds >= 0.0)
+  {
+    SensorSeconds = FMath::Lerp(SensorSeconds, LastSensorSeconds, Smoothing);
+  }
+  const double Period = FMath::Max(Work, NextFrameBeginSeconds - FrameBeginSeconds);
+  if (Period > 0.0)
+  {
+    const float Factor = static_cast<float>(FixedDeltaSeconds / Period);
+    RealTimeFactor = RealTimeFactor < 0.0f ? Factor : FMath::Lerp(RealTimeFactor, Factor, static_cast<float>(Smoothing));
+  }
+
+  if (WorkSeconds > BudgetSeconds)
+  {
+    if (Substeps > MinSubsteps)
+    {
+      --Substeps;
+    }
+    else
+    {
+      // 物理已经最少，剩下的时间留给传感器
+      const double Excess = WorkSeconds - BudgetSeconds;
+      SensorBudgetMilliseconds = static_cast<float>(FMath::Max(SensorSeconds - Excess, 0.0) * 1e3);
+    }
+  }
+  else if (WorkSeconds < RecoverRatio * BudgetSeconds)
+  {
+    if (SensorBudgetMilliseconds >= 0.0f)
+    {
+      const double Headroom = BudgetSeconds - WorkSeconds;
+      SensorBudgetMilliseconds += static_cast<float>(Headroom * 1e3);
+      if (SensorBudgetMilliseconds >= SensorSeconds * 1e3)
+      {
+        SensorBudgetMilliseconds = -1.0f;
+      }
+    }
+    else if (Substeps < NominalSubsteps)
+    {
+      // 一个子步大约占物理时间的 1/Substeps，有足够的余量时才增加
+      const double SubstepSeconds = WorldTickSeconds > 0.0 ? WorldTickSeconds / Substeps : 0.0;
+      if (WorkSeconds + SubstepSeconds < RecoverRatio * BudgetSeconds)
+      {
+        ++Substeps;
+      }
+    }
+  }
+}
+
+void FRealTimeScheduler::BeginFrame(const double NowSeconds)
+{
+  if (!IsEnabled())
+  {
+    return;
+  }
+  FrameBeginSeconds = NowSeconds;
+  // 落后超过一帧时从现在重新开始，不连续追赶
+  NextFrameBeginSeconds = FMath::Max(NextFrameBeginSeconds + BudgetSeconds, NowSeconds);
+  if (NextFrameBeginSeconds > NowSeconds + BudgetSeconds)
+  {
+    NextFrameBeginSeconds = NowSeconds + BudgetSeconds;
+  }
+}
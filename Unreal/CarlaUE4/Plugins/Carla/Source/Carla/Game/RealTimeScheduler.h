@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FEpisodeSettings;
+
+/// 按目标实时因子安排每一帧的墙钟时间（见 FEpisodeSettings::TargetRealTimeFactor）。
+///
+/// 每一帧的预算为 FixedDeltaSeconds / TargetRealTimeFactor。帧开始的时间按预算
+/// 依次排列，落后超过一帧时不再追赶；提前完成的帧等到下一个开始时间。一帧的实际
+/// 工作时间（滑动平均）超出预算时，先每帧减少一个物理子步，子步长最多为
+/// MaxSubstepDeltaTime 的 2 倍以保持物理稳定；子步数已经最少时给传感器设置时间
+/// 预算。回到预算的 80% 以内时按相反的顺序恢复。
+///
+/// 只用于游戏线程。
+class FRealTimeScheduler
+{
+public:
+
+  void Configure(const FEpisodeSettings &Settings);
+
+  /// 异步模式、有固定时间步长并且目标实时因子大于 0。
+  bool IsEnabled() const
+  {
+    return BudgetSeconds > 0.0;
+  }
+
+  double GetBudgetSeconds() const
+  {
+    return BudgetSeconds;
+  }
+
+  /// 上一帧在 @a NowSeconds 结束。@a WorldTickSeconds 和 @a SensorSeconds 为
+  /// 上一帧物理和参与者 tick 以及传感器所用的时间，为负表示没有记录。
+  void EndFrame(double NowSeconds, double WorldTickSeconds, double SensorSeconds);
+
+  /// 下一帧最早开始的平台时间（秒）。
+  double GetNextFrameBeginSeconds() const
+  {
+    return NextFrameBeginSeconds;
+  }
+
+  /// 下一帧在 @a NowSeconds 开始。
+  void BeginFrame(double NowSeconds);
+
+  /// 当前使用的物理子步数，没有启用子步时为 1。
+  int32 GetSubsteps() const
+  {
+    return Substeps;
+  }
+
+  /// 物理子步长，使固定时间步长正好分为 GetSubsteps() 个子步。
+  float GetSubstepDeltaTime() const;
+
+  /// 传感器每帧的时间预算（毫秒），为负表示不限制。
+  float GetSensorBudgetMilliseconds() const
+  {
+    return SensorBudgetMilliseconds;
+  }
+
+  /// 达到的实时因子的滑动平均，还没有完成的帧时为负。
+  float GetRealTimeFactor() const
+  {
+    return RealTimeFactor;
+  }
+
+private:
+
+  double FixedDeltaSeconds = 0.0;
+
+  double BudgetSeconds = 0.0;
+
+  bool bSubstepping = false;
+
+  /// 按 MaxSubstepDeltaTime 的子步数，也是恢复的上限。
+  int32 NominalSubsteps = 1;
+
+  /// 子步长为 MaxSubstepDeltaTime 的 2 倍时的子步数。
+  int32 MinSubsteps = 1;
+
+  int32 Substeps = 1;
+
+  float SensorBudgetMilliseconds = -1.0f;
+
+  /// 一帧工作时间（不含等待）的滑动平均（秒），为负表示还没有完成的帧。
+  double WorkSeconds = -1.0;
+
+  /// 传感器时间的滑动平均（秒）。
+  double SensorSeconds = 0.0;
+
+  float RealTimeFactor = -1.0f;
+
+  double FrameBeginSeconds = -1.0;
+
+  double NextFrameBeginSeconds = 0.0;
+};
@@ -9,7 +9,11 @@
 #include "Engine/SkeletalMesh.h"
 #include "Engine/StaticMesh.h"
 #include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "PhysicsEngine/PhysicsAsset.h"
+#include "UObject/ObjectKey.h"
 
 namespace crp = carla::rpc;
 
@@ -51,6 +55,98 @@ crp::CityObjectLabel ATagger::GetLabelByFolderName(const FString &String) {
   else                               return crp::CityObjectLabel::None;
 }
 
+crp::CityObjectLabel ATagger::GetLabelByPathName(const FString &Path) {
+  TArray<FString> StringArray;
+  Path.ParseIntoArray(StringArray, TEXT("/"), false);
+  return (StringArray.Num() > 4 ? GetLabelByFolderName(StringArray[4]) : crp::CityObjectLabel::None);
+}
+
+// 按资源缓存的标签，键值包含对象的序列号，资源被回收后不会误用
+static TMap<FObjectKey, crp::CityObjectLabel> LabelCache;
+
+// 预先生成的路径到标签的表
+static TMap<FString, crp::CityObjectLabel> TagTable;
+
+static bool bTagTableLoaded = false;
+
+static void LoadDefaultTagTableIfNeeded()
+{
+  if (!bTagTableLoaded)
+  {
+    bTagTableLoaded = true;
+    const FString FilePath = ATagger::GetDefaultTagTablePath();
+    if (FPaths::FileExists(FilePath))
+    {
+      ATagger::LoadTagTable(FilePath);
+    }
+  }
+}
+
+crp::CityObjectLabel ATagger::GetCachedLabel(const UObject *Object)
+{
+  if (Object == nullptr)
+  {
+    return crp::CityObjectLabel::None;
+  }
+  check(IsInGameThread());
+  const FObjectKey Key(Object);
+  if (const crp::CityObjectLabel *Cached = LabelCache.Find(Key))
+  {
+    return *Cached;
+  }
+  LoadDefaultTagTableIfNeeded();
+  const FString Path = Object->GetPathName();
+  const crp::CityObjectLabel *Baked = TagTable.Find(Path);
+  const crp::CityObjectLabel Label = (Baked != nullptr) ? *Baked : GetLabelByPathName(Path);
+  LabelCache.Add(Key, Label);
+  return Label;
+}
+
+int32 ATagger::LoadTagTable(const FString &FilePath)
+{
+  TArray<FString> Lines;
+  if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Tagger: could not read tag table %s"), *FilePath);
+    return 0;
+  }
+  bTagTableLoaded = true;
+  TagTable.Reset();
+  LabelCache.Reset();
+  for (const FString &Line : Lines)
+  {
+    FString Path;
+    FString Label;
+    if (Line.StartsWith(TEXT("#")) || !Line.Split(TEXT(","), &Path, &Label, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+    {
+      continue;
+    }
+    TagTable.Add(Path.TrimStartAndEnd(), static_cast<crp::CityObjectLabel>(FCString::Atoi(*Label)));
+  }
+  UE_LOG(LogCarla, Log, TEXT("Tagger: loaded %d entries from tag table %s"), TagTable.Num(), *FilePath);
+  return TagTable.Num();
+}
+
+void ATagger::AddTagTableEntries(const TMap<FString, uint8> &Labels)
+{
+  LoadDefaultTagTableIfNeeded();
+  for (const auto &Entry : Labels)
+  {
+    TagTable.Add(Entry.Key, static_cast<crp::CityObjectLabel>(Entry.Value));
+  }
+  LabelCache.Reset();
+}
+
+FString ATagger::GetDefaultTagTablePath()
+{
+  return FPaths::ProjectContentDir() + TEXT("Carla/Config/TagTable.csv");
+}
+
+void ATagger::ClearLabelCache()
+{
+  LabelCache.Reset();
+}
+
 void ATagger::SetStencilValue(
     UPrimitiveComponent &Component,
     const crp::CityObjectLabel &Label,
@@ -107,13 +203,14 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
   UE_LOG(LogCarla, Log, TEXT("Actor: %s"), *Actor.GetName());
 #endif // CARLA_TAGGER_EXTRA_LOG
 
+  const bool bIsVehicle = (Cast<ACarlaWheeledVehicle>(&Actor) != nullptr);
+
   // Iterate static meshes.
   TArray<UStaticMeshComponent *> StaticMeshComponents;
   Actor.GetComponents<UStaticMeshComponent>(StaticMeshComponents);
   for (UStaticMeshComponent *Component : StaticMeshComponents) {
-    auto Label = GetLabelByPath(Component->GetStaticMesh());
-    if (Label == crp::CityObjectLabel::Pedestrians &&
-        Cast<ACarlaWheeledVehicle>(&Actor))
+    auto Label = GetCachedLabel(Component->GetStaticMesh());
+    if (Label == crp::CityObjectLabel::Pedestrians && bIsVehicle)
     {
       Label = crp::CityObjectLabel::Rider;
     }
@@ -166,9 +263,8 @@ void ATagger::TagActor(const AActor &Actor, bool bTagForSemanticSegmentation)
   TArray<USkeletalMeshComponent *> SkeletalMeshComponents;
   Actor.GetComponents<USkeletalMeshComponent>(SkeletalMeshComponents);
   for (USkeletalMeshComponent *Component : SkeletalMeshComponents) {
-    auto Label = GetLabelByPath(Component->GetPhysicsAsset());
-    if (Label == crp::CityObjectLabel::Pedestrians &&
-        Cast<ACarlaWheeledVehicle>(&Actor))
+    auto Label = GetCachedLabel(Component->GetPhysicsAsset());
+    if (Label == crp::CityObjectLabel::Pedestrians && bIsVehicle)
     {
       Label = crp::CityObjectLabel::Rider;
     }
@@ -230,8 +326,34 @@ void ATagger::TagActorsInLevel(UWorld &World, bool bTagForSemanticSegmentation)
 void ATagger::TagActorsInLevel(ULevel &Level, bool bTagForSemanticSegmentation)
 {
   for (AActor * Actor : Level.Actors) {
-    TagActor(*Actor, bTagForSemanticSegmentation);
+    if (Actor != nullptr) {
+      TagActor(*Actor, bTagForSemanticSegmentation);
+    }
+  }
+}
+
+bool ATagger::TagActorsInLevel(
+    ULevel &Level,
+    bool bTagForSemanticSegmentation,
+    int32 &ActorIndex,
+    double TimeBudget)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ATagger::TagActorsInLevel);
+  const double StartTime = FPlatformTime::Seconds();
+  const int32 FirstIndex = ActorIndex;
+  while (ActorIndex < Level.Actors.Num())
+  {
+    if (ActorIndex > FirstIndex && FPlatformTime::Seconds() - StartTime >= TimeBudget)
+    {
+      return false;
+    }
+    AActor *Actor = Level.Actors[ActorIndex++];
+    if (Actor != nullptr)
+    {
+      TagActor(*Actor, bTagForSemanticSegmentation);
+    }
   }
+  return true;
 }
 
 void ATagger::GetTagsOfTaggedActor(const AActor &Actor, TSet<crp::CityObjectLabel> &Tags)
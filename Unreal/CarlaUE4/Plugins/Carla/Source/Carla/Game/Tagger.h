@@ -48,6 +48,16 @@ public:
 
   static void TagActorsInLevel(ULevel &Level, bool bTagForSemanticSegmentation);
 
+  /// Time-sliced version of TagActorsInLevel. Tags the actors of @a Level
+  /// starting at @a ActorIndex until @a TimeBudget seconds have elapsed (at
+  /// least one actor is tagged per call), and advances @a ActorIndex to the
+  /// next actor to tag. Returns true once every actor of the level is tagged.
+  static bool TagActorsInLevel(
+      ULevel &Level,
+      bool bTagForSemanticSegmentation,
+      int32 &ActorIndex,
+      double TimeBudget);
+
   /// Retrieve the tag of an already tagged component.
   static crp::CityObjectLabel GetTagOfTaggedComponent(const UPrimitiveComponent &Component)
   {
@@ -75,12 +85,32 @@ public:
   /// using the folder path in which it is stored
   template <typename T>
   static crp::CityObjectLabel GetLabelByPath(const T *Object) {
-    const FString Path = Object->GetPathName();
-    TArray<FString> StringArray;
-    Path.ParseIntoArray(StringArray, TEXT("/"), false);
-    return (StringArray.Num() > 4 ? GetLabelByFolderName(StringArray[4]) : crp::CityObjectLabel::None);
+    return GetLabelByPathName(Object->GetPathName());
   }
 
+  /// Method that computes the label corresponding to an object path name
+  static crp::CityObjectLabel GetLabelByPathName(const FString &Path);
+
+  /// Same as GetLabelByPath but the result is cached per asset, so the path
+  /// of each mesh is only resolved once. Entries of the tag table (see
+  /// LoadTagTable) take precedence over the folder name. Game thread only.
+  static crp::CityObjectLabel GetCachedLabel(const UObject *Object);
+
+  /// Load a tag table with one "ObjectPath,Label" line per asset, as written
+  /// by the BakeTagTable commandlet of CarlaTools, replacing the previous one.
+  /// Returns the number of entries loaded.
+  static int32 LoadTagTable(const FString &FilePath);
+
+  /// Add the entries of @a Labels, by object path, to the tag table, e.g.
+  /// the labels baked in the startup cache of the map.
+  static void AddTagTableEntries(const TMap<FString, uint8> &Labels);
+
+  /// Path of the tag table loaded on first use, if it exists.
+  static FString GetDefaultTagTablePath();
+
+  /// Drop the cached labels, e.g. after changing the tag table.
+  static void ClearLabelCache();
+
   static void SetStencilValue(UPrimitiveComponent &Component,
     const crp::CityObjectLabel &Label, const bool bSetRenderCustomDepth);
 
@@ -57,6 +57,7 @@ void UCarlaLight::SetLightIntensity(float Intensity)
 {
   LightIntensity = Intensity;
   UpdateLights();
+  NotifyLightChanged();
 }
 
 float UCarlaLight::GetLightIntensity() const
@@ -69,6 +70,7 @@ void UCarlaLight::SetLightColor(FLinearColor Color)
   LightColor = Color;
   UpdateLights();
   RecordLightChange();
+  NotifyLightChanged();
 }
 
 FLinearColor UCarlaLight::GetLightColor() const
@@ -81,6 +83,7 @@ void UCarlaLight::SetLightOn(bool bOn)
   bLightOn = bOn;
   UpdateLights();
   RecordLightChange();
+  NotifyLightChanged();
 }
 
 bool UCarlaLight::GetLightOn() const
@@ -91,6 +94,7 @@ bool UCarlaLight::GetLightOn() const
 void UCarlaLight::SetLightType(ELightType Type)
 {
   LightType = Type;
+  NotifyLightChanged();
 }
 
 ELightType UCarlaLight::GetLightType() const
@@ -115,12 +119,21 @@ carla::rpc::LightState UCarlaLight::GetLightState()
 
 void UCarlaLight::SetLightState(carla::rpc::LightState LightState)
 {
+  const FLinearColor Color = LightState._color;
+  const ELightType Type = static_cast<ELightType>(LightState._group);
+  if (LightIntensity == LightState._intensity && LightColor == Color &&
+      LightType == Type && bLightOn == LightState._active)
+  {
+    // Nothing changed, avoid updating the materials and notifying the clients.
+    return;
+  }
   LightIntensity = LightState._intensity;
-  LightColor = LightState._color;
-  LightType = static_cast<ELightType>(LightState._group);
+  LightColor = Color;
+  LightType = Type;
   bLightOn = LightState._active;
   UpdateLights();
   RecordLightChange();
+  NotifyLightChanged();
 }
 
 FVector UCarlaLight::GetLocation() const
@@ -157,3 +170,17 @@ void UCarlaLight::RecordLightChange() const
     }
   }
 }
+
+void UCarlaLight::NotifyLightChanged()
+{
+  // Lights not registered yet are reported as changed when registering.
+  UWorld *World = GetWorld();
+  if (bRegistered && World)
+  {
+    UCarlaLightSubsystem* CarlaLightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
+    if (CarlaLightSubsystem)
+    {
+      CarlaLightSubsystem->MarkLightChanged(GetId());
+    }
+  }
+}
@@ -111,5 +111,7 @@ protected:
 
   void RecordLightChange() const;
 
+  void NotifyLightChanged();
+
   bool bRegistered = false;
 };
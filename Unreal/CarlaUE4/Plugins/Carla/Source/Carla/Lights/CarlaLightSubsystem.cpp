@@ -7,6 +7,8 @@
 #include "CarlaLightSubsystem.h"
 #include "Carla/Weather/Weather.h"
 #include "Kismet/GameplayStatics.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
 
 //using cr = carla::rpc;
 
@@ -31,8 +33,8 @@ void UCarlaLightSubsystem::RegisterLight(UCarlaLight* CarlaLight)
       return;
     }
     Lights.Add(LightId, CarlaLight);
+    MarkLightChanged(LightId);
   }
-  SetClientStatesdirty("");
 }
 
 void UCarlaLightSubsystem::UnregisterLight(UCarlaLight* CarlaLight)
@@ -40,6 +42,8 @@ void UCarlaLightSubsystem::UnregisterLight(UCarlaLight* CarlaLight)
   if(CarlaLight)
   {
     Lights.Remove(CarlaLight->GetId());
+    LightVersions.Remove(CarlaLight->GetId());
+    ++LightsVersion;
   }
   SetClientStatesdirty("");
 }
@@ -71,6 +75,64 @@ std::vector<carla::rpc::LightState> UCarlaLightSubsystem::GetLights(FString Clie
   return result;
 }
 
+std::vector<carla::rpc::LightState> UCarlaLightSubsystem::GetLightsChangedSince(
+    FString Client,
+    uint64 Version,
+    uint64 &OutVersion)
+{
+  std::vector<carla::rpc::LightState> result;
+
+  ClientStates.FindOrAdd(Client) = false;
+  OutVersion = LightsVersion;
+
+  const int32 First = Algo::UpperBoundBy(
+      ChangeLog,
+      Version,
+      [](const TPair<uint64, int> &Change) { return Change.Key; });
+  for (int32 i = First; i < ChangeLog.Num(); ++i)
+  {
+    const TPair<uint64, int> &Change = ChangeLog[i];
+    if (LightVersions.FindRef(Change.Value) != Change.Key)
+    {
+      continue;
+    }
+    UCarlaLight* CarlaLight = Lights.FindRef(Change.Value);
+    if (CarlaLight)
+    {
+      result.push_back(CarlaLight->GetLightState());
+    }
+  }
+  return result;
+}
+
+void UCarlaLightSubsystem::MarkClientUpToDate(const FString &Client, uint64 Version)
+{
+  ClientStates.FindOrAdd(Client) = (Version != LightsVersion);
+}
+
+void UCarlaLightSubsystem::MarkLightChanged(int Id)
+{
+  ++LightsVersion;
+  LightVersions.FindOrAdd(Id) = LightsVersion;
+  ChangeLog.Emplace(LightsVersion, Id);
+  if (ChangeLog.Num() > 2 * FMath::Max(LightVersions.Num(), 64))
+  {
+    CompactChangeLog();
+  }
+  SetClientStatesdirty("");
+}
+
+void UCarlaLightSubsystem::CompactChangeLog()
+{
+  // Keep only the last change of each light.
+  ChangeLog.Reset(LightVersions.Num());
+  for (const auto &LightVersion : LightVersions)
+  {
+    ChangeLog.Emplace(LightVersion.Value, LightVersion.Key);
+  }
+  Algo::SortBy(ChangeLog, [](const TPair<uint64, int> &Change) { return Change.Key; });
+}
+
 void UCarlaLightSubsystem::SetLights(
   FString Client,
   std::vector<carla::rpc::LightState> LightsToSet,
@@ -79,6 +141,8 @@ void UCarlaLightSubsystem::SetLights(
   bool* ClientState = ClientStates.Find(Client);
 
   if(ClientState) {
+    // Only the lights that actually change are updated, and those notify all
+    // the clients through MarkLightChanged.
     for(auto& LightState : LightsToSet) {
       UCarlaLight* CarlaLight = Lights.FindRef(LightState._id);
       if(CarlaLight) {
@@ -50,6 +50,27 @@ public:
 
   std::vector<carla::rpc::LightState> GetLights(FString Client);
 
+  /// Lights whose state changed after @a Version, @a OutVersion is set to the
+  /// current version for the next query. Version 0 returns all the lights.
+  /// Lights removed since then are not reported.
+  std::vector<carla::rpc::LightState> GetLightsChangedSince(
+      FString Client,
+      uint64 Version,
+      uint64 &OutVersion);
+
+  /// Called by the lights whenever their state changes.
+  void MarkLightChanged(int Id);
+
+  /// Incremented on each change of any light, and when a light is removed.
+  uint64 GetLightsVersion() const
+  {
+    return LightsVersion;
+  }
+
+  /// Marks @a Client as up to date with the lights of @a Version, as
+  /// GetLights does, unless a light changed since then.
+  void MarkClientUpToDate(const FString &Client, uint64 Version);
+
   void SetLights(
       FString Client,
       std::vector<carla::rpc::LightState> LightsToSet,
@@ -68,8 +89,20 @@ private:
 
   void SetClientStatesdirty(FString ClientThatUpdate);
 
+  void CompactChangeLog();
+
   TMap<int, UCarlaLight* > Lights;
 
+  // Incremented on each change of any light
+  uint64 LightsVersion = 0u;
+
+  // Version of the last change of each light
+  TMap<int, uint64> LightVersions;
+
+  // (version, light id) of the changes in increasing order of version. An
+  // entry older than the version of its light is superseded by a later one.
+  TArray<TPair<uint64, int>> ChangeLog;
+
   // Flag for each client to tell if an update needs to be done
   TMap<FString, bool> ClientStates;
   // Since the clients doesn't have a proper id on the simulation,
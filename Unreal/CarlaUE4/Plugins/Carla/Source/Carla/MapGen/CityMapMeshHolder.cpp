@@ -8,6 +8,7 @@
 #include "CityMapMeshHolder.h"
 #include "Engine/StaticMeshActor.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Engine/StaticMesh.h"
 #include <vector>
 #include "Settings/CarlaSettings.h"
@@ -72,19 +73,13 @@ void ACityMapMeshHolder::PostInitializeComponents()
   // 检查当前Actor所在的关卡是否有效且未被标记为待销毁
   if(IsValid(GetLevel())&&!GetLevel()->IsPendingKill())
   {
-    // 创建一个数组用于存储附加到该Actor的道路部件Actor
-	 TArray<AActor*> roadpieces;
-   // 获取附加到该Actor的所有Actor并存储到roadpieces数组中
-     GetAttachedActors(roadpieces);
-   // 如果没有附加的道路部件Actor
-	 if(roadpieces.Num()==0)
+    // 如果既没有附加的道路部件Actor也没有实例
+	 if(!HasPieces())
 	 {
      // 输出错误日志，提示需要在编辑模式下重新生成道路
 	   UE_LOG(LogCarla, Error, TEXT("Please regenerate the road in edit mode for '%s' actor"), *UKismetSystemLibrary::GetDisplayName(this));
-     // 更新地图比例尺
-	   UpdateMapScale();
-       // 更新地图
-       UpdateMap();
+       // 重新生成地图
+       RegenerateMap();
 	 }
   }
 
@@ -98,12 +93,8 @@ void ACityMapMeshHolder::PostEditChangeProperty(FPropertyChangedEvent& PropertyC
   Super::PostEditChangeProperty(PropertyChangedEvent);
   if (PropertyChangedEvent.Property)
   {
-    // 删除一些部件（具体实现见DeletePieces函数）
-    DeletePieces();
-    // 更新地图比例尺
-    UpdateMapScale();
-    // 更新地图
-    UpdateMap();
+    // 删除旧的部件并重新生成地图
+    RegenerateMap();
    }
 }
 #endif // WITH_EDITOR
@@ -174,6 +165,16 @@ void ACityMapMeshHolder::AddInstance(ECityMapMeshTag Tag, uint32 X, uint32 Y, fl
 // 在指定的变换位置添加一个指定标签的实例
 void ACityMapMeshHolder::AddInstance(ECityMapMeshTag Tag, FTransform Transform)
 {
+  // 实例化模式下只在共用的组件中添加一个实例，变换相对于本Actor
+  if (bUseInstancedMeshes)
+  {
+    UHierarchicalInstancedStaticMeshComponent *Component = GetInstancedComponent(Tag);
+    if (Component != nullptr)
+    {
+      Component->AddInstance(Transform);
+    }
+    return;
+  }
   // 创建一个Actor生成参数对象，用于指定生成Actor时的一些参数
   FActorSpawnParameters params;
   // 设置生成Actor时的碰撞处理方式为总是生成，即使有碰撞也生成
@@ -217,8 +218,10 @@ void ACityMapMeshHolder::DeletePieces()
   // 遍历数组，销毁每个实例化静态网格组件
   for(int32 i=0;i<oldcomponents.Num();i++)
   {
+	  RemoveInstanceComponent(oldcomponents[i]);
 	  oldcomponents[i]->DestroyComponent();
   }
+  InstancedComponents.Empty();
 
   // 创建一个数组用于存储附加到该Actor的道路部件Actor
   TArray<AActor*> roadpieces;
@@ -238,6 +241,77 @@ void ACityMapMeshHolder::DeletePieces()
 
 }
 
+// 删除旧的部件，按当前的网格重新生成地图
+void ACityMapMeshHolder::RegenerateMap()
+{
+  DeletePieces();
+  UpdateMapScale();
+  UpdateMap();
+
+  // 添加实例时不重建层次结构，全部添加完后每个组件只构建一次
+  for (auto &Item : InstancedComponents)
+  {
+    if (Item.Value != nullptr)
+    {
+      Item.Value->BuildTreeIfOutdated(false, true);
+    }
+  }
+}
+
+// 获取某个标签的所有实例共用的分层实例化静态网格组件，不存在时创建
+UHierarchicalInstancedStaticMeshComponent *ACityMapMeshHolder::GetInstancedComponent(ECityMapMeshTag Tag)
+{
+  UHierarchicalInstancedStaticMeshComponent **Found = InstancedComponents.Find(Tag);
+  if (Found != nullptr && *Found != nullptr)
+  {
+    return *Found;
+  }
+  UStaticMesh *Mesh = GetStaticMesh(Tag);
+  if (Mesh == nullptr)
+  {
+    UE_LOG(
+        LogCarla,
+        Error,
+        TEXT("Cannot find mesh \"%s\" for instancing"),
+        *CityMapMeshTag::ToString(Tag));
+    return nullptr;
+  }
+  auto *Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(
+      this,
+      FName(*FString::Printf(TEXT("Instances_%s"), *CityMapMeshTag::ToString(Tag))));
+  Component->SetMobility(EComponentMobility::Static);
+  Component->SetupAttachment(RootComponent);
+  Component->SetStaticMesh(Mesh);
+  Component->bAutoRebuildTreeOnInstanceChanges = false;
+  AddInstanceComponent(Component);
+  Component->RegisterComponent();
+  InstancedComponents.Add(Tag, Component);
+  // 与道路部件Actor一样，由画质设置统一处理
+  Tags.AddUnique(UCarlaSettings::CARLA_ROAD_TAG);
+  return Component;
+}
+
+// 是否已经生成了道路部件，无论是附加的Actor还是实例
+bool ACityMapMeshHolder::HasPieces() const
+{
+  TArray<AActor*> roadpieces;
+  GetAttachedActors(roadpieces);
+  if (roadpieces.Num() > 0)
+  {
+    return true;
+  }
+  TArray<UInstancedStaticMeshComponent*> instancedcomponents;
+  GetComponents(instancedcomponents);
+  for (const UInstancedStaticMeshComponent *Component : instancedcomponents)
+  {
+    if (Component->GetInstanceCount() > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 // 更新地图比例尺的函数
 void ACityMapMeshHolder::UpdateMapScale()
 {
@@ -12,6 +12,7 @@
 
 class IDetailLayoutBuilder;
 class UInstancedStaticMeshComponent;
+class UHierarchicalInstancedStaticMeshComponent;
 class AStaticMeshActor;
 
 
@@ -97,6 +98,16 @@ private:
   /// Clear all instances of the static mesh actors.
   void DeletePieces();
 
+  /// Delete the current pieces and generate the map again.
+  void RegenerateMap();
+
+  /// Return the hierarchical instanced component holding every instance of
+  /// @a Tag, creating it if necessary.
+  UHierarchicalInstancedStaticMeshComponent *GetInstancedComponent(ECityMapMeshTag Tag);
+
+  /// Whether the map has pieces, either as attached actors or as instances.
+  bool HasPieces() const;
+
   /// Set the scale to the dimensions of the base mesh.
   void UpdateMapScale();
 
@@ -109,11 +120,20 @@ private:
   UPROPERTY(Category = "Map Generation", VisibleAnywhere)
   float MapScale = 1.0f;
 
+  /// If true, the pieces sharing a mesh are added as instances of a single
+  /// hierarchical instanced component instead of spawning an actor per piece,
+  /// which takes one draw call per mesh and LOD instead of one per piece.
+  UPROPERTY(Category = "Map Generation", EditAnywhere)
+  bool bUseInstancedMeshes = false;
+
   UPROPERTY(Category = "Meshes", EditAnywhere)
   TMap<ECityMapMeshTag, UStaticMesh *> StaticMeshes;
 
   UPROPERTY()
   TMap<UStaticMesh *, ECityMapMeshTag> TagMap;
 
+  UPROPERTY()
+  TMap<ECityMapMeshTag, UHierarchicalInstancedStaticMeshComponent *> InstancedComponents;
+
 
 };
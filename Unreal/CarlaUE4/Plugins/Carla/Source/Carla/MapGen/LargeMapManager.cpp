@@ -24,6 +24,12 @@
 #include "FileHelper.h"
 #include "Paths.h"
 
+#include "Carla/Game/CarlaGameModeBase.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/road/Map.h>
+#include <compiler/enable-ue4-macros.h>
+
 #define LARGEMAP_LOGS 1
 
 #if LARGEMAP_LOGS
@@ -32,6 +38,12 @@
 #define LM_LOG(...)
 #endif
 
+// Maximum number of lane waypoints followed per hero to predict its
+// trajectory, shared between all the branches ahead
+static constexpr int32 LARGEMAP_MAX_PREFETCH_WAYPOINTS = 256;
+// Distance between the waypoints followed (cm)
+static constexpr float LARGEMAP_PREFETCH_ROAD_STEP = 50.0f * 100.0f;
+
 // Sets default values
 ALargeMapManager::ALargeMapManager()
 {
@@ -110,6 +122,13 @@ void ALargeMapManager::PostWorldOriginOffset(UWorld* InWorld, FIntVector InSrcOr
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
   CarlaEpisode->SetCurrentMapOrigin(CurrentOriginInt);
 
+  // The environment objects are stored in local coordinates
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(World);
+  if (GameMode && GameMode->GetObjectRegister())
+  {
+    GameMode->GetObjectRegister()->ApplyWorldOffset(FVector(InSrcOrigin - InDstOrigin));
+  }
+
 #if WITH_EDITOR
   GEngine->AddOnScreenDebugMessage(66, MsgTime, FColor::Yellow,
     FString::Printf(TEXT("Src: %s  ->  Dst: %s"), *InSrcOrigin.ToString(), *InDstOrigin.ToString()));
@@ -137,8 +156,27 @@ void ALargeMapManager::PostWorldOriginOffset(UWorld* InWorld, FIntVector InSrcOr
 void ALargeMapManager::OnLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld)
 {
   LM_LOG(Warning, "OnLevelAddedToWorld");
+  if (IsTileProxyLevel(InLevel))
+  {
+    // Proxies are only drawn, their objects are in the full tile
+    return;
+  }
+  if (TileTaggingTimeBudget > 0.0f)
+  {
+    // Spread the tagging over the next ticks, the objects of the tile are
+    // registered once all of them are tagged
+    LevelsToTag.Add(FPendingLevelTagging{InLevel, 0});
+    return;
+  }
   ATagger::TagActorsInLevel(*InLevel, true);
 
+  // Only the objects of the new tile, after the tags are set
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode && GameMode->GetObjectRegister())
+  {
+    GameMode->GetObjectRegister()->RegisterObjectsOfLevel(InLevel);
+  }
+
 
   //FDebug::DumpStackTraceToLog(ELogVerbosity::Log);
 }
@@ -147,6 +185,19 @@ void ALargeMapManager::OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld)
 {
   LM_LOG(Warning, "OnLevelRemovedFromWorld");
   //FDebug::DumpStackTraceToLog(ELogVerbosity::Log);
+  if (IsTileProxyLevel(InLevel))
+  {
+    return;
+  }
+  LevelsToTag.RemoveAll([InLevel](const FPendingLevelTagging& Pending)
+  {
+    return Pending.Level.Get() == InLevel;
+  });
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode && GameMode->GetObjectRegister())
+  {
+    GameMode->GetObjectRegister()->UnregisterObjectsOfLevel(InLevel);
+  }
   FCarlaMapTile& Tile = GetCarlaMapTile(InLevel);
   Tile.TilesSpawned = false;
 }
@@ -231,7 +282,8 @@ void ALargeMapManager::OnActorSpawned(
       //       LM: Map<ActorId, TileID> , Tile: Map<ActorID, FDormantActor>
       //       In case of update: update Tile Map, update LM Map
       LM_LOG(Log, "DORMANT VEHICLE DETECTED");
-      DormantActors.Add(CarlaActor.GetActorId());
+      const FActorData* ActorData = CarlaActor.GetActorData();
+      AddDormantActor(CarlaActor.GetActorId(), ActorData ? ActorData->Location : FDVector());
     }
   }
 
@@ -313,6 +365,16 @@ float ALargeMapManager::GetActorStreamingDistance() const
   return ActorStreamingDistance;
 }
 
+void ALargeMapManager::SetProxyStreamingDistance(float Distance)
+{
+  ProxyStreamingDistance = Distance;
+}
+
+float ALargeMapManager::GetProxyStreamingDistance() const
+{
+  return ProxyStreamingDistance;
+}
+
 FTransform ALargeMapManager::GlobalToLocalTransform(const FTransform& InTransform) const
 {
   return FTransform(
@@ -358,6 +420,8 @@ void ALargeMapManager::Tick(float DeltaTime)
   // Remove the hero actors that doesn't exits any more from the ActorsToConsider vector
   RemovePendingActorsToRemove();
 
+  TagPendingLevels();
+
   ConvertActiveToDormantActors();
 
   ConvertDormantToActiveActors();
@@ -370,6 +434,34 @@ void ALargeMapManager::Tick(float DeltaTime)
 
 }
 
+void ALargeMapManager::TagPendingLevels()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::TagPendingLevels);
+  if (LevelsToTag.Num() == 0)
+  {
+    return;
+  }
+  FPendingLevelTagging& Pending = LevelsToTag[0];
+  ULevel* Level = Pending.Level.Get();
+  if (Level == nullptr)
+  {
+    LevelsToTag.RemoveAt(0);
+    return;
+  }
+  if (!ATagger::TagActorsInLevel(*Level, true, Pending.NextActorIndex, TileTaggingTimeBudget))
+  {
+    return;
+  }
+  LevelsToTag.RemoveAt(0);
+
+  // Only the objects of the new tile, after the tags are set
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode && GameMode->GetObjectRegister())
+  {
+    GameMode->GetObjectRegister()->RegisterObjectsOfLevel(Level);
+  }
+}
+
 void ALargeMapManager::GenerateLargeMap() {
   GenerateMap(LargeMapTilePath);
 }
@@ -398,7 +490,7 @@ void ALargeMapManager::GenerateMap(FString InAssetsPath)
       // LM_LOG(Warning, "Asset class: %s", *(AssetData.AssetClass.ToString()));
     #endif
     FString TileName = AssetData.AssetName.ToString();
-    if (!TileName.Contains("_Tile_"))
+    if (!TileName.Contains("_Tile_") || TileName.EndsWith("_HLOD"))
     {
       continue;
     }
@@ -464,6 +556,7 @@ void ALargeMapManager::GenerateMap(TArray<TPair<FString, FIntVector>> MapPathsId
 void ALargeMapManager::ClearWorldAndTiles()
 {
   MapTiles.Empty();
+  CurrentProxyTilesLoaded.Empty();
 }
 
 void ALargeMapManager::RegisterTilesInWorldComposition()
@@ -479,6 +572,11 @@ void ALargeMapManager::RegisterTilesInWorldComposition()
     ULevelStreamingDynamic* StreamingLevel = It.Value.StreamingLevel;
     World->AddStreamingLevel(StreamingLevel);
     WorldComposition->TilesStreaming.Add(StreamingLevel);
+    if (ULevelStreamingDynamic* ProxyStreamingLevel = It.Value.ProxyStreamingLevel)
+    {
+      World->AddStreamingLevel(ProxyStreamingLevel);
+      WorldComposition->TilesStreaming.Add(ProxyStreamingLevel);
+    }
   }
 }
 
@@ -691,7 +789,34 @@ FCarlaMapTile& ALargeMapManager::LoadCarlaMapTile(FString TileMapPath, TileID Ti
 
   NewTile.StreamingLevel = StreamingLevel;
 
-  // 4 - Add it to the map
+  // 4 - The low detail proxy of the tile, if it was baked
+  const FString ProxyPackageName = LongLevelPackageName + "_HLOD";
+  if (FPackageName::DoesPackageExist(ProxyPackageName))
+  {
+    ULevelStreamingDynamic* ProxyStreamingLevel =
+        NewObject<ULevelStreamingDynamic>(World, *(TileName + "_HLOD"));
+    check(ProxyStreamingLevel);
+    ProxyStreamingLevel->SetWorldAssetByPackageName(*ProxyPackageName);
+#if WITH_EDITOR
+    if (World->IsPlayInEditor())
+    {
+      FWorldContext WorldContext = GEngine->GetWorldContextFromWorldChecked(World);
+      ProxyStreamingLevel->RenameForPIE(WorldContext.PIEInstance);
+    }
+    ProxyStreamingLevel->SetShouldBeVisibleInEditor(false);
+#endif // WITH_EDITOR
+    ProxyStreamingLevel->SetShouldBeLoaded(false);
+    ProxyStreamingLevel->SetShouldBeVisible(false);
+    ProxyStreamingLevel->bShouldBlockOnLoad = false;
+    ProxyStreamingLevel->bInitiallyLoaded = false;
+    ProxyStreamingLevel->bInitiallyVisible = false;
+    // Baked in the local coordinates of the tile
+    ProxyStreamingLevel->LevelTransform = FTransform(TileLocation);
+    ProxyStreamingLevel->PackageNameToLoad = *ProxyPackageName;
+    NewTile.ProxyStreamingLevel = ProxyStreamingLevel;
+  }
+
+  // 5 - Add it to the map
   return MapTiles.Add(TileId, NewTile);
 }
 
@@ -699,6 +824,9 @@ void ALargeMapManager::UpdateTilesState()
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::UpdateTilesState);
   TSet<TileID> TilesToConsider;
+  TSet<TileID> ProxyTilesToConsider;
+  TMap<TileID, float> TilesToPrefetch;
+  const bool bUseProxies = ProxyStreamingDistance > LayerStreamingDistance;
 
   // Loop over ActorsToConsider to update the state of the map tiles
   // if the actor is not valid will be removed
@@ -706,7 +834,15 @@ void ALargeMapManager::UpdateTilesState()
   {
     if (IsValid(Actor))
     {
-      GetTilesToConsider(Actor, TilesToConsider);
+      GetTilesToConsider(Actor, LayerStreamingDistance, TilesToConsider);
+      if (bUseProxies)
+      {
+        GetTilesToConsider(Actor, ProxyStreamingDistance, ProxyTilesToConsider);
+      }
+      if (bPredictiveTileStreaming)
+      {
+        GetTilesToPrefetch(Actor, TilesToPrefetch);
+      }
     }
     else
     {
@@ -724,6 +860,10 @@ void ALargeMapManager::UpdateTilesState()
 
   UpdateCurrentTilesLoaded(TilesToBeVisible, TilesToHidde);
 
+  UpdatePrefetchedTiles(TilesToPrefetch, TilesToBeVisible.Num());
+
+  // After the full tiles, so a proxy is hidden in the frame its tile appears
+  UpdateProxyTilesState(ProxyTilesToConsider);
 }
 
 void ALargeMapManager::RemovePendingActorsToRemove()
@@ -753,7 +893,7 @@ void ALargeMapManager::RemovePendingActorsToRemove()
 
   for(FCarlaActor::IdType Id : DormantsToRemove)
   {
-    DormantActors.Remove(Id);
+    RemoveDormantActor(Id);
   }
   DormantsToRemove.Reset();
 }
@@ -763,6 +903,17 @@ void ALargeMapManager::CheckActiveActors()
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::CheckActiveActors);
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
+
+  TArray<FDVector> HeroLocations;
+  for(AActor* HeroActor : ActorsToConsider)
+  {
+    HeroLocations.Add(CurrentOriginD + HeroActor->GetActorLocation());
+  }
+  // Conservative bounds of a tile around its center
+  const double TileExtent = 2.0 * TileSide + LocalTileOffset.Size2D();
+  // Whether each tile is out of the streaming distance of all the heroes
+  TMap<TileID, bool> TilesOutOfRange;
+
   // Check if they have to be destroyed
   for(FCarlaActor::IdType Id : ActiveActors)
   {
@@ -773,7 +924,8 @@ void ALargeMapManager::CheckActiveActors()
       FVector RelativeLocation = Actor->GetActorLocation();
       FDVector WorldLocation = CurrentOriginD + RelativeLocation;
 
-      if(!IsTileLoaded(WorldLocation))
+      const TileID TileId = GetTileID(WorldLocation);
+      if(!IsTileLoaded(TileId))
       {
         // Save to temporal container. Later will be converted to dormant
         ActiveToDormantActors.Add(Id);
@@ -781,19 +933,43 @@ void ALargeMapManager::CheckActiveActors()
         continue;
       }
 
-      for(AActor* HeroActor : ActorsToConsider)
+      if (View->GetActorType() == FCarlaActor::ActorType::Sensor)
       {
-        FVector HeroLocation = HeroActor->GetActorLocation();
+        continue;
+      }
 
-        float DistanceSquared = (RelativeLocation - HeroLocation).SizeSquared();
+      bool* bTileOutOfRange = TilesOutOfRange.Find(TileId);
+      if (!bTileOutOfRange)
+      {
+        const FDVector TileCenter = GetTileLocationD(TileId);
+        bTileOutOfRange = &TilesOutOfRange.Add(TileId, IsOutOfActorStreamingDistance(
+            TileCenter - FDVector(TileExtent, TileExtent, 0.0),
+            TileCenter + FDVector(TileExtent, TileExtent, 0.0),
+            HeroLocations));
+      }
 
-        if (DistanceSquared > ActorStreamingDistanceSquared && View->GetActorType() != FCarlaActor::ActorType::Sensor)
+      // Only the actors in the tiles that cross the streaming distance need
+      // to be checked one by one
+      bool bOutOfRange = *bTileOutOfRange;
+      if (!bOutOfRange)
+      {
+        bOutOfRange = true;
+        for(const FDVector& HeroLocation : HeroLocations)
         {
-          // Save to temporal container. Later will be converted to dormant
-          ActiveToDormantActors.Add(Id);
-          ActivesToRemove.Add(Id);
+          if (FDVector::DistSquared(WorldLocation, HeroLocation) <= ActorStreamingDistanceSquared)
+          {
+            bOutOfRange = false;
+            break;
+          }
         }
       }
+
+      if (bOutOfRange)
+      {
+        // Save to temporal container. Later will be converted to dormant
+        ActiveToDormantActors.Add(Id);
+        ActivesToRemove.Add(Id);
+      }
     }
     else
     {
@@ -808,6 +984,12 @@ void ALargeMapManager::ConvertActiveToDormantActors()
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::ConvertActiveToDormantActors);
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
+  // The pool may also be enabled from the command line for destroyed actors.
+  FActorRegistry &Registry = CarlaEpisode->GetActorRegistry();
+  if (DormantVehiclePoolSize > Registry.GetActorPoolSize())
+  {
+    Registry.SetActorPoolSize(DormantVehiclePoolSize);
+  }
 
   // These actors are on dormant state so remove them from active actors
   // But save them on the dormant array first
@@ -819,7 +1001,9 @@ void ALargeMapManager::ConvertActiveToDormantActors()
     LM_LOG(Warning, "Converting Active To Dormant... %d", Id);
 
     // Need the ID of the dormant actor and save it
-    DormantActors.Add(Id);
+    FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
+    const FActorData* ActorData = View ? View->GetActorData() : nullptr;
+    AddDormantActor(Id, ActorData ? ActorData->Location : FDVector());
   }
 
   ActiveToDormantActors.Reset();
@@ -831,47 +1015,57 @@ void ALargeMapManager::CheckDormantActors()
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
 
-
-  for(FCarlaActor::IdType Id : DormantActors)
+  TArray<FDVector> HeroLocations;
+  for(AActor* Actor : ActorsToConsider)
   {
-    FCarlaActor* CarlaActor = CarlaEpisode->FindCarlaActor(Id);
+    HeroLocations.Add(CurrentOriginD + Actor->GetActorLocation());
+  }
 
-    // If the Ids don't match, the actor has been removed
-    if(!CarlaActor)
-    {
-      LM_LOG(Log, "CheckDormantActors Carla Actor %d not found", Id);
-      DormantsToRemove.Add(Id);
-      continue;
-    }
-    if(CarlaActor->GetActorId() != Id)
-    {
-      LM_LOG(Warning, "CheckDormantActors IDs doesn't match!! Wanted = %d Received = %d", Id, CarlaActor->GetActorId());
-      DormantsToRemove.Add(Id);
-      continue;
-    }
-    if (!CarlaActor->IsDormant())
+  for(auto& Cell : DormantActorsCells)
+  {
+    // Skip the whole tile if it is not loaded or it is too far from all the
+    // heroes, its actors can not wake up
+    if (!IsTileLoaded(Cell.Key) ||
+        IsOutOfActorStreamingDistance(Cell.Value.Min, Cell.Value.Max, HeroLocations))
     {
-      LM_LOG(Warning, "CheckDormantActors Carla Actor %d is not dormant", Id);
-      DormantsToRemove.Add(Id);
       continue;
     }
 
-    const FActorData* ActorData = CarlaActor->GetActorData();
-
-    for(AActor* Actor : ActorsToConsider)
+    for(FCarlaActor::IdType Id : Cell.Value.Actors)
     {
-      FVector HeroLocation = Actor->GetActorLocation();
+      FCarlaActor* CarlaActor = CarlaEpisode->FindCarlaActor(Id);
 
-      FDVector WorldLocation = ActorData->Location;
-      FDVector RelativeLocation = WorldLocation - CurrentOriginD;
+      // If the Ids don't match, the actor has been removed
+      if(!CarlaActor)
+      {
+        LM_LOG(Log, "CheckDormantActors Carla Actor %d not found", Id);
+        DormantsToRemove.Add(Id);
+        continue;
+      }
+      if(CarlaActor->GetActorId() != Id)
+      {
+        LM_LOG(Warning, "CheckDormantActors IDs doesn't match!! Wanted = %d Received = %d", Id, CarlaActor->GetActorId());
+        DormantsToRemove.Add(Id);
+        continue;
+      }
+      if (!CarlaActor->IsDormant())
+      {
+        LM_LOG(Warning, "CheckDormantActors Carla Actor %d is not dormant", Id);
+        DormantsToRemove.Add(Id);
+        continue;
+      }
 
-      float DistanceSquared = (RelativeLocation - HeroLocation).SizeSquared();
+      const FActorData* ActorData = CarlaActor->GetActorData();
+      const FDVector WorldLocation = ActorData->Location;
 
-      if(DistanceSquared < ActorStreamingDistanceSquared && IsTileLoaded(WorldLocation))
+      for(const FDVector& HeroLocation : HeroLocations)
       {
-        DormantToActiveActors.Add(Id);
-        DormantsToRemove.Add(Id);
-        break;
+        if(FDVector::DistSquared(WorldLocation, HeroLocation) < ActorStreamingDistanceSquared)
+        {
+          DormantToActiveActors.Add(Id);
+          DormantsToRemove.Add(Id);
+          break;
+        }
       }
     }
   }
@@ -883,14 +1077,26 @@ void ALargeMapManager::ConvertDormantToActiveActors()
   UWorld* World = GetWorld();
   UCarlaEpisode* CarlaEpisode = UCarlaStatics::GetCurrentEpisode(World);
 
+  // Respawning is expensive, queue them and wake up only as many as fit in
+  // the budget of this frame. The rest are not active nor dormant meanwhile.
   for(FCarlaActor::IdType Id : DormantToActiveActors)
   {
-    LM_LOG(Warning, "Converting %d Dormant To Active", Id);
+    CarlaEpisode->QueueWakeActorUp(Id);
+  }
+  DormantToActiveActors.Reset();
 
-    CarlaEpisode->WakeActorUp(Id);
+  for(FCarlaActor::IdType Id : CarlaEpisode->WakeQueuedActorsUp(ActorWakeUpTimeBudget))
+  {
+    LM_LOG(Warning, "Converting %d Dormant To Active", Id);
 
     FCarlaActor* View = CarlaEpisode->FindCarlaActor(Id);
 
+    if (!View)
+    {
+      // Destroyed while queued
+      continue;
+    }
+
     if (View->IsActive()){
       LM_LOG(Warning, "Spawning dormant at %s\n\tOrigin: %s\n\tRel. location: %s", \
         *((CurrentOriginD + View->GetActor()->GetActorLocation()).ToString()), \
@@ -902,10 +1108,81 @@ void ALargeMapManager::ConvertDormantToActiveActors()
     else
     {
       LM_LOG(Warning, "Actor %d could not be woken up, keeping sleep state", Id);
-      DormantActors.Add(Id);
+      AddDormantActor(Id, View->GetActorData()->Location);
+    }
+  }
+}
+
+void ALargeMapManager::AddDormantActor(FCarlaActor::IdType Id, const FDVector& WorldLocation)
+{
+  RemoveDormantActor(Id);
+  const TileID TileId = GetTileID(WorldLocation);
+  FDormantActorsCell* Cell = DormantActorsCells.Find(TileId);
+  if (!Cell)
+  {
+    Cell = &DormantActorsCells.Add(TileId);
+    Cell->Min = WorldLocation;
+    Cell->Max = WorldLocation;
+  }
+  else
+  {
+    Cell->Min = FDVector(
+        FMath::Min(Cell->Min.X, WorldLocation.X),
+        FMath::Min(Cell->Min.Y, WorldLocation.Y),
+        FMath::Min(Cell->Min.Z, WorldLocation.Z));
+    Cell->Max = FDVector(
+        FMath::Max(Cell->Max.X, WorldLocation.X),
+        FMath::Max(Cell->Max.Y, WorldLocation.Y),
+        FMath::Max(Cell->Max.Z, WorldLocation.Z));
+  }
+  Cell->Actors.Add(Id);
+  DormantActors.Add(Id, TileId);
+}
+
+void ALargeMapManager::RemoveDormantActor(FCarlaActor::IdType Id)
+{
+  TileID TileId;
+  if (!DormantActors.RemoveAndCopyValue(Id, TileId))
+  {
+    return;
+  }
+  FDormantActorsCell* Cell = DormantActorsCells.Find(TileId);
+  if (Cell)
+  {
+    Cell->Actors.Remove(Id);
+    if (Cell->Actors.Num() == 0)
+    {
+      DormantActorsCells.Remove(TileId);
     }
   }
-  DormantToActiveActors.Reset();
+}
+
+void ALargeMapManager::OnDormantActorMoved(FCarlaActor::IdType Id, const FDVector& WorldLocation)
+{
+  if (DormantActors.Contains(Id))
+  {
+    AddDormantActor(Id, WorldLocation);
+  }
+}
+
+bool ALargeMapManager::IsOutOfActorStreamingDistance(
+  const FDVector& InMin,
+  const FDVector& InMax,
+  const TArray<FDVector>& InHeroLocations) const
+{
+  for (const FDVector& HeroLocation : InHeroLocations)
+  {
+    // Closest point of the box to the hero
+    const FDVector Closest(
+        FMath::Clamp(HeroLocation.X, InMin.X, InMax.X),
+        FMath::Clamp(HeroLocation.Y, InMin.Y, InMax.Y),
+        FMath::Clamp(HeroLocation.Z, InMin.Z, InMax.Z));
+    if (FDVector::DistSquared(Closest, HeroLocation) <= ActorStreamingDistanceSquared)
+    {
+      return false;
+    }
+  }
+  return true;
 }
 
 void ALargeMapManager::CheckIfRebaseIsNeeded()
@@ -932,6 +1209,7 @@ void ALargeMapManager::CheckIfRebaseIsNeeded()
 }
 
 void ALargeMapManager::GetTilesToConsider(const AActor* ActorToConsider,
+                                          float InStreamingDistance,
                                           TSet<TileID>& OutTilesToConsider)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::GetTilesToConsider);
@@ -943,8 +1221,8 @@ void ALargeMapManager::GetTilesToConsider(const AActor* ActorToConsider,
   FIntVector CurrentTile = GetTileVectorID(ActorLocation);
 
   // Calculate tile bounds
-  FDVector UpperPos = ActorLocation + FDVector(LayerStreamingDistance,LayerStreamingDistance,0);
-  FDVector LowerPos = ActorLocation + FDVector(-LayerStreamingDistance,-LayerStreamingDistance,0);
+  FDVector UpperPos = ActorLocation + FDVector(InStreamingDistance,InStreamingDistance,0);
+  FDVector LowerPos = ActorLocation + FDVector(-InStreamingDistance,-InStreamingDistance,0);
   FIntVector UpperTileId = GetTileVectorID(UpperPos);
   FIntVector LowerTileId = GetTileVectorID(LowerPos);
   for (int Y = UpperTileId.Y; Y <= LowerTileId.Y; Y++)
@@ -968,6 +1246,151 @@ void ALargeMapManager::GetTilesToConsider(const AActor* ActorToConsider,
   }
 }
 
+void ALargeMapManager::GetTilesToPrefetch(const AActor* ActorToConsider,
+                                          TMap<TileID, float>& OutTilesToPrefetch)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::GetTilesToPrefetch);
+  check(ActorToConsider);
+  const FVector Velocity = ActorToConsider->GetVelocity();
+  const float Speed = Velocity.Size2D();
+  if (Speed < TilePrefetchMinSpeed || TilePrefetchTime <= 0.0f)
+  {
+    return;
+  }
+  // World location
+  const FDVector ActorLocation = CurrentOriginD + ActorToConsider->GetActorLocation();
+  const float Horizon = Speed * TilePrefetchTime;
+
+  // Follow the lanes ahead of the actor, all the branches, as these are the
+  // routes the traffic manager can plan from there
+  bool bFollowedRoad = false;
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  if (GameMode && GameMode->GetMap())
+  {
+    const carla::road::Map& Map = *GameMode->GetMap();
+    auto Waypoint = Map.GetWaypoint(carla::geom::Location(ActorLocation.ToFVector()));
+    if (Waypoint &&
+        FVector::DotProduct(Map.ComputeTransform(*Waypoint).GetForwardVector().ToFVector(), Velocity) > 0.0f)
+    {
+      bFollowedRoad = true;
+      const float Step = FMath::Min(LARGEMAP_PREFETCH_ROAD_STEP, Horizon);
+      TArray<TPair<carla::road::element::Waypoint, float>> Open;
+      Open.Emplace(*Waypoint, 0.0f);
+      // Breadth first, so that the waypoints budget is shared by the branches
+      for (int32 i = 0; i < Open.Num() && i < LARGEMAP_MAX_PREFETCH_WAYPOINTS; ++i)
+      {
+        const float Distance = Open[i].Value + Step;
+        if (Distance > Horizon)
+        {
+          continue;
+        }
+        for (const auto& Next : Map.GetNext(Open[i].Key, 1e-2 * Step))
+        {
+          const FVector Location = Map.ComputeTransform(Next).location;
+          AddTilesToPrefetch(FDVector(Location), Distance / Speed, OutTilesToPrefetch);
+          Open.Emplace(Next, Distance);
+        }
+      }
+    }
+  }
+
+  // Otherwise, extrapolate the velocity
+  if (!bFollowedRoad)
+  {
+    const FVector Direction = Velocity.GetSafeNormal2D();
+    const float Step = FMath::Min(FMath::Max(0.5f * FMath::Min(TileSide, LayerStreamingDistance), 100.0f), Horizon);
+    for (float Distance = Step; Distance <= Horizon; Distance += Step)
+    {
+      AddTilesToPrefetch(ActorLocation + FDVector(Direction * Distance), Distance / Speed, OutTilesToPrefetch);
+    }
+  }
+}
+
+void ALargeMapManager::AddTilesToPrefetch(
+  const FDVector& InLocation,
+  float InTimeToArrival,
+  TMap<TileID, float>& OutTilesToPrefetch)
+{
+  // The same tiles GetTilesToConsider would load at that location
+  FDVector UpperPos = InLocation + FDVector(LayerStreamingDistance,LayerStreamingDistance,0);
+  FDVector LowerPos = InLocation + FDVector(-LayerStreamingDistance,-LayerStreamingDistance,0);
+  FIntVector UpperTileId = GetTileVectorID(UpperPos);
+  FIntVector LowerTileId = GetTileVectorID(LowerPos);
+  for (int Y = UpperTileId.Y; Y <= LowerTileId.Y; Y++)
+  {
+    for (int X = LowerTileId.X; X <= UpperTileId.X; X++)
+    {
+      TileID TileID = GetTileID(FIntVector(X, Y, 0));
+      if (!MapTiles.Contains(TileID))
+      {
+        continue; // Tile does not exist, discard
+      }
+      float* TimeToArrival = OutTilesToPrefetch.Find(TileID);
+      if (!TimeToArrival)
+      {
+        OutTilesToPrefetch.Add(TileID, InTimeToArrival);
+      }
+      else if (InTimeToArrival < *TimeToArrival)
+      {
+        *TimeToArrival = InTimeToArrival;
+      }
+    }
+  }
+}
+
+void ALargeMapManager::UpdatePrefetchedTiles(
+  const TMap<TileID, float>& InTilesToPrefetch,
+  int32 InNumTilesLoadedThisFrame)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::UpdatePrefetchedTiles);
+
+  // Tiles that became visible are no longer prefetched, and tiles that are
+  // no longer ahead of any hero are unloaded
+  TSet<TileID> TilesToUnload;
+  for (auto It = PrefetchedTiles.CreateIterator(); It; ++It)
+  {
+    const TileID TileID = *It;
+    if (CurrentTilesLoaded.Contains(TileID))
+    {
+      It.RemoveCurrent();
+    }
+    else if (!InTilesToPrefetch.Contains(TileID))
+    {
+      TilesToUnload.Add(TileID);
+      It.RemoveCurrent();
+    }
+  }
+  UpdateTileState(TilesToUnload, false, false, false);
+
+  // The tiles to load, the soonest to be reached first
+  int32 Budget = MaxTileLoadsPerFrame - InNumTilesLoadedThisFrame;
+  if (Budget <= 0)
+  {
+    return;
+  }
+  TArray<TPair<float, TileID>> Candidates;
+  for (const auto& Element : InTilesToPrefetch)
+  {
+    if (!CurrentTilesLoaded.Contains(Element.Key) && !PrefetchedTiles.Contains(Element.Key))
+    {
+      Candidates.Emplace(Element.Value, Element.Key);
+    }
+  }
+  Candidates.Sort([](const TPair<float, TileID>& A, const TPair<float, TileID>& B)
+  {
+    return A.Key < B.Key;
+  });
+
+  TSet<TileID> TilesToLoad;
+  for (int32 i = 0; i < Candidates.Num() && i < Budget; ++i)
+  {
+    TilesToLoad.Add(Candidates[i].Value);
+  }
+  // Load in the background, it will be made visible when in range
+  UpdateTileState(TilesToLoad, false, true, false);
+  PrefetchedTiles.Append(TilesToLoad);
+}
+
 void ALargeMapManager::GetTilesThatNeedToChangeState(
   const TSet<TileID>& InTilesToConsider,
   TSet<TileID>& OutTilesToBeVisible,
@@ -1016,6 +1439,52 @@ void ALargeMapManager::UpdateCurrentTilesLoaded(
   }
 }
 
+void ALargeMapManager::UpdateProxyTilesState(const TSet<TileID>& InTilesInRange)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALargeMapManager::UpdateProxyTilesState);
+  for (const TileID TileID : CurrentProxyTilesLoaded.Difference(InTilesInRange))
+  {
+    FCarlaMapTile* CarlaTile = MapTiles.Find(TileID);
+    if (CarlaTile && CarlaTile->ProxyStreamingLevel)
+    {
+      CarlaTile->ProxyStreamingLevel->SetShouldBeLoaded(false);
+      CarlaTile->ProxyStreamingLevel->SetShouldBeVisible(false);
+    }
+  }
+
+  TSet<TileID> ProxyTilesLoaded;
+  for (const TileID TileID : InTilesInRange)
+  {
+    FCarlaMapTile* CarlaTile = MapTiles.Find(TileID);
+    if (!CarlaTile || !CarlaTile->ProxyStreamingLevel)
+    {
+      continue;
+    }
+    // The proxies near the heroes stay loaded but hidden, so they show up
+    // without a gap when their full tile is unloaded
+    const ULevelStreamingDynamic* StreamingLevel = CarlaTile->StreamingLevel;
+    const bool bTileVisible = CurrentTilesLoaded.Contains(TileID) &&
+        StreamingLevel && StreamingLevel->IsLevelVisible();
+    CarlaTile->ProxyStreamingLevel->SetShouldBeLoaded(true);
+    CarlaTile->ProxyStreamingLevel->SetShouldBeVisible(!bTileVisible);
+    ProxyTilesLoaded.Add(TileID);
+  }
+  CurrentProxyTilesLoaded = MoveTemp(ProxyTilesLoaded);
+}
+
+bool ALargeMapManager::IsTileProxyLevel(const ULevel* InLevel) const
+{
+  for (const auto& It : MapTiles)
+  {
+    const ULevelStreamingDynamic* ProxyStreamingLevel = It.Value.ProxyStreamingLevel;
+    if (ProxyStreamingLevel && ProxyStreamingLevel->GetLoadedLevel() == InLevel)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 FString ALargeMapManager::GenerateTileName(TileID TileID)
 {
   int32 X = (int32)(TileID >> 32);
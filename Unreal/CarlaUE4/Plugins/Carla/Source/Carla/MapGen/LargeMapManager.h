@@ -38,6 +38,16 @@ struct FActiveActor
   FQuat Rotation;
 };
 
+// 一个瓦片中的休眠参与者，以及它们位置的包围盒（只在清空时重置）
+struct FDormantActorsCell
+{
+  TSet<FCarlaActor::IdType> Actors;
+
+  FDVector Min;
+
+  FDVector Max;
+};
+
 USTRUCT(BlueprintType)
 struct FCarlaMapTile
 {
@@ -54,6 +64,11 @@ struct FCarlaMapTile
   UPROPERTY(VisibleAnywhere,  BlueprintReadWrite, Category = "Carla Map Tile")
   ULevelStreamingDynamic* StreamingLevel = nullptr;
 
+  // 瓦片的低细节代理（BakeTileProxies 命令行工具烘焙的 <瓦片>_HLOD 关卡），
+  // 没有烘焙时为空
+  UPROPERTY(VisibleAnywhere,  BlueprintReadWrite, Category = "Carla Map Tile")
+  ULevelStreamingDynamic* ProxyStreamingLevel = nullptr;
+
   bool TilesSpawned = false;
 };
 
@@ -113,6 +128,9 @@ public:
 
   void AddActorToUnloadedList(const FCarlaActor& CarlaActor, const FTransform& Transform);
 
+  // 休眠参与者的位置（全局）改变时调用，更新它所在的瓦片
+  void OnDormantActorMoved(FCarlaActor::IdType Id, const FDVector& WorldLocation);
+
   UFUNCTION(BlueprintCallable, Category = "Large Map Manager")
   FIntVector GetNumTilesInXY() const;
 
@@ -167,6 +185,10 @@ public:
 
   float GetActorStreamingDistance() const;
 
+  void SetProxyStreamingDistance(float Distance);
+
+  float GetProxyStreamingDistance() const;
+
   UFUNCTION(BlueprintCallable, Category = "Large Map Manager")
   FIntVector GetTileVectorID(FVector TileLocation) const;
 
@@ -216,6 +238,9 @@ protected:
 
   void RemovePendingActorsToRemove();
 
+  // 在时间预算内为新加载的瓦片设置语义标签，完成后注册瓦片中的对象
+  void TagPendingLevels();
+
   //检查是否有任何处于活动状态的参与者需要转换为休眠状态的参与者。
   //因为它超出了范围（参与者流送距离）
  // 仅存储所选参与者的数组
@@ -232,10 +257,21 @@ protected:
   // 将超出范围的活动参与者转换为休眠参与者。
   void ConvertDormantToActiveActors();
 
+  void AddDormantActor(FCarlaActor::IdType Id, const FDVector& WorldLocation);
+
+  void RemoveDormantActor(FCarlaActor::IdType Id);
+
+  // 包围盒 [InMin, InMax] 是否在所有主车的参与者流送距离以外
+  bool IsOutOfActorStreamingDistance(
+    const FDVector& InMin,
+    const FDVector& InMax,
+    const TArray<FDVector>& InHeroLocations) const;
+
   void CheckIfRebaseIsNeeded();
 
   void GetTilesToConsider(
     const AActor* ActorToConsider,
+    float InStreamingDistance,
     TSet<TileID>& OutTilesToConsider);
 
   void GetTilesThatNeedToChangeState(
@@ -253,6 +289,31 @@ protected:
     const TSet<TileID>& InTilesToBeVisible,
     const TSet<TileID>& InTilesToHidde);
 
+  // 在后台加载 ProxyStreamingDistance 以内瓦片的代理，完整的瓦片不可见时
+  // 显示代理，并卸载范围以外的代理
+  void UpdateProxyTilesState(const TSet<TileID>& InTilesInRange);
+
+  // InLevel 是否是某个瓦片的代理关卡
+  bool IsTileProxyLevel(const ULevel* InLevel) const;
+
+  // 沿着参与者的预测轨迹（速度和前方的车道）找到将要进入流送距离的瓦片，
+  // 以及到达它们的时间（秒）
+  void GetTilesToPrefetch(
+    const AActor* ActorToConsider,
+    TMap<TileID, float>& OutTilesToPrefetch);
+
+  // 把流送距离内 InLocation 周围的瓦片加入 OutTilesToPrefetch
+  void AddTilesToPrefetch(
+    const FDVector& InLocation,
+    float InTimeToArrival,
+    TMap<TileID, float>& OutTilesToPrefetch);
+
+  // 按到达时间的顺序在后台加载（不可见）要预取的瓦片，每帧最多
+  // MaxTileLoadsPerFrame 个，并卸载不再需要的预取瓦片
+  void UpdatePrefetchedTiles(
+    const TMap<TileID, float>& InTilesToPrefetch,
+    int32 InNumTilesLoadedThisFrame);
+
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   TMap<uint64, FCarlaMapTile> MapTiles;
 
@@ -265,8 +326,12 @@ protected:
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   AActor* Spectator = nullptr;
   //UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
-  TArray<FCarlaActor::IdType> ActiveActors;
-  TArray<FCarlaActor::IdType> DormantActors;
+  TSet<FCarlaActor::IdType> ActiveActors;
+
+  // 休眠参与者按所在的瓦片分组，这样只需要检查流送距离边界附近的瓦片中的参与者
+  TMap<TileID, FDormantActorsCell> DormantActorsCells;
+  // 每个休眠参与者所在的瓦片
+  TMap<FCarlaActor::IdType, TileID> DormantActors;
 
   //临时集合用于移除参与者。这样做只是为了避免在更新循环中移除它们。
   TSet<AActor*> ActorsToRemove;
@@ -280,6 +345,14 @@ protected:
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   TSet<uint64> CurrentTilesLoaded;
 
+  // 已经在后台加载但还不可见的瓦片
+  UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
+  TSet<uint64> PrefetchedTiles;
+
+  // 代理关卡已经加载（可见或隐藏）的瓦片
+  UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
+  TSet<uint64> CurrentProxyTilesLoaded;
+
   // 重新定基准后的当前原点。
   UPROPERTY(VisibleAnywhere, Category = "Large Map Manager")
   FIntVector CurrentOriginInt{ 0 };
@@ -301,6 +374,11 @@ protected:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
   float RebaseOriginDistance = 2.0f * 1000.0f * 100.0f;
 
+  // 超出 LayerStreamingDistance 但在这个距离以内的瓦片显示它们的代理，
+  // 不大于 LayerStreamingDistance 时不使用代理
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float ProxyStreamingDistance = 6.0f * 1000.0f * 100.0f;
+
   float LayerStreamingDistanceSquared = LayerStreamingDistance * LayerStreamingDistance;
   float ActorStreamingDistanceSquared = ActorStreamingDistance * ActorStreamingDistance;
   float RebaseOriginDistanceSquared = RebaseOriginDistance * RebaseOriginDistance;
@@ -314,6 +392,45 @@ protected:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
   bool ShouldTilesBlockOnLoad = false;
 
+  // 根据主车的速度和前方的车道预取瓦片，避免高速行驶时加载瓦片造成卡顿
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  bool bPredictiveTileStreaming = true;
+
+  // 预测轨迹的时间范围（秒）
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float TilePrefetchTime = 10.0f;
+
+  // 低于这个速度（cm/s）时不预取
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float TilePrefetchMinSpeed = 100.0f;
+
+  // 每帧最多开始加载的瓦片数量，包括进入流送距离的瓦片
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  int32 MaxTileLoadsPerFrame = 1;
+
+  // 每帧唤醒休眠参与者的时间（秒），其余的留到之后的帧
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float ActorWakeUpTimeBudget = 0.005f;
+
+  // 每种蓝图最多保留的隐藏车辆，唤醒时重新使用而不是重新生成，0 表示使用注册表
+  // 的池大小（-carla-actor-pool-size，默认不使用）
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  int32 DormantVehiclePoolSize = 0;
+
+  // 每帧为新加载的瓦片设置语义标签的时间（秒），为 0 时在加载时一次完成
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Large Map Manager")
+  float TileTaggingTimeBudget = 0.002f;
+
+  struct FPendingLevelTagging
+  {
+    TWeakObjectPtr<ULevel> Level;
+
+    int32 NextActorIndex = 0;
+  };
+
+  // 等待设置标签的瓦片，按加载顺序处理
+  TArray<FPendingLevelTagging> LevelsToTag;
+
 
   void RegisterTilesInWorldComposition();
 
@@ -3,6 +3,8 @@
 
 #include "ProceduralBuilding.h"
 
+#include "Carla.h"
+#include "EngineUtils.h"
 
 // Sets default values
 AProceduralBuilding::AProceduralBuilding()
@@ -29,10 +31,8 @@ UHierarchicalInstancedStaticMeshComponent* AProceduralBuilding::GetHISMComp(
 
   if(HISMCompPtr) return *HISMCompPtr;
 
-  UHierarchicalInstancedStaticMeshComponent* HISMComp = *HISMCompPtr;
-
   // If it doesn't exist, create the component
-  HISMComp = NewObject<UHierarchicalInstancedStaticMeshComponent>(this,
+  UHierarchicalInstancedStaticMeshComponent* HISMComp = NewObject<UHierarchicalInstancedStaticMeshComponent>(this,
     FName(*FString::Printf(TEXT("HISMComp_%d"), HISMComps.Num())));
   HISMComp->SetupAttachment(RootComponent);
   HISMComp->RegisterComponent();
@@ -133,6 +133,52 @@ void AProceduralBuilding::HideAllChildren()
   }
 }
 
+void AProceduralBuilding::MergeBuildingsOfLevel()
+{
+  ULevel* Level = GetLevel();
+  if(!Level) return;
+
+  TArray<AProceduralBuilding*> Buildings;
+  for(TActorIterator<AProceduralBuilding> It(GetWorld()); It; ++It)
+  {
+    if(*It != this && It->GetLevel() == Level && !It->IsPendingKill())
+    {
+      Buildings.Add(*It);
+    }
+  }
+
+  Modify();
+  int NumMerged = 0;
+  for(AProceduralBuilding* Building : Buildings)
+  {
+    // Child actors can't be instanced, keep the whole building
+    if(Building->ChildActorComps.Num() > 0) continue;
+
+    TArray<UHierarchicalInstancedStaticMeshComponent*> OtherHISMComps;
+    Building->GetComponents<UHierarchicalInstancedStaticMeshComponent>(OtherHISMComps);
+
+    for(UHierarchicalInstancedStaticMeshComponent* OtherHISMComp : OtherHISMComps)
+    {
+      const UStaticMesh* SM = OtherHISMComp->GetStaticMesh();
+      if(!SM) continue;
+
+      UHierarchicalInstancedStaticMeshComponent* HISMComp = GetHISMComp(SM);
+      for(int32 i = 0; i < OtherHISMComp->GetInstanceCount(); i++)
+      {
+        FTransform Transform;
+        OtherHISMComp->GetInstanceTransform(i, Transform, true);
+        HISMComp->AddInstanceWorldSpace(Transform);
+      }
+    }
+
+    Building->Destroy();
+    NumMerged++;
+  }
+
+  UE_LOG(LogCarla, Log, TEXT("Merged %d of %d procedural buildings into '%s'"),
+    NumMerged, Buildings.Num(), *GetName());
+}
+
 void AProceduralBuilding::SetBaseParameters(
   const TSet<int>& InDoorsIndexPosition,
   const TArray<bool>& InUseWallMesh,
@@ -43,6 +43,15 @@ public:
   UFUNCTION(BlueprintCallable, CallInEditor, Category="Procedural Building")
   void HideAllChildren();
 
+  /**
+   *  Moves the instances of the other procedural buildings of this level (tile)
+   *  into the HISM components of this one and destroys them, so each mesh of
+   *  the whole tile is drawn by a single component. Buildings using blueprint
+   *  parts are left untouched.
+   */
+  UFUNCTION(BlueprintCallable, CallInEditor, Category="Procedural Building")
+  void MergeBuildingsOfLevel();
+
   UFUNCTION(BlueprintCallable, Category="Procedural Building|Conversion")
   void SetBaseParameters(
     const TSet<int>& InDoorsIndexPosition,
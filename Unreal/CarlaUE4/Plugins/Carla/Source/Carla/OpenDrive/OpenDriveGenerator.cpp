@@ -5,6 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "Carla.h"
+#include "Carla/Game/CarlaEpisode.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "OpenDriveGenerator.h"
 #include "Traffic/TrafficLightManager.h"
@@ -17,6 +18,12 @@
 
 #include "Engine/Classes/Interfaces/Interface_CollisionDataProvider.h"
 #include "PhysicsCore/Public/BodySetupEnums.h"
+#include "Async/Async.h"
+#include "Kismet/GameplayStatics.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 AProceduralMeshActor::AProceduralMeshActor()
 {
@@ -28,7 +35,9 @@ AProceduralMeshActor::AProceduralMeshActor()
 AOpenDriveGenerator::AOpenDriveGenerator(const FObjectInitializer &ObjectInitializer)
   : Super(ObjectInitializer)
 {
-  PrimaryActorTick.bCanEverTick = false;
+  // Only ticks while streaming the road mesh
+  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.bStartWithTickEnabled = false;
   RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneComponent"));
   SetRootComponent(RootComponent);
   RootComponent->Mobility = EComponentMobility::Static;
@@ -77,39 +86,16 @@ void AOpenDriveGenerator::GenerateRoadMesh()
     carla::log_warning("Missing game instance");
   }
 
+  if (Parameters.enable_mesh_streaming)
+  {
+    GenerateRoadMeshStreaming(Parameters);
+    return;
+  }
+
   auto& CarlaMap = UCarlaStatics::GetGameMode(GetWorld())->GetMap();
   const auto Meshes = CarlaMap->GenerateChunkedMesh(Parameters);
   for (const auto &Mesh : Meshes) {
-    if (!Mesh->GetVertices().size())
-    {
-      continue;
-    }
-    AProceduralMeshActor* TempActor = GetWorld()->SpawnActor<AProceduralMeshActor>();
-    UProceduralMeshComponent *TempPMC = TempActor->MeshComponent;
-    TempPMC->bUseAsyncCooking = true;
-    TempPMC->bUseComplexAsSimpleCollision = true;
-    TempPMC->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-
-    const FProceduralCustomMesh MeshData = *Mesh;
-    TempPMC->CreateMeshSection_LinearColor(
-        0,
-        MeshData.Vertices,
-        MeshData.Triangles,
-        MeshData.Normals,
-        TArray<FVector2D>(), // UV0
-        TArray<FLinearColor>(), // VertexColor
-        TArray<FProcMeshTangent>(), // Tangents
-        true); // Create collision
-
-    ActorMeshList.Add(TempActor);
-  }
-
-  if(!Parameters.enable_mesh_visibility)
-  {
-    for(AActor * actor : ActorMeshList)
-    {
-      actor->SetActorHiddenInGame(true);
-    }
+    SpawnRoadMeshActor(*Mesh, Parameters.enable_mesh_visibility);
   }
 
   // // Build collision data
@@ -129,6 +115,192 @@ void AOpenDriveGenerator::GenerateRoadMesh()
   // }
 }
 
+void AOpenDriveGenerator::SpawnRoadMeshActor(const carla::geom::Mesh &Mesh, const bool bVisible)
+{
+  if (!Mesh.GetVertices().size())
+  {
+    return;
+  }
+  AProceduralMeshActor* TempActor = GetWorld()->SpawnActor<AProceduralMeshActor>();
+  UProceduralMeshComponent *TempPMC = TempActor->MeshComponent;
+  TempPMC->bUseAsyncCooking = true;
+  TempPMC->bUseComplexAsSimpleCollision = true;
+  TempPMC->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+  const FProceduralCustomMesh MeshData = Mesh;
+  TempPMC->CreateMeshSection_LinearColor(
+      0,
+      MeshData.Vertices,
+      MeshData.Triangles,
+      MeshData.Normals,
+      TArray<FVector2D>(), // UV0
+      TArray<FLinearColor>(), // VertexColor
+      TArray<FProcMeshTangent>(), // Tangents
+      true); // Create collision
+
+  if (!bVisible)
+  {
+    TempActor->SetActorHiddenInGame(true);
+  }
+  ActorMeshList.Add(TempActor);
+}
+
+TArray<FVector> AOpenDriveGenerator::GetStreamingFocusLocations() const
+{
+  TArray<FVector> Locations;
+  UWorld *World = GetWorld();
+  // The spectator is the pawn of the first player
+  if (const APawn *Spectator = UGameplayStatics::GetPlayerPawn(World, 0))
+  {
+    Locations.Add(Spectator->GetActorLocation());
+  }
+  if (UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(World))
+  {
+    for (const auto &Pair : Episode->GetActorRegistry())
+    {
+      const FCarlaActor *CarlaActor = Pair.Value.Get();
+      if (CarlaActor == nullptr || CarlaActor->GetActor() == nullptr)
+      {
+        continue;
+      }
+      const FActorAttribute *Role =
+          CarlaActor->GetActorInfo()->Description.Variations.Find("role_name");
+      if (Role != nullptr && Role->Value == "hero")
+      {
+        Locations.Add(CarlaActor->GetActor()->GetActorLocation());
+      }
+    }
+  }
+  if (Locations.Num() == 0)
+  {
+    Locations.Add(FVector::ZeroVector);
+  }
+  return Locations;
+}
+
+void AOpenDriveGenerator::GenerateRoadMeshStreaming(
+    const carla::rpc::OpendriveGenerationParameters &Parameters)
+{
+  auto& CarlaMap = UCarlaStatics::GetGameMode(GetWorld())->GetMap();
+  // The map belongs to the game mode, EndPlay waits for the task before it
+  // can be destroyed
+  const carla::road::Map *Map = &*CarlaMap;
+
+  std::vector<carla::geom::Location> Focus;
+  for (const FVector &Location : GetStreamingFocusLocations())
+  {
+    Focus.emplace_back(Location);
+  }
+  carla::geom::Vector3D MinPosition;
+  carla::geom::Vector3D MaxPosition;
+  Map->GetMeshGenerationBounds(MinPosition, MaxPosition);
+
+  bStreamedMeshVisible = Parameters.enable_mesh_visibility;
+  bCancelStreaming = false;
+  bStreamingFinished = false;
+  StreamingStartSeconds = FPlatformTime::Seconds();
+
+  StreamingTask = Async(EAsyncExecution::Thread,
+      [this, Map, Parameters, MinPosition, MaxPosition, Focus]()
+  {
+    const float ChunkSize = static_cast<float>(std::max(Parameters.max_road_length, 1.0));
+    try
+    {
+      Map->GenerateOrderedChunkedMeshInLocations(
+          Parameters, MinPosition, MaxPosition, Focus,
+          [&](carla::road::Map::MeshChunk &&Chunk)
+      {
+        if (bCancelStreaming)
+        {
+          throw std::runtime_error("road mesh streaming cancelled");
+        }
+        FStreamedChunk Streamed;
+        Streamed.Mesh = std::make_unique<carla::geom::Mesh>();
+        for (const auto &Pair : Chunk.meshes)
+        {
+          for (const auto &LaneMesh : Pair.second)
+          {
+            *Streamed.Mesh += *LaneMesh;
+          }
+        }
+        // Same chunk layout as GenerateOrderedChunkedMeshInLocations
+        const float CenterX = MinPosition.x + (static_cast<float>(Chunk.x) + 0.5f) * ChunkSize;
+        const float CenterY = MinPosition.y - (static_cast<float>(Chunk.y) + 0.5f) * ChunkSize;
+        Streamed.DistanceSquared = std::numeric_limits<float>::max();
+        for (const auto &Location : Focus)
+        {
+          Streamed.DistanceSquared = std::min(
+              Streamed.DistanceSquared,
+              FMath::Square(Location.x - CenterX) + FMath::Square(Location.y - CenterY));
+        }
+        StreamedChunks.Enqueue(MoveTemp(Streamed));
+      });
+    }
+    catch (const std::exception &Error)
+    {
+      if (!bCancelStreaming)
+      {
+        UE_LOG(LogCarla, Error, TEXT("Road mesh streaming failed: %s"), UTF8_TO_TCHAR(Error.what()));
+      }
+    }
+    bStreamingFinished = true;
+  });
+
+  // The chunks are generated nearest first, wait only until the first one
+  // out of the focus radius
+  const float MaxDistanceSquared = FMath::Square(StreamingFocusRadius / 100.f);
+  while (!SpawnStreamedChunks(MAX_int32, MaxDistanceSquared))
+  {
+    if (bStreamingFinished && StreamedChunks.IsEmpty())
+    {
+      break;
+    }
+    FPlatformProcess::Sleep(0.001f);
+  }
+  UE_LOG(LogCarla, Log, TEXT("Road mesh around %d focus locations ready in %.2f s, streaming the rest"),
+      static_cast<int32>(Focus.size()), FPlatformTime::Seconds() - StreamingStartSeconds);
+  SetActorTickEnabled(true);
+}
+
+bool AOpenDriveGenerator::SpawnStreamedChunks(const int32 MaxChunks, const float MaxDistanceSquared)
+{
+  FStreamedChunk Chunk;
+  for (int32 Count = 0; Count < MaxChunks && StreamedChunks.Dequeue(Chunk); ++Count)
+  {
+    SpawnRoadMeshActor(*Chunk.Mesh, bStreamedMeshVisible);
+    if (Chunk.DistanceSquared > MaxDistanceSquared)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void AOpenDriveGenerator::Tick(float DeltaSeconds)
+{
+  Super::Tick(DeltaSeconds);
+  // Read before spawning, every chunk is queued when the task finishes
+  const bool bFinished = bStreamingFinished;
+  SpawnStreamedChunks(StreamingChunksPerTick, std::numeric_limits<float>::max());
+  if (bFinished && StreamedChunks.IsEmpty())
+  {
+    UE_LOG(LogCarla, Log, TEXT("Road mesh streaming finished in %.2f s"),
+        FPlatformTime::Seconds() - StreamingStartSeconds);
+    SetActorTickEnabled(false);
+  }
+}
+
+void AOpenDriveGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (StreamingTask.IsValid())
+  {
+    bCancelStreaming = true;
+    StreamingTask.Wait();
+    StreamingTask = {};
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
 void AOpenDriveGenerator::GeneratePoles()
 {
   if (!IsOpenDriveValid())
@@ -8,6 +8,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "ProceduralMeshComponent.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <boost/optional.hpp>
@@ -16,6 +18,9 @@
 
 #include "Vehicle/VehicleSpawnPoint.h"
 
+#include <atomic>
+#include <memory>
+
 #include "OpenDriveGenerator.generated.h"
 
 UCLASS()
@@ -58,10 +63,23 @@ public:
 
   void GenerateAll();
 
+  virtual void Tick(float DeltaSeconds) override;
+
 protected:
 
   virtual void BeginPlay() override;
 
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  /// ʽʱʼ缯֮ǰɾ۲߻ڴ˷Χڣף
+  /// ֿ飬ֿں̨ɡ
+  UPROPERTY(Category = "Streaming", EditAnywhere)
+  float StreamingFocusRadius = 30000.f;
+
+  /// ʽʱÿ֡ഴķֿ
+  UPROPERTY(Category = "Streaming", EditAnywhere)
+  int32 StreamingChunksPerTick = 4;
+
   /// ȷÿRoutePlannerķø߶
   UPROPERTY(Category = "Spawners", EditAnywhere)
   float SpawnersHeight = 300.f;
@@ -75,4 +93,39 @@ protected:
   UPROPERTY(EditAnywhere)
   TArray<AActor *> ActorMeshList;
 
+private:
+
+  /// ̨߳ꡢȴϷ߳дķֿ顣
+  struct FStreamedChunk
+  {
+    std::unique_ptr<carla::geom::Mesh> Mesh;
+
+    /// ֿĵĽˮƽϵľƽף
+    float DistanceSquared = 0.f;
+  };
+
+  /// ں̨뽹ľɽԶŵͼ񣬷ǰ㸽
+  /// ֿ飬 Tick д
+  void GenerateRoadMeshStreaming(const carla::rpc::OpendriveGenerationParameters &Parameters);
+
+  /// ۲ߺλãûʱΪԭ㡣
+  TArray<FVector> GetStreamingFocusLocations() const;
+
+  void SpawnRoadMeshActor(const carla::geom::Mesh &Mesh, bool bVisible);
+
+  ///  @a MaxChunks ɵķֿ飬ƽ
+  /// @a MaxDistanceSquared ķֿʱڴֹ֮ͣ true
+  bool SpawnStreamedChunks(int32 MaxChunks, float MaxDistanceSquared);
+
+  TQueue<FStreamedChunk, EQueueMode::Mpsc> StreamedChunks;
+
+  TFuture<void> StreamingTask;
+
+  std::atomic<bool> bCancelStreaming{false};
+
+  std::atomic<bool> bStreamingFinished{false};
+
+  bool bStreamedMeshVisible = true;
+
+  double StreamingStartSeconds = 0.0;
 };
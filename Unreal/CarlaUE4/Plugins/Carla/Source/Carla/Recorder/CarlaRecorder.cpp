@@ -80,6 +80,21 @@ void ACarlaRecorder::SetReplayerIgnoreSpectator(bool IgnoreSpectator)
   Replayer.SetIgnoreSpectator(IgnoreSpectator);
 }
 
+void ACarlaRecorder::SetReplayerSkipPhysics(bool SkipPhysics)
+{
+  Replayer.SetSkipPhysics(SkipPhysics);
+}
+
+void ACarlaRecorder::SetReplayerFrameStep(bool FrameStep)
+{
+  Replayer.SetFrameStep(FrameStep);
+}
+
+uint64_t ACarlaRecorder::GetReplayerFrame(void)
+{
+  return Replayer.GetFrameId();
+}
+
 void ACarlaRecorder::StopReplayer(bool KeepActors)
 {
   Replayer.Stop(KeepActors);
@@ -413,7 +428,7 @@ void ACarlaRecorder::AddActorBones(FCarlaActor *CarlaActor)
   WalkersBones.Add(std::move(Walker));
 }
 
-std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool AdditionalData)
+std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool AdditionalData, bool Compressed)
 {
   // stop replayer if any in course
   if (Replayer.IsEnabled())
@@ -429,7 +444,7 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   std::string Filename = GetRecorderFilename(Name);
 
   // binary file
-  File.open(Filename, std::ios::binary);
+  File.open(Filename, Compressed);
   if (!File.is_open())
   {
     return "";
@@ -444,7 +459,77 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   // write general info
   Info.Write(File);
 
+  StartFrames(AdditionalData, CarlaRecorderFrameIndex::DefaultKeyFrameInterval);
+
+  return std::string(Filename);
+}
+
+std::string ACarlaRecorder::StartRing(std::string Name, FString MapName, double Seconds,
+    double SecondsAfter, bool AdditionalData, bool Compressed)
+{
+  // stop replayer if any in course
+  if (Replayer.IsEnabled())
+    Replayer.Stop();
+
+  // stop recording
+  Stop();
+
+  // reset collisions Id
+  NextCollisionId = 0;
+
+  // get the final path + filename, the files written get a counter
+  std::string Filename = GetRecorderFilename(Name);
+  Ring.Start(Filename, Seconds, SecondsAfter, Compressed);
+
+  // the info is written with each file
+  Info.Version = 1;
+  Info.Magic = TEXT("CARLA_RECORDER");
+  Info.Mapfile = MapName;
+
+  StartFrames(AdditionalData, CarlaRecorderRing::KeyFrameInterval);
+
+  return Filename;
+}
+
+std::string ACarlaRecorder::TriggerRing(void)
+{
+  if (!Enabled || !Ring.IsEnabled())
+  {
+    return "";
+  }
+
+  // already writing a file, just keep writing for longer
+  if (File.is_open())
+  {
+    Ring.SetDumpEnd(Frames.GetFrame().Elapsed);
+    return "";
+  }
+
+  std::string Filename = Ring.NextFilename();
+  File.open(Filename, Ring.IsCompressed());
+  if (!File.is_open())
+  {
+    return "";
+  }
+
+  Info.Date = std::time(0);
+  Info.Write(File);
+
+  // the last seconds, the frames of now on are written to the file
+  Ring.Dump(File, FrameIndex, Frames);
+  Ring.SetDumpEnd(Frames.GetFrame().Elapsed);
+
+  return Filename;
+}
+
+void ACarlaRecorder::StartFrames(bool AdditionalData, double KeyFrameInterval)
+{
   Frames.Reset();
+  FrameIndex.Reset(KeyFrameInterval);
+  KeyFrame.Reset();
+  Positions.ResetDelta();
+  Vehicles.ResetDelta();
+  Walkers.ResetDelta();
   PlatformTime.SetStartTime();
 
   Enable();
@@ -453,18 +538,29 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
 
   // add all existing actors
   AddExistingActors();
-
-  return std::string(Filename);
 }
 
-void ACarlaRecorder::Stop(void)
+void ACarlaRecorder::CloseFile(void)
 {
-  Disable();
+  if (File.is_open())
+  {
+    // trailer to seek without parsing the whole file
+    FrameIndex.Write(File);
+  }
 
-  if (File)
+  if (File.is_open())
   {
     File.close();
   }
+}
+
+void ACarlaRecorder::Stop(void)
+{
+  Disable();
+
+  // a flight recorder only writes the file it was writing, if any
+  CloseFile();
+  Ring.Stop();
 
   Clear();
 }
@@ -494,46 +590,83 @@ void ACarlaRecorder::Clear(void)
 
 void ACarlaRecorder::Write(double DeltaSeconds)
 {
+  // a flight recorder not triggered writes to memory
+  const bool bToRing = Ring.IsEnabled() && !File.is_open();
+  std::ostream &Out = bToRing ? Ring.GetStream() : static_cast<std::ostream &>(File);
+
   // update this frame data
   Frames.SetFrame(DeltaSeconds);
 
   // start
-  Frames.WriteStart(File);
-  VisualTime.Write(File);
+  const uint64_t Offset = static_cast<uint64_t>(std::streamoff(Out.tellp()));
+  Frames.WriteStart(Out);
+  if (FrameIndex.AddFrame(Frames.GetFrame().Elapsed, Offset))
+  {
+    // state before the events of this frame
+    KeyFrame.Write(Out);
+    // replay can start here, nothing may depend on the frames before
+    Positions.ResetDelta();
+    Vehicles.ResetDelta();
+    Walkers.ResetDelta();
+  }
+  VisualTime.Write(Out);
 
   // events
-  EventsAdd.Write(File);
-  EventsDel.Write(File);
-  EventsParent.Write(File);
-  Collisions.Write(File);
-  DoorVehicles.Write(File);
+  EventsAdd.Write(Out);
+  EventsDel.Write(Out);
+  EventsParent.Write(Out);
+  Collisions.Write(Out);
+  DoorVehicles.Write(Out);
 
-  // positions and states
-  Positions.Write(File);
-  States.Write(File);
+  // positions and states (only what changed since the previous frame)
+  Positions.WriteDelta(Out);
+  States.Write(Out);
 
   // animations
-  Vehicles.Write(File);
-  Walkers.Write(File);
-  LightVehicles.Write(File);
-  LightScenes.Write(File);
-  Wheels.Write(File);
-  Bikers.Write(File);
+  Vehicles.WriteDelta(Out);
+  Walkers.WriteDelta(Out);
+  LightVehicles.Write(Out);
+  LightScenes.Write(Out);
+  Wheels.Write(Out);
+  Bikers.Write(Out);
 
   // additional info
   if (bAdditionalData)
   {
-    Kinematics.Write(File);
-    BoundingBoxes.Write(File);
-    TriggerVolumes.Write(File);
-    PlatformTime.Write(File);
-    PhysicsControls.Write(File);
-    TrafficLightTimes.Write(File);
-    WalkersBones.Write(File);
+    Kinematics.Write(Out);
+    BoundingBoxes.Write(Out);
+    TriggerVolumes.Write(Out);
+    PlatformTime.Write(Out);
+    PhysicsControls.Write(Out);
+    TrafficLightTimes.Write(Out);
+    WalkersBones.Write(Out);
   }
 
   // end
-  Frames.WriteEnd(File);
+  Frames.WriteEnd(Out);
+
+  KeyFrame.Update(EventsAdd, EventsDel, EventsParent, LightScenes, DoorVehicles);
+
+  if (bToRing)
+  {
+    // forget what is older than needed
+    Ring.Trim(FrameIndex, Frames);
+  }
+  else
+  {
+    // only this frame will be patched by the next one
+    File.Commit(Offset);
+
+    // flight recorder: close the file once the seconds after the trigger
+    // are recorded, and go on in memory (the state of the actors is kept)
+    if (Ring.IsEnabled() && Frames.GetFrame().Elapsed >= Ring.GetDumpEnd())
+    {
+      CloseFile();
+      // the next frame is a key frame, it does not depend on the file
+      Frames.Reset();
+      FrameIndex.Reset(CarlaRecorderRing::KeyFrameInterval);
+    }
+  }
 
   Clear();
 }
@@ -577,7 +710,7 @@ void ACarlaRecorder::AddCollision(AActor *Actor1, AActor *Actor2)
     CarlaRecorderCollision Collision;
 
     // some inits
-    Collision.Id = NextCollisionId++;
+    Collision.Id = NextCollisionId;
     Collision.IsActor1Hero = false;
     Collision.IsActor2Hero = false;
 
@@ -611,7 +744,18 @@ void ACarlaRecorder::AddCollision(AActor *Actor1, AActor *Actor2)
       Collision.DatabaseId2 = uint32_t(-1); // actor2 is not a registered Carla actor
     }
 
-    Collisions.Add(std::move(Collision));
+    // the same pair of actors is recorded only once per frame
+    if (!Collisions.Add(std::move(Collision)))
+    {
+      return;
+    }
+    ++NextCollisionId;
+
+    // flight recorder: write the last seconds and the following ones
+    if (Ring.IsEnabled())
+    {
+      TriggerRing();
+    }
   }
 }
 
@@ -11,6 +11,7 @@
 
 #include "Carla/Actor/ActorDescription.h"
 
+#include "CarlaRecorderBlockFile.h"
 #include "CarlaRecorderTraficLightTime.h"
 #include "CarlaRecorderPhysicsControl.h"
 #include "CarlaRecorderPlatformTime.h"
@@ -26,10 +27,13 @@
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderKeyFrame.h"
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderQuery.h"
+#include "CarlaRecorderRing.h"
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderVisualTime.h"
 #include "CarlaRecorderWalkerBones.h"
@@ -71,7 +75,12 @@ enum class CarlaRecorderPacketId : uint8_t
   VisualTime,
   VehicleDoor,
   AnimVehicleWheels,
-  AnimBiker
+  AnimBiker,
+  KeyFrame,
+  FrameIndex,
+  PositionDelta,
+  AnimVehicleDelta,
+  AnimWalkerDelta
 };
 
 /// Recorder for the simulation
@@ -95,7 +104,17 @@ public:
   void Disable(void);
 
   // start / stop
-  std::string Start(std::string Name, FString MapName, bool AdditionalData = false);
+  // compressed writes the file in zlib blocks from a background thread
+  std::string Start(std::string Name, FString MapName, bool AdditionalData = false, bool Compressed = false);
+
+  // flight recorder: keeps only the last Seconds in memory, and writes them
+  // to a new file (Name with a counter) on each trigger or collision, together
+  // with the next SecondsAfter
+  std::string StartRing(std::string Name, FString MapName, double Seconds, double SecondsAfter,
+      bool AdditionalData = false, bool Compressed = false);
+
+  // returns the name of the file started, empty if none
+  std::string TriggerRing(void);
 
   void Stop(void);
 
@@ -174,6 +193,9 @@ public:
   void SetReplayerTimeFactor(double TimeFactor);
   void SetReplayerIgnoreHero(bool IgnoreHero);
   void SetReplayerIgnoreSpectator(bool IgnoreSpectator);
+  void SetReplayerSkipPhysics(bool SkipPhysics);
+  void SetReplayerFrameStep(bool FrameStep);
+  uint64_t GetReplayerFrame(void);
   void StopReplayer(bool KeepActors = false);
 
   void Ticking(float DeltaSeconds);
@@ -188,13 +210,15 @@ private:
   uint32_t NextCollisionId = 0;
 
   // files
-  std::ofstream File;
+  CarlaRecorderOutputFile File;
 
   UCarlaEpisode *Episode = nullptr;
 
   // structures
   CarlaRecorderInfo Info;
   CarlaRecorderFrames Frames;
+  CarlaRecorderFrameIndex FrameIndex;
+  CarlaRecorderKeyFrame KeyFrame;
   CarlaRecorderEventsAdd EventsAdd;
   CarlaRecorderEventsDel EventsDel;
   CarlaRecorderEventsParent EventsParent;
@@ -217,12 +241,18 @@ private:
   CarlaRecorderVisualTime VisualTime;
   CarlaRecorderDoorVehicles DoorVehicles;
 
+  // memory of the flight recorder mode
+  CarlaRecorderRing Ring;
+
   // replayer
   CarlaReplayer Replayer;
 
   // query tools
   CarlaRecorderQuery Query;
 
+  void StartFrames(bool AdditionalData, double KeyFrameInterval);
+  void CloseFile(void);
+
   void AddExistingActors(void);
   void AddActorPosition(FCarlaActor *CarlaActor);
   void AddWalkerAnimation(FCarlaActor *CarlaActor);
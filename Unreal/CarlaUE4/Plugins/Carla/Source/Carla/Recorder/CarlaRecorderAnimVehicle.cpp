@@ -31,6 +31,46 @@ void CarlaRecorderAnimVehicle::Read(std::istream &InFile)
 
 // ---------------------------------------------
 
+bool CarlaRecorderAnimVehicleDeltaPolicy::IsUnchanged(
+    const CarlaRecorderAnimVehicle &Previous,
+    const CarlaRecorderAnimVehicle &Current)
+{
+  return
+      Previous.Steering == Current.Steering &&
+      Previous.Throttle == Current.Throttle &&
+      Previous.Brake == Current.Brake &&
+      Previous.bHandbrake == Current.bHandbrake &&
+      Previous.Gear == Current.Gear;
+}
+
+void CarlaRecorderAnimVehicleDeltaPolicy::Write(
+    std::ostream &OutFile,
+    const CarlaRecorderAnimVehicle *,
+    const CarlaRecorderAnimVehicle &Current,
+    CarlaRecorderAnimVehicle &Decoded)
+{
+  WriteValue<float>(OutFile, Current.Steering);
+  WriteValue<float>(OutFile, Current.Throttle);
+  WriteValue<float>(OutFile, Current.Brake);
+  WriteValue<bool>(OutFile, Current.bHandbrake);
+  WriteValue<int32_t>(OutFile, Current.Gear);
+  Decoded = Current;
+}
+
+void CarlaRecorderAnimVehicleDeltaPolicy::Read(
+    std::istream &InFile,
+    const CarlaRecorderAnimVehicle *,
+    CarlaRecorderAnimVehicle &Decoded)
+{
+  ReadValue<float>(InFile, Decoded.Steering);
+  ReadValue<float>(InFile, Decoded.Throttle);
+  ReadValue<float>(InFile, Decoded.Brake);
+  ReadValue<bool>(InFile, Decoded.bHandbrake);
+  ReadValue<int32_t>(InFile, Decoded.Gear);
+}
+
+// ---------------------------------------------
+
 void CarlaRecorderAnimVehicles::Clear(void)
 {
   Vehicles.clear();
@@ -67,6 +107,32 @@ void CarlaRecorderAnimVehicles::Write(std::ostream &OutFile)
   OutFile.seekp(PosEnd, std::ios::beg);
 }
 
+void CarlaRecorderAnimVehicles::WriteDelta(std::ostream &OutFile)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::AnimVehicleDelta));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  Delta.Write(OutFile, Vehicles);
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderAnimVehicles::ResetDelta(void)
+{
+  Delta.Clear();
+}
+
 void CarlaRecorderAnimVehicles::Read(std::istream &InFile)
 {
   uint16_t i, Total;
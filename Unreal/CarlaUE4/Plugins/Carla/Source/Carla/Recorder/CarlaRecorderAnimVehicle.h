@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "CarlaRecorderDelta.h"
+
 #include <sstream>
 #include <vector>
 
@@ -26,6 +28,23 @@ struct CarlaRecorderAnimVehicle
 };
 #pragma pack(pop)
 
+/// Delta encoding of the vehicle animations: the records that changed since
+/// the previous frame are written in full, without the id.
+struct CarlaRecorderAnimVehicleDeltaPolicy
+{
+  using RecordType = CarlaRecorderAnimVehicle;
+
+  static bool IsUnchanged(const CarlaRecorderAnimVehicle &Previous, const CarlaRecorderAnimVehicle &Current);
+
+  static void Write(
+      std::ostream &OutFile,
+      const CarlaRecorderAnimVehicle *Previous,
+      const CarlaRecorderAnimVehicle &Current,
+      CarlaRecorderAnimVehicle &Decoded);
+
+  static void Read(std::istream &InFile, const CarlaRecorderAnimVehicle *Previous, CarlaRecorderAnimVehicle &Decoded);
+};
+
 class CarlaRecorderAnimVehicles
 {
 public:
@@ -34,12 +53,21 @@ public:
 
   void Clear(void);
 
+  /// Write an AnimVehicle packet with all the records.
   void Write(std::ostream &OutFile);
 
+  /// Write an AnimVehicleDelta packet, relative to the last one written.
+  void WriteDelta(std::ostream &OutFile);
+
+  /// The next AnimVehicleDelta packet does not depend on the previous ones.
+  void ResetDelta(void);
+
   void Read(std::istream &InFile);
 
   const std::vector<CarlaRecorderAnimVehicle>& GetVehicles();
 private:
 
   std::vector<CarlaRecorderAnimVehicle> Vehicles;
+
+  TCarlaRecorderDelta<CarlaRecorderAnimVehicleDeltaPolicy> Delta;
 };
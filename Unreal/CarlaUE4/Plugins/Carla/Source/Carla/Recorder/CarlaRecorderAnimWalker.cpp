@@ -8,6 +8,8 @@
 #include "CarlaRecorderAnimWalker.h"
 #include "CarlaRecorderHelpers.h"
 
+#include <cstring>
+
 void CarlaRecorderAnimWalker::Write(std::ostream &OutFile)
 {
   // database id
@@ -23,6 +25,33 @@ void CarlaRecorderAnimWalker::Read(std::istream &InFile)
 
 // ---------------------------------------------
 
+bool CarlaRecorderAnimWalkerDeltaPolicy::IsUnchanged(
+    const CarlaRecorderAnimWalker &Previous,
+    const CarlaRecorderAnimWalker &Current)
+{
+  return Previous.Speed == Current.Speed;
+}
+
+void CarlaRecorderAnimWalkerDeltaPolicy::Write(
+    std::ostream &OutFile,
+    const CarlaRecorderAnimWalker *,
+    const CarlaRecorderAnimWalker &Current,
+    CarlaRecorderAnimWalker &Decoded)
+{
+  WriteValue<float>(OutFile, Current.Speed);
+  Decoded = Current;
+}
+
+void CarlaRecorderAnimWalkerDeltaPolicy::Read(
+    std::istream &InFile,
+    const CarlaRecorderAnimWalker *,
+    CarlaRecorderAnimWalker &Decoded)
+{
+  ReadValue<float>(InFile, Decoded.Speed);
+}
+
+// ---------------------------------------------
+
 void CarlaRecorderAnimWalkers::Clear(void)
 {
   Walkers.clear();
@@ -54,6 +83,32 @@ void CarlaRecorderAnimWalkers::Write(std::ostream &OutFile)
   }
 }
 
+void CarlaRecorderAnimWalkers::WriteDelta(std::ostream &OutFile)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::AnimWalkerDelta));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  Delta.Write(OutFile, Walkers);
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderAnimWalkers::ResetDelta(void)
+{
+  Delta.Clear();
+}
+
 void CarlaRecorderAnimWalkers::Read(std::istream &InFile)
 {
   uint16_t i, Total;
@@ -68,6 +123,26 @@ void CarlaRecorderAnimWalkers::Read(std::istream &InFile)
   }
 }
 
+size_t CarlaRecorderAnimWalkers::Read(const char *InData, size_t InSize)
+{
+  uint16_t Total = 0u;
+  if (InSize < sizeof(Total))
+  {
+    return InSize;
+  }
+  std::memcpy(&Total, InData, sizeof(Total));
+  const size_t Bytes = Total * sizeof(CarlaRecorderAnimWalker);
+  if (InSize - sizeof(Total) < Bytes)
+  {
+    return InSize;
+  }
+  // the records are written as a plain array
+  const size_t First = Walkers.size();
+  Walkers.resize(First + Total);
+  std::memcpy(Walkers.data() + First, InData + sizeof(Total), Bytes);
+  return sizeof(Total) + Bytes;
+}
+
 const std::vector<CarlaRecorderAnimWalker>& CarlaRecorderAnimWalkers::GetWalkers()
 {
   return Walkers;
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "CarlaRecorderDelta.h"
+
 #include <sstream>
 #include <vector>
 
@@ -22,6 +24,23 @@ struct CarlaRecorderAnimWalker
 };
 #pragma pack(pop)
 
+/// Delta encoding of the walker animations: the records that changed since
+/// the previous frame are written in full, without the id.
+struct CarlaRecorderAnimWalkerDeltaPolicy
+{
+  using RecordType = CarlaRecorderAnimWalker;
+
+  static bool IsUnchanged(const CarlaRecorderAnimWalker &Previous, const CarlaRecorderAnimWalker &Current);
+
+  static void Write(
+      std::ostream &OutFile,
+      const CarlaRecorderAnimWalker *Previous,
+      const CarlaRecorderAnimWalker &Current,
+      CarlaRecorderAnimWalker &Decoded);
+
+  static void Read(std::istream &InFile, const CarlaRecorderAnimWalker *Previous, CarlaRecorderAnimWalker &Decoded);
+};
+
 class CarlaRecorderAnimWalkers
 {
 public:
@@ -30,13 +49,26 @@ public:
 
   void Clear(void);
 
+  /// Write an AnimWalker packet with all the records.
   void Write(std::ostream &OutFile);
 
+  /// Write an AnimWalkerDelta packet, relative to the last one written.
+  void WriteDelta(std::ostream &OutFile);
+
+  /// The next AnimWalkerDelta packet does not depend on the previous ones.
+  void ResetDelta(void);
+
   void Read(std::istream &InFile);
 
+  /// Read the records of an AnimWalker packet from memory (after its header),
+  /// copying them straight into the array. Returns the bytes used.
+  size_t Read(const char *InData, size_t InSize);
+
   const std::vector<CarlaRecorderAnimWalker>& GetWalkers();
   
 private:
 
   std::vector<CarlaRecorderAnimWalker> Walkers;
+
+  TCarlaRecorderDelta<CarlaRecorderAnimWalkerDeltaPolicy> Delta;
 };
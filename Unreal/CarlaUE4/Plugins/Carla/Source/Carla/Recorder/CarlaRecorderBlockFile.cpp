@@ -0,0 +1,547 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "CarlaRecorderBlockFile.h"
+#include "CarlaRecorderHelpers.h"
+
+#include "HAL/Event.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+namespace
+{
+  constexpr char Signature[8] = {'C', 'R', 'B', 'L', 'O', 'C', 'K', 'S'};
+
+  // uncompressed size of the blocks
+  constexpr uint64_t BlockSize = 1u << 20u;
+
+  enum class BlockCompression : uint8_t
+  {
+    Stored = 0,
+    Zlib
+  };
+
+  #pragma pack(push, 1)
+  struct BlockHeader
+  {
+    uint32_t StoredSize;
+    uint32_t Size;
+    uint8_t Compression;
+  };
+  #pragma pack(pop)
+}
+
+// ---------
+// writer
+// ---------
+
+class CarlaRecorderBlockWriter : public std::streambuf, public FRunnable
+{
+public:
+
+  bool Open(const std::string &Filename)
+  {
+    File.open(Filename, std::ios::binary);
+    if (!File.is_open())
+    {
+      return false;
+    }
+    File.write(Signature, sizeof(Signature));
+    Front.reserve(2u * BlockSize);
+    WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+    Thread = FRunnableThread::Create(this, TEXT("CarlaRecorderWriter"));
+    return true;
+  }
+
+  bool IsOpen() const
+  {
+    return File.is_open();
+  }
+
+  void Close()
+  {
+    if (!File.is_open())
+    {
+      return;
+    }
+    // the last block, whatever its size
+    PushBlock(Front.size());
+    bStop = true;
+    WorkEvent->Trigger();
+    Thread->WaitForCompletion();
+    delete Thread;
+    Thread = nullptr;
+    FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+    WorkEvent = nullptr;
+    File.close();
+  }
+
+  void Commit(uint64_t Offset)
+  {
+    if (Offset > FrontStart && Offset - FrontStart >= BlockSize)
+    {
+      PushBlock(std::min<uint64_t>(Offset - FrontStart, Front.size()));
+    }
+  }
+
+  ~CarlaRecorderBlockWriter()
+  {
+    Close();
+  }
+
+  // FRunnable, compress and write the blocks in order
+  uint32 Run() override
+  {
+    std::vector<char> Block;
+    std::vector<char> Compressed;
+    while (true)
+    {
+      WorkEvent->Wait();
+      while (PopBlock(Block))
+      {
+        WriteBlock(Block, Compressed);
+        FScopeLock Lock(&Mutex);
+        FreeBuffers.push_back(std::move(Block));
+      }
+      if (bStop)
+      {
+        break;
+      }
+    }
+    return 0;
+  }
+
+protected:
+
+  // std::streambuf, there is no put area so every write comes here
+  std::streamsize xsputn(const char *Data, std::streamsize Count) override
+  {
+    const uint64_t Offset = Position - FrontStart;
+    if (Offset + Count > Front.size())
+    {
+      Front.resize(Offset + Count);
+    }
+    std::memcpy(Front.data() + Offset, Data, Count);
+    Position += Count;
+    return Count;
+  }
+
+  int_type overflow(int_type Char) override
+  {
+    if (traits_type::eq_int_type(Char, traits_type::eof()))
+    {
+      return traits_type::not_eof(Char);
+    }
+    const char Value = traits_type::to_char_type(Char);
+    xsputn(&Value, 1);
+    return Char;
+  }
+
+  pos_type seekoff(off_type Offset, std::ios::seekdir Dir, std::ios::openmode Mode) override
+  {
+    switch (Dir)
+    {
+      case std::ios::beg:
+        return seekpos(pos_type(Offset), Mode);
+      case std::ios::cur:
+        return seekpos(pos_type(static_cast<off_type>(Position) + Offset), Mode);
+      default:
+        return seekpos(pos_type(static_cast<off_type>(FrontStart + Front.size()) + Offset), Mode);
+    }
+  }
+
+  pos_type seekpos(pos_type Pos, std::ios::openmode Mode) override
+  {
+    const off_type Offset = off_type(Pos);
+    // only the data not sent to a block can be overwritten
+    if (!(Mode & std::ios::out) ||
+        Offset < static_cast<off_type>(FrontStart) ||
+        Offset > static_cast<off_type>(FrontStart + Front.size()))
+    {
+      return pos_type(off_type(-1));
+    }
+    Position = static_cast<uint64_t>(Offset);
+    return Pos;
+  }
+
+private:
+
+  // send the first Count bytes of the buffer to the background thread, the
+  // rest is copied to a new buffer
+  void PushBlock(uint64_t Count)
+  {
+    std::vector<char> Back;
+    {
+      FScopeLock Lock(&Mutex);
+      if (!FreeBuffers.empty())
+      {
+        Back = std::move(FreeBuffers.back());
+        FreeBuffers.pop_back();
+      }
+    }
+    Back.reserve(2u * BlockSize);
+    Back.assign(Front.begin() + Count, Front.end());
+    Front.resize(Count);
+    if (Count > 0u)
+    {
+      FScopeLock Lock(&Mutex);
+      Blocks.push_back(std::move(Front));
+    }
+    Front = std::move(Back);
+    FrontStart += Count;
+    WorkEvent->Trigger();
+  }
+
+  bool PopBlock(std::vector<char> &Block)
+  {
+    FScopeLock Lock(&Mutex);
+    if (Blocks.empty())
+    {
+      return false;
+    }
+    Block = std::move(Blocks.front());
+    Blocks.pop_front();
+    return true;
+  }
+
+  void WriteBlock(std::vector<char> &Block, std::vector<char> &Compressed)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(CarlaRecorderBlockWriter::WriteBlock);
+    BlockHeader Header;
+    Header.Size = Block.size();
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Header.Size);
+    Compressed.resize(CompressedSize);
+    const bool bCompressed = FCompression::CompressMemory(
+        NAME_Zlib,
+        Compressed.data(),
+        CompressedSize,
+        Block.data(),
+        Header.Size);
+    if (bCompressed && static_cast<uint32_t>(CompressedSize) < Header.Size)
+    {
+      Header.StoredSize = CompressedSize;
+      Header.Compression = static_cast<uint8_t>(BlockCompression::Zlib);
+      WriteValue<BlockHeader>(File, Header);
+      File.write(Compressed.data(), CompressedSize);
+    }
+    else
+    {
+      Header.StoredSize = Header.Size;
+      Header.Compression = static_cast<uint8_t>(BlockCompression::Stored);
+      WriteValue<BlockHeader>(File, Header);
+      File.write(Block.data(), Header.Size);
+    }
+    Block.clear();
+  }
+
+  std::ofstream File;
+
+  // data not sent to a block yet, starting at FrontStart in the stream
+  std::vector<char> Front;
+  uint64_t FrontStart = 0u;
+  uint64_t Position = 0u;
+
+  // shared with the background thread
+  FCriticalSection Mutex;
+  std::deque<std::vector<char>> Blocks;
+  std::vector<std::vector<char>> FreeBuffers;
+  std::atomic<bool> bStop { false };
+
+  FEvent *WorkEvent = nullptr;
+  FRunnableThread *Thread = nullptr;
+};
+
+// ---------
+// reader
+// ---------
+
+class CarlaRecorderBlockReader : public std::streambuf
+{
+public:
+
+  static bool IsBlockFile(const std::string &Filename)
+  {
+    std::ifstream File(Filename, std::ios::binary);
+    char Value[sizeof(Signature)] = {};
+    File.read(Value, sizeof(Value));
+    return File && std::memcmp(Value, Signature, sizeof(Signature)) == 0;
+  }
+
+  bool Open(const std::string &Filename)
+  {
+    File.open(Filename, std::ios::binary);
+    if (!File.is_open())
+    {
+      return false;
+    }
+
+    // find all the blocks, a block cut by a crash is ignored
+    File.seekg(0, std::ios::end);
+    const uint64_t FileSize = static_cast<uint64_t>(std::streamoff(File.tellg()));
+    uint64_t FileOffset = sizeof(Signature);
+    uint64_t Start = 0u;
+    while (FileOffset + sizeof(BlockHeader) <= FileSize)
+    {
+      BlockHeader Header;
+      File.seekg(FileOffset, std::ios::beg);
+      ReadValue<BlockHeader>(File, Header);
+      FileOffset += sizeof(BlockHeader);
+      if (!File || FileOffset + Header.StoredSize > FileSize)
+      {
+        break;
+      }
+      Blocks.push_back(BlockInfo{FileOffset, Start, Header.StoredSize, Header.Size, Header.Compression});
+      FileOffset += Header.StoredSize;
+      Start += Header.Size;
+    }
+    TotalSize = Start;
+    File.clear();
+    return true;
+  }
+
+  bool IsOpen() const
+  {
+    return File.is_open();
+  }
+
+  void Close()
+  {
+    File.close();
+  }
+
+protected:
+
+  int_type underflow() override
+  {
+    if (gptr() < egptr())
+    {
+      return traits_type::to_int_type(*gptr());
+    }
+    const size_t Next = (Current < Blocks.size()) ? Current + 1u : 0u;
+    if (Next >= Blocks.size() || !LoadBlock(Next))
+    {
+      return traits_type::eof();
+    }
+    setg(Data.data(), Data.data(), Data.data() + Data.size());
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(off_type Offset, std::ios::seekdir Dir, std::ios::openmode Mode) override
+  {
+    switch (Dir)
+    {
+      case std::ios::beg:
+        return seekpos(pos_type(Offset), Mode);
+      case std::ios::cur:
+        return seekpos(pos_type(static_cast<off_type>(GetPosition()) + Offset), Mode);
+      default:
+        return seekpos(pos_type(static_cast<off_type>(TotalSize) + Offset), Mode);
+    }
+  }
+
+  pos_type seekpos(pos_type Pos, std::ios::openmode Mode) override
+  {
+    const off_type Offset = off_type(Pos);
+    if (!(Mode & std::ios::in) || Offset < 0 || static_cast<uint64_t>(Offset) > TotalSize)
+    {
+      return pos_type(off_type(-1));
+    }
+    if (Blocks.empty())
+    {
+      return Pos;
+    }
+
+    // last block that starts at or before the position
+    auto It = std::upper_bound(Blocks.begin(), Blocks.end(), static_cast<uint64_t>(Offset),
+        [](uint64_t Value, const BlockInfo &Block) { return Value < Block.Start; });
+    const size_t Index = std::distance(Blocks.begin(), It) - 1u;
+    if (Index != Current && !LoadBlock(Index))
+    {
+      return pos_type(off_type(-1));
+    }
+    setg(Data.data(), Data.data() + (Offset - Blocks[Index].Start), Data.data() + Data.size());
+    return Pos;
+  }
+
+private:
+
+  struct BlockInfo
+  {
+    uint64_t FileOffset;
+    uint64_t Start;
+    uint32_t StoredSize;
+    uint32_t Size;
+    uint8_t Compression;
+  };
+
+  uint64_t GetPosition() const
+  {
+    if (Current >= Blocks.size())
+    {
+      return 0u;
+    }
+    return Blocks[Current].Start + (gptr() - eback());
+  }
+
+  bool LoadBlock(size_t Index)
+  {
+    const BlockInfo &Block = Blocks[Index];
+    Stored.resize(Block.StoredSize);
+    File.clear();
+    File.seekg(Block.FileOffset, std::ios::beg);
+    File.read(Stored.data(), Block.StoredSize);
+    if (!File)
+    {
+      return false;
+    }
+    if (Block.Compression == static_cast<uint8_t>(BlockCompression::Zlib))
+    {
+      Data.resize(Block.Size);
+      if (!FCompression::UncompressMemory(NAME_Zlib, Data.data(), Block.Size, Stored.data(), Block.StoredSize))
+      {
+        UE_LOG(LogCarla, Error, TEXT("Recorder block %d could not be decompressed"), static_cast<int32>(Index));
+        return false;
+      }
+    }
+    else
+    {
+      Data.swap(Stored);
+    }
+    Current = Index;
+    return true;
+  }
+
+  std::ifstream File;
+
+  std::vector<BlockInfo> Blocks;
+  uint64_t TotalSize = 0u;
+
+  // block in the get area, -1 if none
+  size_t Current = static_cast<size_t>(-1);
+  std::vector<char> Data;
+  std::vector<char> Stored;
+};
+
+// ---------
+// files
+// ---------
+
+CarlaRecorderOutputFile::CarlaRecorderOutputFile()
+  : std::ostream(nullptr) {}
+
+CarlaRecorderOutputFile::~CarlaRecorderOutputFile()
+{
+  close();
+}
+
+void CarlaRecorderOutputFile::open(const std::string &Filename, bool bCompressed)
+{
+  close();
+  if (bCompressed)
+  {
+    BlockWriter = std::make_unique<CarlaRecorderBlockWriter>();
+    if (!BlockWriter->Open(Filename))
+    {
+      BlockWriter.reset();
+    }
+    rdbuf(BlockWriter.get());
+  }
+  else
+  {
+    PlainBuffer.open(Filename, std::ios::out | std::ios::binary);
+    rdbuf(&PlainBuffer);
+  }
+  if (!is_open())
+  {
+    setstate(std::ios::failbit);
+  }
+}
+
+bool CarlaRecorderOutputFile::is_open() const
+{
+  return BlockWriter != nullptr ? BlockWriter->IsOpen() : PlainBuffer.is_open();
+}
+
+void CarlaRecorderOutputFile::close()
+{
+  if (BlockWriter != nullptr)
+  {
+    BlockWriter->Close();
+    BlockWriter.reset();
+  }
+  if (PlainBuffer.is_open())
+  {
+    PlainBuffer.close();
+  }
+  rdbuf(nullptr);
+}
+
+void CarlaRecorderOutputFile::Commit(uint64_t Offset)
+{
+  if (BlockWriter != nullptr)
+  {
+    BlockWriter->Commit(Offset);
+  }
+}
+
+CarlaRecorderInputFile::CarlaRecorderInputFile()
+  : std::istream(nullptr) {}
+
+CarlaRecorderInputFile::~CarlaRecorderInputFile()
+{
+  close();
+}
+
+void CarlaRecorderInputFile::open(const std::string &Filename, std::ios::openmode Mode)
+{
+  close();
+  if (CarlaRecorderBlockReader::IsBlockFile(Filename))
+  {
+    BlockReader = std::make_unique<CarlaRecorderBlockReader>();
+    if (!BlockReader->Open(Filename))
+    {
+      BlockReader.reset();
+    }
+    rdbuf(BlockReader.get());
+  }
+  else
+  {
+    PlainBuffer.open(Filename, Mode | std::ios::in);
+    rdbuf(&PlainBuffer);
+  }
+  if (!is_open())
+  {
+    setstate(std::ios::failbit);
+  }
+}
+
+bool CarlaRecorderInputFile::is_open() const
+{
+  return BlockReader != nullptr ? BlockReader->IsOpen() : PlainBuffer.is_open();
+}
+
+void CarlaRecorderInputFile::close()
+{
+  if (BlockReader != nullptr)
+  {
+    BlockReader->Close();
+    BlockReader.reset();
+  }
+  if (PlainBuffer.is_open())
+  {
+    PlainBuffer.close();
+  }
+  rdbuf(nullptr);
+}
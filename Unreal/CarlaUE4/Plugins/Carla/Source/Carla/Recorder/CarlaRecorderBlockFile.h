@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+class CarlaRecorderBlockWriter;
+class CarlaRecorderBlockReader;
+
+// Block-compressed recorder files
+//
+// A compressed file starts with the signature "CRBLOCKS" followed by blocks
+// of about 1 MB of the plain recorder format, each one with a header
+// {uint32 StoredSize, uint32 Size, uint8 Compression} (Compression is 0 for
+// stored and 1 for zlib). The streams below hide the blocks, so the packets
+// are written and read the same way as in plain files, and the offsets
+// (tellp, seekg, the frame index) are those of the uncompressed data.
+
+// Output file for the recorder, plain or block-compressed.
+//
+// When compressed, the packets are copied to a buffer in memory and each block
+// is compressed and written to disk by a background thread, so the game thread
+// never waits for the disk. Use Commit() to tell which data will not be
+// patched anymore.
+class CarlaRecorderOutputFile : public std::ostream
+{
+public:
+
+  CarlaRecorderOutputFile();
+
+  ~CarlaRecorderOutputFile();
+
+  void open(const std::string &Filename, bool bCompressed = false);
+
+  bool is_open() const;
+
+  // write the pending data and wait until it is on disk
+  void close();
+
+  bool IsCompressed() const
+  {
+    return BlockWriter != nullptr;
+  }
+
+  // data before Offset will not be overwritten, so it can go to a block
+  void Commit(uint64_t Offset);
+
+private:
+
+  std::filebuf PlainBuffer;
+
+  std::unique_ptr<CarlaRecorderBlockWriter> BlockWriter;
+};
+
+// Input file for the replayer and the queries, detects if the file is plain
+// or block-compressed. Only the block being read is decompressed.
+class CarlaRecorderInputFile : public std::istream
+{
+public:
+
+  CarlaRecorderInputFile();
+
+  ~CarlaRecorderInputFile();
+
+  void open(const std::string &Filename, std::ios::openmode Mode = std::ios::binary);
+
+  bool is_open() const;
+
+  void close();
+
+  bool IsCompressed() const
+  {
+    return BlockReader != nullptr;
+  }
+
+private:
+
+  std::filebuf PlainBuffer;
+
+  std::unique_ptr<CarlaRecorderBlockReader> BlockReader;
+};
@@ -42,9 +42,9 @@ void CarlaRecorderCollisions::Clear(void)
     Collisions.clear();
 }
 
-void CarlaRecorderCollisions::Add(const CarlaRecorderCollision &Collision)
+bool CarlaRecorderCollisions::Add(const CarlaRecorderCollision &Collision)
 {
-    Collisions.insert(std::move(Collision));
+    return Collisions.insert(std::move(Collision)).second;
 }
 
 void CarlaRecorderCollisions::Write(std::ostream &OutFile)
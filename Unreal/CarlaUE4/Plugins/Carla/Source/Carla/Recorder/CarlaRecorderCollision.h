@@ -45,7 +45,8 @@ namespace std
 class CarlaRecorderCollisions{
 
     public:
-    void Add(const CarlaRecorderCollision &Collision);
+    // returns false if the pair of actors already collided in this frame
+    bool Add(const CarlaRecorderCollision &Collision);
     void Clear(void);
     void Write(std::ostream &OutFile);
 
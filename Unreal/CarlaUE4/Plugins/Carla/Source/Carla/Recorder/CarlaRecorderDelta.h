@@ -0,0 +1,195 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CarlaRecorderHelpers.h"
+
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+/// Encoding of the records of a packet relative to the same packet of the
+/// previous frame, used by the PositionDelta, AnimVehicleDelta and
+/// AnimWalkerDelta packets. The payload is
+///
+///   uint8   flags, see NewIds and Reset
+///   uint16  number of records
+///   uint32  id of each record, only with NewIds; otherwise the records are of
+///           the same actors, in the same order, as in the previous frame
+///   uint8   mask of the records that changed, one bit per record
+///   ...     each record that changed, as written by Policy::Write
+///
+/// A record that did not change is the same as in the previous frame. A
+/// packet with Reset does not depend on the previous frame, so reading can
+/// start there; the recorder writes one in every key frame.
+///
+/// @a Policy provides the type of the records and how a changed record is
+/// written, given the record of the same actor in the previous frame, or
+/// nullptr if the actor was not there:
+///
+///   using RecordType = ...;
+///   static bool IsUnchanged(const RecordType &Previous, const RecordType &Current);
+///   static void Write(std::ostream &, const RecordType *Previous, const RecordType &Current, RecordType &Decoded);
+///   static void Read(std::istream &, const RecordType *Previous, RecordType &Decoded);
+///
+/// Write outputs in @a Decoded the record the reader will get, the next frame
+/// is encoded relative to it so lossy encodings do not drift.
+template <typename Policy>
+class TCarlaRecorderDelta
+{
+public:
+
+  using RecordType = typename Policy::RecordType;
+
+  static constexpr uint8_t NewIds = 1u << 0u;
+
+  static constexpr uint8_t Reset = 1u << 1u;
+
+  /// Forget the previous frame, the next packet written does not depend on
+  /// it.
+  void Clear()
+  {
+    Previous.clear();
+    bReset = true;
+  }
+
+  void Write(std::ostream &OutFile, const std::vector<RecordType> &Records)
+  {
+    const uint16_t Total = static_cast<uint16_t>(Records.size());
+    bool bNewIds = bReset || (Previous.size() != Records.size());
+    for (uint16_t i = 0u; !bNewIds && i < Total; ++i)
+    {
+      bNewIds = (Previous[i].DatabaseId != Records[i].DatabaseId);
+    }
+    WriteValue<uint8_t>(OutFile, (bNewIds ? NewIds : 0u) | (bReset ? Reset : 0u));
+    WriteValue<uint16_t>(OutFile, Total);
+    if (bNewIds)
+    {
+      for (const RecordType &Record : Records)
+      {
+        WriteValue<uint32_t>(OutFile, Record.DatabaseId);
+      }
+    }
+    FindPrevious(Records, bNewIds);
+
+    std::vector<RecordType> Decoded(Records);
+    std::vector<uint8_t> Changed((Total + 7u) / 8u, 0u);
+    for (uint16_t i = 0u; i < Total; ++i)
+    {
+      if (PreviousRecords[i] == nullptr || !Policy::IsUnchanged(*PreviousRecords[i], Records[i]))
+      {
+        Changed[i / 8u] |= static_cast<uint8_t>(1u << (i % 8u));
+      }
+      else
+      {
+        Decoded[i] = *PreviousRecords[i];
+      }
+    }
+    OutFile.write(reinterpret_cast<const char *>(Changed.data()), Changed.size());
+    for (uint16_t i = 0u; i < Total; ++i)
+    {
+      if ((Changed[i / 8u] & (1u << (i % 8u))) != 0u)
+      {
+        Policy::Write(OutFile, PreviousRecords[i], Records[i], Decoded[i]);
+      }
+    }
+
+    Previous = std::move(Decoded);
+    bReset = false;
+  }
+
+  /// Read a packet written by Write, the records are valid until the next
+  /// call.
+  const std::vector<RecordType> &Read(std::istream &InFile)
+  {
+    uint8_t Flags = 0u;
+    uint16_t Total = 0u;
+    ReadValue<uint8_t>(InFile, Flags);
+    ReadValue<uint16_t>(InFile, Total);
+    if ((Flags & Reset) != 0u)
+    {
+      Previous.clear();
+    }
+
+    std::vector<RecordType> Records(Total);
+    const bool bNewIds = ((Flags & NewIds) != 0u) || (Previous.size() != Total);
+    for (uint16_t i = 0u; i < Total; ++i)
+    {
+      if ((Flags & NewIds) != 0u)
+      {
+        ReadValue<uint32_t>(InFile, Records[i].DatabaseId);
+      }
+      else if (i < Previous.size())
+      {
+        Records[i].DatabaseId = Previous[i].DatabaseId;
+      }
+    }
+    FindPrevious(Records, bNewIds);
+
+    std::vector<uint8_t> Changed((Total + 7u) / 8u, 0u);
+    InFile.read(reinterpret_cast<char *>(Changed.data()), Changed.size());
+    for (uint16_t i = 0u; i < Total; ++i)
+    {
+      if ((Changed[i / 8u] & (1u << (i % 8u))) != 0u)
+      {
+        const uint32_t Id = Records[i].DatabaseId;
+        Policy::Read(InFile, PreviousRecords[i], Records[i]);
+        Records[i].DatabaseId = Id;
+      }
+      else if (PreviousRecords[i] != nullptr)
+      {
+        Records[i] = *PreviousRecords[i];
+      }
+    }
+
+    Previous = std::move(Records);
+    return Previous;
+  }
+
+private:
+
+  /// Point each record to the record of the same actor in Previous.
+  void FindPrevious(const std::vector<RecordType> &Records, bool bNewIds)
+  {
+    PreviousRecords.assign(Records.size(), nullptr);
+    if (!bNewIds)
+    {
+      for (size_t i = 0u; i < Records.size(); ++i)
+      {
+        PreviousRecords[i] = &Previous[i];
+      }
+      return;
+    }
+    PreviousIndex.clear();
+    for (size_t i = 0u; i < Previous.size(); ++i)
+    {
+      PreviousIndex.emplace(Previous[i].DatabaseId, i);
+    }
+    for (size_t i = 0u; i < Records.size(); ++i)
+    {
+      auto It = PreviousIndex.find(Records[i].DatabaseId);
+      if (It != PreviousIndex.end())
+      {
+        PreviousRecords[i] = &Previous[It->second];
+      }
+    }
+  }
+
+  std::vector<RecordType> Previous;
+
+  std::vector<const RecordType *> PreviousRecords;
+
+  std::unordered_map<uint32_t, size_t> PreviousIndex;
+
+  bool bReset { true };
+};
+
+template <typename Policy>
+constexpr uint8_t TCarlaRecorderDelta<Policy>::NewIds;
+
+template <typename Policy>
+constexpr uint8_t TCarlaRecorderDelta<Policy>::Reset;
@@ -0,0 +1,153 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorderFrameIndex.h"
+#include "CarlaRecorder.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <algorithm>
+
+constexpr double CarlaRecorderFrameIndex::DefaultKeyFrameInterval;
+
+void CarlaRecorderFrameIndex::Reset(double InKeyFrameInterval)
+{
+  KeyFrameInterval = InKeyFrameInterval;
+  Entries.clear();
+  KeyFrames.clear();
+}
+
+bool CarlaRecorderFrameIndex::AddFrame(double Elapsed, uint64_t Offset)
+{
+  bool bKeyFrame = KeyFrames.empty() ||
+      Elapsed - Entries[KeyFrames.back()].Elapsed >= KeyFrameInterval;
+  if (bKeyFrame)
+  {
+    KeyFrames.push_back(Entries.size());
+  }
+  Entries.push_back(CarlaRecorderFrameIndexEntry
+  {
+    Elapsed,
+    Offset,
+    static_cast<uint8_t>(bKeyFrame ? 1u : 0u)
+  });
+  return bKeyFrame;
+}
+
+void CarlaRecorderFrameIndex::Write(std::ostream &OutFile)
+{
+  uint64_t PosStart = static_cast<uint64_t>(std::streamoff(OutFile.tellp()));
+
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameIndex));
+
+  // write the packet size
+  uint32_t Total = sizeof(uint32_t) +
+      Entries.size() * sizeof(CarlaRecorderFrameIndexEntry) +
+      sizeof(uint64_t);
+  WriteValue<uint32_t>(OutFile, Total);
+
+  // write total records
+  Total = Entries.size();
+  WriteValue<uint32_t>(OutFile, Total);
+  for (const auto &Entry : Entries)
+  {
+    WriteValue<CarlaRecorderFrameIndexEntry>(OutFile, Entry);
+  }
+
+  // the offset of this packet goes last, at the end of the file
+  WriteValue<uint64_t>(OutFile, PosStart);
+}
+
+bool CarlaRecorderFrameIndex::Read(std::istream &InFile)
+{
+  constexpr uint64_t HeaderSize = sizeof(char) + sizeof(uint32_t);
+
+  Reset(KeyFrameInterval);
+  std::streampos Current = InFile.tellg();
+
+  InFile.clear();
+  InFile.seekg(0, std::ios::end);
+  uint64_t FileSize = static_cast<uint64_t>(std::streamoff(InFile.tellg()));
+
+  bool bFound = false;
+  if (FileSize >= HeaderSize + sizeof(uint32_t) + sizeof(uint64_t))
+  {
+    uint64_t PosStart = 0;
+    InFile.seekg(FileSize - sizeof(uint64_t), std::ios::beg);
+    ReadValue<uint64_t>(InFile, PosStart);
+
+    if (InFile && PosStart + HeaderSize + sizeof(uint32_t) + sizeof(uint64_t) <= FileSize)
+    {
+      char Id = 0;
+      uint32_t Size = 0, Total = 0;
+      InFile.seekg(PosStart, std::ios::beg);
+      ReadValue<char>(InFile, Id);
+      ReadValue<uint32_t>(InFile, Size);
+      ReadValue<uint32_t>(InFile, Total);
+
+      // check that it is really the trailer and not some packet data
+      bFound = InFile &&
+          Id == static_cast<char>(CarlaRecorderPacketId::FrameIndex) &&
+          PosStart + HeaderSize + Size == FileSize &&
+          Size == sizeof(uint32_t) + uint64_t(Total) * sizeof(CarlaRecorderFrameIndexEntry) + sizeof(uint64_t);
+      if (bFound)
+      {
+        Entries.resize(Total);
+        InFile.read(reinterpret_cast<char *>(Entries.data()), Total * sizeof(CarlaRecorderFrameIndexEntry));
+        bFound = static_cast<bool>(InFile);
+      }
+    }
+  }
+
+  if (bFound)
+  {
+    for (uint32_t i = 0; i < Entries.size(); ++i)
+    {
+      if (Entries[i].bKeyFrame)
+      {
+        KeyFrames.push_back(i);
+      }
+    }
+  }
+  else
+  {
+    Reset(KeyFrameInterval);
+  }
+
+  InFile.clear();
+  InFile.seekg(Current, std::ios::beg);
+  return bFound;
+}
+
+const CarlaRecorderFrameIndexEntry *CarlaRecorderFrameIndex::FindKeyFrame(double Time) const
+{
+  // first key frame after Time
+  auto It = std::upper_bound(KeyFrames.begin(), KeyFrames.end(), Time,
+      [this](double Value, uint32_t Index) { return Value < Entries[Index].Elapsed; });
+  if (It == KeyFrames.begin())
+  {
+    return nullptr;
+  }
+  return &Entries[*(--It)];
+}
+
+void CarlaRecorderFrameIndex::Rebase(uint64_t FirstOffset, int64_t OffsetDelta, double ElapsedDelta)
+{
+  auto First = std::lower_bound(Entries.begin(), Entries.end(), FirstOffset,
+      [](const CarlaRecorderFrameIndexEntry &Entry, uint64_t Value) { return Entry.Offset < Value; });
+  Entries.erase(Entries.begin(), First);
+
+  KeyFrames.clear();
+  for (uint32_t i = 0; i < Entries.size(); ++i)
+  {
+    Entries[i].Offset = static_cast<uint64_t>(static_cast<int64_t>(Entries[i].Offset) + OffsetDelta);
+    Entries[i].Elapsed += ElapsedDelta;
+    if (Entries[i].bKeyFrame)
+    {
+      KeyFrames.push_back(i);
+    }
+  }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <sstream>
+#include <vector>
+
+#pragma pack(push, 1)
+struct CarlaRecorderFrameIndexEntry
+{
+  // time of the frame since the start of the recording
+  double Elapsed;
+  // offset of the FrameStart packet in the file
+  uint64_t Offset;
+  // the frame starts with a KeyFrame packet
+  uint8_t bKeyFrame;
+};
+#pragma pack(pop)
+
+// Offset and elapsed time of each frame, written as a trailer packet when the
+// recording is stopped. The last 8 bytes of the file are the offset of the
+// trailer, so the replayer can find it without parsing the file.
+class CarlaRecorderFrameIndex
+{
+public:
+
+  // KeyFrameInterval: seconds between key frames
+  void Reset(double InKeyFrameInterval = DefaultKeyFrameInterval);
+
+  // recorder: add the next frame, returns true if it has to be a key frame
+  bool AddFrame(double Elapsed, uint64_t Offset);
+
+  void Write(std::ostream &OutFile);
+
+  // replayer: read the trailer, returns false (and leaves the index empty) if
+  // the file has none, like those recorded by older versions or not stopped
+  // cleanly. The position of the stream is restored.
+  bool Read(std::istream &InFile);
+
+  bool IsEmpty(void) const
+  {
+    return Entries.empty();
+  }
+
+  double GetTotalTime(void) const
+  {
+    return Entries.empty() ? 0.0 : Entries.back().Elapsed;
+  }
+
+  // last key frame at or before Time, nullptr if none
+  const CarlaRecorderFrameIndexEntry *FindKeyFrame(double Time) const;
+
+  // remove the frames before the one at FirstOffset (must be a key frame),
+  // and move the rest by OffsetDelta bytes and ElapsedDelta seconds
+  void Rebase(uint64_t FirstOffset, int64_t OffsetDelta, double ElapsedDelta);
+
+  const std::vector<CarlaRecorderFrameIndexEntry> &GetEntries(void) const
+  {
+    return Entries;
+  }
+
+  static constexpr double DefaultKeyFrameInterval = 10.0;
+
+private:
+
+  // seconds between key frames
+  double KeyFrameInterval { DefaultKeyFrameInterval };
+
+  std::vector<CarlaRecorderFrameIndexEntry> Entries;
+
+  // position in Entries of each key frame
+  std::vector<uint32_t> KeyFrames;
+};
@@ -89,3 +89,13 @@ void CarlaRecorderFrames::WriteEnd(std::ostream &OutFile)
   uint32_t Total = 0;
   WriteValue<uint32_t>(OutFile, Total);
 }
+
+void CarlaRecorderFrames::Rebase(int64_t OffsetDelta, int64_t IdDelta, double ElapsedDelta)
+{
+  if (OffsetPreviousFrame > 0)
+  {
+    OffsetPreviousFrame += OffsetDelta;
+  }
+  Frame.Id = static_cast<uint64_t>(static_cast<int64_t>(Frame.Id) + IdDelta);
+  Frame.Elapsed += ElapsedDelta;
+}
@@ -32,9 +32,18 @@ public:
 
   void SetFrame(double DeltaSeconds);
 
+  const CarlaRecorderFrame &GetFrame(void) const
+  {
+    return Frame;
+  }
+
   void WriteStart(std::ostream &OutFile);
   void WriteEnd(std::ostream &OutFile);
 
+  // the frames written so far were moved OffsetDelta bytes in the file, and
+  // renumbered by IdDelta and ElapsedDelta seconds
+  void Rebase(int64_t OffsetDelta, int64_t IdDelta, double ElapsedDelta);
+
 private:
 
   CarlaRecorderFrame Frame;
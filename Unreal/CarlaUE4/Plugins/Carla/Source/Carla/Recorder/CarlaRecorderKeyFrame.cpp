@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorderKeyFrame.h"
+#include "CarlaRecorder.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <algorithm>
+
+void CarlaRecorderKeyFrame::Reset(void)
+{
+  Actors.clear();
+  Parents.clear();
+  Lights.clear();
+  Doors.clear();
+}
+
+void CarlaRecorderKeyFrame::Update(
+    CarlaRecorderEventsAdd &EventsAdd,
+    CarlaRecorderEventsDel &EventsDel,
+    CarlaRecorderEventsParent &EventsParent,
+    CarlaRecorderLightScenes &LightScenes,
+    CarlaRecorderDoorVehicles &DoorVehicles)
+{
+  // same order as the replayer applies them
+  for (const auto &Event : EventsAdd.GetEvents())
+  {
+    Actors[Event.DatabaseId] = Event;
+  }
+
+  for (const auto &Event : EventsDel.GetEvents())
+  {
+    const uint32_t Id = Event.DatabaseId;
+    Actors.erase(Id);
+    Parents.erase(Id);
+    Doors.erase(std::remove_if(Doors.begin(), Doors.end(),
+        [Id](const CarlaRecorderDoorVehicle &Door) { return Door.DatabaseId == Id; }),
+        Doors.end());
+  }
+
+  for (const auto &Event : EventsParent.GetEvents())
+  {
+    Parents[Event.DatabaseId] = Event.DatabaseIdParent;
+  }
+
+  for (const auto &Light : LightScenes.GetLights())
+  {
+    Lights[Light.LightId] = Light;
+  }
+
+  for (const auto &Door : DoorVehicles.GetDoorVehicles())
+  {
+    Doors.erase(std::remove_if(Doors.begin(), Doors.end(),
+        [&Door](const CarlaRecorderDoorVehicle &Other)
+        {
+          return Other.DatabaseId == Door.DatabaseId && Other.Doors == Door.Doors;
+        }),
+        Doors.end());
+    Doors.push_back(Door);
+  }
+}
+
+void CarlaRecorderKeyFrame::Write(std::ostream &OutFile)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::KeyFrame));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  // write the nested packets
+  CarlaRecorderEventsAdd EventsAdd;
+  for (const auto &Actor : Actors)
+  {
+    EventsAdd.Add(Actor.second);
+  }
+  EventsAdd.Write(OutFile);
+
+  CarlaRecorderEventsParent EventsParent;
+  for (const auto &Parent : Parents)
+  {
+    EventsParent.Add(CarlaRecorderEventParent{Parent.first, Parent.second});
+  }
+  EventsParent.Write(OutFile);
+
+  CarlaRecorderLightScenes LightScenes;
+  for (const auto &Light : Lights)
+  {
+    LightScenes.Add(Light.second);
+  }
+  LightScenes.Write(OutFile);
+
+  CarlaRecorderDoorVehicles DoorVehicles;
+  for (const auto &Door : Doors)
+  {
+    DoorVehicles.Add(Door);
+  }
+  DoorVehicles.Write(OutFile);
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
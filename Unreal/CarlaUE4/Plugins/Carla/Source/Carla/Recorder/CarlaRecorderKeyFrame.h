@@ -0,0 +1,55 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "CarlaRecorderDoorVehicle.h"
+#include "CarlaRecorderEventAdd.h"
+#include "CarlaRecorderEventDel.h"
+#include "CarlaRecorderEventParent.h"
+#include "CarlaRecorderLightScene.h"
+
+// Full state of the events recorded so far (actors alive, parents, scene
+// lights and doors), so the replayer can start from a key frame instead of
+// applying all the events since the start of the file.
+//
+// The KeyFrame packet nests an EventAdd, an EventParent, a SceneLight and a
+// VehicleDoor packet, and is written right after the FrameStart packet, so it
+// holds the state before the events of its frame.
+class CarlaRecorderKeyFrame
+{
+public:
+
+  void Reset(void);
+
+  // apply the events of a frame once it is written
+  void Update(
+      CarlaRecorderEventsAdd &EventsAdd,
+      CarlaRecorderEventsDel &EventsDel,
+      CarlaRecorderEventsParent &EventsParent,
+      CarlaRecorderLightScenes &LightScenes,
+      CarlaRecorderDoorVehicles &DoorVehicles);
+
+  void Write(std::ostream &OutFile);
+
+private:
+
+  // sorted by id to spawn the actors in the same order they were recorded
+  std::map<uint32_t, CarlaRecorderEventAdd> Actors;
+
+  // parent of each actor
+  std::map<uint32_t, uint32_t> Parents;
+
+  // last state of each light
+  std::map<int, CarlaRecorderLightScene> Lights;
+
+  // last change of each door, in the order they happened
+  std::vector<CarlaRecorderDoorVehicle> Doors;
+};
@@ -8,6 +8,8 @@
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderHelpers.h"
 
+#include <cstring>
+
 void CarlaRecorderPosition::Write(std::ostream &OutFile)
 {
   // database id
@@ -27,6 +29,131 @@ void CarlaRecorderPosition::Read(std::istream &InFile)
 
 // ---------------------------------------------
 
+namespace CarlaRecorderPosition_Delta
+{
+  /// Each changed record starts with one of these.
+  static constexpr uint8_t Quantized = 0u;
+  static constexpr uint8_t Full = 1u;
+
+  static float &GetValue(CarlaRecorderPosition &Position, int32 Index)
+  {
+    return (Index < 3) ? Position.Location[Index] : Position.Rotation[Index - 3];
+  }
+
+  static float GetValue(const CarlaRecorderPosition &Position, int32 Index)
+  {
+    return (Index < 3) ? Position.Location[Index] : Position.Rotation[Index - 3];
+  }
+
+  static float GetStep(int32 Index)
+  {
+    return (Index < 3) ?
+        CarlaRecorderPositionDeltaPolicy::LocationStep :
+        CarlaRecorderPositionDeltaPolicy::RotationStep;
+  }
+
+  // false if a difference does not fit
+  static bool Quantize(
+      const CarlaRecorderPosition &Previous,
+      const CarlaRecorderPosition &Current,
+      int16_t (&Deltas)[6])
+  {
+    for (int32 i = 0; i < 6; ++i)
+    {
+      const float Steps = (GetValue(Current, i) - GetValue(Previous, i)) / GetStep(i);
+      if (!(FMath::Abs(Steps) <= 32767.0f))
+      {
+        return false;
+      }
+      Deltas[i] = static_cast<int16_t>(FMath::RoundToInt(Steps));
+    }
+    return true;
+  }
+
+  static CarlaRecorderPosition Dequantize(const CarlaRecorderPosition &Previous, const int16_t (&Deltas)[6])
+  {
+    CarlaRecorderPosition Result = Previous;
+    for (int32 i = 0; i < 6; ++i)
+    {
+      GetValue(Result, i) += static_cast<float>(Deltas[i]) * GetStep(i);
+    }
+    return Result;
+  }
+}
+
+constexpr float CarlaRecorderPositionDeltaPolicy::LocationStep;
+constexpr float CarlaRecorderPositionDeltaPolicy::RotationStep;
+
+bool CarlaRecorderPositionDeltaPolicy::IsUnchanged(
+    const CarlaRecorderPosition &Previous,
+    const CarlaRecorderPosition &Current)
+{
+  int16_t Deltas[6];
+  if (!CarlaRecorderPosition_Delta::Quantize(Previous, Current, Deltas))
+  {
+    return false;
+  }
+  for (int16_t Delta : Deltas)
+  {
+    if (Delta != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CarlaRecorderPositionDeltaPolicy::Write(
+    std::ostream &OutFile,
+    const CarlaRecorderPosition *Previous,
+    const CarlaRecorderPosition &Current,
+    CarlaRecorderPosition &Decoded)
+{
+  using namespace CarlaRecorderPosition_Delta;
+  int16_t Deltas[6];
+  if (Previous != nullptr && Quantize(*Previous, Current, Deltas))
+  {
+    WriteValue<uint8_t>(OutFile, Quantized);
+    OutFile.write(reinterpret_cast<const char *>(Deltas), sizeof(Deltas));
+    Decoded = Dequantize(*Previous, Deltas);
+  }
+  else
+  {
+    WriteValue<uint8_t>(OutFile, Full);
+    WriteFVector(OutFile, Current.Location);
+    WriteFVector(OutFile, Current.Rotation);
+    Decoded = Current;
+  }
+}
+
+void CarlaRecorderPositionDeltaPolicy::Read(
+    std::istream &InFile,
+    const CarlaRecorderPosition *Previous,
+    CarlaRecorderPosition &Decoded)
+{
+  using namespace CarlaRecorderPosition_Delta;
+  uint8_t Encoding = Full;
+  ReadValue<uint8_t>(InFile, Encoding);
+  if (Encoding == Quantized)
+  {
+    int16_t Deltas[6];
+    InFile.read(reinterpret_cast<char *>(Deltas), sizeof(Deltas));
+    // a quantized record always has a previous one, unless the file is corrupted
+    CarlaRecorderPosition Origin;
+    Origin.DatabaseId = Decoded.DatabaseId;
+    Origin.Location = FVector::ZeroVector;
+    Origin.Rotation = FVector::ZeroVector;
+    Decoded = Dequantize((Previous != nullptr) ? *Previous : Origin, Deltas);
+  }
+  else
+  {
+    ReadFVector(InFile, Decoded.Location);
+    ReadFVector(InFile, Decoded.Rotation);
+  }
+}
+
+// ---------------------------------------------
+
 void CarlaRecorderPositions::Clear(void)
 {
   Positions.clear();
@@ -58,6 +185,32 @@ void CarlaRecorderPositions::Write(std::ostream &OutFile)
   }
 }
 
+void CarlaRecorderPositions::WriteDelta(std::ostream &OutFile)
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::PositionDelta));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  Delta.Write(OutFile, Positions);
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+void CarlaRecorderPositions::ResetDelta(void)
+{
+  Delta.Clear();
+}
+
 void CarlaRecorderPositions::Read(std::istream &InFile)
 {
   uint16_t i, Total;
@@ -72,6 +225,26 @@ void CarlaRecorderPositions::Read(std::istream &InFile)
   }
 }
 
+size_t CarlaRecorderPositions::Read(const char *InData, size_t InSize)
+{
+  uint16_t Total = 0u;
+  if (InSize < sizeof(Total))
+  {
+    return InSize;
+  }
+  std::memcpy(&Total, InData, sizeof(Total));
+  const size_t Bytes = Total * sizeof(CarlaRecorderPosition);
+  if (InSize - sizeof(Total) < Bytes)
+  {
+    return InSize;
+  }
+  // the records are written as a plain array
+  const size_t First = Positions.size();
+  Positions.resize(First + Total);
+  std::memcpy(Positions.data() + First, InData + sizeof(Total), Bytes);
+  return sizeof(Total) + Bytes;
+}
+
 const std::vector<CarlaRecorderPosition>& CarlaRecorderPositions::GetPositions()
 {
   return Positions;
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "CarlaRecorderDelta.h"
+
 #include <sstream>
 #include <vector>
 
@@ -23,6 +25,30 @@ struct CarlaRecorderPosition
 };
 #pragma pack(pop)
 
+/// Delta encoding of the positions: the location in steps of 0.1 mm and the
+/// rotation in steps of 0.01 degrees relative to the previous frame, as int16,
+/// or the full record when a delta does not fit.
+struct CarlaRecorderPositionDeltaPolicy
+{
+  using RecordType = CarlaRecorderPosition;
+
+  /// In centimeters.
+  static constexpr float LocationStep = 0.01f;
+
+  /// In degrees.
+  static constexpr float RotationStep = 0.01f;
+
+  static bool IsUnchanged(const CarlaRecorderPosition &Previous, const CarlaRecorderPosition &Current);
+
+  static void Write(
+      std::ostream &OutFile,
+      const CarlaRecorderPosition *Previous,
+      const CarlaRecorderPosition &Current,
+      CarlaRecorderPosition &Decoded);
+
+  static void Read(std::istream &InFile, const CarlaRecorderPosition *Previous, CarlaRecorderPosition &Decoded);
+};
+
 class CarlaRecorderPositions
 {
 public:
@@ -31,13 +57,26 @@ public:
 
   void Clear(void);
 
+  /// Write a Position packet with all the records.
   void Write(std::ostream &OutFile);
 
+  /// Write a PositionDelta packet, relative to the last one written.
+  void WriteDelta(std::ostream &OutFile);
+
+  /// The next PositionDelta packet does not depend on the previous ones.
+  void ResetDelta(void);
+
   void Read(std::istream &InFile);
 
+  /// Read the records of a Position packet from memory (after its header),
+  /// copying them straight into the array. Returns the bytes used.
+  size_t Read(const char *InData, size_t InSize);
+
   const std::vector<CarlaRecorderPosition>& GetPositions();
 
 private:
 
   std::vector<CarlaRecorderPosition> Positions;
+
+  TCarlaRecorderDelta<CarlaRecorderPositionDeltaPolicy> Delta;
 };
@@ -85,6 +85,18 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   {
     Info << "Frame " << Frame.Id << " at " << Frame.Elapsed << " seconds\n";
   };
+  auto PrintPosition = [&Info](const CarlaRecorderPosition &Item)
+  {
+    Info << "  Id: " << Item.DatabaseId << " Location: (" << Item.Location.X << ", " << Item.Location.Y << ", " << Item.Location.Z << ") Rotation: (" <<  Item.Rotation.X << ", " << Item.Rotation.Y << ", " << Item.Rotation.Z << ")" << std::endl;
+  };
+  auto PrintAnimVehicle = [&Info](const CarlaRecorderAnimVehicle &Item)
+  {
+    Info << "  Id: " << Item.DatabaseId << " Steering: " << Item.Steering << " Throttle: " << Item.Throttle << " Brake: " << Item.Brake << " Handbrake: " << Item.bHandbrake << " Gear: " << Item.Gear << std::endl;
+  };
+  auto PrintAnimWalker = [&Info](const CarlaRecorderAnimWalker &Item)
+  {
+    Info << "  Id: " << Item.DatabaseId << " speed: " << Item.Speed << std::endl;
+  };
 
   if (!CheckFileInfo(Info))
     return Info.str();
@@ -202,7 +214,27 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           for (i = 0; i < Total; ++i)
           {
             Position.Read(File);
-            Info << "  Id: " << Position.DatabaseId << " Location: (" << Position.Location.X << ", " << Position.Location.Y << ", " << Position.Location.Z << ") Rotation: (" <<  Position.Rotation.X << ", " << Position.Rotation.Y << ", " << Position.Rotation.Z << ")" << std::endl;
+            PrintPosition(Position);
+          }
+        }
+        else
+          SkipPacket();
+        break;
+
+      // positions (only the ones that changed are stored)
+      case static_cast<char>(CarlaRecorderPacketId::PositionDelta):
+        if (bShowAll)
+        {
+          const auto &Positions = PositionDelta.Read(File);
+          if (!Positions.empty() && !bFramePrinted)
+          {
+            PrintFrame(Info);
+            bFramePrinted = true;
+          }
+          Info << " Positions: " << Positions.size() << std::endl;
+          for (const auto &Item : Positions)
+          {
+            PrintPosition(Item);
           }
         }
         else
@@ -245,7 +277,27 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           for (i = 0; i < Total; ++i)
           {
             Vehicle.Read(File);
-            Info << "  Id: " << Vehicle.DatabaseId << " Steering: " << Vehicle.Steering << " Throttle: " << Vehicle.Throttle << " Brake: " << Vehicle.Brake << " Handbrake: " << Vehicle.bHandbrake << " Gear: " << Vehicle.Gear << std::endl;
+            PrintAnimVehicle(Vehicle);
+          }
+        }
+        else
+          SkipPacket();
+        break;
+
+      // vehicle animations (only the ones that changed are stored)
+      case static_cast<char>(CarlaRecorderPacketId::AnimVehicleDelta):
+        if (bShowAll)
+        {
+          const auto &Vehicles = AnimVehicleDelta.Read(File);
+          if (!Vehicles.empty() && !bFramePrinted)
+          {
+            PrintFrame(Info);
+            bFramePrinted = true;
+          }
+          Info << " Vehicle animations: " << Vehicles.size() << std::endl;
+          for (const auto &Item : Vehicles)
+          {
+            PrintAnimVehicle(Item);
           }
         }
         else
@@ -266,7 +318,27 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           for (i = 0; i < Total; ++i)
           {
             Walker.Read(File);
-            Info << "  Id: " << Walker.DatabaseId << " speed: " << Walker.Speed << std::endl;
+            PrintAnimWalker(Walker);
+          }
+        }
+        else
+          SkipPacket();
+        break;
+
+      // walker animations (only the ones that changed are stored)
+      case static_cast<char>(CarlaRecorderPacketId::AnimWalkerDelta):
+        if (bShowAll)
+        {
+          const auto &Walkers = AnimWalkerDelta.Read(File);
+          if (!Walkers.empty() && !bFramePrinted)
+          {
+            PrintFrame(Info);
+            bFramePrinted = true;
+          }
+          Info << " Walker animations: " << Walkers.size() << std::endl;
+          for (const auto &Item : Walkers)
+          {
+            PrintAnimWalker(Item);
           }
         }
         else
@@ -857,6 +929,36 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   Info << " " << std::setw(10) << std::right << "Duration";
   Info << std::endl;
 
+  auto CheckPosition = [&](const CarlaRecorderPosition &Item)
+  {
+    ReplayerActorInfo &Actor = Actors[Item.DatabaseId];
+    // check if actor moved less than a distance
+    if (FVector::Distance(Actor.LastPosition, Item.Location) < MinDistance)
+    {
+      // actor stopped
+      if (Actor.Duration == 0)
+        Actor.Time = Frame.Elapsed;
+      Actor.Duration += Frame.DurationThis;
+    }
+    else
+    {
+      // check to show info
+      if (Actor.Duration >= MinTime)
+      {
+        std::stringstream Result;
+        Result << std::setw(8) << std::setprecision(0) << std::fixed << Actor.Time;
+        Result << " " << std::setw(6) << Item.DatabaseId;
+        Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actor.Id);
+        Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actor.Duration;
+        Result << std::endl;
+        Results.insert(std::make_pair(Actor.Duration, Result.str()));
+      }
+      // actor moving
+      Actor.Duration = 0;
+      Actor.LastPosition = Item.Location;
+    }
+  };
+
   // parse only frames
   while (File)
   {
@@ -913,31 +1015,14 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
         for (i=0; i<Total; ++i)
         {
           Position.Read(File);
-          // check if actor moved less than a distance
-          if (FVector::Distance(Actors[Position.DatabaseId].LastPosition, Position.Location) < MinDistance)
-          {
-            // actor stopped
-            if (Actors[Position.DatabaseId].Duration == 0)
-              Actors[Position.DatabaseId].Time = Frame.Elapsed;
-            Actors[Position.DatabaseId].Duration += Frame.DurationThis;
-          }
-          else
-          {
-            // check to show info
-            if (Actors[Position.DatabaseId].Duration >= MinTime)
-            {
-              std::stringstream Result;
-              Result << std::setw(8) << std::setprecision(0) << std::fixed << Actors[Position.DatabaseId].Time;
-              Result << " " << std::setw(6) << Position.DatabaseId;
-              Result << " " << std::setw(35) << std::left << TCHAR_TO_UTF8(*Actors[Position.DatabaseId].Id);
-              Result << " " << std::setw(10) << std::setprecision(0) << std::fixed << std::right << Actors[Position.DatabaseId].Duration;
-              Result << std::endl;
-              Results.insert(std::make_pair(Actors[Position.DatabaseId].Duration, Result.str()));
-            }
-            // actor moving
-            Actors[Position.DatabaseId].Duration = 0;
-            Actors[Position.DatabaseId].LastPosition = Position.Location;
-          }
+          CheckPosition(Position);
+        }
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::PositionDelta):
+        for (const auto &Item : PositionDelta.Read(File))
+        {
+          CheckPosition(Item);
         }
         break;
 
@@ -8,6 +8,7 @@
 
 #include <fstream>
 
+#include "CarlaRecorderBlockFile.h"
 #include "CarlaRecorderTraficLightTime.h"
 #include "CarlaRecorderPhysicsControl.h"
 #include "CarlaRecorderPlatformTime.h"
@@ -50,7 +51,7 @@ public:
 
 private:
 
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
@@ -71,6 +72,10 @@ private:
   CarlaRecorderTrafficLightTime TrafficLightTime;
   CarlaRecorderWalkerBones WalkerBones;
   CarlaRecorderDoorVehicle DoorVehicle;
+  // decoders of the delta packets
+  TCarlaRecorderDelta<CarlaRecorderPositionDeltaPolicy> PositionDelta;
+  TCarlaRecorderDelta<CarlaRecorderAnimVehicleDeltaPolicy> AnimVehicleDelta;
+  TCarlaRecorderDelta<CarlaRecorderAnimWalkerDeltaPolicy> AnimWalkerDelta;
 
   // read next header packet
   bool ReadHeader(void);
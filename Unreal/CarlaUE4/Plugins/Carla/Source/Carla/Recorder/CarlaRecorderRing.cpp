@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorderRing.h"
+#include "CarlaRecorderFrameIndex.h"
+#include "CarlaRecorderFrames.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace CarlaRecorderRing_Frame
+{
+  // position of the fields in a FrameStart packet: char id, uint32 size and
+  // the CarlaRecorderFrame
+  constexpr uint64_t IdOffset = sizeof(char) + sizeof(uint32_t);
+  constexpr uint64_t ElapsedOffset = IdOffset + sizeof(uint64_t) + sizeof(double);
+}
+
+constexpr double CarlaRecorderRing::KeyFrameInterval;
+
+void CarlaRecorderRing::Start(const std::string &InFilename, double InSeconds, double InSecondsAfter, bool bInCompressed)
+{
+  bEnabled = true;
+  bCompressed = bInCompressed;
+  Filename = InFilename;
+  Count = 0u;
+  Seconds = InSeconds;
+  SecondsAfter = InSecondsAfter;
+  DumpEnd = 0.0;
+  Stream.str(std::string());
+  Stream.clear();
+}
+
+void CarlaRecorderRing::Stop(void)
+{
+  bEnabled = false;
+  // free the memory
+  Stream.str(std::string());
+  Stream.clear();
+}
+
+void CarlaRecorderRing::Trim(CarlaRecorderFrameIndex &Index, CarlaRecorderFrames &Frames)
+{
+  const CarlaRecorderFrameIndexEntry *KeyFrame =
+      Index.FindKeyFrame(Frames.GetFrame().Elapsed - Seconds);
+  if (KeyFrame == nullptr || KeyFrame->Offset == 0u)
+  {
+    return;
+  }
+  // everything before this key frame is not needed anymore
+  const uint64_t Offset = KeyFrame->Offset;
+  Stream.str(Stream.str().substr(Offset));
+  Stream.clear();
+  Stream.seekp(0, std::ios::end);
+  Index.Rebase(Offset, -static_cast<int64_t>(Offset), 0.0);
+  Frames.Rebase(-static_cast<int64_t>(Offset), 0, 0.0);
+}
+
+void CarlaRecorderRing::Dump(std::ostream &OutFile, CarlaRecorderFrameIndex &Index, CarlaRecorderFrames &Frames)
+{
+  using namespace CarlaRecorderRing_Frame;
+
+  std::string Data = Stream.str();
+  Stream.str(std::string());
+  Stream.clear();
+
+  const auto &Entries = Index.GetEntries();
+  if (Entries.empty())
+  {
+    return;
+  }
+
+  // renumber the frames as in a recording started at the first one
+  uint64_t FirstId = 0u;
+  std::memcpy(&FirstId, &Data[Entries.front().Offset + IdOffset], sizeof(uint64_t));
+  const double FirstElapsed = Entries.front().Elapsed;
+  for (const auto &Entry : Entries)
+  {
+    uint64_t Id = 0u;
+    double Elapsed = 0.0;
+    std::memcpy(&Id, &Data[Entry.Offset + IdOffset], sizeof(uint64_t));
+    std::memcpy(&Elapsed, &Data[Entry.Offset + ElapsedOffset], sizeof(double));
+    Id -= FirstId - 1u;
+    Elapsed -= FirstElapsed;
+    std::memcpy(&Data[Entry.Offset + IdOffset], &Id, sizeof(uint64_t));
+    std::memcpy(&Data[Entry.Offset + ElapsedOffset], &Elapsed, sizeof(double));
+  }
+
+  const int64_t Base = static_cast<int64_t>(std::streamoff(OutFile.tellp()));
+  OutFile.write(Data.data(), static_cast<std::streamsize>(Data.size()));
+
+  Index.Rebase(0u, Base, -FirstElapsed);
+  Frames.Rebase(Base, -static_cast<int64_t>(FirstId - 1u), -FirstElapsed);
+}
+
+std::string CarlaRecorderRing::NextFilename(void)
+{
+  // insert the counter before the extension, if any
+  std::string::size_type Dot = Filename.find_last_of('.');
+  std::string::size_type Slash = Filename.find_last_of("/\\");
+  if (Dot == std::string::npos || (Slash != std::string::npos && Dot < Slash))
+  {
+    Dot = Filename.size();
+  }
+  char Suffix[16];
+  std::snprintf(Suffix, sizeof(Suffix), "_%04u", ++Count);
+  return Filename.substr(0, Dot) + Suffix + Filename.substr(Dot);
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+class CarlaRecorderFrameIndex;
+class CarlaRecorderFrames;
+
+// Memory of the flight recorder mode
+//
+// The frames are written to memory instead of a file, with a key frame every
+// second. After each frame the oldest seconds are dropped (always at a key
+// frame, so what is left can be replayed), keeping between Seconds and
+// Seconds + 1 recorded. When triggered, the frames in memory are written to a
+// new file, renumbered to start at frame 1 and time 0, and the recorder keeps
+// writing to that file during SecondsAfter. Then the file is closed and the
+// frames go to memory again until the next trigger.
+class CarlaRecorderRing
+{
+public:
+
+  static constexpr double KeyFrameInterval = 1.0;
+
+  // Filename is the base name of the files, a counter is added to each one
+  void Start(const std::string &Filename, double InSeconds, double InSecondsAfter, bool bInCompressed);
+
+  void Stop(void);
+
+  bool IsEnabled(void) const
+  {
+    return bEnabled;
+  }
+
+  bool IsCompressed(void) const
+  {
+    return bCompressed;
+  }
+
+  std::ostream &GetStream(void)
+  {
+    return Stream;
+  }
+
+  // drop the frames not needed to keep the last seconds
+  void Trim(CarlaRecorderFrameIndex &Index, CarlaRecorderFrames &Frames);
+
+  // write the frames in memory to OutFile (after its header), Index and
+  // Frames are updated to continue recording in OutFile
+  void Dump(std::ostream &OutFile, CarlaRecorderFrameIndex &Index, CarlaRecorderFrames &Frames);
+
+  // name of the file for the next dump (name_0001.log, name_0002.log...)
+  std::string NextFilename(void);
+
+  // recording to a file until this time, after a trigger
+  double GetDumpEnd(void) const
+  {
+    return DumpEnd;
+  }
+
+  void SetDumpEnd(double Elapsed)
+  {
+    DumpEnd = Elapsed + SecondsAfter;
+  }
+
+private:
+
+  bool bEnabled { false };
+
+  bool bCompressed { false };
+
+  std::string Filename;
+
+  uint32_t Count { 0u };
+
+  double Seconds { 0.0 };
+
+  double SecondsAfter { 0.0 };
+
+  double DumpEnd { 0.0 };
+
+  std::stringstream Stream;
+};
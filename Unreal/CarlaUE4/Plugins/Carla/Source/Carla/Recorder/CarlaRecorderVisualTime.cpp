@@ -22,7 +22,7 @@ void CarlaRecorderVisualTime::SetTime(double ThisTime)
   // 将传入的参数ThisTime的值赋给类中的Time成员变量，从而完成对时间的设置操作
 }
 
-void CarlaRecorderVisualTime::Read(std::ifstream &InFile)
+void CarlaRecorderVisualTime::Read(std::istream &InFile)
 // 定义一个名为Read的成员函数，属于CarlaRecorderVisualTime类。
 // 此函数用于从输入文件流InFile中读取数据，并将读取到的数据设置为类中的相关成员变量的值
 {
@@ -32,7 +32,7 @@ void CarlaRecorderVisualTime::Read(std::ifstream &InFile)
   // 并将其赋给当前类（this）的Time成员变量，以完成从文件读取时间数据并设置的操作
 }
 
-void CarlaRecorderVisualTime::Write(std::ofstream &OutFile)
+void CarlaRecorderVisualTime::Write(std::ostream &OutFile)
 // 定义一个名为Write的成员函数，属于CarlaRecorderVisualTime类。
 // 此函数用于将类中与视觉时间相关的数据写入到输出文件流OutFile中
 {
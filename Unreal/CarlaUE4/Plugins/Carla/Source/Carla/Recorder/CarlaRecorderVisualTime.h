@@ -16,9 +16,9 @@ struct CarlaRecorderVisualTime
 
   void SetTime(double ThisTime);
 
-  void Read(std::ifstream &InFile);
+  void Read(std::istream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 };
 #pragma pack(pop)
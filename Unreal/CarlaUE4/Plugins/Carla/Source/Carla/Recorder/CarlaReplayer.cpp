@@ -62,11 +62,16 @@ void CarlaReplayer::Rewind(void)
   File.seekg(0, std::ios::beg);
 
   // mark as header as invalid to force reload a new one next time
+  Frame.Id = 0;
   Frame.Elapsed = -1.0f;
   Frame.DurationThis = 0.0f;
 
   MappedId.clear();
   IsHeroMap.clear();
+  bApplyKeyFrame = false;
+  PositionDelta.Clear();
+  AnimVehicleDelta.Clear();
+  AnimWalkerDelta.Clear();
 
   // read geneal Info
   RecInfo.Read(File);
@@ -75,6 +80,12 @@ void CarlaReplayer::Rewind(void)
 // read last frame in File and return the Total time recorded
 double CarlaReplayer::GetTotalTime(void)
 {
+  // use the index if the file has one
+  if (FrameIndex.Read(File))
+  {
+    return FrameIndex.GetTotalTime();
+  }
+
   std::streampos Current = File.tellg();
 
   // parse only frames
@@ -182,6 +193,9 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   if (IgnoreSpectator)
     Info << "Ignoring Spectator camera" << std::endl;
 
+  if (bFrameStep)
+    Info << "Replaying one recorded frame per tick" << std::endl;
+
   // set the follow Id
   FollowId = ThisFollowId;
 
@@ -191,7 +205,7 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   {
     Helper.RemoveStaticProps();
     // process all events until the time
-    ProcessToTime(TimeStart, true);
+    SeekToTime(TimeStart);
     // mark as enabled
     Enabled = true;
   }
@@ -254,13 +268,27 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   Helper.RemoveStaticProps();
 
   // process all events until the time
-  ProcessToTime(TimeStart, true);
+  SeekToTime(TimeStart);
 
   // mark as enabled
   Enabled = true;
 }
 
-void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
+void CarlaReplayer::SeekToTime(double Time)
+{
+  const CarlaRecorderFrameIndexEntry *KeyFrame = FrameIndex.FindKeyFrame(Time);
+  if (KeyFrame != nullptr)
+  {
+    // the key frame holds all the events before it
+    File.clear();
+    File.seekg(KeyFrame->Offset, std::ios::beg);
+    bApplyKeyFrame = true;
+  }
+
+  ProcessToTime(Time, true);
+}
+
+void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime, bool bNextFrame)
 {
   double Per = 0.0f;
   double NewTime = CurrentTime + Time;
@@ -269,7 +297,7 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
   bool bExitLoop = false;
 
   // check if we are in the right frame
-  if (NewTime >= Frame.Elapsed && NewTime < Frame.Elapsed + Frame.DurationThis)
+  if (!bNextFrame && NewTime >= Frame.Elapsed && NewTime < Frame.Elapsed + Frame.DurationThis)
   {
     Per = (NewTime - Frame.Elapsed) / Frame.DurationThis;
     bFrameFound = true;
@@ -289,14 +317,31 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
       case static_cast<char>(CarlaRecorderPacketId::FrameStart):
         // only read if we are not in the right frame
         Frame.Read(File);
+        // stepping frame by frame: this is the frame, at its recorded position
+        if (bNextFrame)
+        {
+          NewTime = Frame.Elapsed;
+          bFrameFound = true;
+        }
         // check if target time is in this frame
-        if (NewTime < Frame.Elapsed + Frame.DurationThis)
+        else if (NewTime < Frame.Elapsed + Frame.DurationThis)
         {
           Per = (NewTime - Frame.Elapsed) / Frame.DurationThis;
           bFrameFound = true;
         }
         break;
 
+      // key frame, only needed if we started from it
+      case static_cast<char>(CarlaRecorderPacketId::KeyFrame):
+        if (bApplyKeyFrame)
+        {
+          ProcessKeyFrame();
+          bApplyKeyFrame = false;
+        }
+        else
+          SkipPacket();
+        break;
+
       // visual time for FX
       case static_cast<char>(CarlaRecorderPacketId::VisualTime):
         ProcessVisualTime();
@@ -330,6 +375,11 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // positions (delta encoded)
+      case static_cast<char>(CarlaRecorderPacketId::PositionDelta):
+        ProcessPositionDelta(bFrameFound, IsFirstTime);
+        break;
+
       // states
       case static_cast<char>(CarlaRecorderPacketId::State):
         if (bFrameFound)
@@ -346,6 +396,11 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // vehicle animation (delta encoded)
+      case static_cast<char>(CarlaRecorderPacketId::AnimVehicleDelta):
+        ProcessAnimVehicleDelta(bFrameFound);
+        break;
+
       // vehicle wheels animation
       case static_cast<char>(CarlaRecorderPacketId::AnimVehicleWheels):
         if (bFrameFound)
@@ -362,6 +417,11 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
           SkipPacket();
         break;
 
+      // walker animation (delta encoded)
+      case static_cast<char>(CarlaRecorderPacketId::AnimWalkerDelta):
+        ProcessAnimWalkerDelta(bFrameFound);
+        break;
+
       // biker animation
       case static_cast<char>(CarlaRecorderPacketId::AnimBiker):
         if (bFrameFound)
@@ -426,14 +486,47 @@ void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
   // save current time
   CurrentTime = NewTime;
 
-  // stop replay?
-  if (CurrentTime >= TimeToStop)
+  // stop replay? (when stepping, also at the end of the file)
+  if (CurrentTime >= TimeToStop || (bNextFrame && !bFrameFound))
   {
     // keep actors in scene and let them continue with autopilot
     Stop(true);
   }
 }
 
+void CarlaReplayer::ProcessKeyFrame(void)
+{
+  // process the nested packets
+  std::streampos End = File.tellg() + static_cast<std::streamoff>(Header.Size);
+  while (File && File.tellg() < End)
+  {
+    ReadHeader();
+
+    switch (Header.Id)
+    {
+      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+        ProcessEventsAdd();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::EventParent):
+        ProcessEventsParent();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::SceneLight):
+        ProcessLightScene();
+        break;
+
+      case static_cast<char>(CarlaRecorderPacketId::VehicleDoor):
+        ProcessDoorVehicle();
+        break;
+
+      default:
+        SkipPacket();
+        break;
+    }
+  }
+}
+
 void CarlaReplayer::ProcessVisualTime(void)
 {
   CarlaRecorderVisualTime VisualTime;
@@ -581,6 +674,24 @@ void CarlaReplayer::ProcessAnimVehicle(void)
   }
 }
 
+void CarlaReplayer::ProcessAnimVehicleDelta(bool bApply)
+{
+  const std::vector<CarlaRecorderAnimVehicle> &Vehicles = AnimVehicleDelta.Read(File);
+  if (!bApply)
+  {
+    return;
+  }
+  for (CarlaRecorderAnimVehicle Vehicle : Vehicles)
+  {
+    Vehicle.DatabaseId = MappedId[Vehicle.DatabaseId];
+    // check if ignore this actor
+    if (!(IgnoreHero && IsHeroMap[Vehicle.DatabaseId]))
+    {
+      Helper.ProcessReplayerAnimVehicle(Vehicle);
+    }
+  }
+}
+
 void CarlaReplayer::ProcessAnimVehicleWheels(void)
 {
   uint16_t i, Total;
@@ -620,6 +731,24 @@ void CarlaReplayer::ProcessAnimWalker(void)
   }
 }
 
+void CarlaReplayer::ProcessAnimWalkerDelta(bool bApply)
+{
+  const std::vector<CarlaRecorderAnimWalker> &Walkers = AnimWalkerDelta.Read(File);
+  if (!bApply)
+  {
+    return;
+  }
+  for (CarlaRecorderAnimWalker Walker : Walkers)
+  {
+    Walker.DatabaseId = MappedId[Walker.DatabaseId];
+    // check if ignore this actor
+    if (!(IgnoreHero && IsHeroMap[Walker.DatabaseId]))
+    {
+      Helper.ProcessReplayerAnimWalker(Walker);
+    }
+  }
+}
+
 void CarlaReplayer::ProcessAnimBiker(void)
 {
   uint16_t i, Total;
@@ -693,18 +822,37 @@ void CarlaReplayer::ProcessLightScene(void)
 void CarlaReplayer::ProcessPositions(bool IsFirstTime)
 {
   uint16_t i, Total;
+  std::vector<CarlaRecorderPosition> Positions;
+
+  // read all positions
+  ReadValue<uint16_t>(File, Total);
+  Positions.resize(Total);
+  for (i = 0; i < Total; ++i)
+  {
+    Positions[i].Read(File);
+  }
+
+  SetCurrentPositions(Positions, IsFirstTime);
+}
+
+void CarlaReplayer::ProcessPositionDelta(bool bApply, bool IsFirstTime)
+{
+  const std::vector<CarlaRecorderPosition> &Positions = PositionDelta.Read(File);
+  if (bApply)
+  {
+    SetCurrentPositions(Positions, IsFirstTime);
+  }
+}
 
+void CarlaReplayer::SetCurrentPositions(const std::vector<CarlaRecorderPosition> &Positions, bool IsFirstTime)
+{
   // save current as previous
   PrevPos = std::move(CurrPos);
 
-  // read all positions
-  ReadValue<uint16_t>(File, Total);
   CurrPos.clear();
-  CurrPos.reserve(Total);
-  for (i = 0; i < Total; ++i)
+  CurrPos.reserve(Positions.size());
+  for (CarlaRecorderPosition Pos : Positions)
   {
-    CarlaRecorderPosition Pos;
-    Pos.Read(File);
     // assign mapped Id
     auto NewId = MappedId.find(Pos.DatabaseId);
     if (NewId != MappedId.end())
@@ -765,7 +913,10 @@ void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
     }
   }
 
-  // go through each actor and update
+  // go through each actor and collect what to update
+  bool bFollowFound = false;
+  BatchPositions.clear();
+  BatchPositions.reserve(CurrPos.size());
   for (auto &Pos : CurrPos)
   {
     // check if ignore this actor (hero) or the spectator (id == 1)
@@ -779,36 +930,30 @@ void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
         // check if time factor is high
         if (TimeFactor >= 2.0)
           // assign first position
-          InterpolatePosition(PrevPos[Result->second], Pos, 0.0, DeltaTime);
+          BatchPositions.push_back({&PrevPos[Result->second], &Pos, 0.0, nullptr, FTransform::Identity});
         else
           // interpolate
-          InterpolatePosition(PrevPos[Result->second], Pos, Per, DeltaTime);
+          BatchPositions.push_back({&PrevPos[Result->second], &Pos, Per, nullptr, FTransform::Identity});
       }
       else
       {
         // assign last position (we don't have previous one)
-        InterpolatePosition(Pos, Pos, 0.0, DeltaTime);
+        BatchPositions.push_back({&Pos, &Pos, 0.0, nullptr, FTransform::Identity});
       }
     }
 
-    // move the camera to follow this actor if required
-    if (NewFollowId != 0)
-    {
-      if (NewFollowId == Pos.DatabaseId)
-        Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
-    }
+    if (NewFollowId != 0 && NewFollowId == Pos.DatabaseId)
+      bFollowFound = true;
   }
-}
 
-// interpolate a position (transform, velocity...)
-void CarlaReplayer::InterpolatePosition(
-    const CarlaRecorderPosition &Pos1,
-    const CarlaRecorderPosition &Pos2,
-    double Per,
-    double DeltaTime)
-{
-  // call the callback
-  Helper.ProcessReplayerPosition(Pos1, Pos2, Per, DeltaTime, IgnoreSpectator);
+  // move all actors at once
+  Helper.ProcessReplayerPositions(BatchPositions, IgnoreSpectator, bSkipPhysics);
+
+  // move the camera to follow this actor if required (after the actor moved)
+  if (bFollowFound)
+  {
+    Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
+  }
 }
 
 // tick for the replayer
@@ -818,6 +963,9 @@ void CarlaReplayer::Tick(float Delta)
   // check if there are events to process
   if (Enabled)
   {
-    ProcessToTime(Delta * TimeFactor, false);
+    if (bFrameStep)
+      ProcessToTime(0.0, false, true);
+    else
+      ProcessToTime(Delta * TimeFactor, false);
   }
 }
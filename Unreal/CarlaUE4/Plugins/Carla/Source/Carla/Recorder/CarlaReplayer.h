@@ -11,7 +11,11 @@
 #include <unordered_map>
 
 #include <functional>
+#include "CarlaRecorderAnimVehicle.h"
+#include "CarlaRecorderAnimWalker.h"
+#include "CarlaRecorderBlockFile.h"
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderFrameIndex.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
@@ -92,6 +96,26 @@ public:
     IgnoreSpectator = InIgnoreSpectator;
   }
 
+  // teleport the actors without physics (replay only viewing)
+  void SetSkipPhysics(bool InSkipPhysics)
+  {
+    bSkipPhysics = InSkipPhysics;
+  }
+
+  // advance exactly one recorded frame per tick, ignoring the time factor
+  // and the delta time, so every tick shows one recorded frame as it was
+  // recorded (no interpolation)
+  void SetFrameStep(bool InFrameStep)
+  {
+    bFrameStep = InFrameStep;
+  }
+
+  // id of the last recorded frame processed
+  uint64_t GetFrameId(void) const
+  {
+    return Frame.Id;
+  }
+
   // check if after a map is loaded, we need to replay
   void CheckPlayAfterMapLoaded(void);
 
@@ -103,14 +127,24 @@ private:
   bool Enabled;
   bool bReplaySensors = false;
   UCarlaEpisode *Episode = nullptr;
-  // binary file reader
-  std::ifstream File;
+  // binary file reader (plain or compressed)
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
+  // offset and time of each frame, empty if the file has no index
+  CarlaRecorderFrameIndex FrameIndex;
+  // apply the next key frame found (only after seeking to it)
+  bool bApplyKeyFrame { false };
   // positions (to be able to interpolate)
   std::vector<CarlaRecorderPosition> CurrPos;
   std::vector<CarlaRecorderPosition> PrevPos;
+  // actors to move in the current tick, kept to reuse the memory
+  std::vector<CarlaReplayerHelper::ReplayerPosition> BatchPositions;
+  // decoders of the delta packets, they keep the records of the previous frame
+  TCarlaRecorderDelta<CarlaRecorderPositionDeltaPolicy> PositionDelta;
+  TCarlaRecorderDelta<CarlaRecorderAnimVehicleDeltaPolicy> AnimVehicleDelta;
+  TCarlaRecorderDelta<CarlaRecorderAnimWalkerDeltaPolicy> AnimWalkerDelta;
   // mapping id
   std::unordered_map<uint32_t, uint32_t> MappedId;
   // times
@@ -126,6 +160,8 @@ private:
   // ignore hero vehicles
   bool IgnoreHero { false };
   bool IgnoreSpectator { true };
+  bool bSkipPhysics { false };
+  bool bFrameStep { false };
   std::unordered_map<uint32_t, bool> IsHeroMap;
 
   // utils
@@ -137,8 +173,15 @@ private:
 
   void Rewind(void);
 
+  // jump to the last key frame before Time (if the file has an index) and
+  // process from there until Time
+  void SeekToTime(double Time);
+
   // processing packets
-  void ProcessToTime(double Time, bool IsFirstTime = false);
+  // with bNextFrame, Time is ignored and only the next frame is processed
+  void ProcessToTime(double Time, bool IsFirstTime = false, bool bNextFrame = false);
+
+  void ProcessKeyFrame(void);
 
   void ProcessVisualTime(void);
 
@@ -147,12 +190,18 @@ private:
   void ProcessEventsParent(void);
 
   void ProcessPositions(bool IsFirstTime = false);
+  // delta packets are decoded even when the frame is skipped (bApply false),
+  // the next frames depend on them
+  void ProcessPositionDelta(bool bApply, bool IsFirstTime = false);
+  void SetCurrentPositions(const std::vector<CarlaRecorderPosition> &Positions, bool IsFirstTime);
 
   void ProcessStates(void);
 
   void ProcessAnimVehicle(void);
+  void ProcessAnimVehicleDelta(bool bApply);
   void ProcessAnimVehicleWheels(void);
   void ProcessAnimWalker(void);
+  void ProcessAnimWalkerDelta(bool bApply);
   void ProcessAnimBiker(void);
 
   void ProcessLightVehicle(void);
@@ -164,6 +213,4 @@ private:
 
   // positions
   void UpdatePositions(double Per, double DeltaTime);
-
-  void InterpolatePosition(const CarlaRecorderPosition &Start, const CarlaRecorderPosition &End, double Per, double DeltaTime);
 };
@@ -33,6 +33,7 @@
 
 
 #include "EngineUtils.h"
+#include "Async/ParallelFor.h"
 
 // create or reuse an actor for replaying
 std::pair<int, FCarlaActor*>CarlaReplayerHelper::TryToCreateReplayerActor(
@@ -304,36 +305,88 @@ bool CarlaReplayerHelper::ProcessReplayerPosition(CarlaRecorderPosition Pos1, Ca
 {
   check(Episode != nullptr);
   FCarlaActor* CarlaActor = Episode->FindCarlaActor(Pos1.DatabaseId);
-  FVector Location;
-  FRotator Rotation;
   if(CarlaActor)
   {
     //Hot fix to avoid spectator we should investigate why this case is possible here
-    if(bIgnoreSpectator && CarlaActor->GetActor()->GetClass()->GetFName().ToString().Contains("Spectator"))
+    if(bIgnoreSpectator && IsSpectator(CarlaActor))
     {
       return false;
     }
-    // check to assign first position or interpolate between both
-    if (Per == 0.0)
-    {
-      // assign position 1
-      Location = FVector(Pos1.Location);
-      Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
-    }
-    else
-    {
-      // interpolate positions
-      Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
-      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
-    }
     // set new transform
-    FTransform Trans(Rotation, Location, FVector(1, 1, 1));
-    CarlaActor->SetActorGlobalTransform(Trans, ETeleportType::None);
+    CarlaActor->SetActorGlobalTransform(InterpolateTransform(Pos1, Pos2, Per), ETeleportType::None);
     return true;
   }
   return false;
 }
 
+void CarlaReplayerHelper::ProcessReplayerPositions(
+    std::vector<ReplayerPosition> &Positions,
+    bool bIgnoreSpectator,
+    bool bSkipPhysics)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(CarlaReplayerHelper::ProcessReplayerPositions);
+  check(Episode != nullptr);
+
+  // the registry is not modified while replaying a frame, so the lookups
+  // can run together with the interpolation
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+    ParallelFor(Positions.size(), [&](int32 Index)
+    {
+      ReplayerPosition &Pos = Positions[Index];
+      Pos.CarlaActor = Episode->FindCarlaActor(Pos.Start->DatabaseId);
+      if (Pos.CarlaActor)
+      {
+        Pos.Transform = InterpolateTransform(*Pos.Start, *Pos.End, Pos.Per);
+      }
+    });
+  }
+
+  // moving the actors touches the scene, this has to be done in this thread
+  const ETeleportType TeleportType =
+      bSkipPhysics ? ETeleportType::TeleportPhysics : ETeleportType::None;
+  for (const ReplayerPosition &Pos : Positions)
+  {
+    if (Pos.CarlaActor == nullptr)
+      continue;
+    if (bIgnoreSpectator && IsSpectator(Pos.CarlaActor))
+      continue;
+    Pos.CarlaActor->SetActorGlobalTransform(Pos.Transform, TeleportType);
+  }
+}
+
+FTransform CarlaReplayerHelper::InterpolateTransform(
+    const CarlaRecorderPosition &Pos1,
+    const CarlaRecorderPosition &Pos2,
+    double Per)
+{
+  FVector Location;
+  FRotator Rotation;
+  // check to assign first position or interpolate between both
+  if (Per == 0.0)
+  {
+    // assign position 1
+    Location = FVector(Pos1.Location);
+    Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
+  }
+  else
+  {
+    // interpolate positions
+    Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
+    Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
+  }
+  return FTransform(Rotation, Location, FVector(1, 1, 1));
+}
+
+bool CarlaReplayerHelper::IsSpectator(FCarlaActor *CarlaActor)
+{
+  // only actors of type 'other' can be the spectator, this avoids building
+  // the class name for every vehicle and walker
+  if (CarlaActor->GetActorType() != FCarlaActor::ActorType::Other)
+    return false;
+  return CarlaActor->GetActor()->GetClass()->GetFName().ToString().Contains("Spectator");
+}
+
 void CarlaReplayerHelper::ProcessReplayerAnimVehicleWheels(CarlaRecorderAnimWheels VehicleAnimWheels)
 {
   check(Episode != nullptr)
@@ -19,6 +19,7 @@
 #include "CarlaRecorderWalkerBones.h"
 
 #include <unordered_map>
+#include <vector>
 
 class UCarlaEpisode;
 class FCarlaActor;
@@ -29,6 +30,17 @@ class CarlaReplayerHelper
 
 public:
 
+  // one actor to reposition, interpolated between Start and End
+  struct ReplayerPosition
+  {
+    const CarlaRecorderPosition *Start;
+    const CarlaRecorderPosition *End;
+    double Per;
+    // filled by ProcessReplayerPositions
+    FCarlaActor *CarlaActor;
+    FTransform Transform;
+  };
+
   // set the episode to use
   void SetEpisode(UCarlaEpisode *ThisEpisode)
   {
@@ -54,6 +66,12 @@ public:
   // reposition actors
   bool ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime, bool bIgnoreSpectator);
 
+  // reposition all actors of a frame at once: the actor lookups and the
+  // interpolation run in parallel, then the transforms are set on the game
+  // thread. With bSkipPhysics the actors are teleported, so the physics
+  // bodies are moved without computing velocities (replay only viewing)
+  void ProcessReplayerPositions(std::vector<ReplayerPosition> &Positions, bool bIgnoreSpectator, bool bSkipPhysics);
+
   // replay event for traffic light state
   bool ProcessReplayerStateTrafficLight(CarlaRecorderStateTrafficLight State);
 
@@ -108,6 +126,12 @@ private:
 
   FCarlaActor* FindTrafficLightAt(FVector Location);
 
+  // interpolated transform between two recorded positions
+  static FTransform InterpolateTransform(const CarlaRecorderPosition &Pos1, const CarlaRecorderPosition &Pos2, double Per);
+
+  // hot fix to avoid the spectator, see ProcessReplayerPosition
+  static bool IsSpectator(FCarlaActor *CarlaActor);
+
   // enable / disable physics for an actor
   bool SetActorSimulatePhysics(FCarlaActor *CarlaActor, bool bEnabled);
   // enable / disable autopilot for an actor
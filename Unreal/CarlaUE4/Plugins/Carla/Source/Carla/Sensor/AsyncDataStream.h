@@ -10,10 +10,16 @@
 #include <carla/Buffer.h>
 #include <carla/Logging.h>
 #include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/s11n/Compression.h>
 #include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/sensor/s11n/VideoStream.h>
 #include <carla/streaming/Stream.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include "Carla/Sensor/SensorBundle.h"
+
+#include <memory>
+
 template <typename T>
 class FDataStreamTmpl;
 
@@ -76,6 +82,42 @@ public:
     }
   }
 
+  /// Compress the payload of the message before sending it. The header is
+  /// flagged so the client's Deserializer can decompress it transparently.
+  void SetCompression(carla::sensor::s11n::CompressionType InCompression)
+  {
+    Compression = InCompression;
+    SetHeaderCompression(Compression);
+  }
+
+  /// Encode the payload with @a InEncoder, the encoder of the sensor, which
+  /// keeps the previous frames. The header is flagged as a video frame so the
+  /// client decodes it with the decoder of its subscription.
+  void SetVideoEncoder(std::shared_ptr<carla::sensor::s11n::VideoEncoder> InEncoder)
+  {
+    VideoEncoder = std::move(InEncoder);
+    SetCompression(carla::sensor::s11n::CompressionType::Video);
+  }
+
+  /// Flag the format of the payload in the header, e.g. the format of a
+  /// camera image converted on the GPU (see carla::sensor::s11n::ImageFormat).
+  void SetPayloadFormat(uint8_t Format)
+  {
+    carla::sensor::s11n::SensorHeaderSerializer::Header *HeaderStr =
+      reinterpret_cast<carla::sensor::s11n::SensorHeaderSerializer::Header *>(Header.data());
+    if (HeaderStr)
+    {
+      carla::sensor::s11n::SensorHeaderSerializer::SetPayloadFormat(*HeaderStr, Format);
+    }
+  }
+
+  /// Also send the data to @a InBundle, which coalesces it with the data of
+  /// the other sensors of the bundle.
+  void SetBundle(std::shared_ptr<FSensorBundle> InBundle)
+  {
+    Bundle = std::move(InBundle);
+  }
+
   /// return the type of sensor of this stream
   uint64_t GetSensorType()
   {
@@ -83,7 +125,7 @@ public:
       reinterpret_cast<carla::sensor::s11n::SensorHeaderSerializer::Header *>(Header.data());
     if (HeaderStr)
     {
-      return HeaderStr->sensor_type;
+      return carla::sensor::s11n::SensorHeaderSerializer::GetSensorTypeId(*HeaderStr);
     }
     return 0u;
   }
@@ -123,9 +165,73 @@ private:
       double Timestamp,
       StreamType InStream);
 
+  void SetHeaderCompression(carla::sensor::s11n::CompressionType InCompression)
+  {
+    carla::sensor::s11n::SensorHeaderSerializer::Header *HeaderStr =
+      reinterpret_cast<carla::sensor::s11n::SensorHeaderSerializer::Header *>(Header.data());
+    if (HeaderStr)
+    {
+      carla::sensor::s11n::SensorHeaderSerializer::SetCompression(
+          *HeaderStr,
+          static_cast<uint8_t>(InCompression));
+    }
+  }
+
+  static boost::asio::const_buffer MakeConstBuffer(const carla::Buffer &Buffer)
+  {
+    return Buffer.cbuffer();
+  }
+
+  static boost::asio::const_buffer MakeConstBuffer(const carla::SharedBufferView &View)
+  {
+    return View->cbuffer();
+  }
+
+  /// Compress the payload into a single buffer, returns an empty buffer if the
+  /// compression failed, in which case the data is sent uncompressed.
+  template <typename... ArgsT>
+  carla::Buffer CompressPayload(const ArgsT &... Args)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Compress Sensor Data");
+    auto Compressed = (Compression == carla::sensor::s11n::CompressionType::Video && VideoEncoder) ?
+        VideoEncoder->Encode({MakeConstBuffer(Args)...}, PopBufferFromPool()) :
+        carla::sensor::s11n::Compression::Compress(
+            Compression,
+            {MakeConstBuffer(Args)...},
+            PopBufferFromPool());
+    if (Compressed.empty())
+    {
+      carla::log_warning("failed to compress sensor data, sending it uncompressed");
+      SetHeaderCompression(carla::sensor::s11n::CompressionType::None);
+    }
+    return Compressed;
+  }
+
+  /// Write the message to the stream and to the bundle, if any.
+  template <typename... ViewsT>
+  void WriteViews(carla::SharedBufferView ViewHeader, ViewsT &&... Views)
+  {
+    if (Bundle)
+    {
+      const auto *HeaderStr =
+          reinterpret_cast<const carla::sensor::s11n::SensorHeaderSerializer::Header *>(ViewHeader->data());
+      Bundle->Add(
+          carla::streaming::detail::token_type(Stream.token()).get_stream_id(),
+          HeaderStr->frame,
+          {ViewHeader->cbuffer(), MakeConstBuffer(Views)...});
+    }
+    Stream.Write(std::move(ViewHeader), std::forward<ViewsT>(Views)...);
+  }
+
   StreamType Stream;
 
   carla::Buffer Header;
+
+  std::shared_ptr<FSensorBundle> Bundle;
+
+  std::shared_ptr<carla::sensor::s11n::VideoEncoder> VideoEncoder;
+
+  carla::sensor::s11n::CompressionType Compression = carla::sensor::s11n::CompressionType::None;
 };
 
 // =============================================================================
@@ -147,21 +253,42 @@ inline void FAsyncDataStreamTmpl<T>::SerializeAndSend(SensorT &Sensor, ArgsT &&.
   // serialize data
   carla::Buffer Data(carla::sensor::SensorRegistry::Serialize(Sensor, std::forward<ArgsT>(Args)...));
 
+  if (Compression != carla::sensor::s11n::CompressionType::None)
+  {
+    auto Compressed = CompressPayload(Data);
+    if (!Compressed.empty())
+    {
+      Data = std::move(Compressed);
+    }
+  }
+
   // create views of buffers
   auto ViewHeader = carla::BufferView::CreateFrom(std::move(Header));
   auto ViewData = carla::BufferView::CreateFrom(std::move(Data));
 
   // send views
-  Stream.Write(ViewHeader, ViewData);
+  WriteViews(ViewHeader, ViewData);
 }
 
 template <typename T>
 template <typename SensorT, typename... ArgsT>
 inline void FAsyncDataStreamTmpl<T>::Send(SensorT &Sensor, ArgsT &&... Args)
 {
+  if (Compression != carla::sensor::s11n::CompressionType::None)
+  {
+    auto Compressed = CompressPayload(Args...);
+    if (!Compressed.empty())
+    {
+      auto ViewHeader = carla::BufferView::CreateFrom(std::move(Header));
+      auto ViewData = carla::BufferView::CreateFrom(std::move(Compressed));
+      WriteViews(ViewHeader, ViewData);
+      return;
+    }
+  }
+
   // create views of buffers
   auto ViewHeader = carla::BufferView::CreateFrom(std::move(Header));
 
   // send views
-  Stream.Write(ViewHeader, std::forward<ArgsT>(Args)...);
+  WriteViews(ViewHeader, std::forward<ArgsT>(Args)...);
 }
@@ -61,20 +61,68 @@ void ACollisionSensor::SetOwner(AActor *NewOwner)
   }
 }
 
-void ACollisionSensor::PrePhysTick(float DeltaSeconds) {
-  Super::PrePhysTick(DeltaSeconds);
-
-  // remove all items from previous frames
-  uint64_t CurrentFrame = FCarlaEngine::GetFrameCounter();
-  CollisionRegistry.erase(
-      std::remove_if(
-          CollisionRegistry.begin(),
-          CollisionRegistry.end(),
-          [CurrentFrame](std::tuple<uint64_t, AActor*, AActor*> Item)
-          {
-            return std::get<0>(Item) < CurrentFrame;
-          }),
-      CollisionRegistry.end());
+void ACollisionSensor::OnFirstClientConnected()
+{
+  PendingCollisions.clear();
+  bSendCollisions = true;
+}
+
+void ACollisionSensor::OnLastClientDisconnected()
+{
+  PendingCollisions.clear();
+  bSendCollisions = false;
+}
+
+void ACollisionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACollisionSensor::PostPhysTick);
+  if (PendingCollisions.empty())
+  {
+    return;
+  }
+
+  const auto& CurrentEpisode = GetEpisode();
+  constexpr float TO_METERS = 1e-2;
+  for (FPendingCollision& Collision : PendingCollisions)
+  {
+    AActor* Actor = Collision.Actor.Get();
+    AActor* OtherActor = Collision.OtherActor.Get();
+    if (Actor == nullptr || OtherActor == nullptr)
+    {
+      // Destroyed since the hit
+      continue;
+    }
+    const FVector NormalImpulse = Collision.NormalImpulse * TO_METERS;
+    GetDataStream(*this).SerializeAndSend(
+        *this,
+        CurrentEpisode.SerializeActor(Actor),
+        CurrentEpisode.SerializeActor(OtherActor),
+        carla::geom::Vector3D(
+            (float)NormalImpulse.X,
+            (float)NormalImpulse.Y,
+            (float)NormalImpulse.Z));
+
+    // ROS2
+#if defined(WITH_ROS2)
+    auto ROS2 = carla::ros2::ROS2::GetInstance();
+    if (ROS2->IsEnabled())
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("ROS2 Send");
+      auto StreamId = carla::streaming::detail::token_type(GetToken()).get_stream_id();
+      AActor* ParentActor = GetAttachParentActor();
+      if (ParentActor)
+      {
+        FTransform LocalTransformRelativeToParent = GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
+        ROS2->ProcessDataFromCollisionSensor(0, StreamId, LocalTransformRelativeToParent, OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      }
+      else
+      {
+        ROS2->ProcessDataFromCollisionSensor(0, StreamId, GetActorTransform(), OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      }
+    }
+#endif
+  }
+  PendingCollisions.clear();
 }
 
 void ACollisionSensor::OnCollisionEvent(
@@ -97,57 +145,44 @@ void ACollisionSensor::OnCollisionEvent(
     return;
   }
 
-  uint64_t CurrentFrame = FCarlaEngine::GetFrameCounter();
-
-  // check if this collision has been procesed already in this frame
-  for (auto& Collision: CollisionRegistry)
+  // accumulate the impulse of every hit with the same actor, the event is
+  // sent once per frame in PostPhysTick
+  if (bSendCollisions)
   {
-    if (std::get<0>(Collision) == CurrentFrame &&
-        std::get<1>(Collision) == Actor &&
-        std::get<2>(Collision) == OtherActor)
+    auto Pending = std::find_if(
+        PendingCollisions.begin(),
+        PendingCollisions.end(),
+        [Actor, OtherActor](const FPendingCollision& Collision)
+        {
+          return Collision.Actor.Get() == Actor && Collision.OtherActor.Get() == OtherActor;
+        });
+    if (Pending != PendingCollisions.end())
+    {
+      Pending->NormalImpulse += NormalImpulse;
+    }
+    else
     {
-      return;
+      PendingCollisions.push_back(FPendingCollision{Actor, OtherActor, NormalImpulse});
     }
   }
 
+  // record the collision event, once per frame and pair of actors
   const auto& CurrentEpisode = GetEpisode();
-  constexpr float TO_METERS = 1e-2;
-  NormalImpulse *= TO_METERS;
-  GetDataStream(*this).SerializeAndSend(
-      *this,
-      CurrentEpisode.SerializeActor(Actor),
-      CurrentEpisode.SerializeActor(OtherActor),
-      carla::geom::Vector3D(
-          (float)NormalImpulse.X,
-          (float)NormalImpulse.Y,
-          (float)NormalImpulse.Z));
-
-  // record the collision event
-  if (CurrentEpisode.GetRecorder()->IsEnabled()){
-      CurrentEpisode.GetRecorder()->AddCollision(Actor, OtherActor);
-  }
-
-  CollisionRegistry.emplace_back(CurrentFrame, Actor, OtherActor);
-
-  // ROS2
-#if defined(WITH_ROS2)
-  auto ROS2 = carla::ros2::ROS2::GetInstance();
-  if (ROS2->IsEnabled())
+  if (CurrentEpisode.GetRecorder()->IsEnabled())
   {
-    TRACE_CPUPROFILER_EVENT_SCOPE_STR("ROS2 Send");
-    auto StreamId = carla::streaming::detail::token_type(GetToken()).get_stream_id();
-    AActor* ParentActor = GetAttachParentActor();
-    if (ParentActor)
+    const uint64_t CurrentFrame = FCarlaEngine::GetFrameCounter();
+    if (RecordedCollisionsFrame != CurrentFrame)
     {
-      FTransform LocalTransformRelativeToParent = GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
-      ROS2->ProcessDataFromCollisionSensor(0, StreamId, LocalTransformRelativeToParent, OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      RecordedCollisions.clear();
+      RecordedCollisionsFrame = CurrentFrame;
     }
-    else
+    const auto Pair = std::make_pair(Actor, OtherActor);
+    if (std::find(RecordedCollisions.begin(), RecordedCollisions.end(), Pair) == RecordedCollisions.end())
     {
-      ROS2->ProcessDataFromCollisionSensor(0, StreamId, GetActorTransform(), OtherActor->GetUniqueID(), carla::geom::Vector3D{NormalImpulse.X, NormalImpulse.Y, NormalImpulse.Z}, this);
+      RecordedCollisions.push_back(Pair);
+      CurrentEpisode.GetRecorder()->AddCollision(Actor, OtherActor);
     }
   }
-#endif
 }
 
 void ACollisionSensor::OnActorCollisionEvent(
@@ -26,9 +26,12 @@ public:
 
   ACollisionSensor(const FObjectInitializer& ObjectInitializer);
 
-  virtual void PrePhysTick(float DeltaSeconds) override;
+  void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
   void SetOwner(AActor *NewOwner) override;
 
+  void OnFirstClientConnected() override;
+  void OnLastClientDisconnected() override;
+
   UFUNCTION()
   void OnCollisionEvent(
       AActor *Actor,
@@ -52,7 +55,25 @@ public:
       const FHitResult& Hit);
 
 private:
-  /// 保存所有碰撞的注册表。
-  /// 用于避免每帧发送多次相同的碰撞，因为碰撞传感器使用 PhysX 子步节拍信号。有助于传感器的使用和流过载。
-  std::vector<std::tuple<uint64_t, AActor*, AActor*>> CollisionRegistry;
+
+  struct FPendingCollision
+  {
+    TWeakObjectPtr<AActor> Actor;
+    TWeakObjectPtr<AActor> OtherActor;
+    FVector NormalImpulse;
+  };
+
+  /// 自上次发送以来的碰撞，每对参与者只有一项并累加所有碰撞通知的冲量，
+  /// 在 PostPhysTick 中每帧每对参与者只发送一条消息。
+  /// 碰撞传感器使用 PhysX 子步节拍信号，摩擦接触每秒会产生数百次碰撞通知，
+  /// 逐个发送会使流过载。
+  std::vector<FPendingCollision> PendingCollisions;
+
+  /// 本帧已经交给录制器的碰撞，与发送的消息采用相同的去重规则。
+  std::vector<std::pair<AActor*, AActor*>> RecordedCollisions;
+
+  uint64_t RecordedCollisionsFrame = 0u;
+
+  /// 没有客户端监听时不累积碰撞。
+  bool bSendCollisions = false;
 };
@@ -13,6 +13,10 @@
 #include "Carla/Util/RandomEngine.h"
 #include "Carla/Sensor/DVSCamera.h"
 #include "Actor/ActorBlueprintFunctionLibrary.h"
+#include "DVSEventPass.h"
+#include "RenderingThread.h"
+#include "RHIDefinitions.h"
+#include "TextureResource.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/ros2/ROS2.h"
@@ -85,7 +89,13 @@ FActorDefinition ADVSCamera::GetSensorDefinition()
   Log_EPS.RecommendedValues = { TEXT("0.001") };
   Log_EPS.bRestrictToRecommended = false;
 
-  Definition.Variations.Append({ Cp, Cm, Sigma_Cp, Sigma_Cm, Refractory_Period, Use_Log, Log_EPS });
+  FActorVariation Backend;
+  Backend.Id = TEXT("backend");  // 事件仿真的位置："gpu" 只回读事件，"cpu" 回读整幅图像后逐像素仿真
+  Backend.Type = EActorAttributeType::String;
+  Backend.RecommendedValues = { TEXT("gpu"), TEXT("cpu") };
+  Backend.bRestrictToRecommended = true;
+
+  Definition.Variations.Append({ Cp, Cm, Sigma_Cp, Sigma_Cm, Refractory_Period, Use_Log, Log_EPS, Backend });
 
   return Definition;
 }
@@ -128,6 +138,16 @@ void ADVSCamera::Set(const FActorDescription &Description)
       "log_eps",
       Description.Variations,
       1e-03);
+
+  // 计算着色器需要 SM5，不支持时退回 CPU 仿真
+  this->config.use_gpu = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "backend",
+      Description.Variations,
+      "gpu") == TEXT("gpu") && GMaxRHIFeatureLevel >= ERHIFeatureLevel::SM5;
+  if (this->config.use_gpu && !EventPass)
+  {
+    EventPass = std::make_shared<FDVSEventPass>();
+  }
 }
 
 // 物理节拍信号后处理
@@ -142,25 +162,35 @@ void ADVSCamera::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
 
   /// 在当前时刻，场景的立刻入队渲染命令。
   EnqueueRenderSceneImmediate();
-  WaitForRenderThreadToFinish();
 
-  //Super (ASceneCaptureSensor) Capture the Scene in a (UTextureRenderTarget2D) CaptureRenderTarge from the CaptureComponent2D
-  /** 读取图像 **/
-  TArray<FColor> RawImage;
-  this->ReadPixels(RawImage);
-
-  /** 将图像转换为灰度图 **/
-  if (this->config.use_log)
+  ADVSCamera::DVSEventArray events;
+  if (this->config.use_gpu)
   {
-    this->ImageToLogGray(RawImage);
+    /** 在 GPU 上仿真，只回读事件 **/
+    events = this->SimulationOnGPU();
   }
   else
   {
-    this->ImageToGray(RawImage);
-  }
+    WaitForRenderThreadToFinish();
+
+    //Super (ASceneCaptureSensor) Capture the Scene in a (UTextureRenderTarget2D) CaptureRenderTarge from the CaptureComponent2D
+    /** 读取图像 **/
+    TArray<FColor> RawImage;
+    this->ReadPixels(RawImage);
 
-  /** 动态视觉传感器仿真器 **/
-  ADVSCamera::DVSEventArray events = this->Simulation(DeltaTime);
+    /** 将图像转换为灰度图 **/
+    if (this->config.use_log)
+    {
+      this->ImageToLogGray(RawImage);
+    }
+    else
+    {
+      this->ImageToGray(RawImage);
+    }
+
+    /** 动态视觉传感器仿真器 **/
+    events = this->Simulation(DeltaTime);
+  }
 
   auto Stream = GetDataStream(*this);       // 获得数据流
   auto Buff = Stream.PopBufferFromPool();   // 从内存池中获取一个内存缓冲，用于存数据
@@ -352,3 +382,72 @@ ADVSCamera::DVSEventArray ADVSCamera::Simulation (float DeltaTime)
 
   return events;
 }
+
+// 在 GPU 上执行仿真
+ADVSCamera::DVSEventArray ADVSCamera::SimulationOnGPU()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ADVSCamera::SimulationOnGPU);
+  ADVSCamera::DVSEventArray events;
+
+  const std::int64_t now = dvs::secToNanosec(this->GetEpisode().GetElapsedGameTime());
+  if (!this->bEventPassInitialized)
+  {
+    /** 第一帧只初始化像素状态 **/
+    this->current_time = now;
+  }
+
+  /** 以纳秒表示的时间增量，计算着色器中以 32 位保存（最多约 4.29 秒） **/
+  const std::int64_t delta_t_ns = std::max<std::int64_t>(now - this->current_time, 0);
+  const uint32 DeltaTimeNs = static_cast<uint32>(std::min<std::int64_t>(delta_t_ns, MAX_uint32));
+
+  FDVSEventParameters Parameters;
+  Parameters.PositiveThreshold = this->config.Cp;
+  Parameters.NegativeThreshold = this->config.Cm;
+  Parameters.SigmaPositive = this->config.sigma_Cp;
+  Parameters.SigmaNegative = this->config.sigma_Cm;
+  Parameters.RefractoryPeriodNs = static_cast<float>(this->config.refractory_period_ns);
+  Parameters.bUseLog = this->config.use_log;
+  Parameters.LogEps = this->config.log_eps;
+  // 噪声的种子来自传感器的随机引擎，保证相同种子下结果可复现
+  Parameters.Seed = static_cast<uint32>(RandomEngine->GetUniformIntInRange(0, MAX_int32));
+
+  TArray<FDVSGpuEvent> GpuEvents;
+  auto Pass = this->EventPass;
+  auto *Resource = static_cast<const FTextureRenderTarget2DResource *>(CaptureRenderTarget->Resource);
+  ENQUEUE_RENDER_COMMAND(DVSEventSimulation)(
+    [Pass, Resource, Parameters, DeltaTimeNs, &GpuEvents](FRHICommandListImmediate &RHICmdList)
+    {
+      FTexture2DRHIRef Texture = Resource != nullptr ? Resource->GetRenderTargetTexture() : nullptr;
+      if (Texture)
+      {
+        Pass->Execute(RHICmdList, Texture, Parameters, DeltaTimeNs, GpuEvents);
+      }
+    });
+  // 回读是同步的，等待渲染线程写完事件
+  FlushRenderingCommands();
+
+  if (Pass->GetNumDroppedEvents() > 0u)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("DVS camera: %u events dropped, the event buffer grows for the next frame"),
+        Pass->GetNumDroppedEvents());
+  }
+
+  events.reserve(GpuEvents.Num());
+  for (const FDVSGpuEvent &Event : GpuEvents)
+  {
+    events.emplace_back(Event.GetX(), Event.GetY(), this->current_time + Event.TimeOffsetNs, Event.Polarity != 0u);
+  }
+
+  /** 更新当前时间 **/
+  this->bEventPassInitialized = true;
+  this->current_time = now;
+
+  // 事件在 GPU 上的写入顺序不确定，按时间戳排序（时间相同时按位置）保证结果稳定
+  std::sort(events.begin(), events.end(), [](const ::carla::sensor::data::DVSEvent& it1, const ::carla::sensor::data::DVSEvent& it2){
+    if (it1.t != it2.t) return it1.t < it2.t;
+    if (it1.y != it2.y) return it1.y < it2.y;
+    return it1.x < it2.x;
+  });
+
+  return events;
+}
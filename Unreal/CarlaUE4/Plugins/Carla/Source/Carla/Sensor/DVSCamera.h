@@ -16,8 +16,12 @@
 #include "Sensor/ShaderBasedSensor.h"
 #include <carla/sensor/data/DVSEvent.h>
 
+#include <memory>
+
 #include "DVSCamera.generated.h"
 
+class FDVSEventPass;
+
 namespace dvs
 {
   /// 动态视觉传感器 (DVS, Dynamic Vision Sensor) 配置结构
@@ -30,6 +34,7 @@ namespace dvs
     std::uint64_t refractory_period_ns;  // 不应期（像素在触发事件后无法触发事件的时间），以纳秒为单位。它限制了触发事件的最高频率。
     bool use_log;    // 是否以对数强度刻度工作。
     float log_eps;   // 用于将图像转换为对数的 Epsilon 值
+    bool use_gpu;    // 是否在 GPU 上仿真事件，只回读事件而不是整幅图像。
   };
 
   // 秒转纳秒
@@ -64,6 +69,9 @@ protected:
   void ImageToLogGray(const TArray<FColor> &image);
   ADVSCamera::DVSEventArray Simulation (float DeltaTime);
 
+  /// 在 GPU 上用计算着色器执行仿真，像素状态保存在显存中，只回读事件。
+  ADVSCamera::DVSEventArray SimulationOnGPU();
+
 private:
   /// 包含最新（当前）图像和先前图像的图像
   TArray<float> last_image, prev_image;
@@ -79,4 +87,10 @@ private:
 
   /// 动态时间传感器的仿真配置
   dvs::Config config;
+
+  /// GPU 仿真的计算着色器阶段，持有像素状态，只在渲染线程中使用
+  std::shared_ptr<FDVSEventPass> EventPass;
+
+  /// GPU 上的像素状态是否已经用第一帧图像初始化
+  bool bEventPassInitialized = false;
 };
@@ -27,4 +27,12 @@ public:
 protected:
 
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+  /// The depth can also be sent decoded, in meters.
+  bool SupportsImageFormat(carla::sensor::s11n::ImageFormat Format) const override
+  {
+    return Format == carla::sensor::s11n::ImageFormat::BGRA8 ||
+        Format == carla::sensor::s11n::ImageFormat::Depth16F ||
+        Format == carla::sensor::s11n::ImageFormat::Depth32F;
+  }
 };
@@ -44,18 +44,34 @@ void AGnssSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSe
   {
     ActorLocation = LargeMap->LocalToGlobalLocation(ActorLocation);
   }
-  carla::geom::Location Location = ActorLocation;
-  carla::geom::GeoLocation CurrentLocation = CurrentGeoReference.Transform(Location);
 
-  // Compute the noise for the sensor
-  const float LatError = RandomEngine->GetNormalDistribution(0.0f, LatitudeDeviation);
-  const float LonError = RandomEngine->GetNormalDistribution(0.0f, LongitudeDeviation);
-  const float AltError = RandomEngine->GetNormalDistribution(0.0f, AltitudeDeviation);
+  std::vector<carla::sensor::s11n::GnssSerializer::Sample> Samples;
+  if (SamplesPerTick > 1)
+  {
+    FSensorKinematicState CurrentState;
+    CurrentState.Location = ActorLocation;
+    CurrentState.Velocity = FSubTickInterpolation::GetVelocityAtLocation(GetOwner(), GetActorLocation());
+    if (bHasPrevState && DeltaSeconds > 0.0f)
+    {
+      Samples.reserve(SamplesPerTick);
+      for (int32 i = 1; i <= SamplesPerTick; ++i)
+      {
+        const float Alpha = static_cast<float>(i) / static_cast<float>(SamplesPerTick);
+        Samples.push_back(carla::sensor::s11n::GnssSerializer::Sample{
+            (Alpha - 1.0f) * DeltaSeconds,
+            ComputeGeoLocation(FSubTickInterpolation::GetLocation(PrevState, CurrentState, DeltaSeconds, Alpha))});
+      }
+    }
+    PrevState = CurrentState;
+    bHasPrevState = true;
+  }
 
-  // Apply the noise to the sensor
-  double Latitude = CurrentLocation.latitude + LatitudeBias + LatError;
-  double Longitude = CurrentLocation.longitude + LongitudeBias + LonError;
-  double Altitude = CurrentLocation.altitude + AltitudeBias + AltError;
+  // The measurement itself is the last sample
+  const carla::geom::GeoLocation GeoLocation =
+      Samples.empty() ? ComputeGeoLocation(ActorLocation) : Samples.back().geo_location;
+  const double Latitude = GeoLocation.latitude;
+  const double Longitude = GeoLocation.longitude;
+  const double Altitude = GeoLocation.altitude;
 
   auto Stream = GetDataStream(*this);
 
@@ -80,10 +96,34 @@ void AGnssSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSe
   #endif
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("AGnssSensor Stream Send");
-    Stream.SerializeAndSend(*this, carla::geom::GeoLocation{Latitude, Longitude, Altitude});
+    if (Samples.empty())
+    {
+      Stream.SerializeAndSend(*this, carla::geom::GeoLocation{Latitude, Longitude, Altitude});
+    }
+    else
+    {
+      Stream.SerializeAndSend(*this, Samples);
+    }
   }
 }
 
+carla::geom::GeoLocation AGnssSensor::ComputeGeoLocation(const FVector &ActorLocation)
+{
+  carla::geom::Location Location = ActorLocation;
+  carla::geom::GeoLocation CurrentLocation = CurrentGeoReference.Transform(Location);
+
+  // Compute the noise for the sensor
+  const float LatError = RandomEngine->GetNormalDistribution(0.0f, LatitudeDeviation);
+  const float LonError = RandomEngine->GetNormalDistribution(0.0f, LongitudeDeviation);
+  const float AltError = RandomEngine->GetNormalDistribution(0.0f, AltitudeDeviation);
+
+  // Apply the noise to the sensor
+  return carla::geom::GeoLocation{
+      CurrentLocation.latitude + LatitudeBias + LatError,
+      CurrentLocation.longitude + LongitudeBias + LonError,
+      CurrentLocation.altitude + AltitudeBias + AltError};
+}
+
 void AGnssSensor::SetLatitudeDeviation(float Value)
 {
   LatitudeDeviation = Value;
@@ -140,6 +180,16 @@ float AGnssSensor::GetAltitudeBias() const
   return AltitudeBias;
 }
 
+void AGnssSensor::SetSamplesPerTick(const int32 Value)
+{
+  SamplesPerTick = FMath::Max(Value, 1);
+}
+
+int32 AGnssSensor::GetSamplesPerTick() const
+{
+  return SamplesPerTick;
+}
+
 void AGnssSensor::BeginPlay()
 {
   Super::BeginPlay();
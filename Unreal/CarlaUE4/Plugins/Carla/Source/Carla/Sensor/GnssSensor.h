@@ -7,14 +7,18 @@
 #pragma once
 
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Sensor/SubTickInterpolation.h"
 
 #include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Actor/ActorDescription.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/GeoLocation.h"
+#include "carla/sensor/s11n/GnssSerializer.h"
 #include <compiler/enable-ue4-macros.h>
 
+#include <vector>
+
 #include "GnssSensor.generated.h"
 
 /// Gnss sensor representation
@@ -51,14 +55,30 @@ public:
   float GetLongitudeBias() const;
   float GetAltitudeBias() const;
 
+  /// Number of samples interpolated between two ticks and sent together, 1
+  /// to send only the location at the end of the tick.
+  void SetSamplesPerTick(int32 Value);
+
+  int32 GetSamplesPerTick() const;
+
 protected:
 
   virtual void BeginPlay() override;
 
 private:
 
+  /// Geo location of @a Location (global, in cm) with noise applied.
+  carla::geom::GeoLocation ComputeGeoLocation(const FVector &Location);
+
   carla::geom::GeoLocation CurrentGeoReference;
 
+  int32 SamplesPerTick = 1;
+
+  /// State at the previous tick, to interpolate the samples of this tick
+  FSensorKinematicState PrevState;
+
+  bool bHasPrevState = false;
+
   float LatitudeDeviation;
   float LongitudeDeviation;
   float AltitudeDeviation;
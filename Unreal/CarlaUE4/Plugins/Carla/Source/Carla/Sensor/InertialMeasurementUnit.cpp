@@ -165,9 +165,14 @@ carla::geom::Vector3D AInertialMeasurementUnit::ComputeGyroscope()
 }
 
 float AInertialMeasurementUnit::ComputeCompass()
+{
+  return ComputeCompass(GetActorForwardVector());
+}
+
+float AInertialMeasurementUnit::ComputeCompass(const FVector &ForwardVector)
 {
   // Magnetometer: orientation with respect to the North in rad
-  const FVector ForwVect = GetActorForwardVector().GetSafeNormal2D();
+  const FVector ForwVect = ForwardVector.GetSafeNormal2D();
   const float DotProd = FVector::DotProduct(CarlaNorthVector, ForwVect);
 
   // We check if the dot product is higher than 1.0 due to numerical error
@@ -182,11 +187,90 @@ float AInertialMeasurementUnit::ComputeCompass()
   return Compass;
 }
 
+FSensorKinematicState AInertialMeasurementUnit::GetKinematicState()
+{
+  FSensorKinematicState State;
+  State.Location = GetActorLocation();
+  State.Rotation = GetRootComponent()->GetComponentTransform().GetRotation();
+  State.Velocity = FSubTickInterpolation::GetVelocityAtLocation(GetOwner(), State.Location);
+  if (GetOwner() != nullptr)
+  {
+    State.AngularVelocity = FIMU_GetActorAngularVelocityInRadians(*GetOwner());
+  }
+  return State;
+}
+
+std::vector<carla::sensor::s11n::IMUSerializer::Sample> AInertialMeasurementUnit::ComputeSubTickSamples(
+    const FSensorKinematicState &Start,
+    const FSensorKinematicState &End,
+    const float DeltaTime)
+{
+  // Used to convert from UE4's cm to meters
+  constexpr float TO_METERS = 1e-2;
+  // Gravity set by gamemode
+  const float GRAVITY = UCarlaStatics::GetGameMode(GetWorld())->IMUISensorGravity;
+
+  const FQuat SensorLocalRotation =
+      RootComponent->GetRelativeTransform().GetRotation();
+
+  std::vector<carla::sensor::s11n::IMUSerializer::Sample> Samples;
+  Samples.reserve(SamplesPerTick);
+  for (int32 i = 1; i <= SamplesPerTick; ++i)
+  {
+    const float Alpha = static_cast<float>(i) / static_cast<float>(SamplesPerTick);
+    const FQuat Rotation = FQuat::Slerp(Start.Rotation, End.Rotation, Alpha);
+
+    FVector Acceleration = TO_METERS * FSubTickInterpolation::GetAcceleration(Start, End, DeltaTime, Alpha);
+    Acceleration.Z += GRAVITY;
+    Acceleration = Rotation.UnrotateVector(Acceleration);
+
+    const FVector AngularVelocity = FMath::Lerp(Start.AngularVelocity, End.AngularVelocity, Alpha);
+
+    Samples.push_back(carla::sensor::s11n::IMUSerializer::Sample{
+        (Alpha - 1.0f) * DeltaTime,
+        ComputeAccelerometerNoise(Acceleration),
+        ComputeGyroscopeNoise(SensorLocalRotation.RotateVector(AngularVelocity)),
+        ComputeCompass(Rotation.GetForwardVector())});
+  }
+  return Samples;
+}
+
 void AInertialMeasurementUnit::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
-  carla::geom::Vector3D Accelerometer = ComputeAccelerometer(DeltaTime);
-  carla::geom::Vector3D Gyroscope = ComputeGyroscope();
-  float Compass = ComputeCompass();
+  carla::geom::Vector3D Accelerometer;
+  carla::geom::Vector3D Gyroscope;
+  float Compass;
+
+  std::vector<carla::sensor::s11n::IMUSerializer::Sample> Samples;
+  if (SamplesPerTick > 1)
+  {
+    const FSensorKinematicState CurrentState = GetKinematicState();
+    if (bHasPrevState && DeltaTime > 0.0f)
+    {
+      Samples = ComputeSubTickSamples(PrevState, CurrentState, DeltaTime);
+    }
+    PrevState = CurrentState;
+    bHasPrevState = true;
+  }
+
+  if (!Samples.empty())
+  {
+    // The measurement itself is the last sample
+    Accelerometer = Samples.back().accelerometer;
+    Gyroscope = Samples.back().gyroscope;
+    Compass = Samples.back().compass;
+
+    // Keep the history of the single sample accelerometer up to date
+    PrevLocation[0] = PrevLocation[1];
+    PrevLocation[1] = GetActorLocation();
+    PrevDeltaTime = DeltaTime;
+  }
+  else
+  {
+    Accelerometer = ComputeAccelerometer(DeltaTime);
+    Gyroscope = ComputeGyroscope();
+    Compass = ComputeCompass();
+  }
 
   auto Stream = GetDataStream(*this);
 
@@ -212,7 +296,14 @@ void AInertialMeasurementUnit::PostPhysTick(UWorld *World, ELevelTick TickType,
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(AInertialMeasurementUnit::PostPhysTick);
-    Stream.SerializeAndSend(*this, Accelerometer, Gyroscope, Compass);
+    if (Samples.empty())
+    {
+      Stream.SerializeAndSend(*this, Accelerometer, Gyroscope, Compass);
+    }
+    else
+    {
+      Stream.SerializeAndSend(*this, Samples);
+    }
   }
 }
 
@@ -246,6 +337,16 @@ const FVector &AInertialMeasurementUnit::GetGyroscopeBias() const
   return BiasGyro;
 }
 
+void AInertialMeasurementUnit::SetSamplesPerTick(const int32 Value)
+{
+  SamplesPerTick = FMath::Max(Value, 1);
+}
+
+int32 AInertialMeasurementUnit::GetSamplesPerTick() const
+{
+  return SamplesPerTick;
+}
+
 void AInertialMeasurementUnit::BeginPlay()
 {
   Super::BeginPlay();
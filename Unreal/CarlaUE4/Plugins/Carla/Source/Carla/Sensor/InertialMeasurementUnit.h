@@ -7,15 +7,18 @@
 #pragma once
 
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Sensor/SubTickInterpolation.h"
 
 #include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Actor/ActorDescription.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/Vector3D.h"
+#include "carla/sensor/s11n/IMUSerializer.h"
 #include <compiler/enable-ue4-macros.h>
 
 #include <array>
+#include <vector>
 
 #include "InertialMeasurementUnit.generated.h"
 
@@ -51,6 +54,15 @@ public:
   /// Magnetometer: orientation with respect to the North in rad
   float ComputeCompass();
 
+  /// Compass of a sensor facing @a ForwardVector
+  static float ComputeCompass(const FVector &ForwardVector);
+
+  /// Number of samples interpolated between two ticks and sent together, 1
+  /// to send only the state at the end of the tick.
+  void SetSamplesPerTick(int32 Value);
+
+  int32 GetSamplesPerTick() const;
+
   void SetAccelerationStandardDeviation(const FVector &Vec);
 
   void SetGyroscopeStandardDeviation(const FVector &Vec);
@@ -85,4 +97,20 @@ private:
   /// Used to compute the acceleration
   float PrevDeltaTime;
 
+  FSensorKinematicState GetKinematicState();
+
+  /// Samples at the end of each of the SamplesPerTick intervals between
+  /// @a Start and @a End.
+  std::vector<carla::sensor::s11n::IMUSerializer::Sample> ComputeSubTickSamples(
+      const FSensorKinematicState &Start,
+      const FSensorKinematicState &End,
+      float DeltaTime);
+
+  int32 SamplesPerTick = 1;
+
+  /// State at the previous tick, to interpolate the samples of this tick
+  FSensorKinematicState PrevState;
+
+  bool bHasPrevState = false;
+
 };
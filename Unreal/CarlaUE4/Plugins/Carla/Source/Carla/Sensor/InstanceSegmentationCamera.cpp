@@ -10,12 +10,35 @@
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 
 #include "Carla/Sensor/PixelReader.h"
+#include "Carla/Util/BoundingBoxCalculator.h"
 
 #include "Components/SceneCaptureComponent2D.h"
+#include "InstanceBoxesPass.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/BufferView.h>
+#include <carla/sensor/data/InstanceBox.h>
+#include <carla/sensor/s11n/ImageConversion.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <compiler/enable-ue4-macros.h>
 
 FActorDefinition AInstanceSegmentationCamera::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("instance_segmentation"));
+  auto Definition = UActorBlueprintFunctionLibrary::MakeCameraDefinition(TEXT("instance_segmentation"));
+
+  // "image" sends the instance image, "boxes" only the boxes of the instances
+  // computed on the GPU, "image_and_boxes" both as two messages per frame.
+  FActorVariation GroundTruth;
+  GroundTruth.Id = TEXT("ground_truth");
+  GroundTruth.Type = EActorAttributeType::String;
+  GroundTruth.RecommendedValues = { TEXT("image"), TEXT("boxes"), TEXT("image_and_boxes") };
+  GroundTruth.bRestrictToRecommended = true;
+  Definition.Variations.Emplace(GroundTruth);
+
+  return Definition;
 }
 
 AInstanceSegmentationCamera::AInstanceSegmentationCamera(
@@ -27,6 +50,25 @@ AInstanceSegmentationCamera::AInstanceSegmentationCamera(
   // World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &AInstanceSegmentationCamera::OnActorSpawned));
 }
 
+void AInstanceSegmentationCamera::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+
+  const FString Value = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "ground_truth",
+      Description.Variations,
+      "image");
+  GroundTruth =
+      Value == TEXT("boxes") ? EGroundTruth::Boxes :
+      Value == TEXT("image_and_boxes") ? EGroundTruth::ImageAndBoxes :
+      EGroundTruth::Image;
+  if (GroundTruth != EGroundTruth::Image && GMaxRHIFeatureLevel < ERHIFeatureLevel::SM5)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Instance boxes need compute shaders, sending the instance images instead"));
+    GroundTruth = EGroundTruth::Image;
+  }
+}
+
 void AInstanceSegmentationCamera::SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture)
 {
   Super::SetUpSceneCaptureComponent(SceneCapture);
@@ -63,6 +105,141 @@ void AInstanceSegmentationCamera::PostPhysTick(UWorld *World, ELevelTick TickTyp
     SceneCapture->ShowOnlyComponents.Emplace(Component);
   }
 
-  FPixelReader::SendPixelsInRenderThread<AInstanceSegmentationCamera, FColor>(*this);
+  if (GroundTruth != EGroundTruth::Boxes)
+  {
+    FPixelReader::SendPixelsInRenderThread<AInstanceSegmentationCamera, FColor>(*this);
+  }
+  if (GroundTruth != EGroundTruth::Image)
+  {
+    SendInstanceBoxes();
+  }
+}
+
+/// Estimate the occlusion of @a Actor as one minus the area of its visible
+/// box over the area of the projection of its 3D bounding box, clipped to the
+/// image. Returns -1 if the actor has no bounding box or is partly behind the
+/// camera.
+static float EstimateOcclusion(
+    const AActor &Actor,
+    const FTransform &CameraTransform,
+    float FocalLength,
+    float Width,
+    float Height,
+    const carla::sensor::data::InstanceBox &Box)
+{
+  const FBoundingBox BoundingBox = UBoundingBoxCalculator::GetActorBoundingBox(&Actor);
+  if (BoundingBox.Extent.IsNearlyZero())
+  {
+    return -1.0f;
+  }
+  const FTransform &ActorTransform = Actor.GetActorTransform();
+  FBox2D Projected(ForceInit);
+  for (int32 Corner = 0; Corner < 8; ++Corner)
+  {
+    const FVector Sign(
+        (Corner & 1) ? 1.0f : -1.0f,
+        (Corner & 2) ? 1.0f : -1.0f,
+        (Corner & 4) ? 1.0f : -1.0f);
+    const FVector Local = BoundingBox.Origin + BoundingBox.Rotation.RotateVector(BoundingBox.Extent * Sign);
+    // Camera space: x forward, y right, z up.
+    const FVector Point = CameraTransform.InverseTransformPosition(ActorTransform.TransformPosition(Local));
+    if (Point.X < KINDA_SMALL_NUMBER)
+    {
+      return -1.0f;
+    }
+    Projected += FVector2D(
+        0.5f * Width + FocalLength * Point.Y / Point.X,
+        0.5f * Height - FocalLength * Point.Z / Point.X);
+  }
+  const float MinX = FMath::Clamp(Projected.Min.X, 0.0f, Width);
+  const float MinY = FMath::Clamp(Projected.Min.Y, 0.0f, Height);
+  const float MaxX = FMath::Clamp(Projected.Max.X, 0.0f, Width);
+  const float MaxY = FMath::Clamp(Projected.Max.Y, 0.0f, Height);
+  const float ProjectedArea = (MaxX - MinX) * (MaxY - MinY);
+  if (ProjectedArea <= 0.0f)
+  {
+    return -1.0f;
+  }
+  return FMath::Clamp(1.0f - static_cast<float>(Box.GetBoxArea()) / ProjectedArea, 0.0f, 1.0f);
+}
+
+void AInstanceSegmentationCamera::SendInstanceBoxes()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AInstanceSegmentationCamera::SendInstanceBoxes);
+  if (!BoxesPass)
+  {
+    BoxesPass = std::make_shared<FInstanceBoxesPass>();
+  }
+
+  TArray<FInstanceBoxRecord> Records;
+  auto Pass = BoxesPass;
+  auto *Resource = static_cast<const FTextureRenderTarget2DResource *>(CaptureRenderTarget->Resource);
+  ENQUEUE_RENDER_COMMAND(InstanceBoxesReduction)(
+    [Pass, Resource, &Records](FRHICommandListImmediate &RHICmdList)
+    {
+      FTexture2DRHIRef Texture = Resource != nullptr ? Resource->GetRenderTargetTexture() : nullptr;
+      if (Texture)
+      {
+        Pass->Execute(RHICmdList, Texture, Records);
+      }
+    });
+  // The readback is synchronous, wait for the render thread to write the
+  // records.
+  FlushRenderingCommands();
+
+  // The order in which the GPU appends the records is not deterministic.
+  Records.Sort([](const FInstanceBoxRecord &A, const FInstanceBoxRecord &B) {
+    return A.GetInstanceId() < B.GetInstanceId();
+  });
+
+  // Instances are encoded with the lower 16 bits of the unique id of their
+  // actor, see ATagger::GetActorLabelColor.
+  TMap<uint16, const FCarlaActor *> Actors;
+  for (const auto &Pair : GetEpisode().GetActorRegistry())
+  {
+    const FCarlaActor *View = Pair.Value.Get();
+    const AActor *Actor = View != nullptr ? View->GetActor() : nullptr;
+    if (Actor != nullptr)
+    {
+      Actors.Add(static_cast<uint16>(Actor->GetUniqueID() & 0xFFFFu), View);
+    }
+  }
+
+  const float Width = GetImageWidth();
+  const float Height = GetImageHeight();
+  const float FocalLength = 0.5f * Width / FMath::Tan(FMath::DegreesToRadians(0.5f * GetFOVAngle()));
+  const FTransform CameraTransform = GetCaptureComponent2D()->GetComponentTransform();
+
+  using carla::sensor::data::InstanceBox;
+  using carla::sensor::s11n::ImageSerializer;
+  auto Stream = GetDataStream(*this);
+  carla::Buffer Buffer = Stream.PopBufferFromPool();
+  Buffer.reset(ImageSerializer::header_offset + sizeof(InstanceBox) * Records.Num());
+  const ImageSerializer::ImageHeader Header = { GetImageWidth(), GetImageHeight(), GetFOVAngle() };
+  std::memcpy(Buffer.data(), &Header, sizeof(Header));
+
+  unsigned char *Out = Buffer.data() + ImageSerializer::header_offset;
+  for (const FInstanceBoxRecord &Record : Records)
+  {
+    InstanceBox Box;
+    Box.instance_id = Record.GetInstanceId();
+    Box.semantic_tag = Record.GetSemanticTag();
+    Box.pixel_count = Record.PixelCount;
+    Box.x_min = static_cast<uint16_t>(Record.Min & 0xFFFFu);
+    Box.y_min = static_cast<uint16_t>(Record.Min >> 16u);
+    Box.x_max = static_cast<uint16_t>(Record.Max & 0xFFFFu);
+    Box.y_max = static_cast<uint16_t>(Record.Max >> 16u);
+    if (const FCarlaActor *const *View = Actors.Find(Box.instance_id))
+    {
+      Box.actor_id = (*View)->GetActorId();
+      Box.occlusion = EstimateOcclusion(*(*View)->GetActor(), CameraTransform, FocalLength, Width, Height, Box);
+    }
+    std::memcpy(Out, &Box, sizeof(Box));
+    Out += sizeof(Box);
+  }
 
+  Stream.SetPayloadFormat(static_cast<uint8_t>(carla::sensor::s11n::ImageFormat::InstanceBoxes));
+  carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(Buffer));
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("Instance boxes Stream Send");
+  Stream.Send(*this, BufView);
 }
@@ -10,8 +10,12 @@
 
 #include "Carla/Actor/ActorDefinition.h"
 
+#include <memory>
+
 #include "InstanceSegmentationCamera.generated.h"
 
+class FInstanceBoxesPass;
+
 /// Sensor that produces "Instance segmentation" images.
 UCLASS()
 class CARLA_API AInstanceSegmentationCamera : public AShaderBasedSensor
@@ -24,8 +28,33 @@ public:
 
   AInstanceSegmentationCamera(const FObjectInitializer &ObjectInitializer);
 
+  void Set(const FActorDescription &ActorDescription) override;
+
 protected:
 
   void SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture) override;
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+  bool SupportsImageFormat(carla::sensor::s11n::ImageFormat Format) const override
+  {
+    return Format == carla::sensor::s11n::ImageFormat::BGRA8;
+  }
+
+private:
+
+  /// What is sent every frame, see the "ground_truth" attribute.
+  enum class EGroundTruth : uint8
+  {
+    Image,
+    Boxes,
+    ImageAndBoxes
+  };
+
+  /// Reduce the instance image on the GPU and send the boxes of the instances
+  /// as carla::sensor::data::InstanceBoxes.
+  void SendInstanceBoxes();
+
+  EGroundTruth GroundTruth = EGroundTruth::Image;
+
+  std::shared_ptr<FInstanceBoxesPass> BoxesPass;
 };
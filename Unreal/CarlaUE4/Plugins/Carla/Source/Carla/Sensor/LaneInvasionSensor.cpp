@@ -6,14 +6,127 @@
 #include "Carla.h"
 #include "Carla/Sensor/LaneInvasionSensor.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/CarlaGameModeBase.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/road/Map.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <limits>
+#include <vector>
 
 FActorDefinition ALaneInvasionSensor::GetSensorDefinition()
 {
-  return UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(TEXT("other"), TEXT("lane_invasion"));
+  auto Definition = UActorBlueprintFunctionLibrary::MakeGenericSensorDefinition(TEXT("other"), TEXT("lane_invasion"));
+
+  FActorVariation ServerSide;
+  ServerSide.Id = TEXT("server_side");
+  ServerSide.Type = EActorAttributeType::Bool;
+  ServerSide.RecommendedValues = { TEXT("false") };
+  ServerSide.bRestrictToRecommended = false;
+  Definition.Variations.Add(ServerSide);
+
+  return Definition;
 }
 
 ALaneInvasionSensor::ALaneInvasionSensor(const FObjectInitializer &ObjectInitializer)
   : Super(ObjectInitializer)
 {
-  PrimaryActorTick.bCanEverTick = false;
+  // Only ticks when a client listens, which never happens for the client
+  // side implementation.
+  PrimaryActorTick.bCanEverTick = true;
+}
+
+void ALaneInvasionSensor::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  bServerSide = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToBool(
+      "server_side",
+      Description.Variations,
+      bServerSide);
+}
+
+bool ALaneInvasionSensor::GetParentCorners(std::array<carla::geom::Location, 4u> &Corners) const
+{
+  const ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(GetOwner());
+  if (Vehicle == nullptr)
+  {
+    return false;
+  }
+  const FTransform BoxTransform = Vehicle->GetVehicleBoundingBoxTransform();
+  const FVector Extent = Vehicle->GetVehicleBoundingBoxExtent();
+  // Same corners as the client side sensor: only the yaw of the vehicle is
+  // taken into account.
+  const FTransform VehicleTransform(
+      FRotator(0.0f, Vehicle->GetActorRotation().Yaw, 0.0f),
+      Vehicle->GetActorLocation());
+  const FVector Center = BoxTransform.GetLocation();
+  const FVector Offsets[4u] = {
+      { Extent.X,  Extent.Y, 0.0f},
+      {-Extent.X,  Extent.Y, 0.0f},
+      { Extent.X, -Extent.Y, 0.0f},
+      {-Extent.X, -Extent.Y, 0.0f}};
+  for (auto i = 0u; i < 4u; ++i)
+  {
+    Corners[i] = carla::geom::Location(VehicleTransform.TransformPosition(Center + Offsets[i]));
+  }
+  return true;
+}
+
+void ALaneInvasionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ALaneInvasionSensor::PostPhysTick);
+  if (!bServerSide)
+  {
+    return;
+  }
+  ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(World);
+  if (GameMode == nullptr || !GameMode->GetMap())
+  {
+    return;
+  }
+  std::array<carla::geom::Location, 4u> Corners;
+  if (!GetParentCorners(Corners))
+  {
+    return;
+  }
+  if (!bHasPreviousCorners)
+  {
+    PreviousCorners = Corners;
+    bHasPreviousCorners = true;
+    return;
+  }
+
+  constexpr float DistanceThreshold = 10.0f * std::numeric_limits<float>::epsilon();
+  for (auto i = 0u; i < 4u; ++i)
+  {
+    if ((Corners[i] - PreviousCorners[i]).Length() < DistanceThreshold)
+    {
+      return;
+    }
+  }
+
+  const carla::road::Map &Map = *GameMode->GetMap();
+  std::vector<carla::road::element::LaneMarking> CrossedLanes;
+  for (auto i = 0u; i < 4u; ++i)
+  {
+    const auto Lanes = Map.CalculateCrossedLanes(PreviousCorners[i], Corners[i]);
+    CrossedLanes.insert(CrossedLanes.end(), Lanes.begin(), Lanes.end());
+  }
+  PreviousCorners = Corners;
+
+  if (CrossedLanes.empty() || !IsStreamReady())
+  {
+    return;
+  }
+  const FCarlaActor *Parent = GetEpisode().FindCarlaActor(GetOwner());
+  if (Parent == nullptr)
+  {
+    return;
+  }
+  auto DataStream = GetDataStream(*this);
+  DataStream.SerializeAndSend(*this, Parent->GetActorId(), CrossedLanes);
 }
@@ -9,10 +9,18 @@
 
 #include "Carla/Actor/ActorDefinition.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Location.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <array>
+
 #include "LaneInvasionSensor.generated.h"
 
 /// LaneInvasion sensor representation
-/// The actual position calculation is done one client side
+/// By default the actual position calculation is done on client side. With
+/// the "server_side" attribute set, the crossed lanes are calculated here
+/// with the server's map after physics and only the events are streamed.
 UCLASS()
 class CARLA_API ALaneInvasionSensor : public ASensor
 {
@@ -23,4 +31,19 @@ public:
   static FActorDefinition GetSensorDefinition();
 
   ALaneInvasionSensor(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &Description) override;
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+private:
+
+  /// Bounding box corners of the parent vehicle on the ground plane.
+  bool GetParentCorners(std::array<carla::geom::Location, 4u> &Corners) const;
+
+  bool bServerSide = false;
+
+  bool bHasPreviousCorners = false;
+
+  std::array<carla::geom::Location, 4u> PreviousCorners;
 };
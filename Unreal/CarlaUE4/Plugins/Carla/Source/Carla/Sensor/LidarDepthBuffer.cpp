@@ -0,0 +1,143 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/LidarDepthBuffer.h"
+
+// Neighbouring pixels further apart than this fraction of the hit distance
+// belong to different surfaces and are not used to estimate the normal.
+static constexpr float DEPTH_DISCONTINUITY = 0.1f;
+
+// Smallest elevation that reaches the top or bottom face of the cubemap,
+// atan(1 / sqrt(2)) in degrees.
+static constexpr float POLAR_FACE_MIN_ELEVATION = 35.2643897f;
+
+FRotator FLidarDepthBuffer::GetFaceRotation(const int32 Face)
+{
+  switch (Face)
+  {
+    case 0: return FRotator(0.0f, 0.0f, 0.0f);
+    case 1: return FRotator(0.0f, 90.0f, 0.0f);
+    case 2: return FRotator(0.0f, 180.0f, 0.0f);
+    case 3: return FRotator(0.0f, -90.0f, 0.0f);
+    case 4: return FRotator(90.0f, 0.0f, 0.0f);
+    default: return FRotator(-90.0f, 0.0f, 0.0f);
+  }
+}
+
+bool FLidarDepthBuffer::IsFaceRequired(const int32 Face, const float UpperFovLimit, const float LowerFovLimit)
+{
+  switch (Face)
+  {
+    case 4: return UpperFovLimit > POLAR_FACE_MIN_ELEVATION;
+    case 5: return LowerFovLimit < -POLAR_FACE_MIN_ELEVATION;
+    default: return LowerFovLimit < 45.0f && UpperFovLimit > -45.0f;
+  }
+}
+
+int32 FLidarDepthBuffer::ComputeResolution(const float AngularStep)
+{
+  // A pixel at the center of a face spans 2 / Resolution radians.
+  const float Step = FMath::Max(FMath::DegreesToRadians(AngularStep), 1e-4f);
+  const uint32 Pixels = static_cast<uint32>(FMath::CeilToInt(2.0f / Step));
+  return FMath::Clamp(static_cast<int32>(FMath::RoundUpToPowerOfTwo(Pixels)), 64, 2048);
+}
+
+void FLidarDepthBuffer::Reset(const int32 InResolution)
+{
+  Resolution = InResolution;
+  for (auto &Face : Depth)
+  {
+    Face.Init(0.0f, Resolution * Resolution);
+  }
+}
+
+int32 FLidarDepthBuffer::SelectFace(const FVector &Direction)
+{
+  const FVector Abs = Direction.GetAbs();
+  if (Abs.X >= Abs.Y && Abs.X >= Abs.Z)
+  {
+    return Direction.X > 0.0f ? 0 : 2;
+  }
+  if (Abs.Y >= Abs.Z)
+  {
+    return Direction.Y > 0.0f ? 1 : 3;
+  }
+  return Direction.Z > 0.0f ? 4 : 5;
+}
+
+const FQuat &FLidarDepthBuffer::GetFaceQuat(const int32 Face)
+{
+  static const FQuat FaceQuats[NumberOfFaces] = {
+    GetFaceRotation(0).Quaternion(),
+    GetFaceRotation(1).Quaternion(),
+    GetFaceRotation(2).Quaternion(),
+    GetFaceRotation(3).Quaternion(),
+    GetFaceRotation(4).Quaternion(),
+    GetFaceRotation(5).Quaternion()};
+  return FaceQuats[Face];
+}
+
+FVector FLidarDepthBuffer::GetPixelPoint(const int32 Face, const int32 X, const int32 Y) const
+{
+  const float PlanarDepth = Depth[Face][Y * Resolution + X];
+  const float NdcX = 2.0f * (X + 0.5f) / Resolution - 1.0f;
+  const float NdcY = 1.0f - 2.0f * (Y + 0.5f) / Resolution;
+  return FVector(PlanarDepth, PlanarDepth * NdcX, PlanarDepth * NdcY);
+}
+
+bool FLidarDepthBuffer::Trace(
+    const FVector &Direction,
+    const float Range,
+    float &OutDistance,
+    FVector &OutNormal) const
+{
+  const int32 Face = SelectFace(Direction);
+  if (Resolution <= 1 || Depth[Face].Num() != Resolution * Resolution)
+  {
+    return false;
+  }
+
+  // Project the direction onto the image plane of the face: +Y points to the
+  // right of the image and +Z to the top.
+  const FQuat &Rotation = GetFaceQuat(Face);
+  const FVector Local = Rotation.UnrotateVector(Direction);
+  if (Local.X <= KINDA_SMALL_NUMBER)
+  {
+    return false;
+  }
+  const int32 X = FMath::Clamp(
+      FMath::FloorToInt((0.5f + 0.5f * Local.Y / Local.X) * Resolution), 0, Resolution - 1);
+  const int32 Y = FMath::Clamp(
+      FMath::FloorToInt((0.5f - 0.5f * Local.Z / Local.X) * Resolution), 0, Resolution - 1);
+
+  // The sky and anything beyond the far plane have a depth larger than the
+  // range of the lidar.
+  const FVector Point = GetPixelPoint(Face, X, Y);
+  const float Distance = Point.X / Local.X;
+  if (!(Distance > 0.0f && Distance <= Range))
+  {
+    return false;
+  }
+  OutDistance = Distance;
+
+  const int32 NeighbourX = X + 1 < Resolution ? X + 1 : X - 1;
+  const int32 NeighbourY = Y + 1 < Resolution ? Y + 1 : Y - 1;
+  const FVector EdgeX = GetPixelPoint(Face, NeighbourX, Y) - Point;
+  const FVector EdgeY = GetPixelPoint(Face, X, NeighbourY) - Point;
+  const float MaxEdgeSquared = FMath::Square(DEPTH_DISCONTINUITY * Distance);
+  FVector Normal = -Local;
+  if (EdgeX.SizeSquared() < MaxEdgeSquared && EdgeY.SizeSquared() < MaxEdgeSquared)
+  {
+    const FVector Cross = FVector::CrossProduct(EdgeX, EdgeY).GetSafeNormal();
+    if (!Cross.IsZero())
+    {
+      Normal = FVector::DotProduct(Cross, Local) > 0.0f ? -Cross : Cross;
+    }
+  }
+  OutNormal = Rotation.RotateVector(Normal);
+  return true;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Depth cubemap rendered around a lidar, used by ELidarBackend::DepthBuffer
+/// to find where each laser hits without tracing it against the physics scene.
+///
+/// Every face is a square 90 degree perspective capture of SCS_SceneDepth, so
+/// each pixel stores the distance along the axis of its face, in centimeters.
+/// Directions and normals are expressed in the local frame of the lidar.
+class FLidarDepthBuffer
+{
+public:
+
+  static constexpr int32 NumberOfFaces = 6;
+
+  /// Rotation of the capture of @a Face relative to the lidar. The faces
+  /// look along +X, +Y, -X, -Y, +Z and -Z in this order.
+  static FRotator GetFaceRotation(int32 Face);
+
+  /// Whether a laser between @a LowerFovLimit and @a UpperFovLimit degrees
+  /// can hit @a Face.
+  static bool IsFaceRequired(int32 Face, float UpperFovLimit, float LowerFovLimit);
+
+  /// Resolution of a face whose pixels are not wider than @a AngularStep
+  /// degrees, which is the smallest angle between two lasers.
+  static int32 ComputeResolution(float AngularStep);
+
+  /// Resize every face to @a InResolution x @a InResolution pixels.
+  void Reset(int32 InResolution);
+
+  int32 GetResolution() const
+  {
+    return Resolution;
+  }
+
+  /// Depth of the pixels of @a Face in row-major order.
+  TArray<float> &GetFaceDepth(int32 Face)
+  {
+    return Depth[Face];
+  }
+
+  /// Intersect the laser with unit direction @a Direction with the depth
+  /// cubemap. Returns false if nothing is hit within @a Range, otherwise the
+  /// distance to the hit and the surface normal estimated from the
+  /// neighbouring pixels.
+  bool Trace(const FVector &Direction, float Range, float &OutDistance, FVector &OutNormal) const;
+
+private:
+
+  static int32 SelectFace(const FVector &Direction);
+
+  static const FQuat &GetFaceQuat(int32 Face);
+
+  /// Point seen by the center of pixel (@a X, @a Y) in the frame of @a Face.
+  FVector GetPixelPoint(int32 Face, int32 X, int32 Y) const;
+
+  int32 Resolution = 0;
+
+  TArray<float> Depth[NumberOfFaces];
+};
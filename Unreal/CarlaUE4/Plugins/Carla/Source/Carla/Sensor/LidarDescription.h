@@ -10,6 +10,16 @@
 
 #include "LidarDescription.generated.h"
 
+/// 计算激光命中点的方式
+UENUM()
+enum class ELidarBackend : uint8
+{
+  /// 在 CPU 上对物理场景逐条发射射线
+  RayCast,
+  /// 在 GPU 上渲染传感器周围的深度立方体贴图，对每条射线重投影得到命中点
+  DepthBuffer
+};
+
 USTRUCT()
 struct CARLA_API FLidarDescription
 {
@@ -69,4 +79,16 @@ struct CARLA_API FLidarDescription
 
   UPROPERTY(EditAnywhere)
   float NoiseStdDev = 0.0f;
+
+  /// 计算命中点的方式。
+  UPROPERTY(EditAnywhere)
+  ELidarBackend Backend = ELidarBackend::RayCast;
+
+  /// 是否按列（X、Y、Z、强度和语义标签各一列）发送点，而不是 {X, Y, Z, I} 数组。
+  UPROPERTY(EditAnywhere)
+  bool bColumnLayout = false;
+
+  /// 序列化之前体素降采样的体素边长，单位：米，0 表示不降采样。
+  UPROPERTY(EditAnywhere)
+  float VoxelSize = 0.0f;
 };
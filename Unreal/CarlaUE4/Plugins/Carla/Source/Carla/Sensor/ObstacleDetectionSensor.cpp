@@ -54,15 +54,11 @@ void AObstacleDetectionSensor::Set(const FActorDescription &Description)
 #endif
 }
 
-void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+void AObstacleDetectionSensor::SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaTime)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::PostPhysTick);
+  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::SubmitTraces);
   const FVector &Start = GetActorLocation();
   const FVector &End = Start + (GetActorForwardVector() * Distance);
-  UWorld* CurrentWorld = GetWorld();
-
-  // Struct in which the result of the scan will be saved
-  FHitResult HitOut = FHitResult();
 
   // Initialization of Query Parameters
   FCollisionQueryParams TraceParams(FName(TEXT("ObstacleDetection Trace")), true, this);
@@ -73,7 +69,7 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if (bDebugLineTrace)
   {
     const FName TraceTag("ObstacleDebugTrace");
-    CurrentWorld->DebugDrawTraceTag = TraceTag;
+    GetWorld()->DebugDrawTraceTag = TraceTag;
     TraceParams.TraceTag = TraceTag;
   }
 #endif
@@ -92,39 +88,35 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if(Super::GetOwner()!=nullptr)
     TraceParams.AddIgnoredActor(Super::GetOwner());
 
-  bool isHitReturned;
   // Choosing a type of sweep is a workaround until everything get properly
   // organized under correct collision channels and object types.
+  TraceBatch = FSensorTraceBatch(TraceParams, ECC_WorldStatic);
+  TraceBatch.Shape = FCollisionShape::MakeSphere(HitRadius);
   if (bOnlyDynamics)
   {
     // If we go only for dynamics, we check the object type AllDynamicObjects
-    FCollisionObjectQueryParams TraceChannel = FCollisionObjectQueryParams(
+    TraceBatch.ObjectQueryParams = FCollisionObjectQueryParams(
         FCollisionObjectQueryParams::AllDynamicObjects);
-    isHitReturned = CurrentWorld->SweepSingleByObjectType(
-        HitOut,
-        Start,
-        End,
-        FQuat(),
-        TraceChannel,
-        FCollisionShape::MakeSphere(HitRadius),
-        TraceParams);
   }
-  else
+  // Else, if we go for everything, we get everything that interacts with a
+  // Pawn
+  TraceBatch.Add(Start, End);
+  // Obstacle sensors on the same parent share the broadphase of their sweeps
+  AActor *Parent = GetOwner();
+  TraceBatch.SharedQueryGroup = (Parent != nullptr) ? Parent : this;
+  Scheduler.Submit(TraceBatch);
+}
+
+void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::PostPhysTick);
+  if (!TraceBatch.HasHits() || TraceBatch.Num() == 0)
   {
-    // Else, if we go for everything, we get everything that interacts with a
-    // Pawn
-    ECollisionChannel TraceChannel = ECC_WorldStatic;
-    isHitReturned = CurrentWorld->SweepSingleByChannel(
-        HitOut,
-        Start,
-        End,
-        FQuat(),
-        TraceChannel,
-        FCollisionShape::MakeSphere(HitRadius),
-        TraceParams);
+    return;
   }
 
-  if (isHitReturned)
+  const FHitResult &HitOut = TraceBatch.GetHit(0);
+  if (HitOut.bBlockingHit)
   {
     OnObstacleDetectionEvent(this, HitOut.Actor.Get(), HitOut.Distance, HitOut);
   }
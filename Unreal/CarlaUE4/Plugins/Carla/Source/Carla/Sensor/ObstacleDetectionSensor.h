@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Sensor/SensorTraceScheduler.h"
 #include "Carla/Actor/ActorDefinition.h"
 #include "Carla/Actor/ActorDescription.h"
 #include "ObstacleDetectionSensor.generated.h"
@@ -27,6 +28,8 @@ public:
 
   void Set(const FActorDescription &Description) override;
 
+  virtual void SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaSeconds) override;
+
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
 
 private:
@@ -47,4 +50,6 @@ private:
   bool bOnlyDynamics = false;
 
   bool bDebugLineTrace = false;
+
+  FSensorTraceBatch TraceBatch;
 };
@@ -12,28 +12,58 @@
 #include "HighResScreenshot.h"
 #include "Runtime/ImageWriteQueue/Public/ImageWriteQueue.h"
 
+// =============================================================================
+// -- FPixelReadbackQueue ------------------------------------------------------
+// =============================================================================
+
+std::unique_ptr<FRHIGPUTextureReadback> FPixelReadbackQueue::Acquire()
+{
+  check(IsInRenderingThread());
+  {
+    std::lock_guard<std::mutex> Lock(FreeMutex);
+    if (!Free.empty())
+    {
+      auto Readback = std::move(Free.back());
+      Free.pop_back();
+      return Readback;
+    }
+  }
+  return std::make_unique<FRHIGPUTextureReadback>(TEXT("CameraBufferReadback"));
+}
+
+void FPixelReadbackQueue::Release(std::unique_ptr<FRHIGPUTextureReadback> Readback)
+{
+  std::lock_guard<std::mutex> Lock(FreeMutex);
+  // Keep enough staging buffers for the copies in flight plus the ones still
+  // being sent, the rest are released.
+  if (Free.size() < 2u * MaxInFlight)
+  {
+    Free.emplace_back(std::move(Readback));
+  }
+}
+
 // =============================================================================
 // -- FPixelReader -------------------------------------------------------------
 // =============================================================================
 
 void FPixelReader::WritePixelsToBuffer(
-    const UTextureRenderTarget2D &RenderTarget,
+    FTexture2DRHIRef Texture,
     uint32 Offset,
     FRHICommandListImmediate &RHICmdList,
-    FPixelReader::Payload FuncForSending)
+    FPixelReader::Payload FuncForSending,
+    std::shared_ptr<FPixelReadbackQueue> Queue,
+    bool bWaitForGPU)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR("WritePixelsToBuffer");
   check(IsInRenderingThread());
 
-  auto RenderResource =
-      static_cast<const FTextureRenderTarget2DResource *>(RenderTarget.Resource);
-  FTexture2DRHIRef Texture = RenderResource->GetRenderTargetTexture();
   if (!Texture)
   {
     return;
   }
 
-  auto BackBufferReadback = std::make_unique<FRHIGPUTextureReadback>(TEXT("CameraBufferReadback"));
+  check(Queue != nullptr);
+  auto BackBufferReadback = Queue->Acquire();
   FIntPoint BackBufferSize = Texture->GetSizeXY();
   EPixelFormat BackBufferPixelFormat = Texture->GetFormat();
   {
@@ -43,7 +73,14 @@ void FPixelReader::WritePixelsToBuffer(
                                     FResolveRect(0, 0, BackBufferSize.X, BackBufferSize.Y));
   }
 
-  // workaround to force RHI with Vulkan to refresh the fences state in the middle of frame
+  // Too many copies in flight, wait for the GPU to catch up.
+  bWaitForGPU |= Queue->GetInFlight() >= FPixelReadbackQueue::MaxInFlight;
+  Queue->OnCopyEnqueued();
+
+  // Wait for the GPU to finish the copy, this is also a workaround to force
+  // RHI with Vulkan to refresh the fences state in the middle of frame. A
+  // pipelined copy is ready once the GPU reaches it, usually in a later frame.
+  if (bWaitForGPU)
   {
     FRenderQueryRHIRef Query = RHICreateRenderQuery(RQT_AbsoluteTime);
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("create query");
@@ -60,8 +97,16 @@ void FPixelReader::WritePixelsToBuffer(
       TRACE_CPUPROFILER_EVENT_SCOPE_STR("Wait GPU transfer");
       while (!Readback->IsReady())
       {
-        std::this_thread::yield();
+        if (bWaitForGPU)
+        {
+          std::this_thread::yield();
+        }
+        else
+        {
+          FPlatformProcess::SleepNoStats(0.0005f);
+        }
       }
+      Queue->OnCopyFinished();
     }
 
     {
@@ -72,10 +117,22 @@ void FPixelReader::WritePixelsToBuffer(
       void* LockedData = Readback->Lock(Size);
       if (LockedData)
       {
-        FuncForSending(LockedData, Size, Offset, ExpectedRowBytes);
+        // The readback stays locked until the last reference to it is released,
+        // this allows sending the locked memory without copying it.
+        ReadbackHandle LockedReadback = std::shared_ptr<FRHIGPUTextureReadback>(
+            Readback.release(),
+            [Queue](FRHIGPUTextureReadback *Locked)
+            {
+              Locked->Unlock();
+              Queue->Release(std::unique_ptr<FRHIGPUTextureReadback>(Locked));
+            });
+        FuncForSending(LockedData, Size, Offset, ExpectedRowBytes, std::move(LockedReadback));
+      }
+      else
+      {
+        Readback->Unlock();
+        Queue->Release(std::move(Readback));
       }
-      Readback->Unlock();
-      Readback.reset();
     }
   });
 }
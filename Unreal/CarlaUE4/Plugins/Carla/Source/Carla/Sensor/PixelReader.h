@@ -8,6 +8,7 @@
 
 #include "CoreGlobals.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "RHIGPUReadback.h"
 #include "Runtime/ImageWriteQueue/Public/ImagePixelData.h"
 
 #ifdef _WIN32
@@ -17,6 +18,8 @@
 
 #include "Carla/Game/CarlaEngine.h"
 
+#include "ImageConversionPass.h"
+
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Logging.h>
 #include <carla/Buffer.h>
@@ -24,6 +27,61 @@
 #include <carla/sensor/SensorRegistry.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// =============================================================================
+// -- FPixelReadbackQueue ------------------------------------------------------
+// =============================================================================
+
+/// Readbacks of a sensor's render target that are in flight between the GPU
+/// and the CPU, and the staging buffers recycled between frames.
+///
+/// When the readback is pipelined the render thread does not wait for the
+/// GPU, the pixels are sent once the copy has finished, usually one or two
+/// frames later but stamped with the frame they were captured in. At most
+/// MaxInFlight copies are pending, enqueuing another one waits for the GPU.
+class FPixelReadbackQueue
+{
+public:
+
+  static constexpr uint32 MaxInFlight = 3u;
+
+  /// Returns a recycled readback or a new one if none is free.
+  ///
+  /// @pre To be called from render-thread.
+  std::unique_ptr<FRHIGPUTextureReadback> Acquire();
+
+  /// Returns @a Readback to the queue once its memory has been unlocked.
+  /// Thread-safe.
+  void Release(std::unique_ptr<FRHIGPUTextureReadback> Readback);
+
+  uint32 GetInFlight() const
+  {
+    return InFlight;
+  }
+
+  void OnCopyEnqueued()
+  {
+    ++InFlight;
+  }
+
+  void OnCopyFinished()
+  {
+    --InFlight;
+  }
+
+private:
+
+  std::atomic<uint32> InFlight{0u};
+
+  std::mutex FreeMutex;
+
+  std::vector<std::unique_ptr<FRHIGPUTextureReadback>> Free;
+};
+
 // =============================================================================
 // -- FPixelReader -------------------------------------------------------------
 // =============================================================================
@@ -35,7 +93,11 @@ class FPixelReader
 {
 public:
 
-  using Payload = std::function<void(void *, uint32, uint32, uint32)>;
+  /// Keeps the locked readback memory alive, the readback is unlocked once
+  /// the last reference is released.
+  using ReadbackHandle = std::shared_ptr<const void>;
+
+  using Payload = std::function<void(void *, uint32, uint32, uint32, ReadbackHandle)>;
 
   /// Copy the pixels in @a RenderTarget into @a BitMap.
   ///
@@ -69,20 +131,26 @@ public:
   /// ASceneCaptureSensor or compatible.
   ///
   /// Note that the serializer needs to define a "header_offset" that it's
-  /// allocated in front of the buffer.
+  /// allocated in front of the buffer, and a "SerializeHeader" function used
+  /// when the header is sent as a separate buffer and the locked readback
+  /// memory is handed to the socket without being copied.
   ///
   /// @pre To be called from game-thread.
   template <typename TSensor, typename TPixel>
   static void SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat = false, std::function<TArray<TPixel>(void *, uint32)> Conversor = {});
 
-  /// Copy the pixels in @a RenderTarget into @a Buffer.
+  /// Read back the pixels in @a Texture and pass the locked memory to
+  /// @a FuncForSending. If @a bWaitForGPU is false the render thread does not
+  /// wait for the copy, see FPixelReadbackQueue.
   ///
   /// @pre To be called from render-thread.
   static void WritePixelsToBuffer(
-      const UTextureRenderTarget2D &RenderTarget,
+      FTexture2DRHIRef Texture,
       uint32 Offset,
       FRHICommandListImmediate &InRHICmdList,
-      FPixelReader::Payload FuncForSending);
+      FPixelReader::Payload FuncForSending,
+      std::shared_ptr<FPixelReadbackQueue> Queue,
+      bool bWaitForGPU = true);
 
 };
 
@@ -101,15 +169,35 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
     return;
   }
 
+  // Physics-only servers neither render nor read back cameras.
+  if (Sensor.GetEpisode().GetSettings().bPhysicsOnlyMode)
+  {
+    return;
+  }
+
   /// Blocks until the render thread has finished all it's tasks.
   Sensor.EnqueueRenderSceneImmediate();
 
+  // The stream takes the sensor transform and timestamp of this frame, the
+  // pixels may be sent a few frames later if the readback is pipelined.
+  auto StreamOfFrame = std::make_shared<FAsyncDataStream>(Sensor.GetDataStream(Sensor));
+  const bool bWaitForGPU = !Sensor.IsReadbackPipelined();
+
+  // The image may be converted on the GPU before the readback, the format of
+  // the converted pixels is flagged in the header.
+  auto ConversionPass = Sensor.OutputConversionPass;
+  const FImageConversionParameters ConversionParameters = Sensor.OutputConversionParameters;
+  if (ConversionPass)
+  {
+    StreamOfFrame->SetPayloadFormat(static_cast<uint8_t>(Sensor.OutputConversion.format));
+  }
+
   // Enqueue a command in the render-thread that will write the image buffer to
   // the data stream. The stream is created in the capture thus executed in the
   // game-thread.
   ENQUEUE_RENDER_COMMAND(FWritePixels_SendPixelsInRenderThread)
   (
-    [&Sensor, use16BitFormat, Conversor = std::move(Conversor)](auto &InRHICmdList) mutable
+    [&Sensor, use16BitFormat, bWaitForGPU, StreamOfFrame, Queue = Sensor.ReadbackQueue, ConversionPass, ConversionParameters, Conversor = std::move(Conversor)](auto &InRHICmdList) mutable
     {
       TRACE_CPUPROFILER_EVENT_SCOPE_STR("FWritePixels_SendPixelsInRenderThread");
 
@@ -117,7 +205,7 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
       if (!Sensor.IsPendingKill())
       {
         FPixelReader::Payload FuncForSending =
-          [&Sensor, Frame = FCarlaEngine::GetFrameCounter(), Conversor = std::move(Conversor)](void *LockedData, uint32 Size, uint32 Offset, uint32 ExpectedRowBytes)
+          [&Sensor, Frame = FCarlaEngine::GetFrameCounter(), StreamOfFrame, Conversor = std::move(Conversor)](void *LockedData, uint32 Size, uint32 Offset, uint32 ExpectedRowBytes, ReadbackHandle LockedReadback)
           {
             if (Sensor.IsPendingKill()) return;
 
@@ -132,9 +220,8 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
               Size = Converted.Num() * Converted.GetTypeSize();
             }
 
-            auto Stream = Sensor.GetDataStream(Sensor);
+            auto &Stream = *StreamOfFrame;
             Stream.SetFrameNumber(Frame);
-            auto Buffer = Stream.PopBufferFromPool();
 
             uint32 CurrentRowBytes = ExpectedRowBytes;
 
@@ -144,20 +231,48 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
             if (IsD3DPlatform(GMaxRHIShaderPlatform, false))
             {
               CurrentRowBytes = Align(ExpectedRowBytes, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-              if (ExpectedRowBytes != CurrentRowBytes)
+            }
+#endif // _WIN32
+
+            // If the readback memory can be sent as it is, the image header goes
+            // in its own buffer and the locked memory is handed over to the
+            // socket (scatter-gather), the readback is unlocked once the message
+            // has been sent to every session. ROS2 needs a contiguous buffer.
+            bool bSendInPlace = !Conversor && (ExpectedRowBytes == CurrentRowBytes);
+            #if defined(WITH_ROS2)
+            bSendInPlace = bSendInPlace && !carla::ros2::ROS2::GetInstance()->IsEnabled();
+            #endif
+            if (bSendInPlace)
+            {
+              using SerializerType = typename carla::sensor::SensorRegistry::get<TSensor *>::type;
+              auto HeaderView = carla::BufferView::CreateFrom(SerializerType::SerializeHeader(Sensor));
+              auto PixelsView = carla::BufferView::CreateFrom(
+                  reinterpret_cast<const carla::BufferView::value_type *>(LockedData),
+                  Size,
+                  std::move(LockedReadback));
+
+              SCOPE_CYCLE_COUNTER(STAT_CarlaSensorStreamSend);
+              TRACE_CPUPROFILER_EVENT_SCOPE_STR("Stream Send (in place)");
+              Stream.Send(Sensor, HeaderView, PixelsView);
+              return;
+            }
+
+            auto Buffer = Stream.PopBufferFromPool();
+
+#ifdef _WIN32
+            if (ExpectedRowBytes != CurrentRowBytes)
+            {
+              TRACE_CPUPROFILER_EVENT_SCOPE_STR("Buffer Copy (windows, row by row)");
+              Buffer.reset(Offset + Size);
+              auto DstRow = Buffer.begin() + Offset;
+              const uint8 *SrcRow = reinterpret_cast<uint8 *>(LockedData);
+              uint32 i = 0;
+              while (i < Size)
               {
-                TRACE_CPUPROFILER_EVENT_SCOPE_STR("Buffer Copy (windows, row by row)");
-                Buffer.reset(Offset + Size);
-                auto DstRow = Buffer.begin() + Offset;
-                const uint8 *SrcRow = reinterpret_cast<uint8 *>(LockedData);
-                uint32 i = 0;
-                while (i < Size)
-                {
-                  FMemory::Memcpy(DstRow, SrcRow, ExpectedRowBytes);
-                  DstRow += ExpectedRowBytes;
-                  SrcRow += CurrentRowBytes;
-                  i += ExpectedRowBytes;
-                }
+                FMemory::Memcpy(DstRow, SrcRow, ExpectedRowBytes);
+                DstRow += ExpectedRowBytes;
+                SrcRow += CurrentRowBytes;
+                i += ExpectedRowBytes;
               }
             }
 #endif // _WIN32
@@ -185,32 +300,30 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
                 {
                   TRACE_CPUPROFILER_EVENT_SCOPE_STR("ROS2 Send PixelReader");
                   auto StreamId = carla::streaming::detail::token_type(Sensor.GetToken()).get_stream_id();
-                  auto Res = std::async(std::launch::async, [&Sensor, ROS2, &Stream, StreamId, BufView]()
+                  // get resolution of camera
+                  int W = -1, H = -1;
+                  float Fov = -1.0f;
+                  auto WidthOpt = Sensor.GetAttribute("image_size_x");
+                  if (WidthOpt.has_value())
+                    W = FCString::Atoi(*WidthOpt->Value);
+                  auto HeightOpt = Sensor.GetAttribute("image_size_y");
+                  if (HeightOpt.has_value())
+                    H = FCString::Atoi(*HeightOpt->Value);
+                  auto FovOpt = Sensor.GetAttribute("fov");
+                  if (FovOpt.has_value())
+                    Fov = FCString::Atof(*FovOpt->Value);
+                  // send data to ROS2, it only queues the shared view and the
+                  // data is published on the ROS2 publisher threads
+                  AActor* ParentActor = Sensor.GetAttachParentActor();
+                  if (ParentActor)
                   {
-                    // get resolution of camera
-                    int W = -1, H = -1;
-                    float Fov = -1.0f;
-                    auto WidthOpt = Sensor.GetAttribute("image_size_x");
-                    if (WidthOpt.has_value())
-                      W = FCString::Atoi(*WidthOpt->Value);
-                    auto HeightOpt = Sensor.GetAttribute("image_size_y");
-                    if (HeightOpt.has_value())
-                      H = FCString::Atoi(*HeightOpt->Value);
-                    auto FovOpt = Sensor.GetAttribute("fov");
-                    if (FovOpt.has_value())
-                      Fov = FCString::Atof(*FovOpt->Value);
-                    // send data to ROS2
-                    AActor* ParentActor = Sensor.GetAttachParentActor();
-                    if (ParentActor)
-                    {
-                      FTransform LocalTransformRelativeToParent = Sensor.GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
-                      ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, LocalTransformRelativeToParent, W, H, Fov, BufView, &Sensor);
-                    }
-                    else
-                    {
-                      ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, Stream.GetSensorTransform(), W, H, Fov, BufView, &Sensor);
-                    }
-                  });
+                    FTransform LocalTransformRelativeToParent = Sensor.GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
+                    ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, LocalTransformRelativeToParent, W, H, Fov, BufView, &Sensor);
+                  }
+                  else
+                  {
+                    ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, Stream.GetSensorTransform(), W, H, Fov, BufView, &Sensor);
+                  }
                 }
                 #endif
 
@@ -222,11 +335,22 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
             }
           };
 
+          auto RenderResource =
+              static_cast<const FTextureRenderTarget2DResource *>(Sensor.CaptureRenderTarget->Resource);
+          FTexture2DRHIRef Texture = RenderResource->GetRenderTargetTexture();
+          if (Texture && ConversionPass)
+          {
+            TRACE_CPUPROFILER_EVENT_SCOPE_STR("GPU image conversion");
+            Texture = ConversionPass->Execute(InRHICmdList, Texture, ConversionParameters);
+          }
+
           WritePixelsToBuffer(
-              *Sensor.CaptureRenderTarget,
+              Texture,
               carla::sensor::SensorRegistry::get<TSensor *>::type::header_offset,
               InRHICmdList,
-              std::move(FuncForSending));
+              std::move(FuncForSending),
+              std::move(Queue),
+              bWaitForGPU);
         }
       }
     );
@@ -4,19 +4,23 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
-#include <PxScene.h>
-
 #include "Carla.h"
 #include "Carla/Sensor/Radar.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Runtime/Core/Public/Async/ParallelFor.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/Math.h"
 #include "carla/ros2/ROS2.h"
 #include <compiler/enable-ue4-macros.h>
 
+namespace RadarConstants
+{
+  /// Bounds of the size of the ray pattern, it holds one second of rays.
+  constexpr size_t MinPatternSize = 1024u;
+  constexpr size_t MaxPatternSize = 1u << 16u;
+}
+
 FActorDefinition ARadar::GetSensorDefinition()
 {
   return UActorBlueprintFunctionLibrary::MakeRadarDefinition();
@@ -29,9 +33,10 @@ ARadar::ARadar(const FObjectInitializer& ObjectInitializer)
 
   RandomEngine = CreateDefaultSubobject<URandomEngine>(TEXT("RandomEngine"));
 
-  TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
+  FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
   TraceParams.bTraceComplex = true;
   TraceParams.bReturnPhysicalMaterial = false;
+  TraceBatch = FSensorTraceBatch(TraceParams, ECC_GameTraceChannel2);
 
 }
 
@@ -60,6 +65,55 @@ void ARadar::SetPointsPerSecond(int NewPointsPerSecond)
 {
   PointsPerSecond = NewPointsPerSecond;
   RadarData.SetResolution(PointsPerSecond);
+  BuildRayPattern();
+}
+
+void ARadar::SetMaxRaysPerTick(int NewMaxRaysPerTick)
+{
+  MaxRaysPerTick = FMath::Max(NewMaxRaysPerTick, 0);
+  PendingRays = 0.0f;
+}
+
+int ARadar::ScheduleRays(float DeltaTime)
+{
+  PendingRays += PointsPerSecond * DeltaTime;
+  int NumRays = FMath::FloorToInt(PendingRays);
+  if (MaxRaysPerTick > 0)
+  {
+    NumRays = FMath::Min(NumRays, MaxRaysPerTick);
+  }
+  PendingRays -= NumRays;
+  if (MaxRaysPerTick > 0)
+  {
+    // Keep at most one budget of rays for the next ticks, a sustained rate
+    // above the budget would otherwise grow the backlog without bound.
+    PendingRays = FMath::Min(PendingRays, static_cast<float>(MaxRaysPerTick));
+  }
+  return FMath::Max(NumRays, 0);
+}
+
+void ARadar::BuildRayPattern()
+{
+  // Plastic number, see "The Unreasonable Effectiveness of Quasirandom
+  // Sequences" (Roberts).
+  constexpr double G = 1.32471795724474602596;
+  constexpr double A1 = 1.0 / G;
+  constexpr double A2 = 1.0 / (G * G);
+
+  const size_t Size = FMath::Clamp(
+      static_cast<size_t>(FMath::Max(PointsPerSecond, 0)),
+      RadarConstants::MinPatternSize,
+      RadarConstants::MaxPatternSize);
+  RayPattern.resize(Size);
+  for (size_t i = 0u; i < Size; ++i)
+  {
+    const double U = 0.5 + A1 * i - FMath::FloorToDouble(0.5 + A1 * i);
+    const double V = 0.5 + A2 * i - FMath::FloorToDouble(0.5 + A2 * i);
+    auto &Ray = RayPattern[i];
+    Ray.Radius = static_cast<float>(U);
+    FMath::SinCos(&Ray.Sin, &Ray.Cos, static_cast<float>(V * carla::geom::Math::Pi2<double>()));
+  }
+  PatternCursor = 0u;
 }
 
 void ARadar::BeginPlay()
@@ -67,15 +121,25 @@ void ARadar::BeginPlay()
   Super::BeginPlay();
 
   PrevLocation = GetActorLocation();
+  if (RayPattern.empty())
+  {
+    BuildRayPattern();
+  }
 }
 
-void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+void ARadar::SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaTime)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::PostPhysTick);
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::SubmitTraces);
   CalculateCurrentVelocity(DeltaTime);
+  PrepareLineTraces(DeltaTime);
+  Scheduler.Submit(TraceBatch);
+}
 
+void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::PostPhysTick);
   RadarData.Reset();
-  SendLineTraces(DeltaTime);
+  WriteDetections();
 
   auto DataStream = GetDataStream(*this);
 
@@ -112,91 +176,77 @@ void ARadar::CalculateCurrentVelocity(const float DeltaTime)
   PrevLocation = RadarLocation;
 }
 
-void ARadar::SendLineTraces(float DeltaTime)
+void ARadar::PrepareLineTraces(float DeltaTime)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::SendLineTraces);
-  constexpr float TO_METERS = 1e-2;
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::PrepareLineTraces);
   const FTransform& ActorTransform = GetActorTransform();
   const FRotator& TransformRotator = ActorTransform.Rotator();
   const FVector& RadarLocation = GetActorLocation();
-  const FVector& ForwardVector = GetActorForwardVector();
-  const FVector TransformXAxis = ActorTransform.GetUnitAxis(EAxis::X);
-  const FVector TransformYAxis = ActorTransform.GetUnitAxis(EAxis::Y);
-  const FVector TransformZAxis = ActorTransform.GetUnitAxis(EAxis::Z);
 
   // Maximum radar radius in horizontal and vertical direction
   const float MaxRx = FMath::Tan(FMath::DegreesToRadians(HorizontalFOV * 0.5f)) * Range;
   const float MaxRy = FMath::Tan(FMath::DegreesToRadians(VerticalFOV * 0.5f)) * Range;
-  const int NumPoints = (int)(PointsPerSecond * DeltaTime);
-
-  // Generate the parameters of the rays in a deterministic way
-  Rays.clear();
-  Rays.resize(NumPoints);
-  for (int i = 0; i < Rays.size(); i++) {
-    Rays[i].Radius = RandomEngine->GetUniformFloat();
-    Rays[i].Angle = RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>());
-    Rays[i].Hitted = false;
+  const int NumPoints = ScheduleRays(DeltaTime);
+
+  TraceBatch.Reset(NumPoints);
+  RayDirections.clear();
+  TraceLocation = RadarLocation;
+  if (NumPoints == 0 || RayPattern.empty())
+  {
+    return;
   }
 
-  FCriticalSection Mutex;
-  GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
+  // Randomize the pattern in a deterministic way, the same rotation and
+  // radial shift applies to all the rays of this tick.
+  const float RadialShift = RandomEngine->GetUniformFloat();
+  float RotationSin, RotationCos;
+  FMath::SinCos(
+      &RotationSin,
+      &RotationCos,
+      RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>()));
+
+  const size_t PatternSize = RayPattern.size();
+  RayDirections.resize(NumPoints);
+  for (int idx = 0; idx < NumPoints; ++idx) {
+    const FPatternRay &PatternRay = RayPattern[(PatternCursor + idx) % PatternSize];
+    float Radius = PatternRay.Radius + RadialShift;
+    Radius -= (Radius >= 1.0f) ? 1.0f : 0.0f;
+    const float Cos = PatternRay.Cos * RotationCos - PatternRay.Sin * RotationSin;
+    const float Sin = PatternRay.Sin * RotationCos + PatternRay.Cos * RotationSin;
+
+    RayDirections[idx] = {
+      Range,
+      MaxRx * Radius * Cos,
+      MaxRy * Radius * Sin
+    };
+    TraceBatch.Add(RadarLocation, RadarLocation + TransformRotator.RotateVector(RayDirections[idx]));
+  }
+  PatternCursor = (PatternCursor + NumPoints) % PatternSize;
+}
+
+void ARadar::WriteDetections()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::WriteDetections);
+  constexpr float TO_METERS = 1e-2;
+  if (!TraceBatch.HasHits())
   {
-    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
-    ParallelFor(NumPoints, [&](int32 idx) {
-      TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
-      FHitResult OutHit(ForceInit);
-      const float Radius = Rays[idx].Radius;
-      const float Angle  = Rays[idx].Angle;
-
-      float Sin, Cos;
-      FMath::SinCos(&Sin, &Cos, Angle);
-
-      const FVector EndLocation = RadarLocation + TransformRotator.RotateVector({
-        Range,
-        MaxRx * Radius * Cos,
-        MaxRy * Radius * Sin
-      });
-
-      const bool Hitted = GetWorld()->ParallelLineTraceSingleByChannel(
-        OutHit,
-        RadarLocation,
-        EndLocation,
-        ECC_GameTraceChannel2,
-        TraceParams,
-        FCollisionResponseParams::DefaultResponseParam
-      );
-
-      const TWeakObjectPtr<AActor> HittedActor = OutHit.Actor;
-      if (Hitted && HittedActor.Get()) {
-        Rays[idx].Hitted = true;
-
-        Rays[idx].RelativeVelocity = CalculateRelativeVelocity(OutHit, RadarLocation);
-
-        Rays[idx].AzimuthAndElevation = FMath::GetAzimuthAndElevation (
-          (EndLocation - RadarLocation).GetSafeNormal() * Range,
-          TransformXAxis,
-          TransformYAxis,
-          TransformZAxis
-        );
-
-        Rays[idx].Distance = OutHit.Distance * TO_METERS;
-      }
-    });
+    return;
   }
-  GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
-
-  // Write the detections in the output structure
-  for (auto& ray : Rays) {
-    if (ray.Hitted) {
-      RadarData.WriteDetection({
-        ray.RelativeVelocity,
-        ray.AzimuthAndElevation.X,
-        ray.AzimuthAndElevation.Y,
-        ray.Distance
-      });
+
+  for (int32 idx = 0; idx < TraceBatch.Num(); ++idx) {
+    const FHitResult &OutHit = TraceBatch.GetHit(idx);
+    if (!OutHit.bBlockingHit || !OutHit.Actor.IsValid()) {
+      continue;
     }
+    // The direction is already in the frame of the radar.
+    const FVector &LocalDirection = RayDirections[idx];
+    RadarData.WriteDetection({
+      CalculateRelativeVelocity(OutHit, TraceLocation),
+      FMath::Atan2(LocalDirection.Y, LocalDirection.X),
+      FMath::Atan2(LocalDirection.Z, FVector2D(LocalDirection).Size()),
+      OutHit.Distance * TO_METERS
+    });
   }
-
 }
 
 float ARadar::CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation)
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Sensor/SensorTraceScheduler.h"
 
 #include "Carla/Actor/ActorDefinition.h"
 
@@ -44,11 +45,28 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Radar")
   void SetPointsPerSecond(int NewPointsPerSecond);
 
+  /// Limit the number of rays traced in a single tick, 0 means no limit.
+  /// Rays that do not fit in the budget are carried over to the next ticks,
+  /// up to one budget, and dropped beyond that.
+  UFUNCTION(BlueprintCallable, Category = "Radar")
+  void SetMaxRaysPerTick(int NewMaxRaysPerTick);
+
+  float GetTickCostEstimate(float TickSeconds) const override
+  {
+    float Rays = PointsPerSecond * TickSeconds;
+    if (MaxRaysPerTick > 0)
+    {
+      Rays = FMath::Min(Rays, static_cast<float>(MaxRaysPerTick));
+    }
+    return 1.0f + Rays * 1e-3f;
+  }
+
 protected:
 
   void BeginPlay() override;
 
   // virtual void PrePhysTick(float DeltaTime) override;
+  virtual void SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaTime) override;
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
 
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Detection")
@@ -63,31 +81,62 @@ protected:
   UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Detection")
   int PointsPerSecond;
 
+  UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Detection")
+  int MaxRaysPerTick = 0;
+
 private:
 
   void CalculateCurrentVelocity(const float DeltaTime);
 
-  void SendLineTraces(float DeltaTime);
+  /// Add the rays of this tick to TraceBatch.
+  void PrepareLineTraces(float DeltaTime);
+
+  /// Write the hits of TraceBatch to RadarData.
+  void WriteDetections();
 
   float CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation);
 
+  /// Number of rays to trace this tick according to the points per second and
+  /// the ray budget.
+  int ScheduleRays(float DeltaTime);
+
+  /// Fill RayPattern with a stratified sequence of points in the unit disk.
+  void BuildRayPattern();
+
   FRadarData RadarData;
 
-  FCollisionQueryParams TraceParams;
+  /// Rays of the current tick, traced by the trace scheduler of the
+  /// episode.
+  FSensorTraceBatch TraceBatch;
 
   FVector CurrentVelocity;
 
   /// Used to compute the velocity of the radar
   FVector PrevLocation;
 
-  struct RayData {
+  /// Rays not traced yet, including the fraction of a ray left by the
+  /// previous ticks.
+  float PendingRays = 0.0f;
+
+  /// A ray of the pattern. The ray points to (Radius * Cos, Radius * Sin) in
+  /// the unit disk that is scaled to the field of view.
+  struct FPatternRay {
     float Radius;
-    float Angle;
-    bool Hitted;
-    float RelativeVelocity;
-    FVector2D AzimuthAndElevation;
-    float Distance;
+    float Cos;
+    float Sin;
   };
 
-  std::vector<RayData> Rays;
+  /// Rank-1 lattice (R2 sequence), any run of consecutive rays is evenly
+  /// spread over the disk. Each tick reads the next rays from PatternCursor
+  /// and offsets them by a random rotation and radial shift, so the rays are
+  /// still random but no random numbers are drawn per ray.
+  std::vector<FPatternRay> RayPattern;
+
+  size_t PatternCursor = 0u;
+
+  /// Direction of each ray of TraceBatch in the frame of the radar.
+  std::vector<FVector> RayDirections;
+
+  /// Location of the radar when the rays were traced.
+  FVector TraceLocation;
 };
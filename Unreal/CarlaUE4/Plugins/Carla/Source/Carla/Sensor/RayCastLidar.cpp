@@ -46,6 +46,9 @@ void ARayCastLidar::Set(const FLidarDescription &LidarDescription)
 {
   Description = LidarDescription;
   LidarData = FLidarData(Description.Channels);
+  LidarData.SetLayout(Description.bColumnLayout ?
+      carla::sensor::data::LidarPointLayout::SoA :
+      carla::sensor::data::LidarPointLayout::AoS);
   CreateLasers();
   PointsPerChannel.resize(Description.Channels);
 
@@ -65,6 +68,7 @@ void ARayCastLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float Delta
 
   {
     TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
+    DataStream.SetPayloadFormat(static_cast<uint8_t>(LidarData.GetLayout()));
     DataStream.SerializeAndSend(*this, LidarData, DataStream.PopBufferFromPool());
   }
   // ROS2
@@ -155,12 +159,23 @@ ARayCastLidar::FDetection ARayCastLidar::ComputeDetection(const FHitResult& HitI
     for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
       for (auto& hit : RecordedHits[idxChannel]) {
         FDetection Detection = ComputeDetection(hit, SensorTransform);
-        if (PostprocessDetection(Detection))
-          LidarData.WritePointSync(Detection);
-        else
+        if (!PostprocessDetection(Detection))
           PointsPerChannel[idxChannel]--;
+        else if (Description.bColumnLayout)
+        {
+          const UPrimitiveComponent* Component = hit.Component.Get();
+          LidarData.WritePointSync(Detection, Component != nullptr ? static_cast<uint8_t>(Component->CustomDepthStencilValue) : 0u);
+        }
+        else
+          LidarData.WritePointSync(Detection);
       }
     }
 
     LidarData.WriteChannelCount(PointsPerChannel);
+
+    if (Description.VoxelSize > 0.0f)
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("Voxel grid downsampling");
+      LidarData.DownsampleVoxelGrid(Description.VoxelSize);
+    }
   }
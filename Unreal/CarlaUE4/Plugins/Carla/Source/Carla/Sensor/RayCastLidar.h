@@ -47,6 +47,13 @@ private:
 
   void ComputeAndSaveDetections(const FTransform& SensorTransform) override;
 
+  /// Only the location of the hits is used.
+  /// The semantic tags of the column layout come from the hit components.
+  bool RequiresHitComponents() const override
+  {
+    return Description.bColumnLayout;
+  }
+
   FLidarData LidarData;
 
   /// Enable/Disable general dropoff of lidar points
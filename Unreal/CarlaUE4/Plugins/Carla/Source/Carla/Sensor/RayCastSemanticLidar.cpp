@@ -15,13 +15,19 @@
 #include "carla/ros2/ROS2.h"
 #include <compiler/enable-ue4-macros.h>
 
+#include "Components/SceneCaptureComponent2D.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/CollisionProfile.h"
+#include "Engine/TextureRenderTarget2D.h"
 #include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
 #include "Runtime/Core/Public/Async/ParallelFor.h"
 
 namespace crp = carla::rpc;
 
+// The depth buffer is only accurate to about one pixel, the snapping trace
+// covers at least this distance in centimeters around the hit.
+static constexpr float DEPTH_BUFFER_SNAP_TOLERANCE = 10.0f;
+
 FActorDefinition ARayCastSemanticLidar::GetSensorDefinition()
 {
   return UActorBlueprintFunctionLibrary::MakeLidarDefinition(TEXT("ray_cast_semantic"));
@@ -65,6 +71,169 @@ void ARayCastSemanticLidar::CreateLasers()
   }
 }
 
+void ARayCastSemanticLidar::BeginPlay()
+{
+  Super::BeginPlay();
+  if (Description.Backend == ELidarBackend::DepthBuffer)
+  {
+    CreateDepthCaptures();
+  }
+}
+
+void ARayCastSemanticLidar::CreateDepthCaptures()
+{
+  // The pixels must not be wider than the angle between two lasers, both
+  // vertically and along the rotation.
+  const float VerticalStep = Description.Channels > 1u ?
+      (Description.UpperFovLimit - Description.LowerFovLimit) / static_cast<float>(Description.Channels - 1u) :
+      90.0f;
+  const float PointsPerRotation = Description.PointsPerSecond /
+      (static_cast<float>(Description.Channels) * FMath::Max(Description.RotationFrequency, 1e-3f));
+  const float HorizontalStep = Description.HorizontalFov / FMath::Max(PointsPerRotation, 1.0f);
+  const int32 Resolution = FLidarDepthBuffer::ComputeResolution(FMath::Min(VerticalStep, HorizontalStep));
+  DepthBuffer.Reset(Resolution);
+
+  for (int32 Face = 0; Face < FLidarDepthBuffer::NumberOfFaces; ++Face)
+  {
+    if (!FLidarDepthBuffer::IsFaceRequired(Face, Description.UpperFovLimit, Description.LowerFovLimit))
+    {
+      continue;
+    }
+
+    UTextureRenderTarget2D *Target = NewObject<UTextureRenderTarget2D>(this);
+    Target->SRGB = false;
+    Target->bAutoGenerateMips = false;
+    Target->AddressX = TextureAddress::TA_Clamp;
+    Target->AddressY = TextureAddress::TA_Clamp;
+    Target->InitCustomFormat(Resolution, Resolution, PF_R32_FLOAT, true);
+
+    USceneCaptureComponent2D *Capture = NewObject<USceneCaptureComponent2D>(this);
+    Capture->SetupAttachment(RootComponent);
+    Capture->SetRelativeRotation(FLidarDepthBuffer::GetFaceRotation(Face));
+    Capture->FOVAngle = 90.0f;
+    Capture->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
+    Capture->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_RenderScenePrimitives;
+    Capture->bCaptureEveryFrame = false;
+    Capture->bCaptureOnMovement = false;
+    Capture->bAlwaysPersistRenderingState = true;
+    Capture->TextureTarget = Target;
+    Capture->ShowFlags.DisableAdvancedFeatures();
+    Capture->ShowFlags.SetPostProcessing(false);
+    Capture->ShowFlags.SetDynamicShadows(false);
+    Capture->ShowFlags.SetFog(false);
+    Capture->RegisterComponent();
+
+    DepthCaptures.Add(Capture);
+    DepthCaptureFaces.Add(Face);
+  }
+}
+
+void ARayCastSemanticLidar::CaptureDepthBuffer()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::CaptureDepthBuffer);
+  for (USceneCaptureComponent2D *Capture : DepthCaptures)
+  {
+    Capture->CaptureScene();
+  }
+
+  // The first read flushes the rendering commands, so all the faces are
+  // rendered before any of them is copied back.
+  TArray<FLinearColor> Pixels;
+  for (int32 i = 0; i < DepthCaptures.Num(); ++i)
+  {
+    TArray<float> &Depth = DepthBuffer.GetFaceDepth(DepthCaptureFaces[i]);
+    FTextureRenderTargetResource *Resource =
+        DepthCaptures[i]->TextureTarget->GameThread_GetRenderTargetResource();
+    if (Resource == nullptr || !Resource->ReadLinearColorPixels(Pixels) || Pixels.Num() != Depth.Num())
+    {
+      UE_LOG(LogCarla, Warning, TEXT("%s: failed to read the depth buffer."), *GetName());
+      // A depth of zero is never a hit.
+      FMemory::Memzero(Depth.GetData(), Depth.Num() * sizeof(float));
+      continue;
+    }
+    for (int32 Pixel = 0; Pixel < Depth.Num(); ++Pixel)
+    {
+      Depth[Pixel] = Pixels[Pixel].R;
+    }
+  }
+}
+
+void ARayCastSemanticLidar::SimulateDepthBuffer(
+    const uint32 ChannelCount,
+    const uint32 PointsToScanWithOneLaser,
+    const float CurrentHorizontalAngle,
+    const float AngleDistanceOfLaserMeasure)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SimulateDepthBuffer);
+  CaptureDepthBuffer();
+
+  const FTransform ActorTransf = GetTransform();
+  const FVector LidarBodyLoc = ActorTransf.GetLocation();
+  const bool bSnapToGeometry = RequiresHitComponents();
+  const float PixelAngle = 2.0f / static_cast<float>(DepthBuffer.GetResolution());
+
+  if (bSnapToGeometry)
+  {
+    GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
+  }
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+    ParallelFor(ChannelCount, [&](int32 idxChannel) {
+      TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
+
+      FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
+      TraceParams.bTraceComplex = true;
+      TraceParams.bReturnPhysicalMaterial = false;
+
+      for (auto idxPtsOneLaser = 0u; idxPtsOneLaser < PointsToScanWithOneLaser; idxPtsOneLaser++) {
+        if (!RayPreprocessCondition[idxChannel][idxPtsOneLaser]) {
+          continue;
+        }
+        const float VertAngle = LaserAngles[idxChannel];
+        const float HorizAngle = std::fmod(CurrentHorizontalAngle + AngleDistanceOfLaserMeasure
+            * idxPtsOneLaser, Description.HorizontalFov) - Description.HorizontalFov / 2;
+        const FVector LocalDirection = FRotator(VertAngle, HorizAngle, 0.0f).Vector();
+
+        float Distance;
+        FVector LocalNormal;
+        if (!DepthBuffer.Trace(LocalDirection, Description.Range, Distance, LocalNormal)) {
+          continue;
+        }
+        const FVector Direction = ActorTransf.TransformVectorNoScale(LocalDirection);
+        const FVector HitPoint = LidarBodyLoc + Direction * Distance;
+
+        // Semantic detections need the actor and component that was hit, a
+        // trace across the footprint of the pixel finds them.
+        FHitResult HitResult(ForceInit);
+        if (bSnapToGeometry) {
+          const float Tolerance = DEPTH_BUFFER_SNAP_TOLERANCE + Distance * PixelAngle;
+          GetWorld()->ParallelLineTraceSingleByChannel(
+            HitResult,
+            HitPoint - Direction * Tolerance,
+            HitPoint + Direction * Tolerance,
+            ECC_GameTraceChannel2,
+            TraceParams,
+            FCollisionResponseParams::DefaultResponseParam
+          );
+        }
+        if (!HitResult.bBlockingHit) {
+          HitResult.bBlockingHit = true;
+          HitResult.Distance = Distance;
+          HitResult.Location = HitResult.ImpactPoint = HitPoint;
+          HitResult.Normal = HitResult.ImpactNormal = ActorTransf.TransformVectorNoScale(LocalNormal);
+          HitResult.TraceStart = LidarBodyLoc;
+          HitResult.TraceEnd = LidarBodyLoc + Direction * Description.Range;
+        }
+        WritePointAsync(idxChannel, HitResult);
+      }
+    });
+  }
+  if (bSnapToGeometry)
+  {
+    GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
+  }
+}
+
 void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::PostPhysTick);
@@ -97,9 +266,10 @@ void ARayCastSemanticLidar::PostPhysTick(UWorld *World, ELevelTick TickType, flo
   #endif
 }
 
-void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
+bool ARayCastSemanticLidar::BeginScan(const float DeltaTime)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SimulateLidar);
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::BeginScan);
+  Scan.bValid = false;
   const uint32 ChannelCount = Description.Channels;
   const uint32 PointsToScanWithOneLaser =
     FMath::RoundHalfFromZero(
@@ -112,50 +282,116 @@ void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
         Warning,
         TEXT("%s: no points requested this frame, try increasing the number of points per second."),
         *GetName());
-    return;
+    return false;
   }
 
   check(ChannelCount == LaserAngles.Num());
 
-  const float CurrentHorizontalAngle = carla::geom::Math::ToDegrees(
+  Scan.ChannelCount = ChannelCount;
+  Scan.PointsToScanWithOneLaser = PointsToScanWithOneLaser;
+  Scan.CurrentHorizontalAngle = carla::geom::Math::ToDegrees(
       SemanticLidarData.GetHorizontalAngle());
-  const float AngleDistanceOfTick = Description.RotationFrequency * Description.HorizontalFov
+  Scan.AngleDistanceOfTick = Description.RotationFrequency * Description.HorizontalFov
       * DeltaTime;
-  const float AngleDistanceOfLaserMeasure = AngleDistanceOfTick / PointsToScanWithOneLaser;
+  Scan.AngleDistanceOfLaserMeasure = Scan.AngleDistanceOfTick / PointsToScanWithOneLaser;
 
   ResetRecordedHits(ChannelCount, PointsToScanWithOneLaser);
   PreprocessRays(ChannelCount, PointsToScanWithOneLaser);
+  Scan.bValid = true;
+  return true;
+}
+
+void ARayCastSemanticLidar::SubmitTraces(FSensorTraceScheduler &Scheduler, const float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SubmitTraces);
+  TraceBatch.Reset();
+  if (UsesDepthBuffer() || !BeginScan(DeltaTime))
+  {
+    return;
+  }
+
+  const uint32 ChannelCount = Scan.ChannelCount;
+  const uint32 PointsToScanWithOneLaser = Scan.PointsToScanWithOneLaser;
+  const FTransform ActorTransf = GetTransform();
+  const FVector LidarBodyLoc = ActorTransf.GetLocation();
+  const FRotator LidarBodyRot = ActorTransf.Rotator();
+  const float Range = Description.Range;
+
+  FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
+  TraceParams.bTraceComplex = true;
+  TraceParams.bReturnPhysicalMaterial = false;
+  TraceBatch.QueryParams = TraceParams;
+  TraceBatch.Channel = ECC_GameTraceChannel2;
+  TraceBatch.SetNum(ChannelCount * PointsToScanWithOneLaser);
 
-  GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
     ParallelFor(ChannelCount, [&](int32 idxChannel) {
       TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
-
-      FCollisionQueryParams TraceParams = FCollisionQueryParams(FName(TEXT("Laser_Trace")), true, this);
-      TraceParams.bTraceComplex = true;
-      TraceParams.bReturnPhysicalMaterial = false;
-
       for (auto idxPtsOneLaser = 0u; idxPtsOneLaser < PointsToScanWithOneLaser; idxPtsOneLaser++) {
-        FHitResult HitResult;
+        const int32 idxTrace = idxChannel * PointsToScanWithOneLaser + idxPtsOneLaser;
+        if (!RayPreprocessCondition[idxChannel][idxPtsOneLaser]) {
+          TraceBatch.Skip(idxTrace);
+          continue;
+        }
         const float VertAngle = LaserAngles[idxChannel];
-        const float HorizAngle = std::fmod(CurrentHorizontalAngle + AngleDistanceOfLaserMeasure
+        const float HorizAngle = std::fmod(Scan.CurrentHorizontalAngle + Scan.AngleDistanceOfLaserMeasure
             * idxPtsOneLaser, Description.HorizontalFov) - Description.HorizontalFov / 2;
-        const bool PreprocessResult = RayPreprocessCondition[idxChannel][idxPtsOneLaser];
 
-        if (PreprocessResult && ShootLaser(VertAngle, HorizAngle, HitResult, TraceParams)) {
-          WritePointAsync(idxChannel, HitResult);
-        }
-      };
+        // Same direction as ShootLaser.
+        const FRotator ResultRot = UKismetMathLibrary::ComposeRotators(
+          FRotator(VertAngle, HorizAngle, 0),
+          LidarBodyRot
+        );
+        TraceBatch.Set(
+          idxTrace,
+          LidarBodyLoc,
+          Range * UKismetMathLibrary::GetForwardVector(ResultRot) + LidarBodyLoc);
+      }
     });
   }
-  GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
+
+  Scheduler.Submit(TraceBatch);
+}
+
+void ARayCastSemanticLidar::SimulateLidar(const float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARayCastSemanticLidar::SimulateLidar);
+  if (UsesDepthBuffer())
+  {
+    if (!BeginScan(DeltaTime))
+    {
+      return;
+    }
+    SimulateDepthBuffer(
+        Scan.ChannelCount,
+        Scan.PointsToScanWithOneLaser,
+        Scan.CurrentHorizontalAngle,
+        Scan.AngleDistanceOfLaserMeasure);
+  }
+  else
+  {
+    // The scan was started in SubmitTraces.
+    if (!Scan.bValid)
+    {
+      return;
+    }
+    if (TraceBatch.HasHits())
+    {
+      for (int32 idxTrace = 0; idxTrace < TraceBatch.Num(); ++idxTrace) {
+        if (TraceBatch.IsActive(idxTrace) && TraceBatch.GetHit(idxTrace).bBlockingHit) {
+          WritePointAsync(idxTrace / Scan.PointsToScanWithOneLaser, TraceBatch.GetHit(idxTrace));
+        }
+      }
+    }
+  }
+  Scan.bValid = false;
 
   FTransform ActorTransf = GetTransform();
   ComputeAndSaveDetections(ActorTransf);
 
   const float HorizontalAngle = carla::geom::Math::ToRadians(
-      std::fmod(CurrentHorizontalAngle + AngleDistanceOfTick, Description.HorizontalFov));
+      std::fmod(Scan.CurrentHorizontalAngle + Scan.AngleDistanceOfTick, Description.HorizontalFov));
   SemanticLidarData.SetHorizontalAngle(HorizontalAngle);
 }
 
@@ -178,7 +414,7 @@ void ARayCastSemanticLidar::PreprocessRays(uint32_t Channels, uint32_t MaxPoints
   }
 }
 
-void ARayCastSemanticLidar::WritePointAsync(uint32_t channel, FHitResult &detection) {
+void ARayCastSemanticLidar::WritePointAsync(uint32_t channel, const FHitResult &detection) {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   DEBUG_ASSERT(GetChannelCount() > channel);
   RecordedHits[channel].emplace_back(detection);
@@ -189,6 +425,7 @@ void ARayCastSemanticLidar::ComputeAndSaveDetections(const FTransform& SensorTra
   for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
     PointsPerChannel[idxChannel] = RecordedHits[idxChannel].size();
   SemanticLidarData.ResetMemory(PointsPerChannel);
+  HitLabels.Reset();
 
   for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
     for (auto& hit : RecordedHits[idxChannel]) {
@@ -209,22 +446,43 @@ void ARayCastSemanticLidar::ComputeRawDetection(const FHitResult& HitInfo, const
     const FVector VecInc = - (HitPoint - SensorTransf.GetLocation()).GetSafeNormal();
     Detection.cos_inc_angle = FVector::DotProduct(VecInc, HitInfo.ImpactNormal);
 
-    const FActorRegistry &Registry = GetEpisode().GetActorRegistry();
-
-    const AActor* actor = HitInfo.Actor.Get();
-    Detection.object_idx = 0;
-    Detection.object_tag = static_cast<uint32_t>(HitInfo.Component->CustomDepthStencilValue);
-
-    if (actor != nullptr) {
+    const FHitLabel Label = GetHitLabel(HitInfo.Component.Get(), HitInfo.Actor.Get());
+    Detection.object_tag = Label.Tag;
+    Detection.object_idx = Label.ActorId;
+}
 
-      const FCarlaActor* view = Registry.FindCarlaActor(actor);
-      if(view)
-        Detection.object_idx = view->GetActorId();
+ARayCastSemanticLidar::FHitLabel ARayCastSemanticLidar::GetHitLabel(
+    const UPrimitiveComponent *Component,
+    const AActor *Actor) const
+{
+  // Hits of the depth buffer backend that could not be snapped to the
+  // collision geometry have no component, they are not cached.
+  FHitLabel *Cached = Component != nullptr ? HitLabels.Find(Component) : nullptr;
+  if (Cached != nullptr)
+  {
+    return *Cached;
+  }
 
+  FHitLabel Label;
+  Label.Tag = Component != nullptr ? static_cast<uint32>(Component->CustomDepthStencilValue) : 0u;
+  if (Actor != nullptr)
+  {
+    const FCarlaActor *View = GetEpisode().GetActorRegistry().FindCarlaActor(Actor);
+    if (View != nullptr)
+    {
+      Label.ActorId = View->GetActorId();
     }
-    else {
-      UE_LOG(LogCarla, Warning, TEXT("Actor not valid %p!!!!"), actor);
-    }
+  }
+  else if (Component != nullptr)
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Actor not valid %p!!!!"), Actor);
+  }
+
+  if (Component != nullptr)
+  {
+    HitLabels.Add(Component, Label);
+  }
+  return Label;
 }
 
 
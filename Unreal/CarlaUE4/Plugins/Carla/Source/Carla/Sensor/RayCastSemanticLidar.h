@@ -11,7 +11,9 @@
 #include "Carla/Sensor/Sensor.h"
 
 #include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Sensor/LidarDepthBuffer.h"
 #include "Carla/Sensor/LidarDescription.h"
+#include "Carla/Sensor/SensorTraceScheduler.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 
 #include <compiler/disable-ue4-macros.h>
@@ -20,6 +22,9 @@
 
 #include "RayCastSemanticLidar.generated.h"
 
+class USceneCaptureComponent2D;
+class UTextureRenderTarget2D;
+
 /// A ray-cast based Lidar sensor.
 UCLASS()
 class CARLA_API ARayCastSemanticLidar : public ASensor
@@ -39,7 +44,18 @@ public:
   virtual void Set(const FActorDescription &Description) override;
   virtual void Set(const FLidarDescription &LidarDescription);
 
+  virtual float GetTickCostEstimate(float TickSeconds) const override
+  {
+    return 1.0f + Description.PointsPerSecond * TickSeconds * 1e-3f;
+  }
+
 protected:
+  virtual void BeginPlay() override;
+
+  /// Submits the lasers of the ray cast backend to the trace scheduler of
+  /// the episode.
+  virtual void SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaTime) override;
+
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
 
   /// Creates a Laser for each channel.
@@ -48,6 +64,39 @@ protected:
   /// Updates LidarMeasurement with the points read in DeltaTime.
   void SimulateLidar(const float DeltaTime);
 
+  /// Computes the scan of this tick and preprocesses its rays, returns false
+  /// if there are no points to scan.
+  bool BeginScan(float DeltaTime);
+
+  /// Whether the lasers are found in the depth cubemap instead of traced.
+  bool UsesDepthBuffer() const
+  {
+    return Description.Backend == ELidarBackend::DepthBuffer && DepthCaptures.Num() > 0;
+  }
+
+  /// Creates the depth captures used by ELidarBackend::DepthBuffer, one per
+  /// face of the cubemap that the lasers can hit.
+  void CreateDepthCaptures();
+
+  /// Renders the depth cubemap and reads it back into DepthBuffer.
+  void CaptureDepthBuffer();
+
+  /// Finds the hits of the lasers in the depth cubemap instead of tracing
+  /// them against the physics scene.
+  void SimulateDepthBuffer(
+      uint32 ChannelCount,
+      uint32 PointsToScanWithOneLaser,
+      float CurrentHorizontalAngle,
+      float AngleDistanceOfLaserMeasure);
+
+  /// Whether ComputeAndSaveDetections needs the actor and component of each
+  /// hit. If so, the depth buffer hits are snapped to the collision geometry
+  /// with a short trace.
+  virtual bool RequiresHitComponents() const
+  {
+    return true;
+  }
+
   /// Shoot a laser ray-trace, return whether the laser hit something.
   bool ShootLaser(const float VerticalAngle, float HorizontalAngle, FHitResult &HitResult, FCollisionQueryParams& TraceParams) const;
 
@@ -57,8 +106,19 @@ protected:
   /// Compute all raw detection information
   void ComputeRawDetection(const FHitResult &HitInfo, const FTransform &SensorTransf, FSemanticDetection &Detection) const;
 
+  /// Semantic tag and actor id of a hit component.
+  struct FHitLabel
+  {
+    uint32 Tag = 0u;
+    uint32 ActorId = 0u;
+  };
+
+  /// Label of the hit @a Component of @a Actor, looked up in the registry
+  /// only the first time the component is hit in the scan. Not thread-safe.
+  FHitLabel GetHitLabel(const UPrimitiveComponent *Component, const AActor *Actor) const;
+
   /// Saving the hits the raycast returns per channel
-  void WritePointAsync(uint32_t Channel, FHitResult &Detection);
+  void WritePointAsync(uint32_t Channel, const FHitResult &Detection);
 
   /// Clear the recorded data structure
   void ResetRecordedHits(uint32_t Channels, uint32_t MaxPointsPerChannel);
@@ -76,6 +136,35 @@ protected:
   std::vector<std::vector<bool>> RayPreprocessCondition;
   std::vector<uint32_t> PointsPerChannel;
 
+  UPROPERTY()
+  TArray<USceneCaptureComponent2D *> DepthCaptures;
+
+  /// Face of the depth cubemap rendered by each of the DepthCaptures.
+  TArray<int32> DepthCaptureFaces;
+
+  FLidarDepthBuffer DepthBuffer;
+
+  /// Labels of the components hit in the current scan, cleared before each
+  /// scan because the tags and the registered actors may change.
+  mutable TMap<const UPrimitiveComponent *, FHitLabel> HitLabels;
+
+  /// Scan of the current tick, set by BeginScan.
+  struct FLidarScan
+  {
+    bool bValid = false;
+    uint32 ChannelCount = 0u;
+    uint32 PointsToScanWithOneLaser = 0u;
+    float CurrentHorizontalAngle = 0.0f;
+    float AngleDistanceOfTick = 0.0f;
+    float AngleDistanceOfLaserMeasure = 0.0f;
+  };
+
+  FLidarScan Scan;
+
+  /// Lasers of the ray cast backend, trace idxChannel * PointsToScanWithOneLaser
+  /// + idxPtsOneLaser is point idxPtsOneLaser of channel idxChannel.
+  FSensorTraceBatch TraceBatch;
+
 private:
   FSemanticLidarData SemanticLidarData;
 
@@ -34,6 +34,11 @@ protected:
   void BeginPlay() override;
   void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+  bool SupportsImageFormat(carla::sensor::s11n::ImageFormat Format) const override
+  {
+    return Format == carla::sensor::s11n::ImageFormat::BGRA8;
+  }
   
   virtual void OnFirstClientConnected() override;
   virtual void OnLastClientDisconnected() override;
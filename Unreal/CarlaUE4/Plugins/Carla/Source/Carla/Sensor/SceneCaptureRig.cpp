@@ -0,0 +1,290 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SceneCaptureRig.h"
+
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Sensor/SceneCaptureSensor.h"
+
+#include "CanvasTypes.h"
+#include "EngineModule.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "LegacyScreenPercentageDriver.h"
+#include "RendererInterface.h"
+#include "SceneView.h"
+
+// Widest atlas supported by every RHI; rows of views wrap at this width.
+static constexpr int32 MAX_ATLAS_WIDTH = 8192;
+
+// Rigs alive by world, name, class, format and parent of their members. The
+// members own the rig, it is destroyed when the last one leaves.
+static TMap<FString, TWeakPtr<FSceneCaptureRig>> &GetRigRegistry()
+{
+  static TMap<FString, TWeakPtr<FSceneCaptureRig>> Registry;
+  return Registry;
+}
+
+static FString MakeRigKey(const ASceneCaptureSensor &Sensor)
+{
+  return FString::Printf(
+      TEXT("%p/%s/%s/%p/%d/%d"),
+      Sensor.GetWorld(),
+      *Sensor.GetRig(),
+      *Sensor.GetClass()->GetPathName(),
+      Sensor.GetAttachParentActor(),
+      Sensor.Is16BitFormatEnabled() ? 1 : 0,
+      Sensor.ArePostProcessingEffectsEnabled() ? 1 : 0);
+}
+
+TSharedPtr<FSceneCaptureRig> FSceneCaptureRig::Join(ASceneCaptureSensor &Sensor)
+{
+  check(IsInGameThread());
+  if (Sensor.GetRig().IsEmpty())
+  {
+    return nullptr;
+  }
+
+  auto &Registry = GetRigRegistry();
+  for (auto It = Registry.CreateIterator(); It; ++It)
+  {
+    if (!It.Value().IsValid())
+    {
+      It.RemoveCurrent();
+    }
+  }
+
+  const FString Key = MakeRigKey(Sensor);
+  TSharedPtr<FSceneCaptureRig> Rig = Registry.FindRef(Key).Pin();
+  if (!Rig.IsValid())
+  {
+    Rig = MakeShared<FSceneCaptureRig>();
+    Registry.Add(Key, Rig);
+  }
+  Rig->Members.Add({&Sensor, FIntPoint::ZeroValue});
+  Rig->bLayoutDirty = true;
+  UE_LOG(LogCarla, Log, TEXT("Camera %s joined rig \"%s\" (%d views)"),
+      *Sensor.GetName(), *Sensor.GetRig(), Rig->Members.Num());
+  return Rig;
+}
+
+void FSceneCaptureRig::Leave(ASceneCaptureSensor &Sensor)
+{
+  check(IsInGameThread());
+  Members.RemoveAll([&](const FMember &Member) {
+    return !Member.Sensor.IsValid() || Member.Sensor.Get() == &Sensor;
+  });
+  bLayoutDirty = true;
+}
+
+void FSceneCaptureRig::Capture(ASceneCaptureSensor &Sensor)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSceneCaptureRig::Capture);
+  check(IsInGameThread());
+
+  if (bLayoutDirty)
+  {
+    UpdateLayout();
+  }
+
+  // The first member to tick renders the views of the whole rig, the others
+  // only copy theirs.
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
+  if (Frame != LastRenderedFrame)
+  {
+    RenderViews(*Sensor.GetWorld());
+    LastRenderedFrame = Frame;
+  }
+
+  for (const FMember &Member : Members)
+  {
+    if (Member.Sensor.Get() == &Sensor)
+    {
+      CopyView(Sensor, Member.Offset);
+      return;
+    }
+  }
+}
+
+void FSceneCaptureRig::AddReferencedObjects(FReferenceCollector &Collector)
+{
+  Collector.AddReferencedObject(Atlas);
+}
+
+void FSceneCaptureRig::UpdateLayout()
+{
+  Members.RemoveAll([](const FMember &Member) {
+    return !Member.Sensor.IsValid();
+  });
+  bLayoutDirty = false;
+  if (Members.Num() == 0)
+  {
+    return;
+  }
+
+  FIntPoint Cursor = FIntPoint::ZeroValue;
+  FIntPoint AtlasSize = FIntPoint::ZeroValue;
+  int32 RowHeight = 0;
+  for (FMember &Member : Members)
+  {
+    const FIntPoint Size(Member.Sensor->GetImageWidth(), Member.Sensor->GetImageHeight());
+    if (Cursor.X > 0 && Cursor.X + Size.X > MAX_ATLAS_WIDTH)
+    {
+      Cursor.X = 0;
+      Cursor.Y += RowHeight;
+      RowHeight = 0;
+    }
+    Member.Offset = Cursor;
+    Cursor.X += Size.X;
+    RowHeight = FMath::Max(RowHeight, Size.Y);
+    AtlasSize.X = FMath::Max(AtlasSize.X, Cursor.X);
+    AtlasSize.Y = FMath::Max(AtlasSize.Y, Cursor.Y + RowHeight);
+  }
+
+  // Same settings as the render target of the members, see
+  // ASceneCaptureSensor::BeginPlay.
+  const ASceneCaptureSensor &First = *Members[0].Sensor;
+  if (Atlas == nullptr)
+  {
+    Atlas = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+    Atlas->CompressionSettings = TextureCompressionSettings::TC_Default;
+    Atlas->SRGB = false;
+    Atlas->bAutoGenerateMips = false;
+    Atlas->bGPUSharedFlag = false;
+    Atlas->AddressX = TextureAddress::TA_Clamp;
+    Atlas->AddressY = TextureAddress::TA_Clamp;
+  }
+  Atlas->InitCustomFormat(
+      AtlasSize.X,
+      AtlasSize.Y,
+      First.Is16BitFormatEnabled() ? PF_FloatRGBA : PF_B8G8R8A8,
+      !First.ArePostProcessingEffectsEnabled());
+  if (First.ArePostProcessingEffectsEnabled())
+  {
+    Atlas->TargetGamma = First.GetTargetGamma();
+  }
+}
+
+void FSceneCaptureRig::RenderViews(UWorld &World)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSceneCaptureRig::RenderViews);
+  if (Atlas == nullptr || Members.Num() == 0 || World.Scene == nullptr)
+  {
+    return;
+  }
+
+  // Show flags and capture source are the same for every member, they are
+  // configured by the class of the sensor.
+  const USceneCaptureComponent2D *FirstCapture = Members[0].Sensor->GetCaptureComponent2D();
+  FTextureRenderTargetResource *AtlasResource = Atlas->GameThread_GetRenderTargetResource();
+
+  FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+      AtlasResource,
+      World.Scene,
+      FirstCapture->ShowFlags)
+      .SetResolveScene(true)
+      .SetRealtimeUpdate(true)
+      .SetWorldTimes(World.GetTimeSeconds(), World.GetDeltaSeconds(), World.GetRealTimeSeconds()));
+  ViewFamily.SceneCaptureSource = FirstCapture->CaptureSource;
+  ViewFamily.SceneCaptureCompositeMode = FirstCapture->CompositeMode;
+  ViewFamily.SetScreenPercentageInterface(
+      new FLegacyScreenPercentageDriver(ViewFamily, 1.0f, false));
+
+  for (const FMember &Member : Members)
+  {
+    ASceneCaptureSensor *Sensor = Member.Sensor.Get();
+    if (Sensor == nullptr)
+    {
+      continue;
+    }
+    USceneCaptureComponent2D *Capture = Sensor->GetCaptureComponent2D();
+    const FIntPoint Size(Sensor->GetImageWidth(), Sensor->GetImageHeight());
+    const FTransform &Transform = Capture->GetComponentToWorld();
+
+    FSceneViewInitOptions Options;
+    Options.SetViewRectangle(FIntRect(Member.Offset, Member.Offset + Size));
+    Options.ViewFamily = &ViewFamily;
+    Options.ViewActor = Capture->GetViewOwner();
+    Options.ViewOrigin = Transform.GetLocation();
+    // Unreal's axes (X forward, Z up) to view space (Z forward, Y up).
+    Options.ViewRotationMatrix = FInverseRotationMatrix(Transform.Rotator()) * FMatrix(
+        FPlane(0.0f, 0.0f, 1.0f, 0.0f),
+        FPlane(1.0f, 0.0f, 0.0f, 0.0f),
+        FPlane(0.0f, 1.0f, 0.0f, 0.0f),
+        FPlane(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // Same projection as USceneCaptureComponent2D with a horizontal FOV.
+    const float HalfFOV = FMath::DegreesToRadians(Capture->FOVAngle) * 0.5f;
+    float XAxisMultiplier = 1.0f;
+    float YAxisMultiplier = 1.0f;
+    if (Size.X > Size.Y)
+    {
+      YAxisMultiplier = Size.X / static_cast<float>(Size.Y);
+    }
+    else
+    {
+      XAxisMultiplier = Size.Y / static_cast<float>(Size.X);
+    }
+    Options.ProjectionMatrix = FReversedZPerspectiveMatrix(
+        HalfFOV,
+        HalfFOV,
+        XAxisMultiplier,
+        YAxisMultiplier,
+        GNearClippingPlane,
+        GNearClippingPlane);
+    Options.FOV = Capture->FOVAngle;
+    Options.DesiredFOV = Capture->FOVAngle;
+    Options.SceneViewStateInterface = Capture->GetViewState(0);
+    Options.BackgroundColor = FLinearColor::Black;
+    Options.StereoPass = eSSP_FULL;
+    Options.bUseFieldOfViewForLOD = Capture->bUseFieldOfViewForLOD;
+    Options.LODDistanceFactor = FMath::Clamp(Capture->LODDistanceFactor, 0.01f, 100.0f);
+    Options.OverrideFarClippingPlaneDistance = Capture->MaxViewDistanceOverride;
+
+    // Owned and deleted by the view family.
+    FSceneView *View = new FSceneView(Options);
+    View->bIsSceneCapture = true;
+    View->StartFinalPostprocessSettings(Options.ViewOrigin);
+    View->OverridePostProcessSettings(Capture->PostProcessSettings, Capture->PostProcessBlendWeight);
+    View->EndFinalPostprocessSettings(Options);
+    ViewFamily.Views.Add(View);
+  }
+
+  FCanvas Canvas(AtlasResource, nullptr, &World, World.FeatureLevel);
+  Canvas.Clear(FLinearColor::Transparent);
+  GetRendererModule().BeginRenderingViewFamily(&Canvas, &ViewFamily);
+}
+
+void FSceneCaptureRig::CopyView(ASceneCaptureSensor &Sensor, const FIntPoint &Offset)
+{
+  UTextureRenderTarget2D *Target = Sensor.GetCaptureRenderTarget();
+  if (Atlas == nullptr || Target == nullptr)
+  {
+    return;
+  }
+  FTextureRenderTargetResource *Source = Atlas->GameThread_GetRenderTargetResource();
+  FTextureRenderTargetResource *Destination = Target->GameThread_GetRenderTargetResource();
+  const FIntPoint Size(Sensor.GetImageWidth(), Sensor.GetImageHeight());
+
+  ENQUEUE_RENDER_COMMAND(FSceneCaptureRig_CopyView)
+  (
+    [Source, Destination, Offset, Size](FRHICommandListImmediate &RHICmdList)
+    {
+      FRHITexture *SourceTexture = Source->GetRenderTargetTexture();
+      FRHITexture *DestinationTexture = Destination->GetRenderTargetTexture();
+
+      FRHICopyTextureInfo CopyInfo;
+      CopyInfo.Size = FIntVector(Size.X, Size.Y, 1);
+      CopyInfo.SourcePosition = FIntVector(Offset.X, Offset.Y, 0);
+
+      RHICmdList.Transition(FRHITransitionInfo(SourceTexture, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+      RHICmdList.Transition(FRHITransitionInfo(DestinationTexture, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+      RHICmdList.CopyTexture(SourceTexture, DestinationTexture, CopyInfo);
+      RHICmdList.Transition(FRHITransitionInfo(SourceTexture, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
+      RHICmdList.Transition(FRHITransitionInfo(DestinationTexture, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+    }
+  );
+}
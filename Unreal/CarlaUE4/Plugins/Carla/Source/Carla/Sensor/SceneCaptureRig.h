@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+
+class ASceneCaptureSensor;
+class UTextureRenderTarget2D;
+
+/// Group of cameras attached to the same actor that are rendered together.
+///
+/// Instead of a scene capture per camera, the views of every member are added
+/// to a single view family and rendered once per frame into an atlas, so the
+/// scene renderer setup, mesh gathering and the shadow depths of the lights
+/// are shared by all the views. The view of each member is then copied into
+/// its own render target, and from there it is read back and serialized as
+/// any other camera image.
+///
+/// Cameras join a rig by setting the "rig" attribute to the same name; only
+/// cameras of the same class, image format and parent actor share a rig.
+class FSceneCaptureRig : public FGCObject
+{
+public:
+
+  /// Returns the rig @a Sensor belongs to, adding the sensor to it. Returns
+  /// null if the sensor does not belong to any rig.
+  static TSharedPtr<FSceneCaptureRig> Join(ASceneCaptureSensor &Sensor);
+
+  void Leave(ASceneCaptureSensor &Sensor);
+
+  /// Render the views of the rig, once per frame, and copy the view of
+  /// @a Sensor into its render target.
+  void Capture(ASceneCaptureSensor &Sensor);
+
+  void AddReferencedObjects(FReferenceCollector &Collector) override;
+
+private:
+
+  struct FMember
+  {
+    TWeakObjectPtr<ASceneCaptureSensor> Sensor;
+
+    /// Top-left corner of the view of the sensor in the atlas.
+    FIntPoint Offset;
+  };
+
+  /// Place the views in rows and resize the atlas to fit them.
+  void UpdateLayout();
+
+  void RenderViews(UWorld &World);
+
+  void CopyView(ASceneCaptureSensor &Sensor, const FIntPoint &Offset);
+
+  TArray<FMember> Members;
+
+  UTextureRenderTarget2D *Atlas = nullptr;
+
+  bool bLayoutDirty = true;
+
+  uint64 LastRenderedFrame = MAX_uint64;
+};
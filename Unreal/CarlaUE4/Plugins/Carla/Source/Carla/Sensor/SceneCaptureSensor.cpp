@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Sensor/SceneCaptureSensor.h"
 #include "Carla/Game/CarlaStatics.h"
+#include "Carla/Sensor/SceneCaptureRig.h"
 #include "Actor/ActorBlueprintFunctionLibrary.h"
 
 #include <mutex>
@@ -449,11 +450,19 @@ float ASceneCaptureSensor::GetChromAberrOffset() const
 
 void ASceneCaptureSensor::EnqueueRenderSceneImmediate() {
   TRACE_CPUPROFILER_EVENT_SCOPE(ASceneCaptureSensor::EnqueueRenderSceneImmediate);
-  // Creates an snapshot of the scene, requieres bCaptureEveryFrame = false.
-  GetCaptureComponent2D()->CaptureScene();
-
-  // // Equivalent to "CaptureComponent2D->CaptureScene" + (optional) GBuffer extraction.
-  // CaptureSceneExtended();
+  if (!RigName.IsEmpty() && !Rig.IsValid())
+  {
+    Rig = FSceneCaptureRig::Join(*this);
+  }
+  if (Rig.IsValid())
+  {
+    // The views of the whole rig are rendered together, see FSceneCaptureRig.
+    Rig->Capture(*this);
+    return;
+  }
+  // Equivalent to "CaptureComponent2D->CaptureScene" + GBuffer extraction of
+  // the textures with clients listening, if any.
+  CaptureSceneExtended();
 }
 
 constexpr const TCHAR* GBufferNames[] =
@@ -481,8 +490,6 @@ static void CheckGBufferStream(T& GBufferStream, FGBufferRequest& GBuffer)
     GBuffer.MarkAsRequested(ID);
 }
 
-static uint64 Prior = 0;
-
 void ASceneCaptureSensor::CaptureSceneExtended()
 {
   auto GBufferPtr = MakeUnique<FGBufferRequest>();
@@ -509,10 +516,10 @@ void ASceneCaptureSensor::CaptureSceneExtended()
     return;
   }
 
-  if (Prior != GBufferPtr->DesiredTexturesMask)
+  if (GBufferTexturesMask != GBufferPtr->DesiredTexturesMask)
     UE_LOG(LogCarla, Verbose, TEXT("GBuffer selection changed (%llu)."), GBufferPtr->DesiredTexturesMask);
 
-  Prior = GBufferPtr->DesiredTexturesMask;
+  GBufferTexturesMask = GBufferPtr->DesiredTexturesMask;
   GBufferPtr->OwningActor = CaptureComponent2D->GetViewOwner();
 
 #define CARLA_GBUFFER_DISABLE_TAA // Temporarily disable TAA to avoid jitter.
@@ -533,10 +540,25 @@ void ASceneCaptureSensor::CaptureSceneExtended()
 #undef CARLA_GBUFFER_DISABLE_TAA
 #endif
 
-  AsyncTask(ENamedThreads::AnyHiPriThreadNormalTask, [this, GBuffer = MoveTemp(GBufferPtr)]() mutable
-  {
-    SendGBufferTextures(*GBuffer);
-  });
+  // A single fence after the readback copies of all the requested textures,
+  // the send task waits for it once instead of once per texture.
+  ENQUEUE_RENDER_COMMAND(FGBufferReadbackFence)(
+    [this, GBuffer = MoveTemp(GBufferPtr)](FRHICommandListImmediate& RHICmdList) mutable
+    {
+      FGPUFenceRHIRef Fence = RHICreateGPUFence(TEXT("CarlaGBufferReadback"));
+      RHICmdList.WriteGPUFence(Fence);
+      AsyncTask(ENamedThreads::AnyHiPriThreadNormalTask, [this, GBuffer = MoveTemp(GBuffer), Fence]() mutable
+      {
+        {
+          TRACE_CPUPROFILER_EVENT_SCOPE_STR("GBuffer Readback Wait");
+          while (!Fence->Poll())
+          {
+            FPlatformProcess::Sleep(0.0f);
+          }
+        }
+        SendGBufferTextures(*GBuffer);
+      });
+    });
 }
 
 void ASceneCaptureSensor::SendGBufferTextures(FGBufferRequest& GBuffer)
@@ -572,6 +594,8 @@ void ASceneCaptureSensor::BeginPlay()
   CaptureComponent2D->UpdateContent();
   CaptureComponent2D->Activate();
 
+  SetUpOutputConversion();
+
   // Make sure that there is enough time in the render queue.
   UKismetSystemLibrary::ExecuteConsoleCommand(
       GetWorld(),
@@ -579,6 +603,7 @@ void ASceneCaptureSensor::BeginPlay()
 
   SceneCaptureSensor_local_ns::ConfigureShowFlags(CaptureComponent2D->ShowFlags,
       bEnablePostProcessingEffects);
+  ApplyRenderQuality();
 
   // This ensures the camera is always spawning the raindrops in case the
   // weather was previously set to have rain.
@@ -587,6 +612,76 @@ void ASceneCaptureSensor::BeginPlay()
   Super::BeginPlay();
 }
 
+void ASceneCaptureSensor::ApplyRenderQuality()
+{
+  FEngineShowFlags &ShowFlags = CaptureComponent2D->ShowFlags;
+  if (RenderQuality != ECameraRenderQuality::Epic)
+  {
+    ShowFlags.SetVolumetricFog(false);
+    ShowFlags.SetScreenSpaceReflections(false);
+  }
+  if (RenderQuality == ECameraRenderQuality::Low)
+  {
+    ShowFlags.SetDynamicShadows(false);
+    ShowFlags.SetContactShadows(false);
+    ShowFlags.SetAmbientOcclusion(false);
+    ShowFlags.SetDistanceFieldAO(false);
+  }
+  // The component takes a negative distance as no limit
+  CaptureComponent2D->MaxViewDistanceOverride = MaxViewDistance > 0.0f ? MaxViewDistance : -1.0f;
+  CaptureComponent2D->LODDistanceFactor = LODDistanceFactor;
+}
+
+void ASceneCaptureSensor::SetUpOutputConversion()
+{
+  using namespace carla::sensor::s11n;
+
+  OutputConversionPass.reset();
+  if (OutputConversion.IsIdentity(ImageWidth, ImageHeight))
+  {
+    return;
+  }
+  if (!SupportsImageFormat(OutputConversion.format) ||
+      bEnable16BitFormat ||
+      GetOutputImageWidth() == 0u ||
+      GetOutputImageHeight() == 0u)
+  {
+    UE_LOG(LogCarla, Warning,
+        TEXT("%s: unsupported output conversion to '%s' (%ux%u), sending the images as they are rendered"),
+        *GetName(),
+        UTF8_TO_TCHAR(ImageConversion::ToString(OutputConversion.format)),
+        GetOutputImageWidth(),
+        GetOutputImageHeight());
+    OutputConversion = ImageConversion();
+    return;
+  }
+
+  const ImageRegion Region = OutputConversion.GetRegion(ImageWidth, ImageHeight);
+  OutputConversionParameters.SourceOffset = FIntPoint(Region.x, Region.y);
+  OutputConversionParameters.OutputSize = FIntPoint(GetOutputImageWidth(), GetOutputImageHeight());
+  OutputConversionParameters.Downscale = FMath::Max(OutputConversion.downscale, 1u);
+  switch (OutputConversion.format)
+  {
+    case ImageFormat::Depth16F:
+      OutputConversionParameters.Mode = EImageConversionMode::Depth;
+      OutputConversionParameters.OutputFormat = PF_R16F;
+      break;
+    case ImageFormat::Depth32F:
+      OutputConversionParameters.Mode = EImageConversionMode::Depth;
+      OutputConversionParameters.OutputFormat = PF_R32_FLOAT;
+      break;
+    case ImageFormat::Label8:
+      OutputConversionParameters.Mode = EImageConversionMode::Label;
+      OutputConversionParameters.OutputFormat = PF_G8;
+      break;
+    default:
+      OutputConversionParameters.Mode = EImageConversionMode::Color;
+      OutputConversionParameters.OutputFormat = PF_R8G8B8A8;
+      break;
+  }
+  OutputConversionPass = std::make_shared<FImageConversionPass>();
+}
+
 void ASceneCaptureSensor::PrePhysTick(float DeltaSeconds)
 {
   Super::PrePhysTick(DeltaSeconds);
@@ -606,6 +701,11 @@ void ASceneCaptureSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float
 
 void ASceneCaptureSensor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+  if (Rig.IsValid())
+  {
+    Rig->Leave(*this);
+    Rig.Reset();
+  }
   Super::EndPlay(EndPlayReason);
   FlushRenderingCommands();
   SCENE_CAPTURE_COUNTER = 0u;
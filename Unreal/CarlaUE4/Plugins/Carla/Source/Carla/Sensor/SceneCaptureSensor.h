@@ -14,10 +14,16 @@
 #include "Async/Async.h"
 #include "Renderer/Public/GBufferView.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/ImageConversion.h>
+#include <compiler/enable-ue4-macros.h>
+
 #include <type_traits>
 
 #include "SceneCaptureSensor.generated.h"
 
+class FSceneCaptureRig;
+
 
 
 class UDrawFrustumComponent;
@@ -114,6 +120,20 @@ struct FCameraGBufferFloat
 
 
 
+/// Render profile of a single camera, applied on top of the show flags of its
+/// class and independent of the quality level of the spectator, so cameras
+/// can skip the work that does not change their output.
+UENUM(BlueprintType)
+enum class ECameraRenderQuality : uint8
+{
+  /// Everything the class of the camera renders.
+  Epic,
+  /// No volumetric fog nor screen space reflections.
+  Medium,
+  /// No dynamic shadows nor ambient occlusion either.
+  Low
+};
+
 /// Base class for sensors using a USceneCaptureComponent2D for rendering the
 /// scene. This class does not capture data, use
 /// `FPixelReader::SendPixelsInRenderThread(*this)` in derived classes.
@@ -149,6 +169,11 @@ public:
     return ImageHeight;
   }
 
+  float GetTickCostEstimate(float TickSeconds) const override
+  {
+    return 1.0f + static_cast<float>(ImageWidth) * static_cast<float>(ImageHeight) * 1e-4f;
+  }
+
   UFUNCTION(BlueprintCallable)
   void EnablePostProcessingEffects(bool Enable = true)
   {
@@ -173,6 +198,80 @@ public:
     return bEnable16BitFormat;
   }
 
+  /// In synchronous mode, whether to send the images once the GPU has copied
+  /// them instead of waiting for the copy in the frame they are captured.
+  void SetPipelinedReadback(bool Enable)
+  {
+    bPipelinedReadback = Enable;
+  }
+
+  /// The readback is always pipelined in asynchronous mode.
+  bool IsReadbackPipelined() const
+  {
+    return bPipelinedReadback || !GetEpisode().GetSettings().bSynchronousMode;
+  }
+
+  UFUNCTION(BlueprintCallable)
+  void SetRenderQuality(ECameraRenderQuality Quality)
+  {
+    RenderQuality = Quality;
+  }
+
+  UFUNCTION(BlueprintCallable)
+  ECameraRenderQuality GetRenderQuality() const
+  {
+    return RenderQuality;
+  }
+
+  /// Primitives farther than @a Distance (cm) are not rendered, unlimited if
+  /// not positive.
+  UFUNCTION(BlueprintCallable)
+  void SetMaxViewDistance(float Distance)
+  {
+    MaxViewDistance = Distance;
+  }
+
+  /// Scales the distance used for selecting the LODs, values greater than 1
+  /// use lower LODs.
+  UFUNCTION(BlueprintCallable)
+  void SetLODDistanceFactor(float Factor)
+  {
+    LODDistanceFactor = FMath::Clamp(Factor, 0.01f, 100.0f);
+  }
+
+  /// Crop, downscale and convert the images on the GPU before reading them
+  /// back, see carla::sensor::s11n::ImageConversion. Ignored, with a warning,
+  /// if the sensor does not support the format.
+  void SetOutputConversion(const carla::sensor::s11n::ImageConversion &InConversion)
+  {
+    OutputConversion = InConversion;
+  }
+
+  /// Width of the images sent to the clients, after the conversion.
+  uint32 GetOutputImageWidth() const
+  {
+    return OutputConversion.GetOutputWidth(ImageWidth, ImageHeight);
+  }
+
+  /// Height of the images sent to the clients, after the conversion.
+  uint32 GetOutputImageHeight() const
+  {
+    return OutputConversion.GetOutputHeight(ImageWidth, ImageHeight);
+  }
+
+  /// Render this camera in one pass with the other cameras of the same class
+  /// and format attached to the same actor with the same @a InRigName, see
+  /// FSceneCaptureRig. An empty name renders the camera on its own.
+  void SetRig(const FString &InRigName)
+  {
+    RigName = InRigName;
+  }
+
+  const FString &GetRig() const
+  {
+    return RigName;
+  }
+
   UFUNCTION(BlueprintCallable)
   void SetFOVAngle(float FOVAngle);
 
@@ -421,6 +520,9 @@ public:
 
 protected:
 
+  /// Captures the scene and, in the same render, reads back only the GBuffer
+  /// textures with clients listening. Falls back to a plain capture when
+  /// none is requested.
   void CaptureSceneExtended();
 
   virtual void SendGBufferTextures(FGBufferRequest& GBuffer);
@@ -434,6 +536,14 @@ protected:
 
   virtual void SetUpSceneCaptureComponent(USceneCaptureComponent2D &SceneCapture) {}
 
+  /// Whether the images of this sensor can be converted to @a Format. Only the
+  /// sensors whose images are sent by carla::sensor::s11n::ImageSerializer
+  /// support conversions.
+  virtual bool SupportsImageFormat(carla::sensor::s11n::ImageFormat Format) const
+  {
+    return false;
+  }
+
   /// Render target necessary for scene capture.
   UPROPERTY(EditAnywhere)
   UTextureRenderTarget2D *CaptureRenderTarget = nullptr;
@@ -461,8 +571,51 @@ protected:
   UPROPERTY(EditAnywhere)
   bool bEnable16BitFormat = false;
 
+  /// Whether to pipeline the readback in synchronous mode, see
+  /// SetPipelinedReadback.
+  UPROPERTY(EditAnywhere)
+  bool bPipelinedReadback = false;
+
+  /// Copies of CaptureRenderTarget in flight, used from render-thread.
+  std::shared_ptr<FPixelReadbackQueue> ReadbackQueue = std::make_shared<FPixelReadbackQueue>();
+
+  /// Name of the rig this camera is rendered with, see SetRig.
+  UPROPERTY(EditAnywhere)
+  FString RigName;
+
+  UPROPERTY(EditAnywhere)
+  ECameraRenderQuality RenderQuality = ECameraRenderQuality::Epic;
+
+  /// In cm, unlimited if not positive.
+  UPROPERTY(EditAnywhere)
+  float MaxViewDistance = 0.0f;
+
+  UPROPERTY(EditAnywhere)
+  float LODDistanceFactor = 1.0f;
+
+  /// Joined on the first capture, once the camera is attached to its parent.
+  TSharedPtr<FSceneCaptureRig> Rig;
+
+  /// GBuffer textures requested in the last capture, only for logging.
+  uint64 GBufferTexturesMask = 0u;
+
+  /// Conversion applied before the readback, see SetOutputConversion.
+  carla::sensor::s11n::ImageConversion OutputConversion;
+
+  FImageConversionParameters OutputConversionParameters;
+
+  /// Null if the images are sent as they are rendered.
+  std::shared_ptr<FImageConversionPass> OutputConversionPass;
+
 private:
 
+  /// Validate OutputConversion and create the pass that applies it.
+  void SetUpOutputConversion();
+
+  /// Apply RenderQuality, MaxViewDistance and LODDistanceFactor to the
+  /// capture component, after the show flags of the class.
+  void ApplyRenderQuality();
+
   template <
     typename SensorT,
     typename CameraGBufferT>
@@ -476,6 +629,11 @@ private:
         std::is_same<std::remove_reference_t<CameraGBufferT>, FCameraGBufferUint8>::value,
         FColor,
         FLinearColor>::type;
+      if (!CameraGBuffer.Stream.AreClientsListening())
+      {
+        // The client unsubscribed after the capture, skip the decode.
+        return;
+      }
       FIntPoint ViewSize;
       TArray<PixelType> Pixels;
       if (GBufferData.WaitForTextureTransfer(TextureID))
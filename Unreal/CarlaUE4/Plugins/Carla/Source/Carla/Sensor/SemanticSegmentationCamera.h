@@ -27,4 +27,11 @@ public:
 protected:
 
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+  /// The tags can also be sent alone, one byte per pixel.
+  bool SupportsImageFormat(carla::sensor::s11n::ImageFormat Format) const override
+  {
+    return Format == carla::sensor::s11n::ImageFormat::BGRA8 ||
+        Format == carla::sensor::s11n::ImageFormat::Label8;
+  }
 };
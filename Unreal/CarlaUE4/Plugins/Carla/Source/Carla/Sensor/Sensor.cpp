@@ -28,8 +28,8 @@ void ASensor::BeginPlay()
 {
   Super::BeginPlay();
   UCarlaEpisode* Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-  FSensorManager& SensorManager = Episode->GetSensorManager();
-  SensorManager.RegisterSensor(this);
+  SensorManager = &Episode->GetSensorManager();
+  SensorManager->RegisterSensor(this);
 }
 
 void ASensor::Set(const FActorDescription &Description)
@@ -40,9 +40,33 @@ void ASensor::Set(const FActorDescription &Description)
   // set the tick interval of the sensor
   if (Description.Variations.Contains("sensor_tick"))
   {
-    SetActorTickInterval(
+    SensorTickInterval =
         UActorBlueprintFunctionLibrary::ActorAttributeToFloat(Description.Variations["sensor_tick"],
-        0.0f));
+        0.0f);
+    SetActorTickInterval(SensorTickInterval);
+  }
+
+  // set the compression of the data stream
+  if (Description.Variations.Contains("compression"))
+  {
+    const FString Compression = Description.Variations["compression"].Value;
+    if (!carla::sensor::s11n::Compression::FromString(TCHAR_TO_UTF8(*Compression), StreamCompression))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unknown sensor compression '%s', sending data uncompressed"), *Compression);
+      StreamCompression = carla::sensor::s11n::CompressionType::None;
+    }
+  }
+  if (StreamCompression == carla::sensor::s11n::CompressionType::Video)
+  {
+    int32 KeyframeInterval = 30;
+    if (Description.Variations.Contains("keyframe_interval"))
+    {
+      KeyframeInterval = UActorBlueprintFunctionLibrary::ActorAttributeToInt(
+          Description.Variations["keyframe_interval"],
+          KeyframeInterval);
+    }
+    VideoEncoder = std::make_shared<carla::sensor::s11n::DeltaVideoEncoder>(
+        static_cast<uint32_t>(FMath::Max(KeyframeInterval, 0)));
   }
 }
 
@@ -62,7 +86,7 @@ void ASensor::Tick(const float DeltaTime)
   Super::Tick(DeltaTime);
   if (bClientsListening)
   {
-    if(!Stream.AreClientsListening())
+    if(!AreClientsListening())
     {
       OnLastClientDisconnected();
       bClientsListening = false;
@@ -70,18 +94,32 @@ void ASensor::Tick(const float DeltaTime)
   }
   else
   {
-    if(Stream.AreClientsListening())
+    if(AreClientsListening())
     {
       OnFirstClientConnected();
       bClientsListening = true;
+      if (VideoEncoder)
+      {
+        // The new client can only decode from a keyframe
+        VideoEncoder->RequestKeyframe();
+      }
     }
   }
   if(!bClientsListening)
   {
     return;
   }
+  // Staggered sensors tick every frame but only run in the frames given by
+  // the sensor manager, like the tick interval they get the time since
+  // their last run.
+  SkippedDeltaTime += DeltaTime;
+  if(SensorManager != nullptr && !SensorManager->ShouldTick(*this, FCarlaEngine::GetFrameCounter()))
+  {
+    return;
+  }
   ReadyToTick = true;
-  PrePhysTick(DeltaTime);
+  PrePhysTick(SkippedDeltaTime);
+  SkippedDeltaTime = 0.0f;
 }
 
 void ASensor::SetSeed(const int32 InSeed)
@@ -120,11 +158,20 @@ void ASensor::EndPlay(EEndPlayReason::Type EndPlayReason)
   auto StreamId = carla::streaming::detail::token_type(Stream.GetToken()).get_stream_id();
   StreamingServer.CloseStream(StreamId);
 
+  SensorManager = nullptr;
   UCarlaEpisode* Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
   if(Episode)
   {
-    FSensorManager& SensorManager = Episode->GetSensorManager();
-    SensorManager.DeRegisterSensor(this);
+    FSensorManager& EpisodeSensorManager = Episode->GetSensorManager();
+    EpisodeSensorManager.DeRegisterSensor(this);
+  }
+}
+
+void ASensor::SubmitTracesInternal(FSensorTraceScheduler &Scheduler, float DeltaSeconds)
+{
+  if(ReadyToTick)
+  {
+    SubmitTraces(Scheduler, DeltaSeconds);
   }
 }
 
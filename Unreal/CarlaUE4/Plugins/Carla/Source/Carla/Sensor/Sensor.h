@@ -17,6 +17,8 @@
 #include "Sensor.generated.h"
 
 struct FActorDescription;
+class FSensorManager;
+class FSensorTraceScheduler;
 
 /// Base class for sensors.
 UCLASS(Abstract, hidecategories = (Collision, Attachment, Actor))
@@ -63,9 +65,24 @@ public:
     return Stream.IsStreamReady();
   }
 
+  /// Send the data of this sensor also to @a InBundle, nullptr to remove the
+  /// sensor from its current bundle.
+  void SetSensorBundle(std::shared_ptr<FSensorBundle> InBundle)
+  {
+    Bundle = std::move(InBundle);
+  }
+
+  const std::shared_ptr<FSensorBundle> &GetSensorBundle() const
+  {
+    return Bundle;
+  }
+
   void Tick(const float DeltaTime) final;
 
   virtual void PrePhysTick(float DeltaSeconds) {}
+  /// Submit the traces of this tick to @a Scheduler. They are executed after
+  /// every sensor submitted theirs and the hits are ready in PostPhysTick.
+  virtual void SubmitTraces(FSensorTraceScheduler &Scheduler, float DeltaSeconds) {}
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) {}
   // Small interface to notify sensors when clients are listening
   virtual void OnFirstClientConnected() {};
@@ -73,6 +90,30 @@ public:
   virtual void OnLastClientDisconnected() {};
 
 
+  void SubmitTracesInternal(FSensorTraceScheduler &Scheduler, float DeltaSeconds);
+
+  /// Whether the sensor ticks in this frame and has to run PostPhysTick.
+  bool IsReadyToTick() const
+  {
+    return ReadyToTick;
+  }
+
+  /// Time between ticks set with the "sensor_tick" attribute, 0 to tick
+  /// every frame.
+  float GetSensorTickInterval() const
+  {
+    return SensorTickInterval;
+  }
+
+  /// Relative cost of a tick of the sensor, used by FSensorManager to spread
+  /// expensive sensors across frames. @a TickSeconds is the time covered by
+  /// each tick. About 1 per thousand rays traced or ten thousand pixels
+  /// rendered.
+  virtual float GetTickCostEstimate(float TickSeconds) const
+  {
+    return 1.0f;
+  }
+
   void PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 
   UFUNCTION(BlueprintCallable)
@@ -109,7 +150,20 @@ protected:
   template <typename SensorT>
   FAsyncDataStream GetDataStream(const SensorT &Self)
   {
-    return Stream.MakeAsyncDataStream(Self, GetEpisode().GetElapsedGameTime());
+    auto AsyncStream = Stream.MakeAsyncDataStream(Self, GetEpisode().GetElapsedGameTime());
+    if (VideoEncoder)
+    {
+      AsyncStream.SetVideoEncoder(VideoEncoder);
+    }
+    else if (StreamCompression != carla::sensor::s11n::CompressionType::None)
+    {
+      AsyncStream.SetCompression(StreamCompression);
+    }
+    if (Bundle)
+    {
+      AsyncStream.SetBundle(Bundle);
+    }
+    return AsyncStream;
   }
 
   /// Seed of the pseudo-random engine.
@@ -125,14 +179,38 @@ protected:
 
 private:
 
+  /// Either a client listens to the sensor's stream or to its bundle.
+  bool AreClientsListening()
+  {
+    return Stream.AreClientsListening() || (Bundle && Bundle->AreClientsListening());
+  }
+
   FDataStream Stream;
 
+  std::shared_ptr<FSensorBundle> Bundle;
+
   FDelegateHandle OnPostTickDelegate;
 
   FActorDescription SensorDescription;
 
+  /// Compression applied to the data sent by this sensor, set from the
+  /// "compression" attribute of the blueprint.
+  carla::sensor::s11n::CompressionType StreamCompression = carla::sensor::s11n::CompressionType::None;
+
+  /// Encoder of the "video" compression, shared by the data streams of the
+  /// sensor since each frame is encoded against the previous one.
+  std::shared_ptr<carla::sensor::s11n::VideoEncoder> VideoEncoder;
+
   const UCarlaEpisode *Episode = nullptr;
 
+  /// Set while the sensor is registered, decides in which frames it ticks.
+  FSensorManager *SensorManager = nullptr;
+
+  float SensorTickInterval = 0.0f;
+
+  /// Time since the sensor last ran.
+  float SkippedDeltaTime = 0.0f;
+
   /// Allows the sensor to tick with the tick rate from UE4.
   bool ReadyToTick = false;
 
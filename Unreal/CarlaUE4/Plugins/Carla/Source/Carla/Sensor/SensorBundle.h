@@ -0,0 +1,73 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/Buffer.h>
+#include <carla/BufferView.h>
+#include <carla/sensor/s11n/SensorBundleSerializer.h>
+#include <carla/streaming/Stream.h>
+#include <carla/streaming/detail/Token.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
+/// A stream that coalesces the data of a group of sensors. Once every sensor
+/// of the bundle has sent its data for a frame, a single message containing
+/// all of them is sent down the bundle's stream.
+///
+/// Thread-safe, sensors send their data from the render thread and from task
+/// threads.
+class FSensorBundle
+{
+public:
+
+  using stream_id_type = carla::streaming::detail::stream_id_type;
+
+  FSensorBundle(carla::streaming::Stream InStream, std::vector<stream_id_type> StreamIds)
+    : Stream(std::move(InStream)),
+      Builder(std::move(StreamIds)) {}
+
+  /// Return the token that allows subscribing to this bundle.
+  carla::streaming::Token GetToken() const
+  {
+    return Stream.token();
+  }
+
+  stream_id_type GetStreamId() const
+  {
+    return carla::streaming::detail::token_type(Stream.token()).get_stream_id();
+  }
+
+  bool AreClientsListening()
+  {
+    return Stream.AreClientsListening();
+  }
+
+  /// Add the message of the sensor with stream @a StreamId, the bundle message
+  /// is sent as soon as the frame is complete.
+  void Add(stream_id_type StreamId, uint64_t Frame, const std::vector<boost::asio::const_buffer> &Message)
+  {
+    if (!Stream.AreClientsListening())
+    {
+      return;
+    }
+    auto Bundle = Builder.Add(StreamId, Frame, Message);
+    if (Bundle)
+    {
+      Stream.Write(
+          carla::BufferView::CreateFrom(std::move(Bundle->first)),
+          carla::BufferView::CreateFrom(std::move(Bundle->second)));
+    }
+  }
+
+private:
+
+  carla::streaming::Stream Stream;
+
+  carla::sensor::s11n::SensorBundleBuilder Builder;
+};
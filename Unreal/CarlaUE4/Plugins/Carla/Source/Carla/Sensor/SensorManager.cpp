@@ -7,20 +7,229 @@
 #include "SensorManager.h"
 #include "Sensor.h"
 
+#include "Misc/App.h"
+
+namespace SensorManagerConstants
+{
+  /// Frames inspected to find the most loaded frame of a phase, long enough
+  /// to cover the common multiple of the usual periods.
+  constexpr int32 ScheduleHorizon = 240;
+
+  /// Weight of the last tick in the moving average of the measured cost.
+  constexpr float MeasuredCostSmoothing = 0.1f;
+}
+
+static double FSensorManager_GetFixedDeltaSeconds()
+{
+  return FApp::IsBenchmarking() ? FApp::GetFixedDeltaTime() : 0.0;
+}
+
+static bool FSensorManager_NoStagger()
+{
+  static const bool bNoStagger = FParse::Param(FCommandLine::Get(), TEXT("NoSensorTickStagger"));
+  return bNoStagger;
+}
+
 void FSensorManager::RegisterSensor(ASensor* Sensor)
 {
   SensorList.Emplace(Sensor);
+  ScheduleSensor(*Sensor);
 }
 
 void FSensorManager::DeRegisterSensor(ASensor* Sensor)
 {
   SensorList.Remove(Sensor);
+  TickSchedules.Remove(Sensor);
+}
+
+bool FSensorManager::IsScheduled(const ASensor &Sensor, uint64 Frame) const
+{
+  const FSensorTickSchedule *Schedule = TickSchedules.Find(&Sensor);
+  if (Schedule == nullptr || Schedule->PeriodFrames <= 1)
+  {
+    return true;
+  }
+  return static_cast<int32>(Frame % Schedule->PeriodFrames) == Schedule->PhaseFrames;
+}
+
+bool FSensorManager::ShouldTick(const ASensor &Sensor, uint64 Frame)
+{
+  FSensorTickSchedule *Schedule = TickSchedules.Find(&Sensor);
+  if (Schedule == nullptr)
+  {
+    return true;
+  }
+  if (Frame != TickBudgetFrame)
+  {
+    TickBudgetFrame = Frame;
+    TickBudgetSpent = 0.0f;
+  }
+  const float Cost = FMath::Max(Schedule->MeasuredCost, 0.0f);
+  if (Schedule->PeriodFrames <= 1)
+  {
+    TickBudgetSpent += Cost;
+    return true;
+  }
+  if (!Schedule->bDeferred && !IsScheduled(Sensor, Frame))
+  {
+    return false;
+  }
+  if (TickBudget >= 0.0f &&
+      TickBudgetSpent + Cost > TickBudget &&
+      Schedule->DeferredFrames < Schedule->PeriodFrames - 1)
+  {
+    Schedule->bDeferred = true;
+    ++Schedule->DeferredFrames;
+    return false;
+  }
+  Schedule->bDeferred = false;
+  Schedule->DeferredFrames = 0;
+  TickBudgetSpent += Cost;
+  return true;
+}
+
+int32 FSensorManager::GetDeferredCount() const
+{
+  int32 Count = 0;
+  for (const auto &Item : TickSchedules)
+  {
+    Count += Item.Value.bDeferred ? 1 : 0;
+  }
+  return Count;
+}
+
+float FSensorManager::GetFrameCost(uint64 Frame, const ASensor *Ignored) const
+{
+  float Cost = 0.0f;
+  for (const auto &Item : TickSchedules)
+  {
+    if (Item.Key != Ignored && IsScheduled(*Item.Key, Frame))
+    {
+      Cost += Item.Value.EstimatedCost;
+    }
+  }
+  return Cost;
+}
+
+TArray<float> FSensorManager::GetTickCostPlan(uint64 FirstFrame, int32 NumFrames) const
+{
+  TArray<float> Plan;
+  Plan.Reserve(NumFrames);
+  for (int32 i = 0; i < NumFrames; ++i)
+  {
+    Plan.Add(GetFrameCost(FirstFrame + i));
+  }
+  return Plan;
+}
+
+void FSensorManager::ScheduleSensor(ASensor &Sensor)
+{
+  FSensorTickSchedule &Schedule = TickSchedules.FindOrAdd(&Sensor);
+  const float MeasuredCost = Schedule.MeasuredCost;
+  Schedule = FSensorTickSchedule{};
+  Schedule.MeasuredCost = MeasuredCost;
+
+  const double FixedDeltaSeconds = ScheduledFixedDeltaSeconds;
+  const float Interval = Sensor.GetSensorTickInterval();
+  Schedule.EstimatedCost = Sensor.GetTickCostEstimate(
+      FMath::Max(Interval, static_cast<float>(FixedDeltaSeconds)));
+
+  if (FSensorManager_NoStagger() || FixedDeltaSeconds <= 0.0 || Interval <= 0.0f)
+  {
+    Sensor.SetActorTickInterval(Interval);
+    return;
+  }
+  const int32 Period = FMath::Max(FMath::RoundToInt(Interval / FixedDeltaSeconds), 1);
+  if (Period == 1)
+  {
+    Sensor.SetActorTickInterval(0.0f);
+    return;
+  }
+
+  // Pick the phase whose most loaded frame is the least loaded, the first
+  // one on ties.
+  int32 BestPhase = 0;
+  float BestCost = TNumericLimits<float>::Max();
+  for (int32 Phase = 0; Phase < Period; ++Phase)
+  {
+    float PhaseCost = 0.0f;
+    for (int32 Frame = Phase; Frame < SensorManagerConstants::ScheduleHorizon; Frame += Period)
+    {
+      PhaseCost = FMath::Max(PhaseCost, GetFrameCost(Frame, &Sensor));
+    }
+    if (PhaseCost < BestCost)
+    {
+      BestCost = PhaseCost;
+      BestPhase = Phase;
+    }
+  }
+
+  Schedule.PeriodFrames = Period;
+  Schedule.PhaseFrames = BestPhase;
+  // The manager decides in which frames the sensor ticks.
+  Sensor.SetActorTickInterval(0.0f);
+}
+
+void FSensorManager::RescheduleAll()
+{
+  TArray<ASensor *> Sensors = SensorList;
+  for (ASensor *Sensor : Sensors)
+  {
+    FSensorTickSchedule &Schedule = TickSchedules.FindOrAdd(Sensor);
+    Schedule.PeriodFrames = 0;
+    Schedule.EstimatedCost = 0.0f;
+  }
+  const float FixedDeltaSeconds = static_cast<float>(ScheduledFixedDeltaSeconds);
+  Sensors.Sort([FixedDeltaSeconds](const ASensor &A, const ASensor &B) {
+    const float TickA = FMath::Max(A.GetSensorTickInterval(), FixedDeltaSeconds);
+    const float TickB = FMath::Max(B.GetSensorTickInterval(), FixedDeltaSeconds);
+    return A.GetTickCostEstimate(TickA) > B.GetTickCostEstimate(TickB);
+  });
+  for (ASensor *Sensor : Sensors)
+  {
+    ScheduleSensor(*Sensor);
+  }
 }
 
 void FSensorManager::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
+  TMap<ASensor *, double> TickSeconds;
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Submit Sensor Traces");
+    for(ASensor* Sensor : SensorList)
+    {
+      if (Sensor->IsReadyToTick())
+      {
+        const double Begin = FPlatformTime::Seconds();
+        Sensor->SubmitTracesInternal(TraceScheduler, DeltaSeconds);
+        TickSeconds.Add(Sensor, FPlatformTime::Seconds() - Begin);
+      }
+    }
+  }
+  TraceScheduler.Execute(World);
   for(ASensor* Sensor : SensorList)
   {
+    double *Seconds = TickSeconds.Find(Sensor);
+    const double Begin = FPlatformTime::Seconds();
     Sensor->PostPhysTickInternal(World, TickType, DeltaSeconds);
+    if (Seconds != nullptr)
+    {
+      FSensorTickSchedule *Schedule = TickSchedules.Find(Sensor);
+      if (Schedule != nullptr)
+      {
+        const float Milliseconds = static_cast<float>((*Seconds + FPlatformTime::Seconds() - Begin) * 1e3);
+        Schedule->MeasuredCost = Schedule->MeasuredCost < 0.0f ?
+            Milliseconds :
+            FMath::Lerp(Schedule->MeasuredCost, Milliseconds, SensorManagerConstants::MeasuredCostSmoothing);
+      }
+    }
+  }
+
+  // Sensors are spread in frames, a new fixed delta changes every period.
+  const double FixedDeltaSeconds = FSensorManager_GetFixedDeltaSeconds();
+  if (FixedDeltaSeconds != ScheduledFixedDeltaSeconds)
+  {
+    ScheduledFixedDeltaSeconds = FixedDeltaSeconds;
+    RescheduleAll();
   }
 }
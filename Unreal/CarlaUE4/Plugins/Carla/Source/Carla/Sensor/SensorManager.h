@@ -6,8 +6,37 @@
 
 #pragma once
 
+#include "Carla/Sensor/SensorTraceScheduler.h"
+
 class ASensor;
 
+/// Frames in which a sensor ticks.
+struct FSensorTickSchedule
+{
+  /// The sensor ticks every PeriodFrames frames, 0 if it is not staggered
+  /// and ticks with its own tick interval.
+  int32 PeriodFrames = 0;
+
+  /// The sensor ticks in the frames whose number modulo PeriodFrames is
+  /// PhaseFrames.
+  int32 PhaseFrames = 0;
+
+  /// Cost given by ASensor::GetTickCostEstimate.
+  float EstimatedCost = 1.0f;
+
+  /// Moving average of the game thread time of SubmitTraces and
+  /// PostPhysTick in milliseconds, negative until the sensor ticked. The
+  /// shared trace pass is not included.
+  float MeasuredCost = -1.0f;
+
+  /// The sensor was due but did not fit in the tick budget, it ticks in the
+  /// next frame that has room for it.
+  bool bDeferred = false;
+
+  /// Frames the sensor has been deferred since it was due.
+  int32 DeferredFrames = 0;
+};
+
 class FSensorManager
 {
 
@@ -19,8 +48,77 @@ public:
 
   void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 
+  FSensorTraceScheduler &GetTraceScheduler()
+  {
+    return TraceScheduler;
+  }
+
+  /// Whether @a Sensor ticks in @a Frame according to its phase.
+  bool IsScheduled(const ASensor &Sensor, uint64 Frame) const;
+
+  /// Whether @a Sensor ticks in @a Frame, like IsScheduled but a staggered
+  /// sensor that does not fit in the tick budget of the frame is deferred to
+  /// the following frames. A sensor is never deferred past the frame before
+  /// its next phase, so it keeps its rate. Called once per sensor and frame.
+  bool ShouldTick(const ASensor &Sensor, uint64 Frame);
+
+  /// Limit the measured cost of the sensors that tick in a frame to
+  /// @a Milliseconds, negative for no limit. Sensors that tick every frame
+  /// always tick but count against the budget.
+  void SetTickBudget(float Milliseconds)
+  {
+    TickBudget = Milliseconds;
+  }
+
+  float GetTickBudget() const
+  {
+    return TickBudget;
+  }
+
+  /// Number of sensors currently deferred by the tick budget.
+  int32 GetDeferredCount() const;
+
+  /// Fixed delta seconds the current phases were assigned with, 0 if there
+  /// is no fixed delta and sensors are not staggered.
+  double GetScheduledFixedDeltaSeconds() const
+  {
+    return ScheduledFixedDeltaSeconds;
+  }
+
+  const TMap<ASensor *, FSensorTickSchedule> &GetTickSchedules() const
+  {
+    return TickSchedules;
+  }
+
+  /// Sum of the estimated cost of the sensors that tick in each of the
+  /// @a NumFrames frames starting at @a FirstFrame.
+  TArray<float> GetTickCostPlan(uint64 FirstFrame, int32 NumFrames) const;
+
 private:
 
+  /// Assign a phase to @a Sensor that minimizes the largest cost of the
+  /// frames it ticks in, given the phases of the other sensors.
+  void ScheduleSensor(ASensor &Sensor);
+
+  /// Assign again the phases of every sensor, most expensive first.
+  void RescheduleAll();
+
+  /// Estimated cost of the sensors that tick in @a Frame, except @a Ignored.
+  float GetFrameCost(uint64 Frame, const ASensor *Ignored = nullptr) const;
+
   TArray<ASensor*> SensorList;
 
+  FSensorTraceScheduler TraceScheduler;
+
+  TMap<ASensor *, FSensorTickSchedule> TickSchedules;
+
+  double ScheduledFixedDeltaSeconds = 0.0;
+
+  float TickBudget = -1.0f;
+
+  /// Frame TickBudgetSpent refers to.
+  uint64 TickBudgetFrame = 0u;
+
+  float TickBudgetSpent = 0.0f;
+
 };
@@ -0,0 +1,330 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorTraceScheduler.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+#include "WorldCollision.h"
+
+#include <PxScene.h>
+
+#include <atomic>
+
+namespace SensorTraceSchedulerConstants
+{
+  /// Traces run sequentially by a task before it takes the next chunk.
+  constexpr int32 TracesPerChunk = 64;
+}
+
+struct FSensorTraceScheduler::FSharedSweepGroup
+{
+  const AActor *Owner;
+
+  ECollisionChannel Channel;
+
+  /// Object types queried, 0 if the batches query Channel.
+  int32 ObjectTypes;
+
+  TArray<FSensorTraceBatch *> Batches;
+
+  /// Components with a blocking response overlapping every sweep of the
+  /// group.
+  TArray<UPrimitiveComponent *> Candidates;
+
+  bool Matches(const FSensorTraceBatch &Batch) const
+  {
+    const int32 BatchObjectTypes = Batch.ObjectQueryParams.IsSet() ?
+        Batch.ObjectQueryParams->GetQueryBitfield() : 0;
+    return (Owner == Batch.SharedQueryGroup) &&
+        (ObjectTypes == BatchObjectTypes) &&
+        ((ObjectTypes != 0) || (Channel == Batch.Channel));
+  }
+};
+
+void FSensorTraceScheduler::FindSharedSweepCandidates(UWorld &World, FSharedSweepGroup &Group)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSensorTraceScheduler::FindSharedSweepCandidates);
+  FBox Bounds(ForceInit);
+  for (const FSensorTraceBatch *Batch : Group.Batches)
+  {
+    const FVector Extent = Batch->Shape.GetExtent();
+    for (int32 idx = 0; idx < Batch->Num(); ++idx)
+    {
+      if (Batch->Active[idx])
+      {
+        Bounds += FBox(Batch->Starts[idx] - Extent, Batch->Starts[idx] + Extent);
+        Bounds += FBox(Batch->Ends[idx] - Extent, Batch->Ends[idx] + Extent);
+      }
+    }
+  }
+  if (!Bounds.IsValid)
+  {
+    return;
+  }
+
+  const FSensorTraceBatch &First = *Group.Batches[0];
+  FCollisionQueryParams Params(FName(TEXT("SharedSensorSweep")), false, Group.Owner);
+  const FCollisionShape Box = FCollisionShape::MakeBox(Bounds.GetExtent());
+  TArray<FOverlapResult> Overlaps;
+  if (First.ObjectQueryParams.IsSet())
+  {
+    World.OverlapMultiByObjectType(
+        Overlaps,
+        Bounds.GetCenter(),
+        FQuat::Identity,
+        First.ObjectQueryParams.GetValue(),
+        Box,
+        Params);
+  }
+  else
+  {
+    World.OverlapMultiByChannel(
+        Overlaps,
+        Bounds.GetCenter(),
+        FQuat::Identity,
+        First.Channel,
+        Box,
+        Params,
+        First.ResponseParams);
+  }
+
+  for (const FOverlapResult &Overlap : Overlaps)
+  {
+    // Object type queries block on every object type queried.
+    UPrimitiveComponent *Component = Overlap.Component.Get();
+    if ((Component != nullptr) && (Overlap.bBlockingHit || First.ObjectQueryParams.IsSet()))
+    {
+      Group.Candidates.AddUnique(Component);
+    }
+  }
+}
+
+void FSensorTraceScheduler::Submit(FSensorTraceBatch &Batch)
+{
+  if (Batch.Num() > 0)
+  {
+    Batches.Add(&Batch);
+  }
+}
+
+int32 FSensorTraceScheduler::GetThreadBudget()
+{
+  if (ThreadBudget <= 0)
+  {
+    int32 Threads = 0;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("-SensorTraceThreads="), Threads) || Threads <= 0)
+    {
+      Threads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    }
+    SetThreadBudget(Threads);
+  }
+  return ThreadBudget;
+}
+
+void FSensorTraceScheduler::SetThreadBudget(int32 InThreadBudget)
+{
+  ThreadBudget = FMath::Max(InThreadBudget, 1);
+}
+
+int32 FSensorTraceScheduler::GetNumPendingTraces() const
+{
+  int32 Count = 0;
+  for (const FSensorTraceBatch *Batch : Batches)
+  {
+    Count += Batch->Num();
+  }
+  return Count;
+}
+
+void FSensorTraceScheduler::Execute(UWorld *World)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSensorTraceScheduler::Execute);
+  if (Batches.Num() == 0)
+  {
+    return;
+  }
+  check(World != nullptr);
+
+  struct FChunk
+  {
+    FSensorTraceBatch *Batch;
+    int32 Begin;
+    int32 End;
+  };
+
+  struct FSharedSweep
+  {
+    const FSharedSweepGroup *Group;
+    FSensorTraceBatch *Batch;
+    int32 Index;
+  };
+
+  TArray<FChunk> Chunks;
+  TArray<FSensorTraceBatch *> SerialBatches;
+  TArray<FSharedSweepGroup> SharedGroups;
+  for (FSensorTraceBatch *Batch : Batches)
+  {
+    const int32 Num = Batch->Num();
+    Batch->Hits.Reset(Num);
+    Batch->Hits.SetNum(Num);
+    if (Batch->IsShared())
+    {
+      FSharedSweepGroup *Group = SharedGroups.FindByPredicate(
+          [Batch](const FSharedSweepGroup &Item) { return Item.Matches(*Batch); });
+      if (Group == nullptr)
+      {
+        Group = &SharedGroups.Add_GetRef(FSharedSweepGroup{
+            Batch->SharedQueryGroup,
+            Batch->Channel,
+            Batch->ObjectQueryParams.IsSet() ? Batch->ObjectQueryParams->GetQueryBitfield() : 0});
+      }
+      Group->Batches.Add(Batch);
+    }
+    else if (Batch->IsParallel())
+    {
+      for (int32 Begin = 0; Begin < Num; Begin += SensorTraceSchedulerConstants::TracesPerChunk)
+      {
+        Chunks.Add({Batch, Begin, FMath::Min(Begin + SensorTraceSchedulerConstants::TracesPerChunk, Num)});
+      }
+    }
+    else
+    {
+      SerialBatches.Add(Batch);
+    }
+  }
+  Batches.Reset();
+
+  TArray<FSharedSweep> SharedSweeps;
+  for (FSharedSweepGroup &Group : SharedGroups)
+  {
+    FindSharedSweepCandidates(*World, Group);
+    if (Group.Candidates.Num() == 0)
+    {
+      continue;
+    }
+    for (FSensorTraceBatch *Batch : Group.Batches)
+    {
+      for (int32 idx = 0; idx < Batch->Num(); ++idx)
+      {
+        if (Batch->Active[idx])
+        {
+          SharedSweeps.Add({&Group, Batch, idx});
+        }
+      }
+    }
+  }
+
+  if ((Chunks.Num() > 0) || (SharedSweeps.Num() > 0))
+  {
+    physx::PxScene *Scene = World->GetPhysicsScene()->GetPxScene();
+    Scene->lockRead();
+    if (Chunks.Num() > 0)
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+      // Each task takes the next chunk until there are none left, the number
+      // of tasks bounds the threads tracing at the same time.
+      std::atomic<int32> NextChunk{0};
+      const int32 NumTasks = FMath::Min(GetThreadBudget(), Chunks.Num());
+      ParallelFor(NumTasks, [&](int32) {
+        TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
+        for (int32 idxChunk = NextChunk++; idxChunk < Chunks.Num(); idxChunk = NextChunk++) {
+          const FChunk &Chunk = Chunks[idxChunk];
+          FSensorTraceBatch &Batch = *Chunk.Batch;
+          for (int32 idx = Chunk.Begin; idx < Chunk.End; ++idx) {
+            if (!Batch.Active[idx]) {
+              continue;
+            }
+            World->ParallelLineTraceSingleByChannel(
+              Batch.Hits[idx],
+              Batch.Starts[idx],
+              Batch.Ends[idx],
+              Batch.Channel,
+              Batch.QueryParams,
+              Batch.ResponseParams
+            );
+          }
+        }
+      });
+    }
+    if (SharedSweeps.Num() > 0)
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE_STR("Shared Sweeps");
+      // Narrowphase of each sweep against the candidates of its group, the
+      // closest blocking hit wins as in SweepSingleByChannel.
+      std::atomic<int32> NextSweep{0};
+      const int32 NumTasks = FMath::Min(GetThreadBudget(), SharedSweeps.Num());
+      ParallelFor(NumTasks, [&](int32) {
+        TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
+        for (int32 idxSweep = NextSweep++; idxSweep < SharedSweeps.Num(); idxSweep = NextSweep++) {
+          const FSharedSweep &Sweep = SharedSweeps[idxSweep];
+          FSensorTraceBatch &Batch = *Sweep.Batch;
+          const FVector &Start = Batch.Starts[Sweep.Index];
+          const FVector &End = Batch.Ends[Sweep.Index];
+          const FVector Extent = Batch.Shape.GetExtent();
+          FBox SweepBounds(Start - Extent, Start + Extent);
+          SweepBounds += FBox(End - Extent, End + Extent);
+          const auto &IgnoredActors = Batch.QueryParams.GetIgnoredActors();
+          FHitResult &Best = Batch.Hits[Sweep.Index];
+          for (UPrimitiveComponent *Component : Sweep.Group->Candidates)
+          {
+            const AActor *Owner = Component->GetOwner();
+            if (((Owner != nullptr) && IgnoredActors.Contains(Owner->GetUniqueID())) ||
+                !SweepBounds.Intersect(Component->Bounds.GetBox()))
+            {
+              continue;
+            }
+            FHitResult Hit;
+            if (Component->SweepComponent(
+                    Hit, Start, End, FQuat::Identity, Batch.Shape, Batch.QueryParams.bTraceComplex) &&
+                (!Best.bBlockingHit || (Hit.Time < Best.Time)))
+            {
+              Best = Hit;
+              Best.bBlockingHit = true;
+            }
+          }
+        }
+      });
+    }
+    Scene->unlockRead();
+  }
+
+  for (FSensorTraceBatch *Batch : SerialBatches)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Serial Traces");
+    for (int32 idx = 0; idx < Batch->Num(); ++idx)
+    {
+      if (!Batch->Active[idx])
+      {
+        continue;
+      }
+      if (Batch->ObjectQueryParams.IsSet())
+      {
+        World->SweepSingleByObjectType(
+            Batch->Hits[idx],
+            Batch->Starts[idx],
+            Batch->Ends[idx],
+            FQuat::Identity,
+            Batch->ObjectQueryParams.GetValue(),
+            Batch->Shape,
+            Batch->QueryParams);
+      }
+      else
+      {
+        World->SweepSingleByChannel(
+            Batch->Hits[idx],
+            Batch->Starts[idx],
+            Batch->Ends[idx],
+            FQuat::Identity,
+            Batch->Channel,
+            Batch->Shape,
+            Batch->QueryParams,
+            Batch->ResponseParams);
+      }
+    }
+  }
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+
+/// Traces of a sensor for one tick, all of them with the same query
+/// parameters. The sensor fills it in ASensor::SubmitTraces and reads the
+/// hits back in ASensor::PostPhysTick.
+class FSensorTraceBatch
+{
+public:
+
+  FSensorTraceBatch() = default;
+
+  FSensorTraceBatch(const FCollisionQueryParams &InQueryParams, ECollisionChannel InChannel)
+    : Channel(InChannel),
+      QueryParams(InQueryParams) {}
+
+  /// Channel traced against, ignored if ObjectQueryParams is set.
+  ECollisionChannel Channel = ECC_GameTraceChannel2;
+
+  FCollisionQueryParams QueryParams = FCollisionQueryParams::DefaultQueryParam;
+
+  FCollisionResponseParams ResponseParams = FCollisionResponseParams::DefaultResponseParam;
+
+  /// If set, trace against these object types instead of Channel.
+  TOptional<FCollisionObjectQueryParams> ObjectQueryParams;
+
+  /// Line traces by default, sweeps for any other shape.
+  FCollisionShape Shape;
+
+  /// If set, the sweeps of this batch share a single broadphase query with
+  /// the other batches of the same group and query channel, usually the
+  /// sensors attached to the same parent, and run in parallel against the
+  /// components it found. Only the hits of blocking components are found,
+  /// as with QueryParams.bIgnoreTouches.
+  const AActor *SharedQueryGroup = nullptr;
+
+  /// Remove the traces and the hits of the previous tick.
+  void Reset(int32 ExpectedTraces = 0)
+  {
+    Starts.Reset(ExpectedTraces);
+    Ends.Reset(ExpectedTraces);
+    Active.Reset(ExpectedTraces);
+    Hits.Reset(ExpectedTraces);
+  }
+
+  /// Add a trace, returns its index.
+  int32 Add(const FVector &Start, const FVector &End)
+  {
+    Ends.Add(End);
+    Active.Add(true);
+    return Starts.Add(Start);
+  }
+
+  /// Resize to @a NumTraces traces that are filled with Set or Skip. Each
+  /// index can be filled from a different thread.
+  void SetNum(int32 NumTraces)
+  {
+    Starts.SetNumUninitialized(NumTraces);
+    Ends.SetNumUninitialized(NumTraces);
+    Active.SetNumUninitialized(NumTraces);
+    Hits.Reset(NumTraces);
+  }
+
+  void Set(int32 Index, const FVector &Start, const FVector &End)
+  {
+    Starts[Index] = Start;
+    Ends[Index] = End;
+    Active[Index] = true;
+  }
+
+  /// Do not trace @a Index, its hit is left empty.
+  void Skip(int32 Index)
+  {
+    Active[Index] = false;
+  }
+
+  bool IsActive(int32 Index) const
+  {
+    return Active[Index];
+  }
+
+  int32 Num() const
+  {
+    return Starts.Num();
+  }
+
+  /// Whether the traces can run on the worker threads of the scheduler.
+  bool IsParallel() const
+  {
+    return Shape.IsLine() && !ObjectQueryParams.IsSet();
+  }
+
+  /// Whether the sweeps share a broadphase query with other batches.
+  bool IsShared() const
+  {
+    return (SharedQueryGroup != nullptr) && !Shape.IsLine();
+  }
+
+  /// Hit of trace @a Index, valid after the scheduler executed the batch.
+  const FHitResult &GetHit(int32 Index) const
+  {
+    return Hits[Index];
+  }
+
+  bool HasHits() const
+  {
+    return Hits.Num() == Starts.Num();
+  }
+
+private:
+
+  friend class FSensorTraceScheduler;
+
+  TArray<FVector> Starts;
+
+  TArray<FVector> Ends;
+
+  TArray<bool> Active;
+
+  TArray<FHitResult> Hits;
+};
+
+/// Runs the traces of all the sensors in a single pass after physics.
+///
+/// The line traces by channel of every batch are split in chunks and traced
+/// by at most GetThreadBudget() tasks while the physics scene is locked for
+/// reading once. Sweeps and traces by object type have no thread-safe
+/// variant, they run afterwards in the game thread.
+///
+/// Shared sweeps are the exception: each group runs one overlap query in the
+/// game thread around all of its sweeps, then every sweep is tested in
+/// parallel only against the components that overlap found.
+///
+/// The thread budget defaults to the task graph workers plus the game thread
+/// and can be set with -SensorTraceThreads=N.
+class FSensorTraceScheduler
+{
+public:
+
+  /// @a Batch must be alive until Execute returns.
+  void Submit(FSensorTraceBatch &Batch);
+
+  void Execute(UWorld *World);
+
+  int32 GetThreadBudget();
+
+  void SetThreadBudget(int32 InThreadBudget);
+
+  /// Traces submitted since the last Execute.
+  int32 GetNumPendingTraces() const;
+
+private:
+
+  struct FSharedSweepGroup;
+
+  /// Broadphase of @a Group in the game thread.
+  static void FindSharedSweepCandidates(UWorld &World, FSharedSweepGroup &Group);
+
+  TArray<FSensorTraceBatch *> Batches;
+
+  /// Read from the command line the first time it is needed, the task graph
+  /// is not running yet when the class default episode is constructed.
+  int32 ThreadBudget = 0;
+};
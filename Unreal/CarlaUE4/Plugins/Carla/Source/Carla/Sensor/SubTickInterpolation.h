@@ -0,0 +1,78 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+
+/// Kinematic state of a sensor at the end of a tick.
+struct FSensorKinematicState
+{
+  /// World location in cm.
+  FVector Location = FVector::ZeroVector;
+
+  /// World velocity in cm/s.
+  FVector Velocity = FVector::ZeroVector;
+
+  FQuat Rotation = FQuat::Identity;
+
+  /// Angular velocity in rad/s, in the frame of the parent actor.
+  FVector AngularVelocity = FVector::ZeroVector;
+};
+
+/// Interpolates the motion of a sensor between two ticks with a cubic
+/// Hermite spline through the locations and velocities of both ends, so
+/// sensors can produce several samples per tick without substepping the
+/// simulation.
+struct FSubTickInterpolation
+{
+  /// Location at @a Alpha in [0, 1] between @a Start and @a End, which are
+  /// @a DeltaTime seconds apart.
+  static FVector GetLocation(
+      const FSensorKinematicState &Start,
+      const FSensorKinematicState &End,
+      const float DeltaTime,
+      const float Alpha)
+  {
+    const float Alpha2 = Alpha * Alpha;
+    const float Alpha3 = Alpha2 * Alpha;
+    // Relative to the start to keep the precision far from the origin
+    return Start.Location +
+        (3.0f * Alpha2 - 2.0f * Alpha3) * (End.Location - Start.Location) +
+        (Alpha3 - 2.0f * Alpha2 + Alpha) * DeltaTime * Start.Velocity +
+        (Alpha3 - Alpha2) * DeltaTime * End.Velocity;
+  }
+
+  /// Acceleration in cm/s^2 at @a Alpha, second derivative of GetLocation.
+  static FVector GetAcceleration(
+      const FSensorKinematicState &Start,
+      const FSensorKinematicState &End,
+      const float DeltaTime,
+      const float Alpha)
+  {
+    return ((6.0f - 12.0f * Alpha) * (End.Location - Start.Location) +
+        (6.0f * Alpha - 4.0f) * DeltaTime * Start.Velocity +
+        (6.0f * Alpha - 2.0f) * DeltaTime * End.Velocity) / (DeltaTime * DeltaTime);
+  }
+
+  /// Velocity in cm/s of the point @a Location of @a Parent, zero if there
+  /// is no parent.
+  static FVector GetVelocityAtLocation(AActor *Parent, const FVector &Location)
+  {
+    if (Parent == nullptr)
+    {
+      return FVector::ZeroVector;
+    }
+    UPrimitiveComponent *Root = Cast<UPrimitiveComponent>(Parent->GetRootComponent());
+    if (Root != nullptr && Root->IsSimulatingPhysics())
+    {
+      return Root->GetPhysicsLinearVelocityAtPoint(Location);
+    }
+    // e.g. walkers, moved by their movement component
+    return Parent->GetVelocity();
+  }
+};
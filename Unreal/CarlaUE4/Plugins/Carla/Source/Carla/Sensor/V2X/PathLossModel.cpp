@@ -7,6 +7,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "Carla.h"
+#include "Carla/Game/CarlaEngine.h"
 #include "Carla/Game/CarlaEpisode.h"
 #include "Math/UnrealMathUtility.h"
 
@@ -17,6 +18,16 @@
 double PathLossModel::Frequency_GHz = 5.9f;
 double PathLossModel::Frequency = 5.9f * std::pow(10, 9);
 double PathLossModel::lambda = PathLossModel::c_speedoflight / (5.9f * std::pow(10, 9));
+std::map<PathLossModel::LinkKey, PathLossModel::FLinkPathState> PathLossModel::mLinkPathStateCache;
+uint64_t PathLossModel::mLinkPathStateCacheFrame = 0u;
+
+namespace PathLossModelConstants
+{
+    // 两端移动小于该距离（cm）时视为静止
+    constexpr float StationaryTolerance = 1.0f;
+    // 静止链路最多重用的帧数，限制其它车辆驶入链路而未被检测到的时间
+    constexpr uint64_t MaxStationaryFrames = 5u;
+}
 
 PathLossModel::PathLossModel(URandomEngine *random_engine)
 {
@@ -146,19 +157,12 @@ float PathLossModel::CalculateReceivedPower(AActor *OtherActor,
     // reference_z in cm
     // distance3d in m
     bool ret = false;
-    FCollisionObjectQueryParams ObjectParams;
-    // Channels to check for collision with different object types
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
-    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
-    HitResult.Reset();
 
     FVector tx = Source;
     tx.Z += ht_local;
     FVector rx = Destination;
     rx.Z += hr_local;
-    mWorld->LineTraceMultiByObjectType(HitResult, tx, rx, ObjectParams);
+    mLinkPathState = &UpdateLinkPathState(OtherActor, tx, rx, reference_z);
 
     // all losses
     float loss = ComputeLoss(OtherActor, Source, Destination, Distance3d, ht, hr, reference_z);
@@ -223,6 +227,60 @@ float PathLossModel::CalculateReceivedPower(AActor *OtherActor,
     }
 }
 
+const PathLossModel::FLinkPathState &PathLossModel::UpdateLinkPathState(AActor *OtherActor,
+                                                                      const FVector &tx,
+                                                                      const FVector &rx,
+                                                                      double reference_z)
+{
+    const uint64_t Frame = FCarlaEngine::GetFrameCounter();
+    if (Frame != mLinkPathStateCacheFrame)
+    {
+        // 新的一帧，移除不能再重用的链路
+        for (auto it = mLinkPathStateCache.begin(); it != mLinkPathStateCache.end();)
+        {
+            if (Frame - it->second.Frame > PathLossModelConstants::MaxStationaryFrames)
+            {
+                it = mLinkPathStateCache.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        mLinkPathStateCacheFrame = Frame;
+    }
+
+    const bool bOwnerFirst = mActorOwner < OtherActor;
+    const LinkKey Key = bOwnerFirst ? LinkKey(mActorOwner, OtherActor) : LinkKey(OtherActor, mActorOwner);
+    const FVector &FirstEnd = bOwnerFirst ? tx : rx;
+    const FVector &SecondEnd = bOwnerFirst ? rx : tx;
+
+    auto Cached = mLinkPathStateCache.find(Key);
+    if (Cached != mLinkPathStateCache.end() &&
+        FVector::Dist(Cached->second.FirstEnd, FirstEnd) < PathLossModelConstants::StationaryTolerance &&
+        FVector::Dist(Cached->second.SecondEnd, SecondEnd) < PathLossModelConstants::StationaryTolerance)
+    {
+        return Cached->second;
+    }
+
+    FCollisionObjectQueryParams ObjectParams;
+    // Channels to check for collision with different object types
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+    HitResult.Reset();
+    mWorld->LineTraceMultiByObjectType(HitResult, tx, rx, ObjectParams);
+
+    FLinkPathState &Link = mLinkPathStateCache[Key];
+    Link.Frame = Frame;
+    Link.FirstEnd = FirstEnd;
+    Link.SecondEnd = SecondEnd;
+    Link.VehicleObstacles.clear();
+    EstimatePathStateAndVehicleObstacles(OtherActor, tx, 0.0, 0.0, reference_z, Link.State, Link.VehicleObstacles);
+    return Link;
+}
+
 void PathLossModel::EstimatePathStateAndVehicleObstacles(AActor *OtherActor,
                                                          FVector CurrentActorLocation,
                                                          double TxHeight,
@@ -333,15 +391,14 @@ float PathLossModel::ComputeLoss(AActor *OtherActor, FVector Source, FVector Des
     // RxHeight in m
     // reference_z in cm
     // distance3d in m
-    EPathState state;
-
     float PathLoss = 0.0;
     double VehicleBlockageLoss = 0.0;
     float ShadowFadingLoss = 0.0;
 
-    // state and vehicle obstacles are call-by-reference
-    std::vector<FVector> vehicle_obstacles;
-    EstimatePathStateAndVehicleObstacles(OtherActor, Source, TxHeight, RxHeight, reference_z, state, vehicle_obstacles);
+    // state and vehicle obstacles of the link set in CalculateReceivedPower
+    check(mLinkPathState != nullptr);
+    const EPathState state = mLinkPathState->State;
+    std::vector<FVector> vehicle_obstacles = mLinkPathState->VehicleObstacles;
 
     if (model == EPathLossModel::Winner)
     {
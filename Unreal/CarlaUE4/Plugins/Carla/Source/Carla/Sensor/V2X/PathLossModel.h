@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <map>
+#include <utility>
 #include <vector>
 
 
@@ -70,6 +72,24 @@ private:
                                  const double reference_z);
     void EstimatePathStateAndVehicleObstacles(AActor *OtherActor, FVector Source, double TxHeight, double RxHeight, double reference_z, EPathState &state, std::vector<FVector> &vehicle_obstacles);
     double MakeVehicleBlockageLoss(double TxHeight, double RxHeight, double obj_height, double obj_distance);
+
+    // 一条链路的传播状态，由发射端到接收端的射线检测得到
+    struct FLinkPathState
+    {
+        uint64_t Frame;
+        // 按 LinkKey 的顺序存放两个端点的天线位置
+        FVector FirstEnd;
+        FVector SecondEnd;
+        EPathState State;
+        std::vector<FVector> VehicleObstacles;
+    };
+    using LinkKey = std::pair<const AActor *, const AActor *>;
+    // 取得 tx 到 rx 的链路状态，可以重用时不再进行射线检测
+    const FLinkPathState &UpdateLinkPathState(AActor *OtherActor, const FVector &tx, const FVector &rx, double reference_z);
+    // 所有 V2X 传感器共用的链路缓存。链路状态视为互易的，同一帧内反方向的链路
+    // 直接重用；两端都静止的链路在几帧内重用
+    static std::map<LinkKey, FLinkPathState> mLinkPathStateCache;
+    static uint64_t mLinkPathStateCacheFrame;
     // 变量
     AActor *mActorOwner;
     UCarlaEpisode *mCarlaEpisode;
@@ -123,4 +143,6 @@ protected:
     // 预计算功能
     void CalculateFSPL_d0();
     TArray<FHitResult> HitResult;
+    // 当前计算的链路状态，由 UpdateLinkPathState 设置
+    const FLinkPathState *mLinkPathState = nullptr;
 };
@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/VehicleTelemetrySensor.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Actor/ActorRegistry.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/VehicleTelemetryData.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/rpc/VehicleTelemetryData.h"
+#include <compiler/enable-ue4-macros.h>
+
+FActorDefinition AVehicleTelemetrySensor::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeVehicleTelemetrySensorDefinition();
+}
+
+AVehicleTelemetrySensor::AVehicleTelemetrySensor(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+}
+
+void AVehicleTelemetrySensor::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  // Meters to centimeters.
+  MaxDistance = FMath::Max(UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat(
+      "max_distance",
+      Description.Variations,
+      MaxDistance / 100.0f), 0.0f) * 100.0f;
+  VehicleRoleName = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "vehicle_role_name",
+      Description.Variations,
+      VehicleRoleName);
+}
+
+bool AVehicleTelemetrySensor::IsSelected(const FCarlaActor &View, const FVector &SensorLocation) const
+{
+  if (View.GetActorType() != FCarlaActor::ActorType::Vehicle || View.IsDormant())
+  {
+    return false;
+  }
+  const AActor *Actor = View.GetActor();
+  if (Actor == nullptr)
+  {
+    return false;
+  }
+  if (MaxDistance > 0.0f &&
+      FVector::DistSquared(Actor->GetActorLocation(), SensorLocation) > FMath::Square(MaxDistance))
+  {
+    return false;
+  }
+  if (!VehicleRoleName.IsEmpty())
+  {
+    const FActorAttribute *Role = View.GetActorInfo()->Description.Variations.Find("role_name");
+    if (Role == nullptr || Role->Value != VehicleRoleName)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AVehicleTelemetrySensor::WriteVehicle(FCarlaActor &View)
+{
+  FVehicleTelemetryData Telemetry;
+  if (View.GetVehicleTelemetryData(Telemetry) == ECarlaServerResponse::Success)
+  {
+    TelemetryData.WriteVehicle(View.GetActorId(), carla::rpc::VehicleTelemetryData(Telemetry));
+  }
+}
+
+void AVehicleTelemetrySensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AVehicleTelemetrySensor::PostPhysTick);
+  if (!IsStreamReady())
+  {
+    return;
+  }
+
+  // The wheel states are read from the physics scene, after this tick's
+  // simulation step.
+  TelemetryData.Reset();
+  const UCarlaEpisode &Episode = GetEpisode();
+  AActor *Parent = GetAttachParentActor();
+  FCarlaActor *ParentView = Parent != nullptr ? Episode.FindCarlaActor(Parent) : nullptr;
+  if (ParentView != nullptr && ParentView->GetActorType() == FCarlaActor::ActorType::Vehicle)
+  {
+    if (!ParentView->IsDormant())
+    {
+      WriteVehicle(*ParentView);
+    }
+  }
+  else
+  {
+    const FVector SensorLocation = GetActorLocation();
+    for (const auto &Pair : Episode.GetActorRegistry())
+    {
+      FCarlaActor *View = Pair.Value.Get();
+      if (View != nullptr && IsSelected(*View, SensorLocation))
+      {
+        WriteVehicle(*View);
+      }
+    }
+  }
+
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
+    auto DataStream = GetDataStream(*this);
+    DataStream.SerializeAndSend(*this, TelemetryData, DataStream.PopBufferFromPool());
+  }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Actor/ActorDescription.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/TelemetryData.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "VehicleTelemetrySensor.generated.h"
+
+class FCarlaActor;
+
+/// Publishes the telemetry of vehicles (speed, controls, engine RPM, gear,
+/// drag and the slip, load and forces of each wheel) in a single message per
+/// tick. Attached to a vehicle it reports only that vehicle, otherwise all the
+/// vehicles selected by its attributes.
+UCLASS()
+class CARLA_API AVehicleTelemetrySensor : public ASensor
+{
+  GENERATED_BODY()
+
+  using FTelemetryData = carla::sensor::data::TelemetryData;
+
+public:
+
+  static FActorDefinition GetSensorDefinition();
+
+  AVehicleTelemetrySensor(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &Description) override;
+
+  float GetTickCostEstimate(float TickSeconds) const override
+  {
+    return 1.0f + 1e-2f * TelemetryData.GetVehicleCount();
+  }
+
+protected:
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+private:
+
+  /// Whether the telemetry of @a View is part of the message, always true for
+  /// the parent vehicle.
+  bool IsSelected(const FCarlaActor &View, const FVector &SensorLocation) const;
+
+  void WriteVehicle(FCarlaActor &View);
+
+  /// Only vehicles closer than this distance (cm), 0 means all vehicles.
+  float MaxDistance = 0.0f;
+
+  /// Only vehicles with this role name, empty means all vehicles.
+  FString VehicleRoleName;
+
+  FTelemetryData TelemetryData;
+};
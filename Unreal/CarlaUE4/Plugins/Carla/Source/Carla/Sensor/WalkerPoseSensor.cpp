@@ -0,0 +1,126 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Sensor/WalkerPoseSensor.h"
+
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Actor/ActorRegistry.h"
+#include "Carla/Game/CarlaEpisode.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/SkeletalMeshComponent.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/geom/Transform.h"
+#include <compiler/enable-ue4-macros.h>
+
+FActorDefinition AWalkerPoseSensor::GetSensorDefinition()
+{
+  return UActorBlueprintFunctionLibrary::MakeWalkerPoseSensorDefinition();
+}
+
+AWalkerPoseSensor::AWalkerPoseSensor(const FObjectInitializer &ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  PrimaryActorTick.bCanEverTick = true;
+}
+
+void AWalkerPoseSensor::Set(const FActorDescription &Description)
+{
+  Super::Set(Description);
+  // Meters to centimeters.
+  MaxDistance = FMath::Max(UActorBlueprintFunctionLibrary::RetrieveActorAttributeToFloat(
+      "max_distance",
+      Description.Variations,
+      MaxDistance / 100.0f), 0.0f) * 100.0f;
+  WalkerRoleName = UActorBlueprintFunctionLibrary::RetrieveActorAttributeToString(
+      "walker_role_name",
+      Description.Variations,
+      WalkerRoleName);
+}
+
+void AWalkerPoseSensor::GatherWalkers()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AWalkerPoseSensor::GatherWalkers);
+  SkeletalMeshes.Reset();
+  Walkers.clear();
+
+  const FVector SensorLocation = GetActorLocation();
+  const float MaxDistanceSquared = FMath::Square(MaxDistance);
+  TArray<USkeletalMeshComponent *> Components;
+  for (const auto &Pair : GetEpisode().GetActorRegistry())
+  {
+    const FCarlaActor *View = Pair.Value.Get();
+    if (View == nullptr || View->GetActorType() != FCarlaActor::ActorType::Walker)
+    {
+      continue;
+    }
+    AActor *Actor = View->GetActor();
+    if (Actor == nullptr)
+    {
+      // Dormant walkers have no pose.
+      continue;
+    }
+    if (MaxDistance > 0.0f &&
+        FVector::DistSquared(Actor->GetActorLocation(), SensorLocation) > MaxDistanceSquared)
+    {
+      continue;
+    }
+    if (!WalkerRoleName.IsEmpty())
+    {
+      const FActorAttribute *Role = View->GetActorInfo()->Description.Variations.Find("role_name");
+      if (Role == nullptr || Role->Value != WalkerRoleName)
+      {
+        continue;
+      }
+    }
+    // The same mesh as AWalkerController::GetBonesTransform, so the bones are
+    // in the same order.
+    Actor->GetComponents<USkeletalMeshComponent>(Components, false);
+    USkeletalMeshComponent *SkeletalMesh = Components.IsValidIndex(0) ? Components[0] : nullptr;
+    if (SkeletalMesh == nullptr)
+    {
+      continue;
+    }
+    SkeletalMeshes.Add(SkeletalMesh);
+    Walkers.emplace_back(View->GetActorId(), static_cast<uint32_t>(FMath::Max(SkeletalMesh->GetNumBones(), 0)));
+  }
+}
+
+void AWalkerPoseSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AWalkerPoseSensor::PostPhysTick);
+  if (!IsStreamReady())
+  {
+    return;
+  }
+
+  GatherWalkers();
+  PoseData.SetWalkers(Walkers);
+  LastWalkerCount = SkeletalMeshes.Num();
+
+  // Each task only reads the pose of its own mesh and writes its own bones.
+  ParallelFor(SkeletalMeshes.Num(), [&](int32 Index)
+  {
+    const USkeletalMeshComponent *SkeletalMesh = SkeletalMeshes[Index];
+    carla::sensor::data::WalkerBonePose *Bones = PoseData.GetBones(Index);
+    const int32 NumBones = static_cast<int32>(Walkers[Index].second);
+    for (int32 Bone = 0; Bone < NumBones; ++Bone)
+    {
+      const carla::geom::Transform Transform = SkeletalMesh->GetBoneTransform(Bone);
+      Bones[Bone] = {
+          Transform.location.x, Transform.location.y, Transform.location.z,
+          Transform.rotation.pitch, Transform.rotation.yaw, Transform.rotation.roll};
+    }
+  }, SkeletalMeshes.Num() < 2);
+
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Send Stream");
+    auto DataStream = GetDataStream(*this);
+    DataStream.SerializeAndSend(*this, PoseData, DataStream.PopBufferFromPool());
+  }
+}
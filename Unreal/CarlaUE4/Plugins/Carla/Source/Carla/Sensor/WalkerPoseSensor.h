@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Sensor/Sensor.h"
+
+#include "Carla/Actor/ActorDefinition.h"
+#include "Carla/Actor/ActorDescription.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/WalkerPoseData.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include "WalkerPoseSensor.generated.h"
+
+class USkeletalMeshComponent;
+
+/// Publishes the world transform of every bone of all the walkers, or of the
+/// walkers selected by its attributes, in a single message per tick. The
+/// bones of each walker are in the order returned by get_bones.
+UCLASS()
+class CARLA_API AWalkerPoseSensor : public ASensor
+{
+  GENERATED_BODY()
+
+  using FWalkerPoseData = carla::sensor::data::WalkerPoseData;
+
+public:
+
+  static FActorDefinition GetSensorDefinition();
+
+  AWalkerPoseSensor(const FObjectInitializer &ObjectInitializer);
+
+  void Set(const FActorDescription &Description) override;
+
+  float GetTickCostEstimate(float TickSeconds) const override
+  {
+    return 1.0f + 1e-2f * LastWalkerCount;
+  }
+
+protected:
+
+  virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) override;
+
+private:
+
+  /// Collect the skeletal meshes of the selected walkers, on the game thread.
+  void GatherWalkers();
+
+  /// Only walkers closer than this distance (cm), 0 means all walkers.
+  float MaxDistance = 0.0f;
+
+  /// Only walkers with this role name, empty means all walkers.
+  FString WalkerRoleName;
+
+  TArray<USkeletalMeshComponent *> SkeletalMeshes;
+
+  /// Actor id and number of bones of each entry of SkeletalMeshes.
+  std::vector<std::pair<uint32_t, uint32_t>> Walkers;
+
+  FWalkerPoseData PoseData;
+
+  int32 LastWalkerCount = 0;
+};
@@ -19,10 +19,13 @@
 #include "Carla/Traffic/SignComponent.h"
 #include "Carla/Walker/WalkerController.h"
 
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "CoreGlobals.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/rpc/String.h>
+#include <carla/rpc/VehicleLightState.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/data/ActorDynamicState.h>
 #include <compiler/enable-ue4-macros.h>
@@ -67,6 +70,8 @@ static auto FWorldObserver_GetActorState(const FCarlaActor &View, const FActorRe
       // Get the failure state by checking the rollover one as it is the only one currently implemented.
       // This will have to be expanded once more states are added
       state.vehicle_data.failure_state = Vehicle->GetFailureState();
+      state.vehicle_data.light_state =
+          carla::rpc::VehicleLightState(Vehicle->GetVehicleLightState()).GetLightStateAsValue();
     }
   }
 
@@ -265,22 +270,179 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
-static carla::Buffer FWorldObserver_Serialize(
-    carla::Buffer &&buffer,
+static carla::sensor::data::ActorDynamicState FWorldObserver_GetActorDynamicState(
+    const FCarlaActor &View,
+    const FActorRegistry &Registry,
+    float DeltaSeconds)
+{
+  constexpr float TO_METERS = 1e-2;
+
+  FTransform ActorTransform;
+  FVector Velocity(0.0f);
+  carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
+  carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
+  carla::sensor::data::ActorDynamicState::TypeDependentState State{};
+
+  if(View.IsDormant())
+  {
+    const FActorData* ActorData = View.GetActorData();
+    Velocity = TO_METERS * ActorData->Velocity;
+    AngularVelocity = carla::geom::Vector3D
+                      {ActorData->AngularVelocity.X,
+                       ActorData->AngularVelocity.Y,
+                       ActorData->AngularVelocity.Z};
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetDormantActorState(View, Registry);
+  }
+  else
+  {
+    Velocity = TO_METERS * View.GetActor()->GetVelocity();
+    AngularVelocity = FWorldObserver_GetAngularVelocity(*View.GetActor());
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetActorState(View, Registry);
+  }
+  ActorTransform = View.GetActorGlobalTransform();
+
+  return {
+    View.GetActorId(),
+    View.GetActorState(),
+    carla::geom::Transform(ActorTransform),
+    carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
+    AngularVelocity,
+    Acceleration,
+    State,
+  };
+}
+
+/// Number of actors gathered by each task of the ParallelFor.
+static constexpr int32 WORLD_OBSERVER_ACTORS_PER_BLOCK = 64;
+
+/// Everything a message needs, copied out of the episode on the game thread so
+/// that the serialization can run on a worker thread.
+struct FWorldObserver_Snapshot
+{
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+
+  /// The states of every actor, in the order they are serialized.
+  TArray<ActorDynamicState> States;
+
+  uint64 EpisodeId = 0u;
+
+  uint64 Frame = 0u;
+
+  double PlatformTimestamp = 0.0;
+
+  float DeltaSeconds = 0.0f;
+
+  FIntVector MapOriginInMeters;
+
+  bool MapChange = false;
+
+  bool PendingLightUpdates = false;
+};
+
+static void FWorldObserver_GatherStates(
     const UCarlaEpisode &Episode,
     float DeltaSeconds,
-    bool MapChange,
-    bool PendingLightUpdates)
+    TArray<carla::sensor::data::ActorDynamicState> &States)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  const FActorRegistry &Registry = Episode.GetActorRegistry();
+
+  // The registry is not modified while gathering, each task only reads its
+  // own actors and writes their previous velocity and their slot of States.
+  TArray<const FCarlaActor *> Views;
+  Views.Reserve(Registry.Num());
+  for (auto& It : Registry)
+  {
+    const FCarlaActor* View = It.Value.Get();
+    check(View);
+    Views.Add(View);
+  }
+
+  States.SetNumUninitialized(Views.Num());
+  const int32 NumBlocks =
+      FMath::DivideAndRoundUp(Views.Num(), WORLD_OBSERVER_ACTORS_PER_BLOCK);
+  ParallelFor(NumBlocks, [&](int32 Block)
+  {
+    const int32 Begin = Block * WORLD_OBSERVER_ACTORS_PER_BLOCK;
+    const int32 End = FMath::Min(Begin + WORLD_OBSERVER_ACTORS_PER_BLOCK, Views.Num());
+    for (int32 Index = Begin; Index < End; ++Index)
+    {
+      States[Index] = FWorldObserver_GetActorDynamicState(*Views[Index], Registry, DeltaSeconds);
+    }
+  }, NumBlocks < 2);
+}
+
+static carla::Buffer FWorldObserver_Serialize(
+    carla::Buffer &&buffer,
+    const FWorldObserver_Snapshot &Snapshot,
+    FWorldObserver::FDeltaEncoding &Delta)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
   using SimulationState = carla::sensor::s11n::EpisodeStateSerializer::SimulationState;
   using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+  using ActorId = carla::rpc::ActorId;
+
+  const TArray<ActorDynamicState> &States = Snapshot.States;
+  const bool MapChange = Snapshot.MapChange;
+
+  // A delta is only valid if the clients can have the previous message, so a
+  // keyframe is sent periodically and every time the map or episode changes.
+  const uint64 Frame = Snapshot.Frame;
+  const bool bIsDelta =
+      Delta.IsEnabled() &&
+      !MapChange &&
+      (Delta.EpisodeId == Snapshot.EpisodeId) &&
+      (Delta.MessagesSinceKeyframe > 0u) &&
+      (Delta.MessagesSinceKeyframe < Delta.KeyframeInterval);
+
+  TArray<const ActorDynamicState*> ChangedStates;
+  TArray<ActorId> RemovedActors;
+  if (bIsDelta)
+  {
+    TSet<ActorId> PresentActors;
+    PresentActors.Reserve(States.Num());
+    for (const ActorDynamicState &State : States)
+    {
+      PresentActors.Add(State.id);
+      ActorDynamicState *LastSent = Delta.LastSentStates.Find(State.id);
+      if (LastSent == nullptr || Serializer::HasChanged(*LastSent, State, Delta.Epsilon))
+      {
+        ChangedStates.Add(&State);
+        Delta.LastSentStates.Add(State.id, State);
+      }
+    }
+    for (auto It = Delta.LastSentStates.CreateIterator(); It; ++It)
+    {
+      if (!PresentActors.Contains(It.Key()))
+      {
+        RemovedActors.Add(It.Key());
+        It.RemoveCurrent();
+      }
+    }
+  }
+  else
+  {
+    for (const ActorDynamicState &State : States)
+    {
+      ChangedStates.Add(&State);
+    }
+    if (Delta.IsEnabled())
+    {
+      Delta.LastSentStates.Reset();
+      for (const ActorDynamicState &State : States)
+      {
+        Delta.LastSentStates.Add(State.id, State);
+      }
+    }
+  }
 
-
-  const FActorRegistry &Registry = Episode.GetActorRegistry();
-
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
+  auto total_size =
+      sizeof(Serializer::Header) +
+      (bIsDelta ? sizeof(Serializer::DeltaHeader) + sizeof(ActorId) * RemovedActors.Num() : 0u) +
+      sizeof(ActorDynamicState) * ChangedStates.Num();
   auto current_size = 0;
   // Set up buffer for writing.
   buffer.reset(total_size);
@@ -291,69 +453,45 @@ static carla::Buffer FWorldObserver_Serialize(
     current_size += sizeof(data);
   };
 
-  constexpr float TO_METERS = 1e-2;
-
   // Write header.
   Serializer::Header header;
-  header.episode_id = Episode.GetId();
-  header.platform_timestamp = FPlatformTime::Seconds();
-  header.delta_seconds = DeltaSeconds;
-  FIntVector MapOrigin = Episode.GetCurrentMapOrigin();
-  FIntVector MapOriginInMeters = MapOrigin / 100;
+  header.episode_id = Snapshot.EpisodeId;
+  header.platform_timestamp = Snapshot.PlatformTimestamp;
+  header.delta_seconds = Snapshot.DeltaSeconds;
+  const FIntVector &MapOriginInMeters = Snapshot.MapOriginInMeters;
   header.map_origin = carla::geom::Vector3DInt{ MapOriginInMeters.X, MapOriginInMeters.Y, MapOriginInMeters.Z };
 
   uint8_t simulation_state = (SimulationState::MapChange * MapChange);
-  simulation_state |= (SimulationState::PendingLightUpdate * PendingLightUpdates);
+  simulation_state |= (SimulationState::PendingLightUpdate * Snapshot.PendingLightUpdates);
+  simulation_state |= (SimulationState::Delta * bIsDelta);
 
   header.simulation_state = static_cast<SimulationState>(simulation_state);
 
   write_data(header);
 
-  // Write every actor.
-  for (auto& It : Registry)
+  if (bIsDelta)
   {
-    const FCarlaActor* View = It.Value.Get();
-    const FActorInfo* ActorInfo = View->GetActorInfo();
-
-    FTransform ActorTransform;
-    FVector Velocity(0.0f);
-    carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
-    carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
-    carla::sensor::data::ActorDynamicState::TypeDependentState State{};
-
-
-    check(View);
-
-    if(View->IsDormant())
-    {
-      const FActorData* ActorData = View->GetActorData();
-      Velocity = TO_METERS * ActorData->Velocity;
-      AngularVelocity = carla::geom::Vector3D
-                        {ActorData->AngularVelocity.X,
-                         ActorData->AngularVelocity.Y,
-                         ActorData->AngularVelocity.Z};
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetDormantActorState(*View, Registry);
-    }
-    else
+    Serializer::DeltaHeader delta_header;
+    delta_header.base_frame = Delta.LastFrame;
+    delta_header.number_of_removed_actors = static_cast<uint32_t>(RemovedActors.Num());
+    write_data(delta_header);
+    for (ActorId Id : RemovedActors)
     {
-      Velocity = TO_METERS * View->GetActor()->GetVelocity();
-      AngularVelocity = FWorldObserver_GetAngularVelocity(*View->GetActor());
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetActorState(*View, Registry);
+      write_data(Id);
     }
-    ActorTransform = View->GetActorGlobalTransform();
-
-    ActorDynamicState info = {
-      View->GetActorId(),
-      View->GetActorState(),
-      carla::geom::Transform(ActorTransform),
-      carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
-      AngularVelocity,
-      Acceleration,
-      State,
-    };
-    write_data(info);
+  }
+
+  // Write every actor.
+  for (const ActorDynamicState *State : ChangedStates)
+  {
+    write_data(*State);
+  }
+
+  if (Delta.IsEnabled())
+  {
+    Delta.EpisodeId = Snapshot.EpisodeId;
+    Delta.LastFrame = Frame;
+    Delta.MessagesSinceKeyframe = bIsDelta ? Delta.MessagesSinceKeyframe + 1u : 1u;
   }
 
   // Shrink buffer
@@ -372,17 +510,46 @@ void FWorldObserver::BroadcastTick(
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 
+  // The previous message uses the delta encoding state and has to be sent
+  // before this one.
+  WaitForPendingSend();
+
   if (!Stream.IsStreamReady())
     return;
 
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
-  carla::Buffer buffer = FWorldObserver_Serialize(
-      AsyncStream.PopBufferFromPool(),
-      Episode,
-      DeltaSecond,
-      MapChange,
-      PendingLightUpdates);
+  FWorldObserver_Snapshot Snapshot;
+  FWorldObserver_GatherStates(Episode, DeltaSecond, Snapshot.States);
+  Snapshot.EpisodeId = Episode.GetId();
+  Snapshot.Frame = FCarlaEngine::GetFrameCounter();
+  Snapshot.PlatformTimestamp = FPlatformTime::Seconds();
+  Snapshot.DeltaSeconds = DeltaSecond;
+  Snapshot.MapOriginInMeters = Episode.GetCurrentMapOrigin() / 100;
+  Snapshot.MapChange = MapChange;
+  Snapshot.PendingLightUpdates = PendingLightUpdates;
+
+  carla::Buffer Buffer = AsyncStream.PopBufferFromPool();
+
+  // Serialize and send on a worker thread, the game thread does not wait for
+  // it unless the next message is ready before.
+  PendingSend = Async(EAsyncExecution::ThreadPool,
+      [this,
+       AsyncStream = std::move(AsyncStream),
+       Buffer = std::move(Buffer),
+       Snapshot = std::move(Snapshot)]() mutable
+  {
+    carla::Buffer buffer = FWorldObserver_Serialize(std::move(Buffer), Snapshot, Delta);
+    AsyncStream.SerializeAndSend(*this, std::move(buffer));
+  });
+}
 
-  AsyncStream.SerializeAndSend(*this, std::move(buffer));
+void FWorldObserver::WaitForPendingSend()
+{
+  if (PendingSend.IsValid())
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+    PendingSend.Wait();
+    PendingSend.Reset();
+  }
 }
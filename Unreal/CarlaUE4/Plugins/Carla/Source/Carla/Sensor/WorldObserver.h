@@ -8,9 +8,19 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include "Async/Future.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <compiler/enable-ue4-macros.h>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
+///
+/// The states of the actors are gathered in parallel on the game thread, the
+/// message is serialized and sent on a worker thread.
 class FWorldObserver
 {
 public:
@@ -18,12 +28,30 @@ public:
   /// Prevent this sensor to be spawned by users.
   using not_spawnable = void;
 
+  ~FWorldObserver()
+  {
+    WaitForPendingSend();
+  }
+
   /// Replace the Stream associated with this sensor.
   void SetStream(FDataMultiStream InStream)
   {
+    WaitForPendingSend();
     Stream = std::move(InStream);
   }
 
+  /// Enable delta encoding of the episode state. Only the actors that changed
+  /// more than @a Epsilon since the previous message, and the ids of the
+  /// destroyed ones, are sent; every @a KeyframeInterval messages a full state
+  /// is sent instead. A @a KeyframeInterval of 0 disables delta encoding.
+  void SetDeltaEncoding(uint32 KeyframeInterval, float Epsilon)
+  {
+    WaitForPendingSend();
+    Delta = FDeltaEncoding{};
+    Delta.KeyframeInterval = KeyframeInterval;
+    Delta.Epsilon = Epsilon;
+  }
+
   /// Return the token that allows subscribing to this sensor's stream.
   auto GetToken() const
   {
@@ -44,7 +72,36 @@ public:
     return {};
   }
 
+  /// State kept between messages to compute the deltas.
+  struct FDeltaEncoding
+  {
+    bool IsEnabled() const
+    {
+      return KeyframeInterval > 0u;
+    }
+
+    uint32 KeyframeInterval = 0u;
+
+    float Epsilon = 1e-3f;
+
+    uint32 MessagesSinceKeyframe = 0u;
+
+    uint64 EpisodeId = 0u;
+
+    uint64 LastFrame = 0u;
+
+    TMap<carla::rpc::ActorId, carla::sensor::data::ActorDynamicState> LastSentStates;
+  };
+
 private:
 
+  /// Block until the message of the previous tick has been sent.
+  void WaitForPendingSend();
+
   FDataMultiStream Stream;
+
+  FDeltaEncoding Delta;
+
+  /// Serialization of the previous tick, only accessed by the game thread.
+  TFuture<void> PendingSend;
 };
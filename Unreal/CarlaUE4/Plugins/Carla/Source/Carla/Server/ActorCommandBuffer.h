@@ -0,0 +1,225 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/ActorId.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/// 按 actor id 直接索引的命令缓冲区，用于车辆控制和行人状态。
+///
+/// RPC 线程不加锁地写入命令，游戏线程在物理之前统一应用一次，同一个参与者只保留
+/// 最后写入的命令。槽位按块分配，块在第一次写入时通过 CAS 创建，直到缓冲区销毁才
+/// 释放。每个槽位用一个序列锁保护：写入方把序号从偶数改为奇数后写入数据再改回偶数，
+/// 读取方只接受前后序号相同且为偶数时读到的数据。
+template <typename ValueT>
+class TActorCommandBuffer
+{
+public:
+
+  using IdType = carla::rpc::ActorId;
+
+  TActorCommandBuffer()
+  {
+    for (auto &Chunk : Chunks)
+    {
+      Chunk.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~TActorCommandBuffer()
+  {
+    for (auto &Chunk : Chunks)
+    {
+      delete Chunk.load(std::memory_order_acquire);
+    }
+  }
+
+  TActorCommandBuffer(const TActorCommandBuffer &) = delete;
+
+  TActorCommandBuffer &operator=(const TActorCommandBuffer &) = delete;
+
+  /// 缓冲区是否能保存 @a ActorId 的命令。
+  static bool IsInRange(IdType ActorId)
+  {
+    return (ActorId >> ChunkBits) < MaxChunks;
+  }
+
+  /// 线程安全。id 超出容量时不写入并返回 false。
+  bool Write(IdType ActorId, const ValueT &Value)
+  {
+    const uint32 ChunkIndex = ActorId >> ChunkBits;
+    if (ChunkIndex >= MaxChunks)
+    {
+      return false;
+    }
+    FChunk *Chunk = GetOrCreateChunk(ChunkIndex);
+    const uint32 SlotIndex = ActorId & (ChunkSize - 1u);
+    FSlot &Slot = Chunk->Slots[SlotIndex];
+
+    // 只有两个客户端同时控制同一个参与者时才会在这里等待
+    uint32 Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      if ((Sequence & 1u) != 0u)
+      {
+        Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+      }
+      else if (Slot.Sequence.compare_exchange_weak(
+          Sequence,
+          Sequence + 1u,
+          std::memory_order_acquire,
+          std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&Slot.Value, &Value, sizeof(Value));
+    Slot.Sequence.store(Sequence + 2u, std::memory_order_release);
+
+    Chunk->DirtyWords[SlotIndex / 64u].fetch_or(uint64(1u) << (SlotIndex % 64u), std::memory_order_release);
+    Chunk->bDirty.store(true, std::memory_order_release);
+    return true;
+  }
+
+  /// 对上次调用以来写入过的每个参与者调用一次 Callback(ActorId, Value)。
+  ///
+  /// @warning 同一时间只能有一个线程调用，一般是游戏线程。
+  template <typename FunctorT>
+  void Consume(FunctorT &&Callback)
+  {
+    const uint32 Num = NumChunks.load(std::memory_order_acquire);
+    for (uint32 ChunkIndex = 0u; ChunkIndex < Num; ++ChunkIndex)
+    {
+      FChunk *Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire);
+      // 先清除块的标记再清除槽位的标记，写入方的顺序相反，不会丢失写入
+      if (Chunk == nullptr || !Chunk->bDirty.exchange(false, std::memory_order_acq_rel))
+      {
+        continue;
+      }
+      for (uint32 Word = 0u; Word < WordsPerChunk; ++Word)
+      {
+        uint64 Bits = Chunk->DirtyWords[Word].exchange(0u, std::memory_order_acq_rel);
+        while (Bits != 0u)
+        {
+          const uint32 SlotIndex = Word * 64u + static_cast<uint32>(FMath::CountTrailingZeros64(Bits));
+          Bits &= Bits - 1u;
+          ValueT Value;
+          Read(Chunk->Slots[SlotIndex], Value);
+          Callback(static_cast<IdType>((ChunkIndex << ChunkBits) | SlotIndex), Value);
+        }
+      }
+    }
+  }
+
+  /// 丢弃所有未应用的命令。
+  void Discard()
+  {
+    Consume([](IdType, const ValueT &) {});
+  }
+
+private:
+
+  static_assert(std::is_trivially_copyable<ValueT>::value,
+      "The slots are copied byte by byte");
+
+  static constexpr uint32 ChunkBits = 10u;
+
+  static constexpr uint32 ChunkSize = 1u << ChunkBits;
+
+  /// 最多 4M 个 id，只分配用到的块
+  static constexpr uint32 MaxChunks = 4096u;
+
+  static constexpr uint32 WordsPerChunk = ChunkSize / 64u;
+
+  struct FSlot
+  {
+    /// 奇数表示正在写入
+    std::atomic<uint32> Sequence { 0u };
+
+    ValueT Value;
+  };
+
+  struct FChunk
+  {
+    FChunk()
+    {
+      for (auto &Word : DirtyWords)
+      {
+        Word.store(0u, std::memory_order_relaxed);
+      }
+    }
+
+    FSlot Slots[ChunkSize];
+
+    /// 每个槽位一位，表示写入后还没有被应用
+    std::atomic<uint64> DirtyWords[WordsPerChunk];
+
+    /// 块中是否有标记的槽位，没有写入的块不用扫描
+    std::atomic<bool> bDirty { false };
+  };
+
+  static void Read(const FSlot &Slot, ValueT &OutValue)
+  {
+    for (;;)
+    {
+      const uint32 Before = Slot.Sequence.load(std::memory_order_acquire);
+      if ((Before & 1u) != 0u)
+      {
+        // 写入只需要几十纳秒
+        continue;
+      }
+      std::memcpy(&OutValue, &Slot.Value, sizeof(OutValue));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (Slot.Sequence.load(std::memory_order_relaxed) == Before)
+      {
+        return;
+      }
+    }
+  }
+
+  FChunk *GetOrCreateChunk(uint32 ChunkIndex)
+  {
+    FChunk *Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire);
+    if (Chunk != nullptr)
+    {
+      return Chunk;
+    }
+    FChunk *NewChunk = new FChunk();
+    if (Chunks[ChunkIndex].compare_exchange_strong(
+        Chunk,
+        NewChunk,
+        std::memory_order_acq_rel,
+        std::memory_order_acquire))
+    {
+      Chunk = NewChunk;
+    }
+    else
+    {
+      // 另一个线程先创建了这个块
+      delete NewChunk;
+    }
+    uint32 Num = NumChunks.load(std::memory_order_relaxed);
+    while (Num < ChunkIndex + 1u &&
+           !NumChunks.compare_exchange_weak(Num, ChunkIndex + 1u, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return Chunk;
+  }
+
+  std::atomic<FChunk *> Chunks[MaxChunks];
+
+  /// 已分配的最大块下标加一，Consume 只扫描到这里
+  std::atomic<uint32> NumChunks { 0u };
+};
@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Server/CarlaServer.h"
 #include "Carla/Server/CarlaServerResponse.h"
+#include "Carla/Server/ActorCommandBuffer.h"
 #include "Carla/Traffic/TrafficLightGroup.h"
 #include "EngineUtils.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -23,18 +24,22 @@
 #include "Carla/Sensor/CustomV2XSensor.h"
 #include "Carla/Walker/WalkerController.h"
 #include "Carla/Walker/WalkerBase.h"
+#include "Carla/Walker/WalkerStateBatch.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Carla/Game/Tagger.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "Carla/Vehicle/MovementComponents/CarSimManagerComponent.h"
 #include "Carla/Vehicle/MovementComponents/ChronoMovementComponent.h"
 #include "Carla/Lights/CarlaLightSubsystem.h"
+#include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 #include "Carla/Actor/ActorData.h"
 #include "CarlaServerResponse.h"
 #include "Carla/Util/BoundingBoxCalculator.h"
 #include "Misc/FileHelper.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/AsyncLogger.h>
+#include <carla/ContentHash.h>
 #include <carla/Functional.h>
 #include <carla/multigpu/router.h>
 #include <carla/Version.h>
@@ -42,6 +47,9 @@
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/ActorDefinition.h>
 #include <carla/rpc/ActorDescription.h>
+#include <carla/rpc/ActorQuery.h>
+#include <carla/rpc/ActorQueryResult.h>
+#include <carla/rpc/ActorSpawnBatch.h>
 #include <carla/rpc/BoneTransformDataIn.h>
 #include <carla/rpc/Command.h>
 #include <carla/rpc/CommandResponse.h>
@@ -49,12 +57,16 @@
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/EpisodeInfo.h>
 #include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/FileInfo.h>
+#include <carla/rpc/FrameTimings.h>
 #include <carla/rpc/LabelledPoint.h>
 #include <carla/rpc/LightState.h>
 #include <carla/rpc/MapInfo.h>
 #include <carla/rpc/MapLayer.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/SensorTickPlan.h>
 #include <carla/rpc/Server.h>
+#include <carla/rpc/StreamStatistics.h>
 #include <carla/rpc/String.h>
 #include <carla/rpc/Transform.h>
 #include <carla/rpc/Vector2D.h>
@@ -69,16 +81,25 @@
 #include <carla/rpc/WalkerBoneControlIn.h>
 #include <carla/rpc/WalkerBoneControlOut.h>
 #include <carla/rpc/WalkerControl.h>
+#include <carla/rpc/WalkerStates.h>
 #include <carla/rpc/VehicleWheels.h>
 #include <carla/rpc/WeatherParameters.h>
+#include <carla/streaming/detail/Token.h>
 #include <carla/streaming/detail/Types.h>
+#include <carla/streaming/detail/udp/Protocol.h>
+#include <carla/TaskScheduler.h>
+#include <carla/profiler/MetricsServer.h>
+#include <carla/ThreadSettings.h>
 #include <carla/rpc/Texture.h>
 #include <carla/rpc/MaterialParameter.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <algorithm>
 #include <vector>
 #include <atomic>
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <tuple>
 
 template <typename T>
@@ -129,12 +150,153 @@ public:
 
   carla::streaming::Stream BroadcastStream;
 
+  /// 是否设置了组播组，传感器流可以通过组播发送
+  bool bIsMulticastAvailable = false;
+
+  /// EpisodeState 流是否通过组播发送
+  bool bIsEpisodeStateMulticast = false;
+
   std::shared_ptr<carla::multigpu::Router> SecondaryServer;
 
   UCarlaEpisode *Episode = nullptr;
 
   std::atomic_size_t TickCuesReceived { 0u };  // 收到的节拍提示
 
+  /// 以 -MetricsPort= 启动时提供 Prometheus 拉取接口
+  std::unique_ptr<carla::profiler::MetricsServer> MetricsServer;
+
+  FDebugShapeGroups DebugShapeGroups;
+
+  /// 保留的帧时间记录的数量
+  static constexpr size_t MaxFrameTimings = 1000u;
+
+  /// 最近几帧各阶段的时间，按帧号升序排列
+  std::deque<carla::rpc::FrameTimings> FrameTimings;
+
+  /// 同步模式下参与节拍屏障的客户端
+  struct FTickParticipant
+  {
+    std::string Name;
+
+    /// 大于 0 时，等待超过该时间（秒）后不再等待此客户端
+    double DeadlineSeconds = 0.0;
+
+    /// 此客户端已处理完的最后一帧
+    uint64_t LastReadyFrame = 0u;
+
+    /// 因超过截止时间而没有等待此客户端的帧数
+    uint64_t SkippedFrames = 0u;
+  };
+
+  std::unordered_map<uint32_t, FTickParticipant> TickParticipants;
+
+  /// 当前剧集的地图文件内容的 ContentHash，每个剧集只计算一次
+  struct FMapContentHashes
+  {
+    uint64_t EpisodeId = 0u;
+
+    std::string OpenDrive;
+
+    std::string NavigationMesh;
+  };
+
+  TOptional<FMapContentHashes> MapContentHashes;
+
+  const FMapContentHashes &GetMapContentHashes();
+
+  /// 只读查询的结果，在游戏线程中生成，由异步处理程序在 RPC 工作线程中直接
+  /// 返回，不占用游戏线程的时间。生成后不再修改；输入变化时生成新的快照，
+  /// 没有变化的部分与之前的快照共享
+  struct FReadOnlySnapshot
+  {
+    uint64_t EpisodeId = 0u;
+
+    uint64 ObjectRegisterVersion = 0u;
+
+    uint64 LightsVersion = 0u;
+
+    int32 NumLights = 0;
+
+    std::shared_ptr<const carla::rpc::MapInfo> MapInfo;
+
+    std::shared_ptr<const std::vector<carla::rpc::ActorDefinition>> ActorDefinitions;
+
+    /// 所有标签的环境物体，大地图中为全局坐标
+    std::shared_ptr<const std::vector<carla::rpc::EnvironmentObject>> EnvironmentObjects;
+
+    std::shared_ptr<const std::vector<carla::rpc::LightState>> Lights;
+  };
+
+  /// 只能通过 std::atomic_load 和 std::atomic_store 访问，剧集结束时为空
+  std::shared_ptr<const FReadOnlySnapshot> ReadOnlySnapshot;
+
+  std::shared_ptr<const FReadOnlySnapshot> GetReadOnlySnapshot() const
+  {
+    return std::atomic_load(&ReadOnlySnapshot);
+  }
+
+  /// 输入变化时重新生成 ReadOnlySnapshot，只能在游戏线程中调用
+  void UpdateReadOnlySnapshot();
+
+  /// 从快照获取了灯光状态的客户端及快照的灯光版本，GetLights 会把客户端标记
+  /// 为已更新，这里在游戏线程中补上
+  TQueue<TPair<FString, uint64>, EQueueMode::Mpsc> LightClientsUpToDate;
+
+  /// 可以分块下载的文件的 ContentHash，按绝对路径缓存，文件修改后重新计算
+  struct FFileContentHash
+  {
+    FDateTime TimeStamp;
+
+    int64 Size = 0;
+
+    std::string Hash;
+  };
+
+  /// 文件请求在 RPC 工作线程中处理，缓存需要加锁
+  FCriticalSection FileContentHashesMutex;
+
+  TMap<FString, FFileContentHash> FileContentHashes;
+
+  /// 内容目录中的文件 @a Name 的绝对路径，路径不在内容目录中时返回 false
+  static bool GetDownloadableFilePath(const std::string &Name, FString &OutPath);
+
+  /// 文件 @a Path 的 ContentHash，可以在任何线程调用，文件不存在时为空
+  std::string GetFileContentHash(const FString &Path, int64 &OutSize);
+
+  uint32_t NextTickParticipantId = 1u;
+
+  /// 屏障开始等待当前帧的平台时间，小于 0 表示还没有开始等待
+  double TickBarrierWaitBeginSeconds = -1.0;
+
+  /// 所有参与者都处理完当前帧，或者超过了各自的截止时间时返回 true
+  bool IsTickBarrierReady();
+
+  /// 传感器组的流 ID 与组及其传感器的映射
+  std::unordered_map<
+      carla::streaming::detail::stream_id_type,
+      std::pair<std::shared_ptr<FSensorBundle>, std::vector<carla::rpc::ActorId>>> SensorBundles;
+
+  /// RPC 线程写入的批量车辆控制，每次运行服务器后在游戏线程中应用
+  TActorCommandBuffer<carla::rpc::VehicleControl> VehicleControls;
+
+  /// 应用 VehicleControls 中的控制，只能在游戏线程中调用
+  void ApplyBufferedVehicleControls();
+
+  struct FBufferedWalkerState
+  {
+    carla::geom::Transform Transform;
+    float Speed;
+  };
+
+  /// RPC 线程写入的批量行人状态，与 VehicleControls 一同在游戏线程中应用
+  TActorCommandBuffer<FBufferedWalkerState> WalkerStates;
+
+  /// 保留内存供每次应用 WalkerStates 时复用
+  FWalkerStateBatch WalkerStateBatch;
+
+  /// 应用 WalkerStates 中的状态，只能在游戏线程中调用
+  void ApplyBufferedWalkerStates();
+
 private:
 
   void BindActions();
@@ -162,6 +324,11 @@ private:
     CARLA_ENSURE_GAME_THREAD();   \
     if (Episode == nullptr) { RESPOND_ERROR("episode not ready"); }
 
+/// 异步处理程序读取的只读快照，可以在任何线程中使用
+#define REQUIRE_READ_ONLY_SNAPSHOT(Snapshot)        \
+    const auto Snapshot = GetReadOnlySnapshot();    \
+    if (Snapshot == nullptr) { RESPOND_ERROR("episode not ready"); }
+
 carla::rpc::ResponseError RespondError(
     const FString& FuncName,
     const FString& ErrorMessage,
@@ -220,6 +387,266 @@ private:
 // -- Bind Actions -------------------------------------------------------------
 // =============================================================================
 
+const FCarlaServer::FPimpl::FMapContentHashes &FCarlaServer::FPimpl::GetMapContentHashes()
+{
+  check(Episode != nullptr);
+  if (!MapContentHashes.IsSet() || (MapContentHashes->EpisodeId != Episode->GetId()))
+  {
+    FMapContentHashes Hashes;
+    Hashes.EpisodeId = Episode->GetId();
+    Hashes.OpenDrive = carla::ContentHash::Compute(
+        cr::FromLongFString(UOpenDrive::GetXODR(Episode->GetWorld())));
+    const auto NavigationMesh = FNavigationMesh::Load(Episode->GetMapName());
+    if (NavigationMesh.Num() > 0)
+    {
+      Hashes.NavigationMesh = carla::ContentHash::Compute(NavigationMesh.GetData(), NavigationMesh.Num());
+    }
+    MapContentHashes = MoveTemp(Hashes);
+  }
+  return MapContentHashes.GetValue();
+}
+
+void FCarlaServer::FPimpl::UpdateReadOnlySnapshot()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  CARLA_ENSURE_GAME_THREAD();
+  UWorld *World = (Episode != nullptr) ? Episode->GetWorld() : nullptr;
+  ACarlaGameModeBase *GameMode = (World != nullptr) ? UCarlaStatics::GetGameMode(World) : nullptr;
+  if (GameMode == nullptr)
+  {
+    std::atomic_store(&ReadOnlySnapshot, std::shared_ptr<const FReadOnlySnapshot>());
+    LightClientsUpToDate.Empty();
+    return;
+  }
+  UCarlaLightSubsystem *LightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
+
+  TPair<FString, uint64> LightClient;
+  while (LightClientsUpToDate.Dequeue(LightClient))
+  {
+    if (LightSubsystem != nullptr)
+    {
+      LightSubsystem->MarkClientUpToDate(LightClient.Key, LightClient.Value);
+    }
+  }
+
+  const auto Previous = GetReadOnlySnapshot();
+  const bool bSameEpisode = (Previous != nullptr) && (Previous->EpisodeId == Episode->GetId());
+  const uint64 ObjectRegisterVersion = GameMode->GetObjectRegister()->GetVersion();
+  const uint64 LightsVersion = (LightSubsystem != nullptr) ? LightSubsystem->GetLightsVersion() : 0u;
+  const int32 NumLights = (LightSubsystem != nullptr) ? LightSubsystem->NumLights() : 0;
+  const bool bSameObjects = bSameEpisode && (Previous->ObjectRegisterVersion == ObjectRegisterVersion);
+  const bool bSameLights = bSameEpisode &&
+      (Previous->LightsVersion == LightsVersion) &&
+      (Previous->NumLights == NumLights);
+  if (bSameObjects && bSameLights)
+  {
+    return;
+  }
+
+  auto Snapshot = std::make_shared<FReadOnlySnapshot>();
+  Snapshot->EpisodeId = Episode->GetId();
+  Snapshot->ObjectRegisterVersion = ObjectRegisterVersion;
+  Snapshot->LightsVersion = LightsVersion;
+  Snapshot->NumLights = NumLights;
+
+  // 地图信息和蓝图在剧集中不会改变
+  if (bSameEpisode)
+  {
+    Snapshot->MapInfo = Previous->MapInfo;
+    Snapshot->ActorDefinitions = Previous->ActorDefinitions;
+  }
+  else
+  {
+    FString FullMapPath = GameMode->GetFullMapPath();
+    FString MapDir = FullMapPath.RightChop(FullMapPath.Find("Content/", ESearchCase::CaseSensitive) + 8);
+    MapDir += "/" + Episode->GetMapName();
+    const auto &Hashes = GetMapContentHashes();
+    Snapshot->MapInfo = std::make_shared<const carla::rpc::MapInfo>(carla::rpc::MapInfo{
+        carla::rpc::FromFString(MapDir),
+        MakeVectorFromTArray<carla::geom::Transform>(Episode->GetRecommendedSpawnPoints()),
+        Hashes.OpenDrive,
+        Hashes.NavigationMesh});
+    Snapshot->ActorDefinitions = std::make_shared<const std::vector<carla::rpc::ActorDefinition>>(
+        MakeVectorFromTArray<carla::rpc::ActorDefinition>(Episode->GetActorDefinitions()));
+  }
+
+  if (bSameObjects)
+  {
+    Snapshot->EnvironmentObjects = Previous->EnvironmentObjects;
+  }
+  else
+  {
+    TArray<FEnvironmentObject> Objects = GameMode->GetEnvironmentObjects();
+    ALargeMapManager* LargeMap = GameMode->GetLMManager();
+    if (LargeMap)
+    {
+      for (auto& Object : Objects)
+      {
+        Object.Transform = LargeMap->LocalToGlobalTransform(Object.Transform);
+      }
+    }
+    Snapshot->EnvironmentObjects = std::make_shared<const std::vector<carla::rpc::EnvironmentObject>>(
+        MakeVectorFromTArray<carla::rpc::EnvironmentObject>(Objects));
+  }
+
+  if (bSameLights)
+  {
+    Snapshot->Lights = Previous->Lights;
+  }
+  else
+  {
+    auto Lights = std::make_shared<std::vector<carla::rpc::LightState>>();
+    if (LightSubsystem != nullptr)
+    {
+      Lights->reserve(NumLights);
+      for (auto &Light : LightSubsystem->GetLights())
+      {
+        Lights->push_back(Light.Value->GetLightState());
+      }
+    }
+    Snapshot->Lights = std::move(Lights);
+  }
+
+  std::atomic_store(&ReadOnlySnapshot, std::shared_ptr<const FReadOnlySnapshot>(std::move(Snapshot)));
+}
+
+bool FCarlaServer::FPimpl::GetDownloadableFilePath(const std::string &Name, FString &OutPath)
+{
+  const FString ContentDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+  // 转换时会合并 ".."，合并后仍需在内容目录中
+  FString Path = FPaths::ConvertRelativePathToFull(ContentDir, UTF8_TO_TCHAR(Name.c_str()));
+  if (!Path.StartsWith(ContentDir))
+  {
+    return false;
+  }
+  OutPath = MoveTemp(Path);
+  return true;
+}
+
+std::string FCarlaServer::FPimpl::GetFileContentHash(const FString &Path, int64 &OutSize)
+{
+  OutSize = 0;
+  IFileManager &FileManager = IFileManager::Get();
+  const FFileStatData Stat = FileManager.GetStatData(*Path);
+  if (!Stat.bIsValid || Stat.bIsDirectory)
+  {
+    return {};
+  }
+  {
+    FScopeLock Lock(&FileContentHashesMutex);
+    const FFileContentHash *Cached = FileContentHashes.Find(Path);
+    if (Cached != nullptr && Cached->TimeStamp == Stat.ModificationTime && Cached->Size == Stat.FileSize)
+    {
+      OutSize = Cached->Size;
+      return Cached->Hash;
+    }
+  }
+
+  // 在锁外分块读取，大文件不需要整个读入内存
+  TUniquePtr<FArchive> Reader(FileManager.CreateFileReader(*Path));
+  if (Reader == nullptr)
+  {
+    return {};
+  }
+  const int64 Size = Reader->TotalSize();
+  TArray<uint8> Buffer;
+  Buffer.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(Size, 1 << 20)));
+  uint64_t Hash = carla::ContentHash::InitialValue();
+  for (int64 Offset = 0; Offset < Size; Offset += Buffer.Num())
+  {
+    const int64 Count = FMath::Min<int64>(Buffer.Num(), Size - Offset);
+    Reader->Serialize(Buffer.GetData(), Count);
+    if (Reader->IsError())
+    {
+      return {};
+    }
+    Hash = carla::ContentHash::ComputeValue(Buffer.GetData(), static_cast<size_t>(Count), Hash);
+  }
+
+  FFileContentHash Entry;
+  Entry.TimeStamp = Stat.ModificationTime;
+  Entry.Size = Size;
+  Entry.Hash = carla::ContentHash::Format(Hash, static_cast<uint64_t>(Size));
+  OutSize = Size;
+  FScopeLock Lock(&FileContentHashesMutex);
+  return FileContentHashes.Add(Path, MoveTemp(Entry)).Hash;
+}
+
+bool FCarlaServer::FPimpl::IsTickBarrierReady()
+{
+  if (TickParticipants.empty())
+  {
+    return false;
+  }
+  const auto Frame = FCarlaEngine::GetFrameCounter();
+  const double Now = FPlatformTime::Seconds();
+  if (TickBarrierWaitBeginSeconds < 0.0)
+  {
+    TickBarrierWaitBeginSeconds = Now;
+  }
+  const double Waited = Now - TickBarrierWaitBeginSeconds;
+  for (const auto &Item : TickParticipants)
+  {
+    const auto &Participant = Item.second;
+    const bool bIsLate = (Participant.DeadlineSeconds > 0.0) && (Waited >= Participant.DeadlineSeconds);
+    if ((Participant.LastReadyFrame < Frame) && !bIsLate)
+    {
+      return false;
+    }
+  }
+  for (auto &Item : TickParticipants)
+  {
+    if (Item.second.LastReadyFrame < Frame)
+    {
+      ++Item.second.SkippedFrames;
+    }
+  }
+  TickBarrierWaitBeginSeconds = -1.0;
+  return true;
+}
+
+void FCarlaServer::FPimpl::ApplyBufferedVehicleControls()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  if (Episode == nullptr)
+  {
+    VehicleControls.Discard();
+    return;
+  }
+  VehicleControls.Consume([this](FCarlaActor::IdType ActorId, const carla::rpc::VehicleControl &Control)
+  {
+    FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+    const ECarlaServerResponse Response = (CarlaActor != nullptr) ?
+        CarlaActor->ApplyControlToVehicle(Control, EVehicleInputPriority::Client) :
+        ECarlaServerResponse::ActorNotFound;
+    if (Response != ECarlaServerResponse::Success)
+    {
+      UE_LOG(LogCarlaServer, Log, TEXT("apply_vehicle_controls: %s Actor Id: %u"),
+          *CarlaGetStringError(Response), ActorId);
+    }
+  });
+}
+
+void FCarlaServer::FPimpl::ApplyBufferedWalkerStates()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  if (Episode == nullptr)
+  {
+    WalkerStates.Discard();
+    return;
+  }
+  WalkerStateBatch.Reset();
+  WalkerStates.Consume([this](FCarlaActor::IdType ActorId, const FBufferedWalkerState &State)
+  {
+    WalkerStateBatch.Add(ActorId, State.Transform, State.Speed);
+  });
+  WalkerStateBatch.Apply(*Episode, [](FCarlaActor::IdType ActorId, ECarlaServerResponse Response)
+  {
+    UE_LOG(LogCarlaServer, Log, TEXT("apply_walker_states: %s Actor Id: %u"),
+        *CarlaGetStringError(Response), ActorId);
+  });
+}
+
 void FCarlaServer::FPimpl::BindActions()
 {
   namespace cr = carla::rpc;
@@ -281,6 +708,88 @@ void FCarlaServer::FPimpl::BindActions()
     return Current + 1;
   };
 
+  // ~~ Tick barrier ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  // 注册一个参与节拍屏障的客户端。有参与者时，同步模式下每当所有参与者都
+  // 通过 tick_ready 确认处理完当前帧，服务器就开始下一帧，不需要 tick 命令
+  BIND_SYNC(register_tick_participant) << [this](std::string name, double deadline) -> R<uint32_t>
+  {
+    if (deadline < 0.0)
+    {
+      RESPOND_ERROR("register_tick_participant: deadline must not be negative");
+    }
+    const auto Id = NextTickParticipantId++;
+    auto &Participant = TickParticipants[Id];
+    Participant.Name = std::move(name);
+    Participant.DeadlineSeconds = deadline;
+    Participant.LastReadyFrame = FCarlaEngine::GetFrameCounter();
+    UE_LOG(LogCarla, Log, TEXT("Tick participant %u registered: %s, deadline %f s"),
+        Id, *cr::ToFString(Participant.Name), deadline);
+    return Id;
+  };
+
+  BIND_SYNC(unregister_tick_participant) << [this](uint32_t id) -> R<void>
+  {
+    auto It = TickParticipants.find(id);
+    if (It == TickParticipants.end())
+    {
+      RESPOND_ERROR("unregister_tick_participant: participant not found");
+    }
+    UE_LOG(LogCarla, Log, TEXT("Tick participant %u unregistered: %s, %llu frames skipped"),
+        id, *cr::ToFString(It->second.Name), It->second.SkippedFrames);
+    TickParticipants.erase(It);
+    return R<void>::Success();
+  };
+
+  // 客户端确认已处理完 frame，调用方不需要等待响应
+  BIND_SYNC(tick_ready) << [this](uint32_t id, uint64_t frame) -> R<void>
+  {
+    auto It = TickParticipants.find(id);
+    if (It == TickParticipants.end())
+    {
+      RESPOND_ERROR("tick_ready: participant not found");
+    }
+    It->second.LastReadyFrame = std::max(It->second.LastReadyFrame, frame);
+    return R<void>::Success();
+  };
+
+  // 返回最近 count 帧（最多 MaxFrameTimings 帧）各阶段的时间
+  BIND_SYNC(get_frame_timings) << [this](uint64_t count) -> R<std::vector<cr::FrameTimings>>
+  {
+    const auto Count = static_cast<size_t>(std::min<uint64_t>(count, FrameTimings.size()));
+    return std::vector<cr::FrameTimings>(FrameTimings.end() - Count, FrameTimings.end());
+  };
+
+  // 返回传感器的触发相位以及之后 frames 帧的传感器估计开销
+  BIND_SYNC(get_sensor_tick_plan) << [this](uint32_t frames) -> R<cr::SensorTickPlan>
+  {
+    REQUIRE_CARLA_EPISODE();
+    const FSensorManager &SensorManager = Episode->GetSensorManager();
+    cr::SensorTickPlan Plan;
+    Plan.fixed_delta_seconds = SensorManager.GetScheduledFixedDeltaSeconds();
+    for (const auto &Item : SensorManager.GetTickSchedules())
+    {
+      const FCarlaActor *CarlaActor = Episode->FindCarlaActor(Item.Key);
+      if (CarlaActor == nullptr)
+      {
+        continue;
+      }
+      cr::SensorTickPlan::Sensor Sensor;
+      Sensor.actor_id = CarlaActor->GetActorId();
+      Sensor.period_frames = static_cast<uint32_t>(Item.Value.PeriodFrames);
+      Sensor.phase_frames = static_cast<uint32_t>(Item.Value.PhaseFrames);
+      Sensor.estimated_cost = Item.Value.EstimatedCost;
+      Sensor.measured_cost = Item.Value.MeasuredCost;
+      Plan.sensors.emplace_back(Sensor);
+    }
+    Plan.first_frame = FCarlaEngine::GetFrameCounter() + 1u;
+    const TArray<float> Costs = SensorManager.GetTickCostPlan(
+        Plan.first_frame,
+        static_cast<int32>(std::min<uint32_t>(frames, 10000u)));
+    Plan.frame_costs.assign(Costs.GetData(), Costs.GetData() + Costs.Num());
+    return Plan;
+  };
+
   // ~~ Load new episode ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_ASYNC(get_available_maps) << [this]() -> R<std::vector<std::string>>
@@ -326,6 +835,39 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  BIND_SYNC(soft_reset_episode) << [this](const bool reset_settings) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->SoftResetEpisode(reset_settings);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(save_episode_snapshot) << [this]() -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->SaveSnapshot();
+  };
+
+  BIND_SYNC(restore_episode_snapshot) << [this](uint64_t snapshot_id) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Episode->RestoreSnapshot(snapshot_id))
+    {
+      RESPOND_ERROR("unable to restore snapshot: snapshot not found");
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(remove_episode_snapshot) << [this](uint64_t snapshot_id) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Episode->RemoveSnapshot(snapshot_id))
+    {
+      RESPOND_ERROR("unable to remove snapshot: snapshot not found");
+    }
+    return R<void>::Success();
+  };
+
   BIND_SYNC(load_map_layer) << [this](cr::MapLayer MapLayers) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
@@ -354,6 +896,42 @@ void FCarlaServer::FPimpl::BindActions()
     return R<void>::Success();
   };
 
+  BIND_SYNC(load_map_layer_async) << [this](cr::MapLayer MapLayers) -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+
+    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
+    if (!GameMode)
+    {
+      RESPOND_ERROR("unable to find CARLA game mode");
+    }
+    return GameMode->LoadMapLayerAsync(static_cast<int32>(MapLayers));
+  };
+
+  BIND_SYNC(unload_map_layer_async) << [this](cr::MapLayer MapLayers) -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+
+    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
+    if (!GameMode)
+    {
+      RESPOND_ERROR("unable to find CARLA game mode");
+    }
+    return GameMode->UnLoadMapLayerAsync(static_cast<int32>(MapLayers));
+  };
+
+  BIND_SYNC(is_map_layer_request_done) << [this](uint64_t RequestId) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+
+    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
+    if (!GameMode)
+    {
+      RESPOND_ERROR("unable to find CARLA game mode");
+    }
+    return GameMode->IsMapLayerRequestDone(RequestId);
+  };
+
   BIND_SYNC(copy_opendrive_to_file) << [this](const std::string &opendrive, cr::OpendriveGenerationParameters Params) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
@@ -462,20 +1040,21 @@ void FCarlaServer::FPimpl::BindActions()
   BIND_SYNC(get_episode_info) << [this]() -> R<cr::EpisodeInfo>
   {
     REQUIRE_CARLA_EPISODE();
+    if (bIsEpisodeStateMulticast)
+    {
+      // 组播时返回组播组的令牌
+      return cr::EpisodeInfo{
+          Episode->GetId(),
+          StreamingServer.GetToken(carla::streaming::detail::token_type(BroadcastStream.token()).get_stream_id())};
+    }
     return cr::EpisodeInfo{Episode->GetId(), BroadcastStream.token()};
   };
 
-  BIND_SYNC(get_map_info) << [this]() -> R<cr::MapInfo>
+  // 只读查询在 RPC 工作线程中从快照返回，见 UpdateReadOnlySnapshot
+  BIND_ASYNC(get_map_info) << [this]() -> R<cr::MapInfo>
   {
-    REQUIRE_CARLA_EPISODE();
-    ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
-    const auto &SpawnPoints = Episode->GetRecommendedSpawnPoints();
-    FString FullMapPath = GameMode->GetFullMapPath();
-    FString MapDir = FullMapPath.RightChop(FullMapPath.Find("Content/", ESearchCase::CaseSensitive) + 8);
-    MapDir += "/" + Episode->GetMapName();
-    return cr::MapInfo{
-      cr::FromFString(MapDir),
-      MakeVectorFromTArray<cg::Transform>(SpawnPoints)};
+    REQUIRE_READ_ONLY_SNAPSHOT(Snapshot);
+    return *Snapshot->MapInfo;
   };
 
   BIND_SYNC(get_map_data) << [this]() -> R<std::string>
@@ -494,6 +1073,66 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  // ~~ Server-side walker navigation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  BIND_SYNC(walker_navigation_add) << [this](
+      cr::ActorId WalkerId,
+      cr::ActorId ControllerId) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!FWalkerNavigation::IsAvailable())
+    {
+      return RespondError(
+          "walker_navigation_add",
+          FString("the server was built without server navigation"));
+    }
+    return Episode->GetWalkerNavigation().AddWalker(*Episode, WalkerId, ControllerId);
+  };
+
+  BIND_SYNC(walker_navigation_remove) << [this](cr::ActorId WalkerId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetWalkerNavigation().RemoveWalker(WalkerId);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(walker_navigation_set_target) << [this](
+      cr::ActorId WalkerId,
+      cr::Location To) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().SetWalkerTarget(WalkerId, To);
+  };
+
+  BIND_SYNC(walker_navigation_set_max_speed) << [this](
+      cr::ActorId WalkerId,
+      float MaxSpeed) -> R<bool>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().SetWalkerMaxSpeed(WalkerId, MaxSpeed);
+  };
+
+  BIND_SYNC(walker_navigation_random_locations) << [this](
+      uint32_t Count) -> R<std::vector<cr::Location>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetWalkerNavigation().GetRandomLocations(*Episode, Count);
+  };
+
+  BIND_SYNC(walker_navigation_set_cross_factor) << [this](float Percentage) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetWalkerNavigation().SetPedestriansCrossFactor(Percentage);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(walker_navigation_set_seed) << [this](unsigned int Seed) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetWalkerNavigation().SetPedestriansSeed(Seed);
+    return R<void>::Success();
+  };
+
   BIND_SYNC(get_required_files) << [this](std::string folder = "") -> R<std::vector<std::string>>
   {
     REQUIRE_CARLA_EPISODE();
@@ -523,6 +1162,7 @@ void FCarlaServer::FPimpl::BindActions()
 
     return result;
   };
+  // Kept for clients that download the whole file in a single response
   BIND_SYNC(request_file) << [this](std::string name) -> R<std::vector<uint8_t>>
   {
     REQUIRE_CARLA_EPISODE();
@@ -540,6 +1180,59 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  BIND_ASYNC(get_file_info) << [this](std::string name) -> R<cr::FileInfo>
+  {
+    cr::FileInfo Info;
+    FString Path;
+    if (GetDownloadableFilePath(name, Path))
+    {
+      int64 Size = 0;
+      Info.content_hash = GetFileContentHash(Path, Size);
+      Info.size = static_cast<uint64_t>(Size);
+    }
+    return Info;
+  };
+
+  BIND_ASYNC(request_file_chunk) << [this](
+      std::string name,
+      std::string content_hash,
+      uint64_t offset,
+      uint64_t size) -> R<std::vector<uint8_t>>
+  {
+    // Chunks are read in the RPC worker threads, an upper bound keeps a
+    // single request from holding a whole map file in memory
+    constexpr uint64_t MaxChunkSize = 64u << 20u;
+    FString Path;
+    if (!GetDownloadableFilePath(name, Path))
+    {
+      RESPOND_ERROR("invalid file name");
+    }
+    int64 FileSize = 0;
+    if (GetFileContentHash(Path, FileSize) != content_hash)
+    {
+      RESPOND_ERROR("file changed in the server, the download has to be restarted");
+    }
+    if (size > MaxChunkSize || offset > static_cast<uint64_t>(FileSize) ||
+        size > static_cast<uint64_t>(FileSize) - offset)
+    {
+      RESPOND_ERROR("requested file chunk out of range");
+    }
+
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+    if (Reader == nullptr)
+    {
+      RESPOND_ERROR("unable to open file");
+    }
+    std::vector<uint8_t> Result(size);
+    Reader->Seek(static_cast<int64>(offset));
+    Reader->Serialize(Result.data(), static_cast<int64>(size));
+    if (Reader->IsError())
+    {
+      RESPOND_ERROR("unable to read file");
+    }
+    return Result;
+  };
+
   BIND_SYNC(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
   {
     REQUIRE_CARLA_EPISODE();
@@ -567,10 +1260,10 @@ void FCarlaServer::FPimpl::BindActions()
     return FCarlaEngine::GetFrameCounter();
   };
 
-  BIND_SYNC(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
+  BIND_ASYNC(get_actor_definitions) << [this]() -> R<std::vector<cr::ActorDefinition>>
   {
-    REQUIRE_CARLA_EPISODE();
-    return MakeVectorFromTArray<cr::ActorDefinition>(Episode->GetActorDefinitions());
+    REQUIRE_READ_ONLY_SNAPSHOT(Snapshot);
+    return *Snapshot->ActorDefinitions;
   };
 
   BIND_SYNC(get_spectator) << [this]() -> R<cr::Actor>
@@ -605,7 +1298,29 @@ void FCarlaServer::FPimpl::BindActions()
     return MakeVectorFromTArray<cg::BoundingBox>(Result);
   };
 
-  BIND_SYNC(get_environment_objects) << [this](uint8 QueriedTag) -> R<std::vector<cr::EnvironmentObject>>
+  BIND_ASYNC(get_environment_objects) << [this](uint8 QueriedTag) -> R<std::vector<cr::EnvironmentObject>>
+  {
+    REQUIRE_READ_ONLY_SNAPSHOT(Snapshot);
+    const auto Tag = static_cast<cr::CityObjectLabel>(QueriedTag);
+    if (Tag == cr::CityObjectLabel::Any)
+    {
+      return *Snapshot->EnvironmentObjects;
+    }
+    std::vector<cr::EnvironmentObject> Result;
+    for (const auto &Object : *Snapshot->EnvironmentObjects)
+    {
+      if (Object.type == Tag)
+      {
+        Result.emplace_back(Object);
+      }
+    }
+    return Result;
+  };
+
+  BIND_SYNC(get_environment_objects_in_radius) << [this](
+      cr::Location Location,
+      float Radius,
+      uint8 QueriedTag) -> R<std::vector<cr::EnvironmentObject>>
   {
     REQUIRE_CARLA_EPISODE();
     ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(Episode->GetWorld());
@@ -613,9 +1328,15 @@ void FCarlaServer::FPimpl::BindActions()
     {
       RESPOND_ERROR("unable to find CARLA game mode");
     }
-    TArray<FEnvironmentObject> Result = GameMode->GetEnvironmentObjects(QueriedTag);
+    FVector Center = Location;
     ALargeMapManager* LargeMap = GameMode->GetLMManager();
     if (LargeMap)
+    {
+      Center = LargeMap->GlobalToLocalLocation(Center);
+    }
+    TArray<FEnvironmentObject> Result =
+        GameMode->GetEnvironmentObjectsInRadius(Center, 1e2f * Radius, QueriedTag);
+    if (LargeMap)
     {
       for(auto& Object : Result)
       {
@@ -714,6 +1435,101 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  BIND_SYNC(query_actors) << [this](
+      const cr::ActorQuery &Query) -> R<cr::ActorQueryResult>
+  {
+    REQUIRE_CARLA_EPISODE();
+    constexpr float TO_METERS = 1e-2;
+    using Field = cr::ActorQueryField;
+
+    const FString TypeIdFilter = cr::ToFString(Query.type_id_filter);
+    const bool bFilterByRadius = Query.radius > 0.0f;
+    const FVector Center = Query.center;
+    const float MaxDistanceSquared = FMath::Square(1e2f * Query.radius);
+
+    cr::ActorQueryResult Result;
+    Result.fields = Query.fields;
+
+    auto AddActor = [&](const FCarlaActor &View)
+    {
+      const cr::Actor &Serialized = View.GetActorInfo()->SerializedData;
+      if (!TypeIdFilter.IsEmpty() &&
+          !cr::ToFString(Serialized.description.id).MatchesWildcard(TypeIdFilter))
+      {
+        return;
+      }
+      if (!Query.semantic_tags.empty() &&
+          std::none_of(Serialized.semantic_tags.begin(), Serialized.semantic_tags.end(), [&](uint8_t Tag) {
+            return std::find(Query.semantic_tags.begin(), Query.semantic_tags.end(), Tag) != Query.semantic_tags.end();
+          }))
+      {
+        return;
+      }
+      const FTransform Transform = View.GetActorGlobalTransform();
+      if (bFilterByRadius &&
+          FVector::DistSquared(Transform.GetLocation(), Center) > MaxDistanceSquared)
+      {
+        return;
+      }
+
+      Result.ids.emplace_back(View.GetActorId());
+      if (Query.HasField(Field::TypeId))
+      {
+        Result.type_ids.emplace_back(Serialized.description.id);
+      }
+      if (Query.HasField(Field::ParentId))
+      {
+        Result.parent_ids.emplace_back(View.GetParent());
+      }
+      if (Query.HasField(Field::SemanticTags))
+      {
+        Result.semantic_tags.emplace_back(Serialized.semantic_tags);
+      }
+      if (Query.HasField(Field::Attributes))
+      {
+        Result.attributes.emplace_back(Serialized.description.attributes);
+      }
+      if (Query.HasField(Field::BoundingBox))
+      {
+        Result.bounding_boxes.emplace_back(Serialized.bounding_box);
+      }
+      if (Query.HasField(Field::Transform))
+      {
+        Result.transforms.emplace_back(Transform);
+      }
+      if (Query.HasField(Field::Velocity))
+      {
+        const FVector Velocity = TO_METERS * View.GetActorVelocity();
+        Result.velocities.emplace_back(Velocity.X, Velocity.Y, Velocity.Z);
+      }
+      if (Query.HasField(Field::AngularVelocity))
+      {
+        const FVector AngularVelocity = View.GetActorAngularVelocity();
+        Result.angular_velocities.emplace_back(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z);
+      }
+    };
+
+    if (Query.actor_ids.empty())
+    {
+      for (auto It = Episode->GetActorRegistry().begin(); It != Episode->GetActorRegistry().end(); ++It)
+      {
+        AddActor(*(It.Value().Get()));
+      }
+    }
+    else
+    {
+      for (auto &&Id : Query.actor_ids)
+      {
+        FCarlaActor* View = Episode->FindCarlaActor(Id);
+        if (View)
+        {
+          AddActor(*View);
+        }
+      }
+    }
+    return Result;
+  };
+
   BIND_SYNC(spawn_actor) << [this](
       cr::ActorDescription Description,
       const cr::Transform &Transform) -> R<cr::Actor>
@@ -737,6 +1553,62 @@ void FCarlaServer::FPimpl::BindActions()
     return Episode->SerializeActor(Result.Value);
   };
 
+  // Attach an actor that has just been spawned to @a ParentId.
+  auto attach_spawned_actor = [this](
+      FCarlaActor* CarlaActor,
+      cr::ActorId ParentId,
+      cr::AttachmentType InAttachmentType,
+      const std::string& socket_name) -> R<void>
+  {
+    FCarlaActor* ParentCarlaActor = Episode->FindCarlaActor(ParentId);
+
+    if (!ParentCarlaActor)
+    {
+      RESPOND_ERROR("unable to attach actor: parent actor not found");
+    }
+
+    CarlaActor->SetParent(ParentId);
+    CarlaActor->SetAttachmentType(InAttachmentType);
+    ParentCarlaActor->AddChildren(CarlaActor->GetActorId());
+
+    #if defined(WITH_ROS2)
+    auto ROS2 = carla::ros2::ROS2::GetInstance();
+    if (ROS2->IsEnabled())
+    {
+      FCarlaActor* CurrentActor = ParentCarlaActor;
+      while(CurrentActor)
+      {
+        for (const auto &Attr : CurrentActor->GetActorInfo()->Description.Variations)
+        {
+          if (Attr.Key == "ros_name")
+          {
+            const std::string value = std::string(TCHAR_TO_UTF8(*Attr.Value.Value));
+            ROS2->AddActorParentRosName(static_cast<void*>(CarlaActor->GetActor()), static_cast<void*>(CurrentActor->GetActor()));
+          }
+        }
+        CurrentActor = Episode->FindCarlaActor(CurrentActor->GetParent());
+      }
+    }
+    #endif
+
+    // Only is possible to attach if the actor has been really spawned and
+    // is not in dormant state
+    if(!ParentCarlaActor->IsDormant())
+    {
+      Episode->AttachActors(
+          CarlaActor->GetActor(),
+          ParentCarlaActor->GetActor(),
+          static_cast<EAttachmentType>(InAttachmentType),
+          FString(socket_name.c_str()));
+    }
+    else
+    {
+      Episode->PutActorToSleep(CarlaActor->GetActorId());
+    }
+
+    return R<void>::Success();
+  };
+
   BIND_SYNC(spawn_actor_with_parent) << [this](
       cr::ActorDescription Description,
       const cr::Transform &Transform,
@@ -749,62 +1621,97 @@ void FCarlaServer::FPimpl::BindActions()
     auto Result = Episode->SpawnActorWithInfo(Transform, std::move(Description));
     if (Result.Key != EActorSpawnResultStatus::Success)
     {
-      RESPOND_ERROR_FSTRING(FActorSpawnResult::StatusToString(Result.Key));
+      RESPOND_ERROR_FSTRING(FActorSpawnResult::StatusToString(Result.Key));
+    }
+
+    FCarlaActor* CarlaActor = Episode->FindCarlaActor(Result.Value->GetActorId());
+    if (!CarlaActor)
+    {
+      RESPOND_ERROR("internal error: actor could not be spawned");
+    }
+
+    auto Attached = attach_spawned_actor(CarlaActor, ParentId, InAttachmentType, socket_name);
+    if (!Attached)
+    {
+      return Attached.GetError();
+    }
+
+    return Episode->SerializeActor(CarlaActor);
+  };
+
+  BIND_SYNC(spawn_actors) << [this, attach_spawned_actor](
+      const cr::ActorSpawnBatch &Batch) -> R<std::vector<cr::CommandResponse>>
+  {
+    REQUIRE_CARLA_EPISODE();
+
+    // Every blueprint is converted once, not once per actor.
+    TArray<FActorDescription> Descriptions;
+    Descriptions.Reserve(Batch.descriptions.size());
+    for (const auto &Description : Batch.descriptions)
+    {
+      Descriptions.Emplace(Description);
     }
 
-    FCarlaActor* CarlaActor = Episode->FindCarlaActor(Result.Value->GetActorId());
-    if (!CarlaActor)
+    TArray<FTransform> Transforms;
+    Transforms.Reserve(Batch.entries.size());
+    for (const auto &Entry : Batch.entries)
     {
-      RESPOND_ERROR("internal error: actor could not be spawned");
+      Transforms.Emplace(Entry.transform);
     }
 
-    FCarlaActor* ParentCarlaActor = Episode->FindCarlaActor(ParentId);
+    constexpr float TO_CENTIMETERS = 1e2;
+    const TArray<bool> IsFree = Episode->AreSpawnPointsFree(
+        Transforms,
+        TO_CENTIMETERS * Batch.validation_radius);
 
-    if (!ParentCarlaActor)
+    ALargeMapManager* LargeMap = UCarlaStatics::GetLargeMapManager(Episode->GetWorld());
+
+    std::vector<cr::CommandResponse> Results;
+    Results.reserve(Batch.entries.size());
+    for (auto i = 0u; i < Batch.entries.size(); ++i)
     {
-      RESPOND_ERROR("unable to attach actor: parent actor not found");
-    }
+      const auto &Entry = Batch.entries[i];
+      if (Entry.description >= static_cast<uint32_t>(Descriptions.Num()))
+      {
+        Results.emplace_back(cr::ResponseError("invalid actor description index"));
+        continue;
+      }
+      if (!IsFree[i])
+      {
+        Results.emplace_back(cr::ResponseError("spawn point is not free"));
+        continue;
+      }
 
-    CarlaActor->SetParent(ParentId);
-    CarlaActor->SetAttachmentType(InAttachmentType);
-    ParentCarlaActor->AddChildren(CarlaActor->GetActorId());
+      auto Result = Episode->SpawnActorWithInfo(Transforms[i], Descriptions[Entry.description]);
+      if (Result.Key != EActorSpawnResultStatus::Success)
+      {
+        Results.emplace_back(cr::ResponseError(
+            cr::FromFString(FActorSpawnResult::StatusToString(Result.Key))));
+        continue;
+      }
 
-    #if defined(WITH_ROS2)
-    auto ROS2 = carla::ros2::ROS2::GetInstance();
-    if (ROS2->IsEnabled())
-    {
-      FCarlaActor* CurrentActor = ParentCarlaActor;
-      while(CurrentActor)
+      if (LargeMap)
       {
-        for (const auto &Attr : CurrentActor->GetActorInfo()->Description.Variations)
+        LargeMap->OnActorSpawned(*Result.Value);
+      }
+
+      if (Entry.parent != 0u)
+      {
+        auto Attached = attach_spawned_actor(
+            Result.Value,
+            Entry.parent,
+            Entry.attachment_type,
+            Entry.socket_name);
+        if (!Attached)
         {
-          if (Attr.Key == "ros_name")
-          {
-            const std::string value = std::string(TCHAR_TO_UTF8(*Attr.Value.Value));
-            ROS2->AddActorParentRosName(static_cast<void*>(CarlaActor->GetActor()), static_cast<void*>(CurrentActor->GetActor()));
-          }
+          Results.emplace_back(Attached.GetError());
+          continue;
         }
-        CurrentActor = Episode->FindCarlaActor(CurrentActor->GetParent());
       }
-    }
-    #endif
 
-    // Only is possible to attach if the actor has been really spawned and
-    // is not in dormant state
-    if(!ParentCarlaActor->IsDormant())
-    {
-      Episode->AttachActors(
-          CarlaActor->GetActor(),
-          ParentCarlaActor->GetActor(),
-          static_cast<EAttachmentType>(InAttachmentType),
-          FString(socket_name.c_str()));
-    }
-    else
-    {
-      Episode->PutActorToSleep(CarlaActor->GetActorId());
+      Results.emplace_back(Result.Value->GetActorId());
     }
-
-    return Episode->SerializeActor(CarlaActor);
+    return Results;
   };
 
   BIND_SYNC(destroy_actor) << [this](cr::ActorId ActorId) -> R<bool>
@@ -863,8 +1770,14 @@ void FCarlaServer::FPimpl::BindActions()
     if (SecondaryServer->HasClientsConnected() && !ForceInPrimary)
     {
       // multi-gpu
+      // the rendering cost decides which secondary server gets the sensor
+      const FActorInfo *Info = Episode->GetActorInfoFromStream(sensor_id);
+      const double Weight = carla::multigpu::PlacementScheduler::GetSensorWeight(
+          carla::rpc::FromFString(Desc),
+          UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_x", Info->Description.Variations, 800),
+          UActorBlueprintFunctionLibrary::RetrieveActorAttributeToInt("image_size_y", Info->Description.Variations, 600));
       UE_LOG(LogCarla, Log, TEXT("Sensor %d '%s' created in secondary server"), sensor_id, *Desc);
-      return SecondaryServer->GetCommander().GetToken(sensor_id);
+      return SecondaryServer->GetCommander().GetToken(sensor_id, Weight);
     }
     else
     {
@@ -969,6 +1882,100 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     }
   };
 
+  // 只统计本服务器上的会话，多 GPU 模式下从服务器的会话不包括在内
+  BIND_SYNC(get_sensor_stream_statistics) << [this](carla::streaming::detail::stream_id_type sensor_id) ->
+                                 R<cr::StreamStatistics>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return cr::StreamStatistics(StreamingServer.GetSessionStatistics(sensor_id));
+  };
+
+  BIND_SYNC(enable_sensor_multicast) << [this](carla::streaming::detail::stream_id_type sensor_id) ->
+                                 R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!bIsMulticastAvailable)
+    {
+      RESPOND_ERROR("enable_sensor_multicast: multicast not available, start the simulator with -carla-multicast-address");
+    }
+    if (!StreamingServer.EnableMulticast(sensor_id))
+    {
+      RESPOND_ERROR("enable_sensor_multicast: sensor stream not found");
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(disable_sensor_multicast) << [this](carla::streaming::detail::stream_id_type sensor_id) ->
+                                 R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    StreamingServer.DisableMulticast(sensor_id);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(open_sensor_bundle) << [this](
+      std::vector<cr::ActorId> ActorIds) -> R<std::vector<unsigned char>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (ActorIds.empty())
+    {
+      RESPOND_ERROR("open_sensor_bundle: no sensors given");
+    }
+    std::vector<ASensor *> Sensors;
+    std::vector<carla::streaming::detail::stream_id_type> StreamIds;
+    for (auto ActorId : ActorIds)
+    {
+      FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+      if (!CarlaActor)
+      {
+        return RespondError(
+            "open_sensor_bundle",
+            ECarlaServerResponse::ActorNotFound,
+            " Actor Id: " + FString::FromInt(ActorId));
+      }
+      ASensor* Sensor = Cast<ASensor>(CarlaActor->GetActor());
+      if (!Sensor || !Sensor->IsStreamReady())
+      {
+        return RespondError(
+            "open_sensor_bundle",
+            ECarlaServerResponse::ActorTypeMismatch,
+            " Actor Id: " + FString::FromInt(ActorId));
+      }
+      Sensors.push_back(Sensor);
+      StreamIds.push_back(carla::streaming::detail::token_type(Sensor->GetToken()).get_stream_id());
+    }
+    auto Bundle = std::make_shared<FSensorBundle>(StreamingServer.MakeStream(), StreamIds);
+    for (auto *Sensor : Sensors)
+    {
+      Sensor->SetSensorBundle(Bundle);
+    }
+    SensorBundles[Bundle->GetStreamId()] = std::make_pair(Bundle, std::move(ActorIds));
+    const auto Token = Bundle->GetToken();
+    return std::vector<unsigned char>(std::begin(Token.data), std::end(Token.data));
+  };
+
+  BIND_SYNC(close_sensor_bundle) << [this](
+      carla::streaming::detail::stream_id_type BundleId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto It = SensorBundles.find(BundleId);
+    if (It == SensorBundles.end())
+    {
+      RESPOND_ERROR("close_sensor_bundle: sensor bundle not found");
+    }
+    for (auto ActorId : It->second.second)
+    {
+      FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+      ASensor* Sensor = CarlaActor ? Cast<ASensor>(CarlaActor->GetActor()) : nullptr;
+      if (Sensor && (Sensor->GetSensorBundle() == It->second.first))
+      {
+        Sensor->SetSensorBundle(nullptr);
+      }
+    }
+    SensorBundles.erase(It);
+    return R<void>::Success();
+  };
+
 
   BIND_SYNC(send) << [this](
       cr::ActorId ActorId,
@@ -2010,6 +3017,52 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  // 在 RPC 线程中直接写入缓冲区，不等待游戏线程，控制在下一次物理更新前统一应用。
+  // 找不到的车辆只记录日志，不返回错误；有 id 超出缓冲区容量时整批都不写入，
+  // 客户端可以改用 apply_batch 重新发送而不会重复应用。
+  BIND_ASYNC(apply_vehicle_controls) << [this](
+      const std::vector<cr::Command::ApplyVehicleControl> &Controls) -> R<void>
+  {
+    using FBuffer = decltype(VehicleControls);
+    const uint32 Rejected = static_cast<uint32>(std::count_if(Controls.begin(), Controls.end(),
+        [](const cr::Command::ApplyVehicleControl &Command) { return !FBuffer::IsInRange(Command.actor); }));
+    if (Rejected > 0u)
+    {
+      RESPOND_ERROR_FSTRING(FString::Printf(
+          TEXT("apply_vehicle_controls: %u actor ids out of range, no control applied"), Rejected));
+    }
+    for (const cr::Command::ApplyVehicleControl &Command : Controls)
+    {
+      VehicleControls.Write(Command.actor, Command.control);
+    }
+    return R<void>::Success();
+  };
+
+  // 与 apply_vehicle_controls 相同，在 RPC 线程中写入缓冲区，在下一次运行服务器后
+  // 统一应用，同一行人只保留最后写入的状态。
+  BIND_ASYNC(apply_walker_states) << [this](
+      const cr::WalkerStates &States) -> R<void>
+  {
+    if (States.transforms.size() != States.size() ||
+        States.speeds.size() != States.size())
+    {
+      RESPOND_ERROR("apply_walker_states: mismatched number of actors, transforms and speeds");
+    }
+    using FBuffer = decltype(WalkerStates);
+    const uint32 Rejected = static_cast<uint32>(std::count_if(States.actors.begin(), States.actors.end(),
+        [](cr::ActorId ActorId) { return !FBuffer::IsInRange(ActorId); }));
+    if (Rejected > 0u)
+    {
+      RESPOND_ERROR_FSTRING(FString::Printf(
+          TEXT("apply_walker_states: %u actor ids out of range, no state applied"), Rejected));
+    }
+    for (size_t i = 0u; i < States.size(); ++i)
+    {
+      WalkerStates.Write(States.actors[i], FBufferedWalkerState{States.transforms[i], States.speeds[i]});
+    }
+    return R<void>::Success();
+  };
+
   BIND_SYNC(apply_ackermann_control_to_vehicle) << [this](
       cr::ActorId ActorId,
       cr::VehicleAckermannControl Control) -> R<void>
@@ -2385,6 +3438,30 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(enable_kinematic_physics) << [this](
+      cr::ActorId ActorId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    FCarlaActor* CarlaActor = Episode->FindCarlaActor(ActorId);
+    if (!CarlaActor)
+    {
+      return RespondError(
+          "enable_kinematic_physics",
+          ECarlaServerResponse::ActorNotFound,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    ECarlaServerResponse Response =
+        CarlaActor->EnableKinematicPhysics();
+    if (Response != ECarlaServerResponse::Success)
+    {
+      return RespondError(
+          "enable_kinematic_physics",
+          Response,
+          " Actor Id: " + FString::FromInt(ActorId));
+    }
+    return R<void>::Success();
+  };
+
   BIND_SYNC(restore_physx_physics) << [this](
       cr::ActorId ActorId) -> R<void>
   {
@@ -2791,10 +3868,27 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 
   // ~~ Logging and playback ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  BIND_SYNC(start_recorder) << [this](std::string name, bool AdditionalData) -> R<std::string>
+  BIND_SYNC(start_recorder) << [this](std::string name, bool AdditionalData, bool Compressed) -> R<std::string>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return R<std::string>(Episode->StartRecorder(name, AdditionalData, Compressed));
+  };
+
+  BIND_SYNC(start_flight_recorder) << [this](
+      std::string name,
+      double seconds,
+      double seconds_after,
+      bool AdditionalData,
+      bool Compressed) -> R<std::string>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return R<std::string>(Episode->StartFlightRecorder(name, seconds, seconds_after, AdditionalData, Compressed));
+  };
+
+  BIND_SYNC(trigger_flight_recorder) << [this]() -> R<std::string>
   {
     REQUIRE_CARLA_EPISODE();
-    return R<std::string>(Episode->StartRecorder(name, AdditionalData));
+    return R<std::string>(Episode->GetRecorder()->TriggerRing());
   };
 
   BIND_SYNC(stop_recorder) << [this]() -> R<void>
@@ -2875,6 +3969,26 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(set_replayer_skip_physics) << [this](bool skip_physics) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetReplayerSkipPhysics(skip_physics);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(set_replayer_frame_step) << [this](bool frame_step) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetReplayerFrameStep(frame_step);
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(get_replayer_frame) << [this]() -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    return Episode->GetRecorder()->GetReplayerFrame();
+  };
+
   BIND_SYNC(stop_replayer) << [this](bool keep_actors) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();
@@ -2894,6 +4008,36 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(draw_debug_shapes) << [this](const std::vector<cr::DebugShape> &shapes) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto *World = Episode->GetWorld();
+    check(World != nullptr);
+    FDebugShapeDrawer Drawer(*World);
+    for (const auto &shape : shapes)
+    {
+      Drawer.Draw(shape);
+    }
+    return R<void>::Success();
+  };
+
+  BIND_SYNC(draw_debug_shape_group) << [this](
+      const std::vector<cr::DebugShape> &shapes,
+      uint64_t group) -> R<uint64_t>
+  {
+    REQUIRE_CARLA_EPISODE();
+    auto *World = Episode->GetWorld();
+    check(World != nullptr);
+    return DebugShapeGroups.Draw(*World, group, shapes);
+  };
+
+  BIND_SYNC(clear_debug_shape_group) << [this](uint64_t group) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    DebugShapeGroups.Clear(group);
+    return R<void>::Success();
+  };
+
   // ~~ Apply commands in batch ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   using C = cr::Command;
@@ -2979,14 +4123,26 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
 
   // ~~ Light Subsystem ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-  BIND_SYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
+  BIND_ASYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
+  {
+    REQUIRE_READ_ONLY_SNAPSHOT(Snapshot);
+    LightClientsUpToDate.Enqueue(MakeTuple(FString(client.c_str()), Snapshot->LightsVersion));
+    return *Snapshot->Lights;
+  };
+
+  // 只返回版本 version 之后状态改变的灯光，以及当前的版本号
+  BIND_SYNC(query_lights_state_since) << [this]
+    (std::string client, uint64_t version) -> R<std::pair<uint64_t, std::vector<cr::LightState>>>
   {
     REQUIRE_CARLA_EPISODE();
-    std::vector<cr::LightState> result;
+    std::pair<uint64_t, std::vector<cr::LightState>> result{version, {}};
     auto *World = Episode->GetWorld();
     if(World) {
       UCarlaLightSubsystem* CarlaLightSubsystem = World->GetSubsystem<UCarlaLightSubsystem>();
-      result = CarlaLightSubsystem->GetLights(FString(client.c_str()));
+      uint64 CurrentVersion = version;
+      result.second = CarlaLightSubsystem->GetLightsChangedSince(
+          FString(client.c_str()), version, CurrentVersion);
+      result.first = CurrentVersion;
     }
     return result;
   };
@@ -3098,12 +4254,18 @@ void FCarlaServer::NotifyBeginEpisode(UCarlaEpisode &Episode)
   check(Pimpl != nullptr);
   UE_LOG(LogCarlaServer, Log, TEXT("New episode '%s' started"), *Episode.GetMapName());
   Pimpl->Episode = &Episode;
+  // 异步的只读查询不等待下一次运行服务器
+  Pimpl->UpdateReadOnlySnapshot();
 }
 
 void FCarlaServer::NotifyEndEpisode()
 {
   check(Pimpl != nullptr);
   Pimpl->Episode = nullptr;
+  Pimpl->UpdateReadOnlySnapshot();
+  // 新剧集会重新分配 id
+  Pimpl->VehicleControls.Discard();
+  Pimpl->WalkerStates.Discard();
 }
 
 void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
@@ -3133,15 +4295,180 @@ void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
   UE_LOG(LogCarla, Log, TEXT("FCarlaServer AsyncRun %d, RPCThreads %d, StreamingThreads %d, SecondaryThreads %d"),
         NumberOfWorkerThreads, RPCThreads, StreamingThreads, SecondaryThreads);
 
+  // 工作线程的 CPU 亲和性和优先级，使其不与游戏线程和渲染线程争抢 CPU
+  auto ParseThreadSettings = [](const TCHAR *AffinityOption, const TCHAR *PriorityOption)
+  {
+    carla::ThreadSettings Settings;
+    FString Value;
+    if (FParse::Value(FCommandLine::Get(), AffinityOption, Value) &&
+        !carla::ThreadSettings::ParseCpuList(carla::rpc::FromFString(Value), Settings.cpu_affinity))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Invalid CPU list '%s' for %s, expected e.g. 0-3,8"), *Value, AffinityOption);
+    }
+    if (FParse::Value(FCommandLine::Get(), PriorityOption, Value) &&
+        !carla::ThreadSettings::ParsePriority(carla::rpc::FromFString(Value), Settings.priority))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Invalid thread priority '%s' for %s, expected low, normal or high"), *Value, PriorityOption);
+    }
+    return Settings;
+  };
+  const auto StreamingThreadSettings =
+      ParseThreadSettings(TEXT("-StreamingAffinity="), TEXT("-StreamingThreadPriority="));
+  const auto SecondaryThreadSettings =
+      ParseThreadSettings(TEXT("-SecondaryAffinity="), TEXT("-SecondaryThreadPriority="));
+
+  // 地图构建、网格生成等并行计算共用的任务调度器，默认使用全部硬件线程
+  int32_t TaskThreads = 0;
+  FParse::Value(FCommandLine::Get(), TEXT("-TaskThreads="), TaskThreads);
+  carla::TaskScheduler::Configure(
+      static_cast<size_t>(std::max(0, TaskThreads)),
+      ParseThreadSettings(TEXT("-TaskAffinity="), TEXT("-TaskThreadPriority=")));
+
+  // LibCarla 日志默认同步写入标准输出；-LogAsync=text|json 改为由后台线程写入，
+  // -LogFile= 指定输出文件，-LogLevel= 在运行时提高或降低日志级别
+  FString LogAsync;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-LogAsync="), LogAsync))
+  {
+    carla::AsyncLoggerSettings LogSettings;
+    LogSettings.format = (LogAsync == TEXT("json")) ? carla::LogFormat::Json : carla::LogFormat::Text;
+    FString LogFile;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-LogFile="), LogFile))
+    {
+      LogSettings.file_path = carla::rpc::FromFString(LogFile);
+    }
+    carla::AsyncLogger::Start(LogSettings);
+  }
+  FString LogLevel;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-LogLevel="), LogLevel))
+  {
+    if (LogLevel == TEXT("debug"))
+    {
+      carla::logging::SetLevel(LIBCARLA_LOG_LEVEL_DEBUG);
+    }
+    else if (LogLevel == TEXT("info"))
+    {
+      carla::logging::SetLevel(LIBCARLA_LOG_LEVEL_INFO);
+    }
+    else if (LogLevel == TEXT("warning"))
+    {
+      carla::logging::SetLevel(LIBCARLA_LOG_LEVEL_WARNING);
+    }
+    else if (LogLevel == TEXT("error"))
+    {
+      carla::logging::SetLevel(LIBCARLA_LOG_LEVEL_ERROR);
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Invalid log level '%s', expected debug, info, warning or error"), *LogLevel);
+    }
+  }
+
+  // RPC、流、交通管理器与引擎的指标，-MetricsPort= 指定 HTTP 拉取接口的端口
+  int32_t MetricsPort;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-MetricsPort="), MetricsPort))
+  {
+    try
+    {
+      Pimpl->MetricsServer = std::make_unique<carla::profiler::MetricsServer>(
+          static_cast<uint16_t>(FMath::Clamp(MetricsPort, 0, 65535)));
+      UE_LOG(LogCarla, Log, TEXT("FCarlaServer metrics available at http://0.0.0.0:%d/metrics"),
+          static_cast<int32>(Pimpl->MetricsServer->GetPort()));
+    }
+    catch (const std::exception &e)
+    {
+      UE_LOG(LogCarla, Error, TEXT("FCarlaServer failed to start metrics server on port %d: %s"),
+          MetricsPort, UTF8_TO_TCHAR(e.what()));
+    }
+  }
+
+  // 每个会话的发送队列，较慢的客户端超出队列长度后按指定策略丢弃消息
+  carla::streaming::detail::SessionQueueSettings QueueSettings;
+  int32_t StreamingQueueDepth;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-StreamingQueueDepth="), StreamingQueueDepth))
+  {
+    QueueSettings.max_depth = static_cast<size_t>(std::max(0, StreamingQueueDepth));
+  }
+  FString StreamingQueuePolicy;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-StreamingQueuePolicy="), StreamingQueuePolicy))
+  {
+    if (StreamingQueuePolicy == TEXT("drop-oldest"))
+    {
+      QueueSettings.policy = carla::streaming::detail::OverflowPolicy::DropOldest;
+    }
+    else if (StreamingQueuePolicy == TEXT("block"))
+    {
+      QueueSettings.policy = carla::streaming::detail::OverflowPolicy::Block;
+    }
+    else if (StreamingQueuePolicy != TEXT("drop-newest"))
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unknown streaming queue policy '%s', using drop-newest"), *StreamingQueuePolicy);
+    }
+  }
+  int32_t StreamingQueueTimeout;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-StreamingQueueTimeout="), StreamingQueueTimeout))
+  {
+    QueueSettings.timeout = carla::time_duration::milliseconds(static_cast<size_t>(std::max(0, StreamingQueueTimeout)));
+  }
+  Pimpl->StreamingServer.SetSessionQueueSettings(QueueSettings);
+
+  // 同一主机上的客户端可以通过共享内存接收传感器数据，其余客户端仍使用 TCP
+  if (FParse::Param(FCommandLine::Get(), TEXT("carla-shared-memory-streaming")))
+  {
+    UE_LOG(LogCarla, Log, TEXT("FCarlaServer shared memory streaming enabled"));
+    Pimpl->StreamingServer.SetSharedMemoryMode(true);
+  }
+
+  // 很多客户端订阅同一个流时，通过组播只发送一次，丢失的消息不会重发
+  FString MulticastAddress;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-carla-multicast-address="), MulticastAddress))
+  {
+    carla::streaming::detail::udp::MulticastSettings MulticastSettings;
+    int32_t MulticastPort = 2004;
+    FParse::Value(FCommandLine::Get(), TEXT("-carla-multicast-port="), MulticastPort);
+    int32_t MulticastFEC;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-multicast-fec="), MulticastFEC))
+    {
+      MulticastSettings.fec_group_size = static_cast<uint8_t>(FMath::Clamp(MulticastFEC, 0, 255));
+    }
+    int32_t MulticastTTL;
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-multicast-ttl="), MulticastTTL))
+    {
+      MulticastSettings.ttl = static_cast<uint8_t>(FMath::Clamp(MulticastTTL, 1, 255));
+    }
+    const auto Address = carla::rpc::FromFString(MulticastAddress);
+    boost::system::error_code ec;
+    const auto Group = boost::asio::ip::make_address(Address, ec);
+    if (ec || !Group.is_multicast())
+    {
+      UE_LOG(LogCarla, Error, TEXT("FCarlaServer invalid multicast address '%s'"), *MulticastAddress);
+    }
+    else
+    {
+      UE_LOG(LogCarla, Log, TEXT("FCarlaServer multicast streaming to %s:%d, FEC group %d"),
+          *MulticastAddress, MulticastPort, MulticastSettings.fec_group_size);
+      Pimpl->StreamingServer.SetMulticastGroup(Address, static_cast<uint16_t>(MulticastPort), MulticastSettings);
+      Pimpl->bIsMulticastAvailable = true;
+      if (FParse::Param(FCommandLine::Get(), TEXT("carla-multicast-episode-state")))
+      {
+        const auto BroadcastId = carla::streaming::detail::token_type(Pimpl->BroadcastStream.token()).get_stream_id();
+        Pimpl->bIsEpisodeStateMulticast = Pimpl->StreamingServer.EnableMulticast(BroadcastId);
+      }
+    }
+  }
+
   Pimpl->Server.AsyncRun(RPCThreads);
-  Pimpl->StreamingServer.AsyncRun(StreamingThreads);
-  Pimpl->SecondaryServer->AsyncRun(SecondaryThreads);
+  Pimpl->StreamingServer.AsyncRun(StreamingThreads, StreamingThreadSettings);
+  Pimpl->SecondaryServer->AsyncRun(SecondaryThreads, SecondaryThreadSettings);
 }
 
 void FCarlaServer::RunSome(uint32 Milliseconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   Pimpl->Server.SyncRunFor(carla::time_duration::milliseconds(Milliseconds));
+  Pimpl->ApplyBufferedVehicleControls();
+  Pimpl->ApplyBufferedWalkerStates();
+  // 包括刚才的同步调用所做的修改
+  Pimpl->UpdateReadOnlySnapshot();
 }
 
 void FCarlaServer::Tick()
@@ -3155,7 +4482,22 @@ bool FCarlaServer::TickCueReceived()
   bool flag = (k > 0);
   if (!flag)
     (void)Pimpl->TickCuesReceived.fetch_add(1, std::memory_order_release);
-  return flag;
+  if (flag)
+  {
+    // 由 tick 命令开始的帧不属于屏障的等待时间
+    Pimpl->TickBarrierWaitBeginSeconds = -1.0;
+    return true;
+  }
+  return Pimpl->IsTickBarrierReady();
+}
+
+void FCarlaServer::RecordFrameTimings(const carla::rpc::FrameTimings &Timings)
+{
+  Pimpl->FrameTimings.emplace_back(Timings);
+  while (Pimpl->FrameTimings.size() > FPimpl::MaxFrameTimings)
+  {
+    Pimpl->FrameTimings.pop_front();
+  }
 }
 
 void FCarlaServer::Stop()
@@ -3164,7 +4506,10 @@ void FCarlaServer::Stop()
   {
     Pimpl->Server.Stop();
     Pimpl->SecondaryServer->Stop();
+    Pimpl->MetricsServer.reset();
   }
+  // 写出异步日志队列中剩余的消息
+  carla::AsyncLogger::Stop();
 }
 
 FDataStream FCarlaServer::OpenStream() const
@@ -13,6 +13,7 @@
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/multigpu/router.h>
+#include <carla/rpc/FrameTimings.h>
 #include <carla/streaming/Server.h>
 #include <compiler/enable-ue4-macros.h>
 
@@ -40,6 +41,8 @@ public:
   
   bool TickCueReceived();
 
+  void RecordFrameTimings(const carla::rpc::FrameTimings &Timings);
+
   void Stop();
 
   FDataStream OpenStream() const;
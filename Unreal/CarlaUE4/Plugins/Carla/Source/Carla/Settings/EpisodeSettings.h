@@ -68,4 +68,26 @@ struct CARLA_API FEpisodeSettings
     // 设为false则旁观者和自我主体有不同的处理逻辑。
     bool SpectatorAsEgo = true;
 
+    // bDeterministicPhysics启用PhysX的增强确定性（UPhysicsSettings::bEnableEnhancedDeterminism）。
+    // PhysX在创建物理场景时读取这个标志，所以在下一次加载地图时生效；
+    // 同步模式加上固定的时间步长时，每一帧的子步数和子步长也是固定的，结果可以复现。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bDeterministicPhysics = false;
+
+    // KinematicPhysicsDistance大于0时，距离所有hero车辆超过该距离（厘米）的车辆
+    // 改用UKinematicMovementComponent的运动学模型，回到该距离的90%以内时恢复完整的物理。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    float KinematicPhysicsDistance = 0.0f;
+
+    // bPhysicsOnlyMode为true时服务器只推进物理和交通：隐含bNoRenderingMode，相机传感器
+    // 不再渲染和读回图像，天气只记录参数不更新视觉效果，行人只在被渲染时更新骨骼动画。
+    // 空的RHI只能在启动时用-nullrhi选择。
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    bool bPhysicsOnlyMode = false;
+
+    // TargetRealTimeFactor大于0时，在异步模式并且设置了FixedDeltaSeconds的情况下，
+    // FCarlaEngine让每一帧占用FixedDeltaSeconds/TargetRealTimeFactor的墙钟时间；
+    // 超出预算时先减少物理子步（子步长最多为MaxSubstepDeltaTime的2倍），再推迟传感器。
+    double TargetRealTimeFactor = 0.0;
+
 };
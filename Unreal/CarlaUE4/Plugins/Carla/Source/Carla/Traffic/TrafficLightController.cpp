@@ -192,6 +192,11 @@ void UTrafficLightController::SetElapsedTime(float InElapsedTime)
   ElapsedTime = InElapsedTime;
 }
 
+void UTrafficLightController::SetCurrentStateIndex(int Index)
+{
+  CurrentState = FMath::Clamp(Index, 0, LightStates.Num() - 1);
+}
+
 void UTrafficLightController::SetGroup(ATrafficLightGroup* Group)
 {
   TrafficLightGroup = Group;
@@ -118,6 +118,16 @@ public:
   UFUNCTION(Category = "Traffic Controller", BlueprintCallable)
   void SetElapsedTime(float InElapsedTime);
 
+  UFUNCTION(Category = "Traffic Controller", BlueprintPure)
+  int GetCurrentStateIndex() const
+  {
+    return CurrentState;
+  }
+
+  // 设置当前的阶段，不会更新交通信号灯（用于恢复保存的状态）
+  UFUNCTION(Category = "Traffic Controller", BlueprintCallable)
+  void SetCurrentStateIndex(int Index);
+
   void SetGroup(ATrafficLightGroup* Group);
 
   ATrafficLightGroup* GetGroup();
@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Game/CarlaStatics.h"
 #include "TrafficLightGroup.h"
+#include "TrafficLightManager.h"
 
 
 // 设置默认值
@@ -39,6 +40,31 @@ void ATrafficLightGroup::ResetGroup()
   controller->StartCycle();
 }
 
+void ATrafficLightGroup::BeginPlay()
+{
+  Super::BeginPlay();
+
+  // 由交通灯管理器在一次遍历中推进所有的组，避免每个组单独 Tick
+  ACarlaGameModeBase* GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  ATrafficLightManager* Manager = GameMode ? GameMode->GetTrafficLightManager() : nullptr;
+  if (Manager)
+  {
+    Manager->AddSteppedGroup(this);
+    SteppingManager = Manager;
+    SetActorTickEnabled(false);
+  }
+}
+
+void ATrafficLightGroup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (SteppingManager.IsValid())
+  {
+    SteppingManager->RemoveSteppedGroup(this);
+  }
+  SteppingManager = nullptr;
+  Super::EndPlay(EndPlayReason);
+}
+
 // 每帧调用
 void ATrafficLightGroup::Tick(float DeltaTime)
 {
@@ -59,7 +85,12 @@ void ATrafficLightGroup::Tick(float DeltaTime)
     }
   }
 
-  if (bIsFrozen)
+  StepGroup(DeltaTime);
+}
+
+void ATrafficLightGroup::StepGroup(float DeltaTime)
+{
+  if (bIsFrozen || Controllers.Num() == 0)
   {
     return;
   }
@@ -83,6 +114,11 @@ int ATrafficLightGroup::GetJunctionId() const
   return JunctionId;
 }
 
+void ATrafficLightGroup::SetCurrentControllerIndex(int Index)
+{
+  CurrentController = FMath::Clamp(Index, 0, Controllers.Num() - 1);
+}
+
 void ATrafficLightGroup::AddController(UTrafficLightController* Controller)
 {
   Controllers.Add(Controller);
@@ -47,8 +47,27 @@ public:
   UFUNCTION(Category = "Traffic Group", BlueprintCallable)
   void AddController(UTrafficLightController* Controller);
 
+  UFUNCTION(Category = "Traffic Group", BlueprintPure)
+  int GetCurrentControllerIndex() const
+  {
+    return CurrentController;
+  }
+
+  // 设置当前运行循环的控制器，不会重新开始它的循环（用于恢复保存的状态）
+  UFUNCTION(Category = "Traffic Group", BlueprintCallable)
+  void SetCurrentControllerIndex(int Index);
+
+  // 推进当前控制器的时间，周期结束时切换到下一个控制器。
+  // 通常由 ATrafficLightManager 在一次遍历中对所有组调用
+  void StepGroup(float DeltaTime);
+
 protected:
-  // 每帧调用
+
+  virtual void BeginPlay() override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  // 每帧调用，只有在没有 ATrafficLightManager 统一推进时才启用
   virtual void Tick(float DeltaTime) override;
 
 private:
@@ -72,4 +91,7 @@ private:
 
   UPROPERTY(Category = "Traffic Group", EditAnywhere)
   int JunctionId = -1;
+
+  // 负责推进该组的交通灯管理器
+  TWeakObjectPtr<ATrafficLightManager> SteppingManager;
 };
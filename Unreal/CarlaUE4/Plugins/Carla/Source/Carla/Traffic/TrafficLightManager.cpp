@@ -6,6 +6,8 @@
 
 #include "TrafficLightManager.h"
 #include "Game/CarlaStatics.h"
+#include "Game/MapStartupCache.h"
+#include "EngineUtils.h"
 #include "StopSignComponent.h"
 #include "YieldSignComponent.h"
 #include "SpeedLimitComponent.h"
@@ -24,7 +26,8 @@
 
 ATrafficLightManager::ATrafficLightManager()
 {
-  PrimaryActorTick.bCanEverTick = false;
+  // Steps all the traffic light groups in a single pass, see Tick.
+  PrimaryActorTick.bCanEverTick = true;
   SceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
   RootComponent = SceneComponent;
 
@@ -247,6 +250,41 @@ void ATrafficLightManager::RegisterLightComponentGenerated(UTrafficLightComponen
   }
 }
 
+void ATrafficLightManager::AddSteppedGroup(ATrafficLightGroup* Group)
+{
+  SteppedGroups.AddUnique(Group);
+}
+
+void ATrafficLightManager::RemoveSteppedGroup(ATrafficLightGroup* Group)
+{
+  SteppedGroups.Remove(Group);
+}
+
+void ATrafficLightManager::Tick(float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ATrafficLightManager::Tick);
+  Super::Tick(DeltaTime);
+
+  // Do not update while the replayer is driving the lights.
+  auto* Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+  if (Episode)
+  {
+    auto* Replayer = Episode->GetReplayer();
+    if (Replayer && Replayer->IsEnabled())
+    {
+      return;
+    }
+  }
+
+  for (ATrafficLightGroup* Group : SteppedGroups)
+  {
+    if (IsValid(Group))
+    {
+      Group->StepGroup(DeltaTime);
+    }
+  }
+}
+
 const boost::optional<carla::road::Map>& ATrafficLightManager::GetMap()
 {
   return UCarlaStatics::GetGameMode(GetWorld())->GetMap();
@@ -268,6 +306,9 @@ void ATrafficLightManager::GenerateSignalsAndTrafficLights()
 
     SpawnSignals();
 
+    BakedActorsByPath.Empty();
+    bBakedActorsIndexed = false;
+
     TrafficLightsGenerated = true;
   }
 }
@@ -479,11 +520,79 @@ T * GetClosestTrafficSignActor(const carla::road::Signal &Signal, UWorld* World)
   return ClosestTrafficSign;
 }
 
+void ATrafficLightManager::BakeSignalActors(
+    const carla::road::Map &Map,
+    UWorld *World,
+    FMapStartupCache &Cache)
+{
+  for (const auto &SignalPair : Map.GetSignals())
+  {
+    const auto &Signal = *SignalPair.second;
+    const FString SignalId = carla::rpc::ToFString(SignalPair.first);
+    // 与 SpawnTrafficLights 和 SpawnSignals 的查找相同
+    ATrafficSignBase *Actor = nullptr;
+    if (carla::road::SignalType::IsTrafficLight(Signal.GetType()))
+    {
+      Actor = GetClosestTrafficSignActor<ATrafficLightBase>(Signal, World);
+      Cache.TrafficLightActors.Add(SignalId, Actor ? UWorld::RemovePIEPrefix(Actor->GetPathName()) : FString());
+    }
+    else
+    {
+      Actor = GetClosestTrafficSignActor(Signal, World);
+      Cache.SignActors.Add(SignalId, Actor ? UWorld::RemovePIEPrefix(Actor->GetPathName()) : FString());
+    }
+  }
+}
+
+bool ATrafficLightManager::FindBakedSignalActor(
+    const TMap<FString, FString> *Table,
+    const carla::road::Signal &Signal,
+    ATrafficSignBase *&OutActor)
+{
+  OutActor = nullptr;
+  const FString *Path = Table ? Table->Find(carla::rpc::ToFString(Signal.GetSignalId())) : nullptr;
+  if (Path == nullptr)
+  {
+    return false;
+  }
+  if (Path->IsEmpty())
+  {
+    return true;
+  }
+  if (!bBakedActorsIndexed)
+  {
+    bBakedActorsIndexed = true;
+    for (TActorIterator<ATrafficSignBase> It(GetWorld()); It; ++It)
+    {
+      BakedActorsByPath.Add(UWorld::RemovePIEPrefix(It->GetPathName()), *It);
+    }
+  }
+  // 参与者已不存在或不再匹配时退回到完整的查找
+  ATrafficSignBase **Actor = BakedActorsByPath.Find(*Path);
+  if ((Actor == nullptr) || !MatchSignalAndActor(Signal, *Actor))
+  {
+    return false;
+  }
+  OutActor = *Actor;
+  return true;
+}
+
 void ATrafficLightManager::SpawnTrafficLights()
 {
   namespace cr = carla::road;
   const auto& Signals = GetMap()->GetSignals();
   std::unordered_set<std::string> SignalsToSpawn;
+  ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(GetWorld());
+  const FMapStartupCache *StartupCache = GameMode ? GameMode->GetStartupCache() : nullptr;
+  const TMap<FString, FString> *BakedTrafficLights = StartupCache ? &StartupCache->TrafficLightActors : nullptr;
+  auto FindTrafficLight = [&](const cr::Signal &Signal) -> ATrafficLightBase * {
+    ATrafficSignBase *Baked = nullptr;
+    if (FindBakedSignalActor(BakedTrafficLights, Signal, Baked))
+    {
+      return Cast<ATrafficLightBase>(Baked);
+    }
+    return GetClosestTrafficSignActor<ATrafficLightBase>(Signal, GetWorld());
+  };
   for(const auto& ControllerPair : GetMap()->GetControllers())
   {
     const auto& Controller = ControllerPair.second;
@@ -494,8 +603,7 @@ void ATrafficLightManager::SpawnTrafficLights()
       {
         continue;
       }
-      ATrafficLightBase * TrafficLight = GetClosestTrafficSignActor<ATrafficLightBase>(
-          *Signal.get(), GetWorld());
+      ATrafficLightBase * TrafficLight = FindTrafficLight(*Signal.get());
       if (TrafficLight)
       {
         UTrafficLightComponent *TrafficLightComponent = TrafficLight->GetTrafficLightComponent();
@@ -517,8 +625,7 @@ void ATrafficLightManager::SpawnTrafficLights()
        carla::road::SignalType::IsTrafficLight(Signal->GetType()) &&
        !SignalsToSpawn.count(SignalId))
     {
-      ATrafficLightBase * TrafficLight = GetClosestTrafficSignActor<ATrafficLightBase>(
-          *Signal.get(), GetWorld());
+      ATrafficLightBase * TrafficLight = FindTrafficLight(*Signal.get());
       if (TrafficLight)
       {
         UTrafficLightComponent *TrafficLightComponent = TrafficLight->GetTrafficLightComponent();
@@ -607,13 +714,20 @@ void ATrafficLightManager::SpawnSignals()
   ACarlaGameModeBase *GM = UCarlaStatics::GetGameMode(GetWorld());
   check(GM);
 
+  const FMapStartupCache *StartupCache = GM->GetStartupCache();
+  const TMap<FString, FString> *BakedSigns = StartupCache ? &StartupCache->SignActors : nullptr;
   const auto &Signals = GetMap()->GetSignals();
   for (auto& SignalPair : Signals)
   {
     auto &Signal = SignalPair.second;
     FString SignalType = Signal->GetType().c_str();
 
-    ATrafficSignBase * ClosestTrafficSign = GetClosestTrafficSignActor(*Signal.get(), GetWorld());
+    // 交通灯信号不在缓存中，它们可能匹配 SpawnTrafficLights 刚生成的交通灯
+    ATrafficSignBase * ClosestTrafficSign = nullptr;
+    if (!FindBakedSignalActor(BakedSigns, *Signal.get(), ClosestTrafficSign))
+    {
+      ClosestTrafficSign = GetClosestTrafficSignActor(*Signal.get(), GetWorld());
+    }
     if (ClosestTrafficSign)
     {
       USignComponent *SignComponent;
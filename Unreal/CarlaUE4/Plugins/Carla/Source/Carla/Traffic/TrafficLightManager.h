@@ -11,6 +11,8 @@
 #include "TrafficSignBase.h"
 #include "Carla/OpenDrive/OpenDrive.h"
 
+struct FMapStartupCache;
+
 #include "TrafficLightManager.generated.h"
 
 /// 负责创建和分配交通灯组、控制器和组件的类。
@@ -58,6 +60,17 @@ public:
   // Called when the game starts by the gamemode
   void InitializeTrafficLights();
 
+  // 按启动时的规则为 Map 的每个信号匹配 World 中的交通灯和交通标志，写入启动缓存，
+  // 由 CarlaTools 的 BakeMapStartupCache 命令行调用
+  static void BakeSignalActors(const carla::road::Map &Map, UWorld *World, FMapStartupCache &Cache);
+
+  // 交通灯组在 BeginPlay 时注册，由管理器每帧统一推进
+  void AddSteppedGroup(ATrafficLightGroup* Group);
+
+  void RemoveSteppedGroup(ATrafficLightGroup* Group);
+
+  virtual void Tick(float DeltaTime) override;
+
 private:
 
   void SpawnTrafficLights();
@@ -68,6 +81,18 @@ private:
 
   void RemoveAttachedProps(TArray<AActor*> Actors) const;
 
+  // 在启动缓存的 Table 中查找与信号 SignalId 匹配的参与者；缓存中有这个信号时返回
+  // true，OutActor 为匹配的参与者，没有匹配时为 nullptr
+  bool FindBakedSignalActor(
+      const TMap<FString, FString> *Table,
+      const carla::road::Signal &Signal,
+      ATrafficSignBase *&OutActor);
+
+  // 关卡中的交通标志按去掉 PIE 前缀的路径名索引，第一次查找启动缓存时建立
+  TMap<FString, ATrafficSignBase *> BakedActorsByPath;
+
+  bool bBakedActorsIndexed = false;
+
   // 映射对 ATrafficLightGroup (交叉路口) 的引用
   UPROPERTY()
   TMap<int, ATrafficLightGroup *> TrafficGroups;
@@ -83,6 +108,10 @@ private:
   // 交通标志 TrafficSigns 的映射引用
   TArray<ATrafficSignBase*> TrafficSigns;
 
+  // 每帧由管理器推进的交通灯组
+  UPROPERTY()
+  TArray<ATrafficLightGroup *> SteppedGroups;
+
   UPROPERTY(EditAnywhere, Category= "Traffic Light Manager")
   TSubclassOf<AActor> TrafficLightModel;
 
@@ -24,8 +24,22 @@
 #include "Rendering/SkeletalMeshRenderData.h"
 #include "Engine/SkeletalMeshSocket.h"
 
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
 namespace crp = carla::rpc;
 
+// Actors per task when computing the bounding boxes of a level in parallel.
+static constexpr int32 BB_ACTORS_PER_TASK = 32;
+
+// Bounding box of each skeletal mesh asset in mesh space. Computing it walks
+// every vertex of LOD 0, so it is done only once per asset and the result is
+// composed with the transform of each component.
+static TMap<TObjectKey<USkeletalMesh>, FBoundingBox> SkeletalMeshBBCache;
+
+static FRWLock SkeletalMeshBBCacheLock;
+
 static FBoundingBox ApplyTransformToBB(
     FBoundingBox InBB,
     const FTransform& Transform)
@@ -264,6 +278,16 @@ FBoundingBox UBoundingBoxCalculator::GetSkeletalMeshBoundingBox(const USkeletalM
     return {};
   }
 
+  const TObjectKey<USkeletalMesh> Key(SkeletalMesh);
+  {
+    FReadScopeLock ReadLock(SkeletalMeshBBCacheLock);
+    const FBoundingBox *Cached = SkeletalMeshBBCache.Find(Key);
+    if (Cached != nullptr)
+    {
+      return *Cached;
+    }
+  }
+
   // Get Vertex postion information from LOD 0 of the Skeletal Mesh
   FSkeletalMeshRenderData* SkeletalMeshRenderData = SkeletalMesh->GetResourceForRendering();
   FSkeletalMeshLODRenderData& LODRenderData = SkeletalMeshRenderData->LODRenderData[0];
@@ -285,9 +309,16 @@ FBoundingBox UBoundingBoxCalculator::GetSkeletalMeshBoundingBox(const USkeletalM
   auto Extent = (Max - Min) * 0.5f;
   auto Origin = Min + Extent;
 
-  return {Origin, Extent};
+  const FBoundingBox BoundingBox{Origin, Extent};
+  {
+    FWriteScopeLock WriteLock(SkeletalMeshBBCacheLock);
+    SkeletalMeshBBCache.Add(Key, BoundingBox);
+  }
+  return BoundingBox;
 }
 
+// The bounds of the static meshes are already stored in the asset, there is
+// nothing to cache.
 FBoundingBox UBoundingBoxCalculator::GetStaticMeshBoundingBox(const UStaticMesh* StaticMesh)
 {
   if(!StaticMesh)
@@ -409,10 +440,30 @@ TArray<FBoundingBox> UBoundingBoxCalculator::GetBoundingBoxOfActors(
   const TArray<AActor*>& Actors,
   uint8 InTagQueried)
 {
+  // The actors are only read, each task writes the boxes of its own actors.
+  TArray<TArray<FBoundingBox>> BBsPerActor;
+  BBsPerActor.SetNum(Actors.Num());
+  const int32 NumTasks = FMath::DivideAndRoundUp(Actors.Num(), BB_ACTORS_PER_TASK);
+  ParallelFor(NumTasks, [&](int32 Task)
+  {
+    const int32 Begin = Task * BB_ACTORS_PER_TASK;
+    const int32 End = FMath::Min(Begin + BB_ACTORS_PER_TASK, Actors.Num());
+    for (int32 Index = Begin; Index < End; ++Index)
+    {
+      BBsPerActor[Index] = GetBBsOfActor(Actors[Index], InTagQueried);
+    }
+  }, NumTasks < 2);
+
+  // Keep the order of the actors.
+  int32 NumBBs = 0;
+  for (const TArray<FBoundingBox> &BBs : BBsPerActor)
+  {
+    NumBBs += BBs.Num();
+  }
   TArray<FBoundingBox> Result;
-  for(AActor* Actor : Actors)
+  Result.Reserve(NumBBs);
+  for (const TArray<FBoundingBox> &BBs : BBsPerActor)
   {
-    TArray<FBoundingBox> BBs = GetBBsOfActor(Actor, InTagQueried);
     Result.Append(BBs.GetData(), BBs.Num());
   }
 
@@ -12,6 +12,7 @@
 
 #include "DrawDebugHelpers.h"
 #include "Components/LineBatchComponent.h"
+#include "GameFramework/WorldSettings.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include <carla/rpc/DebugShape.h>
@@ -24,13 +25,15 @@ struct FShapeVisitor
 {
   using Shape = carla::rpc::DebugShape;
 
-  FShapeVisitor(UWorld &InWorld, FColor InColor, float InLifeTime, bool bInPersistentLines)
+  FShapeVisitor(UWorld &InWorld, ULineBatchComponent &InLineBatcher, FColor InColor, float InLifeTime, bool bInPersistentLines)
     : World(&InWorld),
+      LineBatcher(&InLineBatcher),
       Color(InColor.ReinterpretAsLinear() * BrightMultiplier),
       LifeTime(InLifeTime),
+      LineLifeTime(LineBatcher == World->PersistentLineBatcher ? InLifeTime : 0.0f),
       bPersistentLines(bInPersistentLines)
   {
-    World->PersistentLineBatcher->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    LineBatcher->SetCollisionEnabled(ECollisionEnabled::NoCollision);
   }
 
   ACarlaHUD * GetHUD() const {
@@ -52,12 +55,12 @@ struct FShapeVisitor
     {
       Location = LargeMap->GlobalToLocalLocation(Location);
     }
-    World->PersistentLineBatcher->DrawPoint(
+    LineBatcher->DrawPoint(
         Location,
         Color,
         1e2f * Point.size,
         DepthPriority,
-        LifeTime);
+        LineLifeTime);
   }
 
   void operator()(const Shape::HUDPoint &Point) const
@@ -84,13 +87,13 @@ struct FShapeVisitor
       Begin = LargeMap->GlobalToLocalLocation(Begin);
       End = LargeMap->GlobalToLocalLocation(End);
     }
-    World->PersistentLineBatcher->DrawLine(
+    LineBatcher->DrawLine(
         Begin,
         End,
         Color,
         DepthPriority,
         1e2f * Line.thickness,
-        LifeTime);
+        LineLifeTime);
   }
 
   void operator()(const Shape::HUDLine &Line) const {
@@ -127,21 +130,21 @@ struct FShapeVisitor
     const auto ArrowTipDist = Dist - ArrowSize;
     const auto Thickness = 1e2f * Arrow.line.thickness;
 
-    World->PersistentLineBatcher->DrawLines(TArray<FBatchedLine>({
+    LineBatcher->DrawLines(TArray<FBatchedLine>({
         FBatchedLine(
-            Begin, End, Color, LifeTime, Thickness, DepthPriority),
+            Begin, End, Color, LineLifeTime, Thickness, DepthPriority),
         FBatchedLine(
             Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, +ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
+            End, Color, LineLifeTime, Thickness, DepthPriority),
         FBatchedLine(
             Transform.TransformPosition(FVector(ArrowTipDist, +ArrowSize, -ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
+            End, Color, LineLifeTime, Thickness, DepthPriority),
         FBatchedLine(
             Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, +ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority),
+            End, Color, LineLifeTime, Thickness, DepthPriority),
         FBatchedLine(
             Transform.TransformPosition(FVector(ArrowTipDist, -ArrowSize, -ArrowSize)),
-            End, Color, LifeTime, Thickness, DepthPriority)}));
+            End, Color, LineLifeTime, Thickness, DepthPriority)}));
   }
 
   void operator()(const Shape::HUDArrow &Arrow) const {
@@ -202,21 +205,21 @@ struct FShapeVisitor
       {
         P.X=B[i].X; Q.X=B[i].X; P.Y=B[j].Y;
         Q.Y=B[j].Y; P.Z=B[0].Z; Q.Z=B[1].Z;
-        World->PersistentLineBatcher->DrawLine(
+        LineBatcher->DrawLine(
             Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+            Color, DepthPriority, Thickness, LineLifeTime);
 
         P.Y=B[i].Y; Q.Y=B[i].Y; P.Z=B[j].Z;
         Q.Z=B[j].Z; P.X=B[0].X; Q.X=B[1].X;
-        World->PersistentLineBatcher->DrawLine(
+        LineBatcher->DrawLine(
             Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+            Color, DepthPriority, Thickness, LineLifeTime);
 
         P.Z=B[i].Z; Q.Z=B[i].Z; P.X=B[j].X;
         Q.X=B[j].X; P.Y=B[0].Y; Q.Y=B[1].Y;
-        World->PersistentLineBatcher->DrawLine(
+        LineBatcher->DrawLine(
             Transform.TransformPosition(P), Transform.TransformPosition(Q),
-            Color, DepthPriority, Thickness, LifeTime);
+            Color, DepthPriority, Thickness, LineLifeTime);
       }
     }
   }
@@ -280,10 +283,16 @@ private:
 
   UWorld *World;
 
+  ULineBatchComponent *LineBatcher;
+
   FLinearColor Color;
 
   float LifeTime;
 
+  /// Life time of the shapes drawn into the line batcher, shapes of a group
+  /// stay until the group is replaced or cleared.
+  float LineLifeTime;
+
   bool bPersistentLines;
 
   uint8 DepthPriority = SDPG_World;
@@ -302,6 +311,46 @@ private:
 
 void FDebugShapeDrawer::Draw(const carla::rpc::DebugShape &Shape)
 {
-  auto Visitor = FShapeVisitor(World, Shape.color, Shape.life_time, Shape.persistent_lines);
+  ULineBatchComponent *Batcher = LineBatcher != nullptr ? LineBatcher : World.PersistentLineBatcher;
+  auto Visitor = FShapeVisitor(World, *Batcher, Shape.color, Shape.life_time, Shape.persistent_lines);
   boost::variant2::visit(Visitor, Shape.primitive);
 }
+
+uint64_t FDebugShapeGroups::Draw(UWorld &World, uint64_t Group, const std::vector<carla::rpc::DebugShape> &Shapes)
+{
+  TWeakObjectPtr<ULineBatchComponent> *Found = Groups.Find(Group);
+  ULineBatchComponent *Batcher = Found != nullptr ? Found->Get() : nullptr;
+  if (Batcher == nullptr || Batcher->GetWorld() != &World)
+  {
+    // Owned by the world settings so it is destroyed with the world.
+    Batcher = NewObject<ULineBatchComponent>(World.GetWorldSettings());
+    Batcher->bCalculateAccurateBounds = false;
+    Batcher->RegisterComponentWithWorld(&World);
+    if (Found != nullptr)
+    {
+      Groups.Remove(Group);
+    }
+    Group = NextGroup++;
+    Groups.Add(Group, Batcher);
+  }
+  else
+  {
+    Batcher->Flush();
+  }
+  FDebugShapeDrawer Drawer(World, Batcher);
+  for (const auto &Shape : Shapes)
+  {
+    Drawer.Draw(Shape);
+  }
+  return Group;
+}
+
+void FDebugShapeGroups::Clear(uint64_t Group)
+{
+  TWeakObjectPtr<ULineBatchComponent> Batcher;
+  if (Groups.RemoveAndCopyValue(Group, Batcher) && Batcher.IsValid())
+  {
+    Batcher->Flush();
+    Batcher->DestroyComponent();
+  }
+}
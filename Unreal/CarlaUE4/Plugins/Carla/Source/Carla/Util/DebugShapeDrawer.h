@@ -6,7 +6,14 @@
 
 #pragma once
 
+#include "Containers/Map.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include <cstdint>
+#include <vector>
+
 class UWorld;
+class ULineBatchComponent;
 
 namespace carla { namespace rpc { class DebugShape; }}
 
@@ -14,11 +21,38 @@ class FDebugShapeDrawer
 {
 public:
 
-  explicit FDebugShapeDrawer(UWorld &InWorld) : World(InWorld) {}
+  /// Draws into @a InLineBatcher, the persistent line batcher of the world if
+  /// null. Shapes drawn into a line batcher other than the world's one stay
+  /// until the batcher is flushed, their life time only applies to HUD
+  /// shapes and strings.
+  explicit FDebugShapeDrawer(UWorld &InWorld, ULineBatchComponent *InLineBatcher = nullptr)
+    : World(InWorld),
+      LineBatcher(InLineBatcher) {}
 
   void Draw(const carla::rpc::DebugShape &Shape);
 
 private:
 
   UWorld &World;
+
+  ULineBatchComponent *LineBatcher;
+};
+
+/// Groups of debug shapes that can be replaced or cleared as a whole, each
+/// one drawn by its own line batcher.
+class FDebugShapeGroups
+{
+public:
+
+  /// Replace the shapes of @a Group, or create a new group if @a Group is 0 or
+  /// no longer exists in @a World. Returns the id of the group.
+  uint64_t Draw(UWorld &World, uint64_t Group, const std::vector<carla::rpc::DebugShape> &Shapes);
+
+  void Clear(uint64_t Group);
+
+private:
+
+  TMap<uint64_t, TWeakObjectPtr<ULineBatchComponent>> Groups;
+
+  uint64_t NextGroup = 1u;
 };
@@ -38,45 +38,132 @@ TArray<FEnvironmentObject> UObjectRegister::GetEnvironmentObjects(uint8 InTagQue
   return Result;
 }
 
-void UObjectRegister::RegisterObjects(TArray<AActor*> Actors)
+TArray<FEnvironmentObject> UObjectRegister::GetEnvironmentObjectsInRadius(
+    const FVector& Center,
+    float Radius,
+    uint8 InTagQueried) const
 {
-  // Empties the array but doesn't change memory allocations
-  EnvironmentObjects.Reset();
+  TArray<FEnvironmentObject> Result;
 
-  for(AActor* Actor : Actors)
+  crp::CityObjectLabel TagQueried = (crp::CityObjectLabel)InTagQueried;
+  bool FilterByTagEnabled = (TagQueried != crp::CityObjectLabel::Any);
+  const float RadiusSquared = Radius * Radius;
+
+  const FIntPoint Min = GetCell(Center - FVector(Radius));
+  const FIntPoint Max = GetCell(Center + FVector(Radius));
+  for(int32 X = Min.X; X <= Max.X; X++)
   {
+    for(int32 Y = Min.Y; Y <= Max.Y; Y++)
+    {
+      const TArray<int32>* Cell = ObjectGrid.Find(FIntPoint(X, Y));
+      if(!Cell) continue;
+      for(int32 Index : *Cell)
+      {
+        const FEnvironmentObject& It = EnvironmentObjects[Index];
+        if((!FilterByTagEnabled || (It.ObjectLabel == TagQueried)) &&
+           (FVector::DistSquared(It.BoundingBox.Origin, Center) <= RadiusSquared))
+        {
+          Result.Emplace(It);
+        }
+      }
+    }
+  }
 
-    FString ClassName = Actor->GetClass()->GetName();
-    // Discard Sky to not break the global ilumination
-    if(ClassName.Equals("BP_Sky_C")) continue;
+  return Result;
+}
 
-    ACarlaWheeledVehicle* Vehicle = Cast<ACarlaWheeledVehicle>(Actor);
-    if (Vehicle)
+FIntPoint UObjectRegister::GetCell(const FVector& Location) const
+{
+  return FIntPoint(
+      FMath::FloorToInt(Location.X / CellSize),
+      FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UObjectRegister::IndexObjects(int32 FirstIndex)
+{
+  for(int32 Index = FirstIndex; Index < EnvironmentObjects.Num(); Index++)
+  {
+    const FEnvironmentObject& It = EnvironmentObjects[Index];
+    // EnableEnvironmentObjects uses the first object with a given id
+    if(!IdToIndex.Contains(It.Id))
     {
-      RegisterVehicle(Vehicle);
-      continue;
+      IdToIndex.Add(It.Id, Index);
     }
+    ObjectGrid.FindOrAdd(GetCell(It.BoundingBox.Origin)).Add(Index);
+  }
+}
 
-    ACharacter* Character = Cast<ACharacter>(Actor);
-    if (Character)
+void UObjectRegister::RebuildIndex()
+{
+  IdToIndex.Reset();
+  ObjectGrid.Reset();
+  IndexObjects(0);
+}
+
+void UObjectRegister::RegisterObjectsOfLevel(const ULevel* Level)
+{
+  if(!Level) return;
+  // In case the level was already registered with the rest of the world
+  UnregisterObjectsOfLevel(Level);
+  const int32 FirstIndex = EnvironmentObjects.Num();
+  TArray<AActor*> Actors;
+  Actors.Reserve(Level->Actors.Num());
+  for(AActor* Actor : Level->Actors)
+  {
+    if(Actor && !Actor->IsPendingKill())
     {
-      RegisterCharacter(Character);
-      continue;
+      Actors.Add(Actor);
     }
+  }
+  RegisterActors(Actors);
+  IndexObjects(FirstIndex);
+  ++Version;
+}
 
-    ATrafficLightBase* TrafficLight = Cast<ATrafficLightBase>(Actor);
-    if(TrafficLight)
+void UObjectRegister::UnregisterObjectsOfLevel(const ULevel* Level)
+{
+  if(!Level) return;
+  const int32 Removed = EnvironmentObjects.RemoveAll([Level](const FEnvironmentObject& It)
+  {
+    return It.Actor && It.Actor->GetLevel() == Level;
+  });
+  if(Removed > 0)
+  {
+    ++Version;
+    RebuildIndex();
+    TArray<uint64> Ids;
+    ObjectIdToComp.GetKeys(Ids);
+    for(uint64 Id : Ids)
     {
-      RegisterTrafficLight(TrafficLight);
-      continue;
+      if(!IdToIndex.Contains(Id))
+      {
+        ObjectIdToComp.Remove(Id);
+      }
     }
+  }
+}
 
-    RegisterISMComponents(Actor);
+void UObjectRegister::ApplyWorldOffset(const FVector& Offset)
+{
+  for(FEnvironmentObject& It : EnvironmentObjects)
+  {
+    It.Transform.AddToTranslation(Offset);
+    It.BoundingBox.Origin += Offset;
+  }
+  RebuildIndex();
+  ++Version;
+}
 
-    RegisterSMComponents(Actor);
+void UObjectRegister::RegisterObjects(TArray<AActor*> Actors)
+{
+  // Empties the array but doesn't change memory allocations
+  EnvironmentObjects.Reset();
+  ObjectIdToComp.Reset();
+  FoliageActorInstanceCount = 0;
 
-    RegisterSKMComponents(Actor);
-  }
+  RegisterActors(Actors);
+  RebuildIndex();
+  ++Version;
 
 #if WITH_EDITOR
   // To help debug
@@ -105,21 +192,54 @@ void UObjectRegister::RegisterObjects(TArray<AActor*> Actors)
 
 }
 
+void UObjectRegister::RegisterActors(const TArray<AActor*>& Actors)
+{
+  for(AActor* Actor : Actors)
+  {
+
+    FString ClassName = Actor->GetClass()->GetName();
+    // Discard Sky to not break the global ilumination
+    if(ClassName.Equals("BP_Sky_C")) continue;
+
+    ACarlaWheeledVehicle* Vehicle = Cast<ACarlaWheeledVehicle>(Actor);
+    if (Vehicle)
+    {
+      RegisterVehicle(Vehicle);
+      continue;
+    }
+
+    ACharacter* Character = Cast<ACharacter>(Actor);
+    if (Character)
+    {
+      RegisterCharacter(Character);
+      continue;
+    }
+
+    ATrafficLightBase* TrafficLight = Cast<ATrafficLightBase>(Actor);
+    if(TrafficLight)
+    {
+      RegisterTrafficLight(TrafficLight);
+      continue;
+    }
+
+    RegisterISMComponents(Actor);
+
+    RegisterSMComponents(Actor);
+
+    RegisterSKMComponents(Actor);
+  }
+}
+
 void UObjectRegister::EnableEnvironmentObjects(const TSet<uint64>& EnvObjectIds, bool Enable)
 {
   for(uint64 It : EnvObjectIds)
   {
-    bool found = false;
-    for(FEnvironmentObject& EnvironmentObject : EnvironmentObjects)
+    const int32* Index = IdToIndex.Find(It);
+    if(Index)
     {
-      if(It == EnvironmentObject.Id)
-      {
-        EnableEnvironmentObject(EnvironmentObject, Enable);
-        found = true;
-        break;
-      }
+      EnableEnvironmentObject(EnvironmentObjects[*Index], Enable);
     }
-    if(!found)
+    else
     {
       UE_LOG(LogCarla, Error, TEXT("EnableEnvironmentObjects id not found %llu"), It);
     }
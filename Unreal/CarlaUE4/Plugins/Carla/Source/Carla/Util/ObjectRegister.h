@@ -28,14 +28,49 @@ public:
   UFUNCTION(Category = "Carla Object Register", BlueprintCallable, CallInEditor)
   TArray<FEnvironmentObject> GetEnvironmentObjects(uint8 InTagQueried = 0xFF) const;
 
+  /// Objects whose bounding box center is within @a Radius (cm) of @a Center,
+  /// looked up in a grid so only the cells around @a Center are visited.
+  UFUNCTION(Category = "Carla Object Register", BlueprintCallable)
+  TArray<FEnvironmentObject> GetEnvironmentObjectsInRadius(
+      const FVector& Center,
+      float Radius,
+      uint8 InTagQueried = 0xFF) const;
+
+  /// Replace the registered objects by the ones of @a Actors.
   UFUNCTION(Category = "Carla Object Register")
   void RegisterObjects(TArray<AActor*> Actors);
 
+  /// Register the objects of a level added to the world (e.g. a tile of a
+  /// large map) without registering the rest of the world again.
+  void RegisterObjectsOfLevel(const ULevel* Level);
+
+  /// Forget the objects of a level about to be removed from the world.
+  void UnregisterObjectsOfLevel(const ULevel* Level);
+
+  /// Move the registered objects after a rebase of the world origin, the
+  /// actors are moved by @a Offset.
+  void ApplyWorldOffset(const FVector& Offset);
+
   UFUNCTION(Category = "Carla Object Register")
   void EnableEnvironmentObjects(const TSet<uint64>& EnvObjectIds, bool Enable);
 
+  /// Incremented whenever the registered objects are added, removed or moved.
+  uint64 GetVersion() const
+  {
+    return Version;
+  }
+
 private:
 
+  void RegisterActors(const TArray<AActor*>& Actors);
+
+  /// Add the objects from @a FirstIndex onwards to the index.
+  void IndexObjects(int32 FirstIndex);
+
+  void RebuildIndex();
+
+  FIntPoint GetCell(const FVector& Location) const;
+
   void RegisterEnvironmentObject(
     AActor* Actor,
     FBoundingBox& BoundingBox,
@@ -67,6 +102,17 @@ private:
   UPROPERTY(Category = "Carla Object Register", EditAnywhere)
   TArray<FEnvironmentObject> EnvironmentObjects;
 
+  /// Index in EnvironmentObjects of each object id.
+  TMap<uint64, int32> IdToIndex;
+
+  /// Indices in EnvironmentObjects of the objects in each XY cell.
+  TMap<FIntPoint, TArray<int32>> ObjectGrid;
+
+  /// Size of the cells of ObjectGrid (cm).
+  float CellSize = 5000.0f;
+
   int FoliageActorInstanceCount = 0;
 
+  uint64 Version = 0u;
+
 };
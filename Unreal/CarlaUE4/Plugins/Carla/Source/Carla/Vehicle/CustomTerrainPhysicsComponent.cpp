@@ -63,7 +63,9 @@
 #include "Math/OrientedBox.h"
 #include "Misc/DateTime.h"
 #include "EngineUtils.h"
+#include "Misc/Compression.h"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 
 #include <thread>
@@ -112,6 +114,7 @@ void FHeightMapData::InitializeHeightmap(
   Tile0Position = Tile0;
   WorldSize = Size;
   Offset = Origin;
+  ++Version;
   Size_X = DataAsset->SizeX;
   Size_Y = DataAsset->SizeY;
   // Pixels = DataAsset->HeightValues;
@@ -138,6 +141,84 @@ void FHeightMapData::Clear()
   Pixels.clear();
 }
 
+// Compressed tiles: header followed by the zlib stream of the position and the
+// particles, laid out as WriteFVector and WriteStdVector would write them.
+struct FCompressedTileHeader
+{
+  uint32_t Magic = 0x454C4954; // "TILE"
+  uint32_t Size = 0;
+  uint32_t StoredSize = 0;
+};
+
+static FString GetCompressedTileFileName(const FString& SavePath, const FDVector& TilePosition)
+{
+  return SavePath + TilePosition.ToString() + ".ctile";
+}
+
+static void WriteCompressedTile(const FString& SavePath, const FDenseTile& Tile)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(WriteCompressedTile);
+  const FVector Position = Tile.TilePosition.ToFVector();
+  const uint32_t NumParticles = Tile.Particles.size();
+  std::vector<char> Data(sizeof(FVector) + sizeof(uint32_t) + NumParticles * sizeof(FParticle));
+  std::memcpy(Data.data(), &Position, sizeof(FVector));
+  std::memcpy(Data.data() + sizeof(FVector), &NumParticles, sizeof(uint32_t));
+  std::memcpy(Data.data() + sizeof(FVector) + sizeof(uint32_t),
+      Tile.Particles.data(), NumParticles * sizeof(FParticle));
+
+  FCompressedTileHeader Header;
+  Header.Size = Data.size();
+  int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Header.Size);
+  std::vector<char> Compressed(CompressedSize);
+  if (!FCompression::CompressMemory(
+      NAME_Zlib, Compressed.data(), CompressedSize, Data.data(), Header.Size))
+  {
+    UE_LOG(LogCarla, Error, TEXT("Tile %s could not be compressed"), *Tile.TilePosition.ToString());
+    return;
+  }
+  Header.StoredSize = CompressedSize;
+
+  std::string FileName = std::string(TCHAR_TO_UTF8(*GetCompressedTileFileName(SavePath, Tile.TilePosition)));
+  std::ofstream OutputStream(FileName.c_str(), std::ios::binary);
+  WriteValue<FCompressedTileHeader>(OutputStream, Header);
+  OutputStream.write(Compressed.data(), CompressedSize);
+}
+
+static bool ReadCompressedTile(const FString& FileName, FDVector& TilePosition, std::vector<FParticle>& Particles)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ReadCompressedTile);
+  std::ifstream ReadStream(TCHAR_TO_UTF8(*FileName), std::ios::binary);
+  FCompressedTileHeader Header;
+  const uint32_t Magic = Header.Magic;
+  ReadValue<FCompressedTileHeader>(ReadStream, Header);
+  if (!ReadStream || Header.Magic != Magic || Header.Size < sizeof(FVector) + sizeof(uint32_t))
+  {
+    return false;
+  }
+  std::vector<char> Compressed(Header.StoredSize);
+  ReadStream.read(Compressed.data(), Header.StoredSize);
+  std::vector<char> Data(Header.Size);
+  if (!ReadStream || !FCompression::UncompressMemory(
+      NAME_Zlib, Data.data(), Header.Size, Compressed.data(), Header.StoredSize))
+  {
+    return false;
+  }
+
+  FVector Position;
+  uint32_t NumParticles = 0;
+  std::memcpy(&Position, Data.data(), sizeof(FVector));
+  std::memcpy(&NumParticles, Data.data() + sizeof(FVector), sizeof(uint32_t));
+  if (Header.Size != sizeof(FVector) + sizeof(uint32_t) + NumParticles * sizeof(FParticle))
+  {
+    return false;
+  }
+  TilePosition = FDVector(Position);
+  Particles.resize(NumParticles);
+  std::memcpy(Particles.data(), Data.data() + sizeof(FVector) + sizeof(uint32_t),
+      NumParticles * sizeof(FParticle));
+  return true;
+}
+
 FDenseTile::FDenseTile(){
   Particles.clear();
   ParticlesHeightMap.clear();
@@ -159,6 +240,8 @@ FDenseTile::FDenseTile(const FDenseTile& Origin){
   TilePosition = Origin.TilePosition;
   SavePath = Origin.SavePath;
   bHeightmapNeedToUpdate = false;
+  PartialHeightMapSize = Origin.PartialHeightMapSize;
+  TileSize = Origin.TileSize;
   Particles = Origin.Particles;
   ParticlesHeightMap = Origin.ParticlesHeightMap;
   ParticlesZOrdered = Origin.ParticlesZOrdered;
@@ -168,6 +251,8 @@ FDenseTile::FDenseTile(FDenseTile&& Origin){
   TilePosition = Origin.TilePosition;
   SavePath = Origin.SavePath;
   bHeightmapNeedToUpdate = false;
+  PartialHeightMapSize = Origin.PartialHeightMapSize;
+  TileSize = Origin.TileSize;
   Particles = std::move(Origin.Particles);
   ParticlesHeightMap = std::move(Origin.ParticlesHeightMap);
   ParticlesZOrdered = std::move(Origin.ParticlesZOrdered);
@@ -178,6 +263,8 @@ FDenseTile& FDenseTile::operator=(FDenseTile&& Origin)
   TilePosition = Origin.TilePosition;
   SavePath = Origin.SavePath;
   bHeightmapNeedToUpdate = false;
+  PartialHeightMapSize = Origin.PartialHeightMapSize;
+  TileSize = Origin.TileSize;
   Particles = std::move(Origin.Particles);
   ParticlesHeightMap = std::move(Origin.ParticlesHeightMap);
   ParticlesZOrdered = std::move(Origin.ParticlesZOrdered);
@@ -192,9 +279,15 @@ void FDenseTile::InitializeTile(uint32_t TextureSize, float AffectedRadius, floa
   TileSize = (TileEnd.X - TileOrigin.X );
   PartialHeightMapSize = TileSize * TextureSize / (2*AffectedRadius);
   std::string FileName = std::string(TCHAR_TO_UTF8(*( SavePath + TileOrigin.ToString() + ".tile" ) ) );
+  FString CompressedFileName = GetCompressedTileFileName(SavePath, TileOrigin);
   
   //UE_LOG(LogCarla, Log, TEXT("Tile origin %s"), *TileOrigin.ToString() );
-  if( FPaths::FileExists(FString(FileName.c_str())) )
+  if( FPaths::FileExists(CompressedFileName) &&
+      ReadCompressedTile(CompressedFileName, TilePosition, Particles) )
+  {
+    // Written by WriteCompressedTile, older tiles are read below
+  }
+  else if( FPaths::FileExists(FString(FileName.c_str())) )
   {
     
     TRACE_CPUPROFILER_EVENT_SCOPE(DenseTile::InitializeTile::Read);
@@ -739,6 +832,8 @@ void FSparseHighDetailMap::UpdateHeightMap(UHeightMapDataAsset* DataAsset,
       FDVector Origin, FDVector MapSize, float Size,
       float ScaleZ)
 {
+  // The tiles worker builds new tiles from the height map
+  FScopeLock ScopeLock(&Lock_Heightmap);
   Heightmap.Clear();
   Heightmap.InitializeHeightmap(
       DataAsset, Extension, Origin, 
@@ -753,7 +848,8 @@ void FSparseHighDetailMap::Clear()
 }
 
 void FSparseHighDetailMap::UpdateMaps(
-    FDVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY)
+    FDVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY,
+    FDVector PrefetchPosition)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::UpdateMaps);
   double MinX = Position.X - RadiusX;
@@ -769,6 +865,12 @@ void FSparseHighDetailMap::UpdateMaps(
   FIntVector CacheMaxVector = GetVectorTileId(
       FDVector(Position.X + CacheRadiusX, Position.Y + CacheRadiusY, 0));
 
+  // Where the vehicle is heading, those tiles are loaded before they are needed
+  FIntVector PrefetchMinVector = GetVectorTileId(
+      FDVector(PrefetchPosition.X - RadiusX, PrefetchPosition.Y - RadiusY, 0));
+  FIntVector PrefetchMaxVector = GetVectorTileId(
+      FDVector(PrefetchPosition.X + RadiusX, PrefetchPosition.Y + RadiusY, 0));
+
   auto IsInCacheRange = [&](int32_t Tile_X, int32_t Tile_Y) -> bool
   {
     return Tile_X >= CacheMinVector.X && Tile_X <= CacheMaxVector.X &&
@@ -779,6 +881,7 @@ void FSparseHighDetailMap::UpdateMaps(
     return Tile_X >= MinVector.X && Tile_X <= MaxVector.X &&
            Tile_Y >= MinVector.Y && Tile_Y <= MaxVector.Y;
   };
+  std::vector<uint64_t> TilesToLoad;
   {
     FScopeLock ScopeLock(&Lock_Map);
     FScopeLock ScopeCacheLock(&Lock_CacheMap);
@@ -799,12 +902,67 @@ void FSparseHighDetailMap::UpdateMaps(
     {
       Map.erase(TileId);
     }
+
+    // mark the tiles needed now and soon, the missing ones are loaded below
+    ++UseCounter;
+    auto MarkTiles = [&](const FIntVector& From, const FIntVector& To)
+    {
+      for (int32_t Tile_X = From.X; Tile_X <= To.X; ++Tile_X)
+      {
+        for (int32_t Tile_Y = From.Y; Tile_Y <= To.Y; ++Tile_Y)
+        {
+          uint64_t TileId = GetTileId(Tile_X, Tile_Y);
+          uint64_t& LastUse = TileLastUse[TileId];
+          if (LastUse != UseCounter && Map.count(TileId) == 0 && CacheMap.count(TileId) == 0)
+          {
+            TilesToLoad.emplace_back(TileId);
+          }
+          LastUse = UseCounter;
+        }
+      }
+    };
+    MarkTiles(MinVector, MaxVector);
+    MarkTiles(PrefetchMinVector, PrefetchMaxVector);
   }
+
+  if (TilesToLoad.size())
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(LoadTiles);
+    // Read from disk or create the tiles without holding the map locks, the
+    // game thread keeps simulating meanwhile
+    std::vector<FDenseTile> LoadedTiles(TilesToLoad.size());
+    {
+      FScopeLock ScopeLock(&Lock_Heightmap);
+      ParallelFor(TilesToLoad.size(), [&](int32 Idx)
+      {
+        FDVector TileCenter = GetTilePosition(TilesToLoad[Idx]);
+        LoadedTiles[Idx].InitializeTile(
+            TextureSize, AffectedRadius,
+            ParticleSize, TerrainDepth,
+            TileCenter, TileCenter + FDVector(TileSize, TileSize, 0.f),
+            SavePath, Heightmap);
+      });
+    }
+    FScopeLock ScopeLock(&Lock_Map);
+    FScopeLock ScopeCacheLock(&Lock_CacheMap);
+    for (size_t i = 0; i < TilesToLoad.size(); ++i)
+    {
+      // the game thread may have created it in the meantime
+      if (Map.count(TilesToLoad[i]) == 0)
+      {
+        CacheMap.emplace(TilesToLoad[i], std::move(LoadedTiles[i]));
+      }
+    }
+  }
+
+  std::vector<FDenseTile> TilesToSave;
   {
     FScopeLock ScopeCacheLock(&Lock_CacheMap);
     TRACE_CPUPROFILER_EVENT_SCOPE(UpdateCache);
     
-    // unload extra tiles
+    // unload the tiles out of the cache range, then the least recently used
+    // ones until the cache fits, never the ones needed in this pass
+    std::vector<std::pair<uint64_t, uint64_t>> Candidates;
     std::vector<uint64_t> TilesToErase;
     {
       TRACE_CPUPROFILER_EVENT_SCOPE(GetTilesToErase);
@@ -812,37 +970,50 @@ void FSparseHighDetailMap::UpdateMaps(
       {
         uint64_t TileId = Element.first;
         FIntVector VectorTileId = GetVectorTileId(TileId);
+        uint64_t LastUse = TileLastUse[TileId];
         if (!IsInCacheRange(VectorTileId.X, VectorTileId.Y))
         {
           TilesToErase.emplace_back(TileId);
         }
+        else if (LastUse != UseCounter)
+        {
+          Candidates.emplace_back(LastUse, TileId);
+        }
+      }
+      size_t CacheSize = CacheMap.size() - TilesToErase.size();
+      if (CacheSize > MaxCachedTiles)
+      {
+        size_t NumToEvict = std::min(CacheSize - MaxCachedTiles, Candidates.size());
+        std::partial_sort(Candidates.begin(), Candidates.begin() + NumToEvict, Candidates.end());
+        for (size_t i = 0; i < NumToEvict; ++i)
+        {
+          TilesToErase.emplace_back(Candidates[i].second);
+        }
       }
     }
 
     {
-      TRACE_CPUPROFILER_EVENT_SCOPE(EraseTiles);
-      ParallelFor(TilesToErase.size(), [&](int32 Idx)
-      {
-        TRACE_CPUPROFILER_EVENT_SCOPE(SaveData);
-        uint64_t TileId = TilesToErase[Idx];
-        auto& Tile = CacheMap[TileId];
-        std::string FileToSavePath = std::string(
-              TCHAR_TO_UTF8(*( SavePath + Tile.TilePosition.ToString() + ".tile")));
-        std::ofstream OutputStream(FileToSavePath.c_str());
-        WriteFVector(OutputStream, Tile.TilePosition.ToFVector());
-        WriteStdVector<FParticle> (OutputStream, Tile.Particles);
-        OutputStream.close();
-      });
+      TRACE_CPUPROFILER_EVENT_SCOPE(CacheMap.erase);
+      TilesToSave.reserve(TilesToErase.size());
+      for (uint64_t TileId : TilesToErase)
       {
-        TRACE_CPUPROFILER_EVENT_SCOPE(CacheMap.erase);
-        for (uint64_t TileId : TilesToErase)
-        {
-          CacheMap.erase(TileId); 
-        }
+        auto Iterator = CacheMap.find(TileId);
+        TilesToSave.emplace_back(std::move(Iterator->second));
+        CacheMap.erase(Iterator);
+        TileLastUse.erase(TileId);
       }
     }
   }
 
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(EraseTiles);
+    // the evicted tiles are owned by this thread now, no lock is needed
+    ParallelFor(TilesToSave.size(), [&](int32 Idx)
+    {
+      TRACE_CPUPROFILER_EVENT_SCOPE(SaveData);
+      WriteCompressedTile(SavePath, TilesToSave[Idx]);
+    });
+  }
 }
 
 void FSparseHighDetailMap::Update(FVector Position, float RadiusX, float RadiusY)
@@ -890,26 +1061,22 @@ void FSparseHighDetailMap::SaveMap()
 {
   UE_LOG(LogCarla, Warning, TEXT("Save directory %s"), *SavePath );
   TRACE_CPUPROFILER_EVENT_SCOPE(FSparseHighDetailMap::SaveMap);
-  ParallelFor(Map.size(), [this](int32 Idx)
-  {
-    std::pair<uint64_t, FDenseTile> it = *(std::next(this->Map.begin(), Idx) );
-    std::string FileToSavePath = std::string(TCHAR_TO_UTF8(*( this->SavePath + it.second.TilePosition.ToString() + ".tile")));
-    std::ofstream OutputStream(FileToSavePath.c_str());
-    WriteFVector(OutputStream, it.second.TilePosition.ToFVector());
-    WriteStdVector<FParticle> (OutputStream, it.second.Particles);
-    OutputStream.close();
-  });
-  
-  ParallelFor(CacheMap.size(), [this](int32 Idx)
-  {
-    std::pair<uint64_t, FDenseTile> it = *(std::next(this->CacheMap.begin(), Idx) );
-    std::string FileToSavePath = std::string(TCHAR_TO_UTF8(*( this->SavePath + it.second.TilePosition.ToString() + ".tile")));
-    std::ofstream OutputStream(FileToSavePath.c_str());
-    WriteFVector(OutputStream, it.second.TilePosition.ToFVector());
-    WriteStdVector<FParticle> (OutputStream, it.second.Particles);
-    OutputStream.close();
+  FScopeLock ScopeLock(&Lock_Map);
+  FScopeLock ScopeCacheLock(&Lock_CacheMap);
+  std::vector<const FDenseTile*> Tiles;
+  Tiles.reserve(Map.size() + CacheMap.size());
+  for (auto& Element : Map)
+  {
+    Tiles.emplace_back(&Element.second);
+  }
+  for (auto& Element : CacheMap)
+  {
+    Tiles.emplace_back(&Element.second);
+  }
+  ParallelFor(Tiles.size(), [&](int32 Idx)
+  {
+    WriteCompressedTile(SavePath, *Tiles[Idx]);
   });
-
 }
 
 void UCustomTerrainPhysicsComponent::UpdateTexture()
@@ -1192,6 +1359,15 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
   {
     CacheRadius = MToCM*FVector(Value, Value, 0.f);
   }
+  if (FParse::Value(FCommandLine::Get(), TEXT("-tile-prefetch-time="), Value))
+  {
+    TilePrefetchTime = Value;
+  }
+  int32 IntValue = 0;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-max-cached-tiles="), IntValue))
+  {
+    MaxCachedTiles = IntValue;
+  }
   if (FParse::Param(FCommandLine::Get(), TEXT("-update-particles")))
   {
     bUpdateParticles = true;
@@ -1255,6 +1431,10 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
   {
     bRemoveLandscapeColliders = true;
   }
+  if (FParse::Param(FCommandLine::Get(), TEXT("-terrain-gpu")))
+  {
+    bUseGPUTerrain = true;
+  }
   if (FParse::Param(FCommandLine::Get(), TEXT("-disable-terramechanics")))
   {
     SetComponentTickEnabled(false);
@@ -1279,6 +1459,7 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
         TEXT("ParticleDiameter %f"), ParticleDiameter);
 
     SparseMap.Init(TextureToUpdate->GetSizeX(), TextureRadius, ParticleDiameter * CMToM, TerrainDepth * CMToM, FloorHeight * CMToM );
+    SparseMap.SetMaxCachedTiles(FMath::Max(MaxCachedTiles, 0));
     RootComponent = Cast<UPrimitiveComponent>(GetOwner()->GetRootComponent());
     if(LargeMapManager)
     {
@@ -1299,7 +1480,7 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(LoadNNModel);
     carla::learning::test_learning();
-    TerramechanicsModel.LoadModel(TCHAR_TO_ANSI(*NeuralModelFile), CUDADevice);
+    TerramechanicsModel.LoadModel(TCHAR_TO_ANSI(*NeuralModelFile), CUDADevice, bOptimizeNeuralModel);
   }
 #endif
 
@@ -1330,6 +1511,19 @@ void UCustomTerrainPhysicsComponent::BeginPlay()
   }
   
   InitTexture();
+
+  if (bUseGPUTerrain)
+  {
+    if (GMaxRHIFeatureLevel >= ERHIFeatureLevel::SM5 && TextureToUpdate)
+    {
+      TerrainPass = std::make_shared<FTerrainDeformationPass>();
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning,
+          TEXT("GPU terrain requires SM5 and a deformation texture, using the CPU path"));
+    }
+  }
   
   UE_LOG(LogCarla, Log, TEXT("MainThread Data ArraySize %d "), Data.Num());
   UE_LOG(LogCarla, Log, TEXT("Map Size %d "), SparseMap.Map.size() );
@@ -1414,6 +1608,17 @@ void UCustomTerrainPhysicsComponent::TickComponent(float DeltaTime,
   TArray<AActor*> VehiclesActors;
   UGameplayStatics::GetAllActorsOfClass(GetWorld(), ACarlaWheeledVehicle::StaticClass(), VehiclesActors);
   UCarlaEpisode* Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+  if (TerrainPass)
+  {
+    TArray<FTerrainWheelForce> LatestForces;
+    TerrainPass->GetLatestForces(LatestForces);
+    GpuWheelForces.Reset();
+    for (const FTerrainWheelForce& Force : LatestForces)
+    {
+      GpuWheelForces.Add(Force.Tag, Force);
+    }
+  }
+  TArray<ACarlaWheeledVehicle*> NNVehicles;
   for (AActor* VehicleActor : VehiclesActors)
   {
 
@@ -1482,10 +1687,26 @@ void UCustomTerrainPhysicsComponent::TickComponent(float DeltaTime,
       }
     }
 
-    SparseMap.LockMutex();
-    RunNNPhysicsSimulation(Vehicle, DeltaTime);
-    LastUpdatedPosition = GlobalLocation;
-    SparseMap.UnLockMutex();
+    if (TerrainPass)
+    {
+      RunGPUTerrainSimulation(Vehicle, CarlaActor->GetActorId());
+      LastUpdatedPosition = GlobalLocation;
+      LastUpdatedVelocity = Vehicle->GetVelocity();
+    }
+    else if (bBatchNeuralModel)
+    {
+      NNVehicles.Add(Vehicle);
+      LastUpdatedPosition = GlobalLocation;
+      LastUpdatedVelocity = Vehicle->GetVelocity();
+    }
+    else
+    {
+      SparseMap.LockMutex();
+      RunNNPhysicsSimulation(Vehicle, DeltaTime);
+      LastUpdatedPosition = GlobalLocation;
+      LastUpdatedVelocity = Vehicle->GetVelocity();
+      SparseMap.UnLockMutex();
+    }
 
     if (bDrawLoadedTiles)
     {
@@ -1529,6 +1750,17 @@ void UCustomTerrainPhysicsComponent::TickComponent(float DeltaTime,
     }
   }
 
+  if (TerrainPass)
+  {
+    DispatchGPUTerrain();
+  }
+  else if (NNVehicles.Num())
+  {
+    SparseMap.LockMutex();
+    RunNNPhysicsSimulationBatch(NNVehicles, DeltaTime);
+    SparseMap.UnLockMutex();
+  }
+
   if (bDrawHeightMap)
   {
     TRACE_CPUPROFILER_EVENT_SCOPE(DrawHeightMap);
@@ -1777,11 +2009,79 @@ void UCustomTerrainPhysicsComponent::GenerateBenchmarkParticles(std::vector<FPar
   UE_LOG(LogCarla, Log, TEXT("Generated %d particles"), BenchParticles.size());
 }
 
+#ifdef WITH_PYTORCH
+// Input of the neural model for one vehicle, together with the data needed to
+// apply its output
+struct FNNVehicleInput
+{
+  ACarlaWheeledVehicle* Vehicle = nullptr;
+  FTransform WheelTransforms[4];
+  std::vector<FParticle*> Particles[4];
+  std::vector<FParticle> BenchParticles;
+  // Storage of the arrays Input points to
+  TArray<TArray<float>> Arrays;
+  carla::learning::Inputs Input;
+};
+#endif
+
 void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
     ACarlaWheeledVehicle *Vehicle, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(RunNNPhysicsSimulation);
   #ifdef WITH_PYTORCH
+  FNNVehicleInput VehicleInput;
+  SetUpNNVehicleInput(Vehicle, VehicleInput);
+  TerramechanicsModel.SetInputs(VehicleInput.Input);
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(RunModel);
+    if(bUseCUDAModel)
+    {
+      TerramechanicsModel.ForwardCUDATensors();
+    }
+    else if(bUseDynamicModel)
+    {
+      TerramechanicsModel.ForwardDynamic();
+    }
+    else 
+    {
+      TerramechanicsModel.Forward();
+    }
+  }
+  ApplyNNVehicleOutput(VehicleInput, TerramechanicsModel.GetOutputs(), DeltaTime);
+  #endif
+}
+
+void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulationBatch(
+    const TArray<ACarlaWheeledVehicle*> &BatchVehicles, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(RunNNPhysicsSimulationBatch);
+  #ifdef WITH_PYTORCH
+  // Every vehicle reads the particles before any of them is moved, the model
+  // runs once for all of them
+  std::vector<FNNVehicleInput> VehicleInputs(BatchVehicles.Num());
+  std::vector<carla::learning::Inputs> Inputs;
+  Inputs.reserve(VehicleInputs.size());
+  for (int32 i = 0; i < BatchVehicles.Num(); ++i)
+  {
+    SetUpNNVehicleInput(BatchVehicles[i], VehicleInputs[i]);
+    Inputs.push_back(VehicleInputs[i].Input);
+  }
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(RunModelBatch);
+    TerramechanicsModel.ForwardBatch(Inputs, BatchOutputs, bUseCUDAModel);
+  }
+  for (size_t i = 0; i < VehicleInputs.size(); ++i)
+  {
+    ApplyNNVehicleOutput(VehicleInputs[i], BatchOutputs[i], DeltaTime);
+  }
+  #endif
+}
+
+#ifdef WITH_PYTORCH
+void UCustomTerrainPhysicsComponent::SetUpNNVehicleInput(
+    ACarlaWheeledVehicle *Vehicle, FNNVehicleInput &VehicleInput)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(SetUpNNVehicleInput);
   FTransform VehicleTransform = Vehicle->GetTransform();
   FTransform WheelTransform0 = VehicleTransform;
   FTransform WheelTransform1 = VehicleTransform;
@@ -1937,23 +2237,42 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
   {
     NNInput.throttle *= -1;
   }
-  TerramechanicsModel.SetInputs(NNInput);
-  {
-    TRACE_CPUPROFILER_EVENT_SCOPE(RunModel);
-    if(bUseCUDAModel)
-    {
-      TerramechanicsModel.ForwardCUDATensors();
-    }
-    else if(bUseDynamicModel)
-    {
-      TerramechanicsModel.ForwardDynamic();
-    }
-    else 
-    {
-      TerramechanicsModel.Forward();
-    }
-  }
-  carla::learning::Outputs& Output = TerramechanicsModel.GetOutputs();
+
+  // The model input points to these arrays, moving them keeps their memory
+  VehicleInput.Vehicle = Vehicle;
+  VehicleInput.WheelTransforms[0] = WheelTransform0;
+  VehicleInput.WheelTransforms[1] = WheelTransform1;
+  VehicleInput.WheelTransforms[2] = WheelTransform2;
+  VehicleInput.WheelTransforms[3] = WheelTransform3;
+  VehicleInput.Particles[0] = std::move(ParticlesWheel0);
+  VehicleInput.Particles[1] = std::move(ParticlesWheel1);
+  VehicleInput.Particles[2] = std::move(ParticlesWheel2);
+  VehicleInput.Particles[3] = std::move(ParticlesWheel3);
+  VehicleInput.BenchParticles = std::move(BenchParticles);
+  for (TArray<float>* Array : {
+      &ParticlePos0, &ParticleVel0, &WheelPos0, &WheelOrient0, &WheelLinVel0, &WheelAngVel0,
+      &ParticlePos1, &ParticleVel1, &WheelPos1, &WheelOrient1, &WheelLinVel1, &WheelAngVel1,
+      &ParticlePos2, &ParticleVel2, &WheelPos2, &WheelOrient2, &WheelLinVel2, &WheelAngVel2,
+      &ParticlePos3, &ParticleVel3, &WheelPos3, &WheelOrient3, &WheelLinVel3, &WheelAngVel3})
+  {
+    VehicleInput.Arrays.Emplace(MoveTemp(*Array));
+  }
+  VehicleInput.Input = NNInput;
+}
+
+void UCustomTerrainPhysicsComponent::ApplyNNVehicleOutput(
+    FNNVehicleInput &VehicleInput, carla::learning::Outputs &Output, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ApplyNNVehicleOutput);
+  ACarlaWheeledVehicle *Vehicle = VehicleInput.Vehicle;
+  std::vector<FParticle*> &ParticlesWheel0 = VehicleInput.Particles[0];
+  std::vector<FParticle*> &ParticlesWheel1 = VehicleInput.Particles[1];
+  std::vector<FParticle*> &ParticlesWheel2 = VehicleInput.Particles[2];
+  std::vector<FParticle*> &ParticlesWheel3 = VehicleInput.Particles[3];
+  const FTransform &WheelTransform0 = VehicleInput.WheelTransforms[0];
+  const FTransform &WheelTransform1 = VehicleInput.WheelTransforms[1];
+  const FTransform &WheelTransform2 = VehicleInput.WheelTransforms[2];
+  const FTransform &WheelTransform3 = VehicleInput.WheelTransforms[3];
 
   if(bUpdateParticles)
   {
@@ -2041,7 +2360,120 @@ void UCustomTerrainPhysicsComponent::RunNNPhysicsSimulation(
             Output.wheel3.wheel_torque_y,
             Output.wheel3.wheel_torque_z)));
   }
-  #endif
+}
+#endif
+
+void UCustomTerrainPhysicsComponent::RunGPUTerrainSimulation(
+    ACarlaWheeledVehicle *Vehicle, uint32 ActorId)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(RunGPUTerrainSimulation);
+  static const FVector WheelOffsets[4] = {
+      FVector(140, -70, 40), FVector(140, 70, 40),
+      FVector(-140, -70, 40), FVector(-140, 70, 40)};
+
+  UPrimitiveComponent* PrimitiveComponent =
+      Cast<UPrimitiveComponent>(Vehicle->GetRootComponent());
+  FTransform VehicleTransform = Vehicle->GetTransform();
+  FVector2D Forward = FVector2D(UEFrameToSIDirection(VehicleTransform.GetUnitAxis(EAxis::X))).GetSafeNormal();
+  FVector2D MotionDirection = FVector2D(Vehicle->GetVelocity()).GetSafeNormal();
+  const float Exponent = SoilSinkageExponent;
+
+  for (uint32 WheelIdx = 0; WheelIdx < 4; ++WheelIdx)
+  {
+    FVector WheelPosition = VehicleTransform.TransformPosition(WheelOffsets[WheelIdx]);
+    FVector GlobalWheelPosition = WheelPosition;
+    if(LargeMapManager)
+    {
+      GlobalWheelPosition = LargeMapManager->LocalToGlobalLocation(WheelPosition);
+    }
+    const uint64 Tag = (static_cast<uint64>(ActorId) << 2) | WheelIdx;
+
+    FTerrainGpuWheel& Wheel = GpuWheels.AddDefaulted_GetRef();
+    Wheel.Center = UEFrameToSI(GlobalWheelPosition);
+    Wheel.Radius = UEFrameToSI(TireRadius);
+    Wheel.Forward = Forward;
+    Wheel.HalfWidth = 0.5f * UEFrameToSI(TireWidth);
+    GpuWheelTags.Add(Tag);
+
+    // Forces of a previous frame, the read back never waits for the GPU
+    const FTerrainWheelForce* Force = GpuWheelForces.Find(Tag);
+    if (!Force || !PrimitiveComponent)
+    {
+      continue;
+    }
+    // Bekker compaction resistance: (kc + b kphi) z^(n+1) / (n+1)
+    float Resistance = (SoilCohesiveModulus + UEFrameToSI(TireWidth) * SoilFrictionalModulus) *
+        FMath::Pow(Force->Sinkage, Exponent + 1.f) / (Exponent + 1.f);
+    FVector WheelForce = ForceMulFactor * MToCM * FVector(
+        -Resistance * MotionDirection.X,
+        -Resistance * MotionDirection.Y,
+        Force->NormalForce);
+    PrimitiveComponent->AddForceAtLocation(
+        WheelForce.GetClampedToMaxSize(MaxForceMagnitude), WheelPosition);
+  }
+}
+
+void UCustomTerrainPhysicsComponent::DispatchGPUTerrain()
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(DispatchGPUTerrain);
+  if (!TextureToUpdate || !TextureToUpdate->Resource)
+  {
+    GpuWheels.Reset();
+    GpuWheelTags.Reset();
+    return;
+  }
+
+  // The height map only changes when a new large map tile is entered
+  const FHeightMapData& HeightMap = SparseMap.GetHeightMap();
+  bool bUploadHeightMap = HeightMap.Version != UploadedHeightMapVersion;
+  TArray<float> Heights;
+  if (bUploadHeightMap)
+  {
+    Heights.Append(HeightMap.Pixels.data(), static_cast<int32>(HeightMap.Pixels.size()));
+    UploadedHeightMapVersion = HeightMap.Version;
+  }
+  FIntPoint HeightMapSize(HeightMap.Size_X, HeightMap.Size_Y);
+  FVector2D HeightMapOrigin(HeightMap.Tile0Position.X, HeightMap.Tile0Position.Y);
+  FVector2D HeightMapWorldSize(HeightMap.WorldSize.X, HeightMap.WorldSize.Y);
+
+  // Same region as UpdateLoadedTextureDataRegions
+  FDVector TextureCenterPosition = UEFrameToSI(GetTileCenter(LastUpdatedPosition));
+  FVector2D FieldOrigin(
+      TextureCenterPosition.X - TextureRadius, TextureCenterPosition.Y - TextureRadius);
+
+  FTerrainDeformationParameters Parameters;
+  Parameters.FieldOrigin = FieldOrigin;
+  Parameters.TexelSize = (2.0f * TextureRadius) / TextureToUpdate->GetSizeX();
+  if (bGpuFieldOriginValid)
+  {
+    FVector2D Shift = (FieldOrigin - GpuFieldOrigin) / Parameters.TexelSize;
+    Parameters.Shift = FIntPoint(FMath::RoundToInt(Shift.X), FMath::RoundToInt(Shift.Y));
+  }
+  GpuFieldOrigin = FieldOrigin;
+  bGpuFieldOriginValid = true;
+  Parameters.CohesiveModulus = SoilCohesiveModulus;
+  Parameters.FrictionalModulus = SoilFrictionalModulus;
+  Parameters.SinkageExponent = SoilSinkageExponent;
+  Parameters.MaxSinkage = UEFrameToSI(TerrainDepth);
+  Parameters.MinDisplacement = MinDisplacement;
+  Parameters.MaxDisplacement = MaxDisplacement;
+
+  ENQUEUE_RENDER_COMMAND(UpdateTerrainDeformation)
+  (
+    [Pass=TerrainPass, Parameters, Wheels=MoveTemp(GpuWheels), Tags=MoveTemp(GpuWheelTags),
+        Heights=MoveTemp(Heights), bUploadHeightMap, HeightMapSize, HeightMapOrigin,
+        HeightMapWorldSize, Texture=TextureToUpdate](FRHICommandListImmediate &InRHICmdList)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UCustomTerrainPhysicsComponent::DispatchGPUTerrain Renderthread"));
+    if (bUploadHeightMap)
+    {
+      Pass->SetHeightMap(InRHICmdList, Heights, HeightMapSize, HeightMapOrigin, HeightMapWorldSize);
+    }
+    FTexture2DResource* Resource = (FTexture2DResource*)Texture->Resource;
+    Pass->Execute(InRHICmdList, Parameters, Wheels, Tags, Resource->GetTexture2DRHI());
+  });
+  GpuWheels.Reset();
+  GpuWheelTags.Reset();
 }
 
 void UCustomTerrainPhysicsComponent::UpdateParticles(
@@ -2622,8 +3054,9 @@ void UCustomTerrainPhysicsComponent::ApplyForces()
 void UCustomTerrainPhysicsComponent::UpdateMaps(
     FVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY)
 {
+  FVector PrefetchPosition = Position + TilePrefetchTime * LastUpdatedVelocity;
   SparseMap.UpdateMaps(UEFrameToSI(Position), UEFrameToSI(RadiusX), UEFrameToSI(RadiusY), 
-      UEFrameToSI(CacheRadiusX), UEFrameToSI(CacheRadiusY));
+      UEFrameToSI(CacheRadiusX), UEFrameToSI(CacheRadiusY), UEFrameToSI(PrefetchPosition));
 }
 
 FTilesWorker::FTilesWorker(UCustomTerrainPhysicsComponent* TerrainComp, FVector NewPosition, float NewRadiusX, float NewRadiusY )
@@ -2655,6 +3088,10 @@ uint32 FTilesWorker::Run(){
           CustomTerrainComp->TileRadius.X, CustomTerrainComp->TileRadius.Y,
           CustomTerrainComp->CacheRadius.X, CustomTerrainComp->CacheRadius.Y);
     }
+    else
+    {
+      FPlatformProcess::Sleep(0.001f * CustomTerrainComp->TimeToTriggerLoadTiles);
+    }
     if(!bShouldContinue)
     {
       break;
@@ -17,12 +17,14 @@
 #include "Carla/MapGen/LargeMapManager.h"
 #include "Engine/DataAsset.h"
 #include "Async/Future.h"
+#include "TerrainDeformationPass.h"
 #ifdef WITH_PYTORCH
 THIRD_PARTY_INCLUDES_START
 #include <carla/pytorch/pytorch.h>
 THIRD_PARTY_INCLUDES_END
 #endif
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include "Misc/ScopeLock.h"
@@ -30,6 +32,8 @@ THIRD_PARTY_INCLUDES_END
 
 #include "CustomTerrainPhysicsComponent.generated.h"
 
+struct FNNVehicleInput;
+
 
 UENUM(BlueprintType)
 enum EDefResolutionType
@@ -78,6 +82,8 @@ struct FHeightMapData
   float Scale_Z = 1;
   FDVector Tile0Position;
   std::vector<float> Pixels;
+  // Incremented on every InitializeHeightmap, to know when to upload it again.
+  uint32_t Version = 0;
 };
 
 struct FDenseTile
@@ -159,16 +165,30 @@ public:
     return Heightmap.GetHeight(Position);
   }
 
+  const FHeightMapData& GetHeightMap() const {
+    return Heightmap;
+  }
+
   void InitializeMap(UHeightMapDataAsset* DataAsset,
       FDVector Origin, FDVector MapSize, float Size, float ScaleZ);
 
   void UpdateHeightMap(UHeightMapDataAsset* DataAsset,
       FDVector Origin, FDVector MapSize, float Size, float ScaleZ);
 
-  void UpdateMaps(FDVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY);
+  // Called from the tiles worker: loads or creates the tiles around Position
+  // and PrefetchPosition into the cache without holding the locks, and writes
+  // the evicted ones to disk compressed.
+  void UpdateMaps(FDVector Position, float RadiusX, float RadiusY, float CacheRadiusX, float CacheRadiusY,
+      FDVector PrefetchPosition);
 
   void Update(FVector Position, float RadiusX, float RadiusY);
 
+  // Tiles kept in the cache at most, the least recently used are evicted first
+  void SetMaxCachedTiles(uint32_t NewMaxCachedTiles)
+  {
+    MaxCachedTiles = NewMaxCachedTiles;
+  }
+
   void SaveMap();
 
   void Clear();
@@ -208,6 +228,10 @@ public:
   FCriticalSection Lock_Particles;
 private:
   std::unordered_map<uint64_t, FDenseTile> TilesToWrite;
+  // Last UpdateMaps pass that needed each cached tile
+  std::unordered_map<uint64_t, uint64_t> TileLastUse;
+  uint64_t UseCounter = 0;
+  uint32_t MaxCachedTiles = 1024;
   FDVector Tile0Position;
   FDVector Extension;
   float TileSize = 1.f; // 1m per tile
@@ -222,6 +246,7 @@ private:
   FCriticalSection Lock_CacheMap; // UE4 Mutex
   FCriticalSection Lock_GetTile;
   FCriticalSection Lock_Position; // UE4 Mutex
+  FCriticalSection Lock_Heightmap;
 
 };
 
@@ -314,6 +339,7 @@ public:
   FVector NextPositionToUpdate = FVector(0,0,0);
   
   FVector LastUpdatedPosition;
+  FVector LastUpdatedVelocity = FVector(0,0,0);
   FVector CachePosition;
 
   FString SavePath;
@@ -334,6 +360,20 @@ private:
 
   void RunNNPhysicsSimulation(
       ACarlaWheeledVehicle *Vehicle, float DeltaTime);
+  // Runs the neural model once for all the vehicles
+  void RunNNPhysicsSimulationBatch(
+      const TArray<ACarlaWheeledVehicle*> &BatchVehicles, float DeltaTime);
+  #ifdef WITH_PYTORCH
+  void SetUpNNVehicleInput(
+      ACarlaWheeledVehicle *Vehicle, FNNVehicleInput &VehicleInput);
+  void ApplyNNVehicleOutput(
+      FNNVehicleInput &VehicleInput, carla::learning::Outputs &Output, float DeltaTime);
+  #endif
+  // Applies the forces read back from the GPU and queues the wheels of the
+  // vehicle for the next dispatch.
+  void RunGPUTerrainSimulation(
+      ACarlaWheeledVehicle *Vehicle, uint32 ActorId);
+  void DispatchGPUTerrain();
   // TArray<FParticle*> GetParticlesInRange(...);
   void SetUpParticleArrays(std::vector<FParticle*>& ParticlesIn, 
       TArray<float>& ParticlePosOut, 
@@ -408,6 +448,12 @@ public:
   FVector CacheRadius = FVector( 50, 50, 0 );
   UPROPERTY(EditAnywhere, Category="Tiles")
   bool bDrawLoadedTiles = false;
+  // Maximum number of tiles kept in the cache
+  UPROPERTY(EditAnywhere, Category="Tiles")
+  int32 MaxCachedTiles = 1024;
+  // Tiles where the vehicle will be in this many seconds are loaded ahead
+  UPROPERTY(EditAnywhere, Category="Tiles")
+  float TilePrefetchTime = 1.0f;
   UPROPERTY(EditAnywhere, Category="Tiles")
   int32 TileSize = 1;
   UPROPERTY(EditAnywhere, Category="Tiles")
@@ -465,11 +511,29 @@ private:
   bool bUseDynamicModel = false;
   UPROPERTY(EditAnywhere)
   bool bUseCUDAModel = false;
+  // Runs the neural model once per tick for all the vehicles instead of once
+  // per vehicle
+  UPROPERTY(EditAnywhere)
+  bool bBatchNeuralModel = true;
+  // Freezes and optimizes the TorchScript graph of the model when loading it
+  UPROPERTY(EditAnywhere)
+  bool bOptimizeNeuralModel = false;
 
   UPROPERTY(EditAnywhere)
   float TireRadius = 33.0229f;
   UPROPERTY(EditAnywhere)
   float TireWidth = 21.21f;
+  // Deforms the terrain and computes the wheel forces in a compute shader
+  // with the Bekker pressure-sinkage model instead of the neural model
+  UPROPERTY(EditAnywhere, Category="GPU")
+  bool bUseGPUTerrain = false;
+  // Bekker soil parameters, the defaults are those of dry sand
+  UPROPERTY(EditAnywhere, Category="GPU")
+  float SoilCohesiveModulus = 0.99e3f;
+  UPROPERTY(EditAnywhere, Category="GPU")
+  float SoilFrictionalModulus = 1528.43e3f;
+  UPROPERTY(EditAnywhere, Category="GPU")
+  float SoilSinkageExponent = 1.1f;
   UPROPERTY(EditAnywhere)
   float BoxSearchForwardDistance = 114.39f;
   UPROPERTY(EditAnywhere)
@@ -527,10 +591,19 @@ private:
   TArray<uint8> LargeData;
   #ifdef WITH_PYTORCH
   carla::learning::NeuralModel TerramechanicsModel;
+  std::vector<carla::learning::Outputs> BatchOutputs;
   #endif
 
   TFuture<bool> IterationCompleted;
 
+  std::shared_ptr<FTerrainDeformationPass> TerrainPass;
+  TArray<FTerrainGpuWheel> GpuWheels;
+  TArray<uint64> GpuWheelTags;
+  TMap<uint64, FTerrainWheelForce> GpuWheelForces;
+  uint32_t UploadedHeightMapVersion = 0;
+  FVector2D GpuFieldOrigin = FVector2D::ZeroVector;
+  bool bGpuFieldOriginValid = false;
+
   class FRunnableThread* Thread;
   struct FTilesWorker* TilesWorker;
 };
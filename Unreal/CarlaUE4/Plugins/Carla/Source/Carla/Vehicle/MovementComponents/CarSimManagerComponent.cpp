@@ -21,6 +21,9 @@ void UCarSimManagerComponent::CreateCarsimComponent(
   #ifdef WITH_CARSIM
   UCarSimManagerComponent* CarSimManagerComponent = NewObject<UCarSimManagerComponent>(Vehicle);
   CarSimManagerComponent->SimfilePath = Simfile;
+  // CarSim is stepped by the tick of its own UCarSimMovementComponent, this
+  // one has nothing to do every frame.
+  CarSimManagerComponent->PrimaryComponentTick.bCanEverTick = false;
   Vehicle->SetCarlaMovementComponent(CarSimManagerComponent);
   CarSimManagerComponent->RegisterComponent();
   #else
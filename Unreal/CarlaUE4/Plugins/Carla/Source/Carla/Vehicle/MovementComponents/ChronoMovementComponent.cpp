@@ -17,6 +17,8 @@
 #include "compiler/enable-ue4-macros.h"
 #include "Carla/Util/RayTracer.h"
 
+#include "Async/ParallelFor.h"
+
 
 void UChronoMovementComponent::CreateChronoMovementComponent(
     ACarlaWheeledVehicle* Vehicle,
@@ -86,6 +88,51 @@ FQuat ChronoToUE4Quat(const ChQuaternion<>& quat)
   return FQuat(-quat.e1(), quat.e2(), -quat.e3(), quat.e0());
 }
 
+/// Steps all the Chrono vehicles once per frame. Each vehicle has its own
+/// Chrono system, so they are advanced in parallel on the task graph by the
+/// first of them to tick, and each one then syncs its actor in its own tick.
+class FChronoScheduler
+{
+public:
+
+  static FChronoScheduler &Get()
+  {
+    static FChronoScheduler Instance;
+    return Instance;
+  }
+
+  void Register(UChronoMovementComponent *Component)
+  {
+    Components.AddUnique(Component);
+  }
+
+  void Unregister(UChronoMovementComponent *Component)
+  {
+    Components.RemoveSwap(Component);
+  }
+
+  void Step(uint64 Frame, float DeltaTime)
+  {
+    if (Frame == SteppedFrame)
+    {
+      return;
+    }
+    SteppedFrame = Frame;
+    TRACE_CPUPROFILER_EVENT_SCOPE(FChronoScheduler::Step);
+    ParallelFor(Components.Num(), [&](int32 Index)
+    {
+      Components[Index]->StepChronoSimulation(DeltaTime);
+    },
+    Components.Num() < 2);
+  }
+
+private:
+
+  TArray<UChronoMovementComponent *> Components;
+
+  uint64 SteppedFrame = TNumericLimits<uint64>::Max();
+};
+
 UERayCastTerrain::UERayCastTerrain(
     ACarlaWheeledVehicle* UEVehicle,
     chrono::vehicle::ChVehicle* ChrVehicle)
@@ -162,6 +209,8 @@ void UChronoMovementComponent::BeginPlay()
       this, &UChronoMovementComponent::OnVehicleOverlap);
   CarlaVehicle->GetMesh()->SetCollisionResponseToChannel(
       ECollisionChannel::ECC_WorldStatic, ECollisionResponse::ECR_Overlap);
+
+  FChronoScheduler::Get().Register(this);
 }
 
 void UChronoMovementComponent::InitializeChronoVehicle()
@@ -237,6 +286,13 @@ void UChronoMovementComponent::TickComponent(float DeltaTime,
       FActorComponentTickFunction* ThisTickFunction)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(UChronoMovementComponent::TickComponent);
+  FChronoScheduler::Get().Step(GFrameCounter, DeltaTime);
+  ApplyChronoState();
+}
+
+void UChronoMovementComponent::StepChronoSimulation(float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(UChronoMovementComponent::StepChronoSimulation);
   if (DeltaTime > MaxSubstepDeltaTime)
   {
     uint64_t NumberSubSteps =
@@ -266,7 +322,10 @@ void UChronoMovementComponent::TickComponent(float DeltaTime,
   {
     AdvanceChronoSimulation(DeltaTime);
   }
+}
 
+void UChronoMovementComponent::ApplyChronoState()
+{
   const auto ChronoPositionOffset = ChVector<>(0,0,-0.25f);
   auto VehiclePos = Vehicle->GetVehiclePos() + ChronoPositionOffset;
   auto VehicleRot = Vehicle->GetVehicleRot();
@@ -334,6 +393,7 @@ float UChronoMovementComponent::GetVehicleForwardSpeed() const
 
 void UChronoMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+  FChronoScheduler::Get().Unregister(this);
   if(!CarlaVehicle)
   {
     return;
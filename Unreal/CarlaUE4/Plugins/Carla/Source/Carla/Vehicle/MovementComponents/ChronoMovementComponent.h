@@ -92,6 +92,14 @@ public:
 
   void AdvanceChronoSimulation(float StepSize);
 
+  /// Advance the Chrono system by @a DeltaTime in substeps. Touches only the
+  /// Chrono system of this vehicle and the ray casts of its terrain, so the
+  /// vehicles can be stepped in parallel.
+  void StepChronoSimulation(float DeltaTime);
+
+  /// Move the actor to the current state of the Chrono vehicle.
+  void ApplyChronoState();
+
   virtual FVector GetVelocity() const override;
 
   virtual int32 GetVehicleCurrentGear() const override;
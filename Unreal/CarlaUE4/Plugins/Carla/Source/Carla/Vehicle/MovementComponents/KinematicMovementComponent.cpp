@@ -0,0 +1,286 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "KinematicMovementComponent.h"
+#include "DefaultMovementComponent.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Vehicle/CarlaWheeledVehicle.h"
+
+#include "VehicleWheel.h"
+#include "WheeledVehicleMovementComponent.h"
+
+void UKinematicMovementComponent::CreateKinematicMovementComponent(
+    ACarlaWheeledVehicle* Vehicle,
+    bool bAutomatic)
+{
+  UKinematicMovementComponent* KinematicMovementComponent =
+      NewObject<UKinematicMovementComponent>(Vehicle);
+  KinematicMovementComponent->bAutomatic = bAutomatic;
+  Vehicle->SetCarlaMovementComponent(KinematicMovementComponent);
+  KinematicMovementComponent->RegisterComponent();
+}
+
+void UKinematicMovementComponent::UpdateByDistanceToHero(UCarlaEpisode &Episode, float Distance)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  TArray<FVector, TInlineAllocator<4>> Heroes;
+  TArray<ACarlaWheeledVehicle *> Vehicles;
+  for (auto &Element : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *CarlaActor = Element.Value.Get();
+    if (CarlaActor->GetActorType() != FCarlaActor::ActorType::Vehicle || CarlaActor->IsDormant())
+    {
+      continue;
+    }
+    ACarlaWheeledVehicle *Vehicle = Cast<ACarlaWheeledVehicle>(CarlaActor->GetActor());
+    if (Vehicle == nullptr)
+    {
+      continue;
+    }
+    const FActorAttribute *Role = CarlaActor->GetActorInfo()->Description.Variations.Find("role_name");
+    if (Role != nullptr && Role->Value == "hero")
+    {
+      Heroes.Add(Vehicle->GetActorLocation());
+    }
+    else
+    {
+      Vehicles.Add(Vehicle);
+    }
+  }
+  if (Heroes.Num() == 0)
+  {
+    return;
+  }
+
+  // Some hysteresis, so the vehicles around the threshold do not switch every
+  // frame.
+  const float FarSquared = FMath::Square(Distance);
+  const float NearSquared = FMath::Square(0.9f * Distance);
+  for (ACarlaWheeledVehicle *Vehicle : Vehicles)
+  {
+    const FVector Location = Vehicle->GetActorLocation();
+    float Closest = TNumericLimits<float>::Max();
+    for (const FVector &Hero : Heroes)
+    {
+      Closest = FMath::Min(Closest, FVector::DistSquared(Location, Hero));
+    }
+    UKinematicMovementComponent *Kinematic =
+        Vehicle->GetCarlaMovementComponent<UKinematicMovementComponent>();
+    if (Kinematic != nullptr)
+    {
+      // The ones enabled by the user stay until restore_physx_physics.
+      if (Kinematic->IsAutomatic() && Closest < NearSquared)
+      {
+        Kinematic->DisableKinematicPhysics();
+      }
+    }
+    else if (Closest > FarSquared &&
+             Vehicle->GetCarlaMovementComponent<UDefaultMovementComponent>() != nullptr &&
+             Vehicle->GetMesh()->IsSimulatingPhysics())
+    {
+      // Vehicles teleported by the hybrid mode of the Traffic Manager have
+      // their physics disabled already.
+      CreateKinematicMovementComponent(Vehicle, true);
+    }
+  }
+}
+
+void UKinematicMovementComponent::BeginPlay()
+{
+  Super::BeginPlay();
+  if (!CarlaVehicle)
+  {
+    return;
+  }
+
+  // Keep the speed the vehicle had, read from the body before disabling it.
+  Speed = FVector::DotProduct(
+      UBaseCarlaMovementComponent::GetVelocity(),
+      CarlaVehicle->GetActorForwardVector());
+  VehicleControl = CarlaVehicle->GetVehicleControl();
+  InitializeGeometry();
+
+  DisableUE4VehiclePhysics();
+
+  CarlaVehicle->OnActorHit.AddDynamic(
+      this, &UKinematicMovementComponent::OnVehicleHit);
+}
+
+void UKinematicMovementComponent::InitializeGeometry()
+{
+  const UWheeledVehicleMovementComponent *Movement = CarlaVehicle->GetVehicleMovementComponent();
+  if (Movement != nullptr && Movement->Wheels.Num() > 0 && Movement->Wheels[0] != nullptr)
+  {
+    MaxSteerAngle = Movement->Wheels[0]->SteerAngle;
+  }
+
+  // Front wheels come first, as in FVehiclePhysicsControl.
+  const FTransform &Transform = CarlaVehicle->GetActorTransform();
+  const int32 NumWheels = (Movement != nullptr) ? Movement->WheelSetups.Num() : 0;
+  if (NumWheels >= 2)
+  {
+    const int32 NumFront = NumWheels / 2;
+    float Front = 0.0f;
+    float Rear = 0.0f;
+    for (int32 i = 0; i < NumWheels; ++i)
+    {
+      const FVector Wheel = Transform.InverseTransformPosition(
+          CarlaVehicle->GetMesh()->GetSocketLocation(Movement->WheelSetups[i].BoneName));
+      (i < NumFront ? Front : Rear) += Wheel.X;
+    }
+    FrontAxle = Front / NumFront;
+    RearAxle = Rear / (NumWheels - NumFront);
+  }
+  if (FrontAxle - RearAxle < 1.0f)
+  {
+    const float HalfLength = CarlaVehicle->GetVehicleBoundingBoxExtent().X;
+    FrontAxle = 0.6f * HalfLength;
+    RearAxle = -0.6f * HalfLength;
+  }
+
+  const FVector Location = Transform.GetLocation();
+  const FVector Forward = FRotator(0.0f, Transform.Rotator().Yaw, 0.0f).Vector();
+  float FrontHeight;
+  float RearHeight;
+  if (TraceGround(Location + Forward * FrontAxle, FrontHeight) &&
+      TraceGround(Location + Forward * RearAxle, RearHeight))
+  {
+    GroundOffset = Location.Z - 0.5f * (FrontHeight + RearHeight);
+  }
+}
+
+bool UKinematicMovementComponent::TraceGround(const FVector &Location, float &OutHeight) const
+{
+  FHitResult Hit;
+  FCollisionQueryParams CollisionQueryParams(SCENE_QUERY_STAT(KinematicVehicleGround), false, CarlaVehicle);
+  const bool bDidHit = GetWorld()->LineTraceSingleByObjectType(
+      Hit,
+      Location + FVector(0.0f, 0.0f, GroundTraceHeight),
+      Location - FVector(0.0f, 0.0f, GroundTraceHeight),
+      FCollisionObjectQueryParams(ECC_WorldStatic),
+      CollisionQueryParams);
+  if (bDidHit)
+  {
+    OutHeight = Hit.ImpactPoint.Z;
+  }
+  return bDidHit;
+}
+
+void UKinematicMovementComponent::TickComponent(float DeltaTime,
+    ELevelTick TickType,
+    FActorComponentTickFunction* ThisTickFunction)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(UKinematicMovementComponent::TickComponent);
+  if (!CarlaVehicle || DeltaTime <= 0.0f)
+  {
+    return;
+  }
+
+  const float Direction = VehicleControl.bReverse ? -1.0f : 1.0f;
+  const float TopSpeed = VehicleControl.bReverse ? MaxReverseSpeed : MaxSpeed;
+  const float Drive = Direction * VehicleControl.Throttle * MaxAcceleration *
+      FMath::Clamp(1.0f - Direction * Speed / TopSpeed, 0.0f, 1.0f);
+  const float Resistance = RollingDeceleration +
+      VehicleControl.Brake * MaxDeceleration +
+      (VehicleControl.bHandBrake ? MaxDeceleration : 0.0f);
+  Speed += Drive * DeltaTime;
+  // The resistance only slows down, it never reverses the vehicle.
+  const float Slowdown = Resistance * DeltaTime;
+  Speed = (FMath::Abs(Speed) <= Slowdown) ? 0.0f : Speed - FMath::Sign(Speed) * Slowdown;
+  if (Speed == 0.0f)
+  {
+    return;
+  }
+
+  // Bicycle model around the rear axle.
+  const FTransform &Transform = CarlaVehicle->GetActorTransform();
+  const FRotator Rotation = Transform.Rotator();
+  const float WheelBase = FrontAxle - RearAxle;
+  const float SteerAngle = FMath::DegreesToRadians(VehicleControl.Steer * MaxSteerAngle);
+  const float DeltaYaw = FMath::RadiansToDegrees(Speed * FMath::Tan(SteerAngle) / WheelBase * DeltaTime);
+  const float Yaw = Rotation.Yaw + DeltaYaw;
+  const FVector Forward = FRotator(0.0f, Rotation.Yaw, 0.0f).Vector();
+  const FVector MidForward = FRotator(0.0f, Rotation.Yaw + 0.5f * DeltaYaw, 0.0f).Vector();
+  const FVector NewForward = FRotator(0.0f, Yaw, 0.0f).Vector();
+  const FVector RearAxleLocation =
+      Transform.GetLocation() + Forward * RearAxle + MidForward * (Speed * DeltaTime);
+  FVector NewLocation = RearAxleLocation - NewForward * RearAxle;
+
+  float Pitch = Rotation.Pitch;
+  float FrontHeight;
+  float RearHeight;
+  if (TraceGround(NewLocation + NewForward * FrontAxle, FrontHeight) &&
+      TraceGround(RearAxleLocation, RearHeight))
+  {
+    NewLocation.Z = 0.5f * (FrontHeight + RearHeight) + GroundOffset;
+    Pitch = FMath::RadiansToDegrees(FMath::Atan2(FrontHeight - RearHeight, WheelBase));
+  }
+
+  CarlaVehicle->SetActorLocationAndRotation(
+      NewLocation,
+      FRotator(Pitch, Yaw, 0.0f),
+      false,
+      nullptr,
+      ETeleportType::TeleportPhysics);
+}
+
+void UKinematicMovementComponent::ProcessControl(FVehicleControl &Control)
+{
+  VehicleControl = Control;
+  Control.Gear = GetVehicleCurrentGear();
+}
+
+FVector UKinematicMovementComponent::GetVelocity() const
+{
+  if (CarlaVehicle)
+  {
+    return CarlaVehicle->GetActorForwardVector() * Speed;
+  }
+  return FVector();
+}
+
+int32 UKinematicMovementComponent::GetVehicleCurrentGear() const
+{
+  return VehicleControl.bReverse ? -1 : 1;
+}
+
+float UKinematicMovementComponent::GetVehicleForwardSpeed() const
+{
+  return Speed;
+}
+
+void UKinematicMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (!CarlaVehicle)
+  {
+    return;
+  }
+  CarlaVehicle->OnActorHit.RemoveDynamic(
+      this, &UKinematicMovementComponent::OnVehicleHit);
+}
+
+void UKinematicMovementComponent::DisableSpecialPhysics()
+{
+  DisableKinematicPhysics();
+}
+
+void UKinematicMovementComponent::DisableKinematicPhysics()
+{
+  this->SetComponentTickEnabled(false);
+  CarlaVehicle->OnActorHit.RemoveDynamic(
+      this, &UKinematicMovementComponent::OnVehicleHit);
+  // Hand the current velocity over to PhysX.
+  EnableUE4VehiclePhysics(false);
+  UDefaultMovementComponent::CreateDefaultMovementComponent(CarlaVehicle);
+}
+
+void UKinematicMovementComponent::OnVehicleHit(AActor *Actor,
+    AActor *OtherActor,
+    FVector NormalImpulse,
+    const FHitResult &Hit)
+{
+  DisableKinematicPhysics();
+}
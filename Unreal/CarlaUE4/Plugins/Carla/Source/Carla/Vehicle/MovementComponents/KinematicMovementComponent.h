@@ -0,0 +1,120 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "BaseCarlaMovementComponent.h"
+#include "Carla/Vehicle/VehicleControl.h"
+
+#include "KinematicMovementComponent.generated.h"
+
+class UCarlaEpisode;
+
+/// Lightweight vehicle model for background traffic.
+///
+/// Replaces the PhysX vehicle simulation by a kinematic bicycle model around
+/// the rear axle: the throttle and the brake give the longitudinal
+/// acceleration, the steering the yaw rate, and two line traces to the ground
+/// under the axles give the height and the pitch. The body is kinematic, so
+/// it still pushes simulated actors out of the way but it is not simulated
+/// itself.
+///
+/// Any hit goes back to full physics keeping the current velocity.
+UCLASS(Blueprintable, meta=(BlueprintSpawnableComponent) )
+class CARLA_API UKinematicMovementComponent : public UBaseCarlaMovementComponent
+{
+  GENERATED_BODY()
+
+public:
+
+  /// Replace the movement component of @a Vehicle. If @a bAutomatic the model
+  /// was chosen by UpdateByDistanceToHero and it is reverted by it too.
+  static void CreateKinematicMovementComponent(
+      ACarlaWheeledVehicle* Vehicle,
+      bool bAutomatic = false);
+
+  /// Switch the vehicles farther than @a Distance (in cm) from every hero
+  /// vehicle to the kinematic model, and back to full physics the ones that
+  /// got close again. Does nothing if there is no hero vehicle.
+  static void UpdateByDistanceToHero(UCarlaEpisode &Episode, float Distance);
+
+  virtual void BeginPlay() override;
+
+  void TickComponent(float DeltaTime,
+      ELevelTick TickType,
+      FActorComponentTickFunction* ThisTickFunction) override;
+
+  void ProcessControl(FVehicleControl &Control) override;
+
+  virtual FVector GetVelocity() const override;
+
+  virtual int32 GetVehicleCurrentGear() const override;
+
+  virtual float GetVehicleForwardSpeed() const override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  virtual void DisableSpecialPhysics() override;
+
+  bool IsAutomatic() const
+  {
+    return bAutomatic;
+  }
+
+  /// Acceleration at full throttle from standstill, in cm/s^2.
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float MaxAcceleration = 350.0f;
+
+  /// Deceleration at full brake, in cm/s^2.
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float MaxDeceleration = 800.0f;
+
+  /// Deceleration with no throttle nor brake, in cm/s^2.
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float RollingDeceleration = 40.0f;
+
+  /// Speed at which the throttle stops accelerating, in cm/s.
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float MaxSpeed = 5000.0f;
+
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float MaxReverseSpeed = 800.0f;
+
+  /// Height above and below the axles searched for the ground, in cm.
+  UPROPERTY(Category = "Kinematic Model", EditAnywhere, BlueprintReadWrite)
+  float GroundTraceHeight = 200.0f;
+
+private:
+
+  void InitializeGeometry();
+
+  bool TraceGround(const FVector &Location, float &OutHeight) const;
+
+  void DisableKinematicPhysics();
+
+  UFUNCTION()
+  void OnVehicleHit(AActor *Actor,
+      AActor *OtherActor,
+      FVector NormalImpulse,
+      const FHitResult &Hit);
+
+  bool bAutomatic = false;
+
+  FVehicleControl VehicleControl;
+
+  /// Signed speed along the forward vector, in cm/s.
+  float Speed = 0.0f;
+
+  float MaxSteerAngle = 70.0f;
+
+  /// Position of the axles along the forward vector of the actor, in cm.
+  float FrontAxle = 125.0f;
+
+  float RearAxle = -125.0f;
+
+  /// Height of the actor above the ground under the axles, in cm.
+  float GroundOffset = 0.0f;
+};
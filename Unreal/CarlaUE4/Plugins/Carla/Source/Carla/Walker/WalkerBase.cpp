@@ -6,8 +6,39 @@
 
 #include "WalkerBase.h"
 
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/CarlaStatics.h"
+
+#include "Components/SkeletalMeshComponent.h"
 
 AWalkerBase::AWalkerBase(const FObjectInitializer &ObjectInitializer)
         : Super(ObjectInitializer)
 {
+}
+
+void AWalkerBase::BeginPlay()
+{
+  Super::BeginPlay();
+
+  if (GetMesh() != nullptr)
+  {
+    DefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+  }
+  UCarlaEpisode *Episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
+  if (Episode != nullptr && Episode->GetSettings().bPhysicsOnlyMode)
+  {
+    SetAnimateOnlyWhenRendered(true);
+  }
+}
+
+void AWalkerBase::SetAnimateOnlyWhenRendered(const bool bEnabled)
+{
+  USkeletalMeshComponent *SkeletalMesh = GetMesh();
+  if (SkeletalMesh == nullptr)
+  {
+    return;
+  }
+  SkeletalMesh->VisibilityBasedAnimTickOption = bEnabled ?
+      EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered :
+      DefaultAnimTickOption;
 }
\ No newline at end of file
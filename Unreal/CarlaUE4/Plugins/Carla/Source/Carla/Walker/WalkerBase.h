@@ -44,4 +44,16 @@ public:
     {
         SetLifeSpan(AfterLifeSpan);
     }
+
+    // 只运行物理时行人只在被渲染时更新骨骼动画，关闭时恢复蓝图中设置的选项。
+    void SetAnimateOnlyWhenRendered(bool bEnabled);
+
+protected:
+
+    virtual void BeginPlay() override;
+
+private:
+
+    EVisibilityBasedAnimTickOption DefaultAnimTickOption =
+        EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
 };
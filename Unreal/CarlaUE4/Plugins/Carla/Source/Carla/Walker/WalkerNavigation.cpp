@@ -0,0 +1,375 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Walker/WalkerNavigation.h"
+
+#include "Carla/Actor/CarlaActor.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Game/CarlaGameModeBase.h"
+#include "Carla/Game/CarlaStatics.h"
+#include "Carla/Traffic/TrafficSignBase.h"
+#include "Carla/Util/NavigationMesh.h"
+
+#include "Components/BoxComponent.h"
+
+#if defined(WITH_SERVER_NAVIGATION)
+#include <compiler/disable-ue4-macros.h>
+#include <carla/nav/Navigation.h>
+#include <carla/road/Map.h>
+#include <carla/rpc/TrafficLightState.h>
+#include <carla/rpc/WalkerControl.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <set>
+#include <utility>
+#endif // WITH_SERVER_NAVIGATION
+
+FWalkerNavigation::FWalkerNavigation() = default;
+
+FWalkerNavigation::~FWalkerNavigation() = default;
+
+bool FWalkerNavigation::IsAvailable()
+{
+#if defined(WITH_SERVER_NAVIGATION)
+  return true;
+#else
+  return false;
+#endif // WITH_SERVER_NAVIGATION
+}
+
+#if defined(WITH_SERVER_NAVIGATION)
+
+namespace
+{
+  /// The stop locations of @a TrafficLight, one per lane its trigger volumes
+  /// cover, as the client computes them with TrafficLight::GetStopWaypoints.
+  void FWalkerNavigation_GetStopLocations(
+      const carla::road::Map &Map,
+      carla::rpc::ActorId Id,
+      const ATrafficSignBase &TrafficLight,
+      std::vector<carla::nav::TrafficLightStop> &Stops)
+  {
+    std::set<std::pair<carla::road::RoadId, carla::road::LaneId>> Lanes;
+    for (UBoxComponent *Box : TrafficLight.GetTriggerVolumes())
+    {
+      if (Box == nullptr)
+      {
+        continue;
+      }
+      const FVector Center = Box->GetComponentLocation();
+      const FVector Direction = Box->GetForwardVector();
+      const float Extent = 0.9f * Box->GetScaledBoxExtent().X;
+      // Every meter along the volume.
+      for (float X = -Extent; X < Extent; X += 100.0f)
+      {
+        auto Waypoint = Map.GetWaypoint(carla::geom::Location(Center + Direction * X));
+        if (Waypoint && Lanes.emplace(Waypoint->road_id, Waypoint->lane_id).second)
+        {
+          Stops.emplace_back(Id, Map.ComputeTransform(*Waypoint).location);
+        }
+      }
+    }
+  }
+} // namespace
+
+bool FWalkerNavigation::Load(UCarlaEpisode &Episode)
+{
+  if (Nav != nullptr)
+  {
+    return true;
+  }
+  if (bLoadAttempted)
+  {
+    return false;
+  }
+  bLoadAttempted = true;
+
+  const TArray<uint8> Mesh = FNavigationMesh::Load(Episode.GetMapName());
+  if (Mesh.Num() == 0)
+  {
+    UE_LOG(LogCarla, Error, TEXT("FWalkerNavigation: map '%s' has no navigation mesh"), *Episode.GetMapName());
+    return false;
+  }
+
+  auto Navigation = std::make_shared<carla::nav::Navigation>();
+  if (!Navigation->Load(std::vector<uint8_t>(Mesh.GetData(), Mesh.GetData() + Mesh.Num())))
+  {
+    UE_LOG(LogCarla, Error, TEXT("FWalkerNavigation: failed to load the navigation mesh of '%s'"), *Episode.GetMapName());
+    return false;
+  }
+
+  // The episode owns this object, so it outlives the navigation.
+  UCarlaEpisode *EpisodePtr = &Episode;
+  Navigation->SetTrafficLights(
+      [EpisodePtr]() {
+        std::vector<carla::nav::TrafficLightStop> Stops;
+        ACarlaGameModeBase *GameMode = UCarlaStatics::GetGameMode(EpisodePtr->GetWorld());
+        if (GameMode == nullptr || !GameMode->GetMap())
+        {
+          return Stops;
+        }
+        for (auto &Element : EpisodePtr->GetActorRegistry())
+        {
+          const FCarlaActor *CarlaActor = Element.Value.Get();
+          if (CarlaActor->GetActorType() != FCarlaActor::ActorType::TrafficLight)
+          {
+            continue;
+          }
+          const auto *TrafficLight = Cast<ATrafficSignBase>(CarlaActor->GetActor());
+          if (TrafficLight != nullptr)
+          {
+            FWalkerNavigation_GetStopLocations(
+                *GameMode->GetMap(), CarlaActor->GetActorId(), *TrafficLight, Stops);
+          }
+        }
+        return Stops;
+      },
+      [EpisodePtr](carla::rpc::ActorId Id) {
+        FCarlaActor *CarlaActor = EpisodePtr->FindCarlaActor(Id);
+        if (CarlaActor == nullptr)
+        {
+          return carla::rpc::TrafficLightState::Unknown;
+        }
+        return static_cast<carla::rpc::TrafficLightState>(CarlaActor->GetTrafficLightState());
+      });
+
+  Navigation->SetPedestriansCrossFactor(CrossFactor);
+  if (bHasSeed)
+  {
+    Navigation->SetSeed(Seed);
+  }
+  Nav = std::move(Navigation);
+  return true;
+}
+
+bool FWalkerNavigation::AddWalker(
+    UCarlaEpisode &Episode,
+    carla::rpc::ActorId WalkerId,
+    carla::rpc::ActorId ControllerId)
+{
+  if (!Load(Episode))
+  {
+    return false;
+  }
+  FCarlaActor *Walker = Episode.FindCarlaActor(WalkerId);
+  if (Walker == nullptr || Walker->GetActorType() != FCarlaActor::ActorType::Walker)
+  {
+    return false;
+  }
+  if (!Nav->AddWalker(WalkerId, carla::geom::Location(Walker->GetActorGlobalLocation())))
+  {
+    return false;
+  }
+  Walker->SetActorSimulatePhysics(false);
+  Walker->SetActorCollisions(false);
+  Walkers.Add(WalkerId, ControllerId);
+  return true;
+}
+
+bool FWalkerNavigation::RemoveWalker(carla::rpc::ActorId WalkerId)
+{
+  if (Walkers.Remove(WalkerId) == 0)
+  {
+    return false;
+  }
+  return Nav->RemoveAgent(WalkerId);
+}
+
+bool FWalkerNavigation::SetWalkerTarget(carla::rpc::ActorId WalkerId, const carla::geom::Location &To)
+{
+  return Walkers.Contains(WalkerId) && Nav->SetWalkerTarget(WalkerId, To);
+}
+
+bool FWalkerNavigation::SetWalkerMaxSpeed(carla::rpc::ActorId WalkerId, float MaxSpeed)
+{
+  return Walkers.Contains(WalkerId) && Nav->SetWalkerMaxSpeed(WalkerId, MaxSpeed);
+}
+
+std::vector<carla::geom::Location> FWalkerNavigation::GetRandomLocations(UCarlaEpisode &Episode, uint32 Count)
+{
+  std::vector<carla::geom::Location> Locations;
+  if (!Load(Episode))
+  {
+    return Locations;
+  }
+  Nav->GetRandomLocations(Count, Locations);
+  return Locations;
+}
+
+void FWalkerNavigation::SetPedestriansCrossFactor(float Percentage)
+{
+  CrossFactor = Percentage;
+  if (Nav != nullptr)
+  {
+    Nav->SetPedestriansCrossFactor(Percentage);
+  }
+}
+
+void FWalkerNavigation::SetPedestriansSeed(unsigned int InSeed)
+{
+  bHasSeed = true;
+  Seed = InSeed;
+  if (Nav != nullptr)
+  {
+    Nav->SetSeed(InSeed);
+  }
+}
+
+void FWalkerNavigation::Reset()
+{
+  for (auto &Element : Walkers)
+  {
+    Nav->RemoveAgent(Element.Key);
+  }
+  Walkers.Reset();
+}
+
+void FWalkerNavigation::RelocateWalkers(UCarlaEpisode &Episode)
+{
+  for (auto &Element : Walkers)
+  {
+    Nav->RemoveAgent(Element.Key);
+    const FCarlaActor *Walker = Episode.FindCarlaActor(Element.Key);
+    if (Walker != nullptr)
+    {
+      Nav->AddWalker(Element.Key, carla::geom::Location(Walker->GetActorGlobalLocation()));
+    }
+  }
+}
+
+void FWalkerNavigation::UpdateVehicles(UCarlaEpisode &Episode)
+{
+  std::vector<carla::nav::VehicleCollisionInfo> Vehicles;
+  for (auto &Element : Episode.GetActorRegistry())
+  {
+    const FCarlaActor *CarlaActor = Element.Value.Get();
+    if (CarlaActor->GetActorType() != FCarlaActor::ActorType::Vehicle || !CarlaActor->IsAlive())
+    {
+      continue;
+    }
+    Vehicles.emplace_back(carla::nav::VehicleCollisionInfo{
+        CarlaActor->GetActorId(),
+        carla::geom::Transform(CarlaActor->GetActorGlobalTransform()),
+        CarlaActor->GetActorInfo()->SerializedData.bounding_box});
+  }
+  Nav->UpdateVehicles(std::move(Vehicles));
+}
+
+void FWalkerNavigation::RemoveWalkerAndController(UCarlaEpisode &Episode, carla::rpc::ActorId WalkerId)
+{
+  const carla::rpc::ActorId ControllerId = Walkers.FindRef(WalkerId);
+  Walkers.Remove(WalkerId);
+  Nav->RemoveAgent(WalkerId);
+  Episode.DestroyActor(ControllerId);
+}
+
+void FWalkerNavigation::Tick(UCarlaEpisode &Episode, float DeltaSeconds)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  if (Walkers.Num() == 0 || Nav == nullptr)
+  {
+    return;
+  }
+
+  // Forget the walkers destroyed since the last tick.
+  TArray<carla::rpc::ActorId> Removed;
+  for (auto &Element : Walkers)
+  {
+    const FCarlaActor *Walker = Episode.FindCarlaActor(Element.Key);
+    if (Walker == nullptr || !Walker->IsAlive())
+    {
+      Removed.Add(Element.Key);
+    }
+  }
+  for (carla::rpc::ActorId WalkerId : Removed)
+  {
+    RemoveWalkerAndController(Episode, WalkerId);
+  }
+
+  UpdateVehicles(Episode);
+
+  Nav->UpdateCrowd(DeltaSeconds);
+
+  // Move the walkers, the same as the ApplyWalkerState commands of the client.
+  Removed.Reset();
+  carla::geom::Transform Transform;
+  bool bAlive = true;
+  for (auto &Element : Walkers)
+  {
+    FCarlaActor *Walker = Episode.FindCarlaActor(Element.Key);
+    if (Nav->GetWalkerTransform(Element.Key, Transform))
+    {
+      const float Speed = Nav->GetWalkerSpeed(Element.Key);
+      Walker->SetWalkerState(
+          Transform,
+          carla::rpc::WalkerControl(Transform.GetForwardVector(), Speed, false));
+    }
+    if (Nav->IsWalkerAlive(Element.Key, bAlive) && !bAlive)
+    {
+      Walker->SetActorCollisions(true);
+      Walker->SetActorDead();
+      Removed.Add(Element.Key);
+    }
+  }
+  for (carla::rpc::ActorId WalkerId : Removed)
+  {
+    RemoveWalkerAndController(Episode, WalkerId);
+  }
+}
+
+#else
+
+bool FWalkerNavigation::AddWalker(UCarlaEpisode &, carla::rpc::ActorId, carla::rpc::ActorId)
+{
+  UE_LOG(LogCarla, Error, TEXT("FWalkerNavigation: the server was built without server navigation"));
+  return false;
+}
+
+bool FWalkerNavigation::RemoveWalker(carla::rpc::ActorId)
+{
+  return false;
+}
+
+bool FWalkerNavigation::SetWalkerTarget(carla::rpc::ActorId, const carla::geom::Location &)
+{
+  return false;
+}
+
+bool FWalkerNavigation::SetWalkerMaxSpeed(carla::rpc::ActorId, float)
+{
+  return false;
+}
+
+std::vector<carla::geom::Location> FWalkerNavigation::GetRandomLocations(UCarlaEpisode &, uint32)
+{
+  return {};
+}
+
+void FWalkerNavigation::SetPedestriansCrossFactor(float Percentage)
+{
+  CrossFactor = Percentage;
+}
+
+void FWalkerNavigation::SetPedestriansSeed(unsigned int InSeed)
+{
+  bHasSeed = true;
+  Seed = InSeed;
+}
+
+void FWalkerNavigation::Reset()
+{
+}
+
+void FWalkerNavigation::RelocateWalkers(UCarlaEpisode &)
+{
+}
+
+void FWalkerNavigation::Tick(UCarlaEpisode &, float)
+{
+}
+
+#endif // WITH_SERVER_NAVIGATION
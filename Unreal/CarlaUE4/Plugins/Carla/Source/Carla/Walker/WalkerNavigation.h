@@ -0,0 +1,110 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Location.h>
+#include <carla/rpc/ActorId.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <memory>
+#include <vector>
+
+class UCarlaEpisode;
+
+namespace carla {
+namespace nav {
+  class Navigation;
+} // namespace nav
+} // namespace carla
+
+/// Runs the pedestrian crowd of carla::nav::Navigation inside the server, in
+/// the pre-tick before physics.
+///
+/// Walkers whose "controller.ai.walker" has the attribute server_navigation
+/// set are added here instead of to the crowd of the client. The client does
+/// not need to download the episode state and send one ApplyWalkerState
+/// command per walker every tick, and the crowd does not depend on the
+/// latency of the client.
+///
+/// The navigation is only available if the plugin is built with
+/// WITH_SERVER_NAVIGATION, otherwise adding a walker fails.
+class FWalkerNavigation
+{
+public:
+
+  FWalkerNavigation();
+
+  ~FWalkerNavigation();
+
+  /// Whether the plugin was built with the server navigation.
+  static bool IsAvailable();
+
+  /// Add @a WalkerId to the crowd, controlled by @a ControllerId. Disables
+  /// the physics and collisions of the walker. Loads the navigation mesh of
+  /// the map the first time.
+  bool AddWalker(
+      UCarlaEpisode &Episode,
+      carla::rpc::ActorId WalkerId,
+      carla::rpc::ActorId ControllerId);
+
+  bool RemoveWalker(carla::rpc::ActorId WalkerId);
+
+  bool SetWalkerTarget(carla::rpc::ActorId WalkerId, const carla::geom::Location &To);
+
+  bool SetWalkerMaxSpeed(carla::rpc::ActorId WalkerId, float MaxSpeed);
+
+  /// Up to @a Count random locations of the navigation mesh, empty if the map
+  /// has no navigation mesh.
+  std::vector<carla::geom::Location> GetRandomLocations(UCarlaEpisode &Episode, uint32 Count);
+
+  void SetPedestriansCrossFactor(float Percentage);
+
+  void SetPedestriansSeed(unsigned int Seed);
+
+  /// Remove every walker from the crowd without destroying the walkers or
+  /// their controllers. The navigation mesh stays loaded.
+  void Reset();
+
+  /// Add the walkers to the crowd again where they are now, after they were
+  /// teleported. Their targets are lost and have to be set again.
+  void RelocateWalkers(UCarlaEpisode &Episode);
+
+  /// Update the vehicles seen by the crowd and the crowd itself, and move the
+  /// walkers. Walkers that are destroyed or killed by a vehicle are removed
+  /// together with their controller.
+  void Tick(UCarlaEpisode &Episode, float DeltaSeconds);
+
+  int32 GetNumWalkers() const
+  {
+    return Walkers.Num();
+  }
+
+private:
+
+  bool Load(UCarlaEpisode &Episode);
+
+  void UpdateVehicles(UCarlaEpisode &Episode);
+
+  /// Remove @a WalkerId from the crowd and destroy its controller.
+  void RemoveWalkerAndController(UCarlaEpisode &Episode, carla::rpc::ActorId WalkerId);
+
+  /// Shared so that the header and builds without the navigation do not need
+  /// the definition of carla::nav::Navigation.
+  std::shared_ptr<carla::nav::Navigation> Nav;
+
+  bool bLoadAttempted = false;
+
+  float CrossFactor = 0.0f;
+
+  bool bHasSeed = false;
+
+  unsigned int Seed = 0u;
+
+  /// Controller of each walker.
+  TMap<carla::rpc::ActorId, carla::rpc::ActorId> Walkers;
+};
@@ -0,0 +1,104 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Walker/WalkerStateBatch.h"
+
+#include "Carla/Actor/CarlaActor.h"
+#include "Carla/Game/CarlaEpisode.h"
+#include "Carla/Walker/WalkerBase.h"
+#include "Carla/Walker/WalkerController.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/WalkerControl.h>
+#include <compiler/enable-ue4-macros.h>
+
+void FWalkerStateBatch::Resolve(UCarlaEpisode &Episode)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FWalkerStateBatch::Resolve);
+  Resolved.SetNum(ActorIds.Num(), false);
+
+  // Only lookups and reads here, the actors are modified in ApplyResolved.
+  ParallelFor(ActorIds.Num(), [&](int32 Index)
+  {
+    FResolvedState &State = Resolved[Index];
+    State = FResolvedState();
+
+    State.Actor = Episode.FindCarlaActor(ActorIds[Index]);
+    if (State.Actor == nullptr)
+    {
+      State.Response = ECarlaServerResponse::ActorNotFound;
+      return;
+    }
+
+    State.Transform = Transforms[Index];
+
+    if (State.Actor->IsDormant())
+    {
+      return;
+    }
+
+    AActor *Actor = State.Actor->GetActor();
+    auto *Walker = Cast<AWalkerBase>(Actor);
+    if (Walker && !Walker->bAlive)
+    {
+      State.Response = ECarlaServerResponse::WalkerDead;
+      return;
+    }
+    auto *Pawn = Cast<APawn>(Actor);
+    if (Pawn == nullptr)
+    {
+      State.Response = ECarlaServerResponse::ActorTypeMismatch;
+      return;
+    }
+    State.Controller = Cast<AWalkerController>(Pawn->GetController());
+    if (State.Controller == nullptr)
+    {
+      State.Response = ECarlaServerResponse::WalkerIncompatibleController;
+      return;
+    }
+
+    // adjust position up by half of capsule height, as in
+    // FWalkerActor::SetWalkerState
+    auto *Capsule = Cast<UCapsuleComponent>(Actor->GetRootComponent());
+    if (Capsule)
+    {
+      FVector Location = State.Transform.GetLocation();
+      Location.Z += Capsule->GetScaledCapsuleHalfHeight();
+      State.Transform.SetLocation(Location);
+    }
+  });
+}
+
+ECarlaServerResponse FWalkerStateBatch::ApplyResolved(int32 Index)
+{
+  const FResolvedState &State = Resolved[Index];
+  if (State.Response != ECarlaServerResponse::Success)
+  {
+    return State.Response;
+  }
+
+  const carla::rpc::WalkerControl Control(
+      Transforms[Index].GetForwardVector(),
+      Speeds[Index],
+      false);
+
+  if (State.Controller == nullptr)
+  {
+    // Dormant walker, keep the control until it is awake again.
+    FWalkerData *WalkerData = State.Actor->GetActorData<FWalkerData>();
+    WalkerData->WalkerControl = Control;
+  }
+  else
+  {
+    State.Controller->ApplyWalkerControl(Control);
+  }
+  State.Actor->SetActorGlobalTransform(State.Transform);
+  return ECarlaServerResponse::Success;
+}
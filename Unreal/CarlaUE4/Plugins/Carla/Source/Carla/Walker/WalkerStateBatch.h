@@ -0,0 +1,99 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Carla/Server/CarlaServerResponse.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/geom/Transform.h>
+#include <carla/rpc/ActorId.h>
+#include <compiler/enable-ue4-macros.h>
+
+class AWalkerController;
+class FCarlaActor;
+class UCarlaEpisode;
+
+/// Transforms and speeds of many walkers, stored as parallel arrays and
+/// applied in one pass. Has the same effect as calling
+/// FCarlaActor::SetWalkerState for each walker.
+///
+/// Looking up the actors and controllers and computing the transforms runs
+/// in parallel; only the calls into the engine (controller input and
+/// SetActorTransform) run one after another on the game thread.
+class FWalkerStateBatch
+{
+public:
+
+  void Reset()
+  {
+    ActorIds.Reset();
+    Transforms.Reset();
+    Speeds.Reset();
+  }
+
+  void Add(carla::rpc::ActorId ActorId, const carla::geom::Transform &Transform, float Speed)
+  {
+    ActorIds.Add(ActorId);
+    Transforms.Add(Transform);
+    Speeds.Add(Speed);
+  }
+
+  int32 Num() const
+  {
+    return ActorIds.Num();
+  }
+
+  /// Apply every state of the batch. @a OnError is called on the game thread
+  /// as OnError(ActorId, Response) for each walker that could not be moved.
+  /// Can only be called from the game thread.
+  template <typename FunctorT>
+  void Apply(UCarlaEpisode &Episode, FunctorT &&OnError)
+  {
+    Resolve(Episode);
+    for (int32 Index = 0; Index < Resolved.Num(); ++Index)
+    {
+      const ECarlaServerResponse Response = ApplyResolved(Index);
+      if (Response != ECarlaServerResponse::Success)
+      {
+        OnError(ActorIds[Index], Response);
+      }
+    }
+  }
+
+  void Apply(UCarlaEpisode &Episode)
+  {
+    Apply(Episode, [](carla::rpc::ActorId, ECarlaServerResponse) {});
+  }
+
+private:
+
+  struct FResolvedState
+  {
+    FCarlaActor *Actor = nullptr;
+
+    /// Null if the walker is dormant.
+    AWalkerController *Controller = nullptr;
+
+    FTransform Transform;
+
+    ECarlaServerResponse Response = ECarlaServerResponse::Success;
+  };
+
+  /// Fill Resolved in parallel.
+  void Resolve(UCarlaEpisode &Episode);
+
+  ECarlaServerResponse ApplyResolved(int32 Index);
+
+  TArray<carla::rpc::ActorId> ActorIds;
+
+  TArray<carla::geom::Transform> Transforms;
+
+  TArray<float> Speeds;
+
+  /// Kept between batches to reuse the memory.
+  TArray<FResolvedState> Resolved;
+};
@@ -9,6 +9,8 @@
 #include "Carla/Sensor/SceneCaptureCamera.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Kismet/GameplayStatics.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
 #include "ConstructorHelpers.h"
 
 // AWeather类的构造函数,接受一个FObjectInitializer对象用于初始化类成员
@@ -66,13 +68,91 @@ void AWeather::CheckWeatherPostProcessEffects()
     }
 }
 
+// 比较两组天气参数，返回改变的字段
+EWeatherChange AWeather::GetWeatherChanges(
+    const FWeatherParameters& Current,
+    const FWeatherParameters& New)
+{
+    EWeatherChange Changes = EWeatherChange::None;
+#define CARLA_WEATHER_CHANGE(Field) \
+    if (Current.Field != New.Field) { Changes |= EWeatherChange::Field; }
+    CARLA_WEATHER_CHANGE(Cloudiness)
+    CARLA_WEATHER_CHANGE(Precipitation)
+    CARLA_WEATHER_CHANGE(PrecipitationDeposits)
+    CARLA_WEATHER_CHANGE(WindIntensity)
+    CARLA_WEATHER_CHANGE(SunAzimuthAngle)
+    CARLA_WEATHER_CHANGE(SunAltitudeAngle)
+    CARLA_WEATHER_CHANGE(FogDensity)
+    CARLA_WEATHER_CHANGE(FogDistance)
+    CARLA_WEATHER_CHANGE(FogFalloff)
+    CARLA_WEATHER_CHANGE(Wetness)
+    CARLA_WEATHER_CHANGE(ScatteringIntensity)
+    CARLA_WEATHER_CHANGE(MieScatteringScale)
+    CARLA_WEATHER_CHANGE(RayleighScatteringScale)
+    CARLA_WEATHER_CHANGE(DustStorm)
+#undef CARLA_WEATHER_CHANGE
+    return Changes;
+}
+
+// 把改变的字段写入材质参数集，只修改 GPU 上的标量参数
+void AWeather::UpdateWeatherParameterCollection(EWeatherChange Changes)
+{
+    UWorld* World = GetWorld();
+    if (WeatherParameterCollection == nullptr || World == nullptr)
+    {
+        return;
+    }
+    UMaterialParameterCollectionInstance* Instance =
+        World->GetParameterCollectionInstance(WeatherParameterCollection);
+    if (Instance == nullptr)
+    {
+        return;
+    }
+    // 参数集中没有的字段会被忽略
+#define CARLA_WEATHER_PARAMETER(Field) \
+    if (EnumHasAnyFlags(Changes, EWeatherChange::Field)) { Instance->SetScalarParameterValue(TEXT(#Field), Weather.Field); }
+    CARLA_WEATHER_PARAMETER(Cloudiness)
+    CARLA_WEATHER_PARAMETER(Precipitation)
+    CARLA_WEATHER_PARAMETER(PrecipitationDeposits)
+    CARLA_WEATHER_PARAMETER(WindIntensity)
+    CARLA_WEATHER_PARAMETER(SunAzimuthAngle)
+    CARLA_WEATHER_PARAMETER(SunAltitudeAngle)
+    CARLA_WEATHER_PARAMETER(FogDensity)
+    CARLA_WEATHER_PARAMETER(FogDistance)
+    CARLA_WEATHER_PARAMETER(FogFalloff)
+    CARLA_WEATHER_PARAMETER(Wetness)
+    CARLA_WEATHER_PARAMETER(ScatteringIntensity)
+    CARLA_WEATHER_PARAMETER(MieScatteringScale)
+    CARLA_WEATHER_PARAMETER(RayleighScatteringScale)
+    CARLA_WEATHER_PARAMETER(DustStorm)
+#undef CARLA_WEATHER_PARAMETER
+}
+
 // 应用指定天气参数的函数
 void AWeather::ApplyWeather(const FWeatherParameters& InWeather)
 {
+    // 只有第一次应用时才需要更新所有的字段，之后只更新改变的字段
+    const EWeatherChange Changes = bWeatherApplied ?
+        GetWeatherChanges(AppliedWeather, InWeather) :
+        EWeatherChange::All;
+
     // 设置当前天气参数为传入的天气参数
     SetWeather(InWeather);
-    // 检查并应用与天气相关的后处理效果
-    CheckWeatherPostProcessEffects();
+    if (bPhysicsOnlyMode || Changes == EWeatherChange::None)
+    {
+        // 每帧应用相同的天气（例如平滑过渡的最后阶段）或只运行物理时不需要做任何事情
+        return;
+    }
+    AppliedWeather = Weather;
+    bWeatherApplied = true;
+    LastWeatherChanges = Changes;
+
+    // 只有降水或沙尘暴改变时才需要更新后处理效果
+    if (EnumHasAnyFlags(Changes, EWeatherChange::Precipitation | EWeatherChange::DustStorm))
+    {
+        CheckWeatherPostProcessEffects();
+    }
+    UpdateWeatherParameterCollection(Changes);
 
 #ifdef CARLA_WEATHER_EXTRA_LOG
     // 如果定义了CARLA_WEATHER_EXTRA_LOG宏，则输出以下日志信息，记录当前天气参数的各项值
@@ -103,6 +183,12 @@ void AWeather::NotifyWeather(ASensor* Sensor)
     // 检查并应用与天气相关的后处理效果
     CheckWeatherPostProcessEffects();
 
+    // 新的传感器需要所有的字段
+    AppliedWeather = Weather;
+    bWeatherApplied = true;
+    LastWeatherChanges = EWeatherChange::All;
+    UpdateWeatherParameterCollection(LastWeatherChanges);
+
     // 调用能真正改变天气的蓝图。
     RefreshWeather(Weather);
 }
@@ -118,3 +204,17 @@ void AWeather::SetDayNightCycle(const bool& active)
 {
     DayNightCycle = active;
 }
+
+void AWeather::SetPhysicsOnlyMode(const bool bEnabled)
+{
+    if (bPhysicsOnlyMode == bEnabled)
+    {
+        return;
+    }
+    bPhysicsOnlyMode = bEnabled;
+    if (!bPhysicsOnlyMode && bWeatherApplied)
+    {
+        // 应用只运行物理期间记录下的天气
+        ApplyWeather(Weather);
+    }
+}
@@ -13,6 +13,30 @@
 
 class ASensor;
 class ASceneCaptureCamera;
+class UMaterialParameterCollection;
+
+/// 天气参数 FWeatherParameters 中改变的字段，每个字段一位
+enum class EWeatherChange : uint32
+{
+  None                    = 0u,
+  Cloudiness              = 1u << 0u,
+  Precipitation           = 1u << 1u,
+  PrecipitationDeposits   = 1u << 2u,
+  WindIntensity           = 1u << 3u,
+  SunAzimuthAngle         = 1u << 4u,
+  SunAltitudeAngle        = 1u << 5u,
+  FogDensity              = 1u << 6u,
+  FogDistance             = 1u << 7u,
+  FogFalloff              = 1u << 8u,
+  Wetness                 = 1u << 9u,
+  ScatteringIntensity     = 1u << 10u,
+  MieScatteringScale      = 1u << 11u,
+  RayleighScatteringScale = 1u << 12u,
+  DustStorm               = 1u << 13u,
+  All                     = (1u << 14u) - 1u
+};
+
+ENUM_CLASS_FLAGS(EWeatherChange);
 
 UCLASS(Abstract)
 class CARLA_API AWeather : public AActor
@@ -51,6 +75,23 @@ public:
   /// 更新昼夜周期
   void SetDayNightCycle(const bool &active);
 
+  /// 只运行物理时天气只记录参数，不更新材质和后处理，也不通知蓝图；
+  /// 退出时一次性应用期间改变的字段
+  void SetPhysicsOnlyMode(bool bEnabled);
+
+  /// 上一次 ApplyWeather 或 NotifyWeather 改变的字段（EWeatherChange 的位），
+  /// 蓝图可以据此跳过没有改变的部分
+  UFUNCTION(BlueprintPure)
+  int32 GetLastWeatherChanges() const
+  {
+    return static_cast<int32>(LastWeatherChanges);
+  }
+
+  /// 返回 @a Current 与 @a New 之间改变的字段
+  static EWeatherChange GetWeatherChanges(
+      const FWeatherParameters &Current,
+      const FWeatherParameters &New);
+
 protected:
 
   UFUNCTION(BlueprintImplementableEvent)
@@ -60,6 +101,9 @@ private:
 
   void CheckWeatherPostProcessEffects();
 
+  /// 只把改变的字段写入材质参数集 WeatherParameterCollection
+  void UpdateWeatherParameterCollection(EWeatherChange Changes);
+
   UPROPERTY(VisibleAnywhere)
   FWeatherParameters Weather;
 
@@ -71,4 +115,18 @@ private:
 
   UPROPERTY(EditAnywhere, Category = "Weather")
   bool DayNightCycle = true;
+
+  /// 可选的材质参数集，参数名与 FWeatherParameters 的字段名相同。材质直接读取
+  /// 这些标量参数时，更新天气只需要修改 GPU 上的参数，不需要重新评估材质
+  UPROPERTY(EditAnywhere, Category = "Weather")
+  UMaterialParameterCollection *WeatherParameterCollection = nullptr;
+
+  /// 最近一次通知到蓝图的天气参数
+  FWeatherParameters AppliedWeather;
+
+  bool bWeatherApplied = false;
+
+  bool bPhysicsOnlyMode = false;
+
+  EWeatherChange LastWeatherChanges = EWeatherChange::None;
 };
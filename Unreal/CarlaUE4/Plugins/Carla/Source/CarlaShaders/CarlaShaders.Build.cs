@@ -0,0 +1,36 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+using UnrealBuildTool;
+
+// Global shaders of the Carla plugin. They have to be registered before the
+// engine compiles its shaders, so this module is loaded at PostConfigInit
+// while the rest of the plugin is loaded later.
+public class CarlaShaders : ModuleRules
+{
+  public CarlaShaders(ReadOnlyTargetRules Target) : base(Target)
+  {
+    PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+    PublicDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Core",
+        "RenderCore",
+        "RHI"
+      }
+      );
+
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "CoreUObject",
+        "Engine",
+        "Projects"
+      }
+      );
+  }
+}
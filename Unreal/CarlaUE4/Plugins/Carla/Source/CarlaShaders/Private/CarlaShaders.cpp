@@ -0,0 +1,26 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaShaders.h"
+
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "ShaderCore.h"
+
+void FCarlaShadersModule::StartupModule()
+{
+  const FString ShaderDirectory = FPaths::Combine(
+      IPluginManager::Get().FindPlugin(TEXT("Carla"))->GetBaseDir(),
+      TEXT("Shaders"));
+  AddShaderSourceDirectoryMapping(TEXT("/Plugin/Carla"), ShaderDirectory);
+}
+
+void FCarlaShadersModule::ShutdownModule()
+{
+}
+
+IMPLEMENT_MODULE(FCarlaShadersModule, CarlaShaders)
@@ -0,0 +1,187 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "DVSEventPass.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+class FCarlaDVSEventsCS : public FGlobalShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaDVSEventsCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaDVSEventsCS, FGlobalShader);
+
+  static constexpr uint32 ThreadGroupSize = 8u;
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_TEXTURE(Texture2D<float4>, InputTexture)
+    SHADER_PARAMETER_UAV(RWTexture2D, State)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, EventCounter)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<FDVSEvent>, Events)
+    SHADER_PARAMETER(FUintVector2, ImageSize)
+    SHADER_PARAMETER(uint32, Capacity)
+    SHADER_PARAMETER(uint32, Initialize)
+    SHADER_PARAMETER(uint32, UseLog)
+    SHADER_PARAMETER(float, LogEps)
+    SHADER_PARAMETER(float, PositiveThreshold)
+    SHADER_PARAMETER(float, NegativeThreshold)
+    SHADER_PARAMETER(float, SigmaPositive)
+    SHADER_PARAMETER(float, SigmaNegative)
+    SHADER_PARAMETER(float, RefractoryPeriodNs)
+    SHADER_PARAMETER(float, DeltaTimeNs)
+    SHADER_PARAMETER(uint32, Seed)
+  END_SHADER_PARAMETER_STRUCT()
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+  }
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaDVSEventsCS,
+    "/Plugin/Carla/Private/DVSEvents.usf",
+    "MainCS",
+    SF_Compute);
+
+void FDVSEventPass::ReserveEvents(uint32 NewCapacity)
+{
+  if (Counter == nullptr)
+  {
+    FRHIResourceCreateInfo CreateInfo;
+    Counter = RHICreateStructuredBuffer(
+        sizeof(uint32),
+        sizeof(uint32),
+        BUF_UnorderedAccess | BUF_ShaderResource,
+        CreateInfo);
+    CounterUAV = RHICreateUnorderedAccessView(Counter, false, false);
+  }
+  if (NewCapacity <= Capacity)
+  {
+    return;
+  }
+  FRHIResourceCreateInfo CreateInfo;
+  Events = RHICreateStructuredBuffer(
+      sizeof(FDVSGpuEvent),
+      sizeof(FDVSGpuEvent) * NewCapacity,
+      BUF_UnorderedAccess | BUF_ShaderResource,
+      CreateInfo);
+  EventsUAV = RHICreateUnorderedAccessView(Events, false, false);
+  Capacity = NewCapacity;
+}
+
+void FDVSEventPass::Execute(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Source,
+    const FDVSEventParameters &Parameters,
+    uint32 DeltaTimeNs,
+    TArray<FDVSGpuEvent> &OutEvents)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FDVSEventPass::Execute);
+  check(IsInRenderingThread());
+  check(Source != nullptr);
+
+  const FIntPoint Size = Source->GetSizeXY();
+  check(Size.X > 0 && Size.Y > 0);
+  NumDroppedEvents = 0u;
+
+  const bool bInitialize = !State.IsValid() || State->GetSizeXY() != Size;
+  if (bInitialize)
+  {
+    FRHIResourceCreateInfo CreateInfo;
+    State = RHICreateTexture2D(
+        Size.X,
+        Size.Y,
+        PF_A32B32G32R32F,
+        1,
+        1,
+        TexCreate_ShaderResource | TexCreate_UAV,
+        CreateInfo);
+    StateUAV = RHICreateUnorderedAccessView(State, 0);
+  }
+  // One event per pixel to start with, most frames produce far fewer.
+  ReserveEvents(FMath::Max(Capacity, static_cast<uint32>(Size.X * Size.Y)));
+
+  TShaderMapRef<FCarlaDVSEventsCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+
+  FCarlaDVSEventsCS::FParameters ShaderParameters;
+  ShaderParameters.InputTexture = Source;
+  ShaderParameters.State = StateUAV;
+  ShaderParameters.EventCounter = CounterUAV;
+  ShaderParameters.Events = EventsUAV;
+  ShaderParameters.ImageSize = FUintVector2(Size.X, Size.Y);
+  ShaderParameters.Capacity = Capacity;
+  ShaderParameters.Initialize = bInitialize ? 1u : 0u;
+  ShaderParameters.UseLog = Parameters.bUseLog ? 1u : 0u;
+  ShaderParameters.LogEps = Parameters.LogEps;
+  ShaderParameters.PositiveThreshold = Parameters.PositiveThreshold;
+  ShaderParameters.NegativeThreshold = Parameters.NegativeThreshold;
+  ShaderParameters.SigmaPositive = Parameters.SigmaPositive;
+  ShaderParameters.SigmaNegative = Parameters.SigmaNegative;
+  ShaderParameters.RefractoryPeriodNs = Parameters.RefractoryPeriodNs;
+  ShaderParameters.DeltaTimeNs = static_cast<float>(DeltaTimeNs);
+  ShaderParameters.Seed = Parameters.Seed;
+
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::Unknown, ERHIAccess::SRVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(StateUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(CounterUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(EventsUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.ClearUAVUint(CounterUAV, FUintVector4(0u, 0u, 0u, 0u));
+  FComputeShaderUtils::Dispatch(
+      RHICmdList,
+      ComputeShader,
+      ShaderParameters,
+      FIntVector(
+          FMath::DivideAndRoundUp(Size.X, static_cast<int32>(FCarlaDVSEventsCS::ThreadGroupSize)),
+          FMath::DivideAndRoundUp(Size.Y, static_cast<int32>(FCarlaDVSEventsCS::ThreadGroupSize)),
+          1));
+  RHICmdList.Transition(FRHITransitionInfo(CounterUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead));
+  RHICmdList.Transition(FRHITransitionInfo(EventsUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead));
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::SRVCompute, ERHIAccess::SRVMask));
+
+  if (bInitialize)
+  {
+    return;
+  }
+
+  // Read the counter first so only the events written are copied back.
+  uint32 NumEvents = 0u;
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("DVS read event count");
+    const void *Data = RHICmdList.LockStructuredBuffer(Counter, 0u, sizeof(uint32), RLM_ReadOnly);
+    FMemory::Memcpy(&NumEvents, Data, sizeof(uint32));
+    RHICmdList.UnlockStructuredBuffer(Counter);
+  }
+
+  const uint32 NumRead = FMath::Min(NumEvents, Capacity);
+  NumDroppedEvents = NumEvents - NumRead;
+  if (NumRead > 0u)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("DVS read events");
+    const int32 Offset = OutEvents.AddUninitialized(NumRead);
+    const uint32 NumBytes = NumRead * sizeof(FDVSGpuEvent);
+    const void *Data = RHICmdList.LockStructuredBuffer(Events, 0u, NumBytes, RLM_ReadOnly);
+    FMemory::Memcpy(OutEvents.GetData() + Offset, Data, NumBytes);
+    RHICmdList.UnlockStructuredBuffer(Events);
+  }
+
+  if (NumDroppedEvents > 0u)
+  {
+    // Make room for the next frame.
+    ReserveEvents(FMath::RoundUpToPowerOfTwo(NumEvents));
+  }
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "ImageConversionPass.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+class FCarlaImageConversionCS : public FGlobalShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaImageConversionCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaImageConversionCS, FGlobalShader);
+
+  static constexpr uint32 ThreadGroupSize = 8u;
+
+  class FOutputMode : SHADER_PERMUTATION_INT("OUTPUT_MODE", 3);
+
+  using FPermutationDomain = TShaderPermutationDomain<FOutputMode>;
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_TEXTURE(Texture2D<float4>, InputTexture)
+    SHADER_PARAMETER(FIntPoint, SourceOffset)
+    SHADER_PARAMETER(FIntPoint, OutputSize)
+    SHADER_PARAMETER(uint32, Downscale)
+    SHADER_PARAMETER_UAV(RWTexture2D, OutputTexture)
+  END_SHADER_PARAMETER_STRUCT()
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+  }
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaImageConversionCS,
+    "/Plugin/Carla/Private/ImageConversion.usf",
+    "MainCS",
+    SF_Compute);
+
+FTexture2DRHIRef FImageConversionPass::Execute(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Source,
+    const FImageConversionParameters &Parameters)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FImageConversionPass::Execute);
+  check(IsInRenderingThread());
+  check(Source != nullptr);
+  check(Parameters.OutputSize.X > 0 && Parameters.OutputSize.Y > 0);
+
+  if (!Output.IsValid() ||
+      Output->GetSizeXY() != Parameters.OutputSize ||
+      Output->GetFormat() != Parameters.OutputFormat)
+  {
+    FRHIResourceCreateInfo CreateInfo;
+    Output = RHICreateTexture2D(
+        Parameters.OutputSize.X,
+        Parameters.OutputSize.Y,
+        Parameters.OutputFormat,
+        1,
+        1,
+        TexCreate_ShaderResource | TexCreate_UAV,
+        CreateInfo);
+    OutputUAV = RHICreateUnorderedAccessView(Output, 0);
+  }
+
+  FCarlaImageConversionCS::FPermutationDomain PermutationVector;
+  PermutationVector.Set<FCarlaImageConversionCS::FOutputMode>(static_cast<int32>(Parameters.Mode));
+  TShaderMapRef<FCarlaImageConversionCS> ComputeShader(
+      GetGlobalShaderMap(GMaxRHIFeatureLevel),
+      PermutationVector);
+
+  FCarlaImageConversionCS::FParameters ShaderParameters;
+  ShaderParameters.InputTexture = Source;
+  ShaderParameters.SourceOffset = Parameters.SourceOffset;
+  ShaderParameters.OutputSize = Parameters.OutputSize;
+  ShaderParameters.Downscale = FMath::Max(Parameters.Downscale, 1u);
+  ShaderParameters.OutputTexture = OutputUAV;
+
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::Unknown, ERHIAccess::SRVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(OutputUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  FComputeShaderUtils::Dispatch(
+      RHICmdList,
+      ComputeShader,
+      ShaderParameters,
+      FIntVector(
+          FMath::DivideAndRoundUp(Parameters.OutputSize.X, static_cast<int32>(FCarlaImageConversionCS::ThreadGroupSize)),
+          FMath::DivideAndRoundUp(Parameters.OutputSize.Y, static_cast<int32>(FCarlaImageConversionCS::ThreadGroupSize)),
+          1));
+  RHICmdList.Transition(FRHITransitionInfo(OutputUAV, ERHIAccess::UAVCompute, ERHIAccess::CopySrc));
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::SRVCompute, ERHIAccess::SRVMask));
+
+  return Output;
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "InstanceBoxesPass.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+namespace InstanceBoxesPass_Constants
+{
+  /// One entry per 16 bit instance id.
+  static constexpr uint32 NumInstances = 1u << 16u;
+
+  /// Must match ENTRY_SIZE in InstanceBoxes.usf.
+  static constexpr uint32 EntrySize = 6u;
+
+  static constexpr uint32 ThreadGroupSize = 8u;
+}
+
+class FCarlaInstanceBoxesShader : public FGlobalShader
+{
+public:
+
+  FCarlaInstanceBoxesShader() = default;
+
+  FCarlaInstanceBoxesShader(const ShaderMetaType::CompiledShaderInitializerType &Initializer)
+    : FGlobalShader(Initializer) {}
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), InstanceBoxesPass_Constants::ThreadGroupSize);
+  }
+};
+
+class FCarlaInstanceBoxesAccumulateCS : public FCarlaInstanceBoxesShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaInstanceBoxesAccumulateCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaInstanceBoxesAccumulateCS, FCarlaInstanceBoxesShader);
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_TEXTURE(Texture2D<float4>, InputTexture)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Table)
+    SHADER_PARAMETER(FUintVector2, ImageSize)
+  END_SHADER_PARAMETER_STRUCT()
+};
+
+class FCarlaInstanceBoxesCompactCS : public FCarlaInstanceBoxesShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaInstanceBoxesCompactCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaInstanceBoxesCompactCS, FCarlaInstanceBoxesShader);
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Table)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RecordCounter)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<FInstanceRecord>, Records)
+  END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaInstanceBoxesAccumulateCS,
+    "/Plugin/Carla/Private/InstanceBoxes.usf",
+    "AccumulateCS",
+    SF_Compute);
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaInstanceBoxesCompactCS,
+    "/Plugin/Carla/Private/InstanceBoxes.usf",
+    "CompactCS",
+    SF_Compute);
+
+void FInstanceBoxesPass::CreateBuffers()
+{
+  using namespace InstanceBoxesPass_Constants;
+  FRHIResourceCreateInfo CreateInfo;
+  Table = RHICreateStructuredBuffer(
+      sizeof(uint32),
+      sizeof(uint32) * EntrySize * NumInstances,
+      BUF_UnorderedAccess | BUF_ShaderResource,
+      CreateInfo);
+  TableUAV = RHICreateUnorderedAccessView(Table, false, false);
+  // Every instance fits, the list never overflows.
+  Records = RHICreateStructuredBuffer(
+      sizeof(FInstanceBoxRecord),
+      sizeof(FInstanceBoxRecord) * NumInstances,
+      BUF_UnorderedAccess | BUF_ShaderResource,
+      CreateInfo);
+  RecordsUAV = RHICreateUnorderedAccessView(Records, false, false);
+  Counter = RHICreateStructuredBuffer(
+      sizeof(uint32),
+      sizeof(uint32),
+      BUF_UnorderedAccess | BUF_ShaderResource,
+      CreateInfo);
+  CounterUAV = RHICreateUnorderedAccessView(Counter, false, false);
+}
+
+void FInstanceBoxesPass::Execute(
+    FRHICommandListImmediate &RHICmdList,
+    FRHITexture2D *Source,
+    TArray<FInstanceBoxRecord> &OutRecords)
+{
+  using namespace InstanceBoxesPass_Constants;
+  TRACE_CPUPROFILER_EVENT_SCOPE(FInstanceBoxesPass::Execute);
+  check(IsInRenderingThread());
+  check(Source != nullptr);
+
+  if (!Table.IsValid())
+  {
+    CreateBuffers();
+  }
+
+  const FIntPoint Size = Source->GetSizeXY();
+
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::Unknown, ERHIAccess::SRVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(TableUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(CounterUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.Transition(FRHITransitionInfo(RecordsUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+  RHICmdList.ClearUAVUint(TableUAV, FUintVector4(0u, 0u, 0u, 0u));
+  RHICmdList.ClearUAVUint(CounterUAV, FUintVector4(0u, 0u, 0u, 0u));
+
+  {
+    TShaderMapRef<FCarlaInstanceBoxesAccumulateCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FCarlaInstanceBoxesAccumulateCS::FParameters ShaderParameters;
+    ShaderParameters.InputTexture = Source;
+    ShaderParameters.Table = TableUAV;
+    ShaderParameters.ImageSize = FUintVector2(Size.X, Size.Y);
+    FComputeShaderUtils::Dispatch(
+        RHICmdList,
+        ComputeShader,
+        ShaderParameters,
+        FIntVector(
+            FMath::DivideAndRoundUp(Size.X, static_cast<int32>(ThreadGroupSize)),
+            FMath::DivideAndRoundUp(Size.Y, static_cast<int32>(ThreadGroupSize)),
+            1));
+  }
+
+  RHICmdList.Transition(FRHITransitionInfo(TableUAV, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+
+  {
+    TShaderMapRef<FCarlaInstanceBoxesCompactCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FCarlaInstanceBoxesCompactCS::FParameters ShaderParameters;
+    ShaderParameters.Table = TableUAV;
+    ShaderParameters.RecordCounter = CounterUAV;
+    ShaderParameters.Records = RecordsUAV;
+    FComputeShaderUtils::Dispatch(
+        RHICmdList,
+        ComputeShader,
+        ShaderParameters,
+        FIntVector(NumInstances / (ThreadGroupSize * ThreadGroupSize), 1, 1));
+  }
+
+  RHICmdList.Transition(FRHITransitionInfo(CounterUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead));
+  RHICmdList.Transition(FRHITransitionInfo(RecordsUAV, ERHIAccess::UAVCompute, ERHIAccess::CPURead));
+  RHICmdList.Transition(FRHITransitionInfo(Source, ERHIAccess::SRVCompute, ERHIAccess::SRVMask));
+
+  // Read the counter first so only the records written are copied back.
+  uint32 NumRecords = 0u;
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Instance boxes read count");
+    const void *Data = RHICmdList.LockStructuredBuffer(Counter, 0u, sizeof(uint32), RLM_ReadOnly);
+    FMemory::Memcpy(&NumRecords, Data, sizeof(uint32));
+    RHICmdList.UnlockStructuredBuffer(Counter);
+  }
+
+  NumRecords = FMath::Min(NumRecords, NumInstances);
+  if (NumRecords > 0u)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Instance boxes read records");
+    const int32 Offset = OutRecords.AddUninitialized(NumRecords);
+    const uint32 NumBytes = NumRecords * sizeof(FInstanceBoxRecord);
+    const void *Data = RHICmdList.LockStructuredBuffer(Records, 0u, NumBytes, RLM_ReadOnly);
+    FMemory::Memcpy(OutRecords.GetData() + Offset, Data, NumBytes);
+    RHICmdList.UnlockStructuredBuffer(Records);
+  }
+}
@@ -0,0 +1,373 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "TerrainDeformationPass.h"
+
+#include "GlobalShader.h"
+#include "RenderGraphUtils.h"
+#include "ShaderParameterStruct.h"
+
+namespace TerrainDeformationPass_Constants
+{
+  static constexpr uint32 ThreadGroupSize = 8u;
+
+  /// Must match FORCE_UNIT and SINKAGE_UNIT in TerrainDeformation.usf.
+  static constexpr float ForceUnit = 0.01f;
+
+  static constexpr float SinkageUnit = 1e-6f;
+
+  /// Entries of the forces buffer per wheel.
+  static constexpr uint32 ForceEntries = 2u;
+}
+
+class FCarlaTerrainDeformationShader : public FGlobalShader
+{
+public:
+
+  FCarlaTerrainDeformationShader() = default;
+
+  FCarlaTerrainDeformationShader(const ShaderMetaType::CompiledShaderInitializerType &Initializer)
+    : FGlobalShader(Initializer) {}
+
+  static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters &Parameters)
+  {
+    return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+  }
+
+  static void ModifyCompilationEnvironment(
+      const FGlobalShaderPermutationParameters &Parameters,
+      FShaderCompilerEnvironment &OutEnvironment)
+  {
+    FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+    OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), TerrainDeformationPass_Constants::ThreadGroupSize);
+  }
+};
+
+class FCarlaTerrainShiftCS : public FCarlaTerrainDeformationShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaTerrainShiftCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaTerrainShiftCS, FCarlaTerrainDeformationShader);
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, SourceDepth)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Depth)
+    SHADER_PARAMETER(FIntPoint, Shift)
+    SHADER_PARAMETER(uint32, FieldSize)
+  END_SHADER_PARAMETER_STRUCT()
+};
+
+class FCarlaTerrainWheelCS : public FCarlaTerrainDeformationShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaTerrainWheelCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaTerrainWheelCS, FCarlaTerrainDeformationShader);
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_SRV(StructuredBuffer<float>, HeightMap)
+    SHADER_PARAMETER_SRV(StructuredBuffer<FTerrainWheel>, Wheels)
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Depth)
+    SHADER_PARAMETER_UAV(RWBuffer<uint>, WheelForces)
+    SHADER_PARAMETER(FUintVector2, HeightMapSize)
+    SHADER_PARAMETER(FVector2D, HeightMapOrigin)
+    SHADER_PARAMETER(FVector2D, HeightMapWorldSize)
+    SHADER_PARAMETER(FVector2D, FieldOrigin)
+    SHADER_PARAMETER(uint32, FieldSize)
+    SHADER_PARAMETER(uint32, FootprintSize)
+    SHADER_PARAMETER(uint32, NumWheels)
+    SHADER_PARAMETER(float, TexelSize)
+    SHADER_PARAMETER(float, CohesiveModulus)
+    SHADER_PARAMETER(float, FrictionalModulus)
+    SHADER_PARAMETER(float, SinkageExponent)
+    SHADER_PARAMETER(float, MaxSinkage)
+  END_SHADER_PARAMETER_STRUCT()
+};
+
+class FCarlaTerrainEncodeCS : public FCarlaTerrainDeformationShader
+{
+public:
+
+  DECLARE_GLOBAL_SHADER(FCarlaTerrainEncodeCS);
+  SHADER_USE_PARAMETER_STRUCT(FCarlaTerrainEncodeCS, FCarlaTerrainDeformationShader);
+
+  BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+    SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, Depth)
+    SHADER_PARAMETER_UAV(RWTexture2D<float>, OutputTexture)
+    SHADER_PARAMETER(uint32, FieldSize)
+    SHADER_PARAMETER(float, MinDisplacement)
+    SHADER_PARAMETER(float, MaxDisplacement)
+  END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaTerrainShiftCS,
+    "/Plugin/Carla/Private/TerrainDeformation.usf",
+    "ShiftCS",
+    SF_Compute);
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaTerrainWheelCS,
+    "/Plugin/Carla/Private/TerrainDeformation.usf",
+    "WheelCS",
+    SF_Compute);
+
+IMPLEMENT_GLOBAL_SHADER(
+    FCarlaTerrainEncodeCS,
+    "/Plugin/Carla/Private/TerrainDeformation.usf",
+    "EncodeCS",
+    SF_Compute);
+
+void FTerrainDeformationPass::SetHeightMap(
+    FRHICommandListImmediate &RHICmdList,
+    const TArray<float> &Heights,
+    FIntPoint Size,
+    FVector2D Origin,
+    FVector2D WorldSize)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformationPass::SetHeightMap);
+  check(IsInRenderingThread());
+  check(Heights.Num() == Size.X * Size.Y);
+
+  if (Heights.Num() == 0)
+  {
+    HeightMap.SafeRelease();
+    HeightMapSRV.SafeRelease();
+    return;
+  }
+
+  const uint32 NumBytes = Heights.Num() * sizeof(float);
+  if (!HeightMap.IsValid() || HeightMap->GetSize() != NumBytes)
+  {
+    FRHIResourceCreateInfo CreateInfo;
+    HeightMap = RHICreateStructuredBuffer(
+        sizeof(float),
+        NumBytes,
+        BUF_ShaderResource | BUF_Dynamic,
+        CreateInfo);
+    HeightMapSRV = RHICreateShaderResourceView(HeightMap);
+  }
+  void *Data = RHICmdList.LockStructuredBuffer(HeightMap, 0u, NumBytes, RLM_WriteOnly);
+  FMemory::Memcpy(Data, Heights.GetData(), NumBytes);
+  RHICmdList.UnlockStructuredBuffer(HeightMap);
+
+  HeightMapSize = Size;
+  HeightMapOrigin = Origin;
+  HeightMapWorldSize = WorldSize;
+}
+
+void FTerrainDeformationPass::CreateField(uint32 NewFieldSize, EPixelFormat Format)
+{
+  FieldSize = NewFieldSize;
+  CurrentDepth = 0u;
+
+  FRHIResourceCreateInfo CreateInfo;
+  for (uint32 i = 0u; i < 2u; ++i)
+  {
+    Depth[i] = RHICreateStructuredBuffer(
+        sizeof(uint32),
+        sizeof(uint32) * FieldSize * FieldSize,
+        BUF_UnorderedAccess | BUF_ShaderResource,
+        CreateInfo);
+    DepthUAV[i] = RHICreateUnorderedAccessView(Depth[i], false, false);
+  }
+  Encoded = RHICreateTexture2D(
+      FieldSize,
+      FieldSize,
+      Format,
+      1,
+      1,
+      TexCreate_ShaderResource | TexCreate_UAV,
+      CreateInfo);
+  EncodedUAV = RHICreateUnorderedAccessView(Encoded, 0);
+}
+
+void FTerrainDeformationPass::ReserveWheels(uint32 NewCapacity)
+{
+  using namespace TerrainDeformationPass_Constants;
+  if (NewCapacity <= WheelCapacity)
+  {
+    return;
+  }
+  FRHIResourceCreateInfo CreateInfo;
+  WheelBuffer = RHICreateStructuredBuffer(
+      sizeof(FTerrainGpuWheel),
+      sizeof(FTerrainGpuWheel) * NewCapacity,
+      BUF_ShaderResource | BUF_Dynamic,
+      CreateInfo);
+  WheelSRV = RHICreateShaderResourceView(WheelBuffer);
+  Forces = RHICreateVertexBuffer(
+      sizeof(uint32) * ForceEntries * NewCapacity,
+      BUF_UnorderedAccess | BUF_ShaderResource,
+      CreateInfo);
+  ForcesUAV = RHICreateUnorderedAccessView(Forces, PF_R32_UINT);
+  WheelCapacity = NewCapacity;
+}
+
+void FTerrainDeformationPass::PollReadbacks()
+{
+  using namespace TerrainDeformationPass_Constants;
+  // Oldest first, so the most recent one ready is the one kept.
+  for (uint32 i = 0u; i < UE_ARRAY_COUNT(Readbacks); ++i)
+  {
+    FPendingReadback &Pending = Readbacks[(NextReadback + i) % UE_ARRAY_COUNT(Readbacks)];
+    if (!Pending.bPending || !Pending.Readback->IsReady())
+    {
+      continue;
+    }
+    const uint32 NumWheels = Pending.Tags.Num();
+    TArray<FTerrainWheelForce> NewForces;
+    NewForces.SetNum(NumWheels);
+    const uint32 NumBytes = sizeof(uint32) * ForceEntries * NumWheels;
+    const uint32 *Data = static_cast<const uint32 *>(Pending.Readback->Lock(NumBytes));
+    for (uint32 Wheel = 0u; Wheel < NumWheels; ++Wheel)
+    {
+      NewForces[Wheel].Tag = Pending.Tags[Wheel];
+      NewForces[Wheel].NormalForce = Data[ForceEntries * Wheel] * ForceUnit;
+      NewForces[Wheel].Sinkage = Data[ForceEntries * Wheel + 1u] * SinkageUnit;
+    }
+    Pending.Readback->Unlock();
+    Pending.bPending = false;
+
+    FScopeLock Lock(&LatestForcesMutex);
+    LatestForces = MoveTemp(NewForces);
+  }
+}
+
+void FTerrainDeformationPass::Execute(
+    FRHICommandListImmediate &RHICmdList,
+    const FTerrainDeformationParameters &Parameters,
+    const TArray<FTerrainGpuWheel> &Wheels,
+    const TArray<uint64> &Tags,
+    FRHITexture2D *Target)
+{
+  using namespace TerrainDeformationPass_Constants;
+  TRACE_CPUPROFILER_EVENT_SCOPE(FTerrainDeformationPass::Execute);
+  check(IsInRenderingThread());
+  check(Target != nullptr);
+  check(Wheels.Num() == Tags.Num());
+
+  PollReadbacks();
+
+  const FIntPoint Size = Target->GetSizeXY();
+  check(Size.X == Size.Y);
+  const bool bCreated =
+      !Depth[0].IsValid() ||
+      FieldSize != static_cast<uint32>(Size.X) ||
+      Encoded->GetFormat() != Target->GetFormat();
+  if (bCreated)
+  {
+    CreateField(Size.X, Target->GetFormat());
+    RHICmdList.Transition(FRHITransitionInfo(DepthUAV[0], ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+    RHICmdList.ClearUAVUint(DepthUAV[0], FUintVector4(0u, 0u, 0u, 0u));
+  }
+
+  const FIntVector FieldGroups(
+      FMath::DivideAndRoundUp(FieldSize, ThreadGroupSize),
+      FMath::DivideAndRoundUp(FieldSize, ThreadGroupSize),
+      1);
+
+  if (!bCreated && Parameters.Shift != FIntPoint::ZeroValue)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Terrain shift");
+    const uint32 NextDepth = 1u - CurrentDepth;
+    RHICmdList.Transition(FRHITransitionInfo(DepthUAV[CurrentDepth], ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+    RHICmdList.Transition(FRHITransitionInfo(DepthUAV[NextDepth], ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+    TShaderMapRef<FCarlaTerrainShiftCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FCarlaTerrainShiftCS::FParameters ShaderParameters;
+    ShaderParameters.SourceDepth = DepthUAV[CurrentDepth];
+    ShaderParameters.Depth = DepthUAV[NextDepth];
+    ShaderParameters.Shift = Parameters.Shift;
+    ShaderParameters.FieldSize = FieldSize;
+    FComputeShaderUtils::Dispatch(RHICmdList, ComputeShader, ShaderParameters, FieldGroups);
+    CurrentDepth = NextDepth;
+  }
+
+  FRHIUnorderedAccessView *FieldUAV = DepthUAV[CurrentDepth];
+  RHICmdList.Transition(FRHITransitionInfo(FieldUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+
+  const uint32 NumWheels = Wheels.Num();
+  if (NumWheels > 0u && HeightMap.IsValid())
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Terrain wheels");
+    ReserveWheels(NumWheels);
+
+    // Wide enough for any heading of the wheels.
+    float MaxExtent = 0.0f;
+    const uint32 WheelsBytes = sizeof(FTerrainGpuWheel) * NumWheels;
+    void *Data = RHICmdList.LockStructuredBuffer(WheelBuffer, 0u, WheelsBytes, RLM_WriteOnly);
+    FMemory::Memcpy(Data, Wheels.GetData(), WheelsBytes);
+    RHICmdList.UnlockStructuredBuffer(WheelBuffer);
+    for (const FTerrainGpuWheel &Wheel : Wheels)
+    {
+      MaxExtent = FMath::Max(MaxExtent, FMath::Sqrt(Wheel.Radius * Wheel.Radius + Wheel.HalfWidth * Wheel.HalfWidth));
+    }
+    const uint32 FootprintSize = FMath::CeilToInt(2.0f * MaxExtent / Parameters.TexelSize) + 2u;
+
+    RHICmdList.Transition(FRHITransitionInfo(ForcesUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+    RHICmdList.ClearUAVUint(ForcesUAV, FUintVector4(0u, 0u, 0u, 0u));
+
+    TShaderMapRef<FCarlaTerrainWheelCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FCarlaTerrainWheelCS::FParameters ShaderParameters;
+    ShaderParameters.HeightMap = HeightMapSRV;
+    ShaderParameters.Wheels = WheelSRV;
+    ShaderParameters.Depth = FieldUAV;
+    ShaderParameters.WheelForces = ForcesUAV;
+    ShaderParameters.HeightMapSize = FUintVector2(HeightMapSize.X, HeightMapSize.Y);
+    ShaderParameters.HeightMapOrigin = HeightMapOrigin;
+    ShaderParameters.HeightMapWorldSize = HeightMapWorldSize;
+    ShaderParameters.FieldOrigin = Parameters.FieldOrigin;
+    ShaderParameters.FieldSize = FieldSize;
+    ShaderParameters.FootprintSize = FootprintSize;
+    ShaderParameters.NumWheels = NumWheels;
+    ShaderParameters.TexelSize = Parameters.TexelSize;
+    ShaderParameters.CohesiveModulus = Parameters.CohesiveModulus;
+    ShaderParameters.FrictionalModulus = Parameters.FrictionalModulus;
+    ShaderParameters.SinkageExponent = Parameters.SinkageExponent;
+    ShaderParameters.MaxSinkage = Parameters.MaxSinkage;
+    FComputeShaderUtils::Dispatch(
+        RHICmdList,
+        ComputeShader,
+        ShaderParameters,
+        FIntVector(
+            FMath::DivideAndRoundUp(FootprintSize, ThreadGroupSize),
+            FMath::DivideAndRoundUp(FootprintSize, ThreadGroupSize),
+            NumWheels));
+
+    // Copied to a staging buffer now, mapped once the GPU is done.
+    RHICmdList.Transition(FRHITransitionInfo(ForcesUAV, ERHIAccess::UAVCompute, ERHIAccess::CopySrc));
+    FPendingReadback &Pending = Readbacks[NextReadback];
+    if (!Pending.Readback.IsValid())
+    {
+      Pending.Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("TerrainWheelForces"));
+    }
+    Pending.Readback->EnqueueCopy(RHICmdList, Forces, sizeof(uint32) * ForceEntries * NumWheels);
+    Pending.Tags = Tags;
+    Pending.bPending = true;
+    NextReadback = (NextReadback + 1u) % UE_ARRAY_COUNT(Readbacks);
+
+    RHICmdList.Transition(FRHITransitionInfo(FieldUAV, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+  }
+
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("Terrain encode");
+    RHICmdList.Transition(FRHITransitionInfo(EncodedUAV, ERHIAccess::Unknown, ERHIAccess::UAVCompute));
+    TShaderMapRef<FCarlaTerrainEncodeCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FCarlaTerrainEncodeCS::FParameters ShaderParameters;
+    ShaderParameters.Depth = FieldUAV;
+    ShaderParameters.OutputTexture = EncodedUAV;
+    ShaderParameters.FieldSize = FieldSize;
+    ShaderParameters.MinDisplacement = Parameters.MinDisplacement;
+    ShaderParameters.MaxDisplacement = Parameters.MaxDisplacement;
+    FComputeShaderUtils::Dispatch(RHICmdList, ComputeShader, ShaderParameters, FieldGroups);
+  }
+
+  RHICmdList.Transition(FRHITransitionInfo(Encoded, ERHIAccess::UAVCompute, ERHIAccess::CopySrc));
+  RHICmdList.Transition(FRHITransitionInfo(Target, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+  RHICmdList.CopyTexture(Encoded, Target, FRHICopyTextureInfo());
+  RHICmdList.Transition(FRHITransitionInfo(Target, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+}
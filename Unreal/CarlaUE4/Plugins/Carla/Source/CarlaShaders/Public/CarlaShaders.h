@@ -0,0 +1,21 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+
+/// Maps the "Shaders" directory of the plugin to the "/Plugin/Carla" virtual
+/// shader path.
+class FCarlaShadersModule : public IModuleInterface
+{
+public:
+
+  virtual void StartupModule() override;
+
+  virtual void ShutdownModule() override;
+};
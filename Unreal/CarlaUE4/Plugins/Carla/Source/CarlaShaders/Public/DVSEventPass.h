@@ -0,0 +1,111 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+#include "RHIResources.h"
+
+struct FDVSEventParameters
+{
+  float PositiveThreshold = 0.3f;
+
+  float NegativeThreshold = 0.3f;
+
+  float SigmaPositive = 0.0f;
+
+  float SigmaNegative = 0.0f;
+
+  float RefractoryPeriodNs = 0.0f;
+
+  bool bUseLog = true;
+
+  float LogEps = 1e-3f;
+
+  /// Seed of the threshold noise, should change every frame.
+  uint32 Seed = 0u;
+};
+
+/// An event as written by the compute shader.
+struct FDVSGpuEvent
+{
+  /// x in the lower 16 bits, y in the upper 16 bits.
+  uint32 PackedXY;
+
+  /// Nanoseconds since the start of the interval.
+  uint32 TimeOffsetNs;
+
+  /// 1 for positive events, 0 for negative events.
+  uint32 Polarity;
+
+  uint16 GetX() const { return static_cast<uint16>(PackedXY & 0xFFFFu); }
+
+  uint16 GetY() const { return static_cast<uint16>(PackedXY >> 16u); }
+};
+
+static_assert(sizeof(FDVSGpuEvent) == 3u * sizeof(uint32), "Must match the layout in DVSEvents.usf");
+
+/// Compute shader stage that runs the event simulation of the DVS camera on
+/// the GPU, so only the events are read back instead of the whole image.
+///
+/// Keeps the state of every pixel (previous intensity, reference value and
+/// time of the last event) in a texture on the GPU. The events are appended to
+/// a structured buffer through an atomic counter; the counter is read back
+/// first and then only as many events as it says. The buffer grows when it
+/// overflows, the events that did not fit are dropped for that frame.
+///
+/// @warning To be used only from the render thread.
+class CARLASHADERS_API FDVSEventPass
+{
+public:
+
+  /// Simulate the interval of @a DeltaTimeNs nanoseconds that ends with
+  /// @a Source and append the events to @a OutEvents, unsorted. The first
+  /// call after a reset, or after the size of the image changed, only
+  /// initializes the state and produces no events.
+  ///
+  /// Blocks until the GPU has finished.
+  void Execute(
+      FRHICommandListImmediate &RHICmdList,
+      FRHITexture2D *Source,
+      const FDVSEventParameters &Parameters,
+      uint32 DeltaTimeNs,
+      TArray<FDVSGpuEvent> &OutEvents);
+
+  /// Forget the state of the pixels, the next call initializes it again.
+  void Reset()
+  {
+    State.SafeRelease();
+  }
+
+  /// Number of events dropped by the last call because the buffer was full.
+  uint32 GetNumDroppedEvents() const
+  {
+    return NumDroppedEvents;
+  }
+
+private:
+
+  void ReserveEvents(uint32 NewCapacity);
+
+  FTexture2DRHIRef State;
+
+  FUnorderedAccessViewRHIRef StateUAV;
+
+  FStructuredBufferRHIRef Events;
+
+  FUnorderedAccessViewRHIRef EventsUAV;
+
+  FStructuredBufferRHIRef Counter;
+
+  FUnorderedAccessViewRHIRef CounterUAV;
+
+  uint32 Capacity = 0u;
+
+  uint32 NumDroppedEvents = 0u;
+};
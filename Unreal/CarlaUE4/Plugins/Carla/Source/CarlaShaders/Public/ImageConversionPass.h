@@ -0,0 +1,69 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+#include "RHIResources.h"
+
+/// How the pixels of the source image are converted.
+enum class EImageConversionMode : uint8
+{
+  /// BGRA8 color, each output pixel is the average of its block.
+  Color,
+  /// Depth in meters decoded from the RGB encoding of the depth camera,
+  /// written to a single floating point channel.
+  Depth,
+  /// Semantic tag stored in the red channel, written to a single 8 bit channel.
+  Label
+};
+
+struct FImageConversionParameters
+{
+  EImageConversionMode Mode = EImageConversionMode::Color;
+
+  /// Format of the converted image, PF_R8G8B8A8 for color (the channels are
+  /// swizzled so the bytes are in BGRA order), PF_R16F or PF_R32_FLOAT for
+  /// depth and PF_G8 for labels.
+  EPixelFormat OutputFormat = PF_R8G8B8A8;
+
+  /// Top-left corner of the region of interest in the source image.
+  FIntPoint SourceOffset = FIntPoint::ZeroValue;
+
+  /// Size of the converted image.
+  FIntPoint OutputSize = FIntPoint::ZeroValue;
+
+  /// Each output pixel covers Downscale x Downscale source pixels.
+  uint32 Downscale = 1u;
+};
+
+/// Compute shader stage that crops, downscales and converts the render target
+/// of a camera on the GPU, so only the converted image is read back.
+///
+/// Owns the texture the image is converted to, which is reused while the
+/// parameters do not change. The readback of the previous conversion is
+/// ordered before the next dispatch by the GPU, so the texture can be reused
+/// while readbacks are still in flight.
+///
+/// @warning To be used only from the render thread.
+class CARLASHADERS_API FImageConversionPass
+{
+public:
+
+  /// Convert @a Source and return the converted texture, ready to be copied.
+  FTexture2DRHIRef Execute(
+      FRHICommandListImmediate &RHICmdList,
+      FRHITexture2D *Source,
+      const FImageConversionParameters &Parameters);
+
+private:
+
+  FTexture2DRHIRef Output;
+
+  FUnorderedAccessViewRHIRef OutputUAV;
+};
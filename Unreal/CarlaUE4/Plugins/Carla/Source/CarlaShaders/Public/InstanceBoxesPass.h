@@ -0,0 +1,72 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+#include "RHIResources.h"
+
+/// An instance as written by the compute shader.
+struct FInstanceBoxRecord
+{
+  /// Instance id in the lower 16 bits, semantic tag in the upper 16 bits.
+  uint32 IdAndTag;
+
+  uint32 PixelCount;
+
+  /// x in the lower 16 bits, y in the upper 16 bits, inclusive.
+  uint32 Min;
+
+  /// x in the lower 16 bits, y in the upper 16 bits, inclusive.
+  uint32 Max;
+
+  uint16 GetInstanceId() const { return static_cast<uint16>(IdAndTag & 0xFFFFu); }
+
+  uint8 GetSemanticTag() const { return static_cast<uint8>(IdAndTag >> 16u); }
+};
+
+static_assert(sizeof(FInstanceBoxRecord) == 4u * sizeof(uint32), "Must match the layout in InstanceBoxes.usf");
+
+/// Compute shader stage that reduces the image of the instance segmentation
+/// camera to the pixel count and the 2D bounding box of each instance, so only
+/// that list is read back instead of the whole image.
+///
+/// The instances are accumulated in a table indexed by their 16 bit id, which
+/// is then compacted into a list through an atomic counter. The counter is read
+/// back first and then only as many records as it says.
+///
+/// @warning To be used only from the render thread.
+class CARLASHADERS_API FInstanceBoxesPass
+{
+public:
+
+  /// Reduce @a Source and append one record per instance to @a OutRecords,
+  /// unsorted.
+  ///
+  /// Blocks until the GPU has finished.
+  void Execute(
+      FRHICommandListImmediate &RHICmdList,
+      FRHITexture2D *Source,
+      TArray<FInstanceBoxRecord> &OutRecords);
+
+private:
+
+  void CreateBuffers();
+
+  FStructuredBufferRHIRef Table;
+
+  FUnorderedAccessViewRHIRef TableUAV;
+
+  FStructuredBufferRHIRef Records;
+
+  FUnorderedAccessViewRHIRef RecordsUAV;
+
+  FStructuredBufferRHIRef Counter;
+
+  FUnorderedAccessViewRHIRef CounterUAV;
+};
@@ -0,0 +1,189 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "RHI.h"
+#include "RHICommandList.h"
+#include "RHIGPUReadback.h"
+#include "RHIResources.h"
+
+/// A wheel as read by the compute shader. All the values are in meters, in the
+/// right-handed frame of the height map (see UEFrameToSI).
+struct FTerrainGpuWheel
+{
+  /// Center of the wheel.
+  FVector Center;
+
+  float Radius;
+
+  /// Horizontal heading of the wheel, normalized.
+  FVector2D Forward;
+
+  float HalfWidth;
+
+  float Padding = 0.0f;
+};
+
+static_assert(sizeof(FTerrainGpuWheel) == 8u * sizeof(float), "Must match the layout in TerrainDeformation.usf");
+
+struct FTerrainWheelForce
+{
+  /// Tag given to the wheel when it was enqueued.
+  uint64 Tag = 0u;
+
+  /// Vertical force of the soil on the wheel in newtons.
+  float NormalForce = 0.0f;
+
+  /// Deepest sinkage of the wheel in meters.
+  float Sinkage = 0.0f;
+};
+
+struct FTerrainDeformationParameters
+{
+  /// Corner of the deformation field with the lowest coordinates, in meters.
+  FVector2D FieldOrigin = FVector2D::ZeroVector;
+
+  /// Field center moved since the last call, in texels. Used to keep the
+  /// deformation of the texels that are still inside the field.
+  FIntPoint Shift = FIntPoint::ZeroValue;
+
+  float TexelSize = 0.01f;
+
+  /// Bekker cohesive modulus of the soil in N/m^(n+1).
+  float CohesiveModulus = 0.99e3f;
+
+  /// Bekker frictional modulus of the soil in N/m^(n+2).
+  float FrictionalModulus = 1528.43e3f;
+
+  /// Bekker sinkage exponent n.
+  float SinkageExponent = 1.1f;
+
+  /// Depth of the deformable layer in meters.
+  float MaxSinkage = 0.4f;
+
+  /// Displacement mapped to 0 and 1 in the output texture, in meters.
+  float MinDisplacement = -100.0f;
+
+  float MaxDisplacement = 100.0f;
+};
+
+/// Compute shader stage that deforms the terrain under the wheels on the GPU.
+///
+/// Keeps the undeformed height map and the depth of the ruts, a square field
+/// of the size of the output texture, in buffers on the GPU. Each wheel is
+/// sampled with one thread per texel of its footprint: the sinkage of the
+/// texels in contact gives the ground pressure by the Bekker pressure-sinkage
+/// relation, which is added up into the normal force of the wheel, and the
+/// soil is pushed down to the bottom of the tire. The field is then encoded
+/// into the output texture with the same mapping as the CPU path.
+///
+/// Only the forces are read back, without blocking: they become available a
+/// frame or two later through GetLatestForces.
+///
+/// @warning All the methods, except GetLatestForces, are to be used only from
+/// the render thread.
+class CARLASHADERS_API FTerrainDeformationPass
+{
+public:
+
+  /// Upload the undeformed height map, in meters and indexed X * SizeY + Y as
+  /// in FHeightMapData.
+  void SetHeightMap(
+      FRHICommandListImmediate &RHICmdList,
+      const TArray<float> &Heights,
+      FIntPoint Size,
+      FVector2D Origin,
+      FVector2D WorldSize);
+
+  /// Deform the field under @a Wheels, encode it into @a Target and enqueue
+  /// the read back of the forces. @a Tags identify the wheels in the forces
+  /// returned later, one per wheel.
+  void Execute(
+      FRHICommandListImmediate &RHICmdList,
+      const FTerrainDeformationParameters &Parameters,
+      const TArray<FTerrainGpuWheel> &Wheels,
+      const TArray<uint64> &Tags,
+      FRHITexture2D *Target);
+
+  /// Forget the deformation, the field starts flat again.
+  void Reset()
+  {
+    Depth[0].SafeRelease();
+    Depth[1].SafeRelease();
+  }
+
+  /// Forces of the most recent call whose read back has finished.
+  ///
+  /// Thread-safe.
+  void GetLatestForces(TArray<FTerrainWheelForce> &OutForces) const
+  {
+    FScopeLock Lock(&LatestForcesMutex);
+    OutForces = LatestForces;
+  }
+
+private:
+
+  struct FPendingReadback
+  {
+    TUniquePtr<FRHIGPUBufferReadback> Readback;
+
+    TArray<uint64> Tags;
+
+    bool bPending = false;
+  };
+
+  void CreateField(uint32 NewFieldSize, EPixelFormat Format);
+
+  void ReserveWheels(uint32 NewCapacity);
+
+  void PollReadbacks();
+
+  uint32 FieldSize = 0u;
+
+  /// Depth of the ruts, ping-ponged when the field moves.
+  FStructuredBufferRHIRef Depth[2];
+
+  FUnorderedAccessViewRHIRef DepthUAV[2];
+
+  uint32 CurrentDepth = 0u;
+
+  FTexture2DRHIRef Encoded;
+
+  FUnorderedAccessViewRHIRef EncodedUAV;
+
+  FStructuredBufferRHIRef HeightMap;
+
+  FShaderResourceViewRHIRef HeightMapSRV;
+
+  FIntPoint HeightMapSize = FIntPoint::ZeroValue;
+
+  FVector2D HeightMapOrigin = FVector2D::ZeroVector;
+
+  FVector2D HeightMapWorldSize = FVector2D::UnitVector;
+
+  FStructuredBufferRHIRef WheelBuffer;
+
+  FShaderResourceViewRHIRef WheelSRV;
+
+  /// Two entries per wheel, normal force and sinkage in fixed point.
+  FVertexBufferRHIRef Forces;
+
+  FUnorderedAccessViewRHIRef ForcesUAV;
+
+  uint32 WheelCapacity = 0u;
+
+  /// A few frames in flight so a slow read back never stalls the GPU.
+  FPendingReadback Readbacks[3u];
+
+  uint32 NextReadback = 0u;
+
+  mutable FCriticalSection LatestForcesMutex;
+
+  TArray<FTerrainWheelForce> LatestForces;
+};
@@ -23,6 +23,9 @@
 #include "PhysicsPublic.h"
 #include "PhysXIncludes.h"
 #include "PxSimpleTypes.h"
+#include "Async/ParallelFor.h"
+#include <cstdarg>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 
@@ -44,6 +47,11 @@ void FCarlaExporterModule::StartupModule()
     FExecuteAction::CreateRaw(this, &FCarlaExporterModule::PluginButtonClicked),
     FCanExecuteAction());
 
+  PluginCommands->MapAction(
+    FCarlaExporterCommands::Get().PluginActionExportTiles,
+    FExecuteAction::CreateRaw(this, &FCarlaExporterModule::PluginTilesButtonClicked),
+    FCanExecuteAction());
+
   FLevelEditorModule& LevelEditorModule = FModuleManager::LoadModuleChecked<FLevelEditorModule>("LevelEditor");
 
   {
@@ -66,6 +74,78 @@ void FCarlaExporterModule::ShutdownModule()
 }
 
 void FCarlaExporterModule::PluginButtonClicked()
+{
+  ExportGeometry(false);
+}
+
+void FCarlaExporterModule::PluginTilesButtonClicked()
+{
+  ExportGeometry(true);
+}
+
+// 一个要导出的对象（组件或实例）。
+struct FExportObject
+{
+  // OBJ 的组名，即参与者的名称
+  FString GroupName;
+
+  FString ObjectName;
+
+  // 为空时只写入组名（没有要导出的组件的参与者）
+  UBodySetup *Body = nullptr;
+
+  FTransform Transform;
+
+  AreaType Area = AreaType::BLOCK;
+
+  // 按瓦片导出时对象所在的瓦片
+  FIntPoint Tile = FIntPoint(0, 0);
+
+  // 对象的第一个顶点在所在文件中的索引
+  int32 Offset = 0;
+
+  // 对象的 OBJ 文本，并行生成
+  TArray<ANSICHAR> Text;
+};
+
+// 把格式化的文本追加到 @a Out，代替逐个字符的 iostream 格式化。
+static void AppendFormat(TArray<ANSICHAR> &Out, const ANSICHAR *Format, ...)
+{
+  ANSICHAR Buffer[256];
+  va_list Args;
+  va_start(Args, Format);
+  va_list ArgsCopy;
+  va_copy(ArgsCopy, Args);
+  const int Length = std::vsnprintf(Buffer, sizeof(Buffer), Format, Args);
+  va_end(Args);
+  if (Length > 0 && Length < static_cast<int>(sizeof(Buffer)))
+  {
+    Out.Append(Buffer, Length);
+  }
+  else if (Length > 0)
+  {
+    // 很长的对象名称
+    const int32 Start = Out.AddUninitialized(Length + 1);
+    std::vsnprintf(Out.GetData() + Start, Length + 1, Format, ArgsCopy);
+    Out.Pop(false);
+  }
+  va_end(ArgsCopy);
+}
+
+static const ANSICHAR *GetAreaMaterial(AreaType Area)
+{
+  switch (Area)
+  {
+    case AreaType::ROAD:      return "road";
+    case AreaType::GRASS:     return "grass";
+    case AreaType::SIDEWALK:  return "sidewalk";
+    case AreaType::CROSSWALK: return "crosswalk";
+    case AreaType::BLOCK:     return "block";
+  }
+  return "block";
+}
+
+void FCarlaExporterModule::ExportGeometry(bool bByTiles)
 {
   UWorld* World = GEditor->GetEditorWorldContext().World();
   if (!World) return;
@@ -84,20 +164,13 @@ void FCarlaExporterModule::PluginButtonClicked()
 
   // 得到目标路径
   FString Path = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir());
-  //构建最终名称。
-  std::ostringstream name;
-  name << TCHAR_TO_UTF8(*Path) << "/" << TCHAR_TO_UTF8(*World->GetMapName()) << ".obj";
-  //创建文件。
-  std::ofstream f(name.str());
 
   // 定义回合数
   int rounds;
   rounds = 5;
 
-  // 我们需要缩放网格（虚幻引擎使用 “厘米”，Recast 使用 “米”）
-  constexpr float TO_METERS = 0.01f;
-
-  int offset = 1;
+  // 在游戏线程中收集要导出的对象，顺序与写入文件的顺序相同
+  TArray<FExportObject> Objects;
   AreaType areaType;
   for (int round = 0; round < rounds; ++round)
   {
@@ -144,8 +217,24 @@ void FCarlaExporterModule::PluginButtonClicked()
           continue;
       }
 
-      f << "g " << TCHAR_TO_ANSI(*(ActorName)) << "\n";
+      auto AddObject = [&](const FString &ObjectName, UBodySetup *body, const FTransform &Transform)
+      {
+        FExportObject &Object = Objects.AddDefaulted_GetRef();
+        Object.GroupName = ActorName;
+        Object.ObjectName = ObjectName;
+        Object.Body = body;
+        Object.Transform = Transform;
+        Object.Area = areaType;
+        if (bByTiles)
+        {
+          const FVector Location = Transform.GetTranslation();
+          Object.Tile = FIntPoint(
+              FMath::FloorToInt(Location.X / TileSize),
+              FMath::FloorToInt(Location.Y / TileSize));
+        }
+      };
 
+      const int32 NumObjects = Objects.Num();
       TArray<UActorComponent*> Components = TempActor->GetComponentsByClass(UStaticMeshComponent::StaticClass());
       for (auto *Component : Components)
       {
@@ -165,9 +254,8 @@ void FCarlaExporterModule::PluginButtonClicked()
             // 获取组件的位置和变换
             FTransform InstanceTransform;
             comp2->GetInstanceTransform(i, InstanceTransform, true);
-            FVector InstanceLocation = InstanceTransform.GetTranslation();
 
-            offset += WriteObjectGeom(f, ObjectName, body, InstanceTransform, areaType, offset);
+            AddObject(ObjectName, body, InstanceTransform);
           }
         }
         else
@@ -184,26 +272,110 @@ void FCarlaExporterModule::PluginButtonClicked()
           FString ObjectName = ActorName +"_"+comp->GetName();
 
           // 获取组件的位置和变换。
-          FTransform CompTransform = comp->GetComponentTransform();
-          FVector CompLocation = CompTransform.GetTranslation();
-
-          offset += WriteObjectGeom(f, ObjectName, body, CompTransform, areaType, offset);
+          AddObject(ObjectName, body, comp->GetComponentTransform());
         }
       }
+      // 没有几何体的参与者也写入它的组名
+      if (Objects.Num() == NumObjects)
+      {
+        AddObject(ActorName, nullptr, TempActor->GetActorTransform());
+      }
+    }
+  }
+
+  // OBJ 的索引从 1 开始，每个文件单独编号
+  TMap<FIntPoint, int32> NextOffset;
+  for (FExportObject &Object : Objects)
+  {
+    int32 &Offset = NextOffset.FindOrAdd(Object.Tile, 1);
+    Object.Offset = Offset;
+    Offset += GetObjectGeomVertices(Object.Body);
+  }
+
+  // 文本格式化是主要开销，各个对象互不依赖
+  ParallelFor(Objects.Num(), [&](int32 Index)
+  {
+    FExportObject &Object = Objects[Index];
+    if (Object.Body)
+    {
+      WriteObjectGeom(Object.Text, Object.ObjectName, Object.Body, Object.Transform, Object.Area, Object.Offset);
+    }
+  });
+
+  // 按顺序写入各个文件
+  TMap<FIntPoint, TSharedPtr<std::ofstream>> Files;
+  TMap<FIntPoint, const FString *> LastGroup;
+  for (const FExportObject &Object : Objects)
+  {
+    TSharedPtr<std::ofstream> &File = Files.FindOrAdd(Object.Tile);
+    if (!File.IsValid())
+    {
+      //构建最终名称。
+      std::ostringstream name;
+      name << TCHAR_TO_UTF8(*Path) << "/" << TCHAR_TO_UTF8(*World->GetMapName());
+      if (bByTiles)
+      {
+        name << "_" << Object.Tile.X << "_" << Object.Tile.Y;
+      }
+      name << ".obj";
+      //创建文件。
+      File = MakeShared<std::ofstream>(name.str(), std::ios::binary);
+    }
+    const FString *&Group = LastGroup.FindOrAdd(Object.Tile, nullptr);
+    if (Group == nullptr || !Group->Equals(Object.GroupName))
+    {
+      *File << "g " << TCHAR_TO_ANSI(*(Object.GroupName)) << "\n";
+      Group = &Object.GroupName;
     }
+    File->write(Object.Text.GetData(), Object.Text.Num());
+  }
+  for (auto &File : Files)
+  {
+    File.Value->close();
   }
-  f.close();
 }
 
-int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName, UBodySetup *body, FTransform &CompTransform, AreaType Area, int32 Offset)
+int32 FCarlaExporterModule::GetObjectGeomVertices(UBodySetup *body)
 {
   if (!body) return 0;
 
+  // 与 WriteObjectGeom 写入的几何体相同
+  int32 TotalVertices = body->AggGeom.BoxElems.Num() * 8;
+  bool Written = (body->AggGeom.BoxElems.Num() > 0);
+  for (const auto &convex : body->AggGeom.ConvexElems)
+  {
+    PxConvexMesh *mesh = convex.GetConvexMesh();
+    if (!mesh) continue;
+    TotalVertices += mesh->getNbVertices();
+    Written = true;
+  }
+  if (!Written)
+  {
+    for (const auto &mesh : body->TriMeshes)
+    {
+      TotalVertices += mesh->getNbVertices();
+    }
+  }
+  return TotalVertices;
+}
+
+int32 FCarlaExporterModule::WriteObjectGeom(TArray<ANSICHAR> &Out, const FString &ObjectName, UBodySetup *body, const FTransform &CompTransform, AreaType Area, int32 Offset)
+{
+  if (!body) return 0;
+
+  // 我们需要缩放网格（虚幻引擎使用 “厘米”，Recast 使用 “米”）
   constexpr float TO_METERS = 0.01f;
   FVector CompLocation = CompTransform.GetTranslation();
   int TotalVerticesAdded = 0;
   bool Written = false;
 
+  auto WriteVertex = [&](const FVector &vec)
+  {
+    FVector vec3 = CompTransform.TransformVector(vec);
+    FVector world(CompLocation.X + vec3.X, CompLocation.Y + vec3.Y, CompLocation.Z + vec3.Z);
+    AppendFormat(Out, "v %f %f %f\n", world.X * TO_METERS, world.Z * TO_METERS, world.Y * TO_METERS);
+  };
+
   // try to write the box collision if any
   for (const auto &box: body->AggGeom.BoxElems)
   {
@@ -214,7 +386,7 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
 
     FVector HalfExtent(box.X / 2.0f, box.Y / 2.0f, box.Z / 2.0f);
 
-    f << "o " << TCHAR_TO_ANSI(*(ObjectName +"_box")) << "\n";
+    AppendFormat(Out, "o %s_box\n", TCHAR_TO_ANSI(*ObjectName));
 
     // 定义 8 个顶点。
     boxVerts.Add(box.Center + box.Rotation.RotateVector(FVector(-HalfExtent.X, -HalfExtent.Y, -HalfExtent.Z)));
@@ -243,28 +415,16 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
     // 写入所有顶点。
     for (int32 j=0; j<nbVerts; j++)
     {
-      const FVector &v = boxVerts[j];
-      FVector vec(v.X, v.Y, v.Z);
-      FVector vec3 = CompTransform.TransformVector(vec);
-      FVector world(CompLocation.X + vec3.X, CompLocation.Y + vec3.Y, CompLocation.Z + vec3.Z);
-
-      f << "v " << std::fixed << world.X * TO_METERS << " " << world.Z * TO_METERS << " " << world.Y * TO_METERS << "\n";
+      WriteVertex(boxVerts[j]);
     }
     //根据区域类型设置材质。
-    switch (Area)
-    {
-      case AreaType::ROAD:      f << "usemtl road"      << "\n"; break;
-      case AreaType::GRASS:     f << "usemtl grass"     << "\n"; break;
-      case AreaType::SIDEWALK:  f << "usemtl sidewalk"  << "\n"; break;
-      case AreaType::CROSSWALK: f << "usemtl crosswalk" << "\n"; break;
-      case AreaType::BLOCK:     f << "usemtl block"     << "\n"; break;
-    }
+    AppendFormat(Out, "usemtl %s\n", GetAreaMaterial(Area));
     //写入所有面。
     int k = 0;
     for (int32 i=0; i<indexBuffer.Num()/3; ++i)
     {
       // 对于左手坐标系，使用逆序。
-      f << "f " << Offset + indexBuffer[k+2] << " " << Offset + indexBuffer[k+1] << " " << Offset + indexBuffer[k] << "\n";
+      AppendFormat(Out, "f %d %d %d\n", Offset + indexBuffer[k+2], Offset + indexBuffer[k+1], Offset + indexBuffer[k]);
       k += 3;
     }
     TotalVerticesAdded += nbVerts;
@@ -282,27 +442,16 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
     const PxVec3* convexVerts = mesh->getVertices();
     const PxU8* indexBuffer = (PxU8 *) mesh->getIndexBuffer();
 
-    f << "o " << TCHAR_TO_ANSI(*(ObjectName +"_convex")) << "\n";
+    AppendFormat(Out, "o %s_convex\n", TCHAR_TO_ANSI(*ObjectName));
 
     //写入所有顶点。
     for (int32 j=0; j<nbVerts; j++)
     {
       const PxVec3 &v = convexVerts[j];
-      FVector vec(v.x, v.y, v.z);
-      FVector vec3 = CompTransform.TransformVector(vec);
-      FVector world(CompLocation.X + vec3.X, CompLocation.Y + vec3.Y, CompLocation.Z + vec3.Z);
-
-      f << "v " << std::fixed << world.X * TO_METERS << " " << world.Z * TO_METERS << " " << world.Y * TO_METERS << "\n";
+      WriteVertex(FVector(v.x, v.y, v.z));
     }
     // 根据区域类型设置材质。
-    switch (Area)
-    {
-      case AreaType::ROAD:      f << "usemtl road"      << "\n"; break;
-      case AreaType::GRASS:     f << "usemtl grass"     << "\n"; break;
-      case AreaType::SIDEWALK:  f << "usemtl sidewalk"  << "\n"; break;
-      case AreaType::CROSSWALK: f << "usemtl crosswalk" << "\n"; break;
-      case AreaType::BLOCK:     f << "usemtl block"     << "\n"; break;
-    }
+    AppendFormat(Out, "usemtl %s\n", GetAreaMaterial(Area));
     // 写入所有面。
     for (PxU32 i=0; i<mesh->getNbPolygons(); ++i)
     {
@@ -313,7 +462,7 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
       for(int32 j=2; j<faceNbVerts; j++)
       {
         // 对于左手坐标系，使用逆序。
-        f << "f " << Offset + faceIndices[j-1] << " " << Offset + faceIndices[j] << " " << Offset + faceIndices[0] << "\n";
+        AppendFormat(Out, "f %d %d %d\n", Offset + faceIndices[j-1], Offset + faceIndices[j], Offset + faceIndices[0]);
       }
     }
     TotalVerticesAdded += nbVerts;
@@ -330,27 +479,16 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
       PxU32 nbVerts = mesh->getNbVertices();
       const PxVec3* convexVerts = mesh->getVertices();
 
-      f << "o " << TCHAR_TO_ANSI(*(ObjectName +"_mesh")) << "\n";
+      AppendFormat(Out, "o %s_mesh\n", TCHAR_TO_ANSI(*ObjectName));
 
       // 写入所有顶点。
       for (PxU32 j=0; j<nbVerts; j++)
       {
         const PxVec3 &v = convexVerts[j];
-        FVector vec(v.x, v.y, v.z);
-        FVector vec3 = CompTransform.TransformVector(vec);
-        FVector world(CompLocation.X + vec3.X, CompLocation.Y + vec3.Y, CompLocation.Z + vec3.Z);
-
-        f << "v " << std::fixed << world.X * TO_METERS << " " << world.Z * TO_METERS << " " << world.Y * TO_METERS << "\n";
+        WriteVertex(FVector(v.x, v.y, v.z));
       }
       // 根据区域类型设置材质。
-      switch (Area)
-      {
-        case AreaType::ROAD:      f << "usemtl road"      << "\n"; break;
-        case AreaType::GRASS:     f << "usemtl grass"     << "\n"; break;
-        case AreaType::SIDEWALK:  f << "usemtl sidewalk"  << "\n"; break;
-        case AreaType::CROSSWALK: f << "usemtl crosswalk" << "\n"; break;
-        case AreaType::BLOCK:     f << "usemtl block"     << "\n"; break;
-      }
+      AppendFormat(Out, "usemtl %s\n", GetAreaMaterial(Area));
       // 写入所有面
       int k = 0;
       //三角形索引可以是 16 位或 32 位。
@@ -360,7 +498,7 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
         for (PxU32 i=0; i<mesh->getNbTriangles(); ++i)
         {
           //  对于左手坐标系，使用逆序。
-          f << "f " << Offset + Indices16[k+2] << " " << Offset + Indices16[k+1] << " " << Offset + Indices16[k] << "\n";
+          AppendFormat(Out, "f %d %d %d\n", Offset + Indices16[k+2], Offset + Indices16[k+1], Offset + Indices16[k]);
           k += 3;
         }
       }
@@ -370,7 +508,7 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
         for (PxU32 i=0; i<mesh->getNbTriangles(); ++i)
         {
           //  对于左手坐标系，使用逆序。
-          f << "f " << Offset + Indices32[k+2] << " " << Offset + Indices32[k+1] << " " << Offset + Indices32[k] << "\n";
+          AppendFormat(Out, "f %d %d %d\n", Offset + static_cast<int32>(Indices32[k+2]), Offset + static_cast<int32>(Indices32[k+1]), Offset + static_cast<int32>(Indices32[k]));
           k += 3;
         }
       }
@@ -384,6 +522,7 @@ int32 FCarlaExporterModule::WriteObjectGeom(std::ofstream &f, FString ObjectName
 void FCarlaExporterModule::AddMenuExtension(FMenuBuilder& Builder)
 {
   Builder.AddMenuEntry(FCarlaExporterCommands::Get().PluginActionExportAll);
+  Builder.AddMenuEntry(FCarlaExporterCommands::Get().PluginActionExportTiles);
 }
 
 #undef LOCTEXT_NAMESPACE
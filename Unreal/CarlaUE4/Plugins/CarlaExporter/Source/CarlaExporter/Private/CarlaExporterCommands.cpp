@@ -11,6 +11,7 @@
 void FCarlaExporterCommands::RegisterCommands()
 {
   UI_COMMAND(PluginActionExportAll, "Carla Exporter", "Export all or selected meshes into an .OBJ file to be used by Carla (in /saved/ folder)", EUserInterfaceActionType::Button, FInputGesture());
+  UI_COMMAND(PluginActionExportTiles, "Carla Exporter (tiles)", "Export all or selected meshes into one .OBJ file per 2 km tile to be used by Carla (in /saved/ folder)", EUserInterfaceActionType::Button, FInputGesture());
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -13,6 +13,7 @@
 //用于构建工具栏和菜单。
 class FToolBarBuilder;
 class FMenuBuilder;
+class UBodySetup;
 
 //定义一个枚举类型AreaType，用于表示不同的区域类型。
 enum AreaType
@@ -38,12 +39,23 @@ public:
   //这个函数将被绑定到命令
   void PluginButtonClicked();
 
+  //将几何信息按瓦片导出，每个瓦片一个文件。
+  void PluginTilesButtonClicked();
+
 private://声明私有成员和函数，仅在类内部可见。
 
   //定义一个私有函数AddMenuExtension，用于向菜单添加扩展。
   void AddMenuExtension(FMenuBuilder& Builder);
-  //定义一个私有函数WriteObjectGeom，用于写入对象的几何信息到文件。
-  int32 WriteObjectGeom(std::ofstream &f, FString ObjectName, UBodySetup *body, FTransform &CompTransform, AreaType Area, int32 Offset);
+  //导出所有（或选中的）参与者的碰撞几何体，bByTiles 为真时每个 TileSize 的瓦片一个文件。
+  //各个对象的文本并行生成，再按顺序写入文件。
+  void ExportGeometry(bool bByTiles);
+  //定义一个私有函数WriteObjectGeom，用于把对象的几何信息以 OBJ 格式写入缓冲区，返回写入的顶点数。
+  static int32 WriteObjectGeom(TArray<ANSICHAR> &Out, const FString &ObjectName, UBodySetup *body, const FTransform &CompTransform, AreaType Area, int32 Offset);
+  //WriteObjectGeom 会写入的顶点数，用于在并行写入之前计算每个对象的顶点偏移。
+  static int32 GetObjectGeomVertices(UBodySetup *body);
+
+  //按瓦片导出时瓦片的边长（厘米），与大地图默认的瓦片大小相同。
+  float TileSize = 2.0f * 1000.0f * 100.0f;
 
 //声明一个私有成员PluginCommands，用于存储插件的UI命令列表。
 private:
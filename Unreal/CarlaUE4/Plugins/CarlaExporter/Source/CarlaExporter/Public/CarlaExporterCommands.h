@@ -27,5 +27,7 @@ public:
   virtual void RegisterCommands() override;//声明了一个虚函数，用于注册具体的命令。这个函数重写了基类 TCommands 中定义的同名虚函数，在派生类（也就是这里的 FCarlaExporterCommands 类）中需要实现这个函数来定义具体要注册哪些命令以及它们的相关属性（如命令对应的执行函数、快捷键绑定、显示名称等），只有经过注册的命令才能在编辑器中被正确识别和使用。
 
 public:
-  TSharedPtr< FUICommandInfo > PluginActionExportAll;//定义了一个共享指针类型（TSharedPtr）的成员变量，指向 FUICommandInfo 类型的对象。FUICommandInfo 通常用于保存一个具体的用户界面命令的详细信息，比如命令的名称、图标、执行的操作回调函数等。这里的 PluginActionExportAll 变量很可能是用于保存一个特定的命令信息，从名称推测可能是和 “导出所有（相关内容）” 这个操作对应的命令，后续会在 RegisterCommands() 函数中对其进行详细配置和初始化。
+  TSharedPtr< FUICommandInfo > PluginActionExportAll;
+  //按瓦片导出的命令，每个瓦片导出一个 .OBJ 文件。
+  TSharedPtr< FUICommandInfo > PluginActionExportTiles;//定义了一个共享指针类型（TSharedPtr）的成员变量，指向 FUICommandInfo 类型的对象。FUICommandInfo 通常用于保存一个具体的用户界面命令的详细信息，比如命令的名称、图标、执行的操作回调函数等。这里的 PluginActionExportAll 变量很可能是用于保存一个特定的命令信息，从名称推测可能是和 “导出所有（相关内容）” 这个操作对应的命令，后续会在 RegisterCommands() 函数中对其进行详细配置和初始化。
 };
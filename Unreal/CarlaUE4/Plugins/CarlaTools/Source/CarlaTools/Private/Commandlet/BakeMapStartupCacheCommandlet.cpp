@@ -0,0 +1,134 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "BakeMapStartupCacheCommandlet.h"
+
+#include "Carla/Game/MapStartupCache.h"
+#include "Carla/Game/Tagger.h"
+#include "Carla/OpenDrive/OpenDrive.h"
+#include "Carla/Traffic/TrafficLightManager.h"
+#include "Carla/Vehicle/VehicleSpawnPoint.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/Map.h>
+#include <carla/rpc/String.h>
+#include <compiler/enable-ue4-macros.h>
+
+DEFINE_LOG_CATEGORY(LogCarlaToolsBakeMapStartupCacheCommandlet);
+
+UBakeMapStartupCacheCommandlet::UBakeMapStartupCacheCommandlet()
+{
+  IsClient = false;
+  IsEditor = true;
+  IsServer = false;
+  LogToConsole = true;
+}
+
+#if WITH_EDITORONLY_DATA
+
+static void AddMeshLabel(const UObject *Object, FMapStartupCache &Cache)
+{
+  if (Object != nullptr)
+  {
+    // The label the tagger would give it at runtime, tag table included
+    Cache.MeshLabels.Add(Object->GetPathName(), static_cast<uint8>(ATagger::GetCachedLabel(Object)));
+  }
+}
+
+int32 UBakeMapStartupCacheCommandlet::Main(const FString &Params)
+{
+  FString MapPath;
+  if (!FParse::Value(*Params, TEXT("Map="), MapPath))
+  {
+    UE_LOG(LogCarlaToolsBakeMapStartupCacheCommandlet, Error, TEXT("Missing -Map=<package>"));
+    return 1;
+  }
+  FString MapName = FPackageName::GetShortName(MapPath);
+  FParse::Value(*Params, TEXT("MapName="), MapName);
+  FString Output = FMapStartupCache::GetDefaultPath(MapName);
+  FParse::Value(*Params, TEXT("Output="), Output);
+
+  UPackage *Package = LoadPackage(nullptr, *MapPath, LOAD_None);
+  UWorld *World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+  if (World == nullptr)
+  {
+    UE_LOG(LogCarlaToolsBakeMapStartupCacheCommandlet, Error, TEXT("Could not load map %s"), *MapPath);
+    return 1;
+  }
+  World->AddToRoot();
+  World->WorldType = EWorldType::Editor;
+  if (!World->bIsWorldInitialized)
+  {
+    World->InitWorld(UWorld::InitializationValues()
+        .AllowAudioPlayback(false)
+        .CreateAISystem(false)
+        .CreateNavigation(false)
+        .RequiresHitProxies(false)
+        .ShouldSimulatePhysics(false));
+  }
+  // Sublevels too, the signals may be matched with actors in any of them
+  World->LoadSecondaryLevels(true);
+
+  const FString XODRContent = UOpenDrive::LoadXODR(MapName);
+  const auto CarlaMap = carla::opendrive::OpenDriveParser::Load(carla::rpc::FromLongFString(XODRContent));
+  if (!CarlaMap.has_value())
+  {
+    UE_LOG(LogCarlaToolsBakeMapStartupCacheCommandlet, Error, TEXT("Invalid OpenDRIVE for map %s"), *MapName);
+    World->RemoveFromRoot();
+    return 1;
+  }
+
+  FMapStartupCache Cache;
+  Cache.OpenDriveHash = FMapStartupCache::HashOpenDrive(XODRContent);
+
+  // The game mode only generates spawn points for maps without any
+  if (!TActorIterator<AVehicleSpawnPoint>(World))
+  {
+    Cache.SpawnPoints = FMapStartupCache::ComputeSpawnPoints(*CarlaMap);
+  }
+
+  for (TActorIterator<AActor> It(World); It; ++It)
+  {
+    TArray<UStaticMeshComponent *> StaticMeshComponents;
+    It->GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+    for (const UStaticMeshComponent *Component : StaticMeshComponents)
+    {
+      AddMeshLabel(Component->GetStaticMesh(), Cache);
+    }
+    TArray<USkeletalMeshComponent *> SkeletalMeshComponents;
+    It->GetComponents<USkeletalMeshComponent>(SkeletalMeshComponents);
+    for (const USkeletalMeshComponent *Component : SkeletalMeshComponents)
+    {
+      AddMeshLabel(Component->GetPhysicsAsset(), Cache);
+    }
+  }
+
+  ATrafficLightManager::BakeSignalActors(*CarlaMap, World, Cache);
+
+  World->RemoveFromRoot();
+  if (!Cache.Save(Output))
+  {
+    UE_LOG(LogCarlaToolsBakeMapStartupCacheCommandlet, Error, TEXT("Could not write map startup cache %s"), *Output);
+    return 1;
+  }
+  UE_LOG(LogCarlaToolsBakeMapStartupCacheCommandlet, Log,
+      TEXT("Wrote %s: %d spawn points, %d mesh labels, %d traffic lights and %d signs"),
+      *Output,
+      Cache.SpawnPoints.Num(),
+      Cache.MeshLabels.Num(),
+      Cache.TrafficLightActors.Num(),
+      Cache.SignActors.Num());
+  return 0;
+}
+
+#endif // WITH_EDITORONLY_DATA
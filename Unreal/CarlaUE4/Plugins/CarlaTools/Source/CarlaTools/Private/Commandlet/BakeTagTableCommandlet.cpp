@@ -0,0 +1,69 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "BakeTagTableCommandlet.h"
+
+#include "Carla/Game/Tagger.h"
+
+#include "AssetRegistryModule.h"
+#include "Engine/StaticMesh.h"
+#include "Misc/FileHelper.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+
+DEFINE_LOG_CATEGORY(LogCarlaToolsBakeTagTableCommandlet);
+
+UBakeTagTableCommandlet::UBakeTagTableCommandlet()
+{
+  IsClient = false;
+  IsEditor = true;
+  IsServer = false;
+  LogToConsole = true;
+}
+
+#if WITH_EDITORONLY_DATA
+
+int32 UBakeTagTableCommandlet::Main(const FString &Params)
+{
+  FString Path = TEXT("/Game");
+  FString Output = ATagger::GetDefaultTagTablePath();
+  FParse::Value(*Params, TEXT("Path="), Path);
+  FParse::Value(*Params, TEXT("Output="), Output);
+
+  IAssetRegistry &AssetRegistry =
+      FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+  AssetRegistry.SearchAllAssets(true);
+
+  // The tagger reads the label from the static mesh of static mesh components
+  // and from the physics asset of skeletal mesh components
+  FARFilter Filter;
+  Filter.PackagePaths.Add(FName(*Path));
+  Filter.bRecursivePaths = true;
+  Filter.ClassNames.Add(UStaticMesh::StaticClass()->GetFName());
+  Filter.ClassNames.Add(UPhysicsAsset::StaticClass()->GetFName());
+
+  TArray<FAssetData> Assets;
+  AssetRegistry.GetAssets(Filter, Assets);
+
+  TArray<FString> Lines;
+  Lines.Reserve(Assets.Num() + 1);
+  Lines.Add(TEXT("# ObjectPath,Label"));
+  for (const FAssetData &Asset : Assets)
+  {
+    const FString ObjectPath = Asset.ObjectPath.ToString();
+    const auto Label = ATagger::GetLabelByPathName(ObjectPath);
+    Lines.Add(FString::Printf(TEXT("%s,%d"), *ObjectPath, static_cast<int32>(Label)));
+  }
+
+  if (!FFileHelper::SaveStringArrayToFile(Lines, *Output))
+  {
+    UE_LOG(LogCarlaToolsBakeTagTableCommandlet, Error, TEXT("Could not write tag table %s"), *Output);
+    return 1;
+  }
+  UE_LOG(LogCarlaToolsBakeTagTableCommandlet, Log, TEXT("Wrote %d entries to %s"), Assets.Num(), *Output);
+  return 0;
+}
+
+#endif // WITH_EDITORONLY_DATA
@@ -0,0 +1,227 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "BakeTileProxiesCommandlet.h"
+
+#include "AssetRegistryModule.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "EngineUtils.h"
+#include "IMeshMergeUtilities.h"
+#include "MeshMergeModule.h"
+#include "Misc/PackageName.h"
+
+DEFINE_LOG_CATEGORY(LogCarlaToolsBakeTileProxiesCommandlet);
+
+UBakeTileProxiesCommandlet::UBakeTileProxiesCommandlet()
+{
+  IsClient = false;
+  IsEditor = true;
+  IsServer = false;
+  LogToConsole = true;
+}
+
+#if WITH_EDITORONLY_DATA
+
+static bool SaveAssetPackage(UObject *Asset, const bool bIsMap)
+{
+  UPackage *Package = Asset->GetOutermost();
+  const FString FileName = FPackageName::LongPackageNameToFilename(
+      Package->GetName(),
+      bIsMap ? FPackageName::GetMapPackageExtension() : FPackageName::GetAssetPackageExtension());
+  return UPackage::SavePackage(
+      Package,
+      Asset,
+      EObjectFlags::RF_Public | EObjectFlags::RF_Standalone,
+      *FileName,
+      GError,
+      nullptr,
+      true,
+      true,
+      SAVE_NoError);
+}
+
+int32 UBakeTileProxiesCommandlet::Main(const FString &Params)
+{
+  FString Path;
+  if (!FParse::Value(*Params, TEXT("Path="), Path))
+  {
+    UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Error, TEXT("Missing -Path=<content path of the tiles>"));
+    return 1;
+  }
+  int32 TextureSize = 1024;
+  float MinSize = 500.0f;
+  FParse::Value(*Params, TEXT("TextureSize="), TextureSize);
+  FParse::Value(*Params, TEXT("MinSize="), MinSize);
+
+  IAssetRegistry &AssetRegistry =
+      FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+  AssetRegistry.SearchAllAssets(true);
+
+  FARFilter Filter;
+  Filter.PackagePaths.Add(FName(*Path));
+  Filter.bRecursivePaths = true;
+  Filter.ClassNames.Add(UWorld::StaticClass()->GetFName());
+
+  TArray<FAssetData> Assets;
+  AssetRegistry.GetAssets(Filter, Assets);
+
+  int32 NumProxies = 0;
+  int32 NumErrors = 0;
+  for (const FAssetData &Asset : Assets)
+  {
+    // Same naming as ALargeMapManager::GenerateMap, skipping the proxies
+    const FString AssetName = Asset.AssetName.ToString();
+    if (!AssetName.Contains(TEXT("_Tile_")) || AssetName.EndsWith(TEXT("_HLOD")))
+    {
+      continue;
+    }
+    if (BakeTileProxy(Asset.PackageName.ToString(), TextureSize, MinSize))
+    {
+      ++NumProxies;
+    }
+    else
+    {
+      ++NumErrors;
+    }
+    // Only one tile in memory at a time
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+  }
+
+  UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Log,
+      TEXT("Baked %d tile proxies in %s, %d errors"), NumProxies, *Path, NumErrors);
+  return (NumErrors == 0) ? 0 : 1;
+}
+
+bool UBakeTileProxiesCommandlet::BakeTileProxy(
+    const FString &TilePackageName,
+    const int32 TextureSize,
+    const float MinSize)
+{
+  UPackage *Package = LoadPackage(nullptr, *TilePackageName, LOAD_None);
+  UWorld *World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+  if (World == nullptr)
+  {
+    UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Error, TEXT("Could not load tile %s"), *TilePackageName);
+    return false;
+  }
+  World->AddToRoot();
+  World->WorldType = EWorldType::Editor;
+  if (!World->bIsWorldInitialized)
+  {
+    World->InitWorld(UWorld::InitializationValues()
+        .AllowAudioPlayback(false)
+        .CreateAISystem(false)
+        .CreateNavigation(false)
+        .RequiresHitProxies(false)
+        .ShouldSimulatePhysics(false));
+  }
+
+  TArray<UPrimitiveComponent *> Components;
+  for (TActorIterator<AActor> It(World); It; ++It)
+  {
+    if (It->IsHidden())
+    {
+      continue;
+    }
+    TArray<UStaticMeshComponent *> StaticMeshComponents;
+    It->GetComponents<UStaticMeshComponent>(StaticMeshComponents);
+    for (UStaticMeshComponent *Component : StaticMeshComponents)
+    {
+      if (Component->GetStaticMesh() != nullptr &&
+          Component->IsVisible() &&
+          Component->Bounds.SphereRadius * 2.0f >= MinSize)
+      {
+        Components.Add(Component);
+      }
+    }
+  }
+  if (Components.Num() == 0)
+  {
+    UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Warning, TEXT("Tile %s has no meshes to merge"), *TilePackageName);
+    World->RemoveFromRoot();
+    return true;
+  }
+
+  // The lowest LOD of each mesh and a single material with atlas textures,
+  // the proxy is only seen from beyond the layer streaming distance
+  FMeshMergingSettings Settings;
+  Settings.LODSelectionType = EMeshLODSelectionType::LowestDetailLOD;
+  Settings.bMergeMaterials = true;
+  Settings.MaterialSettings.TextureSize = FIntPoint(TextureSize, TextureSize);
+  Settings.bMergePhysicsData = false;
+  Settings.bGenerateLightMapUV = false;
+  Settings.bPivotPointAtZero = false;
+
+  const FString ProxyPackageName = TilePackageName + TEXT("_HLOD");
+  TArray<UObject *> MergedAssets;
+  FVector MergedLocation;
+  const IMeshMergeUtilities &MeshUtilities =
+      FModuleManager::Get().LoadModuleChecked<IMeshMergeModule>("MeshMergeUtilities").GetUtilities();
+  MeshUtilities.MergeComponentsToStaticMesh(
+      Components,
+      World,
+      Settings,
+      nullptr,
+      nullptr,
+      ProxyPackageName + TEXT("_Mesh"),
+      MergedAssets,
+      MergedLocation,
+      TNumericLimits<float>::Max(),
+      true);
+  World->RemoveFromRoot();
+
+  UStaticMesh *ProxyMesh = nullptr;
+  for (UObject *MergedAsset : MergedAssets)
+  {
+    if (UStaticMesh *Mesh = Cast<UStaticMesh>(MergedAsset))
+    {
+      ProxyMesh = Mesh;
+    }
+    // Mesh, material and textures, each one in its own package
+    if (!SaveAssetPackage(MergedAsset, false))
+    {
+      UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Error, TEXT("Could not save %s"), *MergedAsset->GetPathName());
+      return false;
+    }
+  }
+  if (ProxyMesh == nullptr)
+  {
+    UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Error, TEXT("Could not merge the meshes of tile %s"), *TilePackageName);
+    return false;
+  }
+
+  // The proxy level uses the local coordinates of the tile, the large map
+  // manager gives both the same level transform
+  UPackage *ProxyPackage = CreatePackage(*ProxyPackageName);
+  UWorld *ProxyWorld = UWorld::CreateWorld(
+      EWorldType::Inactive,
+      false,
+      FName(*FPackageName::GetShortName(ProxyPackageName)),
+      ProxyPackage);
+  ProxyWorld->SetFlags(EObjectFlags::RF_Public | EObjectFlags::RF_Standalone);
+
+  AStaticMeshActor *ProxyActor = ProxyWorld->SpawnActor<AStaticMeshActor>(MergedLocation, FRotator::ZeroRotator);
+  UStaticMeshComponent *ProxyComponent = ProxyActor->GetStaticMeshComponent();
+  ProxyComponent->SetStaticMesh(ProxyMesh);
+  ProxyComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  ProxyComponent->SetCastShadow(false);
+
+  FAssetRegistryModule::AssetCreated(ProxyWorld);
+  const bool bSaved = SaveAssetPackage(ProxyWorld, true);
+  ProxyWorld->DestroyWorld(false);
+  if (!bSaved)
+  {
+    UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Error, TEXT("Could not save %s"), *ProxyPackageName);
+    return false;
+  }
+  UE_LOG(LogCarlaToolsBakeTileProxiesCommandlet, Log,
+      TEXT("Baked %s from %d meshes"), *ProxyPackageName, Components.Num());
+  return true;
+}
+
+#endif // WITH_EDITORONLY_DATA
@@ -76,6 +76,12 @@ int32 UGenerateTileCommandlet::Main(const FString &Params)
   OpenDriveMap->BaseLevelName = ParamsMap["BaseLevelName"];
   OpenDriveMap->OriginGeoCoordinates = FVector2D(FCString::Atof(*ParamsMap["GeoCoordsX"]),FCString::Atof(*ParamsMap["GeoCoordsY"]));
   OpenDriveMap->CurrentTilesInXY = FIntVector(FCString::Atof(*ParamsMap["CTileX"]),FCString::Atof(*ParamsMap["CTileY"]), 0);
+  // Set to false when several tiles are generated at the same time and the
+  // base level has already been saved
+  if (const FString *GenerateBaseLevel = ParamsMap.Find("GenerateBaseLevel"))
+  {
+    OpenDriveMap->bGenerateBaseLevel = GenerateBaseLevel->ToBool();
+  }
   // Parse Params
   OpenDriveMap->GenerateTile();
   return 0;
@@ -347,13 +347,18 @@ void UOpenDriveToMap::GenerateTile(){
                             ALargeMapManager::StaticClass() );
     if( QueryActor != nullptr ){
       ALargeMapManager* LmManager = Cast<ALargeMapManager>(QueryActor);  // 获得大地图管理器
-      LmManager->GenerateMap_Editor();
+      // 并行生成时基础关卡中已经保存了瓦片信息，避免多个进程同时写入基础关卡
+      if( bGenerateBaseLevel ){
+        LmManager->GenerateMap_Editor();
+      }
       NumTilesInXY  = LmManager->GetNumTilesInXY();  // 获得横向和纵向的瓦片数
       TileSize = LmManager->GetTileSize();  // 获得地图瓦片大小
       Tile0Offset = LmManager->GetTile0Offset();  // 获得瓦片的偏移
 
       FCarlaMapTile& CarlaTile =  LmManager->GetCarlaMapTile(CurrentTilesInXY);
-      UEditorLevelLibrary::SaveCurrentLevel();
+      if( bGenerateBaseLevel ){
+        UEditorLevelLibrary::SaveCurrentLevel();
+      }
 
       UE_LOG(LogCarlaToolsMapGenerator, Warning, TEXT("Current Tile is %s"), *( CurrentTilesInXY.ToString() ) );
       UE_LOG(LogCarlaToolsMapGenerator, Warning, TEXT("NumTilesInXY is %s"), *( NumTilesInXY.ToString() ) );
@@ -399,6 +404,110 @@ bool UOpenDriveToMap::GoNextTile(){
   return true;
 }
 
+// 当前瓦片是否属于本机负责的分片
+bool UOpenDriveToMap::IsCurrentTileInShard() const{
+  if( NumTileShards <= 1 ){
+    return true;
+  }
+  const int32 TileIndex = CurrentTilesInXY.Y * NumTilesInXY.X + CurrentTilesInXY.X;
+  return (TileIndex % NumTileShards) == TileShardIndex;
+}
+
+// 并行生成所有瓦片，每个瓦片由一个独立的 GenerateTile 命令行进程生成
+void UOpenDriveToMap::GenerateTilesInParallel(int32 MaxProcesses){
+  if( FilePath.IsEmpty() ){
+    UE_LOG(LogCarlaToolsMapGenerator, Warning, TEXT("UOpenDriveToMap::GenerateTilesInParallel(): No file to load") );
+    return;
+  }
+
+  AActor* QueryActor = UGameplayStatics::GetActorOfClass(
+                              UEditorLevelLibrary::GetEditorWorld(),
+                              ALargeMapManager::StaticClass() );
+  if( QueryActor == nullptr ){
+    UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Largemapmanager not found ") );
+    return;
+  }
+
+  // 基础关卡只在这里生成并保存一次，各瓦片进程只读取它
+  ALargeMapManager* LargeMapManager = Cast<ALargeMapManager>(QueryActor);
+  BaseLevelName = LargeMapManager->LargeMapTilePath + "/" + LargeMapManager->LargeMapName;
+  UEditorLevelLibrary::LoadLevel(*BaseLevelName);
+  LargeMapManager = Cast<ALargeMapManager>(UGameplayStatics::GetActorOfClass(
+                              UEditorLevelLibrary::GetEditorWorld(),
+                              ALargeMapManager::StaticClass() ));
+  if( LargeMapManager == nullptr ){
+    UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Largemapmanager not found in %s"), *BaseLevelName );
+    return;
+  }
+  LargeMapManager->GenerateMap_Editor();
+  NumTilesInXY = LargeMapManager->GetNumTilesInXY();
+  TileSize = LargeMapManager->GetTileSize();
+  Tile0Offset = LargeMapManager->GetTile0Offset();
+  UEditorLevelLibrary::SaveCurrentLevel();
+
+  if( MaxProcesses <= 0 ){
+    // 每个进程都会加载整个编辑器，内存往往比 CPU 先成为瓶颈
+    MaxProcesses = FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+  }
+
+  TArray<FIntVector> PendingTiles;
+  CurrentTilesInXY = FIntVector(0,0,0);
+  do{
+    if( IsCurrentTileInShard() ){
+      PendingTiles.Add(CurrentTilesInXY);
+    }
+  }while(GoNextTile());
+
+  const FString EditorPath = FPlatformProcess::ExecutablePath();
+  const FString ProjectPath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+
+  struct FTileProcess
+  {
+    FIntVector Tile;
+    FProcHandle Handle;
+  };
+  TArray<FTileProcess> Running;
+  int32 NextTile = 0;
+  int32 NumFailed = 0;
+  UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Generating %d tiles with up to %d processes"), PendingTiles.Num(), MaxProcesses );
+  while( NextTile < PendingTiles.Num() || Running.Num() > 0 ){
+    while( NextTile < PendingTiles.Num() && Running.Num() < MaxProcesses ){
+      const FIntVector Tile = PendingTiles[NextTile++];
+      const FString Arguments = FString::Printf(
+          TEXT("\"%s\" -run=GenerateTile -FilePath=\"%s\" -BaseLevelName=\"%s\" -GeoCoordsX=%f -GeoCoordsY=%f -CTileX=%d -CTileY=%d -GenerateBaseLevel=false -unattended -nopause"),
+          *ProjectPath, *FilePath, *BaseLevelName,
+          OriginGeoCoordinates.X, OriginGeoCoordinates.Y, Tile.X, Tile.Y);
+      FProcHandle Handle = FPlatformProcess::CreateProc(
+          *EditorPath, *Arguments, true, true, true, nullptr, 0, nullptr, nullptr);
+      if( !Handle.IsValid() ){
+        UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Failed to launch the generation of tile %s"), *Tile.ToString() );
+        ++NumFailed;
+        continue;
+      }
+      Running.Add({Tile, Handle});
+    }
+    FPlatformProcess::Sleep(0.5f);
+    for( int32 i = Running.Num() - 1; i >= 0; --i ){
+      if( FPlatformProcess::IsProcRunning(Running[i].Handle) ){
+        continue;
+      }
+      int32 ReturnCode = 0;
+      FPlatformProcess::GetProcReturnCode(Running[i].Handle, &ReturnCode);
+      FPlatformProcess::CloseProc(Running[i].Handle);
+      if( ReturnCode != 0 ){
+        UE_LOG(LogCarlaToolsMapGenerator, Error, TEXT("Generation of tile %s failed with code %d"), *Running[i].Tile.ToString(), ReturnCode );
+        ++NumFailed;
+      }else{
+        UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Tile %s generated"), *Running[i].Tile.ToString() );
+      }
+      Running.RemoveAtSwap(i);
+    }
+  }
+  UE_LOG(LogCarlaToolsMapGenerator, Log, TEXT("Generated %d of %d tiles"), PendingTiles.Num() - NumFailed, PendingTiles.Num() );
+  CurrentTilesInXY = FIntVector(0,0,0);
+  ReturnToMainLevel();
+}
+
 // 返回主关卡
 void UOpenDriveToMap::ReturnToMainLevel(){
   Landscapes.Empty();
@@ -487,7 +596,9 @@ void UOpenDriveToMap::LoadMap()
       ULevel* PersistantLevel = UEditorLevelLibrary::GetEditorWorld()->PersistentLevel;  // 持久关卡
       BaseLevelName = LargeMapManager->LargeMapTilePath + "/" + LargeMapManager->LargeMapName;
       do{
-        GenerateTileStandalone();  // 循环独立生成地图瓦片
+        if( IsCurrentTileInShard() ){
+          GenerateTileStandalone();  // 循环独立生成地图瓦片
+        }
       }while(GoNextTile());
       ReturnToMainLevel();  // 返回主关卡
     }
@@ -0,0 +1,44 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "BakeMapStartupCacheCommandlet.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCarlaToolsBakeMapStartupCacheCommandlet, Log, All);
+
+/// Precomputes what the server computes for a map at startup into the
+/// binary FMapStartupCache that ACarlaGameModeBase loads with the map: the
+/// spawn points generated from the road topology, the semantic labels of the
+/// meshes and the traffic lights and signs matched with each OpenDRIVE
+/// signal.
+///
+/// Run it before cooking, again whenever the map or its OpenDRIVE changes
+/// (a cache baked for another OpenDRIVE is ignored):
+///
+///   UE4Editor CarlaUE4.uproject -run=BakeMapStartupCache -Map=/Game/Carla/Maps/Town10HD [-MapName=<name>] [-Output=<file>]
+///
+/// MapName defaults to the name of the map package, set it to the
+/// LargeMapName of large maps. By default the cache is written to
+/// FMapStartupCache::GetDefaultPath(MapName).
+UCLASS()
+class CARLATOOLS_API UBakeMapStartupCacheCommandlet
+  : public UCommandlet
+{
+  GENERATED_BODY()
+
+public:
+
+  UBakeMapStartupCacheCommandlet();
+
+#if WITH_EDITORONLY_DATA
+
+  virtual int32 Main(const FString &Params) override;
+
+#endif // WITH_EDITORONLY_DATA
+};
@@ -0,0 +1,41 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "BakeTagTableCommandlet.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCarlaToolsBakeTagTableCommandlet, Log, All);
+
+/// Writes the semantic label of every static mesh and physics asset under a
+/// content path to a tag table that ATagger loads at runtime, so the labels
+/// are not resolved from the asset paths while the levels load. The table is
+/// plain text and can be edited to override the label of assets stored
+/// outside the usual folders.
+///
+/// Run it before cooking:
+///
+///   UE4Editor CarlaUE4.uproject -run=BakeTagTable [-Path=/Game] [-Output=<file>]
+///
+/// By default the table is written to ATagger::GetDefaultTagTablePath().
+UCLASS()
+class CARLATOOLS_API UBakeTagTableCommandlet
+  : public UCommandlet
+{
+  GENERATED_BODY()
+
+public:
+
+  UBakeTagTableCommandlet();
+
+#if WITH_EDITORONLY_DATA
+
+  virtual int32 Main(const FString &Params) override;
+
+#endif // WITH_EDITORONLY_DATA
+};
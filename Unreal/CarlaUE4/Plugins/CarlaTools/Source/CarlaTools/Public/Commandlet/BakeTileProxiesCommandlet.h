@@ -0,0 +1,51 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "BakeTileProxiesCommandlet.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCarlaToolsBakeTileProxiesCommandlet, Log, All);
+
+/// Bakes a low detail proxy of every tile of a large map: the static meshes
+/// of the tile are merged at their lowest LOD into a single mesh with one
+/// atlas material, and saved in a level named after the tile with the
+/// "_HLOD" suffix. ALargeMapManager streams these proxy levels for the tiles
+/// beyond LayerStreamingDistance and within ProxyStreamingDistance, so the
+/// far tiles are drawn with a few draw calls and compressed textures instead
+/// of staying empty.
+///
+/// Run it before cooking, again whenever the tiles change:
+///
+///   UE4Editor CarlaUE4.uproject -run=BakeTileProxies -Path=/Game/Carla/Maps/Town13 [-TextureSize=1024] [-MinSize=500]
+///
+/// Meshes whose bounds are smaller than MinSize (cm) are left out of the
+/// proxy, they are not visible from that far. Landscapes are not merged,
+/// they keep their own LODs.
+UCLASS()
+class CARLATOOLS_API UBakeTileProxiesCommandlet
+  : public UCommandlet
+{
+  GENERATED_BODY()
+
+public:
+
+  UBakeTileProxiesCommandlet();
+
+#if WITH_EDITORONLY_DATA
+
+  virtual int32 Main(const FString &Params) override;
+
+private:
+
+  /// Bakes the proxy of the tile @a TilePackageName, returns false if the
+  /// tile could not be loaded or the proxy could not be saved.
+  bool BakeTileProxy(const FString &TilePackageName, int32 TextureSize, float MinSize);
+
+#endif // WITH_EDITORONLY_DATA
+};
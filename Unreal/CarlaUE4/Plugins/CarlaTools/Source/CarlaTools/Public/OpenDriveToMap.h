@@ -87,9 +87,16 @@ public:
 // 可在蓝图调用，生成瓦片
   UFUNCTION(BlueprintCallable)
   void GenerateTile();
+// 可在蓝图调用，同时启动最多 MaxProcesses 个 GenerateTile 命令行进程生成所有瓦片，
+// 每个瓦片保存为独立的关卡；MaxProcesses 不大于 0 时使用一半的 CPU 核心数
+  UFUNCTION(BlueprintCallable)
+  void GenerateTilesInParallel(int32 MaxProcesses = 0);
 // 可在蓝图调用，切换到下一个瓦片
   UFUNCTION(BlueprintCallable)
   bool GoNextTile();
+// 可在蓝图调用，当前瓦片是否属于本机负责的分片
+  UFUNCTION(BlueprintCallable)
+  bool IsCurrentTileInShard() const;
 // 可在蓝图调用，返回到主层级
   UFUNCTION(BlueprintCallable)
   void ReturnToMainLevel();
@@ -173,6 +180,17 @@ public:
 // 可在编辑器编辑、蓝图读写，基础层级名称
   UPROPERTY( EditAnywhere, BlueprintReadWrite, Category="TileGeneration" )
   FString BaseLevelName;
+// 可在编辑器编辑、蓝图读写，瓦片按行优先的序号对 NumTileShards 取模等于
+// TileShardIndex 时才生成，用于把一张地图分给多台机器生成
+  UPROPERTY( EditAnywhere, BlueprintReadWrite, Category="TileGeneration" )
+  int32 TileShardIndex = 0;
+// 可在编辑器编辑、蓝图读写，分片的数量，默认只有一个分片
+  UPROPERTY( EditAnywhere, BlueprintReadWrite, Category="TileGeneration" )
+  int32 NumTileShards = 1;
+// 可在编辑器编辑、蓝图读写，生成瓦片前是否重新生成并保存基础关卡；并行生成时
+// 基础关卡只由发起的进程保存一次，各瓦片进程不再写入
+  UPROPERTY( EditAnywhere, BlueprintReadWrite, Category="TileGeneration" )
+  bool bGenerateBaseLevel = true;
 // 可在编辑器编辑、蓝图读写，默认高度图纹理
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heightmap")
   UTexture2D* DefaultHeightmap;
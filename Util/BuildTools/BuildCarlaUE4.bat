@@ -27,6 +27,8 @@ set AT_LEAST_WRITE_OPTIONALMODULES=false
 set EDITOR_FLAGS=""
 set USE_ROS2=false
 set ROS2_STATE="Ros2 OFF"
+set USE_SERVER_NAVIGATION=false
+set SERVER_NAVIGATION_STATE="ServerNavigation OFF"
 
 :arg-parse
 echo %1
@@ -53,6 +55,9 @@ if not "%1"=="" (
     if "%1"=="--ros2" (
         set USE_ROS2=true
     )
+    if "%1"=="--server-navigation" (
+        set USE_SERVER_NAVIGATION=true
+    )
     if "%1"=="--no-unity" (
         set USE_UNITY=false
     )
@@ -165,7 +170,12 @@ if %USE_UNITY% == true (
 ) else (
     set UNITY_STATE="Unity OFF"
 )
-set OPTIONAL_MODULES_TEXT=%CARSIM_STATE% %CHRONO_STATE% %ROS2_STATE% %OMNIVERSE_PLUGIN_INSTALLED% %UNITY_STATE%
+if %USE_SERVER_NAVIGATION% == true (
+    set SERVER_NAVIGATION_STATE="ServerNavigation ON"
+) else (
+    set SERVER_NAVIGATION_STATE="ServerNavigation OFF"
+)
+set OPTIONAL_MODULES_TEXT=%CARSIM_STATE% %CHRONO_STATE% %ROS2_STATE% %OMNIVERSE_PLUGIN_INSTALLED% %UNITY_STATE% %SERVER_NAVIGATION_STATE%
 echo %OPTIONAL_MODULES_TEXT% > "%ROOT_PATH%Unreal/CarlaUE4/Config/OptionalModules.ini"
 
 